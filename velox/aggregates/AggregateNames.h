@@ -19,6 +19,7 @@
 namespace facebook::velox::aggregate {
 
 const char* const kApproxDistinct = "approx_distinct";
+const char* const kApproxMostFrequent = "approx_most_frequent";
 const char* const kApproxPercentile = "approx_percentile";
 const char* const kArbitrary = "arbitrary";
 const char* const kArrayAgg = "array_agg";
@@ -27,8 +28,11 @@ const char* const kBitwiseAnd = "bitwise_and_agg";
 const char* const kBitwiseOr = "bitwise_or_agg";
 const char* const kBoolAnd = "bool_and";
 const char* const kBoolOr = "bool_or";
+const char* const kCorr = "corr";
 const char* const kCount = "count";
 const char* const kCountIf = "count_if";
+const char* const kCovarPop = "covar_pop";
+const char* const kCovarSamp = "covar_samp";
 const char* const kMapAgg = "map_agg";
 const char* const kMax = "max";
 const char* const kMaxBy = "max_by";
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "velox/common/base/Range.h"
+#include "velox/vector/DecodedVector.h"
 #include "velox/vector/LazyVector.h"
 
 namespace facebook::velox::aggregate {
@@ -162,6 +163,76 @@ class SimpleCallableHook final : public AggregationHook {
   UpdateSingleValue updateSingleValue_;
 };
 
+// Counts non-null values. The value is not looked at, so this works for
+// columns of any type. The accumulator is an int64_t that is never null.
+class CountHook final : public AggregationHook {
+ public:
+  CountHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char** groups,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
+
+  Kind kind() const override {
+    return kGeneric;
+  }
+
+  void addValue(vector_size_t row, const void* /*value*/) override {
+    ++*reinterpret_cast<int64_t*>(findGroup(row) + offset_);
+  }
+};
+
+// Counts true values of a boolean column. The accumulator is an int64_t
+// that is never null.
+class CountIfHook final : public AggregationHook {
+ public:
+  CountIfHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char** groups,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
+
+  Kind kind() const override {
+    return kGeneric;
+  }
+
+  void addValue(vector_size_t row, const void* value) override {
+    if (*reinterpret_cast<const bool*>(value)) {
+      ++*reinterpret_cast<int64_t*>(findGroup(row) + offset_);
+    }
+  }
+};
+
+// Adds values to an accumulator with 'sum' and 'count' members, e.g. the
+// accumulator of avg().
+template <typename TValue, typename TAccumulator>
+class SumCountHook final : public AggregationHook {
+ public:
+  SumCountHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char** groups,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
+
+  Kind kind() const override {
+    return kGeneric;
+  }
+
+  void addValue(vector_size_t row, const void* value) override {
+    auto group = findGroup(row);
+    clearNull(group);
+    auto accumulator = reinterpret_cast<TAccumulator*>(group + offset_);
+    accumulator->sum += *reinterpret_cast<const TValue*>(value);
+    ++accumulator->count;
+  }
+};
+
 template <typename T, bool isMin>
 class MinMaxHook final : public AggregationHook {
  public:
@@ -209,4 +280,59 @@ class MinMaxHook final : public AggregationHook {
   }
 };
 
+// Loads 'rows' of the not yet loaded LazyVector under 'arg' into 'hook'
+// instead of materializing the values. 'indices' is scratch space for the
+// row numbers of the LazyVector if not all rows are selected. The hook gets
+// the position of each value among the selected rows, so its groups must
+// come from selectedGroups() or repeatGroup().
+inline void pushdownToHook(
+    ValueHook& hook,
+    const SelectivityVector& rows,
+    const VectorPtr& arg,
+    std::vector<vector_size_t>& indices) {
+  DecodedVector decoded(*arg, rows, false);
+  const vector_size_t* rawIndices = decoded.indices();
+  // The decoded vector does not keep the info from 'rows', except for its
+  // upper bound. If not all rows are selected, we generate the indices of
+  // the selected rows, which we indirect through the decoded ones.
+  vector_size_t numIndices{arg->size()};
+  if (!rows.isAllSelected()) {
+    const auto numSelected = rows.countSelected();
+    if (numSelected != arg->size()) {
+      indices.resize(numSelected);
+      vector_size_t target{0};
+      rows.applyToSelected(
+          [&](vector_size_t i) { indices[target++] = rawIndices[i]; });
+      rawIndices = indices.data();
+      numIndices = numSelected;
+    }
+  }
+
+  decoded.base()->as<const LazyVector>()->load(
+      RowSet(rawIndices, numIndices), &hook);
+}
+
+// Returns the groups of the selected 'rows' in order, using 'buffer' if not
+// all rows are selected.
+inline char** selectedGroups(
+    char** groups,
+    const SelectivityVector& rows,
+    std::vector<char*>& buffer) {
+  if (rows.isAllSelected()) {
+    return groups;
+  }
+  buffer.clear();
+  rows.applyToSelected([&](vector_size_t i) { buffer.push_back(groups[i]); });
+  return buffer.data();
+}
+
+// Sets 'groups' to 'numRows' copies of 'group' and returns them. Lets hooks,
+// which look up the group of each row, update the single group of a global
+// aggregation.
+inline char**
+repeatGroup(char* group, vector_size_t numRows, std::vector<char*>& groups) {
+  groups.assign(numRows, group);
+  return groups.data();
+}
+
 } // namespace facebook::velox::aggregate
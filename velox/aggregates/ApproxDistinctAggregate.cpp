@@ -47,6 +47,21 @@ struct HllAccumulator {
     }
   }
 
+  void append(const uint64_t* hashes, int32_t count) {
+    // Feed the sparse HLL in small batches so that it switches to the dense
+    // layout close to its memory limit rather than after a large batch.
+    int32_t i = 0;
+    for (; isSparse_ && i < count; i += kSparseBatchSize) {
+      if (sparseHll_.insertHashes(
+              hashes + i, std::min(kSparseBatchSize, count - i))) {
+        toDense();
+      }
+    }
+    if (i < count) {
+      denseHll_.insertHashes(hashes + i, count - i);
+    }
+  }
+
   int64_t cardinality() const {
     return isSparse_ ? sparseHll_.cardinality() : denseHll_.cardinality();
   }
@@ -90,6 +105,8 @@ struct HllAccumulator {
     sparseHll_.reset();
   }
 
+  static constexpr int32_t kSparseBatchSize = 64;
+
   bool isSparse_{true};
   int8_t indexBitLength_{-1};
   hll::SparseHll sparseHll_;
@@ -227,19 +244,23 @@ class ApproxDistinctAggregate : public exec::Aggregate {
       bool /*mayPushdown*/) override {
     decodeArguments(rows, args);
 
+    // Hash all rows first and insert the hashes into the HLL in one batch.
+    hashes_.resize(rows.end());
+    int32_t numHashes = 0;
     rows.applyToSelected([&](auto row) {
-      if (decodedValue_.isNullAt(row)) {
-        return;
-      }
-
-      auto accumulator = value<HllAccumulator>(group);
-      if (clearNull(group)) {
-        accumulator->setIndexBitLength(indexBitLength_);
+      if (!decodedValue_.isNullAt(row)) {
+        hashes_[numHashes++] = hashOne(decodedValue_.valueAt<T>(row));
       }
-
-      auto hash = hashOne(decodedValue_.valueAt<T>(row));
-      accumulator->append(hash);
     });
+    if (numHashes == 0) {
+      return;
+    }
+
+    auto accumulator = value<HllAccumulator>(group);
+    if (clearNull(group)) {
+      accumulator->setIndexBitLength(indexBitLength_);
+    }
+    accumulator->append(hashes_.data(), numHashes);
   }
 
   void addSingleGroupIntermediateResults(
@@ -343,6 +364,7 @@ class ApproxDistinctAggregate : public exec::Aggregate {
   DecodedVector decodedValue_;
   DecodedVector decodedMaxStandardError_;
   DecodedVector decodedHll_;
+  std::vector<uint64_t> hashes_;
 };
 
 template <TypeKind kind>
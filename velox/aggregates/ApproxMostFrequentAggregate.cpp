@@ -0,0 +1,633 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <folly/container/F14Map.h>
+#include <numeric>
+
+#include "velox/aggregates/AggregateNames.h"
+#include "velox/exec/Aggregate.h"
+#include "velox/exec/HashStringAllocator.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::aggregate {
+namespace {
+
+// Space-saving sketch of the most frequent values of a group. Keeps at
+// most 'capacity' counters. When all counters are in use, a value without
+// a counter takes over the counter with the smallest count, so that a
+// count exceeds the true count of its value by at most the smallest
+// count. The counters form a min-heap on count and are found by value
+// through an open addressing table with linear probing. All memory,
+// including copies of non-inlined strings, comes from the
+// HashStringAllocator.
+template <typename T>
+class SpaceSavingSketch {
+ public:
+  explicit SpaceSavingSketch(exec::HashStringAllocator* allocator)
+      : values_{exec::StlAllocator<T>(allocator)},
+        counts_{exec::StlAllocator<int64_t>(allocator)},
+        heap_{exec::StlAllocator<int32_t>(allocator)},
+        heapIndex_{exec::StlAllocator<int32_t>(allocator)},
+        table_{exec::StlAllocator<int32_t>(allocator)} {}
+
+  void setCapacity(int32_t capacity) {
+    capacity_ = capacity;
+  }
+
+  int32_t size() const {
+    return values_.size();
+  }
+
+  T valueAt(int32_t counter) const {
+    return values_[counter];
+  }
+
+  int64_t countAt(int32_t counter) const {
+    return counts_[counter];
+  }
+
+  // Adds 'count' occurrences of 'value'.
+  void add(T value, int64_t count, exec::HashStringAllocator* allocator) {
+    if (table_.empty()) {
+      table_.resize(kInitialTableSize, kEmpty);
+    }
+    auto slot = findSlot(value);
+    auto counter = table_[slot];
+    if (counter != kEmpty) {
+      counts_[counter] += count;
+      siftDown(heapIndex_[counter]);
+      return;
+    }
+
+    if (size() < capacity_) {
+      counter = values_.size();
+      values_.push_back(storeValue(value, allocator));
+      counts_.push_back(count);
+      heapIndex_.push_back(heap_.size());
+      heap_.push_back(counter);
+      table_[slot] = counter;
+      siftUp(heap_.size() - 1);
+      if (values_.size() * 2 > table_.size()) {
+        rehash(table_.size() * 2);
+      }
+      return;
+    }
+
+    // Take over the counter with the smallest count.
+    counter = heap_[0];
+    eraseSlot(findSlot(values_[counter]));
+    freeValue(values_[counter], allocator);
+    values_[counter] = storeValue(value, allocator);
+    table_[findSlot(value)] = counter;
+    counts_[counter] += count;
+    siftDown(0);
+  }
+
+  // Sets 'counters' to the min('n', size()) counters with the highest
+  // counts, highest count first. Ties are ordered by value.
+  void topCounters(int32_t n, std::vector<int32_t>& counters) const {
+    counters.resize(values_.size());
+    std::iota(counters.begin(), counters.end(), 0);
+    auto end = counters.begin() + std::min<int32_t>(n, counters.size());
+    std::partial_sort(
+        counters.begin(), end, counters.end(), [&](int32_t a, int32_t b) {
+          if (counts_[a] != counts_[b]) {
+            return counts_[a] > counts_[b];
+          }
+          return values_[a] < values_[b];
+        });
+    counters.erase(end, counters.end());
+  }
+
+  void free(exec::HashStringAllocator* allocator) {
+    for (auto& value : values_) {
+      freeValue(value, allocator);
+    }
+    freeVector(values_);
+    freeVector(counts_);
+    freeVector(heap_);
+    freeVector(heapIndex_);
+    freeVector(table_);
+  }
+
+ private:
+  static constexpr int32_t kEmpty = -1;
+  static constexpr int32_t kInitialTableSize = 16;
+
+  template <typename V>
+  static void freeVector(V& vector) {
+    V empty(vector.get_allocator());
+    vector.swap(empty);
+  }
+
+  static T storeValue(T value, exec::HashStringAllocator* allocator) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      if (!value.isInline()) {
+        auto data = allocator->allocate(value.size())->begin();
+        memcpy(data, value.data(), value.size());
+        return StringView(data, value.size());
+      }
+    }
+    return value;
+  }
+
+  static void freeValue(T value, exec::HashStringAllocator* allocator) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      if (!value.isInline()) {
+        allocator->free(exec::HashStringAllocator::headerOf(value.data()));
+      }
+    }
+  }
+
+  int32_t homeSlot(T value) const {
+    return folly::hasher<T>()(value) & (table_.size() - 1);
+  }
+
+  // Returns the slot of 'value' or the empty slot where it would go.
+  int32_t findSlot(T value) const {
+    auto mask = table_.size() - 1;
+    auto slot = homeSlot(value);
+    while (table_[slot] != kEmpty && !(values_[table_[slot]] == value)) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  // Empties 'slot' and moves later entries of the same probe sequence
+  // back so that no lookup passes an empty slot before its value.
+  void eraseSlot(int32_t slot) {
+    auto mask = table_.size() - 1;
+    auto hole = slot;
+    auto next = (hole + 1) & mask;
+    while (table_[next] != kEmpty) {
+      auto home = homeSlot(values_[table_[next]]);
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        table_[hole] = table_[next];
+        hole = next;
+      }
+      next = (next + 1) & mask;
+    }
+    table_[hole] = kEmpty;
+  }
+
+  void rehash(int32_t size) {
+    table_.assign(size, kEmpty);
+    for (auto counter = 0; counter < values_.size(); ++counter) {
+      table_[findSlot(values_[counter])] = counter;
+    }
+  }
+
+  void swapHeap(int32_t i, int32_t j) {
+    std::swap(heap_[i], heap_[j]);
+    heapIndex_[heap_[i]] = i;
+    heapIndex_[heap_[j]] = j;
+  }
+
+  void siftUp(int32_t i) {
+    while (i > 0) {
+      auto parent = (i - 1) / 2;
+      if (counts_[heap_[parent]] <= counts_[heap_[i]]) {
+        break;
+      }
+      swapHeap(i, parent);
+      i = parent;
+    }
+  }
+
+  void siftDown(int32_t i) {
+    int32_t size = heap_.size();
+    for (;;) {
+      auto smallest = i;
+      for (auto child = 2 * i + 1; child <= 2 * i + 2 && child < size;
+           ++child) {
+        if (counts_[heap_[child]] < counts_[heap_[smallest]]) {
+          smallest = child;
+        }
+      }
+      if (smallest == i) {
+        break;
+      }
+      swapHeap(i, smallest);
+      i = smallest;
+    }
+  }
+
+  int32_t capacity_{0};
+  std::vector<T, exec::StlAllocator<T>> values_;
+  std::vector<int64_t, exec::StlAllocator<int64_t>> counts_;
+
+  // Counters in min-heap order of count and the position of each counter
+  // in 'heap_'.
+  std::vector<int32_t, exec::StlAllocator<int32_t>> heap_;
+  std::vector<int32_t, exec::StlAllocator<int32_t>> heapIndex_;
+
+  // Open addressing table of counters keyed on value. The size is a power
+  // of two and at least twice the number of counters.
+  std::vector<int32_t, exec::StlAllocator<int32_t>> table_;
+};
+
+// approx_most_frequent(buckets, value, capacity) returns a map from up to
+// 'buckets' of the most frequent values to their approximate counts,
+// tracked by a space-saving sketch of 'capacity' counters. The
+// intermediate result is ROW(buckets, capacity, ARRAY(value),
+// ARRAY(count)) with the counters of the sketch. Merging adds each
+// counter of the intermediate result to the sketch of the group.
+template <typename T>
+class ApproxMostFrequentAggregate : public exec::Aggregate {
+ public:
+  explicit ApproxMostFrequentAggregate(const TypePtr& resultType)
+      : exec::Aggregate(resultType) {}
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(SpaceSavingSketch<T>);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    setAllNulls(groups, indices);
+    for (auto i : indices) {
+      new (groups[i] + offset_) SpaceSavingSketch<T>(allocator_);
+    }
+  }
+
+  void finalize(char** /*groups*/, int32_t /*numGroups*/) override {}
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto mapVector = (*result)->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    mapVector->resize(numGroups);
+    auto* rawNulls = getRawNulls(mapVector);
+
+    vector_size_t numElements = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      if (!isNull(groups[i])) {
+        numElements +=
+            std::min<int64_t>(buckets_, value<Sketch>(groups[i])->size());
+      }
+    }
+    auto mapKeys = mapVector->mapKeys()->asFlatVector<T>();
+    auto mapValues = mapVector->mapValues()->asFlatVector<int64_t>();
+    mapKeys->resize(numElements);
+    mapValues->resize(numElements);
+
+    vector_size_t offset = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        mapVector->setNull(i, true);
+        mapVector->setOffsetAndSize(i, offset, 0);
+        continue;
+      }
+      clearNull(rawNulls, i);
+      auto sketch = value<Sketch>(group);
+      sketch->topCounters(buckets_, counters_);
+      for (auto counter : counters_) {
+        mapKeys->set(offset, sketch->valueAt(counter));
+        mapValues->set(offset, sketch->countAt(counter));
+        ++offset;
+      }
+      mapVector->setOffsetAndSize(
+          i, offset - counters_.size(), counters_.size());
+    }
+  }
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto rowVector = (*result)->as<RowVector>();
+    VELOX_CHECK(rowVector);
+    rowVector->resize(numGroups);
+    auto* rawNulls = getRawNulls(rowVector);
+
+    auto bucketsVector = rowVector->childAt(0)->asFlatVector<int64_t>();
+    auto capacityVector = rowVector->childAt(1)->asFlatVector<int64_t>();
+    auto valuesVector = rowVector->childAt(2)->as<ArrayVector>();
+    auto countsVector = rowVector->childAt(3)->as<ArrayVector>();
+    bucketsVector->resize(numGroups);
+    capacityVector->resize(numGroups);
+    valuesVector->resize(numGroups);
+    countsVector->resize(numGroups);
+
+    vector_size_t numElements = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      numElements += value<Sketch>(groups[i])->size();
+    }
+    auto values = valuesVector->elements()->asFlatVector<T>();
+    auto counts = countsVector->elements()->asFlatVector<int64_t>();
+    values->resize(numElements);
+    counts->resize(numElements);
+
+    vector_size_t offset = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        rowVector->setNull(i, true);
+        valuesVector->setOffsetAndSize(i, offset, 0);
+        countsVector->setOffsetAndSize(i, offset, 0);
+        continue;
+      }
+      clearNull(rawNulls, i);
+      auto sketch = value<Sketch>(group);
+      bucketsVector->set(i, buckets_);
+      capacityVector->set(i, capacity_);
+      valuesVector->setOffsetAndSize(i, offset, sketch->size());
+      countsVector->setOffsetAndSize(i, offset, sketch->size());
+      for (auto counter = 0; counter < sketch->size(); ++counter) {
+        values->set(offset, sketch->valueAt(counter));
+        counts->set(offset, sketch->countAt(counter));
+        ++offset;
+      }
+    }
+  }
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeArguments(rows, args);
+
+    // Consecutive rows with the same group and value are added as one
+    // update.
+    char* runGroup = nullptr;
+    T runValue{};
+    int64_t runCount = 0;
+    rows.applyToSelected([&](auto row) {
+      if (decodedValue_.isNullAt(row)) {
+        return;
+      }
+      auto group = groups[row];
+      auto x = decodedValue_.valueAt<T>(row);
+      if (group == runGroup && x == runValue) {
+        ++runCount;
+        return;
+      }
+      if (runCount) {
+        addToGroup(runGroup, runValue, runCount);
+      }
+      runGroup = group;
+      runValue = x;
+      runCount = 1;
+    });
+    if (runCount) {
+      addToGroup(runGroup, runValue, runCount);
+    }
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeIntermediate(rows, args);
+
+    rows.applyToSelected([&](auto row) {
+      if (!decodedIntermediate_.isNullAt(row)) {
+        mergeIntermediate(groups[row], decodedIntermediate_.index(row));
+      }
+    });
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeArguments(rows, args);
+
+    // Count the distinct values of the batch first so that each of them
+    // updates the sketch once.
+    batchCounts_.clear();
+    rows.applyToSelected([&](auto row) {
+      if (!decodedValue_.isNullAt(row)) {
+        ++batchCounts_[decodedValue_.valueAt<T>(row)];
+      }
+    });
+    for (auto& [x, count] : batchCounts_) {
+      addToGroup(group, x, count);
+    }
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeIntermediate(rows, args);
+
+    rows.applyToSelected([&](auto row) {
+      if (!decodedIntermediate_.isNullAt(row)) {
+        mergeIntermediate(group, decodedIntermediate_.index(row));
+      }
+    });
+  }
+
+  void destroy(folly::Range<char**> groups) override {
+    for (auto group : groups) {
+      value<Sketch>(group)->free(allocator_);
+    }
+  }
+
+ private:
+  using Sketch = SpaceSavingSketch<T>;
+
+  void addToGroup(char* group, T x, int64_t count) {
+    auto sketch = value<Sketch>(group);
+    if (clearNull(group)) {
+      sketch->setCapacity(capacity_);
+    }
+    sketch->add(x, count, allocator_);
+  }
+
+  void mergeIntermediate(char* group, vector_size_t index) {
+    checkSetBuckets(intermediateBuckets_->valueAt(index));
+    checkSetCapacity(intermediateCapacity_->valueAt(index));
+    auto valuesOffset = intermediateValues_->offsetAt(index);
+    auto countsOffset = intermediateCounts_->offsetAt(index);
+    auto size = intermediateValues_->sizeAt(index);
+    for (auto i = 0; i < size; ++i) {
+      addToGroup(
+          group,
+          intermediateValueElements_->valueAt(valuesOffset + i),
+          intermediateCountElements_->valueAt(countsOffset + i));
+    }
+  }
+
+  void decodeArguments(
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args) {
+    decodedBuckets_.decode(*args[0], rows, true);
+    decodedValue_.decode(*args[1], rows, true);
+    decodedCapacity_.decode(*args[2], rows, true);
+    VELOX_USER_CHECK(
+        decodedBuckets_.isConstantMapping() &&
+            decodedCapacity_.isConstantMapping(),
+        "The number of buckets and the capacity of {} must be constant for "
+        "all input rows",
+        kApproxMostFrequent);
+    checkSetBuckets(decodedBuckets_.valueAt<int64_t>(0));
+    checkSetCapacity(decodedCapacity_.valueAt<int64_t>(0));
+  }
+
+  void decodeIntermediate(
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args) {
+    decodedIntermediate_.decode(*args[0], rows, true);
+    auto base = decodedIntermediate_.base()->as<RowVector>();
+    VELOX_CHECK(base);
+    intermediateBuckets_ =
+        base->childAt(0)->as<SimpleVector<int64_t>>();
+    intermediateCapacity_ =
+        base->childAt(1)->as<SimpleVector<int64_t>>();
+    intermediateValues_ = base->childAt(2)->as<ArrayVector>();
+    intermediateCounts_ = base->childAt(3)->as<ArrayVector>();
+    intermediateValueElements_ =
+        intermediateValues_->elements()->as<SimpleVector<T>>();
+    intermediateCountElements_ =
+        intermediateCounts_->elements()->as<SimpleVector<int64_t>>();
+  }
+
+  void checkSetBuckets(int64_t buckets) {
+    VELOX_USER_CHECK_GT(
+        buckets,
+        0,
+        "The number of buckets of {} must be positive",
+        kApproxMostFrequent);
+    if (buckets_ < 0) {
+      buckets_ = buckets;
+    } else {
+      VELOX_USER_CHECK_EQ(
+          buckets,
+          buckets_,
+          "The number of buckets of {} must be constant for all input rows",
+          kApproxMostFrequent);
+    }
+  }
+
+  void checkSetCapacity(int64_t capacity) {
+    VELOX_USER_CHECK_GE(
+        capacity,
+        buckets_,
+        "The capacity of {} must be at least the number of buckets",
+        kApproxMostFrequent);
+    VELOX_USER_CHECK_LE(
+        capacity,
+        kMaxCapacity,
+        "The capacity of {} is too large",
+        kApproxMostFrequent);
+    if (capacity_ < 0) {
+      capacity_ = capacity;
+    } else {
+      VELOX_USER_CHECK_EQ(
+          capacity,
+          capacity_,
+          "The capacity of {} must be constant for all input rows",
+          kApproxMostFrequent);
+    }
+  }
+
+  static constexpr int64_t kMaxCapacity = 1 << 24;
+
+  int64_t buckets_{-1};
+  int64_t capacity_{-1};
+  DecodedVector decodedBuckets_;
+  DecodedVector decodedValue_;
+  DecodedVector decodedCapacity_;
+  DecodedVector decodedIntermediate_;
+  const SimpleVector<int64_t>* intermediateBuckets_;
+  const SimpleVector<int64_t>* intermediateCapacity_;
+  const ArrayVector* intermediateValues_;
+  const ArrayVector* intermediateCounts_;
+  const SimpleVector<T>* intermediateValueElements_;
+  const SimpleVector<int64_t>* intermediateCountElements_;
+  folly::F14FastMap<T, int64_t> batchCounts_;
+  std::vector<int32_t> counters_;
+};
+
+template <typename T>
+std::unique_ptr<exec::Aggregate> createApproxMostFrequent(
+    const TypePtr& resultType) {
+  return std::make_unique<ApproxMostFrequentAggregate<T>>(resultType);
+}
+
+bool registerApproxMostFrequent(const std::string& name) {
+  exec::AggregateFunctions().Register(
+      name,
+      [name](
+          core::AggregationNode::Step step,
+          const std::vector<TypePtr>& argTypes,
+          const TypePtr& /*resultType*/) -> std::unique_ptr<exec::Aggregate> {
+        auto isRawInput = exec::isRawInput(step);
+        auto isPartialOutput = exec::isPartialOutput(step);
+
+        TypePtr type;
+        if (isRawInput) {
+          VELOX_USER_CHECK_EQ(
+              argTypes.size(), 3, "{} takes 3 arguments", name);
+          VELOX_USER_CHECK_EQ(
+              argTypes[0]->kind(),
+              TypeKind::BIGINT,
+              "The number of buckets of {} must be BIGINT",
+              name);
+          VELOX_USER_CHECK_EQ(
+              argTypes[2]->kind(),
+              TypeKind::BIGINT,
+              "The capacity of {} must be BIGINT",
+              name);
+          type = argTypes[1];
+        } else {
+          VELOX_USER_CHECK(
+              argTypes.size() == 1 &&
+                  argTypes[0]->kind() == TypeKind::ROW &&
+                  argTypes[0]->size() == 4,
+              "Unexpected partial result type for {}",
+              name);
+          type = argTypes[0]->childAt(2)->childAt(0);
+        }
+
+        auto aggResultType = isPartialOutput
+            ? ROW({"buckets", "capacity", "values", "counts"},
+                  {BIGINT(), BIGINT(), ARRAY(type), ARRAY(BIGINT())})
+            : MAP(type, BIGINT());
+
+        switch (type->kind()) {
+          case TypeKind::TINYINT:
+            return createApproxMostFrequent<int8_t>(aggResultType);
+          case TypeKind::SMALLINT:
+            return createApproxMostFrequent<int16_t>(aggResultType);
+          case TypeKind::INTEGER:
+            return createApproxMostFrequent<int32_t>(aggResultType);
+          case TypeKind::BIGINT:
+            return createApproxMostFrequent<int64_t>(aggResultType);
+          case TypeKind::VARCHAR:
+            return createApproxMostFrequent<StringView>(aggResultType);
+          default:
+            VELOX_USER_FAIL(
+                "Unsupported input type for {} aggregation {}",
+                name,
+                type->toString());
+        }
+      });
+  return true;
+}
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerApproxMostFrequent(kApproxMostFrequent);
+
+} // namespace
+} // namespace facebook::velox::aggregate
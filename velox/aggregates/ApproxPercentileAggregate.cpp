@@ -23,90 +23,77 @@
 
 namespace facebook::velox::aggregate {
 namespace {
-int32_t serializedSize(const folly::TDigest& digest) {
-  return sizeof(size_t) + // maxSize
-      4 * sizeof(double) + // sum, count, min, max
-      sizeof(size_t) + // number of centroids
-      2 * sizeof(double) * digest.getCentroids().size();
-}
-
-template <typename TByteStream>
-void serialize(const folly::TDigest& digest, TByteStream& output) {
-  output.appendOne(digest.maxSize());
-  output.appendOne(digest.sum());
-  output.appendOne(digest.count());
-  output.appendOne(digest.min());
-  output.appendOne(digest.max());
-
-  const auto& centroids = digest.getCentroids();
-  output.appendOne(centroids.size());
-  for (const auto& centroid : centroids) {
-    output.appendOne(centroid.mean());
-    output.appendOne(centroid.weight());
-  }
-}
-
-template <typename TByteStream>
-folly::TDigest deserialize(TByteStream& input) {
-  auto maxSize = input.template read<size_t>();
-  auto sum = input.template read<double>();
-  auto count = input.template read<double>();
-  auto min = input.template read<double>();
-  auto max = input.template read<double>();
-
-  auto centroidCount = input.template read<size_t>();
-  std::vector<folly::TDigest::Centroid> centroids;
-  centroids.reserve(centroidCount);
-  for (auto i = 0; i < centroidCount; i++) {
-    auto mean = input.template read<double>();
-    auto weight = input.template read<double>();
-    centroids.emplace_back(folly::TDigest::Centroid(mean, weight));
-  }
-
-  return folly::TDigest(std::move(centroids), sum, count, max, min, maxSize);
-}
-
 template <typename T>
 folly::TDigest singleValueDigest(T v, int64_t count) {
   return folly::TDigest(
       {folly::TDigest::Centroid(v, count)}, v * count, count, v, v);
 }
 
+// The t-digest of a group. The centroids and statistics are kept in place
+// in memory from the HashStringAllocator. Raw values and the centroids of
+// intermediate results are buffered and merged into the centroids by
+// folly::TDigest only when a buffer fills up or on flush(), so that neither
+// adding values nor adding intermediate results reads or writes a
+// serialized digest.
 struct TDigestAccumulator {
   explicit TDigestAccumulator(exec::HashStringAllocator* allocator)
       : values_{exec::StlAllocator<double>(allocator)},
         largeCountValues_{exec::StlAllocator<double>(allocator)},
-        largeCounts_{exec::StlAllocator<int64_t>(allocator)} {}
+        largeCounts_{exec::StlAllocator<int64_t>(allocator)},
+        centroids_{exec::StlAllocator<folly::TDigest::Centroid>(allocator)},
+        pendingCentroids_{
+            exec::StlAllocator<folly::TDigest::Centroid>(allocator)} {}
+
+  // Returns the size of the serialized digest, which must be flushed.
+  int32_t serializedSize() const {
+    return sizeof(size_t) + // maxSize
+        4 * sizeof(double) + // sum, count, min, max
+        sizeof(size_t) + // number of centroids
+        2 * sizeof(double) * centroids_.size();
+  }
 
-  void write(
-      const folly::TDigest& digest,
-      exec::HashStringAllocator* allocator) {
-    if (!begin_) {
-      begin_ = allocator->allocate(serializedSize(digest));
+  // Writes the digest, which must be flushed, in the format of
+  // appendSerialized().
+  template <typename TByteStream>
+  void serialize(TByteStream& output) const {
+    output.appendOne(maxSize_);
+    output.appendOne(sum_);
+    output.appendOne(count_);
+    output.appendOne(min_);
+    output.appendOne(max_);
+    output.appendOne(centroids_.size());
+    for (const auto& centroid : centroids_) {
+      output.appendOne(centroid.mean());
+      output.appendOne(centroid.weight());
     }
-
-    ByteStream stream(allocator);
-    allocator->extendWrite({begin_, begin_->begin()}, stream);
-    serialize(digest, stream);
-    allocator->finishWrite(stream, 0);
   }
 
-  folly::TDigest read() const {
-    VELOX_CHECK(begin_);
-
-    ByteStream inStream;
-    exec::HashStringAllocator::prepareRead(begin_, inStream);
-    return deserialize(inStream);
+  // Returns the digest, which must be flushed.
+  folly::TDigest digest() const {
+    if (count_ == 0) {
+      return folly::TDigest();
+    }
+    return folly::TDigest(
+        std::vector<folly::TDigest::Centroid>(
+            centroids_.begin(), centroids_.end()),
+        sum_,
+        count_,
+        max_,
+        min_,
+        maxSize_);
   }
 
   bool hasValue() const {
-    return begin_ != nullptr;
+    return count_ > 0 || !values_.empty() || !largeCountValues_.empty() ||
+        !pendingCentroids_.empty();
   }
 
-  void destroy(exec::HashStringAllocator* allocator) {
-    if (begin_) {
-      allocator->free(begin_);
-    }
+  void destroy(exec::HashStringAllocator* /*allocator*/) {
+    freeVector(values_);
+    freeVector(largeCountValues_);
+    freeVector(largeCounts_);
+    freeVector(centroids_);
+    freeVector(pendingCentroids_);
   }
 
   template <typename T>
@@ -141,58 +128,131 @@ struct TDigestAccumulator {
     }
   }
 
-  void append(folly::TDigest digest, exec::HashStringAllocator* allocator) {
-    if (hasValue()) {
-      auto currentDigest = read();
-      std::vector<folly::TDigest> digests = {
-          std::move(currentDigest), std::move(digest)};
-      auto combinedDigest =
-          folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
-      write(combinedDigest, allocator);
+  // Adds the digest serialized by serialize() at the read position of
+  // 'input'. The centroids are copied to the pending centroids without
+  // building a folly::TDigest.
+  void appendSerialized(
+      InputByteStream& input,
+      exec::HashStringAllocator* allocator) {
+    input.read<size_t>(); // maxSize
+    auto sum = input.read<double>();
+    auto count = input.read<double>();
+    auto min = input.read<double>();
+    auto max = input.read<double>();
+    auto numCentroids = input.read<size_t>();
+    if (numCentroids == 0) {
+      return;
+    }
+    if (pendingCentroids_.empty()) {
+      pendingMin_ = min;
+      pendingMax_ = max;
     } else {
-      write(digest, allocator);
+      pendingMin_ = std::min(pendingMin_, min);
+      pendingMax_ = std::max(pendingMax_, max);
+    }
+    pendingSum_ += sum;
+    pendingCount_ += count;
+    for (auto i = 0; i < numCentroids; ++i) {
+      auto mean = input.read<double>();
+      auto weight = input.read<double>();
+      pendingCentroids_.emplace_back(mean, weight);
+    }
+    if (pendingCentroids_.size() >= kMaxBufferSize) {
+      flush(allocator);
     }
   }
 
-  void flush(exec::HashStringAllocator* allocator) {
+  void flush(exec::HashStringAllocator* /*allocator*/) {
+    if (values_.empty() && largeCountValues_.empty() &&
+        pendingCentroids_.empty()) {
+      return;
+    }
+    auto merged = digest();
     if (!values_.empty()) {
-      folly::TDigest digest{hasValue() ? read() : folly::TDigest()};
-      digest = digest.merge(values_);
+      merged = merged.merge(values_);
       values_.clear();
-      write(digest, allocator);
     }
 
-    if (!largeCountValues_.empty()) {
+    if (!largeCountValues_.empty() || !pendingCentroids_.empty()) {
       std::vector<folly::TDigest> digests;
-      digests.reserve(largeCountValues_.size() + 1);
+      digests.reserve(largeCountValues_.size() + 2);
       for (auto i = 0; i < largeCountValues_.size(); i++) {
         digests.emplace_back(
             singleValueDigest(largeCountValues_[i], largeCounts_[i]));
       }
-
-      if (hasValue()) {
-        digests.emplace_back(read());
+      if (!pendingCentroids_.empty()) {
+        std::sort(
+            pendingCentroids_.begin(),
+            pendingCentroids_.end(),
+            [](const auto& left, const auto& right) {
+              return left.mean() < right.mean();
+            });
+        digests.emplace_back(
+            std::vector<folly::TDigest::Centroid>(
+                pendingCentroids_.begin(), pendingCentroids_.end()),
+            pendingSum_,
+            pendingCount_,
+            pendingMax_,
+            pendingMin_,
+            maxSize_);
+      }
+      if (merged.count() > 0) {
+        digests.emplace_back(std::move(merged));
       }
 
-      auto combinedDigest =
+      merged =
           folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
       largeCountValues_.clear();
       largeCounts_.clear();
-
-      write(combinedDigest, allocator);
+      pendingCentroids_.clear();
+      pendingSum_ = 0;
+      pendingCount_ = 0;
     }
+
+    centroids_.assign(
+        merged.getCentroids().begin(), merged.getCentroids().end());
+    sum_ = merged.sum();
+    count_ = merged.count();
+    min_ = merged.min();
+    max_ = merged.max();
+    maxSize_ = merged.maxSize();
   }
 
  private:
   // Maximum number of values to accumulate before updating TDigest.
   static const size_t kMaxBufferSize = 4096;
 
-  exec::HashStringAllocator::Header* begin_{nullptr};
+  template <typename V>
+  static void freeVector(V& vector) {
+    V empty(vector.get_allocator());
+    vector.swap(empty);
+  }
 
   std::vector<double, exec::StlAllocator<double>> values_;
 
   std::vector<double, exec::StlAllocator<double>> largeCountValues_;
   std::vector<int64_t, exec::StlAllocator<int64_t>> largeCounts_;
+
+  // The merged digest.
+  std::vector<
+      folly::TDigest::Centroid,
+      exec::StlAllocator<folly::TDigest::Centroid>>
+      centroids_;
+  size_t maxSize_{100};
+  double sum_{0};
+  double count_{0};
+  double min_{0};
+  double max_{0};
+
+  // Centroids and statistics of intermediate results not yet merged.
+  std::vector<
+      folly::TDigest::Centroid,
+      exec::StlAllocator<folly::TDigest::Centroid>>
+      pendingCentroids_;
+  double pendingSum_{0};
+  double pendingCount_{0};
+  double pendingMin_{0};
+  double pendingMax_{0};
 };
 
 // The following variations are possible:
@@ -243,10 +303,11 @@ class ApproxPercentileAggregate : public exec::Aggregate {
         groups,
         numGroups,
         flatResult,
-        [&](const folly::TDigest& digest,
+        [&](const TDigestAccumulator& accumulator,
             FlatVector<T>* result,
             vector_size_t index) {
-          result->set(index, (T)digest.estimateQuantile(percentile_));
+          result->set(
+              index, (T)accumulator.digest().estimateQuantile(percentile_));
         });
   }
 
@@ -259,15 +320,16 @@ class ApproxPercentileAggregate : public exec::Aggregate {
         groups,
         numGroups,
         flatResult,
-        [&](const folly::TDigest& digest,
+        [&](const TDigestAccumulator& accumulator,
             FlatVector<StringView>* result,
             vector_size_t index) {
-          auto size = sizeof(double) /*percentile*/ + serializedSize(digest);
+          auto size =
+              sizeof(double) /*percentile*/ + accumulator.serializedSize();
           Buffer* buffer = flatResult->getBufferWithSpace(size);
           StringView serialized(buffer->as<char>() + buffer->size(), size);
           OutputByteStream stream(buffer->asMutable<char>() + buffer->size());
           stream.appendOne(percentile_);
-          serialize(digest, stream);
+          accumulator.serialize(stream);
           buffer->setSize(buffer->size() + size);
           result->setNoCopy(index, serialized);
         });
@@ -331,10 +393,9 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       InputByteStream stream(serialized.data());
       auto percentile = stream.read<double>();
       checkSetPercentile(percentile);
-      auto digest = deserialize(stream);
 
       auto accumulator = value<TDigestAccumulator>(groups[row]);
-      accumulator->append(std::move(digest), allocator_);
+      accumulator->appendSerialized(stream, allocator_);
     });
   }
 
@@ -387,12 +448,6 @@ class ApproxPercentileAggregate : public exec::Aggregate {
     decodedDigest_.decode(*args[0], rows, true);
     auto accumulator = value<TDigestAccumulator>(group);
 
-    std::vector<folly::TDigest> digests;
-    digests.reserve(rows.end() + 1);
-    if (accumulator->hasValue()) {
-      digests.emplace_back(accumulator->read());
-    }
-
     rows.applyToSelected([&](auto row) {
       if (decodedDigest_.isNullAt(row)) {
         return;
@@ -402,15 +457,8 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       InputByteStream stream(serialized.data());
       auto percentile = stream.read<double>();
       checkSetPercentile(percentile);
-
-      digests.emplace_back(deserialize(stream));
+      accumulator->appendSerialized(stream, allocator_);
     });
-
-    if (!digests.empty()) {
-      auto digest =
-          folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
-      accumulator->write(digest, allocator_);
-    }
   }
 
  private:
@@ -438,8 +486,7 @@ class ApproxPercentileAggregate : public exec::Aggregate {
         if (rawNulls) {
           bits::clearBit(rawNulls, i);
         }
-        auto digest = accumulator->read();
-        extractFunction(digest, result, i);
+        extractFunction(*accumulator, result, i);
       }
     }
   }
@@ -63,9 +63,9 @@ class ArrayAggAggregate : public exec::Aggregate {
 
       auto& values = value<ArrayAccumulator>(groups[i])->elements;
       auto arraySize = values.size();
-      ValueListReader reader(values);
-      for (auto index = 0; index < arraySize; ++index) {
-        reader.next(*elements, offset + index);
+      if (arraySize) {
+        ValueListReader reader(values);
+        reader.read(*elements, offset);
       }
       vector->setOffsetAndSize(i, offset, arraySize);
       offset += arraySize;
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/aggregates/AggregateNames.h"
+#include "velox/aggregates/AggregationHook.h"
 #include "velox/exec/Aggregate.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/DecodedVector.h"
@@ -99,7 +100,12 @@ class AverageAggregate : public exec::Aggregate {
       char** groups,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
+    if (mayPushdown) {
+      pushdown(selectedGroups(groups, rows, pushdownGroups_), rows, args[0]);
+      return;
+    }
+
     decodedRaw_.decode(*args[0], rows);
     if (decodedRaw_.isConstantMapping()) {
       if (!decodedRaw_.isNullAt(0)) {
@@ -130,7 +136,13 @@ class AverageAggregate : public exec::Aggregate {
       char* group,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
+    if (mayPushdown) {
+      pushdown(
+          repeatGroup(group, args[0]->size(), pushdownGroups_), rows, args[0]);
+      return;
+    }
+
     decodedRaw_.decode(*args[0], rows);
 
     if (decodedRaw_.isConstantMapping()) {
@@ -265,6 +277,17 @@ class AverageAggregate : public exec::Aggregate {
     return exec::Aggregate::value<SumCount>(group);
   }
 
+  // Adds the values of the not yet loaded 'arg' to the accumulators while
+  // loading it. 'groups' has the group of each selected row in order.
+  void pushdown(
+      char** groups,
+      const SelectivityVector& rows,
+      const VectorPtr& arg) {
+    SumCountHook<T, SumCount> hook(
+        offset_, nullByte_, nullMask_, groups, &numNulls_);
+    pushdownToHook(hook, rows, arg, pushdownCustomIndices_);
+  }
+
   DecodedVector decodedRaw_;
   DecodedVector decodedPartial_;
 };
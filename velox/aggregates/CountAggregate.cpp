@@ -50,12 +50,17 @@ class CountAggregate : public SimpleNumericAggregate<bool, int64_t, int64_t> {
       char** groups,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
     if (args.empty()) {
       rows.applyToSelected([&](vector_size_t i) { addToGroup(groups[i], 1); });
       return;
     }
 
+    if (mayPushdown) {
+      BaseAggregate::pushdown<CountHook>(groups, rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
     if (decoded.isConstantMapping()) {
       if (!decoded.isNullAt(0)) {
@@ -86,12 +91,17 @@ class CountAggregate : public SimpleNumericAggregate<bool, int64_t, int64_t> {
       char* group,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
     if (args.empty()) {
       addToGroup(group, rows.size());
       return;
     }
 
+    if (mayPushdown) {
+      BaseAggregate::pushdownOneGroup<CountHook>(group, rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
     if (decoded.isConstantMapping()) {
       if (!decoded.isNullAt(0)) {
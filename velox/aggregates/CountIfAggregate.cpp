@@ -15,6 +15,7 @@
  */
 
 #include "velox/aggregates/AggregateNames.h"
+#include "velox/aggregates/AggregationHook.h"
 #include "velox/exec/Aggregate.h"
 #include "velox/vector/DecodedVector.h"
 #include "velox/vector/FlatVector.h"
@@ -61,7 +62,12 @@ class CountIfAggregate : public exec::Aggregate {
       char** groups,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
+    if (mayPushdown) {
+      pushdown(selectedGroups(groups, rows, pushdownGroups_), rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
 
     if (decoded.isConstantMapping()) {
@@ -114,7 +120,13 @@ class CountIfAggregate : public exec::Aggregate {
       char* group,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
+    if (mayPushdown) {
+      pushdown(
+          repeatGroup(group, args[0]->size(), pushdownGroups_), rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
 
     // Constant mapping - check once and add number of selected rows if true.
@@ -162,6 +174,16 @@ class CountIfAggregate : public exec::Aggregate {
   inline void addToGroup(char* group, int64_t numTrue) {
     *value<int64_t>(group) += numTrue;
   }
+
+  // Counts the true values of the not yet loaded 'arg' while loading it.
+  // 'groups' has the group of each selected row in order.
+  void pushdown(
+      char** groups,
+      const SelectivityVector& rows,
+      const VectorPtr& arg) {
+    CountIfHook hook(offset_, nullByte_, nullMask_, groups, &numNulls_);
+    pushdownToHook(hook, rows, arg, pushdownCustomIndices_);
+  }
 };
 
 bool registerCountIfAggregate(const std::string& name) {
@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/aggregates/AggregateNames.h"
+#include "velox/exec/Aggregate.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::aggregate {
+
+namespace {
+
+// Indices into Row Vector, in which we store necessary accumulator data.
+constexpr int32_t kCountIdx{0};
+constexpr int32_t kMeanXIdx{1};
+constexpr int32_t kMeanYIdx{2};
+constexpr int32_t kC2Idx{3};
+constexpr int32_t kM2XIdx{4};
+constexpr int32_t kM2YIdx{5};
+
+// Structure storing the count, the means and the co-moment of (x, y) pairs.
+// If 'kWithM2' is true, also keeps the second moments of x and y, which are
+// needed for the correlation.
+template <bool kWithM2>
+struct CovarianceAccumulator {
+  int64_t count() const {
+    return count_;
+  }
+
+  double meanX() const {
+    return meanX_;
+  }
+
+  double meanY() const {
+    return meanY_;
+  }
+
+  double c2() const {
+    return c2_;
+  }
+
+  double m2X() const {
+    return m2X_;
+  }
+
+  double m2Y() const {
+    return m2Y_;
+  }
+
+  void update(double x, double y) {
+    count_ += 1;
+    double deltaX = x - meanX_;
+    meanX_ += deltaX / count_;
+    double deltaY = y - meanY_;
+    meanY_ += deltaY / count_;
+    c2_ += deltaX * (y - meanY_);
+    if constexpr (kWithM2) {
+      m2X_ += deltaX * (x - meanX_);
+      m2Y_ += deltaY * (y - meanY_);
+    }
+  }
+
+  inline void merge(const CovarianceAccumulator& other) {
+    merge(
+        other.count(),
+        other.meanX(),
+        other.meanY(),
+        other.c2(),
+        other.m2X(),
+        other.m2Y());
+  }
+
+  void merge(
+      int64_t countOther,
+      double meanXOther,
+      double meanYOther,
+      double c2Other,
+      double m2XOther,
+      double m2YOther) {
+    if (countOther == 0) {
+      return;
+    }
+    int64_t newCount = countOther + count_;
+    double deltaX = meanXOther - meanX_;
+    double deltaY = meanYOther - meanY_;
+    double weight = (double)countOther * count_ / newCount;
+    c2_ += c2Other + deltaX * deltaY * weight;
+    if constexpr (kWithM2) {
+      m2X_ += m2XOther + deltaX * deltaX * weight;
+      m2Y_ += m2YOther + deltaY * deltaY * weight;
+    }
+    meanX_ += deltaX * countOther / newCount;
+    meanY_ += deltaY * countOther / newCount;
+    count_ = newCount;
+  }
+
+ private:
+  int64_t count_{0};
+  double meanX_{0};
+  double meanY_{0};
+  double c2_{0};
+  double m2X_{0};
+  double m2Y_{0};
+};
+
+// Number of independent partial sums kept when reducing a word of 64 pairs.
+// Consecutive additions do not depend on each other, so the compiler can keep
+// the partial sums in SIMD registers.
+constexpr int32_t kNumLanes = 8;
+
+template <typename T>
+double sumWord(const T* values) {
+  double sums[kNumLanes] = {};
+  for (auto i = 0; i < 64; i += kNumLanes) {
+    for (auto j = 0; j < kNumLanes; ++j) {
+      sums[j] += values[i + j];
+    }
+  }
+  double sum = 0;
+  for (auto j = 0; j < kNumLanes; ++j) {
+    sum += sums[j];
+  }
+  return sum;
+}
+
+// Merges 64 consecutive pairs of 'x' and 'y' into 'accData'. The means of the
+// pairs are computed first, then their moments around these means, and the
+// result is combined with 'accData' with the parallel formula.
+template <bool kWithM2, typename T>
+void updateWord(
+    CovarianceAccumulator<kWithM2>& accData,
+    const T* x,
+    const T* y) {
+  double meanX = sumWord(x) / 64;
+  double meanY = sumWord(y) / 64;
+  double c2s[kNumLanes] = {};
+  double m2Xs[kNumLanes] = {};
+  double m2Ys[kNumLanes] = {};
+  for (auto i = 0; i < 64; i += kNumLanes) {
+    for (auto j = 0; j < kNumLanes; ++j) {
+      double deltaX = x[i + j] - meanX;
+      double deltaY = y[i + j] - meanY;
+      c2s[j] += deltaX * deltaY;
+      if constexpr (kWithM2) {
+        m2Xs[j] += deltaX * deltaX;
+        m2Ys[j] += deltaY * deltaY;
+      }
+    }
+  }
+  double c2 = 0;
+  double m2X = 0;
+  double m2Y = 0;
+  for (auto j = 0; j < kNumLanes; ++j) {
+    c2 += c2s[j];
+    m2X += m2Xs[j];
+    m2Y += m2Ys[j];
+  }
+  accData.merge(64, meanX, meanY, c2, m2X, m2Y);
+}
+
+// 'Population covariance' result accessor.
+struct CovarPopResultAccessor {
+  template <typename TAccumulator>
+  static bool hasResult(const TAccumulator& accData) {
+    return accData.count() > 0;
+  }
+
+  template <typename TAccumulator>
+  static double result(const TAccumulator& accData) {
+    return accData.c2() / accData.count();
+  }
+};
+
+// 'Sample covariance' result accessor.
+struct CovarSampResultAccessor {
+  template <typename TAccumulator>
+  static bool hasResult(const TAccumulator& accData) {
+    return accData.count() >= 2;
+  }
+
+  template <typename TAccumulator>
+  static double result(const TAccumulator& accData) {
+    return accData.c2() / (accData.count() - 1);
+  }
+};
+
+// 'Correlation' result accessor. There is no result if either input is
+// constant.
+struct CorrResultAccessor {
+  template <typename TAccumulator>
+  static bool hasResult(const TAccumulator& accData) {
+    return accData.count() >= 2 && accData.m2X() > 0 && accData.m2Y() > 0;
+  }
+
+  template <typename TAccumulator>
+  static double result(const TAccumulator& accData) {
+    return accData.c2() / std::sqrt(accData.m2X() * accData.m2Y());
+  }
+};
+
+// Covariance-based aggregation over (y, x) pairs. Pairs where either is null
+// are ignored.
+// Partial aggregation produces a (count, mean_x, mean_y, c2) struct, with
+// m2_x and m2_y added for the correlation.
+// Final aggregation takes the struct and returns a double.
+// T is the input type for partial aggregation. Not used for final aggregation.
+template <typename T, bool kWithM2, typename TResultAccessor>
+class CovarianceAggregate : public exec::Aggregate {
+  using Accumulator = CovarianceAccumulator<kWithM2>;
+
+ public:
+  explicit CovarianceAggregate(TypePtr resultType)
+      : exec::Aggregate(resultType) {}
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(Accumulator);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    setAllNulls(groups, indices);
+    for (auto i : indices) {
+      new (groups[i] + offset_) Accumulator();
+    }
+  }
+
+  void finalize(char** /* unused */, int32_t /* unused */) override {}
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto rowVector = (*result)->as<RowVector>();
+    rowVector->resize(numGroups);
+    uint64_t* rawNulls = getRawNulls(rowVector);
+
+    auto rawCounts = rowVector->childAt(kCountIdx)
+                         ->asFlatVector<int64_t>()
+                         ->mutableRawValues();
+    auto rawMeanXs = rawDoubles(rowVector, kMeanXIdx);
+    auto rawMeanYs = rawDoubles(rowVector, kMeanYIdx);
+    auto rawC2s = rawDoubles(rowVector, kC2Idx);
+    double* rawM2Xs = nullptr;
+    double* rawM2Ys = nullptr;
+    if constexpr (kWithM2) {
+      rawM2Xs = rawDoubles(rowVector, kM2XIdx);
+      rawM2Ys = rawDoubles(rowVector, kM2YIdx);
+    }
+    for (auto i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        rowVector->setNull(i, true);
+      } else {
+        clearNull(rawNulls, i);
+        auto* accData = accumulator(group);
+        rawCounts[i] = accData->count();
+        rawMeanXs[i] = accData->meanX();
+        rawMeanYs[i] = accData->meanY();
+        rawC2s[i] = accData->c2();
+        if constexpr (kWithM2) {
+          rawM2Xs[i] = accData->m2X();
+          rawM2Ys[i] = accData->m2Y();
+        }
+      }
+    }
+  }
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto vector = (*result)->as<FlatVector<double>>();
+    VELOX_CHECK(vector);
+    vector->resize(numGroups);
+    uint64_t* rawNulls = getRawNulls(vector);
+
+    double* rawValues = vector->mutableRawValues();
+    for (int32_t i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        vector->setNull(i, true);
+      } else {
+        auto* accData = accumulator(group);
+        if (TResultAccessor::hasResult(*accData)) {
+          clearNull(rawNulls, i);
+          rawValues[i] = TResultAccessor::result(*accData);
+        } else {
+          vector->setNull(i, true);
+        }
+      }
+    }
+  }
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodedY_.decode(*args[0], rows);
+    decodedX_.decode(*args[1], rows);
+    if (decodedX_.mayHaveNulls() || decodedY_.mayHaveNulls()) {
+      rows.applyToSelected([&](vector_size_t i) {
+        if (decodedX_.isNullAt(i) || decodedY_.isNullAt(i)) {
+          return;
+        }
+        updateNonNullValue(
+            groups[i], decodedX_.valueAt<T>(i), decodedY_.valueAt<T>(i));
+      });
+    } else {
+      rows.applyToSelected([&](vector_size_t i) {
+        updateNonNullValue(
+            groups[i], decodedX_.valueAt<T>(i), decodedY_.valueAt<T>(i));
+      });
+    }
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodedY_.decode(*args[0], rows);
+    decodedX_.decode(*args[1], rows);
+
+    if (decodedX_.isIdentityMapping() && decodedY_.isIdentityMapping()) {
+      if (updateFlat(*accumulator(group), rows)) {
+        exec::Aggregate::clearNull(group);
+      }
+    } else {
+      rows.applyToSelected([&](vector_size_t i) {
+        if (decodedX_.isNullAt(i) || decodedY_.isNullAt(i)) {
+          return;
+        }
+        updateNonNullValue(
+            group, decodedX_.valueAt<T>(i), decodedY_.valueAt<T>(i));
+      });
+    }
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /* mayPushdown */) override {
+    decodePartial(args[0], rows);
+    rows.applyToSelected([&](vector_size_t i) {
+      if (!decodedPartial_.isNullAt(i)) {
+        mergePartial(groups[i], decodedPartial_.index(i));
+      }
+    });
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /* mayPushdown */) override {
+    decodePartial(args[0], rows);
+    rows.applyToSelected([&](vector_size_t i) {
+      if (!decodedPartial_.isNullAt(i)) {
+        mergePartial(group, decodedPartial_.index(i));
+      }
+    });
+  }
+
+ private:
+  inline Accumulator* accumulator(char* group) {
+    return exec::Aggregate::value<Accumulator>(group);
+  }
+
+  static double* rawDoubles(RowVector* rowVector, int32_t index) {
+    return rowVector->childAt(index)
+        ->asFlatVector<double>()
+        ->mutableRawValues();
+  }
+
+  inline void updateNonNullValue(char* group, T x, T y) {
+    exec::Aggregate::clearNull(group);
+    accumulator(group)->update(x, y);
+  }
+
+  // Decodes the partial results in 'arg' into 'decodedPartial_' and sets
+  // 'partialCounts_' and 'partialMoments_' to the fields of its base.
+  void decodePartial(const VectorPtr& arg, const SelectivityVector& rows) {
+    decodedPartial_.decode(*arg, rows);
+    auto base = decodedPartial_.base()->as<RowVector>();
+    partialCounts_ = base->childAt(kCountIdx)->as<SimpleVector<int64_t>>();
+    for (auto i = kMeanXIdx; i <= (kWithM2 ? kM2YIdx : kC2Idx); ++i) {
+      partialMoments_[i] = base->childAt(i)->as<SimpleVector<double>>();
+    }
+  }
+
+  // Merges the partial at 'index' of the base of 'decodedPartial_' into
+  // 'group'.
+  void mergePartial(char* group, vector_size_t index) {
+    exec::Aggregate::clearNull(group);
+    accumulator(group)->merge(
+        partialCounts_->valueAt(index),
+        partialMoments_[kMeanXIdx]->valueAt(index),
+        partialMoments_[kMeanYIdx]->valueAt(index),
+        partialMoments_[kC2Idx]->valueAt(index),
+        kWithM2 ? partialMoments_[kM2XIdx]->valueAt(index) : 0,
+        kWithM2 ? partialMoments_[kM2YIdx]->valueAt(index) : 0);
+  }
+
+  // Adds the selected pairs of flat 'decodedX_' and 'decodedY_' where neither
+  // is null to 'accData'. Words of 64 rows where all pairs qualify are merged
+  // with updateWord(), the other pairs one at a time. Returns false if no
+  // pair qualifies.
+  bool updateFlat(Accumulator& accData, const SelectivityVector& rows) {
+    const T* x = decodedX_.data<T>();
+    const T* y = decodedY_.data<T>();
+    const uint64_t* nullsX = decodedX_.nulls();
+    const uint64_t* nullsY = decodedY_.nulls();
+    const uint64_t* selected = rows.asRange().bits();
+    bool hasValue = false;
+    auto updateBits = [&](int32_t index, uint64_t word) {
+      if (nullsX) {
+        word &= nullsX[index];
+      }
+      if (nullsY) {
+        word &= nullsY[index];
+      }
+      if (!word) {
+        return;
+      }
+      hasValue = true;
+      auto offset = index * 64;
+      if (word == bits::kNotNull64) {
+        updateWord(accData, x + offset, y + offset);
+        return;
+      }
+      do {
+        auto row = offset + __builtin_ctzll(word);
+        accData.update(x[row], y[row]);
+        word &= word - 1;
+      } while (word);
+    };
+    bits::forEachWord(
+        rows.begin(),
+        rows.end(),
+        [&](int32_t index, uint64_t mask) {
+          updateBits(index, selected[index] & mask);
+        },
+        [&](int32_t index) { updateBits(index, selected[index]); });
+    return hasValue;
+  }
+
+  DecodedVector decodedX_;
+  DecodedVector decodedY_;
+  DecodedVector decodedPartial_;
+  const SimpleVector<int64_t>* partialCounts_{nullptr};
+  const SimpleVector<double>* partialMoments_[kM2YIdx + 1]{};
+};
+
+template <typename T>
+using CovarPopAggregate = CovarianceAggregate<T, false, CovarPopResultAccessor>;
+
+template <typename T>
+using CovarSampAggregate =
+    CovarianceAggregate<T, false, CovarSampResultAccessor>;
+
+template <typename T>
+using CorrAggregate = CovarianceAggregate<T, true, CorrResultAccessor>;
+
+// Registration code
+
+template <bool kWithM2>
+TypePtr intermediateType() {
+  if constexpr (kWithM2) {
+    return ROW(
+        {"count", "mean_x", "mean_y", "c2", "m2_x", "m2_y"},
+        {BIGINT(), DOUBLE(), DOUBLE(), DOUBLE(), DOUBLE(), DOUBLE()});
+  } else {
+    return ROW(
+        {"count", "mean_x", "mean_y", "c2"},
+        {BIGINT(), DOUBLE(), DOUBLE(), DOUBLE()});
+  }
+}
+
+template <template <typename TInput> class TClass, bool kWithM2>
+bool registerCovarianceAggregate(const std::string& name) {
+  exec::AggregateFunctions().Register(
+      name,
+      [name](
+          core::AggregationNode::Step step,
+          const std::vector<TypePtr>& argTypes,
+          const TypePtr& /*resultType*/) -> std::unique_ptr<exec::Aggregate> {
+        TypePtr resultType;
+        if (exec::isPartialOutput(step)) {
+          resultType = intermediateType<kWithM2>();
+        } else {
+          resultType = DOUBLE();
+        }
+        if (exec::isRawInput(step)) {
+          VELOX_CHECK_EQ(
+              argTypes.size(), 2, "{} takes exactly two arguments", name);
+          VELOX_CHECK_EQ(
+              argTypes[0]->kind(),
+              argTypes[1]->kind(),
+              "{} arguments must have the same type",
+              name);
+          switch (argTypes[0]->kind()) {
+            case TypeKind::REAL:
+              return std::make_unique<TClass<float>>(resultType);
+            case TypeKind::DOUBLE:
+              return std::make_unique<TClass<double>>(resultType);
+            default:
+              VELOX_FAIL(
+                  "Unknown input type for {} aggregation {}",
+                  name,
+                  argTypes[0]->kindName());
+              return nullptr;
+          }
+        } else {
+          VELOX_CHECK_EQ(
+              argTypes.size(), 1, "{} takes exactly one argument", name);
+          VELOX_CHECK(
+              argTypes[0]->kindEquals(intermediateType<kWithM2>()),
+              "Input type for final {} aggregation must be {}",
+              name,
+              intermediateType<kWithM2>()->toString());
+          return std::make_unique<TClass<double>>(resultType);
+        }
+      });
+  return true;
+}
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerCovarianceAggregate<CorrAggregate, true>(kCorr);
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerCovarianceAggregate<CovarPopAggregate, false>(kCovarPop);
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerCovarianceAggregate<CovarSampAggregate, false>(kCovarSamp);
+
+} // namespace
+} // namespace facebook::velox::aggregate
@@ -71,11 +71,11 @@ class MapAggAggregate : public exec::Aggregate {
 
       auto accumulator = value<MapAccumulator>(group);
       auto mapSize = accumulator->keys.size();
-      ValueListReader keysReader(accumulator->keys);
-      ValueListReader valuesReader(accumulator->values);
-      for (auto index = 0; index < mapSize; ++index) {
-        keysReader.next(*mapKeys, offset + index);
-        valuesReader.next(*mapValues, offset + index);
+      if (mapSize) {
+        ValueListReader keysReader(accumulator->keys);
+        ValueListReader valuesReader(accumulator->values);
+        keysReader.read(*mapKeys, offset);
+        valuesReader.read(*mapValues, offset);
       }
       mapVector->setOffsetAndSize(i, offset, mapSize);
       offset += mapSize;
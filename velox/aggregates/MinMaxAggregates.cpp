@@ -134,6 +134,11 @@ class MaxAggregate : public MinMaxAggregate<T, ResultType> {
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
       bool mayPushdown) override {
+    if (mayPushdown && std::is_same<T, ResultType>::value) {
+      BaseAggregate::template pushdownOneGroup<MinMaxHook<T, false>>(
+          group, rows, args[0]);
+      return;
+    }
     BaseAggregate::updateOneGroup(
         group,
         rows,
@@ -208,6 +213,11 @@ class MinAggregate : public MinMaxAggregate<T, ResultType> {
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
       bool mayPushdown) override {
+    if (mayPushdown && std::is_same<T, ResultType>::value) {
+      BaseAggregate::template pushdownOneGroup<MinMaxHook<T, true>>(
+          group, rows, args[0]);
+      return;
+    }
     BaseAggregate::updateOneGroup(
         group,
         rows,
@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include "velox/aggregates/AggregateNames.h"
 #include "velox/exec/Aggregate.h"
+#include "velox/exec/HashStringAllocator.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/DecodedVector.h"
 #include "velox/vector/FlatVector.h"
@@ -334,7 +336,8 @@ template <typename T, typename U>
 class MaxByAggregate : public MinMaxByAggregate<T, U> {
  public:
   explicit MaxByAggregate(TypePtr resultType)
-      : MinMaxByAggregate<T, U>(resultType, std::numeric_limits<U>::min()) {}
+      : MinMaxByAggregate<T, U>(resultType, std::numeric_limits<U>::lowest()) {
+  }
 
   void addRawInput(
       char** groups,
@@ -432,6 +435,292 @@ class MinByAggregate : public MinMaxByAggregate<T, U> {
   }
 };
 
+// The largest n accepted by min_by(x, y, n) and max_by(x, y, n).
+constexpr int64_t kMaxTopN = 10'000;
+
+// MinMaxByNAggregate implements min_by(x, y, n) and max_by(x, y, n). These
+// return an array of the values of X associated with the n smallest/largest
+// values of Y, in ascending/descending order of Y. Each group keeps its best
+// n pairs in a heap in memory from the HashStringAllocator. The top of the
+// heap is the pair that is replaced first. Partial aggregation produces a
+// ROW(n, array(X), array(Y)) struct with the pairs in heap order. 'Compare'
+// is std::less for min_by and std::greater for max_by.
+template <typename T, typename U, typename Compare>
+class MinMaxByNAggregate : public exec::Aggregate {
+ public:
+  explicit MinMaxByNAggregate(TypePtr resultType)
+      : exec::Aggregate(resultType) {}
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(Accumulator);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    exec::Aggregate::setAllNulls(groups, indices);
+    for (auto i : indices) {
+      new (groups[i] + offset_) Accumulator(allocator_);
+    }
+  }
+
+  void destroy(folly::Range<char**> groups) override {
+    for (auto group : groups) {
+      accumulator(group)->~Accumulator();
+    }
+  }
+
+  void finalize(char** /* unused */, int32_t /* unused */) override {}
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto vector = (*result)->as<ArrayVector>();
+    VELOX_CHECK(vector);
+    vector->resize(numGroups);
+    auto values = vector->elements()->asFlatVector<T>();
+    values->resize(countEntries(groups, numGroups));
+    uint64_t* rawNulls = getRawNulls(vector);
+
+    vector_size_t offset = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        vector->setNull(i, true);
+        vector->setOffsetAndSize(i, offset, 0);
+        continue;
+      }
+      clearNull(rawNulls, i);
+      auto& heap = accumulator(group)->heap;
+      sorted_.assign(heap.begin(), heap.end());
+      std::sort_heap(sorted_.begin(), sorted_.end(), compareEntries);
+      for (auto j = 0; j < sorted_.size(); ++j) {
+        if (sorted_[j].valueIsNull) {
+          values->setNull(offset + j, true);
+        } else {
+          values->set(offset + j, sorted_[j].value);
+        }
+      }
+      vector->setOffsetAndSize(i, offset, sorted_.size());
+      offset += sorted_.size();
+    }
+  }
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto rowVector = (*result)->as<RowVector>();
+    VELOX_CHECK(rowVector);
+    rowVector->resize(numGroups);
+    auto nVector = rowVector->childAt(0)->asFlatVector<int64_t>();
+    auto valueArrays = rowVector->childAt(1)->as<ArrayVector>();
+    auto comparisonArrays = rowVector->childAt(2)->as<ArrayVector>();
+    nVector->resize(numGroups);
+    valueArrays->resize(numGroups);
+    comparisonArrays->resize(numGroups);
+    auto numEntries = countEntries(groups, numGroups);
+    auto values = valueArrays->elements()->asFlatVector<T>();
+    auto comparisons = comparisonArrays->elements()->asFlatVector<U>();
+    values->resize(numEntries);
+    comparisons->resize(numEntries);
+    uint64_t* rawNulls = getRawNulls(rowVector);
+
+    vector_size_t offset = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      auto entries = accumulator(group);
+      if (isNull(group)) {
+        rowVector->setNull(i, true);
+      } else {
+        clearNull(rawNulls, i);
+      }
+      nVector->set(i, entries->n);
+      auto& heap = entries->heap;
+      for (auto j = 0; j < heap.size(); ++j) {
+        if (heap[j].valueIsNull) {
+          values->setNull(offset + j, true);
+        } else {
+          values->set(offset + j, heap[j].value);
+        }
+        comparisons->set(offset + j, heap[j].comparison);
+      }
+      valueArrays->setOffsetAndSize(i, offset, heap.size());
+      comparisonArrays->setOffsetAndSize(i, offset, heap.size());
+      offset += heap.size();
+    }
+  }
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addRaw([&](vector_size_t row) { return groups[row]; }, rows, args);
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addIntermediate(
+        [&](vector_size_t row) { return groups[row]; }, rows, args);
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addRaw([&](vector_size_t /*row*/) { return group; }, rows, args);
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addIntermediate([&](vector_size_t /*row*/) { return group; }, rows, args);
+  }
+
+ private:
+  struct Entry {
+    U comparison;
+    T value;
+    bool valueIsNull;
+  };
+
+  struct Accumulator {
+    explicit Accumulator(exec::HashStringAllocator* allocator)
+        : heap{exec::StlAllocator<Entry>(allocator)} {}
+
+    // The n of the group, 0 until the first value is added.
+    int64_t n{0};
+    std::vector<Entry, exec::StlAllocator<Entry>> heap;
+  };
+
+  // Orders the entries so that the top of the heap is the entry that is
+  // replaced first and sort_heap() returns the result order.
+  static bool compareEntries(const Entry& left, const Entry& right) {
+    return Compare()(left.comparison, right.comparison);
+  }
+
+  Accumulator* accumulator(char* group) {
+    return value<Accumulator>(group);
+  }
+
+  vector_size_t countEntries(char** groups, int32_t numGroups) {
+    vector_size_t count = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      count += accumulator(groups[i])->heap.size();
+    }
+    return count;
+  }
+
+  static int64_t checkN(int64_t n) {
+    VELOX_USER_CHECK_GT(
+        n, 0, "third argument of min_by/max_by must be positive");
+    VELOX_USER_CHECK_LE(
+        n,
+        kMaxTopN,
+        "third argument of min_by/max_by must be less than or equal to {}",
+        kMaxTopN);
+    return n;
+  }
+
+  void addEntry(char* group, int64_t n, const Entry& entry) {
+    clearNull(group);
+    auto entries = accumulator(group);
+    if (entries->n == 0) {
+      entries->n = checkN(n);
+    }
+    auto& heap = entries->heap;
+    if (heap.size() < entries->n) {
+      heap.push_back(entry);
+      std::push_heap(heap.begin(), heap.end(), compareEntries);
+    } else if (compareEntries(entry, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), compareEntries);
+      heap.back() = entry;
+      std::push_heap(heap.begin(), heap.end(), compareEntries);
+    }
+  }
+
+  template <typename GetGroup>
+  void addRaw(
+      GetGroup getGroup,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args) {
+    decodedValue_.decode(*args[0], rows);
+    decodedComparison_.decode(*args[1], rows);
+    decodedN_.decode(*args[2], rows);
+    const bool isBigint = args[2]->typeKind() == TypeKind::BIGINT;
+    rows.applyToSelected([&](vector_size_t i) {
+      if (decodedComparison_.isNullAt(i)) {
+        return;
+      }
+      VELOX_USER_CHECK(
+          !decodedN_.isNullAt(i),
+          "third argument of min_by/max_by must not be null");
+      auto n = isBigint ? decodedN_.valueAt<int64_t>(i)
+                        : decodedN_.valueAt<int32_t>(i);
+      bool valueIsNull = decodedValue_.isNullAt(i);
+      addEntry(
+          getGroup(i),
+          n,
+          {decodedComparison_.valueAt<U>(i),
+           valueIsNull ? T() : decodedValue_.valueAt<T>(i),
+           valueIsNull});
+    });
+  }
+
+  template <typename GetGroup>
+  void addIntermediate(
+      GetGroup getGroup,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args) {
+    decodedValue_.decode(*args[0], rows);
+    auto base = decodedValue_.base()->as<RowVector>();
+    VELOX_CHECK(base);
+    auto nVector = base->childAt(0)->asFlatVector<int64_t>();
+    auto valueArrays = base->childAt(1)->as<ArrayVector>();
+    auto comparisonArrays = base->childAt(2)->as<ArrayVector>();
+    auto values = valueArrays->elements()->asFlatVector<T>();
+    auto comparisons =
+        comparisonArrays->elements()->asFlatVector<U>();
+    rows.applyToSelected([&](vector_size_t i) {
+      if (decodedValue_.isNullAt(i)) {
+        return;
+      }
+      auto index = decodedValue_.index(i);
+      auto group = getGroup(i);
+      auto n = nVector->valueAt(index);
+      auto valueOffset = valueArrays->offsetAt(index);
+      auto comparisonOffset = comparisonArrays->offsetAt(index);
+      auto size = comparisonArrays->sizeAt(index);
+      for (auto j = 0; j < size; ++j) {
+        bool valueIsNull = values->isNullAt(valueOffset + j);
+        addEntry(
+            group,
+            n,
+            {comparisons->valueAt(comparisonOffset + j),
+             valueIsNull ? T() : values->valueAt(valueOffset + j),
+             valueIsNull});
+      }
+    });
+  }
+
+  DecodedVector decodedValue_;
+  DecodedVector decodedComparison_;
+  DecodedVector decodedN_;
+
+  // Scratch copy of a heap sorted for output.
+  std::vector<Entry> sorted_;
+};
+
+template <typename T, typename U>
+using MaxByNAggregate = MinMaxByNAggregate<T, U, std::greater<U>>;
+
+template <typename T, typename U>
+using MinByNAggregate = MinMaxByNAggregate<T, U, std::less<U>>;
+
 template <template <typename U, typename V> class T, typename W>
 std::unique_ptr<exec::Aggregate> create(
     TypePtr resultType,
@@ -456,7 +745,66 @@ std::unique_ptr<exec::Aggregate> create(
   }
 }
 
+// Returns true if 'argTypes' are the arguments of min_by(x, y, n) or
+// max_by(x, y, n) or their intermediate results.
+bool isTopN(bool isRawInput, const std::vector<TypePtr>& argTypes) {
+  if (isRawInput) {
+    return argTypes.size() == 3;
+  }
+  return argTypes.size() == 1 && argTypes[0]->kind() == TypeKind::ROW &&
+      argTypes[0]->size() == 3;
+}
+
 template <template <typename U, typename V> class T>
+std::unique_ptr<exec::Aggregate> createTopN(
+    const std::string& name,
+    core::AggregationNode::Step step,
+    const std::vector<TypePtr>& argTypes) {
+  auto isRawInput = exec::isRawInput(step);
+  if (isRawInput) {
+    VELOX_USER_CHECK(
+        argTypes[2]->kind() == TypeKind::BIGINT ||
+            argTypes[2]->kind() == TypeKind::INTEGER,
+        "third argument of {} must be an integer",
+        name);
+  }
+  auto valueType =
+      isRawInput ? argTypes[0] : argTypes[0]->childAt(1)->childAt(0);
+  auto compareType =
+      isRawInput ? argTypes[1] : argTypes[0]->childAt(2)->childAt(0);
+  std::string errorMessage = fmt::format(
+      "Unknown input types for {} ({}) aggregation: {}, {}",
+      name,
+      mapAggregationStepToName(step),
+      valueType->kindName(),
+      compareType->kindName());
+  auto resultType = exec::isPartialOutput(step)
+      ? ROW({"n", "v", "c"}, {BIGINT(), ARRAY(valueType), ARRAY(compareType)})
+      : ARRAY(valueType);
+
+  switch (valueType->kind()) {
+    case TypeKind::TINYINT:
+      return create<T, int8_t>(resultType, compareType->kind(), errorMessage);
+    case TypeKind::SMALLINT:
+      return create<T, int16_t>(resultType, compareType->kind(), errorMessage);
+    case TypeKind::INTEGER:
+      return create<T, int32_t>(resultType, compareType->kind(), errorMessage);
+    case TypeKind::BIGINT:
+      return create<T, int64_t>(resultType, compareType->kind(), errorMessage);
+    case TypeKind::REAL:
+      return create<T, float>(resultType, compareType->kind(), errorMessage);
+    case TypeKind::DOUBLE:
+      return create<T, double>(resultType, compareType->kind(), errorMessage);
+    default:
+      VELOX_FAIL(errorMessage);
+  }
+}
+
+template <
+    template <typename U, typename V>
+    class T,
+    template <typename U, typename V>
+    class TopN>
 bool registerMinMaxByAggregate(const std::string& name) {
   exec::AggregateFunctions().Register(
       name,
@@ -466,6 +814,9 @@ bool registerMinMaxByAggregate(const std::string& name) {
           const TypePtr&
           /*resultType*/) -> std::unique_ptr<exec::Aggregate> {
         auto isRawInput = exec::isRawInput(step);
+        if (isTopN(isRawInput, argTypes)) {
+          return createTopN<TopN>(name, step, argTypes);
+        }
         if (isRawInput) {
           VELOX_CHECK_EQ(
               argTypes.size(),
@@ -531,9 +882,9 @@ bool registerMinMaxByAggregate(const std::string& name) {
 }
 
 static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
-    registerMinMaxByAggregate<MaxByAggregate>(kMaxBy);
+    registerMinMaxByAggregate<MaxByAggregate, MaxByNAggregate>(kMaxBy);
 static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
-    registerMinMaxByAggregate<MinByAggregate>(kMinBy);
+    registerMinMaxByAggregate<MinByAggregate, MinByNAggregate>(kMinBy);
 
 } // namespace
 } // namespace facebook::velox::aggregate
@@ -80,17 +80,17 @@ class SimpleNumericAggregate : public exec::Aggregate {
       bool mayPushdown) {
     DecodedVector decoded(*arg, rows, !mayPushdown);
     auto encoding = decoded.base()->encoding();
-    auto indices = decoded.indices();
     if (encoding == VectorEncoding::Simple::LAZY) {
       SimpleCallableHook<TInput, TData, UpdateSingleValue> hook(
           exec::Aggregate::offset_,
           exec::Aggregate::nullByte_,
           exec::Aggregate::nullMask_,
-          groups,
+          selectedGroups(
+              groups, rows, this->exec::Aggregate::pushdownGroups_),
           &this->exec::Aggregate::numNulls_,
           updateSingleValue);
-      decoded.base()->as<const LazyVector>()->load(
-          RowSet(indices, arg->size()), &hook);
+      pushdownToHook(
+          hook, rows, arg, this->exec::Aggregate::pushdownCustomIndices_);
       return;
     }
 
@@ -125,7 +125,8 @@ class SimpleNumericAggregate : public exec::Aggregate {
   }
 
   // TData is either TAccumulator or TResult, which in most cases are the same,
-  // but for sum(real) can differ.
+  // but for sum(real) can differ. 'updateSingleValue' must also accept TData
+  // values: partial results over many rows are combined with it.
   template <
       typename TData = TResult,
       typename UpdateSingle,
@@ -136,16 +137,51 @@ class SimpleNumericAggregate : public exec::Aggregate {
       const VectorPtr& arg,
       UpdateSingle updateSingleValue,
       UpdateDuplicate updateDuplicateValues,
-      bool /*mayPushdown*/,
+      bool mayPushdown,
       TData initialValue) {
+    if (mayPushdown && isLazyNotLoaded(*arg)) {
+      SimpleCallableHook<TInput, TData, UpdateSingle> hook(
+          exec::Aggregate::offset_,
+          exec::Aggregate::nullByte_,
+          exec::Aggregate::nullMask_,
+          repeatGroup(
+              group, arg->size(), this->exec::Aggregate::pushdownGroups_),
+          &this->exec::Aggregate::numNulls_,
+          updateSingleValue);
+      pushdownToHook(
+          hook, rows, arg, this->exec::Aggregate::pushdownCustomIndices_);
+      return;
+    }
+
+    if (arg->encoding() == VectorEncoding::Simple::SEQUENCE &&
+        !arg->mayHaveNulls()) {
+      if (reduceRuns(
+              *arg,
+              rows,
+              initialValue,
+              updateSingleValue,
+              updateDuplicateValues)) {
+        combineNonNullValue(group, initialValue, updateSingleValue);
+      }
+      return;
+    }
+
     DecodedVector decoded(*arg, rows);
 
-    // Do row by row if not all rows are selected.
     if (decoded.isConstantMapping()) {
       if (!decoded.isNullAt(0)) {
         updateDuplicateValues(
             initialValue, decoded.valueAt<TInput>(0), rows.countSelected());
-        updateNonNullValue<true, TData>(group, initialValue, updateSingleValue);
+        combineNonNullValue(group, initialValue, updateSingleValue);
+      }
+    } else if (decoded.isIdentityMapping() && !std::is_same_v<TInput, bool>) {
+      if (reduceFlat(
+              decoded.data<TInput>(),
+              decoded.nulls(),
+              rows,
+              initialValue,
+              updateSingleValue)) {
+        combineNonNullValue(group, initialValue, updateSingleValue);
       }
     } else if (decoded.mayHaveNulls()) {
       rows.applyToSelected([&](vector_size_t i) {
@@ -155,11 +191,6 @@ class SimpleNumericAggregate : public exec::Aggregate {
         updateNonNullValue<true, TData>(
             group, decoded.valueAt<TInput>(i), updateSingleValue);
       });
-    } else if (decoded.isIdentityMapping() && !std::is_same_v<TInput, bool>) {
-      auto data = decoded.data<TInput>();
-      rows.applyToSelected([&](vector_size_t i) {
-        updateNonNullValue<true, TData>(group, data[i], updateSingleValue);
-      });
     } else {
       rows.applyToSelected([&](vector_size_t i) {
         updateNonNullValue<true, TData>(
@@ -171,37 +202,136 @@ class SimpleNumericAggregate : public exec::Aggregate {
   template <typename THook>
   void
   pushdown(char** groups, const SelectivityVector& rows, const VectorPtr& arg) {
-    DecodedVector decoded(*arg, rows, false);
-    const vector_size_t* indices = decoded.indices();
     THook hook(
         exec::Aggregate::offset_,
         exec::Aggregate::nullByte_,
         exec::Aggregate::nullMask_,
-        groups,
+        selectedGroups(groups, rows, this->exec::Aggregate::pushdownGroups_),
         &this->exec::Aggregate::numNulls_);
-    // The decoded vector does not really keep the info from the 'rows', except
-    // for the 'upper bound' of it. In case not all rows are selected we need to
-    // generate proper indices, which we 'indirect' through the ones we got from
-    // the decoded vector.
-    vector_size_t numIndices{arg->size()};
-    if (not rows.isAllSelected()) {
-      const auto numSelected = rows.countSelected();
-      if (numSelected != arg->size()) {
-        pushdownCustomIndices_.resize(numSelected);
-        vector_size_t tgtIndex{0};
-        rows.template applyToSelected([&](vector_size_t i) {
-          pushdownCustomIndices_[tgtIndex++] = indices[i];
-        });
-        indices = pushdownCustomIndices_.data();
-        numIndices = numSelected;
+    pushdownToHook(
+        hook, rows, arg, this->exec::Aggregate::pushdownCustomIndices_);
+  }
+
+  // Same as pushdown() for the single group of a global aggregation.
+  template <typename THook>
+  void pushdownOneGroup(
+      char* group,
+      const SelectivityVector& rows,
+      const VectorPtr& arg) {
+    THook hook(
+        exec::Aggregate::offset_,
+        exec::Aggregate::nullByte_,
+        exec::Aggregate::nullMask_,
+        repeatGroup(group, arg->size(), this->exec::Aggregate::pushdownGroups_),
+        &this->exec::Aggregate::numNulls_);
+    pushdownToHook(
+        hook, rows, arg, this->exec::Aggregate::pushdownCustomIndices_);
+  }
+
+ private:
+  // Reduces the selected values of run-length encoded 'sequence' without
+  // nulls into 'result'. Each run is folded with a single call to
+  // 'updateDuplicate' on the count of its selected rows and the partial
+  // results of the runs are combined with 'update'. Returns false if no row
+  // is selected.
+  template <typename TData, typename Update, typename UpdateDuplicate>
+  static bool reduceRuns(
+      const BaseVector& sequence,
+      const SelectivityVector& rows,
+      TData& result,
+      Update update,
+      UpdateDuplicate updateDuplicate) {
+    auto values = sequence.valueVector();
+    auto lengths = sequence.wrapInfo()->as<vector_size_t>();
+    SelectivityVector allRuns(values->size());
+    DecodedVector decoded(*values, allRuns);
+    const uint64_t* selected = rows.asRange().bits();
+    const TData initialValue = result;
+    bool hasValue = false;
+    vector_size_t runEnd = 0;
+    for (vector_size_t run = 0; run < values->size(); ++run) {
+      auto runBegin = runEnd;
+      runEnd += lengths[run];
+      if (runEnd <= rows.begin()) {
+        continue;
+      }
+      if (runBegin >= rows.end()) {
+        break;
+      }
+      auto count = bits::countBits(
+          selected,
+          std::max(runBegin, rows.begin()),
+          std::min(runEnd, rows.end()));
+      if (count == 0) {
+        continue;
+      }
+      TData runResult = initialValue;
+      updateDuplicate(runResult, decoded.valueAt<TInput>(run), count);
+      if (hasValue) {
+        update(result, runResult);
+      } else {
+        result = runResult;
+        hasValue = true;
       }
     }
+    return hasValue;
+  }
 
-    decoded.base()->as<const LazyVector>()->load(
-        RowSet(indices, numIndices), &hook);
+  // Reduces the selected non-null values of flat 'data' into 'result' with
+  // 'update'. Returns false if there are no such values. Words of 64 rows
+  // that are all selected and not null are reduced in a loop without
+  // branches or dependencies on the group, which the compiler vectorizes.
+  template <typename TData, typename Update>
+  static bool reduceFlat(
+      const TInput* data,
+      const uint64_t* nulls,
+      const SelectivityVector& rows,
+      TData& result,
+      Update update) {
+    const uint64_t* selected = rows.asRange().bits();
+    bool hasValue = false;
+    auto reduceWord = [&](int32_t index, uint64_t word) {
+      if (!word) {
+        return;
+      }
+      hasValue = true;
+      auto values = data + index * 64;
+      if (word == bits::kNotNull64) {
+        for (auto i = 0; i < 64; ++i) {
+          update(result, values[i]);
+        }
+        return;
+      }
+      do {
+        update(result, values[__builtin_ctzll(word)]);
+        word &= word - 1;
+      } while (word);
+    };
+    bits::forEachWord(
+        rows.begin(),
+        rows.end(),
+        [&](int32_t index, uint64_t mask) {
+          reduceWord(
+              index,
+              selected[index] & mask &
+                  (nulls ? nulls[index] : bits::kNotNull64));
+        },
+        [&](int32_t index) {
+          reduceWord(
+              index,
+              selected[index] & (nulls ? nulls[index] : bits::kNotNull64));
+        });
+    return hasValue;
+  }
+
+  // Combines 'value', the result of 'update' over one or more input values,
+  // into the accumulator of 'group'.
+  template <typename TData, typename Update>
+  inline void combineNonNullValue(char* group, TData value, Update update) {
+    exec::Aggregate::clearNull(group);
+    update(*exec::Aggregate::value<TData>(group), value);
   }
 
- private:
   // TData is either TAccumulator or TResult, which in most cases are the same,
   // but for sum(real) can differ.
   template <
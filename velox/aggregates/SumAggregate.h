@@ -78,12 +78,19 @@ class SumAggregate
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
       bool mayPushdown) override {
+    if (mayPushdown) {
+      BaseAggregate::template pushdownOneGroup<SumHook<TInput, TAccumulator>>(
+          group, rows, args[0]);
+      return;
+    }
     BaseAggregate::template updateOneGroup<TAccumulator>(
         group,
         rows,
         args[0],
-        [](TAccumulator& result, TInput value) { result += value; },
-        [](TAccumulator& result, TInput value, int n) { result += n * value; },
+        [](TAccumulator& result, TAccumulator value) { result += value; },
+        [](TAccumulator& result, TInput value, int n) {
+          result += static_cast<TAccumulator>(value) * n;
+        },
         mayPushdown,
         0);
   }
@@ -97,8 +104,10 @@ class SumAggregate
         group,
         rows,
         args[0],
-        [](ResultType& result, TInput value) { result += value; },
-        [](ResultType& result, TInput value, int n) { result += n * value; },
+        [](ResultType& result, ResultType value) { result += value; },
+        [](ResultType& result, TInput value, int n) {
+          result += static_cast<ResultType>(value) * n;
+        },
         mayPushdown,
         0);
   }
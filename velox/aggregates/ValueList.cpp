@@ -59,8 +59,46 @@ void ValueList::appendNonNull(
   exec::ContainerRowSerde::instance().serialize(values, index, stream);
   totalBytes_ += stream.size();
   ++size_;
-  auto reserve = std::max<int32_t>(1024, std::min<int64_t>(128, totalBytes_));
-  dataCurrent_ = allocator->finishWrite(stream, reserve);
+  dataCurrent_ = allocator->finishWrite(stream, reserveBytes());
+}
+
+void ValueList::appendFixedWidthRange(
+    const BaseVector& vector,
+    int32_t valueBytes,
+    vector_size_t offset,
+    vector_size_t size,
+    exec::HashStringAllocator* allocator) {
+  auto rawValues = reinterpret_cast<const char*>(vector.valuesAsVoid());
+  auto rawNulls = vector.rawNulls();
+  auto end = offset + size;
+  // Writes the values one nulls word at a time since the data and the
+  // nulls cannot be written at the same time.
+  for (auto begin = offset; begin < end;) {
+    prepareAppend(allocator);
+    auto numValues = std::min<vector_size_t>(end - begin, 64 - size_ % 64);
+    ByteStream stream(allocator);
+    allocator->extendWrite(dataCurrent_, stream);
+    auto runStart = begin;
+    auto flushRun = [&](vector_size_t runEnd) {
+      if (runEnd > runStart) {
+        stream.appendStringPiece(folly::StringPiece(
+            rawValues + runStart * valueBytes,
+            (runEnd - runStart) * valueBytes));
+      }
+    };
+    for (auto i = begin; i < begin + numValues; ++i) {
+      if (rawNulls && bits::isBitNull(rawNulls, i)) {
+        flushRun(i);
+        runStart = i + 1;
+        lastNulls_ |= 1UL << (size_ % 64);
+      }
+      ++size_;
+    }
+    begin += numValues;
+    flushRun(begin);
+    totalBytes_ += stream.size();
+    dataCurrent_ = allocator->finishWrite(stream, reserveBytes());
+  }
 }
 
 void ValueList::appendValue(
@@ -80,6 +118,12 @@ void ValueList::appendRange(
     vector_size_t offset,
     vector_size_t size,
     exec::HashStringAllocator* allocator) {
+  if (vector->encoding() == VectorEncoding::Simple::FLAT) {
+    if (auto valueBytes = fixedWidthValueBytes(*vector->type())) {
+      appendFixedWidthRange(*vector, valueBytes, offset, size, allocator);
+      return;
+    }
+  }
   for (auto index = offset; index < offset + size; ++index) {
     if (vector->isNullAt(index)) {
       appendNull(allocator);
@@ -109,4 +153,55 @@ bool ValueListReader::next(BaseVector& output, vector_size_t outputIndex) {
   pos_++;
   return pos_ < values_.size();
 }
+
+void ValueListReader::read(BaseVector& output, vector_size_t outputIndex) {
+  if (output.encoding() == VectorEncoding::Simple::FLAT) {
+    if (auto valueBytes = fixedWidthValueBytes(*output.type())) {
+      readFixedWidth(output, valueBytes, outputIndex);
+      return;
+    }
+  }
+  auto size = values_.size();
+  for (auto i = pos_; i < size; ++i) {
+    next(output, outputIndex++);
+  }
+}
+
+void ValueListReader::readFixedWidth(
+    BaseVector& output,
+    int32_t valueBytes,
+    vector_size_t outputIndex) {
+  auto rawValues = output.values()->asMutable<char>();
+  auto size = values_.size();
+  while (pos_ < size) {
+    if (pos_ % 64 == 0) {
+      nulls_ = nullsStream_.read<uint64_t>();
+    }
+    auto numValues = std::min<vector_size_t>(size - pos_, 64 - pos_ % 64);
+    auto bit = pos_ % 64;
+    if ((nulls_ >> bit) == 0) {
+      dataStream_.readBytes(
+          rawValues + outputIndex * valueBytes, numValues * valueBytes);
+      if (output.mayHaveNulls()) {
+        bits::fillBits(
+            output.mutableRawNulls(),
+            outputIndex,
+            outputIndex + numValues,
+            bits::kNotNull);
+      }
+      outputIndex += numValues;
+    } else {
+      for (auto i = 0; i < numValues; ++i, ++outputIndex) {
+        if (nulls_ & (1UL << (bit + i))) {
+          output.setNull(outputIndex, true);
+        } else {
+          dataStream_.readBytes(
+              rawValues + outputIndex * valueBytes, valueBytes);
+          output.setNull(outputIndex, false);
+        }
+      }
+    }
+    pos_ += numValues;
+  }
+}
 } // namespace facebook::velox::aggregate
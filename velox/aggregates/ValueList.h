@@ -25,7 +25,9 @@ namespace facebook::velox::aggregate {
 
 // Represents a list of values, including nulls, for an array/map/distinct value
 // set in aggregation. Bit-packed null flags are stored separately from the
-// non-null values.
+// non-null values. Non-null fixed-width values are stored back to back in
+// their native representation, so they can be copied in runs. The data
+// allocation grows in size classes that double with the bytes written.
 class ValueList {
  public:
   void appendValue(
@@ -75,6 +77,17 @@ class ValueList {
   // sizes for lots of small arrays.
   static constexpr int kInitialSize = 44;
 
+  // Bounds for the bytes reserved after each data write. The reservation
+  // is the number of bytes written so far, so that the allocation
+  // doubles in size while small and grows in 1KB steps after that.
+  static constexpr int32_t kMinReserve = 64;
+  static constexpr int32_t kMaxReserve = 1024;
+
+  int32_t reserveBytes() const {
+    return std::min<int64_t>(
+        kMaxReserve, std::max<int64_t>(kMinReserve, totalBytes_));
+  }
+
   void appendNull(exec::HashStringAllocator* allocator);
 
   void appendNonNull(
@@ -82,6 +95,15 @@ class ValueList {
       vector_size_t index,
       exec::HashStringAllocator* allocator);
 
+  // Appends the fixed-width values in [offset, offset + size) of flat
+  // 'vector' of 'valueBytes' wide values.
+  void appendFixedWidthRange(
+      const BaseVector& vector,
+      int32_t valueBytes,
+      vector_size_t offset,
+      vector_size_t size,
+      exec::HashStringAllocator* allocator);
+
   void prepareAppend(exec::HashStringAllocator* allocator);
 
   // Writes lastNulls_ word to the 'nulls' block.
@@ -105,6 +127,16 @@ class ValueList {
   uint64_t lastNulls_{0};
 };
 
+// Returns the width of the values of 'type' if these can be stored and
+// extracted as raw bytes, 0 otherwise.
+inline int32_t fixedWidthValueBytes(const Type& type) {
+  if (!type.isPrimitiveType() || !type.isFixedWidth() ||
+      type.kind() == TypeKind::BOOLEAN) {
+    return 0;
+  }
+  return type.cppSizeInBytes();
+}
+
 // Extracts values from the ValueList into provided vector.
 class ValueListReader {
  public:
@@ -112,7 +144,16 @@ class ValueListReader {
 
   bool next(BaseVector& output, vector_size_t outputIndex);
 
+  // Extracts all the values not yet returned by next() into 'output'
+  // starting at 'outputIndex'. Fixed-width values are copied in runs.
+  void read(BaseVector& output, vector_size_t outputIndex);
+
  private:
+  void readFixedWidth(
+      BaseVector& output,
+      int32_t valueBytes,
+      vector_size_t outputIndex);
+
   ValueList& values_;
   ByteStream dataStream_;
   ByteStream nullsStream_;
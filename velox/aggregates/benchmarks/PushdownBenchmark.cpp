@@ -153,6 +153,24 @@ BENCHMARK_NAMED_PARAM(pushdown, BITWISE_AND_INTEGER, kBitwiseAnd, INTEGER());
 BENCHMARK_NAMED_PARAM(pushdown, BITWISE_AND_BIGINT, kBitwiseAnd, BIGINT());
 BENCHMARK_DRAW_LINE();
 
+// Count aggregate.
+BENCHMARK_NAMED_PARAM(pushdown, COUNT_INTEGER, kCount, INTEGER());
+BENCHMARK_NAMED_PARAM(pushdown, COUNT_BIGINT, kCount, BIGINT());
+BENCHMARK_NAMED_PARAM(pushdown, COUNT_DOUBLE, kCount, DOUBLE());
+BENCHMARK_DRAW_LINE();
+
+// Average aggregate.
+BENCHMARK_NAMED_PARAM(pushdown, AVG_INTEGER, kAvg, INTEGER());
+BENCHMARK_NAMED_PARAM(pushdown, AVG_BIGINT, kAvg, BIGINT());
+BENCHMARK_NAMED_PARAM(pushdown, AVG_DOUBLE, kAvg, DOUBLE());
+BENCHMARK_DRAW_LINE();
+
+// Boolean aggregates.
+BENCHMARK_NAMED_PARAM(pushdown, COUNT_IF_BOOLEAN, kCountIf, BOOLEAN());
+BENCHMARK_NAMED_PARAM(pushdown, BOOL_AND_BOOLEAN, kBoolAnd, BOOLEAN());
+BENCHMARK_NAMED_PARAM(pushdown, BOOL_OR_BOOLEAN, kBoolOr, BOOLEAN());
+BENCHMARK_DRAW_LINE();
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
 
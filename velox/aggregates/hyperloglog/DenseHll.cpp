@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include "velox/aggregates/hyperloglog/DenseHll.h"
+#include <immintrin.h>
+
 #include "velox/aggregates/IOUtils.h"
 #include "velox/aggregates/hyperloglog/BiasCorrection.h"
 #include "velox/aggregates/hyperloglog/HllUtils.h"
@@ -80,6 +82,76 @@ int8_t getOverflowImpl(
   }
   return 0;
 }
+
+/// Returns two 4-bit 'deltas' packed in a byte rebased to a higher baseline.
+/// 'highShift' is the baseline difference shifted into the high nibble and
+/// 'lowShift' is the difference itself. Deltas that fall below the new
+/// baseline become zero.
+inline uint8_t
+rebaseSlot(uint8_t deltas, uint8_t highShift, uint8_t lowShift) {
+  uint8_t high = deltas & 0xF0;
+  uint8_t low = deltas & 0x0F;
+  high = high > highShift ? high - highShift : 0;
+  low = low > lowShift ? low - lowShift : 0;
+  return high | low;
+}
+
+/// Merges two arrays of 4-bit deltas neither of which has overflow entries.
+/// 'shift' and 'otherShift' are the differences between the merged baseline
+/// and the baselines of 'deltas' and 'otherDeltas' respectively; at most one
+/// of them is non-zero and both are capped at 15. The merged delta of a
+/// bucket is the max of the rebased deltas and never exceeds 15, so no
+/// overflow entries are created. Writes the result into 'deltas' and returns
+/// the number of zero deltas.
+int32_t mergeDeltasWithoutOverflows(
+    uint8_t* deltas,
+    const uint8_t* otherDeltas,
+    int32_t size,
+    uint8_t shift,
+    uint8_t otherShift) {
+  int32_t zeros = 0;
+  int32_t i = 0;
+#ifdef __AVX2__
+  const auto highMask = _mm256_set1_epi8(static_cast<char>(0xF0));
+  const auto lowMask = _mm256_set1_epi8(0x0F);
+  const auto highShift = _mm256_set1_epi8(static_cast<char>(shift << 4));
+  const auto lowShift = _mm256_set1_epi8(shift);
+  const auto otherHighShift =
+      _mm256_set1_epi8(static_cast<char>(otherShift << 4));
+  const auto otherLowShift = _mm256_set1_epi8(otherShift);
+  const auto zero = _mm256_setzero_si256();
+  for (; i + 32 <= size; i += 32) {
+    auto slots = _mm256_loadu_si256(reinterpret_cast<__m256i*>(deltas + i));
+    auto otherSlots = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(otherDeltas + i));
+    auto high = _mm256_max_epu8(
+        _mm256_subs_epu8(_mm256_and_si256(slots, highMask), highShift),
+        _mm256_subs_epu8(
+            _mm256_and_si256(otherSlots, highMask), otherHighShift));
+    auto low = _mm256_max_epu8(
+        _mm256_subs_epu8(_mm256_and_si256(slots, lowMask), lowShift),
+        _mm256_subs_epu8(
+            _mm256_and_si256(otherSlots, lowMask), otherLowShift));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(deltas + i), _mm256_or_si256(high, low));
+    zeros += __builtin_popcount(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, zero)));
+    zeros += __builtin_popcount(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, zero)));
+  }
+#endif
+  uint8_t highShift8 = shift << 4;
+  uint8_t otherHighShift8 = otherShift << 4;
+  for (; i < size; ++i) {
+    uint8_t slot1 = rebaseSlot(deltas[i], highShift8, shift);
+    uint8_t slot2 = rebaseSlot(otherDeltas[i], otherHighShift8, otherShift);
+    uint8_t slot = std::max(slot1 & 0xF0, slot2 & 0xF0) |
+        std::max(slot1 & 0x0F, slot2 & 0x0F);
+    deltas[i] = slot;
+    zeros += ((slot & 0xF0) == 0) + ((slot & 0x0F) == 0);
+  }
+  return zeros;
+}
 } // namespace
 
 DenseHll::DenseHll(int8_t indexBitLength, exec::HashStringAllocator* allocator)
@@ -106,6 +178,24 @@ void DenseHll::insertHash(uint64_t hash) {
   insert(index, value);
 }
 
+void DenseHll::insertHashes(const uint64_t* hashes, int32_t count) {
+  constexpr int32_t kBatchSize = 64;
+  uint32_t indices[kBatchSize];
+  int8_t values[kBatchSize];
+  for (auto begin = 0; begin < count; begin += kBatchSize) {
+    auto size = std::min(kBatchSize, count - begin);
+    // The iterations are independent, which lets the compiler vectorize
+    // this loop. The bucket updates below are inherently scalar.
+    for (auto i = 0; i < size; ++i) {
+      indices[i] = computeIndex(hashes[begin + i], indexBitLength_);
+      values[i] = computeValue(hashes[begin + i], indexBitLength_);
+    }
+    for (auto i = 0; i < size; ++i) {
+      insert(indices[i], values[i]);
+    }
+  }
+}
+
 void DenseHll::insert(int32_t index, int8_t value) {
   auto delta = value - baseline_;
   auto oldDelta = getDelta(index);
@@ -429,6 +519,23 @@ void DenseHll::mergeWith(
     const uint16_t* otherOverflowBuckets,
     const int8_t* otherOverflowValues) {
   int8_t newBaseline = std::max(baseline_, otherBaseline);
+
+  if (overflows_ == 0 && otherOverflows == 0) {
+    // Fast path: with no overflows every bucket value is baseline + delta, so
+    // the merge is a per-nibble max of the deltas rebased to 'newBaseline'.
+    auto shift = std::min<int>(newBaseline - baseline_, kMaxDelta);
+    auto otherShift = std::min<int>(newBaseline - otherBaseline, kMaxDelta);
+    baselineCount_ = mergeDeltasWithoutOverflows(
+        reinterpret_cast<uint8_t*>(deltas_.data()),
+        reinterpret_cast<const uint8_t*>(otherDeltas),
+        deltas_.size(),
+        shift,
+        otherShift);
+    baseline_ = newBaseline;
+    adjustBaselineIfNeeded();
+    return;
+  }
+
   int32_t baselineCount = 0;
 
   int bucket = 0;
@@ -48,6 +48,11 @@ class DenseHll {
 
   void insertHash(uint64_t hash);
 
+  /// Inserts 'count' hashes. Equivalent to calling insertHash for each of
+  /// them, but computes bucket indices and values for a batch of hashes at a
+  /// time before updating the buckets.
+  void insertHashes(const uint64_t* hashes, int32_t count);
+
   /// Inserts pre-computed {bucket, value} pair. These value must be compatible
   /// with computeIndex and computeValue methods called with the indexBitLength
   /// value of this HLL. Used by SparseHll.toDense().
@@ -77,6 +77,33 @@ bool SparseHll::insertHash(uint64_t hash) {
   return entries_.size() >= softNumEntriesLimit_;
 }
 
+bool SparseHll::insertHashes(const uint64_t* hashes, int32_t count) {
+  if (count > 0) {
+    std::vector<uint32_t> newEntries(count);
+    for (auto i = 0; i < count; i++) {
+      newEntries[i] = encode(
+          computeIndex(hashes[i], kIndexBitLength),
+          computeValue(hashes[i], kIndexBitLength));
+    }
+
+    // Entries are ordered by bucket index, then by value. Keep the last, i.e.
+    // the largest, entry for each bucket.
+    std::sort(newEntries.begin(), newEntries.end());
+    int32_t numNewEntries = 1;
+    for (auto i = 1; i < count; i++) {
+      if (decodeIndex(newEntries[i]) ==
+          decodeIndex(newEntries[numNewEntries - 1])) {
+        newEntries[numNewEntries - 1] = newEntries[i];
+      } else {
+        newEntries[numNewEntries++] = newEntries[i];
+      }
+    }
+    mergeWith(numNewEntries, newEntries.data());
+  }
+
+  return entries_.size() >= softNumEntriesLimit_;
+}
+
 int64_t SparseHll::cardinality() const {
   // Estimate the cardinality using linear counting over the theoretical
   // 2^kIndexBitLength buckets available due to the fact that we're
@@ -35,6 +35,13 @@ class SparseHll {
   /// Returns true if soft memory limit has been reached. False, otherwise.
   bool insertHash(uint64_t hash);
 
+  /// Inserts 'count' hashes. Equivalent to calling insertHash for each of
+  /// them, but sorts the new entries and merges them into the existing ones
+  /// in one pass instead of inserting them one at a time. The soft memory
+  /// limit is checked only after all hashes have been inserted. Returns true
+  /// if the limit has been reached.
+  bool insertHashes(const uint64_t* hashes, int32_t count);
+
   int64_t cardinality() const;
 
   /// Serializes internal state using Presto SparseV2 format.
@@ -173,6 +173,23 @@ TEST_P(DenseHllTest, mergeWith) {
   testMergeWith(indexBitLength, sequence(0, 2'000'000), sequence(0, 2'000'000));
 }
 
+TEST_P(DenseHllTest, insertHashes) {
+  int8_t indexBitLength = GetParam();
+
+  for (auto size : {10, 1'000, 100'000}) {
+    std::vector<uint64_t> hashes;
+    DenseHll expected{indexBitLength, &allocator_};
+    for (auto i = 0; i < size; i++) {
+      hashes.push_back(hashOne(i));
+      expected.insertHash(hashes.back());
+    }
+
+    DenseHll denseHll{indexBitLength, &allocator_};
+    denseHll.insertHashes(hashes.data(), hashes.size());
+    ASSERT_EQ(serialize(denseHll), serialize(expected));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     DenseHllTest,
     DenseHllTest,
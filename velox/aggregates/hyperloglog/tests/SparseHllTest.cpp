@@ -137,6 +137,24 @@ std::vector<T> sequence(T start, T end) {
 }
 } // namespace
 
+TEST_F(SparseHllTest, insertHashes) {
+  SparseHll expected{&allocator_};
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 1'000; i++) {
+    // Repeat some values to exercise duplicate entries within a batch.
+    hashes.push_back(hashOne(i % 300));
+    expected.insertHash(hashes.back());
+  }
+
+  SparseHll sparseHll{&allocator_};
+  sparseHll.insertHashes(hashes.data(), 500);
+  sparseHll.insertHashes(hashes.data() + 500, 500);
+  sparseHll.verify();
+
+  ASSERT_EQ(300, sparseHll.cardinality());
+  ASSERT_EQ(serialize(11, sparseHll), serialize(11, expected));
+}
+
 TEST_F(SparseHllTest, mergeWith) {
   // with overlap
   testMergeWith(sequence(0, 100), sequence(50, 150));
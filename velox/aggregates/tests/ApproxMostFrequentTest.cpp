@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/aggregates/tests/AggregationTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace facebook::velox::aggregate::test {
+namespace {
+
+class ApproxMostFrequentTest : public AggregationTestBase {};
+
+TEST_F(ApproxMostFrequentTest, global) {
+  vector_size_t size = 1'000;
+  std::vector<RowVectorPtr> vectors = {makeRowVector({makeFlatVector<int64_t>(
+      size, [](vector_size_t row) { return row % 7; })})};
+
+  // Values 0 to 5 occur 143 times and 6 occurs 142 times. The capacity
+  // covers all values, so that the counts are exact.
+  std::map<variant, variant> expected{
+      {variant(0L), variant(143L)},
+      {variant(1L), variant(143L)},
+      {variant(2L), variant(143L)}};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"approx_most_frequent(3, c0, 10)"})
+                .planNode();
+  ASSERT_EQ(variant::map(expected), readSingleValue(op));
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({}, {"approx_most_frequent(3, c0, 10)"})
+           .finalAggregation({}, {"approx_most_frequent(a0)"})
+           .planNode();
+  ASSERT_EQ(variant::map(expected), readSingleValue(op));
+}
+
+TEST_F(ApproxMostFrequentTest, groupBy) {
+  vector_size_t size = 90;
+  auto vectors = {makeRowVector(
+      {makeFlatVector<int32_t>(size, [](vector_size_t row) { return row % 3; }),
+       makeFlatVector<StringView>(size, [](vector_size_t row) {
+         return StringView(row % 2 ? "a rather long string" : "short");
+       })})};
+
+  // Each group has 15 even and 15 odd rows.
+  auto expectedResult = {makeRowVector(
+      {makeFlatVector<int32_t>({0, 1, 2}),
+       makeMapVector<StringView, int64_t>(
+           3,
+           [](vector_size_t /*row*/) { return 2; },
+           [](vector_size_t row) {
+             return StringView(row % 2 ? "short" : "a rather long string");
+           },
+           [](vector_size_t /*row*/) { return 15; })})};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({0}, {"approx_most_frequent(2, c1, 4)"})
+                .planNode();
+  assertQuery(op, expectedResult);
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({0}, {"approx_most_frequent(2, c1, 4)"})
+           .intermediateAggregation({0}, {"approx_most_frequent(a0)"})
+           .finalAggregation({0}, {"approx_most_frequent(a0)"})
+           .planNode();
+  assertQuery(op, expectedResult);
+}
+
+TEST_F(ApproxMostFrequentTest, heavyHitter) {
+  // Half of the rows have value 0 and the rest have distinct values, many
+  // more than the capacity. The heavy hitter keeps its counter and its
+  // count is never below the true count.
+  vector_size_t size = 10'000;
+  std::vector<RowVectorPtr> vectors = {makeRowVector({makeFlatVector<int64_t>(
+      size, [](vector_size_t row) { return row % 2 ? row : 0; })})};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"approx_most_frequent(1, c0, 16)"})
+                .planNode();
+  auto result = readSingleValue(op).map();
+  ASSERT_EQ(1, result.size());
+  ASSERT_EQ(variant(0L), result.begin()->first);
+  ASSERT_GE(result.begin()->second.value<int64_t>(), size / 2);
+}
+
+TEST_F(ApproxMostFrequentTest, allNulls) {
+  std::vector<RowVectorPtr> vectors = {makeRowVector({makeFlatVector<int64_t>(
+      100, [](vector_size_t row) { return row; }, nullEvery(1))})};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"approx_most_frequent(3, c0, 10)"})
+                .planNode();
+  ASSERT_TRUE(readSingleValue(op).isNull());
+}
+
+} // namespace
+} // namespace facebook::velox::aggregate::test
@@ -241,5 +241,35 @@ TEST_F(ApproxPercentileTest, largeWeightsGroupBy) {
   testGroupByAgg(keys, values, weights, 0.5, expectedResult);
 }
 
+// Intermediate results of several partial groups are merged into one
+// group of the final aggregation.
+TEST_F(ApproxPercentileTest, mergeIntermediateResults) {
+  vector_size_t size = 63;
+  auto keys = makeFlatVector<int32_t>(size, [](auto row) { return row % 3; });
+  auto subkeys =
+      makeFlatVector<int32_t>(size, [](auto row) { return row % 5; });
+  auto values = makeFlatVector<int32_t>(
+      size, [](auto row) { return row % 3 * 100 + row / 3; });
+  auto rowVector = makeRowVector({keys, subkeys, values});
+
+  auto op = PlanBuilder()
+                .values({rowVector})
+                .partialAggregation({0, 1}, {"approx_percentile(c2, 0.5)"})
+                .finalAggregation({0}, {"approx_percentile(a0)"}, {INTEGER()})
+                .planNode();
+  assertQuery(
+      op,
+      makeRowVector(
+          {makeFlatVector(std::vector<int32_t>{0, 1, 2}),
+           makeFlatVector(std::vector<int32_t>{10, 110, 210})}));
+
+  op = PlanBuilder()
+           .values({rowVector})
+           .partialAggregation({1}, {"approx_percentile(c2, 0.5)"})
+           .finalAggregation({}, {"approx_percentile(a0)"}, {INTEGER()})
+           .planNode();
+  assertQuery(op, "SELECT 110");
+}
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/aggregates/tests/AggregationTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox::exec::test;
+
+namespace facebook::velox::aggregate::test {
+
+namespace {
+
+// Moments of (y, x) pairs computed in long double with two passes.
+struct Moments {
+  int64_t count{0};
+  long double c2{0};
+  long double m2X{0};
+  long double m2Y{0};
+
+  Moments(const std::vector<double>& y, const std::vector<double>& x) {
+    long double sumX = 0;
+    long double sumY = 0;
+    for (auto i = 0; i < x.size(); ++i) {
+      sumX += x[i];
+      sumY += y[i];
+    }
+    count = x.size();
+    auto meanX = sumX / count;
+    auto meanY = sumY / count;
+    for (auto i = 0; i < x.size(); ++i) {
+      c2 += (x[i] - meanX) * (y[i] - meanY);
+      m2X += (x[i] - meanX) * (x[i] - meanX);
+      m2Y += (y[i] - meanY) * (y[i] - meanY);
+    }
+  }
+
+  double result(const std::string& name) const {
+    if (name == "covar_pop") {
+      return c2 / count;
+    }
+    if (name == "covar_samp") {
+      return c2 / (count - 1);
+    }
+    return c2 / std::sqrt(m2X * m2Y);
+  }
+};
+
+class CovarianceAggregationTest : public AggregationTestBase {
+ protected:
+  static constexpr vector_size_t kSize = 1'000;
+  static constexpr int32_t kNumGroups = 3;
+
+  void SetUp() override {
+    AggregationTestBase::SetUp();
+    // c0 is the group, c1 is y and c2 is x. y is null in every 7th row. The
+    // values have a large offset, which loses precision if the moments are
+    // not computed around the mean.
+    for (auto i = 0; i < 3; ++i) {
+      auto offset = i * kSize;
+      vectors_.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              kSize, [&](auto row) { return (offset + row) % kNumGroups; }),
+          makeFlatVector<double>(
+              kSize, [&](auto row) { return y(offset + row); }, nullEvery(7)),
+          makeFlatVector<double>(
+              kSize, [&](auto row) { return x(offset + row); }),
+      }));
+    }
+  }
+
+  static double x(int32_t row) {
+    return 1e9 + (row * 17) % 101;
+  }
+
+  static double y(int32_t row) {
+    return 1e9 + 3 * x(row) + (row * 7) % 13;
+  }
+
+  // Returns the moments of the pairs in 'group' or of all pairs if 'group'
+  // is -1.
+  Moments expectedMoments(int32_t group) {
+    std::vector<double> ys;
+    std::vector<double> xs;
+    for (auto i = 0; i < vectors_.size(); ++i) {
+      for (auto row = 0; row < kSize; ++row) {
+        auto overall = i * kSize + row;
+        if (row % 7 == 0 || (group >= 0 && overall % kNumGroups != group)) {
+          continue;
+        }
+        ys.push_back(y(overall));
+        xs.push_back(x(overall));
+      }
+    }
+    return Moments(ys, xs);
+  }
+
+  void assertNear(
+      const std::shared_ptr<const core::PlanNode>& plan,
+      double expected) {
+    auto actual = readSingleValue(plan).value<TypeKind::DOUBLE>();
+    EXPECT_NEAR(actual, expected, std::abs(expected) * 1e-6);
+  }
+
+  std::vector<RowVectorPtr> vectors_;
+  const std::vector<std::string> aggrNames_{"covar_pop", "covar_samp", "corr"};
+};
+
+TEST_F(CovarianceAggregationTest, global) {
+  auto moments = expectedMoments(-1);
+  for (const auto& name : aggrNames_) {
+    auto aggregate = fmt::format("{}(c1, c2)", name);
+    auto expected = moments.result(name);
+
+    auto plan = PlanBuilder()
+                    .values(vectors_)
+                    .singleAggregation({}, {aggregate})
+                    .planNode();
+    assertNear(plan, expected);
+
+    plan = PlanBuilder()
+               .values(vectors_)
+               .partialAggregation({}, {aggregate})
+               .intermediateAggregation({}, {fmt::format("{}(a0)", name)})
+               .finalAggregation({}, {fmt::format("{}(a0)", name)})
+               .planNode();
+    assertNear(plan, expected);
+
+    // Only some of the rows are selected.
+    plan = PlanBuilder()
+               .values(vectors_)
+               .filter("c0 = 1")
+               .singleAggregation({}, {aggregate})
+               .planNode();
+    assertNear(plan, expectedMoments(1).result(name));
+  }
+}
+
+TEST_F(CovarianceAggregationTest, groupBy) {
+  for (const auto& name : aggrNames_) {
+    for (auto group = 0; group < kNumGroups; ++group) {
+      auto plan =
+          PlanBuilder()
+              .values(vectors_)
+              .partialAggregation({0}, {fmt::format("{}(c1, c2)", name)})
+              .finalAggregation({0}, {fmt::format("{}(a0)", name)})
+              .filter(fmt::format("c0 = {}", group))
+              .project({"a0"})
+              .planNode();
+      assertNear(plan, expectedMoments(group).result(name));
+    }
+  }
+}
+
+TEST_F(CovarianceAggregationTest, nullAndConstantInput) {
+  auto vectors = {makeRowVector({
+      makeNullableFlatVector<double>({1.0, std::nullopt, 3.0}),
+      makeNullableFlatVector<double>({std::nullopt, 2.0, 5.0}),
+      makeFlatVector<double>({1.0, 1.0, 1.0}),
+  })};
+  createDuckDbTable(vectors);
+
+  // A single pair has a population covariance of 0 and no sample covariance
+  // or correlation. A constant input has no correlation.
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .singleAggregation(
+                      {},
+                      {"covar_pop(c0, c1)",
+                       "covar_samp(c0, c1)",
+                       "corr(c0, c1)",
+                       "corr(c0, c2)"})
+                  .planNode();
+  assertQuery(
+      plan, "SELECT 0::DOUBLE, null::DOUBLE, null::DOUBLE, null::DOUBLE");
+}
+
+} // namespace
+} // namespace facebook::velox::aggregate::test
@@ -281,5 +281,61 @@ TEST_F(MinMaxByAggregationTest, minByGroupBy) {
       op, "SELECT c2, min(CAST(c1 as DOUBLE)) * 0.1 FROM tmp GROUP BY 1");
 }
 
+TEST_F(MinMaxByAggregationTest, topN) {
+  // c1 is a permutation of 0..999 and c0 is 2 * c1 + 1. Rows with even
+  // c1 are in group 0.
+  const vector_size_t size = 1'000;
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 2; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int32_t>(
+             size / 2,
+             [&](auto row) { return (row + i * size / 2) * 7 % size * 2 + 1; }),
+         makeFlatVector<int64_t>(
+             size / 2,
+             [&](auto row) { return (row + i * size / 2) * 7 % size; }),
+         makeFlatVector<int32_t>(size / 2, [](auto row) { return row % 2; })}));
+  }
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .partialAggregation(
+                    {}, {"max_by(c0, c1, 3)", "min_by(c0, c1, 3)"})
+                .finalAggregation({}, {"max_by(a0)", "min_by(a1)"})
+                .planNode();
+  assertQuery(op, "SELECT [1999, 1997, 1995], [1, 3, 5]");
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({2}, {"max_by(c0, c1, 3)", "min_by(c0, c1, 3)"})
+           .finalAggregation({0}, {"max_by(a0)", "min_by(a1)"})
+           .planNode();
+  assertQuery(
+      op,
+      "SELECT * FROM (VALUES (0, [1997, 1993, 1989], [1, 5, 9]), "
+      "(1, [1999, 1995, 1991], [3, 7, 11])) AS t");
+}
+
+TEST_F(MinMaxByAggregationTest, topNNulls) {
+  // Rows with null y are skipped. Null x values are kept.
+  auto vectors = {makeRowVector({
+      makeNullableFlatVector<int64_t>({1, std::nullopt, 3, 4, 5}),
+      makeNullableFlatVector<double>({1.5, 4.5, std::nullopt, -2.5, 3.5}),
+  })};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation(
+                    {}, {"max_by(c0, c1, 2)", "min_by(c0, c1, 10)"})
+                .planNode();
+  assertQuery(op, "SELECT [NULL, 5], [4, 1, 5, NULL]");
+
+  op = PlanBuilder()
+           .values(vectors)
+           .singleAggregation({}, {"max_by(c0, c1, 0)"})
+           .planNode();
+  EXPECT_THROW(assertQuery(op, "SELECT NULL"), VeloxException);
+}
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
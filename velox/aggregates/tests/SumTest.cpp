@@ -16,6 +16,7 @@
 #include "velox/aggregates/AggregationHook.h"
 #include "velox/aggregates/tests/AggregationTestBase.h"
 #include "velox/exec/tests/PlanBuilder.h"
+#include "velox/vector/SequenceVector.h"
 
 using facebook::velox::exec::test::PlanBuilder;
 
@@ -180,6 +181,85 @@ TEST_F(SumTest, sumWithMask) {
 }
 
 // Test aggregation over boolean key
+TEST_F(SumTest, global) {
+  // Flat inputs with nulls and values whose sum overflows INTEGER.
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 3; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int32_t>(
+             1'000,
+             [](auto row) { return 2'000'000'000 - row; },
+             velox::test::VectorMaker::nullEvery(7)),
+         makeFlatVector<double>(
+             1'000,
+             [](auto row) { return row % 100; },
+             [](auto row) { return row % 64 < 10; }),
+         makeFlatVector<int32_t>(1'000, [](auto row) { return row % 3; })}));
+  }
+  createDuckDbTable(vectors);
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"sum(c0)", "sum(c1)"})
+                .planNode();
+  assertQuery(op, "SELECT sum(c0), sum(c1) FROM tmp");
+
+  // A selection of rows from a mask.
+  op = PlanBuilder()
+           .values(vectors)
+           .project({"c0", "c1", "c2 = 1"}, {"c0", "c1", "m0"})
+           .partialAggregation({}, {"sum(c0)", "sum(c1)"}, {"m0", "m0"})
+           .finalAggregation({}, {"sum(a0)", "sum(a1)"})
+           .planNode();
+  assertQuery(
+      op,
+      "SELECT sum(c0) filter (where c2 = 1), sum(c1) filter (where c2 = 1) "
+      "FROM tmp");
+
+  // Constant input.
+  op = PlanBuilder()
+           .values(vectors)
+           .project({"cast(2000000000 as integer)"}, {"c0"})
+           .singleAggregation({}, {"sum(c0)"})
+           .planNode();
+  assertQuery(op, "SELECT 6000000000");
+}
+
+TEST_F(SumTest, globalSequence) {
+  // Run-length encoded inputs with 10 runs of 100 rows each and a mask that
+  // selects every third row.
+  std::vector<RowVectorPtr> vectors;
+  int64_t expectedMasked = 0;
+  for (auto i = 0; i < 3; ++i) {
+    auto lengths = AlignedBuffer::allocate<vector_size_t>(10, pool_.get());
+    std::fill_n(lengths->asMutable<vector_size_t>(), 10, 100);
+    auto runs = std::make_shared<SequenceVector<int32_t>>(
+        pool_.get(),
+        1'000,
+        makeFlatVector<int32_t>(10, [&](auto run) { return run + i; }),
+        lengths);
+    for (auto row = 0; row < 1'000; row += 3) {
+      expectedMasked += runs->valueAt(row);
+    }
+    vectors.push_back(makeRowVector(
+        {runs,
+         makeFlatVector<bool>(1'000, [](auto row) { return row % 3 == 0; })}));
+  }
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"sum(c0)", "min(c0)", "max(c0)"})
+                .planNode();
+  assertQuery(op, "SELECT 16500::BIGINT, 0, 11");
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({}, {"sum(c0)"}, {"c1"})
+           .finalAggregation({}, {"sum(a0)"})
+           .planNode();
+  assertQuery(op, fmt::format("SELECT {}::BIGINT", expectedMasked));
+}
+
 TEST_F(SumTest, boolKey) {
   vector_size_t size = 1'000;
   auto rowType = ROW({"c0", "c1"}, {BOOLEAN(), INTEGER()});
@@ -46,6 +46,26 @@ class ValueListTest : public functions::test::FunctionBaseTest {
     assertEqualVectors(data, result);
   }
 
+  // Appends 'data' in ranges of 'rangeSize' and extracts it in bulk after
+  // reading the first value with next().
+  void testRangeRoundTrip(const VectorPtr& data, vector_size_t rangeSize) {
+    auto size = data->size();
+
+    aggregate::ValueList values;
+    for (auto i = 0; i < size; i += rangeSize) {
+      values.appendRange(data, i, std::min(rangeSize, size - i), allocator());
+    }
+    values.finalize(allocator());
+    ASSERT_EQ(size, values.size());
+
+    aggregate::ValueListReader reader(values);
+    auto result = BaseVector::create(data->type(), size, pool());
+    reader.next(*result, 0);
+    reader.read(*result, 1);
+
+    assertEqualVectors(data, result);
+  }
+
   exec::HashStringAllocator* allocator() {
     return allocator_.get();
   }
@@ -100,3 +120,35 @@ TEST_F(ValueListTest, arrays) {
     }
   }
 }
+
+TEST_F(ValueListTest, ranges) {
+  for (auto size : {10, 1'000, 10'000}) {
+    for (auto rangeSize : {1, 7, 64, 1'000}) {
+      testRangeRoundTrip(
+          makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+          rangeSize);
+      for (auto nullEvery : {2, 7, 97}) {
+        auto nulls = test::VectorMaker::nullEvery(nullEvery);
+        testRangeRoundTrip(
+            makeFlatVector<int32_t>(
+                size, [](auto row) { return row; }, nulls),
+            rangeSize);
+        testRangeRoundTrip(
+            makeFlatVector<double>(
+                size, [](auto row) { return row * 0.1; }, nulls),
+            rangeSize);
+        testRangeRoundTrip(
+            makeFlatVector<bool>(
+                size, [](auto row) { return row % 3 == 0; }, nulls),
+            rangeSize);
+        testRangeRoundTrip(
+            makeArrayVector<int32_t>(
+                size,
+                [](auto row) { return row % 7; },
+                [](auto row) { return row % 11; },
+                nulls),
+            rangeSize);
+      }
+    }
+  }
+}
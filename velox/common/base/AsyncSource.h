@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace facebook::velox {
+
+// A value made by a function that can run either on a background
+// thread ahead of need, or on the consumer thread when the value is
+// first needed. The consumer waits if the value is being made in the
+// background. Used for preparing work, e.g. opening the next file of
+// a scan, while the consumer is occupied with the previous one.
+template <typename Item>
+class AsyncSource {
+ public:
+  explicit AsyncSource(std::function<std::shared_ptr<Item>()> make)
+      : make_(std::move(make)) {}
+
+  // Makes the value if it is not already made or being made. To be
+  // called on a background executor.
+  void prepare() {
+    std::function<std::shared_ptr<Item>()> make;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      if (!make_) {
+        return;
+      }
+      making_ = true;
+      std::swap(make, make_);
+    }
+    std::shared_ptr<Item> item;
+    std::exception_ptr exception;
+    try {
+      item = make();
+    } catch (const std::exception&) {
+      exception = std::current_exception();
+    }
+    std::lock_guard<std::mutex> l(mutex_);
+    item_ = std::move(item);
+    exception_ = exception;
+    making_ = false;
+    made_.notify_all();
+  }
+
+  // Returns the value. Makes it on the calling thread if it is not
+  // started and waits for it if it is being made in the
+  // background. Rethrows the error of a background make. Returns
+  // nullptr after close() or a previous move().
+  std::shared_ptr<Item> move() {
+    std::function<std::shared_ptr<Item>()> make;
+    {
+      std::unique_lock<std::mutex> l(mutex_);
+      made_.wait(l, [&]() { return !making_; });
+      if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+      }
+      if (!make_) {
+        return std::move(item_);
+      }
+      std::swap(make, make_);
+    }
+    return make();
+  }
+
+  // True if the value is made and not yet moved out.
+  bool hasValue() const {
+    std::lock_guard<std::mutex> l(mutex_);
+    return item_ != nullptr;
+  }
+
+  // Cancels a make that has not started, waits for one in progress
+  // and drops the value. After this, move() returns nullptr. Must be
+  // called before the state the make function refers to is destroyed.
+  void close() {
+    std::unique_lock<std::mutex> l(mutex_);
+    make_ = nullptr;
+    made_.wait(l, [&]() { return !making_; });
+    item_ = nullptr;
+    exception_ = nullptr;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable made_;
+  std::function<std::shared_ptr<Item>()> make_;
+  bool making_{false};
+  std::shared_ptr<Item> item_;
+  std::exception_ptr exception_;
+};
+
+} // namespace facebook::velox
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace facebook {
 namespace velox {
@@ -112,6 +113,18 @@ inline int32_t getAndClearLastSetBit(uint16_t& bits) {
   return trailingZeros;
 }
 
+inline int32_t getAndClearLastSetBit(uint32_t& bits) {
+  int32_t trailingZeros = __builtin_ctz(bits);
+  bits &= bits - 1;
+  return trailingZeros;
+}
+
+inline int32_t getAndClearLastSetBit(uint64_t& bits) {
+  int32_t trailingZeros = __builtin_ctzll(bits);
+  bits &= bits - 1;
+  return trailingZeros;
+}
+
 /**
  * Invokes a function for each batch of bits (partial or full words)
  * in a given range.
@@ -274,7 +287,21 @@ inline int32_t countBits(const uint64_t* bits, int32_t begin, int32_t end) {
  * @param numBytes The number of bytes of the byte array
  */
 inline void reverseBits(uint8_t* bytes, int numBytes) {
-  for (int i = 0; i < numBytes; ++i) {
+  int i = 0;
+  // Reverses 8 bytes at a time by swapping adjacent bits, bit pairs and
+  // nibbles. The loop vectorizes.
+  for (; i + 8 <= numBytes; i += 8) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    word = ((word >> 1) & 0x5555555555555555UL) |
+        ((word & 0x5555555555555555UL) << 1);
+    word = ((word >> 2) & 0x3333333333333333UL) |
+        ((word & 0x3333333333333333UL) << 2);
+    word = ((word >> 4) & 0x0f0f0f0f0f0f0f0fUL) |
+        ((word & 0x0f0f0f0f0f0f0f0fUL) << 4);
+    memcpy(bytes + i, &word, sizeof(word));
+  }
+  for (; i < numBytes; ++i) {
     auto byte = bytes[i];
     bytes[i] = ((byte & 0x01) << 7) | ((byte & 0x02) << 5) |
         ((byte & 0x4) << 3) | ((byte & 0x08) << 1) | ((byte & 0x10) >> 1) |
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/base/Counters.h"
+#include "velox/common/base/StatsReporter.h"
+
+namespace facebook::velox {
+
+void registerVeloxCounters() {
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheNumEntries, StatType::AVG);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheCachedBytes, StatType::AVG);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCachePrefetchBytes, StatType::AVG);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheNumHits, StatType::SUM);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheNumNew, StatType::SUM);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheNumEvicts, StatType::SUM);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterCacheNumWaitExclusive, StatType::SUM);
+
+  REPORT_ADD_STAT_EXPORT_TYPE(
+      kCounterMappedMemoryAllocatedPages, StatType::AVG);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterMappedMemoryMappedPages, StatType::AVG);
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterMappedMemoryHugePages, StatType::AVG);
+
+  // Buckets of 1MB up to 64MB.
+  REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES(
+      kCounterExchangeQueueBytes, 1 << 20, 0, 64 << 20, 50, 90, 99);
+  // Buckets of 1ms up to 10s.
+  REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES(
+      kCounterExchangeFetchLatencyUs, 1'000, 0, 10'000'000, 50, 90, 99, 100);
+
+  REPORT_ADD_STAT_EXPORT_TYPE(kCounterStorageReadBytes, StatType::SUM);
+  REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES(
+      kCounterStorageReadLatencyUs, 1'000, 0, 10'000'000, 50, 90, 99, 100);
+}
+
+} // namespace facebook::velox
@@ -14,10 +14,57 @@
  * limitations under the License.
  */
 
+
 #pragma once
+
+#include <folly/Range.h>
+
 namespace facebook::velox {
 
-// Velox Counter Registration
-void registerVeloxCounters() {}
+// Registers the export types of the stats below with the
+// BaseStatsReporter of the process. Call once at startup after the
+// reporter is set up.
+void registerVeloxCounters();
+
+// AsyncDataCache. Levels are reported as AVG and cumulative counts as the
+// SUM of their changes between reports. See PeriodicStatsReporter.
+constexpr folly::StringPiece kCounterCacheNumEntries{
+    "velox.cache_num_entries"};
+constexpr folly::StringPiece kCounterCacheCachedBytes{
+    "velox.cache_cached_bytes"};
+constexpr folly::StringPiece kCounterCachePrefetchBytes{
+    "velox.cache_prefetch_bytes"};
+constexpr folly::StringPiece kCounterCacheNumHits{"velox.cache_num_hits"};
+constexpr folly::StringPiece kCounterCacheNumNew{"velox.cache_num_new"};
+constexpr folly::StringPiece kCounterCacheNumEvicts{
+    "velox.cache_num_evicts"};
+constexpr folly::StringPiece kCounterCacheNumWaitExclusive{
+    "velox.cache_num_wait_exclusive"};
+
+// MappedMemory, in machine pages. The allocated pages of each size class
+// are reported as kCounterMappedMemorySizeClassPages followed by '.' and
+// the size of the class in pages.
+constexpr folly::StringPiece kCounterMappedMemoryAllocatedPages{
+    "velox.mapped_memory_allocated_pages"};
+constexpr folly::StringPiece kCounterMappedMemoryMappedPages{
+    "velox.mapped_memory_mapped_pages"};
+constexpr folly::StringPiece kCounterMappedMemoryHugePages{
+    "velox.mapped_memory_huge_pages"};
+constexpr folly::StringPiece kCounterMappedMemorySizeClassPages{
+    "velox.mapped_memory_size_class_pages"};
+
+// ExchangeClient. Histograms of the queued bytes when a consumer takes a
+// page and of the time from request to response.
+constexpr folly::StringPiece kCounterExchangeQueueBytes{
+    "velox.exchange_queue_bytes"};
+constexpr folly::StringPiece kCounterExchangeFetchLatencyUs{
+    "velox.exchange_fetch_latency_us"};
+
+// IoStatistics. Bytes read from storage and a histogram of the latency of
+// each storage read.
+constexpr folly::StringPiece kCounterStorageReadBytes{
+    "velox.storage_read_bytes"};
+constexpr folly::StringPiece kCounterStorageReadLatencyUs{
+    "velox.storage_read_latency_us"};
 
 } // namespace facebook::velox
@@ -22,10 +22,21 @@
 namespace facebook {
 namespace velox {
 
+// Measures the time spent and the rows dropped by a filter. Used for
+// ordering filters by time per dropped row. The history is halved
+// after kMaxHistoryRows input rows, so that the order follows changes
+// in the data during a scan.
 class SelectivityInfo {
  public:
+  static constexpr uint64_t kMaxHistoryRows = 128 << 10;
+
   void addOutput(uint64_t numOut) {
     numOut_ += numOut;
+    if (numIn_ >= kMaxHistoryRows) {
+      numIn_ /= 2;
+      numOut_ /= 2;
+      timeClocks_ /= 2;
+    }
   }
 
   float timeToDropValue() const {
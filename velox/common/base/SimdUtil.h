@@ -17,6 +17,7 @@
 #pragma once
 
 #include <immintrin.h>
+#include <algorithm>
 #include <cstdint>
 #include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
@@ -755,6 +756,31 @@ gather8Bits(const uint64_t* bits, const int32_t* indices, int32_t numIndices) {
   return gather8Bits(bits, Vectors<int32_t>::load(indices), numIndices);
 }
 
+// Sets bit i of 'result' to bit 'indices[i]' of 'bits' for i below
+// 'numIndices', 8 bits per instruction. Used for propagating the
+// nulls of a dictionary base through the dictionary indices. Whole
+// bytes of 'result' are written, so that the bits past 'numIndices'
+// in the last byte are cleared.
+inline void gatherBits(
+    const uint64_t* bits,
+    const int32_t* indices,
+    int32_t numIndices,
+    uint64_t* result) {
+  constexpr int32_t kStep = Vectors<int32_t>::VSize;
+  auto resultBytes = reinterpret_cast<uint8_t*>(result);
+  int32_t i = 0;
+  for (; i + kStep <= numIndices; i += kStep) {
+    resultBytes[i / kStep] = gather8Bits(bits, indices + i, kStep);
+  }
+  if (i < numIndices) {
+    // Copies the last indices so that the load does not read past
+    // 'indices'.
+    int32_t last[kStep] = {};
+    std::copy(indices + i, indices + numIndices, last);
+    resultBytes[i / kStep] = gather8Bits(bits, last, numIndices - i);
+  }
+}
+
 template <typename TData, typename TIndices>
 void storePermute(void* /*ptr*/, TData /*data*/, TIndices /*indices*/) {
   static_assert("storePermute undefined");
@@ -18,6 +18,7 @@
 
 #include <folly/Singleton.h>
 #include <memory>
+#include <vector>
 
 /// StatsReporter designed to assist in reporting various stats of the
 /// application that uses velox library. The library itself does not implement
@@ -44,6 +45,15 @@
 ///   REPORT_ADD_STAT_VALUE("my_stat1");
 ///   REPORT_ADD_STAT_VALUE("my_stat2", 10);
 ///   REPORT_ADD_STAT_VALUE("my_stat1", numOfFailures);
+///
+/// A stat of type HISTOGRAM is registered with its buckets and the
+/// percentiles to export. Each value is then added to the histogram:
+///
+///   REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES(
+///       "my_latency_us", 1'000, 0, 100'000, 50, 90, 99);
+///   REPORT_ADD_HISTOGRAM_VALUE("my_latency_us", latencyUs);
+///
+/// The stats of the library are named and registered in Counters.h.
 
 namespace facebook::velox {
 
@@ -52,6 +62,7 @@ enum class StatType {
   SUM,
   RATE,
   COUNT,
+  HISTOGRAM,
 };
 
 // This is the base stats reporter interface that should be extended by
@@ -70,6 +81,19 @@ class BaseStatsReporter {
   virtual void addStatValue(const char* key, size_t value = 1) const = 0;
 
   virtual void addStatValue(folly::StringPiece key, size_t value = 1) const = 0;
+
+  // Registers 'key' as a histogram with buckets of 'bucketWidth' between
+  // 'min' and 'max' that exports 'percentiles'.
+  virtual void addHistogramExportPercentiles(
+      folly::StringPiece /*key*/,
+      int64_t /*bucketWidth*/,
+      int64_t /*min*/,
+      int64_t /*max*/,
+      const std::vector<int32_t>& /*percentiles*/) const {}
+
+  // Adds 'value' to the histogram 'key'.
+  virtual void addHistogramValue(folly::StringPiece /*key*/, size_t /*value*/)
+      const {}
 };
 
 // This is a dummy reporter that does nothing
@@ -108,4 +132,23 @@ class DummyStatsReporter : public BaseStatsReporter {
     }                                                                         \
   }
 
+#define REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES(k, width, min, max, ...)      \
+  {                                                                           \
+    auto reporter =                                                           \
+        folly::Singleton<facebook::velox::BaseStatsReporter>::try_get_fast(); \
+    if (LIKELY(reporter != nullptr)) {                                        \
+      reporter->addHistogramExportPercentiles(                                \
+          (k), (width), (min), (max), {__VA_ARGS__});                         \
+    }                                                                         \
+  }
+
+#define REPORT_ADD_HISTOGRAM_VALUE(k, v)                                      \
+  {                                                                           \
+    auto reporter =                                                           \
+        folly::Singleton<facebook::velox::BaseStatsReporter>::try_get_fast(); \
+    if (LIKELY(reporter != nullptr)) {                                        \
+      reporter->addHistogramValue((k), (v));                                  \
+    }                                                                         \
+  }
+
 } // namespace facebook::velox
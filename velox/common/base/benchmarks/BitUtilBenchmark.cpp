@@ -18,6 +18,7 @@
 #include <folly/init/Init.h>
 
 #include "velox/common/base/BitUtil.h"
+#include "velox/common/base/SimdUtil.h"
 DECLARE_bool(bmi2); // NOLINT
 
 namespace facebook {
@@ -141,6 +142,43 @@ BENCHMARK_RELATIVE(BM_scatterBits, n) {
   runScatterBits(n, false);
 }
 
+// Gathers the bits of a 64K bitmap at 10K pseudo-random indices, as
+// when propagating the nulls of a dictionary base to the rows.
+void runGatherBits(int32_t n, bool isSimple) {
+  constexpr int32_t kNumIndices = 10'000;
+  std::vector<uint64_t> source;
+  std::vector<int32_t> indices;
+  std::vector<uint64_t> target;
+  BENCHMARK_SUSPEND {
+    source.resize(1024, 0x1234567890abcdef);
+    indices.resize(kNumIndices);
+    for (auto i = 0; i < kNumIndices; ++i) {
+      indices[i] = (i * 7919) % (source.size() * 64);
+    }
+    target.resize(bits::nwords(kNumIndices));
+  }
+  for (auto i = 0; i < n; ++i) {
+    if (isSimple) {
+      for (auto j = 0; j < kNumIndices; ++j) {
+        bits::setBit(
+            target.data(), j, bits::isBitSet(source.data(), indices[j]));
+      }
+    } else {
+      simd::gatherBits(
+          source.data(), indices.data(), kNumIndices, target.data());
+    }
+  }
+  folly::doNotOptimizeAway(target);
+}
+
+BENCHMARK(BM_gatherBitsSimple, n) {
+  runGatherBits(n, true);
+}
+
+BENCHMARK_RELATIVE(BM_gatherBits, n) {
+  runGatherBits(n, false);
+}
+
 } // namespace test
 } // namespace velox
 } // namespace facebook
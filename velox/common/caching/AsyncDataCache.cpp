@@ -15,10 +15,16 @@
  */
 
 #include "velox/common/caching/AsyncDataCache.h"
+#include "velox/common/caching/CachePolicy.h"
 #include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+#include "velox/common/process/TraceRecorder.h"
 
 #include <folly/executors/QueuedImmediateExecutor.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace facebook::velox::cache {
 
 using memory::MachinePageCount;
@@ -40,6 +46,19 @@ void AsyncDataCacheEntry::setExclusiveToShared() {
   }
 }
 
+int32_t AsyncDataCacheEntry::score(AccessTime now) const {
+  return shard_->cache()->policy().score(*this, now);
+}
+
+void AsyncDataCacheEntry::setValid(bool success) {
+  VELOX_CHECK_NE(0, numPins_);
+  dataValid_ = success;
+  load_.reset();
+  if (success && ssdSaveable_ && !ssdFile_) {
+    shard_->cache()->possibleSsdSave(size_);
+  }
+}
+
 void AsyncDataCacheEntry::release() {
   VELOX_CHECK_NE(0, numPins_);
   if (!dataValid_) {
@@ -115,6 +134,7 @@ CachePin CacheShard::findOrCreate(
     RawFileCacheKey key,
     uint64_t size,
     folly::SemiFuture<bool>* wait) {
+  cache_->policy().recordAccess(key);
   AsyncDataCacheEntry* entryToInit = nullptr;
   {
     std::lock_guard<std::mutex> l(mutex_);
@@ -124,6 +144,7 @@ CachePin CacheShard::findOrCreate(
       auto found = it->second;
       if (found->isExclusive()) {
         ++numWaitExclusive_;
+        process::traceInstant("waitExclusive", "cache", size);
         if (!wait) {
           return CachePin();
         }
@@ -135,19 +156,24 @@ CachePin CacheShard::findOrCreate(
       if (found->isPrefetch_) {
         found->isFirstUse_ = true;
         found->setPrefetch(false);
+        process::traceInstant("prefetchHit", "cache", size);
       } else {
         ++numHit_;
+        process::traceInstant("hit", "cache", size);
       }
       ++found->numPins_;
       CachePin pin;
       pin.setEntry(found);
       return pin;
     } else {
+      process::traceInstant("miss", "cache", size);
       auto newEntry = getFreeEntryWithSize(size);
       // Initialize the members that must be set inside 'mutex_'.
       newEntry->numPins_ = AsyncDataCacheEntry::kExclusive;
       newEntry->promise_ = nullptr;
       newEntry->dataValid_ = false;
+      newEntry->ssdSaveable_ = false;
+      newEntry->ssdFile_ = nullptr;
       entryToInit = newEntry.get();
       entryMap_[key] = newEntry.get();
       if (emptySlots_.empty()) {
@@ -181,7 +207,15 @@ CachePin CacheShard::initEntry(
     } else {
       auto sizePages = bits::roundUp(size, MappedMemory::kPageSize) /
           MappedMemory::kPageSize;
-      if (cache_->allocate(sizePages, kCacheOwner, entry->data_)) {
+      // The entry is created by the thread that will read it, while the
+      // data may be loaded on an IO thread on another node.
+      if (cache_->allocate(
+              sizePages,
+              kCacheOwner,
+              entry->data_,
+              nullptr,
+              0,
+              MappedMemory::currentNumaNode())) {
         cache_->incrementCachedPages(entry->data().numPages());
       } else {
         // No memory to cover the new entry. The entry is in exclusive
@@ -198,6 +232,9 @@ CachePin CacheShard::initEntry(
   }
   entry->touch();
   entry->size_ = size;
+  entry->retention_ = cache_->policy().admit(key, size)
+      ? CacheRetention::kNormal
+      : CacheRetention::kNoRetain;
   CachePin pin;
   pin.setEntry(entry);
   return pin;
@@ -212,6 +249,7 @@ FusedLoad::~FusedLoad() {
 }
 
 bool FusedLoad::loadOrFuture(folly::SemiFuture<bool>* wait) {
+  bool cancelled;
   {
     std::lock_guard<std::mutex> l(mutex_);
     if (state_ == LoadState::kCancelled || state_ == LoadState::kLoaded) {
@@ -228,10 +266,20 @@ bool FusedLoad::loadOrFuture(folly::SemiFuture<bool>* wait) {
       return false;
     }
     VELOX_CHECK_EQ(LoadState::kPlanned, state_);
-    state_ = LoadState::kLoading;
+    // A prefetch for a terminated query would only hold IO and memory
+    // that nobody reads.
+    cancelled = !wait && cancellationToken_.isCancellationRequested();
+    if (!cancelled) {
+      state_ = LoadState::kLoading;
+    }
+  }
+  if (cancelled) {
+    cancel();
+    return true;
   }
   // Outside of 'mutex_'.
   try {
+    process::TraceSpan span("FusedLoad", "cache", pins_.size());
     // If wait is not set this counts as prefetch.
     loadData(!wait);
     for (auto& pin : pins_) {
@@ -336,10 +384,16 @@ void CacheShard::evict(uint64_t bytesToFree, bool evictAllUnpinned) {
         numChecked = 0;
         eventCounter_ = 0;
       }
+      if (candidate->numPins_ != 0 ||
+          (candidate->retention_ == CacheRetention::kPin &&
+           candidate->key_.fileNum.hasValue() && !evictAllUnpinned)) {
+        continue;
+      }
       int32_t score = 0;
-      if (candidate->numPins_ == 0 &&
-          (!candidate->key_.fileNum.hasValue() || evictAllUnpinned ||
-           (score = candidate->score(now)) >= evictionThreshold_)) {
+      if (!candidate->key_.fileNum.hasValue() || evictAllUnpinned ||
+          (candidate->retention_ == CacheRetention::kNoRetain &&
+           !candidate->isPrefetch_) ||
+          (score = candidate->score(now)) >= evictionThreshold_) {
         removeEntryLocked(candidate);
         freeEntries_.push_back(std::move(*iter));
         emptySlots_.push_back(entryIndex);
@@ -417,22 +471,54 @@ void CacheShard::updateStats(CacheStats& stats) {
   stats.allocClocks += allocClocks_;
 }
 
+void CacheShard::appendSsdSaveable(std::vector<CachePin>& pins) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& entry : entries_) {
+    if (!entry || !entry->key_.fileNum.hasValue() || !entry->dataValid_ ||
+        entry->isExclusive() || !entry->ssdSaveable_ || entry->ssdFile_) {
+      continue;
+    }
+    entry->ssdSaveable_ = false;
+    ++entry->numPins_;
+    CachePin pin;
+    pin.setEntry(entry.get());
+    pins.push_back(std::move(pin));
+  }
+}
+
 AsyncDataCache::AsyncDataCache(
     std::unique_ptr<MappedMemory> mappedMemory,
-    uint64_t maxBytes)
+    uint64_t maxBytes,
+    std::unique_ptr<SsdCache> ssdCache,
+    int32_t numShards,
+    folly::Executor* evictionExecutor)
     : mappedMemory_(std::move(mappedMemory)),
+      ssdCache_(std::move(ssdCache)),
+      shardMask_(shardCount(numShards) - 1),
+      evictionExecutor_(evictionExecutor),
       cachedPages_(0),
       maxBytes_(maxBytes) {
-  for (auto i = 0; i < kNumShards; ++i) {
+  policy_ = std::make_unique<ClockPolicy>();
+  for (auto i = 0; i <= shardMask_; ++i) {
     shards_.push_back(std::make_unique<CacheShard>(this));
   }
 }
 
+AsyncDataCache::~AsyncDataCache() {
+  while (evictionInProgress_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (ssdCache_) {
+    // A write in progress holds pins on entries of 'this'.
+    ssdCache_->waitForWrite();
+  }
+}
+
 CachePin AsyncDataCache::findOrCreate(
     RawFileCacheKey key,
     uint64_t size,
     folly::SemiFuture<bool>* wait) {
-  int shard = std::hash<RawFileCacheKey>()(key) & (kShardMask);
+  int shard = std::hash<RawFileCacheKey>()(key) & shardMask_;
   return shards_[shard]->findOrCreate(key, size, wait);
 }
 
@@ -441,27 +527,98 @@ bool AsyncDataCache::allocate(
     int32_t owner,
     Allocation& out,
     std::function<void(int64_t)> beforeAllocCB,
-    MachinePageCount minSizeClass) {
-  constexpr int32_t kMaxAttempts = kNumShards * 4;
+    MachinePageCount minSizeClass,
+    int32_t numaNode) {
+  const int32_t numShards = shards_.size();
+  const int32_t maxAttempts = numShards * 4;
   free(out);
-  for (auto nthAttempt = 0; nthAttempt < kMaxAttempts; ++nthAttempt) {
+  for (auto nthAttempt = 0; nthAttempt < maxAttempts; ++nthAttempt) {
     if (mappedMemory_->numAllocated() + numPages <
         maxBytes_ / MappedMemory::kPageSize) {
       if (mappedMemory_->allocate(
-              numPages, owner, out, beforeAllocCB, minSizeClass)) {
+              numPages, owner, out, beforeAllocCB, minSizeClass, numaNode)) {
+        maybeStartBackgroundEviction();
         return true;
       }
     }
-    ++shardCounter_;
     // Evict from next shard. If we have gone through all shards once
     // and still have not made the allocation, we go to desperate mode
     // with 'evictAllUnpinned' set to true.
-    shards_[shardCounter_ & (kShardMask)]->evict(
-        numPages * MappedMemory::kPageSize, nthAttempt >= kNumShards);
+    shards_[++shardCounter_ & shardMask_]->evict(
+        numPages * MappedMemory::kPageSize, nthAttempt >= numShards);
   }
   return false;
 }
 
+void AsyncDataCache::setPolicy(std::unique_ptr<CachePolicy> policy) {
+  VELOX_CHECK_NOT_NULL(policy);
+  policy_ = std::move(policy);
+}
+
+// static
+int32_t AsyncDataCache::shardCount(int32_t numShards) {
+  if (numShards <= 0) {
+    numShards = std::clamp<int32_t>(
+        std::thread::hardware_concurrency(), kMinShards, kMaxShards);
+  }
+  return bits::nextPowerOfTwo(numShards);
+}
+
+void AsyncDataCache::maybeStartBackgroundEviction() {
+  if (!evictionExecutor_ ||
+      mappedMemory_->numAllocated() * 100 <
+          maxBytes_ / MappedMemory::kPageSize * kBackgroundEvictStartPct ||
+      evictionInProgress_.exchange(true)) {
+    return;
+  }
+  evictionExecutor_->add([this]() {
+    evictInBackground();
+    evictionInProgress_ = false;
+  });
+}
+
+void AsyncDataCache::evictInBackground() {
+  const MachinePageCount targetPages =
+      maxBytes_ / MappedMemory::kPageSize * kBackgroundEvictTargetPct / 100;
+  // Goes over the shards at most twice.
+  for (auto i = 0; i < 2 * shards_.size(); ++i) {
+    auto numAllocated = mappedMemory_->numAllocated();
+    if (numAllocated <= targetPages) {
+      return;
+    }
+    shards_[++shardCounter_ & shardMask_]->evict(
+        (numAllocated - targetPages) * MappedMemory::kPageSize, false);
+  }
+}
+
+void AsyncDataCache::possibleSsdSave(uint64_t bytes) {
+  if (!ssdCache_) {
+    return;
+  }
+  if ((ssdSaveableBytes_ += bytes) >= kMinSsdSaveBytes) {
+    saveToSsd();
+  }
+}
+
+void AsyncDataCache::saveToSsd() {
+  if (!ssdCache_ || !ssdCache_->startWrite()) {
+    return;
+  }
+  ssdSaveableBytes_ = 0;
+  std::vector<CachePin> pins;
+  for (auto& shard : shards_) {
+    shard->appendSsdSaveable(pins);
+  }
+  auto* executor = ssdCache_->executor();
+  if (!executor) {
+    ssdCache_->write(std::move(pins));
+    return;
+  }
+  executor->add([this, pins = std::move(pins)]() mutable {
+    ssdCache_->write(std::move(pins));
+  });
+}
+
 CacheStats AsyncDataCache::refreshStats() const {
   CacheStats stats;
   for (auto& shard : shards_) {
@@ -481,6 +638,9 @@ std::string AsyncDataCache::toString() const {
       << stats.numEvict << "\n"
       << " read pins " << stats.numShared << " unused prefetch "
       << stats.numPrefetch << " Alloc Mclks " << (stats.allocClocks >> 20);
+  if (ssdCache_) {
+    out << "\n" << ssdCache_->toString();
+  }
   return out.str();
 }
 
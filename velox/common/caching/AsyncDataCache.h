@@ -18,6 +18,8 @@
 
 #include <deque>
 
+#include <folly/CancellationToken.h>
+#include <folly/Executor.h>
 #include <folly/chrono/Hardware.h>
 #include <folly/futures/SharedPromise.h>
 #include "velox/common/base/BitUtil.h"
@@ -28,7 +30,10 @@
 namespace facebook::velox::cache {
 
 class AsyncDataCache;
+class CachePolicy;
 class CacheShard;
+class SsdCache;
+class SsdFile;
 
 // Type for tracking last access. This is based on CPU clock and
 // scaled to be around 1ms resolution. This can wrap around and is
@@ -64,6 +69,11 @@ struct AccessStats {
   }
 };
 
+// Hint for retaining a cache entry. A kNoRetain entry is evicted at
+// first sight once it is unpinned and no longer an unused prefetch. A
+// kPin entry is evicted only when there is no other way to make space.
+enum class CacheRetention { kNormal, kNoRetain, kPin };
+
 // Owning reference to a file number and an offset.
 struct FileCacheKey {
   StringIdLease fileNum;
@@ -156,18 +166,27 @@ class AsyncDataCacheEntry {
   }
 
   // Call this after loading the data and before releasing the pin.
-  void setValid(bool success = true) {
-    VELOX_CHECK_NE(0, numPins_);
-    dataValid_ = success;
-    load_.reset();
-  }
+  void setValid(bool success = true);
 
   void touch() {
     accessStats_.touch();
   }
 
-  int32_t score(AccessTime now) const {
-    return accessStats_.score(now, size_);
+  // Returns the score of 'this' from the CachePolicy of the cache.
+  int32_t score(AccessTime now) const;
+
+  const AccessStats& accessStats() const {
+    return accessStats_;
+  }
+
+  // Sets the retention hint. Requires exclusive access.
+  void setRetention(CacheRetention retention) {
+    VELOX_CHECK(isExclusive());
+    retention_ = retention;
+  }
+
+  CacheRetention retention() const {
+    return retention_;
   }
 
   bool isShared() const {
@@ -216,6 +235,32 @@ class AsyncDataCacheEntry {
 
   void setExclusiveToShared();
 
+  // Sets 'this' to be written to the SSD cache, if any, after it is
+  // loaded.
+  void setSsdSaveable(bool saveable = true) {
+    ssdSaveable_ = saveable;
+  }
+
+  bool ssdSaveable() const {
+    return ssdSaveable_;
+  }
+
+  // Records that the data of 'this' is also at 'offset' in 'file'.
+  void setSsdFile(SsdFile* file, uint64_t offset) {
+    ssdFile_ = file;
+    ssdOffset_ = offset;
+  }
+
+  // Returns the SsdFile with a copy of the data or nullptr if the data
+  // is not on SSD.
+  SsdFile* ssdFile() const {
+    return ssdFile_;
+  }
+
+  uint64_t ssdOffset() const {
+    return ssdOffset_;
+  }
+
  private:
   void release();
   void addReference();
@@ -253,6 +298,7 @@ class AsyncDataCacheEntry {
   // Setting this from 0 to 1 or to kExclusive requires owning shard_->mutex_.
   std::atomic<int32_t> numPins_{0};
   AccessStats accessStats_;
+  CacheRetention retention_{CacheRetention::kNormal};
   // True if 'this' is speculatively loaded. This is reset on first
   // hit. Allows catching a situation where prefetched entries get
   // evicted before they are hit.
@@ -268,6 +314,16 @@ class AsyncDataCacheEntry {
   // mutex. If set, 'this' is pinned for either exclusive or shared.
   std::shared_ptr<FusedLoad> load_;
 
+  // True if 'this' should be written to SSD after loading. Set by the
+  // thread holding 'this' exclusive. Cleared inside the mutex of
+  // 'shard_' when the write is scheduled.
+  bool ssdSaveable_{false};
+
+  // The SsdFile and offset of the copy of the data on SSD, if any. An
+  // entry on SSD can be evicted without losing the data.
+  SsdFile* ssdFile_{nullptr};
+  uint64_t ssdOffset_{0};
+
   friend class CacheShard;
   friend class CachePin;
 };
@@ -375,11 +431,18 @@ class FusedLoad : public std::enable_shared_from_this<FusedLoad> {
 
   virtual ~FusedLoad();
 
+  // Sets a token whose cancellation makes a prefetch that has not
+  // started cancel 'this' instead of doing the IO. Call before
+  // initialize().
+  void setCancellationToken(folly::CancellationToken token) {
+    cancellationToken_ = std::move(token);
+  }
+
   // Loads the pinned entries on first call. Returns true if the
   // pins are loaded. If returns false, 'wait' is set to a future
   // that is realized when the load is ready. The caller must
   // further check that the pin it holds is in a valid state before
-  // using the data since the load may have failed.
+  // using the data since the load may have failed or been cancelled.
   bool loadOrFuture(folly::SemiFuture<bool>* wait);
 
   // Removes 'this' from the affected entries. If 'this' is already
@@ -423,6 +486,9 @@ class FusedLoad : public std::enable_shared_from_this<FusedLoad> {
   // entries in shared mode. The entries will block other readers until 'this'
   // lets go of the entries because 'load_' of the entry is set.
   std::vector<CachePin> pins_;
+
+  // Cancelled when the query that scheduled 'this' is terminated.
+  folly::CancellationToken cancellationToken_;
   static std::atomic<int32_t> numFusedLoads_;
 };
 
@@ -519,6 +585,11 @@ class CacheShard {
   // Adds the stats of 'this' to 'stats'.
   void updateStats(CacheStats& stats);
 
+  // Appends a shared pin to 'pins' for each loaded entry that is
+  // saveable to SSD and not yet there. Clears the saveable flag of the
+  // entries.
+  void appendSsdSaveable(std::vector<CachePin>& pins);
+
  private:
   static constexpr int32_t kNoThreshold = std::numeric_limits<int32_t>::max();
   void calibrateThreshold();
@@ -567,9 +638,21 @@ class CacheShard {
 class AsyncDataCache : public memory::MappedMemory,
                        public std::enable_shared_from_this<AsyncDataCache> {
  public:
+  // Constructs a cache of 'maxBytes' in 'mappedMemory'. Entries that
+  // are marked saveable are also written to 'ssdCache' if given. The
+  // entries are divided into 'numShards' shards, rounded up to a power
+  // of 2. 0 means a count proportional to the number of cores. If
+  // 'evictionExecutor' is given, entries are evicted on it when the
+  // cache is nearly full, so that allocation rarely has to evict
+  // inline.
   AsyncDataCache(
       std::unique_ptr<memory::MappedMemory> mappedMemory,
-      uint64_t maxBytes);
+      uint64_t maxBytes,
+      std::unique_ptr<SsdCache> ssdCache = nullptr,
+      int32_t numShards = 0,
+      folly::Executor* evictionExecutor = nullptr);
+
+  ~AsyncDataCache() override;
 
   // Finds or creates a cache entry corresponding to 'key'. The entry
   // is returned in 'pin'. If the entry is new, it is pinned in
@@ -592,7 +675,8 @@ class AsyncDataCache : public memory::MappedMemory,
       int32_t owner,
       Allocation& out,
       std::function<void(int64_t)> beforeAllocCB = nullptr,
-      memory::MachinePageCount minSizeClass = 0) override;
+      memory::MachinePageCount minSizeClass = 0,
+      int32_t numaNode = kAnyNumaNode) override;
 
   int64_t free(Allocation& allocation) override {
     return mappedMemory_->free(allocation);
@@ -614,6 +698,15 @@ class AsyncDataCache : public memory::MappedMemory,
     return mappedMemory_->numMapped();
   }
 
+  memory::MachinePageCount numHugeAllocated() const override {
+    return mappedMemory_->numHugeAllocated();
+  }
+
+  memory::MachinePageCount numAllocatedInSizeClass(
+      int32_t sizeIndex) const override {
+    return mappedMemory_->numAllocatedInSizeClass(sizeIndex);
+  }
+
   CacheStats refreshStats() const;
 
   std::string toString() const;
@@ -632,12 +725,64 @@ class AsyncDataCache : public memory::MappedMemory,
     return maxBytes_;
   }
 
+  int32_t numShards() const {
+    return shards_.size();
+  }
+
+  SsdCache* ssdCache() const {
+    return ssdCache_.get();
+  }
+
+  CachePolicy& policy() const {
+    return *policy_;
+  }
+
+  // Replaces the default ClockPolicy. Must be called before 'this' is
+  // used.
+  void setPolicy(std::unique_ptr<CachePolicy> policy);
+
+  // Records that a saveable entry of 'bytes' was loaded. Starts a
+  // write to SSD when enough data is pending.
+  void possibleSsdSave(uint64_t bytes);
+
+  // Starts writing the saveable entries to SSD unless a write is
+  // already in progress. The write runs on the executor of the
+  // SsdCache if set, else on the calling thread.
+  void saveToSsd();
+
  private:
-  static constexpr int32_t kNumShards = 4; // Must be power of 2.
-  static constexpr int32_t kShardMask = kNumShards - 1;
+  // Bounds for the default shard count.
+  static constexpr int32_t kMinShards = 4;
+  static constexpr int32_t kMaxShards = 256;
+  // Percentages of capacity in use at which background eviction starts
+  // and down to which it evicts.
+  static constexpr int32_t kBackgroundEvictStartPct = 95;
+  static constexpr int32_t kBackgroundEvictTargetPct = 90;
+  // Size of pending saveable entries that starts a write to SSD.
+  static constexpr uint64_t kMinSsdSaveBytes = 16 << 20;
+
+  // Returns the shard count for 'numShards' given to the constructor.
+  static int32_t shardCount(int32_t numShards);
+
+  // Schedules evictInBackground() on 'evictionExecutor_' if the cache
+  // is nearly full and no background eviction is in progress.
+  void maybeStartBackgroundEviction();
+
+  // Evicts entries until kBackgroundEvictTargetPct of capacity is in
+  // use.
+  void evictInBackground();
+
   std::unique_ptr<memory::MappedMemory> mappedMemory_;
+  std::unique_ptr<CachePolicy> policy_;
+  std::unique_ptr<SsdCache> ssdCache_;
+  // Bytes of saveable entries loaded since the last write to SSD.
+  std::atomic<uint64_t> ssdSaveableBytes_{0};
   std::vector<std::unique_ptr<CacheShard>> shards_;
-  int32_t shardCounter_{};
+  // shards_.size() - 1.
+  int32_t shardMask_;
+  std::atomic<int32_t> shardCounter_{};
+  folly::Executor* const evictionExecutor_;
+  std::atomic<bool> evictionInProgress_{false};
   std::atomic<memory::MachinePageCount> cachedPages_{0};
   // Number of pages that are allocated and not yet loaded or loaded
   // but not yet hit for the first time.
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/CachePolicy.h"
+
+namespace facebook::velox::cache {
+
+FrequencyPolicy::FrequencyPolicy(
+    int32_t sketchWidth,
+    int32_t minAdmitFrequency)
+    : width_(sketchWidth),
+      minAdmitFrequency_(minAdmitFrequency),
+      sampleSize_(10 * sketchWidth),
+      counters_(kNumRows * sketchWidth) {
+  VELOX_CHECK_GT(sketchWidth, 0);
+  VELOX_CHECK_LE(sketchWidth, 1 << 16);
+  VELOX_CHECK_EQ(0, sketchWidth & (sketchWidth - 1));
+}
+
+void FrequencyPolicy::recordAccess(RawFileCacheKey key) {
+  auto hash = std::hash<RawFileCacheKey>()(key);
+  for (auto row = 0; row < kNumRows; ++row) {
+    auto& count = counter(hash, row);
+    auto value = count.load(std::memory_order_relaxed);
+    if (value < kMaxCount) {
+      count.store(value + 1, std::memory_order_relaxed);
+    }
+  }
+  if (++numAccesses_ % sampleSize_ == 0) {
+    halve();
+  }
+}
+
+int32_t FrequencyPolicy::frequency(RawFileCacheKey key) const {
+  auto hash = std::hash<RawFileCacheKey>()(key);
+  int32_t result = kMaxCount;
+  for (auto row = 0; row < kNumRows; ++row) {
+    result = std::min<int32_t>(
+        result, counter(hash, row).load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+int32_t FrequencyPolicy::score(
+    const AsyncDataCacheEntry& entry,
+    AccessTime now) const {
+  RawFileCacheKey key{entry.key().fileNum.id(), entry.key().offset};
+  return entry.accessStats().score(now, entry.size()) /
+      std::max(1, frequency(key));
+}
+
+void FrequencyPolicy::halve() {
+  for (auto& count : counters_) {
+    count.store(
+        count.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+  }
+}
+
+} // namespace facebook::velox::cache
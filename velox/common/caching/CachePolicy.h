@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "velox/common/caching/AsyncDataCache.h"
+
+namespace facebook::velox::cache {
+
+// Decides which entries AsyncDataCache retains. A CacheShard evicts
+// unpinned entries whose score() is at or above a sampled percentile
+// of the scores in the shard. Entries that are not admitted get
+// CacheRetention::kNoRetain and are evicted at first sight once
+// they are unpinned.
+class CachePolicy {
+ public:
+  virtual ~CachePolicy() = default;
+
+  // Records a lookup of 'key'. Called for hits and misses.
+  virtual void recordAccess(RawFileCacheKey /*key*/) {}
+
+  // Returns true if a new entry of 'size' bytes for 'key' should be
+  // retained after its first use.
+  virtual bool admit(RawFileCacheKey key, uint64_t size) = 0;
+
+  // Returns the retention score of 'entry'. A higher score means less
+  // worth retaining. 'now' is the current accessTime().
+  virtual int32_t score(const AsyncDataCacheEntry& entry, AccessTime now)
+      const = 0;
+};
+
+// Admits all entries and scores by time since last use over use count.
+class ClockPolicy : public CachePolicy {
+ public:
+  bool admit(RawFileCacheKey /*key*/, uint64_t /*size*/) override {
+    return true;
+  }
+
+  int32_t score(const AsyncDataCacheEntry& entry, AccessTime now)
+      const override {
+    return entry.accessStats().score(now, entry.size());
+  }
+};
+
+// TinyLFU style policy. Keeps an approximate count of recent lookups
+// per key in a count-min sketch. The counts are halved after every
+// 10 * 'sketchWidth' lookups so that they follow recent use. A new
+// entry is admitted only if its key was looked up at least
+// 'minAdmitFrequency' times, so that data read once, e.g. by a one-off
+// full scan, does not displace the working set. The clock score is
+// divided by the count.
+class FrequencyPolicy : public CachePolicy {
+ public:
+  static constexpr int32_t kDefaultSketchWidth = 1 << 16;
+  static constexpr int32_t kDefaultMinAdmitFrequency = 2;
+
+  // 'sketchWidth' must be a power of 2 and at most 64K.
+  explicit FrequencyPolicy(
+      int32_t sketchWidth = kDefaultSketchWidth,
+      int32_t minAdmitFrequency = kDefaultMinAdmitFrequency);
+
+  void recordAccess(RawFileCacheKey key) override;
+
+  bool admit(RawFileCacheKey key, uint64_t /*size*/) override {
+    return frequency(key) >= minAdmitFrequency_;
+  }
+
+  int32_t score(const AsyncDataCacheEntry& entry, AccessTime now)
+      const override;
+
+  // Returns the approximate count of recent lookups of 'key'.
+  int32_t frequency(RawFileCacheKey key) const;
+
+ private:
+  static constexpr int32_t kNumRows = 4;
+  static constexpr uint8_t kMaxCount = 15;
+
+  std::atomic<uint8_t>& counter(uint64_t hash, int32_t row) const {
+    return counters_[row * width_ + ((hash >> (row * 16)) & (width_ - 1))];
+  }
+
+  void halve();
+
+  const int32_t width_;
+  const int32_t minAdmitFrequency_;
+  const int64_t sampleSize_;
+  // kNumRows rows of 'width_' counters. Updates are relaxed and may be
+  // lost under contention, which only makes the counts less exact.
+  mutable std::vector<std::atomic<uint8_t>> counters_;
+  std::atomic<int64_t> numAccesses_{0};
+};
+
+} // namespace facebook::velox::cache
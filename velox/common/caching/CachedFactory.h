@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <memory>
@@ -111,6 +112,23 @@ class CachedPtr {
   std::mutex* mu_;
 };
 
+// Counters of a CachedFactory.
+struct CachedFactoryStats {
+  // Calls to generate() that found the value in the cache.
+  int64_t numHits{0};
+  // Calls to generate() that waited for another thread generating the
+  // same key.
+  int64_t numWaits{0};
+  // Runs of the Generator.
+  int64_t numGenerated{0};
+  // Runs of the Generator that threw.
+  int64_t numGenerateErrors{0};
+  // Values dropped from the cache by invalidate().
+  int64_t numInvalidated{0};
+  // Values dropped from the cache because they expired.
+  int64_t numExpired{0};
+};
+
 template <typename Value>
 struct DefaultSizer {
   int64_t operator()(const Value& value) const {
@@ -176,6 +194,13 @@ class CachedFactory {
     return cache_->maxSize();
   }
 
+  // Drops the cached value for 'key', e.g. because the underlying data
+  // changed. The next generate() runs the Generator. Values handed out
+  // before stay valid until their CachedPtrs are destroyed.
+  void invalidate(const Key& key);
+
+  CachedFactoryStats stats();
+
   // Move allowed, copy disallowed.
   CachedFactory(CachedFactory&&) = default;
   CachedFactory& operator=(CachedFactory&&) = default;
@@ -190,6 +215,12 @@ class CachedFactory {
   std::mutex cacheMu_;
   std::mutex pendingMu_;
   std::condition_variable pendingCv_;
+
+  std::atomic<int64_t> numHits_{0};
+  std::atomic<int64_t> numWaits_{0};
+  std::atomic<int64_t> numGenerated_{0};
+  std::atomic<int64_t> numGenerateErrors_{0};
+  std::atomic<int64_t> numInvalidated_{0};
 };
 
 //
@@ -272,9 +303,9 @@ void CachedPtr<Key, Value, Comparator, Hash>::clear() {
   if (cache_) {
     if (mu_) {
       std::lock_guard<std::mutex> l(*mu_);
-      cache_->release(*key_);
+      cache_->release(*key_, value_);
     } else {
-      cache_->release(*key_);
+      cache_->release(*key_, value_);
     }
   } else {
     delete value_;
@@ -296,6 +327,7 @@ CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
     std::lock_guard<std::mutex> cache_lock(cacheMu_);
     Value* value = cache_->get(key);
     if (value) {
+      ++numHits_;
       return CachedPtr<Key, Value, Comparator, Hash>(
           /*wasCached=*/true,
           value,
@@ -305,6 +337,7 @@ CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
     }
   }
   if (pending_.contains(key)) {
+    ++numWaits_;
     pendingCv_.wait(pending_lock, [&]() { return !pending_.contains(key); });
     // Will normally hit the cache now.
     {
@@ -327,8 +360,10 @@ CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
     std::unique_ptr<Value> generatedValue;
     // TODO: consider using folly/ScopeGuard here.
     try {
+      ++numGenerated_;
       generatedValue = (*generator_)(key);
     } catch (const std::exception& e) {
+      ++numGenerateErrors_;
       {
         std::lock_guard<std::mutex> pending_lock(pendingMu_);
         pending_.erase(key);
@@ -364,6 +399,41 @@ CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
   }
 }
 
+template <
+    typename Key,
+    typename Value,
+    typename Generator,
+    typename Sizer,
+    typename Comparator,
+    typename Hash>
+void CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::invalidate(
+    const Key& key) {
+  std::lock_guard<std::mutex> cache_lock(cacheMu_);
+  if (cache_->invalidate(key)) {
+    ++numInvalidated_;
+  }
+}
+
+template <
+    typename Key,
+    typename Value,
+    typename Generator,
+    typename Sizer,
+    typename Comparator,
+    typename Hash>
+CachedFactoryStats
+CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::stats() {
+  CachedFactoryStats stats;
+  stats.numHits = numHits_;
+  stats.numWaits = numWaits_;
+  stats.numGenerated = numGenerated_;
+  stats.numGenerateErrors = numGenerateErrors_;
+  stats.numInvalidated = numInvalidated_;
+  std::lock_guard<std::mutex> cache_lock(cacheMu_);
+  stats.numExpired = cache_->numExpired();
+  return stats;
+}
+
 template <
     typename Key,
     typename Value,
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/caching/PeriodicStatsReporter.h"
+#include "velox/common/base/Counters.h"
+#include "velox/common/base/StatsReporter.h"
+
+#include <fmt/format.h>
+
+namespace facebook::velox::cache {
+namespace {
+std::string sizeClassKey(memory::MachinePageCount size) {
+  return fmt::format("{}.{}", kCounterMappedMemorySizeClassPages, size);
+}
+} // namespace
+
+PeriodicStatsReporter::PeriodicStatsReporter(
+    const AsyncDataCache* cache,
+    const memory::MappedMemory* mappedMemory)
+    : cache_(cache), mappedMemory_(mappedMemory ? mappedMemory : cache) {
+  if (mappedMemory_) {
+    for (auto size : mappedMemory_->sizes()) {
+      REPORT_ADD_STAT_EXPORT_TYPE(sizeClassKey(size).c_str(), StatType::AVG);
+    }
+  }
+  if (cache_) {
+    lastCacheStats_ = cache_->refreshStats();
+  }
+}
+
+void PeriodicStatsReporter::report() {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (cache_) {
+    reportCache();
+  }
+  if (mappedMemory_) {
+    reportMappedMemory();
+  }
+}
+
+void PeriodicStatsReporter::reportCache() {
+  auto stats = cache_->refreshStats();
+  REPORT_ADD_STAT_VALUE(kCounterCacheNumEntries, stats.numEntries);
+  REPORT_ADD_STAT_VALUE(
+      kCounterCacheCachedBytes, stats.tinySize + stats.largeSize);
+  REPORT_ADD_STAT_VALUE(kCounterCachePrefetchBytes, stats.prefetchBytes);
+  REPORT_ADD_STAT_VALUE(
+      kCounterCacheNumHits, stats.numHit - lastCacheStats_.numHit);
+  REPORT_ADD_STAT_VALUE(
+      kCounterCacheNumNew, stats.numNew - lastCacheStats_.numNew);
+  REPORT_ADD_STAT_VALUE(
+      kCounterCacheNumEvicts, stats.numEvict - lastCacheStats_.numEvict);
+  REPORT_ADD_STAT_VALUE(
+      kCounterCacheNumWaitExclusive,
+      stats.numWaitExclusive - lastCacheStats_.numWaitExclusive);
+  lastCacheStats_ = stats;
+}
+
+void PeriodicStatsReporter::reportMappedMemory() {
+  REPORT_ADD_STAT_VALUE(
+      kCounterMappedMemoryAllocatedPages, mappedMemory_->numAllocated());
+  REPORT_ADD_STAT_VALUE(
+      kCounterMappedMemoryMappedPages, mappedMemory_->numMapped());
+  REPORT_ADD_STAT_VALUE(
+      kCounterMappedMemoryHugePages, mappedMemory_->numHugeAllocated());
+  auto& sizes = mappedMemory_->sizes();
+  for (auto i = 0; i < sizes.size(); ++i) {
+    REPORT_ADD_STAT_VALUE(
+        sizeClassKey(sizes[i]), mappedMemory_->numAllocatedInSizeClass(i));
+  }
+}
+
+} // namespace facebook::velox::cache
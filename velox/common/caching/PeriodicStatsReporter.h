@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "velox/common/caching/AsyncDataCache.h"
+
+#include <mutex>
+
+namespace facebook::velox::cache {
+
+// Publishes the state of the AsyncDataCache and the MappedMemory of the
+// process through the BaseStatsReporter. The subsystems already count in
+// sharded or atomic counters, so that nothing is added to their hot paths.
+// report() reads these and reports the levels and the changes of the
+// cumulative counts since the previous call. The application calls
+// report() periodically, e.g. every few seconds from a timer thread. See
+// Counters.h for the names of the stats.
+class PeriodicStatsReporter {
+ public:
+  // 'cache' and 'mappedMemory' may be nullptr and must outlive 'this'.
+  // The cache is also reported as the MappedMemory if 'mappedMemory' is
+  // not given.
+  PeriodicStatsReporter(
+      const AsyncDataCache* cache,
+      const memory::MappedMemory* mappedMemory = nullptr);
+
+  void report();
+
+ private:
+  void reportCache();
+
+  void reportMappedMemory();
+
+  const AsyncDataCache* const cache_;
+  const memory::MappedMemory* const mappedMemory_;
+  // Serializes report() and guards 'lastCacheStats_'.
+  std::mutex mutex_;
+  CacheStats lastCacheStats_;
+};
+
+} // namespace facebook::velox::cache
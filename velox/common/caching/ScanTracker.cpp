@@ -38,6 +38,77 @@ void ScanTracker::recordRead(
   sum_.incrementRead(bytes);
 }
 
+// static
+TrackingHistory& TrackingHistory::instance() {
+  static TrackingHistory history;
+  return history;
+}
+
+void TrackingHistory::add(std::string_view table, const TrackingMap& data) {
+  if (data.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  StringIdLease name(tableIds_, table);
+  auto& history = tables_[name.id()];
+  if (!history.name.hasValue()) {
+    history.name = std::move(name);
+  }
+  for (auto& [id, added] : data) {
+    auto& total = history.data[id];
+    total.add(added);
+    if (total.numReferences > kMaxReferences) {
+      total.referencedBytes /= 2;
+      total.readBytes /= 2;
+      total.numReferences /= 2;
+      total.numReads /= 2;
+    }
+  }
+}
+
+TrackingMap TrackingHistory::get(std::string_view table) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = tables_.find(tableIds_.id(table));
+  if (it == tables_.end()) {
+    return {};
+  }
+  return it->second.data;
+}
+
+std::string TrackingHistory::exportStats() {
+  std::lock_guard<std::mutex> l(mutex_);
+  std::stringstream out;
+  for (auto& [tableId, history] : tables_) {
+    auto name = tableIds_.string(tableId);
+    for (auto& [id, data] : history.data) {
+      out << name << '\t' << id.id() << '\t' << data.referencedBytes << '\t'
+          << data.readBytes << '\t' << data.numReferences << '\t'
+          << data.numReads << '\n';
+    }
+  }
+  return out.str();
+}
+
+void TrackingHistory::importStats(std::string_view stats) {
+  std::stringstream in{std::string(stats)};
+  std::string line;
+  folly::F14FastMap<std::string, TrackingMap> tables;
+  while (std::getline(in, line)) {
+    auto tab = line.find('\t');
+    VELOX_CHECK_NE(tab, std::string::npos, "Bad tracking stats: {}", line);
+    std::stringstream fields(line.substr(tab + 1));
+    int32_t id;
+    TrackingData data;
+    fields >> id >> data.referencedBytes >> data.readBytes >>
+        data.numReferences >> data.numReads;
+    VELOX_CHECK(!fields.fail(), "Bad tracking stats: {}", line);
+    tables[line.substr(0, tab)][TrackingId::fromId(id)].add(data);
+  }
+  for (auto& [table, data] : tables) {
+    add(table, data);
+  }
+}
+
 std::string ScanTracker::toString() const {
   std::stringstream out;
   out << "ScanTracker for " << id_ << std::endl;
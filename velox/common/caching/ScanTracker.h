@@ -21,6 +21,7 @@
 #include <mutex>
 
 #include "velox/common/base/Exceptions.h"
+#include "velox/common/caching/StringIdMap.h"
 
 namespace facebook::velox::cache {
 
@@ -55,6 +56,13 @@ class TrackingId {
     return id_;
   }
 
+  // Returns the TrackingId whose id() is 'id'.
+  static TrackingId fromId(int32_t id) {
+    TrackingId result;
+    result.id_ = id;
+    return result;
+  }
+
  private:
   int32_t id_;
 };
@@ -87,6 +95,54 @@ struct TrackingData {
     readBytes += bytes;
     ++numReads;
   }
+
+  void add(const TrackingData& other) {
+    referencedBytes += other.referencedBytes;
+    readBytes += other.readBytes;
+    numReferences += other.numReferences;
+    numReads += other.numReads;
+  }
+};
+
+using TrackingMap = folly::F14FastMap<TrackingId, TrackingData>;
+
+// Aggregate TrackingData of finished scans by table and
+// TrackingId. Seeds new ScanTrackers so that prefetch and caching
+// decisions are informed from the first split of a scan. The stats
+// can be exported and imported to carry them across workers and
+// restarts.
+class TrackingHistory {
+ public:
+  // The counts of a stream are halved when its references exceed
+  // this, so that the history follows recent use.
+  static constexpr int32_t kMaxReferences = 10'000;
+
+  // Returns the process-wide history.
+  static TrackingHistory& instance();
+
+  // Adds 'data' to the history of 'table'.
+  void add(std::string_view table, const TrackingMap& data);
+
+  // Returns the history of 'table'. Empty if 'table' is not known.
+  TrackingMap get(std::string_view table);
+
+  // Returns the history as text, one line per table and stream.
+  std::string exportStats();
+
+  // Adds the history in 'stats', as returned by exportStats().
+  void importStats(std::string_view stats);
+
+ private:
+  struct Table {
+    // Keeps the id of the table name in 'tableIds_'.
+    StringIdLease name;
+    TrackingMap data;
+  };
+
+  std::mutex mutex_;
+  StringIdMap tableIds_;
+  // Map from id in 'tableIds_' to the history of the table.
+  folly::F14FastMap<uint64_t, Table> tables_;
 };
 
 // Tracks column access frequency during execution of a query. A
@@ -98,6 +154,14 @@ struct TrackingData {
 // over multiple partitions.
 class ScanTracker {
  public:
+  // Default percentage of reads over references for saving a stream to
+  // SSD.
+  static constexpr int32_t kSsdSaveMinReadPct = 50;
+
+  // Default percentage of reads over references for keeping the
+  // decompressed form of a stream in memory cache.
+  static constexpr int32_t kCacheDecompressedMinReadPct = 80;
+
   ScanTracker() {}
 
   // Constructs a tracker with 'id'. The tracker will be owned by
@@ -109,10 +173,27 @@ class ScanTracker {
       std::function<void(ScanTracker*)> unregisterer)
       : id_(id), unregisterer_(unregisterer) {}
 
+  // Constructs a tracker for a scan of 'table'. The decisions of
+  // 'this' start from the history of 'table' in 'history' and the
+  // data of 'this' is added to 'history' on destruction.
+  ScanTracker(
+      std::string_view id,
+      std::function<void(ScanTracker*)> unregisterer,
+      std::string_view table,
+      TrackingHistory* history)
+      : id_(id),
+        unregisterer_(unregisterer),
+        table_(table),
+        history_(history),
+        prior_(history->get(table)) {}
+
   ~ScanTracker() {
     if (unregisterer_) {
       unregisterer_(this);
     }
+    if (history_) {
+      history_->add(table_, data_);
+    }
   }
 
   // Records that a scan references 'bytes' bytes of the stream given
@@ -126,12 +207,27 @@ class ScanTracker {
   // True if 'trackingId' is read at least  'minReadPct' % of the time.
   bool shouldPrefetch(TrackingId id, int32_t minReadPct) {
     std::lock_guard<std::mutex> l(mutex_);
-    const auto& data = data_[id];
-    if (!data.numReferences) {
-      // Always prefetch first time data is mentioned.
-      return true;
-    }
-    return (100 * data.numReads) / data.numReferences >= minReadPct;
+    auto pct = readPctLocked(id);
+    // Always prefetch first time data is mentioned.
+    return pct < 0 || pct >= minReadPct;
+  }
+
+  // True if 'id' is read often enough that its data is worth keeping
+  // on SSD after it is evicted from memory.
+  bool shouldSaveToSsd(
+      TrackingId id,
+      int32_t minReadPct = kSsdSaveMinReadPct) {
+    std::lock_guard<std::mutex> l(mutex_);
+    return readPctLocked(id) >= minReadPct;
+  }
+
+  // True if 'id' is read often enough that its decompressed data is
+  // worth caching, so that later reads skip decompression.
+  bool shouldCacheDecompressed(
+      TrackingId id,
+      int32_t minReadPct = kCacheDecompressedMinReadPct) {
+    std::lock_guard<std::mutex> l(mutex_);
+    return readPctLocked(id) >= minReadPct;
   }
 
   std::string_view id() const {
@@ -141,11 +237,31 @@ class ScanTracker {
   std::string toString() const;
 
  private:
+  // Returns the percentage of references of 'id' that are read in
+  // this scan and in the history of the table, or -1 if 'id' has no
+  // references.
+  int32_t readPctLocked(TrackingId id) {
+    TrackingData data = data_[id];
+    auto it = prior_.find(id);
+    if (it != prior_.end()) {
+      data.add(it->second);
+    }
+    if (!data.numReferences) {
+      return -1;
+    }
+    return (100 * data.numReads) / data.numReferences;
+  }
+
   std::mutex mutex_;
   // Id of query + scan operator to track.
   const std::string id_;
   std::function<void(ScanTracker*)> unregisterer_;
-  folly::F14FastMap<TrackingId, TrackingData> data_;
+  // The scanned table and the history for it, if any.
+  const std::string table_;
+  TrackingHistory* const history_{nullptr};
+  // The history of 'table_' when 'this' was created.
+  const TrackingMap prior_;
+  TrackingMap data_;
   TrackingData sum_;
 };
 
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -45,8 +46,10 @@ class SimpleLRUCache {
   // Constructs a cache of the specified size. This size can represent whatever
   // you want -- slots, or bytes, or etc; you provide the size of each element
   // whenever you add a new value to the cache. Note that in certain
-  // circumstances this max_size may be exceeded -- see add().
-  SimpleLRUCache(int64_t maxSize);
+  // circumstances this max_size may be exceeded -- see add(). If
+  // 'expireAfterMs' is not 0, elements expire that many milliseconds
+  // after they are added. get() does not return an expired element.
+  SimpleLRUCache(int64_t maxSize, int64_t expireAfterMs = 0);
 
   // Frees all owned data. Check-fails if any element remains pinned.
   ~SimpleLRUCache();
@@ -90,6 +93,20 @@ class SimpleLRUCache {
   // happen (namely, memory leaks).
   void release(const Key& key);
 
+  // Same as release(), but for the element holding 'value'. Unlike
+  // release(), this is also correct after the element is invalidated.
+  void release(const Key& key, const Value* value);
+
+  // Removes the element of 'key'. If it is pinned, its value stays
+  // valid and is freed when the last pin is released. A new value may
+  // be added for 'key' meanwhile. Returns true if 'key' was present.
+  bool invalidate(const Key& key);
+
+  // Number of elements that get() found expired.
+  int64_t numExpired() const {
+    return numExpired_;
+  }
+
   // Total size of elements in the cache (NOT the maximum size/limit).
   int64_t currentSize() const {
     return curSize_;
@@ -108,19 +125,42 @@ class SimpleLRUCache {
   // remaining are all pinned.
   int64_t free(int64_t size);
 
+  static uint64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
   const int64_t maxSize_;
+  const int64_t expireAfterMs_;
   int64_t curSize_ = 0;
   int64_t pinnedSize_ = 0;
+  int64_t numExpired_ = 0;
 
   struct Element {
     Key key;
     Value* value;
     int size;
     int pinCount;
+    // Time after which get() does not return the element. 0 if the
+    // element does not expire.
+    uint64_t expireTimeMs;
+    // Position of 'this' in 'elements_'.
+    typename std::list<Element*>::iterator position;
   };
+
+  void unpin(Element* element) {
+    --element->pinCount;
+    if (element->pinCount == 0) {
+      pinnedSize_ -= element->size;
+    }
+  }
+
   // Elements get newer as we move from elements_.begin() to elements_.end().
   std::list<Element*> elements_;
   folly::F14FastMap<Key, Element*, Hash, Comparator> keys_;
+  // Invalidated elements that are still pinned, by value.
+  folly::F14FastMap<const Value*, Element*> invalidated_;
 };
 
 //
@@ -129,8 +169,9 @@ class SimpleLRUCache {
 
 template <typename Key, typename Value, typename Comparator, typename Hash>
 inline SimpleLRUCache<Key, Value, Comparator, Hash>::SimpleLRUCache(
-    int64_t maxSize)
-    : maxSize_(maxSize) {}
+    int64_t maxSize,
+    int64_t expireAfterMs)
+    : maxSize_(maxSize), expireAfterMs_(expireAfterMs) {}
 
 template <typename Key, typename Value, typename Comparator, typename Hash>
 inline SimpleLRUCache<Key, Value, Comparator, Hash>::~SimpleLRUCache() {
@@ -140,6 +181,7 @@ inline SimpleLRUCache<Key, Value, Comparator, Hash>::~SimpleLRUCache() {
   free(maxSize_);
   CHECK(elements_.empty());
   CHECK(keys_.empty());
+  CHECK(invalidated_.empty());
   CHECK_EQ(curSize_, 0);
 }
 
@@ -180,10 +222,12 @@ inline bool SimpleLRUCache<Key, Value, Comparator, Hash>::addInternal(
   e->value = value;
   e->size = size;
   e->pinCount = pinned;
+  e->expireTimeMs = expireAfterMs_ ? nowMs() + expireAfterMs_ : 0;
   if (pinned)
     pinnedSize_ += size;
   keys_.emplace(e->key, e);
   elements_.push_back(e);
+  e->position = std::prev(elements_.end());
   curSize_ += size;
   return true;
 }
@@ -195,6 +239,11 @@ inline Value* SimpleLRUCache<Key, Value, Comparator, Hash>::get(
   if (it == keys_.end()) {
     return nullptr;
   }
+  if (it->second->expireTimeMs && nowMs() >= it->second->expireTimeMs) {
+    ++numExpired_;
+    invalidate(key);
+    return nullptr;
+  }
   if (it->second->pinCount == 0) {
     pinnedSize_ += it->second->size;
   }
@@ -205,11 +254,48 @@ inline Value* SimpleLRUCache<Key, Value, Comparator, Hash>::get(
 template <typename Key, typename Value, typename Comparator, typename Hash>
 inline void SimpleLRUCache<Key, Value, Comparator, Hash>::release(
     const Key& key) {
-  Element* e = keys_[key];
-  --e->pinCount;
+  unpin(keys_[key]);
+}
+
+template <typename Key, typename Value, typename Comparator, typename Hash>
+inline void SimpleLRUCache<Key, Value, Comparator, Hash>::release(
+    const Key& key,
+    const Value* value) {
+  auto it = keys_.find(key);
+  if (it != keys_.end() && it->second->value == value) {
+    unpin(it->second);
+    return;
+  }
+  auto invalidatedIt = invalidated_.find(value);
+  CHECK(invalidatedIt != invalidated_.end());
+  Element* e = invalidatedIt->second;
+  unpin(e);
+  if (e->pinCount == 0) {
+    invalidated_.erase(invalidatedIt);
+    curSize_ -= e->size;
+    delete e->value;
+    delete e;
+  }
+}
+
+template <typename Key, typename Value, typename Comparator, typename Hash>
+inline bool SimpleLRUCache<Key, Value, Comparator, Hash>::invalidate(
+    const Key& key) {
+  auto it = keys_.find(key);
+  if (it == keys_.end()) {
+    return false;
+  }
+  Element* e = it->second;
+  keys_.erase(it);
+  elements_.erase(e->position);
   if (e->pinCount == 0) {
-    pinnedSize_ -= e->size;
+    curSize_ -= e->size;
+    delete e->value;
+    delete e;
+  } else {
+    invalidated_.emplace(e->value, e);
   }
+  return true;
 }
 
 template <typename Key, typename Value, typename Comparator, typename Hash>
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/SsdCache.h"
+
+#include <fmt/format.h>
+#include <glog/logging.h>
+
+#include <sstream>
+#include <thread>
+
+namespace facebook::velox::cache {
+
+SsdCache::SsdCache(
+    std::string_view filePrefix,
+    uint64_t maxBytes,
+    int32_t numShards,
+    folly::Executor* executor,
+    uint64_t checkpointIntervalBytes)
+    : filePrefix_(filePrefix),
+      maxBytes_(maxBytes),
+      numShards_(numShards),
+      executor_(executor),
+      checkpointIntervalBytes_(checkpointIntervalBytes) {
+  VELOX_CHECK_GT(numShards_, 0);
+  int32_t regionsPerFile = std::max<uint64_t>(
+      1, maxBytes_ / numShards_ / SsdFile::kRegionSize);
+  for (auto i = 0; i < numShards_; ++i) {
+    files_.push_back(std::make_unique<SsdFile>(
+        fmt::format("{}{}", filePrefix_, i), regionsPerFile));
+  }
+}
+
+bool SsdCache::startWrite() {
+  bool expected = false;
+  return writeInProgress_.compare_exchange_strong(expected, true);
+}
+
+void SsdCache::write(std::vector<CachePin> pins) {
+  VELOX_CHECK(writeInProgress_);
+  try {
+    uint64_t bytes = 0;
+    std::vector<std::vector<CachePin>> shards(numShards_);
+    for (auto& pin : pins) {
+      bytes += pin.entry()->size();
+      auto fileNum = pin.entry()->key().fileNum.id();
+      shards[fileNum % numShards_].push_back(std::move(pin));
+    }
+    for (auto i = 0; i < numShards_; ++i) {
+      if (!shards[i].empty()) {
+        files_[i]->write(shards[i]);
+        shards[i].clear();
+      }
+    }
+    bytesAfterCheckpoint_ += bytes;
+    if (checkpointIntervalBytes_ > 0 &&
+        bytesAfterCheckpoint_ >= checkpointIntervalBytes_) {
+      bytesAfterCheckpoint_ = 0;
+      checkpoint();
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error writing SSD cache " << filePrefix_ << ": "
+               << e.what();
+  }
+  // The pins must be released before the cache can be destroyed.
+  pins.clear();
+  writeInProgress_ = false;
+}
+
+void SsdCache::waitForWrite() {
+  while (writeInProgress_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void SsdCache::checkpoint() {
+  for (auto& file : files_) {
+    file->checkpoint();
+  }
+}
+
+void SsdCache::clear() {
+  for (auto& file : files_) {
+    file->clear();
+  }
+}
+
+SsdCacheStats SsdCache::stats() const {
+  SsdCacheStats stats;
+  for (auto& file : files_) {
+    file->updateStats(stats);
+  }
+  return stats;
+}
+
+std::string SsdCache::toString() const {
+  auto data = stats();
+  std::stringstream out;
+  out << "SsdCache: " << data.bytesCached << " / " << maxBytes_
+      << " bytes in " << data.entriesCached << " entries\n"
+      << "Written " << data.bytesWritten << " read " << data.bytesRead
+      << " missed reads " << data.readsMissed << " evicted regions "
+      << data.regionsEvicted << " checkpoints " << data.checkpointsWritten;
+  return out.str();
+}
+
+} // namespace facebook::velox::cache
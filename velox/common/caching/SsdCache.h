@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Executor.h>
+
+#include "velox/common/caching/SsdFile.h"
+
+namespace facebook::velox::cache {
+
+// Second tier of AsyncDataCache on local SSD. The data is spread over
+// 'numShards' SsdFiles by file number, so that all entries of a file
+// are in the same SsdFile. Entries are written in batches by one
+// writer at a time, see AsyncDataCache::saveToSsd().
+class SsdCache {
+ public:
+  static constexpr int32_t kDefaultNumShards = 4;
+  static constexpr uint64_t kDefaultCheckpointIntervalBytes = 256 << 20;
+
+  // Constructs a cache of 'maxBytes' in files named 'filePrefix'
+  // followed by the shard number. The writes run on 'executor' if
+  // given, else on the thread that starts the write. The files are
+  // checkpointed after every 'checkpointIntervalBytes' written. 0
+  // means that the files are checkpointed only by checkpoint().
+  SsdCache(
+      std::string_view filePrefix,
+      uint64_t maxBytes,
+      int32_t numShards = kDefaultNumShards,
+      folly::Executor* executor = nullptr,
+      uint64_t checkpointIntervalBytes = kDefaultCheckpointIntervalBytes);
+
+  // Returns the file holding the entries of the file with 'fileNum'.
+  SsdFile& file(uint64_t fileNum) {
+    return *files_[fileNum % numShards_];
+  }
+
+  // Returns true and sets 'this' to writing state if no write is in
+  // progress. The caller must then call write().
+  bool startWrite();
+
+  // Writes 'pins' to the files and ends the write started by
+  // startWrite(). The pins are released before the write ends.
+  void write(std::vector<CachePin> pins);
+
+  // Waits until the write in progress, if any, is done.
+  void waitForWrite();
+
+  // Writes the checkpoints of all files.
+  void checkpoint();
+
+  // Removes all entries.
+  void clear();
+
+  folly::Executor* executor() const {
+    return executor_;
+  }
+
+  uint64_t maxBytes() const {
+    return maxBytes_;
+  }
+
+  SsdCacheStats stats() const;
+
+  std::string toString() const;
+
+ private:
+  const std::string filePrefix_;
+  const uint64_t maxBytes_;
+  const int32_t numShards_;
+  folly::Executor* const executor_;
+  const uint64_t checkpointIntervalBytes_;
+  std::vector<std::unique_ptr<SsdFile>> files_;
+
+  // True between startWrite() and the end of the following write().
+  std::atomic<bool> writeInProgress_{false};
+  // Bytes written since the last checkpoint. Accessed by the writer only.
+  uint64_t bytesAfterCheckpoint_{0};
+};
+
+} // namespace facebook::velox::cache
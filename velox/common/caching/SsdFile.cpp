@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/SsdFile.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <fcntl.h>
+#include <folly/String.h>
+#include <glog/logging.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+
+namespace facebook::velox::cache {
+
+namespace {
+constexpr std::string_view kCheckpointMagic = "SsdCpt01";
+
+// Calls 'func' with the start and size of each contiguous range of the
+// data of 'entry'.
+template <typename Func>
+void forEachRange(AsyncDataCacheEntry* entry, Func func) {
+  uint64_t size = entry->size();
+  if (entry->tinyData()) {
+    func(entry->tinyData(), size);
+    return;
+  }
+  auto& data = entry->data();
+  uint64_t offset = 0;
+  for (auto i = 0; i < data.numRuns() && offset < size; ++i) {
+    auto run = data.runAt(i);
+    auto bytes = std::min<uint64_t>(run.numBytes(), size - offset);
+    func(run.data<char>(), bytes);
+    offset += bytes;
+  }
+}
+
+void writeAll(int32_t fd, const char* data, uint64_t size, uint64_t offset) {
+  while (size > 0) {
+    auto written = ::pwrite(fd, data, size, offset);
+    VELOX_CHECK_GT(
+        written, 0, "Error writing SSD cache file: {}", folly::errnoStr(errno));
+    data += written;
+    size -= written;
+    offset += written;
+  }
+}
+
+// Returns false if the file ends before 'offset' + 'size'.
+bool readAll(int32_t fd, char* data, uint64_t size, uint64_t offset) {
+  while (size > 0) {
+    auto numRead = ::pread(fd, data, size, offset);
+    if (numRead <= 0) {
+      return false;
+    }
+    data += numRead;
+    size -= numRead;
+    offset += numRead;
+  }
+  return true;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T readValue(std::istream& in) {
+  T value{};
+  in.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return value;
+}
+} // namespace
+
+SsdFile::SsdFile(const std::string& filename, int32_t maxRegions)
+    : filename_(filename),
+      maxRegions_(maxRegions),
+      regionVersions_(maxRegions, 0) {
+  VELOX_CHECK_GT(maxRegions, 0);
+  fd_ = ::open(filename.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+  VELOX_CHECK_GE(
+      fd_,
+      0,
+      "Cannot open or create SSD cache file {}: {}",
+      filename,
+      folly::errnoStr(errno));
+  readCheckpoint();
+}
+
+SsdFile::~SsdFile() {
+  ::close(fd_);
+}
+
+std::optional<SsdRun> SsdFile::find(RawFileCacheKey key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  auto run = it->second;
+  run.regionVersion = regionVersions_[regionOf(run.offset)];
+  return run;
+}
+
+bool SsdFile::read(const SsdRun& run, AsyncDataCacheEntry* entry) {
+  VELOX_CHECK_EQ(entry->size(), run.size);
+  auto region = regionOf(run.offset);
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (regionVersions_[region] != run.regionVersion) {
+      ++readsMissed_;
+      return false;
+    }
+  }
+  auto offset = run.offset;
+  bool success = true;
+  forEachRange(entry, [&](char* data, uint64_t size) {
+    success = success && readAll(fd_, data, size, offset);
+    offset += size;
+  });
+  // The region may have been evicted and written over during the read.
+  std::lock_guard<std::mutex> l(mutex_);
+  if (!success || regionVersions_[region] != run.regionVersion) {
+    ++readsMissed_;
+    return false;
+  }
+  ++entriesRead_;
+  bytesRead_ += run.size;
+  return true;
+}
+
+void SsdFile::write(const std::vector<CachePin>& pins) {
+  for (auto& pin : pins) {
+    auto* entry = pin.entry();
+    RawFileCacheKey key{
+        entry->key().fileNum.id(), static_cast<uint64_t>(entry->offset())};
+    uint32_t size = entry->size();
+    uint64_t offset;
+    uint32_t regionVersion;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      if (size == 0 || size > kRegionSize || entries_.count(key)) {
+        continue;
+      }
+      offset = allocateLocked(size);
+      regionVersion = regionVersions_[regionOf(offset)];
+    }
+    auto writeOffset = offset;
+    forEachRange(entry, [&](char* data, uint64_t bytes) {
+      writeAll(fd_, data, bytes, writeOffset);
+      writeOffset += bytes;
+    });
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      if (regionVersions_[regionOf(offset)] != regionVersion) {
+        // Written over by a later write.
+        continue;
+      }
+      entries_[key] = SsdRun{offset, size, 0};
+      fileLeases_.try_emplace(key.fileNum, fileIds(), key.fileNum);
+      bytesCached_ += size;
+      ++entriesWritten_;
+      bytesWritten_ += size;
+    }
+    entry->setSsdFile(this, offset);
+  }
+}
+
+uint64_t SsdFile::allocateLocked(uint64_t size) {
+  if (writeOffset_ + size > (writeRegion_ + 1) * kRegionSize) {
+    writeRegion_ = (writeRegion_ + 1) % maxRegions_;
+    evictRegionLocked(writeRegion_);
+    writeOffset_ = writeRegion_ * kRegionSize;
+  }
+  auto offset = writeOffset_;
+  writeOffset_ += size;
+  return offset;
+}
+
+void SsdFile::evictRegionLocked(int32_t region) {
+  int32_t numEvicted = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (regionOf(it->second.offset) == region) {
+      bytesCached_ -= it->second.size;
+      it = entries_.erase(it);
+      ++numEvicted;
+    } else {
+      ++it;
+    }
+  }
+  ++regionVersions_[region];
+  if (numEvicted == 0) {
+    return;
+  }
+  ++regionsEvicted_;
+  if (hasCheckpoint_) {
+    // The checkpoint would refer to data that is about to be written over.
+    ::unlink(checkpointPath().c_str());
+    hasCheckpoint_ = false;
+  }
+}
+
+void SsdFile::checkpoint() {
+  std::lock_guard<std::mutex> l(mutex_);
+  // The entries in the checkpoint must be on disk before the checkpoint.
+  VELOX_CHECK_EQ(
+      0,
+      ::fsync(fd_),
+      "Error syncing SSD cache file {}: {}",
+      filename_,
+      folly::errnoStr(errno));
+  auto tempPath = checkpointPath() + ".tmp";
+  std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+  VELOX_CHECK(out.good(), "Cannot open SSD cache checkpoint {}", tempPath);
+  out.write(kCheckpointMagic.data(), kCheckpointMagic.size());
+  writeValue(out, writeRegion_);
+  writeValue(out, writeOffset_);
+  writeValue<int32_t>(out, fileLeases_.size());
+  for (auto& [fileNum, lease] : fileLeases_) {
+    auto name = fileIds().string(fileNum);
+    writeValue(out, fileNum);
+    writeValue<int32_t>(out, name.size());
+    out.write(name.data(), name.size());
+  }
+  writeValue<int64_t>(out, entries_.size());
+  for (auto& [key, run] : entries_) {
+    writeValue(out, key.fileNum);
+    writeValue(out, key.offset);
+    writeValue(out, run.offset);
+    writeValue(out, run.size);
+  }
+  out.close();
+  VELOX_CHECK(!out.fail(), "Error writing SSD cache checkpoint {}", tempPath);
+  VELOX_CHECK_EQ(
+      0,
+      std::rename(tempPath.c_str(), checkpointPath().c_str()),
+      "Cannot rename SSD cache checkpoint {}: {}",
+      tempPath,
+      folly::errnoStr(errno));
+  hasCheckpoint_ = true;
+  ++checkpointsWritten_;
+}
+
+void SsdFile::readCheckpoint() {
+  std::ifstream in(checkpointPath(), std::ios::binary);
+  if (!in.good()) {
+    return;
+  }
+  std::string magic(kCheckpointMagic.size(), '\0');
+  in.read(magic.data(), magic.size());
+  if (!in || magic != kCheckpointMagic) {
+    LOG(WARNING) << "Ignoring invalid SSD cache checkpoint "
+                 << checkpointPath();
+    return;
+  }
+  auto writeRegion = readValue<int32_t>(in);
+  auto writeOffset = readValue<uint64_t>(in);
+  // Maps the file numbers in the checkpoint to the file numbers of this
+  // process.
+  folly::F14FastMap<uint64_t, uint64_t> fileNums;
+  auto numFiles = readValue<int32_t>(in);
+  for (auto i = 0; i < numFiles && in; ++i) {
+    auto fileNum = readValue<uint64_t>(in);
+    std::string name(readValue<int32_t>(in), '\0');
+    in.read(name.data(), name.size());
+    StringIdLease lease(fileIds(), name);
+    fileNums[fileNum] = lease.id();
+    fileLeases_[lease.id()] = std::move(lease);
+  }
+  auto numEntries = readValue<int64_t>(in);
+  auto maxOffset = maxRegions_ * kRegionSize;
+  bool valid = writeRegion >= 0 && writeRegion < maxRegions_;
+  for (auto i = 0; i < numEntries && in && valid; ++i) {
+    auto fileNum = readValue<uint64_t>(in);
+    auto offset = readValue<uint64_t>(in);
+    SsdRun run;
+    run.offset = readValue<uint64_t>(in);
+    run.size = readValue<uint32_t>(in);
+    auto it = fileNums.find(fileNum);
+    valid = it != fileNums.end();
+    if (valid && run.offset + run.size <= maxOffset) {
+      entries_[RawFileCacheKey{it->second, offset}] = run;
+      bytesCached_ += run.size;
+    }
+  }
+  if (!in || !valid) {
+    LOG(WARNING) << "Ignoring invalid SSD cache checkpoint "
+                 << checkpointPath();
+    entries_.clear();
+    fileLeases_.clear();
+    bytesCached_ = 0;
+    return;
+  }
+  writeRegion_ = writeRegion;
+  writeOffset_ = writeOffset;
+  hasCheckpoint_ = true;
+}
+
+void SsdFile::clear() {
+  std::lock_guard<std::mutex> l(mutex_);
+  entries_.clear();
+  fileLeases_.clear();
+  bytesCached_ = 0;
+  for (auto& version : regionVersions_) {
+    ++version;
+  }
+  writeRegion_ = 0;
+  writeOffset_ = 0;
+  ::unlink(checkpointPath().c_str());
+  hasCheckpoint_ = false;
+}
+
+void SsdFile::updateStats(SsdCacheStats& stats) {
+  std::lock_guard<std::mutex> l(mutex_);
+  stats.entriesCached += entries_.size();
+  stats.bytesCached += bytesCached_;
+  stats.entriesWritten += entriesWritten_;
+  stats.bytesWritten += bytesWritten_;
+  stats.entriesRead += entriesRead_;
+  stats.bytesRead += bytesRead_;
+  stats.readsMissed += readsMissed_;
+  stats.regionsEvicted += regionsEvicted_;
+  stats.checkpointsWritten += checkpointsWritten_;
+}
+
+} // namespace facebook::velox::cache
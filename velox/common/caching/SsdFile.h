@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "velox/common/caching/AsyncDataCache.h"
+
+namespace facebook::velox::cache {
+
+// Location of a cache entry in an SsdFile.
+struct SsdRun {
+  // Offset of the data in the file.
+  uint64_t offset{0};
+  uint32_t size{0};
+  // Version of the region of 'offset' at the time of lookup. The data
+  // is valid only if the region has not been evicted since.
+  uint32_t regionVersion{0};
+};
+
+// Struct for SsdFile stats. Stats from all files are added into this
+// struct to provide a snapshot of state.
+struct SsdCacheStats {
+  // Number of entries and their total size in the files.
+  int64_t entriesCached{};
+  int64_t bytesCached{};
+  // Cumulative number of entries and bytes written.
+  int64_t entriesWritten{};
+  int64_t bytesWritten{};
+  // Cumulative number of entries and bytes read.
+  int64_t entriesRead{};
+  int64_t bytesRead{};
+  // Number of reads that found their region evicted.
+  int64_t readsMissed{};
+  // Number of regions whose entries were dropped to make space.
+  int64_t regionsEvicted{};
+  int64_t checkpointsWritten{};
+};
+
+// A file on local SSD holding cache entries evicted or replicated
+// from AsyncDataCache. The file is written sequentially, one region
+// of kRegionSize bytes at a time. When all regions are full, the
+// oldest region is cleared and written over. The index from
+// RawFileCacheKey to location is kept in memory and is saved in a
+// checkpoint file next to the data, from which it is read on
+// construction. The checkpoint is removed when a region it refers to
+// is written over.
+class SsdFile {
+ public:
+  static constexpr uint64_t kRegionSize = 64 << 20;
+
+  // Opens or creates 'filename' for up to 'maxRegions' regions and
+  // reads the index from the checkpoint, if any.
+  SsdFile(const std::string& filename, int32_t maxRegions);
+
+  ~SsdFile();
+
+  // Returns the location of 'key' or std::nullopt if 'key' is not in
+  // 'this'.
+  std::optional<SsdRun> find(RawFileCacheKey key);
+
+  // Reads the data at 'run' into 'entry', which is pinned exclusive and
+  // has space for run.size bytes. Returns false if the region of 'run'
+  // was evicted after the lookup. The data of 'entry' is then undefined.
+  bool read(const SsdRun& run, AsyncDataCacheEntry* entry);
+
+  // Writes the entries of 'pins' that are not yet in 'this' and
+  // records their location in the entries. The entries are pinned
+  // shared.
+  void write(const std::vector<CachePin>& pins);
+
+  // Writes the index to the checkpoint file.
+  void checkpoint();
+
+  // Removes all entries and the checkpoint.
+  void clear();
+
+  // Adds the stats of 'this' to 'stats'.
+  void updateStats(SsdCacheStats& stats);
+
+  const std::string& filename() const {
+    return filename_;
+  }
+
+ private:
+  std::string checkpointPath() const {
+    return filename_ + ".cpt";
+  }
+
+  int32_t regionOf(uint64_t offset) const {
+    return offset / kRegionSize;
+  }
+
+  // Returns the offset for writing 'size' bytes. Moves to the next
+  // region and evicts its entries if the current region is full.
+  uint64_t allocateLocked(uint64_t size);
+
+  // Removes the entries in 'region' and increments its version.
+  void evictRegionLocked(int32_t region);
+
+  // Sets the index from the checkpoint, if any.
+  void readCheckpoint();
+
+  const std::string filename_;
+  const int32_t maxRegions_;
+  int32_t fd_;
+
+  std::mutex mutex_;
+  folly::F14FastMap<RawFileCacheKey, SsdRun> entries_;
+  // Keeps the file numbers in 'entries_' valid for the lifetime of
+  // 'this'. Map from file number to lease.
+  folly::F14FastMap<uint64_t, StringIdLease> fileLeases_;
+  // Incremented each time the region is evicted.
+  std::vector<uint32_t> regionVersions_;
+  // Region being written and offset in the file of the next write.
+  int32_t writeRegion_{0};
+  uint64_t writeOffset_{0};
+  // True if the checkpoint file matches the index except for entries
+  // added after the checkpoint.
+  bool hasCheckpoint_{false};
+
+  int64_t bytesCached_{0};
+  int64_t entriesWritten_{0};
+  int64_t bytesWritten_{0};
+  int64_t entriesRead_{0};
+  int64_t bytesRead_{0};
+  int64_t readsMissed_{0};
+  int64_t regionsEvicted_{0};
+  int64_t checkpointsWritten_{0};
+};
+
+} // namespace facebook::velox::cache
@@ -19,68 +19,114 @@
 namespace facebook::velox {
 
 uint64_t StringIdMap::id(std::string_view string) {
-  std::lock_guard<std::mutex> l(mutex_);
-  auto it = stringToId_.find(string);
-  if (it != stringToId_.end()) {
+  auto& shard = shardOf(string);
+  folly::SharedMutex::ReadHolder l(shard.mutex);
+  auto it = shard.stringToId.find(string);
+  if (it != shard.stringToId.end()) {
     return it->second;
   }
   return kNoId;
 }
 
+std::string StringIdMap::string(uint64_t id) {
+  auto& shard = shardOf(id);
+  folly::SharedMutex::ReadHolder l(shard.mutex);
+  auto it = shard.idToString.find(id);
+  VELOX_CHECK(it != shard.idToString.end(), "Id not in StringIdMap: {}", id);
+  return it->second.string;
+}
+
+int64_t StringIdMap::pinnedSize() const {
+  int64_t size = 0;
+  for (auto& shard : shards_) {
+    size += shard.pinnedSize;
+  }
+  return size;
+}
+
+// static
+uint32_t StringIdMap::addUse(Shard& shard, Entry& entry) {
+  auto previous = entry.numInUse.fetch_add(1);
+  if (previous == 0) {
+    // The entry was being released. The releaser finds it in use and
+    // keeps it.
+    shard.pinnedSize += entry.string.size();
+  }
+  return previous;
+}
+
 void StringIdMap::release(uint64_t id) {
-  std::lock_guard<std::mutex> l(mutex_);
-  auto it = idToString_.find(id);
-  if (it != idToString_.end()) {
-    VELOX_CHECK_LT(
-        0, it->second.numInUse, "Extra release of id in StringIdMap");
-    if (--it->second.numInUse == 0) {
-      pinnedSize_ -= it->second.string.size();
-      auto strIter = stringToId_.find(it->second.string);
-      assert(strIter != stringToId_.end());
-      stringToId_.erase(strIter);
-      idToString_.erase(it);
+  auto& shard = shardOf(id);
+  {
+    folly::SharedMutex::ReadHolder l(shard.mutex);
+    auto it = shard.idToString.find(id);
+    if (it == shard.idToString.end()) {
+      return;
+    }
+    auto previous = it->second.numInUse.fetch_sub(1);
+    VELOX_CHECK_LT(0, previous, "Extra release of id in StringIdMap");
+    if (previous > 1) {
+      return;
     }
+    shard.pinnedSize -= it->second.string.size();
+  }
+  // The last use is gone. The entry is removed unless makeId() took a new
+  // use in the meantime.
+  folly::SharedMutex::WriteHolder l(shard.mutex);
+  auto it = shard.idToString.find(id);
+  if (it == shard.idToString.end() || it->second.numInUse > 0) {
+    return;
   }
+  shard.stringToId.erase(std::string_view(it->second.string));
+  shard.idToString.erase(it);
 }
 
 void StringIdMap::addReference(uint64_t id) {
-  std::lock_guard<std::mutex> l(mutex_);
-  auto it = idToString_.find(id);
+  auto& shard = shardOf(id);
+  folly::SharedMutex::ReadHolder l(shard.mutex);
+  auto it = shard.idToString.find(id);
   VELOX_CHECK(
-      it != idToString_.end(),
+      it != shard.idToString.end(),
       "Trying to add a reference to an id that is not in StringIdMap");
-
-  ++it->second.numInUse;
+  addUse(shard, it->second);
 }
 
 uint64_t StringIdMap::makeId(std::string_view string) {
-  std::lock_guard<std::mutex> l(mutex_);
-  auto it = stringToId_.find(string);
-  if (it != stringToId_.end()) {
-    auto entry = idToString_.find(it->second);
-    VELOX_CHECK(entry != idToString_.end());
-    if (++entry->second.numInUse == 1) {
-      pinnedSize_ += entry->second.string.size();
+  auto& shard = shardOf(string);
+  {
+    folly::SharedMutex::ReadHolder l(shard.mutex);
+    auto it = shard.stringToId.find(string);
+    if (it != shard.stringToId.end()) {
+      auto entry = shard.idToString.find(it->second);
+      VELOX_CHECK(entry != shard.idToString.end());
+      addUse(shard, entry->second);
+      return it->second;
     }
-
+  }
+  folly::SharedMutex::WriteHolder l(shard.mutex);
+  // Another thread may have added 'string' while the lock was released.
+  auto it = shard.stringToId.find(string);
+  if (it != shard.stringToId.end()) {
+    auto entry = shard.idToString.find(it->second);
+    VELOX_CHECK(entry != shard.idToString.end());
+    addUse(shard, entry->second);
     return it->second;
   }
-  Entry entry;
-  entry.string = std::string(string);
   // Check that we do not use an id twice. In practice this never
   // happens because the int64 counter would have to wrap around for
   // this. Even if this happened, the time spent in the loop would
   // have a low cap since the number of mappings would in practice
   // be in the 100K range.
+  auto shardIndex = &shard - shards_.data();
+  uint64_t id;
   do {
-    entry.id = ++lastId_;
-  } while (idToString_.find(entry.id) != idToString_.end());
-  entry.numInUse = 1;
-  pinnedSize_ += entry.string.size();
-  auto id = entry.id;
-  auto& entryInTable = idToString_[id] = std::move(entry);
-  stringToId_[entryInTable.string] = entry.id;
-  return lastId_;
+    id = (++shard.lastId << kShardBits) | shardIndex;
+  } while (id == kNoId ||
+           shard.idToString.find(id) != shard.idToString.end());
+  auto& entry = shard.idToString.try_emplace(id, string).first->second;
+  addUse(shard, entry);
+  shard.stringToId[std::string_view(entry.string)] = id;
+  return id;
 }
 
 } // namespace facebook::velox
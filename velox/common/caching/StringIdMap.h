@@ -16,17 +16,28 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <string_view>
 
+#include <folly/SharedMutex.h>
 #include <folly/container/F14Map.h>
 
 #include "velox/common/base/Exceptions.h"
 
 namespace facebook::velox {
 
+// Assigns ids to strings, e.g. file names for cache keys, and counts the
+// uses of each id. The mappings are spread over shards by the hash of the
+// string, and the shard of an id is in its low bits. Lookups and the
+// reference counting of existing ids take a shared lock on one shard, so
+// that concurrent split openings do not serialize. Only adding and
+// removing a mapping takes the shard exclusively.
 class StringIdMap {
  public:
   static constexpr uint64_t kNoId = ~0UL;
+  static constexpr int32_t kShardBits = 5;
+  static constexpr int32_t kNumShards = 1 << kShardBits;
 
   StringIdMap() {}
 
@@ -38,11 +49,12 @@ class StringIdMap {
   // Returns the id of 'string' or kNoId if the string is not known.
   uint64_t id(std::string_view string);
 
+  // Returns the string for 'id'. 'id' must be in use.
+  std::string string(uint64_t id);
+
   // Returns the total length of strings involved in currently referenced
   // mappings.
-  int64_t pinnedSize() const {
-    return pinnedSize_;
-  }
+  int64_t pinnedSize() const;
 
   // Returns the id for 'string' and increments its use count. Assigns a
   // new id if none exists. must be released with release() when no longer used.
@@ -57,16 +69,34 @@ class StringIdMap {
 
  private:
   struct Entry {
-    std::string string;
-    uint64_t id;
-    uint32_t numInUse{};
+    explicit Entry(std::string_view value) : string(value) {}
+
+    const std::string string;
+    std::atomic<uint32_t> numInUse{0};
+  };
+
+  struct alignas(64) Shard {
+    folly::SharedMutex mutex;
+    // Keys point to the strings of the entries in 'idToString'.
+    folly::F14FastMap<std::string_view, uint64_t> stringToId;
+    // Node map, so that entries do not move when other entries are added.
+    folly::F14NodeMap<uint64_t, Entry> idToString;
+    uint64_t lastId{0};
+    std::atomic<int64_t> pinnedSize{0};
   };
 
-  std::mutex mutex_;
-  folly::F14FastMap<std::string, uint64_t> stringToId_;
-  folly::F14FastMap<uint64_t, Entry> idToString_;
-  uint64_t lastId_{};
-  uint64_t pinnedSize_{};
+  Shard& shardOf(std::string_view string) {
+    return shards_[std::hash<std::string_view>()(string) % kNumShards];
+  }
+
+  Shard& shardOf(uint64_t id) {
+    return shards_[id & (kNumShards - 1)];
+  }
+
+  // Increments the use count of 'entry' and returns the previous count.
+  static uint32_t addUse(Shard& shard, Entry& entry);
+
+  std::array<Shard, kNumShards> shards_;
 };
 
 // Keeps a string-id association live for the duration of this.
@@ -15,8 +15,10 @@
  */
 
 #include "velox/common/caching/AsyncDataCache.h"
+#include "velox/common/caching/CachePolicy.h"
 #include "velox/common/caching/FileIds.h"
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/executors/QueuedImmediateExecutor.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -29,9 +31,16 @@ using facebook::velox::memory::MappedMemory;
 class AsyncDataCacheTest : public testing::Test {
  protected:
   static constexpr int32_t kNumFiles = 100;
-  void initializeCache(int64_t maxBytes) {
+  void initializeCache(
+      int64_t maxBytes,
+      int32_t numShards = 0,
+      folly::Executor* evictionExecutor = nullptr) {
     cache_ = std::make_shared<AsyncDataCache>(
-        MappedMemory::createDefaultInstance(), maxBytes);
+        MappedMemory::createDefaultInstance(),
+        maxBytes,
+        nullptr,
+        numShards,
+        evictionExecutor);
     for (auto i = 0; i < kNumFiles; ++i) {
       auto name = fmt::format("testing_file_{}", i);
       filenames_.push_back(StringIdLease(fileIds(), name));
@@ -216,6 +225,26 @@ TEST_F(AsyncDataCacheTest, pin) {
   EXPECT_EQ(0, cache_->incrementPrefetchPages(0));
 }
 
+TEST_F(AsyncDataCacheTest, cancelledPrefetch) {
+  constexpr int64_t kSize = 25000;
+  initializeCache(1 << 20);
+  StringIdLease file(fileIds(), std::string_view("testingfile"));
+  folly::SemiFuture<bool> wait(false);
+  std::vector<CachePin> pins;
+  pins.push_back(cache_->findOrCreate({file.id(), 1000}, kSize, &wait));
+
+  folly::CancellationSource cancellationSource;
+  auto load = std::make_shared<TestingFusedLoad>();
+  load->setCancellationToken(cancellationSource.getToken());
+  load->initialize(std::move(pins));
+  cancellationSource.requestCancellation();
+
+  // A prefetch after the cancellation does no IO and drops the entries.
+  EXPECT_TRUE(load->loadOrFuture(nullptr));
+  EXPECT_TRUE(load->state() == LoadState::kCancelled);
+  EXPECT_EQ(0, cache_->refreshStats().numEntries);
+}
+
 TEST_F(AsyncDataCacheTest, replace) {
   constexpr int64_t kMaxBytes = 16 << 20;
   initializeCache(kMaxBytes);
@@ -227,6 +256,88 @@ TEST_F(AsyncDataCacheTest, replace) {
       cache_->incrementCachedPages(0));
 }
 
+TEST_F(AsyncDataCacheTest, retention) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  initializeCache(kMaxBytes, 4);
+  auto makeLoaded = [&](uint64_t offset, CacheRetention retention) {
+    auto pin = cache_->findOrCreate({filenames_[0].id(), offset}, kSize);
+    ASSERT_TRUE(pin.entry()->isExclusive());
+    pin.entry()->setRetention(retention);
+    initializeContents(offset, pin.entry()->data());
+    pin.entry()->setValid();
+    pin.entry()->setExclusiveToShared();
+  };
+  makeLoaded(0, CacheRetention::kPin);
+  makeLoaded(kSize, CacheRetention::kNoRetain);
+  makeLoaded(2 * kSize, CacheRetention::kNormal);
+
+  // Taking most of the capacity evicts all but the pinned entry.
+  MappedMemory::Allocation allocation(cache_.get());
+  ASSERT_TRUE(cache_->allocate(
+      (kMaxBytes - 2 * kSize) / MappedMemory::kPageSize, 0, allocation));
+  auto pin = cache_->findOrCreate({filenames_[0].id(), 0}, kSize);
+  EXPECT_TRUE(pin.entry()->isShared());
+  EXPECT_EQ(CacheRetention::kPin, pin.entry()->retention());
+  pin.clear();
+  cache_->free(allocation);
+  pin = cache_->findOrCreate({filenames_[0].id(), kSize}, kSize);
+  EXPECT_TRUE(pin.entry()->isExclusive());
+}
+
+TEST_F(AsyncDataCacheTest, frequencyPolicy) {
+  initializeCache(16 << 20);
+  cache_->setPolicy(std::make_unique<FrequencyPolicy>());
+  RawFileCacheKey key{filenames_[0].id(), 1000};
+  // The first lookup does not admit the new entry.
+  auto pin = cache_->findOrCreate(key, 10'000);
+  EXPECT_EQ(CacheRetention::kNoRetain, pin.entry()->retention());
+  // Releasing the exclusive pin without valid data drops the entry.
+  pin.clear();
+  pin = cache_->findOrCreate(key, 10'000);
+  EXPECT_EQ(CacheRetention::kNormal, pin.entry()->retention());
+}
+
+TEST(FrequencyPolicyTest, halving) {
+  constexpr int32_t kWidth = 16;
+  FrequencyPolicy policy(kWidth, 2);
+  RawFileCacheKey key{1, 100};
+  EXPECT_FALSE(policy.admit(key, 100));
+  policy.recordAccess(key);
+  EXPECT_FALSE(policy.admit(key, 100));
+  policy.recordAccess(key);
+  EXPECT_TRUE(policy.admit(key, 100));
+  // The counts saturate at 15 and are halved every 10 * kWidth accesses.
+  for (auto i = 2; i < 10 * kWidth - 1; ++i) {
+    policy.recordAccess(key);
+  }
+  EXPECT_EQ(15, policy.frequency(key));
+  policy.recordAccess(key);
+  EXPECT_EQ(7, policy.frequency(key));
+}
+
+TEST_F(AsyncDataCacheTest, numShards) {
+  initializeCache(1 << 20, 5);
+  EXPECT_EQ(8, cache_->numShards());
+  initializeCache(1 << 20);
+  auto numShards = cache_->numShards();
+  EXPECT_LE(4, numShards);
+  EXPECT_EQ(0, numShards & (numShards - 1));
+}
+
+TEST_F(AsyncDataCacheTest, backgroundEviction) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  folly::CPUThreadPoolExecutor executor(1);
+  initializeCache(kMaxBytes, 16, &executor);
+  loadLoop();
+  executor.join();
+  auto stats = cache_->refreshStats();
+  EXPECT_LT(0, stats.numEvict);
+  EXPECT_GE(
+      kMaxBytes / memory::MappedMemory::kPageSize,
+      cache_->incrementCachedPages(0));
+}
+
 TEST_F(AsyncDataCacheTest, outOfCapacity) {
   constexpr int64_t kMaxBytes = 16 << 20;
   constexpr int32_t kSize = 16 << 10;
@@ -16,6 +16,8 @@
 
 #include "velox/common/caching/CachedFactory.h"
 
+#include <thread>
+
 #include "folly/executors/EDFThreadPoolExecutor.h"
 #include "folly/executors/thread_factory/NamedThreadFactory.h"
 #include "gtest/gtest.h"
@@ -224,3 +226,70 @@ TEST(CachedFactoryTest, retrievedCached) {
   }
   ASSERT_EQ(*generated, 5);
 }
+
+TEST(CachedFactoryTest, invalidate) {
+  auto generator = std::make_unique<DoublerGenerator>();
+  auto* generated = &generator->generated_;
+  CachedFactory<int, int, DoublerGenerator> factory(
+      std::make_unique<SimpleLRUCache<int, int>>(1000), std::move(generator));
+  auto first = factory.generate(1);
+  factory.invalidate(1);
+  // The invalidated value stays valid while referenced.
+  auto second = factory.generate(1);
+  ASSERT_FALSE(second.wasCached());
+  ASSERT_EQ(*generated, 2);
+  ASSERT_EQ(*first, 2);
+  ASSERT_EQ(*second, 2);
+  ASSERT_NE(first.get(), second.get());
+  first = CachedPtr<int, int>();
+  ASSERT_TRUE(factory.generate(1).wasCached());
+  ASSERT_EQ(factory.currentSize(), 1);
+
+  auto stats = factory.stats();
+  ASSERT_EQ(stats.numHits, 1);
+  ASSERT_EQ(stats.numGenerated, 2);
+  ASSERT_EQ(stats.numInvalidated, 1);
+  ASSERT_EQ(stats.numExpired, 0);
+}
+
+TEST(CachedFactoryTest, expiration) {
+  auto generator = std::make_unique<DoublerGenerator>();
+  auto* generated = &generator->generated_;
+  CachedFactory<int, int, DoublerGenerator> factory(
+      std::make_unique<SimpleLRUCache<int, int>>(1000, 50),
+      std::move(generator));
+  ASSERT_FALSE(factory.generate(1).wasCached());
+  ASSERT_TRUE(factory.generate(1).wasCached());
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_FALSE(factory.generate(1).wasCached());
+  ASSERT_EQ(*generated, 2);
+  ASSERT_EQ(factory.stats().numExpired, 1);
+}
+
+struct SlowGenerator {
+  std::unique_ptr<int> operator()(const int& value) {
+    ++generated_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return std::make_unique<int>(value * 2);
+  }
+  std::atomic<int> generated_ = 0;
+};
+
+TEST(CachedFactoryTest, concurrentGenerationIsShared) {
+  auto generator = std::make_unique<SlowGenerator>();
+  auto* generated = &generator->generated_;
+  CachedFactory<int, int, SlowGenerator> factory(
+      std::make_unique<SimpleLRUCache<int, int>>(1000), std::move(generator));
+  const int numThreads = 10;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&]() { ASSERT_EQ(*factory.generate(7), 14); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(*generated, 1);
+  auto stats = factory.stats();
+  ASSERT_EQ(stats.numGenerated, 1);
+  ASSERT_EQ(stats.numHits + stats.numWaits, numThreads - 1);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/ScanTracker.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox::cache;
+
+namespace {
+TrackingData makeData(int32_t numReferences, int32_t numReads) {
+  TrackingData data;
+  for (auto i = 0; i < numReferences; ++i) {
+    data.incrementReference(1000);
+  }
+  for (auto i = 0; i < numReads; ++i) {
+    data.incrementRead(1000);
+  }
+  return data;
+}
+} // namespace
+
+TEST(ScanTrackerTest, history) {
+  TrackingHistory history;
+  TrackingId rarelyRead(1, 2);
+  TrackingId oftenRead(2, 2);
+  TrackingId unknown(3, 2);
+  history.add(
+      "t", {{rarelyRead, makeData(10, 1)}, {oftenRead, makeData(10, 9)}});
+  {
+    ScanTracker tracker("scan", nullptr, "t", &history);
+    EXPECT_FALSE(tracker.shouldPrefetch(rarelyRead, 60));
+    EXPECT_TRUE(tracker.shouldPrefetch(oftenRead, 60));
+    EXPECT_TRUE(tracker.shouldPrefetch(unknown, 60));
+    EXPECT_TRUE(tracker.shouldSaveToSsd(oftenRead));
+    EXPECT_FALSE(tracker.shouldSaveToSsd(unknown));
+    // This scan reads the stream every time.
+    for (auto i = 0; i < 20; ++i) {
+      tracker.recordReference(rarelyRead, 1000, 0);
+      tracker.recordRead(rarelyRead, 1000, 0);
+    }
+    EXPECT_TRUE(tracker.shouldPrefetch(rarelyRead, 60));
+  }
+  // The data of the finished scan is in the history.
+  auto data = history.get("t");
+  EXPECT_EQ(30, data[rarelyRead].numReferences);
+  EXPECT_EQ(21, data[rarelyRead].numReads);
+  EXPECT_TRUE(history.get("other").empty());
+
+  // A tracker for another table does not see the history of "t".
+  ScanTracker other("scan2", nullptr, "other", &history);
+  EXPECT_TRUE(other.shouldPrefetch(rarelyRead, 60));
+}
+
+TEST(ScanTrackerTest, exportImport) {
+  TrackingHistory history;
+  TrackingId id(5, 1);
+  history.add("db.t1", {{id, makeData(4, 3)}});
+  history.add("db.t2", {{id, makeData(2, 0)}});
+
+  TrackingHistory copy;
+  copy.importStats(history.exportStats());
+  auto data = copy.get("db.t1");
+  EXPECT_EQ(4, data[id].numReferences);
+  EXPECT_EQ(3, data[id].numReads);
+  EXPECT_EQ(3000, data[id].readBytes);
+  EXPECT_EQ(2, copy.get("db.t2")[id].numReferences);
+
+  EXPECT_THROW(copy.importStats("no tab here\n"), std::exception);
+}
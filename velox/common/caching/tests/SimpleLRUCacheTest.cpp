@@ -16,6 +16,8 @@
 
 #include "velox/common/caching/SimpleLRUCache.h"
 
+#include <thread>
+
 #include "gtest/gtest.h"
 
 using namespace facebook::velox;
@@ -158,3 +160,43 @@ TEST(SimpleLRUCache, insertLargerThanCacheFails) {
   ASSERT_FALSE(cache.add(123, value, 11));
   delete value;
 }
+
+TEST(SimpleLRUCache, invalidate) {
+  SimpleLRUCache<int, int> cache(10);
+  ASSERT_TRUE(cache.add(1, new int(11), 1));
+  ASSERT_TRUE(cache.add(2, new int(22), 1));
+  int* pinned = cache.get(2);
+
+  ASSERT_TRUE(cache.invalidate(1));
+  ASSERT_FALSE(cache.invalidate(1));
+  ASSERT_EQ(cache.get(1), nullptr);
+  ASSERT_EQ(cache.currentSize(), 1);
+
+  // A pinned value stays valid after invalidation and a new value can
+  // be added for the key.
+  ASSERT_TRUE(cache.invalidate(2));
+  ASSERT_EQ(cache.get(2), nullptr);
+  ASSERT_TRUE(cache.add(2, new int(33), 1));
+  int* current = cache.get(2);
+  ASSERT_EQ(*pinned, 22);
+  ASSERT_EQ(*current, 33);
+  cache.release(2, pinned);
+  ASSERT_EQ(cache.currentSize(), 1);
+  cache.release(2, current);
+  ASSERT_EQ(*cache.get(2), 33);
+  cache.release(2);
+}
+
+TEST(SimpleLRUCache, expiration) {
+  SimpleLRUCache<int, int> cache(10, 50);
+  ASSERT_TRUE(cache.add(1, new int(11), 1));
+  ASSERT_EQ(*cache.get(1), 11);
+  cache.release(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_EQ(cache.get(1), nullptr);
+  ASSERT_EQ(cache.numExpired(), 1);
+  ASSERT_EQ(cache.currentSize(), 0);
+  ASSERT_TRUE(cache.add(1, new int(12), 1));
+  ASSERT_EQ(*cache.get(1), 12);
+  cache.release(1);
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <fstream>
+
+using namespace facebook::velox;
+using namespace facebook::velox::cache;
+
+using facebook::velox::memory::MappedMemory;
+
+class SsdFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    filename_ = fmt::format("/tmp/ssdfiletest_{}", getpid());
+    file_ = StringIdLease(fileIds(), std::string_view("ssdfiletest_file"));
+    cache_ = makeCache();
+  }
+
+  void TearDown() override {
+    cache_.reset();
+    ::unlink(filename_.c_str());
+    ::unlink((filename_ + ".cpt").c_str());
+  }
+
+  std::shared_ptr<AsyncDataCache> makeCache(
+      std::unique_ptr<SsdCache> ssdCache = nullptr) {
+    return std::make_shared<AsyncDataCache>(
+        MappedMemory::createDefaultInstance(), 64 << 20, std::move(ssdCache));
+  }
+
+  // Calls 'func' with each range of the data of 'entry' and the offset
+  // of the range in 'entry'.
+  template <typename Func>
+  static void forEachRange(AsyncDataCacheEntry* entry, Func func) {
+    if (entry->tinyData()) {
+      func(entry->tinyData(), entry->size(), 0);
+      return;
+    }
+    auto& data = entry->data();
+    uint64_t offset = 0;
+    for (auto i = 0; i < data.numRuns() && offset < entry->size(); ++i) {
+      auto run = data.runAt(i);
+      auto size = std::min<uint64_t>(run.numBytes(), entry->size() - offset);
+      func(run.data<char>(), size, offset);
+      offset += size;
+    }
+  }
+
+  static void fill(AsyncDataCacheEntry* entry) {
+    forEachRange(entry, [&](char* data, uint64_t size, uint64_t offset) {
+      for (auto i = 0; i < size; ++i) {
+        data[i] = expectedByte(entry, offset + i);
+      }
+    });
+  }
+
+  static void check(AsyncDataCacheEntry* entry) {
+    forEachRange(entry, [&](char* data, uint64_t size, uint64_t offset) {
+      for (auto i = 0; i < size; ++i) {
+        ASSERT_EQ(data[i], expectedByte(entry, offset + i));
+      }
+    });
+  }
+
+  static char expectedByte(AsyncDataCacheEntry* entry, uint64_t offset) {
+    return static_cast<char>((entry->offset() + offset) * 13);
+  }
+
+  // Returns loaded entries of 'sizes' at consecutive offsets, pinned
+  // shared.
+  std::vector<CachePin> makeEntries(
+      AsyncDataCache& cache,
+      const std::vector<int32_t>& sizes) {
+    std::vector<CachePin> pins;
+    uint64_t offset = 0;
+    for (auto size : sizes) {
+      auto pin = cache.findOrCreate(RawFileCacheKey{file_.id(), offset}, size);
+      EXPECT_TRUE(pin.entry()->isExclusive());
+      fill(pin.entry());
+      pin.entry()->setValid();
+      pin.entry()->setExclusiveToShared();
+      pins.push_back(std::move(pin));
+      offset += size;
+    }
+    return pins;
+  }
+
+  // Reads the entries of 'pins' from 'file' into new entries of a
+  // different cache and checks the data.
+  void checkRead(SsdFile& file, const std::vector<CachePin>& pins) {
+    auto otherCache = makeCache();
+    for (auto& pin : pins) {
+      RawFileCacheKey key{
+          file_.id(), static_cast<uint64_t>(pin.entry()->offset())};
+      auto run = file.find(key);
+      ASSERT_TRUE(run.has_value());
+      ASSERT_EQ(pin.entry()->size(), run->size);
+      auto newPin = otherCache->findOrCreate(key, run->size);
+      ASSERT_TRUE(file.read(run.value(), newPin.entry()));
+      check(newPin.entry());
+      newPin.entry()->setValid();
+    }
+  }
+
+  std::string filename_;
+  StringIdLease file_;
+  std::shared_ptr<AsyncDataCache> cache_;
+};
+
+TEST_F(SsdFileTest, writeAndRead) {
+  auto pins = makeEntries(*cache_, {1'000, 100'000, 3'000'000, 20'000});
+  SsdFile file(filename_, 2);
+  file.write(pins);
+  for (auto& pin : pins) {
+    EXPECT_EQ(&file, pin.entry()->ssdFile());
+  }
+  checkRead(file, pins);
+  SsdCacheStats stats;
+  file.updateStats(stats);
+  EXPECT_EQ(4, stats.entriesCached);
+  EXPECT_EQ(3'121'000, stats.bytesWritten);
+  EXPECT_EQ(3'121'000, stats.bytesRead);
+
+  // Writing the same entries again is a no-op.
+  file.write(pins);
+  stats = SsdCacheStats();
+  file.updateStats(stats);
+  EXPECT_EQ(4, stats.entriesWritten);
+
+  // A run found before clear() does not read after clear().
+  RawFileCacheKey key{file_.id(), 0};
+  auto run = file.find(key);
+  ASSERT_TRUE(run.has_value());
+  file.clear();
+  EXPECT_FALSE(file.find(key).has_value());
+  EXPECT_FALSE(file.read(run.value(), pins[0].entry()));
+}
+
+TEST_F(SsdFileTest, checkpoint) {
+  auto pins = makeEntries(*cache_, {5'000, 200'000, 1'000});
+  {
+    SsdFile file(filename_, 2);
+    file.write(pins);
+    file.checkpoint();
+  }
+  // The index is read from the checkpoint.
+  SsdFile file(filename_, 2);
+  checkRead(file, pins);
+
+  // An invalid checkpoint is ignored.
+  file.clear();
+  {
+    std::ofstream out(filename_ + ".cpt");
+    out << "not a checkpoint";
+  }
+  SsdFile emptyFile(filename_, 2);
+  RawFileCacheKey key{file_.id(), 0};
+  EXPECT_FALSE(emptyFile.find(key).has_value());
+}
+
+TEST_F(SsdFileTest, saveToSsd) {
+  auto prefix = filename_ + "_shard";
+  cache_ = makeCache(std::make_unique<SsdCache>(prefix, 128 << 20, 1));
+  // The last entry is not saveable and is not written.
+  auto pins = makeEntries(*cache_, {10'000, 300'000, 100});
+  pins[0].entry()->setSsdSaveable();
+  pins[1].entry()->setSsdSaveable();
+  pins.clear();
+
+  cache_->saveToSsd();
+  auto stats = cache_->ssdCache()->stats();
+  EXPECT_EQ(2, stats.entriesWritten);
+  EXPECT_EQ(310'000, stats.bytesWritten);
+
+  // Nothing new to write.
+  cache_->saveToSsd();
+  stats = cache_->ssdCache()->stats();
+  EXPECT_EQ(2, stats.entriesWritten);
+  cache_.reset();
+  ::unlink((prefix + "0").c_str());
+  ::unlink((prefix + "0.cpt").c_str());
+}
@@ -18,6 +18,8 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+
 using namespace facebook::velox;
 
 TEST(StringIdMapTest, basic) {
@@ -53,3 +55,38 @@ TEST(StringIdMapTest, rehash) {
     EXPECT_EQ(ids[i].id(), StringIdLease(map, name).id());
   }
 }
+
+TEST(StringIdMapTest, concurrent) {
+  constexpr int32_t kNumThreads = 8;
+  constexpr int32_t kNumNames = 100;
+  StringIdMap map;
+  // Leases that outlive the threads, so that some ids stay in use.
+  std::vector<StringIdLease> pinned;
+  int64_t pinnedSize = 0;
+  for (auto i = 0; i < kNumNames; i += 2) {
+    auto name = fmt::format("name_{}", i);
+    pinned.emplace_back(map, name);
+    pinnedSize += name.size();
+  }
+  std::vector<std::thread> threads;
+  for (auto thread = 0; thread < kNumThreads; ++thread) {
+    threads.emplace_back([&, thread]() {
+      for (auto i = 0; i < 10'000; ++i) {
+        auto name = fmt::format("name_{}", (i + thread) % kNumNames);
+        StringIdLease lease(map, name);
+        StringIdLease copy(lease);
+        EXPECT_EQ(map.string(copy.id()), name);
+        EXPECT_EQ(map.id(name), lease.id());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& lease : pinned) {
+    EXPECT_EQ(map.id(map.string(lease.id())), lease.id());
+  }
+  EXPECT_EQ(pinnedSize, map.pinnedSize());
+  pinned.clear();
+  EXPECT_EQ(0, map.pinnedSize());
+}
@@ -22,8 +22,13 @@
 #include <stdexcept>
 
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <folly/portability/SysUio.h>
 
+#ifdef VELOX_ENABLE_IO_URING
+#include "velox/common/file/IoUring.h"
+#endif
+
 namespace facebook::velox {
 
 std::string_view InMemoryReadFile::pread(
@@ -72,7 +77,13 @@ uint64_t InMemoryWriteFile::size() const {
   return file_->size();
 }
 
-LocalReadFile::LocalReadFile(std::string_view path) {
+LocalReadFile::LocalReadFile(
+    std::string_view path,
+    std::shared_ptr<IoUring> ioUring)
+    : ioUring_(std::move(ioUring)) {
+#ifndef VELOX_ENABLE_IO_URING
+  VELOX_CHECK_NULL(ioUring_, "Velox is built without io_uring support");
+#endif
   std::unique_ptr<char[]> buf(new char[path.size() + 1]);
   buf[path.size()] = 0;
   memcpy(buf.get(), path.data(), path.size());
@@ -112,8 +123,10 @@ std::string LocalReadFile::pread(uint64_t offset, uint64_t length) const {
   return result;
 }
 
-uint64_t LocalReadFile::preadv(
-    uint64_t offset,
+namespace {
+// Returns iovecs for reading into 'buffers'. Ranges with nullptr data are
+// read into a scratch buffer whose contents are dropped.
+std::vector<struct iovec> toIovecs(
     const std::vector<folly::Range<char*>>& buffers) {
   static char droppedBytes[8 * 1024];
   std::vector<struct iovec> iovecs;
@@ -130,9 +143,32 @@ uint64_t LocalReadFile::preadv(
       iovecs.push_back({range.data(), range.size()});
     }
   }
+  return iovecs;
+}
+} // namespace
+
+uint64_t LocalReadFile::preadv(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers) {
+  auto iovecs = toIovecs(buffers);
   return folly::preadv(fd_, iovecs.data(), iovecs.size(), offset);
 }
 
+folly::SemiFuture<uint64_t> LocalReadFile::preadvAsync(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers,
+    const folly::CancellationToken& cancellationToken) {
+#ifdef VELOX_ENABLE_IO_URING
+  if (ioUring_) {
+    if (cancellationToken.isCancellationRequested()) {
+      return folly::makeSemiFuture<uint64_t>(folly::OperationCancelled());
+    }
+    return ioUring_->readv(fd_, offset, toIovecs(buffers));
+  }
+#endif
+  return ReadFile::preadvAsync(offset, buffers, cancellationToken);
+}
+
 uint64_t LocalReadFile::size() const {
   if (size_ != -1) {
     return size_;
@@ -153,6 +189,14 @@ uint64_t LocalReadFile::memoryUsage() const {
   return sizeof(FILE);
 }
 
+int64_t LocalReadFile::modificationTime() const {
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    return 0;
+  }
+  return st.st_mtim.tv_sec * 1'000'000'000L + st.st_mtim.tv_nsec;
+}
+
 LocalWriteFile::LocalWriteFile(std::string_view path) {
   std::unique_ptr<char[]> buf(new char[path.size() + 1]);
   buf[path.size()] = 0;
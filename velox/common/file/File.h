@@ -30,9 +30,11 @@
 #include <cstdint>
 #include <cstdio>
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 
+#include <folly/CancellationToken.h>
 #include <folly/Range.h>
 #include <folly/futures/Future.h>
 
@@ -72,10 +74,16 @@ class ReadFile {
 
   // Like preadv but may execute asynchronously and returns the read
   // size or exception via SemiFuture. Use hasPreadvAsync() to check
-  // if the implementation is in fact asynchronous.
+  // if the implementation is in fact asynchronous. If
+  // 'cancellationToken' is cancelled, IO that has not started is not
+  // issued and the result is folly::OperationCancelled.
   virtual folly::SemiFuture<uint64_t> preadvAsync(
       uint64_t offset,
-      const std::vector<folly::Range<char*>>& buffers) {
+      const std::vector<folly::Range<char*>>& buffers,
+      const folly::CancellationToken& cancellationToken = {}) {
+    if (cancellationToken.isCancellationRequested()) {
+      return folly::makeSemiFuture<uint64_t>(folly::OperationCancelled());
+    }
     try {
       return folly::SemiFuture<uint64_t>(preadv(offset, buffers));
     } catch (const std::exception& e) {
@@ -99,6 +107,13 @@ class ReadFile {
   // An estimate for the total amount of memory *this uses.
   virtual uint64_t memoryUsage() const = 0;
 
+  // Returns the time of the last modification of the file in
+  // nanoseconds since the epoch, or 0 if not known. Tells apart
+  // versions of a file in caches.
+  virtual int64_t modificationTime() const {
+    return 0;
+  }
+
   // The total number of bytes *this had been used to read since creation or
   // the last resetBytesRead. We sum all the |length| variables passed to
   // preads, not the actual amount of bytes read (which might be less).
@@ -192,9 +207,15 @@ class InMemoryWriteFile final : public WriteFile {
 // internal arenaing), as local disk writes are expected to be cheap. Local
 // files match against any filepath starting with '/'.
 
+class IoUring;
+
 class LocalReadFile final : public ReadFile {
  public:
-  explicit LocalReadFile(std::string_view path);
+  // If 'ioUring' is given, preadvAsync() submits its reads to it instead of
+  // reading synchronously. Requires building with VELOX_ENABLE_IO_URING.
+  explicit LocalReadFile(
+      std::string_view path,
+      std::shared_ptr<IoUring> ioUring = nullptr);
 
   std::string_view pread(uint64_t offset, uint64_t length, Arena* arena)
       const final;
@@ -205,7 +226,15 @@ class LocalReadFile final : public ReadFile {
   uint64_t preadv(
       uint64_t offset,
       const std::vector<folly::Range<char*>>& buffers) final;
+  folly::SemiFuture<uint64_t> preadvAsync(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers,
+      const folly::CancellationToken& cancellationToken = {}) final;
+  bool hasPreadvAsync() const final {
+    return ioUring_ != nullptr;
+  }
   uint64_t memoryUsage() const final;
+  int64_t modificationTime() const final;
   bool shouldCoalesce() const final {
     return false;
   }
@@ -214,6 +243,7 @@ class LocalReadFile final : public ReadFile {
   void preadInternal(uint64_t offset, uint64_t length, char* pos) const;
 
   int32_t fd_;
+  std::shared_ptr<IoUring> ioUring_;
   mutable long size_ = -1;
 };
 
@@ -20,6 +20,10 @@
 #include "velox/common/file/File.h"
 #include "velox/core/Context.h"
 
+#ifdef VELOX_ENABLE_IO_URING
+#include "velox/common/file/IoUring.h"
+#endif
+
 namespace facebook::velox::filesystems {
 
 constexpr std::string_view kFileScheme("file:");
@@ -75,9 +79,13 @@ class LocalFileSystem : public FileSystem {
 
   std::unique_ptr<ReadFile> openFileForRead(std::string_view path) override {
     if (path.find(kFileScheme) == 0) {
-      return std::make_unique<LocalReadFile>(path.substr(kFileScheme.length()));
+      path = path.substr(kFileScheme.length());
     }
+#ifdef VELOX_ENABLE_IO_URING
+    return std::make_unique<LocalReadFile>(path, IoUring::defaultInstance());
+#else
     return std::make_unique<LocalReadFile>(path);
+#endif
   }
 
   std::unique_ptr<WriteFile> openFileForWrite(std::string_view path) override {
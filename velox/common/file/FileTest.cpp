@@ -18,6 +18,10 @@
 #include "velox/common/file/FileSystems.h"
 #include "velox/exec/tests/TempFilePath.h"
 
+#ifdef VELOX_ENABLE_IO_URING
+#include "velox/common/file/IoUring.h"
+#endif
+
 #include "gtest/gtest.h"
 
 using namespace facebook::velox;
@@ -89,6 +93,59 @@ TEST(LocalFile, WriteAndRead) {
   readData(&readFile);
 }
 
+#ifdef VELOX_ENABLE_IO_URING
+TEST(LocalFile, preadvAsync) {
+  auto tempFile = ::exec::test::TempFilePath::create();
+  const auto& filename = tempFile->path.c_str();
+  remove(filename);
+  {
+    LocalWriteFile writeFile(filename);
+    writeData(&writeFile);
+  }
+  LocalReadFile readFile(filename, std::make_shared<IoUring>(4));
+  ASSERT_TRUE(readFile.hasPreadvAsync());
+  std::vector<std::string> heads(10, std::string(12, 0));
+  std::vector<std::string> tails(10, std::string(7, 0));
+  std::vector<folly::SemiFuture<uint64_t>> reads;
+  for (auto i = 0; i < heads.size(); ++i) {
+    std::vector<folly::Range<char*>> buffers = {
+        folly::Range<char*>(heads[i].data(), heads[i].size()),
+        folly::Range<char*>(nullptr, kOneMB - 4),
+        folly::Range<char*>(tails[i].data(), tails[i].size())};
+    reads.push_back(readFile.preadvAsync(0, buffers));
+  }
+  for (auto i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(15 + kOneMB, std::move(reads[i]).get());
+    ASSERT_EQ("aaaaabbbbbcc", heads[i]);
+    ASSERT_EQ("ccddddd", tails[i]);
+  }
+}
+#endif
+
+TEST(LocalFile, cancelledPreadvAsync) {
+  auto tempFile = ::exec::test::TempFilePath::create();
+  const auto& filename = tempFile->path.c_str();
+  remove(filename);
+  {
+    LocalWriteFile writeFile(filename);
+    writeData(&writeFile);
+  }
+  LocalReadFile readFile(filename);
+  std::string head(12, 0);
+  std::vector<folly::Range<char*>> buffers = {
+      folly::Range<char*>(head.data(), head.size())};
+  folly::CancellationSource cancellationSource;
+  ASSERT_EQ(
+      12,
+      readFile.preadvAsync(0, buffers, cancellationSource.getToken()).get());
+  ASSERT_EQ("aaaaabbbbbcc", head);
+
+  cancellationSource.requestCancellation();
+  EXPECT_THROW(
+      readFile.preadvAsync(0, buffers, cancellationSource.getToken()).get(),
+      folly::OperationCancelled);
+}
+
 TEST(LocalFile, ViaRegistry) {
   filesystems::registerLocalFileSystem();
   const char filename[] = "/tmp/test";
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/file/IoUring.h"
+
+#include <climits>
+
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox {
+
+IoUring::IoUring(int32_t queueDepth) : queueDepth_(queueDepth) {
+  auto rc = io_uring_queue_init(queueDepth_, &ring_, 0);
+  VELOX_CHECK_EQ(0, rc, "io_uring_queue_init failed: {}", strerror(-rc));
+  completionThread_ = std::thread([this]() { reapCompletions(); });
+}
+
+IoUring::~IoUring() {
+  {
+    std::unique_lock<std::mutex> l(mutex_);
+    queueFull_.wait(l, [&]() { return numInFlight_ < queueDepth_; });
+    auto sqe = io_uring_get_sqe(&ring_);
+    VELOX_CHECK_NOT_NULL(sqe);
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    ++numInFlight_;
+    io_uring_submit(&ring_);
+  }
+  completionThread_.join();
+  io_uring_queue_exit(&ring_);
+}
+
+// static
+std::shared_ptr<IoUring> IoUring::defaultInstance() {
+  static auto instance = std::make_shared<IoUring>();
+  return instance;
+}
+
+folly::SemiFuture<uint64_t>
+IoUring::readv(int32_t fd, uint64_t offset, std::vector<struct iovec> iovecs) {
+  auto request = new Request();
+  request->iovecs = std::move(iovecs);
+  auto future = request->promise.getSemiFuture();
+  const int32_t numIovecs = request->iovecs.size();
+  if (numIovecs == 0) {
+    request->promise.setValue(0);
+    delete request;
+    return future;
+  }
+  const int32_t numOps = (numIovecs + IOV_MAX - 1) / IOV_MAX;
+  VELOX_CHECK_LE(numOps, queueDepth_);
+  request->numPending = numOps;
+
+  std::unique_lock<std::mutex> l(mutex_);
+  queueFull_.wait(l, [&]() { return numInFlight_ + numOps <= queueDepth_; });
+  for (auto i = 0; i < numIovecs; i += IOV_MAX) {
+    const int32_t count = std::min<int32_t>(IOV_MAX, numIovecs - i);
+    auto sqe = io_uring_get_sqe(&ring_);
+    VELOX_CHECK_NOT_NULL(sqe);
+    io_uring_prep_readv(sqe, fd, &request->iovecs[i], count, offset);
+    io_uring_sqe_set_data(sqe, request);
+    for (auto j = i; j < i + count; ++j) {
+      offset += request->iovecs[j].iov_len;
+    }
+  }
+  numInFlight_ += numOps;
+  auto rc = io_uring_submit(&ring_);
+  VELOX_CHECK_EQ(numOps, rc, "io_uring_submit failed: {}", strerror(-rc));
+  return future;
+}
+
+void IoUring::reapCompletions() {
+  for (;;) {
+    struct io_uring_cqe* cqe;
+    auto rc = io_uring_wait_cqe(&ring_, &cqe);
+    if (rc == -EINTR) {
+      continue;
+    }
+    VELOX_CHECK_EQ(0, rc, "io_uring_wait_cqe failed: {}", strerror(-rc));
+    auto request = static_cast<Request*>(io_uring_cqe_get_data(cqe));
+    const int32_t result = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      --numInFlight_;
+    }
+    queueFull_.notify_all();
+    if (!request) {
+      return;
+    }
+    complete(request, result);
+  }
+}
+
+void IoUring::complete(Request* request, int32_t result) {
+  if (result < 0) {
+    request->error = -result;
+  } else {
+    request->bytesRead += result;
+  }
+  if (--request->numPending > 0) {
+    return;
+  }
+  if (request->error) {
+    request->promise.setException(std::runtime_error(fmt::format(
+        "io_uring readv failure: {}", strerror(request->error))));
+  } else {
+    request->promise.setValue(request->bytesRead);
+  }
+  delete request;
+}
+
+} // namespace facebook::velox
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/futures/Future.h>
+#include <liburing.h>
+#include <sys/uio.h>
+
+namespace facebook::velox {
+
+// A submission and completion queue pair for asynchronous reads of local
+// files. Reads from any thread are submitted to the kernel without blocking
+// on the IO and are completed by a single thread that fulfills their
+// futures. Available when built with VELOX_ENABLE_IO_URING.
+class IoUring {
+ public:
+  static constexpr int32_t kDefaultQueueDepth = 256;
+
+  explicit IoUring(int32_t queueDepth = kDefaultQueueDepth);
+
+  ~IoUring();
+
+  // Returns a process-wide ring shared by LocalReadFiles.
+  static std::shared_ptr<IoUring> defaultInstance();
+
+  // Reads from 'fd' starting at 'offset' into 'iovecs' and returns the
+  // number of bytes read. All of 'iovecs' are submitted in one batch, split
+  // into ceil(iovecs.size() / IOV_MAX) consecutive readv operations. The
+  // memory referenced by 'iovecs' must stay live until the future is
+  // fulfilled.
+  folly::SemiFuture<uint64_t>
+  readv(int32_t fd, uint64_t offset, std::vector<struct iovec> iovecs);
+
+ private:
+  struct Request {
+    std::vector<struct iovec> iovecs;
+    folly::Promise<uint64_t> promise;
+    int32_t numPending{0};
+    uint64_t bytesRead{0};
+    int32_t error{0};
+  };
+
+  // Loop of 'completionThread_'. Returns when the completion of the no-op
+  // submitted by the destructor is seen.
+  void reapCompletions();
+
+  // Records the completion of one operation of 'request' and fulfills its
+  // promise after the last one.
+  void complete(Request* request, int32_t result);
+
+  const int32_t queueDepth_;
+  struct io_uring ring_;
+
+  // Serializes submissions and guards 'numInFlight_'.
+  std::mutex mutex_;
+  std::condition_variable queueFull_;
+  int32_t numInFlight_{0};
+  std::thread completionThread_;
+};
+
+} // namespace facebook::velox
@@ -29,13 +29,15 @@
 #include <cstring>
 #include <memory>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace facebook::velox {
 
-// Internally manages memory in chunks. Releases memory only upon destruction.
-// Arena is NOT threadsafe: external locking is required. All functions in this
-// class are expected to be used in tight loops, so we inline everything.
+// Internally manages memory in chunks. Releases memory only upon destruction
+// or clear(). Arena is NOT threadsafe: external locking is required. All
+// functions in this class are expected to be used in tight loops, so we
+// inline everything.
 class Arena {
  public:
   Arena(int64_t initial_chunk_size = kMinChunkSize) {
@@ -56,6 +58,32 @@ class Arena {
     return pos_;
   }
 
+  // Returns space for 'count' values of T, aligned for T. T must not need
+  // destruction since the values are never destructed.
+  template <typename T>
+  T* allocate(int64_t count) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    constexpr int64_t kAlign = alignof(T);
+    auto address =
+        reinterpret_cast<uintptr_t>(reserve(count * sizeof(T) + kAlign - 1));
+    return reinterpret_cast<T*>((address + kAlign - 1) & ~(kAlign - 1));
+  }
+
+  // Makes all memory of 'this' available for reuse. Invalidates all
+  // memory returned before. If more than one chunk was added, these are
+  // replaced by a single chunk of their combined size, so that a steady
+  // state of reuse allocates no more memory.
+  void clear() {
+    if (chunks_.size() > 1) {
+      const int64_t totalBytes = totalBytes_;
+      chunks_.clear();
+      totalBytes_ = 0;
+      addChunk(totalBytes);
+    }
+    pos_ = chunkEnd_ - totalBytes_;
+    reserveEnd_ = pos_;
+  }
+
   // Copies |data| into the chunk, returning a view to the copied data.
   std::string_view writeString(std::string_view data) {
     char* pos = reserve(data.size());
@@ -69,6 +97,7 @@ class Arena {
   void addChunk(int64_t bytes) {
     const int64_t chunkSize = std::max(bytes, kMinChunkSize);
     chunks_.emplace_back(new char[chunkSize]);
+    totalBytes_ += chunkSize;
     pos_ = chunks_.back().get();
     chunkEnd_ = pos_ + chunkSize;
     reserveEnd_ = pos_ + bytes;
@@ -77,6 +106,8 @@ class Arena {
   char* chunkEnd_;
   char* pos_;
   char* reserveEnd_;
+  // Sum of the sizes of 'chunks_'.
+  int64_t totalBytes_{0};
   std::vector<std::unique_ptr<char[]>> chunks_;
 };
 
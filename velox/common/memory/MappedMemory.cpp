@@ -17,8 +17,15 @@
 #include "velox/common/memory/MappedMemory.h"
 
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
+#include <fstream>
 #include <iostream>
+#include <unordered_map>
+
+#include <glog/logging.h>
+#include "velox/common/base/BitUtil.h"
 
 namespace facebook::velox::memory {
 
@@ -70,7 +77,275 @@ void MappedMemory::destroyTestOnly() {
   instance_ = nullptr;
 }
 
+// static
+void* MappedMemory::allocateAligned(uint64_t bytes, uint64_t alignment) {
+  if (!FLAGS_velox_memory_huge_pages || bytes < kHugePageSize) {
+    return aligned_alloc(alignment, roundUp(bytes, alignment));
+  }
+  auto size = roundUp(bytes, kHugePageSize);
+  auto ptr = aligned_alloc(kHugePageSize, size);
+#ifdef MADV_HUGEPAGE
+  if (ptr) {
+    // Advisory. The memory is usable also if this fails.
+    madvise(ptr, size, MADV_HUGEPAGE);
+  }
+#endif
+  return ptr;
+}
+
+// static
+int32_t MappedMemory::currentNumaNode() {
+#ifdef __linux__
+  uint32_t cpu;
+  uint32_t node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return node;
+  }
+#endif
+  return 0;
+}
+
+// static
+int32_t MappedMemory::numNumaNodes() {
+  static const int32_t numNodes = []() {
+    // The file lists the possible nodes as a range, e.g. 0-1.
+    std::ifstream in("/sys/devices/system/node/possible");
+    std::string range;
+    if (!(in >> range)) {
+      return 1;
+    }
+    auto last = range.find_last_of("-,");
+    try {
+      return 1 +
+          std::stoi(last == std::string::npos ? range : range.substr(last + 1));
+    } catch (const std::exception&) {
+      return 1;
+    }
+  }();
+  return numNodes;
+}
+
 namespace {
+// Sets the preferred NUMA node of the whole pages in the 'size' bytes
+// at 'ptr'. The pages that are not yet touched are placed on
+// 'numaNode' when first touched. This is only a preference, so a failure
+// is ignored.
+void preferNumaNode(void* ptr, uint64_t size, int32_t numaNode) {
+#ifdef __linux__
+  // Same as MPOL_PREFERRED in <numaif.h>, which is not always installed.
+  constexpr int kPreferred = 1;
+  // The kernel reads one bit less than the size of the mask.
+  constexpr int32_t kMaxNodes = 8 * sizeof(unsigned long);
+  if (numaNode < 0 || numaNode >= kMaxNodes - 1) {
+    return;
+  }
+  auto address = reinterpret_cast<uint64_t>(ptr); // NOLINT
+  auto begin = roundUp(address, MappedMemory::kPageSize);
+  auto end = (address + size) & ~(MappedMemory::kPageSize - 1);
+  if (begin >= end) {
+    return;
+  }
+  unsigned long mask = 1UL << numaNode;
+  syscall(SYS_mbind, begin, end - begin, kPreferred, &mask, kMaxNodes, 0);
+#endif
+}
+
+// A range of address space reserved with mmap and divided into units
+// of 'unitSize' pages. Units are claimed and released with atomic
+// operations on a bitmap, so that allocation takes no lock. A unit
+// stays backed by memory after it is freed, so that the next
+// allocation reuses it without page faults, until adviseAway()
+// returns it to the operating system.
+class SizeClass {
+ public:
+  SizeClass(MachinePageCount unitSize, uint64_t capacityBytes);
+
+  ~SizeClass();
+
+  MachinePageCount unitSize() const {
+    return unitSize_;
+  }
+
+  bool contains(const uint8_t* ptr) const {
+    return ptr >= base_ && ptr < base_ + numUnits_ * unitBytes_;
+  }
+
+  // Claims a free unit, preferring one that is backed by
+  // memory. Returns nullptr if all units are taken. Sets
+  // 'newlyMapped' to true if the unit was not backed by memory.
+  uint8_t* allocateUnit(bool& newlyMapped);
+
+  // Frees the units in the 'numPages' at 'ptr'. Returns false if any
+  // of these was not allocated.
+  bool free(uint8_t* ptr, MachinePageCount numPages);
+
+  // Returns the memory of free units to the operating system until
+  // at least 'numPages' are returned or no free unit is backed by
+  // memory. Returns the number of pages returned.
+  MachinePageCount adviseAway(MachinePageCount numPages);
+
+  // Returns the number of allocated pages. The result is exact only
+  // if no other thread allocates or frees at the same time.
+  MachinePageCount numAllocatedPages() const;
+
+  // Returns the number of pages backed by memory. Same caveat as
+  // numAllocatedPages().
+  MachinePageCount numMappedPages() const;
+
+ private:
+  static constexpr int32_t kBitsPerWord = 64;
+
+  uint8_t* unitAt(int32_t wordIndex, int32_t bit) const {
+    return base_ + (wordIndex * kBitsPerWord + bit) * unitBytes_;
+  }
+
+  const MachinePageCount unitSize_;
+  const uint64_t unitBytes_;
+  const int32_t numUnits_;
+  const int32_t numWords_;
+  // The mmapped range. Larger than the units so that 'base_' can be
+  // aligned to a huge page and so that the units of two size classes
+  // are never adjacent.
+  uint64_t reservedBytes_;
+  void* reserved_;
+  uint8_t* base_;
+  // A set bit means the unit is allocated. The bits past 'numUnits_'
+  // in the last word are always set.
+  std::unique_ptr<std::atomic<uint64_t>[]> allocated_;
+  // A set bit means the unit is backed by memory. Only changed by the
+  // thread that has the unit's bit set in 'allocated_'.
+  std::unique_ptr<std::atomic<uint64_t>[]> mapped_;
+  // The word of 'allocated_' where the last unit was found.
+  std::atomic<int32_t> hint_{0};
+};
+
+SizeClass::SizeClass(MachinePageCount unitSize, uint64_t capacityBytes)
+    : unitSize_(unitSize),
+      unitBytes_(unitSize * MappedMemory::kPageSize),
+      numUnits_(capacityBytes / unitBytes_),
+      numWords_(bits::nwords(numUnits_)),
+      reservedBytes_(numUnits_ * unitBytes_ + MappedMemory::kHugePageSize) {
+  reserved_ = mmap(
+      nullptr,
+      reservedBytes_,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+      -1,
+      0);
+  VELOX_CHECK(
+      reserved_ != MAP_FAILED,
+      "Could not reserve {} bytes of address space",
+      reservedBytes_);
+  base_ = reinterpret_cast<uint8_t*>( // NOLINT
+      roundUp(
+          reinterpret_cast<uint64_t>(reserved_), // NOLINT
+          MappedMemory::kHugePageSize));
+#ifdef MADV_HUGEPAGE
+  if (unitSize_ == MappedMemory::kPagesPerHugePage) {
+    madvise(base_, numUnits_ * unitBytes_, MADV_HUGEPAGE);
+  }
+#endif
+  allocated_.reset(new std::atomic<uint64_t>[numWords_]);
+  mapped_.reset(new std::atomic<uint64_t>[numWords_]);
+  for (auto i = 0; i < numWords_; ++i) {
+    allocated_[i] = 0;
+    mapped_[i] = 0;
+  }
+  if (numUnits_ % kBitsPerWord) {
+    allocated_[numWords_ - 1] = ~bits::lowMask(numUnits_ % kBitsPerWord);
+  }
+}
+
+SizeClass::~SizeClass() {
+  munmap(reserved_, reservedBytes_);
+}
+
+uint8_t* SizeClass::allocateUnit(bool& newlyMapped) {
+  const int32_t start = hint_.load(std::memory_order_relaxed);
+  // The first pass only takes units that are backed by memory.
+  for (auto pass = 0; pass < 2; ++pass) {
+    for (auto i = 0; i < numWords_; ++i) {
+      const int32_t index = (start + i) % numWords_;
+      auto& word = allocated_[index];
+      auto allocated = word.load(std::memory_order_acquire);
+      while (allocated != ~0ULL) {
+        auto candidates = ~allocated;
+        if (pass == 0) {
+          candidates &= mapped_[index].load(std::memory_order_acquire);
+          if (!candidates) {
+            break;
+          }
+        }
+        const int32_t bit = __builtin_ctzll(candidates);
+        const uint64_t mask = 1ULL << bit;
+        if (word.compare_exchange_weak(
+                allocated, allocated | mask, std::memory_order_acq_rel)) {
+          hint_.store(index, std::memory_order_relaxed);
+          newlyMapped = (mapped_[index].fetch_or(mask) & mask) == 0;
+          return unitAt(index, bit);
+        }
+      }
+    }
+  }
+  return nullptr;
+}
+
+bool SizeClass::free(uint8_t* ptr, MachinePageCount numPages) {
+  const uint64_t offset = ptr - base_;
+  if (offset % unitBytes_ || numPages % unitSize_) {
+    return false;
+  }
+  const int32_t first = offset / unitBytes_;
+  for (auto unit = first; unit < first + numPages / unitSize_; ++unit) {
+    const uint64_t mask = 1ULL << (unit % kBitsPerWord);
+    if (!(allocated_[unit / kBitsPerWord].fetch_and(~mask) & mask)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+MachinePageCount SizeClass::adviseAway(MachinePageCount numPages) {
+  MachinePageCount numAdvised = 0;
+  for (auto index = 0; index < numWords_ && numAdvised < numPages; ++index) {
+    auto candidates = mapped_[index].load(std::memory_order_acquire) &
+        ~allocated_[index].load(std::memory_order_acquire);
+    while (candidates && numAdvised < numPages) {
+      const int32_t bit = __builtin_ctzll(candidates);
+      const uint64_t mask = 1ULL << bit;
+      candidates &= candidates - 1;
+      // Claim the unit so that it is not allocated while the memory is
+      // being returned.
+      if (allocated_[index].fetch_or(mask) & mask) {
+        continue;
+      }
+      if (mapped_[index].load(std::memory_order_acquire) & mask) {
+        madvise(unitAt(index, bit), unitBytes_, MADV_DONTNEED);
+        mapped_[index].fetch_and(~mask);
+        numAdvised += unitSize_;
+      }
+      allocated_[index].fetch_and(~mask);
+    }
+  }
+  return numAdvised;
+}
+
+MachinePageCount SizeClass::numAllocatedPages() const {
+  MachinePageCount count = 0;
+  for (auto i = 0; i < numWords_; ++i) {
+    count += __builtin_popcountll(allocated_[i]);
+  }
+  return (count - (numWords_ * kBitsPerWord - numUnits_)) * unitSize_;
+}
+
+MachinePageCount SizeClass::numMappedPages() const {
+  MachinePageCount count = 0;
+  for (auto i = 0; i < numWords_; ++i) {
+    count += __builtin_popcountll(mapped_[i]);
+  }
+  return count * unitSize_;
+}
+
 // Actual Implementation of MappedMemory.
 class MappedMemoryImpl : public MappedMemory {
  public:
@@ -80,7 +355,8 @@ class MappedMemoryImpl : public MappedMemory {
       int32_t owner,
       Allocation& out,
       std::function<void(int64_t)> beforeAllocCB = nullptr,
-      MachinePageCount minSizeClass = 0) override;
+      MachinePageCount minSizeClass = 0,
+      int32_t numaNode = kAnyNumaNode) override;
   int64_t free(Allocation& allocation) override;
   bool checkConsistency() override;
 
@@ -96,6 +372,15 @@ class MappedMemoryImpl : public MappedMemory {
     return numMapped_;
   }
 
+  MachinePageCount numHugeAllocated() const override {
+    return numHugeAllocated_;
+  }
+
+  MachinePageCount numAllocatedInSizeClass(int32_t sizeIndex) const override {
+    VELOX_CHECK_LT(sizeIndex, sizes_.size());
+    return numAllocatedInSizeClass_[sizeIndex];
+  }
+
   MachinePageCount allocationSize(
       MachinePageCount numPages,
       MachinePageCount minSizeClass,
@@ -104,22 +389,97 @@ class MappedMemoryImpl : public MappedMemory {
       int32_t* numSizes) const;
 
  private:
+  static constexpr int32_t kNumMallocShards = 16;
+
+  struct MallocShard {
+    std::mutex mutex;
+    // Maps malloc'd pointers to the index of the size class of the run
+    // in 'sizes_'. Used for detecting bad frees.
+    std::unordered_map<void*, int32_t> pointers;
+  };
+
+  MallocShard& mallocShard(void* ptr) {
+    auto address = reinterpret_cast<uint64_t>(ptr); // NOLINT
+    return mallocShards_[(address / kPageSize) % kNumMallocShards];
+  }
+
+  bool allocateMalloc(
+      Allocation& out,
+      const std::array<int32_t, kMaxSizeClasses>& sizeIndices,
+      const std::array<int32_t, kMaxSizeClasses>& sizeCounts,
+      int32_t numSizes,
+      MachinePageCount pagesToAlloc,
+      std::function<void(int64_t)> beforeAllocCB,
+      int32_t numaNode);
+
+  bool allocateMmap(
+      Allocation& out,
+      const std::array<int32_t, kMaxSizeClasses>& sizeIndices,
+      const std::array<int32_t, kMaxSizeClasses>& sizeCounts,
+      int32_t numSizes,
+      MachinePageCount pagesToAlloc,
+      std::function<void(int64_t)> beforeAllocCB,
+      int32_t numaNode);
+
+  void freeMalloc(Allocation& allocation);
+
+  void freeMmap(Allocation& allocation);
+
+  // Frees the mmapped units in 'run' and returns the index of their
+  // size class in 'sizes_'. Throws if 'run' was not allocated.
+  int32_t freeUnits(PageRun run);
+
+  // Returns the memory of free mmapped units to the operating system
+  // until 'numMapped_' is at most 'capacity_'.
+  void adviseAway();
+
+  // Set from --velox_use_malloc at construction.
+  const bool useMalloc_;
+  // The maximum number of allocated and of mapped pages when using
+  // mmap. Set from --velox_memory_pool_mb.
+  const MachinePageCount capacity_;
   std::atomic<MachinePageCount> numAllocated_;
   // When using mmap/madvise, the current of number pages backed by memory.
   std::atomic<MachinePageCount> numMapped_;
+  // The part of 'numAllocated_' in runs backed by huge pages.
+  std::atomic<MachinePageCount> numHugeAllocated_{0};
+  // The part of 'numAllocated_' in runs of each size class, indexed like
+  // 'sizes_'.
+  std::array<std::atomic<MachinePageCount>, kMaxSizeClasses>
+      numAllocatedInSizeClass_{};
   // The machine page counts corresponding to different sizes in order
   // of increasing size.
   std::vector<MachinePageCount> sizes_;
 
-  std::mutex mallocsMutex_;
-  // Tracks malloc'd pointers to detect bad frees.
-  std::unordered_set<void*> mallocs_;
+  // The malloc'd pointers, sharded by address so that concurrent
+  // allocations rarely wait for each other.
+  std::array<MallocShard, kNumMallocShards> mallocShards_;
+
+  // The mmapped ranges for each size class, indexed like 'sizes_'.
+  // Empty when using malloc.
+  std::vector<std::unique_ptr<SizeClass>> sizeClasses_;
 };
 
 } // namespace
 
-MappedMemoryImpl::MappedMemoryImpl() : numAllocated_(0), numMapped_(0) {
+MappedMemoryImpl::MappedMemoryImpl()
+    : useMalloc_(FLAGS_velox_use_malloc),
+      capacity_((static_cast<uint64_t>(FLAGS_velox_memory_pool_mb) << 20) /
+                kPageSize),
+      numAllocated_(0),
+      numMapped_(0) {
   sizes_ = {4, 8, 16, 32, 64, 128, 256};
+  if (FLAGS_velox_memory_huge_pages) {
+    sizes_.push_back(kPagesPerHugePage);
+  }
+  if (!useMalloc_) {
+    // Each size class reserves address space for the whole capacity,
+    // which costs no memory until the pages are touched.
+    for (auto size : sizes_) {
+      sizeClasses_.push_back(
+          std::make_unique<SizeClass>(size, capacity_ * kPageSize));
+    }
+  }
 }
 
 bool MappedMemoryImpl::allocate(
@@ -127,8 +487,12 @@ bool MappedMemoryImpl::allocate(
     int32_t owner,
     Allocation& out,
     std::function<void(int64_t)> beforeAllocCB,
-    MachinePageCount minSizeClass) {
+    MachinePageCount minSizeClass,
+    int32_t numaNode) {
   free(out);
+  if (numaNode != kAnyNumaNode && numNumaNodes() == 1) {
+    numaNode = kAnyNumaNode;
+  }
 
   std::array<int32_t, kMaxSizeClasses> sizeIndices = {};
   std::array<int32_t, kMaxSizeClasses> sizeCounts = {};
@@ -136,48 +500,157 @@ bool MappedMemoryImpl::allocate(
   int32_t pagesToAlloc = allocationSize(
       numPages, minSizeClass, &sizeIndices, &sizeCounts, &numSizes);
 
-  if (FLAGS_velox_use_malloc) {
-    if (beforeAllocCB) {
-      uint64_t bytesAllocated = 0;
-      for (int32_t i = 0; i < numSizes; ++i) {
-        MachinePageCount numPages = sizeCounts[i] * sizes_[sizeIndices[i]];
-        bytesAllocated += numPages * kPageSize;
-      }
-      beforeAllocCB(bytesAllocated);
+  if (useMalloc_) {
+    return allocateMalloc(
+        out,
+        sizeIndices,
+        sizeCounts,
+        numSizes,
+        pagesToAlloc,
+        std::move(beforeAllocCB),
+        numaNode);
+  }
+  return allocateMmap(
+      out,
+      sizeIndices,
+      sizeCounts,
+      numSizes,
+      pagesToAlloc,
+      std::move(beforeAllocCB),
+      numaNode);
+}
+
+bool MappedMemoryImpl::allocateMalloc(
+    Allocation& out,
+    const std::array<int32_t, kMaxSizeClasses>& sizeIndices,
+    const std::array<int32_t, kMaxSizeClasses>& sizeCounts,
+    int32_t numSizes,
+    MachinePageCount pagesToAlloc,
+    std::function<void(int64_t)> beforeAllocCB,
+    int32_t numaNode) {
+  if (beforeAllocCB) {
+    beforeAllocCB(pagesToAlloc * kPageSize);
+  }
+
+  std::vector<void*> pages;
+  pages.reserve(numSizes);
+  MachinePageCount hugePages = 0;
+  for (int32_t i = 0; i < numSizes; ++i) {
+    MachinePageCount numPages = sizeCounts[i] * sizes_[sizeIndices[i]];
+    void* ptr;
+    if (sizes_[sizeIndices[i]] == kPagesPerHugePage) {
+      ptr = allocateAligned(numPages * kPageSize, kHugePageSize);
+      hugePages += ptr ? numPages : 0;
+    } else {
+      ptr = malloc(numPages * kPageSize); // NOLINT
+    }
+    if (!ptr) {
+      // Failed to allocate memory from memory.
+      break;
     }
+    pages.emplace_back(ptr);
+    if (numaNode != kAnyNumaNode) {
+      preferNumaNode(ptr, numPages * kPageSize, numaNode);
+    }
+    out.append(reinterpret_cast<uint8_t*>(ptr), numPages); // NOLINT
+  }
+  if (pages.size() != numSizes) {
+    // Failed to allocate memory using malloc. Free any malloced pages and
+    // return false.
+    for (auto ptr : pages) {
+      ::free(ptr);
+    }
+    out.clear();
+    return false;
+  }
+
+  for (auto i = 0; i < pages.size(); ++i) {
+    auto& shard = mallocShard(pages[i]);
+    std::lock_guard<std::mutex> l(shard.mutex);
+    shard.pointers[pages[i]] = sizeIndices[i];
+  }
+  for (auto i = 0; i < numSizes; ++i) {
+    numAllocatedInSizeClass_[sizeIndices[i]].fetch_add(
+        sizeCounts[i] * sizes_[sizeIndices[i]]);
+  }
 
-    std::vector<void*> pages;
-    pages.reserve(numSizes);
-    for (int32_t i = 0; i < numSizes; ++i) {
-      MachinePageCount numPages = sizeCounts[i] * sizes_[sizeIndices[i]];
-      void* ptr = malloc(numPages * kPageSize); // NOLINT
+  // Successfully allocated all pages.
+  numAllocated_.fetch_add(pagesToAlloc);
+  numHugeAllocated_.fetch_add(hugePages);
+  return true;
+}
+
+bool MappedMemoryImpl::allocateMmap(
+    Allocation& out,
+    const std::array<int32_t, kMaxSizeClasses>& sizeIndices,
+    const std::array<int32_t, kMaxSizeClasses>& sizeCounts,
+    int32_t numSizes,
+    MachinePageCount pagesToAlloc,
+    std::function<void(int64_t)> beforeAllocCB,
+    int32_t numaNode) {
+  if (numAllocated_.fetch_add(pagesToAlloc) + pagesToAlloc > capacity_) {
+    numAllocated_.fetch_sub(pagesToAlloc);
+    return false;
+  }
+  if (beforeAllocCB) {
+    try {
+      beforeAllocCB(pagesToAlloc * kPageSize);
+    } catch (const std::exception&) {
+      numAllocated_.fetch_sub(pagesToAlloc);
+      throw;
+    }
+  }
+
+  MachinePageCount newlyMapped = 0;
+  for (int32_t i = 0; i < numSizes; ++i) {
+    auto& sizeClass = *sizeClasses_[sizeIndices[i]];
+    for (auto unit = 0; unit < sizeCounts[i]; ++unit) {
+      bool isNew = false;
+      auto ptr = sizeClass.allocateUnit(isNew);
       if (!ptr) {
-        // Failed to allocate memory from memory.
-        break;
+        // The size class is out of address space. Any units already
+        // in 'out' are freed but stay backed by memory.
+        numMapped_.fetch_add(newlyMapped);
+        for (auto j = 0; j < out.numRuns(); ++j) {
+          freeUnits(out.runAt(j));
+        }
+        out.clear();
+        numAllocated_.fetch_sub(pagesToAlloc);
+        return false;
       }
-      pages.emplace_back(ptr);
-      out.append(reinterpret_cast<uint8_t*>(ptr), numPages); // NOLINT
-    }
-    if (pages.size() != numSizes) {
-      // Failed to allocate memory using malloc. Free any malloced pages and
-      // return false.
-      for (auto ptr : pages) {
-        ::free(ptr);
+      if (isNew) {
+        newlyMapped += sizeClass.unitSize();
+        if (numaNode != kAnyNumaNode) {
+          preferNumaNode(ptr, sizeClass.unitSize() * kPageSize, numaNode);
+        }
       }
-      out.clear();
-      return false;
+      out.append(ptr, sizeClass.unitSize());
     }
-
-    {
-      std::lock_guard<std::mutex> l(mallocsMutex_);
-      mallocs_.insert(pages.begin(), pages.end());
+  }
+  for (auto i = 0; i < numSizes; ++i) {
+    auto pages = sizeCounts[i] * sizes_[sizeIndices[i]];
+    numAllocatedInSizeClass_[sizeIndices[i]].fetch_add(pages);
+    if (sizes_[sizeIndices[i]] == kPagesPerHugePage) {
+      numHugeAllocated_.fetch_add(pages);
     }
+  }
+  if (newlyMapped &&
+      numMapped_.fetch_add(newlyMapped) + newlyMapped > capacity_) {
+    adviseAway();
+  }
+  return true;
+}
 
-    // Successfully allocated all pages.
-    numAllocated_.fetch_add(pagesToAlloc);
-    return true;
+void MappedMemoryImpl::adviseAway() {
+  // Starts with the largest units, which return the most memory per
+  // system call.
+  for (auto i = sizeClasses_.size(); i-- > 0;) {
+    auto mapped = numMapped_.load();
+    if (mapped <= capacity_) {
+      return;
+    }
+    numMapped_.fetch_sub(sizeClasses_[i]->adviseAway(mapped - capacity_));
   }
-  throw std::runtime_error("Not implemented");
 }
 
 MachinePageCount MappedMemoryImpl::allocationSize(
@@ -222,34 +695,88 @@ int64_t MappedMemoryImpl::free(Allocation& allocation) {
   if (allocation.numRuns() == 0) {
     return 0;
   }
-  MachinePageCount numFreed = 0;
-  if (FLAGS_velox_use_malloc) {
-    for (int32_t i = 0; i < allocation.numRuns(); ++i) {
-      PageRun run = allocation.runAt(i);
-      numFreed += run.numPages();
-      void* ptr = run.data();
-      {
-        std::lock_guard<std::mutex> l(mallocsMutex_);
-        if (mallocs_.find(ptr) == mallocs_.end()) {
-          VELOX_CHECK(false, "Bad free");
-        }
-        mallocs_.erase(ptr);
-      }
-      ::free(ptr); // NOLINT
-    }
+  MachinePageCount numFreed = allocation.numPages();
+  if (useMalloc_) {
+    freeMalloc(allocation);
   } else {
-    throw std::runtime_error("Not implemented");
+    freeMmap(allocation);
   }
   numAllocated_.fetch_sub(numFreed);
-  allocation.clear();
   return numFreed * kPageSize;
 }
 
+void MappedMemoryImpl::freeMalloc(Allocation& allocation) {
+  for (int32_t i = 0; i < allocation.numRuns(); ++i) {
+    PageRun run = allocation.runAt(i);
+    void* ptr = run.data();
+    {
+      auto& shard = mallocShard(ptr);
+      std::lock_guard<std::mutex> l(shard.mutex);
+      auto it = shard.pointers.find(ptr);
+      if (it == shard.pointers.end()) {
+        VELOX_CHECK(false, "Bad free");
+      }
+      if (sizes_[it->second] == kPagesPerHugePage) {
+        numHugeAllocated_.fetch_sub(run.numPages());
+      }
+      numAllocatedInSizeClass_[it->second].fetch_sub(run.numPages());
+      shard.pointers.erase(it);
+    }
+    ::free(ptr); // NOLINT
+  }
+  allocation.clear();
+}
+
+int32_t MappedMemoryImpl::freeUnits(PageRun run) {
+  auto ptr = run.data();
+  for (int32_t sizeIndex = 0; sizeIndex < sizeClasses_.size(); ++sizeIndex) {
+    if (sizeClasses_[sizeIndex]->contains(ptr)) {
+      if (!sizeClasses_[sizeIndex]->free(ptr, run.numPages())) {
+        break;
+      }
+      return sizeIndex;
+    }
+  }
+  VELOX_FAIL("Bad free");
+}
+
+void MappedMemoryImpl::freeMmap(Allocation& allocation) {
+  for (int32_t i = 0; i < allocation.numRuns(); ++i) {
+    PageRun run = allocation.runAt(i);
+    auto sizeIndex = freeUnits(run);
+    if (sizes_[sizeIndex] == kPagesPerHugePage) {
+      numHugeAllocated_.fetch_sub(run.numPages());
+    }
+    numAllocatedInSizeClass_[sizeIndex].fetch_sub(run.numPages());
+  }
+  allocation.clear();
+}
+
 bool MappedMemoryImpl::checkConsistency() {
-  if (FLAGS_velox_use_malloc) {
+  if (useMalloc_) {
     return true;
   }
-  throw std::runtime_error("Not implemented");
+  MachinePageCount numAllocated = 0;
+  MachinePageCount numMapped = 0;
+  bool ok = true;
+  for (auto i = 0; i < sizeClasses_.size(); ++i) {
+    auto allocated = sizeClasses_[i]->numAllocatedPages();
+    if (allocated != numAllocatedInSizeClass_[i]) {
+      LOG(WARNING) << "Size class " << sizes_[i] << " has " << allocated
+                   << " pages allocated, expected "
+                   << numAllocatedInSizeClass_[i];
+      ok = false;
+    }
+    numAllocated += allocated;
+    numMapped += sizeClasses_[i]->numMappedPages();
+  }
+  if (numAllocated != numAllocated_ || numMapped != numMapped_) {
+    LOG(WARNING) << "Allocated/mapped pages are " << numAllocated << "/"
+                 << numMapped << ", expected " << numAllocated_ << "/"
+                 << numMapped_;
+    ok = false;
+  }
+  return ok;
 }
 
 MappedMemory* MappedMemory::customInstance_;
@@ -292,7 +819,8 @@ bool ScopedMappedMemory::allocate(
     int32_t owner,
     Allocation& out,
     std::function<void(int64_t)> beforeAllocCB,
-    MachinePageCount minSizeClass) {
+    MachinePageCount minSizeClass,
+    int32_t numaNode) {
   free(out);
   return parent_->allocate(
       numPages,
@@ -306,7 +834,8 @@ bool ScopedMappedMemory::allocate(
           beforeAllocCB(allocated);
         }
       },
-      minSizeClass);
+      minSizeClass,
+      numaNode);
 }
 
 } // namespace facebook::velox::memory
@@ -28,6 +28,7 @@
 #include "velox/common/memory/MemoryUsageTracker.h"
 
 DECLARE_bool(velox_use_malloc);
+DECLARE_bool(velox_memory_huge_pages);
 DECLARE_int32(velox_memory_pool_mb);
 
 namespace facebook::velox::memory {
@@ -40,11 +41,22 @@ using MachinePageCount = uint64_t;
 // Allocates sets of mmapped pages, so that each allocation is
 // composed of the needed mix of standard size contiguous runs.  If
 // --velox_use_malloc is true, allocates with malloc instead of mmap. This
-// allows using asan and similar tools.
+// allows using asan and similar tools. If --velox_memory_huge_pages is
+// true, there is an additional size class of one huge page and runs of
+// this size are backed by transparent huge pages. With mmap, each
+// size class reserves --velox_memory_pool_mb of address space, at
+// most that many bytes are allocated, and free runs are returned to
+// the system with madvise when the memory backing the pool would
+// exceed that size.
 class MappedMemory {
  public:
   static constexpr uint64_t kPageSize = 4096;
+  static constexpr uint64_t kHugePageSize = 2 << 20;
+  static constexpr uint64_t kPagesPerHugePage = kHugePageSize / kPageSize;
   static constexpr int32_t kMaxSizeClasses = 12;
+  // NUMA node hint for allocate() that leaves the placement to the
+  // operating system.
+  static constexpr int32_t kAnyNumaNode = -1;
 
   // Represents a number of consecutive pages of kPageSize bytes.
   class PageRun {
@@ -179,13 +191,16 @@ class MappedMemory {
   /// formerly referenced by 'out' is freed. 'beforeAllocCb' is called
   /// before making the allocation. Returns true if the allocation
   /// succeeded. If returning false, 'out' references no memory and
-  /// any partially allocated memory is freed.
+  /// any partially allocated memory is freed. If 'numaNode' is not
+  /// kAnyNumaNode, the memory is preferably placed on that node, e.g.
+  /// the node of the Driver thread that will read it.
   virtual bool allocate(
       MachinePageCount numPages,
       int32_t owner,
       Allocation& out,
       std::function<void(int64_t)> beforeAllocCB = nullptr,
-      MachinePageCount minSizeClass = 0) = 0;
+      MachinePageCount minSizeClass = 0,
+      int32_t numaNode = kAnyNumaNode) = 0;
 
   // Returns the number of freed bytes.
   virtual int64_t free(Allocation& allocation) = 0;
@@ -196,10 +211,40 @@ class MappedMemory {
 
   static void destroyTestOnly();
 
+  // Returns the NUMA node of the CPU the calling thread runs on, 0 if
+  // this is not known.
+  static int32_t currentNumaNode();
+
+  // Returns the number of NUMA nodes of the host, 1 if this is not
+  // known.
+  static int32_t numNumaNodes();
+
   virtual const std::vector<MachinePageCount>& sizes() const = 0;
   virtual MachinePageCount numAllocated() const = 0;
+  // Returns the number of machine pages backed by memory, including
+  // free pages retained for reuse. Always 0 with malloc.
   virtual MachinePageCount numMapped() const = 0;
 
+  // Returns the number of allocated machine pages that are in runs
+  // backed by huge pages. These are included in numAllocated().
+  virtual MachinePageCount numHugeAllocated() const {
+    return 0;
+  }
+
+  // Returns the number of allocated machine pages that are in runs of
+  // the size class 'sizes()[sizeIndex]'. These are included in
+  // numAllocated().
+  virtual MachinePageCount numAllocatedInSizeClass(
+      int32_t /*sizeIndex*/) const {
+    return 0;
+  }
+
+  // Allocates 'bytes' aligned to 'alignment' with aligned_alloc. If
+  // --velox_memory_huge_pages is true and 'bytes' is at least a huge
+  // page, the memory is aligned to a huge page and marked for backing
+  // by transparent huge pages. Free the result with ::free().
+  static void* allocateAligned(uint64_t bytes, uint64_t alignment);
+
   virtual std::shared_ptr<MappedMemory> addChild(
       std::shared_ptr<MemoryUsageTracker> tracker);
 
@@ -243,7 +288,8 @@ class ScopedMappedMemory final
       int32_t owner,
       Allocation& out,
       std::function<void(int64_t)> beforeAllocCB,
-      MachinePageCount minSizeClass) override;
+      MachinePageCount minSizeClass,
+      int32_t numaNode) override;
 
   int64_t free(Allocation& allocation) override {
     int64_t freed = parent_->free(allocation);
@@ -269,6 +315,14 @@ class ScopedMappedMemory final
     return parent_->numMapped();
   }
 
+  MachinePageCount numHugeAllocated() const override {
+    return parent_->numHugeAllocated();
+  }
+
+  MachinePageCount numAllocatedInSizeClass(int32_t sizeIndex) const override {
+    return parent_->numAllocatedInSizeClass(sizeIndex);
+  }
+
   std::shared_ptr<MappedMemory> addChild(
       std::shared_ptr<MemoryUsageTracker> tracker) override {
     return std::make_shared<ScopedMappedMemory>(shared_from_this(), tracker);
@@ -16,6 +16,9 @@
 
 #include "velox/common/memory/Memory.h"
 
+#include <array>
+#include <vector>
+
 #include "velox/common/base/BitUtil.h"
 
 namespace facebook {
@@ -26,40 +29,191 @@ std::shared_ptr<MemoryAllocator> MemoryAllocator::createDefaultAllocator() {
   return std::make_shared<MemoryAllocator>();
 }
 
-void* MemoryAllocator::alloc(int64_t size) {
-  return std::malloc(size);
+namespace {
+// Blocks of up to kMaxCachedSize bytes are allocated in size classes of 64
+// and 128 bytes and then of each power of two and 1.5 times a power of two,
+// i.e. the sizes MemoryPoolBase::getPreferredSize() rounds to that are
+// multiples of 64. Freed blocks are kept in a per-thread cache of up to
+// kThreadCacheBytes so that the short-lived buffers of a batch are recycled
+// without going to malloc.
+constexpr int64_t kMaxCachedSize = 1 << 20;
+constexpr int64_t kThreadCacheBytes = 16 << 20;
+constexpr int32_t kNumSizeClasses = 28;
+
+// Returns the index of the size class of 'size' bytes and sets 'classSize' to
+// the size of its blocks. Returns -1 if 'size' is not served from the cache.
+int32_t sizeClass(int64_t size, int64_t& classSize) {
+  if (size <= 64) {
+    classSize = 64;
+    return 0;
+  }
+  if (size <= 128) {
+    classSize = 128;
+    return 1;
+  }
+  if (size > kMaxCachedSize) {
+    return -1;
+  }
+  // 'power' is the largest power of two below 'size', at least 128.
+  const int32_t log2 = 63 - __builtin_clzll(size - 1);
+  const int64_t power = 1L << log2;
+  if (size <= power + power / 2) {
+    classSize = power + power / 2;
+    return 2 + 2 * (log2 - 7);
+  }
+  classSize = 2 * power;
+  return 3 + 2 * (log2 - 7);
 }
 
-void* MemoryAllocator::allocZeroFilled(int64_t numMembers, int64_t sizeEach) {
-  return std::calloc(numMembers, sizeEach);
+// Lists of free blocks by size class. Blocks freed on a thread go to the
+// cache of that thread regardless of which thread allocated them.
+class ThreadBlockCache {
+ public:
+  ~ThreadBlockCache();
+
+  void* allocate(int32_t index, int64_t classSize) {
+    auto& blocks = blocks_[index];
+    if (blocks.empty()) {
+      return nullptr;
+    }
+    auto block = blocks.back();
+    blocks.pop_back();
+    cachedBytes_ -= classSize;
+    return block;
+  }
+
+  // Returns false if the cache is full, in which case the caller frees
+  // 'block'.
+  bool free(void* block, int32_t index, int64_t classSize) {
+    if (cachedBytes_ + classSize > kThreadCacheBytes) {
+      return false;
+    }
+    blocks_[index].push_back(block);
+    cachedBytes_ += classSize;
+    return true;
+  }
+
+ private:
+  std::array<std::vector<void*>, kNumSizeClasses> blocks_;
+  int64_t cachedBytes_{0};
+};
+
+// Set when the cache of the thread is destructed. Blocks freed after that,
+// e.g. from other thread_local destructors, go directly to std::free.
+thread_local bool threadCacheDestroyed{false};
+
+ThreadBlockCache::~ThreadBlockCache() {
+  threadCacheDestroyed = true;
+  for (auto& blocks : blocks_) {
+    for (auto block : blocks) {
+      std::free(block);
+    }
+  }
 }
 
-void* MemoryAllocator::allocAligned(uint16_t alignment, int64_t size) {
-  return aligned_alloc(alignment, size);
+ThreadBlockCache* threadCache() {
+  if (threadCacheDestroyed) {
+    return nullptr;
+  }
+  thread_local ThreadBlockCache cache;
+  return &cache;
 }
 
-void* MemoryAllocator::realloc(void* p, int64_t /* size */, int64_t newSize) {
-  return std::realloc(p, newSize);
+void* allocateBlock(uint16_t alignment, int64_t size) {
+  int64_t classSize;
+  auto index = sizeClass(size, classSize);
+  if (index < 0) {
+    return aligned_alloc(
+        std::max<uint16_t>(alignment, kDefaultAlignment),
+        bits::roundUp(size, kDefaultAlignment));
+  }
+  if (alignment <= kDefaultAlignment) {
+    if (auto cache = threadCache()) {
+      if (auto block = cache->allocate(index, classSize)) {
+        return block;
+      }
+    }
+    return aligned_alloc(kDefaultAlignment, classSize);
+  }
+  // Blocks with a larger alignment are not taken from the cache but have the
+  // size of their class so that they can be returned to it.
+  return aligned_alloc(alignment, std::max<int64_t>(classSize, alignment));
 }
 
-void* MemoryAllocator::reallocAligned(
-    void* p,
+void freeBlock(void* block, int64_t size) {
+  if (!block) {
+    return;
+  }
+  int64_t classSize;
+  auto index = sizeClass(size, classSize);
+  if (index >= 0) {
+    if (auto cache = threadCache()) {
+      if (cache->free(block, index, classSize)) {
+        return;
+      }
+    }
+  }
+  std::free(block);
+}
+
+void* reallocateBlock(
+    void* block,
     uint16_t alignment,
     int64_t size,
     int64_t newSize) {
   if (newSize <= 0) {
     return nullptr;
   }
-  auto block = aligned_alloc(alignment, newSize);
+  if (!block) {
+    return allocateBlock(alignment, newSize);
+  }
+  int64_t classSize;
+  int64_t newClassSize;
+  auto index = sizeClass(size, classSize);
+  if (index >= 0 && index == sizeClass(newSize, newClassSize) &&
+      alignment <= kDefaultAlignment) {
+    return block;
+  }
+  auto newBlock = allocateBlock(alignment, newSize);
+  if (newBlock) {
+    memcpy(newBlock, block, std::min(size, newSize));
+    freeBlock(block, size);
+  }
+  return newBlock;
+}
+} // namespace
+
+void* MemoryAllocator::alloc(int64_t size) {
+  return allocateBlock(kDefaultAlignment, size);
+}
+
+void* MemoryAllocator::allocZeroFilled(int64_t numMembers, int64_t sizeEach) {
+  const int64_t size = numMembers * sizeEach;
+  auto block = allocateBlock(kDefaultAlignment, size);
   if (block) {
-    memcpy(block, p, std::min(size, newSize));
-    std::free(p);
+    memset(block, 0, size);
   }
   return block;
 }
 
-void MemoryAllocator::free(void* p, int64_t /* size */) {
-  std::free(p);
+void* MemoryAllocator::allocAligned(uint16_t alignment, int64_t size) {
+  return allocateBlock(alignment, size);
+}
+
+void* MemoryAllocator::realloc(void* p, int64_t size, int64_t newSize) {
+  return reallocateBlock(p, kDefaultAlignment, size, newSize);
+}
+
+void* MemoryAllocator::reallocAligned(
+    void* p,
+    uint16_t alignment,
+    int64_t size,
+    int64_t newSize) {
+  return reallocateBlock(p, alignment, size, newSize);
+}
+
+void MemoryAllocator::free(void* p, int64_t size) {
+  freeBlock(p, size);
 }
 
 MemoryPoolBase::MemoryPoolBase(
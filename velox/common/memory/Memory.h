@@ -247,6 +247,10 @@ class ScopedMemoryPool final : public MemoryPool {
 
 // A standard allocator interface for the actual allocator of the memory
 // node tree.
+// Allocates blocks aligned to at least kDefaultAlignment. Blocks of up to 1MB
+// are rounded up to a size class and recycled through a per-thread cache of
+// freed blocks, so 'size' passed to realloc() and free() must not exceed the
+// size the block was allocated or last reallocated with.
 class MemoryAllocator {
  public:
   // TODO: move to factory pattern with type trait.
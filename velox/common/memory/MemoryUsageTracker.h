@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 
+#include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
 
 namespace facebook::velox::memory {
@@ -37,6 +38,9 @@ struct MemoryUsageConfig {
   std::optional<int64_t> maxUserMemory;
   std::optional<int64_t> maxSystemMemory;
   std::optional<int64_t> maxTotalMemory;
+  // If set, changes in usage are propagated to the parent in multiples
+  // of this many bytes. Inherited from the parent if not set.
+  std::optional<int64_t> updateBatchBytes;
 };
 
 struct MemoryUsageConfigBuilder {
@@ -60,6 +64,11 @@ struct MemoryUsageConfigBuilder {
     return *this;
   }
 
+  MemoryUsageConfigBuilder& updateBatchBytes(int64_t bytes) {
+    config.updateBatchBytes = bytes;
+    return *this;
+  }
+
   MemoryUsageConfig build() {
     return config;
   }
@@ -83,6 +92,15 @@ struct MemoryUsageConfigBuilder {
 // when above reservation counts as free up to the reservation size. Freeing
 // data within the reservation drops the usage but not the reservation.
 // release() frees unused reserved capacity.
+//
+// With 'updateBatchBytes' set, a tracker does not propagate every
+// change to its parent. It charges the parent in multiples of
+// 'updateBatchBytes' ahead of its usage and credits the parent back
+// when the charge exceeds the usage by more than two multiples. The
+// ancestors thus see at least the usage of their descendants, so that
+// their limits are enforced conservatively, while allocations that fit
+// in the charge touch only the tracker itself. This avoids contention
+// on the trackers near the root when many threads allocate at once.
 class MemoryUsageTracker
     : public std::enable_shared_from_this<MemoryUsageTracker> {
  public:
@@ -129,6 +147,34 @@ class MemoryUsageTracker
     }
   }
 
+  // Like reserve() but returns false instead of throwing if the
+  // reservation would exceed the limit of 'this' or an ancestor. The
+  // reservation is rounded up to a multiple of kReservationQuantum if
+  // this fits, so that the allocations that follow are within the
+  // reservation and do not update the ancestors one by one. This is
+  // used before an imminent growth, e.g. a rehash or adding a batch of
+  // input to a RowContainer, so that the caller can spill or flush
+  // before the growth instead of failing in the middle of it.
+  bool maybeReserve(int64_t size) {
+    int64_t available = reservation_ - usedReservation_;
+    int64_t actualSize = size - available;
+    if (actualSize <= 0) {
+      return true;
+    }
+    const int64_t roundedSize =
+        bits::roundUp(available + actualSize, kReservationQuantum) -
+        available;
+    if (roundedSize > actualSize && maybeUpdate(type_, roundedSize)) {
+      reservation_ += roundedSize;
+      return true;
+    }
+    if (maybeUpdate(type_, actualSize)) {
+      reservation_ += actualSize;
+      return true;
+    }
+    return false;
+  }
+
   // Release unused reservation. Used reservation will be released as the
   // allocations are freed. Note that this function is not thread-safe.
   void release() {
@@ -156,6 +202,20 @@ class MemoryUsageTracker
     }
   }
 
+  ~MemoryUsageTracker() {
+    if (!parent_ || batchBytes_ == 0) {
+      return;
+    }
+    // Return the part of the charge that is not covered by usage.
+    for (auto type : {UsageType::kUserMem, UsageType::kSystemMem}) {
+      auto index = static_cast<int>(type);
+      auto unused = chargedBytes_[index] - currentUsageInBytes_[index];
+      if (unused > 0) {
+        parent_->update(type, -unused);
+      }
+    }
+  }
+
   int64_t getCurrentUserBytes() const {
     return currentUsageInBytes_[static_cast<int>(UsageType::kUserMem)];
   }
@@ -179,6 +239,17 @@ class MemoryUsageTracker
     return std::max<int64_t>(0, reservation_ - usedReservation_);
   }
 
+  // Returns the number of bytes that can still be allocated through
+  // 'this' before exceeding the limit of 'this' or any of its
+  // ancestors. This is used for deciding to spill before an allocation
+  // fails.
+  int64_t getAvailableBytes() const {
+    return getAvailableBytes(type_);
+  }
+
+  // The granularity of reservations made with maybeReserve().
+  static constexpr int64_t kReservationQuantum = 1 << 20;
+
   int64_t getNumAllocs() const {
     return numAllocs_[static_cast<int>(UsageType::kTotalMem)];
   }
@@ -209,6 +280,13 @@ class MemoryUsageTracker
   int64_t reservation_{0};
   std::atomic<int64_t> usedReservation_{};
 
+  // The granularity of updates to 'parent_'. 0 means that every
+  // update is propagated.
+  const int64_t batchBytes_;
+  // The user and system memory charged to 'parent_' if 'batchBytes_'
+  // is not 0.
+  std::array<std::atomic<int64_t>, 2> chargedBytes_{};
+
   explicit MemoryUsageTracker(
       const std::shared_ptr<MemoryUsageTracker>& parent,
       UsageType type,
@@ -218,13 +296,27 @@ class MemoryUsageTracker
         maxMemory_{
             config.maxUserMemory.value_or(kMaxMemory),
             config.maxSystemMemory.value_or(kMaxMemory),
-            config.maxTotalMemory.value_or(kMaxMemory)} {}
+            config.maxTotalMemory.value_or(kMaxMemory)},
+        batchBytes_(config.updateBatchBytes.value_or(
+            parent ? parent->batchBytes_ : 0)) {}
 
   static std::shared_ptr<MemoryUsageTracker> create(
       const std::shared_ptr<MemoryUsageTracker>& parent,
       UsageType type,
       const MemoryUsageConfig& config);
 
+  int64_t getAvailableBytes(UsageType type) const {
+    int64_t available = std::min(
+        maxMemory_[static_cast<int>(type)] -
+            currentUsageInBytes_[static_cast<int>(type)],
+        maxMemory_[static_cast<int>(UsageType::kTotalMem)] -
+            getCurrentTotalBytes());
+    if (parent_) {
+      available = std::min(available, parent_->getAvailableBytes(type));
+    }
+    return std::max<int64_t>(0, available);
+  }
+
   void maySetMax(UsageType type, int64_t newPeak) {
     auto& peakUsage = peakUsageInBytes_[static_cast<int>(type)];
     int64_t oldPeak = peakUsage;
@@ -235,46 +327,89 @@ class MemoryUsageTracker
   }
 
   void update(UsageType type, int64_t size) {
-    // Update parent first. If one of the ancestor's limits are exceeded, it
-    // will throw VeloxMemoryCapExceeded exception.
-    if (parent_) {
-      parent_->update(type, size);
+    if (!maybeUpdate(type, size)) {
+      VELOX_MEM_CAP_EXCEEDED();
     }
+  }
 
+  // Increments the usage of 'this' and its ancestors by 'size'.
+  // Returns false and leaves the usage unchanged if this exceeds the
+  // limit of 'this' or an ancestor.
+  bool maybeUpdate(UsageType type, int64_t size) {
     auto newPeak = currentUsageInBytes_[static_cast<int>(type)].fetch_add(
                        size, std::memory_order_relaxed) +
         size;
 
-    if (size > 0) {
-      ++numAllocs_[static_cast<int>(type)];
-      cumulativeBytes_[static_cast<int>(type)] += size;
-      ++numAllocs_[static_cast<int>(UsageType::kTotalMem)];
-      cumulativeBytes_[static_cast<int>(UsageType::kTotalMem)] += size;
-    }
-
     // We track the peak usage of total memory independent of user and
     // system memory since freed user memory can be reallocated as system
     // memory and vice versa.
     int64_t total = getCurrentUserBytes() + getCurrentSystemBytes();
 
-    // Enforce the limit. Throw VeloxMemoryCapException exception if the limits
-    // are exceeded.
-    if (size > 0 &&
-        (newPeak > maxMemory_[static_cast<int>(type)] ||
-         total > maxMemory_[static_cast<int>(UsageType::kTotalMem)])) {
-      // Exceeded the limit. Fail allocation after reverting changes to
-      // parent and currentUsageInBytes_.
-      if (parent_) {
-        parent_->update(type, -size);
-      }
+    // Enforce the limit of 'this' and then of the ancestors. Fail
+    // allocation after reverting changes to currentUsageInBytes_.
+    if ((size > 0 &&
+         (newPeak > maxMemory_[static_cast<int>(type)] ||
+          total > maxMemory_[static_cast<int>(UsageType::kTotalMem)])) ||
+        (parent_ && !updateParent(type, newPeak, size))) {
       currentUsageInBytes_[static_cast<int>(type)].fetch_add(
           -size, std::memory_order_relaxed);
+      return false;
+    }
 
-      VELOX_MEM_CAP_EXCEEDED();
+    if (size > 0) {
+      ++numAllocs_[static_cast<int>(type)];
+      cumulativeBytes_[static_cast<int>(type)] += size;
+      ++numAllocs_[static_cast<int>(UsageType::kTotalMem)];
+      cumulativeBytes_[static_cast<int>(UsageType::kTotalMem)] += size;
     }
 
     maySetMax(type, newPeak);
     maySetMax(UsageType::kTotalMem, total);
+    return true;
+  }
+
+  // Propagates a change of 'size' bytes, which took the usage of
+  // 'type' to 'newUsage', to 'parent_'. With batching, the parent is
+  // charged only when 'newUsage' exceeds the charge and is credited
+  // back only when the charge exceeds 'newUsage' by more than two
+  // batches. Concurrent updates of the charge retry without locking.
+  // Returns false if the parent cannot be charged.
+  bool updateParent(UsageType type, int64_t newUsage, int64_t size) {
+    if (batchBytes_ == 0) {
+      return parent_->maybeUpdate(type, size);
+    }
+    auto& charged = chargedBytes_[static_cast<int>(type)];
+    int64_t oldCharged = charged;
+    if (size > 0) {
+      while (newUsage > oldCharged) {
+        int64_t newCharged = bits::roundUp(newUsage, batchBytes_);
+        if (!parent_->maybeUpdate(type, newCharged - oldCharged)) {
+          // The rounded up charge does not fit. Try the exact one.
+          newCharged = newUsage;
+          if (!parent_->maybeUpdate(type, newCharged - oldCharged)) {
+            return false;
+          }
+        }
+        const int64_t delta = newCharged - oldCharged;
+        if (charged.compare_exchange_weak(oldCharged, newCharged)) {
+          return true;
+        }
+        // The charge was changed by another update. Undo and retry
+        // with the new 'oldCharged'.
+        parent_->maybeUpdate(type, -delta);
+      }
+      return true;
+    }
+    while (oldCharged - newUsage > 2 * batchBytes_) {
+      const int64_t newCharged =
+          bits::roundUp(std::max<int64_t>(0, newUsage), batchBytes_) +
+          batchBytes_;
+      if (charged.compare_exchange_weak(oldCharged, newCharged)) {
+        parent_->maybeUpdate(type, newCharged - oldCharged);
+        break;
+      }
+    }
+    return true;
   }
 
   // Increments the amount of 'usedReservation_' by 'size'.  Returns the
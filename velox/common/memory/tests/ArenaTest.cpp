@@ -80,3 +80,34 @@ TEST(ArenaTest, writeString) {
   ASSERT_EQ(arena_fruits[2].find("pear"), 0);
   ASSERT_EQ(arena_fruits[3], "grape");
 }
+
+TEST(ArenaTest, allocateAligned) {
+  Arena arena;
+  arena.reserve(3);
+  auto* values = arena.allocate<int64_t>(10);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(values) % alignof(int64_t));
+  for (int i = 0; i < 10; ++i) {
+    values[i] = i;
+  }
+  auto* other = arena.allocate<int64_t>(1);
+  ASSERT_GE(
+      reinterpret_cast<char*>(other), reinterpret_cast<char*>(values + 10));
+}
+
+TEST(ArenaTest, clear) {
+  Arena arena;
+  char* first = arena.reserve(10);
+  arena.clear();
+  // The memory is reused after clear().
+  ASSERT_EQ(first, arena.reserve(10));
+
+  // Several chunks are replaced by one that fits all of them.
+  constexpr int kBufSize = 3 * 1000 * 1000;
+  arena.reserve(kBufSize);
+  arena.reserve(kBufSize);
+  arena.clear();
+  char* pos1 = arena.reserve(kBufSize);
+  char* pos2 = arena.reserve(kBufSize);
+  ASSERT_EQ(pos1 + kBufSize, pos2);
+  memset(pos1, 'x', 2 * kBufSize);
+}
@@ -340,4 +340,139 @@ TEST_F(MappedMemoryTest, minSizeClass) {
   mappedMemory->free(result);
   EXPECT_EQ(0, tracker->getCurrentUserBytes());
 }
+
+TEST_F(MappedMemoryTest, numaNode) {
+  auto numNodes = MappedMemory::numNumaNodes();
+  EXPECT_GE(numNodes, 1);
+  auto node = MappedMemory::currentNumaNode();
+  EXPECT_GE(node, 0);
+  EXPECT_LT(node, numNodes);
+
+  // The node is a hint. Allocations for any node succeed.
+  for (auto i = 0; i <= numNodes; ++i) {
+    MappedMemory::Allocation result(instance_);
+    ASSERT_TRUE(instance_->allocate(100, 0, result, nullptr, 0, i));
+    EXPECT_GE(result.numPages(), 100);
+    initializeContents(result);
+    checkContents(result);
+  }
+}
+
+TEST_F(MappedMemoryTest, sizeClassOccupancy) {
+  auto mappedMemory = MappedMemory::createDefaultInstance();
+  auto& sizes = mappedMemory->sizes();
+  auto pagesInClasses = [&]() {
+    MachinePageCount sum = 0;
+    for (auto i = 0; i < sizes.size(); ++i) {
+      sum += mappedMemory->numAllocatedInSizeClass(i);
+    }
+    return sum;
+  };
+  {
+    // One run of 256 pages and one of 16.
+    MappedMemory::Allocation result(mappedMemory.get());
+    ASSERT_TRUE(mappedMemory->allocate(256 + 16, 0, result));
+    EXPECT_EQ(2, result.numRuns());
+    for (auto i = 0; i < sizes.size(); ++i) {
+      EXPECT_EQ(
+          sizes[i] == 256 || sizes[i] == 16 ? sizes[i] : 0,
+          mappedMemory->numAllocatedInSizeClass(i));
+    }
+    EXPECT_EQ(mappedMemory->numAllocated(), pagesInClasses());
+  }
+  EXPECT_EQ(0, pagesInClasses());
+}
+
+TEST_F(MappedMemoryTest, hugePages) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_memory_huge_pages = true;
+  auto mappedMemory = MappedMemory::createDefaultInstance();
+  EXPECT_EQ(MappedMemory::kPagesPerHugePage, mappedMemory->sizes().back());
+  {
+    MappedMemory::Allocation result(mappedMemory.get());
+    constexpr MachinePageCount kNumPages = 3 * MappedMemory::kPagesPerHugePage;
+    ASSERT_TRUE(mappedMemory->allocate(kNumPages, 0, result));
+    EXPECT_EQ(kNumPages, result.numPages());
+    EXPECT_EQ(kNumPages, mappedMemory->numHugeAllocated());
+    for (auto i = 0; i < result.numRuns(); ++i) {
+      auto address = reinterpret_cast<uint64_t>(result.runAt(i).data());
+      EXPECT_EQ(0, address % MappedMemory::kHugePageSize);
+    }
+    initializeContents(result);
+    checkContents(result);
+
+    // Small allocations do not use huge pages.
+    MappedMemory::Allocation small(mappedMemory.get());
+    ASSERT_TRUE(mappedMemory->allocate(20, 0, small));
+    EXPECT_EQ(kNumPages, mappedMemory->numHugeAllocated());
+  }
+  EXPECT_EQ(0, mappedMemory->numHugeAllocated());
+  EXPECT_EQ(0, mappedMemory->numAllocated());
+
+  auto table = MappedMemory::allocateAligned(MappedMemory::kHugePageSize, 64);
+  EXPECT_EQ(
+      0, reinterpret_cast<uint64_t>(table) % MappedMemory::kHugePageSize);
+  ::free(table);
+}
+
+TEST_F(MappedMemoryTest, mmap) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_use_malloc = false;
+  FLAGS_velox_memory_pool_mb = 4;
+  constexpr MachinePageCount kPoolPages = (4 << 20) / MappedMemory::kPageSize;
+  auto mappedMemory = MappedMemory::createDefaultInstance();
+  {
+    MappedMemory::Allocation large(mappedMemory.get());
+    ASSERT_TRUE(mappedMemory->allocate(kPoolPages, 0, large));
+    EXPECT_EQ(kPoolPages, mappedMemory->numAllocated());
+    EXPECT_EQ(kPoolPages, mappedMemory->numMapped());
+    for (auto i = 0; i < large.numRuns(); ++i) {
+      auto address = reinterpret_cast<uint64_t>(large.runAt(i).data());
+      EXPECT_EQ(0, address % MappedMemory::kPageSize);
+    }
+    initializeContents(large);
+    checkContents(large);
+    EXPECT_TRUE(mappedMemory->checkConsistency());
+
+    // The pool is full.
+    MappedMemory::Allocation small(mappedMemory.get());
+    EXPECT_FALSE(mappedMemory->allocate(4, 0, small));
+    EXPECT_EQ(0, small.numPages());
+    EXPECT_EQ(kPoolPages, mappedMemory->numAllocated());
+
+    // Freed memory stays mapped.
+    mappedMemory->free(large);
+    EXPECT_EQ(0, mappedMemory->numAllocated());
+    EXPECT_EQ(kPoolPages, mappedMemory->numMapped());
+
+    // Mapping a new run of 64 pages returns a free run of 256 pages to
+    // the system.
+    ASSERT_TRUE(mappedMemory->allocate(64, 0, small));
+    EXPECT_EQ(kPoolPages + 64 - 256, mappedMemory->numMapped());
+
+    // A run of 256 pages reuses mapped memory.
+    ASSERT_TRUE(mappedMemory->allocate(256, 0, large));
+    EXPECT_EQ(kPoolPages + 64 - 256, mappedMemory->numMapped());
+    EXPECT_TRUE(mappedMemory->checkConsistency());
+  }
+  EXPECT_EQ(0, mappedMemory->numAllocated());
+
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([&, i]() {
+      MappedMemory::Allocation allocation(mappedMemory.get());
+      for (auto size = 1; size < 200; size += 1 + i) {
+        if (mappedMemory->allocate(size, 0, allocation)) {
+          initializeContents(allocation);
+          checkContents(allocation);
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, mappedMemory->numAllocated());
+  EXPECT_TRUE(mappedMemory->checkConsistency());
+}
 } // namespace facebook::velox::memory
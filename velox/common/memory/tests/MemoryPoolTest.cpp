@@ -254,6 +254,34 @@ TEST(MemoryPoolTest, AllocTest) {
   EXPECT_EQ(4 * kChunkSize, child.getMaxBytes());
 }
 
+TEST(MemoryPoolTest, allocatorSizeClasses) {
+  MemoryAllocator allocator;
+  for (auto size : {1, 40, 64, 100, 129, 200, 1000, 5000, 2 << 20}) {
+    auto* block = allocator.alloc(size);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % kDefaultAlignment);
+    memset(block, 1, size);
+    allocator.free(block, size);
+  }
+
+  // A freed block is reused by the next allocation of its size class on the
+  // same thread.
+  auto* block = allocator.alloc(300);
+  allocator.free(block, 300);
+  EXPECT_EQ(block, allocator.alloc(380));
+
+  // Growing within the size class keeps the block.
+  EXPECT_EQ(block, allocator.realloc(block, 380, 384));
+  auto* grown = allocator.realloc(block, 384, 10000);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(grown) % kDefaultAlignment);
+  allocator.free(grown, 10000);
+
+  auto* zeros = static_cast<char*>(allocator.allocZeroFilled(100, 1));
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_EQ(0, zeros[i]);
+  }
+  allocator.free(zeros, 100);
+}
+
 TEST(MemoryPoolTest, ReallocTestSameSize) {
   MemoryManager<MemoryAllocator> manager{8 * GB};
   auto& root = manager.getRoot();
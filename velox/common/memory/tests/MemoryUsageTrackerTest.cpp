@@ -195,3 +195,97 @@ TEST(MemoryUsageTrackerTest, reserve) {
   EXPECT_EQ(child->getCurrentTotalBytes(), -512);
   EXPECT_EQ(parent->getCurrentTotalBytes(), -512);
 }
+
+TEST(MemoryUsageTrackerTest, maybeReserve) {
+  constexpr int64_t kQuantum = MemoryUsageTracker::kReservationQuantum;
+  constexpr int64_t kMaxSize = 4 * kQuantum;
+  auto config = MemoryUsageConfigBuilder().maxUserMemory(kMaxSize).build();
+  auto parent = MemoryUsageTracker::create(config);
+
+  auto child = parent->addChild();
+
+  EXPECT_FALSE(child->maybeReserve(2 * kMaxSize));
+  EXPECT_EQ(child->getAvailableReservation(), 0);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 0);
+
+  // A small reservation is rounded up to the quantum.
+  EXPECT_TRUE(child->maybeReserve(1000));
+  EXPECT_EQ(child->getAvailableReservation(), kQuantum);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kQuantum);
+
+  // Allocations within the reservation do not change the usage.
+  child->update(512);
+  EXPECT_EQ(child->getAvailableReservation(), kQuantum - 512);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kQuantum);
+
+  // The rounded up reservation does not fit, the exact one does.
+  EXPECT_TRUE(child->maybeReserve(3 * kQuantum + 1));
+  EXPECT_EQ(child->getAvailableReservation(), 3 * kQuantum + 1);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 3 * kQuantum + 513);
+
+  // A denied reservation leaves the usage unchanged.
+  EXPECT_FALSE(child->maybeReserve(kMaxSize));
+  EXPECT_EQ(child->getAvailableReservation(), 3 * kQuantum + 1);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 3 * kQuantum + 513);
+
+  child->release();
+  EXPECT_EQ(child->getAvailableReservation(), 0);
+  EXPECT_EQ(child->getCurrentTotalBytes(), 512);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 512);
+}
+
+TEST(MemoryUsageTrackerTest, updateBatchBytes) {
+  constexpr int64_t kMB = 1 << 20;
+  auto parent = MemoryUsageTracker::create();
+  auto child = parent->addChild(
+      false, MemoryUsageConfigBuilder().updateBatchBytes(kMB).build());
+  // Inherits the batching of 'child'.
+  auto grandChild = child->addChild();
+
+  // The ancestors are charged a whole batch ahead of the usage.
+  grandChild->update(1000);
+  EXPECT_EQ(grandChild->getCurrentTotalBytes(), 1000);
+  EXPECT_EQ(child->getCurrentTotalBytes(), kMB);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kMB);
+
+  grandChild->update(2000);
+  EXPECT_EQ(child->getCurrentTotalBytes(), kMB);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kMB);
+
+  grandChild->update(4 * kMB);
+  EXPECT_EQ(child->getCurrentTotalBytes(), 5 * kMB);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 5 * kMB);
+
+  // The charge is credited back when it exceeds the usage by more
+  // than two batches.
+  grandChild->update(-kMB);
+  EXPECT_EQ(child->getCurrentTotalBytes(), 5 * kMB);
+  grandChild->update(-(3 * kMB + 3000));
+  EXPECT_EQ(grandChild->getCurrentTotalBytes(), 0);
+  EXPECT_EQ(child->getCurrentTotalBytes(), kMB);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 2 * kMB);
+
+  // The unused charge is returned when the tracker goes away.
+  grandChild.reset();
+  EXPECT_EQ(child->getCurrentTotalBytes(), 0);
+  child.reset();
+  EXPECT_EQ(parent->getCurrentTotalBytes(), 0);
+}
+
+TEST(MemoryUsageTrackerTest, updateBatchBytesAtLimit) {
+  constexpr int64_t kMB = 1 << 20;
+  auto config = MemoryUsageConfigBuilder()
+                    .maxUserMemory(kMB + kMB / 2)
+                    .updateBatchBytes(kMB)
+                    .build();
+  auto parent = MemoryUsageTracker::create(config);
+  auto child = parent->addChild();
+
+  // A rounded up charge that does not fit falls back to the exact one.
+  child->update(kMB + 1);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kMB + 1);
+
+  EXPECT_THROW(child->update(kMB), VeloxRuntimeError);
+  EXPECT_EQ(child->getCurrentTotalBytes(), kMB + 1);
+  EXPECT_EQ(parent->getCurrentTotalBytes(), kMB + 1);
+}
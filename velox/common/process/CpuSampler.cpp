@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/process/CpuSampler.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <mutex>
+
+namespace facebook::velox::process {
+namespace {
+std::atomic<bool> isRunning{false};
+std::atomic<bool> handlerInstalled{false};
+std::atomic<uint64_t> totalSamples{0};
+std::atomic<uint64_t> untargetedSamples{0};
+std::mutex startMutex;
+
+// Read by the signal handler on the same thread. Has no constructor, so
+// that the handler does not run thread local initialization.
+thread_local std::atomic<uint64_t>* tTarget = nullptr;
+
+void onSigprof(int /*signal*/) {
+  if (!isRunning.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto savedErrno = errno;
+  totalSamples.fetch_add(1, std::memory_order_relaxed);
+  if (auto* target = tTarget) {
+    target->fetch_add(1, std::memory_order_relaxed);
+  } else {
+    untargetedSamples.fetch_add(1, std::memory_order_relaxed);
+  }
+  errno = savedErrno;
+}
+
+bool setTimer(int64_t intervalMicros) {
+  struct itimerval timer;
+  timer.it_interval.tv_sec = intervalMicros / 1'000'000;
+  timer.it_interval.tv_usec = intervalMicros % 1'000'000;
+  timer.it_value = timer.it_interval;
+  return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+} // namespace
+
+// static
+bool CpuSampler::start(int64_t intervalMicros) {
+  if (intervalMicros <= 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> l(startMutex);
+  if (isRunning) {
+    return false;
+  }
+  if (!handlerInstalled) {
+    struct sigaction action {};
+    action.sa_handler = onSigprof;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      return false;
+    }
+    handlerInstalled = true;
+  }
+  isRunning = true;
+  if (!setTimer(intervalMicros)) {
+    isRunning = false;
+    return false;
+  }
+  return true;
+}
+
+// static
+void CpuSampler::stop() {
+  std::lock_guard<std::mutex> l(startMutex);
+  if (!isRunning) {
+    return;
+  }
+  setTimer(0);
+  isRunning = false;
+}
+
+// static
+bool CpuSampler::running() {
+  return isRunning;
+}
+
+// static
+uint64_t CpuSampler::numSamples() {
+  return totalSamples;
+}
+
+// static
+uint64_t CpuSampler::numUntargetedSamples() {
+  return untargetedSamples;
+}
+
+ScopedCpuSampleTarget::ScopedCpuSampleTarget(std::atomic<uint64_t>* counter)
+    : previous_(tTarget) {
+  tTarget = counter;
+  // The handler may run between any two instructions of this thread.
+  std::atomic_signal_fence(std::memory_order_release);
+}
+
+ScopedCpuSampleTarget::~ScopedCpuSampleTarget() {
+  tTarget = previous_;
+  std::atomic_signal_fence(std::memory_order_release);
+}
+
+} // namespace facebook::velox::process
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace facebook::velox::process {
+
+// Samples the CPU time of the process with SIGPROF and counts the samples
+// per target. Code running on behalf of something, e.g. an Operator of a
+// Driver, points the calling thread at its counter with
+// ScopedCpuSampleTarget and each sample taken on the thread is added to
+// that counter. A sample costs a relaxed atomic add in the signal handler.
+// Switching targets costs a thread local store whether sampling is on or
+// not.
+//
+// The sampler is process-wide and off until start(). The kernel sends the
+// SIGPROF of the process CPU timer to a thread that is running, so the
+// samples of a thread are proportional to its CPU time.
+class CpuSampler {
+ public:
+  // Starts taking a sample every 'intervalMicros' of CPU time of the
+  // process. Returns false if sampling is already on or the timer or the
+  // signal handler cannot be set.
+  static bool start(int64_t intervalMicros);
+
+  // Stops sampling. The signal handler stays installed so that a signal
+  // still in flight does not terminate the process.
+  static void stop();
+
+  static bool running();
+
+  // Returns the number of samples taken since the process started.
+  static uint64_t numSamples();
+
+  // Returns the number of samples taken on a thread without a target.
+  static uint64_t numUntargetedSamples();
+};
+
+// Makes 'counter' receive the samples of the calling thread for the
+// lifetime of 'this'. 'counter' may be nullptr, which makes the samples
+// untargeted.
+class ScopedCpuSampleTarget {
+ public:
+  explicit ScopedCpuSampleTarget(std::atomic<uint64_t>* counter);
+
+  ~ScopedCpuSampleTarget();
+
+  ScopedCpuSampleTarget(const ScopedCpuSampleTarget&) = delete;
+  void operator=(const ScopedCpuSampleTarget&) = delete;
+
+ private:
+  std::atomic<uint64_t>* const previous_;
+};
+
+} // namespace facebook::velox::process
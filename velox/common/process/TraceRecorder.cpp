@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/process/TraceRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+
+namespace facebook::velox::process {
+namespace {
+std::atomic<uint64_t> nextRecorderId{1};
+
+struct ThreadContext {
+  TraceRecorder* recorder{nullptr};
+  int32_t track{0};
+  // The ring of the calling thread in the recorder with id 'ringOwnerId'.
+  uint64_t ringOwnerId{0};
+  void* ring{nullptr};
+};
+
+ThreadContext& threadContext() {
+  thread_local ThreadContext context;
+  return context;
+}
+
+void appendJsonString(const std::string& string, std::ostream& out) {
+  out << '"';
+  for (auto c : string) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << ' ';
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+} // namespace
+
+TraceRecorder::TraceRecorder(int32_t eventsPerThread)
+    : id_(nextRecorderId++), eventsPerThread_(eventsPerThread) {
+  trackNames_.push_back("other");
+}
+
+int32_t TraceRecorder::addTrack(std::string name) {
+  std::lock_guard<std::mutex> l(mutex_);
+  trackNames_.push_back(std::move(name));
+  return trackNames_.size() - 1;
+}
+
+TraceRecorder::Ring& TraceRecorder::threadRing() {
+  auto& context = threadContext();
+  if (context.ringOwnerId == id_) {
+    return *reinterpret_cast<Ring*>(context.ring);
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& ring = rings_[std::this_thread::get_id()];
+  if (!ring) {
+    ring = std::make_unique<Ring>(eventsPerThread_);
+  }
+  context.ringOwnerId = id_;
+  context.ring = ring.get();
+  return *ring;
+}
+
+void TraceRecorder::record(const TraceEvent& event) {
+  if (eventsPerThread_ == 0) {
+    return;
+  }
+  auto& ring = threadRing();
+  std::lock_guard<std::mutex> l(ring.mutex);
+  ring.events[ring.numRecorded % ring.events.size()] = event;
+  ++ring.numRecorded;
+}
+
+std::vector<TraceEvent> TraceRecorder::events() const {
+  std::vector<TraceEvent> result;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    for (auto& [id, ring] : rings_) {
+      std::lock_guard<std::mutex> ringLock(ring->mutex);
+      auto size = ring->events.size();
+      auto numEvents = std::min<uint64_t>(ring->numRecorded, size);
+      for (auto i = ring->numRecorded - numEvents; i < ring->numRecorded;
+           ++i) {
+        result.push_back(ring->events[i % size]);
+      }
+    }
+  }
+  std::stable_sort(
+      result.begin(),
+      result.end(),
+      [](const TraceEvent& left, const TraceEvent& right) {
+        return left.startMicros < right.startMicros;
+      });
+  return result;
+}
+
+uint64_t TraceRecorder::numDropped() const {
+  uint64_t numDropped = 0;
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& [id, ring] : rings_) {
+    std::lock_guard<std::mutex> ringLock(ring->mutex);
+    if (ring->numRecorded > ring->events.size()) {
+      numDropped += ring->numRecorded - ring->events.size();
+    }
+  }
+  return numDropped;
+}
+
+std::string TraceRecorder::toChromeTrace(
+    const std::string& processName) const {
+  auto allEvents = events();
+  std::vector<std::string> trackNames;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    trackNames = trackNames_;
+  }
+  std::stringstream out;
+  out << "{\"traceEvents\":[";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+      << "\"args\":{\"name\":";
+  appendJsonString(processName, out);
+  out << "}}";
+  for (size_t track = 0; track < trackNames.size(); ++track) {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << track << ",\"args\":{\"name\":";
+    appendJsonString(trackNames[track], out);
+    out << "}}";
+  }
+  for (auto& event : allEvents) {
+    out << ",\n{\"name\":";
+    appendJsonString(event.name, out);
+    out << ",\"cat\":";
+    appendJsonString(event.category, out);
+    if (event.isInstant) {
+      out << ",\"ph\":\"i\",\"s\":\"t\"";
+    } else {
+      out << ",\"ph\":\"X\",\"dur\":" << event.durationMicros;
+    }
+    out << ",\"ts\":" << event.startMicros << ",\"pid\":1,\"tid\":"
+        << event.track << ",\"args\":{\"value\":" << event.value << "}}";
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}";
+  return out.str();
+}
+
+// static
+uint64_t TraceRecorder::nowMicros() {
+  // The same clock as BlockingState so that blocked times line up.
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::high_resolution_clock::now().time_since_epoch())
+      .count();
+}
+
+// static
+TraceRecorder* TraceRecorder::current() {
+  return threadContext().recorder;
+}
+
+// static
+int32_t TraceRecorder::currentTrack() {
+  return threadContext().track;
+}
+
+ScopedTraceContext::ScopedTraceContext(TraceRecorder* recorder, int32_t track)
+    : previousRecorder_(threadContext().recorder),
+      previousTrack_(threadContext().track) {
+  threadContext().recorder = recorder;
+  threadContext().track = track;
+}
+
+ScopedTraceContext::~ScopedTraceContext() {
+  threadContext().recorder = previousRecorder_;
+  threadContext().track = previousTrack_;
+}
+
+} // namespace facebook::velox::process
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace facebook::velox::process {
+
+// An event on a timeline. 'name' and 'category' must be string literals or
+// otherwise outlive the TraceRecorder.
+struct TraceEvent {
+  const char* name{nullptr};
+  const char* category{nullptr};
+  // The timeline the event is shown on, e.g. a Driver. See
+  // TraceRecorder::addTrack().
+  int32_t track{0};
+  uint64_t startMicros{0};
+  // 0 for an instant event.
+  uint64_t durationMicros{0};
+  bool isInstant{false};
+  // Optional argument, e.g. a byte count.
+  int64_t value{0};
+};
+
+// Records TraceEvents with low overhead for diagnosing where time goes,
+// e.g. how long Drivers of a Task are blocked on each BlockingReason. Each
+// recording thread has its own fixed size ring buffer, so that recording
+// does not contend and the oldest events are overwritten when a ring is
+// full. The events can be exported in the Chrome trace event format, which
+// is read by chrome://tracing and Perfetto.
+//
+// Code on a thread with a current recorder records with TraceSpan and
+// traceInstant(). These do nothing if there is no current recorder.
+class TraceRecorder {
+ public:
+  static constexpr int32_t kDefaultEventsPerThread = 16 << 10;
+
+  explicit TraceRecorder(int32_t eventsPerThread = kDefaultEventsPerThread);
+
+  // Returns the id of a new track that is displayed as 'name'. Track 0 is
+  // for events not recorded on behalf of a track.
+  int32_t addTrack(std::string name);
+
+  // Adds 'event' to the ring of the calling thread.
+  void record(const TraceEvent& event);
+
+  // Returns the events in the rings of all threads ordered by start time.
+  std::vector<TraceEvent> events() const;
+
+  // Returns the number of events that were overwritten by newer ones.
+  uint64_t numDropped() const;
+
+  // Returns the events as a JSON document in the Chrome trace event
+  // format. Each track is a thread of a process named 'processName'.
+  std::string toChromeTrace(const std::string& processName) const;
+
+  // Returns the time in the unit and epoch of TraceEvent::startMicros.
+  static uint64_t nowMicros();
+
+  // Returns the recorder of the calling thread, nullptr if none. See
+  // ScopedTraceContext.
+  static TraceRecorder* current();
+
+  // Returns the track of the calling thread.
+  static int32_t currentTrack();
+
+ private:
+  struct Ring {
+    explicit Ring(int32_t size) : events(size) {}
+
+    // Only contended when exporting.
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    uint64_t numRecorded{0};
+  };
+
+  Ring& threadRing();
+
+  // Distinguishes 'this' from an earlier recorder at the same address in
+  // the thread local lookup of the ring.
+  const uint64_t id_;
+  const int32_t eventsPerThread_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::thread::id, std::unique_ptr<Ring>> rings_;
+  std::vector<std::string> trackNames_;
+};
+
+// Makes 'recorder' and 'track' current for the calling thread for the
+// lifetime of 'this'. 'recorder' may be nullptr, which disables recording.
+class ScopedTraceContext {
+ public:
+  ScopedTraceContext(TraceRecorder* recorder, int32_t track);
+
+  ~ScopedTraceContext();
+
+ private:
+  TraceRecorder* const previousRecorder_;
+  const int32_t previousTrack_;
+};
+
+// Records an event from construction to destruction on the current
+// recorder of the constructing thread, if any.
+class TraceSpan {
+ public:
+  TraceSpan(const char* name, const char* category, int64_t value = 0)
+      : recorder_(TraceRecorder::current()) {
+    if (recorder_) {
+      event_.name = name;
+      event_.category = category;
+      event_.track = TraceRecorder::currentTrack();
+      event_.value = value;
+      event_.startMicros = TraceRecorder::nowMicros();
+    }
+  }
+
+  ~TraceSpan() {
+    if (recorder_) {
+      event_.durationMicros = TraceRecorder::nowMicros() - event_.startMicros;
+      recorder_->record(event_);
+    }
+  }
+
+  void setValue(int64_t value) {
+    event_.value = value;
+  }
+
+ private:
+  TraceRecorder* const recorder_;
+  TraceEvent event_;
+};
+
+// Records an instant event on the current recorder, if any.
+inline void
+traceInstant(const char* name, const char* category, int64_t value = 0) {
+  if (auto recorder = TraceRecorder::current()) {
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.track = TraceRecorder::currentTrack();
+    event.startMicros = TraceRecorder::nowMicros();
+    event.isInstant = true;
+    event.value = value;
+    recorder->record(event);
+  }
+}
+
+} // namespace facebook::velox::process
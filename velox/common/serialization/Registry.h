@@ -22,6 +22,7 @@
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <atomic>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
@@ -60,6 +61,15 @@ class Registry {
     if (helpMsg) {
       helpMessage_[key] = *helpMsg;
     }
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * Returns a number that changes every time a creator is registered.
+   * Can be used to invalidate caches of lookup results.
+   */
+  uint64_t version() const {
+    return version_.load(std::memory_order_acquire);
   }
 
   inline bool Has(const KeyType& key) const {
@@ -93,6 +103,7 @@ class Registry {
   CreatorMap creatorMap_;
   std::unordered_map<KeyType, std::string> helpMessage_;
   std::mutex registerutex_;
+  std::atomic<uint64_t> version_{0};
 
   Registry(const Registry& other) = delete;
 
@@ -152,6 +152,14 @@ TEST_F(BitUtilTest, reverseBits) {
   for (size_t i = 0; i < 10000; i++) {
     EXPECT_EQ(bytes[i], bytesCopy[i]);
   }
+
+  // Unaligned start and a length that is not a multiple of 8.
+  reverseBits(bytes + 3, 21);
+  for (size_t i = 0; i < 30; i++) {
+    EXPECT_EQ(
+        bytes[i],
+        i >= 3 && i < 24 ? BitReverseTable256[bytesCopy[i]] : bytesCopy[i]);
+  }
 }
 
 TEST_F(BitUtilTest, isAllSet) {
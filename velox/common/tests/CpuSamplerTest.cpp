@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/process/CpuSampler.h"
+
+#include <gtest/gtest.h>
+
+#include <ctime>
+
+using namespace facebook::velox::process;
+
+namespace {
+// Spins for 'millis' of CPU time of the process.
+void burnCpu(int32_t millis) {
+  auto end = std::clock() + millis * (CLOCKS_PER_SEC / 1'000);
+  volatile uint64_t sum = 0;
+  while (std::clock() < end) {
+    for (auto i = 0; i < 1'000; ++i) {
+      sum = sum + i;
+    }
+  }
+}
+} // namespace
+
+TEST(CpuSamplerTest, targets) {
+  EXPECT_FALSE(CpuSampler::start(0));
+  std::atomic<uint64_t> outer{0};
+  std::atomic<uint64_t> inner{0};
+  // Without sampling, targets cost nothing and receive nothing.
+  {
+    ScopedCpuSampleTarget target(&outer);
+    burnCpu(20);
+  }
+  EXPECT_EQ(0, outer);
+
+  ASSERT_TRUE(CpuSampler::start(1'000));
+  EXPECT_TRUE(CpuSampler::running());
+  EXPECT_FALSE(CpuSampler::start(1'000));
+  auto numSamples = CpuSampler::numSamples();
+  {
+    ScopedCpuSampleTarget outerTarget(&outer);
+    burnCpu(100);
+    {
+      ScopedCpuSampleTarget innerTarget(&inner);
+      burnCpu(100);
+    }
+    burnCpu(100);
+  }
+  auto numUntargeted = CpuSampler::numUntargetedSamples();
+  burnCpu(100);
+  CpuSampler::stop();
+  EXPECT_FALSE(CpuSampler::running());
+
+  EXPECT_LT(0, outer);
+  EXPECT_LT(0, inner);
+  EXPECT_LT(numUntargeted, CpuSampler::numUntargetedSamples());
+  EXPECT_LE(outer + inner, CpuSampler::numSamples() - numSamples);
+
+  // No samples after stop().
+  auto numOuter = outer.load();
+  {
+    ScopedCpuSampleTarget target(&outer);
+    burnCpu(20);
+  }
+  EXPECT_EQ(numOuter, outer);
+}
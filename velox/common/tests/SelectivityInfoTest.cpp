@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/base/SelectivityInfo.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+
+namespace {
+void addBatches(
+    SelectivityInfo& info,
+    int32_t numBatches,
+    uint64_t batchSize,
+    uint64_t numOut) {
+  for (auto i = 0; i < numBatches; ++i) {
+    SelectivityTimer timer(info, batchSize);
+    info.addOutput(numOut);
+  }
+}
+} // namespace
+
+TEST(SelectivityInfoTest, boundedHistory) {
+  SelectivityInfo info;
+  addBatches(info, 1'000, 1'000, 500);
+  EXPECT_LT(info.numIn(), SelectivityInfo::kMaxHistoryRows);
+  EXPECT_GT(info.numIn(), SelectivityInfo::kMaxHistoryRows / 4);
+  EXPECT_NEAR(
+      static_cast<double>(info.numOut()) / info.numIn(), 0.5, 0.01);
+}
+
+TEST(SelectivityInfoTest, followsChange) {
+  SelectivityInfo info;
+  // Passes all rows, then drops all rows. The recent rows dominate.
+  addBatches(info, 400, 1'000, 1'000);
+  EXPECT_EQ(info.numIn(), info.numOut());
+  addBatches(info, 400, 1'000, 0);
+  EXPECT_LT(info.numOut(), info.numIn() / 10);
+}
@@ -190,6 +190,27 @@ TEST_F(SimdUtilTest, gatherBits) {
   EXPECT_FALSE(bits::isBitSet(&bits, 7));
 }
 
+TEST_F(SimdUtilTest, gatherBitsBulk) {
+  std::vector<uint64_t> data(100);
+  randomBits(data, 300);
+  for (auto numIndices : {0, 5, 8, 64, 100, 1'001}) {
+    std::vector<int32_t> indices(numIndices);
+    for (auto& index : indices) {
+      index = folly::Random::rand32(rng_) % (data.size() * 64);
+    }
+    std::vector<uint64_t> result(bits::nwords(numIndices) + 1, ~0UL);
+    simd::gatherBits(data.data(), indices.data(), numIndices, result.data());
+    for (auto i = 0; i < numIndices; ++i) {
+      ASSERT_EQ(
+          bits::isBitSet(data.data(), indices[i]),
+          bits::isBitSet(result.data(), i))
+          << "at " << i;
+    }
+    // Only the bytes with gathered bits are written.
+    EXPECT_EQ(~0UL, result.back());
+  }
+}
+
 TEST_F(SimdUtilTest, permute32) {
   // Find elements that satisfy a condition and pack them to the left.
   __m256si data = {12345, 23456, 111, 32000, 14123, 20000, 25000};
@@ -15,6 +15,7 @@
  */
 
 #include "velox/common/base/StatsReporter.h"
+#include "velox/common/base/Counters.h"
 #include <folly/Singleton.h>
 #include <folly/init/Init.h>
 #include <gtest/gtest.h>
@@ -32,6 +33,9 @@ class TestReporter : public BaseStatsReporter {
  public:
   mutable std::unordered_map<std::string, size_t> counterMap;
   mutable std::unordered_map<std::string, StatType> counterTypeMap;
+  mutable std::unordered_map<std::string, std::vector<int32_t>>
+      histogramPercentilesMap;
+  mutable std::unordered_map<std::string, std::vector<size_t>> histogramMap;
 
   void addStatExportType(const char* key, StatType statType) const override {
     counterTypeMap[key] = statType;
@@ -53,6 +57,21 @@ class TestReporter : public BaseStatsReporter {
   void addStatValue(folly::StringPiece key, size_t value) const override {
     counterMap[key.str()] += value;
   }
+
+  void addHistogramExportPercentiles(
+      folly::StringPiece key,
+      int64_t /*bucketWidth*/,
+      int64_t /*min*/,
+      int64_t /*max*/,
+      const std::vector<int32_t>& percentiles) const override {
+    counterTypeMap[key.str()] = StatType::HISTOGRAM;
+    histogramPercentilesMap[key.str()] = percentiles;
+  }
+
+  void addHistogramValue(folly::StringPiece key, size_t value)
+      const override {
+    histogramMap[key.str()].push_back(value);
+  }
 };
 
 TEST_F(StatsReporterTest, trivialReporter) {
@@ -82,6 +101,36 @@ TEST_F(StatsReporterTest, trivialReporter) {
   EXPECT_EQ(1101, reporter->counterMap["key3"]);
 };
 
+TEST_F(StatsReporterTest, histogram) {
+  auto reporter = std::dynamic_pointer_cast<TestReporter>(
+      folly::Singleton<BaseStatsReporter>::try_get());
+
+  REPORT_ADD_HISTOGRAM_EXPORT_PERCENTILES("hist1", 10, 0, 100, 50, 99);
+  EXPECT_EQ(StatType::HISTOGRAM, reporter->counterTypeMap["hist1"]);
+  EXPECT_EQ(
+      std::vector<int32_t>({50, 99}),
+      reporter->histogramPercentilesMap["hist1"]);
+
+  REPORT_ADD_HISTOGRAM_VALUE("hist1", 12);
+  REPORT_ADD_HISTOGRAM_VALUE("hist1", 70);
+  EXPECT_EQ(std::vector<size_t>({12, 70}), reporter->histogramMap["hist1"]);
+}
+
+TEST_F(StatsReporterTest, veloxCounters) {
+  auto reporter = std::dynamic_pointer_cast<TestReporter>(
+      folly::Singleton<BaseStatsReporter>::try_get());
+
+  registerVeloxCounters();
+  EXPECT_EQ(
+      StatType::SUM, reporter->counterTypeMap[kCounterCacheNumHits.str()]);
+  EXPECT_EQ(
+      StatType::AVG,
+      reporter->counterTypeMap[kCounterMappedMemoryAllocatedPages.str()]);
+  EXPECT_EQ(
+      StatType::HISTOGRAM,
+      reporter->counterTypeMap[kCounterExchangeFetchLatencyUs.str()]);
+}
+
 // Registering to folly Singleton with intended reporter type
 folly::Singleton<BaseStatsReporter> reporter([]() {
   return new TestReporter();
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/common/process/TraceRecorder.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace facebook::velox::process;
+
+TEST(TraceRecorderTest, spansAndInstants) {
+  TraceRecorder recorder(100);
+  auto track = recorder.addTrack("driver");
+  // Without a current recorder, nothing is recorded.
+  traceInstant("ignored", "test");
+  {
+    ScopedTraceContext context(&recorder, track);
+    TraceSpan span("span", "test", 1);
+    traceInstant("instant", "test", 2);
+  }
+  traceInstant("ignored", "test");
+
+  auto events = recorder.events();
+  ASSERT_EQ(2, events.size());
+  // The span is recorded at its end but ordered by its start.
+  auto& span = std::string(events[0].name) == "span" ? events[0] : events[1];
+  auto& instant = &span == &events[0] ? events[1] : events[0];
+  EXPECT_LE(span.startMicros, instant.startMicros);
+  EXPECT_FALSE(span.isInstant);
+  EXPECT_EQ(1, span.value);
+  EXPECT_EQ(std::string("instant"), instant.name);
+  EXPECT_TRUE(instant.isInstant);
+  EXPECT_EQ(2, instant.value);
+  for (auto& event : events) {
+    EXPECT_EQ(track, event.track);
+  }
+  EXPECT_EQ(nullptr, TraceRecorder::current());
+}
+
+TEST(TraceRecorderTest, ringPerThread) {
+  constexpr int32_t kNumThreads = 4;
+  TraceRecorder recorder(10);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&recorder, i]() {
+      ScopedTraceContext context(&recorder, i);
+      for (auto j = 0; j < 15; ++j) {
+        traceInstant("event", "test", j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Each ring keeps its 10 latest events.
+  auto events = recorder.events();
+  EXPECT_EQ(kNumThreads * 10, events.size());
+  EXPECT_EQ(kNumThreads * 5, recorder.numDropped());
+  for (auto& event : events) {
+    EXPECT_GE(event.value, 5);
+  }
+}
+
+TEST(TraceRecorderTest, chromeTrace) {
+  TraceRecorder recorder;
+  auto track = recorder.addTrack("pipeline \"0\"");
+  {
+    ScopedTraceContext context(&recorder, track);
+    TraceSpan span("run", "driver");
+  }
+  auto trace = recorder.toChromeTrace("task.1");
+  EXPECT_EQ(0, trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"task.1\"}"));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"pipeline \\\"0\\\"\""));
+  EXPECT_NE(
+      std::string::npos, trace.find("\"name\":\"run\",\"cat\":\"driver\""));
+  EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+}
@@ -83,18 +83,28 @@ void Connector::unregisterTracker(cache::ScanTracker* tracker) {
 }
 
 std::shared_ptr<cache::ScanTracker> Connector::getTracker(
-    const std::string& scanId) {
+    const std::string& scanId,
+    std::string_view table) {
+  auto makeTracker = [&]() {
+    if (table.empty()) {
+      return std::make_shared<cache::ScanTracker>(scanId, unregisterTracker);
+    }
+    return std::make_shared<cache::ScanTracker>(
+        scanId,
+        unregisterTracker,
+        table,
+        &cache::TrackingHistory::instance());
+  };
   return trackers_.withWLock([&](auto& trackers) -> auto {
     auto it = trackers.find(scanId);
     if (it == trackers.end()) {
-      auto newTracker =
-          std::make_shared<cache::ScanTracker>(scanId, unregisterTracker);
+      auto newTracker = makeTracker();
       trackers[newTracker->id()] = newTracker;
       return newTracker;
     }
     std::shared_ptr<cache::ScanTracker> tracker = it->second.lock();
     if (!tracker) {
-      tracker = std::make_shared<cache::ScanTracker>(scanId, unregisterTracker);
+      tracker = makeTracker();
       trackers[tracker->id()] = tracker;
     }
     return tracker;
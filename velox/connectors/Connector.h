@@ -15,12 +15,15 @@
  */
 #pragma once
 
+#include "velox/common/base/AsyncSource.h"
 #include "velox/common/caching/DataCache.h"
 #include "velox/common/caching/ScanTracker.h"
 #include "velox/core/Context.h"
 #include "velox/vector/ComplexVector.h"
 
+#include <folly/CancellationToken.h>
 #include <folly/Synchronized.h>
+#include <folly/futures/Future.h>
 
 namespace facebook::velox::common {
 class Filter;
@@ -33,6 +36,8 @@ class ExprSet;
 }
 namespace facebook::velox::connector {
 
+class DataSource;
+
 // A split represents a chunk of data that a connector should load and return
 // as a RowVectorPtr, potentially after processing pushdowns.
 struct ConnectorSplit {
@@ -42,6 +47,11 @@ struct ConnectorSplit {
   // async prefetch for the split.
   bool cancelled{false};
 
+  // DataSource with 'this' added, prepared in the background ahead of
+  // processing by the TableScan that fetched 'this'. nullptr if 'this'
+  // is not preloaded.
+  std::shared_ptr<AsyncSource<DataSource>> dataSource;
+
   explicit ConnectorSplit(const std::string& _connectorId)
       : connectorId(_connectorId) {}
 
@@ -50,16 +60,35 @@ struct ConnectorSplit {
   virtual std::string toString() const {
     return fmt::format("[split: {}]", connectorId);
   }
+
+  // Returns a string that identifies the data of 'this' across queries,
+  // e.g. file, byte range and modification time. Results computed from
+  // the split may be cached under this key. Empty if the data may
+  // change without the key changing, in which case nothing is cached.
+  virtual std::string cacheKey() const {
+    return "";
+  }
 };
 
 class ColumnHandle {
  public:
   virtual ~ColumnHandle() = default;
+
+  virtual std::string toString() const {
+    return "";
+  }
 };
 
 class ConnectorTableHandle {
  public:
   virtual ~ConnectorTableHandle() = default;
+
+  // Describes the table and the pushed down filters. Used for plan
+  // printing and for telling apart plan fragments that read the same
+  // table with different filters.
+  virtual std::string toString() const {
+    return "";
+  }
 };
 
 /**
@@ -84,7 +113,20 @@ class DataSink {
   // TODO maybe at some point we want to make it async
   virtual void appendData(VectorPtr input) = 0;
 
+  // Returns true if appendData() should not be called until 'future' is
+  // realized, e.g. because too much written data waits for the storage.
+  virtual bool isBlocked(folly::SemiFuture<folly::Unit>* /*future*/) {
+    return false;
+  }
+
   virtual void close() = 0;
+
+  // Called by memory arbitration to free at least 'bytes' bytes, e.g. by
+  // finishing files that are being written. Returns the number of bytes
+  // freed.
+  virtual uint64_t reclaim(uint64_t /*bytes*/) {
+    return 0;
+  }
 };
 
 class DataSource {
@@ -117,6 +159,16 @@ class DataSource {
 
   virtual std::unordered_map<std::string, int64_t> runtimeStats() = 0;
 
+  // Continues with the split of 'source', which was created by the
+  // same connector for the same table and columns and had the split
+  // added in the background. Takes over its open file and reader and
+  // adds its stats to 'this'. Dynamic filters received by 'this' are
+  // not transferred. Only called if the connector supports split
+  // preload.
+  virtual void setFromDataSource(std::shared_ptr<DataSource> /*source*/) {
+    VELOX_UNSUPPORTED("setFromDataSource");
+  }
+
   // TODO Allow DataSource to indicate that it is blocked (say waiting for IO)
   // to avoid holding up the thread.
 };
@@ -148,12 +200,14 @@ class ConnectorQueryCtx {
       Config* config,
       ExpressionEvaluator* expressionEvaluator,
       memory::MappedMemory* mappedMemory,
-      const std::string& scanId)
+      const std::string& scanId,
+      folly::CancellationToken cancellationToken = {})
       : pool_(pool),
         config_(config),
         expressionEvaluator_(expressionEvaluator),
         mappedMemory_(mappedMemory),
-        scanId_(scanId) {}
+        scanId_(scanId),
+        cancellationToken_(std::move(cancellationToken)) {}
 
   memory::MemoryPool* memoryPool() const {
     return pool_;
@@ -182,12 +236,19 @@ class ConnectorQueryCtx {
     return scanId_;
   }
 
+  // Cancelled when the task is terminated. Lets IO started on behalf of
+  // the query, e.g. prefetches on an executor, stop early.
+  const folly::CancellationToken& cancellationToken() const {
+    return cancellationToken_;
+  }
+
  private:
   memory::MemoryPool* pool_;
   Config* config_;
   ExpressionEvaluator* expressionEvaluator_;
   memory::MappedMemory* mappedMemory_;
   std::string scanId_;
+  folly::CancellationToken cancellationToken_;
 };
 
 class Connector {
@@ -225,8 +286,24 @@ class Connector {
       std::shared_ptr<ConnectorInsertTableHandle> connectorInsertTableHandle,
       ConnectorQueryCtx* connectorQueryCtx) = 0;
 
+  // Returns the ScanTracker for 'scanId'. If 'table' is not empty, a
+  // new tracker starts from the TrackingHistory of 'table' and adds
+  // its data to the history when it is destroyed.
+  // Returns true if DataSources of 'this' can have their splits added
+  // on a background thread and be passed to setFromDataSource().
+  virtual bool supportsSplitPreload() const {
+    return false;
+  }
+
+  // Returns the executor for background IO and split preload, nullptr
+  // if none.
+  virtual folly::Executor* executor() const {
+    return nullptr;
+  }
+
   static std::shared_ptr<cache::ScanTracker> getTracker(
-      const std::string& scanId);
+      const std::string& scanId,
+      std::string_view table = "");
 
  private:
   static void unregisterTracker(cache::ScanTracker* tracker);
@@ -44,6 +44,7 @@ std::unique_ptr<FileHandle> FileHandleGenerator::operator()(
                          ->openFileForRead(filename);
   fileHandle->uuid = StringIdLease(fileIds(), filename);
   fileHandle->groupId = StringIdLease(fileIds(), groupName(filename));
+  fileHandle->modificationTime = fileHandle->file->modificationTime();
   VLOG(1) << "Generating file handle for: " << filename
           << " uuid: " << fileHandle->uuid.id();
   // TODO: build the hash map/etc per file type -- presumably after reading
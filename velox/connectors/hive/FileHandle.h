@@ -51,6 +51,11 @@ struct FileHandle {
   // example to decide placing on SSD.
   StringIdLease groupId;
 
+  // Modification time of 'file' when it was opened, as given by
+  // ReadFile::modificationTime(). A cached handle whose time differs
+  // from the one known for a split is stale.
+  int64_t modificationTime{0};
+
   // We'll want to have a hash map here to record the identifier->byte range
   // mappings. Different formats may have different identifiers, so we may need
   // a union of maps. For example in orc you need 3 integers (I think, to be
@@ -15,6 +15,15 @@
  */
 #include "velox/connectors/hive/HiveConnector.h"
 #include <velox/dwio/dwrf/reader/SelectiveColumnReader.h>
+
+#include <filesystem>
+#include <map>
+#include <numeric>
+
+#include <folly/Conv.h>
+#include <folly/Random.h>
+
+#include "velox/connectors/hive/HivePartitionFunction.h"
 #include "velox/dwio/common/InputStream.h"
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
 #include "velox/expression/ControlExpr.h"
@@ -27,36 +36,265 @@ DEFINE_int32(
     1024,
     "Amount of space for the file handle cache in mb.");
 
+DEFINE_int64(
+    file_handle_expiration_ms,
+    0,
+    "Time after which a cached file handle is reopened. 0 means never.");
+
 namespace facebook::velox::connector::hive {
 namespace {
 static const char* kPath = "$path";
 static const char* kBucket = "$bucket";
 } // namespace
 
+namespace {
+// Directory name of partitions whose partitioning column is null.
+constexpr const char* kDefaultPartitionName = "__HIVE_DEFAULT_PARTITION__";
+
+// Returns true if 'path' is on the local file system.
+bool isLocalPath(const std::string& path) {
+  return path.find("/") == 0 || path.find("file:") == 0;
+}
+} // namespace
+
+std::string HiveTableHandle::toString() const {
+  // Sorts the filters by subfield so that equal handles print the same.
+  std::map<std::string, std::string> filters;
+  for (const auto& [subfield, filter] : subfieldFilters_) {
+    filters[subfield.toString()] = filter->toString();
+  }
+  std::ostringstream out;
+  out << "table: " << tableName_
+      << (filterPushdownEnabled_ ? ", pushdown" : "");
+  for (const auto& [subfield, filter] : filters) {
+    out << ", " << subfield << ": " << filter;
+  }
+  if (remainingFilter_) {
+    out << ", remaining filter: " << remainingFilter_->toString();
+  }
+  return out.str();
+}
+
 HiveDataSink::HiveDataSink(
     std::shared_ptr<const RowType> inputType,
-    const std::string& filePath,
-    velox::memory::MemoryPool* memoryPool)
-    : inputType_(inputType) {
+    std::shared_ptr<const HiveInsertTableHandle> insertTableHandle,
+    velox::memory::MemoryPool* memoryPool,
+    int32_t maxOpenWriters,
+    folly::Executor* writeExecutor)
+    : inputType_(inputType),
+      insertTableHandle_(std::move(insertTableHandle)),
+      pool_(memoryPool),
+      maxOpenWriters_(maxOpenWriters),
+      writeExecutor_(writeExecutor),
+      fileNamePrefix_(fmt::format("{:016x}", folly::Random::rand64())) {
+  if (!insertTableHandle_->isPartitioned()) {
+    writer_ = createWriter(insertTableHandle_->filePath());
+    return;
+  }
+  VELOX_USER_CHECK_GT(maxOpenWriters_, 0);
+  const auto& partitionedBy = insertTableHandle_->partitionedBy();
+  for (auto& name : partitionedBy) {
+    auto channel = inputType_->getChildIdx(name);
+    VELOX_USER_CHECK(
+        inputType_->childAt(channel)->isPrimitiveType(),
+        "Partitioning column must be of a primitive type: {}",
+        name);
+    partitionChannels_.push_back(channel);
+  }
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  for (ChannelIndex i = 0; i < inputType_->size(); ++i) {
+    const auto& name = inputType_->nameOf(i);
+    if (std::find(partitionedBy.begin(), partitionedBy.end(), name) ==
+        partitionedBy.end()) {
+      dataChannels_.push_back(i);
+      names.push_back(name);
+      types.push_back(inputType_->childAt(i));
+    }
+  }
+  VELOX_USER_CHECK(
+      !dataChannels_.empty(), "All columns are partitioning columns");
+  dataType_ = ROW(std::move(names), std::move(types));
+
+  if (insertTableHandle_->bucketCount() > 0) {
+    std::vector<ChannelIndex> bucketChannels;
+    for (auto& name : insertTableHandle_->bucketedBy()) {
+      bucketChannels.push_back(inputType_->getChildIdx(name));
+    }
+    const auto bucketCount = insertTableHandle_->bucketCount();
+    std::vector<int> bucketToPartition(bucketCount);
+    std::iota(bucketToPartition.begin(), bucketToPartition.end(), 0);
+    bucketFunction_ = std::make_unique<HivePartitionFunction>(
+        bucketCount, std::move(bucketToPartition), std::move(bucketChannels));
+  }
+}
+
+HiveDataSink::~HiveDataSink() = default;
+
+std::unique_ptr<Writer> HiveDataSink::createWriter(const std::string& path) {
   auto config = std::make_shared<WriterConfig>();
   // TODO: Wire up serde properties to writer configs.
 
   facebook::velox::dwrf::WriterOptions options;
   options.config = config;
-  options.schema = inputType;
+  options.schema = dataType_ ? dataType_ : inputType_;
+  options.writeExecutor = writeExecutor_;
   // Without explicitly setting flush policy, the default memory based flush
   // policy is used.
 
-  auto sink = facebook::velox::dwio::common::DataSink::create(filePath);
-  writer_ = std::make_unique<Writer>(options, std::move(sink), *memoryPool);
+  auto sink = facebook::velox::dwio::common::DataSink::create(path);
+  return std::make_unique<Writer>(options, std::move(sink), *pool_);
 }
 
 void HiveDataSink::appendData(VectorPtr input) {
-  writer_->write(input);
+  if (writer_) {
+    writer_->write(input);
+    return;
+  }
+  auto rowVector = std::dynamic_pointer_cast<RowVector>(input);
+  VELOX_CHECK_NOT_NULL(rowVector);
+  computePartitions(*rowVector);
+
+  std::unordered_map<std::string, std::vector<vector_size_t>> partitionRows;
+  for (vector_size_t row = 0; row < rowVector->size(); ++row) {
+    partitionRows[partitions_[row]].push_back(row);
+  }
+  for (auto& [partition, rows] : partitionRows) {
+    const vector_size_t numRows = rows.size();
+    std::vector<VectorPtr> children;
+    children.reserve(dataChannels_.size());
+    if (numRows == rowVector->size()) {
+      for (auto channel : dataChannels_) {
+        children.push_back(rowVector->childAt(channel));
+      }
+    } else {
+      auto indices = AlignedBuffer::allocate<vector_size_t>(numRows, pool_);
+      std::copy(
+          rows.begin(), rows.end(), indices->asMutable<vector_size_t>());
+      for (auto channel : dataChannels_) {
+        children.push_back(BaseVector::wrapInDictionary(
+            nullptr, indices, numRows, rowVector->childAt(channel)));
+      }
+    }
+    writerFor(partition).write(std::make_shared<RowVector>(
+        pool_, dataType_, nullptr, numRows, std::move(children)));
+  }
+}
+
+bool HiveDataSink::isBlocked(folly::SemiFuture<folly::Unit>* future) {
+  if (writer_) {
+    return writer_->isBlocked(future);
+  }
+  for (auto& [partition, partitionWriter] : writers_) {
+    if (partitionWriter.writer->isBlocked(future)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void HiveDataSink::computePartitions(const RowVector& input) {
+  const auto numRows = input.size();
+  partitions_.resize(numRows);
+  for (auto row = 0; row < numRows; ++row) {
+    partitions_[row].clear();
+  }
+  for (auto i = 0; i < partitionChannels_.size(); ++i) {
+    const auto channel = partitionChannels_[i];
+    const auto& vector = input.childAt(channel);
+    const auto& name = inputType_->nameOf(channel);
+    // Partitioning columns are usually constant within a batch.
+    std::string constantName;
+    if (vector->isConstantEncoding()) {
+      constantName = vector->isNullAt(0) ? kDefaultPartitionName
+                                         : vector->toString(0);
+    }
+    for (auto row = 0; row < numRows; ++row) {
+      auto& partition = partitions_[row];
+      if (i > 0) {
+        partition.push_back('/');
+      }
+      partition.append(name);
+      partition.push_back('=');
+      if (vector->isConstantEncoding()) {
+        partition.append(constantName);
+      } else if (vector->isNullAt(row)) {
+        partition.append(kDefaultPartitionName);
+      } else {
+        partition.append(vector->toString(row));
+      }
+    }
+  }
+  if (bucketFunction_) {
+    bucketFunction_->partition(input, buckets_);
+    for (auto row = 0; row < numRows; ++row) {
+      auto& partition = partitions_[row];
+      if (!partition.empty()) {
+        partition.push_back('/');
+      }
+      partition.append(fmt::format("{:06d}", buckets_[row]));
+    }
+  }
+}
+
+Writer& HiveDataSink::writerFor(const std::string& partition) {
+  ++numWrites_;
+  auto it = writers_.find(partition);
+  if (it != writers_.end()) {
+    it->second.lastWrite = numWrites_;
+    return *it->second.writer;
+  }
+  if (writers_.size() >= maxOpenWriters_) {
+    closeLeastRecentlyWritten();
+  }
+  const auto fileName = fmt::format("{}_{}", fileNamePrefix_, numFiles_++);
+  const auto& directory = insertTableHandle_->filePath();
+  // The names of bucket files start with the bucket number, which is the
+  // last component of 'partition' if bucketed.
+  const auto path = bucketFunction_
+      ? fmt::format("{}/{}_{}", directory, partition, fileName)
+      : fmt::format("{}/{}/{}", directory, partition, fileName);
+  if (isLocalPath(path)) {
+    auto localPath = path.find("file:") == 0 ? path.substr(5) : path;
+    std::filesystem::create_directories(
+        std::filesystem::path(localPath).parent_path());
+  }
+  auto& partitionWriter = writers_[partition];
+  partitionWriter.writer = createWriter(path);
+  partitionWriter.lastWrite = numWrites_;
+  return *partitionWriter.writer;
+}
+
+void HiveDataSink::closeLeastRecentlyWritten() {
+  auto oldest = writers_.begin();
+  for (auto it = writers_.begin(); it != writers_.end(); ++it) {
+    if (it->second.lastWrite < oldest->second.lastWrite) {
+      oldest = it;
+    }
+  }
+  oldest->second.writer->close();
+  writers_.erase(oldest);
 }
 
 void HiveDataSink::close() {
-  writer_->close();
+  if (writer_) {
+    writer_->close();
+    return;
+  }
+  for (auto& [partition, partitionWriter] : writers_) {
+    partitionWriter.writer->close();
+  }
+  writers_.clear();
+}
+
+uint64_t HiveDataSink::reclaim(uint64_t bytes) {
+  uint64_t freed = 0;
+  while (freed < bytes && !writers_.empty()) {
+    const auto before = pool_->getCurrentBytes();
+    closeLeastRecentlyWritten();
+    freed += std::max<int64_t>(0, before - pool_->getCurrentBytes());
+  }
+  return freed;
 }
 
 namespace {
@@ -71,9 +309,8 @@ static void makeFieldSpecs(
     common::Subfield subfield(path);
     common::ScanSpec* fieldSpec = spec->getOrCreateChild(subfield);
     fieldSpec->setProjectOut(true);
-    if (level == 0) {
-      fieldSpec->setChannel(i);
-    }
+    // Nested fields are placed in their struct by channel too.
+    fieldSpec->setChannel(i);
     auto fieldType = type->childAt(i);
     if (fieldType->kind() == TypeKind::ROW) {
       makeFieldSpecs(
@@ -107,6 +344,173 @@ std::unique_ptr<common::ScanSpec> makeScanSpec(
   }
   return spec;
 }
+
+// Restricts the map or array 'spec' of 'type' to the keys or leading
+// elements in 'subfields', whose path elements at 'level' are the
+// subscripts. Does nothing if a subfield refers to the whole value or to
+// all subscripts.
+void setSubscriptPruning(
+    const TypePtr& type,
+    const std::vector<const common::Subfield*>& subfields,
+    size_t level,
+    common::ScanSpec* spec) {
+  std::vector<int64_t> longKeys;
+  std::vector<std::string> stringKeys;
+  for (auto subfield : subfields) {
+    auto& path = subfield->path();
+    if (path.size() <= level) {
+      return;
+    }
+    auto element = path[level].get();
+    switch (element->kind()) {
+      case common::kLongSubscript:
+        longKeys.push_back(
+            static_cast<const common::Subfield::LongSubscript*>(element)
+                ->index());
+        break;
+      case common::kStringSubscript:
+        stringKeys.push_back(
+            static_cast<const common::Subfield::StringSubscript*>(element)
+                ->index());
+        break;
+      default:
+        return;
+    }
+  }
+  if (type->kind() == TypeKind::ARRAY) {
+    if (!stringKeys.empty() || longKeys.empty()) {
+      return;
+    }
+    // Subscripts of arrays are 1-based.
+    auto maxIndex = *std::max_element(longKeys.begin(), longKeys.end());
+    auto minIndex = *std::min_element(longKeys.begin(), longKeys.end());
+    if (minIndex > 0 && maxIndex < std::numeric_limits<vector_size_t>::max()) {
+      spec->setMaxArrayElementsCount(maxIndex);
+    }
+    return;
+  }
+  if (type->kind() != TypeKind::MAP) {
+    return;
+  }
+  auto keyKind = type->childAt(0)->kind();
+  switch (keyKind) {
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT:
+      if (!stringKeys.empty()) {
+        return;
+      }
+      std::sort(longKeys.begin(), longKeys.end());
+      longKeys.erase(
+          std::unique(longKeys.begin(), longKeys.end()), longKeys.end());
+      spec->setMapKeyFilter(common::createBigintValues(longKeys, false));
+      break;
+    case TypeKind::VARCHAR:
+      if (!longKeys.empty()) {
+        return;
+      }
+      spec->setMapKeyFilter(
+          std::make_unique<common::BytesValues>(stringKeys, false));
+      break;
+    default:
+      break;
+  }
+}
+
+// Restricts 'spec' of 'type' to the parts referenced by 'subfields', whose
+// path elements from 'level' on refer to the inside of 'type'. The fields
+// of a struct that no subfield refers to become null constants, so that
+// they are neither read nor decoded. Fields with filters are kept. Does
+// nothing if a subfield refers to the whole value.
+void setSubfieldPruning(
+    const TypePtr& type,
+    const std::vector<const common::Subfield*>& subfields,
+    size_t level,
+    common::ScanSpec* spec,
+    memory::MemoryPool* pool) {
+  if (type->kind() != TypeKind::ROW) {
+    setSubscriptPruning(type, subfields, level, spec);
+    return;
+  }
+  std::unordered_map<std::string, std::vector<const common::Subfield*>>
+      fieldSubfields;
+  for (auto subfield : subfields) {
+    auto& path = subfield->path();
+    if (path.size() <= level) {
+      return;
+    }
+    auto element = path[level].get();
+    if (element->kind() != common::kNestedField) {
+      return;
+    }
+    auto& name =
+        static_cast<const common::Subfield::NestedField*>(element)->name();
+    fieldSubfields[name].push_back(subfield);
+  }
+  auto& rowType = type->asRow();
+  bool anyRead = false;
+  for (auto i = 0; i < rowType.size(); ++i) {
+    if (fieldSubfields.count(rowType.nameOf(i))) {
+      anyRead = true;
+    }
+  }
+  if (!anyRead) {
+    // The struct reader needs at least one field to read.
+    return;
+  }
+  for (auto i = 0; i < rowType.size(); ++i) {
+    auto childSpec = spec->childByName(rowType.nameOf(i));
+    auto it = fieldSubfields.find(rowType.nameOf(i));
+    if (it != fieldSubfields.end()) {
+      setSubfieldPruning(
+          rowType.childAt(i), it->second, level + 1, childSpec, pool);
+    } else if (!childSpec->hasFilter()) {
+      childSpec->setConstantValue(
+          BaseVector::createNullConstant(rowType.childAt(i), 1, pool));
+    }
+  }
+}
+
+// Adds the names of the file columns read for 'spec' to 'names'. For a
+// struct of which only some fields are read, these are the paths of the
+// read fields, e.g. a.b, so that the streams of the other fields are not
+// loaded. 'fileType' is the type of the column in the file.
+void addSelectedColumns(
+    const common::ScanSpec& spec,
+    const std::string& path,
+    const TypePtr& fileType,
+    std::vector<std::string>& names) {
+  auto& children = spec.children();
+  bool isPruned = fileType->kind() == TypeKind::ROW &&
+      std::any_of(children.begin(), children.end(), [](const auto& child) {
+        return child->isConstant();
+      });
+  if (isPruned) {
+    auto& rowType = fileType->asRow();
+    for (auto& child : children) {
+      if (!child->isConstant() && !rowType.containsChild(child->fieldName())) {
+        // Missing from an old file. Read the whole struct as before.
+        isPruned = false;
+        break;
+      }
+    }
+  }
+  if (!isPruned) {
+    names.push_back(path);
+    return;
+  }
+  auto& rowType = fileType->asRow();
+  for (auto& child : children) {
+    if (!child->isConstant()) {
+      addSelectedColumns(
+          *child,
+          path + "." + child->fieldName(),
+          rowType.findChild(child->fieldName()),
+          names);
+    }
+  }
+}
 } // namespace
 
 HiveDataSource::HiveDataSource(
@@ -121,7 +525,10 @@ HiveDataSource::HiveDataSource(
     ExpressionEvaluator* expressionEvaluator,
     memory::MappedMemory* mappedMemory,
     const std::string& scanId,
-    folly::Executor* executor)
+    folly::Executor* executor,
+    cache::CacheRetention cacheRetention,
+    folly::Executor* decodingExecutor,
+    folly::CancellationToken cancellationToken)
     : outputType_(outputType),
       fileHandleFactory_(fileHandleFactory),
       pool_(pool),
@@ -130,11 +537,15 @@ HiveDataSource::HiveDataSource(
       expressionEvaluator_(expressionEvaluator),
       mappedMemory_(mappedMemory),
       scanId_(scanId),
-      executor_(executor) {
+      executor_(executor),
+      cacheRetention_(cacheRetention),
+      cancellationToken_(std::move(cancellationToken)) {
   regularColumns_.reserve(outputType->size());
 
   std::vector<std::string> columnNames;
   columnNames.reserve(outputType->size());
+  // Map and array columns that read only some subscripts.
+  std::vector<std::pair<TypePtr, const HiveColumnHandle*>> prunedColumns;
   for (auto& name : outputType->names()) {
     auto it = columnHandles.find(name);
     VELOX_CHECK(
@@ -151,6 +562,10 @@ HiveDataSource::HiveDataSource(
     columnNames.emplace_back(handle->name());
     if (handle->columnType() == HiveColumnHandle::ColumnType::kRegular) {
       regularColumns_.emplace_back(handle->name());
+      if (!handle->requiredSubfields().empty()) {
+        prunedColumns.emplace_back(
+            outputType->childAt(columnNames.size() - 1), handle.get());
+      }
     }
   }
 
@@ -162,11 +577,20 @@ HiveDataSource::HiveDataSource(
   VELOX_CHECK(
       hiveTableHandle->isFilterPushdownEnabled(),
       "Filter pushdown must be enabled");
+  tableName_ = hiveTableHandle->tableName();
 
   auto outputTypes = outputType_->children();
   readerOutputType_ = ROW(std::move(columnNames), std::move(outputTypes));
   scanSpec_ =
       makeScanSpec(hiveTableHandle->subfieldFilters(), readerOutputType_);
+  for (auto& [type, handle] : prunedColumns) {
+    std::vector<const common::Subfield*> subfields;
+    for (auto& subfield : handle->requiredSubfields()) {
+      subfields.push_back(&subfield);
+    }
+    setSubfieldPruning(
+        type, subfields, 1, scanSpec_->childByName(handle->name()), pool_);
+  }
 
   const auto& remainingFilter = hiveTableHandle->remainingFilter();
   if (remainingFilter) {
@@ -193,11 +617,14 @@ HiveDataSource::HiveDataSource(
       fieldSpec->setChannel(channel++);
     }
     readerOutputType_ = ROW(std::move(names), std::move(types));
+    scanRowFilter_ = std::make_unique<ScanRowFilter>(this);
+    scanSpec_->setRowFilter(scanRowFilter_.get());
   }
 
   columnReaderFactory_ =
       std::make_unique<dwrf::SelectiveColumnReaderFactory>(scanSpec_.get());
   rowReaderOpts_.setColumnReaderFactory(columnReaderFactory_.get());
+  rowReaderOpts_.setDecodingExecutor(decodingExecutor);
 
   ioStats_ = std::make_shared<dwio::common::IoStatistics>();
 }
@@ -240,6 +667,62 @@ bool testFilters(
   return true;
 }
 
+// Returns false if no row of a split with partition key 'value' passes
+// 'filter'. Numeric and boolean filters are tested on the parsed value,
+// the others on the string.
+bool testPartitionValue(
+    const common::Filter& filter,
+    const std::optional<std::string>& value) {
+  if (!filter.isDeterministic()) {
+    return true;
+  }
+  if (!value.has_value()) {
+    return filter.testNull();
+  }
+  switch (filter.kind()) {
+    case common::FilterKind::kAlwaysFalse:
+    case common::FilterKind::kAlwaysTrue:
+    case common::FilterKind::kIsNull:
+    case common::FilterKind::kIsNotNull:
+    case common::FilterKind::kBytesRange:
+    case common::FilterKind::kBytesValues:
+      return filter.testBytes(value->data(), value->size());
+    case common::FilterKind::kBigintRange:
+    case common::FilterKind::kBigintValuesUsingHashTable:
+    case common::FilterKind::kBigintValuesUsingBitmask:
+    case common::FilterKind::kBigintMultiRange: {
+      auto parsed = folly::tryTo<int64_t>(*value);
+      return parsed.hasError() || filter.testInt64(parsed.value());
+    }
+    case common::FilterKind::kDoubleRange: {
+      auto parsed = folly::tryTo<double>(*value);
+      return parsed.hasError() || filter.testDouble(parsed.value());
+    }
+    case common::FilterKind::kBoolValue: {
+      auto parsed = folly::tryTo<bool>(*value);
+      return parsed.hasError() || filter.testBool(parsed.value());
+    }
+    default:
+      return true;
+  }
+}
+
+// Returns false if the filters on partition keys rule out the split. Does
+// not touch the file.
+bool testPartitionFilters(
+    common::ScanSpec* scanSpec,
+    const std::unordered_map<std::string, std::optional<std::string>>&
+        partitionKeys) {
+  for (const auto& [name, value] : partitionKeys) {
+    auto childSpec = scanSpec->childByName(name);
+    if (childSpec && childSpec->filter() &&
+        !testPartitionValue(*childSpec->filter(), value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 class InputStreamHolder : public dwrf::AbstractInputStreamHolder {
  public:
   InputStreamHolder(
@@ -278,12 +761,21 @@ void HiveDataSource::addDynamicFilter(
     const std::shared_ptr<common::Filter>& filter) {
   auto& fieldSpec = scanSpec_->getChildByChannel(outputChannel);
   if (fieldSpec.filter()) {
-    fieldSpec.setFilter(fieldSpec.filter()->mergeWith(filter.get()));
+    // Only a BloomFilter can merge with any other kind of filter.
+    if (filter->kind() == common::FilterKind::kBloomFilter) {
+      fieldSpec.setFilter(filter->mergeWith(fieldSpec.filter()));
+    } else {
+      fieldSpec.setFilter(fieldSpec.filter()->mergeWith(filter.get()));
+    }
   } else {
     fieldSpec.setFilter(filter->clone());
   }
   scanSpec_->resetCachedValues();
 
+  if (!rowReader_) {
+    // Between splits or the split is empty.
+    return;
+  }
   auto columnReader =
       dynamic_cast<SelectiveColumnReader*>(rowReader_->columnReader());
   assert(columnReader);
@@ -299,7 +791,30 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
 
   VLOG(1) << "Adding split " << split_->toString();
 
+  if (!testPartitionFilters(scanSpec_.get(), split_->partitionKeys)) {
+    VLOG(1) << "Skipping " << split_->filePath
+            << " based on filters on partition keys";
+    emptySplit_ = true;
+    ++skippedSplits_;
+    ++skippedPartitionSplits_;
+    skippedSplitBytes_ += split_->length;
+    return;
+  }
+
   fileHandle_ = fileHandleFactory_->generate(split_->filePath);
+  if (!fileHandle_.wasCached()) {
+    ++numFileHandleMisses_;
+  } else if (
+      split_->fileModificationTime.has_value() &&
+      fileHandle_->modificationTime != 0 &&
+      fileHandle_->modificationTime != split_->fileModificationTime.value()) {
+    // The file changed after the cached handle was opened.
+    fileHandle_ = FileHandleCachedPtr();
+    fileHandleFactory_->invalidate(split_->filePath);
+    fileHandle_ = fileHandleFactory_->generate(split_->filePath);
+    ++numFileHandleMisses_;
+    ++numStaleFileHandles_;
+  }
   // Decide between AsyncDataCache, legacy DataCache and no cache. All
   // three are supported to enable comparison.
   if (auto asyncCache = dynamic_cast<cache::AsyncDataCache*>(mappedMemory_)) {
@@ -312,20 +827,25 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
       readerOpts_.setDataCacheConfig(std::move(dataCacheConfig));
     }
     readerOpts_.getDataCacheConfig()->filenum = fileHandle_->uuid.id();
+    readerOpts_.getDataCacheConfig()->modificationTime =
+        fileHandle_->modificationTime;
     bufferedInputFactory_ = std::make_unique<dwrf::CachedBufferedInputFactory>(
         (asyncCache),
-        Connector::getTracker(scanId_),
+        Connector::getTracker(scanId_, tableName_),
         fileHandle_->groupId.id(),
         [factory = fileHandleFactory_,
          path = split_->filePath,
          stats = ioStats_]() { return makeStreamHolder(factory, path, stats); },
         ioStats_,
-        executor_);
+        executor_,
+        cacheRetention_,
+        cancellationToken_);
     readerOpts_.setBufferedInputFactory(bufferedInputFactory_.get());
   } else if (dataCache_) {
     auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
     dataCacheConfig->cache = dataCache_;
     dataCacheConfig->filenum = fileHandle_->uuid.id();
+    dataCacheConfig->modificationTime = fileHandle_->modificationTime;
     readerOpts_.setDataCacheConfig(std::move(dataCacheConfig));
   }
   // We run with the default BufferedInputFactory and no DataCacheConfig if
@@ -405,7 +925,11 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
   std::vector<std::string> columnNames;
   for (auto& spec : scanSpec_->children()) {
     if (!spec->isConstant()) {
-      columnNames.push_back(spec->fieldName());
+      addSelectedColumns(
+          *spec,
+          spec->fieldName(),
+          fileType->findChild(spec->fieldName()),
+          columnNames);
     }
   }
 
@@ -419,6 +943,40 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
 
   rowReader_ = reader_->createRowReader(
       rowReaderOpts_.select(cs).range(split_->start, split_->length));
+  // Starts the IO for the first stripe. When the split is prepared in
+  // the background, this overlaps with processing the previous split.
+  rowReader_->loadFirstStripe();
+}
+
+void HiveDataSource::setFromDataSource(std::shared_ptr<DataSource> source) {
+  auto* other = dynamic_cast<HiveDataSource*>(source.get());
+  VELOX_CHECK(other, "Wrong type of DataSource");
+  VELOX_CHECK(
+      split_ == nullptr,
+      "Previous split has not been processed yet. Call next to process the split.");
+  split_ = std::move(other->split_);
+  emptySplit_ = other->emptySplit_;
+  // The readers of 'other' refer to its ScanSpec and reader
+  // factories. These are used for the following splits as well.
+  scanSpec_ = std::move(other->scanSpec_);
+  // The readers of 'other' refer to 'scanSpec_'.
+  scanSpec_->setRowFilter(scanRowFilter_.get());
+  columnReaderFactory_ = std::move(other->columnReaderFactory_);
+  rowReaderOpts_.setColumnReaderFactory(columnReaderFactory_.get());
+  bufferedInputFactory_ = std::move(other->bufferedInputFactory_);
+  fileHandle_ = std::move(other->fileHandle_);
+  reader_ = std::move(other->reader_);
+  rowReader_ = std::move(other->rowReader_);
+  // 'reader_' refers to the reader options of 'other'.
+  preparedSource_ = std::move(source);
+  skippedSplits_ += other->skippedSplits_;
+  skippedPartitionSplits_ += other->skippedPartitionSplits_;
+  skippedSplitBytes_ += other->skippedSplitBytes_;
+  numFileHandleMisses_ += other->numFileHandleMisses_;
+  numStaleFileHandles_ += other->numStaleFileHandles_;
+  // The reads of the file of 'other' are counted in its IoStatistics.
+  other->ioStats_->merge(*ioStats_);
+  ioStats_ = std::move(other->ioStats_);
 }
 
 RowVectorPtr HiveDataSource::next(uint64_t size) {
@@ -427,6 +985,7 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
     split_.reset();
     reader_.reset();
     rowReader_.reset();
+    preparedSource_.reset();
     return nullptr;
   }
 
@@ -438,6 +997,9 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
   // column, e.g. rand() < 0.1. Evaluate that conjunct first, then scan only
   // rows that passed.
 
+  if (scanRowFilter_) {
+    scanRowFilter_->clearApplied();
+  }
   auto rowsScanned = rowReader_->next(size, output_);
   completedRows_ += rowsScanned;
 
@@ -453,7 +1015,7 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
     auto rowVector = std::dynamic_pointer_cast<RowVector>(output_);
 
     BufferPtr remainingIndices;
-    if (remainingFilterExprSet_) {
+    if (remainingFilterExprSet_ && !scanRowFilter_->applied()) {
       rowsRemaining = evaluateRemainingFilter(rowVector);
       VELOX_CHECK_LE(rowsRemaining, rowsScanned);
       if (rowsRemaining == 0) {
@@ -486,11 +1048,45 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
   split_.reset();
   reader_.reset();
   rowReader_.reset();
+  preparedSource_.reset();
   return nullptr;
 }
 
+HiveDataSource::ScanRowFilter::ScanRowFilter(HiveDataSource* source)
+    : source_(source), isInput_(source->readerOutputType_->size()) {
+  auto& type = source_->readerOutputType_;
+  auto& filter = source_->remainingFilterExprSet_->expr(0);
+  for (auto& input : filter->distinctFields()) {
+    isInput_[type->getChildIdx(input->field())] = true;
+  }
+}
+
+vector_size_t HiveDataSource::ScanRowFilter::filter(
+    const std::vector<VectorPtr>& inputs,
+    vector_size_t size,
+    BufferPtr& indices) {
+  auto& type = source_->readerOutputType_;
+  std::vector<VectorPtr> children(type->size());
+  for (auto i = 0; i < type->size(); ++i) {
+    if (i < inputs.size() && inputs[i]) {
+      children[i] = inputs[i];
+    } else {
+      children[i] = BaseVector::createNullConstant(
+          type->childAt(i), size, source_->pool_);
+    }
+  }
+  auto rowVector = std::make_shared<RowVector>(
+      source_->pool_, type, BufferPtr(nullptr), size, std::move(children));
+  auto numPassed = source_->evaluateRemainingFilter(rowVector);
+  if (numPassed > 0 && numPassed < size) {
+    indices = source_->filterEvalCtx_.selectedIndices;
+  }
+  applied_ = true;
+  return numPassed;
+}
+
 vector_size_t HiveDataSource::evaluateRemainingFilter(RowVectorPtr& rowVector) {
-  filterRows_.resize(output_->size());
+  filterRows_.resize(rowVector->size());
 
   expressionEvaluator_->evaluate(
       remainingFilterExprSet_.get(), filterRows_, rowVector, &filterResult_);
@@ -513,8 +1109,11 @@ void HiveDataSource::setNullConstantValue(
 std::unordered_map<std::string, int64_t> HiveDataSource::runtimeStats() {
   return {
       {"skippedSplits", skippedSplits_},
+      {"skippedPartitionSplits", skippedPartitionSplits_},
       {"skippedSplitBytes", skippedSplitBytes_},
       {"skippedStrides", skippedStrides_},
+      {"fileHandleCacheMisses", numFileHandleMisses_},
+      {"staleFileHandles", numStaleFileHandles_},
       {"numPrefetch", ioStats_->prefetch().count()},
       {"prefetchBytes", ioStats_->prefetch().bytes()},
       {"numStorageRead", ioStats_->read().count()},
@@ -534,9 +1133,25 @@ HiveConnector::HiveConnector(
       dataCache_(std::move(dataCache)),
       fileHandleFactory_(
           std::make_unique<SimpleLRUCache<std::string, FileHandle>>(
-              FLAGS_file_handle_cache_mb << 20),
+              FLAGS_file_handle_cache_mb << 20,
+              FLAGS_file_handle_expiration_ms),
           std::make_unique<FileHandleGenerator>()),
       executor_(executor) {}
 
+// static
+cache::CacheRetention HiveConnector::cacheRetention(const Config* config) {
+  auto retention =
+      config->get<std::string>(kCacheRetention, kCacheRetentionNormal);
+  if (retention == kCacheRetentionNoRetain) {
+    return cache::CacheRetention::kNoRetain;
+  }
+  if (retention == kCacheRetentionPin) {
+    return cache::CacheRetention::kPin;
+  }
+  VELOX_USER_CHECK_EQ(
+      retention, kCacheRetentionNormal, "Bad value of {}", kCacheRetention);
+  return cache::CacheRetention::kNormal;
+}
+
 VELOX_REGISTER_CONNECTOR_FACTORY(std::make_shared<HiveConnectorFactory>())
 } // namespace facebook::velox::connector::hive
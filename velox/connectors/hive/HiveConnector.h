@@ -33,8 +33,18 @@ class HiveColumnHandle : public ColumnHandle {
  public:
   enum class ColumnType { kPartitionKey, kRegular, kSynthesized };
 
-  HiveColumnHandle(const std::string& name, ColumnType columnType)
-      : name_(name), columnType_(columnType) {}
+  // 'requiredSubfields' are the parts of a complex column that are
+  // used: subscripts of a map or array, e.g. m['k'] or a[2], and fields
+  // of a struct, e.g. s.f.g. If set, the other map entries and array
+  // elements are not read, and the other struct fields are neither read
+  // nor decoded and are returned as nulls.
+  HiveColumnHandle(
+      const std::string& name,
+      ColumnType columnType,
+      std::vector<common::Subfield> requiredSubfields = {})
+      : name_(name),
+        columnType_(columnType),
+        requiredSubfields_(std::move(requiredSubfields)) {}
 
   const std::string& name() const {
     return name_;
@@ -44,9 +54,27 @@ class HiveColumnHandle : public ColumnHandle {
     return columnType_;
   }
 
+  const std::vector<common::Subfield>& requiredSubfields() const {
+    return requiredSubfields_;
+  }
+
+  std::string toString() const override {
+    std::string result = name_;
+    if (columnType_ == ColumnType::kPartitionKey) {
+      result += " partition key";
+    } else if (columnType_ == ColumnType::kSynthesized) {
+      result += " synthesized";
+    }
+    for (const auto& subfield : requiredSubfields_) {
+      result += " " + subfield.toString();
+    }
+    return result;
+  }
+
  private:
   const std::string name_;
   const ColumnType columnType_;
+  const std::vector<common::Subfield> requiredSubfields_;
 };
 
 using SubfieldFilters =
@@ -57,10 +85,12 @@ class HiveTableHandle : public ConnectorTableHandle {
   HiveTableHandle(
       bool filterPushdownEnabled,
       SubfieldFilters subfieldFilters,
-      const std::shared_ptr<const core::ITypedExpr>& remainingFilter)
+      const std::shared_ptr<const core::ITypedExpr>& remainingFilter,
+      const std::string& tableName = "")
       : filterPushdownEnabled_(filterPushdownEnabled),
         subfieldFilters_(std::move(subfieldFilters)),
-        remainingFilter_(remainingFilter) {}
+        remainingFilter_(remainingFilter),
+        tableName_(tableName) {}
 
   bool isFilterPushdownEnabled() const {
     return filterPushdownEnabled_;
@@ -74,10 +104,19 @@ class HiveTableHandle : public ConnectorTableHandle {
     return remainingFilter_;
   }
 
+  // Name of the table. Keys the column access history that informs
+  // prefetch and caching. The history is not kept if empty.
+  const std::string& tableName() const {
+    return tableName_;
+  }
+
+  std::string toString() const override;
+
  private:
   const bool filterPushdownEnabled_;
   const SubfieldFilters subfieldFilters_;
   const std::shared_ptr<const core::ITypedExpr> remainingFilter_;
+  const std::string tableName_;
 };
 
 /**
@@ -85,33 +124,144 @@ class HiveTableHandle : public ConnectorTableHandle {
  */
 class HiveInsertTableHandle : public ConnectorInsertTableHandle {
  public:
+  // Writes all rows to one file at 'filePath'.
   explicit HiveInsertTableHandle(const std::string& filePath)
       : filePath_(filePath) {}
 
+  // Writes a partitioned and/or bucketed table under the directory
+  // 'filePath'. Rows go to '<filePath>/<p1>=<v1>/.../<pn>=<vn>/' by the
+  // values of their 'partitionedBy' columns, which are not stored in the
+  // files. If 'bucketCount' is positive, the rows of a partition are further
+  // split into files by the Hive hash of their 'bucketedBy' columns. File
+  // names start with the zero-padded bucket number.
+  HiveInsertTableHandle(
+      const std::string& filePath,
+      std::vector<std::string> partitionedBy,
+      int32_t bucketCount = 0,
+      std::vector<std::string> bucketedBy = {})
+      : filePath_(filePath),
+        partitionedBy_(std::move(partitionedBy)),
+        bucketCount_(bucketCount),
+        bucketedBy_(std::move(bucketedBy)) {
+    VELOX_USER_CHECK_EQ(
+        bucketCount_ > 0,
+        !bucketedBy_.empty(),
+        "Bucketed writes need both a bucket count and bucketing columns");
+  }
+
+  virtual ~HiveInsertTableHandle() {}
+
   const std::string& filePath() const {
     return filePath_;
   }
 
-  virtual ~HiveInsertTableHandle() {}
+  const std::vector<std::string>& partitionedBy() const {
+    return partitionedBy_;
+  }
+
+  int32_t bucketCount() const {
+    return bucketCount_;
+  }
+
+  const std::vector<std::string>& bucketedBy() const {
+    return bucketedBy_;
+  }
+
+  bool isPartitioned() const {
+    return !partitionedBy_.empty() || bucketCount_ > 0;
+  }
+
+  // Each TableWriter Driver of a partitioned write has its own files.
+  bool supportsMultiThreading() const override {
+    return isPartitioned();
+  }
 
  private:
   const std::string filePath_;
+  const std::vector<std::string> partitionedBy_;
+  const int32_t bucketCount_{0};
+  const std::vector<std::string> bucketedBy_;
 };
 
+class HivePartitionFunction;
+
 class HiveDataSink : public DataSink {
  public:
-  explicit HiveDataSink(
+  static constexpr int32_t kDefaultMaxOpenWriters = 100;
+
+  // Writes to one file or, if 'insertTableHandle' is partitioned, to a file
+  // per partition and bucket. At most 'maxOpenWriters' files are open at a
+  // time. When a row goes to a new file and the limit is reached, the least
+  // recently written file is closed. Rows that arrive for its partition
+  // later go to a new file.
+  HiveDataSink(
       std::shared_ptr<const RowType> inputType,
-      const std::string& filePath,
-      velox::memory::MemoryPool* FOLLY_NONNULL memoryPool);
+      std::shared_ptr<const HiveInsertTableHandle> insertTableHandle,
+      velox::memory::MemoryPool* FOLLY_NONNULL memoryPool,
+      int32_t maxOpenWriters = kDefaultMaxOpenWriters,
+      folly::Executor* FOLLY_NULLABLE writeExecutor = nullptr);
+
+  ~HiveDataSink() override;
 
   void appendData(VectorPtr input) override;
 
+  bool isBlocked(folly::SemiFuture<folly::Unit>* future) override;
+
   void close() override;
 
+  // Closes the least recently written files until their writers have
+  // given back 'bytes' of memory or no file is open.
+  uint64_t reclaim(uint64_t bytes) override;
+
  private:
+  struct PartitionWriter {
+    std::unique_ptr<facebook::velox::dwrf::Writer> writer;
+    // Value of 'numWrites_' at the last write to 'writer'.
+    uint64_t lastWrite;
+  };
+
+  std::unique_ptr<facebook::velox::dwrf::Writer> createWriter(
+      const std::string& path);
+
+  // Returns the writer for the file that the rows of 'partition' go to.
+  // 'partition' is the partition directory relative to the table
+  // directory, followed by the bucket number if bucketed.
+  facebook::velox::dwrf::Writer& writerFor(const std::string& partition);
+
+  // Returns the partition of each row of 'input' in 'partitions_'.
+  void computePartitions(const RowVector& input);
+
+  void closeLeastRecentlyWritten();
+
   const std::shared_ptr<const RowType> inputType_;
+  const std::shared_ptr<const HiveInsertTableHandle> insertTableHandle_;
+  velox::memory::MemoryPool* FOLLY_NONNULL const pool_;
+  const int32_t maxOpenWriters_;
+  // If set, the writers write their stripes on this executor.
+  folly::Executor* FOLLY_NULLABLE const writeExecutor_;
+
+  // Writer of a table that is not partitioned.
   std::unique_ptr<facebook::velox::dwrf::Writer> writer_;
+
+  // Channels of 'inputType_' that are stored in the files, their type and
+  // the channels of the partitioning columns.
+  std::vector<ChannelIndex> dataChannels_;
+  std::shared_ptr<const RowType> dataType_;
+  std::vector<ChannelIndex> partitionChannels_;
+  std::unique_ptr<HivePartitionFunction> bucketFunction_;
+
+  // Open files by partition.
+  std::unordered_map<std::string, PartitionWriter> writers_;
+  // Distinguishes the files of 'this' from those of other sinks writing the
+  // same partitions.
+  const std::string fileNamePrefix_;
+  // Number of files created by 'this'.
+  int64_t numFiles_{0};
+  uint64_t numWrites_{0};
+
+  // Reusable memory.
+  std::vector<uint32_t> buckets_;
+  std::vector<std::string> partitions_;
 };
 
 class HiveConnector;
@@ -130,7 +280,10 @@ class HiveDataSource : public DataSource {
       ExpressionEvaluator* FOLLY_NONNULL expressionEvaluator,
       memory::MappedMemory* FOLLY_NONNULL mappedMemory,
       const std::string& scanId,
-      folly::Executor* FOLLY_NULLABLE executor);
+      folly::Executor* FOLLY_NULLABLE executor,
+      cache::CacheRetention cacheRetention = cache::CacheRetention::kNormal,
+      folly::Executor* FOLLY_NULLABLE decodingExecutor = nullptr,
+      folly::CancellationToken cancellationToken = {});
 
   void addSplit(std::shared_ptr<ConnectorSplit> split) override;
 
@@ -150,7 +303,44 @@ class HiveDataSource : public DataSource {
 
   std::unordered_map<std::string, int64_t> runtimeStats() override;
 
+  void setFromDataSource(std::shared_ptr<DataSource> source) override;
+
  private:
+  // Evaluates the remaining filter inside the scan. The struct reader calls
+  // this on the columns the filter reads after the pushed down filters and
+  // before reading the other columns, so that these are read only for the
+  // rows that pass.
+  class ScanRowFilter : public common::RowFilter {
+   public:
+    explicit ScanRowFilter(HiveDataSource* FOLLY_NONNULL source);
+
+    bool isInput(ChannelIndex channel) const override {
+      return channel < isInput_.size() && isInput_[channel];
+    }
+
+    vector_size_t filter(
+        const std::vector<VectorPtr>& inputs,
+        vector_size_t size,
+        BufferPtr& indices) override;
+
+    // True if filter() was called since the last clearApplied(). False
+    // if the scan did not evaluate the filter, e.g. because no rows
+    // passed the pushed down filters or there are no columns to read.
+    bool applied() const {
+      return applied_;
+    }
+
+    void clearApplied() {
+      applied_ = false;
+    }
+
+   private:
+    HiveDataSource* const FOLLY_NONNULL source_;
+    // True for the channels of 'readerOutputType_' the filter reads.
+    std::vector<bool> isInput_;
+    bool applied_{false};
+  };
+
   // Evaluates remainingFilter_ on the specified vector. Returns number of rows
   // passed. Populates filterEvalCtx_.selectedIndices and selectedBits if only
   // some rows passed the filter. If no or all rows passed
@@ -179,18 +369,30 @@ class HiveDataSource : public DataSource {
   std::unique_ptr<dwrf::DwrfReader> reader_;
   std::unique_ptr<dwrf::DwrfRowReader> rowReader_;
   std::unique_ptr<exec::ExprSet> remainingFilterExprSet_;
+  // Set on 'scanSpec_' if there is a remaining filter.
+  std::unique_ptr<ScanRowFilter> scanRowFilter_;
   std::shared_ptr<const RowType> readerOutputType_;
   bool emptySplit_;
 
-  // Number of splits skipped based on statistics.
+  // Number of splits skipped based on statistics or partition keys.
   int64_t skippedSplits_{0};
 
-  // Total bytes in splits skipped based on statistics.
+  // Number of splits skipped based on partition keys without opening the
+  // file.
+  int64_t skippedPartitionSplits_{0};
+
+  // Total bytes in splits skipped based on statistics or partition keys.
   int64_t skippedSplitBytes_{0};
 
   // Number of strides (row groups) skipped based on statistics.
   int64_t skippedStrides_{0};
 
+  // Number of splits whose file handle was not in the cache.
+  int64_t numFileHandleMisses_{0};
+
+  // Number of cached file handles reopened because the file changed.
+  int64_t numStaleFileHandles_{0};
+
   VectorPtr output_;
   FileHandleCachedPtr fileHandle_;
   DataCache* FOLLY_NULLABLE dataCache_;
@@ -204,7 +406,15 @@ class HiveDataSource : public DataSource {
 
   memory::MappedMemory* const FOLLY_NONNULL mappedMemory_;
   const std::string& scanId_;
+  std::string tableName_;
   folly::Executor* FOLLY_NULLABLE executor_;
+  const cache::CacheRetention cacheRetention_;
+  // Cancelled when the query is terminated. Passed to the prefetches of
+  // the splits.
+  const folly::CancellationToken cancellationToken_;
+  // DataSource whose split and reader were taken over by
+  // setFromDataSource(). Kept until the end of the split.
+  std::shared_ptr<DataSource> preparedSource_;
 };
 
 class HiveConnector final : public Connector {
@@ -236,7 +446,12 @@ class HiveConnector final : public Connector {
         connectorQueryCtx->expressionEvaluator(),
         connectorQueryCtx->mappedMemory(),
         connectorQueryCtx->scanId(),
-        executor_);
+        executor_,
+        cacheRetention(connectorQueryCtx->config()),
+        connectorQueryCtx->config()->get<bool>(kParallelDecoding, false)
+            ? executor_
+            : nullptr,
+        connectorQueryCtx->cancellationToken());
   }
 
   std::shared_ptr<DataSink> createDataSink(
@@ -250,15 +465,33 @@ class HiveConnector final : public Connector {
         "Hive connector expecting hive write handle!");
     return std::make_shared<HiveDataSink>(
         inputType,
-        hiveInsertHandle->filePath(),
-        connectorQueryCtx->memoryPool());
+        hiveInsertHandle,
+        connectorQueryCtx->memoryPool(),
+        connectorQueryCtx->config()->get<int32_t>(
+            kMaxOpenWriters, HiveDataSink::kDefaultMaxOpenWriters),
+        connectorQueryCtx->config()->get<bool>(kAsyncWrites, false)
+            ? executor_
+            : nullptr);
   }
 
-  folly::Executor* FOLLY_NULLABLE executor() {
+  bool supportsSplitPreload() const override {
+    return true;
+  }
+
+  folly::Executor* FOLLY_NULLABLE executor() const override {
     return executor_;
   }
 
+  // Counters of the file handle cache shared by the queries of 'this'.
+  CachedFactoryStats fileHandleCacheStats() {
+    return fileHandleFactory_.stats();
+  }
+
  private:
+  // Returns the retention hint for cache entries loaded by a query
+  // with 'config'.
+  static cache::CacheRetention cacheRetention(const Config* config);
+
   std::unique_ptr<DataCache> dataCache_;
   FileHandleFactory fileHandleFactory_;
   folly::Executor* FOLLY_NULLABLE executor_;
@@ -269,6 +502,28 @@ class HiveConnector final : public Connector {
       kNodeSelectionStrategyNoPreference = "NO_PREFERENCE";
   static constexpr const char* FOLLY_NONNULL
       kNodeSelectionStrategySoftAffinity = "SOFT_AFFINITY";
+  // Controls how long the data a query reads stays in AsyncDataCache.
+  // NO_RETAIN is for one-off scans that should not displace the
+  // working set. PIN is for hot data, e.g. dimension tables.
+  static constexpr const char* FOLLY_NONNULL kCacheRetention =
+      "cache_retention";
+  static constexpr const char* FOLLY_NONNULL kCacheRetentionNormal = "NORMAL";
+  static constexpr const char* FOLLY_NONNULL kCacheRetentionNoRetain =
+      "NO_RETAIN";
+  static constexpr const char* FOLLY_NONNULL kCacheRetentionPin = "PIN";
+  // If true, the columns without filters are decoded in parallel on
+  // the connector's executor after the filters have selected the rows.
+  // Cuts the latency of wide scans with few splits.
+  static constexpr const char* FOLLY_NONNULL kParallelDecoding =
+      "parallel_decoding";
+  // Maximum number of files a partitioned TableWriter Driver has open at
+  // a time.
+  static constexpr const char* FOLLY_NONNULL kMaxOpenWriters =
+      "max_open_writers";
+  // If true, the files are written on the connector's executor while the
+  // next stripes are encoded. TableWriter blocks when too many written
+  // bytes are in flight.
+  static constexpr const char* FOLLY_NONNULL kAsyncWrites = "async_writes";
 };
 
 class HiveConnectorFactory : public ConnectorFactory {
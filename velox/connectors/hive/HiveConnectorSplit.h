@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <map>
 #include <optional>
 #include <unordered_map>
 #include "velox/connectors/Connector.h"
@@ -32,6 +33,11 @@ struct HiveConnectorSplit : public connector::ConnectorSplit {
   const std::unordered_map<std::string, std::optional<std::string>>
       partitionKeys;
   std::optional<int32_t> tableBucketNumber;
+  // Modification time of 'filePath' in nanoseconds since the epoch, as
+  // given by ReadFile::modificationTime(). Results for the split are
+  // cacheable only if this is set. A cached file handle with a
+  // different time is reopened.
+  std::optional<int64_t> fileModificationTime;
 
   HiveConnectorSplit(
       const std::string& connectorId,
@@ -61,6 +67,29 @@ struct HiveConnectorSplit : public connector::ConnectorSplit {
     }
     return fmt::format("[file {} {} - {}]", filePath, start, length);
   }
+
+  std::string cacheKey() const override {
+    if (!fileModificationTime.has_value()) {
+      return "";
+    }
+    auto key = fmt::format(
+        "{}:{}:{}:{}",
+        filePath,
+        start,
+        length,
+        fileModificationTime.value());
+    if (tableBucketNumber.has_value()) {
+      key += fmt::format(":b{}", tableBucketNumber.value());
+    }
+    // Partition keys become constant columns, so the same file under
+    // different partition values gives different results.
+    std::map<std::string, std::optional<std::string>> sortedKeys(
+        partitionKeys.begin(), partitionKeys.end());
+    for (const auto& [name, value] : sortedKeys) {
+      key += fmt::format(":{}={}", name, value.value_or("\\N"));
+    }
+    return key;
+  }
 };
 
 } // namespace facebook::velox::connector::hive
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/connectors/hive/storage_adapters/s3fs/S3FileSystem.h"
+
+#include <aws/core/Aws.h>
+#include <aws/core/auth/AWSCredentialsProviderChain.h>
+#include <aws/core/client/DefaultRetryStrategy.h>
+#include <aws/core/utils/threading/Executor.h>
+#include <aws/s3/S3Client.h>
+#include <aws/s3/model/GetObjectRequest.h>
+#include <aws/s3/model/HeadObjectRequest.h>
+#include <folly/synchronization/CallOnce.h>
+
+#include "velox/common/file/File.h"
+#include "velox/common/time/Timer.h"
+#include "velox/connectors/hive/storage_adapters/s3fs/S3Util.h"
+#include "velox/core/Context.h"
+#include "velox/dwio/common/IoStatistics.h"
+
+namespace facebook::velox::filesystems {
+namespace {
+
+constexpr const char* kAllocationTag = "velox-s3";
+constexpr std::string_view kGetObject{"S3.GetObject"};
+
+// Reads of more than this are split into parallel GETs.
+constexpr uint64_t kMaxGetSize = 8 << 20;
+// Skipped ranges of up to this many bytes are read and dropped rather than
+// ending a GET.
+constexpr uint64_t kMaxCoalescedSkip = 512 << 10;
+
+template <typename T>
+T configValue(const Config* config, const char* key, T defaultValue) {
+  return config ? config->get<T>(key, defaultValue) : defaultValue;
+}
+
+Aws::String awsString(std::string_view s) {
+  return Aws::String(s.data(), s.size());
+}
+
+std::string errorMessage(const Aws::Client::AWSError<Aws::S3::S3Errors>& e) {
+  return fmt::format(
+      "{}: {}", std::string(e.GetExceptionName()), std::string(e.GetMessage()));
+}
+
+void initializeAwsApi() {
+  static folly::once_flag awsInitFlag;
+  folly::call_once(awsInitFlag, []() {
+    Aws::SDKOptions options;
+    Aws::InitAPI(options);
+  });
+}
+
+// Writes the body of a ranged GET into the ranges of an S3RangeGet.
+class ScatterStreamBuf : public std::streambuf {
+ public:
+  explicit ScatterStreamBuf(const std::vector<folly::Range<char*>>& ranges)
+      : ranges_(ranges) {}
+
+ protected:
+  std::streamsize xsputn(const char* data, std::streamsize size) override {
+    std::streamsize written = 0;
+    while (written < size && index_ < ranges_.size()) {
+      auto& range = ranges_[index_];
+      auto bytes =
+          std::min<uint64_t>(size - written, range.size() - rangeOffset_);
+      if (range.data()) {
+        memcpy(range.data() + rangeOffset_, data + written, bytes);
+      }
+      written += bytes;
+      rangeOffset_ += bytes;
+      if (rangeOffset_ == range.size()) {
+        ++index_;
+        rangeOffset_ = 0;
+      }
+    }
+    return written;
+  }
+
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+  }
+
+ private:
+  const std::vector<folly::Range<char*>> ranges_;
+  size_t index_{0};
+  uint64_t rangeOffset_{0};
+};
+
+// A GET in flight. Owns everything its completion handler touches so that
+// it may outlive the S3ReadFile that started it.
+struct GetState {
+  std::shared_ptr<Aws::S3::S3Client> client;
+  std::shared_ptr<dwio::common::IoStatistics> ioStats;
+  std::string bucket;
+  std::string key;
+  int32_t maxAttempts;
+  S3RangeGet get;
+  folly::Promise<folly::Unit> promise;
+  int32_t numRetries{0};
+  size_t startMs{0};
+  // A cancelled GET is not started or retried.
+  folly::CancellationToken cancellationToken;
+};
+
+void startAttempt(std::shared_ptr<GetState> state) {
+  if (state->cancellationToken.isCancellationRequested()) {
+    state->promise.setException(folly::OperationCancelled());
+    return;
+  }
+  Aws::S3::Model::GetObjectRequest request;
+  request.SetBucket(awsString(state->bucket));
+  request.SetKey(awsString(state->key));
+  request.SetRange(awsString(fmt::format(
+      "bytes={}-{}",
+      state->get.offset,
+      state->get.offset + state->get.size - 1)));
+  auto streamBuf = std::make_shared<ScatterStreamBuf>(state->get.ranges);
+  request.SetResponseStreamFactory([streamBuf]() {
+    return Aws::New<Aws::IOStream>(kAllocationTag, streamBuf.get());
+  });
+  state->client->GetObjectAsync(
+      request,
+      [state, streamBuf](
+          const Aws::S3::S3Client* /*client*/,
+          const Aws::S3::Model::GetObjectRequest& /*request*/,
+          Aws::S3::Model::GetObjectOutcome outcome,
+          const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+          /*context*/) {
+        if (!outcome.IsSuccess() && outcome.GetError().ShouldRetry() &&
+            state->numRetries + 1 < state->maxAttempts) {
+          ++state->numRetries;
+          startAttempt(state);
+          return;
+        }
+        state->ioStats->incOperationCounters(
+            std::string(kGetObject),
+            0,
+            0,
+            0,
+            state->numRetries,
+            getCurrentTimeMs() - state->startMs,
+            0);
+        if (outcome.IsSuccess()) {
+          state->ioStats->incRawBytesRead(state->get.size);
+          state->promise.setValue();
+        } else {
+          state->promise.setException(std::runtime_error(fmt::format(
+              "Failed to read s3://{}/{} at {}: {}",
+              state->bucket,
+              state->key,
+              state->get.offset,
+              errorMessage(outcome.GetError()))));
+        }
+      });
+}
+
+class S3ReadFile final : public ReadFile {
+ public:
+  S3ReadFile(
+      std::string_view path,
+      std::shared_ptr<Aws::S3::S3Client> client,
+      std::shared_ptr<dwio::common::IoStatistics> ioStats,
+      int32_t maxAttempts)
+      : client_(std::move(client)),
+        ioStats_(std::move(ioStats)),
+        maxAttempts_(maxAttempts) {
+    bucketAndKeyFromS3Path(path, bucket_, key_);
+    Aws::S3::Model::HeadObjectRequest request;
+    request.SetBucket(awsString(bucket_));
+    request.SetKey(awsString(key_));
+    auto outcome = client_->HeadObject(request);
+    VELOX_CHECK(
+        outcome.IsSuccess(),
+        "Failed to open {}: {}",
+        path,
+        errorMessage(outcome.GetError()));
+    size_ = outcome.GetResult().GetContentLength();
+    modificationTime_ =
+        outcome.GetResult().GetLastModified().Millis() * 1'000'000L;
+  }
+
+  std::string_view pread(uint64_t offset, uint64_t length, Arena* arena)
+      const final {
+    char* pos = arena->reserve(length);
+    return pread(offset, length, pos);
+  }
+
+  std::string_view pread(uint64_t offset, uint64_t length, void* buf)
+      const final {
+    auto* pos = static_cast<char*>(buf);
+    read(offset, {folly::Range<char*>(pos, length)}).get();
+    return {pos, length};
+  }
+
+  std::string pread(uint64_t offset, uint64_t length) const final {
+    std::string result(length, 0);
+    pread(offset, length, result.data());
+    return result;
+  }
+
+  uint64_t preadv(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers) final {
+    return read(offset, buffers).get();
+  }
+
+  folly::SemiFuture<uint64_t> preadvAsync(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers,
+      const folly::CancellationToken& cancellationToken = {}) final {
+    return read(offset, buffers, cancellationToken);
+  }
+
+  bool hasPreadvAsync() const final {
+    return true;
+  }
+
+  bool shouldCoalesce() const final {
+    return true;
+  }
+
+  uint64_t size() const final {
+    return size_;
+  }
+
+  uint64_t memoryUsage() const final {
+    return sizeof(*this) + bucket_.size() + key_.size();
+  }
+
+  int64_t modificationTime() const final {
+    return modificationTime_;
+  }
+
+ private:
+  // Starts the GETs for reading 'buffers' and returns a future that is
+  // fulfilled with the total size of 'buffers' after all GETs have
+  // completed.
+  folly::SemiFuture<uint64_t> read(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers,
+      const folly::CancellationToken& cancellationToken = {}) const {
+    uint64_t totalSize = 0;
+    for (auto& range : buffers) {
+      totalSize += range.size();
+    }
+    VELOX_CHECK_LE(offset + totalSize, size_, "Read past end of s3 object");
+    bytesRead_ += totalSize;
+    std::vector<folly::SemiFuture<folly::Unit>> futures;
+    for (auto& get :
+         planRangeGets(offset, buffers, kMaxGetSize, kMaxCoalescedSkip)) {
+      auto state = std::make_shared<GetState>();
+      state->client = client_;
+      state->ioStats = ioStats_;
+      state->bucket = bucket_;
+      state->key = key_;
+      state->maxAttempts = maxAttempts_;
+      state->get = std::move(get);
+      state->startMs = getCurrentTimeMs();
+      state->cancellationToken = cancellationToken;
+      futures.push_back(state->promise.getSemiFuture());
+      startAttempt(std::move(state));
+    }
+    // Waits for all GETs even if some fail so that none writes into
+    // 'buffers' after the caller sees the error.
+    return folly::collectAll(std::move(futures))
+        .deferValue([totalSize](std::vector<folly::Try<folly::Unit>>&& tries) {
+          for (auto& t : tries) {
+            t.throwIfFailed();
+          }
+          return totalSize;
+        });
+  }
+
+  const std::shared_ptr<Aws::S3::S3Client> client_;
+  const std::shared_ptr<dwio::common::IoStatistics> ioStats_;
+  const int32_t maxAttempts_;
+  std::string bucket_;
+  std::string key_;
+  uint64_t size_;
+  int64_t modificationTime_;
+};
+
+} // namespace
+
+class S3FileSystem::Impl {
+ public:
+  explicit Impl(const Config* config)
+      : ioStats_(std::make_shared<dwio::common::IoStatistics>()) {
+    initializeAwsApi();
+    const auto maxConnections =
+        configValue<int32_t>(config, "hive.s3.max-connections", 64);
+    maxAttempts_ = configValue<int32_t>(config, "hive.s3.max-attempts", 3);
+    VELOX_USER_CHECK_GT(maxAttempts_, 0);
+
+    Aws::Client::ClientConfiguration clientConfig;
+    clientConfig.endpointOverride = awsString(
+        configValue<std::string>(config, "hive.s3.endpoint", std::string()));
+    clientConfig.scheme =
+        configValue<bool>(config, "hive.s3.ssl.enabled", true)
+        ? Aws::Http::Scheme::HTTPS
+        : Aws::Http::Scheme::HTTP;
+    clientConfig.maxConnections = maxConnections;
+    // Retries are made by S3ReadFile so that they can be counted.
+    clientConfig.retryStrategy =
+        std::make_shared<Aws::Client::DefaultRetryStrategy>(0);
+    clientConfig.executor =
+        std::make_shared<Aws::Utils::Threading::PooledThreadExecutor>(
+            maxConnections);
+
+    const auto useVirtualAddressing =
+        !configValue<bool>(config, "hive.s3.path-style-access", false);
+    const auto accessKey = configValue<std::string>(
+        config, "hive.s3.aws-access-key", std::string());
+    const auto secretKey = configValue<std::string>(
+        config, "hive.s3.aws-secret-key", std::string());
+    std::shared_ptr<Aws::Auth::AWSCredentialsProvider> credentials;
+    if (!accessKey.empty() && !secretKey.empty()) {
+      credentials = std::make_shared<Aws::Auth::SimpleAWSCredentialsProvider>(
+          awsString(accessKey), awsString(secretKey));
+    } else {
+      credentials =
+          std::make_shared<Aws::Auth::DefaultAWSCredentialsProviderChain>();
+    }
+    client_ = std::make_shared<Aws::S3::S3Client>(
+        credentials,
+        clientConfig,
+        Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
+        useVirtualAddressing);
+  }
+
+  std::unique_ptr<ReadFile> openFileForRead(std::string_view path) {
+    return std::make_unique<S3ReadFile>(path, client_, ioStats_, maxAttempts_);
+  }
+
+  const std::shared_ptr<dwio::common::IoStatistics>& ioStats() const {
+    return ioStats_;
+  }
+
+ private:
+  std::shared_ptr<Aws::S3::S3Client> client_;
+  const std::shared_ptr<dwio::common::IoStatistics> ioStats_;
+  int32_t maxAttempts_;
+};
+
+S3FileSystem::S3FileSystem(std::shared_ptr<const Config> config)
+    : FileSystem(config), impl_(std::make_shared<Impl>(config_.get())) {}
+
+S3FileSystem::~S3FileSystem() = default;
+
+std::string S3FileSystem::name() const {
+  return "S3";
+}
+
+std::unique_ptr<ReadFile> S3FileSystem::openFileForRead(
+    std::string_view path) {
+  return impl_->openFileForRead(path);
+}
+
+std::unique_ptr<WriteFile> S3FileSystem::openFileForWrite(
+    std::string_view /*path*/) {
+  VELOX_NYI("Writing to S3 is not supported");
+}
+
+const std::shared_ptr<dwio::common::IoStatistics>& S3FileSystem::ioStats()
+    const {
+  return impl_->ioStats();
+}
+
+namespace {
+folly::once_flag s3FSRegistrationFlag;
+} // namespace
+
+void registerS3FileSystem() {
+  registerFileSystem(
+      isS3File, [](std::shared_ptr<const Config> properties) {
+        // One S3FileSystem and connection pool is shared by all S3 paths.
+        static std::shared_ptr<FileSystem> s3fs;
+        folly::call_once(s3FSRegistrationFlag, [&properties]() {
+          s3fs = std::make_shared<S3FileSystem>(properties);
+        });
+        return s3fs;
+      });
+}
+
+} // namespace facebook::velox::filesystems
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "velox/common/file/FileSystems.h"
+
+namespace facebook::velox::dwio::common {
+class IoStatistics;
+} // namespace facebook::velox::dwio::common
+
+namespace facebook::velox::filesystems {
+
+// FileSystem for s3://, s3a:// and s3n:// paths of AWS S3 or a compatible
+// object store. Reads are ranged GETs over a pool of 'hive.s3.max-connections'
+// connections. preadv() issues its GETs in parallel and preadvAsync()
+// returns without waiting for them. Files are read-only.
+//
+// Configuration:
+//   hive.s3.endpoint: Endpoint of a compatible store. The AWS default if
+//     empty.
+//   hive.s3.aws-access-key, hive.s3.aws-secret-key: Static credentials. The
+//     default AWS credentials chain is used if not set.
+//   hive.s3.path-style-access: Addresses buckets in the path instead of the
+//     host name. Default false.
+//   hive.s3.ssl.enabled: Default true.
+//   hive.s3.max-connections: Default 64.
+//   hive.s3.max-attempts: Attempts of a GET before failing. Default 3.
+class S3FileSystem : public FileSystem {
+ public:
+  explicit S3FileSystem(std::shared_ptr<const Config> config);
+
+  ~S3FileSystem() override;
+
+  std::string name() const override;
+
+  std::unique_ptr<ReadFile> openFileForRead(std::string_view path) override;
+
+  std::unique_ptr<WriteFile> openFileForWrite(std::string_view path) override;
+
+  // Request counts, retries and latencies of the GETs of all files opened
+  // from 'this', by operation name, e.g. "S3.GetObject".
+  const std::shared_ptr<dwio::common::IoStatistics>& ioStats() const;
+
+ private:
+  class Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+// Registers S3FileSystem for S3 paths. The configuration of the first
+// getFileSystem() call is used for all S3 paths.
+void registerS3FileSystem();
+
+} // namespace facebook::velox::filesystems
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/connectors/hive/storage_adapters/s3fs/S3Util.h"
+
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox::filesystems {
+
+bool isS3File(std::string_view path) {
+  return path.find(kS3Scheme) == 0 || path.find(kS3aScheme) == 0 ||
+      path.find(kS3nScheme) == 0;
+}
+
+void bucketAndKeyFromS3Path(
+    std::string_view path,
+    std::string& bucket,
+    std::string& key) {
+  auto schemeEnd = path.find("://");
+  VELOX_USER_CHECK(
+      schemeEnd != std::string_view::npos, "Not an S3 path: {}", path);
+  auto bucketAndKey = path.substr(schemeEnd + 3);
+  auto slash = bucketAndKey.find('/');
+  VELOX_USER_CHECK(
+      slash != std::string_view::npos && slash > 0 &&
+          slash + 1 < bucketAndKey.size(),
+      "S3 path must have a bucket and key: {}",
+      path);
+  bucket = std::string(bucketAndKey.substr(0, slash));
+  key = std::string(bucketAndKey.substr(slash + 1));
+}
+
+std::vector<S3RangeGet> planRangeGets(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers,
+    uint64_t maxGetSize,
+    uint64_t maxCoalescedSkip) {
+  std::vector<S3RangeGet> gets;
+  // True if the next data range may be appended to gets.back().
+  bool open = false;
+  for (auto& range : buffers) {
+    if (!range.data()) {
+      if (open && range.size() <= maxCoalescedSkip &&
+          gets.back().size + range.size() <= maxGetSize) {
+        gets.back().ranges.push_back(range);
+        gets.back().size += range.size();
+      } else {
+        open = false;
+      }
+      offset += range.size();
+      continue;
+    }
+    uint64_t done = 0;
+    while (done < range.size()) {
+      if (!open || gets.back().size == maxGetSize) {
+        gets.push_back({offset, 0, {}});
+        open = true;
+      }
+      auto& get = gets.back();
+      auto bytes = std::min(range.size() - done, maxGetSize - get.size);
+      get.ranges.emplace_back(range.data() + done, bytes);
+      get.size += bytes;
+      offset += bytes;
+      done += bytes;
+    }
+  }
+  // Do not read skipped bytes at the end of a GET.
+  for (auto& get : gets) {
+    while (!get.ranges.back().data()) {
+      get.size -= get.ranges.back().size();
+      get.ranges.pop_back();
+    }
+  }
+  return gets;
+}
+
+} // namespace facebook::velox::filesystems
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Path handling and request planning shared by the S3 FileSystem and its
+// tests. Does not depend on the AWS SDK.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace facebook::velox::filesystems {
+
+constexpr std::string_view kS3Scheme{"s3://"};
+constexpr std::string_view kS3aScheme{"s3a://"};
+constexpr std::string_view kS3nScheme{"s3n://"};
+
+// Returns true if 'path' starts with one of the S3 schemes.
+bool isS3File(std::string_view path);
+
+// Splits 's3://bucket/key' into 'bucket' and 'key'. Throws a user error if
+// 'path' has no bucket or key.
+void bucketAndKeyFromS3Path(
+    std::string_view path,
+    std::string& bucket,
+    std::string& key);
+
+// A ranged GET of [offset, offset + size) whose body is written into
+// 'ranges' left to right. Ranges with nullptr data drop their bytes.
+struct S3RangeGet {
+  uint64_t offset;
+  uint64_t size;
+  std::vector<folly::Range<char*>> ranges;
+};
+
+// Splits a preadv() of 'buffers' at 'offset' into GETs of at most
+// 'maxGetSize' bytes that can be issued in parallel. Skipped ranges of up to
+// 'maxCoalescedSkip' bytes are read and dropped, larger ones are not
+// requested.
+std::vector<S3RangeGet> planRangeGets(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers,
+    uint64_t maxGetSize,
+    uint64_t maxCoalescedSkip);
+
+} // namespace facebook::velox::filesystems
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/connectors/hive/storage_adapters/s3fs/S3Util.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox::filesystems;
+
+TEST(S3UtilTest, paths) {
+  EXPECT_TRUE(isS3File("s3://bucket/key"));
+  EXPECT_TRUE(isS3File("s3a://bucket/key"));
+  EXPECT_TRUE(isS3File("s3n://bucket/key"));
+  EXPECT_FALSE(isS3File("/tmp/s3://bucket/key"));
+  EXPECT_FALSE(isS3File("file:/tmp/data"));
+
+  std::string bucket;
+  std::string key;
+  bucketAndKeyFromS3Path("s3://warehouse/tpch/lineitem/0.orc", bucket, key);
+  EXPECT_EQ("warehouse", bucket);
+  EXPECT_EQ("tpch/lineitem/0.orc", key);
+  EXPECT_THROW(
+      bucketAndKeyFromS3Path("s3://bucket", bucket, key), std::exception);
+  EXPECT_THROW(
+      bucketAndKeyFromS3Path("s3:///key", bucket, key), std::exception);
+}
+
+TEST(S3UtilTest, planRangeGets) {
+  char head[60];
+  char tail[10];
+  char large[250];
+  std::vector<folly::Range<char*>> buffers = {
+      folly::Range<char*>(nullptr, 5),
+      folly::Range<char*>(head, sizeof(head)),
+      folly::Range<char*>(nullptr, 20),
+      folly::Range<char*>(tail, sizeof(tail)),
+      folly::Range<char*>(nullptr, 1000),
+      folly::Range<char*>(large, sizeof(large)),
+      folly::Range<char*>(nullptr, 10)};
+  auto gets = planRangeGets(1000, buffers, 100, 50);
+
+  // The leading skip is not read. The small skip between 'head' and 'tail'
+  // is read and dropped. The large skip ends the GET and is not read.
+  // 'large' is split into GETs of at most 100 bytes and the trailing skip
+  // is not read.
+  ASSERT_EQ(4, gets.size());
+  EXPECT_EQ(1005, gets[0].offset);
+  EXPECT_EQ(90, gets[0].size);
+  ASSERT_EQ(3, gets[0].ranges.size());
+  EXPECT_EQ(head, gets[0].ranges[0].data());
+  EXPECT_EQ(nullptr, gets[0].ranges[1].data());
+  EXPECT_EQ(tail, gets[0].ranges[2].data());
+
+  EXPECT_EQ(2095, gets[1].offset);
+  EXPECT_EQ(100, gets[1].size);
+  EXPECT_EQ(large, gets[1].ranges[0].data());
+  EXPECT_EQ(2195, gets[2].offset);
+  EXPECT_EQ(large + 100, gets[2].ranges[0].data());
+  EXPECT_EQ(2295, gets[3].offset);
+  EXPECT_EQ(50, gets[3].size);
+  ASSERT_EQ(1, gets[3].ranges.size());
+}
@@ -44,6 +44,17 @@ TEST(FileHandleTest, localFile) {
   ASSERT_EQ(fileHandle->file->size(), 3);
   Arena arena;
   ASSERT_EQ(fileHandle->file->pread(0, 3, &arena), "foo");
+  ASSERT_NE(fileHandle->modificationTime, 0);
+  ASSERT_EQ(
+      fileHandle->modificationTime, fileHandle->file->modificationTime());
+
+  // An invalidated handle is reopened by the next generate().
+  factory.invalidate(filename);
+  auto reopened = factory.generate(filename);
+  ASSERT_FALSE(reopened.wasCached());
+  ASSERT_NE(reopened.get(), fileHandle.get());
+  ASSERT_EQ(reopened->file->pread(0, 3, &arena), "foo");
+  ASSERT_EQ(factory.stats().numGenerated, 2);
 
   // Clean up
   remove(filename.c_str());
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <folly/CancellationToken.h>
 #include <folly/futures/Future.h>
 #include <folly/portability/SysSyscall.h>
 #include <mutex>
@@ -168,6 +169,7 @@ class CancelPool {
 
   void requestTerminate() {
     terminateRequested_ = true;
+    cancellationSource_.requestCancellation();
   }
 
   void requestYield() {
@@ -179,6 +181,14 @@ class CancelPool {
     return terminateRequested_;
   }
 
+  // Returns a token that is cancelled by requestTerminate(). Work that
+  // runs off the Driver threads, e.g. prefetch IO, checks or subscribes
+  // to the token to stop without waiting for the Drivers to come back on
+  // thread.
+  folly::CancellationToken cancellationToken() const {
+    return cancellationSource_.getToken();
+  }
+
   // Once 'pauseRequested_' is set, it will not be cleared until
   // task::resume(). It is therefore OK to read it without a mutex
   // from a thread that this flag concerns.
@@ -233,6 +243,7 @@ class CancelPool {
   int32_t toYield_ = 0;
   int32_t numThreads_ = 0;
   std::vector<VeloxPromise<bool>> finishPromises_;
+  folly::CancellationSource cancellationSource_;
 };
 
 using CancelPoolPtr = std::shared_ptr<CancelPool>;
@@ -26,21 +26,28 @@ AggregationNode::AggregationNode(
     Step step,
     const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
         groupingKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        preGroupedKeys,
     const std::vector<std::string>& aggregateNames,
     const std::vector<std::shared_ptr<const CallTypedExpr>>& aggregates,
     const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
         aggregateMasks,
+    const std::vector<bool>& aggregateDistincts,
     bool ignoreNullKeys,
-    std::shared_ptr<const PlanNode> source)
+    std::shared_ptr<const PlanNode> source,
+    std::optional<uint64_t> numGroupsEstimate)
     : PlanNode(id),
       step_(step),
       groupingKeys_(groupingKeys),
+      preGroupedKeys_(preGroupedKeys),
       aggregateNames_(aggregateNames),
       aggregates_(aggregates),
       aggregateMasks_(aggregateMasks),
+      aggregateDistincts_(aggregateDistincts),
       ignoreNullKeys_(ignoreNullKeys),
       sources_{source},
-      outputType_(getOutputType(groupingKeys_, aggregateNames_, aggregates_)) {
+      outputType_(getOutputType(groupingKeys_, aggregateNames_, aggregates_)),
+      numGroupsEstimate_(numGroupsEstimate) {
   // Empty grouping keys are used in global aggregation:
   //    SELECT sum(c) FROM t
   // Empty aggregates are used in distinct:
@@ -48,6 +55,66 @@ AggregationNode::AggregationNode(
   VELOX_CHECK(
       !groupingKeys_.empty() || !aggregates_.empty(),
       "Aggregation must specify either grouping keys or aggregates");
+
+  for (const auto& key : preGroupedKeys_) {
+    VELOX_CHECK(
+        std::find_if(
+            groupingKeys_.begin(),
+            groupingKeys_.end(),
+            [&](const auto& groupingKey) {
+              return groupingKey->name() == key->name();
+            }) != groupingKeys_.end(),
+        "Pre-grouped key must be one of the grouping keys: {}",
+        key->name());
+  }
+
+  if (!aggregateDistincts_.empty()) {
+    VELOX_CHECK_EQ(
+        aggregateDistincts_.size(),
+        aggregates_.size(),
+        "Number of distinct flags must be equal to number of aggregates");
+    VELOX_CHECK(
+        step_ == Step::kSingle || !hasDistinctAggregates(),
+        "Distinct aggregates require a single aggregation step");
+  }
+}
+
+namespace {
+const char* stepName(AggregationNode::Step step) {
+  switch (step) {
+    case AggregationNode::Step::kPartial:
+      return "partial";
+    case AggregationNode::Step::kFinal:
+      return "final";
+    case AggregationNode::Step::kIntermediate:
+      return "intermediate";
+    case AggregationNode::Step::kSingle:
+      return "single";
+  }
+  VELOX_UNREACHABLE();
+}
+} // namespace
+
+void AggregationNode::addDetails(std::stringstream& stream) const {
+  stream << stepName(step_) << " keys: ";
+  for (const auto& key : groupingKeys_) {
+    stream << key->name() << ", ";
+  }
+  stream << "aggregates: ";
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    stream << aggregateNames_[i] << " := ";
+    if (!aggregateDistincts_.empty() && aggregateDistincts_[i]) {
+      stream << "distinct ";
+    }
+    stream << aggregates_[i]->toString();
+    if (i < aggregateMasks_.size() && aggregateMasks_[i]) {
+      stream << " mask " << aggregateMasks_[i]->name();
+    }
+    stream << ", ";
+  }
+  if (ignoreNullKeys_) {
+    stream << "ignore null keys";
+  }
 }
 
 const std::vector<std::shared_ptr<const PlanNode>>& ValuesNode::sources()
@@ -55,11 +122,34 @@ const std::vector<std::shared_ptr<const PlanNode>>& ValuesNode::sources()
   return EMPTY_SOURCES;
 }
 
+const std::vector<std::shared_ptr<const PlanNode>>& ArrowStreamNode::sources()
+    const {
+  return EMPTY_SOURCES;
+}
+
+const std::vector<std::shared_ptr<const PlanNode>>&
+SyntheticSourceNode::sources() const {
+  return EMPTY_SOURCES;
+}
+
 const std::vector<std::shared_ptr<const PlanNode>>& TableScanNode::sources()
     const {
   return EMPTY_SOURCES;
 }
 
+void TableScanNode::addDetails(std::stringstream& stream) const {
+  stream << tableHandle_->toString() << ", columns: ";
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    const auto& name = outputType_->nameOf(i);
+    stream << name << ":" << outputType_->childAt(i)->toString();
+    auto it = assignments_.find(name);
+    if (it != assignments_.end()) {
+      stream << " " << it->second->toString();
+    }
+    stream << ", ";
+  }
+}
+
 const std::vector<std::shared_ptr<const PlanNode>>& ExchangeNode::sources()
     const {
   return EMPTY_SOURCES;
@@ -114,6 +204,72 @@ UnnestNode::UnnestNode(
   outputType_ = ROW(std::move(names), std::move(types));
 }
 
+GroupIdNode::GroupIdNode(
+    const PlanNodeId& id,
+    std::vector<std::vector<std::shared_ptr<const FieldAccessTypedExpr>>>
+        groupingSets,
+    std::vector<std::shared_ptr<const FieldAccessTypedExpr>> aggregationInputs,
+    const std::string& groupIdName,
+    std::shared_ptr<const PlanNode> source)
+    : PlanNode(id),
+      groupingSets_(std::move(groupingSets)),
+      aggregationInputs_(std::move(aggregationInputs)),
+      groupIdName_(groupIdName),
+      sources_{std::move(source)} {
+  VELOX_CHECK(
+      !groupingSets_.empty(), "GroupIdNode requires at least one grouping set");
+  const auto& inputType = sources_[0]->outputType();
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  auto addOutput = [&](const auto& field) {
+    VELOX_CHECK(
+        inputType->containsChild(field->name()),
+        "GroupIdNode input not found: {}",
+        field->name());
+    VELOX_CHECK(
+        std::find(names.begin(), names.end(), field->name()) == names.end(),
+        "Duplicate GroupIdNode output: {}",
+        field->name());
+    names.emplace_back(field->name());
+    types.emplace_back(field->type());
+  };
+
+  for (const auto& groupingSet : groupingSets_) {
+    for (const auto& key : groupingSet) {
+      if (std::find(names.begin(), names.end(), key->name()) == names.end()) {
+        addOutput(key);
+        groupingKeys_.push_back(key);
+      }
+    }
+  }
+  for (const auto& input : aggregationInputs_) {
+    addOutput(input);
+  }
+  VELOX_CHECK(
+      std::find(names.begin(), names.end(), groupIdName_) == names.end(),
+      "Duplicate GroupIdNode output: {}",
+      groupIdName_);
+  names.emplace_back(groupIdName_);
+  types.emplace_back(BIGINT());
+  outputType_ = ROW(std::move(names), std::move(types));
+}
+
+void GroupIdNode::addDetails(std::stringstream& stream) const {
+  for (auto i = 0; i < groupingSets_.size(); ++i) {
+    if (i > 0) {
+      stream << ", ";
+    }
+    stream << "[";
+    for (auto j = 0; j < groupingSets_[i].size(); ++j) {
+      if (j > 0) {
+        stream << ", ";
+      }
+      stream << groupingSets_[i][j]->name();
+    }
+    stream << "]";
+  }
+}
+
 HashJoinNode::HashJoinNode(
     const PlanNodeId& id,
     JoinType joinType,
@@ -170,12 +326,211 @@ HashJoinNode::HashJoinNode(
   }
 }
 
+MergeJoinNode::MergeJoinNode(
+    const PlanNodeId& id,
+    JoinType joinType,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& leftKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& rightKeys,
+    std::shared_ptr<const PlanNode> left,
+    std::shared_ptr<const PlanNode> right,
+    const RowTypePtr outputType)
+    : PlanNode(id),
+      joinType_(joinType),
+      leftKeys_(leftKeys),
+      rightKeys_(rightKeys),
+      sources_({std::move(left), std::move(right)}),
+      outputType_(outputType) {
+  VELOX_CHECK(
+      joinType_ == JoinType::kInner || joinType_ == JoinType::kLeft,
+      "MergeJoinNode supports only inner and left joins");
+  VELOX_CHECK(
+      !leftKeys_.empty(), "MergeJoinNode requires at least one join key");
+  VELOX_CHECK_EQ(
+      leftKeys_.size(),
+      rightKeys_.size(),
+      "MergeJoinNode requires same number of join keys on both sides");
+  auto leftType = sources_[0]->outputType();
+  for (auto key : leftKeys_) {
+    VELOX_CHECK(
+        leftType->containsChild(key->name()),
+        "Left side join key not found in left side output: {}",
+        key->name());
+  }
+  auto rightType = sources_[1]->outputType();
+  for (auto key : rightKeys_) {
+    VELOX_CHECK(
+        rightType->containsChild(key->name()),
+        "Right side join key not found in right side output: {}",
+        key->name());
+  }
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    auto name = outputType_->nameOf(i);
+    if (leftType->containsChild(name)) {
+      VELOX_CHECK(
+          !rightType->containsChild(name),
+          "Duplicate column name found on join's left and right sides: {}",
+          name);
+    } else if (!rightType->containsChild(name)) {
+      VELOX_FAIL(
+          "Join's output column not found in either left or right sides: {}",
+          name);
+    }
+  }
+}
+
 CrossJoinNode::CrossJoinNode(
     const PlanNodeId& id,
     std::shared_ptr<const PlanNode> left,
     std::shared_ptr<const PlanNode> right,
-    RowTypePtr outputType)
+    RowTypePtr outputType,
+    std::shared_ptr<const ITypedExpr> filter)
     : PlanNode(id),
       sources_({std::move(left), std::move(right)}),
-      outputType_(std::move(outputType)) {}
+      outputType_(std::move(outputType)),
+      filter_(std::move(filter)) {}
+
+namespace {
+RowTypePtr windowOutputType(
+    const RowTypePtr& inputType,
+    const std::vector<std::string>& windowColumnNames,
+    const std::vector<WindowNode::Function>& windowFunctions) {
+  VELOX_CHECK_EQ(
+      windowColumnNames.size(),
+      windowFunctions.size(),
+      "WindowNode requires one column name per window function");
+  auto names = inputType->names();
+  auto types = inputType->children();
+  for (auto i = 0; i < windowFunctions.size(); ++i) {
+    names.push_back(windowColumnNames[i]);
+    types.push_back(windowFunctions[i].functionCall->type());
+  }
+  return ROW(std::move(names), std::move(types));
+}
+
+void checkFrame(const WindowNode::Frame& frame) {
+  using BoundType = WindowNode::BoundType;
+  VELOX_CHECK(
+      frame.startType != BoundType::kUnboundedFollowing,
+      "Window frame cannot start at UNBOUNDED FOLLOWING");
+  VELOX_CHECK(
+      frame.endType != BoundType::kUnboundedPreceding,
+      "Window frame cannot end at UNBOUNDED PRECEDING");
+  VELOX_CHECK_GE(frame.startOffset, 0, "Window frame offset is negative");
+  VELOX_CHECK_GE(frame.endOffset, 0, "Window frame offset is negative");
+  if (frame.type == WindowNode::WindowType::kRange) {
+    VELOX_CHECK(
+        frame.startType != BoundType::kPreceding &&
+            frame.startType != BoundType::kFollowing &&
+            frame.endType != BoundType::kPreceding &&
+            frame.endType != BoundType::kFollowing,
+        "RANGE window frames support only UNBOUNDED and CURRENT ROW bounds");
+  }
+}
+} // namespace
+
+WindowNode::WindowNode(
+    const PlanNodeId& id,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        partitionKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        sortingKeys,
+    const std::vector<SortOrder>& sortingOrders,
+    const std::vector<std::string>& windowColumnNames,
+    const std::vector<Function>& windowFunctions,
+    bool inputsSorted,
+    std::shared_ptr<const PlanNode> source)
+    : PlanNode(id),
+      partitionKeys_(partitionKeys),
+      sortingKeys_(sortingKeys),
+      sortingOrders_(sortingOrders),
+      windowFunctions_(windowFunctions),
+      inputsSorted_(inputsSorted),
+      sources_{std::move(source)},
+      outputType_(windowOutputType(
+          sources_[0]->outputType(),
+          windowColumnNames,
+          windowFunctions)) {
+  VELOX_CHECK_EQ(
+      sortingKeys_.size(),
+      sortingOrders_.size(),
+      "WindowNode requires one sorting order per sorting key");
+  auto inputType = sources_[0]->outputType();
+  for (const auto& key : partitionKeys_) {
+    VELOX_CHECK(
+        inputType->containsChild(key->name()),
+        "Window partition key not found in input: {}",
+        key->name());
+  }
+  for (const auto& key : sortingKeys_) {
+    VELOX_CHECK(
+        inputType->containsChild(key->name()),
+        "Window sorting key not found in input: {}",
+        key->name());
+  }
+  for (const auto& function : windowFunctions_) {
+    checkFrame(function.frame);
+  }
+}
+
+namespace {
+RowTypePtr topNRowNumberOutputType(
+    const RowTypePtr& inputType,
+    const std::optional<std::string>& rowNumberColumnName) {
+  if (!rowNumberColumnName.has_value()) {
+    return inputType;
+  }
+  auto names = inputType->names();
+  auto types = inputType->children();
+  names.push_back(rowNumberColumnName.value());
+  types.push_back(BIGINT());
+  return ROW(std::move(names), std::move(types));
+}
+} // namespace
+
+TopNRowNumberNode::TopNRowNumberNode(
+    const PlanNodeId& id,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        partitionKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        sortingKeys,
+    const std::vector<SortOrder>& sortingOrders,
+    const std::optional<std::string>& rowNumberColumnName,
+    int32_t limit,
+    bool isPartial,
+    std::shared_ptr<const PlanNode> source)
+    : PlanNode(id),
+      partitionKeys_(partitionKeys),
+      sortingKeys_(sortingKeys),
+      sortingOrders_(sortingOrders),
+      limit_(limit),
+      isPartial_(isPartial),
+      sources_{std::move(source)},
+      outputType_(topNRowNumberOutputType(
+          sources_[0]->outputType(),
+          rowNumberColumnName)) {
+  VELOX_CHECK(
+      !sortingKeys_.empty(), "TopNRowNumber must specify sorting keys");
+  VELOX_CHECK_EQ(
+      sortingKeys_.size(),
+      sortingOrders_.size(),
+      "TopNRowNumber requires one sorting order per sorting key");
+  VELOX_CHECK_GT(
+      limit_, 0, "TopNRowNumber must keep at least one row per partition");
+  VELOX_CHECK(
+      !isPartial_ || !rowNumberColumnName.has_value(),
+      "Partial TopNRowNumber cannot produce row numbers");
+  auto inputType = sources_[0]->outputType();
+  for (const auto& key : partitionKeys_) {
+    VELOX_CHECK(
+        inputType->containsChild(key->name()),
+        "TopNRowNumber partition key not found in input: {}",
+        key->name());
+  }
+  for (const auto& key : sortingKeys_) {
+    VELOX_CHECK(
+        inputType->containsChild(key->name()),
+        "TopNRowNumber sorting key not found in input: {}",
+        key->name());
+  }
+}
 } // namespace facebook::velox::core
@@ -17,6 +17,7 @@
 
 #include "velox/connectors/Connector.h"
 #include "velox/core/Expressions.h"
+#include "velox/vector/arrow/Abi.h"
 
 namespace facebook::velox::core {
 
@@ -186,6 +187,145 @@ class ValuesNode : public PlanNode {
   const bool parallelizable_;
 };
 
+/// Reads the batches of an Arrow C stream. The stream is shared by all
+/// operators made from this node, so the node runs single-threaded. The
+/// stream is released with its last reference, e.g. by making the
+/// shared_ptr with a deleter that calls 'release'.
+class ArrowStreamNode : public PlanNode {
+ public:
+  ArrowStreamNode(
+      const PlanNodeId& id,
+      RowTypePtr outputType,
+      std::shared_ptr<ArrowArrayStream> arrowStream)
+      : PlanNode(id),
+        outputType_(std::move(outputType)),
+        arrowStream_(std::move(arrowStream)) {
+    VELOX_CHECK_NOT_NULL(arrowStream_);
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override;
+
+  const std::shared_ptr<ArrowArrayStream>& arrowStream() const {
+    return arrowStream_;
+  }
+
+  std::string_view name() const override {
+    return "arrow stream";
+  }
+
+ private:
+  const RowTypePtr outputType_;
+  const std::shared_ptr<ArrowArrayStream> arrowStream_;
+};
+
+/// Describes how SyntheticSourceNode generates a column. Each row draws a
+/// number from 'distribution', which is converted to the column type:
+/// integers and floating point values take the number, booleans take its
+/// lowest bit and strings append it to 'prefix'.
+struct SyntheticColumn {
+  enum class Distribution {
+    // min, min + 1, ... numbered by the row across all drivers, so that
+    // sequences are unique across drivers. Wraps around after max.
+    kSequence,
+    // Uniformly distributed in [min, max].
+    kUniform,
+    // Normally distributed around (min + max) / 2 with a standard deviation
+    // of (max - min) / 6, clamped to [min, max].
+    kNormal,
+  };
+
+  enum class Encoding {
+    kFlat,
+    // Dictionary over the values of 'cardinality' consecutive numbers
+    // starting at min. The distribution picks dictionary entries in
+    // [0, cardinality - 1] rather than values in [min, max].
+    kDictionary,
+    // A constant vector per batch, with the value of the batch's first row.
+    kConstant,
+  };
+
+  Distribution distribution{Distribution::kSequence};
+  Encoding encoding{Encoding::kFlat};
+  int64_t min{0};
+  int64_t max{std::numeric_limits<int64_t>::max()};
+  int32_t cardinality{1'000};
+  // Fraction of rows that are null. For kConstant, the fraction of batches.
+  double nullRatio{0};
+  std::string prefix;
+};
+
+/// Generates 'rowsPerDriver' rows of synthetic data in every driver, in
+/// batches of 'batchSize' rows, without reading any input. Random
+/// distributions are seeded from 'seed' and the driver id, so that results
+/// are repeatable for a given number of drivers. Meant for benchmarks and
+/// tests that need multi-driver sources without IO.
+class SyntheticSourceNode : public PlanNode {
+ public:
+  SyntheticSourceNode(
+      const PlanNodeId& id,
+      RowTypePtr outputType,
+      std::vector<SyntheticColumn> columns,
+      uint64_t rowsPerDriver,
+      vector_size_t batchSize = 1'024,
+      uint64_t seed = 0)
+      : PlanNode(id),
+        outputType_(std::move(outputType)),
+        columns_(std::move(columns)),
+        rowsPerDriver_(rowsPerDriver),
+        batchSize_(batchSize),
+        seed_(seed) {
+    VELOX_CHECK_EQ(outputType_->size(), columns_.size());
+    VELOX_CHECK_GT(batchSize_, 0);
+    for (const auto& column : columns_) {
+      VELOX_CHECK_LE(column.min, column.max);
+      VELOX_CHECK_GT(column.cardinality, 0);
+      VELOX_CHECK(column.nullRatio >= 0 && column.nullRatio <= 1);
+    }
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override;
+
+  const std::vector<SyntheticColumn>& columns() const {
+    return columns_;
+  }
+
+  uint64_t rowsPerDriver() const {
+    return rowsPerDriver_;
+  }
+
+  vector_size_t batchSize() const {
+    return batchSize_;
+  }
+
+  uint64_t seed() const {
+    return seed_;
+  }
+
+  std::string_view name() const override {
+    return "synthetic source";
+  }
+
+ private:
+  void addDetails(std::stringstream& stream) const override {
+    stream << "rowsPerDriver: " << rowsPerDriver_ << ", batchSize: "
+           << batchSize_;
+  }
+
+  const RowTypePtr outputType_;
+  const std::vector<SyntheticColumn> columns_;
+  const uint64_t rowsPerDriver_;
+  const vector_size_t batchSize_;
+  const uint64_t seed_;
+};
+
 class FilterNode : public PlanNode {
  public:
   FilterNode(
@@ -326,6 +466,8 @@ class TableScanNode : public PlanNode {
   }
 
  private:
+  void addDetails(std::stringstream& stream) const override;
+
   const RowTypePtr outputType_;
   const std::shared_ptr<connector::ConnectorTableHandle> tableHandle_;
   const std::
@@ -404,21 +546,37 @@ class AggregationNode : public PlanNode {
   };
 
   /**
+   * @param preGroupedKeys A subset of the 'groupingKeys' on which the input
+   * is clustered, i.e. all rows with the same values of these keys are
+   * adjacent. If these are all the grouping keys, the aggregation is
+   * computed by a streaming aggregation that emits each group as soon as
+   * the next one starts.
+   * @param aggregateDistincts Empty or one flag per aggregate. A set flag
+   * makes the aggregate see each distinct combination of its arguments only
+   * once per group, e.g. count(DISTINCT x). Requires a single aggregation
+   * step.
    * @param ignoreNullKeys True if rows with at least one null key should be
    * ignored. Used when group by is a source of a join build side and grouping
    * keys are join keys.
+   * @param numGroupsEstimate Expected number of groups in the hash table of
+   * each operator, e.g. from planner statistics. If set, the hash table is
+   * allocated at its final size instead of growing to it.
    */
   AggregationNode(
       const PlanNodeId& id,
       Step step,
       const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
           groupingKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          preGroupedKeys,
       const std::vector<std::string>& aggregateNames,
       const std::vector<std::shared_ptr<const CallTypedExpr>>& aggregates,
       const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
           aggregateMasks,
+      const std::vector<bool>& aggregateDistincts,
       bool ignoreNullKeys,
-      std::shared_ptr<const PlanNode> source);
+      std::shared_ptr<const PlanNode> source,
+      std::optional<uint64_t> numGroupsEstimate = std::nullopt);
 
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
     return sources_;
@@ -437,6 +595,17 @@ class AggregationNode : public PlanNode {
     return groupingKeys_;
   }
 
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  preGroupedKeys() const {
+    return preGroupedKeys_;
+  }
+
+  // Returns true if the input is clustered on all the grouping keys.
+  bool isPreGrouped() const {
+    return !groupingKeys_.empty() &&
+        preGroupedKeys_.size() == groupingKeys_.size();
+  }
+
   const std::vector<std::string>& aggregateNames() const {
     return aggregateNames_;
   }
@@ -450,15 +619,32 @@ class AggregationNode : public PlanNode {
     return aggregateMasks_;
   }
 
+  // Empty if no aggregate is distinct.
+  const std::vector<bool>& aggregateDistincts() const {
+    return aggregateDistincts_;
+  }
+
+  bool hasDistinctAggregates() const {
+    return std::find(
+               aggregateDistincts_.begin(), aggregateDistincts_.end(), true) !=
+        aggregateDistincts_.end();
+  }
+
   bool ignoreNullKeys() const {
     return ignoreNullKeys_;
   }
 
+  const std::optional<uint64_t>& numGroupsEstimate() const {
+    return numGroupsEstimate_;
+  }
+
   std::string_view name() const override {
     return "aggregation";
   }
 
  private:
+  void addDetails(std::stringstream& stream) const override;
+
   static std::shared_ptr<RowType> getOutputType(
       const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
           groupingKeys,
@@ -490,15 +676,21 @@ class AggregationNode : public PlanNode {
 
   const Step step_;
   const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> groupingKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      preGroupedKeys_;
   const std::vector<std::string> aggregateNames_;
   const std::vector<std::shared_ptr<const CallTypedExpr>> aggregates_;
   // Keeps mask/'no mask' for every aggregation. Mask, if given, is a reference
   // to a boolean projection column, used to mask out rows for the aggregation.
   const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
       aggregateMasks_;
+  // Keeps a distinct flag for every aggregation or is empty if none of the
+  // aggregations is distinct.
+  const std::vector<bool> aggregateDistincts_;
   const bool ignoreNullKeys_;
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
   const RowTypePtr outputType_;
+  const std::optional<uint64_t> numGroupsEstimate_;
 };
 
 inline std::ostream& operator<<(
@@ -916,6 +1108,63 @@ class HashJoinNode : public PlanNode {
   const RowTypePtr outputType_;
 };
 
+// Represents inner and left joins of inputs that are sorted on the join
+// keys. Translates to an exec::MergeJoin that streams over both
+// inputs. The right side runs in a separate pipeline and feeds its
+// batches into the join one at a time.
+class MergeJoinNode : public PlanNode {
+ public:
+  MergeJoinNode(
+      const PlanNodeId& id,
+      JoinType joinType,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& leftKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& rightKeys,
+      std::shared_ptr<const PlanNode> left,
+      std::shared_ptr<const PlanNode> right,
+      const RowTypePtr outputType);
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  JoinType joinType() const {
+    return joinType_;
+  }
+
+  bool isInnerJoin() const {
+    return joinType_ == JoinType::kInner;
+  }
+
+  bool isLeftJoin() const {
+    return joinType_ == JoinType::kLeft;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& leftKeys()
+      const {
+    return leftKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& rightKeys()
+      const {
+    return rightKeys_;
+  }
+
+  std::string_view name() const override {
+    return "merge join";
+  }
+
+ private:
+  const JoinType joinType_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> leftKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> rightKeys_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  const RowTypePtr outputType_;
+};
+
 // Cross join.
 class CrossJoinNode : public PlanNode {
  public:
@@ -923,7 +1172,8 @@ class CrossJoinNode : public PlanNode {
       const PlanNodeId& id,
       std::shared_ptr<const PlanNode> left,
       std::shared_ptr<const PlanNode> right,
-      RowTypePtr outputType);
+      RowTypePtr outputType,
+      std::shared_ptr<const ITypedExpr> filter = nullptr);
 
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
     return sources_;
@@ -933,13 +1183,26 @@ class CrossJoinNode : public PlanNode {
     return outputType_;
   }
 
+  const std::shared_ptr<const ITypedExpr>& filter() const {
+    return filter_;
+  }
+
   std::string_view name() const override {
     return "cross join";
   }
 
  private:
+  void addDetails(std::stringstream& stream) const override {
+    if (filter_) {
+      stream << "filter: " << filter_->toString();
+    }
+  }
+
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
   const RowTypePtr outputType_;
+  // Optional filter on the combined probe and build rows, nullptr if
+  // absent. Equivalent to a Filter above the join.
+  const std::shared_ptr<const ITypedExpr> filter_;
 };
 
 // Represents the 'SortBy' node in the plan.
@@ -1205,4 +1468,246 @@ class EnforceSingleRowNode : public PlanNode {
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
 };
 
+/// Replicates each input row once per grouping set for a GROUPING SETS,
+/// ROLLUP or CUBE aggregation. In the copy for grouping set i the grouping
+/// keys that are not in that set are null and a BIGINT column
+/// 'groupIdName' is set to i. An aggregation grouped on all grouping keys
+/// plus the group id column then computes all grouping sets in a single
+/// pass over the input.
+///
+/// The group id can also be placed between a partial aggregation on the
+/// union of the grouping keys and the final aggregation. The coarser
+/// grouping sets are then rolled up from the partial results of the finest
+/// one instead of from the raw input.
+///
+/// The output has the grouping keys in the order of their first appearance
+/// in 'groupingSets', followed by 'aggregationInputs', followed by the
+/// group id column. The aggregation inputs are passed through as is and
+/// must not be grouping keys.
+class GroupIdNode : public PlanNode {
+ public:
+  GroupIdNode(
+      const PlanNodeId& id,
+      std::vector<std::vector<std::shared_ptr<const FieldAccessTypedExpr>>>
+          groupingSets,
+      std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+          aggregationInputs,
+      const std::string& groupIdName,
+      std::shared_ptr<const PlanNode> source);
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const std::vector<std::vector<std::shared_ptr<const FieldAccessTypedExpr>>>&
+  groupingSets() const {
+    return groupingSets_;
+  }
+
+  /// The union of the keys of all grouping sets.
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  groupingKeys() const {
+    return groupingKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  aggregationInputs() const {
+    return aggregationInputs_;
+  }
+
+  const std::string& groupIdName() const {
+    return groupIdName_;
+  }
+
+  std::string_view name() const override {
+    return "group id";
+  }
+
+ private:
+  void addDetails(std::stringstream& stream) const override;
+
+  const std::vector<std::vector<std::shared_ptr<const FieldAccessTypedExpr>>>
+      groupingSets_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      aggregationInputs_;
+  const std::string groupIdName_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  std::vector<std::shared_ptr<const FieldAccessTypedExpr>> groupingKeys_;
+  RowTypePtr outputType_;
+};
+
+/// Computes window functions over partitions of the input. The rows are
+/// divided into partitions by 'partitionKeys' and ordered within each
+/// partition by 'sortingKeys'. Each window function produces one value
+/// per input row from the rows of the row's frame. The output has the
+/// input columns followed by one column per window function, named
+/// 'windowColumnNames'.
+///
+/// If 'inputsSorted' is true, the input is already grouped by the
+/// partition keys and ordered by the sorting keys, e.g. because it comes
+/// from a sorted table or a merge join. The partitions are then computed
+/// as these arrive instead of after all input is buffered and sorted.
+class WindowNode : public PlanNode {
+ public:
+  enum class WindowType { kRange, kRows };
+
+  enum class BoundType {
+    kUnboundedPreceding,
+    kPreceding,
+    kCurrentRow,
+    kFollowing,
+    kUnboundedFollowing
+  };
+
+  /// Bounds of the rows a window function is computed over, relative to
+  /// the current row. 'startOffset' and 'endOffset' are the number of
+  /// rows for kPreceding and kFollowing bounds and are ignored
+  /// otherwise. kRange frames support only kUnboundedPreceding,
+  /// kCurrentRow and kUnboundedFollowing bounds, where kCurrentRow
+  /// includes the rows with the same sorting keys as the current row.
+  struct Frame {
+    WindowType type{WindowType::kRange};
+    BoundType startType{BoundType::kUnboundedPreceding};
+    int64_t startOffset{0};
+    BoundType endType{BoundType::kCurrentRow};
+    int64_t endOffset{0};
+  };
+
+  struct Function {
+    std::shared_ptr<const CallTypedExpr> functionCall;
+    Frame frame;
+  };
+
+  WindowNode(
+      const PlanNodeId& id,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          partitionKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          sortingKeys,
+      const std::vector<SortOrder>& sortingOrders,
+      const std::vector<std::string>& windowColumnNames,
+      const std::vector<Function>& windowFunctions,
+      bool inputsSorted,
+      std::shared_ptr<const PlanNode> source);
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  partitionKeys() const {
+    return partitionKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  sortingKeys() const {
+    return sortingKeys_;
+  }
+
+  const std::vector<SortOrder>& sortingOrders() const {
+    return sortingOrders_;
+  }
+
+  const std::vector<Function>& windowFunctions() const {
+    return windowFunctions_;
+  }
+
+  bool inputsSorted() const {
+    return inputsSorted_;
+  }
+
+  std::string_view name() const override {
+    return "window";
+  }
+
+ private:
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      partitionKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys_;
+  const std::vector<SortOrder> sortingOrders_;
+  const std::vector<Function> windowFunctions_;
+  const bool inputsSorted_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  const RowTypePtr outputType_;
+};
+
+/// Keeps the first 'limit' rows of each partition on 'partitionKeys' in
+/// the order of 'sortingKeys'. This is row_number() over the partition
+/// filtered on row_number <= limit, computed without keeping more than
+/// 'limit' rows per partition. If 'rowNumberColumnName' is set, the
+/// output has the input columns followed by a BIGINT column with the
+/// row number of each row in its partition, starting at 1. A partial
+/// step without the row number can run before an exchange on the
+/// partition keys and a final step produces the row numbers after it.
+class TopNRowNumberNode : public PlanNode {
+ public:
+  TopNRowNumberNode(
+      const PlanNodeId& id,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          partitionKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          sortingKeys,
+      const std::vector<SortOrder>& sortingOrders,
+      const std::optional<std::string>& rowNumberColumnName,
+      int32_t limit,
+      bool isPartial,
+      std::shared_ptr<const PlanNode> source);
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  partitionKeys() const {
+    return partitionKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  sortingKeys() const {
+    return sortingKeys_;
+  }
+
+  const std::vector<SortOrder>& sortingOrders() const {
+    return sortingOrders_;
+  }
+
+  bool generateRowNumber() const {
+    return outputType_->size() > sources_[0]->outputType()->size();
+  }
+
+  int32_t limit() const {
+    return limit_;
+  }
+
+  bool isPartial() const {
+    return isPartial_;
+  }
+
+  std::string_view name() const override {
+    return "topNRowNumber";
+  }
+
+ private:
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      partitionKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys_;
+  const std::vector<SortOrder> sortingOrders_;
+  const int32_t limit_;
+  const bool isPartial_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  const RowTypePtr outputType_;
+};
+
 } // namespace facebook::velox::core
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <folly/Executor.h>
+#include "velox/common/memory/Arena.h"
 #include "velox/common/memory/MappedMemory.h"
 #include "velox/common/memory/Memory.h"
 #include "velox/core/CancelPool.h"
@@ -116,6 +117,42 @@ class QueryCtx : public Context {
         kMaxPartialAggregationMemory, kMaxPartialAggregationMemoryDefault);
   }
 
+  int64_t abandonPartialAggregationMinRows() const {
+    return get<int64_t>(kAbandonPartialAggregationMinRows, 100'000);
+  }
+
+  int32_t abandonPartialAggregationMinPct() const {
+    return get<int32_t>(kAbandonPartialAggregationMinPct, 80);
+  }
+
+  int8_t driverPriority() const {
+    return get<int8_t>(kDriverPriority, 0);
+  }
+
+  int64_t driverTimeSliceMicros() const {
+    return get<int64_t>(kDriverTimeSliceMicros, 0);
+  }
+
+  int64_t driverTimeSliceBatches() const {
+    return get<int64_t>(kDriverTimeSliceBatches, 0);
+  }
+
+  bool sharedFinalAggregation() const {
+    return get<bool>(kSharedFinalAggregation, false);
+  }
+
+  int32_t maxSplitPreloadPerDriver() const {
+    return get<int32_t>(kMaxSplitPreloadPerDriver, 2);
+  }
+
+  bool fragmentResultCacheEnabled() const {
+    return get<bool>(kFragmentResultCacheEnabled, false);
+  }
+
+  int32_t traceEventsPerThread() const {
+    return get<int32_t>(kTraceEventsPerThread, 0);
+  }
+
   uint64_t maxPartitionedOutputBufferSize() const {
     return get<uint64_t>(
         kMaxPartitionedOutputBufferSize,
@@ -127,6 +164,11 @@ class QueryCtx : public Context {
         kMaxLocalExchangeBufferSize, kMaxLocalExchangeBufferSizeDefault);
   }
 
+  uint64_t maxExchangeClientBufferSize() const {
+    return get<uint64_t>(
+        kMaxExchangeClientBufferSize, kMaxExchangeClientBufferSizeDefault);
+  }
+
   bool hashAdaptivityEnabled() const {
     return get<bool>(kHashAdaptivityEnabled, true);
   }
@@ -175,6 +217,70 @@ class QueryCtx : public Context {
     return get<bool>(kExprEvalSimplified, false);
   }
 
+  bool exprTrackStats() const {
+    return get<bool>(kExprTrackStats, false);
+  }
+
+  bool spillEnabled() const {
+    return get<bool>(kSpillEnabled, false);
+  }
+
+  std::string spillPath() const {
+    return get<std::string>(kSpillPath, kSpillPathDefault);
+  }
+
+  uint64_t orderBySpillMemoryThreshold() const {
+    return get<uint64_t>(kOrderBySpillMemoryThreshold, 0);
+  }
+
+  uint64_t aggregationSpillMemoryThreshold() const {
+    return get<uint64_t>(kAggregationSpillMemoryThreshold, 0);
+  }
+
+  uint64_t joinSpillMemoryThreshold() const {
+    return get<uint64_t>(kJoinSpillMemoryThreshold, 0);
+  }
+
+  int32_t spillMaxMergeFanIn() const {
+    return get<int32_t>(kSpillMaxMergeFanIn, 128);
+  }
+
+  int64_t mergeExchangeSourceBufferBytes() const {
+    return get<int64_t>(kMergeExchangeSourceBufferBytes, 32 << 20);
+  }
+
+  bool memoryArbitrationEnabled() const {
+    return get<bool>(kMemoryArbitrationEnabled, false);
+  }
+
+  bool parallelDriverCreationEnabled() const {
+    return get<bool>(kParallelDriverCreationEnabled, true);
+  }
+
+  int64_t memoryUsageUpdateBatchBytes() const {
+    return get<int64_t>(kMemoryUsageUpdateBatchBytes, 1 << 20);
+  }
+
+  bool hashJoinBloomFilterEnabled() const {
+    return get<bool>(kHashJoinBloomFilterEnabled, false);
+  }
+
+  bool hashTableCacheEnabled() const {
+    return get<bool>(kHashTableCacheEnabled, false);
+  }
+
+  std::string exchangeCompression() const {
+    return get<std::string>(kExchangeCompression, "none");
+  }
+
+  uint64_t preferredOutputBatchBytes() const {
+    return get<uint64_t>(kPreferredOutputBatchBytes, 1UL << 20);
+  }
+
+  uint32_t maxOutputBatchRows() const {
+    return get<uint32_t>(kMaxOutputBatchRows, 10'000);
+  }
+
   static constexpr const char* kCodegenEnabled = "driver.codegen.enabled";
   static constexpr const char* kCodegenConfigurationFilePath =
       "driver.codegen.configuration_file_path";
@@ -202,6 +308,102 @@ class QueryCtx : public Context {
   static constexpr const char* kExprEvalSimplified =
       "driver.expr_eval.simplified";
 
+  // Whether to collect CPU time and row counts per expression. These
+  // are reported by FilterProject as runtime stats prefixed with
+  // 'expr.<function name>.'. False by default.
+  static constexpr const char* kExprTrackStats = "driver.expr_eval.track_stats";
+
+  // If true, operators that support spilling write their state to disk
+  // instead of failing when running low on memory. False by default.
+  static constexpr const char* kSpillEnabled = "driver.spill_enabled";
+
+  // Directory for the spill files. "/tmp" by default.
+  static constexpr const char* kSpillPath = "driver.spill_path";
+
+  // Size in bytes of the sort buffer of an OrderBy after which it spills
+  // a sorted run to disk. 0 means only the memory limit of the query
+  // triggers spilling.
+  static constexpr const char* kOrderBySpillMemoryThreshold =
+      "driver.order_by_spill_memory_threshold";
+
+  // Size in bytes of the hash table of a final aggregation after which
+  // it spills its groups to disk. 0 means only the memory limit of the
+  // query triggers spilling.
+  static constexpr const char* kAggregationSpillMemoryThreshold =
+      "driver.aggregation_spill_memory_threshold";
+
+  // Size in bytes of the build side rows of a hash join in one Driver
+  // after which part of the build side is spilled to disk. Also limits
+  // the size of the hash table for a spilled partition before the
+  // partition is divided further. 0 means only the memory limit of the
+  // query triggers spilling.
+  static constexpr const char* kJoinSpillMemoryThreshold =
+      "driver.join_spill_memory_threshold";
+
+  // Maximum number of sorted runs read at the same time when merging
+  // spilled runs. More runs are first merged in groups into intermediate
+  // runs. 0 means no limit.
+  static constexpr const char* kSpillMaxMergeFanIn =
+      "driver.spill_max_merge_fan_in";
+
+  // Maximum number of bytes buffered for each source of a MergeExchange.
+  // The memory of a MergeExchange grows with the number of sources times
+  // this.
+  static constexpr const char* kMergeExchangeSourceBufferBytes =
+      "driver.merge_exchange_source_buffer_bytes";
+
+  // If true, an operator that is about to run out of memory first asks
+  // the process-wide MemoryArbitrator to reclaim memory from the
+  // operators of other Tasks before spilling its own state. False by
+  // default.
+  static constexpr const char* kMemoryArbitrationEnabled =
+      "driver.memory_arbitration_enabled";
+
+  // If true, the Drivers of a pipeline are made in parallel on the
+  // executor of the query when a Task starts.
+  static constexpr const char* kParallelDriverCreationEnabled =
+      "driver.parallel_driver_creation_enabled";
+
+  // The memory trackers of the Drivers of a Task and of their
+  // operators propagate their usage to the Task's tracker in
+  // multiples of this many bytes. 0 propagates every update.
+  static constexpr const char* kMemoryUsageUpdateBatchBytes =
+      "driver.memory_usage_update_batch_bytes";
+
+  // If true, the build side of an inner or semi hash join makes a Bloom
+  // filter for each integer or string join key. The probe side pushes
+  // these down into the table scan as dynamic filters when the keys
+  // have too many distinct values for an IN filter. False by default.
+  static constexpr const char* kHashJoinBloomFilterEnabled =
+      "driver.hash_join_bloom_filter_enabled";
+
+  // If true, the hash table of the build side of an inner, left, semi
+  // or anti join over a TableScan is shared with other queries through
+  // the process-wide HashTableCache. A query whose build side reads the
+  // same splits through the same plan then skips the build. False by
+  // default.
+  static constexpr const char* kHashTableCacheEnabled =
+      "driver.hash_table_cache_enabled";
+
+  // Compression of the pages a PartitionedOutput sends to the
+  // consumers. One of "none", "lz4" or "zstd". A page that does not
+  // compress well is sent uncompressed. "none" by default.
+  static constexpr const char* kExchangeCompression =
+      "driver.exchange_compression";
+
+  // Target size in bytes of the batches produced by TableScan,
+  // HashProbe, Unnest, Merge, OrderBy and Window. The number of rows
+  // is this over the row width the operator observes, so that
+  // expressions over a batch run in cache whatever the width of the
+  // rows. 1MB by default.
+  static constexpr const char* kPreferredOutputBatchBytes =
+      "driver.preferred_output_batch_bytes";
+
+  // Upper limit on the number of rows of the batches sized by
+  // kPreferredOutputBatchBytes. 10'000 by default.
+  static constexpr const char* kMaxOutputBatchRows =
+      "driver.max_output_batch_rows";
+
   // Flags used to configure the CAST operator:
 
   // This flag makes the Row conversion to by applied
@@ -221,6 +423,69 @@ class QueryCtx : public Context {
   static constexpr const char* kMaxPartialAggregationMemory =
       "max_partial_aggregation_memory";
 
+  // Maximum bytes an ExchangeClient has queued and requested from its
+  // sources. The request sizes adapt to the page sizes received from
+  // each source within this limit. 32MB by default.
+  static constexpr const char* kMaxExchangeClientBufferSize =
+      "driver.max_exchange_client_buffer_size";
+
+  // Number of input rows after which a partial aggregation checks
+  // whether it reduces the number of rows enough to keep its hash
+  // table. Counted from the last flush. 100'000 by default.
+  static constexpr const char* kAbandonPartialAggregationMinRows =
+      "driver.abandon_partial_aggregation_min_rows";
+
+  // A partial aggregation whose number of groups is at least this
+  // percentage of its input rows flushes its groups and passes the
+  // following input through as partial results without grouping. 80 by
+  // default. A value over 100 disables the pass-through.
+  static constexpr const char* kAbandonPartialAggregationMinPct =
+      "driver.abandon_partial_aggregation_min_pct";
+
+  // Priority of the Drivers of the query on an executor with priority
+  // classes. Positive is high, 0 is normal and negative is low. 0 by
+  // default.
+  static constexpr const char* kDriverPriority = "driver.priority";
+
+  // Maximum time in microseconds a Driver runs before it yields its
+  // thread and goes to the back of the queue. 0, the default, means no
+  // limit.
+  static constexpr const char* kDriverTimeSliceMicros =
+      "driver.time_slice_micros";
+
+  // Maximum number of batches a Driver passes between its operators
+  // before it yields its thread. 0, the default, means no limit.
+  static constexpr const char* kDriverTimeSliceBatches =
+      "driver.time_slice_batches";
+
+  // If true, the Drivers of a final aggregation with grouping keys
+  // share one hash table partitioned on the keys instead of each
+  // having its own. The input then does not need to be repartitioned
+  // on the keys by a local exchange. false by default.
+  static constexpr const char* kSharedFinalAggregation =
+      "driver.shared_final_aggregation";
+
+  // Number of splits a TableScan fetches ahead of the one it is
+  // processing and prepares in the background, i.e. opens the file
+  // and reads the metadata. 0 disables preloading. 2 by default.
+  static constexpr const char* kMaxSplitPreloadPerDriver =
+      "driver.max_split_preload_per_driver";
+
+  // If true, a partial aggregation over a scan of files keeps its
+  // result for each split in the AsyncDataCache. A later query with
+  // the same plan fragment takes the result from the cache instead of
+  // reading the split. Splits must give the file modification time to
+  // be cached. false by default.
+  static constexpr const char* kFragmentResultCacheEnabled =
+      "driver.fragment_result_cache_enabled";
+
+  // If non-0, a Task records the run, yield and blocked times of its
+  // Drivers, cache accesses and exchange fetches in ring buffers of this
+  // many events per thread. See Task::toChromeTrace(). 0, the default,
+  // disables tracing.
+  static constexpr const char* kTraceEventsPerThread =
+      "driver.trace_events_per_thread";
+
   // Overrides the previous configuration. Note that this function is NOT
   // thread-safe and should probably only be used in tests.
   void setConfigOverridesUnsafe(
@@ -249,6 +514,10 @@ class QueryCtx : public Context {
 
   static constexpr uint64_t kMaxLocalExchangeBufferSizeDefault = 32UL << 20;
 
+  static constexpr uint64_t kMaxExchangeClientBufferSizeDefault = 32UL << 20;
+
+  static constexpr const char* kSpillPathDefault = "/tmp";
+
   // 16MB
   static constexpr uint64_t kMaxPartialAggregationMemoryDefault = 1L << 24;
 
@@ -306,6 +575,24 @@ class ExecCtx : public Context {
     decodedVectorPool_.push_back(std::move(vector));
   }
 
+  /// Returns an arena for scratch memory of functions, e.g. temporary
+  /// arrays of a batch. The arena is cleared when an ExprSet starts
+  /// evaluating a new batch, so the memory must not be referenced from
+  /// results. Made on first use.
+  Arena& arena() {
+    if (!arena_) {
+      arena_ = std::make_unique<Arena>();
+    }
+    return *arena_;
+  }
+
+  /// Clears the arena, if any, for reuse by the next batch.
+  void clearArena() {
+    if (arena_) {
+      arena_->clear();
+    }
+  }
+
  private:
   // Pool for all Buffers for this thread
   memory::MemoryPool* pool_;
@@ -315,6 +602,8 @@ class ExecCtx : public Context {
   // A pool of preallocated SelectivityVectors for use by expressions
   // and operators.
   std::vector<std::unique_ptr<SelectivityVector>> selectivityVectorPool_;
+  // Scratch memory for expression evaluation.
+  std::unique_ptr<Arena> arena_;
 };
 
 } // namespace facebook::velox::core
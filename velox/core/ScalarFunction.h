@@ -65,6 +65,17 @@ struct udf_is_deterministic<
     util::detail::void_t<decltype(T::is_deterministic)>>
     : std::integral_constant<bool, T::is_deterministic> {};
 
+// Index of the argument whose string buffers the result of the UDF may refer
+// to, see UDFOutputString::setNoCopy(). -1 if the result is always copied.
+template <class T, class = void>
+struct udf_reuse_strings_from_arg : std::integral_constant<int32_t, -1> {};
+
+template <class T>
+struct udf_reuse_strings_from_arg<
+    T,
+    util::detail::void_t<decltype(T::reuse_strings_from_arg)>>
+    : std::integral_constant<int32_t, T::reuse_strings_from_arg> {};
+
 KOKSI_MEMBER_CHECKER(udf_has_call, &T::call)
 KOKSI_MEMBER_CHECKER(udf_has_callNullable, &T::callNullable)
 
@@ -223,6 +234,8 @@ class UDFHolder final
       "UDF must implement at least one of `call` or `callNullable`");
   static constexpr bool is_default_null_behavior =
       !udf_has_callNullable<Fun>::value;
+  static constexpr int32_t reuse_strings_from_arg =
+      udf_reuse_strings_from_arg<Fun>::value;
 
   using Metadata = core::ScalarFunctionMetadata<Fun, TReturn, TArgs...>;
 
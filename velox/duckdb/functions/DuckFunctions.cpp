@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 #include "velox/duckdb/functions/DuckFunctions.h"
+
+#include <map>
+#include <mutex>
+
 #include <boost/algorithm/string.hpp>
 #include "velox/duckdb/conversion/DuckConversion.h"
 #include "velox/external/duckdb/duckdb.hpp"
@@ -84,6 +88,12 @@ using exec::Expr;
       throw std::runtime_error("Unsupported DuckDB type: " + type.ToString()); \
   }
 
+// StringView and string_t have the same layout and both inline strings of up
+// to 12 bytes. Strings are referenced in place like the numeric types.
+static_assert(sizeof(StringView) == sizeof(string_t));
+static_assert(StringView::kInlineSize == string_t::INLINE_LENGTH);
+static_assert(StringView::kPrefixSize == string_t::PREFIX_LENGTH);
+
 template <class T>
 static void veloxFlatVectorToDuckTemplated(
     VectorPtr input,
@@ -95,31 +105,6 @@ static void veloxFlatVectorToDuckTemplated(
   ::duckdb::FlatVector::SetData(result, valuePtr + sizeof(T) * offset);
 }
 
-template <>
-void veloxFlatVectorToDuckTemplated<StringView>(
-    VectorPtr arg,
-    size_t offset,
-    size_t count,
-    Vector& result) {
-  // string type needs to be converted
-  // it is almost the same, but because DuckDB is null-terminated the length of
-  // inlined strings is off-by-one we can almost do zero copy but this breaks on
-  // strings of length exactly 12, because velox considers these inlined, but
-  // DuckDB considers them not inlined
-  // this can be fixed in the future (see DuckDB issue #1036)
-  auto resultVarchar = ::duckdb::FlatVector::GetData<string_t>(result);
-  auto veloxVarchar = (StringView*)arg->as<FlatVector<StringView>>()
-                          ->values()
-                          ->as<StringView>();
-  auto& duckdbValidity = ::duckdb::FlatVector::Validity(result);
-  for (size_t i = 0; i < count; i++) {
-    if (duckdbValidity.RowIsValid(i)) {
-      resultVarchar[i] =
-          DuckStringConversion::toDuck(veloxVarchar[offset + i], result);
-    }
-  }
-}
-
 template <>
 void veloxFlatVectorToDuckTemplated<Timestamp>(
     VectorPtr arg,
@@ -287,7 +272,19 @@ void veloxDecodedVectorToDuckTemplated<StringView>(
     size_t offset,
     size_t count,
     Vector& result) {
-  // string type needs to be converted, see veloxFlatVectorToDuckTemplated
+  if (!arg.nulls()) {
+    // The strings are referenced in place, see veloxFlatVectorToDuckTemplated.
+    auto valuePtr = (data_ptr_t)arg.data<StringView>();
+    ::duckdb::FlatVector::SetData(result, valuePtr);
+    auto indices = arg.indices();
+    ::duckdb::SelectionVector sel(STANDARD_VECTOR_SIZE);
+    for (idx_t i = 0; i < count; i++) {
+      sel.set_index(i, indices[offset + i]);
+    }
+    result.Slice(sel, count);
+    return;
+  }
+  // The values under nulls may not be valid strings. Copies the others.
   veloxDecodedVectorConversion<StringView, string_t, DuckStringConversion>(
       arg, offset, count, result);
 }
@@ -412,6 +409,13 @@ class DuckDBFunction : public exec::VectorFunction {
 
  private:
   mutable std::vector<ScalarFunction> set_;
+  // Bound states that are not in use by argument types. A state is bound
+  // and its chunks are allocated once per concurrent caller, not per call.
+  mutable std::mutex mutex_;
+  mutable std::map<
+      std::vector<TypeKind>,
+      std::vector<std::unique_ptr<DuckDBFunctionData>>>
+      freeStates_;
 
  public:
   void apply(
@@ -420,12 +424,12 @@ class DuckDBFunction : public exec::VectorFunction {
       Expr* /* unused */,
       EvalCtx* context,
       VectorPtr* result) const override {
-    // FIXME: this binding does not need to be performed on every function call
-    std::vector<LogicalType> inputTypes;
+    std::vector<TypeKind> argKinds;
+    argKinds.reserve(args.size());
     for (auto& arg : args) {
-      inputTypes.push_back(fromVeloxType(arg->typeKind()));
+      argKinds.push_back(arg->typeKind());
     }
-    auto state = initializeState(move(inputTypes));
+    auto state = acquireState(argKinds);
     assert(state->functionIndex < set_.size());
     auto& function = set_[state->functionIndex];
     idx_t nrow = rows.size();
@@ -439,8 +443,9 @@ class DuckDBFunction : public exec::VectorFunction {
       // convert arguments to duck arguments
       toDuck(rows, args, offset, *state->castChunk, *state->input);
       // run the function
-      callFunction(function, *state, offset, *result);
+      callFunction(function, *state, args, offset, *result);
     }
+    releaseState(argKinds, std::move(state));
   }
 
   template <class T>
@@ -525,9 +530,110 @@ class DuckDBFunction : public exec::VectorFunction {
     }
   }
 
+  // Releases the DuckDB vector buffer that the view is over with the
+  // view.
+  struct DuckBufferReleaser {
+    explicit DuckBufferReleaser(
+        ::duckdb::buffer_ptr<::duckdb::VectorBuffer> buffer)
+        : buffer(std::move(buffer)) {}
+
+    void addRef() const {}
+
+    void release() const {}
+
+    const ::duckdb::buffer_ptr<::duckdb::VectorBuffer> buffer;
+  };
+
+  // Adds the string heaps that the strings of 'resultVector' may point to to
+  // the string buffers of 'result'. These are the heap of 'resultVector',
+  // the heaps of the converted inputs and the string buffers of 'args'.
+  static void keepStringsAlive(
+      Vector& resultVector,
+      DuckDBFunctionData& state,
+      const std::vector<VectorPtr>& args,
+      FlatVector<StringView>& result) {
+    auto addHeap = [&](Vector& vector) {
+      if (auto heap = vector.GetAuxiliary()) {
+        // Empty so that no strings are appended to it.
+        result.stringBuffers().push_back(
+            BufferView<DuckBufferReleaser>::create(
+                nullptr, 0, DuckBufferReleaser(std::move(heap))));
+      }
+    };
+    addHeap(resultVector);
+    for (size_t i = 0; i < args.size(); ++i) {
+      addHeap(state.input->data[i]);
+      addHeap(state.castChunk->data[i]);
+      if (args[i]->typeKind() == TypeKind::VARCHAR ||
+          args[i]->typeKind() == TypeKind::VARBINARY) {
+        result.acquireSharedStringBuffers(args[i].get());
+      }
+    }
+  }
+
+  void callFunctionString(
+      ScalarFunction& function,
+      DuckDBFunctionData& state,
+      const std::vector<VectorPtr>& args,
+      size_t offset,
+      VectorPtr result) const {
+    Vector resultVector(function.return_type);
+    function.function(*state.input, state.state, resultVector);
+    auto flatResult = result->asFlatVector<StringView>();
+    switch (resultVector.GetVectorType()) {
+      case VectorType::FLAT_VECTOR: {
+        // The strings are referenced in place, see
+        // veloxFlatVectorToDuckTemplated.
+        auto resultData = reinterpret_cast<const StringView*>(
+            ::duckdb::FlatVector::GetData<string_t>(resultVector));
+        auto& resultMask = ::duckdb::FlatVector::Validity(resultVector);
+        auto veloxData = flatResult->mutableRawValues();
+        for (auto i = 0; i < state.input->size(); i++) {
+          auto veloxIndex = offset + i;
+          if (resultMask.RowIsValid(i)) {
+            veloxData[veloxIndex] = resultData[i];
+            if (flatResult->rawNulls()) {
+              flatResult->setNull(veloxIndex, false);
+            }
+          } else {
+            veloxData[veloxIndex] = StringView();
+          }
+        }
+        keepStringsAlive(resultVector, state, args, *flatResult);
+        break;
+      }
+      case VectorType::CONSTANT_VECTOR: {
+        if (::duckdb::ConstantVector::IsNull(resultVector)) {
+          for (auto i = 0; i < state.input->size(); i++) {
+            auto veloxIndex = offset + i;
+            result->setNull(veloxIndex, true);
+          }
+        } else {
+          // Copies the value once and references the copy from the other
+          // rows.
+          auto resultData =
+              ::duckdb::ConstantVector::GetData<string_t>(resultVector);
+          flatResult->set(offset, DuckStringConversion::toVelox(*resultData));
+          auto veloxData = flatResult->mutableRawValues();
+          for (auto i = 1; i < state.input->size(); i++) {
+            auto veloxIndex = offset + i;
+            veloxData[veloxIndex] = veloxData[offset];
+            if (flatResult->rawNulls()) {
+              flatResult->setNull(veloxIndex, false);
+            }
+          }
+        }
+        break;
+      }
+      default:
+        throw std::runtime_error("unexpected vector type");
+    }
+  }
+
   void callFunction(
       ScalarFunction& function,
       DuckDBFunctionData& state,
+      const std::vector<VectorPtr>& args,
       size_t offset,
       VectorPtr result) const {
     switch (function.return_type.id()) {
@@ -557,8 +663,7 @@ class DuckDBFunction : public exec::VectorFunction {
             function, state, offset, result);
         break;
       case LogicalTypeId::VARCHAR:
-        callFunctionConversion<string_t, StringView, DuckStringConversion>(
-            function, state, offset, result);
+        callFunctionString(function, state, args, offset, result);
         break;
       default:
         break;
@@ -572,6 +677,35 @@ class DuckDBFunction : public exec::VectorFunction {
   }
 
  private:
+  std::unique_ptr<DuckDBFunctionData> acquireState(
+      const std::vector<TypeKind>& argKinds) const {
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      auto it = freeStates_.find(argKinds);
+      if (it != freeStates_.end() && !it->second.empty()) {
+        auto state = std::move(it->second.back());
+        it->second.pop_back();
+        return state;
+      }
+    }
+    std::vector<LogicalType> inputTypes;
+    inputTypes.reserve(argKinds.size());
+    for (auto kind : argKinds) {
+      inputTypes.push_back(fromVeloxType(kind));
+    }
+    return initializeState(move(inputTypes));
+  }
+
+  void releaseState(
+      const std::vector<TypeKind>& argKinds,
+      std::unique_ptr<DuckDBFunctionData> state) const {
+    // Drops the references to the arguments of the call.
+    state->input->Reset();
+    state->castChunk->Reset();
+    std::lock_guard<std::mutex> l(mutex_);
+    freeStates_[argKinds].push_back(std::move(state));
+  }
+
   std::unique_ptr<DuckDBFunctionData> initializeState(
       std::vector<LogicalType> inputTypes) const {
     assert(set_.size() > 0);
@@ -594,6 +594,38 @@ TEST_F(BaseDuckTest, concat) {
       VARCHAR(), VARCHAR(), "duckdb_concat(c0, c1)", input1, input2, output);
 }
 
+TEST_F(BaseDuckTest, inlineSizeStrings) {
+  // Strings of up to 12 bytes are inlined in both Velox and DuckDB.
+  std::vector<StringView> input{
+      StringView("abcdefghijk"),
+      StringView("abcdefghijkl"),
+      StringView("abcdefghijklm")};
+  std::vector<StringView> output{
+      StringView("kjihgfedcba"),
+      StringView("lkjihgfedcba"),
+      StringView("mlkjihgfedcba")};
+  runDuckTest<StringView, StringView>(
+      VARCHAR(), "duckdb_reverse(c0)", input, output);
+}
+
+TEST_F(BaseDuckTest, longStringsManyBatches) {
+  // The results of the first batches point to DuckDB string heaps that
+  // must survive the later batches.
+  static constexpr int kSize = 3000;
+  std::vector<std::string> inputStrings, outputStrings;
+  for (auto i = 0; i < kSize; i++) {
+    inputStrings.push_back(fmt::format("a rather long string {}", i));
+    outputStrings.push_back(fmt::format("A RATHER LONG STRING {}", i));
+  }
+  std::vector<StringView> input, output;
+  for (auto i = 0; i < kSize; i++) {
+    input.push_back(StringView(inputStrings[i]));
+    output.push_back(StringView(outputStrings[i]));
+  }
+  runDuckTest<StringView, StringView>(
+      VARCHAR(), "duckdb_ucase(c0)", input, output);
+}
+
 TEST_F(BaseDuckTest, stringMix) {
   std::vector<StringView> input{
       StringView("hello"),
@@ -48,7 +48,11 @@ namespace common {
 folly::SemiFuture<uint64_t> InputStream::readAsync(
     const std::vector<folly::Range<char*>>& buffers,
     uint64_t offset,
-    common::LogType logType) {
+    common::LogType logType,
+    const folly::CancellationToken& cancellationToken) {
+  if (cancellationToken.isCancellationRequested()) {
+    return folly::makeSemiFuture<uint64_t>(folly::OperationCancelled());
+  }
   try {
     read(buffers, offset, logType);
     uint64_t size = 0;
@@ -208,13 +212,14 @@ void ReadFileInputStream::read(
 folly::SemiFuture<uint64_t> ReadFileInputStream::readAsync(
     const std::vector<folly::Range<char*>>& buffers,
     uint64_t offset,
-    common::LogType logType) {
+    common::LogType logType,
+    const folly::CancellationToken& cancellationToken) {
   int64_t bufferSize = 0;
   for (auto& buffer : buffers) {
     bufferSize += buffer.size();
   }
   logRead(offset, bufferSize, logType);
-  return readFile_->preadvAsync(offset, buffers);
+  return readFile_->preadvAsync(offset, buffers, cancellationToken);
 }
 
 bool ReadFileInputStream::hasReadAsync() const {
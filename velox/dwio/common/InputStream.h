@@ -116,11 +116,14 @@ class InputStream {
   }
 
   /// Like read() with the same arguments but returns the result or
-  /// exception via SemiFuture. Use only if hasReadAsync() is true.
+  /// exception via SemiFuture. Use only if hasReadAsync() is true. IO
+  /// that has not started when 'cancellationToken' is cancelled is
+  /// not issued.
   virtual folly::SemiFuture<uint64_t> readAsync(
       const std::vector<folly::Range<char*>>& buffers,
       uint64_t offset,
-      common::LogType logType);
+      common::LogType logType,
+      const folly::CancellationToken& cancellationToken = {});
 
   /// Returns true if readAsync has a native implementation that is
   /// asynchronous.
@@ -215,7 +218,8 @@ class ReadFileInputStream final : public InputStream {
   folly::SemiFuture<uint64_t> readAsync(
       const std::vector<folly::Range<char*>>& buffers,
       uint64_t offset,
-      common::LogType logType) override;
+      common::LogType logType,
+      const folly::CancellationToken& cancellationToken = {}) override;
 
   bool hasReadAsync() const override;
 
@@ -16,6 +16,9 @@
 
 #include "velox/dwio/common/IoStatistics.h"
 #include <glog/logging.h>
+#include "velox/common/base/Counters.h"
+#include "velox/common/base/StatsReporter.h"
+#include <algorithm>
 #include <atomic>
 #include <utility>
 
@@ -88,6 +91,74 @@ IoStatistics::operationStats() const {
   return operationStats_;
 }
 
+void IoStatistics::merge(const IoStatistics& other) {
+  rawBytesRead_ += other.rawBytesRead();
+  rawBytesWritten_ += other.rawBytesWritten();
+  inputBatchSize_ += other.inputBatchSize();
+  outputBatchSize_ += other.outputBatchSize();
+  rawOverreadBytes_ += other.rawOverreadBytes();
+  prefetch_.merge(other.prefetch_);
+  read_.merge(other.read_);
+  ramHit_.merge(other.ramHit_);
+  ssdRead_.merge(other.ssdRead_);
+  auto otherOperationStats = other.operationStats();
+  std::lock_guard<std::mutex> lock{operationStatsMutex_};
+  for (auto& [operation, counters] : otherOperationStats) {
+    auto& stats = operationStats_[operation];
+    stats.resourceThrottleCount += counters.resourceThrottleCount;
+    stats.localThrottleCount += counters.localThrottleCount;
+    stats.globalThrottleCount += counters.globalThrottleCount;
+    stats.retryCount += counters.retryCount;
+    stats.latencyInMs += counters.latencyInMs;
+    stats.requestCount += counters.requestCount;
+    stats.delayInjectedInSecs += counters.delayInjectedInSecs;
+  }
+}
+
+namespace {
+// Weight of past reads relative to the next one. Makes the model
+// follow changes in load over a few hundred reads.
+constexpr double kReadDecay = 0.99;
+// Minimum number of reads before there is a model.
+constexpr double kMinReadWeight = 8;
+} // namespace
+
+void IoStatistics::recordStorageRead(uint64_t bytes, uint64_t micros) {
+  REPORT_ADD_STAT_VALUE(kCounterStorageReadBytes, bytes);
+  REPORT_ADD_HISTOGRAM_VALUE(kCounterStorageReadLatencyUs, micros);
+  double x = bytes;
+  double y = micros;
+  std::lock_guard<std::mutex> l(storageReadMutex_);
+  readWeight_ = readWeight_ * kReadDecay + 1;
+  sumBytes_ = sumBytes_ * kReadDecay + x;
+  sumMicros_ = sumMicros_ * kReadDecay + y;
+  sumBytesSquared_ = sumBytesSquared_ * kReadDecay + x * x;
+  sumBytesMicros_ = sumBytesMicros_ * kReadDecay + x * y;
+}
+
+std::optional<StorageReadModel> IoStatistics::storageReadModel() const {
+  std::lock_guard<std::mutex> l(storageReadMutex_);
+  if (readWeight_ < kMinReadWeight) {
+    return std::nullopt;
+  }
+  auto meanBytes = sumBytes_ / readWeight_;
+  auto meanMicros = sumMicros_ / readWeight_;
+  auto varianceBytes = sumBytesSquared_ / readWeight_ - meanBytes * meanBytes;
+  // Reads of about the same size do not tell latency from throughput.
+  if (varianceBytes <= meanBytes * meanBytes * 0.01) {
+    return std::nullopt;
+  }
+  auto covariance = sumBytesMicros_ / readWeight_ - meanBytes * meanMicros;
+  auto microsPerByte = covariance / varianceBytes;
+  if (microsPerByte <= 0) {
+    return std::nullopt;
+  }
+  StorageReadModel model;
+  model.bytesPerUs = 1 / microsPerByte;
+  model.latencyUs = std::max(0.0, meanMicros - microsPerByte * meanBytes);
+  return model;
+}
+
 } // namespace common
 } // namespace dwio
 } // namespace velox
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 
@@ -52,11 +53,25 @@ class IoCounter {
     bytes_ += bytes;
   }
 
+  void merge(const IoCounter& other) {
+    count_ += other.count_;
+    bytes_ += other.bytes_;
+  }
+
  private:
   std::atomic<uint64_t> count_{0};
   std::atomic<uint64_t> bytes_{0};
 };
 
+// Cost model of a read from storage: a read of n bytes is estimated
+// to take latencyUs + n / bytesPerUs microseconds.
+struct StorageReadModel {
+  // Fixed cost of a request, e.g. time to first byte.
+  double latencyUs{0};
+  // Transfer rate once the data is flowing.
+  double bytesPerUs{0};
+};
+
 class IoStatistics {
  public:
   uint64_t rawBytesRead() const;
@@ -98,6 +113,19 @@ class IoStatistics {
 
   std::unordered_map<std::string, OperationCounters> operationStats() const;
 
+  // Adds the counters of 'other' to 'this'. The storage read model of
+  // 'this' is not changed.
+  void merge(const IoStatistics& other);
+
+  // Records a read of 'bytes' from storage that took 'micros'.
+  void recordStorageRead(uint64_t bytes, uint64_t micros);
+
+  // Returns the latency and throughput of storage fitted to the reads
+  // recorded with recordStorageRead(), weighted towards the recent
+  // ones. Returns std::nullopt until there are reads of enough
+  // different sizes to separate the two.
+  std::optional<StorageReadModel> storageReadModel() const;
+
  private:
   std::atomic<uint64_t> rawBytesRead_{0};
   std::atomic<uint64_t> rawBytesWritten_{0};
@@ -120,6 +148,15 @@ class IoStatistics {
 
   std::unordered_map<std::string, OperationCounters> operationStats_;
   mutable std::mutex operationStatsMutex_;
+
+  // Exponentially decayed sums for a least squares fit of read time
+  // over read size. Serialized by 'storageReadMutex_'.
+  double readWeight_{0};
+  double sumBytes_{0};
+  double sumMicros_{0};
+  double sumBytesSquared_{0};
+  double sumBytesMicros_{0};
+  mutable std::mutex storageReadMutex_;
 };
 
 } // namespace common
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <folly/Executor.h>
 #include <limits>
 #include <unordered_set>
 
@@ -91,10 +92,12 @@ class RowReaderOptions {
   bool preloadStripe;
   bool projectSelectedType;
   bool returnFlatVector_ = false;
+  bool returnSequenceVector_ = false;
   ErrorTolerance errorTolerance_;
   std::shared_ptr<ColumnSelector> selector_;
   velox::dwrf::ColumnReaderFactory* columnReaderFactory_ = nullptr;
   std::unordered_set<uint32_t> flatmapNodeIdAsStruct_;
+  folly::Executor* decodingExecutor_ = nullptr;
 
  public:
   RowReaderOptions(const RowReaderOptions& other) {
@@ -106,7 +109,9 @@ class RowReaderOptions {
     selector_ = other.selector_;
     columnReaderFactory_ = other.columnReaderFactory_;
     returnFlatVector_ = other.returnFlatVector_;
+    returnSequenceVector_ = other.returnSequenceVector_;
     flatmapNodeIdAsStruct_ = other.flatmapNodeIdAsStruct_;
+    decodingExecutor_ = other.decodingExecutor_;
   }
 
   RowReaderOptions() noexcept
@@ -197,6 +202,18 @@ class RowReaderOptions {
     returnFlatVector_ = value;
   }
 
+  // For integer columns, return batches with long runs of equal values as
+  // SequenceVector instead of flat vectors
+  bool getReturnSequenceVector() const {
+    return returnSequenceVector_;
+  }
+
+  // For integer columns, request that batches without nulls whose average
+  // run length is long enough are returned as SequenceVector
+  void setReturnSequenceVector(bool value) {
+    returnSequenceVector_ = value;
+  }
+
   /**
    * Request that the selected type be projected.
    */
@@ -241,6 +258,18 @@ class RowReaderOptions {
   const std::unordered_set<uint32_t>& getMapColumnIdAsStruct() const {
     return flatmapNodeIdAsStruct_;
   }
+
+  // Sets the executor on which the selective struct reader decodes the
+  // columns without filters in parallel after the filters have
+  // selected the rows. nullptr decodes all columns on the calling
+  // thread.
+  void setDecodingExecutor(folly::Executor* executor) {
+    decodingExecutor_ = executor;
+  }
+
+  folly::Executor* getDecodingExecutor() const {
+    return decodingExecutor_;
+  }
 };
 
 /**
@@ -286,6 +315,9 @@ struct DataCacheConfig {
   velox::DataCache* cache{nullptr};
   // We identify the file the data belongs to by an id from StringIdMap.
   uint64_t filenum;
+  // Modification time of the file, 0 if not known. Parsed metadata of
+  // the file is cached across readers only if this is known.
+  int64_t modificationTime{0};
 };
 
 /**
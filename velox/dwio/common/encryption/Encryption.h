@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "folly/Range.h"
 #include "folly/io/IOBuf.h"
 #include "velox/dwio/common/exception/Exception.h"
@@ -89,6 +91,19 @@ class Decrypter {
   virtual std::unique_ptr<folly::IOBuf> decrypt(
       folly::StringPiece input) const = 0;
 
+  // Decrypts 'input' into 'output' and returns the decrypted size.
+  // 'output' has space for input.size() bytes, which suffices for
+  // ciphers that do not expand on decryption, e.g. AES-CTR or AES-GCM
+  // with IV and tag in the input. Lets callers reuse one buffer for
+  // all chunks instead of allocating an IOBuf per call. Returns
+  // std::nullopt if not supported, in which case callers use
+  // decrypt().
+  virtual std::optional<size_t> decryptInto(
+      folly::StringPiece /*input*/,
+      char* /*output*/) const {
+    return std::nullopt;
+  }
+
   virtual std::unique_ptr<Decrypter> clone() const = 0;
 };
 
@@ -52,6 +52,13 @@ class TestEncryption {
     return folly::IOBuf::copyBuffer(decoded);
   }
 
+  size_t decryptInto(folly::StringPiece input, char* output) const {
+    auto decrypted = decrypt(input);
+    DWIO_ENSURE_LE(decrypted->length(), input.size());
+    memcpy(output, decrypted->data(), decrypted->length());
+    return decrypted->length();
+  }
+
   size_t getCount() const {
     return count_;
   }
@@ -81,6 +88,11 @@ class TestEncrypter : public TestEncryption, public Encrypter {
 
 class TestDecrypter : public TestEncryption, public Decrypter {
  public:
+  // If 'decryptInto' is false, decryptInto() is unsupported, so
+  // that callers fall back to decrypt().
+  explicit TestDecrypter(bool decryptInto = true)
+      : decryptInto_{decryptInto} {}
+
   void setKey(const std::string& key) override {
     TestEncryption::setKey(key);
   }
@@ -94,11 +106,22 @@ class TestDecrypter : public TestEncryption, public Decrypter {
     return TestEncryption::decrypt(input);
   }
 
+  std::optional<size_t> decryptInto(folly::StringPiece input, char* output)
+      const override {
+    if (!decryptInto_) {
+      return std::nullopt;
+    }
+    return TestEncryption::decryptInto(input, output);
+  }
+
   std::unique_ptr<Decrypter> clone() const override {
-    auto decrypter = std::make_unique<TestDecrypter>();
+    auto decrypter = std::make_unique<TestDecrypter>(decryptInto_);
     decrypter->setKey(getKey());
     return decrypter;
   }
+
+ private:
+  const bool decryptInto_;
 };
 
 class TestEncryptionProperties : public EncryptionProperties {
@@ -52,6 +52,19 @@ class BufferedInput {
       dwio::common::Region region,
       const StreamIdentifier* si = nullptr);
 
+  // Returns a stream over the decompressed content of 'region' if
+  // this caches decompressed data for 'si', else nullptr, in which
+  // case the caller enqueues 'region' and decompresses it itself.
+  // 'decompress' makes a decompressing stream over a stream of the
+  // compressed data.
+  virtual std::unique_ptr<SeekableInputStream> enqueueDecompressed(
+      dwio::common::Region /*region*/,
+      const StreamIdentifier* /*si*/,
+      const std::function<std::unique_ptr<SeekableInputStream>(
+          std::unique_ptr<SeekableInputStream>)>& /*decompress*/) {
+    return nullptr;
+  }
+
   // load all regions to be read in an optimized way (IO efficiency)
   virtual void load(const dwio::common::LogType);
 
@@ -89,6 +102,10 @@ class BufferedInput {
   }
 
  protected:
+  memory::MemoryPool& pool() const {
+    return pool_;
+  }
+
   dwio::common::InputStream& input_;
 
  private:
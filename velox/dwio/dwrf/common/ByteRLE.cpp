@@ -408,24 +408,19 @@ void ByteRleDecoder::next(
     uint64_t consumed = 0;
     if (repeating) {
       if (nulls) {
-        for (uint64_t i = 0; i < count; ++i) {
-          if (!bits::isBitNull(nulls, position + i)) {
-            data[position + i] = value;
-            consumed += 1;
-          }
-        }
+        // The positions of nulls may be set to any value.
+        memset(data + position, value, count);
+        consumed = bits::countNonNulls(nulls, position, position + count);
       } else {
         memset(data + position, value, count);
         consumed = count;
       }
     } else {
       if (nulls) {
-        for (uint64_t i = 0; i < count; ++i) {
-          if (!bits::isBitNull(nulls, position + i)) {
-            data[position + i] = readByte();
-            consumed += 1;
-          }
-        }
+        bits::forEachSetBit(nulls, position, position + count, [&](auto row) {
+          data[row] = readByte();
+          ++consumed;
+        });
       } else {
         uint64_t i = 0;
         while (i < count) {
@@ -16,6 +16,7 @@
 
 #include "velox/dwio/dwrf/common/CacheInputStream.h"
 #include <folly/executors/QueuedImmediateExecutor.h>
+#include "velox/common/caching/SsdCache.h"
 
 namespace facebook::velox::dwrf {
 
@@ -31,7 +32,8 @@ CacheInputStream::CacheInputStream(
     uint64_t fileNum,
     std::shared_ptr<ScanTracker> tracker,
     TrackingId trackingId,
-    uint64_t groupId)
+    uint64_t groupId,
+    cache::CacheRetention retention)
     : cache_(cache),
       ioStats_(ioStats),
       input_(input),
@@ -39,7 +41,8 @@ CacheInputStream::CacheInputStream(
       fileNum_(fileNum),
       tracker_(std::move(tracker)),
       trackingId_(trackingId),
-      groupId_(groupId) {}
+      groupId_(groupId),
+      retention_(retention) {}
 
 bool CacheInputStream::Next(const void** buffer, int32_t* size) {
   if (position_ >= region_.length) {
@@ -137,10 +140,20 @@ void CacheInputStream::loadSync(dwio::common::Region region) {
       continue;
     }
     if (pin_.entry()->isExclusive()) {
-      auto ranges = makeRanges(pin_.entry(), region.length);
-      input_.read(ranges, region.offset, dwio::common::LogType::FILE);
-      ioStats_->read().increment(region.length);
-      pin_.entry()->setValid(true);
+      auto* entry = pin_.entry();
+      if (retention_ != cache::CacheRetention::kNormal) {
+        entry->setRetention(retention_);
+      }
+      if (!loadFromSsd(region, entry)) {
+        auto ranges = makeRanges(entry, region.length);
+        input_.read(ranges, region.offset, dwio::common::LogType::FILE);
+        ioStats_->read().increment(region.length);
+        entry->setSsdSaveable(
+            cache_->ssdCache() &&
+            (!tracker_ || trackingId_.empty() ||
+             tracker_->shouldSaveToSsd(trackingId_)));
+      }
+      entry->setValid(true);
       pin_.entry()->setExclusiveToShared();
     } else {
       if (pin_.entry()->dataValid()) {
@@ -154,6 +167,24 @@ void CacheInputStream::loadSync(dwio::common::Region region) {
   } while (pin_.empty());
 }
 
+bool CacheInputStream::loadFromSsd(
+    dwio::common::Region region,
+    cache::AsyncDataCacheEntry* entry) {
+  auto* ssdCache = cache_->ssdCache();
+  if (!ssdCache) {
+    return false;
+  }
+  auto& file = ssdCache->file(fileNum_);
+  auto run = file.find(cache::RawFileCacheKey{fileNum_, region.offset});
+  if (!run.has_value() || run->size != region.length ||
+      !file.read(run.value(), entry)) {
+    return false;
+  }
+  entry->setSsdFile(&file, run->offset);
+  ioStats_->ssdRead().increment(region.length);
+  return true;
+}
+
 void CacheInputStream::loadPosition() {
   auto offset = region_.offset;
   if (pin_.empty()) {
@@ -48,7 +48,8 @@ class CacheInputStream : public SeekableInputStream {
       uint64_t fileNum,
       std::shared_ptr<cache::ScanTracker> tracker,
       cache::TrackingId trackingId,
-      uint64_t groupId);
+      uint64_t groupId,
+      cache::CacheRetention retention = cache::CacheRetention::kNormal);
 
   bool Next(const void** data, int* size) override;
   void BackUp(int count) override;
@@ -62,6 +63,12 @@ class CacheInputStream : public SeekableInputStream {
  private:
   void loadPosition();
   void loadSync(dwio::common::Region region);
+
+  // Reads 'region' into 'entry' from the SSD cache. Returns false if
+  // 'region' is not on SSD.
+  bool loadFromSsd(
+      dwio::common::Region region,
+      cache::AsyncDataCacheEntry* entry);
   cache::AsyncDataCache* const cache_;
   dwio::common::IoStatistics* ioStats_;
   dwio::common::InputStream& input_;
@@ -71,6 +78,8 @@ class CacheInputStream : public SeekableInputStream {
   std::shared_ptr<cache::ScanTracker> tracker_;
   const cache::TrackingId trackingId_;
   const uint64_t groupId_;
+  // Retention hint for the entries loaded by 'this'.
+  const cache::CacheRetention retention_;
 
   // Maximum number of bytes read from 'input' at a time. This gives the maximum
   // pin_.entry()->size().
@@ -15,7 +15,17 @@
  */
 
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
+#include <gflags/gflags.h>
+#include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+#include "velox/common/time/Timer.h"
 #include "velox/dwio/dwrf/common/CacheInputStream.h"
+#include "velox/dwio/dwrf/common/DecompressedCacheStream.h"
+
+DEFINE_bool(
+    velox_dwrf_cache_decompressed,
+    false,
+    "Keep decompressed data of frequently read streams in memory cache");
 
 namespace facebook::velox::dwrf {
 
@@ -42,7 +52,61 @@ std::unique_ptr<SeekableInputStream> CachedBufferedInput::enqueue(
       RawFileCacheKey{fileNum_, region.offset}, region.length, id, CachePin()});
   tracker_->recordReference(id, region.length, groupId_);
   return std::make_unique<CacheInputStream>(
-      cache_, ioStats_.get(), region, input_, fileNum_, tracker_, id, groupId_);
+      cache_,
+      ioStats_.get(),
+      region,
+      input_,
+      fileNum_,
+      tracker_,
+      id,
+      groupId_,
+      retention_);
+}
+
+std::unique_ptr<SeekableInputStream> CachedBufferedInput::enqueueDecompressed(
+    dwio::common::Region region,
+    const StreamIdentifier* si,
+    const std::function<std::unique_ptr<SeekableInputStream>(
+        std::unique_ptr<SeekableInputStream>)>& decompress) {
+  if (!FLAGS_velox_dwrf_cache_decompressed || !si || !tracker_ ||
+      region.length == 0 || region.length > kMaxCacheDecompressedBytes) {
+    return nullptr;
+  }
+  TrackingId id(si->node, si->kind);
+  if (!tracker_->shouldCacheDecompressed(id)) {
+    return nullptr;
+  }
+  if (!decompressedFileNum_.hasValue()) {
+    auto path = fileIds().string(fileNum_);
+    if (path.empty()) {
+      return nullptr;
+    }
+    decompressedFileNum_ = StringIdLease(fileIds(), path + ":decompressed");
+  }
+  RawFileCacheKey key{decompressedFileNum_.id(), region.offset};
+  CachePin pin;
+  try {
+    pin = cache_->findOrCreate(key, 1);
+  } catch (const VeloxRuntimeError& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+    return nullptr;
+  }
+  if (pin.empty()) {
+    // Another stream is storing the entry. Reads the compressed data.
+    return nullptr;
+  }
+  if (!pin.entry()->isExclusive()) {
+    tracker_->recordReference(id, region.length, groupId_);
+    return std::make_unique<DecompressedCacheStream>(
+        std::move(pin), pool(), tracker_, id, groupId_, region.length);
+  }
+  // A miss. The new entry is dropped when 'pin' goes out of scope and
+  // is made with the right size after decompressing.
+  pin.clear();
+  return std::make_unique<DecompressedCacheStream>(
+      cache_, key, decompress(enqueue(region, si)), pool());
 }
 
 bool CachedBufferedInput::isBuffered(uint64_t /*offset*/, uint64_t /*length*/)
@@ -93,6 +157,11 @@ void CachedBufferedInput::load(const dwio::common::LogType) {
       if (request.pin.entry()->isExclusive()) {
         // A new entry to be filled.
         request.pin.entry()->setPrefetch();
+        request.pin.entry()->setSsdSaveable(
+            shouldSaveToSsd(request.trackingId));
+        if (retention_ != cache::CacheRetention::kNormal) {
+          request.pin.entry()->setRetention(retention_);
+        }
         toLoad.push_back(&request);
       } else {
         // Already in cache, access time is refreshed.
@@ -107,6 +176,7 @@ void CachedBufferedInput::load(const dwio::common::LogType) {
   if (toLoad.empty()) {
     return;
   }
+  updateCoalescing();
   std::sort(
       toLoad.begin(),
       toLoad.end(),
@@ -154,9 +224,12 @@ bool CachedBufferedInput::tryMerge(
     // We do not support one region going to two target buffers.
     return false;
   }
+  int64_t extension = gap + second.length;
+  if (first.length + extension > maxLoadBytes_) {
+    return false;
+  }
   // compare with 0 since it's comparison in different types
-  if (gap <= kMaxMergeDistance) {
-    int64_t extension = gap + second.length;
+  if (gap <= maxMergeDistance_) {
 
     if (extension > 0) {
       first.length += extension;
@@ -174,6 +247,22 @@ bool CachedBufferedInput::tryMerge(
   return false;
 }
 
+void CachedBufferedInput::updateCoalescing() {
+  auto model = ioStats_->storageReadModel();
+  if (!model.has_value()) {
+    // Nothing measured yet. Keep the defaults.
+    return;
+  }
+  maxMergeDistance_ = std::clamp<uint64_t>(
+      model->latencyUs * model->bytesPerUs,
+      kMinMergeDistance,
+      kMaxAdaptiveMergeDistance);
+  // Beyond a few latencies' worth of transfer, a larger read no
+  // longer amortizes the latency but still delays the first use.
+  maxLoadBytes_ =
+      std::clamp<uint64_t>(8 * maxMergeDistance_, kMinLoadBytes, kMaxLoadBytes);
+}
+
 namespace {
 class DwrfFusedLoad : public cache::FusedLoad {
  public:
@@ -225,17 +314,83 @@ class DwrfFusedLoad : public cache::FusedLoad {
     } else {
       ioStats_->read().increment(totalRead);
     }
-    stream.read(buffers, start, dwio::common::LogType::FILE);
+    uint64_t micros = 0;
+    {
+      MicrosecondTimer timer(&micros);
+      stream.read(buffers, start, dwio::common::LogType::FILE);
+    }
+    ioStats_->recordStorageRead(lastOffset - start, micros);
   }
 
  private:
   std::unique_ptr<AbstractInputStreamHolder> input_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
 };
+
+// Loads entries from an SsdFile. An entry whose region of the file
+// was written over after the lookup is read from storage instead.
+class SsdFusedLoad : public cache::FusedLoad {
+ public:
+  void initialize(
+      std::vector<CachePin>&& pins,
+      std::vector<cache::SsdRun>&& runs,
+      cache::SsdFile* file,
+      StreamSource streamSource,
+      std::shared_ptr<dwio::common::IoStatistics> ioStats) {
+    runs_ = std::move(runs);
+    file_ = file;
+    streamSource_ = std::move(streamSource);
+    ioStats_ = std::move(ioStats);
+    cache::FusedLoad::initialize(std::move(pins));
+  }
+
+  void loadData(bool /*isPrefetch*/) override {
+    std::unique_ptr<AbstractInputStreamHolder> input;
+    for (auto i = 0; i < pins_.size(); ++i) {
+      auto* entry = pins_[i].entry();
+      if (file_->read(runs_[i], entry)) {
+        entry->setSsdFile(file_, runs_[i].offset);
+        ioStats_->ssdRead().increment(entry->size());
+        continue;
+      }
+      if (!input) {
+        input = streamSource_();
+      }
+      input->get().read(
+          makeBuffers(entry), entry->offset(), dwio::common::LogType::FILE);
+      ioStats_->read().increment(entry->size());
+    }
+  }
+
+ private:
+  static std::vector<folly::Range<char*>> makeBuffers(
+      cache::AsyncDataCacheEntry* entry) {
+    uint64_t size = entry->size();
+    if (entry->tinyData()) {
+      return {folly::Range<char*>(entry->tinyData(), size)};
+    }
+    std::vector<folly::Range<char*>> buffers;
+    auto& data = entry->data();
+    uint64_t offset = 0;
+    for (auto i = 0; i < data.numRuns() && offset < size; ++i) {
+      auto run = data.runAt(i);
+      auto bytes = std::min<uint64_t>(run.numBytes(), size - offset);
+      buffers.push_back(folly::Range<char*>(run.data<char>(), bytes));
+      offset += bytes;
+    }
+    return buffers;
+  }
+
+  std::vector<cache::SsdRun> runs_;
+  cache::SsdFile* file_;
+  StreamSource streamSource_;
+  std::shared_ptr<dwio::common::IoStatistics> ioStats_;
+};
 } // namespace
 
 void CachedBufferedInput::readRegion(std::vector<CachePin> pins) {
   auto load = std::make_shared<DwrfFusedLoad>();
+  load->setCancellationToken(cancellationToken_);
   load->initialize(std::move(pins), streamSource_(), ioStats_);
   fusedLoads_.push_back(load);
 }
@@ -252,10 +407,44 @@ std::unique_ptr<SeekableInputStream> CachedBufferedInput::read(
       fileNum_,
       nullptr,
       TrackingId(),
-      0);
+      0,
+      retention_);
 }
 
-void CachedBufferedInput::loadFromSsd(std::vector<CacheRequest*> /*requests*/) {
-  // No op placeholder.
+bool CachedBufferedInput::shouldSaveToSsd(TrackingId id) const {
+  return cache_->ssdCache() &&
+      (id.empty() || tracker_->shouldSaveToSsd(id));
+}
+
+void CachedBufferedInput::loadFromSsd(std::vector<CacheRequest*>& requests) {
+  auto* ssdCache = cache_->ssdCache();
+  if (!ssdCache) {
+    return;
+  }
+  auto& file = ssdCache->file(fileNum_);
+  std::vector<CachePin> pins;
+  std::vector<cache::SsdRun> runs;
+  auto it = std::remove_if(
+      requests.begin(), requests.end(), [&](CacheRequest* request) {
+        auto run = file.find(request->key);
+        if (!run.has_value() || run->size != request->size) {
+          return false;
+        }
+        runs.push_back(run.value());
+        pins.push_back(std::move(request->pin));
+        return true;
+      });
+  requests.erase(it, requests.end());
+  if (pins.empty()) {
+    return;
+  }
+  auto load = std::make_shared<SsdFusedLoad>();
+  load->setCancellationToken(cancellationToken_);
+  load->initialize(
+      std::move(pins), std::move(runs), &file, streamSource_, ioStats_);
+  fusedLoads_.push_back(load);
+  if (executor_) {
+    executor_->add([load]() { load->loadOrFuture(nullptr); });
+  }
 }
 } // namespace facebook::velox::dwrf
@@ -18,10 +18,12 @@
 
 #include "velox/common/caching/AsyncDataCache.h"
 #include "velox/common/caching/ScanTracker.h"
+#include "velox/common/caching/StringIdMap.h"
 #include "velox/dwio/common/InputStream.h"
 #include "velox/dwio/dwrf/common/BufferedInput.h"
 
 #include <folly/Executor.h>
+#include <limits>
 
 namespace facebook::velox::dwrf {
 
@@ -53,7 +55,9 @@ class CachedBufferedInput : public BufferedInput {
       uint64_t groupId,
       StreamSource streamSource,
       std::shared_ptr<dwio::common::IoStatistics> ioStats,
-      folly::Executor* executor)
+      folly::Executor* executor,
+      cache::CacheRetention retention = cache::CacheRetention::kNormal,
+      folly::CancellationToken cancellationToken = {})
       : BufferedInput(input, pool, dataCacheConfig),
         cache_(cache),
         fileNum_(dataCacheConfig->filenum),
@@ -61,7 +65,9 @@ class CachedBufferedInput : public BufferedInput {
         groupId_(groupId),
         streamSource_(streamSource),
         ioStats_(std::move(ioStats)),
-        executor_(executor) {}
+        executor_(executor),
+        retention_(retention),
+        cancellationToken_(std::move(cancellationToken)) {}
 
   ~CachedBufferedInput() override {
     for (auto& load : fusedLoads_) {
@@ -77,6 +83,16 @@ class CachedBufferedInput : public BufferedInput {
       dwio::common::Region region,
       const StreamIdentifier* si) override;
 
+  // Returns a stream over the cached decompressed data of 'region'
+  // when 'tracker_' finds the stream hot. On a hit, nothing is read
+  // from storage. On a miss, 'region' is enqueued and decompressed
+  // on first use and the result is stored for the next reader.
+  std::unique_ptr<SeekableInputStream> enqueueDecompressed(
+      dwio::common::Region region,
+      const StreamIdentifier* si,
+      const std::function<std::unique_ptr<SeekableInputStream>(
+          std::unique_ptr<SeekableInputStream>)>& decompress) override;
+
   void load(const dwio::common::LogType) override;
 
   bool isBuffered(uint64_t offset, uint64_t length) const override;
@@ -92,6 +108,25 @@ class CachedBufferedInput : public BufferedInput {
     return true;
   }
 
+  // Bounds of the gap between coalesced reads and the size of a
+  // coalesced read when these are derived from measured storage
+  // latency and throughput.
+  static constexpr uint64_t kMinMergeDistance = 128 << 10;
+  static constexpr uint64_t kMaxAdaptiveMergeDistance = 16 << 20;
+  static constexpr uint64_t kMinLoadBytes = 8 << 20;
+  static constexpr uint64_t kMaxLoadBytes = 128 << 20;
+
+  // Largest compressed stream whose decompressed form is cached.
+  static constexpr uint64_t kMaxCacheDecompressedBytes = 8 << 20;
+
+  uint64_t maxMergeDistance() const {
+    return maxMergeDistance_;
+  }
+
+  uint64_t maxLoadBytes() const {
+    return maxLoadBytes_;
+  }
+
  private:
   struct CacheRequest {
     cache::RawFileCacheKey key;
@@ -106,14 +141,23 @@ class CachedBufferedInput : public BufferedInput {
       dwio::common::Region& first,
       const dwio::common::Region& second);
 
+  // Sets 'maxMergeDistance_' and 'maxLoadBytes_' from the storage
+  // latency and throughput in 'ioStats_'. A gap is worth reading
+  // through if transferring it takes less time than the latency of
+  // a separate read.
+  void updateCoalescing();
+
   // Schedules 'pins' to be read in a single IO covering
   // 'region'. 'pins are sorted and non-overlapping and do not have
   // excessive gaps between the end of one and the start of the next.
   void readRegion(std::vector<cache::CachePin> pins);
 
-  // Removes the requests from 'toLoad' if they hit SSD cache. May start
-  // background load from SSD.
-  void loadFromSsd(std::vector<CacheRequest*> requests);
+  // Removes the requests from 'requests' that hit the SSD cache and
+  // schedules a load of these from SSD.
+  void loadFromSsd(std::vector<CacheRequest*>& requests);
+
+  // True if new entries for 'id' should be saved to the SSD cache.
+  bool shouldSaveToSsd(cache::TrackingId id) const;
 
   cache::AsyncDataCache* cache_;
   const uint64_t fileNum_;
@@ -122,12 +166,27 @@ class CachedBufferedInput : public BufferedInput {
   StreamSource streamSource_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
   folly::Executor* const executor_;
+  // Retention hint for the entries loaded by 'this'.
+  const cache::CacheRetention retention_;
+  // Cancelled when the query is terminated. Prefetches that have not
+  // started by then are cancelled instead of loaded.
+  const folly::CancellationToken cancellationToken_;
 
   //  Percentage of reads over enqueues that qualifies a stream to be
   //  coalesced with nearby streams and prefetched. Anything read less
   //  frequently will be synchronously read on first use.
   int32_t prefetchThreshold_ = 60;
 
+  // Max gap between the end of one and the start of the next region
+  // in a coalesced load and max size of a coalesced load. Set by
+  // updateCoalescing().
+  uint64_t maxMergeDistance_{kMaxMergeDistance};
+  uint64_t maxLoadBytes_{std::numeric_limits<uint64_t>::max()};
+
+  // Id of the cache entries holding decompressed data of the file of
+  // 'fileNum_'. Set on first use.
+  StringIdLease decompressedFileNum_;
+
   // Regions that are candidates for loading.
   std::vector<CacheRequest> requests_;
   // Coalesced loads spanning multiple cache entries in one IO.
@@ -142,13 +201,17 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
       uint64_t groupId,
       StreamSource streamSource,
       std::shared_ptr<dwio::common::IoStatistics> ioStats,
-      folly::Executor* executor)
+      folly::Executor* executor,
+      cache::CacheRetention retention = cache::CacheRetention::kNormal,
+      folly::CancellationToken cancellationToken = {})
       : cache_(cache),
         tracker_(std::move(tracker)),
         groupId_(groupId),
         streamSource_(streamSource),
         ioStats_(ioStats),
-        executor_(executor) {}
+        executor_(executor),
+        retention_(retention),
+        cancellationToken_(std::move(cancellationToken)) {}
 
   std::unique_ptr<BufferedInput> create(
       dwio::common::InputStream& input,
@@ -163,7 +226,9 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
         groupId_,
         streamSource_,
         ioStats_,
-        executor_);
+        executor_,
+        retention_,
+        cancellationToken_);
   }
 
   std::string toString() const {
@@ -180,5 +245,7 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
   StreamSource streamSource_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
   folly::Executor* executor_;
+  const cache::CacheRetention retention_;
+  const folly::CancellationToken cancellationToken_;
 };
 } // namespace facebook::velox::dwrf
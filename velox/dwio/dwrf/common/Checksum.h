@@ -19,7 +19,7 @@
 #include "velox/dwio/common/exception/Exception.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
 
-#include <boost/crc.hpp>
+#include <folly/hash/Checksum.h>
 #define XXH_INLINE_ALL
 #include "velox/external/xxhash.h"
 
@@ -77,6 +77,9 @@ class XxHash : public Checksum {
   }
 };
 
+// CRC-32 with the polynomial of zlib, the same as boost::crc_32_type.
+// folly::crc32() uses PCLMUL/SSE4.2 if the CPU has them and a portable
+// implementation otherwise.
 class Crc32 : public Checksum {
  public:
   Crc32() : Checksum{proto::ChecksumAlgorithm::CRC32} {
@@ -86,11 +89,11 @@ class Crc32 : public Checksum {
   ~Crc32() override = default;
 
   void update(const void* input, size_t len) override {
-    crc_->process_bytes(input, len);
+    crc_ = folly::crc32(reinterpret_cast<const uint8_t*>(input), len, crc_);
   }
 
   int64_t getDigest(bool reset) override {
-    auto ret = crc_->checksum();
+    int64_t ret = ~crc_;
     if (reset) {
       this->reset();
     }
@@ -98,10 +101,11 @@ class Crc32 : public Checksum {
   }
 
  private:
-  std::unique_ptr<boost::crc_32_type> crc_;
+  // The running remainder. The digest is its complement.
+  uint32_t crc_;
 
   void reset() {
-    crc_ = std::make_unique<boost::crc_32_type>();
+    crc_ = ~0U;
   }
 };
 
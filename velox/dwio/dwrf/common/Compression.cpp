@@ -20,11 +20,21 @@
 #include "velox/dwio/dwrf/common/PagedInputStream.h"
 #include "velox/dwio/dwrf/common/PagedOutputStream.h"
 
+#include <gflags/gflags.h>
 #include <lz4.h>
 #include <snappy.h>
 #include <zlib.h>
 #include <zstd.h>
 #include <zstd_errors.h>
+#ifdef VELOX_ENABLE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+DEFINE_bool(
+    velox_dwrf_libdeflate,
+    true,
+    "Use libdeflate for ZLIB compressed DWRF streams if built with "
+    "VELOX_ENABLE_LIBDEFLATE");
 
 namespace facebook::velox::dwrf {
 
@@ -183,6 +193,49 @@ uint64_t ZlibDecompressor::decompress(
   return destLength - zstream_.avail_out;
 }
 
+#ifdef VELOX_ENABLE_LIBDEFLATE
+// Decompresses a ZLIB chunk in one call with libdeflate, which is
+// considerably faster than zlib. Unlike zlib, libdeflate does not stream,
+// so the chunk must be contiguous. The uncompressed size is at most the
+// block size.
+class LibdeflateDecompressor : public Decompressor {
+ public:
+  LibdeflateDecompressor(uint64_t blockSize, const std::string& streamDebugInfo)
+      : Decompressor{blockSize, streamDebugInfo},
+        decompressor_{libdeflate_alloc_decompressor()} {
+    DWIO_ENSURE_NOT_NULL(
+        decompressor_,
+        "Error from libdeflate_alloc_decompressor. Info: ",
+        streamDebugInfo_);
+  }
+
+  ~LibdeflateDecompressor() override {
+    libdeflate_free_decompressor(decompressor_);
+  }
+
+  uint64_t decompress(
+      const char* src,
+      uint64_t srcLength,
+      char* dest,
+      uint64_t destLength) override {
+    size_t uncompressedLength;
+    auto result = libdeflate_deflate_decompress(
+        decompressor_, src, srcLength, dest, destLength, &uncompressedLength);
+    DWIO_ENSURE_EQ(
+        result,
+        LIBDEFLATE_SUCCESS,
+        "Error in LibdeflateDecompressor::decompress. error: ",
+        result,
+        " Info: ",
+        streamDebugInfo_);
+    return uncompressedLength;
+  }
+
+ private:
+  libdeflate_decompressor* decompressor_;
+};
+#endif
+
 class LzoDecompressor : public Decompressor {
  public:
   explicit LzoDecompressor(
@@ -435,7 +488,8 @@ std::unique_ptr<BufferedOutputStream> createCompressor(
     CompressionBufferPool& bufferPool,
     DataBufferHolder& bufferHolder,
     const Config& config,
-    const Encrypter* encrypter) {
+    const Encrypter* encrypter,
+    ParallelFlush* parallelFlush) {
   std::unique_ptr<Compressor> compressor;
   switch (static_cast<int64_t>(kind)) {
     case CompressionKind_NONE:
@@ -459,7 +513,12 @@ std::unique_ptr<BufferedOutputStream> createCompressor(
       DWIO_RAISE("compression codec");
   }
   return std::make_unique<PagedOutputStream>(
-      bufferPool, bufferHolder, config, std::move(compressor), encrypter);
+      bufferPool,
+      bufferHolder,
+      config,
+      std::move(compressor),
+      encrypter,
+      parallelFlush);
 }
 
 std::unique_ptr<SeekableInputStream> createDecompressor(
@@ -478,6 +537,15 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
       // decompressor remain as nullptr
       break;
     case CompressionKind_ZLIB:
+#ifdef VELOX_ENABLE_LIBDEFLATE
+      // Chunks that span input buffers are copied to be contiguous, which
+      // costs less than the gain over zlib.
+      if (FLAGS_velox_dwrf_libdeflate) {
+        decompressor = std::make_unique<LibdeflateDecompressor>(
+            blockSize, streamDebugInfo);
+        break;
+      }
+#endif
       if (!decrypter) {
         // When file is not encrypted, we can use zlib streaming codec to avoid
         // copying data
@@ -28,6 +28,8 @@ namespace facebook::velox::dwrf {
 
 constexpr uint8_t PAGE_HEADER_SIZE = 3;
 
+class ParallelFlush;
+
 class Compressor {
  public:
   explicit Compressor(int32_t level) : level_{level} {}
@@ -86,12 +88,15 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
  * @param bufferHolder buffer holder that handles buffer allocation and
  * collection
  * @param level compression level
+ * @param parallelFlush if set, the last page is compressed on its executor
+ * at flush
  */
 std::unique_ptr<BufferedOutputStream> createCompressor(
     CompressionKind kind,
     CompressionBufferPool& bufferPool,
     DataBufferHolder& bufferHolder,
     const Config& config,
-    const dwio::common::encryption::Encrypter* encrypter = nullptr);
+    const dwio::common::encryption::Encrypter* encrypter = nullptr,
+    ParallelFlush* parallelFlush = nullptr);
 
 } // namespace facebook::velox::dwrf
@@ -20,6 +20,51 @@
 
 namespace facebook::velox::dwrf {
 
+namespace {
+std::string columnsToString(const std::vector<uint32_t>& val) {
+  return folly::join(",", val);
+}
+
+std::vector<uint32_t> columnsFromString(const std::string& val) {
+  std::vector<uint32_t> result;
+  if (!val.empty()) {
+    std::vector<folly::StringPiece> pieces;
+    folly::split(',', val, pieces, true);
+    for (auto& p : pieces) {
+      const auto& trimmedCol = folly::trimWhitespace(p);
+      if (!trimmedCol.empty()) {
+        result.push_back(folly::to<uint32_t>(trimmedCol));
+      }
+    }
+  }
+  return result;
+}
+
+std::string columnGroupsToString(
+    const std::vector<std::vector<uint32_t>>& val) {
+  std::vector<std::string> groups;
+  groups.reserve(val.size());
+  for (auto& group : val) {
+    groups.push_back(columnsToString(group));
+  }
+  return folly::join(";", groups);
+}
+
+std::vector<std::vector<uint32_t>> columnGroupsFromString(
+    const std::string& val) {
+  std::vector<std::vector<uint32_t>> result;
+  std::vector<folly::StringPiece> pieces;
+  folly::split(';', val, pieces, true);
+  for (auto& p : pieces) {
+    auto group = columnsFromString(p.str());
+    if (!group.empty()) {
+      result.push_back(std::move(group));
+    }
+  }
+  return result;
+}
+} // namespace
+
 Config::Entry<WriterVersion> Config::WRITER_VERSION(
     "orc.writer.version",
     WriterVersion_CURRENT);
@@ -88,6 +133,10 @@ Config::Entry<bool> Config::DICTIONARY_SORT_KEYS{
     "hive.exec.orc.dictionary.key.sorted",
     false};
 
+Config::Entry<uint32_t> Config::DICTIONARY_ENCODING_SAMPLE_ROWS{
+    "hive.exec.orc.dictionary.sample.rows",
+    0};
+
 Config::Entry<float> Config::ENTROPY_KEY_STRING_SIZE_THRESHOLD{
     "hive.exec.orc.entropy.key.string.size.threshold",
     0.9f};
@@ -108,6 +157,10 @@ Config::Entry<uint32_t> Config::STRING_STATS_LIMIT(
     "hive.orc.string.stats.limit",
     64);
 
+Config::Entry<bool> Config::DISTINCT_COUNT_STATS(
+    "orc.distinct.count.stats",
+    false);
+
 Config::Entry<bool> Config::FLATTEN_MAP("orc.flatten.map", false);
 
 Config::Entry<bool> Config::MAP_FLAT_DISABLE_DICT_ENCODING(
@@ -121,21 +174,8 @@ Config::Entry<bool> Config::MAP_FLAT_DICT_SHARE(
 Config::Entry<const std::vector<uint32_t>> Config::MAP_FLAT_COLS(
     "orc.map.flat.cols",
     {},
-    [](const std::vector<uint32_t>& val) { return folly::join(",", val); },
-    [](const std::string& val) {
-      std::vector<uint32_t> result;
-      if (!val.empty()) {
-        std::vector<folly::StringPiece> pieces;
-        folly::split(',', val, pieces, true);
-        for (auto& p : pieces) {
-          const auto& trimmedCol = folly::trimWhitespace(p);
-          if (!trimmedCol.empty()) {
-            result.push_back(folly::to<uint32_t>(trimmedCol));
-          }
-        }
-      }
-      return result;
-    });
+    columnsToString,
+    columnsFromString);
 
 Config::Entry<uint32_t> Config::MAP_FLAT_MAX_KEYS(
     "orc.map.flat.max.keys",
@@ -157,8 +197,25 @@ Config::Entry<bool> Config::DISABLE_LOW_MEMORY_MODE(
     "hive.exec.orc.disable.low.memory.mode",
     false);
 
+Config::Entry<const std::vector<uint32_t>> Config::BLOOM_FILTER_COLUMNS(
+    "orc.bloom.filter.columns",
+    {},
+    columnsToString,
+    columnsFromString);
+
 Config::Entry<bool> Config::STREAM_SIZE_ABOVE_THRESHOLD_CHECK_ENABLED(
     "orc.stream.size.above.threshold.check.enabled",
     true);
 
+Config::Entry<uint64_t> Config::MAX_INFLIGHT_WRITE_BYTES(
+    "orc.write.max.inflight.bytes",
+    256L * 1024L * 1024L);
+
+Config::Entry<const std::vector<std::vector<uint32_t>>>
+    Config::COLUMN_READ_GROUPS(
+        "orc.column.read.groups",
+        {},
+        columnGroupsToString,
+        columnGroupsFromString);
+
 } // namespace facebook::velox::dwrf
@@ -95,11 +95,17 @@ class Config {
   static Entry<float> DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD;
   static Entry<float> DICTIONARY_STRING_KEY_SIZE_THRESHOLD;
   static Entry<bool> DICTIONARY_SORT_KEYS;
+  // Number of non-null rows of the first stripe after which a column
+  // re-evaluates its dictionary and switches to direct encoding right away
+  // if the dictionary is not worth keeping. 0 defers the decision to the
+  // first stripe flush.
+  static Entry<uint32_t> DICTIONARY_ENCODING_SAMPLE_ROWS;
   static Entry<float> ENTROPY_KEY_STRING_SIZE_THRESHOLD;
   static Entry<uint32_t> ENTROPY_STRING_MIN_SAMPLES;
   static Entry<float> ENTROPY_STRING_DICT_SAMPLE_FRACTION;
   static Entry<uint32_t> ENTROPY_STRING_THRESHOLD;
   static Entry<uint32_t> STRING_STATS_LIMIT;
+  static Entry<bool> DISTINCT_COUNT_STATS;
   static Entry<bool> FLATTEN_MAP;
   static Entry<bool> MAP_FLAT_DISABLE_DICT_ENCODING;
   static Entry<bool> MAP_FLAT_DICT_SHARE;
@@ -112,9 +118,19 @@ class Config {
   static Entry<bool> FORCE_LOW_MEMORY_MODE;
   // Disable low memory mode mostly for test purposes.
   static Entry<bool> DISABLE_LOW_MEMORY_MODE;
+  // Top level columns that get a Bloom filter for each row group. Only
+  // integer and string columns are supported. Requires CREATE_INDEX.
+  static Entry<const std::vector<uint32_t>> BLOOM_FILTER_COLUMNS;
   // Fail the writer, when Stream size is above threshold
   // Streams greater than 2GB will be failed to be read by Jolly/Presto reader.
   static Entry<bool> STREAM_SIZE_ABOVE_THRESHOLD_CHECK_ENABLED;
+  // When stripes are written on an executor, the number of flushed bytes
+  // that may be waiting to be written before the writer blocks.
+  static Entry<uint64_t> MAX_INFLIGHT_WRITE_BYTES;
+  // Groups of top level columns that are read together, e.g. "0,4;2,3". The
+  // streams of the columns of a group are placed next to each other in a
+  // stripe, in the order of the groups and before the other columns.
+  static Entry<const std::vector<std::vector<uint32_t>>> COLUMN_READ_GROUPS;
 
  private:
   std::unordered_map<std::string, std::string> configs_;
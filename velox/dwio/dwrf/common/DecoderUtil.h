@@ -17,6 +17,7 @@
 #pragma once
 
 #include <algorithm>
+#include "velox/common/base/Nulls.h"
 #include "velox/common/base/RawVector.h"
 #include "velox/common/process/ProcessBase.h"
 #include "velox/dwio/dwrf/common/StreamUtil.h"
@@ -384,6 +385,58 @@ void fixedWidthScan(
       });
 }
 
+// Merges the rows of 'rows' that are null in 'nulls' into the
+// 'numPassed' ascending row numbers in 'filterHits'. These are the
+// non-null rows that passed a filter which also passes nulls. Unless
+// 'filterOnly', also moves the passing values in 'rawValues' to their
+// final positions, writes a default value for each null and sets
+// 'resultNulls' to match. 'filterHits' and 'rawValues' must have space
+// for 'rows.size()' elements. Returns the number of rows in the result.
+template <typename T, bool filterOnly>
+int32_t mergePassingNulls(
+    const uint64_t* nulls,
+    RowSet rows,
+    int32_t numPassed,
+    int32_t* filterHits,
+    T* rawValues,
+    uint64_t* resultNulls) {
+  int32_t numNulls = 0;
+  for (auto row : rows) {
+    numNulls += bits::isBitNull(nulls, row);
+  }
+  if (!numNulls) {
+    return numPassed;
+  }
+  int32_t numResults = numPassed + numNulls;
+  if (!filterOnly) {
+    bits::fillBits(resultNulls, 0, numResults, bits::kNotNull);
+  }
+  // Moving from the end, the write position is never below the next
+  // passing row to move, so this works in place. Stops when the rest
+  // of the passing rows are already where they belong.
+  int32_t passedIndex = numPassed - 1;
+  int32_t resultIndex = numResults - 1;
+  for (int32_t i = rows.size() - 1; resultIndex > passedIndex; --i) {
+    auto row = rows[i];
+    if (bits::isBitNull(nulls, row)) {
+      filterHits[resultIndex] = row;
+      if (!filterOnly) {
+        rawValues[resultIndex] = T();
+        bits::setNull(resultNulls, resultIndex);
+      }
+      --resultIndex;
+    } else if (passedIndex >= 0 && filterHits[passedIndex] == row) {
+      filterHits[resultIndex] = row;
+      if (!filterOnly) {
+        rawValues[resultIndex] = rawValues[passedIndex];
+      }
+      --passedIndex;
+      --resultIndex;
+    }
+  }
+  return numResults;
+}
+
 int32_t nonNullRowsFromDense(
     const uint64_t* nulls,
     int32_t numRows,
@@ -429,6 +482,18 @@ bool useFastPath(Visitor& visitor) {
        Visitor::HookType::kSkipNulls);
 }
 
+// True if the non-null values seen by 'visitor' can be filtered in
+// bulk and the nulls, which pass the filter, merged in afterwards with
+// mergePassingNulls().
+template <typename Visitor>
+bool useFastPathWithPassingNulls(Visitor& visitor) {
+  return process::hasAvx2() && Visitor::FilterType::deterministic &&
+      Visitor::kHasBulkPath &&
+      !std::is_same<typename Visitor::FilterType, common::AlwaysTrue>::value &&
+      std::is_same<typename Visitor::HookType, NoHook>::value &&
+      visitor.allowNulls();
+}
+
 template <typename T>
 void scatterNonNulls(int32_t numRows, const int32_t* target, T* data);
 
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/dwio/dwrf/common/DecompressedCacheStream.h"
+#include "velox/dwio/common/exception/Exception.h"
+#include "velox/dwio/dwrf/common/PagedInputStream.h"
+
+namespace facebook::velox::dwrf {
+
+using cache::AsyncDataCacheEntry;
+using cache::CachePin;
+
+namespace {
+
+// Returns the contiguous pieces of the data of 'entry'.
+std::vector<folly::Range<char*>> entryRanges(AsyncDataCacheEntry* entry) {
+  std::vector<folly::Range<char*>> ranges;
+  if (entry->tinyData()) {
+    ranges.emplace_back(entry->tinyData(), entry->size());
+    return ranges;
+  }
+  auto& allocation = entry->data();
+  int64_t remaining = entry->size();
+  for (auto i = 0; i < allocation.numRuns() && remaining > 0; ++i) {
+    auto run = allocation.runAt(i);
+    int64_t size = std::min<int64_t>(run.numBytes(), remaining);
+    ranges.emplace_back(run.data<char>(), size);
+    remaining -= size;
+  }
+  return ranges;
+}
+
+// Copies 'size' bytes between 'buffer' and offset 'offset' in the
+// concatenation of 'ranges'. Copies into 'ranges' if 'toRanges' is
+// true, else from 'ranges' into 'buffer'.
+void copyRanges(
+    const std::vector<folly::Range<char*>>& ranges,
+    uint64_t offset,
+    char* buffer,
+    uint64_t size,
+    bool toRanges) {
+  for (auto& range : ranges) {
+    if (size == 0) {
+      return;
+    }
+    if (offset >= range.size()) {
+      offset -= range.size();
+      continue;
+    }
+    auto bytes = std::min<uint64_t>(range.size() - offset, size);
+    if (toRanges) {
+      memcpy(range.data() + offset, buffer, bytes);
+    } else {
+      memcpy(buffer, range.data() + offset, bytes);
+    }
+    buffer += bytes;
+    size -= bytes;
+    offset = 0;
+  }
+  DWIO_ENSURE_EQ(size, 0, "Copy past end of cache entry");
+}
+
+uint64_t headerSize(uint64_t numChunks) {
+  return sizeof(uint64_t) * (1 + 2 * numChunks);
+}
+
+} // namespace
+
+DecompressedCacheStream::DecompressedCacheStream(
+    CachePin pin,
+    memory::MemoryPool& pool,
+    std::shared_ptr<cache::ScanTracker> tracker,
+    cache::TrackingId trackingId,
+    uint64_t groupId,
+    uint64_t length)
+    : pin_(std::move(pin)),
+      pool_(pool),
+      tracker_(std::move(tracker)),
+      trackingId_(trackingId),
+      groupId_(groupId),
+      length_(length) {}
+
+DecompressedCacheStream::DecompressedCacheStream(
+    cache::AsyncDataCache* cache,
+    cache::RawFileCacheKey key,
+    std::unique_ptr<SeekableInputStream> decompressed,
+    memory::MemoryPool& pool)
+    : pool_(pool),
+      cache_(cache),
+      key_(key),
+      decompressed_(std::move(decompressed)) {}
+
+void DecompressedCacheStream::ensureLoaded() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  if (decompressed_) {
+    decompressAndStore();
+    return;
+  }
+  if (tracker_) {
+    tracker_->recordRead(trackingId_, length_, groupId_);
+  }
+  initFromPin();
+}
+
+void DecompressedCacheStream::initFromPin() {
+  auto pieces = entryRanges(pin_.entry());
+  uint64_t numChunks;
+  copyRanges(
+      pieces, 0, reinterpret_cast<char*>(&numChunks), sizeof(numChunks), false);
+  chunks_.resize(numChunks);
+  copyRanges(
+      pieces,
+      sizeof(numChunks),
+      reinterpret_cast<char*>(chunks_.data()),
+      numChunks * 2 * sizeof(uint64_t),
+      false);
+  // The data starts after the chunk table.
+  uint64_t skip = headerSize(numChunks);
+  for (auto& piece : pieces) {
+    if (skip >= piece.size()) {
+      skip -= piece.size();
+      continue;
+    }
+    rangeOffsets_.push_back(size_);
+    ranges_.emplace_back(piece.data() + skip, piece.size() - skip);
+    size_ += piece.size() - skip;
+    skip = 0;
+  }
+}
+
+void DecompressedCacheStream::decompressAndStore() {
+  auto* paged = dynamic_cast<PagedInputStream*>(decompressed_.get());
+  DWIO_ENSURE_NOT_NULL(
+      paged, "Expecting a PagedInputStream: ", decompressed_->getName());
+  buffer_ = std::make_unique<dwio::common::DataBuffer<char>>(pool_);
+  const void* data;
+  int32_t size;
+  while (decompressed_->Next(&data, &size)) {
+    if (chunks_.empty() || chunks_.back().first != paged->lastHeaderOffset()) {
+      chunks_.emplace_back(
+          paged->lastHeaderOffset(), paged->bytesReturnedAtLastHeaderOffset());
+    }
+    buffer_->extendAppend(
+        buffer_->size(), reinterpret_cast<const char*>(data), size);
+  }
+  decompressed_.reset();
+  size_ = buffer_->size();
+  CachePin pin;
+  uint64_t numChunks = chunks_.size();
+  auto header = headerSize(numChunks);
+  try {
+    pin = cache_->findOrCreate(key_, header + size_);
+  } catch (const VeloxRuntimeError& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+  }
+  if (pin.empty() || !pin.entry()->isExclusive()) {
+    // Another stream is storing the same data or there is no
+    // space. Reads from the private copy.
+    rangeOffsets_.push_back(0);
+    ranges_.emplace_back(buffer_->data(), size_);
+    return;
+  }
+  auto pieces = entryRanges(pin.entry());
+  copyRanges(
+      pieces, 0, reinterpret_cast<char*>(&numChunks), sizeof(numChunks), true);
+  copyRanges(
+      pieces,
+      sizeof(numChunks),
+      reinterpret_cast<char*>(chunks_.data()),
+      numChunks * 2 * sizeof(uint64_t),
+      true);
+  copyRanges(pieces, header, buffer_->data(), size_, true);
+  pin.entry()->setValid(true);
+  pin.entry()->setExclusiveToShared();
+  buffer_.reset();
+  pin_ = std::move(pin);
+  size_ = 0;
+  initFromPin();
+}
+
+bool DecompressedCacheStream::Next(const void** data, int32_t* size) {
+  ensureLoaded();
+  if (position_ >= size_) {
+    *size = 0;
+    return false;
+  }
+  auto index = std::upper_bound(
+                   rangeOffsets_.begin(), rangeOffsets_.end(), position_) -
+      rangeOffsets_.begin() - 1;
+  auto offsetInRange = position_ - rangeOffsets_[index];
+  auto& range = ranges_[index];
+  *data = range.data() + offsetInRange;
+  *size = std::min<uint64_t>(
+      range.size() - offsetInRange, std::numeric_limits<int32_t>::max());
+  position_ += *size;
+  return true;
+}
+
+void DecompressedCacheStream::BackUp(int32_t count) {
+  DWIO_ENSURE_GE(
+      position_,
+      static_cast<uint64_t>(count),
+      "Backup past start in ",
+      getName());
+  position_ -= count;
+}
+
+bool DecompressedCacheStream::Skip(int32_t count) {
+  ensureLoaded();
+  if (position_ + static_cast<uint64_t>(count) > size_) {
+    position_ = size_;
+    return false;
+  }
+  position_ += count;
+  return true;
+}
+
+google::protobuf::int64 DecompressedCacheStream::ByteCount() const {
+  return static_cast<google::protobuf::int64>(position_);
+}
+
+void DecompressedCacheStream::seekToRowGroup(PositionProvider& position) {
+  ensureLoaded();
+  auto compressedOffset = position.next();
+  auto uncompressedOffset = position.next();
+  auto it = std::lower_bound(
+      chunks_.begin(),
+      chunks_.end(),
+      compressedOffset,
+      [](const std::pair<uint64_t, uint64_t>& chunk, uint64_t offset) {
+        return chunk.first < offset;
+      });
+  if (it == chunks_.end()) {
+    // A position at the end of the compressed data.
+    DWIO_ENSURE_EQ(uncompressedOffset, 0, "Seek past end in ", getName());
+    position_ = size_;
+    return;
+  }
+  DWIO_ENSURE_EQ(
+      it->first, compressedOffset, "Seek to non-chunk start in ", getName());
+  position_ = it->second + uncompressedOffset;
+  DWIO_ENSURE_LE(position_, size_, "Seek past end in ", getName());
+}
+
+std::string DecompressedCacheStream::getName() const {
+  return fmt::format("DecompressedCacheStream {} of {}", position_, size_);
+}
+
+} // namespace facebook::velox::dwrf
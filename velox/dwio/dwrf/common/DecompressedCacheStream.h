@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "velox/common/caching/AsyncDataCache.h"
+#include "velox/common/caching/ScanTracker.h"
+#include "velox/dwio/common/DataBuffer.h"
+#include "velox/dwio/dwrf/common/InputStream.h"
+
+namespace facebook::velox::dwrf {
+
+// Stream over the decompressed content of a compressed stream, kept
+// in AsyncDataCache so that frequently read columns are decompressed
+// once and then shared by all scans of the stripe. The cache entry
+// starts with a table of (compressed chunk offset, decompressed
+// offset) pairs, so that the compressed positions in row group
+// indices can be translated to offsets in the decompressed data.
+class DecompressedCacheStream : public SeekableInputStream {
+ public:
+  // Makes a stream over the previously stored entry in 'pin'. The
+  // first read is recorded in 'tracker' as a read of 'length'
+  // compressed bytes of 'trackingId'.
+  DecompressedCacheStream(
+      cache::CachePin pin,
+      memory::MemoryPool& pool,
+      std::shared_ptr<cache::ScanTracker> tracker,
+      cache::TrackingId trackingId,
+      uint64_t groupId,
+      uint64_t length);
+
+  // Makes a stream that on first use reads all of 'decompressed' and
+  // stores the result in 'cache' under 'key'. 'decompressed' must be
+  // a PagedInputStream. If the entry cannot be made, the data is
+  // kept in memory owned by 'this'.
+  DecompressedCacheStream(
+      cache::AsyncDataCache* cache,
+      cache::RawFileCacheKey key,
+      std::unique_ptr<SeekableInputStream> decompressed,
+      memory::MemoryPool& pool);
+
+  bool Next(const void** data, int32_t* size) override;
+  void BackUp(int32_t count) override;
+  bool Skip(int32_t count) override;
+  google::protobuf::int64 ByteCount() const override;
+  void seekToRowGroup(PositionProvider& position) override;
+  std::string getName() const override;
+
+  size_t loadIndices(const proto::RowIndex& /*rowIndex*/, size_t startIndex)
+      override {
+    // The positions are those of the compressed stream: compressed
+    // chunk offset + offset in the decompressed chunk.
+    return startIndex + 2;
+  }
+
+ private:
+  // Sets 'chunks_' and 'ranges_' from the entry of 'pin_' or
+  // decompresses 'decompressed_' if not done yet.
+  void ensureLoaded();
+
+  // Reads 'decompressed_' to the end and stores the result in
+  // 'cache_'.
+  void decompressAndStore();
+
+  // Sets 'chunks_' and 'ranges_' from the entry of 'pin_'.
+  void initFromPin();
+
+  cache::CachePin pin_;
+  memory::MemoryPool& pool_;
+  std::shared_ptr<cache::ScanTracker> tracker_;
+  const cache::TrackingId trackingId_;
+  const uint64_t groupId_{0};
+  // Compressed size to record as read in 'tracker_'.
+  const uint64_t length_{0};
+
+  cache::AsyncDataCache* const cache_{nullptr};
+  const cache::RawFileCacheKey key_{};
+  std::unique_ptr<SeekableInputStream> decompressed_;
+  // Decompressed data if it could not be stored in 'cache_'.
+  std::unique_ptr<dwio::common::DataBuffer<char>> buffer_;
+
+  bool loaded_{false};
+  // Pairs of compressed chunk offset and decompressed offset of the
+  // chunk, ascending.
+  std::vector<std::pair<uint64_t, uint64_t>> chunks_;
+  // Contiguous pieces of the decompressed data and the offset of
+  // each in the decompressed data.
+  std::vector<folly::Range<const char*>> ranges_;
+  std::vector<uint64_t> rangeOffsets_;
+  uint64_t size_{0};
+  uint64_t position_{0};
+};
+
+} // namespace facebook::velox::dwrf
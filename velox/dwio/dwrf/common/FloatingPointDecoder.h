@@ -61,10 +61,17 @@ class FloatingPointDecoder {
 
   template <bool hasNulls, typename Visitor>
   void readWithVisitor(const uint64_t* nulls, Visitor visitor) {
-    if (std::is_same<TData, TRequested>::value &&
-        useFastPath<Visitor, hasNulls>(visitor)) {
-      fastPath<hasNulls>(nulls, visitor);
-      return;
+    if (std::is_same<TData, TRequested>::value) {
+      if (useFastPath<Visitor, hasNulls>(visitor)) {
+        fastPath<hasNulls>(nulls, visitor);
+        return;
+      }
+      if (hasNulls && useFastPathWithPassingNulls(visitor)) {
+        fastPathWithPassingNulls<
+            std::is_same<typename Visitor::Extract, DropValues>::value>(
+            nulls, visitor);
+        return;
+      }
     }
     int32_t current = visitor.start();
     skip<hasNulls>(current, 0, nulls);
@@ -168,6 +175,60 @@ class FloatingPointDecoder {
     visitor.setNumValues(hasFilter ? numValues : numRows);
   }
 
+  // Same as fastPath() with nulls and a filter that passes nulls. The
+  // non-null values are filtered in bulk and the null rows are merged
+  // into the passing rows afterwards.
+  template <bool filterOnly, typename Visitor>
+  void fastPathWithPassingNulls(const uint64_t* nulls, Visitor& visitor) {
+    auto rows = visitor.rows();
+    auto numRows = visitor.numRows();
+    auto outerVector = &visitor.outerNonNullRows();
+    raw_vector<int32_t>* innerVector = nullptr;
+    int32_t tailSkip = 0;
+    if (Visitor::dense) {
+      nonNullRowsFromDense(nulls, numRows, *outerVector);
+    } else {
+      innerVector = &visitor.innerNonNullRows();
+      nonNullRowsFromSparse<true, false>(
+          nulls,
+          folly::Range<const int32_t*>(rows, numRows),
+          *innerVector,
+          *outerVector,
+          nullptr,
+          tailSkip);
+    }
+    auto rawValues = visitor.rawValues(numRows);
+    auto filterHits = visitor.outputRows(numRows);
+    int32_t numValues = 0;
+    if (!outerVector->empty()) {
+      fixedWidthScan<TData, filterOnly, true>(
+          innerVector ? folly::Range<const int32_t*>(*innerVector)
+                      : folly::Range<const int32_t*>(rows, outerVector->size()),
+          outerVector->data(),
+          rawValues,
+          filterHits,
+          numValues,
+          *input_,
+          bufferStart_,
+          bufferEnd_,
+          visitor.filter(),
+          visitor.hook());
+    }
+    skip<false>(tailSkip, 0, nullptr);
+    auto numPassed = numValues;
+    numValues = mergePassingNulls<TData, filterOnly>(
+        nulls,
+        folly::Range<const int32_t*>(rows, numRows),
+        numPassed,
+        filterHits,
+        reinterpret_cast<TData*>(rawValues),
+        filterOnly ? nullptr : visitor.rawNulls(numRows));
+    if (!filterOnly && numValues > numPassed) {
+      visitor.setHasNulls();
+    }
+    visitor.setNumValues(numValues);
+  }
+
   std::unique_ptr<SeekableInputStream> input_;
   const char* bufferStart_ = nullptr;
   const char* bufferEnd_ = nullptr;
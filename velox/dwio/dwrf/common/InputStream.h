@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "velox/buffer/Buffer.h"
 #include "velox/dwio/common/DataBuffer.h"
 #include "velox/dwio/common/InputStream.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
@@ -58,6 +59,14 @@ class SeekableInputStream : public google::protobuf::io::ZeroCopyInputStream {
       const proto::RowIndex& rowIndex,
       size_t startIndex) = 0;
 
+  // Returns a Buffer that keeps the memory of the range returned by the
+  // last Next() alive and unchanged for as long as the Buffer is
+  // referenced. Returns nullptr if 'this' does not own that memory or
+  // may overwrite it, in which case the caller must copy what it keeps.
+  virtual BufferPtr pinLastBuffer() {
+    return nullptr;
+  }
+
   void readFully(char* buffer, size_t bufferSize);
 };
 
@@ -19,13 +19,47 @@
 
 namespace facebook::velox::dwrf {
 
+namespace {
+// Keeps a decompressed chunk alive while Buffers refer to it.
+struct OutputBufferReleaser {
+  explicit OutputBufferReleaser(
+      std::shared_ptr<dwio::common::DataBuffer<char>> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  void addRef() const {}
+  void release() const {}
+
+ private:
+  const std::shared_ptr<dwio::common::DataBuffer<char>> buffer_;
+};
+} // namespace
+
 void PagedInputStream::prepareOutputBuffer(uint64_t uncompressedLength) {
-  if (!outputBuffer_ || uncompressedLength > outputBuffer_->capacity()) {
-    outputBuffer_ = std::make_unique<dwio::common::DataBuffer<char>>(
+  // A buffer that is still referenced by a pin must not be overwritten.
+  if (!outputBuffer_ || outputBuffer_.use_count() > 1 ||
+      uncompressedLength > outputBuffer_->capacity()) {
+    outputBuffer_ = std::make_shared<dwio::common::DataBuffer<char>>(
         pool_, uncompressedLength);
   }
 }
 
+BufferPtr PagedInputStream::pinLastBuffer() {
+  if (!outputBuffer_) {
+    return nullptr;
+  }
+  // 'outputBufferPtr_' is the end of the last returned range. It points
+  // into 'outputBuffer_' only if that range was decompressed.
+  auto begin = outputBuffer_->data();
+  auto end = begin + outputBuffer_->capacity();
+  if (outputBufferPtr_ <= begin || outputBufferPtr_ > end) {
+    return nullptr;
+  }
+  return BufferView<OutputBufferReleaser>::create(
+      reinterpret_cast<const uint8_t*>(begin),
+      outputBuffer_->capacity(),
+      OutputBufferReleaser(outputBuffer_));
+}
+
 void PagedInputStream::readBuffer(bool failOnEof) {
   int32_t length;
   if (!input_->Next(
@@ -147,10 +181,18 @@ bool PagedInputStream::Next(const void** data, int32_t* size) {
 
   // perform decryption
   if (decrypter_) {
-    decryptionBuffer_ =
-        decrypter_->decrypt(folly::StringPiece{input, remainingLength_});
-    input = reinterpret_cast<const char*>(decryptionBuffer_->data());
-    remainingLength_ = decryptionBuffer_->length();
+    decryptedBuffer_.reserve(remainingLength_);
+    auto decryptedSize = decrypter_->decryptInto(
+        folly::StringPiece{input, remainingLength_}, decryptedBuffer_.data());
+    if (decryptedSize.has_value()) {
+      input = decryptedBuffer_.data();
+      remainingLength_ = decryptedSize.value();
+    } else {
+      decryptionBuffer_ =
+          decrypter_->decrypt(folly::StringPiece{input, remainingLength_});
+      input = reinterpret_cast<const char*>(decryptionBuffer_->data());
+      remainingLength_ = decryptionBuffer_->length();
+    }
     *data = input;
     *size = remainingLength_;
     outputBufferPtr_ = input + remainingLength_;
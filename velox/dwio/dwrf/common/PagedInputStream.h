@@ -31,6 +31,7 @@ class PagedInputStream : public SeekableInputStream {
       : input_(std::move(inStream)),
         pool_(memPool),
         inputBuffer_(pool_),
+        decryptedBuffer_(pool_),
         decompressor_{std::move(decompressor)},
         decrypter_{decrypter},
         streamDebugInfo_{streamDebugInfo} {
@@ -46,6 +47,11 @@ class PagedInputStream : public SeekableInputStream {
     return bytesReturned_;
   }
   void seekToRowGroup(PositionProvider& position) override;
+
+  // Pins 'outputBuffer_' if the last Next() returned decompressed data.
+  // A pinned output buffer is not reused for the next chunk.
+  BufferPtr pinLastBuffer() override;
+
   std::string getName() const override {
     return folly::to<std::string>(
         "PagedInputStream StreamInfo (",
@@ -65,6 +71,17 @@ class PagedInputStream : public SeekableInputStream {
     return startIndex + 2;
   }
 
+  // Offset in the compressed input of the header of the chunk being
+  // read.
+  uint64_t lastHeaderOffset() const {
+    return lastHeaderOffset_;
+  }
+
+  // Decompressed offset of the first byte of the chunk being read.
+  uint64_t bytesReturnedAtLastHeaderOffset() const {
+    return bytesReturnedAtLastHeaderOffset_;
+  }
+
  protected:
   // Special constructor used by ZlibDecompressionStream
   PagedInputStream(
@@ -74,6 +91,7 @@ class PagedInputStream : public SeekableInputStream {
       : input_(std::move(inStream)),
         pool_(memPool),
         inputBuffer_(pool_),
+        decryptedBuffer_(pool_),
         decompressor_{nullptr},
         decrypter_{nullptr},
         streamDebugInfo_{streamDebugInfo} {}
@@ -107,10 +125,16 @@ class PagedInputStream : public SeekableInputStream {
   // decompression/decryption algorithm to work on contiguous block
   dwio::common::DataBuffer<char> inputBuffer_;
 
-  // uncompressed output
-  std::unique_ptr<dwio::common::DataBuffer<char>> outputBuffer_{nullptr};
+  // uncompressed output. Shared with the Buffers returned by
+  // pinLastBuffer().
+  std::shared_ptr<dwio::common::DataBuffer<char>> outputBuffer_{nullptr};
+
+  // unencrypted output, reused across chunks if the decrypter
+  // supports decryptInto()
+  dwio::common::DataBuffer<char> decryptedBuffer_;
 
-  // unencrypted output
+  // unencrypted output of decrypters that do not support
+  // decryptInto()
   std::unique_ptr<folly::IOBuf> decryptionBuffer_{nullptr};
 
   // the current state
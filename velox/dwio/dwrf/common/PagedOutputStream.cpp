@@ -19,45 +19,66 @@
 
 namespace facebook::velox::dwrf {
 
+void ParallelFlush::finish() {
+  for (auto* stream : streams_) {
+    stream->finishFlush();
+  }
+  streams_.clear();
+}
+
+PagedOutputStream::~PagedOutputStream() {
+  if (pendingPage_) {
+    // The compression refers to 'this'.
+    pendingPage_->close();
+  }
+}
+
+uint64_t PagedOutputStream::compressPage(char* output) {
+  return compressor_->compress(
+      buffer_.data() + PAGE_HEADER_SIZE,
+      output + PAGE_HEADER_SIZE,
+      buffer_.size() - PAGE_HEADER_SIZE);
+}
+
 std::vector<folly::StringPiece> PagedOutputStream::createPage() {
   auto origSize = buffer_.size();
   DWIO_ENSURE_GT(origSize, PAGE_HEADER_SIZE);
   origSize -= PAGE_HEADER_SIZE;
 
-  auto compressedSize = origSize;
   // apply compressoin if there is compressor and original data size exceeds
   // threshold
   if (compressor_ && origSize >= threshold_) {
     compressionBuffer_ = pool_.getBuffer(buffer_.size());
-    compressedSize = compressor_->compress(
-        buffer_.data() + PAGE_HEADER_SIZE,
-        compressionBuffer_->data() + PAGE_HEADER_SIZE,
-        origSize);
+    auto compressed = compressionBuffer_->data();
+    return makePage(compressed, compressPage(compressed));
   }
+  return makePage(nullptr, origSize);
+}
 
-  folly::StringPiece compressed;
-  if (compressedSize >= origSize) {
+std::vector<folly::StringPiece> PagedOutputStream::makePage(
+    char* compressed,
+    uint64_t compressedSize) {
+  auto origSize = buffer_.size() - PAGE_HEADER_SIZE;
+  folly::StringPiece page;
+  if (!compressed || compressedSize >= origSize) {
     // write orig
     writeHeader(buffer_.data(), origSize, true);
-    compressed =
-        folly::StringPiece(buffer_.data(), origSize + PAGE_HEADER_SIZE);
+    page = folly::StringPiece(buffer_.data(), origSize + PAGE_HEADER_SIZE);
   } else {
     // write compressed
-    writeHeader(compressionBuffer_->data(), compressedSize, false);
-    compressed = folly::StringPiece(
-        compressionBuffer_->data(), compressedSize + PAGE_HEADER_SIZE);
+    writeHeader(compressed, compressedSize, false);
+    page = folly::StringPiece(compressed, compressedSize + PAGE_HEADER_SIZE);
   }
 
   if (!encrypter_) {
-    return {compressed};
+    return {page};
   }
 
-  encryptionBuffer_ = encrypter_->encrypt(folly::StringPiece(
-      compressed.begin() + PAGE_HEADER_SIZE, compressed.end()));
-  updateSize(
-      const_cast<char*>(compressed.begin()), encryptionBuffer_->length());
+  encryptionBuffer_ = encrypter_->encrypt(
+      folly::StringPiece(page.begin() + PAGE_HEADER_SIZE, page.end()));
+  updateSize(const_cast<char*>(page.begin()), encryptionBuffer_->length());
   return {
-      folly::StringPiece(compressed.begin(), PAGE_HEADER_SIZE),
+      folly::StringPiece(page.begin(), PAGE_HEADER_SIZE),
       folly::StringPiece(
           reinterpret_cast<const char*>(encryptionBuffer_->data()),
           encryptionBuffer_->length())};
@@ -89,8 +110,23 @@ void PagedOutputStream::resetBuffers() {
 }
 
 uint64_t PagedOutputStream::flush() {
+  finishFlush();
   auto size = buffer_.size();
   auto originalSize = bufferHolder_.size();
+  if (parallelFlush_ && compressor_ && size > PAGE_HEADER_SIZE &&
+      size - PAGE_HEADER_SIZE >= threshold_) {
+    // The buffer for the compressed data is allocated on the calling
+    // thread. The compression only works on 'buffer_' and 'flushBuffer_'.
+    flushBuffer_ = std::make_unique<dwio::common::DataBuffer<char>>(
+        bufferHolder_.getMemoryPool(), size);
+    pendingPage_ = std::make_shared<AsyncSource<uint64_t>>([this]() {
+      return std::make_shared<uint64_t>(compressPage(flushBuffer_->data()));
+    });
+    parallelFlush_->executor()->add(
+        [page = pendingPage_]() { page->prepare(); });
+    parallelFlush_->add(this);
+    return 0;
+  }
   if (size > PAGE_HEADER_SIZE) {
     bufferHolder_.take(createPage());
     resetBuffers();
@@ -100,7 +136,20 @@ uint64_t PagedOutputStream::flush() {
   return bufferHolder_.size() - originalSize;
 }
 
+void PagedOutputStream::finishFlush() {
+  if (!pendingPage_) {
+    return;
+  }
+  auto page = std::move(pendingPage_);
+  auto compressedSize = *page->move();
+  bufferHolder_.take(makePage(flushBuffer_->data(), compressedSize));
+  flushBuffer_ = nullptr;
+  encryptionBuffer_ = nullptr;
+  buffer_.resize(PAGE_HEADER_SIZE);
+}
+
 void PagedOutputStream::BackUp(int32_t count) {
+  finishFlush();
   if (count > 0) {
     DWIO_ENSURE_GE(buffer_.size(), count + PAGE_HEADER_SIZE);
     BufferedOutputStream::BackUp(count);
@@ -108,6 +157,7 @@ void PagedOutputStream::BackUp(int32_t count) {
 }
 
 bool PagedOutputStream::Next(void** data, int32_t* size, uint64_t increment) {
+  finishFlush();
   if (!tryResize(data, size, PAGE_HEADER_SIZE, increment)) {
     flushAndReset(data, size, PAGE_HEADER_SIZE, createPage());
     resetBuffers();
@@ -120,6 +170,7 @@ void PagedOutputStream::recordPosition(
     int32_t bufferLength,
     int32_t bufferOffset,
     int32_t strideOffset) const {
+  DWIO_ENSURE(!pendingPage_, "recording position during flush");
   // add compressed size, then uncompressed
   recorder.add(bufferHolder_.size(), strideOffset);
   auto size = buffer_.size();
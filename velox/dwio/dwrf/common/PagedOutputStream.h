@@ -16,10 +16,44 @@
 
 #pragma once
 
+#include <folly/Executor.h>
+
+#include "velox/common/base/AsyncSource.h"
 #include "velox/dwio/dwrf/common/Compression.h"
 
 namespace facebook::velox::dwrf {
 
+class PagedOutputStream;
+
+// Compresses the last pages of the streams of a stripe in parallel on
+// an executor. PagedOutputStream::flush() starts the compression of
+// its last page and adds the stream here. finish() adds the pages to
+// the DataBufferHolders of the streams. Until then, the
+// DataBufferHolders do not have the last pages.
+class ParallelFlush {
+ public:
+  explicit ParallelFlush(folly::Executor* executor) : executor_{executor} {
+    DWIO_ENSURE_NOT_NULL(executor_);
+  }
+
+  folly::Executor* executor() const {
+    return executor_;
+  }
+
+  void add(PagedOutputStream* stream) {
+    streams_.push_back(stream);
+  }
+
+  // Waits for the pages being compressed and adds them to their
+  // streams. Compresses the pages that are not started on the calling
+  // thread.
+  void finish();
+
+ private:
+  folly::Executor* const executor_;
+  std::vector<PagedOutputStream*> streams_;
+};
+
 class PagedOutputStream : public BufferedOutputStream {
  public:
   PagedOutputStream(
@@ -27,19 +61,30 @@ class PagedOutputStream : public BufferedOutputStream {
       DataBufferHolder& bufferHolder,
       const Config& config,
       std::unique_ptr<Compressor> compressor,
-      const dwio::common::encryption::Encrypter* encrypter)
+      const dwio::common::encryption::Encrypter* encrypter,
+      ParallelFlush* parallelFlush = nullptr)
       : BufferedOutputStream(bufferHolder),
         pool_{pool},
         compressor_{std::move(compressor)},
         encrypter_{encrypter},
-        threshold_{config.get(Config::COMPRESSION_THRESHOLD)} {
+        threshold_{config.get(Config::COMPRESSION_THRESHOLD)},
+        parallelFlush_{parallelFlush} {
     DWIO_ENSURE(compressor_ || encrypter_, "invalid paged output stream");
   }
 
+  ~PagedOutputStream() override;
+
   bool Next(void** data, int32_t* size, uint64_t increment) override;
 
+  // If 'parallelFlush_' is set, starts the compression of the last page
+  // on its executor and returns 0. The page is added to the
+  // DataBufferHolder by finishFlush().
   uint64_t flush() override;
 
+  // Adds the page started by flush() to the DataBufferHolder. No-op if
+  // there is no such page.
+  void finishFlush();
+
   uint64_t size() const override {
     // only care about compressed size
     return bufferHolder_.size();
@@ -61,6 +106,17 @@ class PagedOutputStream : public BufferedOutputStream {
   // create page using compressor and encrypter
   std::vector<folly::StringPiece> createPage();
 
+  // Compresses the content of 'buffer_' into 'output' after the page
+  // header. Returns the compressed size.
+  uint64_t compressPage(char* output);
+
+  // Makes the page from 'buffer_' or from 'compressed', which has
+  // 'compressedSize' bytes after the page header. 'compressed' is
+  // nullptr if the page is not compressed.
+  std::vector<folly::StringPiece> makePage(
+      char* compressed,
+      uint64_t compressedSize);
+
   void writeHeader(char* buffer, size_t compressedSize, bool original);
 
   void updateSize(char* buffer, size_t compressedSize);
@@ -82,6 +138,15 @@ class PagedOutputStream : public BufferedOutputStream {
 
   // threshold below which, we skip compression
   uint32_t threshold_;
+
+  ParallelFlush* const parallelFlush_;
+
+  // Compressed size of the page started by flush(). Set until
+  // finishFlush().
+  std::shared_ptr<AsyncSource<uint64_t>> pendingPage_;
+
+  // Buffer for the compressed data of 'pendingPage_'.
+  std::unique_ptr<dwio::common::DataBuffer<char>> flushBuffer_;
 };
 
 } // namespace facebook::velox::dwrf
@@ -16,6 +16,8 @@
 
 #include "velox/dwio/dwrf/common/RLEv2.h"
 
+#include <immintrin.h>
+
 namespace facebook::velox::dwrf {
 
 using memory::MemoryPool;
@@ -105,6 +107,58 @@ inline uint32_t getClosestFixedBits(uint32_t n) {
   }
 }
 
+namespace {
+// Widest value that the word-at-a-time unpack handles. A value of up
+// to 56 bits starting at any bit of a byte fits in the 8 bytes loaded
+// from that byte.
+constexpr uint32_t kMaxFastBitWidth = 56;
+
+// Unpacks 'numValues' values of 'bitWidth' bits into 'output'. The
+// values are packed most significant bit first, starting 'bitOffset'
+// bits into 'input'. Loads 8 bytes starting at the first byte of each
+// value, so these must be addressable. Four values at a time are
+// gathered, byte swapped and shifted in AVX2 registers.
+void unpackBigEndian(
+    const char* input,
+    uint64_t bitOffset,
+    uint32_t bitWidth,
+    uint64_t numValues,
+    int64_t* output) {
+  uint64_t i = 0;
+  if (numValues >= 4) {
+    const __m256i byteSwap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i step = _mm256_set1_epi64x(4 * bitWidth);
+    const __m256i lowBits = _mm256_set1_epi64x(7);
+    const __m128i rightShift = _mm_cvtsi32_si128(64 - bitWidth);
+    __m256i positions = _mm256_setr_epi64x(
+        bitOffset,
+        bitOffset + bitWidth,
+        bitOffset + 2 * bitWidth,
+        bitOffset + 3 * bitWidth);
+    for (; i + 4 <= numValues; i += 4) {
+      auto words = _mm256_i64gather_epi64(
+          reinterpret_cast<const long long*>(input),
+          _mm256_srli_epi64(positions, 3),
+          1);
+      words = _mm256_shuffle_epi8(words, byteSwap);
+      words = _mm256_sllv_epi64(words, _mm256_and_si256(positions, lowBits));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(output + i),
+          _mm256_srl_epi64(words, rightShift));
+      positions = _mm256_add_epi64(positions, step);
+    }
+  }
+  for (; i < numValues; ++i) {
+    auto position = bitOffset + i * bitWidth;
+    uint64_t word;
+    memcpy(&word, input + position / 8, sizeof(word));
+    output[i] = (__builtin_bswap64(word) << (position & 7)) >> (64 - bitWidth);
+  }
+}
+} // namespace
+
 template <bool isSigned>
 int64_t RleDecoderV2<isSigned>::readLongBE(uint64_t bsz) {
   int64_t ret = 0, val;
@@ -576,4 +630,97 @@ template uint64_t RleDecoderV2<false>::nextDelta(
     uint64_t numValues,
     const uint64_t* const nulls);
 
+template <bool isSigned>
+uint64_t RleDecoderV2<isSigned>::readLongs(
+    int64_t* const data,
+    uint64_t offset,
+    uint64_t len,
+    uint64_t fb,
+    const uint64_t* const nulls) {
+  auto numValues = nulls ? bits::countNonNulls(nulls, offset, offset + len)
+                         : len;
+  // The unread bits of 'curByte' are the low 'bitsLeft' bits of the
+  // byte before 'bufferStart'.
+  const char* input = bitsLeft ? IntDecoder<isSigned>::bufferStart - 1
+                               : IntDecoder<isSigned>::bufferStart;
+  uint64_t bitOffset = bitsLeft ? 8 - bitsLeft : 0;
+  uint64_t available = IntDecoder<isSigned>::bufferEnd - input;
+  uint64_t numFast = 0;
+  if (fb <= kMaxFastBitWidth && available >= sizeof(uint64_t) &&
+      (available - sizeof(uint64_t)) * 8 >= bitOffset) {
+    // The values whose first byte is at least 8 bytes before the end
+    // of the buffer.
+    numFast = std::min<uint64_t>(
+        numValues,
+        ((available - sizeof(uint64_t)) * 8 - bitOffset) / fb + 1);
+  }
+  if (numFast == 0) {
+    return readLongsSlow(data, offset, len, fb, nulls);
+  }
+
+  unpackBigEndian(input, bitOffset, fb, numFast, data + offset);
+  uint64_t end = offset + numFast;
+  if (nulls) {
+    // Move the values from the front of the range to the non-null
+    // positions, last first.
+    end = offset;
+    for (uint64_t numNonNull = 0; numNonNull < numFast; ++end) {
+      numNonNull += !bits::isBitNull(nulls, end);
+    }
+    int64_t value = numFast - 1;
+    for (auto pos = end - 1; value >= 0; --pos) {
+      if (!bits::isBitNull(nulls, pos)) {
+        data[pos] = data[offset + value--];
+      }
+    }
+  }
+
+  uint64_t endBit = bitOffset + numFast * fb;
+  IntDecoder<isSigned>::bufferStart = input + endBit / 8;
+  if (endBit % 8) {
+    curByte = static_cast<unsigned char>(*IntDecoder<isSigned>::bufferStart++);
+    bitsLeft = 8 - endBit % 8;
+  } else {
+    bitsLeft = 0;
+  }
+  return numFast + readLongsSlow(data, end, offset + len - end, fb, nulls);
+}
+
+template <bool isSigned>
+uint64_t RleDecoderV2<isSigned>::readLongsSlow(
+    int64_t* const data,
+    uint64_t offset,
+    uint64_t len,
+    uint64_t fb,
+    const uint64_t* const nulls) {
+  uint64_t ret = 0;
+
+  for (uint64_t i = offset; i < (offset + len); i++) {
+    // skip null positions
+    if (nulls && bits::isBitNull(nulls, i)) {
+      continue;
+    }
+    uint64_t result = 0;
+    uint64_t bitsLeftToRead = fb;
+    while (bitsLeftToRead > bitsLeft) {
+      result <<= bitsLeft;
+      result |= curByte & ((1 << bitsLeft) - 1);
+      bitsLeftToRead -= bitsLeft;
+      curByte = readByte();
+      bitsLeft = 8;
+    }
+
+    // handle the left over bits
+    if (bitsLeftToRead > 0) {
+      result <<= bitsLeftToRead;
+      bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
+      result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
+    }
+    data[i] = static_cast<int64_t>(result);
+    ++ret;
+  }
+
+  return ret;
+}
+
 } // namespace facebook::velox::dwrf
@@ -106,42 +106,23 @@ class RleDecoderV2 : public IntDecoder<isSigned> {
   }
 
   int64_t readLongBE(uint64_t bsz);
+  // Reads 'len' values of 'fb' bits into the non-null positions of
+  // 'data' starting at 'offset'. Returns the number of values read.
   uint64_t readLongs(
       int64_t* data,
       uint64_t offset,
       uint64_t len,
       uint64_t fb,
-      const uint64_t* nulls = nullptr) {
-    uint64_t ret = 0;
-
-    // TODO: unroll to improve performance
-    for (uint64_t i = offset; i < (offset + len); i++) {
-      // skip null positions
-      if (nulls && bits::isBitNull(nulls, i)) {
-        continue;
-      }
-      uint64_t result = 0;
-      uint64_t bitsLeftToRead = fb;
-      while (bitsLeftToRead > bitsLeft) {
-        result <<= bitsLeft;
-        result |= curByte & ((1 << bitsLeft) - 1);
-        bitsLeftToRead -= bitsLeft;
-        curByte = readByte();
-        bitsLeft = 8;
-      }
-
-      // handle the left over bits
-      if (bitsLeftToRead > 0) {
-        result <<= bitsLeftToRead;
-        bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
-        result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
-      }
-      data[i] = static_cast<int64_t>(result);
-      ++ret;
-    }
+      const uint64_t* nulls = nullptr);
 
-    return ret;
-  }
+  // Bit-by-bit loop of readLongs(). Used for the values that straddle
+  // the end of the buffer and for 64 bit values.
+  uint64_t readLongsSlow(
+      int64_t* data,
+      uint64_t offset,
+      uint64_t len,
+      uint64_t fb,
+      const uint64_t* nulls);
 
   uint64_t nextShortRepeats(
       int64_t* data,
@@ -55,6 +55,12 @@ class ColumnStatistics {
     if (stats.has_size()) {
       size_ = stats.size();
     }
+    if (stats.has_numberofdistinctvalues()) {
+      distinctCount_ = stats.numberofdistinctvalues();
+    }
+    if (stats.has_distinctvaluessketch()) {
+      distinctSketch_ = stats.distinctvaluessketch();
+    }
   }
 
   virtual ~ColumnStatistics() = default;
@@ -88,6 +94,23 @@ class ColumnStatistics {
     return size_;
   }
 
+  /**
+   * Get the estimated number of distinct non-null values. Only present when
+   * the writer was configured to count distinct values.
+   */
+  std::optional<uint64_t> getNumberOfDistinctValues() const {
+    return distinctCount_;
+  }
+
+  /**
+   * Get the serialized HyperLogLog sketch the distinct count is estimated
+   * from. Sketches of different files can be merged to estimate the number
+   * of distinct values across them. Only kept in file level stats.
+   */
+  const std::optional<std::string>& getDistinctValuesSketch() const {
+    return distinctSketch_;
+  }
+
   /**
    * return string representation of this stats object
    */
@@ -114,6 +137,8 @@ class ColumnStatistics {
   std::optional<bool> hasNull_;
   std::optional<uint64_t> rawSize_;
   std::optional<uint64_t> size_;
+  std::optional<uint64_t> distinctCount_;
+  std::optional<std::string> distinctSketch_;
 };
 
 /**
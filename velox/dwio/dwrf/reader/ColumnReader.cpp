@@ -24,6 +24,7 @@
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/DictionaryVector.h"
 #include "velox/vector/FlatVector.h"
+#include "velox/vector/SequenceVector.h"
 
 #include <folly/Likely.h>
 #include <folly/Portability.h>
@@ -288,12 +289,21 @@ void ByteRleColumnReader<DataType>::next(
 
 class IntegerDirectColumnReader : public ColumnReader {
  private:
+  // Minimum average run length for returning a batch as SequenceVector.
+  static constexpr vector_size_t kMinAverageRunLength = 16;
+
   std::unique_ptr<IntDecoder</*isSigned*/ true>> ints;
   const std::shared_ptr<const dwio::common::TypeWithId> type;
+  const bool returnSequenceVector_;
 
   template <typename T>
   BufferPtr allocateValues(uint64_t numValues, VectorPtr& result);
 
+  // Replaces flat 'result' without nulls by a SequenceVector if its values
+  // have an average run length of at least kMinAverageRunLength.
+  template <typename T>
+  void maybeEncodeRuns(VectorPtr& result);
+
  public:
   IntegerDirectColumnReader(
       const EncodingKey& ek,
@@ -313,7 +323,10 @@ IntegerDirectColumnReader::IntegerDirectColumnReader(
     const std::shared_ptr<const dwio::common::TypeWithId>& t,
     StripeStreams& stripe,
     uint32_t numBytes)
-    : ColumnReader(ek, stripe), type(t) {
+    : ColumnReader(ek, stripe),
+      type(t),
+      returnSequenceVector_(
+          stripe.getRowReaderOptions().getReturnSequenceVector()) {
   auto data = ek.forKind(proto::Stream_Kind_DATA);
   bool dataVInts = stripe.getUseVInts(data);
   ints = IntDecoder</*isSigned*/ true>::createDirect(
@@ -341,10 +354,49 @@ BufferPtr IntegerDirectColumnReader::allocateValues(
   return values;
 }
 
+template <typename T>
+void IntegerDirectColumnReader::maybeEncodeRuns(VectorPtr& result) {
+  auto size = result->size();
+  if (result->getNullCount().value_or(1) != 0 ||
+      size < kMinAverageRunLength) {
+    return;
+  }
+  auto rawValues = result->asFlatVector<T>()->rawValues();
+  vector_size_t numRuns = 1;
+  for (vector_size_t i = 1; i < size; ++i) {
+    numRuns += rawValues[i] != rawValues[i - 1];
+  }
+  if (numRuns * kMinAverageRunLength > size) {
+    return;
+  }
+  auto runValues = AlignedBuffer::allocate<T>(numRuns, &memoryPool);
+  auto runLengths =
+      AlignedBuffer::allocate<vector_size_t>(numRuns, &memoryPool);
+  auto rawRunValues = runValues->asMutable<T>();
+  auto rawRunLengths = runLengths->asMutable<vector_size_t>();
+  vector_size_t run = 0;
+  vector_size_t runBegin = 0;
+  for (vector_size_t i = 1; i <= size; ++i) {
+    if (i == size || rawValues[i] != rawValues[runBegin]) {
+      rawRunValues[run] = rawValues[runBegin];
+      rawRunLengths[run++] = i - runBegin;
+      runBegin = i;
+    }
+  }
+  result = std::make_shared<SequenceVector<T>>(
+      &memoryPool,
+      size,
+      makeFlatVector<T>(&memoryPool, nullptr, 0, numRuns, runValues),
+      runLengths);
+}
+
 void IntegerDirectColumnReader::next(
     uint64_t numValues,
     VectorPtr& result,
     const uint64_t* incomingNulls) {
+  if (result && result->encoding() == VectorEncoding::Simple::SEQUENCE) {
+    result.reset();
+  }
   BufferPtr nulls = readNulls(numValues, result, incomingNulls);
   const auto* nullsPtr = nulls ? nulls->as<uint64_t>() : nullptr;
   uint64_t nullCount = nullsPtr ? bits::countNulls(nullsPtr, 0, numValues) : 0;
@@ -363,6 +415,9 @@ void IntegerDirectColumnReader::next(
         result = makeFlatVector<int16_t>(
             &memoryPool, nulls, nullCount, numValues, values);
       }
+      if (returnSequenceVector_) {
+        maybeEncodeRuns<int16_t>(result);
+      }
       break;
     case TypeKind::INTEGER:
       values = allocateValues<int32_t>(numValues, result);
@@ -371,6 +426,9 @@ void IntegerDirectColumnReader::next(
         result = makeFlatVector<int32_t>(
             &memoryPool, nulls, nullCount, numValues, values);
       }
+      if (returnSequenceVector_) {
+        maybeEncodeRuns<int32_t>(result);
+      }
       break;
     case TypeKind::BIGINT:
       values = allocateValues<int64_t>(numValues, result);
@@ -379,6 +437,9 @@ void IntegerDirectColumnReader::next(
         result = makeFlatVector<int64_t>(
             &memoryPool, nulls, nullCount, numValues, values);
       }
+      if (returnSequenceVector_) {
+        maybeEncodeRuns<int64_t>(result);
+      }
       break;
     default:
       DWIO_RAISE("uknown batch type: ", typeid(type).name());
@@ -836,6 +897,12 @@ class StringDictionaryColumnReader : public ColumnReader {
  private:
   void loadStrideDictionary();
 
+  // Set if the stripe dictionary is shared through the
+  // SharedDictionaryCache.
+  std::optional<SharedDictionaryKey> sharedDictionaryKey_;
+  // The shared stripe dictionary. 'dictionaryBlob' and 'dictionaryOffset'
+  // are its buffers.
+  std::shared_ptr<const SharedDictionary> sharedDictionary_;
   BufferPtr dictionaryBlob;
   BufferPtr dictionaryOffset;
   BufferPtr inDict;
@@ -871,7 +938,8 @@ class StringDictionaryColumnReader : public ColumnReader {
       uint64_t count,
       SeekableInputStream& data,
       IntDecoder</*isSigned*/ false>& lengthDecoder,
-      BufferPtr& offsets);
+      BufferPtr& offsets,
+      memory::MemoryPool& pool);
 
   bool FOLLY_ALWAYS_INLINE setOutput(
       uint64_t index,
@@ -945,6 +1013,10 @@ StringDictionaryColumnReader::StringDictionaryColumnReader(
 
   blobStream =
       stripe.getStream(ek.forKind(proto::Stream_Kind_DICTIONARY_DATA), false);
+  SharedDictionaryKey sharedKey;
+  if (stripe.getSharedDictionaryKey(ek, sharedKey)) {
+    sharedDictionaryKey_ = sharedKey;
+  }
 
   // handle in dictionary stream
   std::unique_ptr<SeekableInputStream> inDictStream =
@@ -986,7 +1058,8 @@ BufferPtr StringDictionaryColumnReader::loadDictionary(
     uint64_t count,
     SeekableInputStream& data,
     IntDecoder</*isSigned*/ false>& lengthDecoder,
-    BufferPtr& offsets) {
+    BufferPtr& offsets,
+    memory::MemoryPool& pool) {
   // read lengths from length reader
   auto* offsetsPtr = offsets->asMutable<int64_t>();
   offsetsPtr[0] = 0;
@@ -1000,7 +1073,7 @@ BufferPtr StringDictionaryColumnReader::loadDictionary(
 
   // read bytes from underlying string
   int64_t blobSize = offsetsPtr[count];
-  BufferPtr dictionary = AlignedBuffer::allocate<char>(blobSize, &memoryPool);
+  BufferPtr dictionary = AlignedBuffer::allocate<char>(blobSize, &pool);
   data.readFully(dictionary->asMutable<char>(), blobSize);
   return dictionary;
 }
@@ -1027,7 +1100,8 @@ void StringDictionaryColumnReader::loadStrideDictionary() {
         strideDictCount,
         *strideDictStream,
         *strideDictLengthDecoder,
-        strideDictOffset);
+        strideDictOffset,
+        memoryPool);
   } else {
     strideDict.reset();
   }
@@ -1211,6 +1285,9 @@ void StringDictionaryColumnReader::readDictionaryVector(
 
     dictionaryValues = combinedDictionaryValues_;
   } else {
+    if (!dictionaryValues_ && sharedDictionary_) {
+      dictionaryValues_ = sharedDictionary_->values;
+    }
     if (!dictionaryValues_) {
       // TODO Reuse memory
       BufferPtr values =
@@ -1275,7 +1352,7 @@ void StringDictionaryColumnReader::readFlatVector(
     strideDictOffsetPtr = strideDictOffset->asMutable<int64_t>();
   }
   auto* dictionaryBlobPtr = dictionaryBlob->as<char>();
-  auto* dictionaryOffsetsPtr = dictionaryOffset->asMutable<int64_t>();
+  auto* dictionaryOffsetsPtr = dictionaryOffset->as<int64_t>();
   bool hasStrideDict = false;
   const char* strData;
   int64_t strLen;
@@ -1334,9 +1411,33 @@ void StringDictionaryColumnReader::ensureInitialized() {
     return;
   }
 
-  ensureCapacity<int64_t>(dictionaryOffset, dictionaryCount + 1, &memoryPool);
-  dictionaryBlob = loadDictionary(
-      dictionaryCount, *blobStream, *lengthDecoder, dictionaryOffset);
+  if (sharedDictionaryKey_) {
+    sharedDictionary_ = SharedDictionaryCache::instance().get(
+        *sharedDictionaryKey_, [&](memory::MemoryPool& pool) {
+          auto dictionary = std::make_shared<SharedDictionary>();
+          dictionary->offsets =
+              AlignedBuffer::allocate<int64_t>(dictionaryCount + 1, &pool);
+          dictionary->blob = loadDictionary(
+              dictionaryCount,
+              *blobStream,
+              *lengthDecoder,
+              dictionary->offsets,
+              pool);
+          dictionary->makeValues(type_, dictionaryCount, pool);
+          return dictionary;
+        });
+    dictionaryBlob = sharedDictionary_->blob;
+    dictionaryOffset = sharedDictionary_->offsets;
+  } else {
+    ensureCapacity<int64_t>(
+        dictionaryOffset, dictionaryCount + 1, &memoryPool);
+    dictionaryBlob = loadDictionary(
+        dictionaryCount,
+        *blobStream,
+        *lengthDecoder,
+        dictionaryOffset,
+        memoryPool);
+  }
   dictionaryValues_.reset();
   combinedDictionaryValues_.reset();
 
@@ -140,6 +140,12 @@ uint64_t DwrfRowReaderShared::seekToRow(uint64_t rowNumber) {
   return previousRow;
 }
 
+void DwrfRowReaderShared::loadFirstStripe() {
+  if (currentStripe < lastStripe && currentRowInStripe == 0) {
+    startNextStripe();
+  }
+}
+
 uint64_t DwrfRowReaderShared::skipRows(uint64_t numberOfRowsToSkip) {
   if (isEmptyFile()) {
     LOG(INFO) << "Empty file, nothing to skip";
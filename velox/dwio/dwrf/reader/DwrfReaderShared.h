@@ -111,6 +111,11 @@ class DwrfRowReaderShared : public StrideIndexProvider,
 
   uint64_t seekToRow(uint64_t rowNumber);
 
+  // Loads the first stripe in range and schedules the reads of its
+  // streams if no stripe is loaded yet. Lets the IO start before the
+  // first read. Does nothing if there are no stripes in range.
+  void loadFirstStripe();
+
   uint64_t skipRows(uint64_t numberOfRowsToSkip);
 
   uint64_t getStrideIndex() const override {
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <gflags/gflags.h>
+
+DECLARE_int32(velox_file_metadata_cache_mb);
+
+namespace facebook::velox::dwrf {
+
+int64_t FileMetadata::size() const {
+  int64_t size = sizeof(FileMetadata) + postScript->SpaceUsedLong();
+  if (arena) {
+    size += arena->SpaceAllocated();
+  }
+  if (stripeCache) {
+    size += stripeCache->capacity();
+  }
+  return size;
+}
+
+FileMetadataCache::FileMetadataCache(int64_t maxBytes)
+    : maxBytes_(maxBytes),
+      pool_(memory::getDefaultScopedMemoryPool()),
+      cache_(maxBytes) {}
+
+// static
+FileMetadataCache& FileMetadataCache::instance() {
+  // Not destroyed at exit because the entries hold leases on fileIds().
+  static FileMetadataCache* cache = new FileMetadataCache(
+      static_cast<int64_t>(FLAGS_velox_file_metadata_cache_mb) << 20);
+  return *cache;
+}
+
+std::shared_ptr<const FileMetadata> FileMetadataCache::find(
+    const FileMetadataKey& key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto* entry = cache_.get(key);
+  if (!entry) {
+    ++numMisses_;
+    return nullptr;
+  }
+  auto metadata = entry->metadata;
+  cache_.release(key);
+  ++numHits_;
+  return metadata;
+}
+
+void FileMetadataCache::insert(
+    const FileMetadataKey& key,
+    std::shared_ptr<const FileMetadata> metadata) {
+  auto size = metadata->size();
+  if (size > maxBytes_) {
+    return;
+  }
+  auto entry = std::make_unique<Entry>(
+      Entry{StringIdLease(fileIds(), key.fileNum), std::move(metadata)});
+  std::lock_guard<std::mutex> l(mutex_);
+  if (cache_.add(key, entry.get(), size)) {
+    entry.release();
+  }
+}
+
+} // namespace facebook::velox::dwrf
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <folly/hash/Hash.h>
+#include <atomic>
+#include <mutex>
+
+#include "velox/common/caching/SimpleLRUCache.h"
+#include "velox/common/caching/StringIdMap.h"
+#include "velox/common/memory/Memory.h"
+#include "velox/dwio/common/DataBuffer.h"
+#include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
+#include "velox/type/Type.h"
+
+namespace facebook::velox::dwrf {
+
+// Parsed tail of a DWRF file: the postscript, the footer with the file
+// stats and the stripe index and footer cache section. Immutable and
+// shared by the readers of the file.
+struct FileMetadata {
+  std::unique_ptr<google::protobuf::Arena> arena;
+  std::unique_ptr<proto::PostScript> postScript;
+  // Allocated in 'arena'.
+  proto::Footer* footer{nullptr};
+  std::shared_ptr<const RowType> schema;
+  // Content of the stripe metadata cache section. nullptr if the file
+  // has none.
+  std::shared_ptr<dwio::common::DataBuffer<char>> stripeCache;
+  uint64_t fileLength{0};
+  uint64_t psLength{0};
+
+  // Returns the approximate memory footprint.
+  int64_t size() const;
+};
+
+// Identifies a version of a file. 'modificationTime' tells apart a file
+// that is rewritten under the same name.
+struct FileMetadataKey {
+  uint64_t fileNum;
+  int64_t modificationTime;
+
+  bool operator==(const FileMetadataKey& other) const {
+    return fileNum == other.fileNum &&
+        modificationTime == other.modificationTime;
+  }
+};
+
+struct FileMetadataKeyHasher {
+  size_t operator()(const FileMetadataKey& key) const {
+    return folly::hash::hash_combine(key.fileNum, key.modificationTime);
+  }
+};
+
+// Process-wide cache of FileMetadata, so that readers of a hot file
+// neither read nor parse its tail again. Bounded by the size of the
+// cached metadata. Thread-safe.
+class FileMetadataCache {
+ public:
+  explicit FileMetadataCache(int64_t maxBytes);
+
+  // Returns the instance sized by --velox_file_metadata_cache_mb.
+  static FileMetadataCache& instance();
+
+  // Returns the metadata for 'key' or nullptr if it is not cached.
+  std::shared_ptr<const FileMetadata> find(const FileMetadataKey& key);
+
+  // Adds 'metadata' for 'key'. The stripe cache buffer of 'metadata'
+  // must be allocated from pool() so that it can outlive the query
+  // that read it. Does nothing if 'key' is already cached or
+  // 'metadata' does not fit.
+  void insert(
+      const FileMetadataKey& key,
+      std::shared_ptr<const FileMetadata> metadata);
+
+  // Pool for the buffers of cached metadata.
+  memory::MemoryPool& pool() {
+    return *pool_;
+  }
+
+  int64_t maxBytes() const {
+    return maxBytes_;
+  }
+
+  int64_t numHits() const {
+    return numHits_;
+  }
+
+  int64_t numMisses() const {
+    return numMisses_;
+  }
+
+ private:
+  struct Entry {
+    // Keeps the file number of the key from being reused for another
+    // file while the entry is cached.
+    StringIdLease fileLease;
+    std::shared_ptr<const FileMetadata> metadata;
+  };
+
+  const int64_t maxBytes_;
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::mutex mutex_;
+  SimpleLRUCache<
+      FileMetadataKey,
+      Entry,
+      std::equal_to<FileMetadataKey>,
+      FileMetadataKeyHasher>
+      cache_;
+  std::atomic<int64_t> numHits_{0};
+  std::atomic<int64_t> numMisses_{0};
+};
+
+} // namespace facebook::velox::dwrf
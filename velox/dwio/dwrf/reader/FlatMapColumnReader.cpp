@@ -51,23 +51,25 @@ StringKeyBuffer::StringKeyBuffer(
 namespace {
 
 template <typename T>
-KeyValue<T> extractKey(const proto::KeyInfo& info) {
-  return KeyValue<T>(info.intkey());
+KeyValue<T> convertDynamic(const folly::dynamic& v) {
+  return KeyValue<T>(v.asInt());
 }
 
 template <>
-KeyValue<StringView> extractKey<StringView>(const proto::KeyInfo& info) {
-  return KeyValue<StringView>(StringView(info.byteskey()));
+KeyValue<StringView> convertDynamic<StringView>(const folly::dynamic& v) {
+  return KeyValue<StringView>(StringView(v.asString()));
 }
 
+} // namespace
+
 template <typename T>
-KeyValue<T> convertDynamic(const folly::dynamic& v) {
-  return KeyValue<T>(v.asInt());
+KeyValue<T> extractKey(const proto::KeyInfo& info) {
+  return KeyValue<T>(info.intkey());
 }
 
 template <>
-KeyValue<StringView> convertDynamic<StringView>(const folly::dynamic& v) {
-  return KeyValue<StringView>(StringView(v.asString()));
+KeyValue<StringView> extractKey<StringView>(const proto::KeyInfo& info) {
+  return KeyValue<StringView>(StringView(info.byteskey()));
 }
 
 template <typename T>
@@ -89,6 +91,8 @@ void forEachConfiguredKey(
   }
 }
 
+namespace {
+
 template <typename T>
 std::vector<std::unique_ptr<KeyNode<T>>> getKeyNodesFiltered(
     const std::function<bool(const KeyValue<T>&)>& keyPredicate,
@@ -607,12 +611,6 @@ void FlatMapStructEncodingColumnReader<T>::next(
   }
 }
 
-inline bool isRequiringStructEncoding(
-    const std::shared_ptr<const dwio::common::TypeWithId>& requestedType,
-    const dwio::common::RowReaderOptions& rowOptions) {
-  return rowOptions.getMapColumnIdAsStruct().count(requestedType->id) > 0;
-}
-
 template <typename T>
 std::unique_ptr<ColumnReader> createFlatMapColumnReader(
     EncodingKey& ek,
@@ -671,4 +669,30 @@ template class FlatMapStructEncodingColumnReader<int32_t>;
 template class FlatMapStructEncodingColumnReader<int64_t>;
 template class FlatMapStructEncodingColumnReader<StringView>;
 
+template KeyValue<int8_t> extractKey<int8_t>(const proto::KeyInfo&);
+template KeyValue<int16_t> extractKey<int16_t>(const proto::KeyInfo&);
+template KeyValue<int32_t> extractKey<int32_t>(const proto::KeyInfo&);
+template KeyValue<int64_t> extractKey<int64_t>(const proto::KeyInfo&);
+
+template void forEachConfiguredKey<int8_t>(
+    const std::function<void(KeyValue<int8_t>&&)>&,
+    const std::shared_ptr<const TypeWithId>&,
+    const StripeStreams&);
+template void forEachConfiguredKey<int16_t>(
+    const std::function<void(KeyValue<int16_t>&&)>&,
+    const std::shared_ptr<const TypeWithId>&,
+    const StripeStreams&);
+template void forEachConfiguredKey<int32_t>(
+    const std::function<void(KeyValue<int32_t>&&)>&,
+    const std::shared_ptr<const TypeWithId>&,
+    const StripeStreams&);
+template void forEachConfiguredKey<int64_t>(
+    const std::function<void(KeyValue<int64_t>&&)>&,
+    const std::shared_ptr<const TypeWithId>&,
+    const StripeStreams&);
+template void forEachConfiguredKey<StringView>(
+    const std::function<void(KeyValue<StringView>&&)>&,
+    const std::shared_ptr<const TypeWithId>&,
+    const StripeStreams&);
+
 } // namespace facebook::velox::dwrf
@@ -54,6 +54,29 @@ struct KeyValueHash {
   }
 };
 
+// Returns the key of the flat map value streams with 'info' as key info.
+template <typename T>
+KeyValue<T> extractKey(const proto::KeyInfo& info);
+
+template <>
+KeyValue<StringView> extractKey<StringView>(const proto::KeyInfo& info);
+
+// Calls 'cb' with each key of the flat map 'requestedType' that is
+// listed in the column selector of 'stripe', in the listed order.
+template <typename T>
+void forEachConfiguredKey(
+    const std::function<void(KeyValue<T>&&)>& cb,
+    const std::shared_ptr<const dwio::common::TypeWithId>& requestedType,
+    const StripeStreams& stripe);
+
+// True if the flat map 'requestedType' is read as a struct with one
+// field per key listed in the column selector.
+inline bool isRequiringStructEncoding(
+    const std::shared_ptr<const dwio::common::TypeWithId>& requestedType,
+    const dwio::common::RowReaderOptions& rowOptions) {
+  return rowOptions.getMapColumnIdAsStruct().count(requestedType->id) > 0;
+}
+
 class StringKeyBuffer;
 
 // represent a branch of a value node in a flat map
@@ -94,6 +94,16 @@ ReaderBase::ReaderBase(
       dataCacheConfig_(dataCacheConfig) {
   input_ = bufferedInputFactory_->create(*stream_, pool, dataCacheConfig);
 
+  // Another reader of the same file may have parsed the tail.
+  if (useFileMetadataCache()) {
+    if (auto metadata = FileMetadataCache::instance().find(fileMetadataKey())) {
+      setFromFileMetadata(std::move(metadata));
+      prefetchStripeFooters();
+      handler_ = DecryptionHandler::create(*footer_, factory);
+      return;
+    }
+  }
+
   // We may have cached the tail before, in which case we can skip the read.
   if (dataCacheConfig && dataCacheConfig->cache) {
     const std::string tailKey = TailKey(dataCacheConfig->filenum);
@@ -103,7 +113,7 @@ ReaderBase::ReaderBase(
       postScript_ = ProtoUtils::readProto<proto::PostScript>(
           std::make_unique<SeekableArrayInputStream>(
               tail.data() + tail.size() - 1 - psLength_, psLength_));
-      footer_ =
+      auto footer =
           google::protobuf::Arena::CreateMessage<proto::Footer>(arena_.get());
       ProtoUtils::readProtoInto(
           createDecompressedStream(
@@ -112,7 +122,8 @@ ReaderBase::ReaderBase(
                       postScript_->footerlength(),
                   postScript_->footerlength()),
               "File Footer"),
-          footer_);
+          footer);
+      footer_ = footer;
       schema_ = std::dynamic_pointer_cast<const RowType>(convertType(*footer_));
       DWIO_ENSURE_NOT_NULL(schema_, "invalid schema");
       if (postScript_->cachesize() > 0) {
@@ -185,22 +196,28 @@ ReaderBase::ReaderBase(
 
   auto footerStream = input_->read(
       fileLength_ - psLength_ - footerSize - 1, footerSize, LogType::FOOTER);
-  footer_ = google::protobuf::Arena::CreateMessage<proto::Footer>(arena_.get());
+  auto footer =
+      google::protobuf::Arena::CreateMessage<proto::Footer>(arena_.get());
   ProtoUtils::readProtoInto<proto::Footer>(
       createDecompressedStream(std::move(footerStream), "File Footer"),
-      footer_);
+      footer);
+  footer_ = footer;
 
   schema_ = std::dynamic_pointer_cast<const RowType>(convertType(*footer_));
   DWIO_ENSURE_NOT_NULL(schema_, "invalid schema");
 
   // load stripe index/footer cache
+  std::shared_ptr<dwio::common::DataBuffer<char>> cacheBuffer;
   if (cacheSize > 0) {
-    auto cacheBuffer =
+    cacheBuffer =
         std::make_shared<dwio::common::DataBuffer<char>>(pool, cacheSize);
     input_->read(fileLength_ - tailSize, cacheSize, LogType::FOOTER)
         ->readFully(cacheBuffer->data(), cacheSize);
     cache_ = std::make_unique<StripeMetadataCache>(
-        *postScript_, *footer_, std::move(cacheBuffer));
+        *postScript_, *footer_, cacheBuffer);
+  }
+  if (useFileMetadataCache()) {
+    addToFileMetadataCache(cacheBuffer);
   }
 
   // Insert the tail in the data cache so we can skip the disk read next time.
@@ -211,6 +228,12 @@ ReaderBase::ReaderBase(
     const std::string tailKey = TailKey(dataCacheConfig->filenum);
     dataCacheConfig->cache->put(tailKey, {tail.get(), tailSize});
   }
+  prefetchStripeFooters();
+  // initialize file decrypter
+  handler_ = DecryptionHandler::create(*footer_, factory);
+}
+
+void ReaderBase::prefetchStripeFooters() {
   if (input_->shouldPrefetchStripes()) {
     auto numStripes = getFooter().stripes_size();
     for (auto i = 0; i < numStripes; i++) {
@@ -223,8 +246,56 @@ ReaderBase::ReaderBase(
       input_->load(LogType::FOOTER);
     }
   }
-  // initialize file decrypter
-  handler_ = DecryptionHandler::create(*footer_, factory);
+}
+
+bool ReaderBase::useFileMetadataCache() const {
+  return dataCacheConfig_ && dataCacheConfig_->modificationTime != 0 &&
+      FileMetadataCache::instance().maxBytes() > 0;
+}
+
+FileMetadataKey ReaderBase::fileMetadataKey() const {
+  return FileMetadataKey{
+      dataCacheConfig_->filenum, dataCacheConfig_->modificationTime};
+}
+
+void ReaderBase::setFromFileMetadata(
+    std::shared_ptr<const FileMetadata> metadata) {
+  postScript_ = std::make_unique<proto::PostScript>(*metadata->postScript);
+  footer_ = metadata->footer;
+  schema_ = metadata->schema;
+  fileLength_ = metadata->fileLength;
+  psLength_ = metadata->psLength;
+  if (metadata->stripeCache) {
+    cache_ = std::make_unique<StripeMetadataCache>(
+        *postScript_, *footer_, metadata->stripeCache);
+  }
+  // Keeps 'footer_' and the stripe cache alive.
+  fileMetadata_ = std::move(metadata);
+}
+
+void ReaderBase::addToFileMetadataCache(
+    const std::shared_ptr<dwio::common::DataBuffer<char>>& stripeCache) {
+  auto& cache = FileMetadataCache::instance();
+  auto metadata = std::make_shared<FileMetadata>();
+  // The metadata outlives this reader, so it gets its own arena and
+  // buffers instead of sharing those of the query.
+  metadata->arena = std::make_unique<google::protobuf::Arena>();
+  metadata->postScript = std::make_unique<proto::PostScript>(*postScript_);
+  metadata->footer = google::protobuf::Arena::CreateMessage<proto::Footer>(
+      metadata->arena.get());
+  metadata->footer->CopyFrom(*footer_);
+  metadata->schema = schema_;
+  if (stripeCache) {
+    metadata->stripeCache = std::make_shared<dwio::common::DataBuffer<char>>(
+        cache.pool(), stripeCache->size());
+    memcpy(
+        metadata->stripeCache->data(),
+        stripeCache->data(),
+        stripeCache->size());
+  }
+  metadata->fileLength = fileLength_;
+  metadata->psLength = psLength_;
+  cache.insert(fileMetadataKey(), std::move(metadata));
 }
 
 std::vector<uint64_t> ReaderBase::getRowsPerStripe() const {
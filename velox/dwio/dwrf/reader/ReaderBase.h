@@ -21,6 +21,7 @@
 #include "velox/dwio/dwrf/common/Compression.h"
 #include "velox/dwio/dwrf/common/Statistics.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
 #include "velox/dwio/dwrf/reader/StripeMetadataCache.h"
 #include "velox/dwio/dwrf/utils/ProtoUtils.h"
 
@@ -228,11 +229,33 @@ class ReaderBase {
       const proto::Footer& footer,
       uint32_t index = 0);
 
+  // Enqueues the stripe footers for loading if the BufferedInput
+  // prefetches stripes.
+  void prefetchStripeFooters();
+
+  // True if the file has a known version and the process-wide
+  // FileMetadataCache is enabled.
+  bool useFileMetadataCache() const;
+
+  FileMetadataKey fileMetadataKey() const;
+
+  // Sets the postscript, footer, schema and stripe metadata cache from
+  // 'metadata'.
+  void setFromFileMetadata(std::shared_ptr<const FileMetadata> metadata);
+
+  // Adds a copy of the parsed tail to the FileMetadataCache.
+  // 'stripeCache' is the content of the stripe metadata cache section
+  // or nullptr.
+  void addToFileMetadataCache(
+      const std::shared_ptr<dwio::common::DataBuffer<char>>& stripeCache);
+
   memory::MemoryPool& pool_;
   std::unique_ptr<dwio::common::InputStream> stream_;
   std::unique_ptr<google::protobuf::Arena> arena_;
   std::unique_ptr<proto::PostScript> postScript_;
-  proto::Footer* footer_ = nullptr;
+  const proto::Footer* footer_ = nullptr;
+  // Set if 'footer_' is shared with other readers of the file.
+  std::shared_ptr<const FileMetadata> fileMetadata_;
   std::unique_ptr<StripeMetadataCache> cache_;
   std::unique_ptr<encryption::DecryptionHandler> handler_;
   BufferedInputFactory* bufferedInputFactory_ =
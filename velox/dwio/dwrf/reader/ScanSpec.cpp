@@ -285,6 +285,58 @@ bool testFilter(
   return true;
 }
 
+bool testBloomFilter(
+    const common::Filter& filter,
+    const common::BloomFilter& bloomFilter) {
+  // Bitmask filters with more values than this are not probed one by one.
+  constexpr int64_t kMaxBitmaskValues = 1'000;
+  switch (filter.kind()) {
+    case common::FilterKind::kBigintRange: {
+      auto range = static_cast<const common::BigintRange*>(&filter);
+      return !range->isSingleValue() || bloomFilter.testInt64(range->lower());
+    }
+    case common::FilterKind::kBigintValuesUsingHashTable: {
+      auto values =
+          static_cast<const common::BigintValuesUsingHashTable*>(&filter);
+      for (auto value : values->values()) {
+        if (bloomFilter.testInt64(value)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case common::FilterKind::kBigintValuesUsingBitmask: {
+      auto values =
+          static_cast<const common::BigintValuesUsingBitmask*>(&filter);
+      if (values->max() - values->min() >= kMaxBitmaskValues) {
+        return true;
+      }
+      for (auto value = values->min(); value <= values->max(); ++value) {
+        if (filter.testInt64(value) && bloomFilter.testInt64(value)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case common::FilterKind::kBytesRange: {
+      auto range = static_cast<const common::BytesRange*>(&filter);
+      return !range->isSingleValue() ||
+          bloomFilter.testBytes(range->lower().data(), range->lower().size());
+    }
+    case common::FilterKind::kBytesValues: {
+      auto values = static_cast<const common::BytesValues*>(&filter);
+      for (const auto& value : values->values()) {
+        if (bloomFilter.testBytes(value.data(), value.size())) {
+          return true;
+        }
+      }
+      return false;
+    }
+    default:
+      return true;
+  }
+}
+
 ScanSpec& ScanSpec::getChildByChannel(ChannelIndex channel) {
   for (auto& child : children_) {
     if (child->channel_ == channel) {
@@ -23,6 +23,7 @@
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/LazyVector.h"
 
+#include <limits>
 #include <vector>
 
 namespace facebook {
@@ -32,6 +33,28 @@ class ColumnStatistics;
 }
 namespace common {
 
+// Filter on more than one field of a struct, e.g. the remaining filter
+// of a table scan. Set on the ScanSpec of the struct. The struct reader
+// calls it on the values of the input fields for the rows that pass
+// the single field filters, before reading the fields without filters,
+// so that these are read only for the rows that pass both.
+class RowFilter {
+ public:
+  virtual ~RowFilter() = default;
+
+  // True if the field produced at 'channel' of the struct is an input.
+  virtual bool isInput(ChannelIndex channel) const = 0;
+
+  // Returns the number of the 'size' rows that pass. If this is less
+  // than 'size', 'indices' is set to the positions of the passing
+  // rows. 'inputs' has the values of the inputs at their channels and
+  // nullptr at the other positions.
+  virtual vector_size_t filter(
+      const std::vector<VectorPtr>& inputs,
+      vector_size_t size,
+      BufferPtr& indices) = 0;
+};
+
 // Describes the filtering and value extraction for a
 // SelectiveColumnReader. This is owned by the TableScan Operator and
 // is passed to SelectiveColumnReaders at construction.  This is
@@ -41,12 +64,25 @@ class ScanSpec {
   static constexpr ChannelIndex kNoChannel = ~0;
 
   explicit ScanSpec(const Subfield::PathElement& element) {
-    if (element.kind() == kNestedField) {
-      auto field = reinterpret_cast<const Subfield::NestedField*>(&element);
-      fieldName_ = field->name();
-
-    } else {
-      VELOX_CHECK(false, "Only nested fields are supported");
+    switch (element.kind()) {
+      case kNestedField:
+        fieldName_ =
+            reinterpret_cast<const Subfield::NestedField*>(&element)->name();
+        break;
+      case kStringSubscript:
+        // The values of a string key in a flat map.
+        fieldName_ = reinterpret_cast<const Subfield::StringSubscript*>(
+                         &element)
+                         ->index();
+        break;
+      case kLongSubscript:
+        // The values of an integer key in a flat map.
+        subscript_ =
+            reinterpret_cast<const Subfield::LongSubscript*>(&element)->index();
+        fieldName_ = std::to_string(subscript_);
+        break;
+      default:
+        VELOX_CHECK(false, "Only nested fields and subscripts are supported");
     }
   }
 
@@ -60,9 +96,11 @@ class ScanSpec {
   }
 
   // Sets 'filter_'. May be used at initialization or when adding a
-  // pushed down filter, e.g. top k cutoff.
+  // pushed down filter, e.g. top k cutoff. The selectivity measured
+  // for the previous filter does not apply to the new one.
   void setFilter(std::unique_ptr<Filter> filter) {
     filter_ = std::move(filter);
+    selectivity_ = SelectivityInfo();
   }
 
   // Returns a constant vector if 'this' corresponds to a partitioning
@@ -205,6 +243,16 @@ class ScanSpec {
     valueHook_ = valueHook;
   }
 
+  // Filter on the children of a struct. Not owned. nullptr if there is
+  // no filter over more than one child.
+  RowFilter* rowFilter() const {
+    return rowFilter_;
+  }
+
+  void setRowFilter(RowFilter* rowFilter) {
+    rowFilter_ = rowFilter;
+  }
+
   // Returns true if the corresponding reader only needs to reference
   // the nulls stream. True if filter is is-null with or without value
   // extraction or if filter is is-not-null and no value is extracted.
@@ -251,6 +299,27 @@ class ScanSpec {
   // Returns the child which produces values for 'channel'. Throws if not found.
   ScanSpec& getChildByChannel(ChannelIndex channel);
 
+  // For a map, filter on the keys of the entries that are read. The
+  // other entries are skipped. Unlike filter(), this does not drop
+  // rows. nullptr if all entries are read.
+  common::Filter* mapKeyFilter() const {
+    return mapKeyFilter_.get();
+  }
+
+  void setMapKeyFilter(std::unique_ptr<Filter> filter) {
+    mapKeyFilter_ = std::move(filter);
+  }
+
+  // For an array, the number of leading elements that are read. The
+  // other elements are skipped.
+  vector_size_t maxArrayElementsCount() const {
+    return maxArrayElementsCount_;
+  }
+
+  void setMaxArrayElementsCount(vector_size_t count) {
+    maxArrayElementsCount_ = count;
+  }
+
  private:
   void reorder();
 
@@ -279,6 +348,11 @@ class ScanSpec {
   // returned as flat.
   bool makeFlat_ = false;
   std::unique_ptr<common::Filter> filter_;
+  // Subfield pruning of maps and arrays. These do not filter rows and
+  // are not reflected in hasFilter().
+  std::unique_ptr<common::Filter> mapKeyFilter_;
+  vector_size_t maxArrayElementsCount_ =
+      std::numeric_limits<vector_size_t>::max();
   SelectivityInfo selectivity_;
   // Sort children by filtering efficiency.
   bool enableFilterReorder_ = true;
@@ -300,6 +374,7 @@ class ScanSpec {
   std::vector<std::unique_ptr<ScanSpec>> children_;
   mutable std::optional<bool> hasFilter_;
   ValueHook* valueHook_ = nullptr;
+  RowFilter* rowFilter_ = nullptr;
 };
 
 // Returns false if no value from a range defined by stats can pass the
@@ -310,6 +385,12 @@ bool testFilter(
     uint64_t totalRows,
     const TypePtr& type);
 
+// Returns false if no value that passes 'filter' is in 'bloomFilter'. True,
+// otherwise. Does not consider nulls, which are not in Bloom filters.
+bool testBloomFilter(
+    const common::Filter& filter,
+    const common::BloomFilter& bloomFilter);
+
 } // namespace common
 } // namespace velox
 } // namespace facebook
@@ -17,16 +17,19 @@
 #include "velox/dwio/dwrf/reader/SelectiveColumnReader.h"
 
 #include "velox/aggregates/AggregationHook.h"
+#include "velox/common/base/AsyncSource.h"
 #include "velox/common/base/Portability.h"
 #include "velox/dwio/common/TypeUtils.h"
 #include "velox/dwio/dwrf/common/DirectDecoder.h"
 #include "velox/dwio/dwrf/common/FloatingPointDecoder.h"
 #include "velox/dwio/dwrf/common/RLEv1.h"
+#include "velox/dwio/dwrf/reader/FlatMapColumnReader.h"
 #include "velox/dwio/dwrf/utils/ProtoUtils.h"
 #include "velox/vector/ConstantVector.h"
 #include "velox/vector/DictionaryVector.h"
 #include "velox/vector/FlatVector.h"
 
+#include <folly/ScopeGuard.h>
 #include <numeric>
 
 namespace facebook::velox::dwrf {
@@ -68,6 +71,24 @@ inline RleVersion convertRleVersion(proto::ColumnEncoding_Kind kind) {
       DWIO_RAISE("Unknown encoding in convertRleVersion");
   }
 }
+
+// Returns false if no value that passes 'filter' is in row group 'index'
+// by the Bloom filter written for the row group.
+bool testRowGroupBloomFilter(
+    const common::Filter& filter,
+    const proto::BloomFilterIndex& bloomFilters,
+    int32_t index) {
+  const auto& bits = bloomFilters.bloomfilter(index).utf8bitset();
+  // The filter has blocks of 8 words.
+  constexpr int32_t kBlockBytes = 8 * sizeof(uint32_t);
+  if (bits.empty() || bits.size() % kBlockBytes != 0) {
+    return true;
+  }
+  auto words =
+      std::make_shared<std::vector<uint32_t>>(bits.size() / sizeof(uint32_t));
+  memcpy(words->data(), bits.data(), bits.size());
+  return common::testBloomFilter(filter, common::BloomFilter(words));
+}
 } // namespace
 
 SelectiveColumnReader::SelectiveColumnReader(
@@ -84,25 +105,45 @@ SelectiveColumnReader::SelectiveColumnReader(
     indexStream_ =
         stripe.getStream(ek.forKind(proto::Stream_Kind_ROW_INDEX), false);
   }
+  if (scanSpec->filter()) {
+    bloomFilterStream_ = stripe.getStream(
+        ek.forKind(proto::Stream_Kind_BLOOM_FILTER_UTF8), false);
+  }
 }
 
 std::vector<uint32_t> SelectiveColumnReader::filterRowGroups(
     uint64_t rowGroupSize,
-    const StatsContext& context) const {
+    const StatsContext& context) {
   ensureRowGroupIndex();
   auto filter = scanSpec_->filter();
   if (!index_ || !filter) {
     return ColumnReader::filterRowGroups(rowGroupSize, context);
   }
 
+  // Bloom filters do not have the nulls of the row group.
+  std::unique_ptr<proto::BloomFilterIndex> bloomFilters;
+  if (bloomFilterStream_ && !filter->testNull()) {
+    bloomFilters = ProtoUtils::readProto<proto::BloomFilterIndex>(
+        std::move(bloomFilterStream_));
+    DWIO_ENSURE_EQ(bloomFilters->bloomfilter_size(), index_->entry_size());
+  }
   std::vector<uint32_t> stridesToSkip;
   for (auto i = 0; i < index_->entry_size(); i++) {
     const auto& entry = index_->entry(i);
     auto columnStats = ColumnStatistics::fromProto(entry.statistics(), context);
     if (!testFilter(filter, columnStats.get(), rowGroupSize, type_)) {
       stridesToSkip.push_back(i); // Skipping stride based on column stats.
+    } else if (
+        bloomFilters && !testRowGroupBloomFilter(*filter, *bloomFilters, i)) {
+      stridesToSkip.push_back(i);
     }
   }
+  if (stridesToSkip.size() < index_->entry_size() && !filter->testNull() &&
+      filter->isDeterministic() && !filterDictionary(*filter)) {
+    // No value of the stripe passes.
+    stridesToSkip.resize(index_->entry_size());
+    std::iota(stridesToSkip.begin(), stridesToSkip.end(), 0);
+  }
   return stridesToSkip;
 }
 
@@ -1209,6 +1250,9 @@ void SelectiveByteRleColumnReader::processFilter(
       readHelper<common::BigintValuesUsingBitmask, isDense>(
           filter, rows, extractValues);
       break;
+    case FilterKind::kBloomFilter:
+      readHelper<common::BloomFilter, isDense>(filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -1418,6 +1462,9 @@ void SelectiveIntegerDirectColumnReader::processFilter(
       readHelper<common::BigintValuesUsingBitmask, isDense>(
           filter, rows, extractValues);
       break;
+    case FilterKind::kBloomFilter:
+      readHelper<common::BloomFilter, isDense>(filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -1487,6 +1534,19 @@ void SelectiveIntegerDirectColumnReader::read(
 
 enum FilterResult { kUnknown = 0x40, kSuccess = 0x80, kFailure = 0 };
 
+// Sets 'filterCache' to the result of 'test' for each of 'size'
+// dictionary entries. Returns true if any entry passes.
+template <typename Test>
+bool filterDictionaryEntries(uint64_t size, uint8_t* filterCache, Test test) {
+  bool anyPassed = false;
+  for (uint64_t i = 0; i < size; ++i) {
+    bool passed = test(i);
+    filterCache[i] = passed ? FilterResult::kSuccess : FilterResult::kFailure;
+    anyPassed |= passed;
+  }
+  return anyPassed;
+}
+
 template <typename T>
 inline __m256si load8Indices(const T* /*input*/) {
   VELOX_FAIL("Unsupported dictionary index type");
@@ -2017,6 +2077,9 @@ class SelectiveIntegerDictionaryColumnReader : public SelectiveColumnReader {
     getIntValues(rows, requestedType_.get(), result);
   }
 
+ protected:
+  bool filterDictionary(common::Filter& filter) override;
+
  private:
   template <typename ColumnVisitor>
   void readWithVisitor(RowSet rows, ColumnVisitor visitor);
@@ -2186,6 +2249,9 @@ void SelectiveIntegerDictionaryColumnReader::processFilter(
       readHelper<common::BigintValuesUsingBitmask, isDense>(
           filter, rows, extractValues);
       break;
+    case FilterKind::kBloomFilter:
+      readHelper<common::BloomFilter, isDense>(filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -2276,6 +2342,37 @@ void SelectiveIntegerDictionaryColumnReader::ensureInitialized() {
   initTimeClocks_ = timer.elapsedClocks();
 }
 
+bool SelectiveIntegerDictionaryColumnReader::filterDictionary(
+    common::Filter& filter) {
+  if (inDictionaryReader_) {
+    return true;
+  }
+  ensureInitialized();
+  auto* filterCache = filterCache_.data();
+  switch (valueSize_) {
+    case 2: {
+      auto* values = dictionary_->as<int16_t>();
+      return filterDictionaryEntries(dictionarySize_, filterCache, [&](auto i) {
+        return filter.testInt64(values[i]);
+      });
+    }
+    case 4: {
+      auto* values = dictionary_->as<int32_t>();
+      return filterDictionaryEntries(dictionarySize_, filterCache, [&](auto i) {
+        return filter.testInt64(values[i]);
+      });
+    }
+    case 8: {
+      auto* values = dictionary_->as<int64_t>();
+      return filterDictionaryEntries(dictionarySize_, filterCache, [&](auto i) {
+        return filter.testInt64(values[i]);
+      });
+    }
+    default:
+      VELOX_FAIL("Unsupported valueSize_ {}", valueSize_);
+  }
+}
+
 template <typename TData, typename TRequested>
 class SelectiveFloatingPointColumnReader : public SelectiveColumnReader {
  public:
@@ -2520,6 +2617,12 @@ class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
     rawStringBuffer_ = nullptr;
     rawStringSize_ = 0;
     rawStringUsed_ = 0;
+    if (!allNull_) {
+      // Pinned buffers are not writable, so they are added only when
+      // 'stringBuffers_' is handed to the result.
+      stringBuffers_.insert(
+          stringBuffers_.end(), streamBuffers_.begin(), streamBuffers_.end());
+    }
     getFlatValues<StringView, StringView>(rows, result, type_);
   }
 
@@ -2529,6 +2632,14 @@ class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
 
   folly::StringPiece readValue(int32_t length);
 
+  // Pins the buffer of 'blobStream_' that holds [bufferStart_,
+  // bufferEnd_) so that values in it can be referenced instead of
+  // copied. No-op if already done for this buffer.
+  void pinStreamBuffer();
+
+  // Drops the pins that cannot back values of the next batch.
+  void releaseStreamBuffers();
+
   template <bool hasNulls, typename Visitor>
   void decode(const uint64_t* nulls, Visitor visitor);
 
@@ -2574,6 +2685,11 @@ class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
   // Storage for a string straddling a buffer boundary. Needed for calling
   // the filter.
   std::string tempString_;
+  // Pins of 'blobStream_' buffers that values of the current batch may
+  // refer to. The last one covers 'pinnedStart_' to 'pinnedEnd_'.
+  std::vector<BufferPtr> streamBuffers_;
+  // Value of 'bufferEnd_' at the last pinStreamBuffer().
+  const char* pinCheckedEnd_ = nullptr;
 };
 
 SelectiveStringDirectColumnReader::SelectiveStringDirectColumnReader(
@@ -2594,6 +2710,39 @@ SelectiveStringDirectColumnReader::SelectiveStringDirectColumnReader(
   blobStream_ = stripe.getStream(ek.forKind(proto::Stream_Kind_DATA), true);
 }
 
+void SelectiveStringDirectColumnReader::pinStreamBuffer() {
+  if (!mayUseStreamBuffer_ || bufferEnd_ == pinCheckedEnd_) {
+    return;
+  }
+  pinCheckedEnd_ = bufferEnd_;
+  pinnedStart_ = nullptr;
+  pinnedEnd_ = nullptr;
+  auto pin = blobStream_->pinLastBuffer();
+  if (!pin) {
+    return;
+  }
+  auto start = pin->as<char>();
+  auto end = start + pin->size();
+  if (bufferStart_ < start || bufferEnd_ > end) {
+    return;
+  }
+  pinnedStart_ = start;
+  pinnedEnd_ = end;
+  streamBuffers_.push_back(std::move(pin));
+}
+
+void SelectiveStringDirectColumnReader::releaseStreamBuffers() {
+  if (mayUseStreamBuffer_ && pinnedStart_) {
+    // The current buffer may also back values of the next batch.
+    streamBuffers_.erase(streamBuffers_.begin(), streamBuffers_.end() - 1);
+    return;
+  }
+  streamBuffers_.clear();
+  pinnedStart_ = nullptr;
+  pinnedEnd_ = nullptr;
+  pinCheckedEnd_ = nullptr;
+}
+
 uint64_t SelectiveStringDirectColumnReader::skip(uint64_t numValues) {
   numValues = ColumnReader::skip(numValues);
   ensureCapacity<int64_t>(lengths_, numValues, &memoryPool);
@@ -2624,7 +2773,8 @@ void SelectiveStringDirectColumnReader::extractCrossBuffers(
       addValue(value);
     } else {
       auto index = outerNonNullRows_[rowIndex + i];
-      if (size <= StringView::kInlineSize) {
+      if (size <= StringView::kInlineSize ||
+          (value.data() >= pinnedStart_ && value.end() <= pinnedEnd_)) {
         reinterpret_cast<StringView*>(rawValues_)[index] =
             StringView(value.data(), size);
       } else {
@@ -2726,6 +2876,13 @@ inline bool SelectiveStringDirectColumnReader::try8Consecutive(
           reinterpret_cast<char*>(result + resultIndex + 1) + length) = 0;
       continue;
     }
+    pinStreamBuffer();
+    if (pinnedStart_) {
+      // The pin covers the whole buffer, so the value can be referenced.
+      *reinterpret_cast<const char**>(result + resultIndex + 2) = data;
+      data += length;
+      continue;
+    }
     if (!rawStringBuffer_ || rawUsed + length > rawStringSize_) {
       // Slow path if no space in raw strings
       return false;
@@ -2802,6 +2959,9 @@ folly::StringPiece SelectiveStringDirectColumnReader::readValue(
   skipBytes(bytesToSkip_, blobStream_.get(), bufferStart_, bufferEnd_);
   bytesToSkip_ = 0;
   if (bufferStart_ + length <= bufferEnd_) {
+    if (length > StringView::kInlineSize) {
+      pinStreamBuffer();
+    }
     bytesToSkip_ = length;
     return folly::StringPiece(bufferStart_, length);
   }
@@ -2946,6 +3106,9 @@ void SelectiveStringDirectColumnReader::processFilter(
     case common::FilterKind::kBytesValues:
       readHelper<common::BytesValues, isDense>(filter, rows, extractValues);
       break;
+    case common::FilterKind::kBloomFilter:
+      readHelper<common::BloomFilter, isDense>(filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -2956,6 +3119,9 @@ void SelectiveStringDirectColumnReader::read(
     vector_size_t offset,
     RowSet rows,
     const uint64_t* incomingNulls) {
+  // Values passed to a hook or dropped do not outlive this call.
+  mayUseStreamBuffer_ = scanSpec_->keepValues() && !scanSpec_->valueHook();
+  releaseStreamBuffers();
   prepareRead<folly::StringPiece>(offset, rows, incomingNulls);
   bool isDense = rows.back() == rows.size() - 1;
 
@@ -3008,7 +3174,7 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
   void resetFilterCaches() override {
     if (!filterCache_.empty()) {
       simd::memset(
-          filterCache_.data(), FilterResult::kUnknown, dictionaryCount_);
+          filterCache_.data(), FilterResult::kUnknown, filterCache_.size());
     }
   }
 
@@ -3045,6 +3211,9 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
 
   void getValues(RowSet rows, VectorPtr* result) override;
 
+ protected:
+  bool filterDictionary(common::Filter& filter) override;
+
  private:
   void loadStrideDictionary();
   void makeDictionaryBaseVector();
@@ -3065,10 +3234,17 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
       uint64_t count,
       SeekableInputStream& data,
       IntDecoder</*isSigned*/ false>& lengthDecoder,
-      BufferPtr& offsets);
+      BufferPtr& offsets,
+      memory::MemoryPool& pool);
 
   void ensureInitialized();
 
+  // Set if the stripe dictionary is shared through the
+  // SharedDictionaryCache.
+  std::optional<SharedDictionaryKey> sharedDictionaryKey_;
+  // The shared stripe dictionary. 'dictionaryBlob_' and
+  // 'dictionaryOffset_' are its buffers.
+  std::shared_ptr<const SharedDictionary> sharedDictionary_;
   BufferPtr dictionaryBlob_;
   BufferPtr dictionaryOffset_;
   BufferPtr inDict_;
@@ -3127,6 +3303,10 @@ SelectiveStringDictionaryColumnReader::SelectiveStringDictionaryColumnReader(
 
   blobStream_ =
       stripe.getStream(ek.forKind(proto::Stream_Kind_DICTIONARY_DATA), false);
+  SharedDictionaryKey sharedKey;
+  if (stripe.getSharedDictionaryKey(ek, sharedKey)) {
+    sharedDictionaryKey_ = sharedKey;
+  }
 
   // handle in dictionary stream
   std::unique_ptr<SeekableInputStream> inDictStream =
@@ -3166,7 +3346,8 @@ BufferPtr SelectiveStringDictionaryColumnReader::loadDictionary(
     uint64_t count,
     SeekableInputStream& data,
     IntDecoder</*isSigned*/ false>& lengthDecoder,
-    BufferPtr& offsets) {
+    BufferPtr& offsets,
+    memory::MemoryPool& pool) {
   // read lengths from length reader
   auto* offsetsPtr = offsets->asMutable<int64_t>();
   offsetsPtr[0] = 0;
@@ -3180,7 +3361,7 @@ BufferPtr SelectiveStringDictionaryColumnReader::loadDictionary(
 
   // read bytes from underlying string
   int64_t blobSize = offsetsPtr[count];
-  BufferPtr dictionary = AlignedBuffer::allocate<char>(blobSize, &memoryPool);
+  BufferPtr dictionary = AlignedBuffer::allocate<char>(blobSize, &pool);
   data.readFully(dictionary->asMutable<char>(), blobSize);
   return dictionary;
 }
@@ -3193,6 +3374,7 @@ void SelectiveStringDictionaryColumnReader::loadStrideDictionary() {
 
   // get stride dictionary size and load it if needed
   auto& positions = index_->entry(nextStride).positions();
+  auto previousStrideDictCount = strideDictCount_;
   strideDictCount_ = positions.Get(strideDictSizeOffset_);
   if (strideDictCount_ > 0) {
     // seek stride dictionary related streams
@@ -3208,22 +3390,33 @@ void SelectiveStringDictionaryColumnReader::loadStrideDictionary() {
         strideDictCount_,
         *strideDictStream_,
         *strideDictLengthDecoder_,
-        strideDictOffset_);
+        strideDictOffset_,
+        memoryPool);
   } else {
     strideDict_.reset();
   }
 
   lastStrideIndex_ = nextStride;
 
-  dictionaryValues_.reset();
+  // Strides without a stride dictionary share the dictionary vector,
+  // so that results memoized over it by expressions stay valid.
+  if (strideDictCount_ > 0 || previousStrideDictCount > 0) {
+    dictionaryValues_.reset();
+  }
+  // The results for the stripe dictionary stay valid. Only the stride
+  // dictionary entries are new.
   filterCache_.resize(dictionaryCount_ + strideDictCount_);
   simd::memset(
-      filterCache_.data(),
+      filterCache_.data() + dictionaryCount_,
       FilterResult::kUnknown,
-      dictionaryCount_ + strideDictCount_);
+      strideDictCount_);
 }
 
 void SelectiveStringDictionaryColumnReader::makeDictionaryBaseVector() {
+  if (sharedDictionary_ && !strideDictCount_) {
+    dictionaryValues_ = sharedDictionary_->values;
+    return;
+  }
   const auto* dictionaryBlob_Ptr = dictionaryBlob_->as<char>();
   const auto* dictionaryOffset_sPtr = dictionaryOffset_->as<int64_t>();
   if (strideDictCount_) {
@@ -3643,6 +3836,9 @@ void SelectiveStringDictionaryColumnReader::processFilter(
     case common::FilterKind::kBytesValues:
       readHelper<common::BytesValues, isDense>(filter, rows, extractValues);
       break;
+    case common::FilterKind::kBloomFilter:
+      readHelper<common::BloomFilter, isDense>(filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -3758,6 +3954,20 @@ void SelectiveStringDictionaryColumnReader::getValues(
   }
 }
 
+bool SelectiveStringDictionaryColumnReader::filterDictionary(
+    common::Filter& filter) {
+  if (inDictionaryReader_) {
+    return true;
+  }
+  ensureInitialized();
+  auto* blob = dictionaryBlob_->as<char>();
+  auto* offsets = dictionaryOffset_->as<int64_t>();
+  return filterDictionaryEntries(
+      dictionaryCount_, filterCache_.data(), [&](auto i) {
+        return filter.testBytes(blob + offsets[i], offsets[i + 1] - offsets[i]);
+      });
+}
+
 void SelectiveStringDictionaryColumnReader::ensureInitialized() {
   if (LIKELY(initialized_)) {
     return;
@@ -3765,9 +3975,33 @@ void SelectiveStringDictionaryColumnReader::ensureInitialized() {
 
   Timer timer;
 
-  ensureCapacity<int64_t>(dictionaryOffset_, dictionaryCount_ + 1, &memoryPool);
-  dictionaryBlob_ = loadDictionary(
-      dictionaryCount_, *blobStream_, *lengthDecoder_, dictionaryOffset_);
+  if (sharedDictionaryKey_) {
+    sharedDictionary_ = SharedDictionaryCache::instance().get(
+        *sharedDictionaryKey_, [&](memory::MemoryPool& pool) {
+          auto dictionary = std::make_shared<SharedDictionary>();
+          dictionary->offsets =
+              AlignedBuffer::allocate<int64_t>(dictionaryCount_ + 1, &pool);
+          dictionary->blob = loadDictionary(
+              dictionaryCount_,
+              *blobStream_,
+              *lengthDecoder_,
+              dictionary->offsets,
+              pool);
+          dictionary->makeValues(type_, dictionaryCount_, pool);
+          return dictionary;
+        });
+    dictionaryBlob_ = sharedDictionary_->blob;
+    dictionaryOffset_ = sharedDictionary_->offsets;
+  } else {
+    ensureCapacity<int64_t>(
+        dictionaryOffset_, dictionaryCount_ + 1, &memoryPool);
+    dictionaryBlob_ = loadDictionary(
+        dictionaryCount_,
+        *blobStream_,
+        *lengthDecoder_,
+        dictionaryOffset_,
+        memoryPool);
+  }
   dictionaryValues_.reset();
   filterCache_.resize(dictionaryCount_);
   simd::memset(filterCache_.data(), FilterResult::kUnknown, dictionaryCount_);
@@ -3788,6 +4022,11 @@ void SelectiveStringDictionaryColumnReader::ensureInitialized() {
 
 class SelectiveStructColumnReader : public SelectiveColumnReader {
  public:
+  // Minimum number of rows passing the filters for reading the
+  // children without filters in parallel. Below this, the handoff to
+  // the executor costs more than the decoding.
+  static constexpr vector_size_t kMinParallelRows = 1000;
+
   SelectiveStructColumnReader(
       const EncodingKey& ek,
       const std::shared_ptr<const TypeWithId>& requestedType,
@@ -3819,7 +4058,7 @@ class SelectiveStructColumnReader : public SelectiveColumnReader {
 
   std::vector<uint32_t> filterRowGroups(
       uint64_t rowGroupSize,
-      const StatsContext& context) const override;
+      const StatsContext& context) override;
 
   void read(vector_size_t offset, RowSet rows, const uint64_t* incomingNulls)
       override;
@@ -3857,8 +4096,54 @@ class SelectiveStructColumnReader : public SelectiveColumnReader {
   uint64_t numReads_ = 0;
   vector_size_t lazyVectorReadOffset_;
 
+  // Reads 'readers' for 'rows', all but the first on 'executor_'. The
+  // first and any not yet started by 'executor_' are read on the
+  // calling thread. Returns after all are read.
+  void readInParallel(
+      const std::vector<SelectiveColumnReader*>& readers,
+      vector_size_t offset,
+      RowSet rows,
+      const uint64_t* structNulls);
+
   // Dense set of rows to read in next().
   raw_vector<vector_size_t> rows_;
+
+  // True if the child will be returned as a LazyVector unless read
+  // in parallel.
+  static bool makesLazyVector(const common::ScanSpec& spec) {
+    return spec.projectOut() && !spec.hasFilter() && !spec.extractValues();
+  }
+
+  // Executor for decoding the children without filters in parallel.
+  // nullptr if all children are read on the calling thread.
+  folly::Executor* executor_;
+
+  // True if 'spec' is a child that scanSpec_->rowFilter() reads.
+  bool isRowFilterInput(const common::ScanSpec& spec) const {
+    auto rowFilter = scanSpec_->rowFilter();
+    return rowFilter && spec.projectOut() && rowFilter->isInput(spec.channel());
+  }
+
+  // Evaluates scanSpec_->rowFilter() on the inputs read for 'rows' and
+  // returns the rows that pass. Keeps the values of the inputs for
+  // getValues().
+  RowSet applyRowFilter(RowSet rows);
+
+  // True if the last read() decoded the children that are otherwise
+  // returned as LazyVectors.
+  bool readLazyChildren_{false};
+
+  // Values of the inputs of the row filter for the rows passing the
+  // other filters in the last read(), indexed by channel. nullptr for
+  // the channels that are not inputs.
+  std::vector<VectorPtr> rowFilterValues_;
+
+  // Positions in 'rowFilterValues_' that passed the row filter. nullptr
+  // if all passed.
+  BufferPtr rowFilterIndices_;
+
+  // The rows that passed the row filter.
+  raw_vector<vector_size_t> rowFilterRows_;
 };
 
 SelectiveStructColumnReader::SelectiveStructColumnReader(
@@ -3867,7 +4152,8 @@ SelectiveStructColumnReader::SelectiveStructColumnReader(
     const std::shared_ptr<const TypeWithId>& dataType,
     StripeStreams& stripe,
     common::ScanSpec* scanSpec)
-    : SelectiveColumnReader(ek, stripe, scanSpec, dataType->type) {
+    : SelectiveColumnReader(ek, stripe, scanSpec, dataType->type),
+      executor_(stripe.getRowReaderOptions().getDecodingExecutor()) {
   DWIO_ENSURE_EQ(ek.node, dataType->id, "working on the same node");
   auto encoding = static_cast<int64_t>(stripe.getEncoding(encodingKey).kind());
   DWIO_ENSURE_EQ(
@@ -3894,7 +4180,7 @@ SelectiveStructColumnReader::SelectiveStructColumnReader(
 
 std::vector<uint32_t> SelectiveStructColumnReader::filterRowGroups(
     uint64_t rowGroupSize,
-    const StatsContext& context) const {
+    const StatsContext& context) {
   auto stridesToSkip =
       SelectiveColumnReader::filterRowGroups(rowGroupSize, context);
   for (const auto& child : children_) {
@@ -3904,7 +4190,7 @@ std::vector<uint32_t> SelectiveStructColumnReader::filterRowGroups(
     } else {
       std::vector<uint32_t> merged;
       merged.reserve(childStridesToSkip.size() + stridesToSkip.size());
-      std::merge(
+      std::set_union(
           childStridesToSkip.begin(),
           childStridesToSkip.end(),
           stridesToSkip.begin(),
@@ -4051,21 +4337,32 @@ void SelectiveStructColumnReader::read(
   const uint64_t* structNulls =
       nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
   bool hasFilter = false;
+  // With 'executor_', the children without filters are read after the
+  // filters have selected the rows.
+  std::vector<SelectiveColumnReader*> deferredReaders;
+  // The inputs of the row filter are read after the single child
+  // filters and before the children that are deferred or lazy.
+  std::vector<SelectiveColumnReader*> rowFilterReaders;
+  readLazyChildren_ = false;
+  rowFilterValues_.clear();
+  rowFilterIndices_ = nullptr;
   assert(!children_.empty());
   for (size_t i = 0; i < childSpecs.size(); ++i) {
     auto& childSpec = childSpecs[i];
     if (childSpec->isConstant()) {
       continue;
     }
-    if (childSpec->projectOut() && !childSpec->filter() &&
-        !childSpec->extractValues()) {
+    if (!executor_ && makesLazyVector(*childSpec) &&
+        !isRowFilterInput(*childSpec)) {
       // Will make a LazyVector.
       continue;
     }
     auto fieldIndex = childSpec->subscript();
     auto reader = children_.at(fieldIndex).get();
     advanceFieldReader(reader, offset);
-    if (childSpec->filter()) {
+    // A child with a filter on one of its own children, e.g. on a key
+    // of a flat map, also drops rows.
+    if (childSpec->hasFilter()) {
       hasFilter = true;
       {
         SelectivityTimer timer(childSpec->selectivity(), activeRows.size());
@@ -4082,10 +4379,35 @@ void SelectiveStructColumnReader::read(
       if (activeRows.empty()) {
         break;
       }
+    } else if (isRowFilterInput(*childSpec)) {
+      rowFilterReaders.push_back(reader);
+    } else if (executor_) {
+      deferredReaders.push_back(reader);
     } else {
       reader->read(offset, activeRows, structNulls);
     }
   }
+  if (!activeRows.empty() && scanSpec_->rowFilter()) {
+    for (auto reader : rowFilterReaders) {
+      reader->read(offset, activeRows, structNulls);
+    }
+    activeRows = applyRowFilter(activeRows);
+    hasFilter = true;
+  }
+  if (!activeRows.empty() && !deferredReaders.empty()) {
+    if (deferredReaders.size() > 1 && activeRows.size() >= kMinParallelRows) {
+      // The columns that would be lazy are decoded here, since loading
+      // a LazyVector happens on the consumer's thread.
+      readInParallel(deferredReaders, offset, activeRows, structNulls);
+      readLazyChildren_ = true;
+    } else {
+      for (auto reader : deferredReaders) {
+        if (!makesLazyVector(*reader->scanSpec())) {
+          reader->read(offset, activeRows, structNulls);
+        }
+      }
+    }
+  }
   if (hasFilter) {
     setOutputRows(activeRows);
   }
@@ -4093,6 +4415,70 @@ void SelectiveStructColumnReader::read(
   readOffset_ = offset + rows.back() + 1;
 }
 
+RowSet SelectiveStructColumnReader::applyRowFilter(RowSet rows) {
+  auto& childSpecs = scanSpec_->children();
+  for (auto& childSpec : childSpecs) {
+    if (!isRowFilterInput(*childSpec)) {
+      continue;
+    }
+    auto channel = childSpec->channel();
+    if (channel >= rowFilterValues_.size()) {
+      rowFilterValues_.resize(channel + 1);
+    }
+    if (childSpec->isConstant()) {
+      rowFilterValues_[channel] = BaseVector::wrapInConstant(
+          rows.size(), 0, childSpec->constantValue());
+    } else {
+      children_[childSpec->subscript()]->getValues(
+          rows, &rowFilterValues_[channel]);
+    }
+  }
+  BufferPtr indices;
+  auto numPassed =
+      scanSpec_->rowFilter()->filter(rowFilterValues_, rows.size(), indices);
+  VELOX_CHECK_LE(numPassed, rows.size());
+  if (numPassed == rows.size()) {
+    return rows;
+  }
+  rowFilterIndices_ = indices;
+  rowFilterRows_.resize(numPassed);
+  if (numPassed) {
+    auto rawIndices = indices->as<vector_size_t>();
+    for (vector_size_t i = 0; i < numPassed; ++i) {
+      rowFilterRows_[i] = rows[rawIndices[i]];
+    }
+  }
+  return rowFilterRows_;
+}
+
+void SelectiveStructColumnReader::readInParallel(
+    const std::vector<SelectiveColumnReader*>& readers,
+    vector_size_t offset,
+    RowSet rows,
+    const uint64_t* structNulls) {
+  std::vector<std::shared_ptr<AsyncSource<bool>>> reads;
+  reads.reserve(readers.size() - 1);
+  for (auto i = 1; i < readers.size(); ++i) {
+    auto reader = readers[i];
+    reads.push_back(std::make_shared<AsyncSource<bool>>([=]() {
+      reader->read(offset, rows, structNulls);
+      return std::make_shared<bool>(true);
+    }));
+    executor_->add([read = reads.back()]() { read->prepare(); });
+  }
+  // The reads refer to the readers and 'rows'. None may be in progress
+  // when this returns, also on error.
+  auto guard = folly::makeGuard([&]() {
+    for (auto& read : reads) {
+      read->close();
+    }
+  });
+  readers[0]->read(offset, rows, structNulls);
+  for (auto& read : reads) {
+    read->move();
+  }
+}
+
 void SelectiveStructColumnReader::getValues(RowSet rows, VectorPtr* result) {
   assert(!children_.empty());
   VELOX_CHECK(
@@ -4125,8 +4511,17 @@ void SelectiveStructColumnReader::getValues(RowSet rows, VectorPtr* result) {
     if (childSpec->isConstant()) {
       resultRow->childAt(channel) = BaseVector::wrapInConstant(
           rows.size(), 0, childSpec->constantValue());
+    } else if (
+        channel < rowFilterValues_.size() && rowFilterValues_[channel]) {
+      // Read and extracted for the row filter.
+      auto& values = rowFilterValues_[channel];
+      resultRow->childAt(channel) = rowFilterIndices_
+          ? BaseVector::wrapInDictionary(
+                BufferPtr(nullptr), rowFilterIndices_, rows.size(), values)
+          : values;
     } else {
-      if (!childSpec->extractValues() && !childSpec->filter()) {
+      if (!childSpec->extractValues() && !childSpec->hasFilter() &&
+          !readLazyChildren_) {
         // LazyVector result.
         if (!lazyPrepared) {
           if (rows.size() != outputRows_.size()) {
@@ -4165,6 +4560,12 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
       common::ScanSpec* scanSpec,
       const TypePtr& type)
       : SelectiveColumnReader(ek, stripe, scanSpec, type, true) {
+    for (auto& childSpec : scanSpec->children()) {
+      VELOX_CHECK(
+          !childSpec->hasFilter(),
+          "Filters on elements of arrays or maps are only supported "
+          "for flat maps");
+    }
     auto rleVersion = convertRleVersion(stripe.getEncoding(encodingKey).kind());
     auto lenId = encodingKey.forKind(proto::Stream_Kind_LENGTH);
     bool lenVints = stripe.getUseVInts(lenId);
@@ -4176,7 +4577,11 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
         INT_BYTE_SIZE);
   }
 
-  void makeNestedRowSet(RowSet rows) {
+  // Sets 'nestedRows_' to the elements of 'rows'. Only the first
+  // 'maxElements' elements of each row are included.
+  void makeNestedRowSet(
+      RowSet rows,
+      vector_size_t maxElements = std::numeric_limits<vector_size_t>::max()) {
     allLengths_.resize(rows.back() + 1);
     assert(!allLengths_.empty()); // for lint only.
     auto nulls =
@@ -4191,7 +4596,7 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
     vector_size_t nestedLength = 0;
     for (auto row : rows) {
       if (!nulls || !bits::isBitNull(nulls, row)) {
-        nestedLength += allLengths_[row];
+        nestedLength += std::min<int64_t>(allLengths_[row], maxElements);
       }
     }
     nestedRows_.resize(nestedLength);
@@ -4220,7 +4625,7 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
         continue;
       }
 
-      auto lengthAtRow = allLengths_[row];
+      auto lengthAtRow = std::min<int64_t>(allLengths_[row], maxElements);
       std::iota(
           &nestedRows_[nestedRow],
           &nestedRows_[nestedRow + lengthAtRow],
@@ -4228,11 +4633,37 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
       rawOffsets[rowIndex] = nestedRow;
       rawSizes[rowIndex] = lengthAtRow;
       nestedRow += lengthAtRow;
-      nestedOffset += lengthAtRow;
+      nestedOffset += allLengths_[row];
     }
     childTargetReadOffset_ += nestedOffset;
   }
 
+  // Keeps the nested rows in 'selected', a subset of 'nestedRows_',
+  // and updates the offsets and sizes of the first 'numRows' rows to
+  // refer to these.
+  void selectNestedRows(int32_t numRows, RowSet selected) {
+    if (selected.size() == nestedRows_.size()) {
+      return;
+    }
+    auto rawOffsets = offsets_->asMutable<vector_size_t>();
+    auto rawSizes = sizes_->asMutable<vector_size_t>();
+    vector_size_t numSelected = 0;
+    for (auto i = 0; i < numRows; ++i) {
+      auto first = numSelected;
+      if (rawSizes[i] > 0) {
+        auto last = nestedRows_[rawOffsets[i] + rawSizes[i] - 1];
+        while (numSelected < selected.size() &&
+               selected[numSelected] <= last) {
+          ++numSelected;
+        }
+      }
+      rawOffsets[i] = first;
+      rawSizes[i] = numSelected - first;
+    }
+    nestedRows_.resize(selected.size());
+    std::copy(selected.begin(), selected.end(), nestedRows_.begin());
+  }
+
   void compactOffsets(RowSet rows) {
     auto rawOffsets = offsets_->asMutable<vector_size_t>();
     auto rawSizes = sizes_->asMutable<vector_size_t>();
@@ -4389,7 +4820,7 @@ void SelectiveListColumnReader::read(
   // Catch up if the child is behind the length stream.
   child_->seekTo(childTargetReadOffset_, false);
   prepareRead<char>(offset, rows, incomingNulls);
-  makeNestedRowSet(rows);
+  makeNestedRowSet(rows, scanSpec_->maxArrayElementsCount());
   if (child_ && !nestedRows_.empty()) {
     child_->read(child_->readOffset(), nestedRows_, nullptr);
   }
@@ -4459,6 +4890,10 @@ class SelectiveMapColumnReader : public SelectiveRepeatedColumnReader {
   std::unique_ptr<SelectiveColumnReader> keyReader_;
   std::unique_ptr<SelectiveColumnReader> elementReader_;
   const TypePtr requestedType_;
+  // Spec of 'keyReader_' with the map key filter of 'scanSpec_', if
+  // any. Not in the ScanSpec tree, so that the filter drops map
+  // entries and not rows.
+  std::unique_ptr<common::ScanSpec> keySpec_;
 };
 
 SelectiveMapColumnReader::SelectiveMapColumnReader(
@@ -4485,12 +4920,16 @@ SelectiveMapColumnReader::SelectiveMapColumnReader(
   VELOX_CHECK(
       cs.shouldReadNode(keyType->id),
       "Map key must be selected in SelectiveMapColumnReader");
+  auto keySpec = scanSpec_->children()[0].get();
+  if (auto keyFilter = scanSpec_->mapKeyFilter()) {
+    keySpec_ = std::make_unique<common::ScanSpec>("keys");
+    keySpec_->setProjectOut(true);
+    keySpec_->setExtractValues(true);
+    keySpec_->setFilter(keyFilter->clone());
+    keySpec = keySpec_.get();
+  }
   keyReader_ = SelectiveColumnReader::build(
-      keyType,
-      dataType->childAt(0),
-      stripe,
-      scanSpec_->children()[0].get(),
-      ek.sequence);
+      keyType, dataType->childAt(0), stripe, keySpec, ek.sequence);
 
   auto& valueType = requestedType->childAt(1);
   VELOX_CHECK(
@@ -4554,7 +4993,14 @@ void SelectiveMapColumnReader::read(
   makeNestedRowSet(rows);
   if (keyReader_ && elementReader_ && !nestedRows_.empty()) {
     keyReader_->read(keyReader_->readOffset(), nestedRows_, nullptr);
-    elementReader_->read(elementReader_->readOffset(), nestedRows_, nullptr);
+    if (keySpec_) {
+      // Only the values of the entries with selected keys are read.
+      selectNestedRows(rows.size(), keyReader_->outputRows());
+    }
+    if (!nestedRows_.empty()) {
+      elementReader_->read(
+          elementReader_->readOffset(), nestedRows_, nullptr);
+    }
   }
   numValues_ = rows.size();
   readOffset_ = offset + rows.back() + 1;
@@ -4583,6 +5029,569 @@ void SelectiveMapColumnReader::getValues(RowSet rows, VectorPtr* result) {
       values);
 }
 
+// Reads a flat map column, i.e. a map whose values are in a separate
+// stream for each key. Only the streams of the keys listed in the
+// column selector, if any, and passing the map key filter of
+// 'scanSpec', if any, are read. The result is a map or, if the column
+// is configured to be read as a struct, a struct with one field per
+// listed key. A child ScanSpec of 'scanSpec' named after a key applies
+// to the values of the key. Its filter drops the rows where the value
+// does not pass. A missing key or a null map counts as a null value.
+template <typename T>
+class SelectiveFlatMapColumnReader : public SelectiveColumnReader {
+ public:
+  SelectiveFlatMapColumnReader(
+      const EncodingKey& ek,
+      const std::shared_ptr<const TypeWithId>& requestedType,
+      const std::shared_ptr<const TypeWithId>& dataType,
+      StripeStreams& stripe,
+      common::ScanSpec* scanSpec);
+
+  bool useBulkPath() const override {
+    return false;
+  }
+
+  void resetFilterCaches() override {
+    for (auto& key : keys_) {
+      key->reader->resetFilterCaches();
+    }
+  }
+
+  void seekToRowGroup(uint32_t index) override {
+    // The row index of each key has the positions of the in-map stream
+    // before the positions of the values, which the value readers do
+    // not expect. The streams are advanced by skipping instead.
+    seekTo(index * rowsPerRowGroup_, false);
+  }
+
+  uint64_t skip(uint64_t numValues) override;
+
+  void read(vector_size_t offset, RowSet rows, const uint64_t* incomingNulls)
+      override;
+
+  void getValues(RowSet rows, VectorPtr* result) override;
+
+ private:
+  static constexpr vector_size_t kNoValue = -1;
+
+  // The value and in-map streams of one key.
+  struct KeyStream {
+    KeyStream(
+        const KeyValue<T>& keyValue,
+        uint32_t keySequence,
+        common::ScanSpec* keySpec,
+        std::unique_ptr<SelectiveColumnReader> valueReader,
+        std::unique_ptr<ByteRleDecoder> inMapDecoder)
+        : key(keyValue),
+          sequence(keySequence),
+          spec(keySpec),
+          reader(std::move(valueReader)),
+          inMap(std::move(inMapDecoder)) {}
+
+    // Reads the in-map flags of the next 'numMaps' non-null maps and
+    // returns the number of maps that have the key.
+    uint64_t readInMap(uint64_t numMaps) {
+      if (numMaps == 0) {
+        return 0;
+      }
+      inMapBits.resize(bits::nwords(numMaps));
+      inMap->next(reinterpret_cast<char*>(inMapBits.data()), numMaps, nullptr);
+      return bits::countBits(inMapBits.data(), 0, numMaps);
+    }
+
+    // Sets 'valueIndices' for the first 'numRows' rows with 'nulls'
+    // and advances the position in the value stream past these.
+    void startRead(vector_size_t numRows, const uint64_t* nulls) {
+      readInMap(nulls ? bits::countBits(nulls, 0, numRows) : numRows);
+      valueIndices.resize(numRows);
+      vector_size_t numValues = 0;
+      vector_size_t mapIndex = 0;
+      for (auto row = 0; row < numRows; ++row) {
+        if (nulls && bits::isBitNull(nulls, row)) {
+          valueIndices[row] = kNoValue;
+        } else {
+          valueIndices[row] = bits::isBitSet(inMapBits.data(), mapIndex++)
+              ? numValues++
+              : kNoValue;
+        }
+      }
+      valueReadOffset = nextValueReadOffset;
+      nextValueReadOffset += numValues;
+    }
+
+    // Sets 'valueRows' to the values of the key at 'rows'.
+    void setValueRows(RowSet rows) {
+      valueRows.clear();
+      for (auto row : rows) {
+        auto index = valueIndices[row];
+        if (index != kNoValue) {
+          valueRows.push_back(index);
+        }
+      }
+    }
+
+    const KeyValue<T> key;
+    const uint32_t sequence;
+    common::ScanSpec* const spec;
+    std::unique_ptr<SelectiveColumnReader> reader;
+    std::unique_ptr<ByteRleDecoder> inMap;
+    raw_vector<uint64_t> inMapBits;
+    // Index in the value stream, relative to 'valueReadOffset', of the
+    // value of each row of the last read. kNoValue if the row has no
+    // value for the key.
+    raw_vector<vector_size_t> valueIndices;
+    raw_vector<vector_size_t> valueRows;
+    // Position in the value stream of the first value of the last read
+    // and of the first value after the rows read or skipped so far.
+    vector_size_t valueReadOffset{0};
+    vector_size_t nextValueReadOffset{0};
+  };
+
+  static bool testKey(common::Filter& filter, const KeyValue<T>& key) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      return filter.testBytes(key.get().data(), key.get().size());
+    } else {
+      return filter.testInt64(key.get());
+    }
+  }
+
+  static std::string keyName(const KeyValue<T>& key) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      return std::string(key.get());
+    } else {
+      return std::to_string(static_cast<int64_t>(key.get()));
+    }
+  }
+
+  // Sets 'spec' to read all of 'type' if it has no children.
+  static void addFullScanSpec(const TypePtr& type, common::ScanSpec& spec);
+
+  // Returns the nulls of the maps at 'rows', nullptr if there are none.
+  BufferPtr nullsAt(RowSet rows);
+
+  void getMapValues(RowSet rows, VectorPtr* result);
+
+  void getStructValues(RowSet rows, VectorPtr* result);
+
+  const TypePtr requestedType_;
+  std::vector<std::unique_ptr<KeyStream>> keys_;
+  // Indices in 'keys_' of the keys that are returned in a map, in
+  // 'keys_' order.
+  std::vector<int32_t> mapKeys_;
+  // The keys of 'mapKeys_', one per key.
+  VectorPtr mapKeyValues_;
+  // If the result is a struct, index in 'keys_' of the key of each
+  // field. -1 if the key is not in the stripe.
+  std::vector<int32_t> structKeys_;
+  TypePtr structType_;
+  // Indices in 'keys_' of the keys with filters on their values.
+  std::vector<int32_t> filterKeys_;
+  // Filters on the values of keys that are not in the stripe.
+  std::vector<common::Filter*> missingKeyFilters_;
+  // ScanSpecs of the keys that have none in 'scanSpec_'.
+  std::vector<std::unique_ptr<common::ScanSpec>> ownedSpecs_;
+  // Rows passing the filters of the last read.
+  raw_vector<vector_size_t> filterRows_;
+};
+
+template <typename T>
+SelectiveFlatMapColumnReader<T>::SelectiveFlatMapColumnReader(
+    const EncodingKey& ek,
+    const std::shared_ptr<const TypeWithId>& requestedType,
+    const std::shared_ptr<const TypeWithId>& dataType,
+    StripeStreams& stripe,
+    common::ScanSpec* scanSpec)
+    : SelectiveColumnReader(ek, stripe, scanSpec, dataType->type),
+      requestedType_(requestedType->type) {
+  DWIO_ENSURE_EQ(ek.node, dataType->id, "working on the same node");
+  std::vector<KeyValue<T>> configuredKeys;
+  std::unordered_map<KeyValue<T>, int32_t, KeyValueHash<T>> configuredIndex;
+  forEachConfiguredKey<T>(
+      [&](auto&& key) {
+        configuredIndex[key] = configuredKeys.size();
+        configuredKeys.push_back(std::move(key));
+      },
+      requestedType,
+      stripe);
+  bool asStruct =
+      isRequiringStructEncoding(requestedType, stripe.getRowReaderOptions());
+  DWIO_ENSURE(
+      !asStruct || !configuredKeys.empty(),
+      "For struct encoding, keys to project must be configured");
+  auto keyFilter = scanSpec_->mapKeyFilter();
+  auto isSelected = [&](const KeyValue<T>& key) {
+    if (!configuredKeys.empty() && !configuredIndex.count(key)) {
+      return false;
+    }
+    return asStruct || !keyFilter || testKey(*keyFilter, key);
+  };
+
+  const auto& requestedValueType = requestedType->childAt(1);
+  const auto& dataValueType = dataType->childAt(1);
+  std::unordered_set<uint32_t> processed;
+  std::vector<bool> selected;
+  stripe.visitStreamsOfNode(
+      dataValueType->id, [&](const StreamInformation& stream) {
+        auto sequence = stream.getSequence();
+        // Sequence 0 is the shared dictionary, if any.
+        if (sequence == 0 || !processed.insert(sequence).second) {
+          return;
+        }
+        EncodingKey seqEk(dataValueType->id, sequence);
+        auto key = extractKey<T>(stripe.getEncoding(seqEk).key());
+        auto spec = scanSpec_->childByName(keyName(key));
+        bool isOutput = isSelected(key);
+        if (!isOutput && !(spec && spec->hasFilter())) {
+          return;
+        }
+        if (!spec) {
+          ownedSpecs_.push_back(
+              std::make_unique<common::ScanSpec>(keyName(key)));
+          spec = ownedSpecs_.back().get();
+        }
+        if (isOutput) {
+          addFullScanSpec(requestedValueType->type, *spec);
+        }
+        auto inMap =
+            stripe.getStream(seqEk.forKind(proto::Stream_Kind_IN_MAP), true);
+        DWIO_ENSURE_NOT_NULL(inMap, "In map stream is required");
+        keys_.push_back(std::make_unique<KeyStream>(
+            key,
+            sequence,
+            spec,
+            SelectiveColumnReader::build(
+                requestedValueType, dataValueType, stripe, spec, sequence),
+            createBooleanRleDecoder(std::move(inMap), seqEk)));
+        selected.push_back(isOutput);
+      });
+
+  // Sort by sequence so that the order of map entries is fixed.
+  std::vector<int32_t> order(keys_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int32_t left, int32_t right) {
+    return keys_[left]->sequence < keys_[right]->sequence;
+  });
+  std::vector<std::unique_ptr<KeyStream>> sortedKeys;
+  for (auto i : order) {
+    sortedKeys.push_back(std::move(keys_[i]));
+    if (selected[i]) {
+      mapKeys_.push_back(sortedKeys.size() - 1);
+    }
+  }
+  keys_ = std::move(sortedKeys);
+
+  std::unordered_set<std::string> keyNames;
+  for (auto i = 0; i < keys_.size(); ++i) {
+    keyNames.insert(keyName(keys_[i]->key));
+    if (keys_[i]->spec->hasFilter()) {
+      filterKeys_.push_back(i);
+    }
+  }
+  for (auto& childSpec : scanSpec_->children()) {
+    if (childSpec->filter() && !keyNames.count(childSpec->fieldName())) {
+      missingKeyFilters_.push_back(childSpec->filter());
+    }
+  }
+
+  if (asStruct) {
+    structKeys_.resize(configuredKeys.size(), -1);
+    for (auto i : mapKeys_) {
+      structKeys_[configuredIndex[keys_[i]->key]] = i;
+    }
+    auto valueType = requestedValueType->type;
+    structType_ = ROW(
+        std::vector<std::string>(configuredKeys.size()),
+        std::vector<TypePtr>(configuredKeys.size(), valueType));
+  } else {
+    mapKeyValues_ = BaseVector::create(
+        requestedType->childAt(0)->type, mapKeys_.size(), &memoryPool);
+    auto flatKeys = mapKeyValues_->asFlatVector<T>();
+    for (auto i = 0; i < mapKeys_.size(); ++i) {
+      flatKeys->set(i, keys_[mapKeys_[i]]->key.get());
+    }
+  }
+  VLOG(1) << "[Flat-Map] Initialized a selective flat-map column reader for "
+          << "node " << dataType->id << ", keys=" << keys_.size();
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::addFullScanSpec(
+    const TypePtr& type,
+    common::ScanSpec& spec) {
+  spec.setProjectOut(true);
+  spec.setExtractValues(true);
+  if (type->kind() != TypeKind::ROW || !spec.children().empty()) {
+    return;
+  }
+  auto& rowType = type->asRow();
+  for (auto i = 0; i < rowType.size(); ++i) {
+    auto childSpec =
+        spec.getOrCreateChild(common::Subfield(rowType.nameOf(i)));
+    childSpec->setChannel(i);
+    addFullScanSpec(rowType.childAt(i), *childSpec);
+  }
+}
+
+template <typename T>
+uint64_t SelectiveFlatMapColumnReader<T>::skip(uint64_t numValues) {
+  auto numMaps = ColumnReader::skip(numValues);
+  // The value streams are advanced on the next read.
+  for (auto& key : keys_) {
+    key->nextValueReadOffset += key->readInMap(numMaps);
+  }
+  return numValues;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::read(
+    vector_size_t offset,
+    RowSet rows,
+    const uint64_t* incomingNulls) {
+  prepareRead<char>(offset, rows, incomingNulls);
+  vector_size_t numRows = rows.back() + 1;
+  auto nulls = nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
+  for (auto& key : keys_) {
+    key->startRead(numRows, nulls);
+  }
+
+  RowSet activeRows = rows;
+  for (auto filter : missingKeyFilters_) {
+    if (!filter->testNull()) {
+      activeRows = RowSet();
+      break;
+    }
+  }
+  // The keys with filters are read first, each for the rows that pass
+  // the previous filters.
+  for (auto i = 0; i < filterKeys_.size() && !activeRows.empty(); ++i) {
+    auto& key = *keys_[filterKeys_[i]];
+    key.setValueRows(activeRows);
+    RowSet passed;
+    if (!key.valueRows.empty()) {
+      key.reader->read(key.valueReadOffset, key.valueRows, nullptr);
+      passed = key.reader->outputRows();
+    }
+    auto filter = key.spec->filter();
+    bool nullsPass = !filter || filter->testNull();
+    // Compacts the passing rows in place. 'activeRows' may be
+    // 'filterRows_'.
+    filterRows_.resize(activeRows.size());
+    vector_size_t numPassed = 0;
+    vector_size_t passedIndex = 0;
+    for (auto row : activeRows) {
+      auto index = key.valueIndices[row];
+      if (index == kNoValue) {
+        if (nullsPass) {
+          filterRows_[numPassed++] = row;
+        }
+        continue;
+      }
+      while (passedIndex < passed.size() && passed[passedIndex] < index) {
+        ++passedIndex;
+      }
+      if (passedIndex < passed.size() && passed[passedIndex] == index) {
+        filterRows_[numPassed++] = row;
+      }
+    }
+    filterRows_.resize(numPassed);
+    activeRows = RowSet(filterRows_.data(), numPassed);
+  }
+  if (!activeRows.empty()) {
+    for (auto i : mapKeys_) {
+      auto& key = *keys_[i];
+      if (key.spec->hasFilter()) {
+        continue;
+      }
+      key.setValueRows(activeRows);
+      if (!key.valueRows.empty()) {
+        key.reader->read(key.valueReadOffset, key.valueRows, nullptr);
+      }
+    }
+  }
+  if (scanSpec_->hasFilter()) {
+    setOutputRows(activeRows);
+  }
+  numValues_ = rows.size();
+  readOffset_ = offset + numRows;
+}
+
+template <typename T>
+BufferPtr SelectiveFlatMapColumnReader<T>::nullsAt(RowSet rows) {
+  if (!nullsInReadRange_) {
+    return nullptr;
+  }
+  auto readNulls = nullsInReadRange_->as<uint64_t>();
+  auto nulls = AlignedBuffer::allocate<bool>(rows.size(), &memoryPool);
+  auto rawNulls = nulls->asMutable<uint64_t>();
+  for (auto i = 0; i < rows.size(); ++i) {
+    bits::setNull(rawNulls, i, bits::isBitNull(readNulls, rows[i]));
+  }
+  return nulls;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::getValues(
+    RowSet rows,
+    VectorPtr* result) {
+  if (structType_) {
+    getStructValues(rows, result);
+  } else {
+    getMapValues(rows, result);
+  }
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::getMapValues(
+    RowSet rows,
+    VectorPtr* result) {
+  // The values of each key are placed after the values of the previous
+  // key and the map entries refer to them through a dictionary.
+  std::vector<VectorPtr> keyValues(mapKeys_.size());
+  std::vector<vector_size_t> keyStarts(mapKeys_.size());
+  vector_size_t numEntries = 0;
+  for (auto i = 0; i < mapKeys_.size(); ++i) {
+    auto& key = *keys_[mapKeys_[i]];
+    key.setValueRows(rows);
+    keyStarts[i] = numEntries;
+    if (!key.valueRows.empty()) {
+      key.reader->getValues(key.valueRows, &keyValues[i]);
+      numEntries += key.valueRows.size();
+    }
+  }
+  auto offsets =
+      AlignedBuffer::allocate<vector_size_t>(rows.size(), &memoryPool);
+  auto sizes =
+      AlignedBuffer::allocate<vector_size_t>(rows.size(), &memoryPool);
+  auto rawOffsets = offsets->asMutable<vector_size_t>();
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  VectorPtr keys;
+  VectorPtr values;
+  if (numEntries == 0) {
+    std::fill(rawOffsets, rawOffsets + rows.size(), 0);
+    std::fill(rawSizes, rawSizes + rows.size(), 0);
+  } else {
+    auto& mapType = requestedType_->asMap();
+    auto allValues =
+        BaseVector::create(mapType.valueType(), numEntries, &memoryPool);
+    for (auto i = 0; i < mapKeys_.size(); ++i) {
+      if (keyValues[i]) {
+        allValues->copy(
+            keyValues[i].get(), keyStarts[i], 0, keyValues[i]->size());
+      }
+    }
+    keys = BaseVector::create(mapType.keyType(), numEntries, &memoryPool);
+    auto flatKeys = keys->asFlatVector<T>();
+    auto keyValuesVector = mapKeyValues_->asFlatVector<T>();
+    flatKeys->setStringBuffers(keyValuesVector->stringBuffers());
+    auto rawKeys = flatKeys->mutableRawValues();
+    auto rawKeyValues = keyValuesVector->rawValues();
+    auto indices =
+        AlignedBuffer::allocate<vector_size_t>(numEntries, &memoryPool);
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    vector_size_t entry = 0;
+    for (auto i = 0; i < rows.size(); ++i) {
+      rawOffsets[i] = entry;
+      for (auto j = 0; j < mapKeys_.size(); ++j) {
+        if (keys_[mapKeys_[j]]->valueIndices[rows[i]] != kNoValue) {
+          rawKeys[entry] = rawKeyValues[j];
+          rawIndices[entry++] = keyStarts[j]++;
+        }
+      }
+      rawSizes[i] = entry - rawOffsets[i];
+    }
+    VELOX_CHECK_EQ(entry, numEntries);
+    values = BaseVector::wrapInDictionary(
+        nullptr, indices, numEntries, std::move(allValues));
+  }
+  *result = std::make_shared<MapVector>(
+      &memoryPool,
+      requestedType_,
+      nullsAt(rows),
+      rows.size(),
+      offsets,
+      sizes,
+      keys,
+      values);
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::getStructValues(
+    RowSet rows,
+    VectorPtr* result) {
+  auto& valueType = requestedType_->asMap().valueType();
+  std::vector<VectorPtr> children(structKeys_.size());
+  for (auto i = 0; i < structKeys_.size(); ++i) {
+    if (structKeys_[i] < 0) {
+      children[i] =
+          BaseVector::createNullConstant(valueType, rows.size(), &memoryPool);
+      continue;
+    }
+    auto& key = *keys_[structKeys_[i]];
+    key.setValueRows(rows);
+    if (key.valueRows.empty()) {
+      children[i] =
+          BaseVector::createNullConstant(valueType, rows.size(), &memoryPool);
+      continue;
+    }
+    VectorPtr values;
+    key.reader->getValues(key.valueRows, &values);
+    if (key.valueRows.size() == rows.size()) {
+      children[i] = std::move(values);
+      continue;
+    }
+    // The rows without the key are null.
+    auto indices =
+        AlignedBuffer::allocate<vector_size_t>(rows.size(), &memoryPool);
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    auto nulls = AlignedBuffer::allocate<bool>(rows.size(), &memoryPool);
+    auto rawNulls = nulls->asMutable<uint64_t>();
+    vector_size_t index = 0;
+    for (auto j = 0; j < rows.size(); ++j) {
+      bool hasValue = key.valueIndices[rows[j]] != kNoValue;
+      rawIndices[j] = hasValue ? index++ : 0;
+      bits::setNull(rawNulls, j, !hasValue);
+    }
+    children[i] = BaseVector::wrapInDictionary(
+        nulls, indices, rows.size(), std::move(values));
+  }
+  *result = std::make_shared<RowVector>(
+      &memoryPool,
+      structType_,
+      nullsAt(rows),
+      rows.size(),
+      std::move(children));
+}
+
+std::unique_ptr<SelectiveColumnReader> buildFlatMapReader(
+    const EncodingKey& ek,
+    const std::shared_ptr<const TypeWithId>& requestedType,
+    const std::shared_ptr<const TypeWithId>& dataType,
+    StripeStreams& stripe,
+    common::ScanSpec* scanSpec) {
+  switch (dataType->childAt(0)->type->kind()) {
+    case TypeKind::TINYINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int8_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::SMALLINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int16_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::INTEGER:
+      return std::make_unique<SelectiveFlatMapColumnReader<int32_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::BIGINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int64_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::VARBINARY:
+    case TypeKind::VARCHAR:
+      return std::make_unique<SelectiveFlatMapColumnReader<StringView>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    default:
+      DWIO_RAISE(
+          "Not supported flat map key type: ",
+          mapTypeKindToName(dataType->childAt(0)->type->kind()));
+  }
+}
+
 } // namespace
 
 std::unique_ptr<SelectiveColumnReader> buildIntegerReader(
@@ -4629,7 +5638,8 @@ std::unique_ptr<SelectiveColumnReader> SelectiveColumnReader::build(
     case TypeKind::MAP:
       if (stripe.getEncoding(ek).kind() ==
           proto::ColumnEncoding_Kind_MAP_FLAT) {
-        VELOX_UNSUPPORTED("SelectiveColumnReader does not support flat maps");
+        return buildFlatMapReader(
+            ek, requestedType, dataType, stripe, scanSpec);
       }
       return std::make_unique<SelectiveMapColumnReader>(
           ek, requestedType, dataType, stripe, scanSpec);
@@ -196,9 +196,12 @@ class SelectiveColumnReader : public ColumnReader {
     initTimeClocks_ = 0;
   }
 
+  // Returns the row groups that cannot pass the filter by their
+  // statistics. Returns all row groups if the values are all in a
+  // dictionary and no dictionary entry passes the filter.
   std::vector<uint32_t> filterRowGroups(
       uint64_t rowGroupSize,
-      const StatsContext& context) const override;
+      const StatsContext& context) override;
 
   raw_vector<int32_t>& innerNonNullRows() {
     return innerNonNullRows_;
@@ -277,6 +280,14 @@ class SelectiveColumnReader : public ColumnReader {
   // copy.
   char* copyStringValue(folly::StringPiece value);
 
+  // Records the result of 'filter' for each entry of the stripe
+  // dictionary of 'this'. Returns false if all values of the stripe are
+  // in the dictionary and no entry passes. Returns true if there is no
+  // dictionary.
+  virtual bool filterDictionary(common::Filter& /*filter*/) {
+    return true;
+  }
+
   void ensureRowGroupIndex() const {
     if (indexStream_) {
       index_ = ProtoUtils::readProto<proto::RowIndex>(std::move(indexStream_));
@@ -290,6 +301,9 @@ class SelectiveColumnReader : public ColumnReader {
   TypePtr type_;
   mutable std::unique_ptr<SeekableInputStream> indexStream_;
   mutable std::unique_ptr<proto::RowIndex> index_;
+  // Set if the column has a Bloom filter for each row group and 'this'
+  // has a filter.
+  std::unique_ptr<SeekableInputStream> bloomFilterStream_;
   // Number of rows in a row group. Last row group may have fewer rows.
   uint32_t rowsPerRowGroup_;
   // Row number after last read row, relative to stripe start.
@@ -340,6 +354,10 @@ class SelectiveColumnReader : public ColumnReader {
   // True if a vector can acquire a pin to a stream's buffer and refer
   // to that as its values.
   bool mayUseStreamBuffer_ = false;
+  // Range of a pinned stream buffer that is in 'stringBuffers_' of the
+  // next result. Strings inside the range are referenced, not copied.
+  const char* pinnedStart_ = nullptr;
+  const char* pinnedEnd_ = nullptr;
   // True if nulls and everything selected, so that nullsInReadRange
   // can be returned as the null flags of the vector in getValues().
   bool returnReaderNulls_ = false;
@@ -365,6 +383,11 @@ inline void SelectiveColumnReader::addValue(const folly::StringPiece value) {
         StringView(value.data(), size);
     return;
   }
+  if (value.data() >= pinnedStart_ && value.end() <= pinnedEnd_) {
+    reinterpret_cast<StringView*>(rawValues_)[numValues_++] =
+        StringView(value.data(), size);
+    return;
+  }
   if (rawStringBuffer_ && rawStringUsed_ + size <= rawStringSize_) {
     memcpy(rawStringBuffer_ + rawStringUsed_, value.data(), size);
     reinterpret_cast<StringView*>(rawValues_)[numValues_++] =
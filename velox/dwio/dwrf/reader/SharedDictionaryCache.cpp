@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/dwio/dwrf/reader/SharedDictionaryCache.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <gflags/gflags.h>
+
+DECLARE_int32(velox_shared_dictionary_cache_mb);
+
+namespace facebook::velox::dwrf {
+
+void SharedDictionary::makeValues(
+    const TypePtr& type,
+    uint64_t count,
+    memory::MemoryPool& pool) {
+  BufferPtr valueBuffer = AlignedBuffer::allocate<StringView>(count, &pool);
+  auto* rawValues = valueBuffer->asMutable<StringView>();
+  const auto* rawBlob = blob->as<char>();
+  const auto* rawOffsets = offsets->as<int64_t>();
+  for (uint64_t i = 0; i < count; ++i) {
+    rawValues[i] = StringView(
+        rawBlob + rawOffsets[i], rawOffsets[i + 1] - rawOffsets[i]);
+  }
+  values = std::make_shared<FlatVector<StringView>>(
+      &pool,
+      type,
+      BufferPtr(nullptr),
+      count,
+      std::move(valueBuffer),
+      std::vector<BufferPtr>{blob});
+}
+
+int64_t SharedDictionary::size() const {
+  int64_t size = sizeof(SharedDictionary) + blob->capacity() +
+      offsets->capacity();
+  if (values) {
+    size += values->values()->capacity();
+  }
+  return size;
+}
+
+SharedDictionaryCache::SharedDictionaryCache(int64_t maxBytes)
+    : maxBytes_(maxBytes),
+      pool_(memory::getDefaultScopedMemoryPool()),
+      cache_(maxBytes) {}
+
+// static
+SharedDictionaryCache& SharedDictionaryCache::instance() {
+  // Not destroyed at exit because the entries hold leases on fileIds().
+  static SharedDictionaryCache* cache = new SharedDictionaryCache(
+      static_cast<int64_t>(FLAGS_velox_shared_dictionary_cache_mb) << 20);
+  return *cache;
+}
+
+std::shared_ptr<const SharedDictionary> SharedDictionaryCache::find(
+    const SharedDictionaryKey& key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto* entry = cache_.get(key);
+  if (!entry) {
+    return nullptr;
+  }
+  auto dictionary = entry->dictionary;
+  cache_.release(key);
+  return dictionary;
+}
+
+std::shared_ptr<const SharedDictionary> SharedDictionaryCache::get(
+    const SharedDictionaryKey& key,
+    Loader loader) {
+  if (auto dictionary = find(key)) {
+    ++numHits_;
+    return dictionary;
+  }
+  ++numMisses_;
+  std::shared_ptr<const SharedDictionary> dictionary = loader(*pool_);
+  auto size = dictionary->size();
+  if (size > maxBytes_) {
+    return dictionary;
+  }
+  auto entry = std::make_unique<Entry>(
+      Entry{StringIdLease(fileIds(), key.fileNum), dictionary});
+  std::lock_guard<std::mutex> l(mutex_);
+  if (cache_.add(key, entry.get(), size)) {
+    entry.release();
+    return dictionary;
+  }
+  // Another reader cached the dictionary first.
+  if (auto* existing = cache_.get(key)) {
+    dictionary = existing->dictionary;
+    cache_.release(key);
+  }
+  return dictionary;
+}
+
+} // namespace facebook::velox::dwrf
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/hash/Hash.h>
+#include <atomic>
+#include <mutex>
+
+#include "velox/common/caching/SimpleLRUCache.h"
+#include "velox/common/caching/StringIdMap.h"
+#include "velox/common/memory/Memory.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::dwrf {
+
+// Decoded stripe dictionary of a string column. Immutable and shared by
+// the readers of the stripe.
+struct SharedDictionary {
+  // Concatenated dictionary entries.
+  BufferPtr blob;
+  // 'count' + 1 int64_t offsets of the entries in 'blob'.
+  BufferPtr offsets;
+  // The entries as a vector over 'blob'. Used as base vector of the
+  // dictionaries produced by the readers.
+  FlatVectorPtr<StringView> values;
+
+  // Sets 'values' to a vector of the 'count' entries in 'blob'.
+  void makeValues(
+      const TypePtr& type,
+      uint64_t count,
+      memory::MemoryPool& pool);
+
+  // Returns the approximate memory footprint.
+  int64_t size() const;
+};
+
+// Identifies the dictionary of a column in a stripe of a version of a
+// file. 'sequence' tells apart the keys of a flat map.
+struct SharedDictionaryKey {
+  uint64_t fileNum;
+  int64_t modificationTime;
+  uint32_t stripe;
+  uint32_t node;
+  uint32_t sequence;
+
+  bool operator==(const SharedDictionaryKey& other) const {
+    return fileNum == other.fileNum &&
+        modificationTime == other.modificationTime && stripe == other.stripe &&
+        node == other.node && sequence == other.sequence;
+  }
+};
+
+struct SharedDictionaryKeyHasher {
+  size_t operator()(const SharedDictionaryKey& key) const {
+    return folly::hash::hash_combine(
+        key.fileNum, key.modificationTime, key.stripe, key.node, key.sequence);
+  }
+};
+
+// Process-wide cache of decoded stripe string dictionaries, so that
+// drivers scanning different row groups of a stripe and queries
+// re-reading a hot stripe decode its dictionaries once. Bounded by the
+// size of the cached dictionaries. Thread-safe.
+class SharedDictionaryCache {
+ public:
+  using Loader =
+      folly::Function<std::shared_ptr<SharedDictionary>(memory::MemoryPool&)>;
+
+  explicit SharedDictionaryCache(int64_t maxBytes);
+
+  // Returns the instance sized by --velox_shared_dictionary_cache_mb.
+  static SharedDictionaryCache& instance();
+
+  // Returns the dictionary for 'key'. If it is not cached, makes it with
+  // 'loader', which allocates from pool(), and caches it if it fits.
+  // Readers missing the same key at the same time may both load it. The
+  // first one to finish is cached and returned to both.
+  std::shared_ptr<const SharedDictionary> get(
+      const SharedDictionaryKey& key,
+      Loader loader);
+
+  // Pool for the buffers of cached dictionaries.
+  memory::MemoryPool& pool() {
+    return *pool_;
+  }
+
+  int64_t maxBytes() const {
+    return maxBytes_;
+  }
+
+  int64_t numHits() const {
+    return numHits_;
+  }
+
+  int64_t numMisses() const {
+    return numMisses_;
+  }
+
+ private:
+  struct Entry {
+    // Keeps the file number of the key from being reused for another
+    // file while the entry is cached.
+    StringIdLease fileLease;
+    std::shared_ptr<const SharedDictionary> dictionary;
+  };
+
+  // Returns the cached dictionary for 'key' or nullptr.
+  std::shared_ptr<const SharedDictionary> find(const SharedDictionaryKey& key);
+
+  const int64_t maxBytes_;
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::mutex mutex_;
+  SimpleLRUCache<
+      SharedDictionaryKey,
+      Entry,
+      std::equal_to<SharedDictionaryKey>,
+      SharedDictionaryKeyHasher>
+      cache_;
+  std::atomic<int64_t> numHits_{0};
+  std::atomic<int64_t> numMisses_{0};
+};
+
+} // namespace facebook::velox::dwrf
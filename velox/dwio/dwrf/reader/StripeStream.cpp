@@ -265,24 +265,39 @@ std::unique_ptr<SeekableInputStream> StripeStreamsImpl::getStream(
     return {};
   }
 
+  auto streamDebugInfo =
+      fmt::format("Stripe {} Stream {}", stripeIndex_, si.toString());
+  auto decrypter = getDecrypter(si.node);
+  dwio::common::Region region{
+      info.getOffset() + stripeStart_, info.getLength()};
   std::unique_ptr<SeekableInputStream> streamRead;
   if (si.kind == StreamKind::StreamKind_ROW_INDEX) {
     streamRead = getIndexStreamFromCache(info);
+  } else if (
+      !decrypter &&
+      reader_.getReader().getCompressionKind() !=
+          CompressionKind::CompressionKind_NONE) {
+    // Hot streams may be cached in decompressed form.
+    auto decompressed = reader_.getStripeInput().enqueueDecompressed(
+        region, &si, [&](std::unique_ptr<SeekableInputStream> compressed) {
+          return reader_.getReader().createDecompressedStream(
+              std::move(compressed), streamDebugInfo);
+        });
+    if (decompressed) {
+      return decompressed;
+    }
   }
 
   if (!streamRead) {
-    streamRead = reader_.getStripeInput().enqueue(
-        {info.getOffset() + stripeStart_, info.getLength()}, &si);
+    streamRead = reader_.getStripeInput().enqueue(region, &si);
   }
 
   if (!streamRead) {
     return streamRead;
   }
 
-  auto streamDebugInfo =
-      fmt::format("Stripe {} Stream {}", stripeIndex_, si.toString());
   return reader_.getReader().createDecompressedStream(
-      std::move(streamRead), streamDebugInfo, getDecrypter(si.node));
+      std::move(streamRead), streamDebugInfo, decrypter);
 }
 
 uint32_t StripeStreamsImpl::visitStreamsOfNode(
@@ -308,6 +323,27 @@ bool StripeStreamsImpl::getUseVInts(const StreamIdentifier& si) const {
   return info.getUseVInts();
 }
 
+bool StripeStreamsImpl::getSharedDictionaryKey(
+    const EncodingKey& ek,
+    SharedDictionaryKey& key) const {
+  auto* config = reader_.getReader().getDataCacheConfig();
+  if (!config || config->modificationTime == 0 ||
+      SharedDictionaryCache::instance().maxBytes() == 0) {
+    return false;
+  }
+  // Decrypted data is not kept beyond the reader that has the key.
+  if (decryptedEncodings_.count(ek)) {
+    return false;
+  }
+  key = SharedDictionaryKey{
+      config->filenum,
+      config->modificationTime,
+      stripeIndex_,
+      ek.node,
+      ek.sequence};
+  return true;
+}
+
 std::unique_ptr<SeekableInputStream> StripeStreamsImpl::getIndexStreamFromCache(
     const StreamInformation& info) const {
   std::unique_ptr<SeekableInputStream> indexStream;
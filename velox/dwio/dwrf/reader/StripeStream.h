@@ -20,6 +20,7 @@
 #include "velox/dwio/common/Options.h"
 #include "velox/dwio/dwrf/common/Common.h"
 #include "velox/dwio/dwrf/common/InputStream.h"
+#include "velox/dwio/dwrf/reader/SharedDictionaryCache.h"
 #include "velox/dwio/dwrf/reader/StripeDictionaryCache.h"
 #include "velox/dwio/dwrf/reader/StripeReaderBase.h"
 
@@ -129,6 +130,15 @@ class StripeStreams {
 
   virtual std::shared_ptr<StripeDictionaryCache> getStripeDictionaryCache() = 0;
 
+  /// Sets 'key' to identify the string dictionary of 'ek' in the
+  /// process-wide SharedDictionaryCache. Returns false if the dictionary
+  /// is not shared, e.g. if the version of the file is not known.
+  virtual bool getSharedDictionaryKey(
+      const EncodingKey& /*ek*/,
+      SharedDictionaryKey& /*key*/) const {
+    return false;
+  }
+
   /**
    * visit all streams of given node and execute visitor logic
    * return number of streams visited
@@ -278,6 +288,9 @@ class StripeStreamsImpl : public StripeStreamsBase {
 
   bool getUseVInts(const StreamIdentifier& si) const override;
 
+  bool getSharedDictionaryKey(const EncodingKey& ek, SharedDictionaryKey& key)
+      const override;
+
   const StrideIndexProvider& getStrideIndexProvider() const override {
     return provider_;
   }
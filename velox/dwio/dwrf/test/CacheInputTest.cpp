@@ -18,10 +18,15 @@
 #include <folly/container/F14Map.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include "velox/common/caching/FileIds.h"
+#include "velox/dwio/common/MemoryInputStream.h"
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
+#include "velox/dwio/dwrf/common/Compression.h"
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+DECLARE_bool(velox_dwrf_cache_decompressed);
+
 using namespace facebook::velox;
 using namespace facebook::velox::dwio;
 using namespace facebook::velox::cache;
@@ -314,6 +319,37 @@ TEST_F(CacheTest, bufferedInput) {
   readLoop("testfile2", 30, 70, 70, 20);
 }
 
+TEST_F(CacheTest, adaptiveCoalescing) {
+  initializeCache(1 << 30);
+  // Reads of 64K to 4MB from a storage with 2ms latency and 1000
+  // bytes per microsecond.
+  for (auto i = 0; i < 100; ++i) {
+    uint64_t bytes = (64 << 10) << (i % 7);
+    ioStats_->recordStorageRead(bytes, 2000 + bytes / 1000);
+  }
+  auto model = ioStats_->storageReadModel();
+  ASSERT_TRUE(model.has_value());
+  EXPECT_NEAR(2000, model->latencyUs, 10);
+  EXPECT_NEAR(1000, model->bytesPerUs, 10);
+
+  uint64_t fileId;
+  uint64_t groupId;
+  auto input = inputByPath("coalescing", fileId, groupId);
+  auto stripe = makeStripeData(
+      input, std::make_shared<ScanTracker>(), fileId, groupId, 0);
+  EXPECT_EQ(
+      dwrf::BufferedInput::kMaxMergeDistance,
+      stripe->input->maxMergeDistance());
+  stripe->input->load(common::LogType::TEST);
+  // 2ms at 1000 bytes per microsecond.
+  EXPECT_NEAR(2'000'000, stripe->input->maxMergeDistance(), 20'000);
+  EXPECT_EQ(
+      8 * stripe->input->maxMergeDistance(), stripe->input->maxLoadBytes());
+  for (auto i = 0; i < kMaxStreams; ++i) {
+    readStream(*stripe, i);
+  }
+}
+
 TEST_F(CacheTest, TestSingleFileThreads) {
   initializeCache(1 << 30);
 
@@ -329,3 +365,86 @@ TEST_F(CacheTest, TestSingleFileThreads) {
     threads[i].join();
   }
 }
+
+TEST_F(CacheTest, decompressed) {
+  FLAGS_velox_dwrf_cache_decompressed = true;
+  initializeCache(64 << 20);
+  // A compressed stream of uncompressed chunks, each with a 3 byte
+  // header.
+  constexpr int32_t kChunkSize = 1000;
+  constexpr int32_t kNumChunks = 10;
+  std::string file;
+  std::string expected;
+  for (auto i = 0; i < kNumChunks; ++i) {
+    uint32_t header = (kChunkSize << 1) | 1;
+    file.push_back(header & 0xff);
+    file.push_back((header >> 8) & 0xff);
+    file.push_back(header >> 16);
+    for (auto j = 0; j < kChunkSize; ++j) {
+      char c = (i * kChunkSize + j) % 251;
+      file.push_back(c);
+      expected.push_back(c);
+    }
+  }
+  StringIdLease fileId(fileIds(), "decompressedTest");
+  auto tracker = std::make_shared<ScanTracker>();
+  auto* si = streamIds_[0].get();
+  TrackingId id(si->node, si->kind);
+  // Makes the stream hot.
+  tracker->recordReference(id, 100, 0);
+  tracker->recordRead(id, 100, 0);
+  auto decompress = [&](std::unique_ptr<dwrf::SeekableInputStream> input) {
+    return dwrf::createDecompressor(
+        dwrf::CompressionKind_ZLIB, std::move(input), 256 << 10, *pool_, "");
+  };
+  Region region{0, file.size()};
+
+  auto check = [&](dwrf::SeekableInputStream& stream) {
+    const void* data;
+    int32_t size;
+    std::string result;
+    while (stream.Next(&data, &size)) {
+      result.append(reinterpret_cast<const char*>(data), size);
+    }
+    EXPECT_EQ(expected, result);
+    // Seeks to byte 10 of the fourth chunk.
+    std::vector<uint64_t> offsets = {3 * (kChunkSize + 3), 10};
+    dwrf::PositionProvider positions(offsets);
+    stream.seekToRowGroup(positions);
+    ASSERT_TRUE(stream.Next(&data, &size));
+    ASSERT_GT(size, 0);
+    EXPECT_EQ(0, memcmp(data, expected.data() + 3 * kChunkSize + 10, size));
+  };
+
+  auto makeInput = [&](std::shared_ptr<common::InputStream> input) {
+    common::DataCacheConfig config{nullptr, fileId.id()};
+    return std::make_unique<dwrf::CachedBufferedInput>(
+        *input,
+        *pool_,
+        &config,
+        cache_.get(),
+        tracker,
+        0,
+        [input]() { return std::make_unique<TestInputStreamHolder>(input); },
+        ioStats_,
+        executor_.get());
+  };
+
+  auto input =
+      std::make_shared<common::MemoryInputStream>(file.data(), file.size());
+  auto bufferedInput = makeInput(input);
+  auto stream = bufferedInput->enqueueDecompressed(region, si, decompress);
+  ASSERT_TRUE(stream != nullptr);
+  bufferedInput->load(common::LogType::TEST);
+  check(*stream);
+
+  // The second read hits the decompressed data and does not read the
+  // file, which here has different content.
+  std::string zeros(file.size(), 0);
+  auto otherInput = makeInput(
+      std::make_shared<common::MemoryInputStream>(zeros.data(), zeros.size()));
+  stream = otherInput->enqueueDecompressed(region, si, decompress);
+  ASSERT_TRUE(stream != nullptr);
+  check(*stream);
+  FLAGS_velox_dwrf_cache_decompressed = false;
+}
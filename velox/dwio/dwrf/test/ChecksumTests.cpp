@@ -15,6 +15,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <boost/crc.hpp>
 #include "velox/dwio/dwrf/common/Checksum.h"
 
 using namespace ::testing;
@@ -61,3 +62,20 @@ TEST_F(ChecksumTests, xxHash) {
 TEST_F(ChecksumTests, Crc32) {
   runTest(proto::ChecksumAlgorithm::CRC32, 4133052486, 3074245904);
 }
+
+TEST_F(ChecksumTests, Crc32Chunks) {
+  // Updates of odd sizes at odd offsets give the same digest as one
+  // boost::crc_32_type over the whole input.
+  auto checksum = ChecksumFactory::create(proto::ChecksumAlgorithm::CRC32);
+  boost::crc_32_type expected;
+  size_t offset = 0;
+  for (size_t size = 1; offset + size <= data.size(); size += 37) {
+    checksum->update(data.data() + offset, size);
+    expected.process_bytes(data.data() + offset, size);
+    offset += size;
+    ASSERT_EQ(expected.checksum(), checksum->getDigest(false));
+  }
+  ASSERT_EQ(expected.checksum(), checksum->getDigest());
+  checksum->update(data.data(), 0);
+  ASSERT_EQ(boost::crc_32_type().checksum(), checksum->getDigest());
+}
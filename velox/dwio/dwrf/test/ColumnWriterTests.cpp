@@ -2858,6 +2858,72 @@ TEST(ColumnWriterTests, IntDictWriterDirectValueOverflow) {
   }
 }
 
+template <typename T>
+void testDictionarySample(
+    const std::shared_ptr<const Type>& type,
+    std::function<T(size_t)> valueAt) {
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  auto typeWithId = TypeWithId::create(type, 1);
+  auto rowType = ROW({"foo"}, {type});
+
+  // The first 100 rows are distinct and the rest repeat one value, so only
+  // a decision on the sample gives up the dictionary.
+  std::vector<std::optional<T>> sample;
+  std::vector<std::optional<T>> rest;
+  for (auto i = 0; i < 100; ++i) {
+    sample.push_back(valueAt(i));
+  }
+  for (auto i = 0; i < 900; ++i) {
+    rest.push_back(valueAt(0));
+  }
+  std::vector<VectorPtr> batches{
+      populateBatch<T>(sample, &pool), populateBatch<T>(rest, &pool)};
+
+  for (uint32_t sampleRows : {0, 100}) {
+    auto config = std::make_shared<Config>();
+    config->set(Config::DICTIONARY_ENCODING_SAMPLE_ROWS, sampleRows);
+    WriterContext context{config, getDefaultScopedMemoryPool()};
+    auto writer = ColumnWriter::create(context, *typeWithId, 0);
+    for (auto& batch : batches) {
+      writer->write(batch, Ranges::of(0, batch->size()));
+    }
+    writer->createIndexEntry();
+    proto::StripeFooter sf;
+    writer->flush([&sf](auto /* unused */) -> proto::ColumnEncoding& {
+      return *sf.add_encoding();
+    });
+    ASSERT_EQ(
+        sf.encoding(0).kind(),
+        sampleRows == 0 ? proto::ColumnEncoding_Kind_DICTIONARY
+                        : proto::ColumnEncoding_Kind_DIRECT);
+
+    MockStripeStreams streams(context, sf, rowType);
+    EXPECT_CALL(streams.getMockStrideIndexProvider(), getStrideIndex())
+        .WillRepeatedly(Return(0));
+    auto reqType = TypeWithId::create(rowType)->childAt(0);
+    auto reader = ColumnReader::build(reqType, reqType, streams, false);
+    for (auto& batch : batches) {
+      VectorPtr out;
+      reader->next(batch->size(), out);
+      ASSERT_EQ(out->size(), batch->size());
+      for (auto i = 0; i < batch->size(); ++i) {
+        ASSERT_TRUE(out->equalValueAt(batch.get(), i, i)) << "at index " << i;
+      }
+    }
+  }
+}
+
+TEST(ColumnWriterTests, abandonDictionaryAfterSample) {
+  testDictionarySample<int64_t>(
+      BIGINT(), [](size_t i) { return static_cast<int64_t>(i) * 1'001; });
+  // Short strings are inlined in the StringView.
+  testDictionarySample<StringView>(VARCHAR(), [](size_t i) {
+    auto value = folly::to<std::string>(i);
+    return StringView(value.data(), value.size());
+  });
+}
+
 TEST(ColumnWriterTests, ShortDictWriterDictValueOverflow) {
   auto config = std::make_shared<Config>();
   auto scopedPool = getDefaultScopedMemoryPool();
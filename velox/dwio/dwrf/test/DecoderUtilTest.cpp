@@ -164,3 +164,53 @@ TEST_F(DecoderUtilTest, nonNullsFromSparse) {
     }
   }
 }
+
+TEST_F(DecoderUtilTest, mergePassingNulls) {
+  constexpr int32_t kSize = 2000;
+  for (auto nullsIn1000 = 1; nullsIn1000 < 1011; nullsIn1000 += 100) {
+    for (auto rowsIn1000 = 1; rowsIn1000 < 1011; rowsIn1000 += 100) {
+      raw_vector<int32_t> rows;
+      std::vector<uint64_t> nulls(bits::nwords(kSize) + 1);
+      randomBits(nulls, 1000 - nullsIn1000);
+      randomRows(kSize, rowsIn1000, rows);
+      // The non-null rows divisible by 3 pass. 'hits' and 'values' are
+      // as a filtering scan leaves them and 'expected*' is the result
+      // with the nulls added.
+      std::vector<int32_t> hits(rows.size());
+      std::vector<double> values(rows.size());
+      std::vector<int32_t> expectedHits;
+      std::vector<bool> expectedNulls;
+      int32_t numPassed = 0;
+      for (auto row : rows) {
+        if (bits::isBitNull(nulls.data(), row)) {
+          expectedHits.push_back(row);
+          expectedNulls.push_back(true);
+        } else if (row % 3 == 0) {
+          hits[numPassed] = row;
+          values[numPassed++] = row * 10.0;
+          expectedHits.push_back(row);
+          expectedNulls.push_back(false);
+        }
+      }
+      std::vector<uint64_t> resultNulls(bits::nwords(rows.size()) + 1, 0);
+      auto numResults = mergePassingNulls<double, false>(
+          nulls.data(),
+          rows,
+          numPassed,
+          hits.data(),
+          values.data(),
+          resultNulls.data());
+      ASSERT_EQ(expectedHits.size(), numResults);
+      bool anyNull = numResults > numPassed;
+      for (auto i = 0; i < numResults; ++i) {
+        EXPECT_EQ(expectedHits[i], hits[i]);
+        if (anyNull) {
+          EXPECT_EQ(expectedNulls[i], bits::isBitNull(resultNulls.data(), i));
+        }
+        if (!expectedNulls[i]) {
+          EXPECT_EQ(hits[i] * 10.0, values[i]);
+        }
+      }
+    }
+  }
+}
@@ -551,6 +551,15 @@ class E2EFilterTest : public testing::Test {
     auto config = std::make_shared<dwrf::Config>();
     config->set(dwrf::Config::COMPRESSION, dwrf::CompressionKind_NONE);
     config->set(dwrf::Config::USE_VINTS, useVInts_);
+    if (!flatMapColumns_.empty()) {
+      config->set(dwrf::Config::FLATTEN_MAP, true);
+      config->set<const std::vector<uint32_t>>(
+          dwrf::Config::MAP_FLAT_COLS, flatMapColumns_);
+    }
+    if (!bloomFilterColumns_.empty()) {
+      config->set<const std::vector<uint32_t>>(
+          dwrf::Config::BLOOM_FILTER_COLUMNS, bloomFilterColumns_);
+    }
     WriterOptions options;
     options.config = config;
     options.schema = type;
@@ -617,7 +626,8 @@ class E2EFilterTest : public testing::Test {
       const std::vector<uint32_t>& hitRows,
       uint64_t& time,
       bool useValueHook,
-      bool skipCheck = false) {
+      bool skipCheck = false,
+      int64_t* numSkippedStrides = nullptr) {
     auto input = std::make_unique<MemoryInputStream>(
         sinkPtr_->getData(), sinkPtr_->size());
 
@@ -676,6 +686,9 @@ class E2EFilterTest : public testing::Test {
     if (!skipCheck) {
       ASSERT_EQ(rowIndex, hitRows.size());
     }
+    if (numSkippedStrides) {
+      *numSkippedStrides = rowReader->skippedStrides();
+    }
   }
 
   template <TypeKind Kind>
@@ -899,6 +912,10 @@ class E2EFilterTest : public testing::Test {
   std::unordered_map<std::string, std::array<int32_t, 2>> filterCoverage_;
   folly::Random::DefaultGenerator rng_;
   bool useVInts_ = true;
+  // Top level columns written as flat maps.
+  std::vector<uint32_t> flatMapColumns_;
+  // Top level columns written with Bloom filters.
+  std::vector<uint32_t> bloomFilterColumns_;
 }; // namespace facebook::velox::dwio::dwrf
 
 TEST_F(E2EFilterTest, integerDirect) {
@@ -1022,4 +1039,109 @@ TEST_F(E2EFilterTest, listAndMap) {
       10);
 }
 
+TEST_F(E2EFilterTest, flatMap) {
+  flatMapColumns_ = {2};
+  testWithTypes(
+      "long_val:bigint,"
+      "int_val:int,"
+      "map_val:map<tinyint,bigint>",
+      [&]() {},
+      false,
+      {"long_val", "int_val"},
+      10);
+}
+
+TEST_F(E2EFilterTest, flatMapKeyFilter) {
+  flatMapColumns_ = {1};
+  makeDataset("long_val:bigint,map_val:map<tinyint,bigint>", nullptr, false);
+  auto spec = makeScanSpec(SubfieldFilters{});
+  spec->getOrCreateChild(Subfield("map_val[1]"))
+      ->setFilter(std::make_unique<velox::common::BigintRange>(
+          0, std::numeric_limits<int64_t>::max(), false));
+
+  // The rows where key 1 is present with a non-negative value.
+  std::vector<uint32_t> hitRows;
+  for (auto i = 0; i < batches_.size(); ++i) {
+    auto map = batches_[i]->childAt(1)->as<MapVector>();
+    auto keys = map->mapKeys()->as<FlatVector<int8_t>>();
+    auto values = map->mapValues()->as<FlatVector<int64_t>>();
+    for (auto row = 0; row < map->size(); ++row) {
+      if (map->isNullAt(row)) {
+        continue;
+      }
+      auto end = map->offsetAt(row) + map->sizeAt(row);
+      for (auto j = map->offsetAt(row); j < end; ++j) {
+        if (keys->valueAt(j) == 1 && !values->isNullAt(j) &&
+            values->valueAt(j) >= 0) {
+          hitRows.push_back(batchPosition(i, row));
+        }
+      }
+    }
+  }
+  ASSERT_FALSE(hitRows.empty());
+  uint64_t time = 0;
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+}
+
+TEST_F(E2EFilterTest, bloomFilter) {
+  bloomFilterColumns_ = {0, 1};
+  makeDataset("long_val:bigint,string_val:string", nullptr, false);
+  // Looks up the values of two rows. The values are random, so the min and
+  // max of the row groups do not exclude any of them.
+  std::vector<std::array<vector_size_t, 2>> probes{{0, 10}, {2, 20'000}};
+  std::vector<int64_t> longs;
+  std::vector<std::string> strings;
+  for (auto [batch, row] : probes) {
+    auto rowVector = batches_[batch];
+    longs.push_back(
+        rowVector->childAt(0)->as<FlatVector<int64_t>>()->valueAt(row));
+    strings.push_back(
+        rowVector->childAt(1)->as<FlatVector<StringView>>()->valueAt(row));
+  }
+  std::sort(longs.begin(), longs.end());
+
+  for (auto column = 0; column < 2; ++column) {
+    SubfieldFilters filters;
+    if (column == 0) {
+      filters[Subfield("long_val")] =
+          std::make_unique<velox::common::BigintValuesUsingHashTable>(
+              longs.front(), longs.back(), longs, false);
+    } else {
+      filters[Subfield("string_val")] =
+          std::make_unique<velox::common::BytesValues>(strings, false);
+    }
+    auto spec = makeScanSpec(std::move(filters));
+    std::vector<uint32_t> hitRows;
+    for (auto i = 0; i < batches_.size(); ++i) {
+      auto values = batches_[i]->childAt(column);
+      for (auto row = 0; row < values->size(); ++row) {
+        if (values->isNullAt(row)) {
+          continue;
+        }
+        bool hit = column == 0
+            ? std::binary_search(
+                  longs.begin(),
+                  longs.end(),
+                  values->as<FlatVector<int64_t>>()->valueAt(row))
+            : std::find(
+                  strings.begin(),
+                  strings.end(),
+                  std::string(
+                      values->as<FlatVector<StringView>>()->valueAt(row))) !=
+                strings.end();
+        if (hit) {
+          hitRows.push_back(batchPosition(i, row));
+        }
+      }
+    }
+    uint64_t time = 0;
+    int64_t numSkippedStrides = 0;
+    readWithFilter(
+        spec.get(), batches_, hitRows, time, false, false, &numSkippedStrides);
+    // 4 stripes of 3 row groups. Only the 2 row groups with the values are
+    // read, except for a rare false positive.
+    EXPECT_GE(numSkippedStrides, 9);
+  }
+}
+
 } // namespace facebook::velox::dwio::dwrf
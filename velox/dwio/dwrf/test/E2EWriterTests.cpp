@@ -15,6 +15,7 @@
  */
 
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "velox/dwio/common/MemoryInputStream.h"
 #include "velox/dwio/common/Options.h"
 #include "velox/dwio/common/encryption/TestProvider.h"
@@ -141,6 +142,50 @@ TEST(E2EWriterTests, E2E) {
   E2EWriterTestUtil::testWriter(pool, type, batches, 1, 1, config, true, false);
 }
 
+TEST(E2EWriterTests, ParallelFlush) {
+  const size_t batchCount = 4;
+  const size_t size = 1100;
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+
+  HiveTypeParser parser;
+  auto type = parser.parse(
+      "struct<"
+      "int_val:int,"
+      "long_val:bigint,"
+      "double_val:double,"
+      "string_val:string,"
+      "array_val:array<float>,"
+      "map_val:map<bigint,double>,"
+      "struct_val:struct<a:float,b:double>"
+      ">");
+
+  auto config = std::make_shared<Config>();
+  config->set(Config::ROW_INDEX_STRIDE, static_cast<uint32_t>(1000));
+  config->set(Config::COMPRESSION_THRESHOLD, static_cast<uint32_t>(0));
+
+  std::vector<VectorPtr> batches;
+  for (size_t i = 0; i < batchCount; ++i) {
+    batches.push_back(BatchMaker::createBatch(type, size, pool));
+  }
+
+  // Each batch is a stripe. The last pages of the streams of each
+  // stripe are compressed on the executor.
+  folly::CPUThreadPoolExecutor executor(4);
+  E2EWriterTestUtil::testWriter(
+      pool,
+      type,
+      batches,
+      batchCount,
+      batchCount,
+      config,
+      false,
+      true,
+      std::numeric_limits<int64_t>::max(),
+      true,
+      &executor);
+}
+
 TEST(E2EWriterTests, MaxFlatMapKeys) {
   using keyType = int32_t;
   using valueType = int32_t;
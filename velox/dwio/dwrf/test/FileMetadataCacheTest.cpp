@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::dwrf;
+
+namespace {
+std::shared_ptr<FileMetadata> makeMetadata(
+    FileMetadataCache& cache,
+    int32_t stripeCacheSize) {
+  auto metadata = std::make_shared<FileMetadata>();
+  metadata->arena = std::make_unique<google::protobuf::Arena>();
+  metadata->postScript = std::make_unique<proto::PostScript>();
+  metadata->footer = google::protobuf::Arena::CreateMessage<proto::Footer>(
+      metadata->arena.get());
+  metadata->footer->set_numberofrows(100);
+  metadata->stripeCache = std::make_shared<dwio::common::DataBuffer<char>>(
+      cache.pool(), stripeCacheSize);
+  return metadata;
+}
+} // namespace
+
+TEST(FileMetadataCacheTest, findAndInsert) {
+  FileMetadataCache cache(10 << 20);
+  StringIdLease file(fileIds(), "file1");
+  FileMetadataKey key{file.id(), 1};
+  EXPECT_EQ(cache.find(key), nullptr);
+  cache.insert(key, makeMetadata(cache, 1000));
+  auto metadata = cache.find(key);
+  ASSERT_NE(metadata, nullptr);
+  EXPECT_EQ(metadata->footer->numberofrows(), 100);
+  // A rewritten file has a different modification time.
+  EXPECT_EQ(cache.find(FileMetadataKey{file.id(), 2}), nullptr);
+  EXPECT_EQ(cache.numHits(), 1);
+  EXPECT_EQ(cache.numMisses(), 2);
+}
+
+TEST(FileMetadataCacheTest, evict) {
+  FileMetadataCache cache(1 << 20);
+  StringIdLease file(fileIds(), "file2");
+  // Each entry takes a little over a third of the budget.
+  for (auto i = 0; i < 5; ++i) {
+    cache.insert(FileMetadataKey{file.id(), i}, makeMetadata(cache, 350'000));
+  }
+  EXPECT_EQ(cache.find(FileMetadataKey{file.id(), 0}), nullptr);
+  EXPECT_NE(cache.find(FileMetadataKey{file.id(), 4}), nullptr);
+  // An entry larger than the cache is not added.
+  cache.insert(FileMetadataKey{file.id(), 10}, makeMetadata(cache, 2 << 20));
+  EXPECT_EQ(cache.find(FileMetadataKey{file.id(), 10}), nullptr);
+  EXPECT_NE(cache.find(FileMetadataKey{file.id(), 4}), nullptr);
+}
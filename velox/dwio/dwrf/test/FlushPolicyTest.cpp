@@ -60,6 +60,40 @@ TEST(DefaultFlushPolicyTest, PredicateTest) {
   }
 }
 
+TEST(StripeSizeFlushPolicyTest, PredicateTest) {
+  StripeSizeFlushPolicy policy{200, 20};
+  // Stripe size, size of the next write, dictionary size.
+  EXPECT_FALSE(policy(0, 0, 0));
+  EXPECT_FALSE(policy(150, 80, 15));
+  EXPECT_TRUE(policy(150, 100, 15));
+  EXPECT_TRUE(policy(150, 80, 21));
+  EXPECT_TRUE(policy(200, 0, 0));
+}
+
+TEST(StripeSizeFlushPolicyTest, EstimateFromContext) {
+  StripeSizeFlushPolicy policy{500, 1 << 20};
+  auto config = std::make_shared<Config>();
+  WriterContext context{config, getDefaultScopedMemoryPool()};
+  ASSERT_TRUE(context.isIndexEnabled);
+  context.stripeRowCount = context.indexStride;
+  context.indexRowCount = 0;
+
+  // 300 bytes on disk at the initial compression ratio guess and as many for
+  // the next stride.
+  context.stripeRawSize = 1'000;
+  EXPECT_FALSE(policy(false, context));
+  EXPECT_TRUE(policy(true, context));
+
+  // A full stride more would overshoot the target by more than the stripe
+  // is short of it.
+  context.stripeRawSize = 1'500;
+  EXPECT_TRUE(policy(false, context));
+
+  // Nothing is left to write in the current stride.
+  context.indexRowCount = context.indexStride;
+  EXPECT_FALSE(policy(false, context));
+}
+
 TEST(RowsPerStripeFlushPolicyTest, EmptyFile) {
   // Empty vector creation succeeds.
   RowsPerStripeFlushPolicy policy({});
@@ -72,4 +72,56 @@ TEST(LayoutPlannerTests, Basic) {
   ASSERT_EQ(pos, dataStreams.size());
 }
 
+TEST(LayoutPlannerTests, ReadGroups) {
+  auto config = std::make_shared<Config>();
+  config->set(Config::COMPRESSION, CompressionKind::CompressionKind_NONE);
+  // Column 3 is read alone and columns 0 and 2 are read together.
+  config->set(Config::COLUMN_READ_GROUPS, {{3}, {0, 2}});
+  WriterContext context{
+      config, facebook::velox::memory::getDefaultScopedMemoryPool()};
+  // Node ids are 1 for column 0, 2 and 3 for column 1, 4 for column 2 and 5
+  // for column 3.
+  auto schema = dwio::common::TypeWithId::create(
+      ROW({"a", "b", "c", "d"},
+          {BIGINT(), ARRAY(BIGINT()), BIGINT(), BIGINT()}));
+  std::vector<StreamIdentifier> streams;
+  std::array<char, 256> data;
+  std::memset(data.data(), 'a', data.size());
+  auto addStream = [&](uint32_t node, StreamKind kind, uint32_t size) {
+    auto streamId = StreamIdentifier{node, 0, 0, kind};
+    streams.push_back(streamId);
+    AppendOnlyBufferedStream out{context.newStream(streamId)};
+    out.write(data.data(), size);
+    out.flush();
+  };
+
+  addStream(1, StreamKind::StreamKind_DATA, 10); // 0
+  addStream(2, StreamKind::StreamKind_PRESENT, 3); // 1
+  addStream(3, StreamKind::StreamKind_DATA, 5); // 2
+  addStream(4, StreamKind::StreamKind_DATA, 20); // 3
+  addStream(5, StreamKind::StreamKind_DATA, 30); // 4
+  addStream(1, StreamKind::StreamKind_ROW_INDEX, 7); // 5
+  addStream(5, StreamKind::StreamKind_ROW_INDEX, 9); // 6
+  addStream(2, StreamKind::StreamKind_ROW_INDEX, 1); // 7
+
+  // The streams of each group come in group order, then the ungrouped
+  // streams. Within a group, the streams are ordered by node size.
+  LayoutPlanner planner{context, schema.get()};
+  std::vector<size_t> indices{6, 5, 7};
+  size_t pos = 0;
+  planner.iterateIndexStreams([&](auto& stream, auto& /* ignored */) {
+    ASSERT_LT(pos, indices.size());
+    ASSERT_EQ(stream, streams.at(indices[pos++]));
+  });
+  ASSERT_EQ(pos, indices.size());
+
+  std::vector<size_t> dataStreams{4, 0, 3, 1, 2};
+  pos = 0;
+  planner.iterateDataStreams([&](auto& stream, auto& /* ignored */) {
+    ASSERT_LT(pos, dataStreams.size());
+    ASSERT_EQ(stream, streams.at(dataStreams[pos++]));
+  });
+  ASSERT_EQ(pos, dataStreams.size());
+}
+
 } // namespace facebook::velox::dwrf
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Measures the throughput of SelectiveColumnReaders over a matrix of
+// column type, encoding, null ratio, filter kind and selectivity,
+// reading with and without AsyncDataCache. Each file has the
+// measured column c0 and a bigint column c1 that is read for the rows
+// passing the filter on c0. Prints rows/s and file bytes/s for each
+// case, and hits and new entries of the cache for the cached reads.
+
+#include <folly/Random.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+
+#include "velox/common/caching/AsyncDataCache.h"
+#include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/ScanTracker.h"
+#include "velox/common/time/Timer.h"
+#include "velox/dwio/common/MemoryInputStream.h"
+#include "velox/dwio/dwrf/common/CachedBufferedInput.h"
+#include "velox/dwio/dwrf/reader/DwrfReader.h"
+#include "velox/dwio/dwrf/reader/ScanSpec.h"
+#include "velox/dwio/dwrf/reader/SelectiveColumnReader.h"
+#include "velox/dwio/dwrf/writer/Writer.h"
+#include "velox/type/Filter.h"
+#include "velox/vector/FlatVector.h"
+
+DEFINE_int32(scan_rows, 1'000'000, "Rows in each generated file");
+DEFINE_int32(scan_batch_size, 10'000, "Rows per RowReader::next");
+DEFINE_int32(scan_repeats, 5, "Timed reads of each case");
+DEFINE_int64(
+    scan_cache_bytes,
+    1L << 30,
+    "Capacity of the AsyncDataCache for the cached reads");
+
+using namespace facebook::velox;
+using namespace facebook::velox::dwrf;
+
+using dwio::common::MemoryInputStream;
+using dwio::common::MemorySink;
+using velox::common::ScanSpec;
+
+namespace {
+
+// Number of distinct values in a dictionary encoded column.
+constexpr int32_t kDictionarySize = 1'000;
+
+enum class ScanFilter { kNone, kRange, kValues, kIsNotNull };
+
+const char* filterName(ScanFilter filter) {
+  switch (filter) {
+    case ScanFilter::kNone:
+      return "none";
+    case ScanFilter::kRange:
+      return "range";
+    case ScanFilter::kValues:
+      return "values";
+    case ScanFilter::kIsNotNull:
+      return "isNotNull";
+  }
+  return "unknown";
+}
+
+// The data of a file. The values of c0 are uniformly distributed over
+// [0, domainSize()), so that a filter can select a given percentage.
+struct FileSpec {
+  TypePtr type;
+  bool dictionary;
+  int32_t nullPct;
+
+  int32_t domainSize() const {
+    return dictionary ? kDictionarySize : FLAGS_scan_rows;
+  }
+
+  std::string name() const {
+    return fmt::format(
+        "{} {} nulls={}%",
+        type->toString(),
+        dictionary ? "dictionary" : "direct",
+        nullPct);
+  }
+};
+
+// A file written in memory. The id identifies the file in the cache.
+struct ScanFile {
+  RowTypePtr rowType;
+  std::unique_ptr<Writer> writer;
+  MemorySink* sink;
+  StringIdLease fileId;
+};
+
+class StreamHolder : public AbstractInputStreamHolder {
+ public:
+  explicit StreamHolder(std::shared_ptr<dwio::common::InputStream> stream)
+      : stream_(std::move(stream)) {}
+
+  dwio::common::InputStream& get() override {
+    return *stream_;
+  }
+
+ private:
+  std::shared_ptr<dwio::common::InputStream> stream_;
+};
+
+class SelectiveReaderBenchmark {
+ public:
+  SelectiveReaderBenchmark()
+      : cache_(std::make_unique<cache::AsyncDataCache>(
+            memory::MappedMemory::createDefaultInstance(),
+            FLAGS_scan_cache_bytes)),
+        executor_(std::make_unique<folly::IOThreadPoolExecutor>(8)),
+        ioStats_(std::make_shared<dwio::common::IoStatistics>()) {}
+
+  ~SelectiveReaderBenchmark() {
+    executor_->join();
+  }
+
+  void run() {
+    for (const auto& type : {BIGINT(), DOUBLE(), VARCHAR()}) {
+      for (auto dictionary : {false, true}) {
+        // The writer does not dictionary encode floating point columns.
+        if (dictionary && type->kind() == TypeKind::DOUBLE) {
+          continue;
+        }
+        for (auto nullPct : {0, 20}) {
+          FileSpec fileSpec{type, dictionary, nullPct};
+          auto file = writeFile(fileSpec);
+          runFilters(fileSpec, *file);
+        }
+      }
+    }
+  }
+
+ private:
+  void runFilters(const FileSpec& fileSpec, const ScanFile& file) {
+    runCases(fileSpec, file, ScanFilter::kNone, 100);
+    for (auto selectPct : {1, 20, 100}) {
+      runCases(fileSpec, file, ScanFilter::kRange, selectPct);
+    }
+    if (fileSpec.type->kind() == TypeKind::BIGINT) {
+      for (auto selectPct : {1, 20}) {
+        runCases(fileSpec, file, ScanFilter::kValues, selectPct);
+      }
+    }
+    if (fileSpec.nullPct) {
+      runCases(fileSpec, file, ScanFilter::kIsNotNull, 100 - fileSpec.nullPct);
+    }
+  }
+
+  void runCases(
+      const FileSpec& fileSpec,
+      const ScanFile& file,
+      ScanFilter filter,
+      int32_t selectPct) {
+    auto spec = makeScanSpec(fileSpec, filter, selectPct);
+    for (auto useCache : {false, true}) {
+      // The first read is not timed. With cache it loads the file in
+      // the cache.
+      scan(file, *spec, useCache);
+
+      auto cacheStats = cache_->refreshStats();
+      auto bytesRead = ioStats_->rawBytesRead();
+      uint64_t micros = 0;
+      int64_t numOutputRows = 0;
+      for (auto i = 0; i < FLAGS_scan_repeats; ++i) {
+        MicrosecondTimer timer(&micros);
+        numOutputRows = scan(file, *spec, useCache);
+      }
+      auto seconds = std::max<uint64_t>(micros, 1) / 1'000'000.0;
+      auto numRows = static_cast<double>(FLAGS_scan_rows) * FLAGS_scan_repeats;
+      auto numBytes =
+          static_cast<double>(file.sink->size()) * FLAGS_scan_repeats;
+      std::string cacheInfo = "no cache";
+      if (useCache) {
+        auto newStats = cache_->refreshStats();
+        cacheInfo = fmt::format(
+            "cache hits {} new {} storage bytes {}",
+            newStats.numHit - cacheStats.numHit,
+            newStats.numNew - cacheStats.numNew,
+            ioStats_->rawBytesRead() - bytesRead);
+      }
+      std::cout << fmt::format(
+                       "{} filter={} {}%: {:.1f} Mrows/s {:.1f} MB/s, "
+                       "{} rows out, {}",
+                       fileSpec.name(),
+                       filterName(filter),
+                       selectPct,
+                       numRows / seconds / 1e6,
+                       numBytes / seconds / 1e6,
+                       numOutputRows,
+                       cacheInfo)
+                << std::endl;
+    }
+  }
+
+  VectorPtr makeColumn(const FileSpec& fileSpec, vector_size_t size) {
+    auto vector = BaseVector::create(fileSpec.type, size, pool_.get());
+    for (auto row = 0; row < size; ++row) {
+      if (folly::Random::rand32(rng_) % 100 < fileSpec.nullPct) {
+        vector->setNull(row, true);
+        continue;
+      }
+      int64_t value = folly::Random::rand32(rng_) % fileSpec.domainSize();
+      switch (fileSpec.type->kind()) {
+        case TypeKind::BIGINT:
+          vector->asFlatVector<int64_t>()->set(row, value);
+          break;
+        case TypeKind::DOUBLE:
+          vector->asFlatVector<double>()->set(row, value);
+          break;
+        case TypeKind::VARCHAR:
+          // Zero padded so that string order is numeric order.
+          vector->asFlatVector<StringView>()->set(
+              row, StringView(stringValue(value)));
+          break;
+        default:
+          VELOX_UNREACHABLE();
+      }
+    }
+    return vector;
+  }
+
+  static std::string stringValue(int64_t value) {
+    return fmt::format("{:012d}", value);
+  }
+
+  std::unique_ptr<ScanFile> writeFile(const FileSpec& fileSpec) {
+    rng_.seed(1);
+    auto config = std::make_shared<Config>();
+    // Uncompressed so that the time is spent in the readers.
+    config->set(Config::COMPRESSION, CompressionKind_NONE);
+    // Forces the encoding of c0. c1 is unique and is always direct.
+    float dictionaryThreshold = fileSpec.dictionary ? 1.0 : 0.0;
+    config->set(
+        Config::DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD, dictionaryThreshold);
+    config->set(
+        Config::DICTIONARY_STRING_KEY_SIZE_THRESHOLD, dictionaryThreshold);
+    config->set(
+        Config::ENTROPY_KEY_STRING_SIZE_THRESHOLD, dictionaryThreshold);
+    WriterOptions options;
+    options.config = config;
+    options.schema = rowType(fileSpec);
+
+    auto file = std::make_unique<ScanFile>();
+    file->rowType = rowType(fileSpec);
+    auto sink = std::make_unique<MemorySink>(*pool_, 1L << 30);
+    file->sink = sink.get();
+    file->writer = std::make_unique<Writer>(options, std::move(sink), *pool_);
+    file->fileId = StringIdLease(fileIds(), fileSpec.name());
+    for (auto start = 0; start < FLAGS_scan_rows;
+         start += FLAGS_scan_batch_size) {
+      auto size = std::min(FLAGS_scan_batch_size, FLAGS_scan_rows - start);
+      auto rowNumbers = std::static_pointer_cast<FlatVector<int64_t>>(
+          BaseVector::create(BIGINT(), size, pool_.get()));
+      for (auto i = 0; i < size; ++i) {
+        rowNumbers->set(i, start + i);
+      }
+      file->writer->write(std::make_shared<RowVector>(
+          pool_.get(),
+          rowType(fileSpec),
+          BufferPtr(nullptr),
+          size,
+          std::vector<VectorPtr>{makeColumn(fileSpec, size), rowNumbers}));
+    }
+    file->writer->close();
+    return file;
+  }
+
+  static RowTypePtr rowType(const FileSpec& fileSpec) {
+    return ROW({"c0", "c1"}, {fileSpec.type, BIGINT()});
+  }
+
+  // Returns a filter on c0 that passes about 'selectPct' percent of
+  // the non-null rows.
+  static std::unique_ptr<velox::common::Filter>
+  makeFilter(const FileSpec& fileSpec, ScanFilter filter, int32_t selectPct) {
+    int64_t numPassing =
+        static_cast<int64_t>(fileSpec.domainSize()) * selectPct / 100;
+    switch (filter) {
+      case ScanFilter::kNone:
+        return nullptr;
+      case ScanFilter::kIsNotNull:
+        return std::make_unique<velox::common::IsNotNull>();
+      case ScanFilter::kValues: {
+        std::vector<int64_t> values;
+        auto step = 100 / selectPct;
+        for (auto value = 0; value < fileSpec.domainSize(); value += step) {
+          values.push_back(value);
+        }
+        return velox::common::createBigintValues(values, false);
+      }
+      case ScanFilter::kRange:
+        break;
+    }
+    switch (fileSpec.type->kind()) {
+      case TypeKind::BIGINT:
+        return std::make_unique<velox::common::BigintRange>(
+            0, numPassing - 1, false);
+      case TypeKind::DOUBLE:
+        return std::make_unique<velox::common::DoubleRange>(
+            0, false, false, numPassing, false, true, false);
+      case TypeKind::VARCHAR:
+        return std::make_unique<velox::common::BytesRange>(
+            stringValue(0),
+            false,
+            false,
+            stringValue(numPassing),
+            false,
+            true,
+            false);
+      default:
+        VELOX_UNREACHABLE();
+    }
+  }
+
+  static std::unique_ptr<ScanSpec>
+  makeScanSpec(const FileSpec& fileSpec, ScanFilter filter, int32_t selectPct) {
+    auto spec = std::make_unique<ScanSpec>("root");
+    auto type = rowType(fileSpec);
+    for (auto i = 0; i < type->size(); ++i) {
+      auto fieldSpec =
+          spec->getOrCreateChild(velox::common::Subfield(type->nameOf(i)));
+      fieldSpec->setProjectOut(true);
+      fieldSpec->setExtractValues(true);
+      fieldSpec->setChannel(i);
+    }
+    if (auto c0Filter = makeFilter(fileSpec, filter, selectPct)) {
+      spec->getOrCreateChild(velox::common::Subfield("c0"))
+          ->setFilter(std::move(c0Filter));
+    }
+    return spec;
+  }
+
+  // Reads 'file' and returns the number of rows passing the filter.
+  int64_t scan(const ScanFile& file, ScanSpec& spec, bool useCache) {
+    auto data = file.sink->getData();
+    auto size = file.sink->size();
+    dwio::common::ReaderOptions readerOpts;
+    std::unique_ptr<CachedBufferedInputFactory> inputFactory;
+    if (useCache) {
+      auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
+      dataCacheConfig->filenum = file.fileId.id();
+      readerOpts.setDataCacheConfig(std::move(dataCacheConfig));
+      inputFactory = std::make_unique<CachedBufferedInputFactory>(
+          cache_.get(),
+          std::make_shared<cache::ScanTracker>(),
+          0,
+          [data, size]() {
+            return std::make_unique<StreamHolder>(
+                std::make_shared<MemoryInputStream>(data, size));
+          },
+          ioStats_,
+          executor_.get());
+      readerOpts.setBufferedInputFactory(inputFactory.get());
+    }
+    auto reader = std::make_unique<DwrfReader>(
+        readerOpts, std::make_unique<MemoryInputStream>(data, size));
+    // The factory and spec must stay live over the lifetime of the reader.
+    auto factory = std::make_unique<SelectiveColumnReaderFactory>(&spec);
+    dwio::common::RowReaderOptions rowReaderOpts;
+    rowReaderOpts.setColumnReaderFactory(factory.get());
+    auto rowReader = reader->createRowReader(rowReaderOpts);
+
+    int64_t numRows = 0;
+    auto batch = BaseVector::create(file.rowType, 0, pool_.get());
+    while (rowReader->next(FLAGS_scan_batch_size, batch)) {
+      auto rowVector = batch->asUnchecked<RowVector>();
+      for (auto i = 0; i < rowVector->childrenSize(); ++i) {
+        rowVector->loadedChildAt(i);
+      }
+      numRows += batch->size();
+    }
+    return numRows;
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_{
+      memory::getDefaultScopedMemoryPool()};
+  std::unique_ptr<cache::AsyncDataCache> cache_;
+  std::unique_ptr<folly::IOThreadPoolExecutor> executor_;
+  std::shared_ptr<dwio::common::IoStatistics> ioStats_;
+  folly::Random::DefaultGenerator rng_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  SelectiveReaderBenchmark benchmark;
+  benchmark.run();
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/dwio/dwrf/reader/SharedDictionaryCache.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::dwrf;
+
+namespace {
+// Returns a loader of a dictionary of 'count' entries of 'entrySize'
+// bytes that counts its calls in 'numLoads'.
+SharedDictionaryCache::Loader
+makeLoader(int32_t count, int32_t entrySize, int32_t& numLoads) {
+  return [count, entrySize, &numLoads](memory::MemoryPool& pool) {
+    ++numLoads;
+    auto dictionary = std::make_shared<SharedDictionary>();
+    dictionary->blob =
+        AlignedBuffer::allocate<char>(count * entrySize, &pool, 'a');
+    dictionary->offsets = AlignedBuffer::allocate<int64_t>(count + 1, &pool);
+    auto* offsets = dictionary->offsets->asMutable<int64_t>();
+    for (auto i = 0; i <= count; ++i) {
+      offsets[i] = i * entrySize;
+    }
+    dictionary->makeValues(VARCHAR(), count, pool);
+    return dictionary;
+  };
+}
+} // namespace
+
+TEST(SharedDictionaryCacheTest, get) {
+  SharedDictionaryCache cache(10 << 20);
+  StringIdLease file(fileIds(), "file1");
+  SharedDictionaryKey key{file.id(), 1, 0, 1, 0};
+  int32_t numLoads = 0;
+  auto dictionary = cache.get(key, makeLoader(10, 3, numLoads));
+  ASSERT_EQ(dictionary->values->size(), 10);
+  EXPECT_EQ(dictionary->values->valueAt(9), StringView("aaa"));
+
+  // The second reader gets the same vector without decoding.
+  EXPECT_EQ(cache.get(key, makeLoader(10, 3, numLoads)), dictionary);
+  EXPECT_EQ(numLoads, 1);
+
+  // Another stripe and a rewritten file are different dictionaries.
+  cache.get(
+      SharedDictionaryKey{file.id(), 1, 1, 1, 0}, makeLoader(10, 3, numLoads));
+  cache.get(
+      SharedDictionaryKey{file.id(), 2, 0, 1, 0}, makeLoader(10, 3, numLoads));
+  EXPECT_EQ(numLoads, 3);
+  EXPECT_EQ(cache.numHits(), 1);
+  EXPECT_EQ(cache.numMisses(), 3);
+}
+
+TEST(SharedDictionaryCacheTest, evict) {
+  SharedDictionaryCache cache(1 << 20);
+  StringIdLease file(fileIds(), "file2");
+  int32_t numLoads = 0;
+  // Two of these dictionaries fit in the budget.
+  for (auto i = 0; i < 5; ++i) {
+    cache.get(
+        SharedDictionaryKey{file.id(), 1, 0, 1, static_cast<uint32_t>(i)},
+        makeLoader(1'000, 300, numLoads));
+  }
+  EXPECT_EQ(numLoads, 5);
+  cache.get(
+      SharedDictionaryKey{file.id(), 1, 0, 1, 4},
+      makeLoader(1'000, 300, numLoads));
+  EXPECT_EQ(numLoads, 5);
+  cache.get(
+      SharedDictionaryKey{file.id(), 1, 0, 1, 0},
+      makeLoader(1'000, 300, numLoads));
+  EXPECT_EQ(numLoads, 6);
+
+  // A dictionary larger than the cache is returned but not cached.
+  SharedDictionaryKey largeKey{file.id(), 1, 0, 2, 0};
+  auto large = cache.get(largeKey, makeLoader(1'000, 2'000, numLoads));
+  EXPECT_EQ(large->values->size(), 1'000);
+  cache.get(largeKey, makeLoader(1'000, 2'000, numLoads));
+  EXPECT_EQ(numLoads, 8);
+}
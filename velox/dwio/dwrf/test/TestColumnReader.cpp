@@ -25,6 +25,7 @@
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/DictionaryVector.h"
 #include "velox/vector/FlatVector.h"
+#include "velox/vector/SequenceVector.h"
 
 #include <folly/Random.h>
 #include <folly/String.h>
@@ -631,6 +632,58 @@ TEST_P(TestColumnReader, testIntegerWithNulls) {
   }
 }
 
+TEST_P(TestColumnReader, testIntegerRunsAsSequence) {
+  if (useSelectiveReader()) {
+    GTEST_SKIP() << "SelectiveColumnReader doesn't return SequenceVector";
+  }
+  proto::ColumnEncoding directEncoding;
+  directEncoding.set_kind(proto::ColumnEncoding_Kind_DIRECT);
+  EXPECT_CALL(streams, getEncodingProxy(_))
+      .WillRepeatedly(Return(&directEncoding));
+  EXPECT_CALL(streams, getStreamProxy(_, proto::Stream_Kind_PRESENT, false))
+      .WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(streams, getStreamProxy(1, proto::Stream_Kind_ROW_INDEX, false))
+      .WillRepeatedly(Return(nullptr));
+
+  // 200 rows of 7, 100 rows of 8 and then 0, 1, ... 63.
+  char buffer[1024];
+  size_t size = 0;
+  for (auto i = 0; i < 300; ++i) {
+    size = writeVuLong(buffer, size, zigZagEncode(i < 200 ? 7 : 8));
+  }
+  size = writeRange(buffer, size, 0, 64);
+  EXPECT_CALL(streams, getStreamProxy(1, proto::Stream_Kind_DATA, true))
+      .WillRepeatedly(Return(new SeekableArrayInputStream(buffer, size)));
+
+  auto rowType = HiveTypeParser().parse("struct<myInt:int>");
+  ColumnSelector cs(rowType, std::vector<uint64_t>{}, true);
+  RowReaderOptions options;
+  options.setReturnSequenceVector(true);
+  EXPECT_CALL(streams, getColumnSelectorProxy())
+      .WillRepeatedly(Return(&cs));
+  EXPECT_CALL(streams, getRowReaderOptionsProxy())
+      .WillRepeatedly(Return(&options));
+  auto reader = ColumnReader::build(
+      cs.getSchemaWithId(), TypeWithId::create(rowType), streams);
+
+  VectorPtr batch;
+  skipAndRead(reader, batch, /* read */ 300);
+  auto runs = getOnlyChild<SequenceVector<int32_t>>(batch);
+  ASSERT_EQ(300, runs->size());
+  ASSERT_EQ(2, runs->numSequences());
+  for (auto i = 0; i < 300; ++i) {
+    ASSERT_EQ(i < 200 ? 7 : 8, runs->valueAt(i)) << "at index " << i;
+  }
+
+  // Values without long runs stay flat.
+  skipAndRead(reader, batch, /* read */ 64);
+  auto flat = getOnlyChild<FlatVector<int32_t>>(batch);
+  ASSERT_EQ(64, flat->size());
+  for (auto i = 0; i < 64; ++i) {
+    ASSERT_EQ(i, flat->valueAt(i));
+  }
+}
+
 TEST_P(TestColumnReader, testIntDictSkipNoNullsAllInDict) {
   // set getEncoding
   proto::ColumnEncoding directEncoding;
@@ -766,3 +766,78 @@ TEST(StatisticsBuilder, initialSize) {
   stats = target2.build();
   EXPECT_EQ(stats->getSize().value(), 100);
 }
+
+TEST(StatisticsBuilder, distinctValues) {
+  StatisticsBuilderOptions distinctOptions{16, std::nullopt, true};
+  // The distinct count is not kept unless requested.
+  IntegerStatisticsBuilder noCount{options};
+  noCount.addValues(1);
+  EXPECT_FALSE(noCount.build()->getNumberOfDistinctValues().has_value());
+
+  IntegerStatisticsBuilder integers{distinctOptions};
+  EXPECT_EQ(0, integers.build()->getNumberOfDistinctValues());
+  DoubleStatisticsBuilder doubles{distinctOptions};
+  StringStatisticsBuilder strings{distinctOptions};
+  for (auto i = 0; i < 10'000; ++i) {
+    integers.addValues(i % 1'000, 2);
+    doubles.addValues(i % 1'000 + 0.5);
+    strings.addValues(folly::to<std::string>("value ", i % 1'000));
+  }
+  // Zero and negative zero are the same value, and so are all NaNs.
+  doubles.addValues(0.0);
+  doubles.addValues(-0.0);
+  doubles.addValues(std::nan("1"));
+  doubles.addValues(std::nan("2"));
+
+  auto stats = integers.build();
+  EXPECT_NEAR(1'000, stats->getNumberOfDistinctValues().value(), 50);
+  EXPECT_TRUE(stats->getDistinctValuesSketch().has_value());
+  EXPECT_NEAR(1'002, doubles.build()->getNumberOfDistinctValues().value(), 50);
+  EXPECT_NEAR(1'000, strings.build()->getNumberOfDistinctValues().value(), 50);
+
+  integers.reset();
+  stats = integers.build();
+  EXPECT_EQ(0, stats->getNumberOfDistinctValues());
+  EXPECT_FALSE(stats->getDistinctValuesSketch().has_value());
+
+  // Types other than integers, floating point and strings are not counted.
+  BooleanStatisticsBuilder booleans{distinctOptions};
+  booleans.addValues(true);
+  EXPECT_FALSE(booleans.build()->getNumberOfDistinctValues().has_value());
+}
+
+TEST(StatisticsBuilder, distinctValuesMerge) {
+  StatisticsBuilderOptions distinctOptions{16, std::nullopt, true};
+  IntegerStatisticsBuilder first{distinctOptions};
+  IntegerStatisticsBuilder second{distinctOptions};
+  for (auto i = 0; i < 20'000; ++i) {
+    first.addValues(i);
+    second.addValues(i + 10'000);
+  }
+
+  // Merge a builder and the stats read back from a file.
+  IntegerStatisticsBuilder target{distinctOptions};
+  target.merge(first);
+  target.merge(*second.build());
+  auto stats = target.build();
+  EXPECT_NEAR(30'000, stats->getNumberOfDistinctValues().value(), 1'500);
+
+  // Empty stats without a sketch do not change the count.
+  target.merge(IntegerStatisticsBuilder{distinctOptions});
+  target.merge(IntegerStatisticsBuilder{options});
+  EXPECT_EQ(
+      stats->getNumberOfDistinctValues(),
+      target.build()->getNumberOfDistinctValues());
+
+  // Stats with values but without a sketch make the count unknown.
+  IntegerStatisticsBuilder noCount{options};
+  noCount.addValues(1);
+  target.merge(noCount);
+  EXPECT_FALSE(target.build()->getNumberOfDistinctValues().has_value());
+
+  // The count is known again after reset.
+  target.reset();
+  target.merge(*first.build());
+  EXPECT_NEAR(
+      20'000, target.build()->getNumberOfDistinctValues().value(), 1'000);
+}
@@ -143,6 +143,8 @@ typedef std::tuple<CompressionKind, const Encrypter*, const Decrypter*>
     TestParams;
 TestEncrypter testEncrypter;
 TestDecrypter testDecrypter;
+// Decrypts through decrypt() instead of into a caller buffer.
+TestDecrypter testCopyingDecrypter{false};
 
 class CompressionTest : public TestWithParam<TestParams> {
  public:
@@ -289,10 +291,14 @@ VELOX_INSTANTIATE_TEST_SUITE_P(
     Values(
         std::make_tuple(CompressionKind_ZLIB, nullptr, nullptr),
         std::make_tuple(CompressionKind_ZLIB, &testEncrypter, &testDecrypter),
+        std::make_tuple(
+            CompressionKind_ZLIB, &testEncrypter, &testCopyingDecrypter),
         std::make_tuple(CompressionKind_ZSTD, nullptr, nullptr),
         std::make_tuple(CompressionKind_ZSTD, &testEncrypter, &testDecrypter),
         std::make_tuple(CompressionKind_NONE, nullptr, nullptr),
-        std::make_tuple(CompressionKind_NONE, &testEncrypter, &testDecrypter)));
+        std::make_tuple(CompressionKind_NONE, &testEncrypter, &testDecrypter),
+        std::make_tuple(
+            CompressionKind_NONE, &testEncrypter, &testCopyingDecrypter)));
 
 typedef std::tuple<CompressionKind, const Encrypter*> TestParams2;
 
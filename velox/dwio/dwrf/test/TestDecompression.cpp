@@ -591,6 +591,43 @@ TEST(TestDecompression, testInflateSequence) {
   }
 }
 
+TEST(TestDecompression, testPinLastBuffer) {
+  const unsigned char buffer[] = {0xe,  0x0,  0x0,  0x63, 0x60, 0x64, 0x62,
+                                  0xc0, 0x8d, 0x0,  0xe,  0x0,  0x0,  0x63,
+                                  0x60, 0x64, 0x62, 0xc0, 0x8d, 0x0,  0xe,
+                                  0x0,  0x0,  0x63, 0x60, 0x64, 0x62, 0xc0,
+                                  0x8d, 0x0};
+  std::unique_ptr<SeekableInputStream> result = createTestDecompressor(
+      CompressionKind_ZLIB,
+      std::unique_ptr<SeekableInputStream>(
+          new SeekableArrayInputStream(buffer, VELOX_ARRAY_SIZE(buffer))),
+      1000);
+  const void* first;
+  const void* second;
+  const void* third;
+  int32_t length;
+  EXPECT_EQ(nullptr, result->pinLastBuffer());
+  ASSERT_TRUE(result->Next(&first, &length));
+  ASSERT_EQ(30, length);
+  auto pin = result->pinLastBuffer();
+  ASSERT_NE(nullptr, pin);
+  EXPECT_EQ(first, pin->as<char>());
+  EXPECT_FALSE(pin->isMutable());
+
+  // A pinned chunk is not overwritten by the next one.
+  ASSERT_TRUE(result->Next(&second, &length));
+  ASSERT_EQ(30, length);
+  EXPECT_NE(first, second);
+  for (int32_t i = 0; i < 30; ++i) {
+    EXPECT_EQ(i % 3, pin->as<char>()[i]);
+  }
+
+  // Without a pin, the output buffer is reused.
+  ASSERT_TRUE(result->Next(&third, &length));
+  ASSERT_EQ(30, length);
+  EXPECT_EQ(second, third);
+}
+
 TEST(TestDecompression, testSkipZlib) {
   const unsigned char buffer[] = {0x19, 0x0, 0x0, 0x0, 0x1, 0x2, 0x3, 0x4,
                                   0x5,  0x6, 0x7, 0x8, 0x9, 0xa, 0xb, 0xb,
@@ -20,6 +20,7 @@
 #include "velox/dwio/dwrf/test/OrcTest.h"
 
 #include <gtest/gtest.h>
+#include <random>
 #include <vector>
 
 using namespace facebook::velox;
@@ -662,6 +663,63 @@ TEST(RLEv2, bitsLeftByPreviousStream) {
   }
 };
 
+TEST(RLEv2, directAllBitWidths) {
+  // DIRECT runs of 512 values for each bit width. The values start at
+  // all bit offsets within a byte, end within 8 bytes of the buffer and
+  // are read in batches that end inside runs.
+  constexpr int32_t kRunLength = 512;
+  constexpr int32_t kNumRuns = 3;
+  std::mt19937 rng(1);
+  for (uint32_t encodedWidth = 0; encodedWidth < 32; ++encodedWidth) {
+    uint32_t width = encodedWidth + 1;
+    if (encodedWidth >= 28) {
+      width = 40 + (encodedWidth - 28) * 8;
+    } else if (encodedWidth >= 24) {
+      width = 26 + (encodedWidth - 24) * 2;
+    }
+    std::vector<unsigned char> bytes;
+    std::vector<int64_t> values;
+    for (auto run = 0; run < kNumRuns; ++run) {
+      bytes.push_back(0x40 | (encodedWidth << 1) | ((kRunLength - 1) >> 8));
+      bytes.push_back((kRunLength - 1) & 0xff);
+      auto start = bytes.size();
+      bytes.resize(start + (kRunLength * width + 7) / 8);
+      for (auto i = 0; i < kRunLength; ++i) {
+        uint64_t value = (static_cast<uint64_t>(rng()) << 32) | rng();
+        if (width < 64) {
+          value &= (1UL << width) - 1;
+        }
+        values.push_back(ZigZag::decode(value));
+        for (uint32_t bit = 0; bit < width; ++bit) {
+          if (value >> (width - 1 - bit) & 1) {
+            uint64_t position = i * static_cast<uint64_t>(width) + bit;
+            bytes[start + position / 8] |= 0x80 >> (position % 8);
+          }
+        }
+      }
+    }
+    auto count = values.size();
+    std::vector<uint64_t> nulls(bits::nwords(count), bits::kNotNull64);
+    for (size_t i = 0; i < count; i += 7) {
+      bits::setNull(nulls.data(), i);
+    }
+    for (auto batch : {1, 37, 100, 512, 1536}) {
+      checkResults(
+          values, decodeRLEv2(bytes.data(), bytes.size(), batch, count), batch);
+      // With nulls the values are read into the non-null positions.
+      auto result =
+          decodeRLEv2(bytes.data(), bytes.size(), batch, count, nulls.data());
+      auto value = 0;
+      for (size_t i = 0; i < count; ++i) {
+        if (!bits::isBitNull(nulls.data(), i)) {
+          ASSERT_EQ(values[value++], result[i])
+              << "width " << width << " batch " << batch << " row " << i;
+        }
+      }
+    }
+  }
+}
+
 TEST(RLEv1, simpleTest) {
   auto scopedPool = memory::getDefaultScopedMemoryPool();
   const unsigned char buffer[] = {
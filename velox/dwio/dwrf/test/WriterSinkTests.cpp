@@ -14,9 +14,12 @@
  * limitations under the License.
  */
 
+#include <future>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "folly/Random.h"
+#include "folly/executors/ManualExecutor.h"
 #include "velox/dwio/dwrf/writer/WriterSink.h"
 
 using namespace ::testing;
@@ -502,3 +505,54 @@ TEST_F(WriterSinkTests, SetModeOutOfOrder) {
   sink.addBuffer(pool, data.data(), 10);
   ASSERT_EQ(sink.getChecksum()->getDigest(false), 977966233);
 }
+
+TEST_F(WriterSinkTests, AsyncWrite) {
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  MemorySink out{pool, 3 * 1024 + 3};
+  Config config;
+  config.set(Config::STRIPE_CACHE_MODE, proto::StripeCacheMode::NA);
+  config.set(Config::MAX_INFLIGHT_WRITE_BYTES, static_cast<uint64_t>(1024));
+  folly::ManualExecutor executor;
+  WriterSink sink{out, pool, config, &executor};
+
+  // The buffers, including the header, get to 'out' when the executor runs
+  // the write.
+  sink.addBuffer(pool, data.data(), data.size());
+  ASSERT_EQ(out.size(), 0);
+  sink.flush();
+  ASSERT_EQ(out.size(), 0);
+  ASSERT_EQ(sink.size(), data.size() + 3);
+  ASSERT_EQ(sink.inflightBytes(), data.size() + 3);
+
+  auto future = folly::SemiFuture<folly::Unit>::makeEmpty();
+  ASSERT_TRUE(sink.isBlocked(&future));
+  executor.drain();
+  ASSERT_TRUE(future.isReady());
+  ASSERT_FALSE(sink.isBlocked(&future));
+  ASSERT_EQ(sink.inflightBytes(), 0);
+  checkOutput(out, 3);
+
+  // Under the limit, the writer is not blocked.
+  sink.addBuffer(pool, data.data(), 512);
+  sink.flush();
+  ASSERT_FALSE(sink.isBlocked(&future));
+  ASSERT_EQ(sink.size(), data.size() + 3 + 512);
+
+  // Over the limit, flush() waits for the writes before the last one.
+  sink.addBuffer(pool, data.data(), data.size());
+  auto flushed = std::async(std::launch::async, [&]() { sink.flush(); });
+  while (flushed.wait_for(std::chrono::milliseconds(1)) !=
+         std::future_status::ready) {
+    executor.run();
+  }
+  flushed.get();
+  ASSERT_EQ(sink.inflightBytes(), data.size());
+
+  executor.drain();
+  sink.finishWrites();
+  ASSERT_EQ(sink.inflightBytes(), 0);
+  ASSERT_EQ(out.size(), sink.size());
+  checkOutput(out, data.size() + 3 + 512);
+}
+
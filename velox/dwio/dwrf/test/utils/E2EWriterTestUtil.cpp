@@ -36,12 +36,14 @@ namespace facebook::velox::dwrf {
     const std::shared_ptr<Config>& config,
     const bool useDefaultFlushPolicy,
     const bool flushPerBatch,
-    const int64_t writerMemoryCap) {
+    const int64_t writerMemoryCap,
+    folly::Executor* flushExecutor) {
   // write file to memory
   WriterOptions options;
   options.config = config;
   options.schema = type;
   options.memoryBudget = writerMemoryCap;
+  options.flushExecutor = flushExecutor;
   if (!useDefaultFlushPolicy) {
     options.flushPolicy = [flushPerBatch](
                               bool /* unused */, auto& /* unused */) {
@@ -74,7 +76,8 @@ namespace facebook::velox::dwrf {
     const bool useDefaultFlushPolicy,
     const bool flushPerBatch,
     const int64_t writerMemoryCap,
-    const bool verifyContent) {
+    const bool verifyContent,
+    folly::Executor* flushExecutor) {
   // write file to memory
   auto sink = std::make_unique<MemorySink>(pool, 200 * 1024 * 1024);
   auto sinkPtr = sink.get();
@@ -87,7 +90,8 @@ namespace facebook::velox::dwrf {
       config,
       useDefaultFlushPolicy,
       flushPerBatch,
-      writerMemoryCap);
+      writerMemoryCap,
+      flushExecutor);
   // read it back and compare
   auto input =
       std::make_unique<MemoryInputStream>(sinkPtr->getData(), sinkPtr->size());
@@ -30,7 +30,8 @@ class E2EWriterTestUtil {
       const std::shared_ptr<Config>& config,
       const bool useDefaultFlushPolicy,
       const bool flushPerBatch,
-      const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max());
+      const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max(),
+      folly::Executor* flushExecutor = nullptr);
 
   static void testWriter(
       memory::MemoryPool& pool,
@@ -44,7 +45,8 @@ class E2EWriterTestUtil {
       const bool useDefaultFlushPolicy = false,
       const bool flushPerBatch = true,
       const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max(),
-      const bool verifyContent = true);
+      const bool verifyContent = true,
+      folly::Executor* flushExecutor = nullptr);
 
   static std::vector<VectorPtr> generateBatches(
       const std::shared_ptr<const Type>& type,
@@ -212,6 +212,12 @@ class IntegerColumnWriter : public ColumnWriter {
         dictionaryKeySizeThreshold_{
             getConfig(Config::DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD)},
         sort_{getConfig(Config::DICTIONARY_SORT_KEYS)},
+        // A dictionary shared between flat map value writers can only be
+        // given up by all of them at once, so it waits for the flush.
+        dictionarySampleRows_{
+            context.shareFlatMapDictionaries
+                ? 0
+                : getConfig(Config::DICTIONARY_ENCODING_SAMPLE_ROWS)},
         useDictionaryEncoding_{useDictionaryEncoding()},
         strideOffsets_{getMemoryPool(MemoryUsageCategory::GENERAL)} {
     DWIO_ENSURE_GE(dictionaryKeySizeThreshold_, 0.0);
@@ -326,6 +332,7 @@ class IntegerColumnWriter : public ColumnWriter {
     // Add entry with stats for either case.
     indexBuilder_->addEntry(*indexStatsBuilder_);
     indexStatsBuilder_->reset();
+    createBloomFilterEntry();
     ColumnWriter::recordPosition();
     // TODO: the only way useDictionaryEncoding_ right now is
     // through abandonDictionary, so we already have the stream initialization
@@ -449,6 +456,25 @@ class IntegerColumnWriter : public ColumnWriter {
     }
   }
 
+  // Decides on the dictionary of the first stripe once
+  // 'dictionarySampleRows_' rows have been added to it. Abandoning it here
+  // instead of at flush stops the dictionary from growing for the rest of
+  // the stripe and frees its memory right away.
+  void sampleDictionary() {
+    if (LIKELY(
+            !firstStripe_ || dictionarySampled_ ||
+            dictionarySampleRows_ == 0 ||
+            rows_.size() < dictionarySampleRows_)) {
+      return;
+    }
+    dictionarySampled_ = true;
+    if (!shouldKeepDictionary()) {
+      context_.suppressStream(StreamIdentifier{
+          id_, sequence_, 0, StreamKind::StreamKind_DICTIONARY_DATA});
+      abandonDictionaries();
+    }
+  }
+
   void populateDictionaryEncodingStreams();
   void convertToDirectEncoding();
 
@@ -466,6 +492,8 @@ class IntegerColumnWriter : public ColumnWriter {
   size_t finalDictionarySize_;
   const float dictionaryKeySizeThreshold_;
   const bool sort_;
+  const uint32_t dictionarySampleRows_;
+  bool dictionarySampled_{false};
   // This value could change if we are writing with low memory mode or if we
   // determine with the first stripe that the data is not fit for dictionary
   // encoding.
@@ -482,7 +510,9 @@ uint64_t IntegerColumnWriter<T>::write(
     // Decode and then write
     auto localDv = context_.getLocalDecodedVector();
     auto& decodedVector = decode(context_, localDv, slice, ranges);
-    return writeDict(decodedVector, ranges);
+    auto rawSize = writeDict(decodedVector, ranges);
+    sampleDictionary();
+    return rawSize;
   } else {
     // If the input is not a flat vector we make a complete copy and convert
     // it to flat vector
@@ -514,6 +544,7 @@ uint64_t IntegerColumnWriter<T>::writeDict(
     T value = decodedVector.valueAt<T>(pos);
     rows_.unsafeAppend(dictEncoder_.addKey(value));
     statsBuilder.addValues(value);
+    addBloomFilterValue(value);
   };
 
   uint64_t nullCount = 0;
@@ -556,6 +587,13 @@ uint64_t IntegerColumnWriter<T>::writeDirect(
       dynamic_cast<IntegerStatisticsBuilder&>(*indexStatsBuilder_),
       slice,
       ranges);
+  if (bloomFilter_) {
+    for (auto& pos : ranges) {
+      if (!nulls || !bits::isBitNull(nulls, pos)) {
+        addBloomFilterValue(vals[pos]);
+      }
+    }
+  }
   auto rawSize = count * sizeof(T) + (ranges.size() - count) * NULL_SIZE;
   indexStatsBuilder_->increaseRawSize(rawSize);
   return rawSize;
@@ -807,6 +845,8 @@ class StringColumnWriter : public ColumnWriter {
             getConfig(Config::ENTROPY_STRING_DICT_SAMPLE_FRACTION),
             getConfig(Config::ENTROPY_STRING_THRESHOLD)},
         sort_{getConfig(Config::DICTIONARY_SORT_KEYS)},
+        dictionarySampleRows_{
+            getConfig(Config::DICTIONARY_ENCODING_SAMPLE_ROWS)},
         useDictionaryEncoding_{useDictionaryEncoding()},
         strideOffsets_{getMemoryPool(MemoryUsageCategory::GENERAL)} {
     DWIO_ENSURE(firstStripe_);
@@ -908,6 +948,7 @@ class StringColumnWriter : public ColumnWriter {
     // Add entry with stats for either case.
     indexBuilder_->addEntry(*indexStatsBuilder_);
     indexStatsBuilder_->reset();
+    createBloomFilterEntry();
     ColumnWriter::recordPosition();
     // TODO: the only way useDictionaryEncoding_ right now is
     // through abandonDictionary, so we already have the stream initialization
@@ -1052,6 +1093,20 @@ class StringColumnWriter : public ColumnWriter {
     }
   }
 
+  // Same as IntegerColumnWriter::sampleDictionary().
+  void sampleDictionary() {
+    if (LIKELY(
+            !firstStripe_ || dictionarySampled_ ||
+            dictionarySampleRows_ == 0 ||
+            rows_.size() < dictionarySampleRows_)) {
+      return;
+    }
+    dictionarySampled_ = true;
+    if (!shouldKeepDictionary()) {
+      abandonDictionaries();
+    }
+  }
+
   void populateDictionaryEncodingStreams();
   void convertToDirectEncoding();
 
@@ -1076,6 +1131,8 @@ class StringColumnWriter : public ColumnWriter {
   size_t finalDictionarySize_;
   EntropyEncodingSelector encodingSelector_;
   const bool sort_;
+  const uint32_t dictionarySampleRows_;
+  bool dictionarySampled_{false};
   // This value could change if we are writing with low memory mode or if we
   // determine with the first stripe that the data is not fit for dictionary
   // encoding.
@@ -1091,7 +1148,9 @@ uint64_t StringColumnWriter::write(
   auto& decodedVector = decode(context_, localDv, slice, ranges);
 
   if (useDictionaryEncoding_) {
-    return writeDict(decodedVector, ranges);
+    auto rawSize = writeDict(decodedVector, ranges);
+    sampleDictionary();
+    return rawSize;
   } else {
     return writeDirect(decodedVector, ranges);
   }
@@ -1111,6 +1170,7 @@ uint64_t StringColumnWriter::writeDict(
     auto sp = decodedVector.valueAt<StringView>(pos);
     rows_.unsafeAppend(dictEncoder_.addKey(sp, strideIndex));
     statsBuilder.addValues(sp);
+    addBloomFilterValue(sp);
     rawSize += sp.size();
   };
 
@@ -1156,6 +1216,7 @@ uint64_t StringColumnWriter::writeDirect(
     auto size = sp.size();
     dataDirect_->write(sp.data(), size);
     statsBuilder.addValues(sp);
+    addBloomFilterValue(sp);
     rawSize += size;
     lengths.unsafeAppend(size);
   };
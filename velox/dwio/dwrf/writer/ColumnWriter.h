@@ -25,6 +25,7 @@
 #include "velox/dwio/dwrf/writer/IndexBuilder.h"
 #include "velox/dwio/dwrf/writer/StatisticsBuilder.h"
 #include "velox/dwio/dwrf/writer/WriterContext.h"
+#include "velox/type/Filter.h"
 #include "velox/type/Type.h"
 #include "velox/vector/BaseVector.h"
 #include "velox/vector/DecodedVector.h"
@@ -105,6 +106,11 @@ class ColumnWriter {
     setEncoding(encoding);
     encodingOverride(encoding);
     indexBuilder_->flush();
+    if (bloomFilterStream_) {
+      bloomFilterIndex_.SerializeToZeroCopyStream(bloomFilterStream_.get());
+      bloomFilterStream_->flush();
+      bloomFilterIndex_.Clear();
+    }
   }
 
   virtual uint64_t writeFileStats(
@@ -151,6 +157,59 @@ class ColumnWriter {
     auto options = StatisticsBuilderOptions::fromConfig(context.getConfigs());
     indexStatsBuilder_ = StatisticsBuilder::create(type.type->kind(), options);
     fileStatsBuilder_ = StatisticsBuilder::create(type.type->kind(), options);
+    if (hasBloomFilter()) {
+      bloomFilterStream_ = newStream(StreamKind::StreamKind_BLOOM_FILTER_UTF8);
+      bloomFilter_ =
+          std::make_unique<common::BloomFilter::Builder>(context.indexStride);
+    }
+  }
+
+  // True if the column is in Config::BLOOM_FILTER_COLUMNS and gets a Bloom
+  // filter for each row group.
+  bool hasBloomFilter() const {
+    if (!isIndexEnabled() || sequence_ != 0 || !type_.parent ||
+        type_.parent->id != 0) {
+      return false;
+    }
+    switch (type_.type->kind()) {
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+      case TypeKind::VARCHAR:
+        break;
+      default:
+        return false;
+    }
+    const auto& columns = getConfig(Config::BLOOM_FILTER_COLUMNS);
+    return std::find(columns.begin(), columns.end(), type_.column) !=
+        columns.end();
+  }
+
+  void addBloomFilterValue(int64_t value) {
+    if (bloomFilter_) {
+      bloomFilter_->addInt64(value);
+    }
+  }
+
+  void addBloomFilterValue(StringView value) {
+    if (bloomFilter_) {
+      bloomFilter_->addBytes(value.data(), value.size());
+    }
+  }
+
+  // Adds the Bloom filter of the row group that ends at the current index
+  // entry. The words of the filter are stored as the bytes of utf8bitset.
+  void createBloomFilterEntry() {
+    if (!bloomFilter_) {
+      return;
+    }
+    auto filter = bloomFilter_->build();
+    const auto& blocks = filter->blocks();
+    bloomFilterIndex_.add_bloomfilter()->set_utf8bitset(
+        reinterpret_cast<const char*>(blocks.data()),
+        blocks.size() * sizeof(uint32_t));
+    bloomFilter_ =
+        std::make_unique<common::BloomFilter::Builder>(context_.indexStride);
   }
 
   virtual void recordPosition() {
@@ -212,6 +271,11 @@ class ColumnWriter {
 
   std::unique_ptr<ByteRleEncoder> present_;
   bool hasNull_ = false;
+  // Values of the current row group and the filters of the finished row
+  // groups of the stripe. Set if hasBloomFilter().
+  std::unique_ptr<common::BloomFilter::Builder> bloomFilter_;
+  proto::BloomFilterIndex bloomFilterIndex_;
+  std::unique_ptr<BufferedOutputStream> bloomFilterStream_;
   // callback used to inject the logic that captures positions for flat map
   // in_map stream
   const std::function<void(IndexBuilder&)> onRecordPosition_;
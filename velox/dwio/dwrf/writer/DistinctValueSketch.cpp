@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define XXH_INLINE_ALL
+
+#include "velox/dwio/dwrf/writer/DistinctValueSketch.h"
+#include "velox/aggregates/hyperloglog/HllUtils.h"
+#include "velox/dwio/common/exception/Exception.h"
+#include "velox/external/xxhash.h"
+
+namespace facebook::velox::dwrf {
+
+using namespace aggregate::hll;
+
+const int8_t DistinctValueSketch::kIndexBitLength =
+    toIndexBitLength(kDefaultStandardError);
+
+DistinctValueSketch::DistinctValueSketch()
+    : allocator_{std::make_unique<exec::HashStringAllocator>(
+          memory::MappedMemory::getInstance())},
+      sparseHll_{allocator_.get()},
+      denseHll_{allocator_.get()} {
+  sparseHll_.setSoftMemoryLimit(
+      DenseHll::estimateInMemorySize(kIndexBitLength));
+}
+
+uint64_t DistinctValueSketch::hash(int64_t value) {
+  return XXH64(&value, sizeof(value), 0);
+}
+
+void DistinctValueSketch::add(double value) {
+  // Equal values must hash the same. Use a single representation for zero
+  // and for NaN.
+  if (value == 0) {
+    value = 0;
+  } else if (std::isnan(value)) {
+    value = std::numeric_limits<double>::quiet_NaN();
+  }
+  insertHash(XXH64(&value, sizeof(value), 0));
+}
+
+void DistinctValueSketch::add(folly::StringPiece value) {
+  insertHash(XXH64(value.data(), value.size(), 0));
+}
+
+void DistinctValueSketch::insertHash(uint64_t hash) {
+  if (isSparse_) {
+    if (sparseHll_.insertHash(hash)) {
+      toDense();
+    }
+  } else {
+    denseHll_.insertHash(hash);
+  }
+}
+
+void DistinctValueSketch::toDense() {
+  isSparse_ = false;
+  denseHll_.initialize(kIndexBitLength);
+  sparseHll_.toDense(denseHll_);
+  sparseHll_.reset();
+}
+
+void DistinctValueSketch::toDenseIfNeeded() {
+  if (sparseHll_.inMemorySize() >
+      DenseHll::estimateInMemorySize(kIndexBitLength)) {
+    toDense();
+  }
+}
+
+void DistinctValueSketch::merge(const DistinctValueSketch& other) {
+  if (!other.isSparse_) {
+    if (isSparse_) {
+      toDense();
+    }
+    denseHll_.mergeWith(other.denseHll_);
+  } else if (isSparse_) {
+    sparseHll_.mergeWith(other.sparseHll_);
+    toDenseIfNeeded();
+  } else {
+    other.sparseHll_.toDense(denseHll_);
+  }
+}
+
+void DistinctValueSketch::merge(folly::StringPiece serialized) {
+  auto input = serialized.data();
+  if (SparseHll::canDeserialize(input)) {
+    if (isSparse_) {
+      sparseHll_.mergeWith(input);
+      toDenseIfNeeded();
+    } else {
+      SparseHll other{input, allocator_.get()};
+      other.toDense(denseHll_);
+    }
+    return;
+  }
+  DWIO_ENSURE(DenseHll::canDeserialize(input), "Unexpected HLL sketch");
+  DWIO_ENSURE_EQ(
+      DenseHll::deserializeIndexBitLength(input),
+      kIndexBitLength,
+      "Unexpected HLL sketch precision");
+  if (isSparse_) {
+    toDense();
+  }
+  denseHll_.mergeWith(input);
+}
+
+uint64_t DistinctValueSketch::cardinality() const {
+  return isSparse_ ? sparseHll_.cardinality() : denseHll_.cardinality();
+}
+
+std::string DistinctValueSketch::serialize() const {
+  std::string result;
+  if (isSparse_) {
+    result.resize(sparseHll_.serializedSize());
+    sparseHll_.serialize(kIndexBitLength, result.data());
+  } else {
+    result.resize(denseHll_.serializedSize());
+    denseHll_.serialize(result.data());
+  }
+  return result;
+}
+
+} // namespace facebook::velox::dwrf
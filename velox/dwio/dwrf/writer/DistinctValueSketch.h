@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include "velox/aggregates/hyperloglog/DenseHll.h"
+#include "velox/aggregates/hyperloglog/SparseHll.h"
+#include "velox/exec/HashStringAllocator.h"
+
+namespace facebook::velox::dwrf {
+
+/// HyperLogLog sketch of the values of a column chunk. Starts in the sparse
+/// layout and switches to the dense one once the sparse one grows past the
+/// size of the dense one. Values are hashed the same way approx_distinct
+/// hashes them, so that serialized sketches can be merged with the ones
+/// produced by approx_set.
+class DistinctValueSketch {
+ public:
+  DistinctValueSketch();
+
+  void add(int64_t value) {
+    insertHash(hash(value));
+  }
+
+  void add(double value);
+
+  void add(folly::StringPiece value);
+
+  /// Merges the state of another instance into this one.
+  void merge(const DistinctValueSketch& other);
+
+  /// Merges the state serialized by another instance into this one.
+  void merge(folly::StringPiece serialized);
+
+  uint64_t cardinality() const;
+
+  std::string serialize() const;
+
+ private:
+  static uint64_t hash(int64_t value);
+
+  void insertHash(uint64_t hash);
+
+  void toDense();
+
+  void toDenseIfNeeded();
+
+  static const int8_t kIndexBitLength;
+
+  std::unique_ptr<exec::HashStringAllocator> allocator_;
+  bool isSparse_{true};
+  aggregate::hll::SparseHll sparseHll_;
+  // Serializing sorts the overflow entries, which does not change the
+  // estimate.
+  mutable aggregate::hll::DenseHll denseHll_;
+};
+
+} // namespace facebook::velox::dwrf
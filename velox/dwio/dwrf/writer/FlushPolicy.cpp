@@ -58,6 +58,46 @@ bool DefaultFlushPolicy::operator()(
       estimatedStripeSize >= stripeSizeThreshold_;
 }
 
+StripeSizeFlushPolicy::StripeSizeFlushPolicy(
+    uint64_t stripeSizeTarget,
+    uint64_t dictionarySizeThreshold)
+    : stripeSizeTarget_{stripeSizeTarget},
+      dictionarySizeThreshold_{dictionarySizeThreshold} {}
+
+bool StripeSizeFlushPolicy::operator()(
+    bool overMemoryBudget,
+    const WriterContext& context) const {
+  if (overMemoryBudget) {
+    return true;
+  }
+  uint64_t estimatedStripeSize =
+      context.getEstimatedStripeSize(context.stripeRawSize);
+  // The compression ratio is only a guess before the first flush.
+  if (context.stripeIndex == 0) {
+    estimatedStripeSize =
+        std::max(estimatedStripeSize, context.getOutputStreamBytes());
+  }
+  // With an index, the next write fills up the current index stride.
+  uint64_t estimatedWriteSize = 0;
+  if (context.isIndexEnabled && context.stripeRowCount > 0) {
+    estimatedWriteSize = estimatedStripeSize *
+        (context.indexStride - context.indexRowCount) / context.stripeRowCount;
+  }
+  return operator()(
+      estimatedStripeSize,
+      estimatedWriteSize,
+      context.getMemoryUsage(MemoryUsageCategory::DICTIONARY)
+          .getCurrentBytes());
+}
+
+bool StripeSizeFlushPolicy::operator()(
+    uint64_t estimatedStripeSize,
+    uint64_t estimatedWriteSize,
+    uint64_t dictionarySize) const {
+  return dictionarySize >= dictionarySizeThreshold_ ||
+      estimatedStripeSize + estimatedWriteSize / 2 >= stripeSizeTarget_;
+}
+
 RowsPerStripeFlushPolicy::RowsPerStripeFlushPolicy(
     const std::vector<uint64_t>& rowsPerStripe)
     : rowsPerStripe_{rowsPerStripe} {
@@ -37,6 +37,30 @@ class DefaultFlushPolicy {
   const uint64_t dictionarySizeThreshold_;
 };
 
+// Cuts stripes at a target size on disk rather than in memory. The size of
+// the stripe is estimated from the compression ratio of the previous stripes
+// and, for the first stripe, from the bytes already in the output streams.
+// A stripe is flushed before the next index stride when that stride would
+// overshoot the target by more than the stripe is short of it, which keeps
+// stripe sizes close to the target.
+class StripeSizeFlushPolicy {
+ public:
+  StripeSizeFlushPolicy(
+      uint64_t stripeSizeTarget,
+      uint64_t dictionarySizeThreshold);
+
+  bool operator()(bool overMemoryBudget, const WriterContext& context) const;
+
+  bool operator()(
+      uint64_t estimatedStripeSize,
+      uint64_t estimatedWriteSize,
+      uint64_t dictionarySize) const;
+
+ private:
+  const uint64_t stripeSizeTarget_;
+  const uint64_t dictionarySizeThreshold_;
+};
+
 class RowsPerStripeFlushPolicy {
  public:
   explicit RowsPerStripeFlushPolicy(const std::vector<uint64_t>& rowsPerStripe);
@@ -45,6 +45,9 @@ class IndexBuilder : public PositionRecorder {
   virtual void addEntry(const StatisticsBuilder& writer) {
     auto stats = entry_.mutable_statistics();
     writer.toProto(*stats);
+    // Row index entries keep the distinct count but not the sketch, which is
+    // only needed for merging file level stats.
+    stats->clear_distinctvaluessketch();
     *index_.add_entry() = entry_;
     entry_.Clear();
   }
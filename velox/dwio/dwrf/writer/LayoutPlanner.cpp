@@ -18,15 +18,48 @@
 
 namespace facebook::velox::dwrf {
 
-LayoutPlanner::LayoutPlanner(WriterContext& context) {
+LayoutPlanner::LayoutPlanner(
+    WriterContext& context,
+    const dwio::common::TypeWithId* schema) {
   streams_.reserve(context.getStreamCount());
   context.iterateUnSuppressedStreams([&](auto& pair) {
     streams_.push_back(std::make_pair(
         std::addressof(pair.first), std::addressof(pair.second)));
   });
+  if (schema) {
+    auto groups = context.getConfig(Config::COLUMN_READ_GROUPS);
+    if (!groups.empty()) {
+      setReadGroups(*schema, groups);
+    }
+  }
   plan();
 }
 
+void LayoutPlanner::setReadGroups(
+    const dwio::common::TypeWithId& schema,
+    const std::vector<std::vector<uint32_t>>& groups) {
+  numGroups_ = groups.size();
+  std::vector<uint32_t> columnGroup(schema.size(), numGroups_);
+  for (uint32_t i = 0; i < groups.size(); ++i) {
+    for (auto column : groups[i]) {
+      DWIO_ENSURE_LT(
+          column, columnGroup.size(), "Unknown column in read groups");
+      // A column listed in several groups goes with the first.
+      if (columnGroup[column] == numGroups_) {
+        columnGroup[column] = i;
+      }
+    }
+  }
+  nodeGroup_.assign(schema.maxId + 1, numGroups_);
+  for (uint32_t i = 0; i < schema.size(); ++i) {
+    auto& child = schema.childAt(i);
+    std::fill(
+        nodeGroup_.begin() + child->id,
+        nodeGroup_.begin() + child->maxId + 1,
+        columnGroup[i]);
+  }
+}
+
 void LayoutPlanner::iterateIndexStreams(
     std::function<void(const StreamIdentifier&, DataBufferHolder&)> consumer) {
   for (auto iter = streams_.begin(), end = iter + indexCount_; iter != end;
@@ -47,13 +80,31 @@ void LayoutPlanner::plan() {
   // place index before data
   auto iter =
       std::partition(streams_.begin(), streams_.end(), [](auto& stream) {
-        return stream.first->kind == StreamKind::StreamKind_ROW_INDEX;
+        return stream.first->kind == StreamKind::StreamKind_ROW_INDEX ||
+            stream.first->kind == StreamKind::StreamKind_BLOOM_FILTER_UTF8;
       });
   indexCount_ = iter - streams_.begin();
 
   // sort streams
   NodeSizeSorter::sort(streams_.begin(), iter);
   NodeSizeSorter::sort(iter, streams_.end());
+
+  if (!nodeGroup_.empty()) {
+    groupStreams(streams_.begin(), iter);
+    groupStreams(iter, streams_.end());
+  }
+}
+
+void LayoutPlanner::groupStreams(
+    StreamList::iterator begin,
+    StreamList::iterator end) {
+  auto getGroup = [&](const StreamIdentifier& stream) {
+    return stream.node < nodeGroup_.size() ? nodeGroup_[stream.node]
+                                           : numGroups_;
+  };
+  std::stable_sort(begin, end, [&](auto& a, auto& b) {
+    return getGroup(*a.first) < getGroup(*b.first);
+  });
 }
 
 void LayoutPlanner::NodeSizeSorter::sort(
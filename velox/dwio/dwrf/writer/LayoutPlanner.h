@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "velox/dwio/common/TypeWithId.h"
 #include "velox/dwio/dwrf/common/Common.h"
 #include "velox/dwio/dwrf/writer/WriterContext.h"
 
@@ -23,7 +24,12 @@ namespace facebook::velox::dwrf {
 
 class LayoutPlanner {
  public:
-  explicit LayoutPlanner(WriterContext& context);
+  // If 'schema' is given, the streams of the columns in each of
+  // Config::COLUMN_READ_GROUPS are placed next to each other, so that a
+  // reader of the columns of a group coalesces their reads.
+  explicit LayoutPlanner(
+      WriterContext& context,
+      const dwio::common::TypeWithId* schema = nullptr);
 
   void iterateIndexStreams(
       std::function<void(const StreamIdentifier&, DataBufferHolder&)> consumer);
@@ -34,11 +40,23 @@ class LayoutPlanner {
  private:
   void plan();
 
+  // Fills 'nodeGroup_' from the top level columns of 'groups'.
+  void setReadGroups(
+      const dwio::common::TypeWithId& schema,
+      const std::vector<std::vector<uint32_t>>& groups);
+
+  // Moves the streams of grouped columns to the front of the range, in the
+  // order of their groups. Keeps the order within each group.
+  void groupStreams(StreamList::iterator begin, StreamList::iterator end);
+
   using StreamList =
       std::vector<std::pair<const StreamIdentifier*, DataBufferHolder*>>;
 
   StreamList streams_;
   size_t indexCount_;
+  // Read group of each node. Empty if there are no read groups.
+  std::vector<uint32_t> nodeGroup_;
+  uint32_t numGroups_{0};
 
   class NodeSizeSorter {
    public:
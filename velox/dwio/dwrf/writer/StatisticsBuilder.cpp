@@ -106,6 +106,33 @@ void StatisticsBuilder::merge(const ColumnStatistics& other) {
   mergeCount(rawSize_, other.getRawSize());
   // Merge size
   mergeCount(size_, other.getSize());
+  mergeDistinctValues(other);
+}
+
+void StatisticsBuilder::mergeDistinctValues(const ColumnStatistics& other) {
+  // Stats without values do not change the distinct count.
+  if (!countDistinct_ || !distinctValid_ || isEmpty(other)) {
+    return;
+  }
+  if (auto builder = dynamic_cast<const StatisticsBuilder*>(&other)) {
+    if (builder->countDistinct_ && builder->distinctValid_) {
+      if (builder->sketch_) {
+        if (!sketch_) {
+          sketch_ = std::make_unique<DistinctValueSketch>();
+        }
+        sketch_->merge(*builder->sketch_);
+      }
+      return;
+    }
+  } else if (const auto& serialized = other.getDistinctValuesSketch()) {
+    if (!sketch_) {
+      sketch_ = std::make_unique<DistinctValueSketch>();
+    }
+    sketch_->merge(folly::StringPiece{serialized.value()});
+    return;
+  }
+  distinctValid_ = false;
+  sketch_.reset();
 }
 
 void StatisticsBuilder::toProto(proto::ColumnStatistics& stats) const {
@@ -121,6 +148,14 @@ void StatisticsBuilder::toProto(proto::ColumnStatistics& stats) const {
   if (size_.has_value()) {
     stats.set_size(size_.value());
   }
+  if (countDistinct_ && distinctValid_) {
+    if (sketch_) {
+      stats.set_numberofdistinctvalues(sketch_->cardinality());
+      stats.set_distinctvaluessketch(sketch_->serialize());
+    } else {
+      stats.set_numberofdistinctvalues(0);
+    }
+  }
 }
 
 std::unique_ptr<ColumnStatistics> StatisticsBuilder::build() const {
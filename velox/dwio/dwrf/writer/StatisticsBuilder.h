@@ -18,6 +18,7 @@
 
 #include "velox/dwio/dwrf/common/Config.h"
 #include "velox/dwio/dwrf/common/Statistics.h"
+#include "velox/dwio/dwrf/writer/DistinctValueSketch.h"
 #include "velox/type/Type.h"
 
 namespace facebook::velox::dwrf {
@@ -48,14 +49,23 @@ addWithOverflowCheck(std::optional<T>& to, T value, uint64_t count) {
 struct StatisticsBuilderOptions {
   explicit StatisticsBuilderOptions(
       uint32_t stringLengthLimit,
-      std::optional<uint64_t> initialSize = std::nullopt)
-      : stringLengthLimit{stringLengthLimit}, initialSize{initialSize} {}
+      std::optional<uint64_t> initialSize = std::nullopt,
+      bool countDistinct = false)
+      : stringLengthLimit{stringLengthLimit},
+        initialSize{initialSize},
+        countDistinct{countDistinct} {}
 
   uint32_t stringLengthLimit;
   std::optional<uint64_t> initialSize;
+  // Whether integer, floating point and string stats keep a HyperLogLog
+  // sketch of the values to estimate the number of distinct values.
+  bool countDistinct;
 
   static StatisticsBuilderOptions fromConfig(const Config& config) {
-    return StatisticsBuilderOptions{config.get(Config::STRING_STATS_LIMIT)};
+    return StatisticsBuilderOptions{
+        config.get(Config::STRING_STATS_LIMIT),
+        std::nullopt,
+        config.get(Config::DISTINCT_COUNT_STATS)};
   }
 };
 
@@ -122,15 +132,39 @@ class StatisticsBuilder : public virtual ColumnStatistics {
       const Type& type,
       const StatisticsBuilderOptions& options);
 
+ protected:
+  template <typename T>
+  void addDistinctValue(T value) {
+    if (countDistinct_ && distinctValid_) {
+      if (!sketch_) {
+        sketch_ = std::make_unique<DistinctValueSketch>();
+      }
+      sketch_->add(value);
+    }
+  }
+
+  // Set by the builders of the types whose values are added to the sketch.
+  bool countDistinct_{false};
+
  private:
   void init() {
     valueCount_ = 0;
     hasNull_ = false;
     rawSize_ = 0;
     size_ = initialSize_;
+    // The sketch is created on the first value, so that columns without
+    // values and reset index stats hold no memory for it.
+    sketch_.reset();
+    distinctValid_ = true;
   }
 
+  void mergeDistinctValues(const ColumnStatistics& other);
+
   std::optional<uint64_t> initialSize_;
+  // False once stats without a sketch have been merged in, as the distinct
+  // count is then unknown.
+  bool distinctValid_;
+  std::unique_ptr<DistinctValueSketch> sketch_;
 };
 
 class BooleanStatisticsBuilder : public StatisticsBuilder,
@@ -170,6 +204,7 @@ class IntegerStatisticsBuilder : public StatisticsBuilder,
  public:
   explicit IntegerStatisticsBuilder(const StatisticsBuilderOptions& options)
       : StatisticsBuilder{options} {
+    countDistinct_ = options.countDistinct;
     init();
   }
 
@@ -184,6 +219,7 @@ class IntegerStatisticsBuilder : public StatisticsBuilder,
       max_ = value;
     }
     addWithOverflowCheck(sum_, value, count);
+    addDistinctValue(value);
   }
 
   void merge(const ColumnStatistics& other) override;
@@ -212,6 +248,7 @@ class DoubleStatisticsBuilder : public StatisticsBuilder,
  public:
   explicit DoubleStatisticsBuilder(const StatisticsBuilderOptions& options)
       : StatisticsBuilder{options} {
+    countDistinct_ = options.countDistinct;
     init();
   }
 
@@ -219,6 +256,7 @@ class DoubleStatisticsBuilder : public StatisticsBuilder,
 
   void addValues(double value, uint64_t count = 1) {
     increaseValueCount(count);
+    addDistinctValue(value);
     // min/max/sum is defined only when none of the values added is NaN
     if (std::isnan(value)) {
       clear();
@@ -271,6 +309,7 @@ class StringStatisticsBuilder : public StatisticsBuilder,
  public:
   explicit StringStatisticsBuilder(const StatisticsBuilderOptions& options)
       : StatisticsBuilder{options}, lengthLimit_{options.stringLengthLimit} {
+    countDistinct_ = options.countDistinct;
     init();
   }
 
@@ -295,6 +334,7 @@ class StringStatisticsBuilder : public StatisticsBuilder,
     }
 
     addWithOverflowCheck<uint64_t>(length_, value.size(), count);
+    addDistinctValue(value);
   }
 
   void merge(const ColumnStatistics& other) override;
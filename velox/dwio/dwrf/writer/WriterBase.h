@@ -32,6 +32,9 @@ class WriterBase {
   virtual ~WriterBase() = default;
 
   virtual void close() {
+    if (writerSink_) {
+      writerSink_->finishWrites();
+    }
     sink_->close();
   }
 
@@ -54,6 +57,13 @@ class WriterBase {
     return *writerSink_;
   }
 
+  // Returns true if the writes of flushed stripes that are in flight
+  // exceed their limit and sets 'future' to be realized when the oldest
+  // one completes.
+  bool isBlocked(folly::SemiFuture<folly::Unit>* future) {
+    return writerSink_ && writerSink_->isBlocked(future);
+  }
+
   void addUserMetadata(const std::string& key, const std::string& value) {
     userMetadata_[key] = value;
   }
@@ -64,13 +74,15 @@ class WriterBase {
   void initContext(
       const std::shared_ptr<const Config>& config,
       std::unique_ptr<velox::memory::ScopedMemoryPool> pool,
-      std::unique_ptr<encryption::EncryptionHandler> handler = nullptr) {
+      std::unique_ptr<encryption::EncryptionHandler> handler = nullptr,
+      folly::Executor* writeExecutor = nullptr) {
     context_ = std::make_unique<WriterContext>(
         config, std::move(pool), sink_->getMetricsLog(), std::move(handler));
     writerSink_ = std::make_unique<WriterSink>(
         *sink_,
         context_->getMemoryPool(MemoryUsageCategory::OUTPUT_STREAM),
-        context_->getConfigs());
+        context_->getConfigs(),
+        writeExecutor);
   }
 
   WriterContext& getContext() {
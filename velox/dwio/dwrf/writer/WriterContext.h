@@ -19,6 +19,7 @@
 #include <gtest/gtest_prod.h>
 
 #include "velox/dwio/dwrf/common/Compression.h"
+#include "velox/dwio/dwrf/common/PagedOutputStream.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
 #include "velox/dwio/dwrf/writer/IndexBuilder.h"
 #include "velox/dwio/dwrf/writer/IntegerDictionaryEncoder.h"
@@ -108,7 +109,25 @@ class WriterContext : public CompressionBufferPool {
     auto encrypter = handler_->isEncrypted(stream.node)
         ? std::addressof(handler_->getEncryptionProvider(stream.node))
         : nullptr;
-    return newStream(compression, holder, encrypter);
+    return createCompressor(
+        compression, *this, holder, *config_, encrypter, parallelFlush_.get());
+  }
+
+  // Makes the streams of columns compress their last page at stripe
+  // flush in parallel on 'executor'. Applies to the streams made after
+  // this call.
+  void setFlushExecutor(folly::Executor* executor) {
+    parallelFlush_ = executor ? std::make_unique<ParallelFlush>(executor)
+                              : nullptr;
+  }
+
+  // Adds the pages compressed in parallel at stripe flush to their
+  // streams. Must be called after flushing the column writers and
+  // before reading the streams.
+  void finishParallelFlush() {
+    if (parallelFlush_) {
+      parallelFlush_->finish();
+    }
   }
 
   std::unique_ptr<DataBufferHolder> newDataBufferHolder(
@@ -351,6 +370,19 @@ class WriterContext : public CompressionBufferPool {
         getConfig(Config::COMPRESSION_BLOCK_SIZE_EXTEND_RATIO));
   }
 
+  // Bytes held by the streams of the current stripe. Paged streams hold
+  // their full pages compressed, so unlike the memory usage of the streams
+  // this is close to what the stripe takes on disk so far.
+  uint64_t getOutputStreamBytes() const {
+    uint64_t size = 0;
+    for (auto& pair : streams_) {
+      if (!pair.second.isSuppressed()) {
+        size += pair.second.size();
+      }
+    }
+    return size;
+  }
+
   // The additional memory usage of writers during flush typically comes from
   // flushing remaining data to output buffer, or all of it in the case of
   // dictionary encoding. In either case, the maximal memory consumption is
@@ -478,6 +510,7 @@ class WriterContext : public CompressionBufferPool {
   std::vector<std::unique_ptr<velox::SelectivityVector>> selectivityVectorPool_;
 
   std::unique_ptr<encryption::EncryptionHandler> handler_;
+  std::unique_ptr<ParallelFlush> parallelFlush_;
   folly::F14FastMap<uint32_t, uint64_t> nodeSize;
   CompressionRatioTracker compressionRatioTracker_;
   FlushOverheadRatioTracker flushOverheadRatioTracker_;
@@ -165,6 +165,7 @@ void WriterShared::flushStripe(bool close) {
       return *footer.add_encoding();
     }
   });
+  context.finishParallelFlush();
 
   // Collects the memory increment from flushing data to output streams.
   auto flushOverhead =
@@ -219,11 +220,11 @@ void WriterShared::flushStripe(bool close) {
   // deals with streams
   uint64_t indexLength = 0;
   sink.setMode(WriterSink::Mode::Index);
-  LayoutPlanner planner(context);
+  LayoutPlanner planner(context, schema_.get());
   planner.iterateIndexStreams([&](auto& streamId, auto& content) {
-    DWIO_ENSURE_EQ(
-        streamId.kind,
-        StreamKind::StreamKind_ROW_INDEX,
+    DWIO_ENSURE(
+        streamId.kind == StreamKind::StreamKind_ROW_INDEX ||
+            streamId.kind == StreamKind::StreamKind_BLOOM_FILTER_UTF8,
         "unexpected stream kind ",
         streamId.kind);
     indexLength += content.size();
@@ -30,6 +30,12 @@ struct WriterOptionsShared {
   std::shared_ptr<encryption::EncryptionSpecification> encryptionSpec;
   std::shared_ptr<dwio::common::encryption::EncrypterFactory> encrypterFactory;
   int64_t memoryBudget = std::numeric_limits<int64_t>::max();
+  // If set, the last pages of the column streams are compressed in
+  // parallel on this executor when a stripe is flushed.
+  folly::Executor* flushExecutor = nullptr;
+  // If set, flushed stripes are written to the sink on this executor while
+  // the next stripe is encoded. See Config::MAX_INFLIGHT_WRITE_BYTES.
+  folly::Executor* writeExecutor = nullptr;
 };
 
 class WriterShared : public WriterBase {
@@ -54,7 +60,9 @@ class WriterShared : public WriterBase {
                 "writer_node_{}",
                 folly::to<std::string>(folly::Random::rand64())),
             std::min(options.memoryBudget, parentPool.getCap())),
-        std::move(handler));
+        std::move(handler),
+        options.writeExecutor);
+    getContext().setFlushExecutor(options.flushExecutor);
     if (!flushPolicy_) {
       auto& context = getContext();
       flushPolicy_ = DefaultFlushPolicy(
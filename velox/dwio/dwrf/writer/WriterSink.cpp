@@ -18,6 +18,13 @@
 
 namespace facebook::velox::dwrf {
 
+WriterSink::~WriterSink() {
+  // The writes refer to 'sink_' and to the buffers of 'this'.
+  for (auto& write : inflightWrites_) {
+    write->done.getSemiFuture().wait();
+  }
+}
+
 void WriterSink::addBuffer(dwio::common::DataBuffer<char> buffer) {
   auto length = buffer.size();
   if (length > 0) {
@@ -60,4 +67,59 @@ void WriterSink::addBuffer(dwio::common::DataBuffer<char> buffer) {
   }
 }
 
+void WriterSink::flushAsync() {
+  reapWrites();
+  if (buffers_.empty()) {
+    return;
+  }
+  auto write = std::make_unique<InflightWrite>();
+  write->buffers = std::move(buffers_);
+  write->size = size_;
+  auto* rawWrite = write.get();
+  write->done = folly::FutureSplitter<folly::Unit>(
+      folly::via(writeExecutor_.copy(), [this, rawWrite]() {
+        if (writeFailed_) {
+          return;
+        }
+        try {
+          sink_.write(rawWrite->buffers);
+        } catch (const std::exception&) {
+          writeFailed_ = true;
+          throw;
+        }
+      }));
+  submittedSize_ += size_;
+  inflightBytes_ += size_;
+  inflightWrites_.push_back(std::move(write));
+
+  // The oldest write may exceed the limit by itself so that the next stripe
+  // is encoded while it is written.
+  while (inflightWrites_.size() > 1 && inflightBytes_ > maxInflightBytes_) {
+    finishOldestWrite();
+  }
+}
+
+void WriterSink::reapWrites() {
+  while (!inflightWrites_.empty() &&
+         inflightWrites_.front()->done.getSemiFuture().isReady()) {
+    finishOldestWrite();
+  }
+}
+
+void WriterSink::finishOldestWrite() {
+  auto write = std::move(inflightWrites_.front());
+  inflightWrites_.pop_front();
+  inflightBytes_ -= write->size;
+  write->done.getSemiFuture().get();
+}
+
+bool WriterSink::isBlocked(folly::SemiFuture<folly::Unit>* future) {
+  reapWrites();
+  if (inflightBytes_ <= maxInflightBytes_) {
+    return false;
+  }
+  *future = inflightWrites_.front()->done.getSemiFuture();
+  return true;
+}
+
 } // namespace facebook::velox::dwrf
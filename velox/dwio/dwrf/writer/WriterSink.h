@@ -16,7 +16,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+
 #include <folly/container/Array.h>
+#include <folly/executors/SerialExecutor.h>
+#include <folly/futures/FutureSplitter.h>
 
 #include "velox/dwio/dwrf/common/Checksum.h"
 #include "velox/dwio/dwrf/common/Config.h"
@@ -36,21 +41,32 @@ class WriterSink {
  public:
   enum Mode : uint8_t { None = 0, Data = 1, Index = 2, Footer = 3 };
 
+  // If 'writeExecutor' is set, flushed buffers are written to 'sink' on it
+  // in order while the caller goes on encoding. The caller blocks in flush()
+  // when more than MAX_INFLIGHT_WRITE_BYTES are waiting to be written
+  // besides the oldest write.
   WriterSink(
       dwio::common::DataSink& sink,
       memory::MemoryPool& pool,
-      const Config& configs)
+      const Config& configs,
+      folly::Executor* writeExecutor = nullptr)
       : sink_{sink},
         checksum_{
             ChecksumFactory::create(configs.get(Config::CHECKSUM_ALGORITHM))},
         cacheMode_{configs.get(Config::STRIPE_CACHE_MODE)},
         mode_{Mode::None},
-        shouldBuffer_{!sink.isBuffered()},
+        shouldBuffer_{writeExecutor || !sink.isBuffered()},
         size_{0},
         maxCacheSize_{configs.get(Config::STRIPE_CACHE_SIZE)},
         cacheHolder_{pool, SLICE_SIZE, SLICE_SIZE},
         cacheBuffer_{pool},
-        exceedsLimit_{false} {
+        exceedsLimit_{false},
+        submittedSize_{sink.size()},
+        maxInflightBytes_{configs.get(Config::MAX_INFLIGHT_WRITE_BYTES)} {
+    if (writeExecutor) {
+      writeExecutor_ = folly::SerialExecutor::create(
+          folly::getKeepAliveToken(writeExecutor));
+    }
     if (cacheMode_ != proto::StripeCacheMode::NA) {
       offsets_.push_back(0);
       cacheBuffer_.reserve(SLICE_SIZE);
@@ -60,10 +76,10 @@ class WriterSink {
     addBuffer(pool, ORC_MAGIC.data(), ORC_MAGIC_LEN);
   }
 
-  ~WriterSink() = default;
+  ~WriterSink();
 
   uint64_t size() const {
-    return sink_.size() + size_;
+    return (writeExecutor_ ? submittedSize_ : sink_.size()) + size_;
   }
 
   void addBuffer(memory::MemoryPool& pool, const char* data, size_t size) {
@@ -83,11 +99,31 @@ class WriterSink {
   }
 
   void flush() {
-    sink_.write(buffers_);
+    if (writeExecutor_) {
+      flushAsync();
+    } else {
+      sink_.write(buffers_);
+    }
     buffers_.clear();
     size_ = 0;
   }
 
+  // Waits for the flushed buffers to be written. Rethrows the error of a
+  // failed write.
+  void finishWrites() {
+    while (!inflightWrites_.empty()) {
+      finishOldestWrite();
+    }
+  }
+
+  // Returns true if more than MAX_INFLIGHT_WRITE_BYTES wait to be written
+  // and sets 'future' to be realized when the oldest write completes.
+  bool isBlocked(folly::SemiFuture<folly::Unit>* future);
+
+  uint64_t inflightBytes() const {
+    return inflightBytes_;
+  }
+
   Checksum* getChecksum() {
     return checksum_.get();
   }
@@ -142,6 +178,31 @@ class WriterSink {
 
   std::vector<dwio::common::DataBuffer<char>> buffers_;
 
+  // Buffers handed to 'writeExecutor_'. They are freed on the thread of
+  // 'this' after the write completes.
+  struct InflightWrite {
+    std::vector<dwio::common::DataBuffer<char>> buffers;
+    uint64_t size;
+    folly::FutureSplitter<folly::Unit> done;
+  };
+
+  folly::Executor::KeepAlive<folly::SerialExecutor> writeExecutor_;
+  // Bytes handed to 'sink_' or to 'writeExecutor_'.
+  uint64_t submittedSize_;
+  const uint64_t maxInflightBytes_;
+  std::deque<std::unique_ptr<InflightWrite>> inflightWrites_;
+  uint64_t inflightBytes_{0};
+  // Set by the first failed write. The writes after it are skipped.
+  std::atomic<bool> writeFailed_{false};
+
+  void flushAsync();
+
+  // Frees the buffers of the completed writes at the front of
+  // 'inflightWrites_'.
+  void reapWrites();
+
+  void finishOldestWrite();
+
   bool shouldChecksum() {
     // checksum is captured in all modes except None and if checksum algorithm
     // is available
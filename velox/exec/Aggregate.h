@@ -268,6 +268,10 @@ class Aggregate {
   // different indices vector as the one we get from the DecodedVector is simply
   // sequential.
   std::vector<vector_size_t> pushdownCustomIndices_;
+
+  // The single group of a global aggregation repeated once per row. Used
+  // when pushing down into a ValueHook, which looks up the group by row.
+  std::vector<char*> pushdownGroups_;
 };
 
 using AggregateFunctionRegistry = Registry<
@@ -24,6 +24,17 @@ void AllocationPool::clear() {
   allocations_.clear();
 }
 
+void AllocationPool::swap(AllocationPool& other) {
+  VELOX_CHECK(mappedMemory_ == other.mappedMemory_);
+  VELOX_CHECK_EQ(owner_, other.owner_);
+  std::swap(allocations_, other.allocations_);
+  auto allocation = std::move(allocation_);
+  allocation_ = std::move(other.allocation_);
+  other.allocation_ = std::move(allocation);
+  std::swap(currentRun_, other.currentRun_);
+  std::swap(currentOffset_, other.currentOffset_);
+}
+
 char* AllocationPool::allocateFixed(uint64_t bytes) {
   VELOX_CHECK(bytes > 0, "Cannot allocate zero bytes");
   if (availableInRun() < bytes) {
@@ -38,6 +38,10 @@ class AllocationPool {
 
   void clear();
 
+  // Exchanges the allocations of 'this' and 'other'. Both must allocate
+  // from the same MappedMemory for the same owner.
+  void swap(AllocationPool& other);
+
   char* allocateFixed(uint64_t bytes);
 
   // Starts a new run for variable length allocation. The actual size
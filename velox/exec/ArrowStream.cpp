@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/ArrowStream.h"
+#include "velox/vector/arrow/Bridge.h"
+
+namespace facebook::velox::exec {
+
+ArrowStream::ArrowStream(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    std::shared_ptr<const core::ArrowStreamNode> arrowStreamNode)
+    : SourceOperator(
+          driverCtx,
+          arrowStreamNode->outputType(),
+          operatorId,
+          arrowStreamNode->id(),
+          "ArrowStream"),
+      arrowStream_(arrowStreamNode->arrowStream()) {}
+
+RowVectorPtr ArrowStream::getOutput() {
+  // Operator::getOutput is expected to return nullptr or a non-empty vector,
+  // so empty arrays are skipped.
+  while (!finished_) {
+    ArrowArray arrowArray;
+    if (arrowStream_->get_next(arrowStream_.get(), &arrowArray)) {
+      VELOX_FAIL("Failed to get the next Arrow array: {}", lastError());
+    }
+    if (!arrowArray.release) {
+      // End of stream.
+      finished_ = true;
+      break;
+    }
+    if (arrowArray.length == 0) {
+      arrowArray.release(&arrowArray);
+      continue;
+    }
+
+    ArrowSchema arrowSchema;
+    if (arrowStream_->get_schema(arrowStream_.get(), &arrowSchema)) {
+      arrowArray.release(&arrowArray);
+      VELOX_FAIL("Failed to get the Arrow stream schema: {}", lastError());
+    }
+
+    // Takes ownership of 'arrowArray', which is released when the imported
+    // vector and all vectors sharing its buffers are gone.
+    auto vector = importFromArrowAsOwner(arrowSchema, arrowArray, pool());
+    VELOX_CHECK_EQ(
+        vector->encoding(),
+        VectorEncoding::Simple::ROW,
+        "Arrow stream must produce struct arrays");
+    VELOX_CHECK(
+        vector->type()->kindEquals(outputType_),
+        "Arrow stream type {} does not match the plan type {}",
+        vector->type()->toString(),
+        outputType_->toString());
+
+    // Arrow names may differ from the plan's, e.g. be empty.
+    auto rowVector = vector->as<RowVector>();
+    return std::make_shared<RowVector>(
+        pool(),
+        outputType_,
+        rowVector->nulls(),
+        rowVector->size(),
+        rowVector->children(),
+        rowVector->getNullCount());
+  }
+  return nullptr;
+}
+
+void ArrowStream::close() {
+  finished_ = true;
+}
+
+std::string ArrowStream::lastError() {
+  const char* error = arrowStream_->get_last_error(arrowStream_.get());
+  return error ? error : "no error description";
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+/// Produces the batches of an Arrow C stream, importing each ArrowArray into a
+/// RowVector without copying its buffers.
+class ArrowStream : public SourceOperator {
+ public:
+  ArrowStream(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      std::shared_ptr<const core::ArrowStreamNode> arrowStreamNode);
+
+  RowVectorPtr getOutput() override;
+
+  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void finish() override {
+    Operator::finish();
+    close();
+  }
+
+  void close() override;
+
+ private:
+  // Returns the description of the last error of 'arrowStream_'.
+  std::string lastError();
+
+  std::shared_ptr<ArrowArrayStream> arrowStream_;
+  bool finished_{false};
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/ArrowStreamSink.h"
+
+#include <cerrno>
+
+#include "velox/exec/Task.h"
+#include "velox/exec/TaskResultStream.h"
+#include "velox/vector/arrow/Bridge.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+
+// The results of a Task and the last error reported through the Arrow
+// stream.
+struct TaskArrowStream {
+  std::shared_ptr<TaskResultStream> results;
+  std::string lastError;
+};
+
+// Returns 'input' with lazy columns replaced by their loaded vectors and
+// columns with encodings that cannot be exported to Arrow flattened. The
+// lazy columns have been loaded on the producer's thread by
+// TaskResultStream.
+RowVectorPtr makeExportable(const RowVectorPtr& input) {
+  auto children = input->children();
+  for (auto& child : children) {
+    child = BaseVector::loadedVectorShared(child);
+    switch (child->encoding()) {
+      case VectorEncoding::Simple::FLAT:
+      case VectorEncoding::Simple::ROW:
+      case VectorEncoding::Simple::ARRAY:
+      case VectorEncoding::Simple::MAP:
+      case VectorEncoding::Simple::DICTIONARY:
+        break;
+      default:
+        BaseVector::flattenVector(&child, input->size());
+    }
+  }
+  return std::make_shared<RowVector>(
+      input->pool(),
+      input->type(),
+      input->nulls(),
+      input->size(),
+      std::move(children),
+      input->getNullCount());
+}
+
+TaskArrowStream& streamOf(ArrowArrayStream* arrowStream) {
+  return *static_cast<TaskArrowStream*>(arrowStream->private_data);
+}
+
+int getSchema(ArrowArrayStream* arrowStream, ArrowSchema* out) {
+  auto& stream = streamOf(arrowStream);
+  try {
+    exportToArrow(stream.results->outputType(), *out);
+  } catch (const std::exception& e) {
+    stream.lastError = e.what();
+    return EIO;
+  }
+  return 0;
+}
+
+// Holds an exported batch together with the Task whose memory pools own the
+// batch's buffers.
+struct TaskArrowArray {
+  ArrowArray arrowArray;
+  std::shared_ptr<Task> task;
+};
+
+void releaseTaskArrowArray(ArrowArray* arrowArray) {
+  if (!arrowArray || !arrowArray->release) {
+    return;
+  }
+  auto* holder = static_cast<TaskArrowArray*>(arrowArray->private_data);
+  holder->arrowArray.release(&holder->arrowArray);
+  delete holder;
+  arrowArray->release = nullptr;
+  arrowArray->private_data = nullptr;
+}
+
+int getNext(ArrowArrayStream* arrowStream, ArrowArray* out) {
+  auto& stream = streamOf(arrowStream);
+  try {
+    auto vector = stream.results->next();
+    if (!vector) {
+      // End of stream.
+      out->release = nullptr;
+      return 0;
+    }
+    auto holder = std::make_unique<TaskArrowArray>();
+    holder->task = stream.results->task();
+    exportToArrow(makeExportable(vector), holder->arrowArray);
+
+    // ArrowArrays may be moved by copying the struct. Only release and
+    // private_data are replaced, to keep the Task alive.
+    *out = holder->arrowArray;
+    out->release = releaseTaskArrowArray;
+    out->private_data = holder.release();
+  } catch (const std::exception& e) {
+    stream.lastError = e.what();
+    return EIO;
+  }
+  return 0;
+}
+
+const char* getLastError(ArrowArrayStream* arrowStream) {
+  auto& stream = streamOf(arrowStream);
+  return stream.lastError.empty() ? nullptr : stream.lastError.c_str();
+}
+
+void releaseStream(ArrowArrayStream* arrowStream) {
+  if (!arrowStream || !arrowStream->release) {
+    return;
+  }
+  auto* stream = static_cast<TaskArrowStream*>(arrowStream->private_data);
+  stream->results->close();
+  delete stream;
+  arrowStream->release = nullptr;
+  arrowStream->private_data = nullptr;
+}
+
+} // namespace
+
+void exportToArrowStream(
+    std::shared_ptr<const core::PlanNode> planNode,
+    std::shared_ptr<core::QueryCtx> queryCtx,
+    ArrowArrayStream& arrowStream,
+    int32_t maxDrivers,
+    uint64_t maxBufferedBytes) {
+  arrowStream.get_schema = getSchema;
+  arrowStream.get_next = getNext;
+  arrowStream.get_last_error = getLastError;
+  arrowStream.release = releaseStream;
+  arrowStream.private_data = new TaskArrowStream{TaskResultStream::create(
+      std::move(planNode), std::move(queryCtx), maxDrivers, maxBufferedBytes)};
+}
+
+} // namespace facebook::velox::exec
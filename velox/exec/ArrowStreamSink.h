@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/core/QueryCtx.h"
+#include "velox/vector/arrow/Abi.h"
+
+namespace facebook::velox::exec {
+
+/// Runs 'planNode' in a new Task and exposes the Task's results as an Arrow C
+/// stream of struct arrays. The Task starts on the first call to get_next,
+/// which blocks until the next batch of results is produced. Producers block
+/// while more than 'maxBufferedBytes' of results wait to be consumed.
+///
+/// Batches are exported without copying, except for top-level columns with
+/// encodings Arrow does not have, e.g. constant, which are flattened. Each
+/// exported ArrowArray keeps the Task, and hence the memory of its vectors,
+/// alive until it is released. Releasing the stream cancels the Task if it is
+/// still running.
+///
+/// Errors of the Task are reported by get_next returning EIO, with the message
+/// available from get_last_error.
+void exportToArrowStream(
+    std::shared_ptr<const core::PlanNode> planNode,
+    std::shared_ptr<core::QueryCtx> queryCtx,
+    ArrowArrayStream& arrowStream,
+    int32_t maxDrivers = 1,
+    uint64_t maxBufferedBytes = 512 * 1024);
+
+} // namespace facebook::velox::exec
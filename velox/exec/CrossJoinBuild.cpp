@@ -58,6 +58,39 @@ void CrossJoinBuild::addInput(RowVectorPtr input) {
   }
 }
 
+void CrossJoinBuild::combineSmallBatches() {
+  std::vector<VectorPtr> combined;
+  size_t begin = 0;
+  while (begin < data_.size()) {
+    auto end = begin + 1;
+    vector_size_t numRows = data_[begin]->size();
+    while (end < data_.size() &&
+           numRows + data_[end]->size() <= kMaxCombinedRows) {
+      numRows += data_[end]->size();
+      ++end;
+    }
+    if (end == begin + 1) {
+      combined.push_back(std::move(data_[begin]));
+      begin = end;
+      continue;
+    }
+    auto batch = std::static_pointer_cast<RowVector>(
+        BaseVector::create(data_[begin]->type(), numRows, pool()));
+    vector_size_t offset = 0;
+    for (auto i = begin; i < end; ++i) {
+      auto* input = data_[i]->asUnchecked<RowVector>();
+      for (auto j = 0; j < batch->childrenSize(); ++j) {
+        batch->childAt(j)->copy(
+            input->childAt(j).get(), offset, 0, input->size());
+      }
+      offset += input->size();
+    }
+    combined.push_back(std::move(batch));
+    begin = end;
+  }
+  data_ = std::move(combined);
+}
+
 BlockingReason CrossJoinBuild::isBlocked(ContinueFuture* future) {
   if (!hasFuture_) {
     return BlockingReason::kNotBlocked;
@@ -96,6 +129,7 @@ void CrossJoinBuild::finish() {
     promise.setValue(true);
   }
 
+  combineSmallBatches();
   operatorCtx_->task()
       ->getCrossJoinBridge(planNodeId())
       ->setData(std::move(data_));
@@ -56,7 +56,15 @@ class CrossJoinBuild : public Operator {
     Operator::close();
   }
 
+  // Consecutive build batches are combined into batches of up to this
+  // many rows, so that small build sides give large probe output.
+  static constexpr vector_size_t kMaxCombinedRows = 1'000;
+
  private:
+  // Copies runs of consecutive small batches of 'data_' into single
+  // batches of up to kMaxCombinedRows rows.
+  void combineSmallBatches();
+
   std::vector<VectorPtr> data_;
 
   // Future for synchronizing with other Drivers of the same pipeline. All build
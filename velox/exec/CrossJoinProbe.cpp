@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/exec/CrossJoinProbe.h"
+#include "velox/exec/OperatorUtils.h"
 #include "velox/exec/Task.h"
 
 namespace facebook::velox::exec {
@@ -53,6 +54,42 @@ CrossJoinProbe::CrossJoinProbe(
   if (isIdentityProjection && buildProjections_.empty()) {
     isIdentityProjection_ = true;
   }
+
+  if (joinNode->filter()) {
+    initializeFilter(joinNode->filter(), probeType, buildType);
+  }
+}
+
+void CrossJoinProbe::initializeFilter(
+    const std::shared_ptr<const core::ITypedExpr>& filter,
+    const RowTypePtr& probeType,
+    const RowTypePtr& buildType) {
+  std::vector<std::shared_ptr<const core::ITypedExpr>> filters = {filter};
+  filter_ =
+      std::make_unique<ExprSet>(std::move(filters), operatorCtx_->execCtx());
+  ChannelIndex filterChannel = 0;
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  for (auto& field : filter_->expr(0)->distinctFields()) {
+    const auto& name = field->field();
+    auto channel = probeType->getChildIdxIfExists(name);
+    if (channel.has_value()) {
+      filterProbeInputs_.emplace_back(channel.value(), filterChannel++);
+      names.push_back(name);
+      types.push_back(probeType->childAt(channel.value()));
+      continue;
+    }
+    channel = buildType->getChildIdxIfExists(name);
+    if (channel.has_value()) {
+      filterBuildInputs_.emplace_back(channel.value(), filterChannel++);
+      names.push_back(name);
+      types.push_back(buildType->childAt(channel.value()));
+      continue;
+    }
+    VELOX_FAIL(
+        "Join filter field {} not in probe or build input", field->toString());
+  }
+  filterInputType_ = ROW(std::move(names), std::move(types));
 }
 
 BlockingReason CrossJoinProbe::isBlocked(ContinueFuture* future) {
@@ -89,16 +126,23 @@ void CrossJoinProbe::addInput(RowVectorPtr input) {
 }
 
 RowVectorPtr CrossJoinProbe::getOutput() {
-  if (!input_) {
-    return nullptr;
+  while (input_) {
+    if (auto output = nextBatch()) {
+      return output;
+    }
   }
+  return nullptr;
+}
 
+RowVectorPtr CrossJoinProbe::nextBatch() {
   const auto inputSize = input_->size();
 
   // TODO Use query-level configuration property.
   static const vector_size_t kOutputBatchSize = 1'000;
 
-  auto buildSize = buildData_.value()[buildIndex_]->size();
+  auto buildRowVector =
+      buildData_.value()[buildIndex_]->asUnchecked<RowVector>();
+  auto buildSize = buildRowVector->size();
   vector_size_t probeCnt;
   if (buildSize > kOutputBatchSize) {
     probeCnt = 1;
@@ -115,10 +159,9 @@ RowVectorPtr CrossJoinProbe::getOutput() {
         rawIndices + (i + 1) * buildSize,
         probeRow_ + i);
   }
-  auto output = fillOutput(size, indices);
 
   BufferPtr buildIndices = nullptr;
-  if (probeCnt > 1) {
+  if (probeCnt > 1 || filter_) {
     buildIndices = AlignedBuffer::allocate<vector_size_t>(size, pool());
     auto* rawBuildIndices = buildIndices->asMutable<vector_size_t>();
     for (auto i = 0; i < probeCnt; ++i) {
@@ -129,8 +172,20 @@ RowVectorPtr CrossJoinProbe::getOutput() {
     }
   }
 
-  auto buildRowVector =
-      buildData_.value()[buildIndex_]->asUnchecked<RowVector>();
+  if (filter_) {
+    size = evalFilter(size, indices, buildIndices, *buildRowVector);
+    if (size == 0) {
+      advance(probeCnt);
+      return nullptr;
+    }
+  }
+
+  // fillOutput() may hand out 'input_' itself. Keep it for pairing with
+  // the next build batches.
+  auto input = input_;
+  auto output = fillOutput(size, indices);
+  input_ = std::move(input);
+
   for (const auto& projection : buildProjections_) {
     VectorPtr buildVector = buildRowVector->childAt(projection.inputChannel);
 
@@ -141,8 +196,55 @@ RowVectorPtr CrossJoinProbe::getOutput() {
     output->childAt(projection.outputChannel) = buildVector;
   }
 
+  advance(probeCnt);
+  return output;
+}
+
+vector_size_t CrossJoinProbe::evalFilter(
+    vector_size_t size,
+    const BufferPtr& probeIndices,
+    const BufferPtr& buildIndices,
+    const RowVector& build) {
+  if (!filterInput_) {
+    filterInput_ = std::static_pointer_cast<RowVector>(
+        BaseVector::create(filterInputType_, 1, pool()));
+  }
+  filterInput_->resize(size);
+  for (auto projection : filterProbeInputs_) {
+    filterInput_->childAt(projection.outputChannel) = wrapChild(
+        size, probeIndices, input_->childAt(projection.inputChannel));
+  }
+  for (auto projection : filterBuildInputs_) {
+    filterInput_->childAt(projection.outputChannel) =
+        BaseVector::wrapInDictionary(
+            BufferPtr(nullptr),
+            buildIndices,
+            size,
+            build.childAt(projection.inputChannel));
+  }
+
+  filterRows_.resize(size);
+  filterRows_.setAll();
+  EvalCtx evalCtx(operatorCtx_->execCtx(), filter_.get(), filterInput_.get());
+  filter_->eval(0, 1, true, filterRows_, &evalCtx, &filterResult_);
+  decodedFilterResult_.decode(*filterResult_[0], filterRows_);
+
+  auto* rawProbeIndices = probeIndices->asMutable<vector_size_t>();
+  auto* rawBuildIndices = buildIndices->asMutable<vector_size_t>();
+  vector_size_t numPassed = 0;
+  for (auto i = 0; i < size; ++i) {
+    if (!decodedFilterResult_.isNullAt(i) &&
+        decodedFilterResult_.valueAt<bool>(i)) {
+      rawProbeIndices[numPassed] = rawProbeIndices[i];
+      rawBuildIndices[numPassed++] = rawBuildIndices[i];
+    }
+  }
+  return numPassed;
+}
+
+void CrossJoinProbe::advance(vector_size_t probeCnt) {
   probeRow_ += probeCnt;
-  if (probeRow_ == inputSize) {
+  if (probeRow_ == input_->size()) {
     probeRow_ = 0;
     ++buildIndex_;
     if (buildIndex_ == buildData_->size()) {
@@ -150,11 +252,11 @@ RowVectorPtr CrossJoinProbe::getOutput() {
       input_.reset();
     }
   }
-  return output;
 }
 
 void CrossJoinProbe::close() {
   buildData_.reset();
+  filterInput_ = nullptr;
   Operator::close();
 }
 } // namespace facebook::velox::exec
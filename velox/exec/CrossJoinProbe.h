@@ -17,6 +17,7 @@
 
 #include "velox/exec/CrossJoinBuild.h"
 #include "velox/exec/Operator.h"
+#include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
 class CrossJoinProbe : public Operator {
@@ -39,8 +40,50 @@ class CrossJoinProbe : public Operator {
   void close() override;
 
  private:
+  // Sets up 'filter_' and related members.
+  void initializeFilter(
+      const std::shared_ptr<const core::ITypedExpr>& filter,
+      const RowTypePtr& probeType,
+      const RowTypePtr& buildType);
+
+  // Returns the pairs of the next probe rows of 'input_' with the rows of
+  // the current build batch. Returns nullptr if 'filter_' drops all the
+  // pairs.
+  RowVectorPtr nextBatch();
+
+  // Applies 'filter_' to 'size' pairs of probe rows in 'probeIndices' and
+  // build rows in 'buildIndices'. Moves the passing pairs to the front of
+  // the indices and returns their number.
+  vector_size_t evalFilter(
+      vector_size_t size,
+      const BufferPtr& probeIndices,
+      const BufferPtr& buildIndices,
+      const RowVector& build);
+
+  // Moves to the next 'probeCnt' probe rows and to the next build batch
+  // after the last probe row.
+  void advance(vector_size_t probeCnt);
+
   std::vector<IdentityProjection> buildProjections_;
 
+  // Join filter, nullptr if absent.
+  std::unique_ptr<ExprSet> filter_;
+
+  // Type of the RowVector for filter inputs.
+  RowTypePtr filterInputType_;
+
+  // Maps input channels to channels in 'filterInputType_'.
+  std::vector<IdentityProjection> filterProbeInputs_;
+
+  // Maps build channels to channels in 'filterInputType_'.
+  std::vector<IdentityProjection> filterBuildInputs_;
+
+  // Reusable members for evaluating 'filter_'.
+  RowVectorPtr filterInput_;
+  SelectivityVector filterRows_;
+  std::vector<VectorPtr> filterResult_{1};
+  DecodedVector decodedFilterResult_;
+
   std::optional<std::vector<VectorPtr>> buildData_;
 
   // Index into buildData_ for the build side vector to process on next call to
@@ -15,9 +15,8 @@
  */
 
 #include <folly/executors/QueuedImmediateExecutor.h>
-#include <folly/executors/task_queue/UnboundedBlockingQueue.h>
-#include <folly/executors/thread_factory/InitThreadFactory.h>
 #include <gflags/gflags.h>
+#include "velox/common/process/CpuSampler.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/Task.h"
 #include "velox/expression/Expr.h"
@@ -28,6 +27,29 @@ DEFINE_int32(
     "Process-wide number of query execution threads");
 
 namespace facebook::velox::exec {
+
+const char* blockingReasonToString(BlockingReason reason) {
+  switch (reason) {
+    case BlockingReason::kNotBlocked:
+      return "NotBlocked";
+    case BlockingReason::kWaitForConsumer:
+      return "WaitForConsumer";
+    case BlockingReason::kWaitForSplit:
+      return "WaitForSplit";
+    case BlockingReason::kWaitForExchange:
+      return "WaitForExchange";
+    case BlockingReason::kWaitForJoinBuild:
+      return "WaitForJoinBuild";
+    case BlockingReason::kWaitForMemory:
+      return "WaitForMemory";
+    case BlockingReason::kWaitForMergeJoinRightSide:
+      return "WaitForMergeJoinRightSide";
+    case BlockingReason::kWaitForPeers:
+      return "WaitForPeers";
+  }
+  return "Unknown";
+}
+
 namespace {
 // Basic implementation of the connector::ExpressionEvaluator interface.
 class SimpleExpressionEvaluator : public connector::ExpressionEvaluator {
@@ -88,7 +110,8 @@ DriverCtx::createConnectorQueryCtx(
       task->queryCtx()->getConnectorConfig(connectorId),
       expressionEvaluator.get(),
       task->queryCtx()->mappedMemory(),
-      fmt::format("{}.{}", task->taskId(), planNodeId));
+      fmt::format("{}.{}", task->taskId(), planNodeId),
+      task->cancelPool()->cancellationToken());
 }
 
 BlockingState::BlockingState(
@@ -117,6 +140,16 @@ void BlockingState::setResume(std::shared_ptr<BlockingState> state) {
       .thenValue([state](bool /* unused */) {
         state->operator_->recordBlockingTime(state->sinceMicros_);
         auto driver = state->driver_;
+        if (auto& recorder = driver->driverCtx()->task->traceRecorder()) {
+          process::TraceEvent event;
+          event.name = blockingReasonToString(state->reason_);
+          event.category = "blocked";
+          event.track = driver->traceTrack();
+          event.startMicros = state->sinceMicros_;
+          event.durationMicros =
+              process::TraceRecorder::nowMicros() - state->sinceMicros_;
+          recorder->record(event);
+        }
         {
           std::lock_guard<std::mutex> l(*driver->cancelPool()->mutex());
           VELOX_CHECK(!driver->state().isSuspended);
@@ -181,13 +214,13 @@ class CancelPoolGuard {
 };
 } // namespace
 
-static std::unique_ptr<folly::CPUThreadPoolExecutor>& getExecutor() {
-  static std::unique_ptr<folly::CPUThreadPoolExecutor> executor;
+static std::unique_ptr<WorkStealingExecutor>& getExecutor() {
+  static std::unique_ptr<WorkStealingExecutor> executor;
   return executor;
 }
 
 // static
-folly::CPUThreadPoolExecutor* Driver::executor(int32_t threads) {
+WorkStealingExecutor* Driver::executor(int32_t threads) {
   static std::mutex mutex;
   if (getExecutor().get()) {
     return getExecutor().get();
@@ -195,12 +228,7 @@ folly::CPUThreadPoolExecutor* Driver::executor(int32_t threads) {
   std::lock_guard<std::mutex> l(mutex);
   if (!getExecutor().get()) {
     auto numThreads = threads > 0 ? threads : FLAGS_velox_num_query_threads;
-    auto queue = std::make_unique<
-        folly::UnboundedBlockingQueue<folly::CPUThreadPoolExecutor::CPUTask>>();
-    getExecutor().reset(new folly::CPUThreadPoolExecutor(
-        numThreads,
-        std::move(queue),
-        std::make_shared<folly::NamedThreadFactory>("velox_query")));
+    getExecutor().reset(new WorkStealingExecutor(numThreads, "velox_query"));
   }
   return getExecutor().get();
 }
@@ -218,11 +246,17 @@ void Driver::enqueue(std::shared_ptr<Driver> driver) {
   VELOX_CHECK(!driver->state().isEnqueued);
   driver->state().isEnqueued = true;
   auto& task = driver->task_;
-  auto executor = task ? task->queryCtx()->executor() : nullptr;
+  folly::Executor* executor = task ? task->queryCtx()->executor() : nullptr;
   if (!executor) {
     executor = Driver::executor();
   }
-  executor->add([driver]() { Driver::run(driver); });
+  if (task && executor->getNumPriorities() > 1) {
+    executor->addWithPriority(
+        [driver]() { Driver::run(driver); },
+        task->queryCtx()->driverPriority());
+  } else {
+    executor->add([driver]() { Driver::run(driver); });
+  }
 }
 
 Driver::Driver(
@@ -234,6 +268,10 @@ Driver::Driver(
       operators_(std::move(operators)) {
   // Operators need access to their Driver for adaptation.
   ctx_->driver = this;
+  if (auto& recorder = task_->traceRecorder()) {
+    traceTrack_ = recorder->addTrack(fmt::format(
+        "pipeline {} driver {}", ctx_->pipelineId, ctx_->driverId));
+  }
 }
 
 namespace {
@@ -333,9 +371,26 @@ core::StopReason Driver::runInternal(
         }
         close();
       });
+  // The events recorded on this thread until return are on the timeline
+  // of 'this'.
+  process::ScopedTraceContext traceContext(
+      task_->traceRecorder().get(), traceTrack_);
+  process::TraceSpan runSpan("run", "driver");
   try {
     int32_t numOperators = operators_.size();
     ContinueFuture future(false);
+    // A Driver that runs longer than its time slice or moves more
+    // batches than its batch limit goes to the back of the queue so that
+    // other Drivers get the thread.
+    const auto timeSliceMicros = task_->queryCtx()->driverTimeSliceMicros();
+    const auto sliceEnd = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(timeSliceMicros);
+    const auto timeSliceBatches =
+        task_->queryCtx()->driverTimeSliceBatches();
+    int64_t numBatches = 0;
+    if (task_->queryCtx()->adaptiveFilterReorderingEnabled()) {
+      reorderFilters();
+    }
 
     for (;;) {
       for (int32_t i = numOperators - 1; i >= 0; --i) {
@@ -346,6 +401,8 @@ core::StopReason Driver::runInternal(
         }
 
         auto op = operators_[i].get();
+        // The CPU samples until the next operator are charged to 'op'.
+        process::ScopedCpuSampleTarget sampleTarget(op->cpuSampleCounter());
         blockingReason_ = op->isBlocked(&future);
         if (blockingReason_ != BlockingReason::kNotBlocked) {
           *blockingState = std::make_shared<BlockingState>(
@@ -377,10 +434,22 @@ core::StopReason Driver::runInternal(
             }
             pushdownFilters(i);
             if (result) {
+              process::ScopedCpuSampleTarget addInputTarget(
+                  nextOp->cpuSampleCounter());
               OperationTimer timer(nextOp->stats().addInputTiming);
               nextOp->stats().inputPositions += result->size();
               nextOp->stats().inputBytes += resultBytes;
               nextOp->addInput(result);
+              ++numBatches;
+              if ((timeSliceBatches > 0 && numBatches >= timeSliceBatches) ||
+                  (timeSliceMicros > 0 &&
+                   std::chrono::steady_clock::now() >= sliceEnd)) {
+                // The next run starts again from the last operator.
+                ++numYields_;
+                process::traceInstant("yield", "driver", numBatches);
+                guard.notThrown();
+                return core::StopReason::kYield;
+              }
               // The next iteration will see if operators_[i + 1] has
               // output now that it got input.
               i += 2;
@@ -406,6 +475,8 @@ core::StopReason Driver::runInternal(
               }
               if (op->isFinishing()) {
                 if (!nextOp->isFinishing()) {
+                  process::ScopedCpuSampleTarget finishTarget(
+                      nextOp->cpuSampleCounter());
                   OperationTimer timer(nextOp->stats().finishTiming);
                   nextOp->finish();
                   break;
@@ -494,6 +565,7 @@ void Driver::addStatsToTask() {
   for (auto& op : operators_) {
     auto& stats = op->stats();
     stats.memoryStats.update(op->pool()->getMemoryUsageTracker());
+    stats.cpuSamples += op->cpuSampleCounter()->exchange(0);
     task_->addOperatorStats(stats);
   }
 }
@@ -506,6 +578,9 @@ void Driver::close() {
   addStatsToTask();
   for (auto& op : operators_) {
     op->close();
+    if (auto& tracker = op->pool()->getMemoryUsageTracker()) {
+      tracker->release();
+    }
   }
   Task::removeDriver(task_, this);
   task_ = nullptr;
@@ -520,6 +595,64 @@ bool Driver::terminate() {
   return false;
 }
 
+uint64_t Driver::reclaim(uint64_t bytes) {
+  VELOX_CHECK(!isOnThread() || state_.isSuspended);
+  uint64_t freed = 0;
+  if (!task_ || isTerminated()) {
+    return freed;
+  }
+  for (auto& op : operators_) {
+    if (freed >= bytes) {
+      break;
+    }
+    auto opFreed = op->reclaim(bytes - freed);
+    if (opFreed > 0) {
+      // Memory freed within a reservation stays reserved until the
+      // reservation is released.
+      if (auto& tracker = op->pool()->getMemoryUsageTracker()) {
+        tracker->release();
+      }
+    }
+    freed += opFreed;
+  }
+  return freed;
+}
+
+void Driver::reorderFilters() {
+  // Minimum number of input rows seen by both operators before
+  // their pass rates are compared.
+  constexpr int64_t kMinRowsForReorder = 10'000;
+  // The downstream operator must pass at most this fraction of the
+  // rows passed by the upstream one to move ahead of it. The margin
+  // keeps operators with similar pass rates from trading places back
+  // and forth.
+  constexpr double kReorderMargin = 0.8;
+  for (auto i = 1; i + 1 < operators_.size(); ++i) {
+    auto op = operators_[i].get();
+    auto nextOp = operators_[i + 1].get();
+    if (!op->canReorder() || !nextOp->canReorder()) {
+      continue;
+    }
+    const auto& stats = op->stats();
+    const auto& nextStats = nextOp->stats();
+    if (stats.inputPositions < kMinRowsForReorder ||
+        nextStats.inputPositions < kMinRowsForReorder) {
+      continue;
+    }
+    const double passRate =
+        static_cast<double>(stats.outputPositions) / stats.inputPositions;
+    const double nextPassRate =
+        static_cast<double>(nextStats.outputPositions) /
+        nextStats.inputPositions;
+    if (nextPassRate < passRate * kReorderMargin) {
+      std::swap(operators_[i], operators_[i + 1]);
+      nextOp->stats().addRuntimeStat("numReorders", 1);
+      // 'op' moved to i + 1 and is not compared again in this pass.
+      ++i;
+    }
+  }
+}
+
 bool Driver::mayPushdownAggregation(Operator* aggregation) const {
   for (auto i = 1; i < operators_.size(); ++i) {
     auto op = operators_[i].get();
@@ -606,6 +739,7 @@ std::string Driver::toString() {
   } else {
     out << "blocked " << static_cast<int>(blockingReason_) << " ";
   }
+  out << "yields " << numYields_ << " ";
   for (auto& op : operators_) {
     out << op->toString() << " ";
   }
@@ -14,16 +14,19 @@
  * limitations under the License.
  */
 #pragma once
-#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
+#include <atomic>
 #include "velox/connectors/Connector.h"
 #include "velox/core/PlanNode.h"
 #include "velox/core/QueryCtx.h"
+#include "velox/exec/WorkStealingExecutor.h"
+#include "velox/vector/VectorPool.h"
 
 namespace facebook::velox::exec {
 
 class Driver;
 class ExchangeClient;
+class FragmentResultCache;
 class Operator;
 struct OperatorStats;
 class Task;
@@ -34,9 +37,15 @@ enum class BlockingReason {
   kWaitForSplit,
   kWaitForExchange,
   kWaitForJoinBuild,
-  kWaitForMemory
+  kWaitForMemory,
+  kWaitForMergeJoinRightSide,
+  // Waiting for the other Drivers of an operator to finish their input.
+  kWaitForPeers
 };
 
+// Returns a name for 'reason' for display. The result is a string literal.
+const char* FOLLY_NONNULL blockingReasonToString(BlockingReason reason);
+
 using ContinueFuture = folly::SemiFuture<bool>;
 
 class BlockingState {
@@ -73,6 +82,12 @@ struct DriverCtx {
   const int pipelineId;
   Driver* FOLLY_NONNULL driver;
   int32_t numDrivers;
+  // Set if the results of the pipeline's partial aggregation are cached
+  // per split. Shared by the TableScan and the aggregation.
+  std::shared_ptr<FragmentResultCache> fragmentResultCache;
+  // Recycles vectors between the operators of the Driver. Declared last so
+  // that the cached vectors are freed before 'task' and its memory pools.
+  VectorPool vectorPool;
 
   explicit DriverCtx(
       std::shared_ptr<Task> _task,
@@ -100,8 +115,9 @@ class Driver {
     close();
   }
 
-  static folly::CPUThreadPoolExecutor* FOLLY_NONNULL
-  executor(int32_t threads = 0);
+  // Returns the process-wide executor for Drivers of Tasks whose
+  // QueryCtx does not specify an executor.
+  static WorkStealingExecutor* FOLLY_NONNULL executor(int32_t threads = 0);
 
   static void run(std::shared_ptr<Driver> self);
 
@@ -137,6 +153,11 @@ class Driver {
   // resources on the thread.
   bool terminate();
 
+  // Asks the Operators of 'this' to free up to 'bytes' bytes of
+  // memory. Returns the number of bytes freed. 'this' must be off
+  // thread or suspended, e.g. its Task is paused.
+  uint64_t reclaim(uint64_t bytes);
+
   void initializeOperatorStats(std::vector<OperatorStats>& stats);
 
   void addStatsToTask();
@@ -164,6 +185,17 @@ class Driver {
     return ctx_.get();
   }
 
+  // Returns the number of times 'this' gave up its thread at the end of
+  // a time slice.
+  int64_t numYields() const {
+    return numYields_;
+  }
+
+  // Returns the track of 'this' in the TraceRecorder of its Task.
+  int32_t traceTrack() const {
+    return traceTrack_;
+  }
+
  private:
   core::StopReason runInternal(
       std::shared_ptr<Driver>& self,
@@ -175,6 +207,11 @@ class Driver {
   // position in the pipeline.
   void pushdownFilters(int operatorIndex);
 
+  // Swaps adjacent operators that only drop rows, e.g. filter-only
+  // HashProbes, so that the one that passes fewer rows runs first.
+  // Called between batches, when no operator holds partial input.
+  void reorderFilters();
+
   std::unique_ptr<DriverCtx> ctx_;
   std::shared_ptr<Task> task_;
   core::CancelPoolPtr cancelPool_;
@@ -185,6 +222,12 @@ class Driver {
   std::vector<std::unique_ptr<Operator>> operators_;
 
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
+
+  // Incremented on thread, read without synchronization for reporting.
+  std::atomic<int64_t> numYields_{0};
+
+  // The timeline of 'this' in the trace of the Task if tracing is enabled.
+  int32_t traceTrack_{0};
 };
 
 using OperatorSupplier = std::function<std::unique_ptr<Operator>(
@@ -253,6 +296,18 @@ struct DriverFactory {
     return planNodeIds;
   }
 
+  /// Returns plan node IDs of all MergeJoinNode's in the pipeline.
+  std::vector<core::PlanNodeId> needsMergeJoinSources() const {
+    std::vector<core::PlanNodeId> joinNodeIds;
+    for (const auto& planNode : planNodes) {
+      if (auto joinNode =
+              std::dynamic_pointer_cast<const core::MergeJoinNode>(planNode)) {
+        joinNodeIds.emplace_back(joinNode->id());
+      }
+    }
+    return joinNodeIds;
+  }
+
   /// Returns plan node IDs of all CrossJoinNode's in the pipeline.
   std::vector<core::PlanNodeId> needsCrossJoinBridges() const {
     std::vector<core::PlanNodeId> joinNodeIds;
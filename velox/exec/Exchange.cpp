@@ -46,6 +46,164 @@ SerializedPage::SerializedPage(
   VELOX_CHECK_EQ(toRead, 0);
 }
 
+namespace {
+// A std::streambuf that writes into MappedMemory allocations. Supports
+// the seeks that serializers do for filling in a header after writing
+// the data.
+class AllocationStreamBuf : public std::streambuf {
+ public:
+  AllocationStreamBuf(
+      memory::MappedMemory* memory,
+      memory::MappedMemory::Allocation& allocation,
+      std::vector<std::unique_ptr<memory::MappedMemory::Allocation>>&
+          extraAllocations,
+      int64_t initialBytes)
+      : memory_(memory),
+        allocation_(allocation),
+        extraAllocations_(extraAllocations) {
+    addAllocation(initialBytes);
+    setRun(0);
+  }
+
+  // Returns the ranges of the written bytes.
+  std::vector<ByteRange> finish() {
+    size_ = std::max(size_, position());
+    std::vector<ByteRange> ranges;
+    for (auto i = 0; i < runs_.size() && starts_[i] < size_; ++i) {
+      auto bytes = std::min<int64_t>(runs_[i].size, size_ - starts_[i]);
+      ranges.push_back(
+          ByteRange{runs_[i].buffer, static_cast<int32_t>(bytes), 0});
+    }
+    return ranges;
+  }
+
+ protected:
+  int_type overflow(int_type c) override {
+    size_ = std::max(size_, position());
+    if (current_ + 1 == runs_.size()) {
+      // Doubles the capacity.
+      addAllocation(starts_.back() + runs_.back().size);
+    }
+    setRun(current_ + 1);
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  pos_type seekoff(
+      off_type offset,
+      std::ios_base::seekdir direction,
+      std::ios_base::openmode which) override {
+    int64_t base = 0;
+    if (direction == std::ios_base::cur) {
+      base = position();
+    } else if (direction == std::ios_base::end) {
+      base = std::max(size_, position());
+    }
+    return seekpos(base + offset, which);
+  }
+
+  pos_type seekpos(pos_type target, std::ios_base::openmode which) override {
+    int64_t capacity = starts_.back() + runs_.back().size;
+    if (!(which & std::ios_base::out) || target < 0 || target > capacity) {
+      return pos_type(off_type(-1));
+    }
+    size_ = std::max(size_, position());
+    auto run = std::upper_bound(starts_.begin(), starts_.end(), target) -
+        starts_.begin() - 1;
+    setRun(run);
+    pbump(target - starts_[run]);
+    return target;
+  }
+
+ private:
+  // Adds runs for at least 'bytes' bytes.
+  void addAllocation(int64_t bytes) {
+    auto* allocation = &allocation_;
+    if (!runs_.empty()) {
+      extraAllocations_.push_back(
+          std::make_unique<memory::MappedMemory::Allocation>(memory_));
+      allocation = extraAllocations_.back().get();
+    }
+    if (!memory_->allocate(
+            bits::roundUp(bytes, memory::MappedMemory::kPageSize) /
+                memory::MappedMemory::kPageSize,
+            SerializedPage::kSerializedPageOwner,
+            *allocation)) {
+      VELOX_FAIL("Could not allocate memory for exchange output");
+    }
+    for (auto i = 0; i < allocation->numRuns(); ++i) {
+      auto run = allocation->runAt(i);
+      starts_.push_back(
+          runs_.empty() ? 0 : starts_.back() + runs_.back().size);
+      runs_.push_back(ByteRange{
+          run.data(),
+          static_cast<int32_t>(
+              run.numPages() * memory::MappedMemory::kPageSize),
+          0});
+    }
+  }
+
+  void setRun(int32_t index) {
+    current_ = index;
+    auto data = reinterpret_cast<char*>(runs_[index].buffer);
+    setp(data, data + runs_[index].size);
+  }
+
+  // Returns the offset of the next write from the start of the first
+  // run.
+  int64_t position() const {
+    return starts_[current_] + (pptr() - pbase());
+  }
+
+  memory::MappedMemory* const memory_;
+  memory::MappedMemory::Allocation& allocation_;
+  std::vector<std::unique_ptr<memory::MappedMemory::Allocation>>&
+      extraAllocations_;
+  std::vector<ByteRange> runs_;
+  // Offset of the start of each of 'runs_'.
+  std::vector<int64_t> starts_;
+  int32_t current_ = 0;
+  // Offset of the end of the written bytes.
+  int64_t size_ = 0;
+};
+} // namespace
+
+SerializedPage::SerializedPage(VectorStreamGroup* group)
+    : allocation_(group->mappedMemory()) {
+  // The arena of 'group' holds the serialized data except for the
+  // headers and tiny ranges.
+  AllocationStreamBuf buffer(
+      group->mappedMemory(),
+      allocation_,
+      extraAllocations_,
+      group->size() + memory::MappedMemory::kPageSize);
+  std::ostream out(&buffer);
+  group->flush(&out);
+  ranges_ = buffer.finish();
+}
+
+SerializedPage::SerializedPage(
+    std::shared_ptr<const SerializedPage> shared,
+    memory::MappedMemory* memory)
+    : allocation_(memory),
+      ranges_(shared->ranges_),
+      shared_(std::move(shared)) {}
+
+// static
+std::unique_ptr<SerializedPage> SerializedPage::fromVectorStreamGroup(
+    VectorStreamGroup* group) {
+  if (!group->isShared()) {
+    return std::make_unique<SerializedPage>(group);
+  }
+  auto shared = group->getOrMakeShared<SerializedPage>(
+      [group]() { return std::make_shared<SerializedPage>(group); });
+  return std::make_unique<SerializedPage>(
+      std::move(shared), group->mappedMemory());
+}
+
 void SerializedPage::prepareStreamForDeserialize(ByteStream* input) {
   input->resetInput(std::move(ranges_));
 }
@@ -87,7 +245,7 @@ class LocalExchangeSource : public ExchangeSource {
     return !pending;
   }
 
-  void request() override {
+  void request(int64_t maxBytes) override {
     auto buffers = PartitionedOutputBufferManager::getInstance().lock();
     VELOX_CHECK_NOT_NULL(buffers, "invalid PartitionedOutputBufferManager");
     VELOX_CHECK(requestPending_);
@@ -96,7 +254,7 @@ class LocalExchangeSource : public ExchangeSource {
     buffers->getData(
         taskId_,
         destination_,
-        kMaxBytes,
+        maxBytes,
         sequence_,
         // Since this lambda may outlive 'this', we need to capture a
         // shared_ptr to the current object (self).
@@ -114,6 +272,7 @@ class LocalExchangeSource : public ExchangeSource {
             sequence = requestedSequence;
           }
           std::vector<std::unique_ptr<SerializedPage>> pages;
+          int64_t numBytes = 0;
           bool atEnd = false;
           for (auto& group : data) {
             if (!group) {
@@ -122,12 +281,14 @@ class LocalExchangeSource : public ExchangeSource {
               continue;
             }
             pages.push_back(SerializedPage::fromVectorStreamGroup(group.get()));
+            numBytes += pages.back()->byteSize();
             group = nullptr;
           }
           int64_t ackSequence;
           {
             std::lock_guard<std::mutex> l(queue_->mutex());
             requestPending_ = false;
+            recordResponseLocked(pages.size(), numBytes);
             for (auto& page : pages) {
               queue_->enqueue(std::move(page));
             }
@@ -146,10 +307,20 @@ class LocalExchangeSource : public ExchangeSource {
         });
   }
 
-  void close() override {}
-
- private:
-  static constexpr uint64_t kMaxBytes = 32 * 1024 * 1024; // 32 MB
+  // Deletes the results not yet fetched, e.g. after a Limit in the
+  // consumer has enough rows.
+  void close() override {
+    {
+      std::lock_guard<std::mutex> l(queue_->mutex());
+      if (atEnd_) {
+        return;
+      }
+      atEnd_ = true;
+    }
+    if (auto buffers = PartitionedOutputBufferManager::getInstance().lock()) {
+      buffers->deleteResults(taskId_, destination_);
+    }
+  }
 };
 
 std::unique_ptr<ExchangeSource> createLocalExchangeSource(
@@ -165,8 +336,52 @@ std::unique_ptr<ExchangeSource> createLocalExchangeSource(
 
 } // namespace
 
+std::vector<std::pair<std::shared_ptr<ExchangeSource>, int64_t>>
+ExchangeClient::pickSourcesLocked() {
+  std::vector<std::pair<std::shared_ptr<ExchangeSource>, int64_t>> toRequest;
+  if (closed_) {
+    return toRequest;
+  }
+  int64_t pendingBytes = 0;
+  for (auto& source : sources_) {
+    pendingBytes += source->requestedBytes_;
+  }
+  auto available = maxQueuedBytes_ - queue_->totalBytes() - pendingBytes;
+  if (available <= 0 && (pendingBytes > 0 || !queue_->empty())) {
+    // Over budget. Pending responses or queued pages keep the consumers
+    // going.
+    return toRequest;
+  }
+  // The sources that had data last time first, in the order of addition.
+  std::vector<ExchangeSource*> candidates;
+  candidates.reserve(sources_.size());
+  for (auto& source : sources_) {
+    candidates.push_back(source.get());
+  }
+  std::stable_partition(
+      candidates.begin(), candidates.end(), [](ExchangeSource* source) {
+        return source->hadData_;
+      });
+  for (auto* source : candidates) {
+    if (!source->shouldRequestLocked()) {
+      continue;
+    }
+    auto maxBytes = std::min(
+        source->nextRequestBytes(),
+        std::max(available, ExchangeSource::kMinRequestBytes));
+    source->requestedBytes_ = maxBytes;
+    source->requestMicros_ = process::TraceRecorder::nowMicros();
+    toRequest.emplace_back(source->shared_from_this(), maxBytes);
+    available -= maxBytes;
+    if (available <= 0) {
+      break;
+    }
+  }
+  return toRequest;
+}
+
 void ExchangeClient::addRemoteTaskId(const std::string& taskId) {
-  std::shared_ptr<ExchangeSource> toRequest;
+  std::vector<std::pair<std::shared_ptr<ExchangeSource>, int64_t>> toRequest;
   {
     std::lock_guard<std::mutex> l(queue_->mutex());
     bool duplicate = !taskIds_.insert(taskId).second;
@@ -175,15 +390,21 @@ void ExchangeClient::addRemoteTaskId(const std::string& taskId) {
       // and the task updates have no guarantees of arriving in order.
       return;
     }
+    if (closed_) {
+      // Nobody reads the data.
+      return;
+    }
     auto source = ExchangeSource::create(taskId, destination_, queue_);
+    source->traceRecorder_ = traceRecorder_;
+    source->traceTrack_ = traceTrack_;
     sources_.push_back(source);
     queue_->addSource();
-    if (source->shouldRequestLocked()) {
-      toRequest = source;
-    }
+    toRequest = pickSourcesLocked();
   }
   // Outside of lock
-  toRequest->request();
+  for (auto& [source, maxBytes] : toRequest) {
+    source->request(maxBytes);
+  }
 }
 
 void ExchangeClient::noMoreRemoteTasks() {
@@ -194,30 +415,71 @@ void ExchangeClient::noMoreRemoteTasks() {
 std::unique_ptr<SerializedPage> ExchangeClient::next(
     bool* atEnd,
     ContinueFuture* future) {
-  std::vector<std::shared_ptr<ExchangeSource>> toRequest;
+  std::unique_ptr<SerializedPage> page;
+  std::vector<std::pair<std::shared_ptr<ExchangeSource>, int64_t>> toRequest;
   {
     std::lock_guard<std::mutex> l(queue_->mutex());
     *atEnd = false;
-    auto page = queue_->dequeue(atEnd, future);
-    if (*atEnd || page) {
+    page = queue_->dequeue(atEnd, future);
+    if (*atEnd) {
       return page;
     }
-    // There is no data to return, send out more requests.
-    for (auto& source : sources_) {
-      if (source->shouldRequestLocked()) {
-        toRequest.push_back(source);
-      }
+    if (page) {
+      REPORT_ADD_HISTOGRAM_VALUE(
+          kCounterExchangeQueueBytes, queue_->totalBytes());
+    }
+    // Send out more requests if there is no data to return or if the
+    // queue is below half of the budget, so that the next pages arrive
+    // before the queue runs out.
+    if (!page || queue_->totalBytes() < maxQueuedBytes_ / 2) {
+      toRequest = pickSourcesLocked();
     }
   }
 
   // Outside of lock
-  for (auto& source : toRequest) {
-    source->request();
+  for (auto& [source, maxBytes] : toRequest) {
+    source->request(maxBytes);
+  }
+  return page;
+}
+
+void ExchangeClient::addConsumer() {
+  std::lock_guard<std::mutex> l(queue_->mutex());
+  ++numConsumers_;
+}
+
+void ExchangeClient::consumerClosed() {
+  {
+    std::lock_guard<std::mutex> l(queue_->mutex());
+    VELOX_CHECK_GT(numConsumers_, 0);
+    if (--numConsumers_ > 0) {
+      return;
+    }
+  }
+  close();
+}
+
+void ExchangeClient::close() {
+  std::vector<std::shared_ptr<ExchangeSource>> sources;
+  {
+    std::lock_guard<std::mutex> l(queue_->mutex());
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+    queue_->closeLocked();
+    sources = sources_;
+  }
+  // Outside of lock.
+  for (auto& source : sources) {
+    source->close();
   }
-  return nullptr;
 }
 
 ExchangeClient::~ExchangeClient() {
+  if (closed_) {
+    return;
+  }
   for (auto& source : sources_) {
     source->close();
   }
@@ -300,6 +562,7 @@ RowVectorPtr Exchange::getOutput() {
         inputStream_ = std::make_unique<ByteStream>();
         stats_.rawInputBytes += currentPage_->byteSize();
         currentPage_->prepareStreamForDeserialize(inputStream_.get());
+        inputStream_->setInputOwner(currentPage_);
       }
 
       VectorStreamGroup::read(
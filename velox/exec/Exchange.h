@@ -16,6 +16,9 @@
 #pragma once
 
 #include <memory>
+#include "velox/common/base/Counters.h"
+#include "velox/common/base/StatsReporter.h"
+#include "velox/common/process/TraceRecorder.h"
 #include "velox/exec/Operator.h"
 
 namespace facebook::velox::exec {
@@ -32,27 +35,50 @@ class SerializedPage {
       uint64_t size,
       memory::MappedMemory* memory);
 
+  // Constructs from the serialized form of 'group'. 'group' is flushed
+  // directly into the memory of 'this' without an intermediate copy.
+  explicit SerializedPage(VectorStreamGroup* group);
+
+  // Constructs a page that reads the memory of 'shared'. 'memory' is
+  // the MappedMemory of 'shared'.
+  SerializedPage(
+      std::shared_ptr<const SerializedPage> shared,
+      memory::MappedMemory* memory);
+
   ~SerializedPage() = default;
 
   uint64_t byteSize() const {
-    return allocation_.byteSize();
+    if (shared_) {
+      return shared_->byteSize();
+    }
+    uint64_t size = allocation_.byteSize();
+    for (auto& allocation : extraAllocations_) {
+      size += allocation->byteSize();
+    }
+    return size;
   }
 
   // Makes 'input' ready for deserializing 'this' with
   // VectorStreamGroup::read().
   void prepareStreamForDeserialize(ByteStream* input);
 
+  // Returns a page with the serialized form of 'group'. If 'group' is
+  // shared by many consumers, the pages of all consumers share one
+  // copy of the serialized data, which stays alive as long as 'group'
+  // or any of the pages.
   static std::unique_ptr<SerializedPage> fromVectorStreamGroup(
-      VectorStreamGroup* group) {
-    std::stringstream out;
-    group->flush(&out);
-    return std::make_unique<SerializedPage>(
-        &out, out.tellp(), group->mappedMemory());
-  }
+      VectorStreamGroup* group);
 
  private:
   memory::MappedMemory::Allocation allocation_;
+  // Allocations added when a flushed VectorStreamGroup does not fit in
+  // 'allocation_'.
+  std::vector<std::unique_ptr<memory::MappedMemory::Allocation>>
+      extraAllocations_;
   std::vector<ByteRange> ranges_;
+  // The page whose memory 'ranges_' refer to when 'this' was made by
+  // sharing another page.
+  std::shared_ptr<const SerializedPage> shared_;
 };
 
 // Queue of results retrieved from source. Owned by shared_ptr by
@@ -73,12 +99,22 @@ class ExchangeQueue {
     return queue_.empty();
   }
 
+  // Returns the total byteSize() of the queued pages.
+  int64_t totalBytes() const {
+    return totalBytes_;
+  }
+
   void enqueue(std::unique_ptr<SerializedPage>&& page) {
+    if (closed_) {
+      // Late response after closeLocked().
+      return;
+    }
     if (!page) {
       ++numCompleted_;
       checkComplete();
       return;
     }
+    totalBytes_ += page->byteSize();
     queue_.push_back(std::move(page));
     if (!promises_.empty()) {
       // Resume one of the waiting drivers.
@@ -117,6 +153,7 @@ class ExchangeQueue {
     }
     auto page = std::move(queue_.front());
     queue_.pop_front();
+    totalBytes_ -= page->byteSize();
     *atEnd = false;
     return page;
   }
@@ -131,6 +168,15 @@ class ExchangeQueue {
     checkComplete();
   }
 
+  // Drops the queued pages and ends the queue when no consumer is left.
+  void closeLocked() {
+    closed_ = true;
+    queue_.clear();
+    totalBytes_ = 0;
+    atEnd_ = true;
+    clearAllPromises();
+  }
+
  private:
   void checkComplete() {
     if (noMoreSources_ && numCompleted_ == numSources_) {
@@ -150,8 +196,10 @@ class ExchangeQueue {
   int numSources_ = 0;
   bool noMoreSources_ = false;
   bool atEnd_ = false;
+  bool closed_ = false;
   std::mutex mutex_;
   std::deque<std::unique_ptr<SerializedPage>> queue_;
+  int64_t totalBytes_{0};
   std::vector<VeloxPromise<bool>> promises_;
   // When set, all promises will be realized and the next dequeue will
   // throw an exception with this message.
@@ -187,10 +235,11 @@ class ExchangeSource : public std::enable_shared_from_this<ExchangeSource> {
   // threads from issuing the same request.
   virtual bool shouldRequestLocked() = 0;
 
-  // Requests the producer to generate more data. Call only if shouldRequest()
-  // was true. The object handles its own lifetime by acquiring a
-  // shared_from_this() pointer if needed.
-  virtual void request() = 0;
+  // Requests the producer to generate more data, about 'maxBytes'
+  // worth. The producer returns at least one page if it has any. Call
+  // only if shouldRequest() was true. The object handles its own
+  // lifetime by acquiring a shared_from_this() pointer if needed.
+  virtual void request(int64_t maxBytes) = 0;
 
   // Close the exchange source. May be called before all data
   // has been received and proessed. This can happen in case
@@ -201,10 +250,45 @@ class ExchangeSource : public std::enable_shared_from_this<ExchangeSource> {
   virtual std::string toString() {
     std::stringstream out;
     out << "[ExchangeSource " << taskId_ << ":" << destination_
-        << (requestPending_ ? " pending " : "") << (atEnd_ ? " at end" : "");
+        << (requestPending_ ? " pending " : "") << (atEnd_ ? " at end" : "")
+        << " pages " << numPages_ << " bytes " << numBytes_;
     return out.str();
   }
 
+  // Records the response to the last request. Call while holding
+  // queue_->mutex().
+  void recordResponseLocked(int32_t numPages, int64_t numBytes) {
+    numPages_ += numPages;
+    numBytes_ += numBytes;
+    requestedBytes_ = 0;
+    hadData_ = numPages > 0;
+    const auto latencyMicros =
+        process::TraceRecorder::nowMicros() - requestMicros_;
+    REPORT_ADD_HISTOGRAM_VALUE(kCounterExchangeFetchLatencyUs, latencyMicros);
+    if (traceRecorder_) {
+      process::TraceEvent event;
+      event.name = "fetch";
+      event.category = "exchange";
+      event.track = traceTrack_;
+      event.startMicros = requestMicros_;
+      event.durationMicros = latencyMicros;
+      event.value = numBytes;
+      traceRecorder_->record(event);
+    }
+  }
+
+  // Returns the size for the next request. Asks for a few pages of the
+  // average size received so far.
+  int64_t nextRequestBytes() const {
+    if (numPages_ == 0) {
+      return kInitialRequestBytes;
+    }
+    return std::clamp<int64_t>(
+        kPagesPerRequest * (numBytes_ / numPages_),
+        kMinRequestBytes,
+        kMaxRequestBytes);
+  }
+
   static void registerFactory();
 
   static bool registerFactory(Factory factory) {
@@ -222,6 +306,23 @@ class ExchangeSource : public std::enable_shared_from_this<ExchangeSource> {
   std::shared_ptr<ExchangeQueue> queue_;
   bool requestPending_ = false;
   bool atEnd_ = false;
+  // Size of the pending request. 0 if no request is pending.
+  int64_t requestedBytes_ = 0;
+  // True if the last response had pages.
+  bool hadData_ = false;
+  // Number and total byteSize() of the pages received.
+  int64_t numPages_ = 0;
+  int64_t numBytes_ = 0;
+  // The time of the last request. Set by ExchangeClient.
+  uint64_t requestMicros_ = 0;
+  // Set if the latency of the requests is traced.
+  std::shared_ptr<process::TraceRecorder> traceRecorder_;
+  int32_t traceTrack_ = 0;
+
+  static constexpr int64_t kMinRequestBytes = 64 << 10;
+  static constexpr int64_t kInitialRequestBytes = 1 << 20;
+  static constexpr int64_t kMaxRequestBytes = 32 << 20;
+  static constexpr int32_t kPagesPerRequest = 4;
 };
 
 struct RemoteConnectorSplit : public connector::ConnectorSplit {
@@ -232,15 +333,31 @@ struct RemoteConnectorSplit : public connector::ConnectorSplit {
 };
 
 // Handle for a set of producers. This may be shared by multiple Exchanges, one
-// per consumer thread.
+// per consumer thread. The queued pages and the pending requests together
+// stay within 'maxQueuedBytes'. The sources whose last response had data
+// are requested first.
 class ExchangeClient {
  public:
-  explicit ExchangeClient(int destination)
-      : destination_(destination), queue_(std::make_shared<ExchangeQueue>()) {
+  static constexpr int64_t kDefaultMaxQueuedBytes = 32 << 20;
+
+  // If 'traceRecorder' is set, the latency of each request to a source is
+  // recorded on a track of the client.
+  explicit ExchangeClient(
+      int destination,
+      int64_t maxQueuedBytes = kDefaultMaxQueuedBytes,
+      std::shared_ptr<process::TraceRecorder> traceRecorder = nullptr)
+      : destination_(destination),
+        maxQueuedBytes_(maxQueuedBytes),
+        queue_(std::make_shared<ExchangeQueue>()),
+        traceRecorder_(std::move(traceRecorder)) {
     VELOX_CHECK(
         destination >= 0,
         "Exchange client destination must be greater than zero, got {}",
         destination);
+    if (traceRecorder_) {
+      traceTrack_ = traceRecorder_->addTrack(
+          fmt::format("exchange client {}", destination));
+    }
   }
 
   ~ExchangeClient();
@@ -255,13 +372,41 @@ class ExchangeClient {
 
   std::unique_ptr<SerializedPage> next(bool* atEnd, ContinueFuture* future);
 
+  // Registers an Exchange reading from 'this'. Call before any
+  // consumerClosed().
+  void addConsumer();
+
+  // Called by an Exchange that will not read any more. When the last
+  // one is closed, e.g. because a Limit downstream has enough rows,
+  // drops the queued pages and closes the sources so that the producers
+  // stop sending data.
+  void consumerClosed();
+
+  // Drops the queued pages, realizes the futures of waiting consumers
+  // and closes the sources, so that pending requests are abandoned and
+  // no new ones are sent. Called when the task is terminated. The
+  // consumers see the end of data when they run next.
+  void close();
+
   std::string toString();
 
  private:
+  // Returns the sources to request with the size of each request. Call
+  // while holding queue_->mutex() and call request() on the result
+  // after releasing it.
+  std::vector<std::pair<std::shared_ptr<ExchangeSource>, int64_t>>
+  pickSourcesLocked();
+
   const int destination_;
+  const int64_t maxQueuedBytes_;
   std::shared_ptr<ExchangeQueue> queue_;
   std::unordered_set<std::string> taskIds_;
   std::vector<std::shared_ptr<ExchangeSource>> sources_;
+  int32_t numConsumers_ = 0;
+  // True after the last consumer is closed. No more requests are sent.
+  bool closed_ = false;
+  const std::shared_ptr<process::TraceRecorder> traceRecorder_;
+  int32_t traceTrack_ = 0;
 };
 
 class Exchange : public SourceOperator {
@@ -279,7 +424,9 @@ class Exchange : public SourceOperator {
             "Exchange"),
         planNodeId_(exchangeNode->id()),
         future_(false),
-        exchangeClient_(std::move(exchangeClient)) {}
+        exchangeClient_(std::move(exchangeClient)) {
+    exchangeClient_->addConsumer();
+  }
 
   ~Exchange() override {
     close();
@@ -292,7 +439,10 @@ class Exchange : public SourceOperator {
   void close() override {
     currentPage_ = nullptr;
     result_ = nullptr;
-    exchangeClient_ = nullptr;
+    if (exchangeClient_) {
+      exchangeClient_->consumerClosed();
+      exchangeClient_ = nullptr;
+    }
   }
 
   BlockingReason isBlocked(ContinueFuture* future) override;
@@ -306,7 +456,9 @@ class Exchange : public SourceOperator {
   ContinueFuture future_;
   RowVectorPtr result_;
   std::shared_ptr<ExchangeClient> exchangeClient_;
-  std::unique_ptr<SerializedPage> currentPage_;
+  // Shared with the vectors deserialized from it that reference its memory
+  // in place.
+  std::shared_ptr<SerializedPage> currentPage_;
   std::unique_ptr<ByteStream> inputStream_;
   bool atEnd_ = false;
   size_t numSplits_{0}; // Number of splits we took to process so far.
@@ -15,6 +15,7 @@
  */
 #include "velox/exec/FilterProject.h"
 #include "velox/core/Expressions.h"
+#include "velox/expression/ControlExpr.h"
 #include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
@@ -72,6 +73,22 @@ FilterProject::FilterProject(
   }
   numExprs_ = allExprs.size();
   exprs_ = makeExprSetFromFlag(std::move(allExprs), operatorCtx_->execCtx());
+  trackExprStats_ = operatorCtx_->execCtx()->queryCtx()->exprTrackStats();
+
+  if (project) {
+    auto inputType = project->sources()[0]->outputType();
+    std::unordered_set<std::string> usedFields;
+    for (auto& projection : identityProjections_) {
+      usedFields.insert(inputType->nameOf(projection.inputChannel));
+    }
+    for (auto i = hasFilter_ ? 1 : 0; i < numExprs_; ++i) {
+      for (auto* field : exprs_->exprs()[i]->distinctFields()) {
+        if (!usedFields.insert(field->field()).second) {
+          projectionsShareFields_ = true;
+        }
+      }
+    }
+  }
 }
 
 void FilterProject::addInput(RowVectorPtr input) {
@@ -122,6 +139,7 @@ RowVectorPtr FilterProject::getOutput() {
     numProcessedInputRows_ = size;
     VELOX_CHECK(!isIdentityProjection_);
     project(*rows, &evalCtx);
+    recordExprStats();
 
     if (results_.size() > 0) {
       auto outCol = results_[0];
@@ -141,6 +159,7 @@ RowVectorPtr FilterProject::getOutput() {
   auto numOut = filter(&evalCtx, *rows);
   numProcessedInputRows_ = size;
   if (numOut == 0) { // no rows passed the filer
+    recordExprStats();
     inputProcessed();
     return nullptr;
   }
@@ -154,6 +173,7 @@ RowVectorPtr FilterProject::getOutput() {
     }
     project(*rows, &evalCtx);
   }
+  recordExprStats();
 
   return fillOutput(
       numOut, allRowsSelected ? nullptr : filterEvalCtx_.selectedIndices);
@@ -177,19 +197,49 @@ void FilterProject::clearNonReusableOutput() {
   }
 }
 
+void FilterProject::recordExprStats() {
+  auto numHits = exprs_->numSharedSubexprHits();
+  if (numHits > numRecordedSharedSubexprHits_) {
+    stats_.addRuntimeStat(
+        "sharedSubexprHits", numHits - numRecordedSharedSubexprHits_);
+    numRecordedSharedSubexprHits_ = numHits;
+  }
+  auto numMemoHits = exprs_->numMemoHits();
+  if (numMemoHits > numRecordedMemoHits_) {
+    stats_.addRuntimeStat("memoHits", numMemoHits - numRecordedMemoHits_);
+    numRecordedMemoHits_ = numMemoHits;
+  }
+  if (!trackExprStats_) {
+    return;
+  }
+  for (auto& [name, exprStats] : exprs_->takeStats()) {
+    auto prefix = fmt::format("expr.{}.", name);
+    stats_.addRuntimeStat(prefix + "cpuNanos", exprStats.timing.cpuNanos);
+    stats_.addRuntimeStat(prefix + "wallNanos", exprStats.timing.wallNanos);
+    stats_.addRuntimeStat(prefix + "numCalls", exprStats.timing.count);
+    stats_.addRuntimeStat(prefix + "numRows", exprStats.numProcessedRows);
+    stats_.addRuntimeStat(prefix + "nullFastPath", exprStats.numNullFastPath);
+    stats_.addRuntimeStat(prefix + "peeled", exprStats.numPeeled);
+    stats_.addRuntimeStat(prefix + "memoHits", exprStats.numMemoHits);
+  }
+}
+
 void FilterProject::project(const SelectivityVector& rows, EvalCtx* evalCtx) {
-  // Make sure LazyVectors are loaded for all the "rows".
+  // Make sure LazyVectors are loaded for all the "rows" if more than one
+  // projection uses them.
   //
   // Consider projection with 2 expressions: f(a) AND g(b), h(b)
   // If b is a LazyVector and f(a) AND g(b) expression is evaluated first, it
   // will load b only for rows where f(a) is true. However, h(b) projection
   // needs all rows for "b".
   //
-  // This works, but may load more rows than necessary. E.g. if we only have
-  // f(a) AND g(b) expression and b is not used anywhere else, it is sufficient
-  // to load b for a subset of rows where f(a) is true.
-  *evalCtx->mutableIsFinalSelection() = false;
-  *evalCtx->mutableFinalSelection() = &rows;
+  // If we only have f(a) AND g(b) expression and b is not used anywhere
+  // else, 'rows' is the final selection and b is loaded for the subset of
+  // rows where f(a) is true.
+  if (projectionsShareFields_) {
+    *evalCtx->mutableIsFinalSelection() = false;
+    *evalCtx->mutableFinalSelection() = &rows;
+  }
 
   exprs_->eval(
       hasFilter_ ? 1 : 0, numExprs_, !hasFilter_, rows, evalCtx, &results_);
@@ -77,13 +77,32 @@ class FilterProject : public Operator {
   // pre-condition: !isIdentityProjection_
   void project(const SelectivityVector& rows, EvalCtx* evalCtx);
 
+  // Adds the number of reuses of shared subexpression values and of
+  // memoized dictionary results since the previous call to the
+  // 'sharedSubexprHits' and 'memoHits' runtime stats. Adds the per
+  // function stats of 'exprs_' if 'trackExprStats_' is true.
+  void recordExprStats();
+
   // If true exprs_[0] is a filter and the other expressions are projections
   const bool hasFilter_{false};
   std::unique_ptr<ExprSet> exprs_;
   int32_t numExprs_;
 
+  // True if an input column is used by more than one projection,
+  // including identity projections. Otherwise each LazyVector input
+  // is loaded only for the rows its projection needs.
+  bool projectionsShareFields_{false};
+
   FilterEvalCtx filterEvalCtx_;
 
   vector_size_t numProcessedInputRows_{0};
+
+  // Values of exprs_->numSharedSubexprHits() and numMemoHits() at the
+  // last recordExprStats().
+  int64_t numRecordedSharedSubexprHits_{0};
+  int64_t numRecordedMemoHits_{0};
+
+  // True if QueryCtx::exprTrackStats() is set.
+  bool trackExprStats_{false};
 };
 } // namespace facebook::velox::exec
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/FragmentResultCache.h"
+#include "velox/common/caching/FileIds.h"
+#include "velox/vector/VectorStream.h"
+
+namespace facebook::velox::exec {
+
+bool FragmentResultCache::startSplit(
+    const connector::ConnectorSplit& split,
+    memory::MemoryPool* pool) {
+  ++splitSequence_;
+  auto key = split.cacheKey();
+  if (key.empty()) {
+    splitKey_.clear();
+    return false;
+  }
+  splitKey_ = fmt::format("{}\n{}:{}", fingerprint_, split.connectorId, key);
+  if (get(splitKey_, pool)) {
+    splitKey_.clear();
+    return true;
+  }
+  return false;
+}
+
+RowVectorPtr FragmentResultCache::nextCachedResult() {
+  if (cachedResults_.empty()) {
+    return nullptr;
+  }
+  auto result = std::move(cachedResults_.front());
+  cachedResults_.pop_front();
+  return result;
+}
+
+bool FragmentResultCache::get(
+    const std::string& key,
+    memory::MemoryPool* pool) {
+  StringIdLease id(fileIds(), key);
+  cache::CachePin pin;
+  try {
+    pin = cache_->findOrCreate(cache::RawFileCacheKey{id.id(), 0}, 1);
+  } catch (const VeloxRuntimeError& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+    return false;
+  }
+  // An empty pin means that another Driver is storing the entry. An
+  // exclusive pin is a new entry, which is dropped on unpin.
+  if (pin.empty() || pin.entry()->isExclusive()) {
+    return false;
+  }
+  auto* entry = pin.entry();
+  std::vector<ByteRange> ranges;
+  if (entry->tinyData()) {
+    ranges.push_back(
+        {reinterpret_cast<uint8_t*>(entry->tinyData()), entry->size(), 0});
+  } else {
+    auto& allocation = entry->data();
+    int32_t remaining = entry->size();
+    for (auto i = 0; i < allocation.numRuns() && remaining > 0; ++i) {
+      auto run = allocation.runAt(i);
+      int32_t size = std::min<int64_t>(run.numBytes(), remaining);
+      ranges.push_back({run.data<uint8_t>(), size, 0});
+      remaining -= size;
+    }
+  }
+  // The deserialized vectors own their data, so 'pin' can be released
+  // after reading.
+  ByteStream stream;
+  stream.resetInput(std::move(ranges));
+  while (!stream.atEnd()) {
+    RowVectorPtr result;
+    VectorStreamGroup::read(&stream, pool, resultType_, &result);
+    cachedResults_.push_back(std::move(result));
+  }
+  return true;
+}
+
+void FragmentResultCache::put(
+    const std::string& key,
+    const std::string& data) {
+  if (data.empty() || data.size() > kMaxEntryBytes) {
+    return;
+  }
+  StringIdLease id(fileIds(), key);
+  cache::CachePin pin;
+  try {
+    pin = cache_->findOrCreate(
+        cache::RawFileCacheKey{id.id(), 0}, data.size());
+  } catch (const VeloxRuntimeError& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+    return;
+  }
+  if (pin.empty() || !pin.entry()->isExclusive()) {
+    return;
+  }
+  auto* entry = pin.entry();
+  if (entry->tinyData()) {
+    memcpy(entry->tinyData(), data.data(), data.size());
+  } else {
+    auto& allocation = entry->data();
+    uint64_t offset = 0;
+    for (auto i = 0; i < allocation.numRuns() && offset < data.size(); ++i) {
+      auto run = allocation.runAt(i);
+      auto size = std::min<uint64_t>(run.numBytes(), data.size() - offset);
+      memcpy(run.data<char>(), data.data() + offset, size);
+      offset += size;
+    }
+  }
+  entry->setValid(true);
+  entry->setExclusiveToShared();
+}
+
+// static
+void FragmentResultCache::serialize(
+    const RowVectorPtr& result,
+    memory::MappedMemory* mappedMemory,
+    std::string& data) {
+  VectorStreamGroup group(mappedMemory);
+  group.createStreamTree(asRowType(result->type()), result->size());
+  IndexRange range{0, result->size()};
+  group.append(result, folly::Range<const IndexRange*>(&range, 1));
+  std::ostringstream out;
+  group.flush(&out);
+  data += out.str();
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include "velox/common/caching/AsyncDataCache.h"
+#include "velox/connectors/Connector.h"
+#include "velox/core/PlanNode.h"
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::exec {
+
+// Keeps the result of a plan fragment for each split in the
+// AsyncDataCache, so that repeated queries, e.g. dashboards, do not
+// read and aggregate the same files again. The fragment is a
+// TableScan followed by filters and projections and a partial
+// aggregation. One instance is shared by the TableScan and the
+// HashAggregation of a Driver. The TableScan looks up each split it
+// takes and skips the splits whose result is cached. The
+// HashAggregation returns the cached results and stores the result
+// of the splits it aggregates itself. The results are kept in the
+// wire format of the registered VectorSerde, in memory only.
+class FragmentResultCache {
+ public:
+  // A split whose serialized result is larger than this is not cached.
+  static constexpr uint64_t kMaxEntryBytes = 8 << 20;
+
+  // 'planNodeId' is the id of the aggregation. 'fingerprint'
+  // identifies the fragment, e.g. the aggregation printed with details
+  // and sources. 'resultType' is the output type of the aggregation.
+  FragmentResultCache(
+      cache::AsyncDataCache* cache,
+      core::PlanNodeId planNodeId,
+      std::string fingerprint,
+      RowTypePtr resultType)
+      : cache_(cache),
+        planNodeId_(std::move(planNodeId)),
+        fingerprint_(std::move(fingerprint)),
+        resultType_(std::move(resultType)) {}
+
+  const core::PlanNodeId& planNodeId() const {
+    return planNodeId_;
+  }
+
+  // Called by the TableScan when it takes 'split'. Returns true if the
+  // result for 'split' is cached. The result is then returned by
+  // nextCachedResult() and the split is not read.
+  bool startSplit(
+      const connector::ConnectorSplit& split,
+      memory::MemoryPool* pool);
+
+  // Incremented by each startSplit(). Tells the aggregation that its
+  // input comes from a different split.
+  int64_t splitSequence() const {
+    return splitSequence_;
+  }
+
+  // Cache key of the split being read. Empty if the split is not
+  // cacheable.
+  const std::string& splitKey() const {
+    return splitKey_;
+  }
+
+  bool hasCachedResults() const {
+    return !cachedResults_.empty();
+  }
+
+  // Returns the next batch of the cached results or nullptr if none.
+  RowVectorPtr nextCachedResult();
+
+  // Stores 'data', made by serialize(), under 'key'. Does nothing if
+  // 'key' is already cached or there is no space in the cache.
+  void put(const std::string& key, const std::string& data);
+
+  // Appends 'result' in wire format to 'data'.
+  static void serialize(
+      const RowVectorPtr& result,
+      memory::MappedMemory* mappedMemory,
+      std::string& data);
+
+ private:
+  // Appends the batches cached under 'key' to 'cachedResults_'. Returns
+  // false if 'key' is not cached.
+  bool get(const std::string& key, memory::MemoryPool* pool);
+
+  cache::AsyncDataCache* const cache_;
+  const core::PlanNodeId planNodeId_;
+  const std::string fingerprint_;
+  const RowTypePtr resultType_;
+  int64_t splitSequence_{0};
+  std::string splitKey_;
+  std::deque<RowVectorPtr> cachedResults_;
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/GroupId.h"
+
+namespace facebook::velox::exec {
+
+GroupId::GroupId(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::GroupIdNode>& groupIdNode)
+    : Operator(
+          driverCtx,
+          groupIdNode->outputType(),
+          operatorId,
+          groupIdNode->id(),
+          "GroupId") {
+  const auto& inputType = groupIdNode->sources()[0]->outputType();
+  const auto& groupingKeys = groupIdNode->groupingKeys();
+
+  for (const auto& groupingSet : groupIdNode->groupingSets()) {
+    std::vector<ChannelIndex> mapping(groupingKeys.size(), kConstantChannel);
+    for (const auto& key : groupingSet) {
+      auto it = std::find_if(
+          groupingKeys.begin(), groupingKeys.end(), [&](const auto& other) {
+            return other->name() == key->name();
+          });
+      mapping[it - groupingKeys.begin()] =
+          inputType->getChildIdx(key->name());
+    }
+    groupingKeyMappings_.push_back(std::move(mapping));
+  }
+
+  for (const auto& input : groupIdNode->aggregationInputs()) {
+    aggregationInputs_.push_back(inputType->getChildIdx(input->name()));
+  }
+}
+
+void GroupId::addInput(RowVectorPtr input) {
+  input_ = std::move(input);
+  groupingSetIndex_ = 0;
+}
+
+RowVectorPtr GroupId::getOutput() {
+  if (!input_) {
+    return nullptr;
+  }
+
+  auto numInput = input_->size();
+  const auto& mapping = groupingKeyMappings_[groupingSetIndex_];
+
+  std::vector<VectorPtr> outputs;
+  outputs.reserve(outputType_->size());
+  for (auto i = 0; i < mapping.size(); ++i) {
+    if (mapping[i] == kConstantChannel) {
+      outputs.push_back(BaseVector::createNullConstant(
+          outputType_->childAt(i), numInput, pool()));
+    } else {
+      outputs.push_back(input_->childAt(mapping[i]));
+    }
+  }
+  for (auto channel : aggregationInputs_) {
+    outputs.push_back(input_->childAt(channel));
+  }
+  outputs.push_back(BaseVector::createConstant(
+      variant::create<TypeKind::BIGINT>(groupingSetIndex_), numInput, pool()));
+
+  auto output = std::make_shared<RowVector>(
+      pool(), outputType_, BufferPtr(nullptr), numInput, std::move(outputs));
+
+  if (++groupingSetIndex_ == groupingKeyMappings_.size()) {
+    input_ = nullptr;
+  }
+  return output;
+}
+} // namespace facebook::velox::exec
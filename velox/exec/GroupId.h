@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+/// Produces one output batch per grouping set for each input batch. The
+/// batches share the input vectors. The grouping keys outside of the
+/// grouping set are constant nulls and the group id is a constant.
+class GroupId : public Operator {
+ public:
+  GroupId(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::GroupIdNode>& groupIdNode);
+
+  BlockingReason isBlocked(ContinueFuture* /*future*/) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  bool needsInput() const override {
+    return input_ == nullptr;
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+ private:
+  // For each grouping set, the input channel of each grouping key output, or
+  // kConstantChannel if the key is not in the set.
+  std::vector<std::vector<ChannelIndex>> groupingKeyMappings_;
+
+  // Input channels of the aggregation inputs.
+  std::vector<ChannelIndex> aggregationInputs_;
+
+  // Index of the grouping set to produce next for 'input_'.
+  int32_t groupingSetIndex_{0};
+};
+} // namespace facebook::velox::exec
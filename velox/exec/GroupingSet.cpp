@@ -49,6 +49,7 @@ GroupingSet::GroupingSet(
     std::vector<std::optional<ChannelIndex>>&& aggrMaskChannels,
     std::vector<std::vector<ChannelIndex>>&& channelLists,
     std::vector<std::vector<VectorPtr>>&& constantLists,
+    std::vector<bool>&& aggregateDistincts,
     bool ignoreNullKeys,
     bool isRawInput,
     OperatorCtx* operatorCtx)
@@ -62,10 +63,12 @@ GroupingSet::GroupingSet(
       ignoreNullKeys_(ignoreNullKeys),
       driverCtx_(operatorCtx->driverCtx()),
       mappedMemory_(operatorCtx->mappedMemory()),
+      pool_(operatorCtx->pool()),
       stringAllocator_(mappedMemory_),
       rows_(mappedMemory_),
       isAdaptive_(operatorCtx->task()->queryCtx()->hashAdaptivityEnabled()) {
   for (auto& hasher : hashers_) {
+    spillKeyChannels_.push_back(keyChannels_.size());
     keyChannels_.push_back(hasher->channel());
   }
   std::unordered_map<ChannelIndex, int> channelUseCount;
@@ -77,6 +80,22 @@ GroupingSet::GroupingSet(
   for (const std::vector<ChannelIndex>& argList : channelLists_) {
     mayPushdown_.push_back(allAreSinglyReferenced(argList, channelUseCount));
   }
+  distinctSets_.resize(aggregates_.size());
+  for (auto i = 0; i < aggregateDistincts.size(); ++i) {
+    if (!aggregateDistincts[i]) {
+      continue;
+    }
+    VELOX_CHECK(isRawInput_, "Distinct aggregates require raw input");
+    auto distinct = std::make_unique<DistinctSet>();
+    distinct->keyChannels = keyChannels_;
+    distinct->keyChannels.insert(
+        distinct->keyChannels.end(),
+        channelLists_[i].begin(),
+        channelLists_[i].end());
+    distinctSets_[i] = std::move(distinct);
+    // The distinct set loads the arguments.
+    mayPushdown_[i] = false;
+  }
 }
 
 void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
@@ -92,7 +111,8 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
     numAdded_ += numRows;
     for (auto i = 0; i < aggregates_.size(); ++i) {
       populateTempVectors(i, input);
-      const SelectivityVector& rows = getSelectivityVector(i);
+      const SelectivityVector& rows =
+          getDistinctRows(i, *input, getSelectivityVector(i));
       const bool canPushdown =
           mayPushdown && mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
       if (isRawInput_) {
@@ -107,6 +127,31 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
     return;
   }
 
+  probeGroups(*input, keyChannels_);
+  prepareMaskedSelectivityVectors(input);
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    const SelectivityVector& rows =
+        getDistinctRows(i, *input, getSelectivityVector(i));
+    // Aggregates map the groups to the selected 'rows' before pushdown, so
+    // masked and distinct rows can be pushed down too.
+    const bool canPushdown =
+        mayPushdown && mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
+    populateTempVectors(i, input);
+    if (isRawInput_) {
+      aggregates_[i]->addRawInput(
+          lookup_->hits.data(), rows, tempVectors_, canPushdown);
+    } else {
+      aggregates_[i]->addIntermediateResults(
+          lookup_->hits.data(), rows, tempVectors_, canPushdown);
+    }
+  }
+  tempVectors_.clear();
+}
+
+void GroupingSet::probeGroups(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& keyChannels) {
+  auto numRows = input.size();
   bool rehash = false;
   if (!table_) {
     rehash = true;
@@ -118,70 +163,61 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
           std::move(hashers_), aggregates_, mappedMemory_);
     }
     lookup_ = std::make_unique<HashLookup>(table_->hashers());
+    table_->setDistinctEstimate(numGroupsEstimate_);
     if (!isAdaptive_ && table_->hashMode() != BaseHashTable::HashMode::kHash) {
       table_->forceGenericHashMode();
     }
   }
   auto& hashers = lookup_->hashers;
-  lookup_->reset(numRows);
-  auto mode = table_->hashMode();
-  if (ignoreNullKeys_) {
-    // A null in any of the keys disables the row.
-    deselectRowsWithNulls(*input, keyChannels_, activeRows_);
-    for (int32_t i = 0; i < hashers.size(); ++i) {
-      auto key = input->loadedChildAt(hashers[i]->channel());
-      if (mode != BaseHashTable::HashMode::kHash) {
-        if (!hashers[i]->computeValueIds(*key, activeRows_, &lookup_->hashes)) {
-          rehash = true;
-        }
-      } else {
-        hashers[i]->hash(*key, activeRows_, i > 0, &lookup_->hashes);
-      }
+  for (;;) {
+    activeRows_.resize(numRows);
+    activeRows_.setAll();
+    lookup_->reset(numRows);
+    auto mode = table_->hashMode();
+    if (ignoreNullKeys_) {
+      // A null in any of the keys disables the row.
+      deselectRowsWithNulls(input, keyChannels, activeRows_);
     }
-    lookup_->rows.clear();
-    bits::forEachSetBit(
-        activeRows_.asRange().bits(),
-        0,
-        activeRows_.size(),
-        [&](vector_size_t row) { lookup_->rows.push_back(row); });
-  } else {
     for (int32_t i = 0; i < hashers.size(); ++i) {
-      auto key = input->loadedChildAt(hashers[i]->channel());
+      auto key = input.loadedChildAt(keyChannels[i]);
       if (mode != BaseHashTable::HashMode::kHash) {
-        if (!hashers[i]->computeValueIds(*key, activeRows_, &lookup_->hashes)) {
+        if (!hashers[i]->computeValueIds(
+                *key, activeRows_, table_->valueIdsFor(*lookup_, i))) {
           rehash = true;
         }
       } else {
         hashers[i]->hash(*key, activeRows_, i > 0, &lookup_->hashes);
       }
     }
-    std::iota(lookup_->rows.begin(), lookup_->rows.end(), 0);
-  }
-  if (rehash) {
+    if (ignoreNullKeys_) {
+      lookup_->rows.clear();
+      bits::forEachSetBit(
+          activeRows_.asRange().bits(),
+          0,
+          activeRows_.size(),
+          [&](vector_size_t row) { lookup_->rows.push_back(row); });
+    } else {
+      std::iota(lookup_->rows.begin(), lookup_->rows.end(), 0);
+    }
+    if (!rehash) {
+      break;
+    }
     if (table_->hashMode() != BaseHashTable::HashMode::kHash) {
-      table_->decideHashMode(input->size());
+      table_->decideHashMode(input.size());
     }
-    addInput(input, mayPushdown);
-    return;
+    rehash = false;
   }
   numAdded_ += lookup_->rows.size();
   table_->groupProbe(*lookup_);
-  prepareMaskedSelectivityVectors(input);
+}
+
+void GroupingSet::addSpilledInput(const RowVectorPtr& input) {
+  probeGroups(*input, spillKeyChannels_);
+  auto numKeys = spillKeyChannels_.size();
   for (auto i = 0; i < aggregates_.size(); ++i) {
-    const SelectivityVector& rows = getSelectivityVector(i);
-    // TODO(spershin): We disable the pushdown at the moment if selectivity
-    // vector has changed after groups generation, we might want to revisit
-    // this.
-    const bool canPushdown = (&rows != &activeRows_) && mayPushdown &&
-        mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
-    populateTempVectors(i, input);
-    if (isRawInput_) {
-      aggregates_[i]->addRawInput(
-          lookup_->hits.data(), rows, tempVectors_, canPushdown);
-    } else {
-      aggregates_[i]->addIntermediateResults(
-          lookup_->hits.data(), rows, tempVectors_, canPushdown);
-    }
+    tempVectors_ = {input->childAt(numKeys + i)};
+    aggregates_[i]->addIntermediateResults(
+        lookup_->hits.data(), activeRows_, tempVectors_, false);
   }
   tempVectors_.clear();
 }
@@ -280,6 +316,73 @@ const SelectivityVector& GroupingSet::getSelectivityVector(
   return it->second.rows;
 }
 
+const SelectivityVector& GroupingSet::getDistinctRows(
+    size_t aggregateIndex,
+    const RowVector& input,
+    const SelectivityVector& rows) {
+  auto& distinct = distinctSets_[aggregateIndex];
+  if (!distinct) {
+    return rows;
+  }
+  bool rehash = false;
+  if (!distinct->table) {
+    rehash = true;
+    std::vector<std::unique_ptr<VectorHasher>> hashers;
+    for (auto channel : distinct->keyChannels) {
+      hashers.push_back(
+          VectorHasher::create(input.childAt(channel)->type(), channel));
+    }
+    static const std::vector<std::unique_ptr<Aggregate>> kNoAggregates;
+    distinct->table = HashTable<false>::createForAggregation(
+        std::move(hashers), kNoAggregates, mappedMemory_);
+    distinct->lookup =
+        std::make_unique<HashLookup>(distinct->table->hashers());
+    if (!isAdaptive_ &&
+        distinct->table->hashMode() != BaseHashTable::HashMode::kHash) {
+      distinct->table->forceGenericHashMode();
+    }
+  }
+  auto& table = *distinct->table;
+  auto& lookup = *distinct->lookup;
+  auto& hashers = lookup.hashers;
+  auto numRows = input.size();
+  for (;;) {
+    lookup.reset(numRows);
+    auto mode = table.hashMode();
+    for (int32_t i = 0; i < hashers.size(); ++i) {
+      auto key = input.loadedChildAt(distinct->keyChannels[i]);
+      if (mode != BaseHashTable::HashMode::kHash) {
+        if (!hashers[i]->computeValueIds(
+                *key, rows, table.valueIdsFor(lookup, i))) {
+          rehash = true;
+        }
+      } else {
+        hashers[i]->hash(*key, rows, i > 0, &lookup.hashes);
+      }
+    }
+    if (!rehash) {
+      break;
+    }
+    if (table.hashMode() != BaseHashTable::HashMode::kHash) {
+      table.decideHashMode(numRows);
+    }
+    rehash = false;
+  }
+  lookup.rows.clear();
+  rows.applyToSelected([&](vector_size_t row) { lookup.rows.push_back(row); });
+  table.groupProbe(lookup);
+
+  // Only the first row of each new combination starts a group.
+  auto& newRows = distinct->newRows;
+  newRows.resize(numRows);
+  newRows.clearAll();
+  for (auto row : lookup.newGroups) {
+    newRows.setValid(row, true);
+  }
+  newRows.updateBounds();
+  return newRows;
+}
+
 bool GroupingSet::getOutput(
     int32_t batchSize,
     bool isPartial,
@@ -309,6 +412,10 @@ bool GroupingSet::getOutput(
     return true;
   }
 
+  if (hasSpilled()) {
+    return getOutputFromSpill(batchSize, isPartial, iterator, result);
+  }
+
   // @lint-ignore CLANGTIDY
   char* groups[batchSize];
   int32_t numGroups =
@@ -316,6 +423,15 @@ bool GroupingSet::getOutput(
   if (!numGroups) {
     return false;
   }
+  extractGroups(groups, numGroups, isPartial, result);
+  return true;
+}
+
+void GroupingSet::extractGroups(
+    char** groups,
+    int32_t numGroups,
+    bool isPartial,
+    RowVectorPtr& result) {
   result->resize(numGroups);
   auto totalKeys = lookup_->hashers.size();
   for (int32_t i = 0; i < totalKeys; ++i) {
@@ -331,21 +447,183 @@ bool GroupingSet::getOutput(
       aggregates_[i]->extractValues(groups, numGroups, &aggregateVector);
     }
   }
-  return true;
 }
 
-void GroupingSet::resetPartial() {
+void GroupingSet::spill() {
+  VELOX_CHECK(spill_, "Spilling is not enabled for this grouping set");
+  if (!table_ || table_->rows()->numRows() == 0) {
+    return;
+  }
+  auto rows = table_->rows();
+  auto numKeys = spillKeyChannels_.size();
+  auto numPartitions = spill_->maxPartitions();
+
+  // Assign each group to a partition by the hash of its keys. Groups
+  // with equal keys in different spill rounds land in the same
+  // partition and are combined when the partition is read back.
+  std::vector<char*> groups(rows->numRows());
+  RowContainerIterator iterator;
+  groups.resize(rows->listRows(&iterator, groups.size(), groups.data()));
+  std::vector<uint64_t> hashes(groups.size());
+  for (auto i = 0; i < numKeys; ++i) {
+    rows->hash(
+        i,
+        folly::Range<char**>(groups.data(), groups.size()),
+        i > 0,
+        hashes.data());
+  }
+  std::vector<std::vector<char*>> partitions(numPartitions);
+  for (auto i = 0; i < groups.size(); ++i) {
+    // The low bits of the hash select the hash table bucket. Use the
+    // high bits for the partition.
+    partitions[(hashes[i] >> 32) % numPartitions].push_back(groups[i]);
+  }
+
+  auto& type = spill_->type();
+  auto batchSize = rows->estimatedNumRowsPerBatch(kSpillBatchBytes);
+  for (auto partition = 0; partition < numPartitions; ++partition) {
+    auto& partitionGroups = partitions[partition];
+    for (auto i = 0; i < partitionGroups.size(); i += batchSize) {
+      int32_t numGroups = std::min<int32_t>(
+          batchSize, partitionGroups.size() - i);
+      auto groupsInBatch = partitionGroups.data() + i;
+      auto batch = std::static_pointer_cast<RowVector>(
+          BaseVector::create(type, numGroups, pool_));
+      for (auto key = 0; key < numKeys; ++key) {
+        rows->extractColumn(
+            groupsInBatch, numGroups, key, batch->childAt(key));
+      }
+      for (auto j = 0; j < aggregates_.size(); ++j) {
+        aggregates_[j]->finalize(groupsInBatch, numGroups);
+        aggregates_[j]->extractAccumulators(
+            groupsInBatch, numGroups, &batch->childAt(numKeys + j));
+      }
+      spill_->appendToPartition(partition, batch);
+    }
+  }
+  clearGroups();
+  // The table is sized for the groups that were spilled. Free it, so
+  // that spilling returns all the memory of the groups.
+  table_->compact();
+}
+
+void GroupingSet::clearGroups() {
   if (table_) {
     table_->clear();
   }
+  // All the accumulators belong to the groups of 'table_', so their
+  // memory is released at once instead of staying in the free lists.
+  stringAllocator_.clear();
+}
+
+bool GroupingSet::getOutputFromSpill(
+    int32_t batchSize,
+    bool isPartial,
+    RowContainerIterator* iterator,
+    RowVectorPtr& result) {
+  if (!spillFinished_) {
+    spill();
+    for (auto partition = 0; partition < spill_->maxPartitions();
+         ++partition) {
+      spill_->finishWrite(partition);
+    }
+    spillFinished_ = true;
+  }
+  // @lint-ignore CLANGTIDY
+  char* groups[batchSize];
+  for (;;) {
+    if (outputPartition_ >= 0) {
+      int32_t numGroups =
+          table_->rows()->listRows(iterator, batchSize, groups);
+      if (numGroups) {
+        extractGroups(groups, numGroups, isPartial, result);
+        return true;
+      }
+    }
+    // Combine the groups of the next non-empty partition in 'table_'.
+    clearGroups();
+    iterator->reset();
+    do {
+      ++outputPartition_;
+    } while (outputPartition_ < spill_->maxPartitions() &&
+             !spill_->hasFiles(outputPartition_));
+    if (outputPartition_ >= spill_->maxPartitions()) {
+      return false;
+    }
+    for (auto& stream : spill_->streams(outputPartition_)) {
+      while (auto batch = stream->nextVector()) {
+        addSpilledInput(batch);
+      }
+    }
+  }
+}
+
+void GroupingSet::toIntermediate(
+    const RowVectorPtr& input,
+    RowVectorPtr& result) {
+  VELOX_CHECK(canPassThrough());
+  VELOX_CHECK(table_ && table_->numDistinct() == 0);
+  auto numRows = input->size();
+  activeRows_.resize(numRows);
+  activeRows_.setAll();
+  lookup_->reset(numRows);
+  auto rows = table_->rows();
+  for (auto i = 0; i < numRows; ++i) {
+    lookup_->hits[i] = rows->newRow();
+    lookup_->newGroups.push_back(i);
+  }
+  auto groups = lookup_->hits.data();
+  for (auto& aggregate : aggregates_) {
+    aggregate->initializeNewGroups(groups, lookup_->newGroups);
+  }
+  prepareMaskedSelectivityVectors(input);
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    populateTempVectors(i, input);
+    aggregates_[i]->addRawInput(
+        groups, getSelectivityVector(i), tempVectors_, false);
+  }
+  tempVectors_.clear();
+
+  result->resize(numRows);
+  auto numKeys = keyChannels_.size();
+  for (auto i = 0; i < numKeys; ++i) {
+    result->childAt(i) = input->loadedChildAt(keyChannels_[i]);
+  }
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    aggregates_[i]->finalize(groups, numRows);
+    aggregates_[i]->extractAccumulators(
+        groups, numRows, &result->childAt(numKeys + i));
+  }
+  // The groups are not in the hash table. Only their rows are freed.
+  rows->clear();
+  lookup_->newGroups.clear();
+}
+
+uint64_t GroupingSet::numGroups() const {
+  return table_ ? table_->numDistinct() : 0;
+}
+
+void GroupingSet::resetPartial() {
+  if (table_) {
+    clearGroups();
+  }
 }
 
 uint64_t GroupingSet::allocatedBytes() const {
+  uint64_t distinctBytes = 0;
+  for (auto& distinct : distinctSets_) {
+    if (distinct && distinct->table) {
+      distinctBytes += distinct->table->allocatedBytes();
+    }
+  }
+
   if (table_) {
-    return table_->allocatedBytes();
+    return table_->allocatedBytes() + stringAllocator_.retainedSize() +
+        distinctBytes;
   }
 
-  return stringAllocator_.retainedSize() + rows_.allocatedBytes();
+  return stringAllocator_.retainedSize() + rows_.allocatedBytes() +
+      distinctBytes;
 }
 
 const HashLookup& GroupingSet::hashLookup() const {
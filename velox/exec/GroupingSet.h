@@ -16,6 +16,7 @@
 #pragma once
 
 #include "velox/exec/HashTable.h"
+#include "velox/exec/Spill.h"
 #include "velox/exec/VectorHasher.h"
 
 namespace facebook::velox::exec {
@@ -30,6 +31,7 @@ class GroupingSet {
       std::vector<std::optional<ChannelIndex>>&& aggrMaskChannels,
       std::vector<std::vector<ChannelIndex>>&& channelLists,
       std::vector<std::vector<VectorPtr>>&& constantLists,
+      std::vector<bool>&& aggregateDistincts,
       bool ignoreNullKeys,
       bool isRawInput,
       OperatorCtx* driverCtx);
@@ -44,11 +46,100 @@ class GroupingSet {
 
   uint64_t allocatedBytes() const;
 
+  // Returns the bytes held in free blocks of the allocator of the
+  // accumulators, i.e. memory taken by fragmentation, not live state.
+  uint64_t freeAccumulatorBytes() const {
+    return stringAllocator_.freeBytes();
+  }
+
+  // Returns the number of groups in the hash table.
+  uint64_t numGroups() const;
+
+  // Sets the expected number of groups. The hash table is allocated for
+  // these when it is created.
+  void setNumGroupsEstimate(uint64_t numGroups) {
+    numGroupsEstimate_ = numGroups;
+  }
+
   void resetPartial();
 
+  // Returns true if toIntermediate() can be used, i.e. this is a
+  // partial aggregation with grouping keys and aggregates that keeps
+  // rows with null keys.
+  bool canPassThrough() const {
+    return !isGlobal_ && isRawInput_ && !ignoreNullKeys_ &&
+        !aggregates_.empty();
+  }
+
+  // Converts each row of 'input' into a group of its own without
+  // looking up 'input' in the hash table. Sets 'result' to the keys and
+  // the partial results of these groups. Used by a partial aggregation
+  // that does not reduce the number of rows enough to be worth the hash
+  // table. The hash table must be empty.
+  void toIntermediate(const RowVectorPtr& input, RowVectorPtr& result);
+
   const HashLookup& hashLookup() const;
 
+  // Enables spilling. The spilled rows have the grouping keys followed
+  // by the accumulator of each aggregate. Applies only to grouping sets
+  // with keys that add intermediate results.
+  void setSpillState(std::unique_ptr<SpillState> spill) {
+    VELOX_CHECK(!isGlobal_ && !isRawInput_);
+    spill_ = std::move(spill);
+  }
+
+  bool canSpill() const {
+    return spill_ != nullptr;
+  }
+
+  // Writes the accumulators of all groups to the spill partitions
+  // selected by the hash of the grouping keys and clears the hash
+  // table. After this, getOutput() produces the results by reading
+  // back one partition at a time.
+  void spill();
+
+  bool hasSpilled() const {
+    return spill_ && spill_->numRuns() > 0;
+  }
+
+  const SpillState* spillState() const {
+    return spill_.get();
+  }
+
  private:
+  // Target size of a batch of spilled groups.
+  static constexpr int32_t kSpillBatchBytes = 1 << 20; // 1MB
+
+  // Finds or creates the groups for the keys in 'keyChannels' of
+  // 'input'. Sets 'activeRows_' to the rows that have a group and
+  // 'lookup_->hits' to their groups.
+  void probeGroups(
+      const RowVector& input,
+      const std::vector<ChannelIndex>& keyChannels);
+
+  // Clears the groups of 'table_' and frees the memory of their
+  // accumulators.
+  void clearGroups();
+
+  // Adds a batch of spilled rows, keys followed by accumulators, to
+  // the groups in 'table_'.
+  void addSpilledInput(const RowVectorPtr& input);
+
+  // Copies the keys and results of 'groups' into 'result'.
+  void extractGroups(
+      char** groups,
+      int32_t numGroups,
+      bool isPartial,
+      RowVectorPtr& result);
+
+  // getOutput() after spilling. Spills the remaining groups, then
+  // reads the partitions back one at a time and returns their groups.
+  bool getOutputFromSpill(
+      int32_t batchSize,
+      bool isPartial,
+      RowContainerIterator* iterator,
+      RowVectorPtr& result);
+
   void initializeGlobalAggregation();
 
   void populateTempVectors(int32_t aggregateIndex, const RowVectorPtr& input);
@@ -64,6 +155,15 @@ class GroupingSet {
   // index for this aggregation), otherwise it returns reference to activeRows_.
   const SelectivityVector& getSelectivityVector(size_t aggregateIndex) const;
 
+  // If the given aggregation is distinct, records the combinations of
+  // grouping keys and arguments of 'rows' in its distinct set and returns
+  // the subset of 'rows' whose combination was not seen before. Otherwise
+  // returns 'rows'.
+  const SelectivityVector& getDistinctRows(
+      size_t aggregateIndex,
+      const RowVector& input,
+      const SelectivityVector& rows);
+
   std::vector<ChannelIndex> keyChannels_;
   std::vector<std::unique_ptr<VectorHasher>> hashers_;
   const bool isGlobal_;
@@ -78,9 +178,23 @@ class GroupingSet {
   // 'channelLists_'. This is used when channelLists_[i][j] ==
   // kConstantChannel.
   const std::vector<std::vector<VectorPtr>> constantLists_;
+
+  // The combinations of grouping keys and arguments seen by a distinct
+  // aggregate. The aggregate gets only the rows that add a new combination.
+  struct DistinctSet {
+    // Grouping key channels followed by the argument channels.
+    std::vector<ChannelIndex> keyChannels;
+    std::unique_ptr<BaseHashTable> table;
+    std::unique_ptr<HashLookup> lookup;
+    SelectivityVector newRows;
+  };
+  // Corresponds pairwise to 'aggregates_'. nullptr for aggregates that are
+  // not distinct. The tables are created on first input.
+  std::vector<std::unique_ptr<DistinctSet>> distinctSets_;
   const bool ignoreNullKeys_;
   DriverCtx* const driverCtx_;
   memory::MappedMemory* const mappedMemory_;
+  memory::MemoryPool* const pool_;
 
   std::vector<bool> mayPushdown_;
 
@@ -88,6 +202,8 @@ class GroupingSet {
   std::vector<VectorPtr> tempVectors_;
   std::unique_ptr<BaseHashTable> table_;
   std::unique_ptr<HashLookup> lookup_;
+  // Expected number of groups. 0 if not known.
+  uint64_t numGroupsEstimate_{0};
   uint64_t numAdded_ = 0;
   SelectivityVector activeRows_;
   // For aggregations that use masks we keep selectivity vectors in this map,
@@ -102,11 +218,20 @@ class GroupingSet {
   // masks.
   DecodedVector decodedMask_;
 
-  // Used to allocate memory for a single row accumulating results of global
-  // aggregation
+  // Used to allocate the variable-width state of the accumulators, e.g.
+  // array_agg values. Cleared together with the groups of 'table_'.
   HashStringAllocator stringAllocator_;
   AllocationPool rows_;
   const bool isAdaptive_;
+
+  std::unique_ptr<SpillState> spill_;
+  // Key channels of the spilled rows, i.e. 0 to number of keys - 1.
+  std::vector<ChannelIndex> spillKeyChannels_;
+  // True after the final spill at the start of producing the output.
+  bool spillFinished_ = false;
+  // The spill partition whose groups are in 'table_' and produced by
+  // getOutput(). -1 before the first partition is read.
+  int32_t outputPartition_ = -1;
 };
 
 } // namespace facebook::velox::exec
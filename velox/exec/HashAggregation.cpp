@@ -15,6 +15,7 @@
  */
 #include "velox/exec/HashAggregation.h"
 #include "velox/exec/Aggregate.h"
+#include "velox/exec/HashPartitionFunction.h"
 #include "velox/exec/Task.h"
 
 namespace facebook::velox::exec {
@@ -37,12 +38,21 @@ HashAggregation::HashAggregation(
       maxPartialAggregationMemoryUsage_(
           operatorCtx_->task()
               ->queryCtx()
-              ->maxPartialAggregationMemoryUsage()) {
+              ->maxPartialAggregationMemoryUsage()),
+      abandonPartialAggregationMinRows_(
+          operatorCtx_->task()
+              ->queryCtx()
+              ->abandonPartialAggregationMinRows()),
+      abandonPartialAggregationMinPct_(
+          operatorCtx_->task()
+              ->queryCtx()
+              ->abandonPartialAggregationMinPct()) {
   auto inputType = aggregationNode->sources()[0]->outputType();
 
   auto numHashers = aggregationNode->groupingKeys().size();
   std::vector<std::unique_ptr<VectorHasher>> hashers;
   hashers.reserve(numHashers);
+  std::vector<ChannelIndex> keyChannels;
   for (const auto& key : aggregationNode->groupingKeys()) {
     auto channel = exprToChannel(key.get(), inputType);
     VELOX_CHECK_NE(
@@ -50,6 +60,7 @@ HashAggregation::HashAggregation(
         kConstantChannel,
         "Aggregation doesn't allow constant grouping keys");
     hashers.push_back(VectorHasher::create(key->type(), channel));
+    keyChannels.push_back(channel);
   }
 
   auto numAggregates = aggregationNode->aggregates().size();
@@ -59,6 +70,10 @@ HashAggregation::HashAggregation(
   aggrMaskChannels.reserve(numAggregates);
   std::vector<std::vector<ChannelIndex>> args;
   std::vector<std::vector<VectorPtr>> constantLists;
+  std::vector<bool> distincts;
+  if (aggregationNode->hasDistinctAggregates()) {
+    distincts = aggregationNode->aggregateDistincts();
+  }
   for (auto i = 0; i < numAggregates; i++) {
     const auto& aggregate = aggregationNode->aggregates()[i];
 
@@ -87,6 +102,18 @@ HashAggregation::HashAggregation(
           inputType->asRow().getChildIdx(aggrMask->name()));
     }
 
+    if (!distincts.empty() && distincts[i]) {
+      VELOX_USER_CHECK(
+          !channels.empty(),
+          "Distinct aggregate {} requires arguments",
+          aggregate->name());
+      VELOX_USER_CHECK(
+          std::find(channels.begin(), channels.end(), kConstantChannel) ==
+              channels.end(),
+          "Distinct aggregate {} does not support constant arguments",
+          aggregate->name());
+    }
+
     const auto& resultType = outputType_->childAt(numHashers + i);
     aggregates.push_back(Aggregate::create(
         aggregate->name(), aggregationNode->step(), argTypes, resultType));
@@ -111,34 +138,273 @@ HashAggregation::HashAggregation(
     }
   }
 
+  // A shared hash table does not spill.
+  const bool shared = driverCtx->numDrivers > 1 &&
+      operatorCtx_->queryCtx()->sharedFinalAggregation() &&
+      aggregationNode->step() == core::AggregationNode::Step::kFinal &&
+      !isDistinct_ && !isGlobal_;
+  std::unique_ptr<SpillState> spill;
+  if (!shared) {
+    spill = makeSpillState(*aggregationNode, args);
+  }
+
   groupingSet_ = std::make_unique<GroupingSet>(
       std::move(hashers),
       std::move(aggregates),
       std::move(aggrMaskChannels),
       std::move(args),
       std::move(constantLists),
+      std::move(distincts),
       aggregationNode->ignoreNullKeys(),
       isRawInput(aggregationNode->step()),
       operatorCtx_.get());
+  if (spill) {
+    groupingSet_->setSpillState(std::move(spill));
+  }
+  if (aggregationNode->numGroupsEstimate()) {
+    groupingSet_->setNumGroupsEstimate(
+        aggregationNode->numGroupsEstimate().value());
+  }
+  if (driverCtx->fragmentResultCache &&
+      driverCtx->fragmentResultCache->planNodeId() == aggregationNode->id()) {
+    resultCache_ = driverCtx->fragmentResultCache;
+  }
+  if (shared) {
+    sharedAggregation_ = operatorCtx_->task()->getSharedAggregation(
+        planNodeId(), driverCtx->numDrivers);
+    sharedAggregation_->setPartition(driverCtx->driverId, groupingSet_.get());
+    partitionFunction_ = std::make_unique<HashPartitionFunction>(
+        driverCtx->numDrivers, inputType, keyChannels);
+  }
+}
+
+std::unique_ptr<SpillState> HashAggregation::makeSpillState(
+    const core::AggregationNode& aggregationNode,
+    const std::vector<std::vector<ChannelIndex>>& args) {
+  auto queryCtx = operatorCtx_->queryCtx();
+  // Only a final aggregation can spill: its input is the accumulators,
+  // so their type is known and spilled groups can be merged back with
+  // addIntermediateResults().
+  if (!queryCtx->spillEnabled() ||
+      aggregationNode.step() != core::AggregationNode::Step::kFinal ||
+      isDistinct_ || isGlobal_) {
+    return nullptr;
+  }
+  for (auto i = 0; i < args.size(); ++i) {
+    if (args[i].size() != 1 || args[i][0] == kConstantChannel ||
+        aggregationNode.aggregateMasks()[i] != nullptr) {
+      return nullptr;
+    }
+  }
+  auto inputType = aggregationNode.sources()[0]->outputType();
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  auto addSpillColumn = [&](ChannelIndex channel) {
+    names.push_back(inputType->nameOf(channel));
+    types.push_back(inputType->childAt(channel));
+  };
+  for (const auto& key : aggregationNode.groupingKeys()) {
+    addSpillColumn(exprToChannel(key.get(), inputType));
+  }
+  for (const auto& argList : args) {
+    addSpillColumn(argList[0]);
+  }
+  spillMemoryThreshold_ = queryCtx->aggregationSpillMemoryThreshold();
+  return std::make_unique<SpillState>(
+      fmt::format(
+          "{}/{}_{}_{}",
+          queryCtx->spillPath(),
+          operatorCtx_->taskId(),
+          planNodeId(),
+          operatorCtx_->driverCtx()->driverId),
+      kNumSpillPartitions,
+      ROW(std::move(names), std::move(types)),
+      std::vector<CompareFlags>{},
+      *operatorCtx_->pool());
+}
+
+void HashAggregation::ensureInputFits(const RowVectorPtr& input) {
+  if (!groupingSet_->canSpill()) {
+    return;
+  }
+  if (spillMemoryThreshold_ &&
+      groupingSet_->allocatedBytes() >= spillMemoryThreshold_) {
+    groupingSet_->spill();
+    return;
+  }
+  // Leave room for new groups from 'input' and for the vectors that
+  // are produced when spilling.
+  int64_t neededBytes = 2 * (input->retainedSize() + kSpillHeadroomBytes);
+  if (!reserveMemory(neededBytes)) {
+    groupingSet_->spill();
+  }
+}
+
+uint64_t HashAggregation::reclaim(uint64_t /*bytes*/) {
+  // The groups can be spilled only while input is being added. After
+  // finish() these are being returned.
+  if (!groupingSet_ || !groupingSet_->canSpill() || isFinishing_) {
+    return 0;
+  }
+  auto allocatedBytes = groupingSet_->allocatedBytes();
+  groupingSet_->spill();
+  return allocatedBytes -
+      std::min(allocatedBytes, groupingSet_->allocatedBytes());
+}
+
+bool HashAggregation::shouldAbandonPartialAggregation() const {
+  // The output of a split is cached only if it is fully aggregated.
+  return isPartialOutput_ && !abandonedPartialAggregation_ && !resultCache_ &&
+      groupingSet_->canPassThrough() &&
+      numInputRows_ >= abandonPartialAggregationMinRows_ &&
+      100 * static_cast<int64_t>(groupingSet_->numGroups()) >=
+      abandonPartialAggregationMinPct_ * numInputRows_;
+}
+
+void HashAggregation::startCachedSplit() {
+  cacheSplitResult();
+  splitSequence_ = resultCache_->splitSequence();
+  splitKey_ = resultCache_->splitKey();
+}
+
+void HashAggregation::cacheSplitResult() {
+  if (!splitKey_.empty() && !splitResult_.empty()) {
+    resultCache_->put(splitKey_, splitResult_);
+    stats_.addRuntimeStat("fragmentResultCacheStores", 1);
+  }
+  splitKey_.clear();
+  splitResult_.clear();
+}
+
+void HashAggregation::addSharedInput(const RowVectorPtr& input) {
+  // Lazy vectors must be loaded before being wrapped for the partitions.
+  for (auto& child : input->children()) {
+    child->loadedVector();
+  }
+  partitionFunction_->partition(*input, partitions_);
+  auto numPartitions = sharedAggregation_->numPartitions();
+  auto numInput = input->size();
+  std::vector<BufferPtr> indices(numPartitions);
+  std::vector<vector_size_t*> rawIndices(numPartitions);
+  for (auto i = 0; i < numPartitions; ++i) {
+    indices[i] = AlignedBuffer::allocate<vector_size_t>(numInput, pool());
+    rawIndices[i] = indices[i]->asMutable<vector_size_t>();
+  }
+  std::vector<vector_size_t> sizes(numPartitions, 0);
+  for (auto row = 0; row < numInput; ++row) {
+    auto partition = partitions_[row];
+    rawIndices[partition][sizes[partition]++] = row;
+  }
+  // Drivers start with their own partition so that they contend for
+  // different partitions.
+  auto driverId = operatorCtx_->driverCtx()->driverId;
+  for (auto i = 0; i < numPartitions; ++i) {
+    auto partition = (driverId + i) % numPartitions;
+    auto size = sizes[partition];
+    if (size == 0) {
+      continue;
+    }
+    std::vector<VectorPtr> children;
+    children.reserve(input->childrenSize());
+    for (auto& child : input->children()) {
+      children.push_back(BaseVector::wrapInDictionary(
+          BufferPtr(nullptr), indices[partition], size, child));
+    }
+    sharedAggregation_->addInput(
+        partition,
+        std::make_shared<RowVector>(
+            pool(), input->type(), BufferPtr(nullptr), size, children));
+  }
 }
 
 void HashAggregation::addInput(RowVectorPtr input) {
   input_ = input;
+  if (sharedAggregation_) {
+    addSharedInput(input_);
+    input_ = nullptr;
+    return;
+  }
+  if (abandonedPartialAggregation_) {
+    // getOutput() passes 'input_' through.
+    return;
+  }
+  if (resultCache_ && resultCache_->splitSequence() != splitSequence_) {
+    if (numInputRows_ > 0) {
+      // The groups of the previous split are flushed first.
+      pendingInput_ = std::move(input_);
+      partialFull_ = true;
+      return;
+    }
+    startCachedSplit();
+  }
   if (!pushdownChecked_) {
     mayPushdown_ = operatorCtx_->driver()->mayPushdownAggregation(this);
     pushdownChecked_ = true;
   }
+  ensureInputFits(input_);
   groupingSet_->addInput(input_, mayPushdown_);
+  numInputRows_ += input_->size();
+  stats_.memoryStats.peakFragmentedBytes = std::max(
+      stats_.memoryStats.peakFragmentedBytes,
+      groupingSet_->freeAccumulatorBytes());
   if (isPartialOutput_ &&
       groupingSet_->allocatedBytes() > maxPartialAggregationMemoryUsage_) {
     partialFull_ = true;
   }
+  if (shouldAbandonPartialAggregation()) {
+    abandonedPartialAggregation_ = true;
+    partialFull_ = true;
+    // 'input_' is already in the groups, which are flushed first.
+    input_ = nullptr;
+    stats_.addRuntimeStat("abandonedPartialAggregation", 1);
+  }
   newDistincts_ = isDistinct_ && !groupingSet_->hashLookup().newGroups.empty();
 }
 
+void HashAggregation::finish() {
+  Operator::finish();
+  if (!sharedAggregation_) {
+    return;
+  }
+  // Other Drivers may still add groups to the partition of this one.
+  std::vector<VeloxPromise<bool>> promises;
+  std::vector<std::shared_ptr<Driver>> peers;
+  if (!operatorCtx_->task()->allPeersFinished(
+          planNodeId(), operatorCtx_->driver(), &future_, promises, peers)) {
+    hasFuture_ = true;
+    return;
+  }
+  for (auto& promise : promises) {
+    promise.setValue(true);
+  }
+}
+
+BlockingReason HashAggregation::isBlocked(ContinueFuture* future) {
+  if (!hasFuture_) {
+    return BlockingReason::kNotBlocked;
+  }
+  *future = std::move(future_);
+  hasFuture_ = false;
+  return BlockingReason::kWaitForPeers;
+}
+
 RowVectorPtr HashAggregation::getOutput() {
-  if (finished_ || (!isFinishing_ && !partialFull_ && !newDistincts_)) {
+  if (resultCache_) {
+    if (auto cached = resultCache_->nextCachedResult()) {
+      return cached;
+    }
+  }
+
+  if (abandonedPartialAggregation_ && input_ && !partialFull_) {
+    auto output = std::static_pointer_cast<RowVector>(
+        BaseVector::create(outputType_, input_->size(), operatorCtx_->pool()));
+    groupingSet_->toIntermediate(input_, output);
     input_ = nullptr;
+    return output;
+  }
+
+  if (finished_ || (!isFinishing_ && !partialFull_ && !newDistincts_)) {
+    operatorCtx_->vectorPool().release(input_);
     return nullptr;
   }
 
@@ -174,7 +440,8 @@ RowVectorPtr HashAggregation::getOutput() {
 
   // TODO Figure out how to re-use 'result' safely.
   auto result = std::static_pointer_cast<RowVector>(
-      BaseVector::create(outputType_, batchSize, operatorCtx_->pool()));
+      operatorCtx_->vectorPool().get(
+          outputType_, batchSize, operatorCtx_->pool()));
 
   bool hasData = groupingSet_->getOutput(
       batchSize, isPartialOutput_, &resultIterator_, result);
@@ -182,15 +449,39 @@ RowVectorPtr HashAggregation::getOutput() {
     resultIterator_.reset();
     if (isPartialOutput_) {
       partialFull_ = false;
+      numInputRows_ = 0;
       groupingSet_->resetPartial();
+      if (resultCache_ && (pendingInput_ || isFinishing_)) {
+        // All the groups of the split are flushed.
+        cacheSplitResult();
+        if (pendingInput_) {
+          addInput(std::move(pendingInput_));
+          // Returning nullptr while finishing would finish the next
+          // operator.
+          return getOutput();
+        }
+      }
       if (isFinishing_) {
         finished_ = true;
       }
     } else {
       finished_ = true;
+      if (auto spill = groupingSet_->spillState()) {
+        stats_.addRuntimeStat("spillRuns", spill->numRuns());
+        stats_.addRuntimeStat("spilledBytes", spill->spilledBytes());
+        stats_.addRuntimeStat("spilledRows", spill->spilledRows());
+      }
     }
     return nullptr;
   }
+  if (!splitKey_.empty()) {
+    FragmentResultCache::serialize(
+        result, operatorCtx_->mappedMemory(), splitResult_);
+    if (splitResult_.size() > FragmentResultCache::kMaxEntryBytes) {
+      splitKey_.clear();
+      splitResult_.clear();
+    }
+  }
   return result;
 }
 
@@ -15,8 +15,10 @@
  */
 #pragma once
 
+#include "velox/exec/FragmentResultCache.h"
 #include "velox/exec/GroupingSet.h"
 #include "velox/exec/Operator.h"
+#include "velox/exec/SharedAggregation.h"
 
 namespace facebook::velox::exec {
 
@@ -35,33 +37,107 @@ class HashAggregation : public Operator {
     return !isFinishing_ && !partialFull_;
   }
 
-  void finish() override {
-    Operator::finish();
-  }
+  // With a shared hash table, waits until all the Drivers of the
+  // aggregation have added their input before producing output.
+  void finish() override;
 
-  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
-    return BlockingReason::kNotBlocked;
-  }
+  BlockingReason isBlocked(ContinueFuture* future) override;
+
+  // Spills the groups of a final aggregation if spilling is enabled and
+  // all input has not been received.
+  uint64_t reclaim(uint64_t bytes) override;
 
   void close() override {
     Operator::close();
+    if (sharedAggregation_) {
+      sharedAggregation_->setPartition(
+          operatorCtx_->driverCtx()->driverId, nullptr);
+    }
     groupingSet_.reset();
   }
 
  private:
   static constexpr int32_t kOutputBatchSize = 10'000;
 
+  // Used to estimate the memory needed for the groups of an input batch.
+  static constexpr int64_t kSpillHeadroomBytes = 1 << 20; // 1MB
+
+  // Number of partitions of the spilled groups. Each partition is read
+  // back into the hash table separately.
+  static constexpr int32_t kNumSpillPartitions = 8;
+
+  // Returns the spill state for 'groupingSet_' or nullptr if spilling is
+  // not enabled or does not apply to 'aggregationNode'. 'args' are the
+  // input channels of the aggregates.
+  std::unique_ptr<SpillState> makeSpillState(
+      const core::AggregationNode& aggregationNode,
+      const std::vector<std::vector<ChannelIndex>>& args);
+
+  // Spills the groups if adding 'input' would exceed the spill
+  // threshold or the memory limit.
+  void ensureInputFits(const RowVectorPtr& input);
+
+  // Adds the rows of 'input' to the partitions of the shared hash table
+  // selected by their keys.
+  void addSharedInput(const RowVectorPtr& input);
+
+  // Returns true if a partial aggregation has seen enough input to
+  // tell that it barely reduces the number of rows. The groups are then
+  // flushed and later input passes through without the hash table.
+  bool shouldAbandonPartialAggregation() const;
+
+  // Makes the groups correspond to the split being read by the
+  // TableScan after caching the result of the previous split.
+  void startCachedSplit();
+
+  // Stores the output of the split whose groups were just flushed in
+  // 'resultCache_' if the split is cacheable.
+  void cacheSplitResult();
+
   std::unique_ptr<GroupingSet> groupingSet_;
   const bool isPartialOutput_;
   const bool isDistinct_;
   const bool isGlobal_;
   const int64_t maxPartialAggregationMemoryUsage_;
+  const int64_t abandonPartialAggregationMinRows_;
+  const int32_t abandonPartialAggregationMinPct_;
+  uint64_t spillMemoryThreshold_ = 0;
   bool partialFull_ = false;
+  // Number of input rows added to the groups since the last flush of a
+  // partial aggregation.
+  int64_t numInputRows_ = 0;
+  // True if a partial aggregation converts each input row into a
+  // partial result instead of adding it to the hash table.
+  bool abandonedPartialAggregation_ = false;
   bool newDistincts_ = false;
   bool finished_ = false;
   RowContainerIterator resultIterator_;
   bool pushdownChecked_ = false;
   bool mayPushdown_ = false;
+
+  // Set if the Drivers of a final aggregation share one hash table.
+  // 'groupingSet_' is then the partition of this Driver.
+  std::shared_ptr<SharedAggregation> sharedAggregation_;
+  // Selects the partition of the shared hash table for each input row.
+  std::unique_ptr<core::PartitionFunction> partitionFunction_;
+  std::vector<uint32_t> partitions_;
+
+  // Set if the output is cached per split. The groups then only hold
+  // the rows of one split at a time.
+  std::shared_ptr<FragmentResultCache> resultCache_;
+  // The split whose rows are in the groups. 'splitKey_' is empty if the
+  // split is not cacheable or its result is too large.
+  int64_t splitSequence_ = 0;
+  std::string splitKey_;
+  // Output for 'splitKey_' so far in wire format.
+  std::string splitResult_;
+  // Input from the next split. Added after the groups of the previous
+  // split are flushed.
+  RowVectorPtr pendingInput_;
+  // Realized when all Drivers have finished adding input to the shared
+  // hash table.
+  ContinueFuture future_{false};
+  bool hasFuture_ = false;
 };
 
 } // namespace facebook::velox::exec
@@ -15,23 +15,259 @@
  */
 
 #include "velox/exec/HashBuild.h"
+#include "velox/exec/HashTableCache.h"
 #include "velox/exec/OperatorUtils.h"
 #include "velox/exec/Task.h"
 
 namespace facebook::velox::exec {
 
-void HashJoinBridge::setHashTable(std::unique_ptr<BaseHashTable> table) {
+JoinSpillPartitioner::JoinSpillPartitioner(
+    const std::vector<TypePtr>& keyTypes,
+    int32_t level)
+    : level_(level) {
+  VELOX_CHECK_LT(level_, kMaxLevels);
+  for (auto i = 0; i < keyTypes.size(); ++i) {
+    hashers_.push_back(std::make_unique<VectorHasher>(keyTypes[i], i));
+  }
+}
+
+void JoinSpillPartitioner::partition(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& keyChannels,
+    const SelectivityVector& rows,
+    std::vector<int32_t>& partitions) {
+  hashes_.resize(input.size());
+  partitions.resize(input.size());
+  for (auto i = 0; i < hashers_.size(); ++i) {
+    hashers_[i]->hash(
+        *input.loadedChildAt(keyChannels[i]), rows, i > 0, &hashes_);
+  }
+  auto shift = 64 - kPartitionBits * (level_ + 1);
+  rows.applyToSelected([&](vector_size_t row) {
+    partitions[row] = (hashes_[row] >> shift) & (kNumPartitions - 1);
+  });
+}
+
+void spillJoinRows(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& channels,
+    const std::vector<int32_t>& partitions,
+    int32_t firstPartition,
+    SelectivityVector& rows,
+    SpillState& spill,
+    memory::MemoryPool& pool) {
+  std::vector<std::vector<vector_size_t>> spilledRows(
+      spill.maxPartitions());
+  rows.applyToSelected([&](vector_size_t row) {
+    if (partitions[row] >= firstPartition) {
+      spilledRows[partitions[row]].push_back(row);
+      rows.setValid(row, false);
+    }
+  });
+  rows.updateBounds();
+  for (auto partition = firstPartition; partition < spilledRows.size();
+       ++partition) {
+    auto& partitionRows = spilledRows[partition];
+    if (partitionRows.empty()) {
+      continue;
+    }
+    vector_size_t size = partitionRows.size();
+    auto indices = AlignedBuffer::allocate<vector_size_t>(size, &pool);
+    std::copy(
+        partitionRows.begin(),
+        partitionRows.end(),
+        indices->asMutable<vector_size_t>());
+    std::vector<VectorPtr> children;
+    children.reserve(channels.size());
+    for (auto channel : channels) {
+      children.push_back(
+          wrapChild(size, indices, input.loadedChildAt(channel)));
+    }
+    spill.appendToPartition(
+        partition,
+        std::make_shared<RowVector>(
+            &pool,
+            spill.type(),
+            BufferPtr(nullptr),
+            size,
+            std::move(children)));
+  }
+}
+
+bool isKeyOnlyJoin(const core::HashJoinNode& joinNode) {
+  if ((!joinNode.isSemiJoin() && !joinNode.isAntiJoin()) ||
+      joinNode.filter()) {
+    return false;
+  }
+  auto type = joinNode.sources()[1]->outputType();
+  folly::F14FastSet<std::string> keyNames;
+  for (auto& key : joinNode.rightKeys()) {
+    keyNames.insert(key->name());
+  }
+  for (auto i = 0; i < type->size(); ++i) {
+    auto& name = type->nameOf(i);
+    if (keyNames.find(name) == keyNames.end() &&
+        joinNode.outputType()->getChildIdxIfExists(name).has_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+JoinTableBuilder::JoinTableBuilder(
+    const core::HashJoinNode& joinNode,
+    memory::MappedMemory* mappedMemory)
+    : isRightJoin_(joinNode.isRightJoin()),
+      // Semi and anti join only needs to know whether there is a match.
+      // Hence, no need to store entries with duplicate keys.
+      allowDuplicates_(
+          isRightJoin_ || (!joinNode.isSemiJoin() && !joinNode.isAntiJoin())),
+      mappedMemory_(mappedMemory) {
+  auto type = joinNode.sources()[1]->outputType();
+  folly::F14FastSet<ChannelIndex> keyChannelSet;
+  for (auto& key : joinNode.rightKeys()) {
+    auto channel = exprToChannel(key.get(), type);
+    keyChannelSet.emplace(channel);
+    buildKeyChannels_.push_back(channel);
+    keyTypes_.push_back(type->childAt(channel));
+  }
+  if (!isKeyOnlyJoin(joinNode)) {
+    for (auto i = 0; i < type->size(); ++i) {
+      if (keyChannelSet.find(i) == keyChannelSet.end()) {
+        dependentTypes_.emplace_back(type->childAt(i));
+        decoders_.emplace_back(std::make_unique<DecodedVector>());
+      }
+    }
+  }
+  makeTable();
+}
+
+void JoinTableBuilder::makeTable() {
+  std::vector<std::unique_ptr<VectorHasher>> keyHashers;
+  keyHashers.reserve(keyTypes_.size());
+  for (auto i = 0; i < keyTypes_.size(); ++i) {
+    keyHashers.emplace_back(
+        std::make_unique<VectorHasher>(keyTypes_[i], buildKeyChannels_[i]));
+  }
+  if (isRightJoin_) {
+    // Do not ignore null keys.
+    table_ = HashTable<false>::createForJoin(
+        std::move(keyHashers),
+        dependentTypes_,
+        allowDuplicates_,
+        true, // hasProbedFlag
+        mappedMemory_);
+  } else {
+    table_ = HashTable<true>::createForJoin(
+        std::move(keyHashers),
+        dependentTypes_,
+        allowDuplicates_,
+        false, // hasProbedFlag
+        mappedMemory_);
+  }
+  analyzeKeys_ = table_->hashMode() != BaseHashTable::HashMode::kHash;
+}
+
+std::unique_ptr<BaseHashTable> JoinTableBuilder::takeTable() {
+  auto table = std::move(table_);
+  makeTable();
+  return table;
+}
+
+void JoinTableBuilder::addRows(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& keyChannels,
+    const std::vector<ChannelIndex>& dependentChannels,
+    const SelectivityVector& rows) {
+  if (!rows.hasSelections()) {
+    return;
+  }
+  if (analyzeKeys_ && hashes_.size() < rows.size()) {
+    hashes_.resize(rows.size());
+  }
+
+  auto& hashers = table_->hashers();
+
+  // As long as analyzeKeys is true, we keep running the keys through
+  // the Vectorhashers so that we get a possible mapping of the keys
+  // to small ints for array or normalized key. When mayUseValueIds is
+  // false for the first time we stop. We do not retain the value ids
+  // since the final ones will only be known after all data is
+  // received.
+  for (auto i = 0; i < hashers.size(); ++i) {
+    auto& hasher = hashers[i];
+    // TODO: Load only for active rows, except if right/full outer join.
+    if (analyzeKeys_) {
+      hasher->computeValueIds(
+          *input.loadedChildAt(keyChannels[i]), rows, &hashes_);
+      analyzeKeys_ = hasher->mayUseValueIds();
+    } else {
+      hasher->decode(*input.loadedChildAt(keyChannels[i]), rows);
+    }
+  }
+  for (auto i = 0; i < decoders_.size(); ++i) {
+    decoders_[i]->decode(*input.loadedChildAt(dependentChannels[i]), rows);
+  }
+  auto container = table_->rows();
+  auto nextOffset = container->nextOffset();
+  rows.applyToSelected([&](auto rowIndex) {
+    char* newRow = container->newRow();
+    if (nextOffset) {
+      *reinterpret_cast<char**>(newRow + nextOffset) = nullptr;
+    }
+    // Store the columns for each row in sequence. At probe time
+    // strings of the row will probably be in consecutive places, so
+    // reading one will prime the cache for the next.
+    for (auto i = 0; i < hashers.size(); ++i) {
+      container->store(hashers[i]->decodedVector(), rowIndex, newRow, i);
+    }
+    for (auto i = 0; i < decoders_.size(); ++i) {
+      container->store(*decoders_[i], rowIndex, newRow, i + hashers.size());
+    }
+  });
+}
+
+void HashJoinBridge::setHashTable(
+    std::unique_ptr<BaseHashTable> table,
+    std::shared_ptr<HashJoinSpill> spill,
+    std::vector<std::shared_ptr<common::Filter>> bloomFilters) {
   VELOX_CHECK(table, "setHashTable called with null table");
 
   std::lock_guard<std::mutex> l(mutex_);
+  if (tableFromCache_) {
+    return;
+  }
   VELOX_CHECK(!table_, "setHashTable may be called only once");
   // Ownership becomes shared.
   table_.reset(table.release());
+  spill_ = std::move(spill);
+  bloomFilters_ = std::move(bloomFilters);
+  if (!hashTableCacheKey_.empty() && !spill_) {
+    HashTableCache::getInstance()->put(hashTableCacheKey_, table_);
+  }
+  notifyConsumersLocked();
+}
+
+void HashJoinBridge::setCachedHashTable(std::shared_ptr<BaseHashTable> table) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (table_ || antiJoinHasNullKeys_) {
+    return;
+  }
+  table_ = std::move(table);
+  tableFromCache_ = true;
   notifyConsumersLocked();
 }
 
+void HashJoinBridge::setHashTableCacheKey(std::string key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  hashTableCacheKey_ = std::move(key);
+}
+
 void HashJoinBridge::setAntiJoinHasNullKeys() {
   std::lock_guard<std::mutex> l(mutex_);
+  if (tableFromCache_) {
+    return;
+  }
   VELOX_CHECK(
       !table_,
       "Only one of setAntiJoinHasNullKeys or setHashTable may be called");
@@ -46,82 +282,120 @@ std::optional<HashJoinBridge::HashBuildResult> HashJoinBridge::tableOrFuture(
   VELOX_CHECK(
       !cancelled_, "Getting hash table after the build side is aborted");
   if (table_ || antiJoinHasNullKeys_) {
-    return HashBuildResult{table_, antiJoinHasNullKeys_};
+    return HashBuildResult{
+        table_, antiJoinHasNullKeys_, spill_, bloomFilters_};
   }
   promises_.emplace_back("HashJoinBridge::tableOrFuture");
   *future = promises_.back().getSemiFuture();
   return std::nullopt;
 }
 
+void HashJoinBridge::addProbeSpillFiles(std::vector<SpillFiles>&& files) {
+  std::lock_guard<std::mutex> l(mutex_);
+  VELOX_CHECK_EQ(files.size(), probeSpillFiles_.size());
+  for (auto i = 0; i < files.size(); ++i) {
+    for (auto& file : files[i]) {
+      probeSpillFiles_[i].push_back(std::move(file));
+    }
+  }
+}
+
+std::vector<SpillFiles> HashJoinBridge::takeProbeSpillFiles() {
+  std::lock_guard<std::mutex> l(mutex_);
+  std::vector<SpillFiles> files(probeSpillFiles_.size());
+  std::swap(files, probeSpillFiles_);
+  return files;
+}
+
+namespace {
+// A table that may be added to HashTableCache outlives the query, so
+// it is allocated from the MappedMemory of the process instead of the
+// one scoped to the query.
+memory::MappedMemory* tableMappedMemory(
+    const core::HashJoinNode& joinNode,
+    OperatorCtx& operatorCtx) {
+  if (operatorCtx.queryCtx()->hashTableCacheEnabled() &&
+      !HashTableCache::cacheableBuildScan(joinNode).empty()) {
+    return operatorCtx.queryCtx()->mappedMemory();
+  }
+  return operatorCtx.mappedMemory();
+}
+} // namespace
+
 HashBuild::HashBuild(
     int32_t operatorId,
     DriverCtx* driverCtx,
     std::shared_ptr<const core::HashJoinNode> joinNode)
     : Operator(driverCtx, nullptr, operatorId, joinNode->id(), "HashBuild"),
       joinType_{joinNode->joinType()},
-      mappedMemory_(operatorCtx_->mappedMemory()) {
+      builder_(std::make_unique<JoinTableBuilder>(
+          *joinNode,
+          tableMappedMemory(*joinNode, *operatorCtx_))) {
   auto type = joinNode->sources()[1]->outputType();
 
   auto numKeys = joinNode->rightKeys().size();
   keyChannels_.reserve(numKeys);
   folly::F14FastSet<ChannelIndex> keyChannelSet;
   keyChannelSet.reserve(numKeys);
-  std::vector<std::unique_ptr<VectorHasher>> keyHashers;
-  keyHashers.reserve(numKeys);
+  std::vector<TypePtr> keyTypes;
   for (auto& key : joinNode->rightKeys()) {
     auto channel = exprToChannel(key.get(), type);
     keyChannelSet.emplace(channel);
     keyChannels_.emplace_back(channel);
-    keyHashers.emplace_back(
-        std::make_unique<VectorHasher>(type->childAt(channel), channel));
+    keyTypes.push_back(type->childAt(channel));
   }
 
-  // Identify the non-key build side columns and make a decoder for each.
-  auto numDependents = type->size() - numKeys;
-  dependentChannels_.reserve(numDependents);
-  decoders_.reserve(numDependents);
-  std::vector<TypePtr> dependentTypes;
-  dependentTypes.reserve(numDependents);
-  for (auto i = 0; i < type->size(); ++i) {
-    if (keyChannelSet.find(i) == keyChannelSet.end()) {
-      dependentTypes.emplace_back(type->childAt(i));
-      dependentChannels_.emplace_back(i);
-      decoders_.emplace_back(std::make_unique<DecodedVector>());
+  // Identify the non-key build side columns. A key-only join needs
+  // none.
+  if (!isKeyOnlyJoin(*joinNode)) {
+    auto numDependents = type->size() - numKeys;
+    dependentChannels_.reserve(numDependents);
+    for (auto i = 0; i < type->size(); ++i) {
+      if (keyChannelSet.find(i) == keyChannelSet.end()) {
+        dependentChannels_.emplace_back(i);
+      }
     }
   }
 
-  if (joinNode->isRightJoin()) {
-    // Do not ignore null keys.
-    table_ = HashTable<false>::createForJoin(
-        std::move(keyHashers),
-        dependentTypes,
-        true, // allowDuplicates
-        true, // hasProbedFlag
-        mappedMemory_);
-  } else {
-    // Semi and anti join only needs to know whether there is a match. Hence, no
-    // need to store entries with duplicate keys.
-    const bool allowDuplicates =
-        !joinNode->isSemiJoin() && !joinNode->isAntiJoin();
-
-    table_ = HashTable<true>::createForJoin(
-        std::move(keyHashers),
-        dependentTypes,
-        allowDuplicates,
-        false, // hasProbedFlag
-        mappedMemory_);
+  // An anti join stops at the first null key on the build side and
+  // needs the complete build side to know that there is none.
+  auto queryCtx = operatorCtx_->queryCtx();
+  if (queryCtx->spillEnabled() && !joinNode->isAntiJoin()) {
+    std::vector<std::string> names;
+    std::vector<TypePtr> types;
+    for (auto i = 0; i < numKeys + dependentChannels_.size(); ++i) {
+      auto channel = i < numKeys ? keyChannels_[i]
+                                 : dependentChannels_[i - numKeys];
+      spillChannels_.push_back(channel);
+      names.push_back(type->nameOf(channel));
+      types.push_back(type->childAt(channel));
+      if (i < numKeys) {
+        tableKeyChannels_.push_back(i);
+      } else {
+        tableDependentChannels_.push_back(i);
+      }
+    }
+    spillMemoryThreshold_ = queryCtx->joinSpillMemoryThreshold();
+    spillPartitioner_ = std::make_unique<JoinSpillPartitioner>(keyTypes, 0);
+    spill_ = std::make_unique<SpillState>(
+        fmt::format(
+            "{}/{}_{}_{}_build",
+            queryCtx->spillPath(),
+            operatorCtx_->taskId(),
+            planNodeId(),
+            operatorCtx_->driverCtx()->driverId),
+        JoinSpillPartitioner::kNumPartitions,
+        ROW(std::move(names), std::move(types)),
+        std::vector<CompareFlags>{},
+        *operatorCtx_->pool());
   }
-  analyzeKeys_ = table_->hashMode() != BaseHashTable::HashMode::kHash;
 }
 
 void HashBuild::addInput(RowVectorPtr input) {
-  activeRows_.resize(input->size());
-  activeRows_.setAll();
-  if (!isRightJoin(joinType_)) {
-    deselectRowsWithNulls(*input, keyChannels_, activeRows_);
-  }
-
   if (joinType_ == core::JoinType::kAnti) {
+    activeRows_.resize(input->size());
+    activeRows_.setAll();
+    deselectRowsWithNulls(*input, keyChannels_, activeRows_);
     // Anti join returns no rows if build side has nulls in join keys. Hence, we
     // can stop processing on first null.
     if (activeRows_.countSelected() < input->size()) {
@@ -131,49 +405,100 @@ void HashBuild::addInput(RowVectorPtr input) {
     }
   }
 
-  if (analyzeKeys_ && hashes_.size() < activeRows_.size()) {
-    hashes_.resize(activeRows_.size());
+  ensureInputFits(input);
+  addRows(*input, keyChannels_, dependentChannels_);
+}
+
+void HashBuild::addRows(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& keyChannels,
+    const std::vector<ChannelIndex>& dependentChannels) {
+  activeRows_.resize(input.size());
+  activeRows_.setAll();
+  if (!isRightJoin(joinType_)) {
+    deselectRowsWithNulls(input, keyChannels, activeRows_);
+  }
+  if (numInMemoryPartitions_ < JoinSpillPartitioner::kNumPartitions) {
+    spillPartitioner_->partition(input, keyChannels, activeRows_, partitions_);
+    // The spilled rows are in table order, keys first.
+    std::vector<ChannelIndex> channels = keyChannels;
+    channels.insert(
+        channels.end(), dependentChannels.begin(), dependentChannels.end());
+    spillJoinRows(
+        input,
+        channels,
+        partitions_,
+        numInMemoryPartitions_,
+        activeRows_,
+        *spill_,
+        *operatorCtx_->pool());
   }
+  builder_->addRows(input, keyChannels, dependentChannels, activeRows_);
+}
 
-  auto& hashers = table_->hashers();
+void HashBuild::ensureInputFits(const RowVectorPtr& input) {
+  if (!spill_ || numInMemoryPartitions_ == 0) {
+    return;
+  }
+  auto table = builder_->table();
+  if (table->rows()->numRows() == 0) {
+    return;
+  }
+  if (spillMemoryThreshold_ &&
+      table->allocatedBytes() >= static_cast<int64_t>(spillMemoryThreshold_)) {
+    spill(numInMemoryPartitions_ / 2);
+    return;
+  }
+  // Leave room for the copy of 'input' in the table and for the hash
+  // table that is made at the end.
+  int64_t neededBytes = 2 * input->retainedSize() + table->allocatedBytes() / 2;
+  if (!reserveMemory(neededBytes) && numInMemoryPartitions_ > 0) {
+    // The table may have been spilled by the MemoryArbitrator while
+    // waiting.
+    spill(numInMemoryPartitions_ / 2);
+  }
+}
 
-  // As long as analyzeKeys is true, we keep running the keys through
-  // the Vectorhashers so that we get a possible mapping of the keys
-  // to small ints for array or normalized key. When mayUseValueIds is
-  // false for the first time we stop. We do not retain the value ids
-  // since the final ones will only be known after all data is
-  // received.
-  for (auto& hasher : hashers) {
-    // TODO: Load only for active rows, except if right/full outer join.
-    if (analyzeKeys_) {
-      hasher->computeValueIds(
-          *input->loadedChildAt(hasher->channel()), activeRows_, &hashes_);
-      analyzeKeys_ = hasher->mayUseValueIds();
-    } else {
-      hasher->decode(*input->loadedChildAt(hasher->channel()), activeRows_);
-    }
+uint64_t HashBuild::reclaim(uint64_t /*bytes*/) {
+  // The build side can be spilled only before reaching the barrier in
+  // finish(). After this the table is being handed over to the probe
+  // side.
+  if (!spill_ || isFinishing_ || numInMemoryPartitions_ == 0) {
+    return 0;
   }
-  for (auto i = 0; i < dependentChannels_.size(); ++i) {
-    decoders_[i]->decode(
-        *input->loadedChildAt(dependentChannels_[i]), activeRows_);
+  auto table = builder_->table();
+  if (table->rows()->numRows() == 0) {
+    return 0;
   }
-  auto rows = table_->rows();
-  auto nextOffset = rows->nextOffset();
-  activeRows_.applyToSelected([&](auto rowIndex) {
-    char* newRow = rows->newRow();
-    if (nextOffset) {
-      *reinterpret_cast<char**>(newRow + nextOffset) = nullptr;
-    }
-    // Store the columns for each row in sequence. At probe time
-    // strings of the row will probably be in consecutive places, so
-    // reading one will prime the cache for the next.
-    for (auto i = 0; i < hashers.size(); ++i) {
-      rows->store(hashers[i]->decodedVector(), rowIndex, newRow, i);
+  auto allocatedBytes = table->allocatedBytes();
+  spill(numInMemoryPartitions_ / 2);
+  return allocatedBytes -
+      std::min(allocatedBytes, builder_->table()->allocatedBytes());
+}
+
+void HashBuild::spill(int32_t numInMemoryPartitions) {
+  VELOX_CHECK(spill_);
+  VELOX_CHECK_LT(numInMemoryPartitions, numInMemoryPartitions_);
+  numInMemoryPartitions_ = numInMemoryPartitions;
+  // Move the rows of the partitions that stay in memory to a new table
+  // and write the others to disk.
+  auto table = builder_->takeTable();
+  auto rows = table->rows();
+  auto& type = spill_->type();
+  std::vector<char*> batchRows(kSpillBatchSize);
+  RowContainerIterator iterator;
+  for (;;) {
+    auto numRows = rows->listRows(&iterator, kSpillBatchSize, batchRows.data());
+    if (!numRows) {
+      break;
     }
-    for (auto i = 0; i < dependentChannels_.size(); ++i) {
-      rows->store(*decoders_[i], rowIndex, newRow, i + hashers.size());
+    auto batch = std::static_pointer_cast<RowVector>(
+        BaseVector::create(type, numRows, operatorCtx_->pool()));
+    for (auto i = 0; i < type->size(); ++i) {
+      rows->extractColumn(batchRows.data(), numRows, i, batch->childAt(i));
     }
-  });
+    addRows(*batch, tableKeyChannels_, tableDependentChannels_);
+  }
 }
 
 void HashBuild::finish() {
@@ -191,21 +516,67 @@ void HashBuild::finish() {
     return;
   }
 
+  std::vector<HashBuild*> builds{this};
+  for (auto& peer : peers) {
+    auto op = peer->findOperator(planNodeId());
+    HashBuild* build = dynamic_cast<HashBuild*>(op);
+    VELOX_CHECK(build);
+    builds.push_back(build);
+  }
+
   std::vector<std::unique_ptr<BaseHashTable>> otherTables;
   otherTables.reserve(peers.size());
+  std::shared_ptr<HashJoinSpill> joinSpill;
+  std::vector<std::shared_ptr<common::Filter>> bloomFilters;
 
+  for (auto build : builds) {
+    if (build->antiJoinHasNullKeys_) {
+      antiJoinHasNullKeys_ = true;
+      break;
+    }
+  }
   if (!antiJoinHasNullKeys_) {
-    for (auto& peer : peers) {
-      auto op = peer->findOperator(planNodeId());
-      HashBuild* build = dynamic_cast<HashBuild*>(op);
-      VELOX_CHECK(build);
-      if (build->antiJoinHasNullKeys_) {
-        antiJoinHasNullKeys_ = true;
-        break;
+    // The partitions spilled by any Driver are spilled by all.
+    int32_t numInMemoryPartitions = numInMemoryPartitions_;
+    for (auto build : builds) {
+      numInMemoryPartitions =
+          std::min(numInMemoryPartitions, build->numInMemoryPartitions_);
+    }
+    if (numInMemoryPartitions < JoinSpillPartitioner::kNumPartitions) {
+      joinSpill = std::make_shared<HashJoinSpill>(numInMemoryPartitions);
+      uint64_t spilledBytes = 0;
+      uint64_t spilledRows = 0;
+      for (auto build : builds) {
+        if (build->numInMemoryPartitions_ > numInMemoryPartitions) {
+          build->spill(numInMemoryPartitions);
+        }
+        for (auto partition = numInMemoryPartitions;
+             partition < JoinSpillPartitioner::kNumPartitions;
+             ++partition) {
+          build->spill_->finishWrite(partition);
+          for (auto& file : build->spill_->takeFiles(partition)) {
+            joinSpill->buildFiles[partition].push_back(std::move(file));
+          }
+        }
+        spilledBytes += build->spill_->spilledBytes();
+        spilledRows += build->spill_->spilledRows();
       }
-      otherTables.push_back(std::move(build->table_));
+      stats_.addRuntimeStat("spilledBytes", spilledBytes);
+      stats_.addRuntimeStat("spilledRows", spilledRows);
+      stats_.addRuntimeStat(
+          "spilledPartitions",
+          JoinSpillPartitioner::kNumPartitions - numInMemoryPartitions);
+    }
+    // The filters would not cover the spilled partitions.
+    if (!joinSpill && operatorCtx_->queryCtx()->hashJoinBloomFilterEnabled() &&
+        (core::isInnerJoin(joinType_) || core::isSemiJoin(joinType_))) {
+      bloomFilters = makeBloomFilters(builds);
+    }
+    for (auto i = 1; i < builds.size(); ++i) {
+      otherTables.push_back(builds[i]->builder_->takeTable());
     }
   }
+  builds.clear();
 
   // Realize the promises so that the other Drivers (which were not
   // the last to finish) can continue from the barrier and finish.
@@ -219,19 +590,109 @@ void HashBuild::finish() {
         ->getHashJoinBridge(planNodeId())
         ->setAntiJoinHasNullKeys();
   } else {
-    table_->prepareJoinTable(std::move(otherTables));
+    auto table = builder_->takeTable();
+    // The peer Drivers are done with their builds, so the threads they
+    // ran on are free to help insert the rows into 'table'.
+    folly::Executor* executor = operatorCtx_->queryCtx()->executor();
+    if (!executor) {
+      executor = Driver::executor();
+    }
+    table->prepareJoinTable(std::move(otherTables), executor);
 
-    addRuntimeStats();
+    addRuntimeStats(*table);
 
     operatorCtx_->task()
         ->getHashJoinBridge(planNodeId())
-        ->setHashTable(std::move(table_));
+        ->setHashTable(
+            std::move(table), std::move(joinSpill), std::move(bloomFilters));
+  }
+}
+
+namespace {
+template <typename T>
+void addToBloomFilter(
+    const BaseVector& values,
+    common::BloomFilter::Builder& builder) {
+  auto flat = values.asUnchecked<FlatVector<T>>();
+  for (auto i = 0; i < flat->size(); ++i) {
+    if (flat->isNullAt(i)) {
+      continue;
+    }
+    if constexpr (std::is_same_v<T, StringView>) {
+      auto value = flat->valueAt(i);
+      builder.addBytes(value.data(), value.size());
+    } else {
+      builder.addInt64(flat->valueAt(i));
+    }
+  }
+}
+} // namespace
+
+std::vector<std::shared_ptr<common::Filter>> HashBuild::makeBloomFilters(
+    const std::vector<HashBuild*>& builds) {
+  constexpr int32_t kBatchSize = 1'000;
+  int64_t numRows = 0;
+  for (auto build : builds) {
+    numRows += build->builder_->table()->rows()->numRows();
+  }
+  const auto& hashers = builder_->table()->hashers();
+  std::vector<std::shared_ptr<common::Filter>> filters(hashers.size());
+  int32_t numFilters = 0;
+  std::vector<char*> rows(kBatchSize);
+  for (auto key = 0; key < hashers.size(); ++key) {
+    auto type = hashers[key]->type();
+    switch (type->kind()) {
+      case TypeKind::TINYINT:
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+        break;
+      default:
+        continue;
+    }
+    common::BloomFilter::Builder builder(numRows);
+    auto values = BaseVector::create(type, kBatchSize, operatorCtx_->pool());
+    for (auto build : builds) {
+      auto container = build->builder_->table()->rows();
+      RowContainerIterator iterator;
+      while (auto numBatchRows =
+                 container->listRows(&iterator, kBatchSize, rows.data())) {
+        values->resize(numBatchRows);
+        container->extractColumn(rows.data(), numBatchRows, key, values);
+        switch (type->kind()) {
+          case TypeKind::TINYINT:
+            addToBloomFilter<int8_t>(*values, builder);
+            break;
+          case TypeKind::SMALLINT:
+            addToBloomFilter<int16_t>(*values, builder);
+            break;
+          case TypeKind::INTEGER:
+            addToBloomFilter<int32_t>(*values, builder);
+            break;
+          case TypeKind::BIGINT:
+            addToBloomFilter<int64_t>(*values, builder);
+            break;
+          default:
+            addToBloomFilter<StringView>(*values, builder);
+            break;
+        }
+      }
+    }
+    filters[key] = builder.build();
+    ++numFilters;
+  }
+  if (!numFilters) {
+    return {};
   }
+  stats_.addRuntimeStat("bloomFilters", numFilters);
+  return filters;
 }
 
-void HashBuild::addRuntimeStats() {
+void HashBuild::addRuntimeStats(const BaseHashTable& table) {
   // Report range sizes and number of distinct values for the join keys.
-  const auto& hashers = table_->hashers();
+  const auto& hashers = table.hashers();
   uint64_t asRange;
   uint64_t asDistinct;
   for (auto i = 0; i < hashers.size(); i++) {
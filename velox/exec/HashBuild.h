@@ -18,21 +18,157 @@
 #include "velox/exec/HashTable.h"
 #include "velox/exec/JoinBridge.h"
 #include "velox/exec/Operator.h"
+#include "velox/exec/Spill.h"
 #include "velox/exec/VectorHasher.h"
 #include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
 
+// Assigns the rows of the build and probe sides of a hash join to
+// spill partitions by the hash of the join keys. The partition is
+// given by 'kPartitionBits' bits from the top of the hash so that it
+// does not correlate with the bits that select the slot in a hash
+// table. Each level of recursive partitioning uses the next lower bits.
+class JoinSpillPartitioner {
+ public:
+  static constexpr int32_t kPartitionBits = 3;
+  static constexpr int32_t kNumPartitions = 1 << kPartitionBits;
+  // Number of times a spilled partition can be divided again when its
+  // build side does not fit in memory.
+  static constexpr int32_t kMaxLevels = 4;
+
+  JoinSpillPartitioner(const std::vector<TypePtr>& keyTypes, int32_t level);
+
+  // Sets 'partitions[i]' to the partition of row i of 'input' for the
+  // rows in 'rows'. The keys are the 'keyChannels' of 'input'.
+  void partition(
+      const RowVector& input,
+      const std::vector<ChannelIndex>& keyChannels,
+      const SelectivityVector& rows,
+      std::vector<int32_t>& partitions);
+
+  int32_t level() const {
+    return level_;
+  }
+
+ private:
+  const int32_t level_;
+  std::vector<std::unique_ptr<VectorHasher>> hashers_;
+  std::vector<uint64_t> hashes_;
+};
+
+// Appends the rows of 'input' that are in 'rows' and whose entry in
+// 'partitions' is 'firstPartition' or above to the corresponding
+// partitions of 'spill'. The spilled rows consist of the 'channels' of
+// 'input'. Removes the spilled rows from 'rows'.
+void spillJoinRows(
+    const RowVector& input,
+    const std::vector<ChannelIndex>& channels,
+    const std::vector<int32_t>& partitions,
+    int32_t firstPartition,
+    SelectivityVector& rows,
+    SpillState& spill,
+    memory::MemoryPool& pool);
+
+// The spilled part of the build side of a hash join. The build side
+// rows of partitions 'firstSpilledPartition' and above are on disk and
+// the rest are in the hash table. The probe side rows of the spilled
+// partitions are spilled by HashProbe and joined with the build side
+// rows one partition at a time after all probe input is seen.
+struct HashJoinSpill {
+  explicit HashJoinSpill(int32_t firstSpilledPartition)
+      : firstSpilledPartition(firstSpilledPartition),
+        buildFiles(JoinSpillPartitioner::kNumPartitions) {}
+
+  const int32_t firstSpilledPartition;
+
+  // The build side files for each partition. The columns are the keys
+  // followed by the dependent columns, as in the hash table.
+  std::vector<SpillFiles> buildFiles;
+};
+
+// True if the hash table of 'joinNode' needs only the build side
+// keys. Semi and anti joins without a filter only check whether a key
+// exists, so the other build side columns are not stored unless they
+// are in the output.
+bool isKeyOnlyJoin(const core::HashJoinNode& joinNode);
+
+// Accumulates the build side rows of a hash join in the RowContainer
+// of a join hash table. Used by HashBuild and by HashProbe for
+// making the tables of spilled partitions.
+class JoinTableBuilder {
+ public:
+  JoinTableBuilder(
+      const core::HashJoinNode& joinNode,
+      memory::MappedMemory* mappedMemory);
+
+  // Adds the rows of 'input' that are in 'rows'. The keys are the
+  // 'keyChannels' of 'input' and the dependent columns are the
+  // 'dependentChannels'. The dependent columns are not stored if the
+  // join is key-only.
+  void addRows(
+      const RowVector& input,
+      const std::vector<ChannelIndex>& keyChannels,
+      const std::vector<ChannelIndex>& dependentChannels,
+      const SelectivityVector& rows);
+
+  BaseHashTable* table() const {
+    return table_.get();
+  }
+
+  // Returns the table and starts a new empty one.
+  std::unique_ptr<BaseHashTable> takeTable();
+
+ private:
+  void makeTable();
+
+  const bool isRightJoin_;
+  const bool allowDuplicates_;
+  std::vector<TypePtr> keyTypes_;
+  std::vector<ChannelIndex> buildKeyChannels_;
+  std::vector<TypePtr> dependentTypes_;
+  memory::MappedMemory* const mappedMemory_;
+
+  // Container for the rows being accumulated.
+  std::unique_ptr<BaseHashTable> table_;
+
+  // Corresponds 1:1 to the dependent columns.
+  std::vector<std::unique_ptr<DecodedVector>> decoders_;
+
+  // True if we are considering use of normalized keys or array hash tables. Set
+  // to false when the dataset is no longer suitable.
+  bool analyzeKeys_;
+
+  // Temporary space for hash numbers.
+  std::vector<uint64_t> hashes_;
+};
+
 // Hands over a hash table from a multi-threaded build pipeline to a
 // multi-threaded probe pipeline. This is owned by shared_ptr by all the build
 // and probe Operator instances concerned. Corresponds to the Presto concept of
 // the same name.
 class HashJoinBridge : public JoinBridge {
  public:
-  void setHashTable(std::unique_ptr<BaseHashTable> table);
+  // Hands over the hash table. If the build side was partly spilled,
+  // 'spill' describes the spilled partitions and 'table' holds the
+  // rest. 'bloomFilters' is either empty or has a BloomFilter or
+  // nullptr for each join key.
+  void setHashTable(
+      std::unique_ptr<BaseHashTable> table,
+      std::shared_ptr<HashJoinSpill> spill = nullptr,
+      std::vector<std::shared_ptr<common::Filter>> bloomFilters = {});
 
   void setAntiJoinHasNullKeys();
 
+  // Hands over a table found in HashTableCache. The build side Drivers
+  // that still run then make no table of their own: later calls to
+  // setHashTable() and setAntiJoinHasNullKeys() have no effect.
+  void setCachedHashTable(std::shared_ptr<BaseHashTable> table);
+
+  // Makes setHashTable() add the table to HashTableCache under 'key'
+  // unless the build side was partly spilled.
+  void setHashTableCacheKey(std::string key);
+
   // Represents the result of a HashBuild operator: a hash table. In case of an
   // anti join, a build side entry with a null in a join key makes the join
   // return nothing. In this case, HashBuild operator finishes early without
@@ -40,13 +176,29 @@ class HashJoinBridge : public JoinBridge {
   struct HashBuildResult {
     std::shared_ptr<BaseHashTable> table;
     bool antiJoinHasNullKeys;
+    std::shared_ptr<HashJoinSpill> spill;
+    std::vector<std::shared_ptr<common::Filter>> bloomFilters;
   };
 
   std::optional<HashBuildResult> tableOrFuture(ContinueFuture* future);
 
+  // Adds the spilled probe side rows of one HashProbe. 'files' has an
+  // entry for each spill partition.
+  void addProbeSpillFiles(std::vector<SpillFiles>&& files);
+
+  // Returns the spilled probe side rows of all HashProbes, by partition.
+  std::vector<SpillFiles> takeProbeSpillFiles();
+
  private:
   std::shared_ptr<BaseHashTable> table_;
+  std::shared_ptr<HashJoinSpill> spill_;
+  std::vector<std::shared_ptr<common::Filter>> bloomFilters_;
+  std::vector<SpillFiles> probeSpillFiles_ =
+      std::vector<SpillFiles>(JoinSpillPartitioner::kNumPartitions);
   bool antiJoinHasNullKeys_{false};
+  // True if 'table_' comes from HashTableCache.
+  bool tableFromCache_{false};
+  std::string hashTableCacheKey_;
 };
 
 // Builds a hash table for use in HashProbe. This is the final
@@ -58,6 +210,13 @@ class HashJoinBridge : public JoinBridge {
 // table. This table is then passed to the probe side pipeline via
 // JoinBridge. After this, all build side Drivers finish and free
 // their state.
+//
+// If spilling is enabled, a Driver whose rows exceed the join spill
+// threshold or the memory limit writes half of its remaining in-memory
+// partitions of the build side to disk and from then on writes the
+// input rows of these partitions directly to disk. At the barrier, the
+// partitions spilled by any Driver are spilled by all and handed over
+// to the probe side together with the table of the other partitions.
 class HashBuild final : public Operator {
  public:
   HashBuild(
@@ -79,15 +238,44 @@ class HashBuild final : public Operator {
 
   BlockingReason isBlocked(ContinueFuture* future) override;
 
+  // Spills half of the partitions that are still in memory if spilling
+  // is enabled and the build side has not reached the barrier.
+  uint64_t reclaim(uint64_t bytes) override;
+
   void close() override {}
 
  private:
-  void addRuntimeStats();
+  // Size of a batch of rows moved out of the table when spilling.
+  static constexpr int32_t kSpillBatchSize = 10'000;
+
+  void addRuntimeStats(const BaseHashTable& table);
+
+  // Adds the rows of 'input' to the table or to the spill files of the
+  // spilled partitions. 'keyChannels' and 'dependentChannels' are as in
+  // JoinTableBuilder::addRows().
+  void addRows(
+      const RowVector& input,
+      const std::vector<ChannelIndex>& keyChannels,
+      const std::vector<ChannelIndex>& dependentChannels);
+
+  // Spills if adding 'input' would exceed the spill threshold or the
+  // memory limit.
+  void ensureInputFits(const RowVectorPtr& input);
+
+  // Keeps only the first 'numInMemoryPartitions' partitions in the
+  // table and writes the rows of the other partitions to disk.
+  void spill(int32_t numInMemoryPartitions);
+
+  // Returns a BloomFilter over the values of each join key in the
+  // tables of 'builds' or nullptr for keys of unsupported types. Returns
+  // an empty vector if no key has a supported type.
+  std::vector<std::shared_ptr<common::Filter>> makeBloomFilters(
+      const std::vector<HashBuild*>& builds);
 
   const core::JoinType joinType_;
 
-  // Container for the rows being accumulated.
-  std::unique_ptr<BaseHashTable> table_;
+  // Makes the table from the rows being accumulated.
+  std::unique_ptr<JoinTableBuilder> builder_;
 
   // Key channels in 'input_'
   std::vector<ChannelIndex> keyChannels_;
@@ -95,24 +283,31 @@ class HashBuild final : public Operator {
   // Non-key channels in 'input_'.
   std::vector<ChannelIndex> dependentChannels_;
 
-  // Corresponds 1:1 to 'dependentChannels_'.
-  std::vector<std::unique_ptr<DecodedVector>> decoders_;
+  // Spilled build side rows. Set if spilling is enabled.
+  std::unique_ptr<SpillState> spill_;
+  std::unique_ptr<JoinSpillPartitioner> spillPartitioner_;
+  uint64_t spillMemoryThreshold_ = 0;
+
+  // The partitions below this are in memory and the others are spilled.
+  int32_t numInMemoryPartitions_ = JoinSpillPartitioner::kNumPartitions;
+
+  // The key and dependent channels of rows extracted from the table,
+  // which has the keys first.
+  std::vector<ChannelIndex> tableKeyChannels_;
+  std::vector<ChannelIndex> tableDependentChannels_;
+
+  // Spill channels of the input, i.e. 'keyChannels_' followed by
+  // 'dependentChannels_'.
+  std::vector<ChannelIndex> spillChannels_;
 
-  // Holds the areas in RowContainer of 'table_'
-  memory::MappedMemory* mappedMemory_;
+  // Spill partition of each row of the input being added.
+  std::vector<int32_t> partitions_;
 
   // Future for synchronizing with other Drivers of the same pipeline. All build
   // Drivers must be completed before making the hash table.
   ContinueFuture future_{false};
   bool hasFuture_ = false;
 
-  // True if we are considering use of normalized keys or array hash tables. Set
-  // to false when the dataset is no longer suitable.
-  bool analyzeKeys_;
-
-  // Temporary space for hash numbers.
-  std::vector<uint64_t> hashes_;
-
   // Set of active rows during addInput().
   SelectivityVector activeRows_;
 
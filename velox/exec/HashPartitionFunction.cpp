@@ -16,12 +16,29 @@
 #include <velox/exec/HashPartitionFunction.h>
 #include <velox/exec/VectorHasher.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace facebook::velox::exec {
+namespace {
+// Maps 'hash' to [0, numPartitions) with a multiply and a shift instead
+// of a modulo. Folds the high half of the hash into the low half so
+// that all bits of the hash contribute.
+inline uint32_t toPartition(uint64_t hash, uint32_t numPartitions) {
+  auto folded = static_cast<uint32_t>(hash ^ (hash >> 32));
+  return (static_cast<uint64_t>(folded) * numPartitions) >> 32;
+}
+} // namespace
+
 HashPartitionFunction::HashPartitionFunction(
     int numPartitions,
     RowTypePtr inputType,
-    std::vector<ChannelIndex> keyChannels)
-    : numPartitions_{numPartitions}, keyChannels_{std::move(keyChannels)} {
+    std::vector<ChannelIndex> keyChannels,
+    int32_t hotKeySpread)
+    : numPartitions_{numPartitions},
+      keyChannels_{std::move(keyChannels)},
+      hotKeySpread_{std::min(hotKeySpread, numPartitions)} {
   hashers_.reserve(keyChannels_.size());
   for (auto channel : keyChannels_) {
     hashers_.emplace_back(
@@ -43,8 +60,89 @@ void HashPartitionFunction::partition(
   }
 
   partitions.resize(size);
-  for (auto i = 0; i < size; ++i) {
-    partitions[i] = hashes_[i] % numPartitions_;
+  int32_t i = 0;
+#if defined(__AVX2__)
+  // toPartition() for 4 hashes at a time.
+  auto numPartitions = _mm256_set1_epi64x(numPartitions_);
+  // Selects the low 32 bits of each 64 bit lane.
+  auto lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+  for (; i + 4 <= size; i += 4) {
+    auto hashes = _mm256_loadu_si256((__m256i*)(hashes_.data() + i));
+    auto folded = _mm256_xor_si256(hashes, _mm256_srli_epi64(hashes, 32));
+    auto products =
+        _mm256_srli_epi64(_mm256_mul_epu32(folded, numPartitions), 32);
+    _mm_storeu_si128(
+        (__m128i*)(partitions.data() + i),
+        _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(products, lowHalves)));
+  }
+#endif
+  for (; i < size; ++i) {
+    partitions[i] = toPartition(hashes_[i], numPartitions_);
+  }
+
+  if (hotKeySpread_ > 1) {
+    updateHotKeys(size);
+    if (!hotHashes_.empty()) {
+      spreadHotKeys(partitions);
+    }
+  }
+}
+
+void HashPartitionFunction::updateHotKeys(vector_size_t size) {
+  for (auto row = 0; row < size; row += kSampleStride) {
+    auto hash = hashes_[row];
+    ++numSamples_;
+    auto it = std::find_if(
+        hotKeyCounters_.begin(),
+        hotKeyCounters_.end(),
+        [&](const auto& counter) { return counter.hash == hash; });
+    if (it != hotKeyCounters_.end()) {
+      ++it->count;
+    } else if (hotKeyCounters_.size() < kMaxTrackedKeys) {
+      hotKeyCounters_.push_back({hash, 1});
+    } else {
+      // The least frequent hash gives its counter to the new one.
+      auto min = std::min_element(
+          hotKeyCounters_.begin(),
+          hotKeyCounters_.end(),
+          [](const auto& left, const auto& right) {
+            return left.count < right.count;
+          });
+      min->hash = hash;
+      ++min->count;
+    }
+  }
+  if (numSamples_ >= kMaxSamples) {
+    numSamples_ /= 2;
+    for (auto& counter : hotKeyCounters_) {
+      counter.count /= 2;
+    }
+  }
+
+  hotHashes_.clear();
+  if (numSamples_ < kMinSamples) {
+    return;
+  }
+  for (const auto& counter : hotKeyCounters_) {
+    if (counter.count * numPartitions_ > numSamples_) {
+      hotHashes_.insert(counter.hash);
+    }
+  }
+}
+
+void HashPartitionFunction::spreadHotKeys(std::vector<uint32_t>& partitions) {
+  for (auto i = 0; i < partitions.size(); ++i) {
+    if (!hotHashes_.contains(hashes_[i])) {
+      continue;
+    }
+    auto offset = nextSpread_;
+    nextSpread_ = nextSpread_ + 1 == hotKeySpread_ ? 0 : nextSpread_ + 1;
+    if (offset == 0) {
+      continue;
+    }
+    partitions[i] = (partitions[i] + offset) % numPartitions_;
+    ++numSpreadRows_;
   }
 }
 } // namespace facebook::velox::exec
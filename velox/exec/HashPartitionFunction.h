@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <folly/container/F14Set.h>
 #include <velox/exec/VectorHasher.h>
 #include "velox/core/PlanNode.h"
 
@@ -22,21 +23,67 @@ namespace facebook::velox::exec {
 
 class HashPartitionFunction : public core::PartitionFunction {
  public:
+  // If 'hotKeySpread' is greater than 1, keys that are found to take more
+  // than a fair share of one partition in a sample of the input are spread
+  // round robin over 'hotKeySpread' consecutive partitions starting at the
+  // partition of the key. This is only correct for consumers that do not
+  // need all rows of a key in one partition, e.g. a partial aggregation
+  // or the probe side of a join whose build side is broadcast.
   HashPartitionFunction(
       int numPartitions,
       RowTypePtr inputType,
-      std::vector<ChannelIndex> keyChannels);
+      std::vector<ChannelIndex> keyChannels,
+      int32_t hotKeySpread = 1);
 
   ~HashPartitionFunction() override = default;
 
   void partition(const RowVector& input, std::vector<uint32_t>& partitions)
       override;
 
+  // Number of rows of hot keys that were sent to a partition other than
+  // that of their key.
+  uint64_t numSpreadRows() const {
+    return numSpreadRows_;
+  }
+
  private:
+  // Every kSampleStride'th row feeds the hot key counters.
+  static constexpr int32_t kSampleStride = 16;
+  // Number of hash values with a counter.
+  static constexpr int32_t kMaxTrackedKeys = 32;
+  // No key is hot before this many samples.
+  static constexpr uint64_t kMinSamples = 64;
+  // The counters are halved when there are this many samples, so that
+  // keys stop being hot when their share of the input falls.
+  static constexpr uint64_t kMaxSamples = 1 << 16;
+
+  struct HotKeyCounter {
+    uint64_t hash;
+    uint64_t count;
+  };
+
+  // Adds a sample of 'hashes_' to 'hotKeyCounters_'. The counters count
+  // the most frequent hashes with the space saving algorithm. Updates
+  // 'hotHashes_'.
+  void updateHotKeys(vector_size_t size);
+
+  // Moves the rows of the keys in 'hotHashes_' to the next partition of
+  // the spread in round robin.
+  void spreadHotKeys(std::vector<uint32_t>& partitions);
+
   const int numPartitions_;
   const std::vector<ChannelIndex> keyChannels_;
+  const int32_t hotKeySpread_;
   std::vector<std::unique_ptr<VectorHasher>> hashers_;
 
+  std::vector<HotKeyCounter> hotKeyCounters_;
+  uint64_t numSamples_{0};
+  // Hashes of the keys whose rows are spread.
+  folly::F14FastSet<uint64_t> hotHashes_;
+  // The offset into the spread of the next row of a hot key.
+  uint32_t nextSpread_{0};
+  uint64_t numSpreadRows_{0};
+
   // Reusable memory.
   SelectivityVector rows_;
   std::vector<uint64_t> hashes_;
@@ -24,11 +24,12 @@ namespace facebook::velox::exec {
 namespace {
 
 // Returns the type for the hash table row. Build side keys first,
-// then dependent build side columns.
+// then dependent build side columns unless 'keysOnly' is true.
 std::shared_ptr<const RowType> makeTableType(
     const RowType* type,
     const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
-        keys) {
+        keys,
+    bool keysOnly) {
   std::vector<std::string> names;
   std::vector<TypePtr> types;
   std::unordered_set<ChannelIndex> keyChannels(keys.size());
@@ -40,7 +41,7 @@ std::shared_ptr<const RowType> makeTableType(
     types.emplace_back(type->childAt(channel));
     keyChannels.insert(channel);
   }
-  for (auto i = 0; i < type->size(); ++i) {
+  for (auto i = 0; i < type->size() && !keysOnly; ++i) {
     if (keyChannels.find(i) == keyChannels.end()) {
       names.emplace_back(type->nameOf(i));
       types.emplace_back(type->childAt(i));
@@ -76,8 +77,8 @@ HashProbe::HashProbe(
           joinNode->id(),
           "HashProbe"),
       joinType_{joinNode->joinType()},
-      filterResult_(1),
-      outputRows_(kOutputBatchSize) {
+      joinNode_(joinNode),
+      filterResult_(1) {
   checkJoinType(joinType_);
   auto probeType = joinNode->sources()[0]->outputType();
   auto numKeys = joinNode->leftKeys().size();
@@ -91,7 +92,8 @@ HashProbe::HashProbe(
   }
   lookup_ = std::make_unique<HashLookup>(hashers_);
   auto buildType = joinNode->sources()[1]->outputType();
-  auto tableType = makeTableType(buildType.get(), joinNode->rightKeys());
+  auto tableType = makeTableType(
+      buildType.get(), joinNode->rightKeys(), isKeyOnlyJoin(*joinNode));
   if (joinNode->filter()) {
     initializeFilter(joinNode->filter(), probeType, tableType);
   }
@@ -117,6 +119,28 @@ HashProbe::HashProbe(
 
   if (isIdentityProjection && tableResultProjections_.empty()) {
     isIdentityProjection_ = true;
+    isFilterOnly_ = (isInnerJoin(joinType_) || isSemiJoin(joinType_)) &&
+        !filter_ && identityProjections_.size() == probeType->size() &&
+        outputType_->size() == probeType->size();
+  }
+
+  if (operatorCtx_->queryCtx()->spillEnabled()) {
+    probeType_ = probeType;
+    tableType_ = tableType;
+    for (ChannelIndex i = 0; i < tableType->size(); ++i) {
+      if (i < numKeys) {
+        keyTypes_.push_back(tableType->childAt(i));
+        tableKeyChannels_.push_back(i);
+      } else {
+        tableDependentChannels_.push_back(i);
+      }
+      tableChannels_.push_back(i);
+    }
+    for (ChannelIndex i = 0; i < probeType->size(); ++i) {
+      probeChannels_.push_back(i);
+    }
+    spillMemoryThreshold_ =
+        operatorCtx_->queryCtx()->joinSpillMemoryThreshold();
   }
 }
 
@@ -160,7 +184,12 @@ void HashProbe::initializeFilter(
 }
 
 BlockingReason HashProbe::isBlocked(ContinueFuture* future) {
-  if (table_) {
+  if (hasFuture_) {
+    *future = std::move(future_);
+    hasFuture_ = false;
+    return BlockingReason::kWaitForPeers;
+  }
+  if (table_ || joiningSpilledPartitions_) {
     return BlockingReason::kNotBlocked;
   }
 
@@ -177,7 +206,12 @@ BlockingReason HashProbe::isBlocked(ContinueFuture* future) {
     isFinishing_ = true;
   } else {
     table_ = hashBuildResult->table;
-    if (table_->numDistinct() == 0) {
+    joinSpill_ = hashBuildResult->spill;
+    if (joinSpill_) {
+      // The table has only part of the build side. Dynamic filters and
+      // shortcuts for an empty build side do not apply.
+      initializeSpill();
+    } else if (table_->numDistinct() == 0) {
       // Build side is empty. Inner, right and semi joins return nothing in this
       // case, hence, we can terminate the pipeline early.
       if (isInnerJoin(joinType_) || isSemiJoin(joinType_) ||
@@ -186,20 +220,30 @@ BlockingReason HashProbe::isBlocked(ContinueFuture* future) {
       }
     } else if (
         (isInnerJoin(joinType_) || isSemiJoin(joinType_)) &&
-        table_->hashMode() != BaseHashTable::HashMode::kHash) {
+        (table_->hashMode() != BaseHashTable::HashMode::kHash ||
+         !hashBuildResult->bloomFilters.empty())) {
       // Find out whether there are any upstream operators that can accept
       // dynamic filters on all or a subset of the join keys. Setup dynamic
       // filter builders to track join selectivity for these keys and generate
-      // dynamic filters to push down.
+      // dynamic filters to push down. The VectorHashers make filters only
+      // if the table uses value ids.
       const auto& buildHashers = table_->hashers();
+      const auto& bloomFilters = hashBuildResult->bloomFilters;
       auto channels = operatorCtx_->driverCtx()->driver->canPushdownFilters(
           this, keyChannels_);
       dynamicFilterBuilders_.resize(keyChannels_.size());
       for (auto i = 0; i < keyChannels_.size(); i++) {
         auto it = channels.find(keyChannels_[i]);
-        if (it != channels.end()) {
+        if (it == channels.end()) {
+          continue;
+        }
+        auto hasher = table_->hashMode() != BaseHashTable::HashMode::kHash
+            ? buildHashers[i].get()
+            : nullptr;
+        auto bloomFilter = bloomFilters.empty() ? nullptr : bloomFilters[i];
+        if (hasher || bloomFilter) {
           dynamicFilterBuilders_[i].emplace(DynamicFilterBuilder(
-              *(buildHashers[i].get()), keyChannels_[i], dynamicFilters_));
+              hasher, bloomFilter, keyChannels_[i], dynamicFilters_));
         }
       }
     }
@@ -212,15 +256,29 @@ void HashProbe::clearDynamicFilters() {
   // The join can be completely replaced with a pushed down
   // filter when the following conditions are met:
   //  * hash table has a single key with unique values,
-  //  * build side has no dependent columns.
+  //  * build side has no dependent columns,
+  //  * the filter passes only the build side keys, i.e. is not a
+  //    BloomFilter.
   if (keyChannels_.size() == 1 && !table_->hasDuplicateKeys() &&
       tableResultProjections_.empty() && !filter_ && !dynamicFilters_.empty()) {
-    canReplaceWithDynamicFilter_ = true;
+    canReplaceWithDynamicFilter_ = std::none_of(
+        dynamicFilters_.begin(), dynamicFilters_.end(), [](const auto& entry) {
+          return entry.second->kind() == common::FilterKind::kBloomFilter;
+        });
   }
 
   Operator::clearDynamicFilters();
 }
 
+bool HashProbe::canReorder() const {
+  if (!isFilterOnly_ || !table_ || input_ || isFinishing_ || joinSpill_ ||
+      probeSpill_ || joiningSpilledPartitions_) {
+    return false;
+  }
+  // An inner join with duplicate build keys may add rows.
+  return isSemiJoin(joinType_) || !table_->hasDuplicateKeys();
+}
+
 void HashProbe::addInput(RowVectorPtr input) {
   input_ = std::move(input);
   newInputForLeftJoin_ = isLeftJoin(joinType_);
@@ -230,7 +288,23 @@ void HashProbe::addInput(RowVectorPtr input) {
     return;
   }
 
+  if (probeSpill_) {
+    spillInput();
+    if (!input_) {
+      return;
+    }
+  }
+
+  passingInputRows_.resize(input_->size());
+  passingInputRows_.setAll();
+
   if (table_->numDistinct() == 0) {
+    if (joinSpill_ && !isLeftJoin(joinType_)) {
+      // The partitions in 'table_' have no build side rows. Other
+      // partitions may have.
+      input_ = nullptr;
+      return;
+    }
     // Build side is empty. This state is valid only for anti and left joins.
     VELOX_CHECK(isAntiJoin(joinType_) || isLeftJoin(joinType_));
     return;
@@ -293,22 +367,36 @@ void HashProbe::addInput(RowVectorPtr input) {
   lookup_->hits.resize(lookup_->rows.back() + 1);
   table_->joinProbe(*lookup_);
   results_.reset(*lookup_);
+
+  if (isInnerJoin(joinType_) || isSemiJoin(joinType_) ||
+      isRightJoin(joinType_)) {
+    // Only the probe rows with a match can be in the output.
+    passingInputRows_ = activeRows_;
+    for (auto row : lookup_->rows) {
+      if (!lookup_->hits[row]) {
+        passingInputRows_.setValid(row, false);
+      }
+    }
+    passingInputRows_.updateBounds();
+  }
 }
 
 namespace {
 // Copy values from 'rows' of 'table' according to 'projections' in
-// 'result'. Reuses 'result' children where possible.
+// 'result'. Reuses 'result' children where possible and otherwise takes
+// recycled vectors from 'vectorPool'.
 void extractColumns(
     BaseHashTable* table,
     folly::Range<char**> rows,
     folly::Range<const IdentityProjection*> projections,
     memory::MemoryPool* pool,
+    VectorPool& vectorPool,
     const RowVectorPtr& result) {
   for (auto projection : projections) {
     auto& child = result->childAt(projection.outputChannel);
     // TODO: Consider reuse of complex types.
     if (!child || !BaseVector::isReusableFlatVector(child)) {
-      child = BaseVector::create(
+      child = vectorPool.get(
           result->type()->childAt(projection.outputChannel), rows.size(), pool);
     }
     child->resize(rows.size());
@@ -317,6 +405,51 @@ void extractColumns(
   }
 }
 
+// Loads a column of a hash table for a subset of the rows of a LazyVector
+// over the hits of a batch of probe output. Keeps the table alive so that
+// the column can be loaded after the probe has moved on to the next batch
+// or to another table.
+class TableColumnLoader : public VectorLoader {
+ public:
+  TableColumnLoader(
+      std::shared_ptr<BaseHashTable> table,
+      BufferPtr rows,
+      ChannelIndex column,
+      TypePtr type,
+      memory::MemoryPool* pool)
+      : table_(std::move(table)),
+        rows_(std::move(rows)),
+        column_(column),
+        type_(std::move(type)),
+        pool_(pool) {}
+
+  void load(RowSet rows, ValueHook* hook, VectorPtr* result) override {
+    // Aggregations are not pushed down past a join.
+    VELOX_CHECK_NULL(hook, "Hash join output does not support ValueHook");
+    auto tableRows = rows_->as<char*>();
+    auto size = rows.back() + 1;
+    *result = BaseVector::create(type_, size, pool_);
+    if (rows.size() == size) {
+      table_->rows()->extractColumn(tableRows, size, column_, *result);
+      return;
+    }
+    // Rows that are not loaded are extracted as nulls.
+    std::vector<char*> selectedRows(size, nullptr);
+    for (auto row : rows) {
+      selectedRows[row] = tableRows[row];
+    }
+    table_->rows()->extractColumn(selectedRows.data(), size, column_, *result);
+  }
+
+ private:
+  const std::shared_ptr<BaseHashTable> table_;
+  // The rows of 'table_' for the rows of the LazyVector.
+  const BufferPtr rows_;
+  const ChannelIndex column_;
+  const TypePtr type_;
+  memory::MemoryPool* const pool_;
+};
+
 folly::Range<vector_size_t*> initializeRowNumberMapping(
     BufferPtr& mapping,
     vector_size_t size,
@@ -330,6 +463,15 @@ folly::Range<vector_size_t*> initializeRowNumberMapping(
 } // namespace
 
 void HashProbe::prepareOutput(vector_size_t size) {
+  if (output_ && output_.unique()) {
+    // Lazy build-side columns of the previous batch are not reusable.
+    for (const auto& projection : tableResultProjections_) {
+      auto& child = output_->childAt(projection.outputChannel);
+      if (child && child->encoding() == VectorEncoding::Simple::LAZY) {
+        child = nullptr;
+      }
+    }
+  }
   VectorPtr outputAsBase = std::move(output_);
   BaseVector::ensureWritable(
       SelectivityVector::empty(), outputType_, pool(), &outputAsBase);
@@ -341,14 +483,10 @@ void HashProbe::fillOutput(vector_size_t size) {
   prepareOutput(size);
 
   for (auto projection : identityProjections_) {
-    // Load input vector if it is being split into multiple batches. It is not
-    // safe to wrap unloaded LazyVector into two different dictionaries.
-    auto inputChild = size == outputRows_.size()
-        ? input_->loadedChildAt(projection.inputChannel)
-        : input_->childAt(projection.inputChannel);
-
-    output_->childAt(projection.outputChannel) =
-        wrapChild(size, rowNumberMapping_, inputChild);
+    output_->childAt(projection.outputChannel) = wrapChild(
+        size,
+        rowNumberMapping_,
+        probeInputColumn(projection.inputChannel, size));
   }
 
   if (newInputForLeftJoin_) {
@@ -358,14 +496,35 @@ void HashProbe::fillOutput(vector_size_t size) {
           BaseVector::createNullConstant(
               outputType_->childAt(projection.outputChannel), size, pool());
     }
-  } else {
-    extractColumns(
-        table_.get(),
-        folly::Range<char**>(outputRows_.data(), size),
-        tableResultProjections_,
-        pool(),
-        output_);
+  } else if (!tableResultProjections_.empty()) {
+    // Build-side columns are extracted on first use and only for the rows
+    // that are used, so that columns dropped or rows filtered out
+    // downstream are never read from the table.
+    auto rows = AlignedBuffer::allocate<char*>(size, pool());
+    memcpy(rows->asMutable<char*>(), outputRows_.data(), size * sizeof(char*));
+    for (const auto& projection : tableResultProjections_) {
+      const auto& type = outputType_->childAt(projection.outputChannel);
+      output_->childAt(projection.outputChannel) =
+          std::make_shared<LazyVector>(
+              pool(),
+              type,
+              size,
+              std::make_unique<TableColumnLoader>(
+                  table_, rows, projection.inputChannel, type, pool()));
+    }
+  }
+}
+
+vector_size_t HashProbe::outputBatchSize() const {
+  uint64_t rowSize = 0;
+  if (input_ && input_->size() > 0) {
+    rowSize += input_->retainedSize() / input_->size();
+  }
+  if (auto buildRowSize = table_->rows()->estimateRowSize()) {
+    rowSize += buildRowSize.value();
   }
+  return outputBatchRows(
+      rowSize > 0 ? std::optional<uint64_t>(rowSize) : std::nullopt);
 }
 
 RowVectorPtr HashProbe::getNonMatchingOutputForRightJoin() {
@@ -373,10 +532,10 @@ RowVectorPtr HashProbe::getNonMatchingOutputForRightJoin() {
     return nullptr;
   }
 
-  outputRows_.resize(kOutputBatchSize);
+  outputRows_.resize(outputBatchSize());
   auto numOut = table_->listNotProbedRows(
       &rightJoinIterator_,
-      kOutputBatchSize,
+      outputRows_.size(),
       RowContainer::kUnlimited,
       outputRows_.data());
   if (!numOut) {
@@ -396,6 +555,7 @@ RowVectorPtr HashProbe::getNonMatchingOutputForRightJoin() {
       folly::Range<char**>(outputRows_.data(), numOut),
       tableResultProjections_,
       pool(),
+      operatorCtx_->vectorPool(),
       output_);
   return output_;
 }
@@ -403,6 +563,9 @@ RowVectorPtr HashProbe::getNonMatchingOutputForRightJoin() {
 RowVectorPtr HashProbe::getOutput() {
   clearIdentityProjectedOutput();
   if (!input_) {
+    if (joiningSpilledPartitions_) {
+      return getOutputFromSpill();
+    }
     if (isFinishing_ && isRightJoin(joinType_)) {
       return getNonMatchingOutputForRightJoin();
     }
@@ -426,11 +589,12 @@ RowVectorPtr HashProbe::getOutput() {
   // Semi and anti joins are always cardinality reducing, e.g. for a given row
   // of input they produce zero or 1 row of output. Therefore, we can process
   // each batch of input in one go.
-  auto outputBatchSize =
-      (isSemiOrAntiJoin || newInputForLeftJoin_) ? inputSize : kOutputBatchSize;
+  auto batchSize = (isSemiOrAntiJoin || newInputForLeftJoin_)
+      ? inputSize
+      : outputBatchSize();
   auto mapping =
-      initializeRowNumberMapping(rowNumberMapping_, outputBatchSize, pool());
-  outputRows_.resize(outputBatchSize);
+      initializeRowNumberMapping(rowNumberMapping_, batchSize, pool());
+  outputRows_.resize(batchSize);
 
   for (;;) {
     int numOut = 0;
@@ -450,6 +614,17 @@ RowVectorPtr HashProbe::getOutput() {
           ++numOut;
         }
       }
+    } else if (isSemiJoin(joinType_) && !filter_) {
+      // Without a filter, a semi join returns each probe row with a
+      // match once. The first hit decides, so there is no need to list
+      // the join results.
+      for (auto i = 0; i < inputSize; ++i) {
+        if (activeRows_.isValid(i) && lookup_->hits[i]) {
+          mapping[numOut] = i;
+          outputRows_[numOut] = lookup_->hits[i];
+          ++numOut;
+        }
+      }
     } else {
       if (newInputForLeftJoin_) {
         // Collect probe rows with no match.
@@ -513,7 +688,9 @@ void HashProbe::fillFilterInput(vector_size_t size) {
   filterInput_->resize(size);
   for (auto projection : filterProbeInputs_) {
     filterInput_->childAt(projection.outputChannel) = wrapChild(
-        size, rowNumberMapping_, input_->childAt(projection.inputChannel));
+        size,
+        rowNumberMapping_,
+        probeInputColumn(projection.inputChannel, size));
   }
 
   extractColumns(
@@ -521,9 +698,22 @@ void HashProbe::fillFilterInput(vector_size_t size) {
       folly::Range<char**>(outputRows_.data(), size),
       filterBuildInputs_,
       pool(),
+      operatorCtx_->vectorPool(),
       filterInput_);
 }
 
+VectorPtr HashProbe::probeInputColumn(
+    ChannelIndex channel,
+    vector_size_t size) {
+  const auto& column = input_->childAt(channel);
+  // A full batch may be followed by more batches for the same input. The
+  // misses of a left join are followed by the matches.
+  if (size == outputRows_.size() || newInputForLeftJoin_) {
+    LazyVector::ensureLoadedRows(*column, passingInputRows_);
+  }
+  return column;
+}
+
 int32_t HashProbe::evalFilter(int32_t numRows) {
   if (!filter_) {
     return numRows;
@@ -571,18 +761,235 @@ int32_t HashProbe::evalFilter(int32_t numRows) {
 
 void HashProbe::finish() {
   Operator::finish();
-  if (isRightJoin(joinType_)) {
+  auto bridge = operatorCtx_->task()->getHashJoinBridge(planNodeId());
+  if (probeSpill_) {
+    std::vector<SpillFiles> files(JoinSpillPartitioner::kNumPartitions);
+    for (auto partition = joinSpill_->firstSpilledPartition;
+         partition < files.size();
+         ++partition) {
+      probeSpill_->finishWrite(partition);
+      files[partition] = probeSpill_->takeFiles(partition);
+    }
+    stats_.addRuntimeStat("spilledBytes", probeSpill_->spilledBytes());
+    stats_.addRuntimeStat("spilledRows", probeSpill_->spilledRows());
+    bridge->addProbeSpillFiles(std::move(files));
+    probeSpill_.reset();
+  }
+  if (isRightJoin(joinType_) || joinSpill_) {
     std::vector<VeloxPromise<bool>> promises;
     std::vector<std::shared_ptr<Driver>> peers;
-    // The last Driver to hit HashProbe::finish is responsible for producing
-    // non-matching build-side rows for the right join.
+    // Without spilling, all Drivers wait for the last one to finish
+    // probing and then each produces the non-matching build-side rows
+    // of its share of the RowContainers for the right join. Otherwise
+    // the last Driver produces these for all and joins the spilled
+    // partitions.
+    const bool parallelRightJoin = isRightJoin(joinType_) && !joinSpill_;
+    if (parallelRightJoin) {
+      rightJoinIterator_.partition_ = operatorCtx_->driverCtx()->driverId;
+      rightJoinIterator_.numPartitions_ =
+          operatorCtx_->driverCtx()->numDrivers;
+    }
     ContinueFuture future{false};
     if (!operatorCtx_->task()->allPeersFinished(
             planNodeId(), operatorCtx_->driver(), &future, promises, peers)) {
+      if (parallelRightJoin) {
+        future_ = std::move(future);
+        hasFuture_ = true;
+        lastRightJoinProbe_ = true;
+      }
       return;
     }
 
-    lastRightJoinProbe_ = true;
+    lastRightJoinProbe_ = isRightJoin(joinType_);
+    if (parallelRightJoin) {
+      for (auto& promise : promises) {
+        promise.setValue(true);
+      }
+    }
+    if (joinSpill_) {
+      auto probeFiles = bridge->takeProbeSpillFiles();
+      for (auto partition = joinSpill_->firstSpilledPartition;
+           partition < JoinSpillPartitioner::kNumPartitions;
+           ++partition) {
+        pendingPartitions_.push_back(
+            {std::move(joinSpill_->buildFiles[partition]),
+             std::move(probeFiles[partition]),
+             0});
+      }
+      joiningSpilledPartitions_ = true;
+    }
+  }
+}
+
+void HashProbe::initializeSpill() {
+  VELOX_CHECK(
+      probeType_, "Build side spilled but spilling is not enabled for probe");
+  spillPartitioner_ = std::make_unique<JoinSpillPartitioner>(keyTypes_, 0);
+  probeSpill_ = makeSpillState("probe", probeType_);
+}
+
+std::unique_ptr<SpillState> HashProbe::makeSpillState(
+    const std::string& side,
+    const RowTypePtr& type) {
+  return std::make_unique<SpillState>(
+      fmt::format(
+          "{}/{}_{}_{}_{}{}",
+          operatorCtx_->queryCtx()->spillPath(),
+          operatorCtx_->taskId(),
+          planNodeId(),
+          operatorCtx_->driverCtx()->driverId,
+          side,
+          numSpillStates_++),
+      JoinSpillPartitioner::kNumPartitions,
+      type,
+      std::vector<CompareFlags>{},
+      *pool());
+}
+
+void HashProbe::spillInput() {
+  auto numInput = input_->size();
+  spillRows_.resize(numInput);
+  spillRows_.setAll();
+  spillPartitioner_->partition(*input_, keyChannels_, spillRows_, partitions_);
+  spillJoinRows(
+      *input_,
+      probeChannels_,
+      partitions_,
+      joinSpill_->firstSpilledPartition,
+      spillRows_,
+      *probeSpill_,
+      *pool());
+  auto numRemaining = spillRows_.countSelected();
+  if (numRemaining == 0) {
+    input_ = nullptr;
+    return;
+  }
+  if (numRemaining < numInput) {
+    auto indices = AlignedBuffer::allocate<vector_size_t>(numRemaining, pool());
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    vector_size_t numIndices = 0;
+    spillRows_.applyToSelected(
+        [&](vector_size_t row) { rawIndices[numIndices++] = row; });
+    input_ = wrap(numRemaining, indices, input_);
+  }
+}
+
+RowVectorPtr HashProbe::getOutputFromSpill() {
+  for (;;) {
+    if (input_) {
+      if (auto output = getOutput()) {
+        return output;
+      }
+      continue;
+    }
+    if (auto input = nextSpilledProbeInput()) {
+      addInput(std::move(input));
+      continue;
+    }
+    if (table_ && isRightJoin(joinType_)) {
+      if (auto output = getNonMatchingOutputForRightJoin()) {
+        return output;
+      }
+    }
+    if (!startNextSpilledPartition()) {
+      return nullptr;
+    }
   }
 }
+
+RowVectorPtr HashProbe::nextSpilledProbeInput() {
+  while (!spilledProbeInput_.empty()) {
+    if (auto batch = spilledProbeInput_.back()->nextVector()) {
+      return batch;
+    }
+    spilledProbeInput_.pop_back();
+  }
+  spilledProbeFiles_.clear();
+  return nullptr;
+}
+
+bool HashProbe::startNextSpilledPartition() {
+  table_.reset();
+  while (!pendingPartitions_.empty()) {
+    auto partition = std::move(pendingPartitions_.back());
+    pendingPartitions_.pop_back();
+    // Skip the partitions that can produce no output.
+    if (partition.probe.empty() && !isRightJoin(joinType_)) {
+      continue;
+    }
+    if (partition.build.empty() && !isLeftJoin(joinType_)) {
+      continue;
+    }
+    if (loadSpilledPartition(partition)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HashProbe::loadSpilledPartition(SpilledPartition& partition) {
+  if (!spillTableBuilder_) {
+    spillTableBuilder_ = std::make_unique<JoinTableBuilder>(
+        *joinNode_, operatorCtx_->mappedMemory());
+  }
+  bool mayRepartition = spillMemoryThreshold_ &&
+      partition.level + 1 < JoinSpillPartitioner::kMaxLevels;
+  for (auto& file : partition.build) {
+    auto stream = file->read(*pool());
+    while (auto batch = stream->nextVector()) {
+      spillRows_.resize(batch->size());
+      spillRows_.setAll();
+      spillTableBuilder_->addRows(
+          *batch, tableKeyChannels_, tableDependentChannels_, spillRows_);
+      if (mayRepartition &&
+          spillTableBuilder_->table()->allocatedBytes() >=
+              static_cast<int64_t>(spillMemoryThreshold_)) {
+        spillTableBuilder_->takeTable();
+        repartition(partition);
+        return false;
+      }
+    }
+  }
+  partition.build.clear();
+  table_ = spillTableBuilder_->takeTable();
+  table_->prepareJoinTable({});
+  rightJoinIterator_ = {};
+  spilledProbeFiles_ = std::move(partition.probe);
+  for (auto& file : spilledProbeFiles_) {
+    spilledProbeInput_.push_back(file->read(*pool()));
+  }
+  return true;
+}
+
+void HashProbe::repartition(SpilledPartition& partition) {
+  auto level = partition.level + 1;
+  JoinSpillPartitioner partitioner(keyTypes_, level);
+  auto spillFiles = [&](SpillFiles& files,
+                        const std::vector<ChannelIndex>& keyChannels,
+                        const std::vector<ChannelIndex>& channels,
+                        SpillState& spill) {
+    for (auto& file : files) {
+      auto stream = file->read(*pool());
+      while (auto batch = stream->nextVector()) {
+        spillRows_.resize(batch->size());
+        spillRows_.setAll();
+        partitioner.partition(*batch, keyChannels, spillRows_, partitions_);
+        spillJoinRows(
+            *batch, channels, partitions_, 0, spillRows_, spill, *pool());
+      }
+    }
+    files.clear();
+  };
+  auto buildSpill = makeSpillState("build", tableType_);
+  auto probeSpill = makeSpillState("probe", probeType_);
+  spillFiles(partition.build, tableKeyChannels_, tableChannels_, *buildSpill);
+  spillFiles(partition.probe, keyChannels_, probeChannels_, *probeSpill);
+  for (auto i = 0; i < JoinSpillPartitioner::kNumPartitions; ++i) {
+    buildSpill->finishWrite(i);
+    probeSpill->finishWrite(i);
+    pendingPartitions_.push_back(
+        {buildSpill->takeFiles(i), probeSpill->takeFiles(i), level});
+  }
+  stats_.addRuntimeStat("spillRepartitions", 1);
+}
 } // namespace facebook::velox::exec
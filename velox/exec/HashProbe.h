@@ -22,7 +22,11 @@
 
 namespace facebook::velox::exec {
 
-// Probes a hash table made by HashBuild.
+// Probes a hash table made by HashBuild. If the build side was partly
+// spilled, the probe rows of the spilled partitions are spilled as
+// well. After all probe input is seen, the last HashProbe of the
+// pipeline joins the spilled partitions one by one. A partition whose
+// build side does not fit in memory is partitioned again.
 class HashProbe : public Operator {
  public:
   HashProbe(
@@ -44,11 +48,14 @@ class HashProbe : public Operator {
 
   void clearDynamicFilters() override;
 
+  bool canReorder() const override;
+
   void close() override {}
 
  private:
-  // TODO: Define batch size as bytes based on RowContainer row sizes.
-  static constexpr int32_t kOutputBatchSize = 1'000;
+  // Returns the number of rows of an output batch for the width of
+  // the rows of 'input_' plus the width of the build side rows.
+  vector_size_t outputBatchSize() const;
 
   // Sets up 'filter_' and related members.
   void initializeFilter(
@@ -69,27 +76,87 @@ class HashProbe : public Operator {
   // Populate filter input columns.
   void fillFilterInput(vector_size_t size);
 
+  // Returns the probe-side column at 'channel' of 'input_' for wrapping
+  // in a dictionary over 'size' rows of output or filter input. A
+  // LazyVector can be loaded only once. If later batches for the same
+  // input may wrap the column again, an unloaded LazyVector is first
+  // loaded for 'passingInputRows_'. Otherwise it stays lazy and is
+  // loaded downstream for the rows that are actually needed.
+  VectorPtr probeInputColumn(ChannelIndex channel, vector_size_t size);
+
+  // Sets up spilling of the probe side after receiving a partly spilled
+  // build side.
+  void initializeSpill();
+
+  // Returns a SpillState for spilling rows of 'type' for a hash join
+  // partition.
+  std::unique_ptr<SpillState> makeSpillState(
+      const std::string& side,
+      const RowTypePtr& type);
+
+  // Writes the rows of 'input_' in spilled partitions to disk and keeps
+  // the others in 'input_'. Sets 'input_' to nullptr if all rows are
+  // spilled.
+  void spillInput();
+
+  // Produces the output of the spilled partitions after the output of
+  // the in-memory ones.
+  RowVectorPtr getOutputFromSpill();
+
+  // Returns the next batch of probe rows of the current spilled
+  // partition or nullptr if there are no more.
+  RowVectorPtr nextSpilledProbeInput();
+
+  // Makes the table for the next spilled partition. Returns false if
+  // there are no more partitions.
+  bool startNextSpilledPartition();
+
+  // A spilled partition with the build and probe side rows.
+  struct SpilledPartition {
+    SpillFiles build;
+    SpillFiles probe;
+    // Number of times the rows of the partition have been partitioned
+    // before.
+    int32_t level;
+  };
+
+  // Makes 'table_' from the build side of 'partition' and starts reading
+  // its probe side. Returns false if the build side does not fit in
+  // memory, in which case 'partition' is partitioned again.
+  bool loadSpilledPartition(SpilledPartition& partition);
+
+  // Divides the rows of 'partition' into partitions of the next level and
+  // adds these to 'pendingPartitions_'.
+  void repartition(SpilledPartition& partition);
+
   // Applies 'filter_' to 'outputRows_' and updates 'outputRows_' and
   // 'rowNumberMapping_'. Returns the number of passing rows.
   vector_size_t evalFilter(vector_size_t numRows);
 
   const core::JoinType joinType_;
 
+  const std::shared_ptr<const core::HashJoinNode> joinNode_;
+
   std::unique_ptr<HashLookup> lookup_;
 
   // Channel of probe keys in 'input_'.
   std::vector<ChannelIndex> keyChannels_;
 
   // Tracks selectivity of a given VectorHasher from the build side and creates
-  // a filter to push down upstream if the hasher is somewhat selective.
+  // a filter to push down upstream if the hasher is somewhat selective. If
+  // the hasher cannot make a filter, e.g. because there are too many
+  // distinct values or the table is in kHash mode, pushes down
+  // 'bloomFilter' instead. 'buildHasher' and 'bloomFilter' may be null.
   class DynamicFilterBuilder {
    public:
     DynamicFilterBuilder(
-        const VectorHasher& buildHasher,
+        const VectorHasher* buildHasher,
+        std::shared_ptr<common::Filter> bloomFilter,
         ChannelIndex channel,
         std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>&
             dynamicFilters)
         : buildHasher_{buildHasher},
+          bloomFilter_{std::move(bloomFilter)},
           channel_{channel},
           dynamicFilters_{dynamicFilters} {}
 
@@ -107,7 +174,14 @@ class HashProbe : public Operator {
       // Add filter if VectorHasher is somewhat selective, e.g. dropped at least
       // 1/3 of the rows. Make sure we have seen at least 10K rows.
       if (isActive_ && numIn_ >= 10'000 && numOut_ < 0.66 * numIn_) {
-        if (auto filter = buildHasher_.getFilter(false)) {
+        std::shared_ptr<common::Filter> filter;
+        if (buildHasher_) {
+          filter = buildHasher_->getFilter(false);
+        }
+        if (!filter) {
+          filter = bloomFilter_;
+        }
+        if (filter) {
           dynamicFilters_.emplace(channel_, std::move(filter));
         }
         isActive_ = false;
@@ -115,7 +189,8 @@ class HashProbe : public Operator {
     }
 
    private:
-    const VectorHasher& buildHasher_;
+    const VectorHasher* const buildHasher_;
+    const std::shared_ptr<common::Filter> bloomFilter_;
     const ChannelIndex channel_;
     std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>&
         dynamicFilters_;
@@ -134,6 +209,11 @@ class HashProbe : public Operator {
   // True if the join became a no-op after pushing down the filter.
   bool replacedWithDynamicFilter_{false};
 
+  // True if the join has no filter and its output is its probe input,
+  // i.e. it only drops probe rows unless the build keys have
+  // duplicates.
+  bool isFilterOnly_{false};
+
   std::vector<std::unique_ptr<VectorHasher>> hashers_;
 
   // Table shared between other HashProbes in other Drivers of the
@@ -225,6 +305,12 @@ class HashProbe : public Operator {
 
   BaseHashTable::NotProbedRowsIterator rightJoinIterator_;
 
+  /// Realized when all probe Drivers have finished probing, so that
+  /// each can list its share of the not-probed build-side rows of the
+  /// right join.
+  ContinueFuture future_{false};
+  bool hasFuture_{false};
+
   /// For left join, tracks the probe side rows which had matches on the build
   /// side but didn't pass the filter.
   LeftJoinTracker leftJoinTracker_;
@@ -239,6 +325,59 @@ class HashProbe : public Operator {
   // Input rows with a hash match. This is a subset of rows with no nulls in the
   // join keys and a superset of rows that have a match on the build side.
   SelectivityVector activeRows_;
+
+  // Input rows that can appear in the output. These are all rows for
+  // left and anti joins and the rows of 'activeRows_' with a match for
+  // the other joins.
+  SelectivityVector passingInputRows_;
+
+  // Set if the build side was partly spilled.
+  std::shared_ptr<HashJoinSpill> joinSpill_;
+
+  // The probe rows of the spilled partitions. Set until finish().
+  std::unique_ptr<SpillState> probeSpill_;
+  std::unique_ptr<JoinSpillPartitioner> spillPartitioner_;
+  uint64_t spillMemoryThreshold_ = 0;
+
+  // Number of SpillStates made, used for naming the spill files.
+  int32_t numSpillStates_ = 0;
+
+  RowTypePtr probeType_;
+
+  // Type of the spilled build side rows, with the keys first as in the
+  // table.
+  RowTypePtr tableType_;
+  std::vector<TypePtr> keyTypes_;
+
+  // Channels of the keys, the dependent columns and all columns in a
+  // spilled build side row.
+  std::vector<ChannelIndex> tableKeyChannels_;
+  std::vector<ChannelIndex> tableDependentChannels_;
+  std::vector<ChannelIndex> tableChannels_;
+
+  // All channels of the probe input.
+  std::vector<ChannelIndex> probeChannels_;
+
+  // Spill partition of each row of the rows being spilled.
+  std::vector<int32_t> partitions_;
+
+  // Rows of a batch being spilled or added to a table.
+  SelectivityVector spillRows_;
+
+  // Makes the tables of the spilled partitions.
+  std::unique_ptr<JoinTableBuilder> spillTableBuilder_;
+
+  // True once the last HashProbe starts producing output for the spilled
+  // partitions.
+  bool joiningSpilledPartitions_{false};
+
+  // Spilled partitions that are not yet joined.
+  std::vector<SpilledPartition> pendingPartitions_;
+
+  // The probe rows of the partition being joined and the streams over
+  // these.
+  SpillFiles spilledProbeFiles_;
+  std::vector<std::unique_ptr<SpillStream>> spilledProbeInput_;
 };
 
 } // namespace facebook::velox::exec
@@ -227,6 +227,30 @@ HashStringAllocator::allocate(int32_t size, bool exactSize) {
   return header;
 }
 
+HashStringAllocator::Header* FOLLY_NULLABLE
+HashStringAllocator::findInFreeList(
+    int32_t index,
+    int32_t size,
+    int32_t maxChecked,
+    Header* FOLLY_NULLABLE& largest) {
+  int32_t counter = 0;
+  auto& list = free_[index];
+  for (auto* item = list.next(); item != &list; item = item->next()) {
+    auto header = headerOf(item);
+    VELOX_CHECK(header->isFree());
+    if (header->size() >= size) {
+      return header;
+    }
+    if (!largest || header->size() > largest->size()) {
+      largest = header;
+    }
+    if (++counter >= maxChecked) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
 HashStringAllocator::Header* FOLLY_NULLABLE
 HashStringAllocator::allocateFromFreeList(
     int32_t preferredSize,
@@ -236,27 +260,34 @@ HashStringAllocator::allocateFromFreeList(
   if (!numFree_) {
     return nullptr;
   }
-  VELOX_CHECK(!free_.empty());
+  VELOX_CHECK(freeNonEmpty_);
   preferredSize = std::max(kMinAlloc, preferredSize);
-  int32_t counter = 0;
+  const auto index = freeListIndex(preferredSize);
   Header* largest = nullptr;
   Header* found = nullptr;
-  for (auto* item = free_.next(); item != &free_; item = item->next()) {
-    auto header = headerOf(item);
-    VELOX_CHECK(header->isFree());
-    auto size = header->size();
-    if (size >= preferredSize) {
-      found = header;
-      break;
-    }
-    if (!largest || size > largest->size()) {
-      largest = header;
-    }
-    if (!mustHaveSize && ++counter > kMaxCheckedForFit) {
-      break;
-    }
+  if (freeNonEmpty_ & (1 << index)) {
+    found = findInFreeList(index, preferredSize, kMaxCheckedForFit, largest);
+  }
+  // Any block in a larger size class fits. Take one from the smallest
+  // such class.
+  const uint32_t larger = freeNonEmpty_ & ~bits::lowMask(index + 1);
+  if (!found && larger) {
+    found = headerOf(free_[__builtin_ctz(larger)].next());
   }
-  if (!mustHaveSize && !found) {
+  if (!found && mustHaveSize && (freeNonEmpty_ & (1 << index))) {
+    // Blocks of the same size class may be smaller than 'preferredSize'.
+    found = findInFreeList(
+        index, preferredSize, std::numeric_limits<int32_t>::max(), largest);
+  }
+  if (!found && !mustHaveSize) {
+    if (!largest) {
+      // All free blocks are in smaller size classes. Take a large one.
+      findInFreeList(
+          31 - __builtin_clz(freeNonEmpty_),
+          preferredSize,
+          kMaxCheckedForFit,
+          largest);
+    }
     found = largest;
   }
   if (!found) {
@@ -299,14 +330,16 @@ void HashStringAllocator::free(Header* _header) {
       }
     }
     if (header->isPreviousFree()) {
+      // The merged block may belong to a larger size class.
       auto previousFree = getPreviousFree(header);
+      unlinkFromFreeList(previousFree);
       previousFree->setSize(
           previousFree->size() + header->size() + sizeof(Header));
       header = previousFree;
     } else {
       ++numFree_;
-      free_.insert(reinterpret_cast<CompactDoubleList*>(header->begin()));
     }
+    insertIntoFreeList(header);
     markAsFree(header);
     header = continued;
   } while (header);
@@ -354,9 +387,15 @@ void HashStringAllocator::checkConsistency() const {
   VELOX_CHECK(freeBytes == freeBytes_);
   uint64_t numInFreeList = 0;
   uint64_t bytesInFreeList = 0;
-  for (auto free = free_.next(); free != &free_; free = free->next()) {
-    ++numInFreeList;
-    bytesInFreeList += headerOf(free)->size() + sizeof(Header);
+  for (auto i = 0; i < kNumFreeLists; ++i) {
+    auto& list = free_[i];
+    VELOX_CHECK_EQ(!list.empty(), (freeNonEmpty_ & (1 << i)) != 0);
+    for (auto free = list.next(); free != &list; free = free->next()) {
+      ++numInFreeList;
+      auto size = headerOf(free)->size();
+      VELOX_CHECK_EQ(i, freeListIndex(size));
+      bytesInFreeList += size + sizeof(Header);
+    }
   }
   VELOX_CHECK(numInFreeList == numFree_);
   VELOX_CHECK(bytesInFreeList == freeBytes_);
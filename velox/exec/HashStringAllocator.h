@@ -29,8 +29,10 @@ namespace facebook::velox::exec {
 // kContinue means that last 8 bytes are a pointer to another Header after which
 // the contents of this allocation continue. kFree means the block is free. A
 // free block has pointers to the next and previous free block via a
-// CompactDoubleList struct immediately after the header. The last 4 bytes of a
-// free block contain its length. kPreviousFree means that the block immediately
+// CompactDoubleList struct immediately after the header. Free blocks are kept
+// in separate lists by size class so that a fitting block is found without
+// walking past many small ones. The last 4 bytes of a free block contain its
+// length. kPreviousFree means that the block immediately
 // below is free. In this case the uint32_t below the header has the size of the
 // previous free block. The last word of a MappedMemory::PageRun backing a
 // HashStringAllocator is set to kArenaEnd.
@@ -238,11 +240,25 @@ class HashStringAllocator : public StreamArena {
     return minFree;
   }
 
+  // Returns the bytes in free blocks, including their headers. This is
+  // memory held by 'this' that is not used by any allocation.
+  uint64_t freeBytes() const {
+    return freeBytes_;
+  }
+
+  // Returns the number of free blocks.
+  uint64_t numFreeBlocks() const {
+    return numFree_;
+  }
+
   // Frees all memory associated with 'this' and leaves 'this' ready for reuse.
   void clear() {
     numFree_ = 0;
     freeBytes_ = 0;
-    new (&free_) CompactDoubleList();
+    for (auto& list : free_) {
+      new (&list) CompactDoubleList();
+    }
+    freeNonEmpty_ = 0;
     pool_.clear();
   }
 
@@ -258,6 +274,20 @@ class HashStringAllocator : public StreamArena {
   static constexpr int32_t kUnitSize = 16 * memory::MappedMemory::kPageSize;
   static constexpr int32_t kMinContiguous = 48;
 
+  // Number of size classes of free blocks. Class 0 has blocks below 64
+  // bytes, class i has blocks of [2^(i + 5), 2^(i + 6)) bytes and the last
+  // class has all blocks of 4KB and more.
+  static constexpr int32_t kNumFreeLists = 8;
+
+  // Returns the size class of a free block of 'size' bytes.
+  static int32_t freeListIndex(int32_t size) {
+    if (size < 64) {
+      return 0;
+    }
+    return std::min<int32_t>(
+        kNumFreeLists - 1, 63 - bits::countLeadingZeros(size) - 5);
+  }
+
   // Adds 'bytes' worth of contiguous space to the free list. This
   // grows the footprint in MappedMemory but does not allocate
   // anything yet. Throws if fails to grow. The caller typically knows
@@ -266,12 +296,38 @@ class HashStringAllocator : public StreamArena {
   // starting to process a batch of input.
   void newSlab(int32_t size);
 
+  // Adds free 'header' to the free list of its size class.
+  void insertIntoFreeList(Header* FOLLY_NONNULL header) {
+    auto index = freeListIndex(header->size());
+    free_[index].insert(reinterpret_cast<CompactDoubleList*>(header->begin()));
+    freeNonEmpty_ |= 1 << index;
+  }
+
+  // Unlinks 'header' from its free list. 'header' must have the size it was
+  // inserted with.
+  void unlinkFromFreeList(Header* FOLLY_NONNULL header) {
+    auto index = freeListIndex(header->size());
+    reinterpret_cast<CompactDoubleList*>(header->begin())->remove();
+    if (free_[index].empty()) {
+      freeNonEmpty_ &= ~(1 << index);
+    }
+  }
+
   void removeFromFreeList(Header* FOLLY_NONNULL header) {
     VELOX_CHECK(header->isFree());
     header->clearFree();
-    reinterpret_cast<CompactDoubleList*>(header->begin())->remove();
+    unlinkFromFreeList(header);
   }
 
+  // Returns the first block of at least 'size' bytes in the free list
+  // 'index' after checking at most 'maxChecked' blocks. Sets 'largest' to
+  // the largest block checked if none fits.
+  Header* FOLLY_NULLABLE findInFreeList(
+      int32_t index,
+      int32_t size,
+      int32_t maxChecked,
+      Header* FOLLY_NULLABLE& largest);
+
   /// Allocates a block of specified size. If exactSize is false, the block may
   /// be smaller or larger. Checks free list before allocating new memory.
   Header* FOLLY_NULLABLE allocate(int32_t size, bool exactSize);
@@ -293,13 +349,16 @@ class HashStringAllocator : public StreamArena {
   // blocks would be below minimum size.
   void freeRestOfBlock(Header* FOLLY_NONNULL header, int32_t keepBytes);
 
-  // Circular list of free blocks.
-  CompactDoubleList free_;
+  // Circular lists of free blocks, one per size class.
+  CompactDoubleList free_[kNumFreeLists];
+
+  // Bit i is set if 'free_[i]' is not empty.
+  uint32_t freeNonEmpty_ = 0;
 
-  // Count of elements in 'free_'. This is 0 when free_.next() == &free_.
+  // Count of elements in 'free_'. This is 0 when all lists are empty.
   uint64_t numFree_ = 0;
 
-  // Sum of the size of blocks in 'free_', excluding headers.
+  // Sum of the size of blocks in 'free_', including headers.
   uint64_t freeBytes_ = 0;
 
   // Pointer to Header for the range being written. nullptr if a write is not in
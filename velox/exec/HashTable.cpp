@@ -15,6 +15,8 @@
  */
 
 #include "velox/exec/HashTable.h"
+#include <condition_variable>
+#include <mutex>
 #include "velox/common/base/SimdUtil.h"
 #include "velox/common/process/ProcessBase.h"
 #include "velox/exec/ContainerRowSerde.h"
@@ -78,11 +80,6 @@ class ProbeState {
   // need it here since erase is very rare and is not expected to
   // change the load factor by much in the expected uses.
   static constexpr uint8_t kTombstoneTag = 0x7f;
-  static constexpr int32_t kFullMask = 0xffff;
-  static constexpr BaseHashTable::TagVector kTombstoneGroup = {
-      0x7f7f7f7f7f7f7f7fUL,
-      0x7f7f7f7f7f7f7f7fUL};
-  static constexpr BaseHashTable::TagVector kEmptyGroup = {0, 0};
 
   static inline int32_t tagsByteOffset(uint64_t hash, uint64_t sizeMask) {
     return (hash & sizeMask) & ~(sizeof(BaseHashTable::TagVector) - 1);
@@ -92,25 +89,25 @@ class ProbeState {
     return row_;
   }
 
-  // Use one instruction to load 16 tags
-  // Use another instruction to make 16 copies of the tag being searched for
+  // Use one instruction to load a vector of tags
+  // Use another instruction to make copies of the tag being searched for
   inline void
   preProbe(uint8_t* tags, uint64_t sizeMask, uint64_t hash, int32_t row) {
     row_ = row;
     tagIndex_ = tagsByteOffset(hash, sizeMask);
     tagsInTable_ = BaseHashTable::loadTags(tags, tagIndex_);
     auto tag = BaseHashTable::hashTag(hash);
-    wantedTags_ = _mm_set1_epi8(tag);
+    wantedTags_ = BaseHashTable::broadcastTag(tag);
     group_ = nullptr;
     indexInTags_ = kNotSet;
   }
 
-  // Use one instruction to compare the tag being searched for to 16 tags
-  // If there is a match, load corresponding data from the table
+  // Use one instruction to compare the tag being searched for to a
+  // vector of tags. If there is a match, load corresponding data from
+  // the table
   template <Operation op = Operation::kProbe>
   inline void firstProbe(char** table, int32_t firstKey) {
-    auto tagMatches = _mm_cmpeq_epi8(tagsInTable_, wantedTags_);
-    hits_ = _mm_movemask_epi8(tagMatches);
+    hits_ = BaseHashTable::matchTags(tagsInTable_, wantedTags_);
     if (hits_) {
       loadNextHit<op>(table, firstKey);
     }
@@ -135,16 +132,13 @@ class ProbeState {
     auto alreadyChecked = group_;
     if (extraCheck) {
       tagsInTable_ = BaseHashTable::loadTags(tags, tagIndex_);
-      auto tagMatches = _mm_cmpeq_epi8(tagsInTable_, wantedTags_);
-      hits_ = _mm_movemask_epi8(tagMatches);
+      hits_ = BaseHashTable::matchTags(tagsInTable_, wantedTags_);
     }
 
     int32_t insertTagIndex = -1;
     for (;;) {
       if (!hits_) {
-        uint16_t empty =
-            _mm_movemask_epi8(_mm_cmpeq_epi8(tagsInTable_, kEmptyGroup)) &
-            kFullMask;
+        auto empty = BaseHashTable::emptyTags(tagsInTable_);
         if (empty) {
           if (op == Operation::kProbe) {
             return nullptr;
@@ -161,9 +155,8 @@ class ProbeState {
           return insert(row_, tagIndex_ + pos);
         } else if (op == Operation::kInsert && indexInTags_ == kNotSet) {
           // We passed through a full group.
-          uint16_t tombstones =
-              _mm_movemask_epi8(_mm_cmpeq_epi8(tagsInTable_, kTombstoneGroup)) &
-              kFullMask;
+          auto tombstones = BaseHashTable::matchTags(
+              tagsInTable_, BaseHashTable::broadcastTag(kTombstoneTag));
           if (tombstones) {
             insertTagIndex = tagIndex_;
             indexInTags_ = bits::getAndClearLastSetBit(tombstones);
@@ -182,8 +175,7 @@ class ProbeState {
       }
       tagIndex_ = (tagIndex_ + sizeof(BaseHashTable::TagVector)) & sizeMask;
       tagsInTable_ = BaseHashTable::loadTags(tags, tagIndex_);
-      auto tagMatches = _mm_cmpeq_epi8(tagsInTable_, wantedTags_);
-      hits_ = _mm_movemask_epi8(tagMatches) & kFullMask;
+      hits_ = BaseHashTable::matchTags(tagsInTable_, wantedTags_);
     }
   }
 
@@ -202,7 +194,7 @@ class ProbeState {
   }
 
   void eraseHit(uint8_t* tags) {
-    auto empty = _mm_movemask_epi8(_mm_cmpeq_epi8(tagsInTable_, kEmptyGroup));
+    auto empty = BaseHashTable::emptyTags(tagsInTable_);
 
     BaseHashTable::storeTag(
         tags, tagIndex_ + indexInTags_, empty ? 0 : kTombstoneTag);
@@ -261,6 +253,10 @@ char* HashTable<ignoreNullKeys>::insertEntry(
     // the word below the row. Space was reserved in the allocation
     // unless we have given up on normalized keys.
     RowContainer::normalizedKey(group) = lookup.normalizedKeys[row]; // NOLINT
+    if (wideKeyStart_) {
+      RowContainer::highNormalizedKey(group) =
+          lookup.highNormalizedKeys[row]; // NOLINT
+    }
   }
   ++numDistinct_;
   lookup.newGroups.push_back(row);
@@ -290,6 +286,9 @@ template <bool ignoreNullKeys>
 bool HashTable<ignoreNullKeys>::compareKeys(
     const char* group,
     const char* inserted) {
+  if (rows_->hasBytewiseKeys()) {
+    return rows_->equalKeys(group, inserted);
+  }
   auto numKeys = hashers_.size();
   int32_t i = 0;
   do {
@@ -308,6 +307,25 @@ FOLLY_ALWAYS_INLINE void HashTable<ignoreNullKeys>::fullProbe(
     bool extraCheck) {
   constexpr ProbeState::Operation op =
       isJoin ? ProbeState::Operation::kProbe : ProbeState::Operation::kInsert;
+  if (hashMode_ == HashMode::kNormalizedKey && wideKeyStart_) {
+    // NOLINT
+    lookup.hits[state.row()] = state.fullProbe<op>(
+        tags_,
+        table_,
+        sizeMask_,
+        -static_cast<int32_t>(2 * sizeof(normalized_key_t)),
+        [&](char* group, int32_t row) {
+          return RowContainer::normalizedKey(group) ==
+              lookup.normalizedKeys[row] &&
+              RowContainer::highNormalizedKey(group) ==
+              lookup.highNormalizedKeys[row];
+        },
+        [&](int32_t index, int32_t row) {
+          return isJoin ? nullptr : insertEntry(lookup, row, index);
+        },
+        !isJoin && extraCheck);
+    return;
+  }
   if (hashMode_ == HashMode::kNormalizedKey) {
     // NOLINT
     lookup.hits[state.row()] = state.fullProbe<op>(
@@ -338,6 +356,20 @@ FOLLY_ALWAYS_INLINE void HashTable<ignoreNullKeys>::fullProbe(
       !isJoin && extraCheck);
 }
 
+template <bool ignoreNullKeys>
+FOLLY_ALWAYS_INLINE void HashTable<ignoreNullKeys>::prefetchProbes(
+    const HashLookup& lookup,
+    int32_t begin,
+    int32_t end) {
+  auto rows = lookup.rows.data();
+  for (auto i = begin; i < end; ++i) {
+    auto index =
+        ProbeState::tagsByteOffset(lookup.hashes[rows[i]], sizeMask_);
+    __builtin_prefetch(tags_ + index);
+    __builtin_prefetch(table_ + index);
+  }
+}
+
 namespace {
 // A normalized key is spread evenly over 64 bits. This mixes the bits
 // so that they affect the low 'bits', which are actually used for
@@ -349,6 +381,14 @@ static inline uint64_t mixNormalizedKey(uint64_t k, uint8_t bits) {
   auto h = (k ^ ((k >> 32))) * prime1;
   return h + (h >> bits) * prime2 + (h >> (2 * bits)) * prime3;
 }
+
+// Mixes the two words of a wide normalized key. The second word is
+// usually small, so it is spread over 64 bits before combining.
+static inline uint64_t
+mixWideNormalizedKey(uint64_t low, uint64_t high, uint8_t bits) {
+  constexpr uint64_t kMul = 0x9ddfea08eb382d69UL; // From CityHash.
+  return mixNormalizedKey(low ^ (high * kMul), bits);
+}
 } // namespace
 
 template <bool ignoreNullKeys>
@@ -365,12 +405,25 @@ void HashTable<ignoreNullKeys>::groupProbe(HashLookup& lookup) {
     auto numRows = lookup.rows.size();
     lookup.normalizedKeys.resize(numRows);
     auto rows = lookup.rows.data();
-    for (int i = 0; i < numRows; ++i) {
-      auto row = rows[i];
-      auto hashes = lookup.hashes.data();
-      auto hash = hashes[row];
-      lookup.normalizedKeys[row] = hash; // NOLINT
-      hashes[row] = mixNormalizedKey(hash, sizeBits_);
+    auto hashes = lookup.hashes.data();
+    if (wideKeyStart_) {
+      lookup.highNormalizedKeys.resize(numRows);
+      auto highHashes = lookup.highHashes.data();
+      for (int i = 0; i < numRows; ++i) {
+        auto row = rows[i];
+        auto hash = hashes[row];
+        auto highHash = highHashes[row];
+        lookup.normalizedKeys[row] = hash; // NOLINT
+        lookup.highNormalizedKeys[row] = highHash; // NOLINT
+        hashes[row] = mixWideNormalizedKey(hash, highHash, sizeBits_);
+      }
+    } else {
+      for (int i = 0; i < numRows; ++i) {
+        auto row = rows[i];
+        auto hash = hashes[row];
+        lookup.normalizedKeys[row] = hash; // NOLINT
+        hashes[row] = mixNormalizedKey(hash, sizeBits_);
+      }
     }
   }
   ProbeState state1;
@@ -380,7 +433,15 @@ void HashTable<ignoreNullKeys>::groupProbe(HashLookup& lookup) {
   int32_t probeIndex = 0;
   int32_t numProbes = lookup.rows.size();
   auto rows = lookup.rows.data();
+  const bool prefetch = size_ >= kMinSizeForPrefetch;
+  if (prefetch) {
+    prefetchProbes(lookup, 0, std::min(kPrefetchDistance, numProbes));
+  }
   for (; probeIndex + 4 <= numProbes; probeIndex += 4) {
+    if (prefetch) {
+      auto begin = probeIndex + kPrefetchDistance;
+      prefetchProbes(lookup, begin, std::min(begin + 4, numProbes));
+    }
     int32_t row = rows[probeIndex];
     state1.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
     row = rows[probeIndex + 1];
@@ -470,6 +531,8 @@ void HashTable<ignoreNullKeys>::joinProbe(HashLookup& lookup) {
     return;
   }
   if (hashMode_ == HashMode::kNormalizedKey) {
+    // Only a group by has a wide normalized key.
+    VELOX_DCHECK_EQ(wideKeyStart_, 0);
     lookup.normalizedKeys.resize(lookup.rows.back() + 1);
     auto hashes = lookup.hashes.data();
     for (auto row : lookup.rows) {
@@ -485,7 +548,17 @@ void HashTable<ignoreNullKeys>::joinProbe(HashLookup& lookup) {
   ProbeState state2;
   ProbeState state3;
   ProbeState state4;
+  // Once the table is much larger than the cache, each probe misses
+  // on its tags and row pointers. Prefetch these ahead of the probes.
+  const bool prefetch = size_ >= kMinSizeForPrefetch;
+  if (prefetch) {
+    prefetchProbes(lookup, 0, std::min(kPrefetchDistance, numProbes));
+  }
   for (; probeIndex + 4 <= numProbes; probeIndex += 4) {
+    if (prefetch) {
+      auto begin = probeIndex + kPrefetchDistance;
+      prefetchProbes(lookup, begin, std::min(begin + 4, numProbes));
+    }
     int32_t row = rows[probeIndex];
     state1.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
     row = rows[probeIndex + 1];
@@ -536,9 +609,13 @@ void HashTable<ignoreNullKeys>::allocateTables(uint64_t size) {
     size_ = size;
     sizeMask_ = size_ - 1;
     sizeBits_ = __builtin_popcountll(sizeMask_);
-    tags_ = reinterpret_cast<uint8_t*>(aligned_alloc(64, size_));
+    // Large tables are backed by huge pages if enabled. Probes access
+    // these at random.
+    tags_ = reinterpret_cast<uint8_t*>(
+        memory::MappedMemory::allocateAligned(size_, 64));
     memset(tags_, 0, size_);
-    table_ = reinterpret_cast<char**>(aligned_alloc(64, sizeof(char*) * size_));
+    table_ = reinterpret_cast<char**>(
+        memory::MappedMemory::allocateAligned(sizeof(char*) * size_, 64));
     // Not strictly necessary to clear 'table_' but more debuggable.
     memset(table_, 0, size_ * sizeof(char*));
   }
@@ -556,6 +633,38 @@ void HashTable<ignoreNullKeys>::clear() {
   numDistinct_ = 0;
 }
 
+template <bool ignoreNullKeys>
+void HashTable<ignoreNullKeys>::compact() {
+  VELOX_CHECK(!isJoinBuild_, "Only group by tables can be compacted");
+  rows_->compact();
+  if (hashMode_ == HashMode::kArray) {
+    // The size of an array is given by the ranges of the keys, not by
+    // the number of rows. The entries point to the moved rows.
+    if (table_) {
+      memset(table_, 0, sizeof(char*) * size_);
+    }
+    rehash();
+    return;
+  }
+  if (numDistinct_ == 0) {
+    // checkSize() allocates the table again for the next insert.
+    allocateTables(0);
+    size_ = 0;
+    sizeMask_ = 0;
+    return;
+  }
+  // Same as the initial size for 'numDistinct_' rows in checkSize().
+  auto newSize =
+      std::max((uint64_t)2048, bits::nextPowerOfTwo(numDistinct_ * 2));
+  if (!table_ || newSize < size_) {
+    allocateTables(newSize);
+  } else {
+    memset(tags_, 0, size_);
+    memset(table_, 0, sizeof(char*) * size_);
+  }
+  rehash();
+}
+
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::checkSize(int32_t numNew) {
   if (!table_) {
@@ -563,8 +672,12 @@ void HashTable<ignoreNullKeys>::checkSize(int32_t numNew) {
     // least 2K entries.
     // numDistinct_ is non-0 when switching from HashMode::kArray to regular
     // hashing.
+    // With an estimate of the distinct keys, the table is allocated at
+    // its final size.
     auto newSize = std::max(
-        (uint64_t)2048, bits::nextPowerOfTwo(numNew * 2 + numDistinct_));
+        {(uint64_t)2048,
+         bits::nextPowerOfTwo(numNew * 2 + numDistinct_),
+         sizeForEstimate()});
     allocateTables(newSize);
     if (numDistinct_) {
       rehash();
@@ -577,6 +690,16 @@ void HashTable<ignoreNullKeys>::checkSize(int32_t numNew) {
   }
 }
 
+template <bool ignoreNullKeys>
+uint64_t HashTable<ignoreNullKeys>::sizeForEstimate() const {
+  if (!distinctEstimate_) {
+    return 0;
+  }
+  // The table is resized when less than 1/8 is free.
+  auto size = bits::nextPowerOfTwo(distinctEstimate_ + distinctEstimate_ / 7);
+  return std::min<uint64_t>(size, kMaxSizeForEstimate);
+}
+
 template <TypeKind Kind>
 bool valueIdRowsColumn(
     bool ignoreNullKeys,
@@ -596,16 +719,21 @@ bool valueIdRowsColumn(
 }
 
 template <bool ignoreNullKeys>
-bool HashTable<ignoreNullKeys>::insertBatch(
+bool HashTable<ignoreNullKeys>::hashRows(
+    RowContainer& rows,
     char** groups,
+    int32_t numGroups,
     uint64_t* hashes,
-    int32_t numGroups) {
+    uint64_t* highHashes) {
   for (int32_t i = 0; i < hashers_.size(); ++i) {
     auto& hasher = hashers_[i];
     if (hashMode_ == HashMode::kHash) {
-      rows_->hash(i, folly::Range<char**>(groups, numGroups), i > 0, hashes);
+      rows.hash(i, folly::Range<char**>(groups, numGroups), i > 0, hashes);
     } else {
       // Array or normalized key.
+      auto valueIds =
+          wideKeyStart_ && i >= wideKeyStart_ ? highHashes : hashes;
+      VELOX_DCHECK_NOT_NULL(valueIds);
       if (!VALUE_ID_TYPE_DISPATCH(
               valueIdRowsColumn,
               hasher->typeKind(),
@@ -613,17 +741,29 @@ bool HashTable<ignoreNullKeys>::insertBatch(
               hasher.get(),
               groups,
               numGroups,
-              rows_->columnAt(i),
-              hashes)) {
-        // Must reconsider 'hashMode_' and start over.
+              rows.columnAt(i),
+              valueIds)) {
         return false;
       }
     }
   }
+  return true;
+}
+
+template <bool ignoreNullKeys>
+bool HashTable<ignoreNullKeys>::insertBatch(
+    char** groups,
+    uint64_t* hashes,
+    uint64_t* highHashes,
+    int32_t numGroups) {
+  if (!hashRows(*rows_, groups, numGroups, hashes, highHashes)) {
+    // Must reconsider 'hashMode_' and start over.
+    return false;
+  }
   if (isJoinBuild_) {
     insertForJoin(groups, hashes, numGroups);
   } else {
-    insertForGroupBy(groups, hashes, numGroups);
+    insertForGroupBy(groups, hashes, highHashes, numGroups);
   }
   return true;
 }
@@ -632,6 +772,7 @@ template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::insertForGroupBy(
     char** groups,
     uint64_t* hashes,
+    uint64_t* highHashes,
     int32_t numGroups) {
   if (hashMode_ == HashMode::kArray) {
     for (auto i = 0; i < numGroups; ++i) {
@@ -641,7 +782,15 @@ void HashTable<ignoreNullKeys>::insertForGroupBy(
       table_[index] = groups[i];
     }
   } else {
-    if (hashMode_ == HashMode::kNormalizedKey) {
+    if (hashMode_ == HashMode::kNormalizedKey && wideKeyStart_) {
+      for (int i = 0; i < numGroups; ++i) {
+        auto hash = hashes[i];
+        // Write both words of the normalized key below the row.
+        RowContainer::normalizedKey(groups[i]) = hash;
+        RowContainer::highNormalizedKey(groups[i]) = highHashes[i];
+        hashes[i] = mixWideNormalizedKey(hash, highHashes[i], sizeBits_);
+      }
+    } else if (hashMode_ == HashMode::kNormalizedKey) {
       for (int i = 0; i < numGroups; ++i) {
         auto hash = hashes[i];
         // Write the normalized key below the row.
@@ -655,7 +804,7 @@ void HashTable<ignoreNullKeys>::insertForGroupBy(
       auto tagIndex = ProbeState::tagsByteOffset(hash, sizeMask_);
       auto tagsInTable = BaseHashTable::loadTags(tags_, tagIndex);
       for (;;) {
-        MaskType free = ~_mm_movemask_epi8(tagsInTable) & ProbeState::kFullMask;
+        MaskType free = freeTags(tagsInTable);
         if (free) {
           auto freeOffset = bits::getAndClearLastSetBit(free);
           storeRowPointer(tagIndex + freeOffset, hash, groups[i]);
@@ -777,11 +926,212 @@ void HashTable<ignoreNullKeys>::insertForJoin(
   }
 }
 
+template <bool ignoreNullKeys>
+bool HashTable<ignoreNullKeys>::insertJoinRow(
+    char* row,
+    uint64_t hash,
+    int64_t end) {
+  auto tagIndex = ProbeState::tagsByteOffset(hash, sizeMask_);
+  auto wantedTags = broadcastTag(hashTag(hash));
+  for (;;) {
+    auto tagsInTable = loadTags(tags_, tagIndex);
+    MaskType hits = matchTags(tagsInTable, wantedTags);
+    while (hits) {
+      auto group =
+          loadRow(table_, tagIndex + bits::getAndClearLastSetBit(hits));
+      bool isMatch = hashMode_ == HashMode::kNormalizedKey
+          ? RowContainer::normalizedKey(group) ==
+              RowContainer::normalizedKey(row)
+          : compareKeys(group, row);
+      if (isMatch) {
+        pushNext(group, row);
+        return true;
+      }
+    }
+    MaskType empty = emptyTags(tagsInTable);
+    if (empty) {
+      storeRowPointer(tagIndex + bits::getAndClearLastSetBit(empty), hash, row);
+      return true;
+    }
+    tagIndex += sizeof(TagVector);
+    if (tagIndex >= end) {
+      return false;
+    }
+    tagIndex &= sizeMask_;
+  }
+}
+
+namespace {
+// Runs 'func' for each of 0 to 'numItems' - 1 on 'executor' and on the
+// calling thread. The calling thread runs all the items no other
+// thread has started, so that this completes even if 'executor' has
+// no free threads. Returns after all items are done and rethrows the
+// first error.
+void parallelFor(
+    folly::Executor* executor,
+    int32_t numItems,
+    std::function<void(int32_t)> func) {
+  struct State {
+    std::atomic<int32_t> nextItem{0};
+    int32_t numItems;
+    std::function<void(int32_t)> func;
+    std::mutex mutex;
+    std::condition_variable allDone;
+    int32_t numDone{0};
+    std::exception_ptr error;
+  };
+  auto state = std::make_shared<State>();
+  state->numItems = numItems;
+  state->func = std::move(func);
+  auto runItems = [state]() {
+    for (;;) {
+      auto item = state->nextItem++;
+      if (item >= state->numItems) {
+        return;
+      }
+      std::exception_ptr error;
+      try {
+        state->func(item);
+      } catch (const std::exception&) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> l(state->mutex);
+      if (error && !state->error) {
+        state->error = error;
+      }
+      if (++state->numDone == state->numItems) {
+        state->allDone.notify_all();
+      }
+    }
+  };
+  for (auto i = 1; i < numItems; ++i) {
+    executor->add(runItems);
+  }
+  runItems();
+  std::unique_lock<std::mutex> l(state->mutex);
+  state->allDone.wait(
+      l, [&]() { return state->numDone == state->numItems; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+} // namespace
+
+template <bool ignoreNullKeys>
+bool HashTable<ignoreNullKeys>::parallelJoinBuild() {
+  constexpr int32_t kHashBatchSize = 1024;
+  const int32_t numTables = 1 + otherTables_.size();
+  const int32_t numPartitions = numTables;
+  // Partitions are whole tag groups so that no two threads write the
+  // same group.
+  const int64_t partitionSize = std::max<int64_t>(
+      bits::roundUp(size_ / numPartitions, sizeof(TagVector)),
+      sizeof(TagVector));
+  auto partitionEnd = [&](int32_t partition) {
+    return partition == numPartitions - 1
+        ? size_
+        : std::min(size_, (partition + 1) * partitionSize);
+  };
+
+  // Rows and hashes of each table by the partition of the table where
+  // their probe starts.
+  using PartitionedRows = std::vector<std::vector<char*>>;
+  using PartitionedHashes = std::vector<std::vector<uint64_t>>;
+  std::vector<PartitionedRows> rows(numTables, PartitionedRows(numPartitions));
+  std::vector<PartitionedHashes> hashes(
+      numTables, PartitionedHashes(numPartitions));
+  std::vector<char> hashed(numTables, false);
+  auto hashTable = [&](int32_t tableIndex) {
+    auto table = tableIndex == 0 ? this : otherTables_[tableIndex - 1].get();
+    // @lint-ignore CLANGTIDY
+    uint64_t batchHashes[kHashBatchSize];
+    char* groups[kHashBatchSize];
+    RowContainerIterator iterator;
+    for (;;) {
+      auto numGroups =
+          table->rows()->listRows(&iterator, kHashBatchSize, groups);
+      if (!numGroups) {
+        break;
+      }
+      if (!hashRows(*table->rows(), groups, numGroups, batchHashes)) {
+        return;
+      }
+      for (auto i = 0; i < numGroups; ++i) {
+        auto hash = batchHashes[i];
+        int64_t start = hash;
+        if (hashMode_ != HashMode::kArray) {
+          if (hashMode_ == HashMode::kNormalizedKey) {
+            RowContainer::normalizedKey(groups[i]) = hash;
+            hash = mixNormalizedKey(hash, sizeBits_);
+          }
+          start = ProbeState::tagsByteOffset(hash, sizeMask_);
+        }
+        auto partition = std::min<int64_t>(
+            start / partitionSize, numPartitions - 1);
+        rows[tableIndex][partition].push_back(groups[i]);
+        hashes[tableIndex][partition].push_back(hash);
+      }
+    }
+    hashed[tableIndex] = true;
+  };
+  if (hashMode_ == HashMode::kHash) {
+    parallelFor(buildExecutor_, numTables, hashTable);
+  } else {
+    for (auto i = 0; i < numTables; ++i) {
+      hashTable(i);
+      if (!hashed[i]) {
+        return false;
+      }
+    }
+  }
+  for (auto isHashed : hashed) {
+    VELOX_CHECK(isHashed);
+  }
+
+  std::vector<std::vector<char*>> overflowRows(numPartitions);
+  std::vector<std::vector<uint64_t>> overflowHashes(numPartitions);
+  parallelFor(buildExecutor_, numPartitions, [&](int32_t partition) {
+    auto end = partitionEnd(partition);
+    for (auto tableIndex = 0; tableIndex < numTables; ++tableIndex) {
+      auto& partitionRows = rows[tableIndex][partition];
+      auto& partitionHashes = hashes[tableIndex][partition];
+      for (auto i = 0; i < partitionRows.size(); ++i) {
+        if (hashMode_ == HashMode::kArray) {
+          VELOX_DCHECK_LT(partitionHashes[i], size_);
+          arrayPushRow(partitionRows[i], partitionHashes[i]);
+        } else if (!insertJoinRow(
+                       partitionRows[i], partitionHashes[i], end)) {
+          overflowRows[partition].push_back(partitionRows[i]);
+          overflowHashes[partition].push_back(partitionHashes[i]);
+        }
+      }
+    }
+  });
+  for (auto partition = 0; partition < numPartitions; ++partition) {
+    for (auto i = 0; i < overflowRows[partition].size(); ++i) {
+      VELOX_CHECK(insertJoinRow(
+          overflowRows[partition][i],
+          overflowHashes[partition][i],
+          std::numeric_limits<int64_t>::max()));
+    }
+  }
+  return true;
+}
+
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::rehash() {
+  if (isJoinBuild_ && buildExecutor_ && !otherTables_.empty() &&
+      numDistinct_ >= kMinRowsForParallelJoinBuild) {
+    if (!parallelJoinBuild()) {
+      VELOX_CHECK(hashMode_ != HashMode::kHash);
+      setHashMode(HashMode::kHash, 0);
+    }
+    return;
+  }
   constexpr int32_t kHashBatchSize = 1024;
   // @lint-ignore CLANGTIDY
   uint64_t hashes[kHashBatchSize];
+  uint64_t highHashes[kHashBatchSize];
   char* groups[kHashBatchSize];
   // A join build can have multiple payload tables. Loop over 'this'
   // and the possible other tables and put all the data in the table
@@ -793,7 +1143,7 @@ void HashTable<ignoreNullKeys>::rehash() {
       numGroups = (i == 0 ? this : otherTables_[i - 1].get())
                       ->rows()
                       ->listRows(&iterator, kHashBatchSize, groups);
-      if (!insertBatch(groups, hashes, numGroups)) {
+      if (!insertBatch(groups, hashes, highHashes, numGroups)) {
         VELOX_CHECK(hashMode_ != HashMode::kHash);
         setHashMode(HashMode::kHash, 0);
         return;
@@ -814,6 +1164,7 @@ void HashTable<ignoreNullKeys>::setHashMode(HashMode mode, int32_t numNew) {
     rehash();
   } else if (mode == HashMode::kHash) {
     hashMode_ = HashMode::kHash;
+    wideKeyStart_ = 0;
     for (auto& hasher : hashers_) {
       hasher->resetStats();
     }
@@ -957,10 +1308,16 @@ uint64_t HashTable<ignoreNullKeys>::setHasherMode(
     const std::vector<std::unique_ptr<VectorHasher>>& hashers,
     const std::vector<bool>& useRange,
     const std::vector<uint64_t>& rangeSizes,
-    const std::vector<uint64_t>& distinctSizes) {
+    const std::vector<uint64_t>& distinctSizes,
+    int32_t wideKeyStart) {
   int64_t multiplier = 1;
   for (int i = 0; i < hashers.size(); ++i) {
     auto kind = hashers[i]->typeKind();
+    if (i == wideKeyStart) {
+      // The second word starts over. A multiplier of 1 makes the first
+      // hasher of the word overwrite the value ids instead of adding.
+      multiplier = 1;
+    }
     multiplier = useRange.size() > i && useRange[i]
         ? hashers[i]->enableValueRange(
               multiplier, addReserve(rangeSizes[i], kind) - rangeSizes[i])
@@ -972,6 +1329,36 @@ uint64_t HashTable<ignoreNullKeys>::setHasherMode(
   return multiplier;
 }
 
+template <bool ignoreNullKeys>
+int32_t HashTable<ignoreNullKeys>::findWideKeyStart(
+    const std::vector<uint64_t>& distinctSizes) {
+  if (!rows_->hasWideNormalizedKeys()) {
+    return 0;
+  }
+  // The first word takes as many leading keys as fit, the second word
+  // must fit the rest.
+  uint64_t product = 1;
+  int32_t start = 0;
+  for (; start < hashers_.size(); ++start) {
+    auto next = safeMul(
+        product,
+        addReserve(distinctSizes[start], hashers_[start]->typeKind()));
+    if (next == VectorHasher::kRangeTooLarge) {
+      break;
+    }
+    product = next;
+  }
+  if (start == 0 || start == hashers_.size()) {
+    return 0;
+  }
+  product = 1;
+  for (auto i = start; i < hashers_.size(); ++i) {
+    product = safeMul(
+        product, addReserve(distinctSizes[i], hashers_[i]->typeKind()));
+  }
+  return product == VectorHasher::kRangeTooLarge ? 0 : start;
+}
+
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::decideHashMode(int32_t numNew) {
   std::vector<uint64_t> rangeSizes(hashers_.size());
@@ -979,6 +1366,7 @@ void HashTable<ignoreNullKeys>::decideHashMode(int32_t numNew) {
   std::vector<bool> useRange(hashers_.size());
   uint64_t bestWithReserve = 1;
   uint64_t distinctsWithReserve = 1;
+  wideKeyStart_ = 0;
   if (numDistinct_ && !isJoinBuild_) {
     if (!analyze()) {
       setHashMode(HashMode::kHash, numNew);
@@ -1026,7 +1414,18 @@ void HashTable<ignoreNullKeys>::decideHashMode(int32_t numNew) {
     return;
   }
   if (distinctsWithReserve == VectorHasher::kRangeTooLarge) {
-    setHashMode(HashMode::kHash, numNew);
+    // The keys may still fit a two word normalized key, which is much
+    // cheaper to compare than the keys.
+    auto wideKeyStart = findWideKeyStart(distinctSizes);
+    if (!wideKeyStart) {
+      setHashMode(HashMode::kHash, numNew);
+      return;
+    }
+    useRange.clear();
+    setHasherMode(
+        hashers_, useRange, rangeSizes, distinctSizes, wideKeyStart);
+    wideKeyStart_ = wideKeyStart;
+    setHashMode(HashMode::kNormalizedKey, numNew);
     return;
   }
   // The key concatenation fits in 64 bits.
@@ -1067,7 +1466,9 @@ bool mayUseValueIds(const BaseHashTable& table) {
 
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::prepareJoinTable(
-    std::vector<std::unique_ptr<BaseHashTable>> tables) {
+    std::vector<std::unique_ptr<BaseHashTable>> tables,
+    folly::Executor* executor) {
+  buildExecutor_ = executor;
   otherTables_.reserve(tables.size());
   for (auto& table : tables) {
     otherTables_.emplace_back(std::unique_ptr<HashTable<ignoreNullKeys>>(
@@ -1109,6 +1510,7 @@ void HashTable<ignoreNullKeys>::prepareJoinTable(
   } else {
     decideHashMode(0);
   }
+  buildExecutor_ = nullptr;
 }
 
 template <bool ignoreNullKeys>
@@ -1154,26 +1556,22 @@ int32_t HashTable<ignoreNullKeys>::listNotProbedRows(
     int32_t maxRows,
     uint64_t maxBytes,
     char** rows) {
-  if (iter->hashTableIndex_ == -1) {
-    auto numRows = rows_->listNotProbedRows(
-        &iter->rowContainerIterator_, maxRows, maxBytes, rows);
-    if (numRows) {
-      return numRows;
-    }
-    iter->hashTableIndex_ = 0;
-    iter->rowContainerIterator_.reset();
-  }
-  while (iter->hashTableIndex_ < otherTables_.size()) {
-    auto numRows =
-        otherTables_[iter->hashTableIndex_]->rows()->listNotProbedRows(
-            &iter->rowContainerIterator_, maxRows, maxBytes, rows);
-    if (numRows) {
-      return numRows;
+  // 'hashTableIndex_' -1 is 'rows_' and the others index 'otherTables_'.
+  while (iter->hashTableIndex_ < static_cast<int32_t>(otherTables_.size())) {
+    if ((iter->hashTableIndex_ + 1) % iter->numPartitions_ ==
+        iter->partition_) {
+      auto container = iter->hashTableIndex_ == -1
+          ? rows_.get()
+          : otherTables_[iter->hashTableIndex_]->rows();
+      auto numRows = container->listNotProbedRows(
+          &iter->rowContainerIterator_, maxRows, maxBytes, rows);
+      if (numRows) {
+        return numRows;
+      }
     }
     ++iter->hashTableIndex_;
     iter->rowContainerIterator_.reset();
   }
-
   return 0;
 }
 
@@ -1182,12 +1580,18 @@ void HashTable<ignoreNullKeys>::erase(folly::Range<char**> rows) {
   auto numRows = rows.size();
   std::vector<uint64_t> hashes;
   hashes.resize(numRows);
+  std::vector<uint64_t> highHashes;
+  if (wideKeyStart_) {
+    highHashes.resize(numRows);
+  }
 
   for (int32_t i = 0; i < hashers_.size(); ++i) {
     auto& hasher = hashers_[i];
     if (hashMode_ == HashMode::kHash) {
       rows_->hash(i, rows, i > 0, hashes.data());
     } else {
+      auto& valueIds =
+          wideKeyStart_ && i >= wideKeyStart_ ? highHashes : hashes;
       if (!VALUE_ID_TYPE_DISPATCH(
               valueIdRowsColumn,
               hasher->typeKind(),
@@ -1196,18 +1600,19 @@ void HashTable<ignoreNullKeys>::erase(folly::Range<char**> rows) {
               rows.data(),
               numRows,
               rows_->columnAt(i),
-              hashes.data())) {
+              valueIds.data())) {
         VELOX_FAIL("Value ids in erase must exist for all keys");
       }
     }
   }
-  eraseWithHashes(rows, hashes.data());
+  eraseWithHashes(rows, hashes.data(), highHashes.data());
 }
 
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::eraseWithHashes(
     folly::Range<char**> rows,
-    uint64_t* hashes) {
+    uint64_t* hashes,
+    uint64_t* highHashes) {
   auto numRows = rows.size();
   if (hashMode_ == HashMode::kArray) {
     for (auto i = 0; i < numRows; ++i) {
@@ -1215,7 +1620,11 @@ void HashTable<ignoreNullKeys>::eraseWithHashes(
       table_[hashes[i]] = nullptr;
     }
   } else {
-    if (hashMode_ == HashMode::kNormalizedKey) {
+    if (hashMode_ == HashMode::kNormalizedKey && wideKeyStart_) {
+      for (auto i = 0; i < numRows; ++i) {
+        hashes[i] = mixWideNormalizedKey(hashes[i], highHashes[i], sizeBits_);
+      }
+    } else if (hashMode_ == HashMode::kNormalizedKey) {
       for (auto i = 0; i < numRows; ++i) {
         hashes[i] = mixNormalizedKey(hashes[i], sizeBits_);
       }
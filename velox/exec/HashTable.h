@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <folly/Executor.h>
 #include "velox/common/memory/MappedMemory.h"
 #include "velox/exec/Aggregate.h"
 #include "velox/exec/Operator.h"
@@ -42,6 +43,11 @@ struct HashLookup {
   std::vector<uint64_t> hashes;
   // If using valueIds, list of concatenated valueIds. 1:1 with 'hashes'.
   std::vector<uint64_t> normalizedKeys;
+  // The value ids and normalized keys of the keys that go in the second
+  // word of a wide normalized key. Empty unless the table has a wide
+  // normalized key. See BaseHashTable::valueIdsFor().
+  std::vector<uint64_t> highHashes;
+  std::vector<uint64_t> highNormalizedKeys;
   // Hit for each row of input. nullptr if no hit. Points to the
   // corresponding group row.
   std::vector<char*> hits;
@@ -52,8 +58,20 @@ class BaseHashTable {
  public:
   using normalized_key_t = uint64_t;
 
+  // The tags are compared a vector at a time. The widest vector the
+  // build targets is used, so the tags of one probe step are 16, 32 or
+  // 64 consecutive slots. MaskType has a bit per tag in a TagVector.
+#if defined(__AVX512BW__)
+  using TagVector = __m512i;
+  using MaskType = uint64_t;
+#elif defined(__AVX2__)
+  using TagVector = __m256i;
+  using MaskType = uint32_t;
+#else
   using TagVector = __m128i;
   using MaskType = uint16_t;
+#endif
+  static constexpr int32_t kTagsPerVector = sizeof(TagVector);
 
   // 2M entries, i.e. 16MB is the largest array based hash table.
   static constexpr uint64_t kArrayHashMaxSize = 2L << 20;
@@ -81,9 +99,15 @@ class BaseHashTable {
     vector_size_t lastRow{0};
   };
 
+  /// Lists the RowContainers of the table whose index modulo
+  /// 'numPartitions_' is 'partition_'. The index of the table's own
+  /// RowContainer is 0 and that of the 'otherTables_' are 1 and up.
+  /// This lets each probe Driver list a disjoint share of the rows.
   struct NotProbedRowsIterator {
     int32_t hashTableIndex_{-1};
     RowContainerIterator rowContainerIterator_;
+    int32_t partition_{0};
+    int32_t numPartitions_{1};
   };
 
   /// Takes ownership of 'hashers'. These are used to keep key-level
@@ -123,8 +147,12 @@ class BaseHashTable {
       uint64_t maxBytes,
       char** rows) = 0;
 
+  /// Combines 'tables' with 'this' into a probe table. If 'executor' is
+  /// given, the rows of a large build side are inserted in parallel on
+  /// 'executor' and the calling thread.
   virtual void prepareJoinTable(
-      std::vector<std::unique_ptr<BaseHashTable>> tables) = 0;
+      std::vector<std::unique_ptr<BaseHashTable>> tables,
+      folly::Executor* FOLLY_NULLABLE executor = nullptr) = 0;
 
   /// Returns the memory footprint in bytes for any data structures
   /// owned by 'this'.
@@ -138,6 +166,12 @@ class BaseHashTable {
   /// side. This is used for sizing the internal hash table.
   virtual uint64_t numDistinct() const = 0;
 
+  /// Sets the expected number of distinct keys, e.g. from planner
+  /// statistics. The table is allocated at the size for this many
+  /// entries instead of growing to it by repeated rehashing. 0 means no
+  /// estimate.
+  virtual void setDistinctEstimate(uint64_t numDistinct) = 0;
+
   /// Returns true if the hash table contains rows with duplicate keys.
   virtual bool hasDuplicateKeys() const = 0;
 
@@ -146,6 +180,26 @@ class BaseHashTable {
   /// VectorHashers of 'this'.
   virtual HashMode hashMode() const = 0;
 
+  /// Returns the index of the first key whose value id goes in the
+  /// second word of a wide normalized key. A group by on many keys
+  /// whose value ids do not fit in 64 bits can still use
+  /// kNormalizedKey mode with a 128 bit key. 0 if the normalized key
+  /// is one word.
+  int32_t wideKeyStart() const {
+    return wideKeyStart_;
+  }
+
+  /// Returns the vector of 'lookup' that gets the value ids of the
+  /// 'key'th key. This is 'lookup.hashes' unless the key goes in the
+  /// second word of a wide normalized key.
+  std::vector<uint64_t>* valueIdsFor(HashLookup& lookup, int32_t key) const {
+    if (wideKeyStart_ && key >= wideKeyStart_) {
+      lookup.highHashes.resize(lookup.hashes.size());
+      return &lookup.highHashes;
+    }
+    return &lookup.hashes;
+  }
+
   /// Disables use of array or normalized key hash modes.
   void forceGenericHashMode() {
     setHashMode(HashMode::kHash, 0);
@@ -167,6 +221,13 @@ class BaseHashTable {
   // and be unique.
   virtual void erase(folly::Range<char**> rows) = 0;
 
+  /// Returns the memory kept after erase() or clear(). Moves the rows into
+  /// new RowContainer allocations without the erased rows and rebuilds
+  /// the table at the smallest size for the remaining rows. Frees the
+  /// table if there are no rows. Invalidates pointers to rows and
+  /// RowContainerIterators. Only for group by tables.
+  virtual void compact() = 0;
+
   /// Returns a brief description for use in debugging.
   virtual std::string toString() = 0;
 
@@ -197,7 +258,53 @@ class BaseHashTable {
   static TagVector loadTags(T* tags, int32_t tagIndex) {
     auto tagPtr =
         reinterpret_cast<TagVector*>(reinterpret_cast<char*>(tags) + tagIndex);
+#if defined(__AVX512BW__)
+    return _mm512_load_si512(tagPtr);
+#elif defined(__AVX2__)
+    return _mm256_load_si256(tagPtr);
+#else
     return _mm_load_si128(tagPtr);
+#endif
+  }
+
+  /// Returns a TagVector with all tags set to 'tag'.
+  static TagVector broadcastTag(uint8_t tag) {
+#if defined(__AVX512BW__)
+    return _mm512_set1_epi8(tag);
+#elif defined(__AVX2__)
+    return _mm256_set1_epi8(tag);
+#else
+    return _mm_set1_epi8(tag);
+#endif
+  }
+
+  /// Returns a bit mask of the positions where 'tags' and 'wanted' are
+  /// equal.
+  static MaskType matchTags(TagVector tags, TagVector wanted) {
+#if defined(__AVX512BW__)
+    return _mm512_cmpeq_epi8_mask(tags, wanted);
+#elif defined(__AVX2__)
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(tags, wanted));
+#else
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(tags, wanted));
+#endif
+  }
+
+  /// Returns a bit mask of the empty positions in 'tags'.
+  static MaskType emptyTags(TagVector tags) {
+    return matchTags(tags, broadcastTag(0));
+  }
+
+  /// Returns a bit mask of the positions in 'tags' that are empty or
+  /// erased. The tags of occupied positions have the high bit set.
+  static MaskType freeTags(TagVector tags) {
+#if defined(__AVX512BW__)
+    return ~_mm512_movepi8_mask(tags);
+#elif defined(__AVX2__)
+    return ~static_cast<MaskType>(_mm256_movemask_epi8(tags));
+#else
+    return ~static_cast<MaskType>(_mm_movemask_epi8(tags));
+#endif
   }
 
   /// Loads the payload row pointer corresponding to the tag at 'index'.
@@ -209,6 +316,7 @@ class BaseHashTable {
   virtual void setHashMode(HashMode mode, int32_t numNew) = 0;
   std::vector<std::unique_ptr<VectorHasher>> hashers_;
   std::unique_ptr<RowContainer> rows_;
+  int32_t wideKeyStart_{0};
 };
 
 class ProbeState;
@@ -298,6 +406,10 @@ class HashTable : public BaseHashTable {
     return numDistinct_;
   }
 
+  void setDistinctEstimate(uint64_t numDistinct) override {
+    distinctEstimate_ = numDistinct;
+  }
+
   bool hasDuplicateKeys() const override {
     return hasDuplicates_;
   }
@@ -311,6 +423,8 @@ class HashTable : public BaseHashTable {
   // Moves the contents of 'tables' into 'this' and prepares 'this'
 
   void erase(folly::Range<char**> rows) override;
+
+  void compact() override;
   // for use in hash join probe. A hash join build side is prepared as
   // follows: 1. Each build side thread gets a random selection of the
   // build stream. Each accumulates rows into its own
@@ -320,8 +434,12 @@ class HashTable : public BaseHashTable {
   // tables are filled, they are combined into one top level table
   // with prepareJoinTable. This then takes ownership of all the data
   // and VectorHashers and decides the hash mode and representation.
+  // With 'executor', a build side of at least
+  // kMinRowsForParallelJoinBuild rows is inserted by
+  // parallelJoinBuild().
   void prepareJoinTable(
-      std::vector<std::unique_ptr<BaseHashTable>> tables) override;
+      std::vector<std::unique_ptr<BaseHashTable>> tables,
+      folly::Executor* FOLLY_NULLABLE executor = nullptr) override;
 
   std::string toString() override;
 
@@ -346,14 +464,70 @@ class HashTable : public BaseHashTable {
       std::vector<bool>& useRange);
 
   /// Sets  value ranges or distinct value ids mode for
-  /// VectorHashers in a kArray or kNormalizedKeys mode table.
+  /// VectorHashers in a kArray or kNormalizedKeys mode table. If
+  /// 'wideKeyStart' is not 0, the hashers from 'wideKeyStart' on make
+  /// the second word of a wide normalized key.
   uint64_t setHasherMode(
       const std::vector<std::unique_ptr<VectorHasher>>& hashers,
       const std::vector<bool>& useRange,
       const std::vector<uint64_t>& rangeSizes,
-      const std::vector<uint64_t>& distinctSizes);
+      const std::vector<uint64_t>& distinctSizes,
+      int32_t wideKeyStart = 0);
+
+  /// Returns the first key of the second word of a wide normalized key
+  /// if the keys with 'distinctSizes' do not fit one word but fit two.
+  /// Returns 0 otherwise.
+  int32_t findWideKeyStart(const std::vector<uint64_t>& distinctSizes);
+
+  // Minimum number of build side rows for inserting these in
+  // parallel.
+  static constexpr int64_t kMinRowsForParallelJoinBuild = 10'000;
+
+  // Minimum table size for prefetching the probe positions a few rows
+  // ahead of the probes. A smaller table is expected to fit in cache.
+  static constexpr int64_t kMinSizeForPrefetch = 256 * 1024;
+
+  // Maximum table size allocated for 'distinctEstimate_'. Bounds the
+  // memory a wrong estimate can take before there are rows.
+  static constexpr int64_t kMaxSizeForEstimate = 16 << 20;
+
+  // Number of rows between the prefetch of a probe position and the
+  // probe. The probes are interleaved 4 at a time, so this covers 4
+  // rounds of probes.
+  static constexpr int32_t kPrefetchDistance = 16;
 
   void rehash();
+
+  // Inserts the rows of 'this' and 'otherTables_' into the table in
+  // two parallel steps on 'buildExecutor_' and the calling thread. The
+  // first computes the hashes of each RowContainer and bins the rows
+  // by the range of the table they start probing at. The second inserts
+  // each range of rows into its part of the table. Rows whose probe
+  // would run past the end of their range are inserted afterwards by
+  // the calling thread. Computing value ids updates the VectorHashers,
+  // so the first step runs serially unless 'hashMode_' is kHash.
+  // Returns false if a key has no value id, in which case the caller
+  // must switch to kHash mode.
+  bool parallelJoinBuild();
+
+  // Inserts 'row' into a join table in kHash or kNormalizedKey mode. The
+  // row is added to an existing entry with the same key or put in the
+  // first free slot on its probe path. Returns false without inserting
+  // if the probe reaches the tag offset 'end'.
+  bool insertJoinRow(char* row, uint64_t hash, int64_t end);
+
+  // Computes the hash numbers or value ids of 'groups' of 'rows'
+  // according to 'hashMode_'. 'rows' is either 'rows_' or the
+  // RowContainer of one of 'otherTables_'. Returns false if a key does
+  // not have a value id. With a wide normalized key, the value ids of
+  // the second word go to 'highHashes'.
+  bool hashRows(
+      RowContainer& rows,
+      char** groups,
+      int32_t numGroups,
+      uint64_t* hashes,
+      uint64_t* highHashes = nullptr);
+
   void initializeNewGroups(HashLookup& lookup);
   void storeKeys(HashLookup& lookup, vector_size_t row);
 
@@ -365,10 +539,20 @@ class HashTable : public BaseHashTable {
 
   void checkSize(int32_t numNew);
 
+  // Returns the table size that holds 'distinctEstimate_' entries at the
+  // load factor of checkSize(), at most kMaxSizeForEstimate. 0 if there
+  // is no estimate.
+  uint64_t sizeForEstimate() const;
+
   // Computes hash numbers of the appropriate hash mode for 'groups',
   // stores these in 'hashes' and inserts the groups using
-  // insertForJoin or insertForGroupBy.
-  bool insertBatch(char** groups, uint64_t* hashes, int32_t numGroups);
+  // insertForJoin or insertForGroupBy. 'highHashes' is scratch for
+  // the second word of a wide normalized key.
+  bool insertBatch(
+      char** groups,
+      uint64_t* hashes,
+      uint64_t* highHashes,
+      int32_t numGroups);
 
   // Inserts 'numGroups' entries into 'this'. 'groups' point to
   // contents in a RowContainer owned by 'this'. 'hashes' are te hash
@@ -379,9 +563,14 @@ class HashTable : public BaseHashTable {
   // Inserts 'numGroups' entries into 'this'. 'groups' point to
   // contents in a RowContainer owned by 'this'. 'hashes' are te hash
   // numbers or array indices (if kArray mode) for each
-  // group. 'groups' is expectedd to have no duplicate keys.
+  // group. 'groups' is expectedd to have no duplicate keys. 'highHashes'
+  // has the second word of a wide normalized key.
 
-  void insertForGroupBy(char** groups, uint64_t* hashes, int32_t numGroups);
+  void insertForGroupBy(
+      char** groups,
+      uint64_t* hashes,
+      uint64_t* highHashes,
+      int32_t numGroups);
 
   char* insertEntry(HashLookup& lookup, int32_t index, vector_size_t row);
   bool compareKeys(char* group, HashLookup& lookup, vector_size_t row);
@@ -389,6 +578,10 @@ class HashTable : public BaseHashTable {
   template <bool isJoin>
   void fullProbe(HashLookup& lookup, ProbeState& state, bool extraCheck);
 
+  // Prefetches the tags and row pointers where the probes for the rows
+  // of 'lookup' at positions 'begin' to 'end' in 'lookup.rows' start.
+  void prefetchProbes(const HashLookup& lookup, int32_t begin, int32_t end);
+
   // Adds a row to a hash join table in kArray hash mode. Returns true
   // if a new entry was made and false if the row was added to an
   // existing set of rows with the same key.
@@ -407,16 +600,21 @@ class HashTable : public BaseHashTable {
   // for array or normalized key.
   bool analyze();
   // Erases the entries of rows from the hash table and its RowContainer.
-  // 'hashes' must be computed according to 'hashMode_'.
-  void eraseWithHashes(folly::Range<char**> rows, uint64_t* hashes);
+  // 'hashes' must be computed according to 'hashMode_'. 'highHashes'
+  // has the second word of a wide normalized key.
+  void eraseWithHashes(
+      folly::Range<char**> rows,
+      uint64_t* hashes,
+      uint64_t* highHashes);
 
   const std::vector<std::unique_ptr<Aggregate>>& aggregates_;
   int8_t sizeBits_;
   bool isJoinBuild_ = false;
 
   // Set at join build time if the table has duplicates, meaning
-  // that the join can be cardinality increasing.
-  bool hasDuplicates_ = false;
+  // that the join can be cardinality increasing. Atomic since a
+  // parallel join build sets this from multiple threads.
+  std::atomic<bool> hasDuplicates_{false};
 
   // Offset of next row link for join build side, 0 if none. Copied
   // from 'rows_'.
@@ -426,10 +624,14 @@ class HashTable : public BaseHashTable {
   int64_t size_ = 0;
   int64_t sizeMask_ = 0;
   int64_t numDistinct_ = 0;
+  // Expected number of distinct keys. 0 if not known.
+  uint64_t distinctEstimate_ = 0;
   HashMode hashMode_ = HashMode::kArray;
   // Owns the memory of multiple build side hash join tables that are
   // combined into a single probe hash table.
   std::vector<std::unique_ptr<HashTable<ignoreNullKeys>>> otherTables_;
+  // Runs parallelJoinBuild(). Set by prepareJoinTable().
+  folly::Executor* FOLLY_NULLABLE buildExecutor_ = nullptr;
 };
 
 } // namespace facebook::velox::exec
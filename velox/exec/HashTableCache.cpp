@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/HashTableCache.h"
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <sstream>
+
+DEFINE_uint64(
+    velox_hash_table_cache_bytes,
+    256 << 20,
+    "Process-wide capacity of the cache of hash join build side tables");
+
+namespace facebook::velox::exec {
+
+HashTableCache* HashTableCache::getInstance() {
+  static HashTableCache instance;
+  return &instance;
+}
+
+// static
+core::PlanNodeId HashTableCache::cacheableBuildScan(
+    const core::HashJoinNode& joinNode) {
+  if (joinNode.isRightJoin() || joinNode.isFullJoin()) {
+    return "";
+  }
+  auto node = joinNode.sources()[1].get();
+  while (dynamic_cast<const core::FilterNode*>(node) ||
+         dynamic_cast<const core::ProjectNode*>(node)) {
+    node = node->sources()[0].get();
+  }
+  if (!dynamic_cast<const core::TableScanNode*>(node)) {
+    return "";
+  }
+  return node->id();
+}
+
+// static
+std::string HashTableCache::fingerprint(const core::HashJoinNode& joinNode) {
+  std::stringstream out;
+  out << "type: " << static_cast<int>(joinNode.joinType()) << ", keys: ";
+  for (auto& key : joinNode.rightKeys()) {
+    out << key->name() << " ";
+  }
+  if (joinNode.filter()) {
+    out << ", filter: " << joinNode.filter()->toString();
+  }
+  out << ", output: " << joinNode.outputType()->toString() << "\n"
+      << joinNode.sources()[1]->toString(true, true);
+  return out.str();
+}
+
+// static
+std::string HashTableCache::makeKey(
+    const std::string& fingerprint,
+    std::vector<std::string> splitKeys) {
+  std::sort(splitKeys.begin(), splitKeys.end());
+  auto key = fingerprint;
+  for (auto& splitKey : splitKeys) {
+    key += "\n";
+    key += splitKey;
+  }
+  return key;
+}
+
+std::shared_ptr<BaseHashTable> HashTableCache::find(const std::string& key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = keyToEntry_.find(key);
+  if (it == keyToEntry_.end()) {
+    ++numMisses_;
+    return nullptr;
+  }
+  ++numHits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->table;
+}
+
+void HashTableCache::put(
+    const std::string& key,
+    std::shared_ptr<BaseHashTable> table) {
+  const uint64_t capacity = FLAGS_velox_hash_table_cache_bytes;
+  const uint64_t bytes = table->allocatedBytes();
+  if (bytes > capacity) {
+    return;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  if (keyToEntry_.count(key)) {
+    // Concurrent queries made the same table. Keep the first.
+    return;
+  }
+  evictLocked(capacity - bytes);
+  entries_.push_front(Entry{key, std::move(table), bytes});
+  keyToEntry_[key] = entries_.begin();
+  cachedBytes_ += bytes;
+}
+
+void HashTableCache::evictLocked(uint64_t capacity) {
+  while (cachedBytes_ > capacity) {
+    auto& entry = entries_.back();
+    cachedBytes_ -= entry.bytes;
+    keyToEntry_.erase(entry.key);
+    entries_.pop_back();
+    ++numEvictions_;
+  }
+}
+
+void HashTableCache::clear() {
+  std::lock_guard<std::mutex> l(mutex_);
+  keyToEntry_.clear();
+  entries_.clear();
+  cachedBytes_ = 0;
+  numHits_ = 0;
+  numMisses_ = 0;
+  numEvictions_ = 0;
+}
+
+int64_t HashTableCache::numHits() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return numHits_;
+}
+
+int64_t HashTableCache::numMisses() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return numMisses_;
+}
+
+int64_t HashTableCache::numEvictions() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return numEvictions_;
+}
+
+uint64_t HashTableCache::cachedBytes() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return cachedBytes_;
+}
+
+} // namespace facebook::velox::exec
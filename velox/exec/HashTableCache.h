@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "velox/core/PlanNode.h"
+#include "velox/exec/HashTable.h"
+
+namespace facebook::velox::exec {
+
+// Process-wide cache of the hash tables made by the build side of hash
+// joins. Queries that join with the same table, e.g. a dimension table
+// of a star schema, then probe one shared read-only table instead of
+// each reading the build side and making a table of its own. A table
+// is keyed by the fingerprint of the build side plan and the cache keys
+// of its splits. Entries are evicted in LRU order when their allocated
+// bytes exceed --velox_hash_table_cache_bytes. An evicted table is
+// freed when the last HashProbe that uses it is done.
+class HashTableCache {
+ public:
+  static HashTableCache* getInstance();
+
+  // Returns the id of the TableScan that reads the build side of
+  // 'joinNode' if its table may be taken from the cache, or an empty
+  // id otherwise. The build side must be a TableScan followed by
+  // filters and projections. A right join sets the probed flags of the
+  // table, so its table is not shared.
+  static core::PlanNodeId cacheableBuildScan(
+      const core::HashJoinNode& joinNode);
+
+  // Identifies the table 'joinNode' builds from a given input.
+  static std::string fingerprint(const core::HashJoinNode& joinNode);
+
+  // Returns the key of the table made from 'splitKeys' by a build side
+  // with 'fingerprint'. The order of the splits does not matter.
+  static std::string makeKey(
+      const std::string& fingerprint,
+      std::vector<std::string> splitKeys);
+
+  // Returns the table for 'key' or nullptr if not cached.
+  std::shared_ptr<BaseHashTable> find(const std::string& key);
+
+  // Adds 'table' under 'key'. Evicts the least recently used tables
+  // until the cached tables fit in the capacity. A table that alone
+  // exceeds the capacity is not cached.
+  void put(const std::string& key, std::shared_ptr<BaseHashTable> table);
+
+  // Drops all entries and resets the counters.
+  void clear();
+
+  int64_t numHits() const;
+  int64_t numMisses() const;
+  int64_t numEvictions() const;
+
+  // Sum of the allocated bytes of the cached tables.
+  uint64_t cachedBytes() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<BaseHashTable> table;
+    uint64_t bytes;
+  };
+
+  void evictLocked(uint64_t capacity);
+
+  mutable std::mutex mutex_;
+  // The most recently used entry is first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> keyToEntry_;
+  uint64_t cachedBytes_{0};
+  int64_t numHits_{0};
+  int64_t numMisses_{0};
+  int64_t numEvictions_{0};
+};
+
+} // namespace facebook::velox::exec
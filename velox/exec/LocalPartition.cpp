@@ -29,56 +29,68 @@ void notify(std::vector<VeloxPromise<bool>>& promises) {
 bool LocalExchangeMemoryManager::increaseMemoryUsage(
     ContinueFuture* future,
     int64_t added) {
+  if ((bufferedBytes_ += added) < maxBufferSize_) {
+    return false;
+  }
   std::lock_guard<std::mutex> l(mutex_);
-  bufferedBytes_ += added;
-
-  if (bufferedBytes_ >= maxBufferSize_) {
-    promises_.emplace_back("LocalExchangeMemoryManager::updateMemoryUsage");
-    *future = promises_.back().getSemiFuture();
-    return true;
+  // A consumer may have gone below the limit after the atomic add. It
+  // checks for promises under 'mutex_' after going below.
+  if (bufferedBytes_ < maxBufferSize_ || cancelled_) {
+    return false;
   }
-
-  return false;
+  promises_.emplace_back("LocalExchangeMemoryManager::updateMemoryUsage");
+  *future = promises_.back().getSemiFuture();
+  return true;
 }
 
 void LocalExchangeMemoryManager::decreaseMemoryUsage(int64_t removed) {
+  auto bytes = bufferedBytes_ -= removed;
+  if (bytes >= maxBufferSize_ || bytes + removed < maxBufferSize_) {
+    return;
+  }
   std::vector<VeloxPromise<bool>> promises;
   {
     std::lock_guard<std::mutex> l(mutex_);
-    bufferedBytes_ -= removed;
-
-    if (bufferedBytes_ < maxBufferSize_ &&
-        bufferedBytes_ + removed >= maxBufferSize_) {
-      promises = std::move(promises_);
-    }
+    promises = std::move(promises_);
   }
+  notify(promises);
+}
 
+void LocalExchangeMemoryManager::cancel() {
+  std::vector<VeloxPromise<bool>> promises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    cancelled_ = true;
+    promises = std::move(promises_);
+  }
   notify(promises);
 }
 
 void LocalExchangeSource::addProducer() {
-  queue_.withWLock([&](auto& /*queue*/) {
-    VELOX_CHECK(!noMoreProducers_, "addProducer called after noMoreProducers");
-    ++pendingProducers_;
-  });
+  std::lock_guard<std::mutex> l(mutex_);
+  VELOX_CHECK(!noMoreProducers_, "addProducer called after noMoreProducers");
+  ++pendingProducers_;
 }
 
 void LocalExchangeSource::noMoreProducers() {
   std::vector<VeloxPromise<bool>> consumerPromises;
   std::vector<VeloxPromise<bool>> producerPromises;
-  queue_.withWLock([&](auto& queue) {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
     VELOX_CHECK(!noMoreProducers_, "noMoreProducers can be called only once");
     noMoreProducers_ = true;
     if (pendingProducers_ == 0) {
       // No more data will be produced.
+      allProduced_ = true;
       consumerPromises = std::move(consumerPromises_);
+      hasConsumerPromises_ = false;
 
-      if (queue.empty()) {
+      if (numQueued_ == 0) {
         // All data has been consumed.
         producerPromises = std::move(producerPromises_);
       }
     }
-  });
+  }
   notify(consumerPromises);
   notify(producerPromises);
 }
@@ -86,36 +98,104 @@ void LocalExchangeSource::noMoreProducers() {
 BlockingReason LocalExchangeSource::enqueue(
     RowVectorPtr input,
     ContinueFuture* future) {
+  if (consumerClosed_) {
+    // Nobody reads 'input'.
+    return BlockingReason::kNotBlocked;
+  }
   auto inputBytes = input->retainedSize();
 
-  std::vector<VeloxPromise<bool>> consumerPromises;
-  queue_.withWLock([&](auto& queue) {
-    queue.push(std::move(input));
-    consumerPromises = std::move(consumerPromises_);
-  });
-  notify(consumerPromises);
-
-  if (memoryManager_->increaseMemoryUsage(future, inputBytes)) {
-    return BlockingReason::kWaitForConsumer;
+  queue_.enqueue(std::move(input));
+  ++numQueued_;
+  // Pairs with the check of 'numQueued_' after a consumer sets
+  // 'hasConsumerPromises_'. Either the consumer sees the data or this
+  // sees the promise.
+  if (hasConsumerPromises_) {
+    std::vector<VeloxPromise<bool>> consumerPromises;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      consumerPromises = std::move(consumerPromises_);
+      hasConsumerPromises_ = false;
+    }
+    notify(consumerPromises);
   }
 
-  return BlockingReason::kNotBlocked;
+  auto blocked = memoryManager_->increaseMemoryUsage(future, inputBytes);
+  if (consumerClosed_) {
+    // The consumer closed after the check above and may not have seen
+    // 'input'.
+    dropQueued();
+    return BlockingReason::kNotBlocked;
+  }
+  return blocked ? BlockingReason::kWaitForConsumer
+                 : BlockingReason::kNotBlocked;
 }
 
 void LocalExchangeSource::noMoreData() {
   std::vector<VeloxPromise<bool>> consumerPromises;
   std::vector<VeloxPromise<bool>> producerPromises;
-  queue_.withWLock([&](auto queue) {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
     VELOX_CHECK_GT(pendingProducers_, 0);
     --pendingProducers_;
     if (noMoreProducers_ && pendingProducers_ == 0) {
+      allProduced_ = true;
       consumerPromises = std::move(consumerPromises_);
-      if (queue.empty()) {
+      hasConsumerPromises_ = false;
+      if (numQueued_ == 0) {
         producerPromises = std::move(producerPromises_);
       }
     }
-  });
+  }
+  notify(consumerPromises);
+  notify(producerPromises);
+}
+
+bool LocalExchangeSource::tryDequeue(RowVectorPtr* data) {
+  if (!queue_.try_dequeue(*data)) {
+    return false;
+  }
+  --numQueued_;
+  memoryManager_->decreaseMemoryUsage((*data)->retainedSize());
+  return true;
+}
+
+void LocalExchangeSource::dropQueued() {
+  RowVectorPtr data;
+  while (tryDequeue(&data)) {
+  }
+}
+
+void LocalExchangeSource::consumerClosed() {
+  consumerClosed_ = true;
+  dropQueued();
+  std::vector<VeloxPromise<bool>> producerPromises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    producerPromises = std::move(producerPromises_);
+  }
+  notify(producerPromises);
+}
+
+void LocalExchangeSource::cancel() {
+  consumerClosed();
+  std::vector<VeloxPromise<bool>> consumerPromises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    consumerPromises = std::move(consumerPromises_);
+    hasConsumerPromises_ = false;
+  }
   notify(consumerPromises);
+}
+
+void LocalExchangeSource::checkAllFetched() {
+  if (!allProduced_ || numQueued_ > 0) {
+    return;
+  }
+  std::vector<VeloxPromise<bool>> producerPromises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    producerPromises = std::move(producerPromises_);
+  }
   notify(producerPromises);
 }
 
@@ -123,46 +203,51 @@ BlockingReason LocalExchangeSource::next(
     ContinueFuture* future,
     memory::MemoryPool* pool,
     RowVectorPtr* data) {
-  std::vector<VeloxPromise<bool>> producerPromises;
-  auto blockingReason = queue_.withWLock([&](auto& queue) {
-    *data = nullptr;
-    if (queue.empty()) {
-      if (noMoreProducers_ && pendingProducers_ == 0) {
+  *data = nullptr;
+  if (tryDequeue(data)) {
+    checkAllFetched();
+    return BlockingReason::kNotBlocked;
+  }
+
+  std::vector<VeloxPromise<bool>> consumerPromises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (noMoreProducers_ && pendingProducers_ == 0) {
+      // All data is in 'queue_'.
+      if (!tryDequeue(data)) {
         return BlockingReason::kNotBlocked;
       }
-
+    } else {
       consumerPromises_.emplace_back("LocalExchangeSource::next");
       *future = consumerPromises_.back().getSemiFuture();
-
-      return BlockingReason::kWaitForExchange;
-    }
-
-    *data = queue.front();
-    queue.pop();
-
-    memoryManager_->decreaseMemoryUsage((*data)->retainedSize());
-
-    if (noMoreProducers_ && pendingProducers_ == 0 && queue.empty()) {
-      producerPromises = std::move(producerPromises_);
+      hasConsumerPromises_ = true;
+      if (numQueued_ > 0) {
+        // A producer added data without seeing the promise. The consumer
+        // continues right away and fetches the data.
+        consumerPromises = std::move(consumerPromises_);
+        hasConsumerPromises_ = false;
+      }
     }
-
+  }
+  if (*data) {
+    checkAllFetched();
     return BlockingReason::kNotBlocked;
-  });
-  notify(producerPromises);
-  return blockingReason;
+  }
+  notify(consumerPromises);
+  return BlockingReason::kWaitForExchange;
 }
 
 BlockingReason LocalExchangeSource::isFinished(ContinueFuture* future) {
-  return queue_.withWLock([&](auto& queue) {
-    if (noMoreProducers_ && pendingProducers_ == 0 && queue.empty()) {
-      return BlockingReason::kNotBlocked;
-    }
+  std::lock_guard<std::mutex> l(mutex_);
+  if (consumerClosed_ ||
+      (noMoreProducers_ && pendingProducers_ == 0 && numQueued_ == 0)) {
+    return BlockingReason::kNotBlocked;
+  }
 
-    producerPromises_.emplace_back("LocalExchangeSource::isFinished");
-    *future = producerPromises_.back().getSemiFuture();
+  producerPromises_.emplace_back("LocalExchangeSource::isFinished");
+  *future = producerPromises_.back().getSemiFuture();
 
-    return BlockingReason::kWaitForConsumer;
-  });
+  return BlockingReason::kWaitForConsumer;
 }
 
 LocalExchangeSourceOperator::LocalExchangeSourceOperator(
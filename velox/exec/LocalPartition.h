@@ -15,13 +15,17 @@
  */
 #pragma once
 
+#include <folly/concurrency/UnboundedQueue.h>
+
 #include "velox/exec/Operator.h"
 #include "velox/exec/VectorHasher.h"
 
 namespace facebook::velox::exec {
 
 /// Keeps track of the total size in bytes of the data buffered in all
-/// LocalExchangeSources.
+/// LocalExchangeSources. The size is an atomic. The mutex is taken only
+/// to block a producer at the limit and to unblock the producers when
+/// the size goes below the limit.
 class LocalExchangeMemoryManager {
  public:
   explicit LocalExchangeMemoryManager(int64_t maxBufferSize)
@@ -33,10 +37,15 @@ class LocalExchangeMemoryManager {
 
   void decreaseMemoryUsage(int64_t removed);
 
+  /// Unblocks the waiting producers. No producer blocks after this.
+  /// Called when the task is terminated.
+  void cancel();
+
  private:
   const int64_t maxBufferSize_;
   std::mutex mutex_;
-  int64_t bufferedBytes_{0};
+  std::atomic<int64_t> bufferedBytes_{0};
+  std::atomic<bool> cancelled_{false};
   std::vector<VeloxPromise<bool>> promises_;
 };
 
@@ -85,18 +94,57 @@ class LocalExchangeSource {
   /// copied into the consumers memory pool.
   BlockingReason isFinished(ContinueFuture* future);
 
+  /// Called by the consumer when it will not fetch any more data, e.g. when
+  /// a Limit downstream has all the rows it needs. Drops the queued data
+  /// and unblocks the producers. The producers' data is dropped from then
+  /// on.
+  void consumerClosed();
+
+  /// True after consumerClosed(). A producer with no open consumers stops
+  /// asking for input.
+  bool isConsumerClosed() const {
+    return consumerClosed_;
+  }
+
   void close() {
-    queue_.withWLock([](auto& queue) {
-      while (!queue.empty()) {
-        queue.pop();
-      }
-    });
+    RowVectorPtr data;
+    while (queue_.try_dequeue(data)) {
+      --numQueued_;
+    }
   }
 
+  /// Called when the task is terminated. Drops the queued data like
+  /// consumerClosed() and also realizes the futures of the waiting
+  /// consumers, so that the Drivers of both sides see the termination
+  /// without waiting for data or space.
+  void cancel();
+
  private:
+  // Returns the first of 'queue_' in 'data'. Returns false if 'queue_' is
+  // empty.
+  bool tryDequeue(RowVectorPtr* data);
+
+  // Drops the content of 'queue_' after consumerClosed().
+  void dropQueued();
+
+  // Satisfies the promises of the producers if all data is produced and
+  // fetched.
+  void checkAllFetched();
+
   LocalExchangeMemoryManager* memoryManager_;
   const int partition_;
-  folly::Synchronized<std::queue<RowVectorPtr>> queue_;
+  // Producers add and consumers take data without locking. 'mutex_'
+  // serializes the rest of the state, which changes when a consumer
+  // has to wait or when producers finish.
+  folly::UMPMCQueue<RowVectorPtr, false> queue_;
+  // Number of entries in 'queue_'. Incremented after adding to 'queue_',
+  // so it may be briefly negative.
+  std::atomic<int64_t> numQueued_{0};
+  // True if 'consumerPromises_' is not empty.
+  std::atomic<bool> hasConsumerPromises_{false};
+  // True if noMoreProducers_ is true and pendingProducers_ is zero.
+  std::atomic<bool> allProduced_{false};
+  std::mutex mutex_;
   // Satisfied when data becomes available or all producers report that they
   // finished producing, e.g. queue_ is not empty or noMoreProducers_ is true
   // and pendingProducers_ is zero.
@@ -107,6 +155,8 @@ class LocalExchangeSource {
   std::vector<VeloxPromise<bool>> producerPromises_;
   int pendingProducers_{0};
   bool noMoreProducers_{false};
+  // Set by consumerClosed().
+  std::atomic<bool> consumerClosed_{false};
 };
 
 /// Fetches data for a single partition produced by local exchange from
@@ -128,6 +178,11 @@ class LocalExchangeSourceOperator : public SourceOperator {
 
   RowVectorPtr getOutput() override;
 
+  void close() override {
+    Operator::close();
+    source_->consumerClosed();
+  }
+
  private:
   const int partition_;
   const std::shared_ptr<LocalExchangeSource> source_{nullptr};
@@ -154,10 +209,17 @@ class LocalPartition : public Operator {
     return nullptr;
   }
 
-  // Always true but the caller will check isBlocked before adding input, hence
-  // the blocked state does not accumulate input.
+  // True until all consumers are closed. The caller will check isBlocked
+  // before adding input, hence the blocked state does not accumulate
+  // input. When no consumer is left, the Driver finishes the producers
+  // upstream, e.g. a TableScan stops reading.
   bool needsInput() const override {
-    return true;
+    for (const auto& source : localExchangeSources_) {
+      if (!source->isConsumerClosed()) {
+        return true;
+      }
+    }
+    return false;
   }
 
   BlockingReason isBlocked(ContinueFuture* future) override;
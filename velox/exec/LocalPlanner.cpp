@@ -14,25 +14,34 @@
  * limitations under the License.
  */
 #include "velox/exec/LocalPlanner.h"
+#include "velox/core/Expressions.h"
 #include "velox/exec/Aggregate.h"
+#include "velox/exec/ArrowStream.h"
 #include "velox/exec/CallbackSink.h"
 #include "velox/exec/CrossJoinBuild.h"
 #include "velox/exec/CrossJoinProbe.h"
 #include "velox/exec/EnforceSingleRow.h"
 #include "velox/exec/Exchange.h"
 #include "velox/exec/FilterProject.h"
+#include "velox/exec/FragmentResultCache.h"
+#include "velox/exec/GroupId.h"
 #include "velox/exec/HashAggregation.h"
 #include "velox/exec/HashBuild.h"
 #include "velox/exec/HashProbe.h"
 #include "velox/exec/Limit.h"
 #include "velox/exec/Merge.h"
+#include "velox/exec/MergeJoin.h"
 #include "velox/exec/OrderBy.h"
 #include "velox/exec/PartitionedOutput.h"
+#include "velox/exec/StreamingAggregation.h"
+#include "velox/exec/SyntheticSource.h"
 #include "velox/exec/TableScan.h"
 #include "velox/exec/TableWriter.h"
 #include "velox/exec/TopN.h"
+#include "velox/exec/TopNRowNumber.h"
 #include "velox/exec/Unnest.h"
 #include "velox/exec/Values.h"
+#include "velox/exec/Window.h"
 
 namespace facebook::velox::exec {
 
@@ -100,6 +109,19 @@ OperatorSupplier makeConsumerSupplier(
       return std::make_unique<CrossJoinBuild>(operatorId, ctx, join);
     };
   }
+
+  if (auto join =
+          std::dynamic_pointer_cast<const core::MergeJoinNode>(planNode)) {
+    auto planNodeId = join->id();
+    return [planNodeId](int32_t operatorId, DriverCtx* ctx) {
+      auto consumer = [ctx, planNodeId](
+                          RowVectorPtr input, ContinueFuture* future) {
+        auto source = ctx->task->getMergeJoinSource(planNodeId);
+        return source->enqueue(input, future);
+      };
+      return std::make_unique<CallbackSink>(operatorId, ctx, consumer);
+    };
+  }
   return nullptr;
 }
 
@@ -150,6 +172,17 @@ uint32_t maxDrivers(
         return 1;
       }
     }
+    if (std::dynamic_pointer_cast<const core::ArrowStreamNode>(node)) {
+      // Arrow streams are read sequentially.
+      return 1;
+    }
+    if (auto topNRowNumber =
+            std::dynamic_pointer_cast<const core::TopNRowNumberNode>(node)) {
+      // final topNRowNumber must see all rows of a partition
+      if (!topNRowNumber->isPartial()) {
+        return 1;
+      }
+    }
     if (auto limit = std::dynamic_pointer_cast<const core::LimitNode>(node)) {
       // final limit must run single-threaded
       if (!limit->isPartial()) {
@@ -168,6 +201,10 @@ uint32_t maxDrivers(
       // Local merge must run single-threaded.
       return 1;
     }
+    if (auto window = std::dynamic_pointer_cast<const core::WindowNode>(node)) {
+      // Window must see all rows of a partition and runs single-threaded.
+      return 1;
+    }
 
     if (auto mergeExchange =
             std::dynamic_pointer_cast<const core::MergeExchangeNode>(node)) {
@@ -175,6 +212,12 @@ uint32_t maxDrivers(
       return 1;
     }
 
+    if (auto mergeJoin =
+            std::dynamic_pointer_cast<const core::MergeJoinNode>(node)) {
+      // Merge join must run single-threaded.
+      return 1;
+    }
+
     if (auto tableWrite =
             std::dynamic_pointer_cast<const core::TableWriteNode>(node)) {
       if (!tableWrite->insertTableHandle()
@@ -186,6 +229,215 @@ uint32_t maxDrivers(
   }
   return std::numeric_limits<uint32_t>::max();
 }
+
+/// Returns a cache for the results of the partial aggregation of
+/// 'planNodes' per split if caching is enabled and the pipeline is a
+/// TableScan followed by filters, projections and a partial hash
+/// aggregation. Returns nullptr otherwise.
+std::shared_ptr<FragmentResultCache> makeFragmentResultCache(
+    const std::vector<std::shared_ptr<const core::PlanNode>>& planNodes,
+    const core::QueryCtx& queryCtx) {
+  if (!queryCtx.fragmentResultCacheEnabled() || !isRegisteredVectorSerde() ||
+      !std::dynamic_pointer_cast<const core::TableScanNode>(planNodes[0])) {
+    return nullptr;
+  }
+  auto* asyncCache =
+      dynamic_cast<cache::AsyncDataCache*>(queryCtx.mappedMemory());
+  if (!asyncCache) {
+    return nullptr;
+  }
+  for (auto i = 1; i < planNodes.size(); ++i) {
+    const auto& node = planNodes[i];
+    if (std::dynamic_pointer_cast<const core::FilterNode>(node) ||
+        std::dynamic_pointer_cast<const core::ProjectNode>(node)) {
+      continue;
+    }
+    // A global aggregation keeps its accumulators across flushes, so
+    // its output cannot be attributed to single splits.
+    auto aggregation =
+        std::dynamic_pointer_cast<const core::AggregationNode>(node);
+    if (!aggregation ||
+        aggregation->step() != core::AggregationNode::Step::kPartial ||
+        aggregation->groupingKeys().empty() ||
+        aggregation->aggregates().empty() || aggregation->isPreGrouped()) {
+      return nullptr;
+    }
+    return std::make_shared<FragmentResultCache>(
+        asyncCache,
+        aggregation->id(),
+        aggregation->toString(true, true),
+        aggregation->outputType());
+  }
+  return nullptr;
+}
+bool isFilterOrProject(const std::shared_ptr<const core::PlanNode>& node) {
+  return std::dynamic_pointer_cast<const core::FilterNode>(node) ||
+      std::dynamic_pointer_cast<const core::ProjectNode>(node);
+}
+
+/// Rewrites a chain of adjacent FilterNodes and ProjectNodes into one
+/// filter and one projection over the input of the first node. The
+/// references to the columns of a projection are replaced by their
+/// expressions, so that the projections nobody reads drop out.
+class FilterProjectFuser {
+ public:
+  explicit FilterProjectFuser(core::ExecCtx* execCtx) : execCtx_(execCtx) {}
+
+  /// Adds the next node of the chain. Returns false if 'node' cannot be
+  /// rewritten.
+  bool add(const std::shared_ptr<const core::PlanNode>& node) {
+    if (!source_) {
+      source_ = node->sources()[0];
+    }
+    id_ = node->id();
+    if (auto filter = std::dynamic_pointer_cast<const core::FilterNode>(node)) {
+      auto expr = inlineColumns(filter->filter(), false);
+      if (!expr) {
+        return false;
+      }
+      filters_.push_back(std::move(expr));
+      return true;
+    }
+    auto project = std::dynamic_pointer_cast<const core::ProjectNode>(node);
+    std::unordered_map<std::string, core::TypedExprPtr> columns;
+    for (auto i = 0; i < project->names().size(); ++i) {
+      auto expr = inlineColumns(project->projections()[i], false);
+      if (!expr) {
+        return false;
+      }
+      columns[project->names()[i]] = std::move(expr);
+    }
+    columns_ = std::move(columns);
+    names_ = project->names();
+    hasProject_ = true;
+    return true;
+  }
+
+  /// Makes the fused nodes. 'filter' or 'project' is set to nullptr if
+  /// the chain has no FilterNode or no ProjectNode. Returns false if a
+  /// non-deterministic expression would be evaluated more than once.
+  bool finish(
+      std::shared_ptr<const core::FilterNode>& filter,
+      std::shared_ptr<const core::ProjectNode>& project) {
+    for (const auto& [expr, numUses] : numUses_) {
+      if (numUses > 1 || inLambda_.count(expr)) {
+        std::vector<core::TypedExprPtr> exprs{expr};
+        ExprSet exprSet(std::move(exprs), execCtx_, false);
+        if (!exprSet.exprs()[0]->isDeterministic()) {
+          return false;
+        }
+      }
+    }
+    std::shared_ptr<const core::PlanNode> source = source_;
+    filter = nullptr;
+    if (!filters_.empty()) {
+      auto expr = filters_.size() == 1
+          ? filters_[0]
+          : std::make_shared<core::CallTypedExpr>(BOOLEAN(), filters_, "and");
+      filter = std::make_shared<core::FilterNode>(id_, expr, source);
+      source = filter;
+    }
+    project = nullptr;
+    if (hasProject_) {
+      std::vector<core::TypedExprPtr> projections;
+      projections.reserve(names_.size());
+      for (const auto& name : names_) {
+        projections.push_back(columns_[name]);
+      }
+      project = std::make_shared<core::ProjectNode>(
+          id_, names_, std::move(projections), source);
+    }
+    return true;
+  }
+
+ private:
+  // Returns 'expr' with the references to the columns of the last
+  // projection replaced by their expressions. Returns nullptr for an
+  // expression kind this does not know.
+  core::TypedExprPtr inlineColumns(
+      const core::TypedExprPtr& expr,
+      bool inLambda) {
+    if (auto field =
+            std::dynamic_pointer_cast<const core::FieldAccessTypedExpr>(expr)) {
+      if (!field->inputs().empty()) {
+        auto input = inlineColumns(field->inputs()[0], inLambda);
+        return input ? std::make_shared<core::FieldAccessTypedExpr>(
+                           field->type(), input, field->name())
+                     : nullptr;
+      }
+      if (!hasProject_ || shadowed_.count(field->name())) {
+        return expr;
+      }
+      auto it = columns_.find(field->name());
+      VELOX_CHECK(it != columns_.end(), "Unknown column {}", field->name());
+      if (!std::dynamic_pointer_cast<const core::FieldAccessTypedExpr>(
+              it->second)) {
+        ++numUses_[it->second];
+        if (inLambda) {
+          inLambda_.insert(it->second);
+        }
+      }
+      return it->second;
+    }
+    if (std::dynamic_pointer_cast<const core::ConstantTypedExpr>(expr)) {
+      return expr;
+    }
+    if (auto lambda =
+            std::dynamic_pointer_cast<const core::LambdaTypedExpr>(expr)) {
+      // The arguments of the lambda hide the columns of the same name.
+      auto shadowed = shadowed_;
+      for (const auto& name : lambda->signature()->names()) {
+        shadowed_.insert(name);
+      }
+      auto body = inlineColumns(lambda->body(), true);
+      shadowed_ = std::move(shadowed);
+      return body ? std::make_shared<core::LambdaTypedExpr>(
+                        lambda->signature(), body)
+                  : nullptr;
+    }
+    std::vector<core::TypedExprPtr> inputs;
+    inputs.reserve(expr->inputs().size());
+    for (const auto& input : expr->inputs()) {
+      auto newInput = inlineColumns(input, inLambda);
+      if (!newInput) {
+        return nullptr;
+      }
+      inputs.push_back(std::move(newInput));
+    }
+    if (auto call =
+            std::dynamic_pointer_cast<const core::CallTypedExpr>(expr)) {
+      return std::make_shared<core::CallTypedExpr>(
+          call->type(), std::move(inputs), call->name());
+    }
+    if (auto cast =
+            std::dynamic_pointer_cast<const core::CastTypedExpr>(expr)) {
+      return std::make_shared<core::CastTypedExpr>(
+          cast->type(), inputs, cast->nullOnFailure());
+    }
+    if (std::dynamic_pointer_cast<const core::ConcatTypedExpr>(expr)) {
+      return std::make_shared<core::ConcatTypedExpr>(
+          expr->type()->asRow().names(), inputs);
+    }
+    return nullptr;
+  }
+
+  core::ExecCtx* const execCtx_;
+  std::shared_ptr<const core::PlanNode> source_;
+  core::PlanNodeId id_;
+  std::vector<core::TypedExprPtr> filters_;
+  // The output columns of the last ProjectNode over the input of the
+  // chain.
+  std::unordered_map<std::string, core::TypedExprPtr> columns_;
+  std::vector<std::string> names_;
+  bool hasProject_{false};
+  // Number of times each expression of 'columns_' other than a column
+  // is inlined.
+  std::unordered_map<core::TypedExprPtr, int32_t> numUses_;
+  // Expressions inlined into a lambda, which evaluates them per element.
+  std::unordered_set<core::TypedExprPtr> inLambda_;
+  // Lambda arguments in scope.
+  std::unordered_set<std::string> shadowed_;
+};
 } // namespace detail
 
 // static
@@ -199,8 +451,23 @@ void LocalPlanner::plan(
       detail::makeConsumerSupplier(consumerSupplier),
       driverFactories);
 
+  // The right side of a merge join feeds a single MergeJoinSource and
+  // must keep its order, so it runs single-threaded too.
+  std::unordered_set<core::PlanNodeId> mergeJoinRightSides;
+  for (auto& factory : *driverFactories) {
+    for (auto& node : factory->planNodes) {
+      if (auto mergeJoin =
+              std::dynamic_pointer_cast<const core::MergeJoinNode>(node)) {
+        mergeJoinRightSides.insert(mergeJoin->sources()[1]->id());
+      }
+    }
+  }
+
   for (auto& factory : *driverFactories) {
     factory->maxDrivers = detail::maxDrivers(factory->planNodes);
+    if (mergeJoinRightSides.count(factory->planNodes.back()->id())) {
+      factory->maxDrivers = 1;
+    }
   }
 }
 
@@ -210,11 +477,41 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
     std::function<int(int pipelineId)> numDrivers) {
   std::vector<std::unique_ptr<Operator>> operators;
   operators.reserve(planNodes.size());
+  ctx->fragmentResultCache =
+      detail::makeFragmentResultCache(planNodes, *ctx->task->queryCtx());
   for (int32_t i = 0; i < planNodes.size(); i++) {
     // Id of the Operator being made. This is not the same as 'i'
     // because some PlanNodes may get fused.
     auto id = operators.size();
     auto planNode = planNodes[i];
+    // A chain of filters and projections other than a single filter
+    // followed by a projection becomes one FilterProject. The column
+    // references are inlined, so that no intermediate vectors are
+    // made.
+    auto chainEnd = i;
+    while (chainEnd < planNodes.size() &&
+           detail::isFilterOrProject(planNodes[chainEnd])) {
+      ++chainEnd;
+    }
+    if (chainEnd - i > 2 ||
+        (chainEnd - i == 2 &&
+         !(std::dynamic_pointer_cast<const core::FilterNode>(planNode) &&
+           std::dynamic_pointer_cast<const core::ProjectNode>(
+               planNodes[i + 1])))) {
+      detail::FilterProjectFuser fuser(ctx->execCtx.get());
+      std::shared_ptr<const core::FilterNode> filterNode;
+      std::shared_ptr<const core::ProjectNode> projectNode;
+      auto fused = true;
+      for (auto j = i; fused && j < chainEnd; ++j) {
+        fused = fuser.add(planNodes[j]);
+      }
+      if (fused && fuser.finish(filterNode, projectNode)) {
+        operators.push_back(std::make_unique<FilterProject>(
+            id, ctx.get(), filterNode, projectNode));
+        i = chainEnd - 1;
+        continue;
+      }
+    }
     if (auto filterNode =
             std::dynamic_pointer_cast<const core::FilterNode>(planNode)) {
       if (i < planNodes.size() - 1) {
@@ -238,6 +535,17 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
         auto valuesNode =
             std::dynamic_pointer_cast<const core::ValuesNode>(planNode)) {
       operators.push_back(std::make_unique<Values>(id, ctx.get(), valuesNode));
+    } else if (
+        auto arrowStreamNode =
+            std::dynamic_pointer_cast<const core::ArrowStreamNode>(planNode)) {
+      operators.push_back(
+          std::make_unique<ArrowStream>(id, ctx.get(), arrowStreamNode));
+    } else if (
+        auto syntheticSourceNode =
+            std::dynamic_pointer_cast<const core::SyntheticSourceNode>(
+                planNode)) {
+      operators.push_back(std::make_unique<SyntheticSource>(
+          id, ctx.get(), syntheticSourceNode));
     } else if (
         auto tableScanNode =
             std::dynamic_pointer_cast<const core::TableScanNode>(planNode)) {
@@ -274,15 +582,32 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
             std::dynamic_pointer_cast<const core::CrossJoinNode>(planNode)) {
       operators.push_back(
           std::make_unique<CrossJoinProbe>(id, ctx.get(), joinNode));
+    } else if (
+        auto joinNode =
+            std::dynamic_pointer_cast<const core::MergeJoinNode>(planNode)) {
+      operators.push_back(std::make_unique<MergeJoin>(id, ctx.get(), joinNode));
     } else if (
         auto aggregationNode =
             std::dynamic_pointer_cast<const core::AggregationNode>(planNode)) {
-      operators.push_back(
-          std::make_unique<HashAggregation>(id, ctx.get(), aggregationNode));
+      // Distinct aggregates are only supported by HashAggregation.
+      if (aggregationNode->isPreGrouped() &&
+          !aggregationNode->hasDistinctAggregates()) {
+        operators.push_back(std::make_unique<StreamingAggregation>(
+            id, ctx.get(), aggregationNode));
+      } else {
+        operators.push_back(
+            std::make_unique<HashAggregation>(id, ctx.get(), aggregationNode));
+      }
     } else if (
         auto topNNode =
             std::dynamic_pointer_cast<const core::TopNNode>(planNode)) {
       operators.push_back(std::make_unique<TopN>(id, ctx.get(), topNNode));
+    } else if (
+        auto topNRowNumberNode =
+            std::dynamic_pointer_cast<const core::TopNRowNumberNode>(
+                planNode)) {
+      operators.push_back(std::make_unique<TopNRowNumber>(
+          id, ctx.get(), topNRowNumberNode));
     } else if (
         auto limitNode =
             std::dynamic_pointer_cast<const core::LimitNode>(planNode)) {
@@ -292,6 +617,15 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
             std::dynamic_pointer_cast<const core::OrderByNode>(planNode)) {
       operators.push_back(
           std::make_unique<OrderBy>(id, ctx.get(), orderByNode));
+    } else if (
+        auto windowNode =
+            std::dynamic_pointer_cast<const core::WindowNode>(planNode)) {
+      operators.push_back(std::make_unique<Window>(id, ctx.get(), windowNode));
+    } else if (
+        auto groupIdNode =
+            std::dynamic_pointer_cast<const core::GroupIdNode>(planNode)) {
+      operators.push_back(
+          std::make_unique<GroupId>(id, ctx.get(), groupIdNode));
     } else if (
         auto localMerge =
             std::dynamic_pointer_cast<const core::LocalMergeNode>(planNode)) {
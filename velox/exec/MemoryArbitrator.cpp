@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/MemoryArbitrator.h"
+#include <algorithm>
+#include <optional>
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+// static
+MemoryArbitrator* MemoryArbitrator::getInstance() {
+  static MemoryArbitrator instance;
+  return &instance;
+}
+
+void MemoryArbitrator::addTask(const std::shared_ptr<Task>& task) {
+  std::lock_guard<std::mutex> l(mutex_);
+  tasks_.push_back(task);
+}
+
+std::vector<std::shared_ptr<Task>> MemoryArbitrator::candidates() {
+  std::vector<std::shared_ptr<Task>> tasks;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto it = tasks_.begin();
+    while (it != tasks_.end()) {
+      auto task = it->lock();
+      if (!task || task->state() != kRunning) {
+        it = tasks_.erase(it);
+        continue;
+      }
+      tasks.push_back(std::move(task));
+      ++it;
+    }
+  }
+  auto usage = [](const std::shared_ptr<Task>& task) -> int64_t {
+    auto& tracker = task->pool()->getMemoryUsageTracker();
+    return tracker ? tracker->getCurrentTotalBytes() : 0;
+  };
+  std::sort(
+      tasks.begin(),
+      tasks.end(),
+      [&](const std::shared_ptr<Task>& left,
+          const std::shared_ptr<Task>& right) {
+        return usage(left) > usage(right);
+      });
+  return tasks;
+}
+
+uint64_t MemoryArbitrator::reclaim(uint64_t bytes, Driver* requester) {
+  // The requester must not count as running while it waits, or else
+  // its own Task and any Task it waits for could not be paused.
+  std::optional<SuspendedSection> suspended;
+  if (requester) {
+    suspended.emplace(requester);
+  }
+  uint64_t freed = 0;
+  {
+    std::lock_guard<std::mutex> l(arbitrationMutex_);
+    for (auto& task : candidates()) {
+      if (freed >= bytes) {
+        break;
+      }
+      freed += Task::reclaim(task, bytes - freed, requester);
+    }
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  ++numArbitrations_;
+  reclaimedBytes_ += freed;
+  return freed;
+}
+
+int64_t MemoryArbitrator::numArbitrations() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return numArbitrations_;
+}
+
+uint64_t MemoryArbitrator::reclaimedBytes() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return reclaimedBytes_;
+}
+
+} // namespace facebook::velox::exec
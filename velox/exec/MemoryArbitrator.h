@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace facebook::velox::exec {
+
+class Driver;
+class Task;
+
+// Arbitrates memory between the Tasks running in the process. A memory
+// user that is about to exceed its MemoryUsageTracker limit calls
+// reclaim(). This pauses the registered Tasks one at a time, the
+// largest memory user first, and asks the Operators of their Drivers to
+// give back memory with Operator::reclaim(), e.g. by spilling. Each
+// Task is resumed as soon as its Operators have been asked. Arbitration
+// is serialized: a thread that waits for its turn is in a suspended
+// section and its own Task can be paused meanwhile.
+class MemoryArbitrator {
+ public:
+  static MemoryArbitrator* getInstance();
+
+  // Makes 'task' a candidate for reclaiming memory. The Task is
+  // dropped from the candidates when it is no longer running or is
+  // freed.
+  void addTask(const std::shared_ptr<Task>& task);
+
+  // Tries to free at least 'bytes' bytes of memory from the Operators
+  // of the registered Tasks. 'requester' is the Driver on whose thread
+  // this is called or nullptr if called from outside of a Driver. The
+  // Operators of 'requester' are not asked to free memory since these
+  // are in the middle of an operation. Returns the number of bytes
+  // freed.
+  uint64_t reclaim(uint64_t bytes, Driver* requester = nullptr);
+
+  // Number of completed calls to reclaim() and the total bytes these
+  // freed.
+  int64_t numArbitrations() const;
+  uint64_t reclaimedBytes() const;
+
+ private:
+  // Returns the running Tasks in descending order of memory usage and
+  // forgets the ones that are no longer running.
+  std::vector<std::shared_ptr<Task>> candidates();
+
+  // Serializes access to 'tasks_' and the counters.
+  mutable std::mutex mutex_;
+  // Serializes calls to reclaim(). Held while Tasks are paused.
+  std::mutex arbitrationMutex_;
+  std::vector<std::weak_ptr<Task>> tasks_;
+  int64_t numArbitrations_ = 0;
+  uint64_t reclaimedBytes_ = 0;
+};
+
+} // namespace facebook::velox::exec
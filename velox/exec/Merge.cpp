@@ -36,13 +36,12 @@ Merge::Merge(
       rowContainer_(std::make_unique<RowContainer>(
           outputType_->children(),
           operatorCtx_->mappedMemory())),
-      candidates_(Comparator(
+      comparator_(
           outputType_,
           sortingKeys,
           sortingOrders,
-          rowContainer_.get())),
-      extractedCols_(std::dynamic_pointer_cast<RowVector>(
-          BaseVector::create(outputType_, 1, operatorCtx_->pool()))),
+          rowContainer_.get()),
+      candidates_(comparator_),
       future_(false) {}
 
 BlockingReason Merge::isBlocked(ContinueFuture* future) {
@@ -65,6 +64,26 @@ BlockingReason Merge::pushSource(ContinueFuture* future, size_t sourceId) {
   return reason;
 }
 
+BlockingReason Merge::appendRun(
+    ContinueFuture* future,
+    size_t sourceId,
+    size_t maxRows) {
+  for (;;) {
+    char* row = nullptr;
+    auto reason = sources_[sourceId]->next(future, &row);
+    if (reason != BlockingReason::kNotBlocked || !row) {
+      return reason;
+    }
+    SourceRow entry(sourceId, row);
+    if (rows_.size() >= maxRows ||
+        (!candidates_.empty() && comparator_(entry, candidates_.top()))) {
+      candidates_.push(entry);
+      return BlockingReason::kNotBlocked;
+    }
+    rows_.push_back(row);
+  }
+}
+
 // Returns kNotBlocked if all sources ready and the priority queue has
 // their top rows.
 BlockingReason Merge::ensureSourcesReady(ContinueFuture* future) {
@@ -105,24 +124,21 @@ RowVectorPtr Merge::getOutput() {
     return nullptr;
   }
 
-  const auto numRowsPerBatch =
-      rowContainer_->estimatedNumRowsPerBatch(kBatchSizeInBytes);
+  const size_t numRowsPerBatch = outputBatchRows(outputRowSize_);
   rows_.reserve(numRowsPerBatch);
 
-  while (!candidates_.empty()) {
+  // The output references the rows of the sources. These are copied
+  // to the result a column at a time once the batch is full.
+  while (!candidates_.empty() && rows_.size() < numRowsPerBatch) {
     auto entry = candidates_.top();
     candidates_.pop();
+    rows_.push_back(entry.second);
 
-    rows_.push_back(rowContainer_->addRow(entry.second, extractedCols_));
-
-    blockingReason_ = pushSource(&future_, entry.first);
+    blockingReason_ = appendRun(&future_, entry.first, numRowsPerBatch);
     if (blockingReason_ != BlockingReason::kNotBlocked) {
       currentSourcePos_ = entry.first;
       break;
     }
-    if (rows_.size() >= numRowsPerBatch) {
-      break;
-    }
   }
 
   if (rows_.size() >= numRowsPerBatch ||
@@ -130,9 +146,19 @@ RowVectorPtr Merge::getOutput() {
     auto result = std::dynamic_pointer_cast<RowVector>(
         BaseVector::create(outputType_, rows_.size(), operatorCtx_->pool()));
 
-    rowContainer_->extractRows(rows_, result);
-    rowContainer_->clear();
+    // The sources have the same row layout as 'rowContainer_'.
+    for (auto i = 0; i < outputType_->size(); ++i) {
+      RowContainer::extractColumn(
+          rows_.data(),
+          rows_.size(),
+          rowContainer_->columnAt(i),
+          result->childAt(i));
+    }
+    outputRowSize_ = result->retainedSize() / rows_.size();
     rows_.clear();
+    for (auto& source : sources_) {
+      source->releaseConsumedRows();
+    }
     return result;
   }
   return nullptr;
@@ -196,7 +222,10 @@ MergeExchange::MergeExchange(
           mergeExchangeNode->sortingKeys(),
           mergeExchangeNode->sortingOrders(),
           mergeExchangeNode->id(),
-          "MergeExchange") {}
+          "MergeExchange"),
+      sourceBufferBytes_(
+          driverCtx->execCtx->queryCtx()
+              ->mergeExchangeSourceBufferBytes()) {}
 
 void MergeExchange::finish() {
   Merge::finish();
@@ -24,7 +24,10 @@ namespace facebook::velox::exec {
 
 // Merge operator Implementation: This implementation uses priority queue
 // to perform a k-way merge of its inputs. It stops merging if any one of
-// its inputs is blocked.
+// its inputs is blocked. The rows of a source that come before the top
+// rows of the other sources are taken as a run without going through the
+// priority queue. The output references the rows of the sources until
+// a batch is full and is then copied a column at a time.
 class Merge : public SourceOperator {
  public:
   Merge(
@@ -55,7 +58,6 @@ class Merge : public SourceOperator {
   const core::PlanNodeId planNodeId_;
 
  private:
-  static const size_t kBatchSizeInBytes{2 * 1024 * 1024};
   using SourceRow = std::pair<size_t, char*>;
 
   class Comparator {
@@ -87,20 +89,32 @@ class Merge : public SourceOperator {
   };
 
   BlockingReason pushSource(ContinueFuture* future, size_t sourceId);
+
+  // Appends the next rows of 'sourceId' to 'rows_' while these do not
+  // come after the top of 'candidates_' and 'rows_' has less than
+  // 'maxRows' rows. Pushes the first row that is not appended into
+  // 'candidates_'.
+  BlockingReason
+  appendRun(ContinueFuture* future, size_t sourceId, size_t maxRows);
   BlockingReason ensureSourcesReady(ContinueFuture* future);
 
+  // Rows of the sources for the next output batch.
   std::vector<char*> rows_;
+  // Gives the row layout of the sources for comparing and extracting
+  // rows. Holds no rows.
   std::unique_ptr<RowContainer> rowContainer_;
+  Comparator comparator_;
   std::priority_queue<SourceRow, std::vector<SourceRow>, Comparator>
       candidates_;
 
-  RowVectorPtr extractedCols_;
-
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
   ContinueFuture future_;
 
   size_t numSourcesAdded_ = 0;
   size_t currentSourcePos_ = 0;
+  // Average width of the rows of the last output batch. Sizes the
+  // next batch.
+  std::optional<uint64_t> outputRowSize_;
 };
 
 // LocalMerge merges its sources' output into a single stream of
@@ -133,10 +147,16 @@ class MergeExchange : public Merge {
 
   void finish() override;
 
+  // Maximum number of bytes buffered for each remote source.
+  int64_t sourceBufferBytes() const {
+    return sourceBufferBytes_;
+  }
+
  protected:
   BlockingReason addMergeSources(ContinueFuture* future) override;
 
  private:
+  const int64_t sourceBufferBytes_;
   bool noMoreSplits_ = false;
   size_t numSplits_{0}; // Number of splits we took to process so far.
 };
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/MergeJoin.h"
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+BlockingReason MergeJoinSource::enqueue(
+    RowVectorPtr data,
+    ContinueFuture* future) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (closed_ || cancelled_) {
+    return BlockingReason::kNotBlocked;
+  }
+  if (!data) {
+    atEnd_ = true;
+    notifyConsumersLocked();
+    return BlockingReason::kNotBlocked;
+  }
+  VELOX_CHECK_NULL(data_, "MergeJoinSource already has a pending batch");
+  data_ = std::move(data);
+  notifyConsumersLocked();
+  promises_.emplace_back("MergeJoinSource::enqueue");
+  *future = promises_.back().getSemiFuture();
+  return BlockingReason::kWaitForConsumer;
+}
+
+BlockingReason MergeJoinSource::next(
+    ContinueFuture* future,
+    RowVectorPtr* data) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (data_) {
+    *data = std::move(data_);
+    // Wakes up the producer waiting for 'data_' to be taken.
+    notifyConsumersLocked();
+    return BlockingReason::kNotBlocked;
+  }
+  if (atEnd_ || cancelled_) {
+    *data = nullptr;
+    return BlockingReason::kNotBlocked;
+  }
+  promises_.emplace_back("MergeJoinSource::next");
+  *future = promises_.back().getSemiFuture();
+  return BlockingReason::kWaitForMergeJoinRightSide;
+}
+
+void MergeJoinSource::close() {
+  std::lock_guard<std::mutex> l(mutex_);
+  closed_ = true;
+  data_ = nullptr;
+  notifyConsumersLocked();
+}
+
+MergeJoin::MergeJoin(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::MergeJoinNode>& joinNode)
+    : Operator(
+          driverCtx,
+          joinNode->outputType(),
+          operatorId,
+          joinNode->id(),
+          "MergeJoin"),
+      joinType_(joinNode->joinType()),
+      rightSource_(operatorCtx_->task()->getMergeJoinSource(joinNode->id())) {
+  auto leftType = joinNode->sources()[0]->outputType();
+  for (auto& key : joinNode->leftKeys()) {
+    leftKeys_.push_back(leftType->getChildIdx(key->name()));
+  }
+  auto rightType = joinNode->sources()[1]->outputType();
+  for (auto& key : joinNode->rightKeys()) {
+    rightKeys_.push_back(rightType->getChildIdx(key->name()));
+  }
+
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    const auto& name = outputType_->nameOf(i);
+    if (auto channel = leftType->getChildIdxIfExists(name)) {
+      leftProjections_.emplace_back(channel.value(), i);
+    } else {
+      rightProjections_.emplace_back(rightType->getChildIdx(name), i);
+    }
+  }
+}
+
+BlockingReason MergeJoin::isBlocked(ContinueFuture* future) {
+  if (hasFuture_) {
+    *future = std::move(future_);
+    hasFuture_ = false;
+    return BlockingReason::kWaitForMergeJoinRightSide;
+  }
+  return BlockingReason::kNotBlocked;
+}
+
+void MergeJoin::addInput(RowVectorPtr input) {
+  // The output is copied a row range at a time. Load lazy vectors here
+  // so that these are not loaded for each range.
+  for (auto& child : input->children()) {
+    child->loadedVector();
+  }
+  input_ = std::move(input);
+  leftIndex_ = 0;
+}
+
+// static
+int32_t MergeJoin::compare(
+    const std::vector<ChannelIndex>& leftKeys,
+    const RowVector& left,
+    vector_size_t leftIndex,
+    const std::vector<ChannelIndex>& rightKeys,
+    const RowVector& right,
+    vector_size_t rightIndex) {
+  for (auto i = 0; i < leftKeys.size(); ++i) {
+    auto result = left.childAt(leftKeys[i])
+                      ->compare(
+                          right.childAt(rightKeys[i]).get(),
+                          leftIndex,
+                          rightIndex);
+    if (result) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+// static
+bool MergeJoin::hasNullKey(
+    const std::vector<ChannelIndex>& keys,
+    const RowVector& input,
+    vector_size_t index) {
+  for (auto key : keys) {
+    if (input.childAt(key)->isNullAt(index)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MergeJoin::fetchRightInput() {
+  if (rightSource_->next(&future_, &rightInput_) !=
+      BlockingReason::kNotBlocked) {
+    hasFuture_ = true;
+    return false;
+  }
+  if (!rightInput_) {
+    rightAtEnd_ = true;
+    return true;
+  }
+  for (auto& child : rightInput_->children()) {
+    child->loadedVector();
+  }
+  rightIndex_ = 0;
+  return true;
+}
+
+void MergeJoin::extendMatch() {
+  // The first row of the match has the key of the match.
+  auto keyInput = match_->ranges.front().input;
+  auto keyIndex = match_->ranges.front().start;
+  auto start = rightIndex_;
+  while (rightIndex_ < rightInput_->size() &&
+         compare(
+             rightKeys_,
+             *keyInput,
+             keyIndex,
+             rightKeys_,
+             *rightInput_,
+             rightIndex_) == 0) {
+    ++rightIndex_;
+  }
+  auto& last = match_->ranges.back();
+  if (last.input == rightInput_) {
+    last.end = rightIndex_;
+  } else if (rightIndex_ > start) {
+    match_->ranges.push_back({rightInput_, start, rightIndex_});
+  }
+  if (rightIndex_ < rightInput_->size()) {
+    match_->complete = true;
+  } else {
+    // The match may continue in the next batch.
+    rightInput_ = nullptr;
+  }
+}
+
+void MergeJoin::prepareOutput() {
+  if (!output_) {
+    output_ = std::static_pointer_cast<RowVector>(
+        BaseVector::create(outputType_, kOutputBatchSize, pool()));
+    outputSize_ = 0;
+  }
+}
+
+RowVectorPtr MergeJoin::takeOutput() {
+  if (!outputSize_) {
+    return nullptr;
+  }
+  for (auto& child : output_->children()) {
+    child->resize(outputSize_);
+  }
+  output_->resize(outputSize_);
+  outputSize_ = 0;
+  return std::move(output_);
+}
+
+bool MergeJoin::addMatches() {
+  auto& [rangeIndex, rowIndex] = match_->cursor.value();
+  const auto& ranges = match_->ranges;
+  while (rangeIndex < ranges.size()) {
+    if (outputSize_ == kOutputBatchSize) {
+      return false;
+    }
+    const auto& range = ranges[rangeIndex];
+    auto numRows = std::min<vector_size_t>(
+        range.end - rowIndex, kOutputBatchSize - outputSize_);
+    prepareOutput();
+    for (const auto& projection : leftProjections_) {
+      auto& target = output_->childAt(projection.outputChannel);
+      auto source = input_->childAt(projection.inputChannel).get();
+      for (auto i = 0; i < numRows; ++i) {
+        target->copy(source, outputSize_ + i, leftIndex_, 1);
+      }
+    }
+    for (const auto& projection : rightProjections_) {
+      output_->childAt(projection.outputChannel)
+          ->copy(
+              range.input->childAt(projection.inputChannel).get(),
+              outputSize_,
+              rowIndex,
+              numRows);
+    }
+    outputSize_ += numRows;
+    rowIndex += numRows;
+    if (rowIndex == range.end && ++rangeIndex < ranges.size()) {
+      rowIndex = ranges[rangeIndex].start;
+    }
+  }
+  return true;
+}
+
+void MergeJoin::addMiss() {
+  if (joinType_ != core::JoinType::kLeft) {
+    return;
+  }
+  prepareOutput();
+  for (const auto& projection : leftProjections_) {
+    output_->childAt(projection.outputChannel)
+        ->copy(
+            input_->childAt(projection.inputChannel).get(),
+            outputSize_,
+            leftIndex_,
+            1);
+  }
+  for (const auto& projection : rightProjections_) {
+    output_->childAt(projection.outputChannel)->setNull(outputSize_, true);
+  }
+  ++outputSize_;
+}
+
+RowVectorPtr MergeJoin::getOutput() {
+  for (;;) {
+    if (outputSize_ == kOutputBatchSize) {
+      return takeOutput();
+    }
+
+    if (!input_) {
+      if (isFinishing_) {
+        // The left side is at end. The rest of the right side has no
+        // matches.
+        match_.reset();
+        rightInput_ = nullptr;
+        rightSource_->close();
+      }
+      return takeOutput();
+    }
+
+    if (leftIndex_ == input_->size()) {
+      input_ = nullptr;
+      continue;
+    }
+
+    if (match_ && match_->cursor.has_value()) {
+      if (addMatches()) {
+        match_->cursor.reset();
+        ++leftIndex_;
+      }
+      continue;
+    }
+
+    if (hasNullKey(leftKeys_, *input_, leftIndex_)) {
+      addMiss();
+      ++leftIndex_;
+      continue;
+    }
+
+    if (match_) {
+      if (!match_->complete) {
+        if (rightInput_) {
+          extendMatch();
+          continue;
+        }
+        if (!rightAtEnd_) {
+          if (!fetchRightInput()) {
+            return takeOutput();
+          }
+          continue;
+        }
+        match_->complete = true;
+      }
+      const auto& key = match_->ranges.front();
+      if (compare(
+              leftKeys_,
+              *input_,
+              leftIndex_,
+              rightKeys_,
+              *key.input,
+              key.start) == 0) {
+        match_->cursor = std::make_pair(0, key.start);
+        continue;
+      }
+      // The left side has moved past the key of the match.
+      match_.reset();
+    }
+
+    if (!rightInput_) {
+      if (!rightAtEnd_) {
+        if (!fetchRightInput()) {
+          return takeOutput();
+        }
+        continue;
+      }
+      if (joinType_ == core::JoinType::kInner) {
+        // The right side is at end and no more left rows can match.
+        input_ = nullptr;
+        isFinishing_ = true;
+        continue;
+      }
+      addMiss();
+      ++leftIndex_;
+      continue;
+    }
+
+    if (rightIndex_ == rightInput_->size()) {
+      rightInput_ = nullptr;
+      continue;
+    }
+
+    if (hasNullKey(rightKeys_, *rightInput_, rightIndex_)) {
+      ++rightIndex_;
+      continue;
+    }
+
+    auto result = compare(
+        leftKeys_, *input_, leftIndex_, rightKeys_, *rightInput_, rightIndex_);
+    if (result < 0) {
+      addMiss();
+      ++leftIndex_;
+    } else if (result > 0) {
+      ++rightIndex_;
+    } else {
+      match_ = Match{{{rightInput_, rightIndex_, rightIndex_}}};
+      extendMatch();
+    }
+  }
+}
+
+void MergeJoin::close() {
+  rightSource_->close();
+  input_ = nullptr;
+  rightInput_ = nullptr;
+  match_.reset();
+  output_ = nullptr;
+  Operator::close();
+}
+
+} // namespace facebook::velox::exec
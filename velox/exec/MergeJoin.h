@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <optional>
+#include "velox/exec/JoinBridge.h"
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+// Passes the batches of the right side of a merge join from the
+// CallbackSink at the end of the right side pipeline to the MergeJoin
+// operator. Holds at most one batch at a time: the producer is blocked
+// until the join has taken the previous batch.
+class MergeJoinSource : public JoinBridge {
+ public:
+  // Called by the right side pipeline. A nullptr 'data' signals the end
+  // of the right side. Returns kWaitForConsumer and sets 'future' if the
+  // producer must wait for the join to take 'data'.
+  BlockingReason enqueue(RowVectorPtr data, ContinueFuture* future);
+
+  // Called by the join. Sets 'data' to the next batch or to nullptr if
+  // the right side is at end. If no batch is available yet, returns
+  // kWaitForMergeJoinRightSide and sets 'future'.
+  BlockingReason next(ContinueFuture* future, RowVectorPtr* data);
+
+  // Called by the join when it needs no more right side data. Drops the
+  // pending batch and unblocks the producer.
+  void close();
+
+ private:
+  RowVectorPtr data_;
+  bool atEnd_{false};
+  bool closed_{false};
+};
+
+// Joins two inputs sorted in ascending order on the join keys. The left
+// input comes from the preceding operator and the right input arrives
+// through the MergeJoinSource for the plan node. Memory stays bounded by
+// the batches in flight and the right side rows of the current key.
+// Rows with a null in any join key never match. These may be sorted
+// either first or last.
+class MergeJoin : public Operator {
+ public:
+  MergeJoin(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::MergeJoinNode>& joinNode);
+
+  BlockingReason isBlocked(ContinueFuture* future) override;
+
+  bool needsInput() const override {
+    return !isFinishing_ && input_ == nullptr;
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+  void close() override;
+
+ private:
+  // Maximum number of rows in an output batch.
+  static constexpr vector_size_t kOutputBatchSize = 1'024;
+
+  // A run of right side rows with the same key.
+  struct RowRange {
+    RowVectorPtr input;
+    vector_size_t start;
+    vector_size_t end;
+  };
+
+  // The right side rows that have the key of the last matched left
+  // row. 'complete' is false while the rows may continue in the next
+  // right side batch. 'cursor' is the position of the next pair to
+  // produce for the left row at 'leftIndex_'. This is set while the
+  // pairs for that row are being produced.
+  struct Match {
+    std::vector<RowRange> ranges;
+    bool complete{false};
+    std::optional<std::pair<size_t, vector_size_t>> cursor;
+  };
+
+  // Compares the join keys of 'left' at 'leftIndex' with the join keys
+  // of 'right' at 'rightIndex'.
+  static int32_t compare(
+      const std::vector<ChannelIndex>& leftKeys,
+      const RowVector& left,
+      vector_size_t leftIndex,
+      const std::vector<ChannelIndex>& rightKeys,
+      const RowVector& right,
+      vector_size_t rightIndex);
+
+  // Returns true if any of 'keys' of 'input' is null at 'index'.
+  static bool hasNullKey(
+      const std::vector<ChannelIndex>& keys,
+      const RowVector& input,
+      vector_size_t index);
+
+  // Takes the next right side batch from 'rightSource_'. Returns false
+  // and sets 'future_' if the batch is not yet available.
+  bool fetchRightInput();
+
+  // Adds the rows of 'rightInput_' from 'rightIndex_' on that have the
+  // key of 'match_'. Sets 'rightInput_' to nullptr if it is used up.
+  void extendMatch();
+
+  // Produces the pairs of the left row at 'leftIndex_' and the rows of
+  // 'match_' until the output is full. Returns true when all pairs
+  // have been produced.
+  bool addMatches();
+
+  // Adds the left row at 'leftIndex_' to the output with nulls for the
+  // right side columns if this is a left join.
+  void addMiss();
+
+  void prepareOutput();
+
+  // Returns the output produced so far, nullptr if none.
+  RowVectorPtr takeOutput();
+
+  const core::JoinType joinType_;
+  const std::shared_ptr<MergeJoinSource> rightSource_;
+
+  std::vector<ChannelIndex> leftKeys_;
+  std::vector<ChannelIndex> rightKeys_;
+
+  // Maps left and right side input channels to output channels.
+  std::vector<IdentityProjection> leftProjections_;
+  std::vector<IdentityProjection> rightProjections_;
+
+  // Position of the next unprocessed row in 'input_'.
+  vector_size_t leftIndex_{0};
+
+  // The current right side batch and the position of its next
+  // unprocessed row. nullptr if the next batch must be fetched.
+  RowVectorPtr rightInput_;
+  vector_size_t rightIndex_{0};
+  bool rightAtEnd_{false};
+
+  std::optional<Match> match_;
+
+  // Future for waiting on the next right side batch. Set by
+  // fetchRightInput() and handed out in isBlocked().
+  ContinueFuture future_{false};
+  bool hasFuture_{false};
+
+  RowVectorPtr output_;
+  vector_size_t outputSize_{0};
+};
+
+} // namespace facebook::velox::exec
@@ -33,10 +33,8 @@ class MergeSourceData {
     }
   }
 
-  void clear() {
-    rows_.clear();
-    data_->clear();
-    currentPos_ = 0;
+  bool empty() const {
+    return rows_.empty();
   }
 
   void fetchRows(const RowVectorPtr& input) {
@@ -88,6 +86,10 @@ class LocalMergeSource : public MergeSource {
     return lockedQueue->enqueue(input, future);
   }
 
+  void releaseConsumedRows() override {
+    queue_.wlock()->releaseConsumedRows();
+  }
+
  private:
   class LocalMergeSourceQueue {
    public:
@@ -118,7 +120,9 @@ class LocalMergeSource : public MergeSource {
         return BlockingReason::kNotBlocked;
       }
 
-      // advance to next batch.
+      // Advance to next batch. The rows of the consumed batch stay
+      // valid until releaseConsumedRows().
+      consumed_.push_back(std::move(data_.front()));
       data_.pop_front();
 
       // Notify any producers.
@@ -145,6 +149,10 @@ class LocalMergeSource : public MergeSource {
       return BlockingReason::kNotBlocked;
     }
 
+    void releaseConsumedRows() {
+      consumed_.clear();
+    }
+
    private:
     const std::shared_ptr<const RowType> rowType_;
     // Since LocalMergeSource's lifetime is same as Tasks, keep mappedMemory's
@@ -154,6 +162,9 @@ class LocalMergeSource : public MergeSource {
 
     bool atEnd_ = false;
     boost::circular_buffer<MergeSourceData> data_;
+    // Batches taken out of 'data_' whose rows may still be referenced
+    // by the merge.
+    std::vector<MergeSourceData> consumed_;
     std::vector<VeloxPromise<bool>> consumerPromises_;
     std::vector<VeloxPromise<bool>> producerPromises_;
 
@@ -179,7 +190,9 @@ class MergeExchangeSource : public MergeSource {
  public:
   MergeExchangeSource(MergeExchange* mergeExchange, const std::string& taskId)
       : mergeExchange_(mergeExchange),
-        client_(std::make_shared<ExchangeClient>(0)),
+        client_(std::make_shared<ExchangeClient>(
+            0,
+            mergeExchange->sourceBufferBytes())),
         data_(
             mergeExchange->outputType(),
             mergeExchange->mappedMemory(),
@@ -214,7 +227,15 @@ class MergeExchangeSource : public MergeSource {
       currentPage_->prepareStreamForDeserialize(inputStream_.get());
     }
 
-    data_.clear();
+    if (!data_.empty()) {
+      // The rows of the consumed batch stay valid until
+      // releaseConsumedRows().
+      consumed_.push_back(std::move(data_));
+      data_ = MergeSourceData(
+          mergeExchange_->outputType(),
+          mergeExchange_->mappedMemory(),
+          nullptr);
+    }
 
     if (!inputStream_->atEnd()) {
       RowVectorPtr result;
@@ -244,12 +265,18 @@ class MergeExchangeSource : public MergeSource {
     return BlockingReason::kNotBlocked;
   }
 
+  void releaseConsumedRows() override {
+    consumed_.clear();
+  }
+
  private:
   MergeExchange* mergeExchange_;
   std::shared_ptr<ExchangeClient> client_;
   std::unique_ptr<ByteStream> inputStream_;
   std::unique_ptr<SerializedPage> currentPage_;
   MergeSourceData data_;
+  // Batches whose rows may still be referenced by the merge.
+  std::vector<MergeSourceData> consumed_;
   bool atEnd_ = false;
 
   BlockingReason enqueue(RowVectorPtr input, ContinueFuture* future) override {
@@ -24,7 +24,14 @@ class MergeExchange;
 class MergeSource {
  public:
   virtual ~MergeSource() {}
+  // Sets 'row' to the next row or to nullptr at end. The returned rows
+  // stay valid until releaseConsumedRows(), so that the merge can copy
+  // them to its output a batch at a time.
   virtual BlockingReason next(ContinueFuture* future, char** row) = 0;
+
+  // Frees the batches whose rows have all been returned by next().
+  virtual void releaseConsumedRows() = 0;
+
   virtual BlockingReason enqueue(
       RowVectorPtr input,
       ContinueFuture* future) = 0;
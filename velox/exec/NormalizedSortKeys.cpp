@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/NormalizedSortKeys.h"
+
+#include <folly/lang/Bits.h>
+
+namespace facebook::velox::exec {
+
+namespace {
+// Returns the number of bytes of a value of 'kind' in an encoded key,
+// not counting the null indicator. 0 if 'kind' has no fixed width
+// encoding.
+int32_t encodedSize(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+      return 1;
+    case TypeKind::SMALLINT:
+      return 2;
+    case TypeKind::INTEGER:
+    case TypeKind::REAL:
+      return 4;
+    case TypeKind::BIGINT:
+    case TypeKind::DOUBLE:
+      return 8;
+    case TypeKind::TIMESTAMP:
+      // Seconds and nanos.
+      return 12;
+    default:
+      return 0;
+  }
+}
+
+// Returns the bits of 'value' so that the unsigned order of the bits
+// is the order of the values.
+template <typename T>
+uint64_t orderedBits(T value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    return value;
+  } else if constexpr (std::is_integral_v<T>) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<U>(value) ^ (U(1) << (sizeof(T) * 8 - 1));
+  } else {
+    using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    constexpr U kSign = U(1) << (sizeof(T) * 8 - 1);
+    if (value == 0) {
+      // -0.0 and 0.0 compare equal.
+      value = 0;
+    }
+    U bits;
+    memcpy(&bits, &value, sizeof(T));
+    return (bits & kSign) ? static_cast<U>(~bits) : bits | kSign;
+  }
+}
+
+// Writes the 'numBytes' low bytes of 'value' at 'out', most
+// significant first, and advances 'out'.
+inline void appendBigEndian(uint64_t value, int32_t numBytes, uint8_t*& out) {
+  for (auto i = numBytes - 1; i >= 0; --i) {
+    *out++ = value >> (i * 8);
+  }
+}
+
+template <typename T>
+inline void appendValue(const char* row, int32_t offset, uint8_t*& out) {
+  auto value = *reinterpret_cast<const T*>(row + offset);
+  appendBigEndian(orderedBits(value), sizeof(T), out);
+}
+
+template <int32_t kNumWords>
+void sortEncoded(
+    const RowContainer& data,
+    const std::vector<CompareFlags>& compareFlags,
+    std::vector<char*>& rows) {
+  struct Entry {
+    std::array<uint64_t, kNumWords> key;
+    char* row;
+  };
+  std::vector<Entry> entries(rows.size());
+  for (auto i = 0; i < rows.size(); ++i) {
+    NormalizedSortKeys::encode(
+        data, rows[i], compareFlags, kNumWords, entries[i].key.data());
+    entries[i].row = rows[i];
+  }
+  std::sort(
+      entries.begin(),
+      entries.end(),
+      [](const Entry& left, const Entry& right) {
+        return left.key < right.key;
+      });
+  for (auto i = 0; i < rows.size(); ++i) {
+    rows[i] = entries[i].row;
+  }
+}
+} // namespace
+
+// static
+int32_t NormalizedSortKeys::numWords(const std::vector<TypePtr>& keyTypes) {
+  int32_t numBytes = 0;
+  for (auto& type : keyTypes) {
+    auto size = encodedSize(type->kind());
+    if (!size) {
+      return 0;
+    }
+    // The value and a null indicator.
+    numBytes += size + 1;
+  }
+  auto words = bits::roundUp(numBytes, sizeof(uint64_t)) / sizeof(uint64_t);
+  return words <= kMaxWords ? words : 0;
+}
+
+// static
+void NormalizedSortKeys::encode(
+    const RowContainer& data,
+    const char* row,
+    const std::vector<CompareFlags>& compareFlags,
+    int32_t numWords,
+    uint64_t* words) {
+  uint8_t bytes[kMaxWords * sizeof(uint64_t)] = {};
+  auto out = bytes;
+  for (auto i = 0; i < compareFlags.size(); ++i) {
+    auto column = data.columnAt(i);
+    auto kind = data.keyTypes()[i]->kind();
+    auto& flags = compareFlags[i];
+    bool isNull =
+        column.nullMask() && (row[column.nullByte()] & column.nullMask());
+    *out++ = isNull == flags.nullsFirst ? 0 : 1;
+    if (isNull) {
+      out += encodedSize(kind);
+      continue;
+    }
+    auto start = out;
+    auto offset = column.offset();
+    switch (kind) {
+      case TypeKind::BOOLEAN:
+        appendValue<bool>(row, offset, out);
+        break;
+      case TypeKind::TINYINT:
+        appendValue<int8_t>(row, offset, out);
+        break;
+      case TypeKind::SMALLINT:
+        appendValue<int16_t>(row, offset, out);
+        break;
+      case TypeKind::INTEGER:
+        appendValue<int32_t>(row, offset, out);
+        break;
+      case TypeKind::BIGINT:
+        appendValue<int64_t>(row, offset, out);
+        break;
+      case TypeKind::REAL:
+        appendValue<float>(row, offset, out);
+        break;
+      case TypeKind::DOUBLE:
+        appendValue<double>(row, offset, out);
+        break;
+      case TypeKind::TIMESTAMP: {
+        auto value = *reinterpret_cast<const Timestamp*>(row + offset);
+        appendBigEndian(orderedBits(value.getSeconds()), 8, out);
+        appendBigEndian(value.getNanos(), 4, out);
+        break;
+      }
+      default:
+        VELOX_UNREACHABLE();
+    }
+    if (!flags.ascending) {
+      for (auto byte = start; byte < out; ++byte) {
+        *byte = ~*byte;
+      }
+    }
+  }
+  for (auto i = 0; i < numWords; ++i) {
+    words[i] = folly::Endian::big(
+        folly::loadUnaligned<uint64_t>(bytes + i * sizeof(uint64_t)));
+  }
+}
+
+// static
+bool NormalizedSortKeys::sort(
+    const RowContainer& data,
+    const std::vector<CompareFlags>& compareFlags,
+    std::vector<char*>& rows) {
+  std::vector<TypePtr> keyTypes(
+      data.keyTypes().begin(),
+      data.keyTypes().begin() + compareFlags.size());
+  switch (numWords(keyTypes)) {
+    case 1:
+      sortEncoded<1>(data, compareFlags, rows);
+      return true;
+    case 2:
+      sortEncoded<2>(data, compareFlags, rows);
+      return true;
+    case 3:
+      sortEncoded<3>(data, compareFlags, rows);
+      return true;
+    case 4:
+      sortEncoded<4>(data, compareFlags, rows);
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// Encodes the keys of RowContainer rows into fixed width words that
+// compare as unsigned integers in the order given by the CompareFlags
+// of each key. Each key is a null indicator byte followed by the value
+// in big endian, with the sign bit flipped for signed values and all
+// bits flipped for descending keys. This replaces a type dispatch per
+// key per comparison with a comparison of a few words.
+class NormalizedSortKeys {
+ public:
+  // Maximum number of words for the keys of a row.
+  static constexpr int32_t kMaxWords = 4;
+
+  // Returns the number of words for encoding 'keyTypes' or 0 if a
+  // type has no fixed width encoding or the keys do not fit in
+  // kMaxWords.
+  static int32_t numWords(const std::vector<TypePtr>& keyTypes);
+
+  // Writes the encoded keys of 'row' into 'numWords' words at
+  // 'words'. The keys are the first 'compareFlags.size()' columns of
+  // 'data'.
+  static void encode(
+      const RowContainer& data,
+      const char* row,
+      const std::vector<CompareFlags>& compareFlags,
+      int32_t numWords,
+      uint64_t* words);
+
+  // Sorts 'rows' of 'data' on the first 'compareFlags.size()' columns.
+  // Returns false without changing 'rows' if the keys cannot be
+  // encoded.
+  static bool sort(
+      const RowContainer& data,
+      const std::vector<CompareFlags>& compareFlags,
+      std::vector<char*>& rows);
+};
+
+} // namespace facebook::velox::exec
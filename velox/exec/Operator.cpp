@@ -15,6 +15,7 @@
  */
 #include "velox/exec/Operator.h"
 #include "velox/exec/Driver.h"
+#include "velox/exec/MemoryArbitrator.h"
 #include "velox/exec/OperatorUtils.h"
 #include "velox/exec/Task.h"
 
@@ -140,15 +141,49 @@ RowVectorPtr Operator::fillOutput(vector_size_t size, BufferPtr mapping) {
 }
 
 void Operator::inputProcessed() {
-  input_ = nullptr;
   if (!output_.unique()) {
     output_ = nullptr;
-    return;
+  } else {
+    auto& columns = output_->children();
+    for (auto& projection : identityProjections_) {
+      columns[projection.outputChannel] = nullptr;
+    }
   }
-  auto& columns = output_->children();
-  for (auto& projection : identityProjections_) {
-    columns[projection.outputChannel] = nullptr;
+  // The columns of 'input_' that are no longer referenced from 'output_' or
+  // the producer can be recycled for the next batch.
+  operatorCtx_->vectorPool().release(input_);
+}
+
+bool Operator::arbitrateMemory(int64_t bytes) {
+  auto& tracker = pool()->getMemoryUsageTracker();
+  if (!tracker || !operatorCtx_->queryCtx()->memoryArbitrationEnabled()) {
+    return false;
   }
+  MemoryArbitrator::getInstance()->reclaim(bytes, operatorCtx_->driver());
+  return tracker->getAvailableBytes() >= bytes;
+}
+
+bool Operator::reserveMemory(int64_t bytes) {
+  auto& tracker = pool()->getMemoryUsageTracker();
+  if (!tracker) {
+    return true;
+  }
+  if (tracker->maybeReserve(bytes)) {
+    return true;
+  }
+  return arbitrateMemory(bytes) && tracker->maybeReserve(bytes);
+}
+
+vector_size_t Operator::outputBatchRows(
+    std::optional<uint64_t> averageRowSize) const {
+  auto* queryCtx = operatorCtx_->queryCtx();
+  const uint64_t maxRows = queryCtx->maxOutputBatchRows();
+  if (!averageRowSize.has_value()) {
+    return std::min<uint64_t>(kInitialOutputBatchRows, maxRows);
+  }
+  const auto numRows = queryCtx->preferredOutputBatchBytes() /
+      std::max<uint64_t>(1, averageRowSize.value());
+  return std::max<uint64_t>(1, std::min(numRows, maxRows));
 }
 
 void Operator::clearIdentityProjectedOutput() {
@@ -246,6 +281,8 @@ void OperatorStats::add(const OperatorStats& other) {
 
   finishTiming.add(other.finishTiming);
 
+  cpuSamples += other.cpuSamples;
+
   memoryStats.add(other.memoryStats);
 
   for (const auto& stat : other.runtimeStats) {
@@ -272,6 +309,8 @@ void OperatorStats::clear() {
 
   finishTiming.clear();
 
+  cpuSamples = 0;
+
   memoryStats.clear();
 
   runtimeStats.clear();
@@ -41,6 +41,10 @@ struct MemoryStats {
   uint64_t peakUserMemoryReservation = {};
   uint64_t peakSystemMemoryReservation = {};
   uint64_t peakTotalMemoryReservation = {};
+  // Peak bytes in free blocks of the arenas of variable-width operator
+  // state, e.g. aggregate accumulators. This is memory held because of
+  // fragmentation, not live data.
+  uint64_t peakFragmentedBytes = {};
 
   void update(const std::shared_ptr<memory::MemoryUsageTracker>& tracker) {
     if (!tracker) {
@@ -63,6 +67,8 @@ struct MemoryStats {
         peakSystemMemoryReservation, other.peakSystemMemoryReservation);
     peakTotalMemoryReservation =
         std::max(peakTotalMemoryReservation, other.peakTotalMemoryReservation);
+    peakFragmentedBytes =
+        std::max(peakFragmentedBytes, other.peakFragmentedBytes);
   }
 
   void clear() {
@@ -72,6 +78,7 @@ struct MemoryStats {
     peakUserMemoryReservation = 0;
     peakSystemMemoryReservation = 0;
     peakTotalMemoryReservation = 0;
+    peakFragmentedBytes = 0;
   }
 };
 
@@ -129,6 +136,10 @@ struct OperatorStats {
 
   OperationTiming finishTiming;
 
+  // Number of process::CpuSampler samples taken while the Driver was
+  // running this operator. 0 unless the sampler is running.
+  uint64_t cpuSamples = 0;
+
   MemoryStats memoryStats;
 
   std::unordered_map<std::string, RuntimeMetric> runtimeStats;
@@ -183,6 +194,10 @@ class OperatorCtx {
     return driverCtx_;
   }
 
+  VectorPool& vectorPool() const {
+    return driverCtx_->vectorPool;
+  }
+
  private:
   DriverCtx* driverCtx_;
   velox::memory::MemoryPool* pool_;
@@ -284,6 +299,14 @@ class Operator {
         toString());
   }
 
+  // Frees up to 'bytes' bytes of memory, e.g. by spilling, and returns
+  // the number of bytes freed. Called by the MemoryArbitrator while the
+  // Driver of 'this' is off thread or suspended. The default frees
+  // nothing.
+  virtual uint64_t reclaim(uint64_t /*bytes*/) {
+    return 0;
+  }
+
   // Returns a list of identify projections, e.g. columns that are projected
   // as-is possibly after applying a filter.
   const std::vector<IdentityProjection>& identityProjections() const {
@@ -307,10 +330,24 @@ class Operator {
     return false;
   }
 
+  // Returns true if 'this' only drops rows of its input and its output
+  // has the type of its input, so that the Driver may swap it with an
+  // adjacent operator for which this is also true. Returns false while
+  // 'this' holds input or is finishing.
+  virtual bool canReorder() const {
+    return false;
+  }
+
   OperatorStats& stats() {
     return stats_;
   }
 
+  // Counter of the CPU samples taken while running 'this'. Added to
+  // stats() when the Driver reports its stats to the Task.
+  std::atomic<uint64_t>* cpuSampleCounter() {
+    return &cpuSamples_;
+  }
+
   void recordBlockingTime(uint64_t start);
 
   virtual std::string toString();
@@ -338,6 +375,9 @@ class Operator {
       const std::shared_ptr<const core::PlanNode>& planNode);
 
  protected:
+  // Rows in an output batch before the width of the rows is known.
+  static constexpr vector_size_t kInitialOutputBatchRows = 1'024;
+
   static std::vector<PlanNodeTranslator>& translators();
 
   // Clears the columns of 'output_' that are projected from
@@ -361,6 +401,28 @@ class Operator {
   // 'identityProjections_' and 'resultProjections_'.
   RowVectorPtr fillOutput(vector_size_t size, BufferPtr mapping);
 
+  // Asks the MemoryArbitrator to free memory in other Operators if
+  // memory arbitration is enabled. Returns true if at least 'bytes'
+  // bytes can be allocated through the memory pool of 'this'
+  // afterwards. Called by Operators that are running low on memory
+  // before they spill their own state.
+  bool arbitrateMemory(int64_t bytes);
+
+  // Reserves 'bytes' in the memory pool of 'this' ahead of an imminent
+  // growth, asking the MemoryArbitrator for memory if the reservation
+  // does not fit. Returns false if the reservation is denied, in which
+  // case the caller is expected to spill or flush before growing. The
+  // unused reservation is released when the Driver closes 'this'.
+  bool reserveMemory(int64_t bytes);
+
+  // Returns the number of rows for an output batch of rows of about
+  // 'averageRowSize' bytes. This is the preferred output batch bytes
+  // of the query over the row size, between 1 and the max output batch
+  // rows. If the row size is not known yet, returns
+  // kInitialOutputBatchRows capped by the max.
+  vector_size_t outputBatchRows(
+      std::optional<uint64_t> averageRowSize = std::nullopt) const;
+
   // Drops references to identity projected columns from 'output_' and
   // clears 'input_'. The producer will see its vectors as singly
   // referenced.
@@ -368,6 +430,8 @@ class Operator {
 
   std::unique_ptr<OperatorCtx> operatorCtx_;
   OperatorStats stats_;
+  // Written by the SIGPROF handler of process::CpuSampler.
+  std::atomic<uint64_t> cpuSamples_{0};
   const std::shared_ptr<const RowType> outputType_;
 
   // Holds the last data from addInput until it is processed. Reset after the
@@ -14,10 +14,68 @@
  * limitations under the License.
  */
 #include "velox/exec/OrderBy.h"
+#include "velox/exec/NormalizedSortKeys.h"
+#include "velox/exec/Task.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox::exec {
 
+namespace {
+// Copies 'numRows' rows of 'data' starting at 'rows' into a new vector
+// of 'type'. 'type' has the columns of 'data' in the same order.
+RowVectorPtr extractRows(
+    RowContainer& data,
+    char* const* rows,
+    int32_t numRows,
+    const std::shared_ptr<const RowType>& type,
+    memory::MemoryPool& pool) {
+  auto result = std::dynamic_pointer_cast<RowVector>(
+      BaseVector::create(type, numRows, &pool));
+  for (auto i = 0; i < type->size(); ++i) {
+    data.extractColumn(rows, numRows, i, result->childAt(i));
+  }
+  return result;
+}
+
+// A SpillStream over the sorted rows that are still in memory at the
+// end of input. These are merged with the spilled runs without being
+// written to disk.
+class SortedRowsStream : public SpillStream {
+ public:
+  SortedRowsStream(
+      std::shared_ptr<const RowType> type,
+      const std::vector<CompareFlags>& compareFlags,
+      memory::MemoryPool& pool,
+      RowContainer& data,
+      std::vector<char*>&& rows,
+      int32_t batchSize)
+      : SpillStream(std::move(type), compareFlags, pool),
+        data_(data),
+        rows_(std::move(rows)),
+        batchSize_(batchSize) {}
+
+ protected:
+  void nextBatch() override {
+    auto numRows = std::min<int32_t>(batchSize_, rows_.size() - nextRow_);
+    rowVector_ =
+        extractRows(data_, rows_.data() + nextRow_, numRows, type_, pool_);
+    size_ = numRows;
+    nextRow_ += numRows;
+  }
+
+  bool hasMoreBatches() const override {
+    return nextRow_ < rows_.size();
+  }
+
+ private:
+  RowContainer& data_;
+  const std::vector<char*> rows_;
+  const int32_t batchSize_;
+  // Position in 'rows_' of the first row of the next batch.
+  size_t nextRow_ = 0;
+};
+} // namespace
+
 OrderBy::OrderBy(
     int32_t operatorId,
     DriverCtx* driverCtx,
@@ -27,64 +85,134 @@ OrderBy::OrderBy(
           orderByNode->outputType(),
           operatorId,
           orderByNode->id(),
-          "OrderBy"),
-      data_(std::make_unique<RowContainer>(
-          outputType_->as<TypeKind::ROW>().children(),
-          operatorCtx_->mappedMemory())) {
+          "OrderBy") {
   auto type = orderByNode->outputType();
   auto numKeys = orderByNode->sortingKeys().size();
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  auto addColumn = [&](ChannelIndex channel) {
+    columns_.push_back(channel);
+    names.push_back(type->nameOf(channel));
+    types.push_back(type->childAt(channel));
+  };
   for (int i = 0; i < numKeys; ++i) {
     auto channel = exprToChannel(orderByNode->sortingKeys()[i].get(), type);
     VELOX_CHECK(
         channel != kConstantChannel,
         "OrderBy doesn't allow constant grouping keys");
-    keyInfo_.emplace_back(channel, orderByNode->sortingOrders()[i]);
+    auto& order = orderByNode->sortingOrders()[i];
+    compareFlags_.push_back(
+        {order.isNullsFirst(), order.isAscending(), false});
+    addColumn(channel);
+  }
+  for (ChannelIndex channel = 0; channel < type->size(); ++channel) {
+    if (std::find(columns_.begin(), columns_.end(), channel) ==
+        columns_.end()) {
+      addColumn(channel);
+    }
+  }
+  std::vector<TypePtr> keyTypes(types.begin(), types.begin() + numKeys);
+  std::vector<TypePtr> dependentTypes(types.begin() + numKeys, types.end());
+  rowType_ = ROW(std::move(names), std::move(types));
+  // The sorting keys are in the rows. The other columns are
+  // columnar so that the rows stay narrow for sorting.
+  static const std::vector<std::unique_ptr<Aggregate>> kNoAggregates;
+  data_ = std::make_unique<RowContainer>(
+      keyTypes,
+      true, // nullableKeys
+      kNoAggregates,
+      dependentTypes,
+      false, // hasNext
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      false, // hasNormalizedKey
+      operatorCtx_->mappedMemory(),
+      ContainerRowSerde::instance(),
+      true); // columnarDependents
+
+  auto queryCtx = operatorCtx_->queryCtx();
+  if (queryCtx->spillEnabled()) {
+    spillMemoryThreshold_ = queryCtx->orderBySpillMemoryThreshold();
+    spill_ = std::make_unique<SpillState>(
+        fmt::format(
+            "{}/{}_{}_{}",
+            queryCtx->spillPath(),
+            operatorCtx_->taskId(),
+            planNodeId(),
+            operatorCtx_->driverCtx()->driverId),
+        1,
+        rowType_,
+        compareFlags_,
+        *operatorCtx_->pool(),
+        queryCtx->spillMaxMergeFanIn());
   }
 }
 
 void OrderBy::addInput(RowVectorPtr input) {
+  ensureInputFits(input);
   SelectivityVector allRows(input->size());
   std::vector<char*> rows(input->size());
   for (int row = 0; row < input->size(); ++row) {
     rows[row] = data_->newRow();
   }
-  for (size_t col = 0; col < input->childrenSize(); ++col) {
-    DecodedVector decoded(*input->childAt(col), allRows);
+  for (size_t col = 0; col < columns_.size(); ++col) {
+    decodedInput_.decode(*input->childAt(columns_[col]), allRows);
     for (int i = 0; i < input->size(); ++i) {
-      data_->store(decoded, i, rows[i], col);
+      data_->store(decodedInput_, i, rows[i], col);
     }
   }
 
   numRows_ += allRows.size();
 }
 
-void OrderBy::finish() {
-  Operator::finish();
-
-  // No data.
-  if (numRows_ == 0) {
-    finished_ = true;
+void OrderBy::ensureInputFits(const RowVectorPtr& input) {
+  if (!spill_ || numRows_ == 0) {
+    return;
+  }
+  if (spillMemoryThreshold_ &&
+      data_->allocatedBytes() >= spillMemoryThreshold_) {
+    spill();
     return;
   }
+  // Leave room for the copy of 'input' in 'data_' and for the vectors
+  // that are produced when writing a sorted run.
+  int64_t neededBytes = 2 *
+      (input->retainedSize() +
+       operatorCtx_->queryCtx()->preferredOutputBatchBytes());
+  if (!reserveMemory(neededBytes)) {
+    spill();
+  }
+}
+
+uint64_t OrderBy::reclaim(uint64_t /*bytes*/) {
+  // The rows can be spilled only while input is being added. After
+  // finish() these are being returned or merged.
+  if (!spill_ || isFinishing_ || numRows_ == 0) {
+    return 0;
+  }
+  auto allocatedBytes = data_->allocatedBytes();
+  spill();
+  return allocatedBytes - std::min(allocatedBytes, data_->allocatedBytes());
+}
 
+void OrderBy::sortRows() {
   // Sort the pointers to the rows in RowContainer (data_) instead of sorting
   // the rows.
   returningRows_.resize(numRows_);
   RowContainerIterator iter;
   data_->listRows(&iter, numRows_, returningRows_.data());
 
+  // Fixed width keys are compared as a few words of encoded keys.
+  if (NormalizedSortKeys::sort(*data_, compareFlags_, returningRows_)) {
+    return;
+  }
   std::sort(
       returningRows_.begin(),
       returningRows_.end(),
       [this](const char* leftRow, const char* rightRow) {
-        for (auto& key : keyInfo_) {
-          if (auto result = data_->compare(
-                  leftRow,
-                  rightRow,
-                  key.first,
-                  {key.second.isNullsFirst(),
-                   key.second.isAscending(),
-                   false})) {
+        for (auto i = 0; i < compareFlags_.size(); ++i) {
+          if (auto result =
+                  data_->compare(leftRow, rightRow, i, compareFlags_[i])) {
             return result < 0;
           }
         }
@@ -92,26 +220,122 @@ void OrderBy::finish() {
       });
 }
 
+void OrderBy::spill() {
+  sortRows();
+  size_t batchSize = outputBatchRows(data_->estimateRowSize());
+  for (size_t i = 0; i < returningRows_.size(); i += batchSize) {
+    auto numRows = std::min(batchSize, returningRows_.size() - i);
+    spill_->appendToPartition(
+        0,
+        extractRows(
+            *data_,
+            returningRows_.data() + i,
+            numRows,
+            rowType_,
+            *operatorCtx_->pool()));
+  }
+  spill_->finishWrite(0);
+  returningRows_.clear();
+  data_->clear();
+  numRows_ = 0;
+}
+
+void OrderBy::finish() {
+  Operator::finish();
+
+  if (spill_ && spill_->hasFiles(0)) {
+    std::vector<std::unique_ptr<SpillStream>> inMemory;
+    if (numRows_) {
+      sortRows();
+      inMemory.push_back(std::make_unique<SortedRowsStream>(
+          rowType_,
+          spill_->compareFlags(),
+          *operatorCtx_->pool(),
+          *data_,
+          std::move(returningRows_),
+          outputBatchRows(data_->estimateRowSize())));
+      returningRows_.clear();
+    }
+    merge_ = spill_->startMerge(0, std::move(inMemory));
+    stats_.addRuntimeStat("spillRuns", spill_->numRuns());
+    stats_.addRuntimeStat("spillMergedRuns", spill_->numMergedRuns());
+    stats_.addRuntimeStat("spilledBytes", spill_->spilledBytes());
+    stats_.addRuntimeStat("spilledRows", spill_->spilledRows());
+    return;
+  }
+
+  // No data.
+  if (numRows_ == 0) {
+    finished_ = true;
+    return;
+  }
+
+  sortRows();
+}
+
+RowVectorPtr OrderBy::getOutputFromSpill() {
+  size_t batchSize = outputBatchRows(data_->estimateRowSize());
+  auto result = std::dynamic_pointer_cast<RowVector>(
+      operatorCtx_->vectorPool().get(
+          outputType_, batchSize, operatorCtx_->pool()));
+
+  vector_size_t numRows = 0;
+  while (numRows < batchSize) {
+    auto stream = merge_->next([](SpillStream* left, SpillStream* right) {
+      return left->compare(*right);
+    });
+    if (!stream.has_value()) {
+      finished_ = true;
+      break;
+    }
+    auto& source = stream.value()->current();
+    auto index = stream.value()->currentIndex();
+    for (auto i = 0; i < columns_.size(); ++i) {
+      result->childAt(columns_[i])
+          ->copy(source.childAt(i).get(), numRows, index, 1);
+    }
+    ++numRows;
+  }
+
+  if (finished_) {
+    merge_.reset();
+    data_->clear();
+  }
+  if (numRows == 0) {
+    return nullptr;
+  }
+  result->resize(numRows);
+  numRowsReturned_ += numRows;
+  return result;
+}
+
 RowVectorPtr OrderBy::getOutput() {
-  if (finished_ || !isFinishing_ || returningRows_.size() == numRowsReturned_) {
+  if (finished_ || !isFinishing_) {
+    return nullptr;
+  }
+  if (merge_) {
+    return getOutputFromSpill();
+  }
+  if (returningRows_.size() == numRowsReturned_) {
     return nullptr;
   }
 
-  size_t numRows = data_->estimatedNumRowsPerBatch(kBatchSizeInBytes);
+  size_t numRows = outputBatchRows(data_->estimateRowSize());
   int32_t numRowsToReturn =
       std::min(numRows, returningRows_.size() - numRowsReturned_);
 
   VELOX_CHECK_GT(numRowsToReturn, 0);
 
   auto result = std::dynamic_pointer_cast<RowVector>(
-      BaseVector::create(outputType_, numRowsToReturn, operatorCtx_->pool()));
+      operatorCtx_->vectorPool().get(
+          outputType_, numRowsToReturn, operatorCtx_->pool()));
 
-  for (int i = 0; i < outputType_->size(); ++i) {
+  for (int i = 0; i < columns_.size(); ++i) {
     data_->extractColumn(
         returningRows_.data() + numRowsReturned_,
         numRowsToReturn,
         i,
-        result->childAt(i));
+        result->childAt(columns_[i]));
   }
 
   numRowsReturned_ += numRowsToReturn;
@@ -18,6 +18,7 @@
 #include "velox/exec/ContainerRowSerde.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/RowContainer.h"
+#include "velox/exec/Spill.h"
 
 namespace facebook::velox::exec {
 
@@ -27,10 +28,18 @@ namespace facebook::velox::exec {
 // to the rows using the RowContainer's compare() function. And finally it
 // constructs and returns the sorted output RowVector using the data in the
 // RowContainer.
+// If spilling is enabled in the QueryCtx, OrderBy sorts the rows
+// accumulated so far and writes them to a spill file as a sorted run
+// when the RowContainer exceeds the configured threshold or the memory
+// limit is about to be reached. The output is then produced by a k-way
+// merge of the spilled runs and the rows still in memory.
+// The sorting keys are stored in the rows and the fixed width
+// non-key columns in column chunks of the RowContainer, so that the
+// sort touches only the narrow key rows.
 // Limitations:
 // * It memcopies twice: 1) input to RowContainer and 2) RowContainer to
 // output.
-// * It does not support spilling. For now, if memory limit exceeds, it will
+// * If spilling is not enabled and the memory limit is exceeded, it will
 // throw an exception: VeloxMemoryCapExceeded.
 class OrderBy : public Operator {
  public:
@@ -53,15 +62,48 @@ class OrderBy : public Operator {
     return BlockingReason::kNotBlocked;
   }
 
+  // Spills the rows accumulated so far if spilling is enabled and all
+  // input has not been received.
+  uint64_t reclaim(uint64_t bytes) override;
+
  private:
-  static const int32_t kBatchSizeInBytes{2 * 1024 * 1024};
+  // Sorts the pointers to the rows in 'data_' into 'returningRows_'.
+  void sortRows();
+
+  // Spills the rows in 'data_' if spilling is enabled and there is not
+  // enough memory for adding 'input'.
+  void ensureInputFits(const RowVectorPtr& input);
+
+  // Writes the rows in 'data_' to a new sorted run and clears 'data_'.
+  void spill();
+
+  // Produces the next batch of output by merging the spilled runs.
+  RowVectorPtr getOutputFromSpill();
 
   std::unique_ptr<RowContainer> data_;
-  std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
+  // The CompareFlags of each sorting key. The keys are the first
+  // columns of 'data_'.
+  std::vector<CompareFlags> compareFlags_;
 
   size_t numRows_ = 0;
   size_t numRowsReturned_ = 0;
   std::vector<char*> returningRows_;
+  // Decodes the input columns. Reused across batches so that the index and
+  // null buffers of nested dictionaries are allocated once.
+  DecodedVector decodedInput_;
+
+  // Type of the rows in 'data_' and of the spilled rows. This has the
+  // sorting keys first, followed by the rest of the columns.
+  std::shared_ptr<const RowType> rowType_;
+  // The column of 'outputType_' for each column of 'rowType_'.
+  std::vector<ChannelIndex> columns_;
+  // Size of 'data_' after which a sorted run is spilled. 0 for no limit.
+  uint64_t spillMemoryThreshold_ = 0;
+  // Set if spilling is enabled.
+  std::unique_ptr<SpillState> spill_;
+  // Merge of the spilled runs and the rows in 'data_'. Set in finish() if
+  // anything was spilled.
+  std::unique_ptr<TreeOfLosers<SpillStream*, SpillStream>> merge_;
 
   bool finished_ = false;
 };
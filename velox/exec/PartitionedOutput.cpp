@@ -20,9 +20,9 @@
 namespace facebook::velox::exec {
 
 BlockingReason Destination::advance(
-    uint64_t maxBytes,
     const std::vector<vector_size_t>& sizes,
     const RowVectorPtr& output,
+    const SerializedRows* serializedRows,
     PartitionedOutputBufferManager& bufferManager,
     bool* atEnd,
     ContinueFuture* future) {
@@ -30,8 +30,8 @@ BlockingReason Destination::advance(
     *atEnd = true;
     return BlockingReason::kNotBlocked;
   }
-  if (bytesInCurrent_ >= maxBytes) {
-    return flush(bufferManager, future);
+  if (bytesInCurrent_ >= targetBytes_) {
+    return flushFull(bufferManager, future);
   }
   auto firstRow = row_;
   for (; row_ < rows_.size(); ++row_) {
@@ -40,22 +40,23 @@ BlockingReason Destination::advance(
     for (vector_size_t i = 0; i < rows_[row_].size; i++) {
       bytesInCurrent_ += sizes[rows_[row_].begin + i];
     }
-    if (bytesInCurrent_ >= maxBytes) {
-      serialize(output, firstRow, row_ + 1);
+    if (bytesInCurrent_ >= targetBytes_) {
+      serialize(output, serializedRows, firstRow, row_ + 1);
       if (row_ == rows_.size() - 1) {
         *atEnd = true;
       }
       ++row_;
-      return flush(bufferManager, future);
+      return flushFull(bufferManager, future);
     }
   }
-  serialize(output, firstRow, row_);
+  serialize(output, serializedRows, firstRow, row_);
   *atEnd = true;
   return BlockingReason::kNotBlocked;
 }
 
 void Destination::serialize(
     const RowVectorPtr& output,
+    const SerializedRows* serializedRows,
     vector_size_t begin,
     vector_size_t end) {
   if (!current_) {
@@ -65,9 +66,25 @@ void Destination::serialize(
     for (vector_size_t i = begin; i < end; i++) {
       numRows += rows_[i].size;
     }
-    current_->createStreamTree(rowType, numRows);
+    current_->createStreamTree(rowType, numRows, serdeOptions_);
   }
-  current_->append(output, folly::Range(&rows_[begin], end - begin));
+  auto ranges = folly::Range(&rows_[begin], end - begin);
+  if (serializedRows) {
+    current_->appendSerializedRows(*serializedRows, ranges);
+  } else {
+    current_->append(output, ranges);
+  }
+}
+
+BlockingReason Destination::flushFull(
+    PartitionedOutputBufferManager& bufferManager,
+    ContinueFuture* future) {
+  if (bufferManager.hasWaitingConsumer(taskId_, destination_)) {
+    targetBytes_ = std::max(minBytes_, targetBytes_ / 2);
+  } else {
+    targetBytes_ = std::min(maxBytes_, targetBytes_ * 2);
+  }
+  return flush(bufferManager, future);
 }
 
 BlockingReason Destination::flush(
@@ -107,7 +124,14 @@ void PartitionedOutput::initializeDestinations() {
     auto memory = operatorCtx_->mappedMemory();
     auto taskId = operatorCtx_->taskId();
     for (int i = 0; i < numDestinations_; ++i) {
-      destinations_.push_back(std::make_unique<Destination>(taskId, i, memory));
+      destinations_.push_back(std::make_unique<Destination>(
+          taskId,
+          i,
+          memory,
+          &serdeOptions_,
+          kMinDestinationSize,
+          kMaxDestinationSize,
+          initialDestinationBytes_));
     }
   }
 }
@@ -140,18 +164,74 @@ void PartitionedOutput::estimateRowSizes() {
   }
 }
 
+void PartitionedOutput::serializeRows() {
+  VectorStreamGroup::serializeRows(
+      output_, operatorCtx_->mappedMemory(), serializedRows_);
+  for (vector_size_t i = 0; i < output_->size(); ++i) {
+    rowSize_[i] = serializedRows_.rowSize(i);
+  }
+}
+
+bool PartitionedOutput::addPendingInput(
+    const RowVectorPtr& input,
+    uint64_t bytes) {
+  if (numDestinations_ == 1 ||
+      numPendingRows_ + input->size() >=
+          numDestinations_ * kMinRowsPerDestination ||
+      pendingBytes_ + bytes >= kMaxPendingInputBytes) {
+    return false;
+  }
+  pendingInputs_.push_back(input);
+  numPendingRows_ += input->size();
+  pendingBytes_ += bytes;
+  return true;
+}
+
+RowVectorPtr PartitionedOutput::combinePendingInputs() {
+  auto combined = std::static_pointer_cast<RowVector>(BaseVector::create(
+      pendingInputs_[0]->type(), numPendingRows_, pool()));
+  vector_size_t offset = 0;
+  for (auto& input : pendingInputs_) {
+    for (auto i = 0; i < input->childrenSize(); ++i) {
+      combined->childAt(i)->copy(
+          input->loadedChildAt(i).get(), offset, 0, input->size());
+    }
+    offset += input->size();
+  }
+  pendingInputs_.clear();
+  numPendingRows_ = 0;
+  pendingBytes_ = 0;
+  return combined;
+}
+
 void PartitionedOutput::addInput(RowVectorPtr input) {
   // TODO Report outputBytes as bytes after serialization
-  stats_.outputBytes += input->retainedSize();
+  auto bytes = input->retainedSize();
+  stats_.outputBytes += bytes;
   stats_.outputPositions += input->size();
 
+  if (addPendingInput(input, bytes)) {
+    return;
+  }
+  if (!pendingInputs_.empty()) {
+    numPendingRows_ += input->size();
+    pendingInputs_.push_back(std::move(input));
+    input = combinePendingInputs();
+  }
   initializeInput(std::move(input));
+  partitionInput();
+}
 
+void PartitionedOutput::partitionInput() {
   initializeDestinations();
 
   initializeSizeBuffers();
 
-  estimateRowSizes();
+  if (rowWiseSerde_) {
+    serializeRows();
+  } else {
+    estimateRowSizes();
+  }
 
   for (auto& destination : destinations_) {
     destination->beginBatch();
@@ -184,8 +264,27 @@ void PartitionedOutput::addInput(RowVectorPtr input) {
         }
       }
     } else {
+      // Counting sort of the rows by partition. Each destination then
+      // gets its rows in one contiguous run.
+      partitionEnds_.assign(numDestinations_ + 1, 0);
       for (vector_size_t i = 0; i < numInput; ++i) {
-        destinations_[partitions_[i]]->addRow(i);
+        ++partitionEnds_[partitions_[i] + 1];
+      }
+      for (auto i = 1; i <= numDestinations_; ++i) {
+        partitionEnds_[i] += partitionEnds_[i - 1];
+      }
+      // Each entry is the start of the partition and after the scatter
+      // the end.
+      rowsByPartition_.resize(numInput);
+      for (vector_size_t i = 0; i < numInput; ++i) {
+        rowsByPartition_[partitionEnds_[partitions_[i]]++] = i;
+      }
+      vector_size_t begin = 0;
+      for (auto i = 0; i < numDestinations_; ++i) {
+        auto end = partitionEnds_[i];
+        destinations_[i]->addRows(folly::Range<const vector_size_t*>(
+            rowsByPartition_.data() + begin, end - begin));
+        begin = end;
       }
     }
   }
@@ -221,15 +320,21 @@ RowVectorPtr PartitionedOutput::getOutput() {
   VELOX_CHECK_NOT_NULL(
       bufferManager, "PartitionedOutputBufferManager was already destructed");
 
+  if (isFinishing_ && !output_ && !pendingInputs_.empty()) {
+    // The held back inputs are not followed by more input.
+    initializeInput(combinePendingInputs());
+    partitionInput();
+  }
+
   bool workLeft;
   do {
     workLeft = false;
     for (auto& destination : destinations_) {
       bool atEnd = false;
       blockingReason_ = destination->advance(
-          kMaxDestinationSize,
           rowSize_,
           output_,
+          rowWiseSerde_ ? &serializedRows_ : nullptr,
           *bufferManager,
           &atEnd,
           &future_);
@@ -275,8 +380,8 @@ RowVectorPtr PartitionedOutput::getOutput() {
     isFinished_ = true;
   }
   // The input is fully processed, drop the reference to allow reuse.
-  input_ = nullptr;
   output_ = nullptr;
+  operatorCtx_->vectorPool().release(input_);
   return nullptr;
 }
 
@@ -27,8 +27,18 @@ class Destination {
   Destination(
       const std::string& taskId,
       int destination,
-      memory::MappedMemory* memory)
-      : taskId_(taskId), destination_(destination), memory_(memory) {}
+      memory::MappedMemory* memory,
+      const VectorSerde::Options* serdeOptions,
+      uint64_t minBytes,
+      uint64_t maxBytes,
+      uint64_t targetBytes)
+      : taskId_(taskId),
+        destination_(destination),
+        memory_(memory),
+        serdeOptions_(serdeOptions),
+        minBytes_(minBytes),
+        maxBytes_(maxBytes),
+        targetBytes_(targetBytes) {}
 
   // Resets the destination before starting a new batch.
   void beginBatch() {
@@ -44,10 +54,25 @@ class Destination {
     rows_.push_back(rows);
   }
 
+  // Adds 'rows', which are in ascending order. Consecutive rows are
+  // added as one range.
+  void addRows(folly::Range<const vector_size_t*> rows) {
+    for (auto i = 0; i < rows.size();) {
+      auto begin = i++;
+      while (i < rows.size() && rows[i] == rows[i - 1] + 1) {
+        ++i;
+      }
+      rows_.push_back(IndexRange{rows[begin], i - begin});
+    }
+  }
+
+  // Serializes rows of 'output' until the page reaches the target size,
+  // which is then flushed. If 'serializedRows' is not null, it has the rows
+  // of 'output' serialized by a row-wise serde and these are copied instead.
   BlockingReason advance(
-      uint64_t maxBytes,
       const std::vector<vector_size_t>& sizes,
       const RowVectorPtr& output,
+      const SerializedRows* serializedRows,
       PartitionedOutputBufferManager& bufferManager,
       bool* atEnd,
       ContinueFuture* future);
@@ -69,12 +94,29 @@ class Destination {
   }
 
  private:
-  void
-  serialize(const RowVectorPtr& input, vector_size_t begin, vector_size_t end);
+  void serialize(
+      const RowVectorPtr& input,
+      const SerializedRows* serializedRows,
+      vector_size_t begin,
+      vector_size_t end);
+
+  // Flushes a page that has reached the target size. Adjusts the target
+  // size to how fast the consumer fetches: a consumer that waits for
+  // data gets smaller pages sooner, one that does not wait gets fewer,
+  // larger pages.
+  BlockingReason flushFull(
+      PartitionedOutputBufferManager& bufferManager,
+      ContinueFuture* future);
 
   const std::string taskId_;
   const int destination_;
   memory::MappedMemory* const memory_;
+  const VectorSerde::Options* const serdeOptions_;
+  // Bounds of 'targetBytes_'.
+  const uint64_t minBytes_;
+  const uint64_t maxBytes_;
+  // The size at which a page is flushed.
+  uint64_t targetBytes_;
   uint64_t bytesInCurrent_{0};
   std::vector<IndexRange> rows_;
 
@@ -116,8 +158,17 @@ class PartitionedOutput : public Operator {
             planNode->inputType(),
             planNode->outputType())),
         future_(false),
+        rowWiseSerde_(
+            isRegisteredVectorSerde() && VectorStreamGroup::isRowWise()),
         bufferManager_(PartitionedOutputBufferManager::getInstance(
             operatorCtx_->task()->queryCtx()->host())) {
+    serdeOptions_.compression = toVectorSerdeCompression(
+        operatorCtx_->queryCtx()->exchangeCompression());
+    initialDestinationBytes_ = std::clamp<uint64_t>(
+        operatorCtx_->queryCtx()->maxPartitionedOutputBufferSize() /
+            numDestinations_,
+        kMinDestinationSize,
+        kMaxDestinationSize);
     if (numDestinations_ == 1 || planNode->isBroadcast()) {
       VELOX_CHECK(keyChannels_.empty());
       VELOX_CHECK_NULL(partitionFunction_);
@@ -148,9 +199,21 @@ class PartitionedOutput : public Operator {
 
   void close() override {
     destinations_.clear();
+    pendingInputs_.clear();
   }
 
  private:
+  // Returns true if 'input' is held back to be serialized together with
+  // the next inputs.
+  bool addPendingInput(const RowVectorPtr& input, uint64_t bytes);
+
+  // Returns the inputs held back by addPendingInput() combined into one
+  // vector.
+  RowVectorPtr combinePendingInputs();
+
+  // Assigns the rows of 'input_' to the destinations.
+  void partitionInput();
+
   void initializeInput(RowVectorPtr input);
 
   void initializeDestinations();
@@ -159,12 +222,24 @@ class PartitionedOutput : public Operator {
 
   void estimateRowSizes();
 
+  // Serializes the rows of 'output_' into 'serializedRows_' once for all
+  // destinations and sets 'rowSize_' to the exact row sizes. Used if the
+  // serde is row-wise.
+  void serializeRows();
+
   /// Collect all rows with null keys into nullRows_.
   void collectNullRows();
 
   static constexpr uint64_t kMaxDestinationSize = 1024 * 1024; // 1MB
   static constexpr uint64_t kMinDestinationSize = 16 * 1024; // 16 KB
 
+  // With many destinations, inputs are held back until they give each
+  // destination at least this many rows on average, so that the rows of
+  // a destination are serialized in fewer, larger pieces.
+  static constexpr vector_size_t kMinRowsPerDestination = 16;
+  // Upper limit for the size of the held back inputs.
+  static constexpr uint64_t kMaxPendingInputBytes = 16 << 20; // 16MB
+
   const std::vector<ChannelIndex> keyChannels_;
   const int numDestinations_;
   const bool replicateNullsAndAny_;
@@ -174,6 +249,8 @@ class PartitionedOutput : public Operator {
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
   ContinueFuture future_;
   bool isFinished_{false};
+  // True if the registered serde is row-wise.
+  const bool rowWiseSerde_;
   // top-level row numbers used as input to
   // VectorStreamGroup::estimateSerializedSize member variable is used to avoid
   // re-allocating memory
@@ -183,11 +260,26 @@ class PartitionedOutput : public Operator {
   std::vector<std::unique_ptr<Destination>> destinations_;
   bool replicatedAny_{false};
   std::weak_ptr<exec::PartitionedOutputBufferManager> bufferManager_;
+  // Options for serializing the pages of 'destinations_'.
+  VectorSerde::Options serdeOptions_;
+  // Initial target page size of 'destinations_'. Divides the output
+  // buffer between the destinations within the page size limits.
+  uint64_t initialDestinationBytes_;
+
+  // Inputs held back by addPendingInput(), their total rows and bytes.
+  std::vector<RowVectorPtr> pendingInputs_;
+  vector_size_t numPendingRows_{0};
+  uint64_t pendingBytes_{0};
 
   // Reusable memory.
   SelectivityVector rows_;
   SelectivityVector nullRows_;
   std::vector<uint32_t> partitions_;
+  // The input rows sorted by partition and the end of the rows of each
+  // partition in 'rowsByPartition_'.
+  std::vector<vector_size_t> rowsByPartition_;
+  std::vector<vector_size_t> partitionEnds_;
+  SerializedRows serializedRows_;
 };
 
 } // namespace facebook::velox::exec
@@ -201,19 +201,25 @@ BlockingReason PartitionedOutputBuffer::enqueue(
 
     totalSize_ += data->size();
     if (broadcast_) {
+      // All destinations share 'data' and its serialized form.
+      data->markShared();
       std::shared_ptr<VectorStreamGroup> shared = std::move(data);
       for (auto& buffer : buffers_) {
-        buffer->enqueue(shared);
-        dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
+        if (buffer) {
+          buffer->enqueue(shared);
+          dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
+        }
       }
 
       if (!noMoreBroadcastBuffers_) {
         dataToBroadcast_.emplace_back(shared);
       }
     } else {
-      auto buffer = buffers_[destination].get();
-      buffer->enqueue(std::move(data));
-      dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
+      // The destination is deleted if its consumer has ended early.
+      if (auto buffer = buffers_[destination].get()) {
+        buffer->enqueue(std::move(data));
+        dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
+      }
     }
 
     if (totalSize_ > maxSize_ && future) {
@@ -277,6 +283,14 @@ bool PartitionedOutputBuffer::isFinishedLocked() {
   return true;
 }
 
+bool PartitionedOutputBuffer::hasWaitingConsumer(int destination) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (destination >= buffers_.size() || !buffers_[destination]) {
+    return false;
+  }
+  return buffers_[destination]->hasWaitingConsumer();
+}
+
 void PartitionedOutputBuffer::acknowledge(int destination, int64_t sequence) {
   std::vector<std::shared_ptr<VectorStreamGroup>> freed;
   std::vector<VeloxPromise<bool>> promises;
@@ -324,6 +338,7 @@ bool PartitionedOutputBuffer::deleteResults(int destination) {
   std::vector<std::shared_ptr<VectorStreamGroup>> freed;
   std::vector<VeloxPromise<bool>> promises;
   bool isFinished;
+  bool earlyEnd;
   {
     std::lock_guard<std::mutex> l(mutex_);
     VELOX_CHECK(destination < buffers_.size());
@@ -336,6 +351,7 @@ bool PartitionedOutputBuffer::deleteResults(int destination) {
     buffers_[destination] = nullptr;
     ++numFinalAcknowledges_;
     isFinished = isFinishedLocked();
+    earlyEnd = isFinished && !atEnd_;
     updateAfterAcknowledgeLocked(freed, promises);
   }
   if (!promises.empty()) {
@@ -345,6 +361,11 @@ bool PartitionedOutputBuffer::deleteResults(int destination) {
   releaseAfterAcknowledge(freed, promises);
   if (isFinished) {
     task_->setAllOutputConsumed();
+    if (earlyEnd) {
+      // All consumers are gone before the producers finished. Nothing
+      // the producers make is read, so stop them.
+      task_->terminate(kFinished);
+    }
   }
   return isFinished;
 }
@@ -443,6 +464,12 @@ void PartitionedOutputBufferManager::noMoreData(const std::string& taskId) {
   getBuffer(taskId)->noMoreData();
 }
 
+bool PartitionedOutputBufferManager::hasWaitingConsumer(
+    const std::string& taskId,
+    int destination) {
+  return getBuffer(taskId)->hasWaitingConsumer(destination);
+}
+
 bool PartitionedOutputBufferManager::isFinished(const std::string& taskId) {
   return getBuffer(taskId)->isFinished();
 }
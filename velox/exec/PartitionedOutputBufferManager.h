@@ -76,6 +76,11 @@ class DestinationBuffer {
   // the callback.
   DataAvailable getAndClearNotify();
 
+  // Returns true if a consumer asked for data that is not yet there.
+  bool hasWaitingConsumer() const {
+    return notify_ != nullptr;
+  }
+
   std::string toString();
 
  private:
@@ -122,6 +127,8 @@ class PartitionedOutputBuffer {
 
   bool isFinishedLocked();
 
+  bool hasWaitingConsumer(int destination);
+
   void acknowledge(int destination, int64_t sequence);
 
   // Deletes all data for 'destination'. Returns true if all
@@ -205,6 +212,10 @@ class PartitionedOutputBufferManager {
 
   void noMoreData(const std::string& taskId);
 
+  // Returns true if the consumer of 'destination' is waiting for data,
+  // i.e. it fetches the data faster than it is produced.
+  bool hasWaitingConsumer(const std::string& taskId, int destination);
+
   // Returns true if noMoreData has been called and all the accumulated data
   // have been fetched and acknowledged.
   bool isFinished(const std::string& taskId);
@@ -32,6 +32,73 @@ static int32_t typeKindSize(TypeKind kind) {
 
   return VELOX_DYNAMIC_TYPE_DISPATCH(kindSize, kind);
 }
+
+// True if a dependent of 'kind' can be stored in column chunks.
+bool isColumnarKind(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT:
+    case TypeKind::REAL:
+    case TypeKind::DOUBLE:
+    case TypeKind::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// True if values of 'kind' are equal if and only if their bytes are
+// equal. Floating point values are not, because of -0.0 and NaN.
+bool isBytewiseComparableKind(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT:
+    case TypeKind::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Compares the first 'kBytes' bytes of 'left' and 'right'. The size is
+// a constant, so that the compare is a few wide loads.
+template <int32_t kBytes>
+bool equalKeyBytes(const char* left, const char* right, int32_t /*bytes*/) {
+  return memcmp(left, right, kBytes) == 0;
+}
+
+bool equalKeyBytesAnySize(const char* left, const char* right, int32_t bytes) {
+  return memcmp(left, right, bytes) == 0;
+}
+
+RowContainer::KeyEquals keyEqualsForSize(int32_t bytes) {
+  switch (bytes) {
+    case 1:
+      return equalKeyBytes<1>;
+    case 2:
+      return equalKeyBytes<2>;
+    case 4:
+      return equalKeyBytes<4>;
+    case 8:
+      return equalKeyBytes<8>;
+    case 12:
+      return equalKeyBytes<12>;
+    case 16:
+      return equalKeyBytes<16>;
+    case 24:
+      return equalKeyBytes<24>;
+    case 32:
+      return equalKeyBytes<32>;
+    default:
+      return equalKeyBytesAnySize;
+  }
+}
 } // namespace
 
 RowContainer::RowContainer(
@@ -44,13 +111,15 @@ RowContainer::RowContainer(
     bool hasProbedFlag,
     bool hasNormalizedKeys,
     memory::MappedMemory* mappedMemory,
-    const RowSerde& serde)
+    const RowSerde& serde,
+    bool columnarDependents)
     : keyTypes_(keyTypes),
       nullableKeys_(nullableKeys),
       aggregates_(aggregates),
       isJoinBuild_(isJoinBuild),
       hasNormalizedKeys_(hasNormalizedKeys),
       rows_(mappedMemory),
+      columnChunks_(mappedMemory),
       stringAllocator_(mappedMemory),
       serde_(serde) {
   // Compute the layout of the payload row.  The row has keys, null
@@ -71,6 +140,11 @@ RowContainer::RowContainer(
   // hash join build side, the pointer to the next row with the same key is
   // after the optional row size.
   //
+  // With 'columnarDependents', the fixed width scalar dependents are
+  // not in the row. Their values are in column chunks at the position
+  // given by a uint32_t row number that follows the dependent
+  // columns. Their null flags are in the row.
+  //
   // In most cases, rows are prefixed with a normalized_key_t at index
   // -1, 8 bytes below the pointer. This space is reserved for a 64
   // bit unique digest of the keys for speding up comparison. This
@@ -92,11 +166,26 @@ RowContainer::RowContainer(
       ++nullOffset;
     }
   }
+  bool bytewiseKeys = !keyTypes_.empty() &&
+      keyTypes_.size() <= kMaxBytewiseKeys &&
+      std::all_of(keyTypes_.begin(), keyTypes_.end(), [](const auto& type) {
+        return isBytewiseComparableKind(type->kind());
+      });
+  if (bytewiseKeys) {
+    keyBytes_ = offset;
+    keyEquals_ = keyEqualsForSize(keyBytes_);
+  }
   // Make offset at least sizeof pointer so that there is space for a
   // free list next pointer below the bit at 'freeFlagOffset_'.
   offset = std::max<int32_t>(offset, sizeof(void*));
   int32_t firstAggregate = offsets_.size();
   int32_t firstAggregateOffset = offset;
+  if (nullableKeys) {
+    // The null flags of the keys are the low bits of the first flag
+    // byte.
+    keyNullByte_ = firstAggregateOffset;
+    keyNullMask_ = bits::lowMask(keyTypes_.size());
+  }
   for (auto& aggregate : aggregates) {
     offsets_.push_back(offset);
     offset += aggregate->accumulatorFixedWidthSize();
@@ -104,15 +193,29 @@ RowContainer::RowContainer(
     ++nullOffset;
     isVariableWidth |= !aggregate->isFixedSize();
   }
+  columnarIndex_.resize(keyTypes_.size(), -1);
   for (auto& type : dependentTypes) {
     types_.push_back(type);
     typeKinds_.push_back(type->kind());
-    offsets_.push_back(offset);
-    offset += typeKindSize(type->kind());
+    if (columnarDependents && isColumnarKind(type->kind())) {
+      // The offset in the row is not used.
+      offsets_.push_back(0);
+      columnarIndex_.push_back(columnarColumns_.size());
+      columnarColumns_.push_back({typeKindSize(type->kind()), {}});
+      columnarRowSize_ += columnarColumns_.back().width;
+    } else {
+      offsets_.push_back(offset);
+      offset += typeKindSize(type->kind());
+      columnarIndex_.push_back(-1);
+    }
     nullOffsets_.push_back(nullOffset);
     ++nullOffset;
     isVariableWidth |= !type->isFixedWidth();
   }
+  if (!columnarColumns_.empty()) {
+    rowNumberOffset_ = offset;
+    offset += sizeof(uint32_t);
+  }
   if (isVariableWidth) {
     rowSizeOffset_ = offset;
     offset += sizeof(uint32_t);
@@ -134,6 +237,9 @@ RowContainer::RowContainer(
 
   // Fixup the offset of aggregates to make space for null flags.
   int32_t nullBytes = bits::nbytes(nullOffsets_.size());
+  if (rowNumberOffset_) {
+    rowNumberOffset_ += nullBytes;
+  }
   if (rowSizeOffset_) {
     rowSizeOffset_ += nullBytes;
   }
@@ -158,8 +264,14 @@ RowContainer::RowContainer(
   // A distinct hash table has no aggregates and if the hash table has
   // no nulls, it may be that there are no null flags.
   if (!nullOffsets_.empty()) {
-    // Aggregates start life as null, join dependent columns as non-null.
+    // Aggregates start life as null, dependent columns as non-null.
     initialNulls_.resize(nullBytes, isJoinBuild_ ? 0x0 : 0xff);
+    for (auto i = 0; i < dependentTypes.size(); ++i) {
+      bits::clearBit(
+          initialNulls_.data(),
+          nullOffsets_[firstAggregate + aggregates.size() + i] -
+              nullOffsets_.front());
+    }
     // The free flag has an initial value of 0.
     bits::clearBit(
         initialNulls_.data(), freeFlagOffset_ - nullOffsets_.front());
@@ -172,7 +284,13 @@ RowContainer::RowContainer(
   if (hasProbedFlag) {
     bits::clearBit(initialNulls_.data(), probedFlagOffset_ - nullOffsets_[0]);
   }
-  normalizedKeySize_ = hasNormalizedKeys_ ? sizeof(normalized_key_t) : 0;
+  // A group by on many keys may need a second word to fit the value ids
+  // of all keys. This costs a word per row until the mode is decided.
+  initialNormalizedKeySize_ =
+      !isJoinBuild && keyTypes_.size() >= kMinKeysForWideNormalizedKey
+      ? 2 * sizeof(normalized_key_t)
+      : sizeof(normalized_key_t);
+  normalizedKeySize_ = hasNormalizedKeys_ ? initialNormalizedKeySize_ : 0;
   for (auto i = 0; i < offsets_.size(); ++i) {
     rowColumns_.emplace_back(
         offsets_[i],
@@ -195,10 +313,24 @@ char* RowContainer::newRow() {
     if (normalizedKeySize_) {
       ++numRowsWithNormalizedKey_;
     }
+    if (rowNumberOffset_) {
+      newColumnarRow(row);
+    }
   }
   return initializeRow(row, false /* reuse */);
 }
 
+void RowContainer::newColumnarRow(char* row) {
+  auto number = numColumnarRows_++;
+  rowNumber(row) = number;
+  if ((number & (kColumnChunkRows - 1)) == 0) {
+    for (auto& column : columnarColumns_) {
+      column.chunks.push_back(
+          columnChunks_.allocateFixed(kColumnChunkRows * column.width));
+    }
+  }
+}
+
 char* RowContainer::initializeRow(char* row, bool reuse) {
   if (reuse) {
     auto rows = folly::Range<char**>(&row, 1);
@@ -302,6 +434,17 @@ void RowContainer::store(
         index,
         row,
         offsets_[column]);
+  } else if (isColumnar(column)) {
+    auto rowColumn = rowColumns_[column];
+    VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+        storeColumnar,
+        typeKinds_[column],
+        decoded,
+        index,
+        row,
+        columnarValue(columnarColumns_[columnarIndex_[column]], row),
+        rowColumn.nullByte(),
+        rowColumn.nullMask());
   } else {
     VELOX_DCHECK(column < keyTypes_.size() || aggregates_.empty());
     auto rowColumn = rowColumns_[column];
@@ -403,9 +546,30 @@ int32_t RowContainer::compareStringAsc(
     StringView left,
     const DecodedVector& decoded,
     vector_size_t index) {
+  auto right = decoded.valueAt<StringView>(index);
+  // 'left' may be stored in non-contiguous pieces. It is read through
+  // data() only if it is not inline and prefixes are equal.
+  if (left.isInline() || !left.prefixEquals(right)) {
+    return left.compare(right);
+  }
+  std::string storage;
+  return HashStringAllocator::contiguousString(left, storage).compare(right);
+}
+
+// static
+bool RowContainer::equalStrings(
+    StringView left,
+    const DecodedVector& decoded,
+    vector_size_t index) {
+  auto right = decoded.valueAt<StringView>(index);
+  if (left.size() != right.size() || !left.prefixEquals(right)) {
+    return false;
+  }
+  if (left.isInline()) {
+    return left == right;
+  }
   std::string storage;
-  return HashStringAllocator::contiguousString(left, storage)
-      .compare(decoded.valueAt<StringView>(index));
+  return HashStringAllocator::contiguousString(left, storage) == right;
 }
 
 // static
@@ -421,6 +585,9 @@ int RowContainer::compareComplexType(
 }
 
 int32_t RowContainer::compareStringAsc(StringView left, StringView right) {
+  if (!left.prefixEquals(right) || (left.isInline() && right.isInline())) {
+    return left.compare(right);
+  }
   std::string leftStorage;
   std::string rightStorage;
   return HashStringAllocator::contiguousString(left, leftStorage)
@@ -498,17 +665,55 @@ void RowContainer::hash(
 
 void RowContainer::clear() {
   rows_.clear();
+  columnChunks_.clear();
+  for (auto& column : columnarColumns_) {
+    column.chunks.clear();
+  }
+  numColumnarRows_ = 0;
   stringAllocator_.clear();
   numRows_ = 0;
   numRowsWithNormalizedKey_ = 0;
+  firstFreeRow_ = nullptr;
+  numFreeRows_ = 0;
   if (hasNormalizedKeys_) {
-    normalizedKeySize_ = sizeof(normalized_key_t);
+    normalizedKeySize_ = initialNormalizedKeySize_;
+  }
+}
+
+void RowContainer::compact() {
+  if (numFreeRows_ == 0) {
+    return;
   }
+  // Normalized keys are either reserved below all rows or disabled.
+  // Once disabled, the new rows do not get the space, also if the old
+  // rows had it.
+  auto keySize = normalizedKeySize_;
+  auto rowSize = fixedRowSize_ + keySize;
+  AllocationPool newRows(rows_.mappedMemory());
+  constexpr int32_t kBatchSize = 1024;
+  // @lint-ignore CLANGTIDY
+  char* batch[kBatchSize];
+  RowContainerIterator iter;
+  int32_t numListed;
+  while ((numListed = listRows(&iter, kBatchSize, batch)) > 0) {
+    for (auto i = 0; i < numListed; ++i) {
+      auto row = newRows.allocateFixed(rowSize);
+      memcpy(row, batch[i] - keySize, rowSize);
+    }
+  }
+  rows_.swap(newRows);
+  numRowsWithNormalizedKey_ = keySize ? numRows_ : 0;
+  firstFreeRow_ = nullptr;
+  numFreeRows_ = 0;
 }
 
 void RowContainer::setProbedFlag(char** rows, int32_t numRows) {
   for (auto i = 0; i < numRows; i++) {
-    bits::setBit(rows[i], probedFlagOffset_);
+    // Rows with many matches are marked once, so that the probe
+    // Drivers do not keep writing the same cache lines.
+    if (!bits::isBitSet(rows[i], probedFlagOffset_)) {
+      bits::setBit(rows[i], probedFlagOffset_);
+    }
   }
 }
 
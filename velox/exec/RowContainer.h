@@ -100,6 +100,10 @@ class RowContainer {
             mappedMemory,
             ContainerRowSerde::instance()) {}
 
+  // Minimum number of keys of a group by for reserving a two word
+  // normalized key.
+  static constexpr int32_t kMinKeysForWideNormalizedKey = 3;
+
   // 'keyTypes' gives the type of the key of each row. For a group by,
   // order by or right outer join build side these may be
   // nullable. 'nullableKeys' specifies if these have a null flag.
@@ -113,9 +117,15 @@ class RowContainer {
   // for a probed state of a full or right outer
   // join. 'hasNormalizedKey' specifies that an extra word is left
   // below each row for a normlized key that collapses all parts
-  // into one word for faster comparison. The bulk allocation is done
-  // from 'mappedMemory'.  'serde_' is used for serializing complex
-  // type values into the container.
+  // into one word for faster comparison. A group by with
+  // kMinKeysForWideNormalizedKey or more keys gets two words. The
+  // bulk allocation is done from 'mappedMemory'.  'serde_' is used
+  // for serializing complex type values into the container. If
+  // 'columnarDependents' is true, the fixed width scalar dependent
+  // columns are stored in column chunks indexed by row number instead
+  // of in the row. This keeps the rows narrow for sorting a wide
+  // payload on few keys. The columnar values are only accessed with
+  // store() and the non-static extractColumn().
   RowContainer(
       const std::vector<TypePtr>& keyTypes,
       bool nullableKeys,
@@ -126,7 +136,8 @@ class RowContainer {
       bool hasProbedFlag,
       bool hasNormalizedKey,
       memory::MappedMemory* mappedMemory,
-      const RowSerde& serde);
+      const RowSerde& serde,
+      bool columnarDependents = false);
 
   // Allocates a new row and initializes possible aggregates to null.
   char* newRow();
@@ -188,9 +199,25 @@ class RowContainer {
       int32_t numRows,
       int32_t columnIndex,
       VectorPtr result) {
+    if (isColumnar(columnIndex)) {
+      VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+          extractColumnarTyped,
+          typeKinds_[columnIndex],
+          rows,
+          numRows,
+          columnIndex,
+          result);
+      return;
+    }
     extractColumn(rows, numRows, columnAt(columnIndex), result);
   }
 
+  // True if the values of 'columnIndex' are in column chunks instead of
+  // in the rows.
+  bool isColumnar(int32_t columnIndex) const {
+    return rowNumberOffset_ && columnarIndex_[columnIndex] >= 0;
+  }
+
   static inline int32_t nullByte(int32_t nullOffset) {
     return nullOffset / 8;
   }
@@ -249,6 +276,30 @@ class RowContainer {
       vector_size_t index,
       CompareFlags flags = CompareFlags());
 
+  // Compares the first 'bytes' bytes of two rows for equality.
+  using KeyEquals = bool (*)(const char*, const char*, int32_t);
+
+  // Maximum number of keys for which equalKeys() compares bytes.
+  static constexpr int32_t kMaxBytewiseKeys = 4;
+
+  // True if equalKeys() may be used. This is the case for up to
+  // kMaxBytewiseKeys keys, all of integer, boolean or timestamp type.
+  bool hasBytewiseKeys() const {
+    return keyEquals_ != nullptr;
+  }
+
+  // Returns true if all keys of 'left' and 'right' are equal, a null
+  // being equal to a null. Compares the key bytes with a kernel chosen
+  // for the key size when 'this' is made, instead of dispatching per
+  // column on the type. Requires hasBytewiseKeys().
+  bool equalKeys(const char* left, const char* right) const {
+    // A null key has a zero value, so only the null flags can differ.
+    if ((left[keyNullByte_] ^ right[keyNullByte_]) & keyNullMask_) {
+      return false;
+    }
+    return keyEquals_(left, right, keyBytes_);
+  }
+
   // Compares the value at 'columnIndex' between 'left' and 'right'. Returns 0
   // for equal, < 0 for left < right, > 0 otherwise.
   int32_t compare(
@@ -264,10 +315,27 @@ class RowContainer {
     return reinterpret_cast<normalized_key_t*>(group)[-1];
   }
 
+  // Allows get/set of the second word of a wide normalized key. This is
+  // stored in the word below the normalized key.
+  static inline normalized_key_t& highNormalizedKey(char* group) {
+    return reinterpret_cast<normalized_key_t*>(group)[-2];
+  }
+
+  // True if the rows have space for a two word normalized key. This is
+  // reserved for a group by on kMinKeysForWideNormalizedKey or more
+  // keys.
+  bool hasWideNormalizedKeys() const {
+    return normalizedKeySize_ == 2 * sizeof(normalized_key_t);
+  }
+
   void disableNormalizedKeys() {
     normalizedKeySize_ = 0;
   }
 
+  const std::vector<TypePtr>& keyTypes() const {
+    return keyTypes_;
+  }
+
   RowColumn columnAt(int32_t index) const {
     return rowColumns_[index];
   }
@@ -300,12 +368,19 @@ class RowContainer {
       uint64_t* result);
 
   uint64_t allocatedBytes() const {
-    return rows_.allocatedBytes() + stringAllocator_.retainedSize();
+    return rows_.allocatedBytes() + columnChunks_.allocatedBytes() +
+        stringAllocator_.retainedSize();
   }
 
   // Resets the state to be as after construction. Frees memory for payload.
   void clear();
 
+  // Moves the rows into new allocations without the space of the erased
+  // rows and frees the old allocations. Invalidates pointers to rows and
+  // RowContainerIterators. Does nothing if there are no erased rows. The
+  // accumulators of aggregates are moved by copying their bytes.
+  void compact();
+
   int32_t compareRows(const char* left, const char* right) {
     for (auto i = 0; i < keyTypes_.size(); ++i) {
       auto result = compare(left, right, i);
@@ -316,12 +391,23 @@ class RowContainer {
     return 0;
   }
 
+  // Returns the average bytes per row, including variable width data
+  // and the free space of the allocations. std::nullopt if there are
+  // no rows.
+  std::optional<uint64_t> estimateRowSize() const {
+    if (numRows_ == 0) {
+      return std::nullopt;
+    }
+    return allocatedBytes() / numRows_;
+  }
+
   // Returns estimated number of rows a batch can support for
   // the given batchSizeInBytes.
   // FIXME(venkatra): estimate num rows for variable length fields.
   int32_t estimatedNumRowsPerBatch(int32_t batchSizeInBytes) {
-    return (batchSizeInBytes / fixedRowSize_) +
-        ((batchSizeInBytes % fixedRowSize_) ? 1 : 0);
+    auto rowSize = fixedRowSize_ + columnarRowSize_;
+    return (batchSizeInBytes / rowSize) +
+        ((batchSizeInBytes % rowSize) ? 1 : 0);
   }
 
   // Adds new row to the row container and copy the 'srcRow' into the new row.
@@ -343,8 +429,7 @@ class RowContainer {
   void extractRows(const std::vector<char*>& rows, const RowVectorPtr& result) {
     VELOX_CHECK_EQ(rows.size(), result->size());
     for (int i = 0; i < result->childrenSize(); ++i) {
-      RowContainer::extractColumn(
-          rows.data(), rows.size(), columnAt(i), result->childAt(i));
+      extractColumn(rows.data(), rows.size(), i, result->childAt(i));
     }
   }
 
@@ -356,6 +441,19 @@ class RowContainer {
   // Offset of the pointer to the next free row on a free row.
   static constexpr int32_t kNextFreeOffset = 0;
 
+  // A column chunk has the values of a columnar dependent for
+  // 2^kColumnChunkShift consecutive row numbers.
+  static constexpr int32_t kColumnChunkShift = 12;
+  static constexpr uint32_t kColumnChunkRows = 1 << kColumnChunkShift;
+
+  // The column chunks of a columnar dependent. The value of the row
+  // with number n is at 'n & (kColumnChunkRows - 1)' * 'width' in
+  // 'chunks[n >> kColumnChunkShift]'.
+  struct ColumnChunks {
+    int32_t width;
+    std::vector<char*> chunks;
+  };
+
   static inline bool
   isNullAt(const char* row, int32_t nullByte, uint8_t nullMask) {
     return (row[nullByte] & nullMask) != 0;
@@ -394,6 +492,72 @@ class RowContainer {
     }
   }
 
+  // Copies the values of the columnar dependent 'columnIndex' for
+  // 'rows' into 'result'. The null flags are in the rows.
+  template <TypeKind Kind>
+  void extractColumnarTyped(
+      const char* const* rows,
+      int32_t numRows,
+      int32_t columnIndex,
+      VectorPtr result) const {
+    using T = typename KindToFlatVector<Kind>::HashRowType;
+    auto* flatResult = result->as<FlatVector<T>>();
+    auto column = columnAt(columnIndex);
+    auto nullByte = column.nullByte();
+    auto nullMask = column.nullMask();
+    const auto& chunks = columnarColumns_[columnarIndex_[columnIndex]];
+    flatResult->resize(numRows);
+    BufferPtr nullBuffer = flatResult->mutableNulls(numRows);
+    auto nulls = nullBuffer->asMutable<uint64_t>();
+    BufferPtr valuesBuffer = flatResult->mutableValues(numRows);
+    auto values = valuesBuffer->asMutableRange<T>();
+    for (int32_t i = 0; i < numRows; ++i) {
+      auto row = rows[i];
+      if (!row || isNullAt(row, nullByte, nullMask)) {
+        bits::setNull(nulls, i, true);
+      } else {
+        bits::setNull(nulls, i, false);
+        values[i] = *reinterpret_cast<const T*>(columnarValue(chunks, row));
+      }
+    }
+  }
+
+  uint32_t& rowNumber(char* row) {
+    return *reinterpret_cast<uint32_t*>(row + rowNumberOffset_);
+  }
+
+  uint32_t rowNumber(const char* row) const {
+    return *reinterpret_cast<const uint32_t*>(row + rowNumberOffset_);
+  }
+
+  // Returns the address of the value of 'row' in 'column'.
+  char* columnarValue(const ColumnChunks& column, const char* row) const {
+    auto number = rowNumber(row);
+    return column.chunks[number >> kColumnChunkShift] +
+        (number & (kColumnChunkRows - 1)) * column.width;
+  }
+
+  // Gives a new row the next row number and allocates the next column
+  // chunks if the previous ones are full.
+  void newColumnarRow(char* row);
+
+  template <TypeKind Kind>
+  inline void storeColumnar(
+      const DecodedVector& decoded,
+      vector_size_t index,
+      char* row,
+      char* value,
+      int32_t nullByte,
+      uint8_t nullMask) {
+    using T = typename TypeTraits<Kind>::NativeType;
+    if (decoded.isNullAt(index)) {
+      row[nullByte] |= nullMask;
+      *reinterpret_cast<T*>(value) = T();
+      return;
+    }
+    *reinterpret_cast<T*>(value) = decoded.valueAt<T>(index);
+  }
+
   char*& nextFree(char* row) {
     return *reinterpret_cast<char**>(row + kNextFreeOffset);
   }
@@ -511,8 +675,7 @@ class RowContainer {
       return compareComplexType(row, offset, decoded, index) == 0;
     }
     if (Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY) {
-      return compareStringAsc(
-                 valueAt<StringView>(row, offset), decoded, index) == 0;
+      return equalStrings(valueAt<StringView>(row, offset), decoded, index);
     }
     return decoded.valueAt<T>(index) == valueAt<T>(row, offset);
   }
@@ -530,8 +693,7 @@ class RowContainer {
       return compareComplexType(row, offset, decoded, index) == 0;
     }
     if (Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY) {
-      return compareStringAsc(
-                 valueAt<StringView>(row, offset), decoded, index) == 0;
+      return equalStrings(valueAt<StringView>(row, offset), decoded, index);
     }
 
     return decoded.valueAt<T>(index) == valueAt<T>(row, offset);
@@ -625,7 +787,7 @@ class RowContainer {
       iter->normalizedKeysLeft = numRowsWithNormalizedKey_;
     }
     int32_t rowSize = fixedRowSize_ +
-        (iter->normalizedKeysLeft > 0 ? sizeof(normalized_key_t) : 0);
+        (iter->normalizedKeysLeft > 0 ? initialNormalizedKeySize_ : 0);
     for (auto i = iter->allocationIndex; i < numAllocations; ++i) {
       auto allocation = rows_.allocationAt(i);
       auto numRuns = allocation->numRuns();
@@ -641,10 +803,10 @@ class RowContainer {
         auto row = iter->rowOffset;
         while (row + rowSize <= limit) {
           rows[count++] = data + row +
-              (iter->normalizedKeysLeft > 0 ? sizeof(normalized_key_t) : 0);
+              (iter->normalizedKeysLeft > 0 ? initialNormalizedKeySize_ : 0);
           row += rowSize;
           if (--iter->normalizedKeysLeft == 0) {
-            rowSize -= sizeof(normalized_key_t);
+            rowSize -= initialNormalizedKeySize_;
           }
           if (bits::isBitSet(rows[count - 1], freeFlagOffset_)) {
             --count;
@@ -693,6 +855,11 @@ class RowContainer {
 
   static int32_t compareStringAsc(StringView left, StringView right);
 
+  static bool equalStrings(
+      StringView left,
+      const DecodedVector& decoded,
+      vector_size_t index);
+
   int32_t compareComplexType(
       const char* row,
       int32_t offset,
@@ -742,8 +909,22 @@ class RowContainer {
   int32_t rowSizeOffset_ = 0;
 
   int32_t fixedRowSize_;
+  // Compares the keys of two rows as bytes, nullptr if the keys are not
+  // all bytewise comparable. See equalKeys().
+  KeyEquals keyEquals_ = nullptr;
+  // Total width of the keys at the start of the row if 'keyEquals_' is
+  // set.
+  int32_t keyBytes_ = 0;
+  // Byte and mask of the null flags of the keys. The mask is 0 if the
+  // keys are not nullable.
+  int32_t keyNullByte_ = 0;
+  uint8_t keyNullMask_ = 0;
   // True if normalized keys are enabled in initial state.
   const bool hasNormalizedKeys_;
+  // Bytes reserved below each row for a normalized key in the initial
+  // state. Two words for a group by with kMinKeysForWideNormalizedKey
+  // or more keys, else one word.
+  int8_t initialNormalizedKeySize_ = sizeof(normalized_key_t);
   // The count of entries that have an extra normalized_key_t before the
   // start.
   int64_t numRowsWithNormalizedKey_ = 0;
@@ -758,7 +939,23 @@ class RowContainer {
   char* firstFreeRow_ = nullptr;
   uint64_t numFreeRows_ = 0;
 
+  // Offset of the uint32_t row number for columnar dependents. 0 if
+  // there are no columnar dependents.
+  int32_t rowNumberOffset_ = 0;
+  // Index into 'columnarColumns_' for each column of 'types_'. -1 for
+  // columns that are in the row.
+  std::vector<int32_t> columnarIndex_;
+  std::vector<ColumnChunks> columnarColumns_;
+  // Total width of the columnar dependents of a row.
+  int32_t columnarRowSize_ = 0;
+  // Number of row numbers given out. Erased rows keep their number
+  // when reused.
+  uint32_t numColumnarRows_ = 0;
+
   AllocationPool rows_;
+  // Allocates the chunks in 'columnarColumns_'. These are not in
+  // 'rows_' because listRows() walks the allocations of 'rows_'.
+  AllocationPool columnChunks_;
   HashStringAllocator stringAllocator_;
   const RowSerde& serde_;
   // RowContainer requires a valid reference to a vector of aggregates. We use
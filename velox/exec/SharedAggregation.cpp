@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/SharedAggregation.h"
+#include "velox/exec/GroupingSet.h"
+
+namespace facebook::velox::exec {
+
+SharedAggregation::SharedAggregation(int32_t numPartitions) {
+  VELOX_CHECK_GT(numPartitions, 0);
+  partitions_.reserve(numPartitions);
+  for (auto i = 0; i < numPartitions; ++i) {
+    partitions_.push_back(std::make_unique<Partition>());
+  }
+}
+
+void SharedAggregation::setPartition(
+    int32_t partition,
+    GroupingSet* groupingSet) {
+  VELOX_CHECK_LT(partition, partitions_.size());
+  auto& state = *partitions_[partition];
+  std::lock_guard<std::mutex> l(state.mutex);
+  state.groupingSet = groupingSet;
+}
+
+void SharedAggregation::addInput(
+    int32_t partition,
+    const RowVectorPtr& input) {
+  auto& state = *partitions_[partition];
+  std::lock_guard<std::mutex> l(state.mutex);
+  if (state.groupingSet) {
+    state.groupingSet->addInput(input, false);
+  }
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <mutex>
+
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::exec {
+
+class GroupingSet;
+
+// The groups of a final aggregation whose Drivers share one hash
+// table. The table is partitioned on the hash of the grouping keys and
+// each Driver owns the GroupingSet of one partition. Any Driver adds
+// input to any partition while holding the mutex of the partition, so
+// the input does not need to be repartitioned by a local exchange and
+// each group exists in one partition only. After all Drivers have
+// received their input, each produces the results of its own
+// partition.
+class SharedAggregation {
+ public:
+  explicit SharedAggregation(int32_t numPartitions);
+
+  int32_t numPartitions() const {
+    return partitions_.size();
+  }
+
+  // Sets the GroupingSet owned by the Driver of 'partition'. The Driver
+  // sets this to nullptr before freeing its GroupingSet.
+  void setPartition(int32_t partition, GroupingSet* groupingSet);
+
+  // Adds 'input' to the groups of 'partition'. All rows of 'input' must
+  // have keys that hash to 'partition'. Does nothing if the Driver of
+  // 'partition' has already freed its GroupingSet, which happens only
+  // when the Task is terminating.
+  void addInput(int32_t partition, const RowVectorPtr& input);
+
+ private:
+  struct Partition {
+    std::mutex mutex;
+    GroupingSet* groupingSet{nullptr};
+  };
+
+  std::vector<std::unique_ptr<Partition>> partitions_;
+};
+
+} // namespace facebook::velox::exec
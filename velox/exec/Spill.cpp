@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/Spill.h"
+
+#include <glog/logging.h>
+#include <cstdio>
+
+namespace facebook::velox::exec {
+
+namespace {
+// A SpillStream over the batches of a SpillFile.
+class FileSpillStream : public SpillStream {
+ public:
+  FileSpillStream(
+      std::shared_ptr<const RowType> type,
+      const std::vector<CompareFlags>& compareFlags,
+      std::shared_ptr<MappedFile> file,
+      memory::MemoryPool& pool)
+      : SpillStream(std::move(type), compareFlags, pool),
+        file_(std::move(file)) {}
+
+ protected:
+  void nextBatch() override {
+    rowVector_ = ColumnarFile::read(file_, offset_, type_, &pool_);
+    size_ = rowVector_->size();
+  }
+
+  bool hasMoreBatches() const override {
+    return offset_ < file_->size();
+  }
+
+ private:
+  const std::shared_ptr<MappedFile> file_;
+  // Offset of the next batch in 'file_'.
+  uint64_t offset_ = 0;
+};
+} // namespace
+
+SpillFile::~SpillFile() {
+  output_.reset();
+  if (size_ && std::remove(path_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to remove spill file " << path_;
+  }
+}
+
+uint64_t SpillFile::append(const RowVectorPtr& rows) {
+  if (!output_) {
+    output_ = std::make_unique<LocalWriteFile>(path_);
+  }
+  std::string serialized;
+  ColumnarFile::append(*rows, serialized);
+  output_->append(serialized);
+  size_ += serialized.size();
+  return serialized.size();
+}
+
+void SpillFile::finishWrite() {
+  VELOX_CHECK(output_, "Spill file {} has no data", path_);
+  output_->flush();
+  output_.reset();
+}
+
+std::unique_ptr<SpillStream> SpillFile::read(memory::MemoryPool& pool) {
+  VELOX_CHECK(!output_, "Spill file {} is still being written", path_);
+  return std::make_unique<FileSpillStream>(
+      type_,
+      compareFlags_,
+      std::make_shared<MappedFile>(path_),
+      pool);
+}
+
+void SpillState::appendToPartition(
+    int32_t partition,
+    const RowVectorPtr& rows) {
+  VELOX_CHECK_LT(partition, maxPartitions_);
+  if (!rows->size()) {
+    return;
+  }
+  if (!isWriting_[partition]) {
+    files_[partition].push_back(std::make_unique<SpillFile>(
+        type_,
+        compareFlags_,
+        fmt::format("{}-{}-{}", path_, partition, numRuns_)));
+    isWriting_[partition] = true;
+    ++numRuns_;
+  }
+  spilledBytes_ += files_[partition].back()->append(rows);
+  spilledRows_ += rows->size();
+}
+
+void SpillState::finishWrite(int32_t partition) {
+  VELOX_CHECK_LT(partition, maxPartitions_);
+  if (!isWriting_[partition]) {
+    return;
+  }
+  files_[partition].back()->finishWrite();
+  isWriting_[partition] = false;
+}
+
+SpillFiles SpillState::takeFiles(int32_t partition) {
+  VELOX_CHECK_LT(partition, maxPartitions_);
+  VELOX_CHECK(!isWriting_[partition], "Spill partition is still written");
+  SpillFiles files;
+  std::swap(files, files_[partition]);
+  return files;
+}
+
+std::vector<std::unique_ptr<SpillStream>> SpillState::streams(
+    int32_t partition) {
+  VELOX_CHECK_LT(partition, maxPartitions_);
+  VELOX_CHECK(!isWriting_[partition], "Spill partition is still written");
+  std::vector<std::unique_ptr<SpillStream>> result;
+  for (auto& file : files_[partition]) {
+    result.push_back(file->read(pool_));
+  }
+  return result;
+}
+
+std::unique_ptr<TreeOfLosers<SpillStream*, SpillStream>>
+SpillState::startMerge(
+    int32_t partition,
+    std::vector<std::unique_ptr<SpillStream>>&& extraStreams) {
+  VELOX_CHECK_LT(partition, maxPartitions_);
+  VELOX_CHECK(!isWriting_[partition], "Spill partition is still written");
+  if (maxMergeFanIn_ > 0) {
+    VELOX_CHECK_LT(
+        extraStreams.size(),
+        maxMergeFanIn_,
+        "Too many in-memory streams for the merge fan-in");
+    auto& files = files_[partition];
+    // Each merge of n runs replaces them by one. Merges the oldest runs
+    // first so that the rows of a partition are rewritten about the
+    // same number of times.
+    while (files.size() + extraStreams.size() > maxMergeFanIn_) {
+      int32_t excess = files.size() + extraStreams.size() - maxMergeFanIn_;
+      mergeRuns(partition, std::min(maxMergeFanIn_, excess + 1));
+    }
+  }
+  auto streams = std::move(extraStreams);
+  for (auto& stream : this->streams(partition)) {
+    streams.push_back(std::move(stream));
+  }
+  VELOX_CHECK(!streams.empty(), "No spilled runs to merge");
+  return std::make_unique<TreeOfLosers<SpillStream*, SpillStream>>(
+      std::move(streams));
+}
+
+void SpillState::mergeRuns(int32_t partition, int32_t numRuns) {
+  auto& files = files_[partition];
+  VELOX_CHECK_LE(numRuns, files.size());
+  std::vector<std::unique_ptr<SpillStream>> streams;
+  for (auto i = 0; i < numRuns; ++i) {
+    streams.push_back(files[i]->read(pool_));
+  }
+  TreeOfLosers<SpillStream*, SpillStream> merge(std::move(streams));
+
+  auto run = std::make_unique<SpillFile>(
+      type_,
+      compareFlags_,
+      fmt::format("{}-{}-merged-{}", path_, partition, numMergedRuns_));
+  ++numMergedRuns_;
+  RowVectorPtr batch;
+  vector_size_t numRows = 0;
+  for (;;) {
+    auto stream = merge.next([](SpillStream* left, SpillStream* right) {
+      return left->compare(*right);
+    });
+    if (batch && (!stream.has_value() || numRows == kMergeBatchRows)) {
+      batch->resize(numRows);
+      spilledBytes_ += run->append(batch);
+      batch = nullptr;
+    }
+    if (!stream.has_value()) {
+      break;
+    }
+    if (!batch) {
+      batch = std::static_pointer_cast<RowVector>(
+          BaseVector::create(type_, kMergeBatchRows, &pool_));
+      numRows = 0;
+    }
+    auto& source = stream.value()->current();
+    auto index = stream.value()->currentIndex();
+    for (auto i = 0; i < type_->size(); ++i) {
+      batch->childAt(i)->copy(source.childAt(i).get(), numRows, index, 1);
+    }
+    ++numRows;
+  }
+  run->finishWrite();
+  // The streams of the merge keep their files mapped after removal.
+  files.erase(files.begin(), files.begin() + numRuns);
+  files.push_back(std::move(run));
+}
+
+} // namespace facebook::velox::exec
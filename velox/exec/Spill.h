@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/common/file/File.h"
+#include "velox/exec/TreeOfLosers.h"
+#include "velox/vector/ColumnarFile.h"
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::exec {
+
+// A source of sorted rows for a k-way merge of spilled runs. Keeps one
+// batch of rows at a time and a position in it. The first
+// 'numSortingKeys' columns are the sorting keys, compared with the
+// corresponding 'compareFlags'. Used as the Source and Value (as a
+// pointer to self) of a TreeOfLosers.
+class SpillStream {
+ public:
+  SpillStream(
+      std::shared_ptr<const RowType> type,
+      const std::vector<CompareFlags>& compareFlags,
+      memory::MemoryPool& pool)
+      : type_(std::move(type)), compareFlags_(compareFlags), pool_(pool) {}
+
+  virtual ~SpillStream() = default;
+
+  // True if there are no rows left to return.
+  bool atEnd() const {
+    return index_ + 1 >= size_ && !hasMoreBatches();
+  }
+
+  // Advances to the next row and returns 'this'. The row is accessed
+  // through current() and currentIndex(). The previously returned row
+  // can be invalidated by this.
+  SpillStream* next() {
+    if (++index_ >= size_) {
+      nextBatch();
+      VELOX_CHECK_GT(size_, 0);
+      index_ = 0;
+    }
+    return this;
+  }
+
+  // Returns the next batch of rows as a whole and advances past it or
+  // nullptr if at end. Used for reading back unsorted spilled data. Not
+  // to be mixed with next().
+  RowVectorPtr nextVector() {
+    VELOX_CHECK_EQ(index_ + 1, size_);
+    if (!hasMoreBatches()) {
+      return nullptr;
+    }
+    nextBatch();
+    index_ = size_ - 1;
+    return rowVector_;
+  }
+
+  const RowVector& current() const {
+    return *rowVector_;
+  }
+
+  vector_size_t currentIndex() const {
+    return index_;
+  }
+
+  // Compares the sorting keys of the current rows of 'this' and 'other'.
+  int32_t compare(const SpillStream& other) const {
+    for (auto i = 0; i < compareFlags_.size(); ++i) {
+      auto result = rowVector_->childAt(i)->compare(
+          other.rowVector_->childAt(i).get(),
+          index_,
+          other.index_,
+          compareFlags_[i]);
+      if (result) {
+        return result;
+      }
+    }
+    return 0;
+  }
+
+ protected:
+  // Loads the next batch into 'rowVector_' and sets 'size_'. Called
+  // only if hasMoreBatches() is true.
+  virtual void nextBatch() = 0;
+
+  virtual bool hasMoreBatches() const = 0;
+
+  const std::shared_ptr<const RowType> type_;
+  const std::vector<CompareFlags> compareFlags_;
+  memory::MemoryPool& pool_;
+  RowVectorPtr rowVector_;
+  // Number of rows in 'rowVector_'.
+  vector_size_t size_ = 0;
+  // Position of the current row in 'rowVector_'. Starts at -1 before
+  // the first call to next().
+  vector_size_t index_ = -1;
+};
+
+// A spill file holding a single sorted run. Written with append() in
+// batches in the ColumnarFile format and read back through a SpillStream
+// over a mapping of the file. The file is deleted when 'this' is
+// destroyed.
+class SpillFile {
+ public:
+  SpillFile(
+      std::shared_ptr<const RowType> type,
+      const std::vector<CompareFlags>& compareFlags,
+      const std::string& path)
+      : type_(std::move(type)), compareFlags_(compareFlags), path_(path) {}
+
+  ~SpillFile();
+
+  // Serializes 'rows' and appends these to the file. Returns the number of
+  // bytes written.
+  uint64_t append(const RowVectorPtr& rows);
+
+  // Closes the file for writing. No append() is allowed after this.
+  void finishWrite();
+
+  // Returns a stream over the rows of the file in the order they were
+  // written. Must be called after finishWrite().
+  std::unique_ptr<SpillStream> read(memory::MemoryPool& pool);
+
+  uint64_t size() const {
+    return size_;
+  }
+
+  const std::string& path() const {
+    return path_;
+  }
+
+ private:
+  const std::shared_ptr<const RowType> type_;
+  const std::vector<CompareFlags> compareFlags_;
+  const std::string path_;
+  std::unique_ptr<WriteFile> output_;
+  uint64_t size_ = 0;
+};
+
+using SpillFiles = std::vector<std::unique_ptr<SpillFile>>;
+
+// Manages the spill files of an operator. The spilled data is divided
+// into 'maxPartitions' partitions, each with a list of sorted
+// runs. Each run is a separate file. The rows of one partition are
+// read back by merging all the sorted runs of the partition. If there
+// are no sorting keys, the runs are unsorted and are read back one
+// after the other with streams().
+class SpillState {
+ public:
+  // Number of rows in the batches written to an intermediate run.
+  static constexpr vector_size_t kMergeBatchRows = 1024;
+
+  // 'path' is a file path prefix for the spill files. 'type' is the
+  // type of the spilled rows and 'compareFlags' gives the order of the
+  // leading 'compareFlags.size()' columns which are the sorting keys.
+  // 'maxMergeFanIn' is the maximum number of streams read at the same
+  // time by startMerge(). 0 means no limit.
+  SpillState(
+      const std::string& path,
+      int32_t maxPartitions,
+      std::shared_ptr<const RowType> type,
+      const std::vector<CompareFlags>& compareFlags,
+      memory::MemoryPool& pool,
+      int32_t maxMergeFanIn = 0)
+      : path_(path),
+        maxPartitions_(maxPartitions),
+        type_(std::move(type)),
+        compareFlags_(compareFlags),
+        pool_(pool),
+        maxMergeFanIn_(maxMergeFanIn),
+        files_(maxPartitions_) {
+    VELOX_CHECK(
+        maxMergeFanIn_ == 0 || maxMergeFanIn_ >= 2,
+        "Merge fan-in must be at least 2");
+  }
+
+  int32_t maxPartitions() const {
+    return maxPartitions_;
+  }
+
+  // Appends 'rows' to the current run of 'partition'. Starts a new run
+  // if there is no open run for 'partition'. 'rows' must be sorted on the
+  // sorting keys and follow the rows previously appended to the same
+  // run.
+  void appendToPartition(int32_t partition, const RowVectorPtr& rows);
+
+  // Finishes the current run of 'partition'. The next append to
+  // 'partition' starts a new run.
+  void finishWrite(int32_t partition);
+
+  // Returns true if 'partition' has at least one spilled run.
+  bool hasFiles(int32_t partition) const {
+    return partition < files_.size() && !files_[partition].empty();
+  }
+
+  // Returns the runs of 'partition' and removes them from 'this'. The
+  // runs must have been finished by finishWrite(). Used for handing
+  // over spilled data to another operator.
+  SpillFiles takeFiles(int32_t partition);
+
+  // Returns a stream over each of the runs of 'partition'. The runs
+  // must have been finished by finishWrite().
+  std::vector<std::unique_ptr<SpillStream>> streams(int32_t partition);
+
+  // Returns a merge of all the sorted runs of 'partition'. The
+  // runs must have been finished by finishWrite(). The caller owns
+  // the result and may add in-memory streams through 'extraStreams'
+  // to merge with the spilled ones. If there are more streams than
+  // the max fan-in, groups of runs are first merged into intermediate
+  // runs so that the final merge reads at most max fan-in streams.
+  std::unique_ptr<TreeOfLosers<SpillStream*, SpillStream>> startMerge(
+      int32_t partition,
+      std::vector<std::unique_ptr<SpillStream>>&& extraStreams = {});
+
+  // Number of runs written so far across all partitions.
+  int64_t numRuns() const {
+    return numRuns_;
+  }
+
+  uint64_t spilledBytes() const {
+    return spilledBytes_;
+  }
+
+  uint64_t spilledRows() const {
+    return spilledRows_;
+  }
+
+  // Number of intermediate runs written by startMerge(). These are not
+  // included in numRuns().
+  int64_t numMergedRuns() const {
+    return numMergedRuns_;
+  }
+
+  const std::shared_ptr<const RowType>& type() const {
+    return type_;
+  }
+
+  const std::vector<CompareFlags>& compareFlags() const {
+    return compareFlags_;
+  }
+
+ private:
+  // Merges the first 'numRuns' runs of 'partition' into a new run at
+  // the end of the runs of 'partition'.
+  void mergeRuns(int32_t partition, int32_t numRuns);
+
+  const std::string path_;
+  const int32_t maxPartitions_;
+  const std::shared_ptr<const RowType> type_;
+  const std::vector<CompareFlags> compareFlags_;
+  memory::MemoryPool& pool_;
+  const int32_t maxMergeFanIn_;
+
+  // A list of sorted runs for each partition.
+  std::vector<SpillFiles> files_;
+  // True for the partitions with an open run, i.e. the last file of
+  // the partition is being written.
+  std::vector<bool> isWriting_ = std::vector<bool>(maxPartitions_, false);
+  int64_t numRuns_ = 0;
+  uint64_t spilledBytes_ = 0;
+  uint64_t spilledRows_ = 0;
+  int64_t numMergedRuns_ = 0;
+};
+
+} // namespace facebook::velox::exec
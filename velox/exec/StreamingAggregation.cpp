@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/StreamingAggregation.h"
+
+namespace facebook::velox::exec {
+
+StreamingAggregation::StreamingAggregation(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::AggregationNode>& aggregationNode)
+    : Operator(
+          driverCtx,
+          aggregationNode->outputType(),
+          operatorId,
+          aggregationNode->id(),
+          aggregationNode->step() == core::AggregationNode::Step::kPartial
+              ? "PartialAggregation"
+              : "Aggregation"),
+      isRawInput_(isRawInput(aggregationNode->step())),
+      isPartialOutput_(isPartialOutput(aggregationNode->step())),
+      ignoreNullKeys_(aggregationNode->ignoreNullKeys()) {
+  VELOX_CHECK(
+      aggregationNode->isPreGrouped(),
+      "StreamingAggregation requires input clustered on all grouping keys");
+  auto inputType = aggregationNode->sources()[0]->outputType();
+
+  std::vector<TypePtr> keyTypes;
+  for (const auto& key : aggregationNode->groupingKeys()) {
+    auto channel = exprToChannel(key.get(), inputType);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "Aggregation doesn't allow constant grouping keys");
+    groupingKeys_.push_back(channel);
+    keyTypes.push_back(key->type());
+  }
+
+  auto numKeys = groupingKeys_.size();
+  for (auto i = 0; i < aggregationNode->aggregates().size(); i++) {
+    const auto& aggregate = aggregationNode->aggregates()[i];
+
+    std::vector<ChannelIndex> channels;
+    std::vector<VectorPtr> constants;
+    std::vector<TypePtr> argTypes;
+    for (auto& arg : aggregate->inputs()) {
+      argTypes.push_back(arg->type());
+      channels.push_back(exprToChannel(arg.get(), inputType));
+      if (channels.back() == kConstantChannel) {
+        auto constant = dynamic_cast<const core::ConstantTypedExpr*>(arg.get());
+        constants.push_back(BaseVector::createConstant(
+            constant->value(), 1, operatorCtx_->pool()));
+      } else {
+        constants.push_back(nullptr);
+      }
+    }
+
+    const auto& mask = aggregationNode->aggregateMasks()[i];
+    if (mask == nullptr) {
+      masks_.emplace_back(std::nullopt);
+    } else {
+      masks_.emplace_back(inputType->asRow().getChildIdx(mask->name()));
+    }
+
+    const auto& resultType = outputType_->childAt(numKeys + i);
+    aggregates_.push_back(Aggregate::create(
+        aggregate->name(), aggregationNode->step(), argTypes, resultType));
+    VELOX_CHECK(
+        aggregates_.back()->resultType()->kindEquals(resultType),
+        "Unexpected result type for an aggregation: {}, expected {}",
+        aggregates_.back()->resultType()->toString(),
+        resultType->toString());
+    args_.push_back(std::move(channels));
+    constantArgs_.push_back(std::move(constants));
+  }
+
+  rows_ = std::make_unique<RowContainer>(
+      keyTypes,
+      !ignoreNullKeys_,
+      aggregates_,
+      std::vector<TypePtr>{},
+      false, // hasNext
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      false, // hasNormalizedKey
+      operatorCtx_->mappedMemory(),
+      ContainerRowSerde::instance());
+}
+
+bool StreamingAggregation::sameGroup(
+    const RowVector& input,
+    vector_size_t index,
+    const RowVector& previous,
+    vector_size_t previousIndex) const {
+  for (auto channel : groupingKeys_) {
+    if (!input.childAt(channel)->equalValueAt(
+            previous.childAt(channel).get(), index, previousIndex)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StreamingAggregation::hasNullKey(
+    const RowVector& input,
+    vector_size_t index) const {
+  for (auto channel : groupingKeys_) {
+    if (input.childAt(channel)->isNullAt(index)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void StreamingAggregation::addGroup(vector_size_t index) {
+  auto group = rows_->newRow();
+  for (auto i = 0; i < groupingKeys_.size(); ++i) {
+    rows_->store(decodedKeys_[i], index, group, i);
+  }
+  newGroups_.push_back(groups_.size());
+  groups_.push_back(group);
+}
+
+void StreamingAggregation::addInput(RowVectorPtr input) {
+  // The keys of each row are compared with the keys of the previous
+  // row. Load the keys once instead of for each comparison.
+  for (auto channel : groupingKeys_) {
+    input->childAt(channel)->loadedVector();
+  }
+  auto numRows = input->size();
+  activeRows_.resize(numRows);
+  activeRows_.setAll();
+  decodedKeys_.resize(groupingKeys_.size());
+  for (auto i = 0; i < groupingKeys_.size(); ++i) {
+    decodedKeys_[i].decode(*input->childAt(groupingKeys_[i]), activeRows_);
+  }
+  inputGroups_.resize(numRows);
+  newGroups_.clear();
+
+  const RowVector* previous = previousInput_.get();
+  auto previousIndex = previousIndex_;
+  for (vector_size_t row = 0; row < numRows; ++row) {
+    if (ignoreNullKeys_ && hasNullKey(*input, row)) {
+      activeRows_.setValid(row, false);
+      inputGroups_[row] = nullptr;
+      continue;
+    }
+    if (groups_.empty() ||
+        !sameGroup(*input, row, *previous, previousIndex)) {
+      addGroup(row);
+    }
+    inputGroups_[row] = groups_.back();
+    previous = input.get();
+    previousIndex = row;
+  }
+  activeRows_.updateBounds();
+  if (previous == input.get()) {
+    previousInput_ = input;
+    previousIndex_ = previousIndex;
+  }
+
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    aggregates_[i]->initializeNewGroups(groups_.data(), newGroups_);
+  }
+  if (!activeRows_.hasSelections()) {
+    return;
+  }
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    const auto& rows = prepareRows(i, input);
+    const auto& channels = args_[i];
+    tempVectors_.resize(channels.size());
+    for (auto j = 0; j < channels.size(); ++j) {
+      if (channels[j] == kConstantChannel) {
+        tempVectors_[j] =
+            BaseVector::wrapInConstant(numRows, 0, constantArgs_[i][j]);
+      } else {
+        tempVectors_[j] = input->childAt(channels[j]);
+      }
+    }
+    if (isRawInput_) {
+      aggregates_[i]->addRawInput(
+          inputGroups_.data(), rows, tempVectors_, false);
+    } else {
+      aggregates_[i]->addIntermediateResults(
+          inputGroups_.data(), rows, tempVectors_, false);
+    }
+  }
+  tempVectors_.clear();
+}
+
+const SelectivityVector& StreamingAggregation::prepareRows(
+    int32_t aggregateIndex,
+    const RowVectorPtr& input) {
+  if (!masks_[aggregateIndex].has_value()) {
+    return activeRows_;
+  }
+  const auto& mask = input->childAt(masks_[aggregateIndex].value());
+  maskedRows_ = activeRows_;
+  decodedMask_.decode(*mask, activeRows_);
+  activeRows_.applyToSelected([&](vector_size_t i) {
+    if (decodedMask_.isNullAt(i) || !decodedMask_.valueAt<bool>(i)) {
+      maskedRows_.setValid(i, false);
+    }
+  });
+  maskedRows_.updateBounds();
+  return maskedRows_;
+}
+
+RowVectorPtr StreamingAggregation::createOutput(int32_t numGroups) {
+  auto output = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, numGroups, pool()));
+  auto groups = groups_.data();
+  auto numKeys = groupingKeys_.size();
+  for (auto i = 0; i < numKeys; ++i) {
+    rows_->extractColumn(groups, numGroups, i, output->childAt(i));
+  }
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    aggregates_[i]->finalize(groups, numGroups);
+    auto& result = output->childAt(numKeys + i);
+    if (isPartialOutput_) {
+      aggregates_[i]->extractAccumulators(groups, numGroups, &result);
+    } else {
+      aggregates_[i]->extractValues(groups, numGroups, &result);
+    }
+  }
+  // The rows of the returned groups are reused for the next groups.
+  rows_->eraseRows(folly::Range<char**>(groups, numGroups));
+  groups_.erase(groups_.begin(), groups_.begin() + numGroups);
+  return output;
+}
+
+RowVectorPtr StreamingAggregation::getOutput() {
+  if (groups_.empty()) {
+    return nullptr;
+  }
+  if (isFinishing_) {
+    return createOutput(
+        std::min<int32_t>(groups_.size(), kOutputBatchSize));
+  }
+  // The last group may continue in the next input.
+  if (groups_.size() > kOutputBatchSize) {
+    return createOutput(kOutputBatchSize);
+  }
+  return nullptr;
+}
+
+void StreamingAggregation::close() {
+  if (rows_) {
+    rows_->eraseRows(folly::Range<char**>(groups_.data(), groups_.size()));
+  }
+  groups_.clear();
+  previousInput_ = nullptr;
+  rows_.reset();
+  Operator::close();
+}
+
+} // namespace facebook::velox::exec
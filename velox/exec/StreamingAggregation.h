@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/Aggregate.h"
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// Aggregation over input that is clustered on the grouping keys, e.g.
+// read from files sorted on the keys or produced by a LocalMerge. A group
+// is complete as soon as a row with different keys arrives, so there is
+// no hash table: each input row is compared with the previous one and the
+// accumulators are kept only for the groups of the next output batch.
+// Completed groups are returned once a batch worth of them is available,
+// and their rows are reused for the following groups.
+class StreamingAggregation : public Operator {
+ public:
+  StreamingAggregation(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::AggregationNode>& aggregationNode);
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+  bool needsInput() const override {
+    return !isFinishing_ && groups_.size() <= kOutputBatchSize;
+  }
+
+  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void close() override;
+
+ private:
+  static constexpr int32_t kOutputBatchSize = 10'000;
+
+  // Returns true if the key of 'input' at 'index' is the same as the key
+  // of 'previous' at 'previousIndex'.
+  bool sameGroup(
+      const RowVector& input,
+      vector_size_t index,
+      const RowVector& previous,
+      vector_size_t previousIndex) const;
+
+  // Returns true if any grouping key of 'input' is null at 'index'.
+  bool hasNullKey(const RowVector& input, vector_size_t index) const;
+
+  // Adds a group with the keys of the current input at 'index'.
+  void addGroup(vector_size_t index);
+
+  // Returns the rows of 'input' that are in a group and pass the mask
+  // of the aggregate at 'aggregateIndex', if any.
+  const SelectivityVector& prepareRows(
+      int32_t aggregateIndex,
+      const RowVectorPtr& input);
+
+  // Returns the first 'numGroups' groups and removes these from
+  // 'groups_'.
+  RowVectorPtr createOutput(int32_t numGroups);
+
+  const bool isRawInput_;
+  const bool isPartialOutput_;
+  const bool ignoreNullKeys_;
+
+  std::vector<ChannelIndex> groupingKeys_;
+  std::vector<std::unique_ptr<Aggregate>> aggregates_;
+  std::vector<std::vector<ChannelIndex>> args_;
+  std::vector<std::vector<VectorPtr>> constantArgs_;
+  std::vector<std::optional<ChannelIndex>> masks_;
+
+  // Holds the keys and accumulators of the groups in 'groups_'.
+  std::unique_ptr<RowContainer> rows_;
+
+  // The groups in order of appearance. The last one is not complete
+  // until the next group starts or the input ends.
+  std::vector<char*> groups_;
+
+  // The last batch that had a row in a group and the position of that
+  // row. Used to check whether the next batch continues the last group.
+  RowVectorPtr previousInput_;
+  vector_size_t previousIndex_{0};
+
+  std::vector<DecodedVector> decodedKeys_;
+
+  // The group of each row of the current input. nullptr for rows that
+  // are dropped for a null key.
+  std::vector<char*> inputGroups_;
+  std::vector<vector_size_t> newGroups_;
+  SelectivityVector activeRows_;
+  SelectivityVector maskedRows_;
+  DecodedVector decodedMask_;
+  std::vector<VectorPtr> tempVectors_;
+};
+
+} // namespace facebook::velox::exec
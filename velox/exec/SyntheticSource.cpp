@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/exec/SyntheticSource.h"
+
+#include <folly/hash/Hash.h>
+
+namespace facebook::velox::exec {
+
+namespace {
+template <typename T>
+void setValues(
+    BaseVector& vector,
+    const std::vector<int64_t>& numbers,
+    const std::string& prefix) {
+  auto flat = vector.asFlatVector<T>();
+  std::string buffer;
+  for (auto i = 0; i < vector.size(); ++i) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      buffer = prefix;
+      folly::toAppend(numbers[i], &buffer);
+      flat->set(i, StringView(buffer));
+    } else if constexpr (std::is_same_v<T, bool>) {
+      flat->set(i, numbers[i] & 1);
+    } else {
+      flat->set(i, static_cast<T>(numbers[i]));
+    }
+  }
+}
+} // namespace
+
+SyntheticSource::SyntheticSource(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    std::shared_ptr<const core::SyntheticSourceNode> syntheticSourceNode)
+    : SourceOperator(
+          driverCtx,
+          syntheticSourceNode->outputType(),
+          operatorId,
+          syntheticSourceNode->id(),
+          "SyntheticSource"),
+      columns_(syntheticSourceNode->columns()),
+      numRows_(syntheticSourceNode->rowsPerDriver()),
+      batchSize_(syntheticSourceNode->batchSize()),
+      firstRow_(driverCtx->driverId * numRows_),
+      rng_(folly::hash::hash_combine(
+          syntheticSourceNode->seed(),
+          driverCtx->driverId)),
+      dictionaries_(columns_.size()) {}
+
+RowVectorPtr SyntheticSource::getOutput() {
+  if (numGenerated_ >= numRows_) {
+    return nullptr;
+  }
+  auto size = std::min<uint64_t>(batchSize_, numRows_ - numGenerated_);
+  std::vector<VectorPtr> children(columns_.size());
+  for (auto i = 0; i < columns_.size(); ++i) {
+    children[i] = makeColumn(i, size);
+  }
+  numGenerated_ += size;
+  return std::make_shared<RowVector>(
+      pool(), outputType_, BufferPtr(nullptr), size, std::move(children));
+}
+
+void SyntheticSource::close() {
+  numGenerated_ = numRows_;
+  dictionaries_.clear();
+}
+
+void SyntheticSource::makeNumbers(
+    const core::SyntheticColumn& column,
+    vector_size_t size,
+    int64_t min,
+    int64_t max) {
+  numbers_.resize(size);
+  switch (column.distribution) {
+    case core::SyntheticColumn::Distribution::kSequence: {
+      // Unsigned arithmetic, as the range of [min, max] may not fit in
+      // int64_t. A range of 0 stands for the full 2^64 values.
+      uint64_t range = static_cast<uint64_t>(max) - min + 1;
+      auto row = firstRow_ + numGenerated_;
+      for (auto i = 0; i < size; ++i, ++row) {
+        numbers_[i] = min + (range == 0 ? row : row % range);
+      }
+      break;
+    }
+    case core::SyntheticColumn::Distribution::kUniform: {
+      std::uniform_int_distribution<int64_t> distribution(min, max);
+      for (auto i = 0; i < size; ++i) {
+        numbers_[i] = distribution(rng_);
+      }
+      break;
+    }
+    case core::SyntheticColumn::Distribution::kNormal: {
+      double stddev = (static_cast<double>(max) - min) / 6;
+      if (stddev == 0) {
+        std::fill(numbers_.begin(), numbers_.end(), min);
+        break;
+      }
+      std::normal_distribution<double> distribution(
+          min / 2.0 + max / 2.0, stddev);
+      for (auto i = 0; i < size; ++i) {
+        auto value = std::round(distribution(rng_));
+        if (value <= min) {
+          numbers_[i] = min;
+        } else if (value >= max) {
+          numbers_[i] = max;
+        } else {
+          numbers_[i] = value;
+        }
+      }
+      break;
+    }
+  }
+}
+
+BufferPtr SyntheticSource::makeNulls(
+    const core::SyntheticColumn& column,
+    vector_size_t size) {
+  if (column.nullRatio == 0) {
+    return nullptr;
+  }
+  auto nulls = AlignedBuffer::allocate<bool>(size, pool(), bits::kNotNull);
+  auto rawNulls = nulls->asMutable<uint64_t>();
+  std::bernoulli_distribution isNull(column.nullRatio);
+  for (auto i = 0; i < size; ++i) {
+    if (isNull(rng_)) {
+      bits::setNull(rawNulls, i);
+    }
+  }
+  return nulls;
+}
+
+VectorPtr SyntheticSource::makeFlat(
+    const core::SyntheticColumn& column,
+    const TypePtr& type,
+    vector_size_t size) {
+  auto vector = BaseVector::create(type, size, pool());
+  switch (type->kind()) {
+    case TypeKind::BOOLEAN:
+      setValues<bool>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::TINYINT:
+      setValues<int8_t>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::SMALLINT:
+      setValues<int16_t>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::INTEGER:
+      setValues<int32_t>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::BIGINT:
+      setValues<int64_t>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::REAL:
+      setValues<float>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::DOUBLE:
+      setValues<double>(*vector, numbers_, column.prefix);
+      break;
+    case TypeKind::VARCHAR:
+      setValues<StringView>(*vector, numbers_, column.prefix);
+      break;
+    default:
+      VELOX_UNSUPPORTED(
+          "Unsupported type of synthetic column: {}", type->toString());
+  }
+  return vector;
+}
+
+VectorPtr SyntheticSource::makeColumn(int32_t channel, vector_size_t size) {
+  const auto& column = columns_[channel];
+  const auto& type = outputType_->childAt(channel);
+  switch (column.encoding) {
+    case core::SyntheticColumn::Encoding::kFlat: {
+      makeNumbers(column, size, column.min, column.max);
+      auto vector = makeFlat(column, type, size);
+      if (auto nulls = makeNulls(column, size)) {
+        vector->setNulls(nulls);
+      }
+      return vector;
+    }
+    case core::SyntheticColumn::Encoding::kDictionary: {
+      auto& dictionary = dictionaries_[channel];
+      if (!dictionary) {
+        numbers_.resize(column.cardinality);
+        for (auto i = 0; i < column.cardinality; ++i) {
+          numbers_[i] = static_cast<uint64_t>(column.min) + i;
+        }
+        dictionary = makeFlat(column, type, column.cardinality);
+      }
+      makeNumbers(column, size, 0, column.cardinality - 1);
+      auto indices = AlignedBuffer::allocate<vector_size_t>(size, pool());
+      auto rawIndices = indices->asMutable<vector_size_t>();
+      std::copy(numbers_.begin(), numbers_.begin() + size, rawIndices);
+      return BaseVector::wrapInDictionary(
+          makeNulls(column, size), indices, size, dictionary);
+    }
+    case core::SyntheticColumn::Encoding::kConstant: {
+      if (column.nullRatio > 0 &&
+          std::bernoulli_distribution(column.nullRatio)(rng_)) {
+        return BaseVector::createNullConstant(type, size, pool());
+      }
+      makeNumbers(column, 1, column.min, column.max);
+      return BaseVector::wrapInConstant(size, 0, makeFlat(column, type, 1));
+    }
+  }
+  VELOX_UNREACHABLE();
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <random>
+
+#include "velox/core/PlanNode.h"
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+/// Generates the synthetic rows described by a SyntheticSourceNode. Each
+/// driver produces its own rows, so the node scales with the number of
+/// drivers.
+class SyntheticSource : public SourceOperator {
+ public:
+  SyntheticSource(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      std::shared_ptr<const core::SyntheticSourceNode> syntheticSourceNode);
+
+  RowVectorPtr getOutput() override;
+
+  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void finish() override {
+    Operator::finish();
+    close();
+  }
+
+  void close() override;
+
+ private:
+  // Fills 'numbers_' with the numbers of the next 'size' rows of 'column',
+  // drawn from [min, max].
+  void makeNumbers(
+      const core::SyntheticColumn& column,
+      vector_size_t size,
+      int64_t min,
+      int64_t max);
+
+  // Returns a null flag per row, or nullptr if no row is null.
+  BufferPtr makeNulls(const core::SyntheticColumn& column, vector_size_t size);
+
+  VectorPtr makeColumn(int32_t channel, vector_size_t size);
+
+  // Returns a flat vector with the values of 'numbers_'.
+  VectorPtr makeFlat(
+      const core::SyntheticColumn& column,
+      const TypePtr& type,
+      vector_size_t size);
+
+  const std::vector<core::SyntheticColumn> columns_;
+  const uint64_t numRows_;
+  const vector_size_t batchSize_;
+  // Number of the first row of this driver across all drivers.
+  const uint64_t firstRow_;
+  uint64_t numGenerated_{0};
+  std::mt19937_64 rng_;
+  // Dictionary bases of the columns with kDictionary encoding, made with the
+  // first batch.
+  std::vector<VectorPtr> dictionaries_;
+  std::vector<int64_t> numbers_;
+};
+
+} // namespace facebook::velox::exec
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/exec/TableScan.h"
+#include "velox/exec/FragmentResultCache.h"
 #include "velox/exec/Task.h"
 #include "velox/expression/Expr.h"
 
@@ -43,11 +44,16 @@ RowVectorPtr TableScan::getOutput() {
   for (;;) {
     if (needNewSplit_) {
       exec::Split split;
-      auto reason = driverCtx_->task->getSplitOrFuture(
-          planNodeId_, split, blockingFuture_);
-      if (reason != BlockingReason::kNotBlocked) {
-        hasBlockingFuture_ = true;
-        return nullptr;
+      if (!preloadedSplits_.empty()) {
+        split = std::move(preloadedSplits_.front());
+        preloadedSplits_.pop_front();
+      } else {
+        auto reason = driverCtx_->task->getSplitOrFuture(
+            planNodeId_, split, blockingFuture_);
+        if (reason != BlockingReason::kNotBlocked) {
+          hasBlockingFuture_ = true;
+          return nullptr;
+        }
       }
 
       if (!split.hasConnectorSplit()) {
@@ -66,6 +72,21 @@ RowVectorPtr TableScan::getOutput() {
       currentSplitGroupId_ = split.groupId;
       needNewSplit_ = false;
 
+      if (auto* resultCache = driverCtx_->fragmentResultCache.get()) {
+        if (resultCache->startSplit(*connectorSplit, pool())) {
+          // The aggregation downstream returns the cached result.
+          if (connectorSplit->dataSource) {
+            connectorSplit->dataSource->close();
+          }
+          ++stats_.numSplits;
+          stats_.addRuntimeStat("fragmentResultCacheHits", 1);
+          driverCtx_->task->splitFinished(planNodeId_, currentSplitGroupId_);
+          currentSplitGroupId_ = -1;
+          needNewSplit_ = true;
+          continue;
+        }
+      }
+
       if (!connector_) {
         connector_ = connector::getConnector(connectorSplit->connectorId);
         connectorQueryCtx_ = driverCtx_->createConnectorQueryCtx(
@@ -85,11 +106,12 @@ RowVectorPtr TableScan::getOutput() {
             "Got splits with different connector IDs");
       }
 
-      dataSource_->addSplit(connectorSplit);
+      addSplit(connectorSplit);
       ++stats_.numSplits;
+      preloadSplits();
     }
 
-    auto data = dataSource_->next(kDefaultBatchSize);
+    auto data = dataSource_->next(outputBatchRows(estimateRowSize()));
     stats_.rawInputPositions = dataSource_->getCompletedRows();
     stats_.rawInputBytes = dataSource_->getCompletedBytes();
     if (data) {
@@ -107,9 +129,77 @@ RowVectorPtr TableScan::getOutput() {
   }
 }
 
+std::optional<uint64_t> TableScan::estimateRowSize() const {
+  std::optional<uint64_t> rowSize;
+  if (stats_.rawInputPositions > 0) {
+    rowSize = stats_.rawInputBytes / stats_.rawInputPositions;
+  }
+  if (stats_.inputPositions > 0) {
+    rowSize = std::max<uint64_t>(
+        rowSize.value_or(0), stats_.inputBytes / stats_.inputPositions);
+  }
+  return rowSize;
+}
+
+void TableScan::addSplit(
+    const std::shared_ptr<connector::ConnectorSplit>& connectorSplit) {
+  std::shared_ptr<connector::DataSource> preparedSource;
+  if (connectorSplit->dataSource) {
+    // Waits if the split is still being prepared in the background.
+    preparedSource = connectorSplit->dataSource->move();
+    connectorSplit->dataSource = nullptr;
+  }
+  if (!preparedSource) {
+    dataSource_->addSplit(connectorSplit);
+    return;
+  }
+  dataSource_->setFromDataSource(std::move(preparedSource));
+  // 'preparedSource' was made before some or all of the dynamic
+  // filters arrived.
+  for (const auto& [channel, filter] : dynamicFilters_) {
+    dataSource_->addDynamicFilter(channel, filter);
+  }
+}
+
+void TableScan::preloadSplits() {
+  auto* executor = connector_->executor();
+  if (!executor || !connector_->supportsSplitPreload()) {
+    return;
+  }
+  auto maxPreload = operatorCtx_->queryCtx()->maxSplitPreloadPerDriver();
+  while (static_cast<int32_t>(preloadedSplits_.size()) < maxPreload) {
+    exec::Split split;
+    if (!driverCtx_->task->getSplitIfAvailable(planNodeId_, split)) {
+      return;
+    }
+    auto connectorSplit = split.connectorSplit;
+    if (connectorSplit &&
+        connectorSplit->connectorId == connector_->connectorId()) {
+      // The source refers to members of 'this'. close() waits for a
+      // make in progress and cancels the rest.
+      connectorSplit->dataSource =
+          std::make_shared<AsyncSource<connector::DataSource>>(
+              [this, connectorSplit]() {
+                auto source = connector_->createDataSource(
+                    outputType_,
+                    tableHandle_,
+                    columnHandles_,
+                    connectorQueryCtx_.get());
+                source->addSplit(connectorSplit);
+                return source;
+              });
+      executor->add([source = connectorSplit->dataSource]() {
+        source->prepare();
+      });
+    }
+    preloadedSplits_.push_back(std::move(split));
+  }
+}
+
 void TableScan::addDynamicFilter(
     ChannelIndex outputChannel,
     const std::shared_ptr<common::Filter>& filter) {
+  dynamicFilters_.emplace_back(outputChannel, filter);
   if (dataSource_) {
     dataSource_->addDynamicFilter(outputChannel, filter);
   } else {
@@ -118,7 +208,25 @@ void TableScan::addDynamicFilter(
 }
 
 void TableScan::close() {
-  // TODO Implement
+  for (auto& split : preloadedSplits_) {
+    if (split.hasConnectorSplit() && split.connectorSplit->dataSource) {
+      split.connectorSplit->dataSource->close();
+    }
+  }
+  preloadedSplits_.clear();
+  if (dataSource_ && !noMoreSplits_) {
+    // Finished before the splits ran out, e.g. a Limit downstream has
+    // enough rows. Freeing the DataSource now cancels the loads it has
+    // scheduled in the background instead of waiting for the Driver to
+    // be destroyed.
+    auto connectorStats = dataSource_->runtimeStats();
+    for (const auto& entry : connectorStats) {
+      stats_.runtimeStats[entry.first].addValue(entry.second);
+    }
+    stats_.addRuntimeStat("earlyFinish", 1);
+    dataSource_ = nullptr;
+  }
+  noMoreSplits_ = true;
 }
 
 } // namespace facebook::velox::exec
@@ -56,7 +56,21 @@ class TableScan : public SourceOperator {
   void close() override;
 
  private:
-  static constexpr int32_t kDefaultBatchSize = 1024;
+  // Returns the average width of the rows read so far, std::nullopt
+  // before the first batch. This is the larger of the storage bytes
+  // per row and the size of the returned vectors per row, since the
+  // first may be compressed and the second may not be loaded yet.
+  std::optional<uint64_t> estimateRowSize() const;
+
+  // Adds 'connectorSplit' to 'dataSource_', taking over the DataSource
+  // prepared for it in the background, if any.
+  void addSplit(
+      const std::shared_ptr<connector::ConnectorSplit>& connectorSplit);
+
+  // Fetches queued splits up to the preload limit into
+  // 'preloadedSplits_' and starts preparing their DataSources on the
+  // connector's executor.
+  void preloadSplits();
 
   const core::PlanNodeId planNodeId_;
   const std::shared_ptr<connector::ConnectorTableHandle> tableHandle_;
@@ -76,5 +90,12 @@ class TableScan : public SourceOperator {
   // Dynamic filters to add to the data source when it gets created.
   std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>
       pendingDynamicFilters_;
+  // All dynamic filters received so far, in arrival order. Added again
+  // after taking over a DataSource prepared in the background.
+  std::vector<std::pair<ChannelIndex, std::shared_ptr<common::Filter>>>
+      dynamicFilters_;
+  // Splits fetched ahead of need. Their DataSources are being prepared
+  // in the background.
+  std::deque<exec::Split> preloadedSplits_;
 };
 } // namespace facebook::velox::exec
@@ -36,9 +36,8 @@ TableWriter::TableWriter(
       driverCtx_(driverCtx),
       insertTableHandle_(
           tableWriteNode->insertTableHandle()->connectorInsertTableHandle()) {
-  // For the time being the table writer supports one file
-  // To extend it we can create a new data sink for each
-  // partition
+  // The data sink decides which files the rows go to, e.g. one per
+  // partition.
   const auto& connectorId = tableWriteNode->insertTableHandle()->connectorId();
   connector_ = connector::getConnector(connectorId);
   connectorQueryCtx_ =
@@ -62,6 +61,15 @@ void TableWriter::createDataSink() {
       mappedType_, insertTableHandle_, connectorQueryCtx_.get());
 }
 
+BlockingReason TableWriter::isBlocked(ContinueFuture* future) {
+  auto writeFuture = folly::SemiFuture<folly::Unit>::makeEmpty();
+  if (!dataSink_ || closed_ || !dataSink_->isBlocked(&writeFuture)) {
+    return BlockingReason::kNotBlocked;
+  }
+  *future = std::move(writeFuture).deferValue([](auto&&) { return true; });
+  return BlockingReason::kWaitForConsumer;
+}
+
 void TableWriter::addInput(RowVectorPtr input) {
   if (input->size() == 0) {
     return;
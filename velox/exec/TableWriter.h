@@ -31,9 +31,8 @@ class TableWriter : public Operator {
       DriverCtx* driverCtx,
       const std::shared_ptr<const core::TableWriteNode>& tableWriteNode);
 
-  BlockingReason isBlocked(ContinueFuture* /* future */) override {
-    return BlockingReason::kNotBlocked;
-  }
+  // Blocked while the data sink has too much written data in flight.
+  BlockingReason isBlocked(ContinueFuture* future) override;
 
   void addInput(RowVectorPtr input) override;
 
@@ -57,6 +56,10 @@ class TableWriter : public Operator {
 
   RowVectorPtr getOutput() override;
 
+  uint64_t reclaim(uint64_t bytes) override {
+    return dataSink_ && !closed_ ? dataSink_->reclaim(bytes) : 0;
+  }
+
  private:
   void createDataSink();
 
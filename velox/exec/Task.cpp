@@ -14,20 +14,84 @@
  * limitations under the License.
  */
 #include "velox/exec/Task.h"
+#include <folly/executors/QueuedImmediateExecutor.h>
+#include <condition_variable>
 #include "velox/codegen/Codegen.h"
 #include "velox/common/time/Timer.h"
 #include "velox/exec/CrossJoinBuild.h"
 #include "velox/exec/Exchange.h"
 #include "velox/exec/HashBuild.h"
+#include "velox/exec/HashTableCache.h"
 #include "velox/exec/LocalPlanner.h"
+#include "velox/exec/MemoryArbitrator.h"
 #include "velox/exec/Merge.h"
+#include "velox/exec/MergeJoin.h"
 #include "velox/exec/PartitionedOutputBufferManager.h"
+#include "velox/exec/SharedAggregation.h"
 #if CODEGEN_ENABLED == 1
 #include "velox/experimental/codegen/CodegenLogger.h"
 #endif
 
 namespace facebook::velox::exec {
 
+namespace {
+// Calls 'func' for each index in [0, 'count') on the calling thread and
+// on up to 'count' - 1 threads of 'executor'. The calling thread takes
+// part, so that this finishes even if no thread of 'executor' is free,
+// e.g. when called from a Driver. Rethrows the first error.
+void parallelFor(
+    folly::Executor* executor,
+    int32_t count,
+    const std::function<void(int32_t)>& func) {
+  if (!executor || count < 2) {
+    for (auto i = 0; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+  struct State {
+    std::atomic<int32_t> next{0};
+    int32_t numDone{0};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable allDone;
+  };
+  auto state = std::make_shared<State>();
+  // A helper that starts after all indices are taken returns without
+  // calling 'func', so 'func' is not referenced after return.
+  auto work = [state, count, &func]() {
+    for (;;) {
+      auto i = state->next++;
+      if (i >= count) {
+        return;
+      }
+      std::exception_ptr error;
+      try {
+        func(i);
+      } catch (const std::exception&) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> l(state->mutex);
+      if (error && !state->error) {
+        state->error = error;
+      }
+      if (++state->numDone == count) {
+        state->allDone.notify_all();
+      }
+    }
+  };
+  for (auto i = 1; i < count; ++i) {
+    executor->add(work);
+  }
+  work();
+  std::unique_lock<std::mutex> l(state->mutex);
+  state->allDone.wait(l, [&]() { return state->numDone == count; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+} // namespace
+
 Task::Task(
     const std::string& taskId,
     std::shared_ptr<const core::PlanNode> planNode,
@@ -43,7 +107,12 @@ Task::Task(
       onError_(onError),
       pool_(queryCtx_->pool()->addScopedChild("task_root")),
       bufferManager_(
-          PartitionedOutputBufferManager::getInstance(queryCtx_->host())) {}
+          PartitionedOutputBufferManager::getInstance(queryCtx_->host())) {
+  if (auto eventsPerThread = queryCtx_->traceEventsPerThread()) {
+    traceRecorder_ =
+        std::make_shared<process::TraceRecorder>(eventsPerThread);
+  }
+}
 
 Task::~Task() {
   try {
@@ -57,7 +126,10 @@ Task::~Task() {
   }
 }
 
-void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
+void Task::start(
+    std::shared_ptr<Task> self,
+    uint32_t maxDrivers,
+    uint32_t numSplitGroups) {
   VELOX_CHECK(self->drivers_.empty());
   {
     std::lock_guard<std::mutex> l(self->mutex_);
@@ -81,43 +153,95 @@ void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
   LocalPlanner::plan(
       self->planNode_, self->consumerSupplier(), &self->driverFactories_);
 
+  if (self->queryCtx_->hashTableCacheEnabled()) {
+    std::lock_guard<std::mutex> l(self->mutex_);
+    self->addCachedBuildsLocked(*self->planNode_);
+  }
+
+  self->maxDrivers_ = maxDrivers;
+  if (numSplitGroups) {
+    std::lock_guard<std::mutex> l(self->mutex_);
+    self->numSplitGroups_ = numSplitGroups;
+    // Sort the splits added before the start into their groups.
+    for (auto& [planNodeId, splitsState] : self->splitsStates_) {
+      auto splits = std::move(splitsState.splits);
+      splitsState.splits.clear();
+      for (auto& split : splits) {
+        self->queueSplitLocked(splitsState, std::move(split));
+      }
+    }
+  }
   for (auto& factory : self->driverFactories_) {
-    self->numDrivers_ += std::min(factory->maxDrivers, maxDrivers);
+    self->numDriversPerGroup_ += std::min(factory->maxDrivers, maxDrivers);
   }
+  self->numDrivers_ =
+      self->numDriversPerGroup_ * std::max<uint32_t>(1, numSplitGroups);
   self->taskStats_.pipelineStats.resize(self->driverFactories_.size());
   // Register self for possible memory recovery callback. Do this
   // after sizing 'drivers_' but before starting the
   // Drivers. 'drivers_' can be read by memory recovery or
   // cancellation while Drivers are being made, so the array should
   // have final size from the start.
+  if (self->queryCtx_->memoryArbitrationEnabled()) {
+    MemoryArbitrator::getInstance()->addTask(self);
+  }
 
+  if (numSplitGroups) {
+    startSplitGroup(self, 0);
+    return;
+  }
+  auto drivers = createDrivers(self);
+  // Set and start all Drivers together inside the CancelPool so that
+  // cancellations and pauses have well
+  // defined timing. For example, do not pause and restart a task
+  // while it is still adding Drivers.
+  std::lock_guard<std::mutex> l(*self->cancelPool()->mutex());
+  self->drivers_ = std::move(drivers);
+  for (auto& driver : self->drivers_) {
+    if (driver) {
+      Driver::enqueue(driver);
+    }
+  }
+}
+
+// static
+std::vector<std::shared_ptr<Driver>> Task::createDrivers(
+    const std::shared_ptr<Task>& self) {
   auto bufferManager = self->bufferManager_.lock();
   VELOX_CHECK_NOT_NULL(
       bufferManager,
       "Unable to initialize task. "
       "PartitionedOutputBufferManager was already destructed");
 
+  const bool isFirstGroup = self->currentSplitGroup_ <= 0;
+  const auto maxDrivers = self->maxDrivers_;
   std::vector<std::shared_ptr<Driver>> drivers;
-  drivers.reserve(self->numDrivers_);
+  drivers.reserve(self->numDriversPerGroup_);
   for (auto pipeline = 0; pipeline < self->driverFactories_.size();
        ++pipeline) {
     auto& factory = self->driverFactories_[pipeline];
     auto numDrivers = std::min(factory->maxDrivers, maxDrivers);
     auto partitionedOutputNode = factory->needsPartitionedOutput();
-    if (partitionedOutputNode) {
+    if (partitionedOutputNode && isFirstGroup) {
       VELOX_CHECK(
           !self->hasPartitionedOutput_,
           "Only one output pipeline per task is supported");
       self->hasPartitionedOutput_ = true;
+      // The output buffers are at end when the output Drivers of all
+      // split groups are finished.
       bufferManager->initializeTask(
           self,
           partitionedOutputNode->isBroadcast(),
           partitionedOutputNode->numPartitions(),
-          numDrivers);
+          numDrivers * std::max<int32_t>(1, self->numSplitGroups_));
     }
 
     std::shared_ptr<ExchangeClient> exchangeClient = nullptr;
     if (factory->needsExchangeClient()) {
+      VELOX_CHECK_EQ(
+          self->numSplitGroups_,
+          0,
+          "Grouped execution does not support remote exchanges");
       exchangeClient = self->addExchangeClient();
     }
 
@@ -128,33 +252,63 @@ void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
 
     self->addHashJoinBridges(factory->needsHashJoinBridges());
     self->addCrossJoinBridges(factory->needsCrossJoinBridges());
-
-    for (int32_t i = 0; i < numDrivers; ++i) {
-      drivers.push_back(factory->createDriver(
-          std::make_unique<DriverCtx>(self, i, pipeline, numDrivers),
-          exchangeClient,
-          [self, maxDrivers](size_t i) {
-            return i < self->driverFactories_.size()
-                ? std::min(self->driverFactories_[i]->maxDrivers, maxDrivers)
-                : 0;
-          }));
-      if (i == 0) {
-        drivers.back()->initializeOperatorStats(
-            self->taskStats_.pipelineStats[pipeline].operatorStats);
-      }
+    self->addMergeJoinSources(factory->needsMergeJoinSources());
+
+    // The Drivers of a pipeline only share state of 'self' that is
+    // made above, so they can be made in parallel. This is most of the
+    // startup time of a Task with many Drivers and expressions to
+    // compile.
+    const auto firstDriver = drivers.size();
+    drivers.resize(firstDriver + numDrivers);
+    parallelFor(
+        self->queryCtx_->parallelDriverCreationEnabled()
+            ? self->queryCtx_->executor()
+            : nullptr,
+        numDrivers,
+        [&](int32_t i) {
+          drivers[firstDriver + i] = factory->createDriver(
+              std::make_unique<DriverCtx>(self, i, pipeline, numDrivers),
+              exchangeClient,
+              [self, maxDrivers](size_t i) {
+                return i < self->driverFactories_.size()
+                    ? std::min(
+                          self->driverFactories_[i]->maxDrivers, maxDrivers)
+                    : 0;
+              });
+        });
+    if (isFirstGroup && numDrivers > 0) {
+      drivers[firstDriver]->initializeOperatorStats(
+          self->taskStats_.pipelineStats[pipeline].operatorStats);
     }
   }
   self->noMoreLocalExchangeProducers();
-  // Set and start all Drivers together inside the CancelPool so that
-  // cancellations and pauses have well
-  // defined timing. For example, do not pause and restart a task
-  // while it is still adding Drivers.
+  return drivers;
+}
+
+// static
+void Task::startSplitGroup(
+    const std::shared_ptr<Task>& self,
+    int32_t splitGroupId) {
+  {
+    std::lock_guard<std::mutex> l(self->mutex_);
+    if (self->state_ != kRunning) {
+      return;
+    }
+    // The Drivers of the previous group are gone. Free what they
+    // shared, e.g. the hash tables of the joins.
+    self->currentSplitGroup_ = splitGroupId;
+    self->bridges_.clear();
+    self->sharedAggregations_.clear();
+    self->localExchanges_.clear();
+    self->localMergeSources_.clear();
+  }
+  auto drivers = createDrivers(self);
+
   std::lock_guard<std::mutex> l(*self->cancelPool()->mutex());
+  self->numSplitGroupDrivers_ = drivers.size();
   self->drivers_ = std::move(drivers);
   for (auto& driver : self->drivers_) {
-    if (driver) {
-      Driver::enqueue(driver);
-    }
+    Driver::enqueue(driver);
   }
 }
 
@@ -189,17 +343,67 @@ void Task::resume(std::shared_ptr<Task> self) {
   }
 }
 
+// static
+uint64_t Task::reclaim(
+    std::shared_ptr<Task> self,
+    uint64_t bytes,
+    const Driver* requester) {
+  if (self->state() != kRunning) {
+    return 0;
+  }
+  self->cancelPool_->requestPause(true);
+  auto& executor = folly::QueuedImmediateExecutor::instance();
+  self->cancelPool_->finishFuture().via(&executor).wait();
+
+  std::vector<std::shared_ptr<Driver>> drivers;
+  {
+    std::lock_guard<std::mutex> l(*self->cancelPool()->mutex());
+    drivers = self->drivers_;
+  }
+  uint64_t freed = 0;
+  try {
+    for (auto& driver : drivers) {
+      if (freed >= bytes) {
+        break;
+      }
+      if (!driver || driver.get() == requester) {
+        continue;
+      }
+      freed += driver->reclaim(bytes - freed);
+    }
+  } catch (const std::exception&) {
+    // The Task is left paused. The error terminates it.
+    self->setError(std::current_exception());
+    return freed;
+  }
+  Task::resume(self);
+  return freed;
+}
+
 // static
 void Task::removeDriver(std::shared_ptr<Task> self, Driver* driver) {
-  std::lock_guard<std::mutex> cancelPoolLock(*self->cancelPool()->mutex());
-  for (auto& driverPtr : self->drivers_) {
-    if (driverPtr.get() == driver) {
-      driverPtr = nullptr;
-      self->driverClosed();
-      return;
+  int32_t nextGroup = -1;
+  {
+    std::lock_guard<std::mutex> cancelPoolLock(*self->cancelPool()->mutex());
+    auto it = std::find_if(
+        self->drivers_.begin(),
+        self->drivers_.end(),
+        [&](const auto& driverPtr) { return driverPtr.get() == driver; });
+    VELOX_CHECK(
+        it != self->drivers_.end(),
+        "Trying to delete a Driver twice from its Task");
+    *it = nullptr;
+    self->driverClosed();
+    if (self->numSplitGroups_ && --self->numSplitGroupDrivers_ == 0 &&
+        self->currentSplitGroup_ + 1 < self->numSplitGroups_) {
+      nextGroup = self->currentSplitGroup_ + 1;
     }
   }
-  VELOX_FAIL("Trying to delete a Driver twice from its Task");
+  // The Drivers of the next group are made outside of the CancelPool
+  // mutex since their Operators call back into 'self'.
+  if (nextGroup != -1) {
+    startSplitGroup(self, nextGroup);
+  }
 }
 
 void Task::setMaxSplitSequenceId(
@@ -245,18 +449,42 @@ void Task::addSplitLocked(SplitsState& splitsState, exec::Split&& split) {
   ++taskStats_.numTotalSplits;
   ++taskStats_.numQueuedSplits;
 
-  splitsState.splits.push_back(split);
+  if (!splitsState.cachedBuildJoinId.empty()) {
+    auto key = split.hasGroup() || !split.connectorSplit
+        ? ""
+        : split.connectorSplit->cacheKey();
+    if (key.empty()) {
+      splitsState.cachedBuildJoinId.clear();
+    } else {
+      splitsState.splitCacheKeys.push_back(std::move(key));
+    }
+  }
 
   if (split.hasGroup()) {
     ++splitsState.groupSplits[split.groupId].numIncompleteSplits;
   }
 
+  queueSplitLocked(splitsState, std::move(split));
+
   if (not splitsState.splitPromises.empty()) {
     splitsState.splitPromises.back().setValue(false);
     splitsState.splitPromises.pop_back();
   }
 }
 
+void Task::queueSplitLocked(SplitsState& splitsState, exec::Split&& split) {
+  if (!numSplitGroups_) {
+    splitsState.splits.push_back(std::move(split));
+    return;
+  }
+  VELOX_CHECK(
+      split.groupId >= 0 && split.groupId < numSplitGroups_,
+      "Split group {} is not in [0, {}) in grouped execution",
+      split.groupId,
+      numSplitGroups_);
+  splitsState.groupedSplits[split.groupId].push_back(std::move(split));
+}
+
 void Task::noMoreSplitsForGroup(
     const core::PlanNodeId& planNodeId,
     int32_t splitGroupId) {
@@ -268,9 +496,71 @@ void Task::noMoreSplitsForGroup(
       splitsState.groupSplits,
       splitGroupId,
       splitsState.groupSplits.find(splitGroupId));
+  if (numSplitGroups_) {
+    splitsState.noMoreSplitsGroups.insert(splitGroupId);
+    if (splitGroupId == currentSplitGroup_) {
+      for (auto& promise : splitsState.splitPromises) {
+        promise.setValue(false);
+      }
+      splitsState.splitPromises.clear();
+    }
+  }
+}
+
+void Task::addCachedBuildsLocked(const core::PlanNode& planNode) {
+  if (auto join = dynamic_cast<const core::HashJoinNode*>(&planNode)) {
+    auto scanId = HashTableCache::cacheableBuildScan(*join);
+    if (!scanId.empty()) {
+      auto& splitsState = splitsStates_[scanId];
+      splitsState.cachedBuildJoinId = join->id();
+      splitsState.cachedBuildFingerprint = HashTableCache::fingerprint(*join);
+    }
+  }
+  for (auto& source : planNode.sources()) {
+    addCachedBuildsLocked(*source);
+  }
+}
+
+void Task::lookupCachedBuild(const core::PlanNodeId& planNodeId) {
+  std::shared_ptr<HashJoinBridge> bridge;
+  std::string key;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto& splitsState = splitsStates_[planNodeId];
+    if (splitsState.cachedBuildJoinId.empty() || splitsState.noMoreSplits) {
+      return;
+    }
+    auto it = bridges_.find(splitsState.cachedBuildJoinId);
+    if (it == bridges_.end()) {
+      return;
+    }
+    bridge = std::dynamic_pointer_cast<HashJoinBridge>(it->second);
+    key = HashTableCache::makeKey(
+        splitsState.cachedBuildFingerprint, splitsState.splitCacheKeys);
+  }
+
+  // The build side cannot finish before it has no more splits, so the
+  // bridge gets the cached table before any table of the build
+  // side. The bridge is called outside of 'mutex_' since it realizes
+  // the promises of the HashProbes.
+  auto table = HashTableCache::getInstance()->find(key);
+  if (!table) {
+    bridge->setHashTableCacheKey(std::move(key));
+    return;
+  }
+  bridge->setCachedHashTable(std::move(table));
+
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& splitsState = splitsStates_[planNodeId];
+  const auto numDropped = splitsState.splits.size();
+  splitsState.splits.clear();
+  taskStats_.numQueuedSplits -= numDropped;
+  taskStats_.numFinishedSplits += numDropped;
 }
 
 void Task::noMoreSplits(const core::PlanNodeId& planNodeId) {
+  lookupCachedBuild(planNodeId);
+
   std::lock_guard<std::mutex> l(mutex_);
 
   auto& splitsState = splitsStates_[planNodeId];
@@ -300,8 +590,10 @@ BlockingReason Task::getSplitOrFuture(
   std::lock_guard<std::mutex> l(mutex_);
 
   auto& splitsState = splitsStates_[planNodeId];
-  if (splitsState.splits.empty()) {
-    if (splitsState.noMoreSplits) {
+  if (runnableSplitsLocked(splitsState).empty()) {
+    if (splitsState.noMoreSplits ||
+        (numSplitGroups_ &&
+         splitsState.noMoreSplitsGroups.count(currentSplitGroup_))) {
       return BlockingReason::kNotBlocked;
     }
     auto [splitPromise, splitFuture] = makeVeloxPromiseContract<bool>(
@@ -311,8 +603,34 @@ BlockingReason Task::getSplitOrFuture(
     return BlockingReason::kWaitForSplit;
   }
 
-  split = std::move(splitsState.splits.front());
-  splitsState.splits.pop_front();
+  takeSplitLocked(splitsState, split);
+  return BlockingReason::kNotBlocked;
+}
+
+bool Task::getSplitIfAvailable(
+    const core::PlanNodeId& planNodeId,
+    exec::Split& split) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& splitsState = splitsStates_[planNodeId];
+  if (runnableSplitsLocked(splitsState).empty()) {
+    return false;
+  }
+  takeSplitLocked(splitsState, split);
+  return true;
+}
+
+std::deque<exec::Split>& Task::runnableSplitsLocked(
+    SplitsState& splitsState) {
+  if (numSplitGroups_) {
+    return splitsState.groupedSplits[currentSplitGroup_];
+  }
+  return splitsState.splits;
+}
+
+void Task::takeSplitLocked(SplitsState& splitsState, exec::Split& split) {
+  auto& splits = runnableSplitsLocked(splitsState);
+  split = std::move(splits.front());
+  splits.pop_front();
 
   --taskStats_.numQueuedSplits;
   ++taskStats_.numRunningSplits;
@@ -321,8 +639,6 @@ BlockingReason Task::getSplitOrFuture(
     taskStats_.firstSplitStartTimeMs = getCurrentTimeMs();
   }
   taskStats_.lastSplitStartTimeMs = getCurrentTimeMs();
-
-  return BlockingReason::kNotBlocked;
 }
 
 void Task::splitFinished(
@@ -411,10 +727,20 @@ void Task::driverClosed() {
 }
 
 std::shared_ptr<ExchangeClient> Task::addExchangeClient() {
-  exchangeClients_.emplace_back(std::make_shared<ExchangeClient>(destination_));
+  exchangeClients_.emplace_back(std::make_shared<ExchangeClient>(
+      destination_,
+      queryCtx_->maxExchangeClientBufferSize(),
+      traceRecorder_));
   return exchangeClients_.back();
 }
 
+std::string Task::toChromeTrace() const {
+  if (!traceRecorder_) {
+    return "";
+  }
+  return traceRecorder_->toChromeTrace(taskId_);
+}
+
 bool Task::allPeersFinished(
     const core::PlanNodeId& planNodeId,
     Driver* caller,
@@ -497,6 +823,42 @@ std::shared_ptr<CrossJoinBridge> Task::getCrossJoinBridge(
   return bridge;
 }
 
+std::shared_ptr<SharedAggregation> Task::getSharedAggregation(
+    const core::PlanNodeId& planNodeId,
+    int32_t numPartitions) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& shared = sharedAggregations_[planNodeId];
+  if (!shared) {
+    shared = std::make_shared<SharedAggregation>(numPartitions);
+  }
+  VELOX_CHECK_EQ(shared->numPartitions(), numPartitions);
+  return shared;
+}
+
+void Task::addMergeJoinSources(
+    const std::vector<core::PlanNodeId>& planNodeIds) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (const auto& planNodeId : planNodeIds) {
+    bridges_.emplace(planNodeId, std::make_shared<MergeJoinSource>());
+  }
+}
+
+std::shared_ptr<MergeJoinSource> Task::getMergeJoinSource(
+    const core::PlanNodeId& planNodeId) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = bridges_.find(planNodeId);
+  VELOX_CHECK(
+      it != bridges_.end(),
+      "Merge join source for plan node ID not found: {}",
+      planNodeId);
+  auto source = std::dynamic_pointer_cast<MergeJoinSource>(it->second);
+  VELOX_CHECK_NOT_NULL(
+      source,
+      "Join bridge for plan node ID is not a merge join source: {}",
+      planNodeId);
+  return source;
+}
+
 //  static
 std::string Task::shortId(const std::string& id) {
   if (id.size() < 12) {
@@ -537,10 +899,30 @@ void Task::terminate(TaskState terminalState) {
       bufferManager->removeTask(taskId_);
     }
   }
-  // Release reference to exchange client, so that it will close exchange
-  // sources and prevent resending requests for data.
+  // Close the exchange clients, so that pending requests are abandoned,
+  // queued pages are freed and the waiting Exchanges continue, then
+  // release them. Closing a source may call into the producer, so this
+  // is done outside of 'mutex_'.
+  std::vector<std::shared_ptr<ExchangeClient>> exchangeClients;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    exchangeClients = std::move(exchangeClients_);
+    exchangeClients_.clear();
+  }
+  for (auto& client : exchangeClients) {
+    client->close();
+  }
+  exchangeClients.clear();
+
   std::lock_guard<std::mutex> l(mutex_);
-  exchangeClients_.clear();
+  // Free the data buffered in local exchanges and continue the Drivers
+  // waiting for data or for space.
+  for (auto& pair : localExchanges_) {
+    pair.second.memoryManager->cancel();
+    for (auto& source : pair.second.sources) {
+      source->cancel();
+    }
+  }
   for (auto& pair : splitsStates_) {
     for (auto& promise : pair.second.splitPromises) {
       promise.setValue(true);
@@ -15,6 +15,7 @@
  */
 #pragma once
 #include <limits>
+#include "velox/common/process/TraceRecorder.h"
 #include "velox/core/QueryCtx.h"
 #include "velox/exec/Driver.h"
 #include "velox/exec/LocalPartition.h"
@@ -69,6 +70,8 @@ struct TaskStats {
 class JoinBridge;
 class HashJoinBridge;
 class CrossJoinBridge;
+class MergeJoinSource;
+class SharedAggregation;
 
 class Task {
  public:
@@ -102,12 +105,18 @@ class Task {
     return taskId_;
   }
 
+  // Thread-safe. Drivers may be made in parallel.
   velox::memory::MemoryPool* FOLLY_NONNULL addDriverPool() {
+    std::lock_guard<std::mutex> l(childPoolsMutex_);
     childPools_.push_back(pool_->addScopedChild("driver_root"));
     auto* driverPool = childPools_.back().get();
     auto parentTracker = pool_->getMemoryUsageTracker();
     if (parentTracker) {
-      driverPool->setMemoryUsageTracker(parentTracker->addChild());
+      driverPool->setMemoryUsageTracker(parentTracker->addChild(
+          false,
+          memory::MemoryUsageConfigBuilder()
+              .updateBatchBytes(queryCtx_->memoryUsageUpdateBatchBytes())
+              .build()));
     }
 
     return driverPool;
@@ -115,16 +124,37 @@ class Task {
 
   velox::memory::MemoryPool* FOLLY_NONNULL
   addOperatorPool(velox::memory::MemoryPool* FOLLY_NONNULL driverPool) {
+    std::lock_guard<std::mutex> l(childPoolsMutex_);
     childPools_.push_back(driverPool->addScopedChild("operator_ctx"));
     return childPools_.back().get();
   }
 
-  static void start(std::shared_ptr<Task> self, uint32_t maxDrivers);
+  // Makes and starts the Drivers of 'self', at most 'maxDrivers' per
+  // pipeline. A non-zero 'numSplitGroups' selects grouped execution:
+  // every split has a group id in [0, numSplitGroups) and the pipelines
+  // run once per group, one group after the other, each on the splits
+  // of its group only. The joins and aggregations of a group thus make
+  // their own small tables, which are freed when the group is done
+  // and before the next group starts. This is for tables bucketed the
+  // same way on the join and grouping keys. Grouped execution does not
+  // support remote exchanges.
+  static void start(
+      std::shared_ptr<Task> self,
+      uint32_t maxDrivers,
+      uint32_t numSplitGroups = 0);
 
   // Resumes execution of 'self' after a successful pause. All 'drivers_' must
   // be off-thread and there must be no 'exception_'
   static void resume(std::shared_ptr<Task> self);
 
+  // Pauses 'self', asks the Operators of its Drivers to free up to
+  // 'bytes' bytes of memory and resumes 'self'. The Operators of
+  // 'requester' are skipped. 'requester' is either nullptr or a Driver
+  // in a suspended section. Returns the number of bytes freed. Called
+  // by MemoryArbitrator.
+  static uint64_t
+  reclaim(std::shared_ptr<Task> self, uint64_t bytes, const Driver* requester);
+
   // Removes driver from the set of drivers in 'self'. The task will be kept
   // alive by 'self'. 'self' going out of scope may cause the Task to
   // be freed. This happens if a cancelled task is decoupled from the
@@ -175,6 +205,13 @@ class Task {
       exec::Split& split,
       ContinueFuture& future);
 
+  // Sets 'split' to the next split for the source operator with
+  // 'planNodeId' and returns true if a split is queued. Returns false
+  // without waiting otherwise. Used for fetching splits ahead of need.
+  bool getSplitIfAvailable(
+      const core::PlanNodeId& planNodeId,
+      exec::Split& split);
+
   void splitFinished(const core::PlanNodeId& planNodeId, int32_t splitGroupId);
 
   void multipleSplitsFinished(int32_t numSplits);
@@ -255,6 +292,18 @@ class Task {
     return queryCtx_;
   }
 
+  // Returns the recorder of trace events for the Drivers of 'this' or
+  // nullptr if tracing is not enabled. See
+  // QueryCtx::kTraceEventsPerThread.
+  const std::shared_ptr<process::TraceRecorder>& traceRecorder() const {
+    return traceRecorder_;
+  }
+
+  // Returns the recorded trace events in the Chrome trace event format,
+  // which chrome://tracing and Perfetto load. Each Driver is a thread of
+  // the process named by the task id. Empty if tracing is not enabled.
+  std::string toChromeTrace() const;
+
   ConsumerSupplier consumerSupplier() {
     return consumerSupplier_;
   }
@@ -297,6 +346,21 @@ class Task {
   std::shared_ptr<CrossJoinBridge> getCrossJoinBridge(
       const core::PlanNodeId& planNodeId);
 
+  // Returns the hash table partitions shared by the Drivers of the
+  // final aggregation 'planNodeId'. The first call makes
+  // 'numPartitions' partitions.
+  std::shared_ptr<SharedAggregation> getSharedAggregation(
+      const core::PlanNodeId& planNodeId,
+      int32_t numPartitions);
+
+  // Adds MergeJoinSource's for all the specified plan node IDs.
+  void addMergeJoinSources(const std::vector<core::PlanNodeId>& planNodeIds);
+
+  // Returns the MergeJoinSource through which the right side of the
+  // merge join 'planNodeId' passes its input to the join.
+  std::shared_ptr<MergeJoinSource> getMergeJoinSource(
+      const core::PlanNodeId& planNodeId);
+
   // Sets the CancelPool of the QueryCtx to a terminate requested
   // state and frees all resources of Drivers that are not presently
   // on thread. Unblocks all waiting Drivers, e.g. Drivers waiting for
@@ -390,9 +454,28 @@ class Task {
     // For splits, coming with group ids, we keep track of them.
     std::unordered_map<int32_t, GroupSplitsInfo> groupSplits;
 
+    // In grouped execution, the queued splits by group id. 'splits' is
+    // then empty.
+    std::unordered_map<int32_t, std::deque<exec::Split>> groupedSplits;
+
+    // In grouped execution, the groups for which no more splits will
+    // arrive.
+    std::unordered_set<int32_t> noMoreSplitsGroups;
+
     // Keep the max added split's sequence id to deduplicate incoming splits.
     long maxSequenceId{std::numeric_limits<long>::min()};
 
+    // Id of the hash join whose build side reads these splits if its
+    // table may come from HashTableCache. Cleared when a split without
+    // cache key arrives.
+    core::PlanNodeId cachedBuildJoinId;
+
+    // Fingerprint of the build side of 'cachedBuildJoinId'.
+    std::string cachedBuildFingerprint;
+
+    // Cache keys of the splits added so far.
+    std::vector<std::string> splitCacheKeys;
+
     // We need these due to having promises in the structure.
     SplitsState() = default;
     SplitsState(SplitsState const&) = delete;
@@ -409,6 +492,10 @@ class Task {
   // splits coming for the task.
   bool isAllSplitsFinishedLocked();
 
+  // Moves the first split of 'splitsState' into 'split' and updates
+  // the split stats. 'splitsState' must have a split.
+  void takeSplitLocked(SplitsState& splitsState, exec::Split& split);
+
   void checkGroupSplitsCompleteLocked(
       std::unordered_map<int32_t, GroupSplitsInfo>& mapGroupSplits,
       int32_t splitGroupId,
@@ -416,6 +503,38 @@ class Task {
 
   void addSplitLocked(SplitsState& splitsState, exec::Split&& split);
 
+  // Appends 'split' to the queue of its group in grouped execution or
+  // to the queue of all splits otherwise.
+  void queueSplitLocked(SplitsState& splitsState, exec::Split&& split);
+
+  // Returns the queued splits the running Drivers take splits from: the
+  // splits of the current group in grouped execution.
+  std::deque<exec::Split>& runnableSplitsLocked(SplitsState& splitsState);
+
+  // Makes the Drivers of all pipelines with the JoinBridges and local
+  // exchanges they share. In grouped execution, makes the Drivers of
+  // 'currentSplitGroup_'.
+  static std::vector<std::shared_ptr<Driver>> createDrivers(
+      const std::shared_ptr<Task>& self);
+
+  // Frees the state shared by the Drivers of the previous split group
+  // and starts the Drivers of 'splitGroupId'.
+  static void startSplitGroup(
+      const std::shared_ptr<Task>& self,
+      int32_t splitGroupId);
+
+  // Marks the splits of the build side TableScans of the hash joins in
+  // 'planNode' and its sources whose tables may come from
+  // HashTableCache.
+  void addCachedBuildsLocked(const core::PlanNode& planNode);
+
+  // Called before no more splits are signaled for 'planNodeId'. If
+  // this is a build side scan marked by addCachedBuildsLocked() and the
+  // table for its splits is cached, hands the table to the
+  // HashJoinBridge and drops the queued splits. Otherwise makes the
+  // bridge add the table of the build side to the cache.
+  void lookupCachedBuild(const core::PlanNodeId& planNodeId);
+
   const std::string taskId_;
   std::shared_ptr<const core::PlanNode> planNode_;
   const int destination_;
@@ -442,7 +561,21 @@ class Task {
 
   std::vector<std::unique_ptr<DriverFactory>> driverFactories_;
   std::vector<std::shared_ptr<Driver>> drivers_;
+  // Number of Drivers that are not yet closed, including the ones of
+  // the split groups that have not started yet.
   int32_t numDrivers_ = 0;
+  uint32_t maxDrivers_ = 0;
+  // Number of Drivers of all pipelines for one split group, or for the
+  // whole Task if not grouped.
+  int32_t numDriversPerGroup_ = 0;
+
+  // Number of split groups in grouped execution, 0 if not grouped.
+  int32_t numSplitGroups_ = 0;
+  // The split group whose Drivers run, -1 if not grouped.
+  int32_t currentSplitGroup_ = -1;
+  // Number of Drivers of 'currentSplitGroup_' that are not yet
+  // closed. Guarded by the CancelPool mutex.
+  int32_t numSplitGroupDrivers_ = 0;
   TaskState state_ = kRunning;
 
   // We store separate splits state for each plan node.
@@ -454,6 +587,10 @@ class Task {
   // Map from the plan node id of the join to the corresponding JoinBridge.
   // Guarded by 'mutex_'.
   std::unordered_map<std::string, std::shared_ptr<JoinBridge>> bridges_;
+  // Map from the plan node id of a final aggregation to its shared hash
+  // table partitions. Guarded by 'mutex_'.
+  std::unordered_map<std::string, std::shared_ptr<SharedAggregation>>
+      sharedAggregations_;
 
   std::vector<VeloxPromise<bool>> stateChangePromises_;
 
@@ -463,6 +600,8 @@ class Task {
   // Keep driver and operator memory pools alive for the duration of the task to
   // allow for sharing vectors across drivers without copy.
   std::vector<std::unique_ptr<velox::memory::MemoryPool>> childPools_;
+  // Serializes additions to 'childPools_'.
+  std::mutex childPoolsMutex_;
 
   std::vector<std::shared_ptr<MergeSource>> localMergeSources_;
 
@@ -476,6 +615,10 @@ class Task {
 
   core::CancelPoolPtr cancelPool_{std::make_shared<core::CancelPool>()};
   std::weak_ptr<PartitionedOutputBufferManager> bufferManager_;
+
+  // Set if tracing is enabled. Shared with the ExchangeClients, whose
+  // responses may arrive after 'this' is gone.
+  std::shared_ptr<process::TraceRecorder> traceRecorder_;
 };
 
 } // namespace facebook::velox::exec
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/TaskResultStream.h"
+
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+std::atomic<int32_t> TaskResultStream::serial_;
+
+// static
+std::shared_ptr<TaskResultStream> TaskResultStream::create(
+    std::shared_ptr<const core::PlanNode> planNode,
+    std::shared_ptr<core::QueryCtx> queryCtx,
+    int32_t maxDrivers,
+    uint64_t maxBufferedBytes) {
+  return std::make_shared<TaskResultStream>(
+      std::move(planNode), std::move(queryCtx), maxDrivers, maxBufferedBytes);
+}
+
+TaskResultStream::~TaskResultStream() {
+  close();
+}
+
+BlockingReason TaskResultStream::enqueue(
+    RowVectorPtr vector,
+    ContinueFuture* future) {
+  if (!vector) {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++numFinishedProducers_;
+    notifyConsumers();
+    return BlockingReason::kNotBlocked;
+  }
+  if (vector->size() == 0) {
+    return BlockingReason::kNotBlocked;
+  }
+
+  // Lazy columns are loaded on the producer's thread. The vector is handed
+  // over as is otherwise.
+  for (auto& child : vector->children()) {
+    child->loadedVector();
+  }
+  auto bytes = vector->retainedSize();
+
+  std::lock_guard<std::mutex> l(mutex_);
+  if (closed_) {
+    return BlockingReason::kNotBlocked;
+  }
+  queue_.emplace_back(std::move(vector), bytes);
+  bufferedBytes_ += bytes;
+  notifyConsumers();
+  if (bufferedBytes_ > maxBufferedBytes_) {
+    auto [promise, semiFuture] = makeVeloxPromiseContract<bool>();
+    producerPromises_.emplace_back(std::move(promise));
+    *future = std::move(semiFuture);
+    return BlockingReason::kWaitForConsumer;
+  }
+  return BlockingReason::kNotBlocked;
+}
+
+void TaskResultStream::notifyConsumers() {
+  for (auto& promise : consumerPromises_) {
+    promise.setValue(true);
+  }
+  consumerPromises_.clear();
+}
+
+void TaskResultStream::start() {
+  // The consumers capture a weak_ptr, since the Task is owned by 'this'.
+  std::weak_ptr<TaskResultStream> weak = shared_from_this();
+  task_ = std::make_shared<Task>(
+      fmt::format("task_result_stream_{}", ++serial_),
+      planNode_,
+      0,
+      std::move(queryCtx_),
+      [weak]() -> Consumer {
+        if (auto self = weak.lock()) {
+          std::lock_guard<std::mutex> l(self->mutex_);
+          ++self->numProducers_;
+        }
+        return [weak](RowVectorPtr vector, ContinueFuture* future) {
+          auto self = weak.lock();
+          return self ? self->enqueue(std::move(vector), future)
+                      : BlockingReason::kNotBlocked;
+        };
+      },
+      // Wakes up the consumers so that they see the error.
+      [weak](std::exception_ptr /*error*/) {
+        if (auto self = weak.lock()) {
+          std::lock_guard<std::mutex> l(self->mutex_);
+          self->notifyConsumers();
+        }
+      });
+  // All drivers, hence all consumers, are made before 'start' returns.
+  Task::start(task_, maxDrivers_);
+}
+
+void TaskResultStream::checkError() {
+  if (task_->error()) {
+    std::rethrow_exception(task_->error());
+  }
+}
+
+RowVectorPtr TaskResultStream::tryNext(ContinueFuture* future) {
+  if (!task_) {
+    start();
+  }
+  checkError();
+  RowVectorPtr vector;
+  std::vector<VeloxPromise<bool>> mayContinue;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (!queue_.empty()) {
+      vector = std::move(queue_.front().first);
+      bufferedBytes_ -= queue_.front().second;
+      queue_.pop_front();
+      if (bufferedBytes_ <= maxBufferedBytes_ / 2) {
+        mayContinue = std::move(producerPromises_);
+        producerPromises_.clear();
+      }
+    } else if (!producersFinished()) {
+      auto [promise, semiFuture] = makeVeloxPromiseContract<bool>();
+      consumerPromises_.emplace_back(std::move(promise));
+      *future = std::move(semiFuture);
+    }
+  }
+  // Outside of 'mutex_'.
+  for (auto& promise : mayContinue) {
+    promise.setValue(true);
+  }
+  return vector;
+}
+
+RowVectorPtr TaskResultStream::next() {
+  for (;;) {
+    ContinueFuture future(false);
+    if (auto vector = tryNext(&future)) {
+      return vector;
+    }
+    if (atEnd()) {
+      checkError();
+      return nullptr;
+    }
+    std::move(future).wait();
+  }
+}
+
+bool TaskResultStream::atEnd() {
+  if (!task_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  return queue_.empty() && producersFinished();
+}
+
+uint64_t TaskResultStream::bufferedBytes() {
+  std::lock_guard<std::mutex> l(mutex_);
+  return bufferedBytes_;
+}
+
+void TaskResultStream::close() {
+  std::vector<VeloxPromise<bool>> mayContinue;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+    queue_.clear();
+    bufferedBytes_ = 0;
+    mayContinue = std::move(producerPromises_);
+    producerPromises_.clear();
+    notifyConsumers();
+  }
+  for (auto& promise : mayContinue) {
+    promise.setValue(true);
+  }
+  if (task_) {
+    task_->cancelPool()->requestTerminate();
+  }
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/core/QueryCtx.h"
+#include "velox/exec/Driver.h"
+
+namespace facebook::velox::exec {
+
+/// Runs 'planNode' in a new Task and returns the Task's results to an
+/// embedding client, one batch at a time. The Task starts on the first call
+/// to next() or tryNext(). Producing Drivers are blocked, without holding
+/// threads, while more than 'maxBufferedBytes' of results wait to be consumed,
+/// and resume once the buffered results drop below half of that.
+///
+/// Batches are handed over without copying. Lazy columns are loaded on the
+/// producer's thread. The buffers of the batches belong to the memory pools
+/// of the Task, so the stream, which owns the Task, must outlive the batches.
+/// Destroying or closing the stream cancels the Task if it is still running.
+class TaskResultStream : public std::enable_shared_from_this<TaskResultStream> {
+ public:
+  static std::shared_ptr<TaskResultStream> create(
+      std::shared_ptr<const core::PlanNode> planNode,
+      std::shared_ptr<core::QueryCtx> queryCtx,
+      int32_t maxDrivers = 1,
+      uint64_t maxBufferedBytes = 512 * 1024);
+
+  TaskResultStream(
+      std::shared_ptr<const core::PlanNode> planNode,
+      std::shared_ptr<core::QueryCtx> queryCtx,
+      int32_t maxDrivers,
+      uint64_t maxBufferedBytes)
+      : planNode_(std::move(planNode)),
+        queryCtx_(std::move(queryCtx)),
+        maxDrivers_(maxDrivers),
+        maxBufferedBytes_(maxBufferedBytes) {}
+
+  ~TaskResultStream();
+
+  const RowTypePtr& outputType() const {
+    return planNode_->outputType();
+  }
+
+  /// Returns the next batch of results without blocking. If no batch is
+  /// available, returns nullptr and, unless atEnd() is true, sets '*future'
+  /// to a future that is realized when tryNext() should be called again.
+  /// Re-throws the error of the Task, if any.
+  RowVectorPtr tryNext(ContinueFuture* future);
+
+  /// Returns the next batch of results, blocking the calling thread until it
+  /// is produced. Returns nullptr at the end. Re-throws the error of the Task,
+  /// if any.
+  RowVectorPtr next();
+
+  /// Returns true if all results have been returned.
+  bool atEnd();
+
+  /// Stops the Task, drops the buffered results and unblocks the producers
+  /// and any waiting consumer.
+  void close();
+
+  /// The Task producing the results, nullptr before the first call to next()
+  /// or tryNext().
+  const std::shared_ptr<Task>& task() const {
+    return task_;
+  }
+
+  /// Number of bytes of results waiting to be consumed.
+  uint64_t bufferedBytes();
+
+ private:
+  // Called by the CallbackSink of each Task driver producing results.
+  BlockingReason enqueue(RowVectorPtr vector, ContinueFuture* future);
+
+  void start();
+
+  // Returns true if no more results will be added. Must be called under
+  // 'mutex_'.
+  bool producersFinished() const {
+    return closed_ || numFinishedProducers_ == numProducers_;
+  }
+
+  // Realizes the futures of the waiting consumers. Must be called under
+  // 'mutex_'.
+  void notifyConsumers();
+
+  void checkError();
+
+  static std::atomic<int32_t> serial_;
+
+  const std::shared_ptr<const core::PlanNode> planNode_;
+  std::shared_ptr<core::QueryCtx> queryCtx_;
+  const int32_t maxDrivers_;
+  const uint64_t maxBufferedBytes_;
+  std::shared_ptr<Task> task_;
+
+  std::mutex mutex_;
+  std::deque<std::pair<RowVectorPtr, uint64_t>> queue_;
+  uint64_t bufferedBytes_{0};
+  int32_t numProducers_{0};
+  int32_t numFinishedProducers_{0};
+  std::vector<VeloxPromise<bool>> producerPromises_;
+  std::vector<VeloxPromise<bool>> consumerPromises_;
+  bool closed_{false};
+};
+
+} // namespace facebook::velox::exec
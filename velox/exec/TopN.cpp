@@ -38,7 +38,18 @@ TopN::TopN(
           topNNode->sortingOrders(),
           data_.get()),
       topRows_(comparator_),
-      decodedVectors_(outputType_->children().size()) {}
+      decodedVectors_(outputType_->children().size()),
+      isKey_(outputType_->size(), false) {
+  for (auto& key : comparator_.keyInfo()) {
+    isKey_[key.first] = true;
+  }
+  auto& firstKeyType = outputType_->childAt(comparator_.keyInfo()[0].first);
+  if (firstKeyType->isPrimitiveType() &&
+      firstKeyType->kind() != TypeKind::UNKNOWN) {
+    firstKeyThreshold_ =
+        BaseVector::create(firstKeyType, 1, operatorCtx_->pool());
+  }
+}
 
 TopN::Comparator::Comparator(
     const std::shared_ptr<const RowType>& type,
@@ -57,15 +68,77 @@ TopN::Comparator::Comparator(
   }
 }
 
+void TopN::filterByFirstKey(const char* topRow) {
+  auto& key = comparator_.keyInfo()[0];
+  data_->extractColumn(&topRow, 1, key.first, firstKeyThreshold_);
+  VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+      filterByFirstKeyTyped,
+      firstKeyThreshold_->typeKind(),
+      decodedVectors_[key.first],
+      key.second);
+}
+
+template <TypeKind Kind>
+void TopN::filterByFirstKeyTyped(
+    const DecodedVector& decoded,
+    core::SortOrder order) {
+  using T = typename TypeTraits<Kind>::NativeType;
+  auto numRows = candidates_.size();
+  bool nullsFirst = order.isNullsFirst();
+  if (firstKeyThreshold_->isNullAt(0)) {
+    // With nulls last, any row comes before or with a null.
+    if (nullsFirst) {
+      for (auto row = 0; row < numRows; ++row) {
+        if (!decoded.isNullAt(row)) {
+          candidates_.setValid(row, false);
+        }
+      }
+    }
+  } else {
+    auto threshold = firstKeyThreshold_->as<SimpleVector<T>>()->valueAt(0);
+    bool ascending = order.isAscending();
+    for (auto row = 0; row < numRows; ++row) {
+      if (decoded.isNullAt(row)) {
+        if (!nullsFirst) {
+          candidates_.setValid(row, false);
+        }
+        continue;
+      }
+      auto value = decoded.valueAt<T>(row);
+      if (ascending ? threshold < value : value < threshold) {
+        candidates_.setValid(row, false);
+      }
+    }
+  }
+  candidates_.updateBounds();
+}
+
 void TopN::addInput(RowVectorPtr input) {
-  SelectivityVector allRows(input->size());
+  candidates_.resize(input->size());
+  candidates_.setAll();
 
-  // TODO Decode keys first, then decode the rest only for passing positions
+  // Decode the keys first. When 'topRows_' is full, most rows of a large
+  // input come after the top row. These are filtered out a batch at a
+  // time on the first key and the other columns are decoded only for
+  // the rows that remain.
   for (int col = 0; col < input->childrenSize(); ++col) {
-    decodedVectors_[col].decode(*input->childAt(col), allRows);
+    if (isKey_[col]) {
+      decodedVectors_[col].decode(*input->childAt(col), candidates_);
+    }
+  }
+  if (firstKeyThreshold_ && !topRows_.empty() && topRows_.size() >= count_) {
+    filterByFirstKey(topRows_.top());
+    if (!candidates_.hasSelections()) {
+      return;
+    }
+  }
+  for (int col = 0; col < input->childrenSize(); ++col) {
+    if (!isKey_[col]) {
+      decodedVectors_[col].decode(*input->childAt(col), candidates_);
+    }
   }
 
-  for (int row = 0; row < input->size(); ++row) {
+  candidates_.applyToSelected([&](vector_size_t row) {
     char* newRow = nullptr;
     if (topRows_.size() < count_) {
       newRow = data_->newRow();
@@ -73,7 +146,7 @@ void TopN::addInput(RowVectorPtr input) {
       char* topRow = topRows_.top();
 
       if (comparator_(topRow, decodedVectors_, row)) {
-        continue;
+        return;
       }
       topRows_.pop();
       // Reuse the topRow's memory.
@@ -85,7 +158,7 @@ void TopN::addInput(RowVectorPtr input) {
     }
 
     topRows_.push(newRow);
-  }
+  });
 }
 
 RowVectorPtr TopN::getOutput() {
@@ -98,7 +171,8 @@ RowVectorPtr TopN::getOutput() {
   VELOX_CHECK(numRowsToReturn > 0);
 
   auto result = std::dynamic_pointer_cast<RowVector>(
-      BaseVector::create(outputType_, numRowsToReturn, operatorCtx_->pool()));
+      operatorCtx_->vectorPool().get(
+          outputType_, numRowsToReturn, operatorCtx_->pool()));
 
   for (int i = 0; i < outputType_->size(); ++i) {
     data_->extractColumn(
@@ -87,11 +87,27 @@ class TopN : public Operator {
       return false;
     }
 
+    const std::vector<std::pair<ChannelIndex, core::SortOrder>>& keyInfo()
+        const {
+      return keyInfo_;
+    }
+
    private:
     std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
     RowContainer* rowContainer_;
   };
 
+  // Deselects the rows in 'candidates_' whose first sorting key comes
+  // after the first sorting key of 'topRow'. These rows cannot replace
+  // 'topRow'. Rows with an equal first key stay selected for a full
+  // comparison.
+  void filterByFirstKey(const char* topRow);
+
+  template <TypeKind Kind>
+  void filterByFirstKeyTyped(
+      const DecodedVector& decoded,
+      core::SortOrder order);
+
   const int32_t count_;
 
   bool finished_ = false;
@@ -112,5 +128,14 @@ class TopN : public Operator {
   std::vector<char*> rows_;
 
   std::vector<DecodedVector> decodedVectors_;
+
+  // True for the columns that are sorting keys.
+  std::vector<bool> isKey_;
+  // The rows of the input that may enter 'topRows_'.
+  SelectivityVector candidates_;
+  // The first sorting key of the top row, set for filtering a batch
+  // with filterByFirstKey(). Null if the first key type is not a
+  // scalar type.
+  VectorPtr firstKeyThreshold_;
 };
 } // namespace facebook::velox::exec
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/TopNRowNumber.h"
+#include "velox/exec/OperatorUtils.h"
+#include "velox/exec/Task.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::exec {
+
+TopNRowNumber::TopNRowNumber(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::TopNRowNumberNode>& node)
+    : Operator(
+          driverCtx,
+          node->outputType(),
+          operatorId,
+          node->id(),
+          "TopNRowNumber"),
+      limit_(node->limit()),
+      generateRowNumber_(node->generateRowNumber()),
+      inputType_(node->sources()[0]->outputType()),
+      isAdaptive_(operatorCtx_->task()->queryCtx()->hashAdaptivityEnabled()),
+      data_(std::make_unique<RowContainer>(
+          inputType_->children(),
+          operatorCtx_->mappedMemory())),
+      decodedVectors_(inputType_->size()) {
+  std::vector<std::unique_ptr<VectorHasher>> hashers;
+  for (auto& key : node->partitionKeys()) {
+    auto channel = exprToChannel(key.get(), inputType_);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "TopNRowNumber doesn't allow constant partition keys");
+    partitionChannels_.push_back(channel);
+    hashers.push_back(
+        VectorHasher::create(inputType_->childAt(channel), channel));
+  }
+  auto& sortingKeys = node->sortingKeys();
+  auto& sortingOrders = node->sortingOrders();
+  for (auto i = 0; i < sortingKeys.size(); ++i) {
+    auto channel = exprToChannel(sortingKeys[i].get(), inputType_);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "TopNRowNumber doesn't allow constant sorting keys");
+    sortingKeys_.emplace_back(channel, sortingOrders[i]);
+  }
+
+  if (hashers.empty()) {
+    // All rows are in one partition.
+    partitions_.resize(1);
+    return;
+  }
+  static const std::vector<std::unique_ptr<Aggregate>> kNoAggregates;
+  table_ = std::make_unique<HashTable<false>>(
+      std::move(hashers),
+      kNoAggregates,
+      std::vector<TypePtr>{INTEGER()},
+      false, // allowDuplicates
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      operatorCtx_->mappedMemory());
+  partitionIndexOffset_ =
+      table_->rows()->columnAt(partitionChannels_.size()).offset();
+  lookup_ = std::make_unique<HashLookup>(table_->hashers());
+  if (!isAdaptive_ && table_->hashMode() != BaseHashTable::HashMode::kHash) {
+    table_->forceGenericHashMode();
+  }
+}
+
+bool TopNRowNumber::lessThan(const char* lhs, vector_size_t index) {
+  for (auto& key : sortingKeys_) {
+    if (auto result = data_->compare(
+            lhs,
+            data_->columnAt(key.first),
+            decodedVectors_[key.first],
+            index,
+            {key.second.isNullsFirst(), key.second.isAscending(), false})) {
+      return result < 0;
+    }
+  }
+  return false;
+}
+
+bool TopNRowNumber::lessThan(const char* lhs, const char* rhs) {
+  if (lhs == rhs) {
+    return false;
+  }
+  for (auto& key : sortingKeys_) {
+    if (auto result = data_->compare(
+            lhs,
+            rhs,
+            key.first,
+            {key.second.isNullsFirst(), key.second.isAscending(), false})) {
+      return result < 0;
+    }
+  }
+  return false;
+}
+
+void TopNRowNumber::probePartitions(const RowVector& input) {
+  auto numRows = input.size();
+  auto& hashers = lookup_->hashers;
+  // The hash mode is decided after the first batch.
+  bool rehash = partitions_.empty();
+  for (;;) {
+    lookup_->reset(numRows);
+    auto mode = table_->hashMode();
+    for (int32_t i = 0; i < hashers.size(); ++i) {
+      auto key = input.loadedChildAt(partitionChannels_[i]);
+      if (mode != BaseHashTable::HashMode::kHash) {
+        if (!hashers[i]->computeValueIds(
+                *key, activeRows_, table_->valueIdsFor(*lookup_, i))) {
+          rehash = true;
+        }
+      } else {
+        hashers[i]->hash(*key, activeRows_, i > 0, &lookup_->hashes);
+      }
+    }
+    std::iota(lookup_->rows.begin(), lookup_->rows.end(), 0);
+    if (!rehash) {
+      break;
+    }
+    if (table_->hashMode() != BaseHashTable::HashMode::kHash) {
+      table_->decideHashMode(numRows);
+    }
+    rehash = false;
+  }
+  table_->groupProbe(*lookup_);
+  for (auto row : lookup_->newGroups) {
+    partitionIndex(lookup_->hits[row]) = partitions_.size();
+    partitions_.emplace_back();
+  }
+}
+
+void TopNRowNumber::addInput(RowVectorPtr input) {
+  auto numRows = input->size();
+  activeRows_.resize(numRows);
+  activeRows_.setAll();
+  if (table_) {
+    probePartitions(*input);
+  }
+  for (auto col = 0; col < input->childrenSize(); ++col) {
+    decodedVectors_[col].decode(*input->childAt(col), activeRows_);
+  }
+
+  // The heaps are max heaps on the sorting keys, so that the top is the
+  // row to replace when a full partition gets a row that comes before
+  // it.
+  auto heapLess = [&](const char* lhs, const char* rhs) {
+    return lessThan(lhs, rhs);
+  };
+  for (auto row = 0; row < numRows; ++row) {
+    auto& heap = table_ ? partitions_[partitionIndex(lookup_->hits[row])]
+                        : partitions_[0];
+    char* newRow;
+    if (heap.size() < limit_) {
+      newRow = data_->newRow();
+    } else {
+      if (lessThan(heap.front(), row)) {
+        continue;
+      }
+      std::pop_heap(heap.begin(), heap.end(), heapLess);
+      // Reuse the memory of the row that drops out.
+      newRow = data_->initializeRow(heap.back(), true /* reuse */);
+      heap.pop_back();
+    }
+    for (auto col = 0; col < input->childrenSize(); ++col) {
+      data_->store(decodedVectors_[col], row, newRow, col);
+    }
+    heap.push_back(newRow);
+    std::push_heap(heap.begin(), heap.end(), heapLess);
+  }
+}
+
+void TopNRowNumber::finish() {
+  Operator::finish();
+  auto heapLess = [&](const char* lhs, const char* rhs) {
+    return lessThan(lhs, rhs);
+  };
+  for (auto& heap : partitions_) {
+    std::sort_heap(heap.begin(), heap.end(), heapLess);
+    for (auto i = 0; i < heap.size(); ++i) {
+      outputRows_.push_back(heap[i]);
+      rowNumbers_.push_back(i + 1);
+    }
+    // The rows are now in 'outputRows_'.
+    std::vector<char*>().swap(heap);
+  }
+  if (outputRows_.empty()) {
+    finished_ = true;
+  }
+}
+
+RowVectorPtr TopNRowNumber::getOutput() {
+  if (finished_ || !isFinishing_) {
+    return nullptr;
+  }
+
+  auto numRowsToReturn =
+      std::min(kMaxNumRowsToReturn, outputRows_.size() - numRowsReturned_);
+  auto result = std::dynamic_pointer_cast<RowVector>(
+      operatorCtx_->vectorPool().get(
+          outputType_, numRowsToReturn, operatorCtx_->pool()));
+
+  auto rows = outputRows_.data() + numRowsReturned_;
+  for (auto i = 0; i < inputType_->size(); ++i) {
+    data_->extractColumn(rows, numRowsToReturn, i, result->childAt(i));
+  }
+  if (generateRowNumber_) {
+    auto rowNumbers =
+        result->childAt(inputType_->size())->asFlatVector<int64_t>();
+    for (auto i = 0; i < numRowsToReturn; ++i) {
+      rowNumbers->set(i, rowNumbers_[numRowsReturned_ + i]);
+    }
+  }
+  numRowsReturned_ += numRowsToReturn;
+  finished_ = (numRowsReturned_ == outputRows_.size());
+  return result;
+}
+} // namespace facebook::velox::exec
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/exec/HashTable.h"
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// Keeps the first 'limit' rows of each partition of the input in the
+// order of the sorting keys. The distinct partition keys are in a hash
+// table and each partition has a heap of at most 'limit' rows in a
+// RowContainer, with its last row in sorting order on top. A row that
+// comes after the top of a full heap is dropped without being stored,
+// so memory is O(partitions * limit) rather than O(input). Once all
+// input is in, the rows are returned a partition at a time in sorting
+// order, optionally followed by their row numbers.
+class TopNRowNumber : public Operator {
+ public:
+  TopNRowNumber(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::TopNRowNumberNode>& node);
+
+  bool needsInput() const override {
+    return !isFinishing_;
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+  void finish() override;
+
+  BlockingReason isBlocked(ContinueFuture* /*future*/) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+ private:
+  static constexpr size_t kMaxNumRowsToReturn = 1024;
+
+  // Returns true if 'lhs' comes before the row at 'index' of the
+  // decoded sorting keys.
+  bool lessThan(const char* lhs, vector_size_t index);
+
+  // Returns true if 'lhs' comes before 'rhs' on the sorting keys.
+  bool lessThan(const char* lhs, const char* rhs);
+
+  // Finds or creates the partition of each row of 'input' in 'table_'.
+  // The groups are in 'lookup_->hits'.
+  void probePartitions(const RowVector& input);
+
+  // Index in 'partitions_' of 'group', a row of 'table_'.
+  int32_t& partitionIndex(char* group) {
+    return *reinterpret_cast<int32_t*>(group + partitionIndexOffset_);
+  }
+
+  const int32_t limit_;
+  const bool generateRowNumber_;
+  const RowTypePtr inputType_;
+  std::vector<ChannelIndex> partitionChannels_;
+  std::vector<std::pair<ChannelIndex, core::SortOrder>> sortingKeys_;
+
+  // The partition keys with the index of the partition in 'partitions_'
+  // as a dependent column. Null if there are no partition keys.
+  std::unique_ptr<BaseHashTable> table_;
+  std::unique_ptr<HashLookup> lookup_;
+  int32_t partitionIndexOffset_ = 0;
+  const bool isAdaptive_;
+  SelectivityVector activeRows_;
+
+  // The input rows that are in the top rows of their partition.
+  std::unique_ptr<RowContainer> data_;
+  // A max heap of at most 'limit_' rows of 'data_' per partition.
+  std::vector<std::vector<char*>> partitions_;
+  std::vector<DecodedVector> decodedVectors_;
+
+  // The rows to return in order, set in finish(), with their row
+  // numbers.
+  std::vector<char*> outputRows_;
+  std::vector<int64_t> rowNumbers_;
+  size_t numRowsReturned_ = 0;
+  bool finished_ = false;
+};
+} // namespace facebook::velox::exec
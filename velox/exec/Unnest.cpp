@@ -56,6 +56,24 @@ Unnest::Unnest(
 
 void Unnest::addInput(RowVectorPtr input) {
   input_ = std::move(input);
+  nextInputRow_ = 0;
+  inputRows_.resize(input_->size());
+  auto& unnestVector = input_->childAt(unnestChannel_);
+  unnestDecoded_.decode(*unnestVector, inputRows_);
+
+  // An output row has the replicated columns of an input row and one
+  // element.
+  std::optional<uint64_t> outputRowSize;
+  if (input_->size() > 0) {
+    auto replicatedBytes =
+        input_->retainedSize() - unnestVector->retainedSize();
+    outputRowSize = replicatedBytes / input_->size();
+    const auto& elements = unnestDecoded_.base()->as<ArrayVector>()->elements();
+    if (elements->size() > 0) {
+      *outputRowSize += elements->retainedSize() / elements->size();
+    }
+  }
+  outputBatchSize_ = outputBatchRows(outputRowSize);
 }
 
 RowVectorPtr Unnest::getOutput() {
@@ -64,49 +82,78 @@ RowVectorPtr Unnest::getOutput() {
   }
 
   auto size = input_->size();
+  auto unnestIndices = unnestDecoded_.indices();
+  auto rawSizes = unnestDecoded_.base()->as<ArrayVector>()->rawSizes();
+
+  // Takes input rows until their elements fill an output batch. Skips
+  // ranges where all arrays are null or empty.
+  while (nextInputRow_ < size) {
+    auto start = nextInputRow_;
+    auto end = start;
+    vector_size_t numElements = 0;
+    for (; end < size && numElements < outputBatchSize_; ++end) {
+      if (!unnestDecoded_.isNullAt(end)) {
+        numElements += rawSizes[unnestIndices[end]];
+      }
+    }
+    nextInputRow_ = end;
+    if (numElements > 0) {
+      auto output = makeOutput(start, end, numElements);
+      if (nextInputRow_ == size) {
+        input_ = nullptr;
+      }
+      return output;
+    }
+  }
 
-  // Build repeated indices to apply to "replicated" columns.
-  const auto& unnestVector = input_->childAt(unnestChannel_);
-
-  inputRows_.resize(size);
-  unnestDecoded_.decode(*unnestVector, inputRows_);
+  // All arrays are null or empty.
+  input_ = nullptr;
+  return nullptr;
+}
 
+RowVectorPtr Unnest::makeOutput(
+    vector_size_t start,
+    vector_size_t end,
+    vector_size_t numElements) {
   auto unnestIndices = unnestDecoded_.indices();
-
   auto unnestBase = unnestDecoded_.base()->as<ArrayVector>();
   auto rawSizes = unnestBase->rawSizes();
   auto rawOffsets = unnestBase->rawOffsets();
 
-  // Count number of elements.
-  vector_size_t numElements = 0;
-  for (auto row = 0; row < size; ++row) {
-    if (!unnestDecoded_.isNullAt(row)) {
-      numElements += rawSizes[unnestIndices[row]];
-    }
-  }
-
-  if (numElements == 0) {
-    // All arrays are null or empty.
-    input_ = nullptr;
-    return nullptr;
-  }
-
-  // Create "indices" buffer to repeat rows as many times as there are elements
-  // in the array.
+  // Build repeated indices to apply to "replicated" columns and the
+  // indices of the elements in one pass. The replicated columns are
+  // not copied, the indices refer to the parent rows in 'input_'.
   BufferPtr repeatedIndices =
       AlignedBuffer::allocate<vector_size_t>(numElements, pool());
   auto* rawIndices = repeatedIndices->asMutable<vector_size_t>();
+  BufferPtr elementIndices =
+      AlignedBuffer::allocate<vector_size_t>(numElements, pool());
+  auto* rawElementIndices = elementIndices->asMutable<vector_size_t>();
   vector_size_t index = 0;
-  for (auto row = 0; row < size; ++row) {
-    if (!unnestDecoded_.isNullAt(row)) {
-      auto unnestSize = rawSizes[unnestIndices[row]];
-      for (auto i = 0; i < unnestSize; i++) {
-        rawIndices[index++] = row;
-      }
+  // The elements are contiguous if each array starts where the last
+  // one ended.
+  std::optional<vector_size_t> firstOffset;
+  bool contiguous = true;
+  for (auto row = start; row < end; ++row) {
+    if (unnestDecoded_.isNullAt(row)) {
+      continue;
+    }
+    auto offset = rawOffsets[unnestIndices[row]];
+    auto unnestSize = rawSizes[unnestIndices[row]];
+    if (unnestSize == 0) {
+      continue;
+    }
+    if (!firstOffset.has_value()) {
+      firstOffset = offset;
+    } else if (offset != firstOffset.value() + index) {
+      contiguous = false;
+    }
+    for (auto i = 0; i < unnestSize; i++) {
+      rawIndices[index] = row;
+      rawElementIndices[index++] = offset + i;
     }
   }
 
-  // Wrap "replicated" columns in a dictionary using 'repeatedIndices'.
   std::vector<VectorPtr> outputs(outputType_->size());
   for (const auto& projection : identityProjections_) {
     outputs[projection.outputChannel] = wrapChild(
@@ -114,32 +161,13 @@ RowVectorPtr Unnest::getOutput() {
   }
 
   // Make "elements" column. Elements may be out of order. Use a
-  // dictionary to ensure the right order.
-  BufferPtr elementIndices =
-      AlignedBuffer::allocate<vector_size_t>(numElements, pool());
-  auto* rawElementIndices = elementIndices->asMutable<vector_size_t>();
-  index = 0;
-  bool identityMapping = true;
-  for (auto row = 0; row < size; ++row) {
-    if (!unnestDecoded_.isNullAt(row)) {
-      auto offset = rawOffsets[unnestIndices[row]];
-      auto unnestSize = rawSizes[unnestIndices[row]];
-
-      if (index != offset) {
-        identityMapping = false;
-      }
-
-      for (auto i = 0; i < unnestSize; i++) {
-        rawElementIndices[index++] = offset + i;
-      }
-    }
-  }
-
-  outputs[identityProjections_.size()] = identityMapping
-      ? unnestBase->elements()
-      : wrapChild(numElements, elementIndices, unnestBase->elements());
-
-  input_ = nullptr;
+  // dictionary to ensure the right order. A run of elements that is the
+  // whole elements vector is returned as is.
+  const auto& elements = unnestBase->elements();
+  outputs[identityProjections_.size()] = contiguous &&
+          firstOffset.value() == 0 && numElements == elements->size()
+      ? elements
+      : wrapChild(numElements, elementIndices, elements);
 
   return std::make_shared<RowVector>(
       pool(), outputType_, BufferPtr(nullptr), numElements, std::move(outputs));
@@ -29,7 +29,7 @@ class Unnest : public Operator {
   }
 
   bool needsInput() const override {
-    return true;
+    return !input_;
   }
 
   void addInput(RowVectorPtr input) override;
@@ -37,9 +37,22 @@ class Unnest : public Operator {
   RowVectorPtr getOutput() override;
 
  private:
+  // Makes the outputs for the input rows in ['start', 'end') that have
+  // 'numElements' elements in total.
+  RowVectorPtr makeOutput(
+      vector_size_t start,
+      vector_size_t end,
+      vector_size_t numElements);
+
   ChannelIndex unnestChannel_;
 
   SelectivityVector inputRows_;
   DecodedVector unnestDecoded_;
+  // The first row of 'input_' not yet unnested.
+  vector_size_t nextInputRow_{0};
+  // Target number of rows in an output batch for the width of the
+  // output rows of 'input_'. An input row whose array is larger still
+  // goes out in one batch.
+  vector_size_t outputBatchSize_{0};
 };
 } // namespace facebook::velox::exec
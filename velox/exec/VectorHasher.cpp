@@ -210,9 +210,6 @@ template <typename T, bool mayHaveNulls>
 bool VectorHasher::makeValueIdsDecoded(
     const SelectivityVector& rows,
     uint64_t* result) {
-  cachedHashes_.resize(decoded_.base()->size());
-  std::fill(cachedHashes_.begin(), cachedHashes_.end(), 0);
-
   auto indices = decoded_.indices();
   auto values = decoded_.values<T>();
 
@@ -227,7 +224,7 @@ bool VectorHasher::makeValueIdsDecoded(
       }
     }
     auto baseIndex = indices[row];
-    uint64_t id = cachedHashes_[baseIndex];
+    uint64_t id = baseValueIds_[baseIndex];
     if (id == 0) {
       T value = values[baseIndex];
 
@@ -243,7 +240,7 @@ bool VectorHasher::makeValueIdsDecoded(
         success = false;
         return;
       }
-      cachedHashes_[baseIndex] = id;
+      baseValueIds_[baseIndex] = id;
     }
     result[row] = multiplier_ == 1 ? id : result[row] + multiplier_ * id;
   });
@@ -255,10 +252,32 @@ bool VectorHasher::computeValueIds(
     SelectivityVector& rows,
     std::vector<uint64_t>* result) {
   decoded_.decode(values, rows);
+  if (!decoded_.isConstantMapping() && !decoded_.isIdentityMapping()) {
+    prepareBaseValueIds(values);
+  }
   return VALUE_ID_TYPE_DISPATCH(
       makeValueIds, values.typeKind(), rows, result->data());
 }
 
+void VectorHasher::prepareBaseValueIds(const BaseVector& values) {
+  const auto* base = decoded_.base();
+  if (values.encoding() == VectorEncoding::Simple::DICTIONARY &&
+      values.valueVector().get() == base) {
+    if (baseValueIdsVector_.get() == base) {
+      // Same dictionary as in the previous batch, e.g. a string column
+      // of the same ORC stripe. The ids of its entries are still valid.
+      return;
+    }
+    // Holding a reference keeps the dictionary from being reused for
+    // different values while its ids are cached.
+    baseValueIdsVector_ = values.valueVector();
+  } else {
+    baseValueIdsVector_ = nullptr;
+  }
+  baseValueIds_.resize(base->size());
+  std::fill(baseValueIds_.begin(), baseValueIds_.end(), 0);
+}
+
 template <>
 bool VectorHasher::computeValueIdForRows<StringView>(
     char** groups,
@@ -478,6 +497,7 @@ void VectorHasher::cardinality(uint64_t& asRange, uint64_t& asDistincts) {
 }
 
 uint64_t VectorHasher::enableValueIds(uint64_t multiplier, int64_t reserve) {
+  baseValueIdsVector_ = nullptr;
   multiplier_ = multiplier;
   rangeSize_ = uniqueValues_.size() + 1 + reserve;
   isRange_ = false;
@@ -493,6 +513,7 @@ uint64_t VectorHasher::enableValueRange(uint64_t multiplier, int64_t reserve) {
   static constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
   // Use reserve as padding above and below the range.
   reserve /= 2;
+  baseValueIdsVector_ = nullptr;
   multiplier_ = multiplier;
   VELOX_CHECK(hasRange_);
   if (kMin + reserve + 1 > min_) {
@@ -519,6 +540,7 @@ void VectorHasher::merge(const VectorHasher& other) {
   if (typeKind_ == TypeKind::BOOLEAN) {
     return;
   }
+  baseValueIdsVector_ = nullptr;
   if (hasRange_ && other.hasRange_ && !rangeOverflow_ &&
       !other.rangeOverflow_) {
     min_ = std::min(min_, other.min_);
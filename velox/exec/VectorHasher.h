@@ -73,6 +73,7 @@ class UniqueValue {
       case TypeKind::BIGINT:
       case TypeKind::VARCHAR:
       case TypeKind::VARBINARY:
+      case TypeKind::TIMESTAMP:
         return true;
       default:
         return false;
@@ -236,6 +237,7 @@ class VectorHasher {
   void resetStats() {
     uniqueValues_.clear();
     uniqueValuesStorage_.clear();
+    baseValueIdsVector_ = nullptr;
   }
 
   uint64_t enableValueRange(uint64_t multiplier, int64_t reserve);
@@ -283,6 +285,7 @@ class VectorHasher {
       case TypeKind::BIGINT:
       case TypeKind::VARCHAR:
       case TypeKind::VARBINARY:
+      case TypeKind::TIMESTAMP:
         return true;
       default:
         return false;
@@ -307,6 +310,17 @@ class VectorHasher {
     return size == 0 ? word : word + (1L << (size * 8));
   }
 
+  // Sets 'number' to the nanoseconds since the epoch of 'value'. Returns
+  // false if these do not fit in 64 bits, i.e. for timestamps outside of
+  // years 1677 to 2262. Timestamps are mapped to value ids through this
+  // number.
+  static inline bool timestampAsNumber(Timestamp value, int64_t& number) {
+    int64_t seconds = value.getSeconds();
+    int64_t nanos = value.getNanos();
+    return !__builtin_mul_overflow(seconds, 1'000'000'000L, &number) &&
+        !__builtin_add_overflow(number, nanos, &number);
+  }
+
   template <TypeKind Kind>
   bool makeValueIds(const SelectivityVector& rows, uint64_t* result);
 
@@ -328,6 +342,11 @@ class VectorHasher {
       std::vector<uint64_t>& cachedHashes,
       uint64_t* result) const;
 
+  // Sets up 'baseValueIds_' for 'decoded_', which decodes 'values'
+  // with a non-trivial mapping. Keeps the ids from the previous call
+  // if 'values' is a dictionary over the same base.
+  void prepareBaseValueIds(const BaseVector& values);
+
   template <typename T>
   void analyzeValue(T value) {
     auto normalized = static_cast<int64_t>(value);
@@ -453,6 +472,13 @@ class VectorHasher {
   DecodedVector decoded_;
   std::vector<uint64_t> cachedHashes_;
 
+  // Value ids of the entries of the base of a dictionary-encoded input,
+  // 0 if not yet computed. Kept across calls of computeValueIds() while
+  // the input has the base 'baseValueIdsVector_' and the id mapping
+  // does not change.
+  std::vector<uint64_t> baseValueIds_;
+  VectorPtr baseValueIdsVector_;
+
   // Members for fast map to int domain for array/normalized key.
   // Maximum integer mapping. If distinct count exceeds this,
   // array/normalized key mapping fails.
@@ -559,6 +585,43 @@ inline uint64_t VectorHasher::lookupValueId(StringView value) const {
   return kUnmappable;
 }
 
+template <>
+inline void VectorHasher::analyzeValue(Timestamp value) {
+  int64_t number;
+  if (!timestampAsNumber(value, number)) {
+    rangeOverflow_ = true;
+    distinctOverflow_ = true;
+    return;
+  }
+  analyzeValue(number);
+}
+
+template <>
+inline bool VectorHasher::tryMapToRange(
+    const Timestamp* /*values*/,
+    const SelectivityVector& /*rows*/,
+    uint64_t* /*result*/) {
+  return false;
+}
+
+template <>
+inline uint64_t VectorHasher::valueId(Timestamp value) {
+  int64_t number;
+  if (!timestampAsNumber(value, number)) {
+    return kUnmappable;
+  }
+  return valueId(number);
+}
+
+template <>
+inline uint64_t VectorHasher::lookupValueId(Timestamp value) const {
+  int64_t number;
+  if (!timestampAsNumber(value, number)) {
+    return kUnmappable;
+  }
+  return lookupValueId(number);
+}
+
 template <>
 inline uint64_t VectorHasher::valueId(bool value) {
   return value ? 2 : 1;
@@ -586,31 +649,34 @@ bool VectorHasher::makeValueIdsFlatWithNulls<bool>(
     const SelectivityVector& rows,
     uint64_t* result);
 
-#define VALUE_ID_TYPE_DISPATCH(TEMPLATE_FUNC, typeKind, ...)   \
-  [&]() {                                                      \
-    switch (typeKind) {                                        \
-      case TypeKind::BOOLEAN: {                                \
-        return TEMPLATE_FUNC<TypeKind::BOOLEAN>(__VA_ARGS__);  \
-      }                                                        \
-      case TypeKind::TINYINT: {                                \
-        return TEMPLATE_FUNC<TypeKind::TINYINT>(__VA_ARGS__);  \
-      }                                                        \
-      case TypeKind::SMALLINT: {                               \
-        return TEMPLATE_FUNC<TypeKind::SMALLINT>(__VA_ARGS__); \
-      }                                                        \
-      case TypeKind::INTEGER: {                                \
-        return TEMPLATE_FUNC<TypeKind::INTEGER>(__VA_ARGS__);  \
-      }                                                        \
-      case TypeKind::BIGINT: {                                 \
-        return TEMPLATE_FUNC<TypeKind::BIGINT>(__VA_ARGS__);   \
-      }                                                        \
-      case TypeKind::VARCHAR:                                  \
-      case TypeKind::VARBINARY: {                              \
-        return TEMPLATE_FUNC<TypeKind::VARCHAR>(__VA_ARGS__);  \
-      }                                                        \
-      default:                                                 \
-        throw std::invalid_argument{"not a value ids  type!"}; \
-    }                                                          \
+#define VALUE_ID_TYPE_DISPATCH(TEMPLATE_FUNC, typeKind, ...)    \
+  [&]() {                                                       \
+    switch (typeKind) {                                         \
+      case TypeKind::BOOLEAN: {                                 \
+        return TEMPLATE_FUNC<TypeKind::BOOLEAN>(__VA_ARGS__);   \
+      }                                                         \
+      case TypeKind::TINYINT: {                                 \
+        return TEMPLATE_FUNC<TypeKind::TINYINT>(__VA_ARGS__);   \
+      }                                                         \
+      case TypeKind::SMALLINT: {                                \
+        return TEMPLATE_FUNC<TypeKind::SMALLINT>(__VA_ARGS__);  \
+      }                                                         \
+      case TypeKind::INTEGER: {                                 \
+        return TEMPLATE_FUNC<TypeKind::INTEGER>(__VA_ARGS__);   \
+      }                                                         \
+      case TypeKind::BIGINT: {                                  \
+        return TEMPLATE_FUNC<TypeKind::BIGINT>(__VA_ARGS__);    \
+      }                                                         \
+      case TypeKind::VARCHAR:                                   \
+      case TypeKind::VARBINARY: {                               \
+        return TEMPLATE_FUNC<TypeKind::VARCHAR>(__VA_ARGS__);   \
+      }                                                         \
+      case TypeKind::TIMESTAMP: {                               \
+        return TEMPLATE_FUNC<TypeKind::TIMESTAMP>(__VA_ARGS__); \
+      }                                                         \
+      default:                                                  \
+        throw std::invalid_argument{"not a value ids  type!"};  \
+    }                                                           \
   }()
 
 } // namespace facebook::velox::exec
@@ -0,0 +1,636 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/Window.h"
+#include "velox/exec/Aggregate.h"
+#include "velox/exec/HashStringAllocator.h"
+#include "velox/exec/Task.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+// row_number(), rank() and dense_rank().
+class RankFunction : public WindowFunction {
+ public:
+  enum class Kind { kRowNumber, kRank, kDenseRank };
+
+  explicit RankFunction(Kind kind) : kind_(kind) {}
+
+  void apply(const WindowPartition& partition, VectorPtr& result) override {
+    auto* rawValues = result->asFlatVector<int64_t>()->mutableRawValues();
+    int64_t denseRank = 0;
+    for (auto i = partition.start; i < partition.end; ++i) {
+      switch (kind_) {
+        case Kind::kRowNumber:
+          rawValues[i] = i - partition.start + 1;
+          break;
+        case Kind::kRank:
+          rawValues[i] = partition.peerStarts[i] - partition.start + 1;
+          break;
+        case Kind::kDenseRank:
+          if (partition.peerStarts[i] == i) {
+            ++denseRank;
+          }
+          rawValues[i] = denseRank;
+          break;
+      }
+    }
+  }
+
+ private:
+  const Kind kind_;
+};
+
+// lag(x[, offset[, default]]) and lead(x[, offset[, default]]). The
+// value of 'x' in the row 'offset' rows before or after the current row
+// in the partition or 'default' if there is no such row.
+class LagLeadFunction : public WindowFunction {
+ public:
+  LagLeadFunction(
+      bool isLag,
+      ChannelIndex channel,
+      int64_t offset,
+      VectorPtr defaultValue)
+      : isLag_(isLag),
+        channel_(channel),
+        offset_(offset),
+        defaultValue_(std::move(defaultValue)) {}
+
+  void apply(const WindowPartition& partition, VectorPtr& result) override {
+    const auto* source = partition.input.childAt(channel_).get();
+    // Limits the offset so that the target row does not overflow.
+    int64_t offset =
+        std::min<int64_t>(offset_, partition.end - partition.start);
+    for (auto i = partition.start; i < partition.end; ++i) {
+      int64_t target = isLag_ ? i - offset : i + offset;
+      if (target >= partition.start && target < partition.end) {
+        result->copy(source, i, target, 1);
+      } else if (defaultValue_) {
+        result->copy(defaultValue_.get(), i, 0, 1);
+      } else {
+        result->setNull(i, true);
+      }
+    }
+  }
+
+ private:
+  const bool isLag_;
+  const ChannelIndex channel_;
+  const int64_t offset_;
+  // Constant vector of size 1 or nullptr for a null default.
+  const VectorPtr defaultValue_;
+};
+
+// An aggregate function over the frame of each row. The aggregate is
+// updated incrementally if the frame starts at the start of the
+// partition and is recomputed for each row otherwise.
+class AggregateWindowFunction : public WindowFunction {
+ public:
+  AggregateWindowFunction(
+      std::unique_ptr<Aggregate> aggregate,
+      std::vector<ChannelIndex> channels,
+      std::vector<VectorPtr> constants,
+      const core::WindowNode::Frame& frame,
+      memory::MemoryPool* pool,
+      memory::MappedMemory* mappedMemory)
+      : aggregate_(std::move(aggregate)),
+        channels_(std::move(channels)),
+        constants_(std::move(constants)),
+        frame_(frame),
+        pool_(pool),
+        stringAllocator_(mappedMemory) {
+    // The single accumulator row has the null flag in the first byte,
+    // the uint32_t row size and then the accumulator.
+    aggregate_->setAllocator(&stringAllocator_);
+    aggregate_->setOffsets(
+        kAccumulatorOffset,
+        RowContainer::nullByte(0),
+        RowContainer::nullMask(0),
+        kRowSizeOffset);
+    group_ = AlignedBuffer::allocate<char>(
+        kAccumulatorOffset + aggregate_->accumulatorFixedWidthSize(), pool);
+    rawGroup_ = group_->asMutable<char>();
+  }
+
+  ~AggregateWindowFunction() override {
+    if (isInitialized_) {
+      aggregate_->destroy(folly::Range<char**>(&rawGroup_, 1));
+    }
+  }
+
+  void prepare(const RowVectorPtr& input) override {
+    args_.resize(channels_.size());
+    for (auto i = 0; i < channels_.size(); ++i) {
+      if (channels_[i] == kConstantChannel) {
+        args_[i] = BaseVector::wrapInConstant(input->size(), 0, constants_[i]);
+      } else {
+        args_[i] = input->childAt(channels_[i]);
+      }
+    }
+    rows_.resize(input->size());
+    rows_.clearAll();
+  }
+
+  void apply(const WindowPartition& partition, VectorPtr& result) override {
+    const bool incremental =
+        frame_.startType == core::WindowNode::BoundType::kUnboundedPreceding;
+    auto numAdded = partition.start;
+    if (incremental) {
+      resetGroup();
+    }
+    for (auto i = partition.start; i < partition.end; ++i) {
+      auto [frameStart, frameEnd] = frameBounds(partition, i);
+      if (incremental) {
+        if (frameEnd > numAdded) {
+          addRows(numAdded, frameEnd);
+          numAdded = frameEnd;
+        }
+      } else {
+        resetGroup();
+        if (frameEnd > frameStart) {
+          addRows(frameStart, frameEnd);
+        }
+      }
+      if (!value_) {
+        value_ = BaseVector::create(result->type(), 1, pool_);
+      }
+      aggregate_->extractValues(&rawGroup_, 1, &value_);
+      result->copy(value_.get(), i, 0, 1);
+    }
+  }
+
+ private:
+  static constexpr int32_t kRowSizeOffset = 4;
+  static constexpr int32_t kAccumulatorOffset = 8;
+
+  // Returns the first row and one past the last row of the frame of
+  // row 'row'. The frame is empty if the end is not after the start.
+  std::pair<vector_size_t, vector_size_t> frameBounds(
+      const WindowPartition& partition,
+      vector_size_t row) const {
+    using BoundType = core::WindowNode::BoundType;
+    const int64_t size = partition.end - partition.start;
+    auto bound = [&](BoundType type, int64_t offset, bool isStart) {
+      offset = std::min(offset, size);
+      switch (type) {
+        case BoundType::kUnboundedPreceding:
+          return static_cast<int64_t>(partition.start);
+        case BoundType::kPreceding:
+          return row - offset + (isStart ? 0 : 1);
+        case BoundType::kCurrentRow:
+          if (frame_.type == core::WindowNode::WindowType::kRange) {
+            return static_cast<int64_t>(
+                isStart ? partition.peerStarts[row] : partition.peerEnds[row]);
+          }
+          return static_cast<int64_t>(row) + (isStart ? 0 : 1);
+        case BoundType::kFollowing:
+          return row + offset + (isStart ? 0 : 1);
+        case BoundType::kUnboundedFollowing:
+          return static_cast<int64_t>(partition.end);
+      }
+      VELOX_UNREACHABLE();
+    };
+    auto clamp = [&](int64_t value) {
+      return static_cast<vector_size_t>(std::max<int64_t>(
+          partition.start, std::min<int64_t>(value, partition.end)));
+    };
+    return {
+        clamp(bound(frame_.startType, frame_.startOffset, true)),
+        clamp(bound(frame_.endType, frame_.endOffset, false))};
+  }
+
+  void resetGroup() {
+    if (isInitialized_) {
+      aggregate_->destroy(folly::Range<char**>(&rawGroup_, 1));
+    }
+    rawGroup_[RowContainer::nullByte(0)] = 0;
+    *reinterpret_cast<uint32_t*>(rawGroup_ + kRowSizeOffset) = 0;
+    aggregate_->clear();
+    aggregate_->initializeNewGroups(&rawGroup_, singleGroup_);
+    isInitialized_ = true;
+  }
+
+  void addRows(vector_size_t begin, vector_size_t end) {
+    rows_.setValidRange(begin, end, true);
+    rows_.updateBounds();
+    aggregate_->addSingleGroupRawInput(rawGroup_, rows_, args_, false);
+    rows_.setValidRange(begin, end, false);
+  }
+
+  const std::unique_ptr<Aggregate> aggregate_;
+  const std::vector<ChannelIndex> channels_;
+  const std::vector<VectorPtr> constants_;
+  const core::WindowNode::Frame frame_;
+  memory::MemoryPool* const pool_;
+  HashStringAllocator stringAllocator_;
+  const std::vector<vector_size_t> singleGroup_{0};
+
+  BufferPtr group_;
+  char* rawGroup_;
+  bool isInitialized_ = false;
+
+  // Arguments of the aggregate for the current batch.
+  std::vector<VectorPtr> args_;
+  SelectivityVector rows_;
+  // Receives the value of the aggregate for one row.
+  VectorPtr value_;
+};
+
+const core::ConstantTypedExpr* constantArgument(
+    const core::ITypedExpr& expr,
+    const std::string& functionName) {
+  auto constant = dynamic_cast<const core::ConstantTypedExpr*>(&expr);
+  VELOX_USER_CHECK_NOT_NULL(
+      constant, "{} requires a constant offset and default", functionName);
+  return constant;
+}
+
+int64_t integerConstant(
+    const core::ITypedExpr& expr,
+    const std::string& functionName) {
+  const auto& value = constantArgument(expr, functionName)->value();
+  switch (value.kind()) {
+    case TypeKind::TINYINT:
+      return value.value<TypeKind::TINYINT>();
+    case TypeKind::SMALLINT:
+      return value.value<TypeKind::SMALLINT>();
+    case TypeKind::INTEGER:
+      return value.value<TypeKind::INTEGER>();
+    case TypeKind::BIGINT:
+      return value.value<TypeKind::BIGINT>();
+    default:
+      VELOX_USER_FAIL("{} requires an integer offset", functionName);
+  }
+}
+} // namespace
+
+// static
+std::unique_ptr<WindowFunction> WindowFunction::create(
+    const core::WindowNode::Function& function,
+    const RowTypePtr& inputType,
+    memory::MemoryPool* pool,
+    memory::MappedMemory* mappedMemory) {
+  const auto& call = function.functionCall;
+  const auto& name = call->name();
+  const auto& inputs = call->inputs();
+
+  static const std::unordered_map<std::string, RankFunction::Kind> kRanks = {
+      {"row_number", RankFunction::Kind::kRowNumber},
+      {"rank", RankFunction::Kind::kRank},
+      {"dense_rank", RankFunction::Kind::kDenseRank},
+  };
+  auto it = kRanks.find(name);
+  if (it != kRanks.end()) {
+    VELOX_USER_CHECK(inputs.empty(), "{} takes no arguments", name);
+    VELOX_USER_CHECK(
+        call->type()->kind() == TypeKind::BIGINT, "{} returns BIGINT", name);
+    return std::make_unique<RankFunction>(it->second);
+  }
+
+  if (name == "lag" || name == "lead") {
+    VELOX_USER_CHECK(
+        !inputs.empty() && inputs.size() <= 3,
+        "{} takes 1 to 3 arguments",
+        name);
+    auto channel = exprToChannel(inputs[0].get(), inputType);
+    VELOX_USER_CHECK_NE(
+        channel, kConstantChannel, "{} requires a column argument", name);
+    int64_t offset = 1;
+    if (inputs.size() > 1) {
+      offset = integerConstant(*inputs[1], name);
+      VELOX_USER_CHECK_GE(offset, 0, "{} requires a non-negative offset", name);
+    }
+    VectorPtr defaultValue;
+    if (inputs.size() > 2) {
+      auto constant = constantArgument(*inputs[2], name);
+      defaultValue = constant->hasValueVector()
+          ? constant->valueVector()
+          : BaseVector::createConstant(constant->value(), 1, pool);
+      VELOX_USER_CHECK(
+          defaultValue->type()->kindEquals(call->type()),
+          "{} requires a default of the type of its first argument",
+          name);
+    }
+    return std::make_unique<LagLeadFunction>(
+        name == "lag", channel, offset, std::move(defaultValue));
+  }
+
+  std::vector<TypePtr> argTypes;
+  std::vector<ChannelIndex> channels;
+  std::vector<VectorPtr> constants;
+  for (auto& arg : inputs) {
+    argTypes.push_back(arg->type());
+    channels.push_back(exprToChannel(arg.get(), inputType));
+    if (channels.back() == kConstantChannel) {
+      auto constant = dynamic_cast<const core::ConstantTypedExpr*>(arg.get());
+      constants.push_back(
+          BaseVector::createConstant(constant->value(), 1, pool));
+    } else {
+      constants.push_back(nullptr);
+    }
+  }
+  return std::make_unique<AggregateWindowFunction>(
+      Aggregate::create(
+          name, core::AggregationNode::Step::kSingle, argTypes, call->type()),
+      std::move(channels),
+      std::move(constants),
+      function.frame,
+      pool,
+      mappedMemory);
+}
+
+Window::Window(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::WindowNode>& windowNode)
+    : Operator(
+          driverCtx,
+          windowNode->outputType(),
+          operatorId,
+          windowNode->id(),
+          "Window"),
+      inputsSorted_(windowNode->inputsSorted()),
+      inputType_(windowNode->sources()[0]->outputType()) {
+  for (const auto& key : windowNode->partitionKeys()) {
+    partitionKeys_.push_back(exprToChannel(key.get(), inputType_));
+  }
+  for (auto i = 0; i < windowNode->sortingKeys().size(); ++i) {
+    sortingKeys_.emplace_back(
+        exprToChannel(windowNode->sortingKeys()[i].get(), inputType_),
+        windowNode->sortingOrders()[i]);
+  }
+  for (const auto& function : windowNode->windowFunctions()) {
+    functions_.push_back(WindowFunction::create(
+        function, inputType_, pool(), operatorCtx_->mappedMemory()));
+  }
+  if (!inputsSorted_) {
+    data_ = std::make_unique<RowContainer>(
+        inputType_->children(), operatorCtx_->mappedMemory());
+  }
+}
+
+bool Window::samePartition(
+    const RowVector& left,
+    vector_size_t leftIndex,
+    const RowVector& right,
+    vector_size_t rightIndex) const {
+  for (auto channel : partitionKeys_) {
+    if (left.childAt(channel)->compare(
+            right.childAt(channel).get(), leftIndex, rightIndex)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Window::samePeerGroup(
+    const RowVector& left,
+    vector_size_t leftIndex,
+    const RowVector& right,
+    vector_size_t rightIndex) const {
+  for (auto& key : sortingKeys_) {
+    if (left.childAt(key.first)
+            ->compare(right.childAt(key.first).get(), leftIndex, rightIndex)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Window::addInput(RowVectorPtr input) {
+  if (!inputsSorted_) {
+    SelectivityVector allRows(input->size());
+    std::vector<char*> rows(input->size());
+    for (int row = 0; row < input->size(); ++row) {
+      rows[row] = data_->newRow();
+    }
+    for (size_t col = 0; col < input->childrenSize(); ++col) {
+      decodedInput_.decode(*input->childAt(col), allRows);
+      for (int i = 0; i < input->size(); ++i) {
+        data_->store(decodedInput_, i, rows[i], col);
+      }
+    }
+    numRows_ += input->size();
+    return;
+  }
+
+  if (input->size() == 0) {
+    return;
+  }
+  for (auto& child : input->children()) {
+    child->loadedVector();
+  }
+  // Finds the start of the last partition in 'input'. The rows before it
+  // complete the partitions buffered so far.
+  auto lastStart = input->size();
+  for (auto i = input->size() - 1; i > 0; --i) {
+    if (!samePartition(*input, i - 1, *input, i)) {
+      lastStart = i;
+      break;
+    }
+  }
+  if (lastStart == input->size() && !pending_.empty()) {
+    const auto& last = pending_.back();
+    if (!samePartition(*last.input, last.end - 1, *input, 0)) {
+      lastStart = 0;
+    }
+  }
+  if (lastStart == input->size()) {
+    pending_.push_back({input, 0, input->size()});
+    return;
+  }
+  if (lastStart > 0) {
+    pending_.push_back({input, 0, lastStart});
+  }
+  completed_ = concatenate(pending_);
+  pending_.clear();
+  pending_.push_back({input, lastStart, input->size()});
+}
+
+RowVectorPtr Window::concatenate(const std::vector<RowRange>& ranges) {
+  if (ranges.size() == 1 && ranges[0].start == 0 &&
+      ranges[0].end == ranges[0].input->size()) {
+    return ranges[0].input;
+  }
+  vector_size_t size = 0;
+  for (const auto& range : ranges) {
+    size += range.end - range.start;
+  }
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(inputType_, size, pool()));
+  vector_size_t offset = 0;
+  for (const auto& range : ranges) {
+    for (auto i = 0; i < inputType_->size(); ++i) {
+      result->childAt(i)->copy(
+          range.input->childAt(i).get(),
+          offset,
+          range.start,
+          range.end - range.start);
+    }
+    offset += range.end - range.start;
+  }
+  return result;
+}
+
+void Window::finish() {
+  Operator::finish();
+
+  if (inputsSorted_) {
+    if (!pending_.empty()) {
+      if (completed_) {
+        pending_.insert(
+            pending_.begin(), RowRange{completed_, 0, completed_->size()});
+      }
+      completed_ = concatenate(pending_);
+      pending_.clear();
+    }
+    return;
+  }
+  sortRows();
+}
+
+void Window::sortRows() {
+  sortedRows_.resize(numRows_);
+  RowContainerIterator iter;
+  data_->listRows(&iter, numRows_, sortedRows_.data());
+
+  std::sort(
+      sortedRows_.begin(),
+      sortedRows_.end(),
+      [this](const char* leftRow, const char* rightRow) {
+        for (auto channel : partitionKeys_) {
+          if (auto result = data_->compare(leftRow, rightRow, channel, {})) {
+            return result < 0;
+          }
+        }
+        for (auto& key : sortingKeys_) {
+          if (auto result = data_->compare(
+                  leftRow,
+                  rightRow,
+                  key.first,
+                  {key.second.isNullsFirst(),
+                   key.second.isAscending(),
+                   false})) {
+            return result < 0;
+          }
+        }
+        return false;
+      });
+}
+
+RowVectorPtr Window::nextSortedBatch() {
+  if (nextRow_ == sortedRows_.size()) {
+    return nullptr;
+  }
+  // Takes about a batch worth of rows, extended to the end of the last
+  // partition.
+  size_t numRows = outputBatchRows(data_->estimateRowSize());
+  auto end = std::min(nextRow_ + numRows, sortedRows_.size());
+  auto isSamePartition = [&](const char* left, const char* right) {
+    for (auto channel : partitionKeys_) {
+      if (data_->compare(left, right, channel, {})) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (end < sortedRows_.size() &&
+         isSamePartition(sortedRows_[end - 1], sortedRows_[end])) {
+    ++end;
+  }
+
+  auto size = end - nextRow_;
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(inputType_, size, pool()));
+  for (auto i = 0; i < inputType_->size(); ++i) {
+    data_->extractColumn(
+        sortedRows_.data() + nextRow_, size, i, result->childAt(i));
+  }
+  nextRow_ = end;
+  return result;
+}
+
+RowVectorPtr Window::computeWindow(const RowVectorPtr& input) {
+  const auto numRows = input->size();
+  peerStarts_.resize(numRows);
+  peerEnds_.resize(numRows);
+
+  std::vector<VectorPtr> results(functions_.size());
+  for (auto i = 0; i < functions_.size(); ++i) {
+    results[i] = BaseVector::create(
+        outputType_->childAt(inputType_->size() + i), numRows, pool());
+    functions_[i]->prepare(input);
+  }
+
+  vector_size_t start = 0;
+  while (start < numRows) {
+    auto end = start + 1;
+    while (end < numRows && samePartition(*input, end - 1, *input, end)) {
+      ++end;
+    }
+    for (auto row = start; row < end;) {
+      auto peerEnd = row + 1;
+      while (peerEnd < end && samePeerGroup(*input, row, *input, peerEnd)) {
+        ++peerEnd;
+      }
+      std::fill(peerStarts_.begin() + row, peerStarts_.begin() + peerEnd, row);
+      std::fill(peerEnds_.begin() + row, peerEnds_.begin() + peerEnd, peerEnd);
+      row = peerEnd;
+    }
+
+    WindowPartition partition{*input, start, end, peerStarts_, peerEnds_};
+    for (auto i = 0; i < functions_.size(); ++i) {
+      functions_[i]->apply(partition, results[i]);
+    }
+    start = end;
+  }
+
+  auto children = input->children();
+  children.insert(children.end(), results.begin(), results.end());
+  return std::make_shared<RowVector>(
+      pool(), outputType_, BufferPtr(nullptr), numRows, std::move(children));
+}
+
+RowVectorPtr Window::getOutput() {
+  if (inputsSorted_) {
+    if (!completed_) {
+      return nullptr;
+    }
+    auto input = std::move(completed_);
+    completed_ = nullptr;
+    return computeWindow(input);
+  }
+
+  if (!isFinishing_) {
+    return nullptr;
+  }
+  auto input = nextSortedBatch();
+  if (!input) {
+    return nullptr;
+  }
+  return computeWindow(input);
+}
+
+void Window::close() {
+  functions_.clear();
+  pending_.clear();
+  completed_ = nullptr;
+  sortedRows_.clear();
+  data_.reset();
+  Operator::close();
+}
+
+} // namespace facebook::velox::exec
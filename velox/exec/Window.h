@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// The rows of one window partition in a batch of sorted rows, together
+// with the peer groups of the rows. Peers are the rows with the same
+// sorting keys.
+struct WindowPartition {
+  const RowVector& input;
+  // First row and one past the last row of the partition in 'input'.
+  vector_size_t start;
+  vector_size_t end;
+  // First row and one past the last row of the peer group of each row
+  // of 'input'. Set for the rows of the partition.
+  const std::vector<vector_size_t>& peerStarts;
+  const std::vector<vector_size_t>& peerEnds;
+};
+
+// Computes the values of one window function for the rows of a
+// partition.
+class WindowFunction {
+ public:
+  virtual ~WindowFunction() = default;
+
+  // Called once for each batch of sorted rows before apply() is called
+  // for the partitions in the batch.
+  virtual void prepare(const RowVectorPtr& /*input*/) {}
+
+  // Sets the values of 'result' for the rows of 'partition'. 'result'
+  // has one row for each row of 'partition.input'.
+  virtual void apply(const WindowPartition& partition, VectorPtr& result) = 0;
+
+  static std::unique_ptr<WindowFunction> create(
+      const core::WindowNode::Function& function,
+      const RowTypePtr& inputType,
+      memory::MemoryPool* pool,
+      memory::MappedMemory* mappedMemory);
+};
+
+// Window operator implementation: Window stores all input in a
+// RowContainer, sorts it on the partition keys and the sorting keys
+// once all input is available and then produces the output a few
+// complete partitions at a time. The output has the input columns
+// followed by a column for each window function.
+// If the input is already sorted, the rows are buffered only until the
+// partition they belong to is complete and each input batch produces
+// the output for the partitions it completes.
+// Supports row_number, rank, dense_rank, lag, lead and any registered
+// aggregate function over ROWS and RANGE frames.
+class Window : public Operator {
+ public:
+  Window(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::WindowNode>& windowNode);
+
+  bool needsInput() const override {
+    return !isFinishing_ && !completed_;
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  void finish() override;
+
+  RowVectorPtr getOutput() override;
+
+  BlockingReason isBlocked(ContinueFuture* /*future*/) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void close() override;
+
+ private:
+  // A range of rows of an input batch buffered in streaming mode.
+  struct RowRange {
+    RowVectorPtr input;
+    vector_size_t start;
+    vector_size_t end;
+  };
+
+  // Returns true if the rows have the same partition keys.
+  bool samePartition(
+      const RowVector& left,
+      vector_size_t leftIndex,
+      const RowVector& right,
+      vector_size_t rightIndex) const;
+
+  // Returns true if the rows have the same sorting keys.
+  bool samePeerGroup(
+      const RowVector& left,
+      vector_size_t leftIndex,
+      const RowVector& right,
+      vector_size_t rightIndex) const;
+
+  // Copies the rows of 'ranges' into a single batch.
+  RowVectorPtr concatenate(const std::vector<RowRange>& ranges);
+
+  // Sorts the rows of 'data_' on the partition and sorting keys.
+  void sortRows();
+
+  // Returns the next batch of complete partitions from the sorted rows
+  // of 'data_' or nullptr if all rows have been returned.
+  RowVectorPtr nextSortedBatch();
+
+  // Computes the window functions for 'input', which consists of
+  // complete partitions sorted on the sorting keys.
+  RowVectorPtr computeWindow(const RowVectorPtr& input);
+
+  const bool inputsSorted_;
+  const RowTypePtr inputType_;
+  std::vector<ChannelIndex> partitionKeys_;
+  std::vector<std::pair<ChannelIndex, core::SortOrder>> sortingKeys_;
+  std::vector<std::unique_ptr<WindowFunction>> functions_;
+
+  // Buffered input if the input is not sorted.
+  std::unique_ptr<RowContainer> data_;
+  size_t numRows_ = 0;
+  // Decodes the columns of unsorted input. Reused across batches.
+  DecodedVector decodedInput_;
+  std::vector<char*> sortedRows_;
+  // Position of the first row in 'sortedRows_' that has not been
+  // returned.
+  size_t nextRow_ = 0;
+
+  // The rows of the current partition if the input is sorted.
+  std::vector<RowRange> pending_;
+  // Complete partitions to compute and return in the next getOutput().
+  RowVectorPtr completed_;
+
+  std::vector<vector_size_t> peerStarts_;
+  std::vector<vector_size_t> peerEnds_;
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/WorkStealingExecutor.h"
+
+#include <fmt/format.h>
+#include <folly/system/ThreadName.h>
+#include <glog/logging.h>
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox::exec {
+namespace {
+// The executor and worker of the calling thread, if the calling thread
+// is a thread of a WorkStealingExecutor.
+thread_local const WorkStealingExecutor* tExecutor = nullptr;
+thread_local int32_t tWorkerIndex = -1;
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(
+    int32_t numThreads,
+    const std::string& threadName) {
+  VELOX_CHECK_GT(numThreads, 0);
+  for (auto i = 0; i < numThreads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (auto i = 0; i < numThreads; ++i) {
+    threads_.emplace_back([this, threadName, i]() {
+      folly::setThreadName(fmt::format("{}-{}", threadName, i));
+      run(i);
+    });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  join();
+}
+
+int32_t WorkStealingExecutor::addIndex() {
+  if (tExecutor == this) {
+    return tWorkerIndex;
+  }
+  return nextWorker_++ % workers_.size();
+}
+
+void WorkStealingExecutor::addWithPriority(
+    folly::Func func,
+    int8_t priority) {
+  auto& worker = *workers_[addIndex()];
+  {
+    std::lock_guard<std::mutex> l(worker.mutex);
+    worker.queues[toPriority(priority)].push_back(std::move(func));
+  }
+  ++numPending_;
+  std::lock_guard<std::mutex> l(mutex_);
+  wakeup_.notify_one();
+}
+
+folly::Func WorkStealingExecutor::take(int32_t index) {
+  auto numWorkers = workers_.size();
+  for (auto priority = 0; priority < kNumPriorities; ++priority) {
+    {
+      auto& worker = *workers_[index];
+      std::lock_guard<std::mutex> l(worker.mutex);
+      auto& queue = worker.queues[priority];
+      if (!queue.empty()) {
+        auto func = std::move(queue.front());
+        queue.pop_front();
+        --numPending_;
+        return func;
+      }
+    }
+    for (auto i = 1; i < numWorkers; ++i) {
+      auto& victim = *workers_[(index + i) % numWorkers];
+      std::lock_guard<std::mutex> l(victim.mutex);
+      auto& queue = victim.queues[priority];
+      if (!queue.empty()) {
+        auto func = std::move(queue.back());
+        queue.pop_back();
+        --numPending_;
+        ++numSteals_;
+        return func;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingExecutor::run(int32_t index) {
+  tExecutor = this;
+  tWorkerIndex = index;
+  for (;;) {
+    auto func = take(index);
+    if (func) {
+      try {
+        func();
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Exception in WorkStealingExecutor: " << e.what();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> l(mutex_);
+    wakeup_.wait(l, [&]() { return numPending_ > 0 || stopping_; });
+    if (stopping_ && numPending_ == 0) {
+      return;
+    }
+  }
+}
+
+void WorkStealingExecutor::join() {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    stopping_ = true;
+  }
+  wakeup_.notify_all();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  threads_.clear();
+}
+
+} // namespace facebook::velox::exec
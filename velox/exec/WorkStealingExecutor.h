@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/Executor.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace facebook::velox::exec {
+
+// Executor for running Drivers. Each thread has its own queue per
+// priority class. Work added from a thread of 'this', e.g. a Driver
+// that yields or a blocked Driver that is resumed from a Driver
+// thread, goes to the queue of that thread. Work added from other
+// threads is spread round robin. A thread runs the oldest work of the
+// highest priority from its own queues and, when these are empty,
+// steals the newest work of the same priority from the other threads.
+class WorkStealingExecutor : public folly::Executor {
+ public:
+  // The priority classes. addWithPriority() maps a positive priority
+  // to kHigh, a negative one to kLow and 0 to kMid.
+  enum Priority { kHigh = 0, kMid = 1, kLow = 2 };
+  static constexpr int32_t kNumPriorities = 3;
+
+  WorkStealingExecutor(int32_t numThreads, const std::string& threadName);
+
+  ~WorkStealingExecutor() override;
+
+  void add(folly::Func func) override {
+    addWithPriority(std::move(func), 0);
+  }
+
+  void addWithPriority(folly::Func func, int8_t priority) override;
+
+  uint8_t getNumPriorities() const override {
+    return kNumPriorities;
+  }
+
+  // Waits until all added work, including work added by the running
+  // work, is done and stops the threads.
+  void join();
+
+  int32_t numThreads() const {
+    return workers_.size();
+  }
+
+  // Returns the number of times a thread ran work from the queue of
+  // another thread.
+  int64_t numSteals() const {
+    return numSteals_;
+  }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::array<std::deque<folly::Func>, kNumPriorities> queues;
+  };
+
+  static Priority toPriority(int8_t priority) {
+    return priority > 0 ? kHigh : priority < 0 ? kLow : kMid;
+  }
+
+  // Returns the index of the worker whose queue gets work added on the
+  // calling thread.
+  int32_t addIndex();
+
+  // Returns the next work for the thread at 'index' or an empty Func if
+  // there is no work in any queue.
+  folly::Func take(int32_t index);
+
+  void run(int32_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  // Number of work items in all queues.
+  std::atomic<int64_t> numPending_{0};
+  std::atomic<int32_t> nextWorker_{0};
+  std::atomic<int64_t> numSteals_{0};
+
+  // Serializes idle threads waiting on 'wakeup_' with adding work and
+  // stopping.
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool stopping_{false};
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Measures group by and join hash tables over a sweep of key types,
+// table sizes and duplicate ratios. The sizes go from a table that
+// fits in L1 to one far larger than the last level cache. The key
+// values are either dense, which allows kArray or kNormalizedKey, or
+// spread over the whole 64 bit range or made of long strings, which
+// forces kHash. The hash modes picked for each case are printed when
+// its data is made so that a change in the choice for a real size table
+// shows up next to the timings.
+//
+// The groupProbe, joinBuild and joinProbe cases drive a HashTable
+// directly, as the HashAggregation, HashBuild and HashProbe operators
+// do. The hashJoin cases run the HashBuild and HashProbe operators in
+// a single Driver plan. The time per iteration is per row of input.
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <random>
+
+#include "velox/exec/HashTable.h"
+#include "velox/exec/VectorHasher.h"
+#include "velox/exec/tests/PlanBuilder.h"
+#include "velox/exec/tests/QueryAssertions.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+constexpr vector_size_t kBatchSize = 10'000;
+constexpr int32_t kMinProbeRows = 100'000;
+
+// The key columns of a case. Multi-part keys split the key number in
+// a low part of up to 1000 values and a high part.
+struct KeyShape {
+  std::string name;
+  std::vector<TypePtr> types;
+};
+
+const std::vector<KeyShape>& keyShapes() {
+  static const std::vector<KeyShape> shapes = {
+      {"bigint", {BIGINT()}},
+      {"2xbigint", {BIGINT(), BIGINT()}},
+      {"varchar", {VARCHAR()}},
+      {"bigint_varchar", {BIGINT(), VARCHAR()}},
+  };
+  return shapes;
+}
+
+struct BenchmarkCase {
+  const KeyShape* keys;
+  // Number of rows on the build side or group by input.
+  int32_t numRows;
+  // Each distinct key occurs this many times in the build side or
+  // group by input.
+  int32_t duplicates;
+  // If false, key parts are spread over the 64 bit range or are
+  // strings over the inline size.
+  bool dense;
+
+  int32_t numDistinct() const {
+    return numRows / duplicates;
+  }
+
+  std::string name() const {
+    return fmt::format(
+        "{}_{}_{}rows_x{}",
+        keys->name,
+        dense ? "dense" : "sparse",
+        numRows,
+        duplicates);
+  }
+};
+
+const char* hashModeName(BaseHashTable::HashMode mode) {
+  switch (mode) {
+    case BaseHashTable::HashMode::kArray:
+      return "kArray";
+    case BaseHashTable::HashMode::kNormalizedKey:
+      return "kNormalizedKey";
+    case BaseHashTable::HashMode::kHash:
+      return "kHash";
+  }
+  return "unknown";
+}
+
+class HashTableBenchmark {
+ public:
+  explicit HashTableBenchmark(const BenchmarkCase& benchmarkCase)
+      : case_(benchmarkCase) {
+    // Every distinct key appears 'duplicates' times in random order.
+    std::vector<int32_t> buildKeys(case_.numRows);
+    for (auto i = 0; i < case_.numRows; ++i) {
+      buildKeys[i] = i % case_.numDistinct();
+    }
+    std::mt19937 rng(1);
+    std::shuffle(buildKeys.begin(), buildKeys.end(), rng);
+    buildBatches_ = makeBatches(buildKeys, "b");
+
+    // Half of the probe keys hit, the other half are outside of the
+    // build side keys.
+    auto numProbeRows = std::max(case_.numRows, kMinProbeRows);
+    std::vector<int32_t> probeKeys(numProbeRows);
+    for (auto i = 0; i < numProbeRows; ++i) {
+      auto key = rng() % case_.numDistinct();
+      probeKeys[i] = i % 2 ? key : key + case_.numDistinct();
+    }
+    probeBatches_ = makeBatches(probeKeys, "p");
+  }
+
+  int32_t numBuildRows() const {
+    return case_.numRows;
+  }
+
+  int32_t numProbeRows() const {
+    return numRows(probeBatches_);
+  }
+
+  // Inserts the build side in a group by hash table. Returns the hash
+  // mode at the end.
+  BaseHashTable::HashMode groupProbe() {
+    auto table = HashTable<false>::createForAggregation(
+        makeHashers(), noAggregates(), mappedMemory_);
+    HashLookup lookup(table->hashers());
+    for (const auto& batch : buildBatches_) {
+      insertGroups(*batch, lookup, *table);
+    }
+    VELOX_CHECK_EQ(table->numDistinct(), case_.numDistinct());
+    return table->hashMode();
+  }
+
+  // Makes a join hash table of the build side.
+  std::unique_ptr<HashTable<true>> joinBuild() {
+    auto table = HashTable<true>::createForJoin(
+        makeHashers(), {}, true, false, mappedMemory_);
+    auto& hashers = table->hashers();
+    auto rowContainer = table->rows();
+    auto nextOffset = rowContainer->nextOffset();
+    bool analyzeKeys = true;
+    std::vector<uint64_t> hashes(kBatchSize);
+    for (const auto& batch : buildBatches_) {
+      SelectivityVector rows(batch->size());
+      for (auto i = 0; i < hashers.size(); ++i) {
+        if (analyzeKeys) {
+          hashers[i]->computeValueIds(*batch->childAt(i), rows, &hashes);
+          analyzeKeys = hashers[i]->mayUseValueIds();
+        } else {
+          hashers[i]->decode(*batch->childAt(i), rows);
+        }
+      }
+      for (auto row = 0; row < batch->size(); ++row) {
+        char* newRow = rowContainer->newRow();
+        if (nextOffset) {
+          *reinterpret_cast<char**>(newRow + nextOffset) = nullptr;
+        }
+        for (auto i = 0; i < hashers.size(); ++i) {
+          rowContainer->store(hashers[i]->decodedVector(), row, newRow, i);
+        }
+      }
+    }
+    table->prepareJoinTable({});
+    return table;
+  }
+
+  // Probes 'table' with the probe side and lists all the matches.
+  // Returns the number of matches.
+  int64_t joinProbe(HashTable<true>& table) {
+    HashLookup lookup(table.hashers());
+    BaseHashTable::JoinResultIterator results;
+    DecodedVector decoded;
+    std::vector<uint64_t> scratch;
+    std::vector<vector_size_t> outputRows(kBatchSize);
+    std::vector<char*> hits(kBatchSize);
+    auto& hashers = table.hashers();
+    auto mode = table.hashMode();
+    int64_t numHits = 0;
+    for (const auto& batch : probeBatches_) {
+      SelectivityVector rows(batch->size());
+      lookup.reset(batch->size());
+      for (auto i = 0; i < hashers.size(); ++i) {
+        auto key = batch->childAt(i);
+        if (mode != BaseHashTable::HashMode::kHash) {
+          decoded.decode(*key, rows);
+          hashers[i]->lookupValueIds(decoded, rows, scratch, &lookup.hashes);
+        } else {
+          hashers[i]->hash(*key, rows, i > 0, &lookup.hashes);
+        }
+      }
+      lookup.rows.clear();
+      rows.applyToSelected([&](auto row) { lookup.rows.push_back(row); });
+      if (lookup.rows.empty()) {
+        continue;
+      }
+      table.joinProbe(lookup);
+      results.reset(lookup);
+      while (!results.atEnd()) {
+        numHits += table.listJoinResults(
+            results,
+            folly::Range(outputRows.data(), outputRows.size()),
+            folly::Range(hits.data(), hits.size()));
+      }
+    }
+    return numHits;
+  }
+
+  // Runs an inner join of the probe side with the build side in a
+  // single Driver. Returns the number of result rows.
+  int64_t hashJoin() {
+    std::vector<ChannelIndex> keys(case_.keys->types.size());
+    std::iota(keys.begin(), keys.end(), 0);
+    CursorParameters params;
+    params.planNode = PlanBuilder(0)
+                          .values(probeBatches_)
+                          .hashJoin(
+                              keys,
+                              keys,
+                              PlanBuilder(100).values(buildBatches_).planNode(),
+                              "",
+                              keys)
+                          .planNode();
+    auto [cursor, results] = readCursor(params, [](Task*) {});
+    return numRows(results);
+  }
+
+ private:
+  static int64_t numRows(const std::vector<RowVectorPtr>& batches) {
+    int64_t numRows = 0;
+    for (const auto& batch : batches) {
+      numRows += batch->size();
+    }
+    return numRows;
+  }
+
+  static const std::vector<std::unique_ptr<Aggregate>>& noAggregates() {
+    static const std::vector<std::unique_ptr<Aggregate>> empty;
+    return empty;
+  }
+
+  std::vector<std::unique_ptr<VectorHasher>> makeHashers() const {
+    std::vector<std::unique_ptr<VectorHasher>> hashers;
+    for (auto i = 0; i < case_.keys->types.size(); ++i) {
+      hashers.push_back(
+          std::make_unique<VectorHasher>(case_.keys->types[i], i));
+    }
+    return hashers;
+  }
+
+  // Returns the value of part 'part' of key number 'key'.
+  int64_t keyPart(int32_t key, int32_t part) const {
+    auto numParts = case_.keys->types.size();
+    uint64_t value =
+        numParts == 1 ? key : (part == 0 ? key % 1000 : key / 1000);
+    return case_.dense ? value : value * 0x9E3779B97F4A7C15UL;
+  }
+
+  VectorPtr makeColumn(const std::vector<int32_t>& keys, int32_t part) {
+    auto size = keys.size();
+    if (case_.keys->types[part]->kind() == TypeKind::BIGINT) {
+      return vectorMaker_.flatVector<int64_t>(
+          size, [&](auto row) { return keyPart(keys[row], part); });
+    }
+    auto strings = std::static_pointer_cast<FlatVector<StringView>>(
+        BaseVector::create(VARCHAR(), size, pool_.get()));
+    for (auto row = 0; row < size; ++row) {
+      auto value = keyPart(keys[row], part);
+      // Dense strings are short enough for a value range. Sparse ones
+      // are over the inline size.
+      auto string = case_.dense ? fmt::format("{}", value)
+                                : fmt::format("key-{:016x}", value);
+      strings->set(row, StringView(string));
+    }
+    return strings;
+  }
+
+  std::vector<RowVectorPtr> makeBatches(
+      const std::vector<int32_t>& keys,
+      const std::string& prefix) {
+    std::vector<RowVectorPtr> batches;
+    const auto& types = case_.keys->types;
+    std::vector<std::string> names;
+    for (auto i = 0; i < types.size(); ++i) {
+      names.push_back(fmt::format("{}{}", prefix, i));
+    }
+    auto rowType = ROW(std::move(names), std::vector<TypePtr>(types));
+    for (auto start = 0; start < keys.size(); start += kBatchSize) {
+      std::vector<int32_t> batchKeys(
+          keys.begin() + start,
+          keys.begin() + std::min<size_t>(start + kBatchSize, keys.size()));
+      std::vector<VectorPtr> children;
+      for (auto i = 0; i < types.size(); ++i) {
+        children.push_back(makeColumn(batchKeys, i));
+      }
+      batches.push_back(std::make_shared<RowVector>(
+          pool_.get(),
+          rowType,
+          BufferPtr(nullptr),
+          batchKeys.size(),
+          std::move(children)));
+    }
+    return batches;
+  }
+
+  // Adds the keys of 'input' to 'table' the way HashAggregation does,
+  // switching the hash mode when the keys no longer fit the current
+  // one.
+  void insertGroups(
+      const RowVector& input,
+      HashLookup& lookup,
+      HashTable<false>& table) {
+    lookup.reset(input.size());
+    auto& hashers = table.hashers();
+    SelectivityVector rows(input.size());
+    auto mode = table.hashMode();
+    bool rehash = false;
+    for (auto i = 0; i < hashers.size(); ++i) {
+      auto key = input.childAt(hashers[i]->channel());
+      if (mode != BaseHashTable::HashMode::kHash) {
+        if (!hashers[i]->computeValueIds(
+                *key, rows, table.valueIdsFor(lookup, i))) {
+          rehash = true;
+        }
+      } else {
+        hashers[i]->hash(*key, rows, i > 0, &lookup.hashes);
+      }
+    }
+    if (rehash) {
+      table.decideHashMode(input.size());
+      insertGroups(input, lookup, table);
+      return;
+    }
+    std::iota(lookup.rows.begin(), lookup.rows.end(), 0);
+    table.groupProbe(lookup);
+  }
+
+  const BenchmarkCase case_;
+  std::unique_ptr<memory::MemoryPool> pool_{
+      memory::getDefaultScopedMemoryPool()};
+  memory::MappedMemory* mappedMemory_{memory::MappedMemory::getInstance()};
+  test::VectorMaker vectorMaker_{pool_.get()};
+  std::vector<RowVectorPtr> buildBatches_;
+  std::vector<RowVectorPtr> probeBatches_;
+};
+
+std::vector<BenchmarkCase> makeCases() {
+  // From L1 resident to far beyond the last level cache.
+  const std::vector<int32_t> sizes = {1'000, 100'000, 10'000'000};
+  const std::vector<int32_t> duplicates = {1, 16};
+  std::vector<BenchmarkCase> cases;
+  for (const auto& keys : keyShapes()) {
+    for (auto dense : {true, false}) {
+      for (auto size : sizes) {
+        for (auto numDuplicates : duplicates) {
+          cases.push_back({&keys, size, numDuplicates, dense});
+        }
+      }
+    }
+  }
+  return cases;
+}
+
+// Returns the data for 'benchmarkCase'. The benchmarks of a case run
+// one after the other, so only the data of the last case is kept.
+// Prints the hash modes when the data of a case is first made.
+HashTableBenchmark& benchmarkFor(const BenchmarkCase& benchmarkCase) {
+  static std::string currentName;
+  static std::unique_ptr<HashTableBenchmark> current;
+  auto name = benchmarkCase.name();
+  if (!current || currentName != name) {
+    current.reset();
+    current = std::make_unique<HashTableBenchmark>(benchmarkCase);
+    currentName = name;
+    std::cout << fmt::format(
+                     "{}: group by {}, join {}",
+                     name,
+                     hashModeName(current->groupProbe()),
+                     hashModeName(current->joinBuild()->hashMode()))
+              << std::endl;
+  }
+  return *current;
+}
+
+void addBenchmarks(const std::vector<BenchmarkCase>& cases) {
+  for (const auto& benchmarkCase : cases) {
+    auto name = benchmarkCase.name();
+    folly::addBenchmark(
+        __FILE__, "groupProbe_" + name, [=](unsigned iterations) {
+          HashTableBenchmark* benchmark;
+          BENCHMARK_SUSPEND {
+            benchmark = &benchmarkFor(benchmarkCase);
+          }
+          for (auto i = 0; i < iterations; ++i) {
+            folly::doNotOptimizeAway(benchmark->groupProbe());
+          }
+          return iterations * benchmark->numBuildRows();
+        });
+    folly::addBenchmark(
+        __FILE__, "joinBuild_" + name, [=](unsigned iterations) {
+          HashTableBenchmark* benchmark;
+          BENCHMARK_SUSPEND {
+            benchmark = &benchmarkFor(benchmarkCase);
+          }
+          for (auto i = 0; i < iterations; ++i) {
+            folly::doNotOptimizeAway(benchmark->joinBuild());
+          }
+          return iterations * benchmark->numBuildRows();
+        });
+    folly::addBenchmark(
+        __FILE__, "joinProbe_" + name, [=](unsigned iterations) {
+          HashTableBenchmark* benchmark;
+          std::unique_ptr<HashTable<true>> table;
+          BENCHMARK_SUSPEND {
+            benchmark = &benchmarkFor(benchmarkCase);
+            table = benchmark->joinBuild();
+          }
+          for (auto i = 0; i < iterations; ++i) {
+            folly::doNotOptimizeAway(benchmark->joinProbe(*table));
+          }
+          return iterations * benchmark->numProbeRows();
+        });
+    folly::addBenchmark(
+        __FILE__, "hashJoin_" + name, [=](unsigned iterations) {
+          HashTableBenchmark* benchmark;
+          BENCHMARK_SUSPEND {
+            benchmark = &benchmarkFor(benchmarkCase);
+          }
+          for (auto i = 0; i < iterations; ++i) {
+            folly::doNotOptimizeAway(benchmark->hashJoin());
+          }
+          return iterations *
+              (benchmark->numBuildRows() + benchmark->numProbeRows());
+        });
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  addBenchmarks(makeCases());
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Runs TPC-H style queries end to end over DWRF files. The data is
+// generated with the TPC-H extension of DuckDB. Each query runs at each
+// of the thread counts in --tpch_num_threads. Reports the wall time of
+// each run and the OperatorStats of the last run of each query and
+// thread count. Decimals are stored as DOUBLE and dates as VARCHAR
+// since the plans only compare and add them.
+
+#include <filesystem>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+
+#include "velox/common/file/FileSystems.h"
+#include "velox/connectors/hive/HiveConnector.h"
+#include "velox/dwio/common/DataSink.h"
+#include "velox/dwio/dwrf/writer/Writer.h"
+#include "velox/duckdb/conversion/DuckWrapper.h"
+#include "velox/exec/Exchange.h"
+#include "velox/exec/tests/HiveConnectorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+#include "velox/exec/tests/QueryAssertions.h"
+#include "velox/exec/tests/utils/FunctionUtils.h"
+#include "velox/functions/prestosql/CoreFunctions.h"
+#include "velox/functions/prestosql/VectorFunctions.h"
+#include "velox/serializers/PrestoSerializer.h"
+
+DEFINE_double(tpch_scale_factor, 0.1, "TPC-H scale factor of the data");
+DEFINE_string(
+    tpch_data_path,
+    "",
+    "Directory of the DWRF files. The tables are generated if the "
+    "directory has no files for them. A temporary directory is used "
+    "if empty");
+DEFINE_int32(tpch_rows_per_file, 100'000, "Rows per generated DWRF file");
+DEFINE_string(tpch_queries, "1,3,6,9,18", "Comma separated query numbers");
+DEFINE_string(
+    tpch_num_threads,
+    "1,4,16",
+    "Comma separated thread counts. Each query runs with this many "
+    "threads and Drivers per pipeline");
+DEFINE_int32(tpch_num_repeats, 3, "Runs of each query per thread count");
+DEFINE_bool(
+    tpch_operator_stats,
+    true,
+    "Print the OperatorStats of the last run of each query");
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+static const core::SortOrder kAsc(true, false);
+static const core::SortOrder kDesc(false, false);
+
+// A generated table and the DuckDB query that reads it in the stored
+// types.
+struct TpchTable {
+  std::string name;
+  std::string select;
+};
+
+const std::vector<TpchTable>& tpchTables() {
+  static const std::vector<TpchTable> tables = {
+      {"lineitem",
+       "SELECT CAST(l_orderkey AS BIGINT) AS l_orderkey, "
+       "CAST(l_partkey AS BIGINT) AS l_partkey, "
+       "CAST(l_suppkey AS BIGINT) AS l_suppkey, "
+       "CAST(l_quantity AS DOUBLE) AS l_quantity, "
+       "CAST(l_extendedprice AS DOUBLE) AS l_extendedprice, "
+       "CAST(l_discount AS DOUBLE) AS l_discount, "
+       "CAST(l_tax AS DOUBLE) AS l_tax, "
+       "l_returnflag, l_linestatus, "
+       "CAST(l_shipdate AS VARCHAR) AS l_shipdate FROM lineitem"},
+      {"orders",
+       "SELECT CAST(o_orderkey AS BIGINT) AS o_orderkey, "
+       "CAST(o_custkey AS BIGINT) AS o_custkey, "
+       "CAST(o_totalprice AS DOUBLE) AS o_totalprice, "
+       "CAST(o_orderdate AS VARCHAR) AS o_orderdate, "
+       "CAST(o_shippriority AS INTEGER) AS o_shippriority FROM orders"},
+      {"customer",
+       "SELECT CAST(c_custkey AS BIGINT) AS c_custkey, c_name, "
+       "c_mktsegment FROM customer"},
+      {"part",
+       "SELECT CAST(p_partkey AS BIGINT) AS p_partkey, p_name FROM part"},
+      {"supplier",
+       "SELECT CAST(s_suppkey AS BIGINT) AS s_suppkey, "
+       "CAST(s_nationkey AS BIGINT) AS s_nationkey FROM supplier"},
+      {"partsupp",
+       "SELECT CAST(ps_partkey AS BIGINT) AS ps_partkey, "
+       "CAST(ps_suppkey AS BIGINT) AS ps_suppkey, "
+       "CAST(ps_supplycost AS DOUBLE) AS ps_supplycost FROM partsupp"},
+      {"nation",
+       "SELECT CAST(n_nationkey AS BIGINT) AS n_nationkey, n_name "
+       "FROM nation"},
+  };
+  return tables;
+}
+
+std::vector<int32_t> parseList(const std::string& list) {
+  std::vector<std::string> parts;
+  folly::split(',', list, parts, true);
+  std::vector<int32_t> values;
+  for (const auto& part : parts) {
+    values.push_back(folly::to<int32_t>(folly::trimWhitespace(part)));
+  }
+  return values;
+}
+
+// A plan and the tables read by each of its TableScanNodes.
+struct TpchPlan {
+  std::shared_ptr<const core::PlanNode> plan;
+  std::unordered_map<core::PlanNodeId, std::string> scans;
+};
+
+class TpchBenchmark {
+ public:
+  TpchBenchmark()
+      : pool_(memory::getDefaultScopedMemoryPool()),
+        queryCtx_(core::QueryCtx::create()),
+        execCtx_(pool_.get(), queryCtx_.get()) {}
+
+  void initialize() {
+    filesystems::registerLocalFileSystem();
+    functions::registerFunctions();
+    functions::registerVectorFunctions();
+    registerTypeResolver();
+    ExchangeSource::registerFactory();
+    if (!isRegisteredVectorSerde()) {
+      serializer::presto::PrestoVectorSerde::registerVectorSerde();
+    }
+    ioExecutor_ = std::make_unique<folly::IOThreadPoolExecutor>(8);
+    connector::registerConnector(
+        connector::getConnectorFactory(connector::hive::kHiveConnectorName)
+            ->newConnector(
+                kHiveConnectorId, nullptr, nullptr, ioExecutor_.get()));
+
+    dataPath_ = FLAGS_tpch_data_path;
+    if (dataPath_.empty()) {
+      tempDir_ = std::filesystem::temp_directory_path() /
+          fmt::format("velox_tpch_{}", getpid());
+      dataPath_ = tempDir_.string();
+    }
+    std::filesystem::create_directories(dataPath_);
+    generateTables();
+  }
+
+  ~TpchBenchmark() {
+    if (!tempDir_.empty()) {
+      std::filesystem::remove_all(tempDir_);
+    }
+    connector::unregisterConnector(kHiveConnectorId);
+  }
+
+  void run() {
+    for (auto query : parseList(FLAGS_tpch_queries)) {
+      for (auto numThreads : parseList(FLAGS_tpch_num_threads)) {
+        runQuery(query, numThreads);
+      }
+    }
+  }
+
+ private:
+  // Writes each table in files of --tpch_rows_per_file rows unless the
+  // files are already there.
+  void generateTables() {
+    facebook::velox::duckdb::DuckDBWrapper db(&execCtx_);
+    bool generated = false;
+    for (const auto& table : tpchTables()) {
+      auto dir = std::filesystem::path(dataPath_) / table.name;
+      if (std::filesystem::exists(dir) && !std::filesystem::is_empty(dir)) {
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+          files_[table.name].push_back(entry.path().string());
+        }
+        std::sort(files_[table.name].begin(), files_[table.name].end());
+        auto result = db.execute(table.select + " LIMIT 0");
+        VELOX_CHECK(result->success(), result->errorMessage());
+        types_[table.name] = result->getType();
+        continue;
+      }
+      if (!generated) {
+        auto result = db.execute(
+            fmt::format("CALL dbgen(sf={})", FLAGS_tpch_scale_factor));
+        VELOX_CHECK(result->success(), result->errorMessage());
+        generated = true;
+      }
+      std::filesystem::create_directories(dir);
+      auto result = db.execute(table.select);
+      VELOX_CHECK(result->success(), result->errorMessage());
+      types_[table.name] = result->getType();
+      std::vector<RowVectorPtr> vectors;
+      int64_t numRows = 0;
+      while (result->next()) {
+        vectors.push_back(result->getVector());
+        numRows += vectors.back()->size();
+        if (numRows >= FLAGS_tpch_rows_per_file) {
+          writeFile(table.name, dir, vectors);
+          numRows = 0;
+        }
+      }
+      if (!vectors.empty()) {
+        writeFile(table.name, dir, vectors);
+      }
+    }
+  }
+
+  void writeFile(
+      const std::string& table,
+      const std::filesystem::path& dir,
+      std::vector<RowVectorPtr>& vectors) {
+    auto path =
+        (dir / fmt::format("{:05d}.dwrf", files_[table].size())).string();
+    dwrf::WriterOptions options;
+    options.config = std::make_shared<dwrf::Config>();
+    options.schema = vectors[0]->type();
+    dwrf::Writer writer{
+        options,
+        std::make_unique<dwio::common::FileSink>(path),
+        pool_->addChild(table, std::numeric_limits<int64_t>::max())};
+    for (const auto& vector : vectors) {
+      writer.write(vector);
+    }
+    writer.close();
+    files_[table].push_back(path);
+    vectors.clear();
+  }
+
+  // Returns the columns of 'table' in 'names'.
+  RowTypePtr columns(
+      const std::string& table,
+      const std::vector<std::string>& names) {
+    const auto& type = types_.at(table);
+    std::vector<TypePtr> types;
+    for (const auto& name : names) {
+      types.push_back(type->findChild(name));
+    }
+    return ROW(std::vector<std::string>(names), std::move(types));
+  }
+
+  // Returns a PlanBuilder whose plan node ids do not collide with
+  // those of the other builders of the plan.
+  PlanBuilder builder() {
+    nextPlanNodeId_ += 100;
+    return PlanBuilder(nextPlanNodeId_);
+  }
+
+  PlanBuilder& scan(
+      PlanBuilder& builder,
+      const std::string& table,
+      const std::vector<std::string>& names) {
+    builder.tableScan(columns(table, names));
+    scans_[builder.planNode()->id()] = table;
+    return builder;
+  }
+
+  // Pricing summary report. Scan, filter, project and aggregation.
+  std::shared_ptr<core::PlanNode> q1() {
+    auto partial = builder();
+    scan(
+        partial,
+        "lineitem",
+        {"l_returnflag",
+         "l_linestatus",
+         "l_quantity",
+         "l_extendedprice",
+         "l_discount",
+         "l_tax",
+         "l_shipdate"})
+        .filter("l_shipdate <= '1998-09-02'")
+        .project(
+            {"l_returnflag",
+             "l_linestatus",
+             "l_quantity",
+             "l_extendedprice",
+             "l_extendedprice * (1.0 - l_discount)",
+             "l_extendedprice * (1.0 - l_discount) * (1.0 + l_tax)",
+             "l_discount"},
+            {"l_returnflag",
+             "l_linestatus",
+             "l_quantity",
+             "l_extendedprice",
+             "disc_price",
+             "charge",
+             "l_discount"})
+        .partialAggregation(
+            {0, 1},
+            {"sum(l_quantity)",
+             "sum(l_extendedprice)",
+             "sum(disc_price)",
+             "sum(charge)",
+             "avg(l_quantity)",
+             "avg(l_extendedprice)",
+             "avg(l_discount)",
+             "count(0)"});
+    return builder()
+        .localPartition({}, {partial.planNode()})
+        .finalAggregation(
+            {0, 1},
+            {"sum(a0)",
+             "sum(a1)",
+             "sum(a2)",
+             "sum(a3)",
+             "avg(a4)",
+             "avg(a5)",
+             "avg(a6)",
+             "sum(a7)"})
+        .orderBy({0, 1}, {kAsc, kAsc}, false)
+        .planNode();
+  }
+
+  // Shipping priority. Two joins, aggregation and top N.
+  std::shared_ptr<core::PlanNode> q3() {
+    auto customers = builder();
+    scan(customers, "customer", {"c_custkey", "c_mktsegment"})
+        .filter("c_mktsegment = 'BUILDING'")
+        .project({"c_custkey"});
+    auto orders = builder();
+    scan(
+        orders,
+        "orders",
+        {"o_orderkey", "o_custkey", "o_orderdate", "o_shippriority"})
+        .filter("o_orderdate < '1995-03-15'")
+        .hashJoin({1}, {0}, customers.planNode(), "", {0, 2, 3});
+    auto partial = builder();
+    scan(
+        partial,
+        "lineitem",
+        {"l_orderkey", "l_extendedprice", "l_discount", "l_shipdate"})
+        .filter("l_shipdate > '1995-03-15'")
+        .project(
+            {"l_orderkey", "l_extendedprice * (1.0 - l_discount)"},
+            {"l_orderkey", "l_revenue"})
+        .hashJoin({0}, {0}, orders.planNode(), "", {0, 1, 3, 4})
+        .partialAggregation({0, 2, 3}, {"sum(l_revenue)"});
+    return builder()
+        .localPartition({}, {partial.planNode()})
+        .finalAggregation({0, 1, 2}, {"sum(a0)"})
+        .topN({3, 1}, {kDesc, kAsc}, 10, false)
+        .planNode();
+  }
+
+  // Forecasting revenue change. A selective scan and a global
+  // aggregation.
+  std::shared_ptr<core::PlanNode> q6() {
+    auto partial = builder();
+    scan(
+        partial,
+        "lineitem",
+        {"l_shipdate", "l_discount", "l_quantity", "l_extendedprice"})
+        .filter(
+            "l_shipdate >= '1994-01-01' AND l_shipdate < '1995-01-01' AND "
+            "l_discount >= 0.05 AND l_discount <= 0.07 AND "
+            "l_quantity < 24.0")
+        .project({"l_extendedprice * l_discount"}, {"revenue"})
+        .partialAggregation({}, {"sum(revenue)"});
+    return builder()
+        .localPartition({}, {partial.planNode()})
+        .finalAggregation({}, {"sum(a0)"})
+        .planNode();
+  }
+
+  // Product type profit measure. Five joins probed by lineitem.
+  std::shared_ptr<core::PlanNode> q9() {
+    auto parts = builder();
+    scan(parts, "part", {"p_partkey", "p_name"})
+        .filter("strpos(p_name, 'green') > 0")
+        .project({"p_partkey"});
+    auto suppliers = builder();
+    scan(suppliers, "supplier", {"s_suppkey", "s_nationkey"});
+    auto partsupps = builder();
+    scan(partsupps, "partsupp", {"ps_partkey", "ps_suppkey", "ps_supplycost"});
+    auto orders = builder();
+    scan(orders, "orders", {"o_orderkey", "o_orderdate"});
+    auto nations = builder();
+    scan(nations, "nation", {"n_nationkey", "n_name"});
+
+    auto partial = builder();
+    scan(
+        partial,
+        "lineitem",
+        {"l_orderkey",
+         "l_partkey",
+         "l_suppkey",
+         "l_quantity",
+         "l_extendedprice",
+         "l_discount"})
+        .hashJoin({1}, {0}, parts.planNode(), "", {0, 1, 2, 3, 4, 5})
+        // + s_nationkey.
+        .hashJoin({2}, {0}, suppliers.planNode(), "", {0, 1, 2, 3, 4, 5, 7})
+        // l_orderkey, l_quantity, l_extendedprice, l_discount,
+        // s_nationkey, ps_supplycost.
+        .hashJoin({1, 2}, {0, 1}, partsupps.planNode(), "", {0, 3, 4, 5, 6, 9})
+        // + o_orderdate, - l_orderkey.
+        .hashJoin({0}, {0}, orders.planNode(), "", {1, 2, 3, 4, 5, 7})
+        // + n_name, - s_nationkey.
+        .hashJoin({3}, {0}, nations.planNode(), "", {0, 1, 2, 4, 5, 7})
+        .project(
+            {"n_name",
+             "substr(o_orderdate, 1, 4)",
+             "l_extendedprice * (1.0 - l_discount) - "
+             "ps_supplycost * l_quantity"},
+            {"nation", "o_year", "amount"})
+        .partialAggregation({0, 1}, {"sum(amount)"});
+    return builder()
+        .localPartition({}, {partial.planNode()})
+        .finalAggregation({0, 1}, {"sum(a0)"})
+        .orderBy({0, 1}, {kAsc, kDesc}, false)
+        .planNode();
+  }
+
+  // Large volume customer. An aggregation with a filter on the result
+  // as a build side, then joins, aggregation and top N.
+  std::shared_ptr<core::PlanNode> q18() {
+    auto quantities = builder();
+    scan(quantities, "lineitem", {"l_orderkey", "l_quantity"})
+        .partialAggregation({0}, {"sum(l_quantity)"});
+    auto bigOrders = builder();
+    bigOrders.localPartition({0}, {quantities.planNode()})
+        .finalAggregation({0}, {"sum(a0)"})
+        .filter("a0 > 300.0")
+        .project({"l_orderkey"}, {"big_orderkey"});
+    auto customers = builder();
+    scan(customers, "customer", {"c_custkey", "c_name"});
+    auto orders = builder();
+    scan(
+        orders,
+        "orders",
+        {"o_orderkey", "o_custkey", "o_orderdate", "o_totalprice"})
+        .hashJoin({0}, {0}, bigOrders.planNode(), "", {0, 1, 2, 3})
+        // + c_name.
+        .hashJoin({1}, {0}, customers.planNode(), "", {0, 1, 2, 3, 5});
+    auto partial = builder();
+    scan(partial, "lineitem", {"l_orderkey", "l_quantity"})
+        // l_quantity, o_orderkey, o_custkey, o_orderdate, o_totalprice,
+        // c_name.
+        .hashJoin({0}, {0}, orders.planNode(), "", {1, 2, 3, 4, 5, 6})
+        .partialAggregation({5, 2, 1, 3, 4}, {"sum(l_quantity)"});
+    return builder()
+        .localPartition({}, {partial.planNode()})
+        .finalAggregation({0, 1, 2, 3, 4}, {"sum(a0)"})
+        .topN({4, 3}, {kDesc, kAsc}, 100, false)
+        .planNode();
+  }
+
+  TpchPlan makePlan(int32_t query) {
+    nextPlanNodeId_ = 0;
+    scans_.clear();
+    std::shared_ptr<const core::PlanNode> plan;
+    switch (query) {
+      case 1:
+        plan = q1();
+        break;
+      case 3:
+        plan = q3();
+        break;
+      case 6:
+        plan = q6();
+        break;
+      case 9:
+        plan = q9();
+        break;
+      case 18:
+        plan = q18();
+        break;
+      default:
+        VELOX_USER_FAIL("TPC-H query {} is not supported", query);
+    }
+    return {plan, scans_};
+  }
+
+  void runQuery(int32_t query, int32_t numThreads) {
+    auto tpchPlan = makePlan(query);
+    auto executor = std::make_shared<folly::CPUThreadPoolExecutor>(numThreads);
+    std::shared_ptr<Task> task;
+    for (auto repeat = 0; repeat < FLAGS_tpch_num_repeats; ++repeat) {
+      CursorParameters params;
+      params.planNode = tpchPlan.plan;
+      params.maxDrivers = numThreads;
+      params.numResultDrivers = 1;
+      params.queryCtx = core::QueryCtx::create(
+          std::make_shared<core::MemConfig>(),
+          {},
+          memory::MappedMemory::getInstance(),
+          memory::getProcessDefaultMemoryManager().getRoot().addScopedChild(
+              core::QueryCtx::kQueryRootMemoryPool),
+          executor);
+
+      bool noMoreSplits = false;
+      auto start = std::chrono::steady_clock::now();
+      auto [cursor, results] = readCursor(params, [&](Task* task) {
+        if (noMoreSplits) {
+          return;
+        }
+        for (const auto& [planNodeId, table] : tpchPlan.scans) {
+          for (const auto& file : files_.at(table)) {
+            task->addSplit(
+                planNodeId, HiveConnectorTestBase::makeHiveSplit(file));
+          }
+          task->noMoreSplits(planNodeId);
+        }
+        noMoreSplits = true;
+      });
+      task = cursor->task();
+      // The last Drivers may still be closing after the results are in.
+      task->stateChangeFuture(10'000'000).wait();
+      auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+      int64_t numRows = 0;
+      for (const auto& result : results) {
+        numRows += result->size();
+      }
+      std::cout << fmt::format(
+                       "Q{} threads={} run={}: {:.3f} s, {} rows",
+                       query,
+                       numThreads,
+                       repeat,
+                       micros / 1'000'000.0,
+                       numRows)
+                << std::endl;
+    }
+    if (FLAGS_tpch_operator_stats && task) {
+      printOperatorStats(*task);
+    }
+  }
+
+  static void printOperatorStats(Task& task) {
+    auto taskStats = task.taskStats();
+    for (auto i = 0; i < taskStats.pipelineStats.size(); ++i) {
+      std::cout << fmt::format("  Pipeline {}:", i) << std::endl;
+      for (const auto& op : taskStats.pipelineStats[i].operatorStats) {
+        auto cpuNanos = op.addInputTiming.cpuNanos +
+            op.getOutputTiming.cpuNanos + op.finishTiming.cpuNanos;
+        auto wallNanos = op.addInputTiming.wallNanos +
+            op.getOutputTiming.wallNanos + op.finishTiming.wallNanos;
+        std::cout << fmt::format(
+                         "    {} {}: input {} rows, output {} rows, "
+                         "raw input {} bytes, cpu {:.1f} ms, wall {:.1f} ms, "
+                         "blocked {:.1f} ms, peak memory {} bytes",
+                         op.planNodeId,
+                         op.operatorType,
+                         op.inputPositions,
+                         op.outputPositions,
+                         op.rawInputBytes,
+                         cpuNanos / 1e6,
+                         wallNanos / 1e6,
+                         op.blockedWallNanos / 1e6,
+                         op.memoryStats.peakTotalMemoryReservation)
+                  << std::endl;
+      }
+    }
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::shared_ptr<core::QueryCtx> queryCtx_;
+  core::ExecCtx execCtx_;
+  std::unique_ptr<folly::IOThreadPoolExecutor> ioExecutor_;
+  std::string dataPath_;
+  // Set if the data goes to a temporary directory removed at exit.
+  std::filesystem::path tempDir_;
+  std::unordered_map<std::string, std::vector<std::string>> files_;
+  std::unordered_map<std::string, RowTypePtr> types_;
+  int32_t nextPlanNodeId_{0};
+  std::unordered_map<core::PlanNodeId, std::string> scans_;
+};
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  TpchBenchmark benchmark;
+  benchmark.initialize();
+  benchmark.run();
+  return 0;
+}
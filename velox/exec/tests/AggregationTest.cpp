@@ -438,5 +438,200 @@ TEST_F(AggregationTest, partialAggregationMemoryLimit) {
   assertQuery(params, "SELECT c0, count(1) FROM tmp GROUP BY 1");
 }
 
+TEST_F(AggregationTest, abandonPartialAggregation) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    // Nearly every key is unique. Keys repeat across batches after the
+    // first few.
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            batchSize,
+            [&](vector_size_t row) { return (row + i * batchSize) % 7'000; },
+            nullEvery(11)),
+        makeFlatVector<int64_t>(
+            batchSize, [&](vector_size_t row) { return row + i; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kAbandonPartialAggregationMinRows, "2000"},
+      {core::QueryCtx::kAbandonPartialAggregationMinPct, "80"},
+  });
+
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .partialAggregation({0}, {"count(1)", "sum(c1)", "max(c1)"})
+          .finalAggregation({0}, {"sum(a0)", "sum(a1)", "max(a2)"})
+          .planNode();
+
+  auto task = assertQuery(
+      params, "SELECT c0, count(1), sum(c1), max(c1) FROM tmp GROUP BY 1");
+
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  auto partialStats = std::find_if(stats.begin(), stats.end(), [](auto& op) {
+    return op.operatorType == "PartialAggregation";
+  });
+  ASSERT_NE(partialStats, stats.end());
+  EXPECT_EQ(
+      1, partialStats->runtimeStats["abandonedPartialAggregation"].sum);
+  // The partial aggregation passes most rows through.
+  EXPECT_GT(partialStats->outputPositions, 9'000);
+
+  // Keys with few distinct values keep the hash table.
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .project({"c0 % 10", "c1"}, {"c0", "c1"})
+          .partialAggregation({0}, {"count(1)", "sum(c1)", "max(c1)"})
+          .finalAggregation({0}, {"sum(a0)", "sum(a1)", "max(a2)"})
+          .planNode();
+
+  task = assertQuery(
+      params,
+      "SELECT c0 % 10, count(1), sum(c1), max(c1) FROM tmp GROUP BY 1");
+  stats = task->taskStats().pipelineStats[0].operatorStats;
+  partialStats = std::find_if(stats.begin(), stats.end(), [](auto& op) {
+    return op.operatorType == "PartialAggregation";
+  });
+  ASSERT_NE(partialStats, stats.end());
+  EXPECT_EQ(
+      0, partialStats->runtimeStats.count("abandonedPartialAggregation"));
+}
+
+TEST_F(AggregationTest, spill) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            batchSize,
+            [&](vector_size_t row) { return (row * 7 + i * 13) % 3000; },
+            nullEvery(7)),
+        makeFlatVector<int64_t>(
+            batchSize, [&](vector_size_t row) { return row + i; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  // Flush the partial aggregation after every batch and set a tiny
+  // spill threshold so that the final aggregation spills its groups
+  // before adding each batch after the first.
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kMaxPartialAggregationMemory, "100"},
+      {core::QueryCtx::kSpillEnabled, "true"},
+      {core::QueryCtx::kAggregationSpillMemoryThreshold, "1"},
+  });
+
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .partialAggregation({0}, {"count(1)", "sum(c1)", "max(c1)"})
+          .finalAggregation({0}, {"sum(a0)", "sum(a1)", "max(a2)"})
+          .planNode();
+
+  auto task = assertQuery(
+      params, "SELECT c0, count(1), sum(c1), max(c1) FROM tmp GROUP BY 1");
+
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  auto aggregationStats =
+      std::find_if(stats.begin(), stats.end(), [](auto& op) {
+        return op.operatorType == "Aggregation";
+      });
+  ASSERT_NE(aggregationStats, stats.end());
+  EXPECT_GT(aggregationStats->runtimeStats["spillRuns"].sum, 0);
+  EXPECT_GT(aggregationStats->runtimeStats["spilledRows"].sum, 0);
+}
+
+TEST_F(AggregationTest, sharedFinalAggregation) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000,
+            [&](vector_size_t row) { return (row * 7 + i * 13) % 3000; },
+            nullEvery(11)),
+        makeFlatVector<int64_t>(
+            1'000, [&](vector_size_t row) { return row + i; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  // Each of the 4 Drivers reads all of 'vectors'. There is no local
+  // exchange between the partial and final aggregations, so each group
+  // is correct only if the final aggregations share their groups.
+  CursorParameters params;
+  params.maxDrivers = 4;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSharedFinalAggregation, "true"},
+  });
+  params.planNode =
+      PlanBuilder()
+          .values(vectors, true)
+          .partialAggregation({0}, {"count(1)", "sum(c1)", "max(c1)"})
+          .finalAggregation({0}, {"sum(a0)", "sum(a1)", "max(a2)"})
+          .planNode();
+
+  assertQuery(
+      params,
+      "SELECT c0, 4 * count(1), 4 * sum(c1), max(c1) FROM tmp GROUP BY 1");
+}
+
+TEST_F(AggregationTest, distinctAggregates) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000, [&](vector_size_t row) { return (row + i) % 17; }),
+        makeFlatVector<int64_t>(
+            1'000,
+            [&](vector_size_t row) { return (row * 3 + i) % 50; },
+            nullEvery(7)),
+        makeFlatVector<int64_t>(
+            1'000, [&](vector_size_t row) { return row * i; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  // Distinct and non-distinct aggregates over the same column in one
+  // operator.
+  auto op = PlanBuilder()
+                .values(vectors)
+                .aggregation(
+                    {0},
+                    {"count(c1)", "sum(c1)", "count(c1)", "max(c2)"},
+                    {},
+                    core::AggregationNode::Step::kSingle,
+                    false,
+                    {},
+                    {true, true, false, false})
+                .planNode();
+  assertQuery(
+      op,
+      "SELECT c0, count(DISTINCT c1), sum(DISTINCT c1), count(c1), max(c2) "
+      "FROM tmp GROUP BY 1");
+
+  op = PlanBuilder()
+           .values(vectors)
+           .aggregation(
+               {},
+               {"count(c1)", "sum(c2)", "sum(c1)"},
+               {},
+               core::AggregationNode::Step::kSingle,
+               false,
+               {},
+               {true, true, false})
+           .planNode();
+  assertQuery(
+      op, "SELECT count(DISTINCT c1), sum(DISTINCT c2), sum(c1) FROM tmp");
+}
+
 } // namespace
 } // namespace facebook::velox::exec::test
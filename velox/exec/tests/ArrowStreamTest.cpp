@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/ArrowStreamSink.h"
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+#include "velox/vector/arrow/Bridge.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+// Arrow stream over a list of vectors. Fails after 'failAfter' batches.
+class VectorArrowStream {
+ public:
+  VectorArrowStream(
+      std::vector<RowVectorPtr> vectors,
+      std::optional<int32_t> failAfter = std::nullopt)
+      : vectors_(std::move(vectors)), failAfter_(failAfter) {}
+
+  static std::shared_ptr<ArrowArrayStream> make(
+      std::vector<RowVectorPtr> vectors,
+      std::optional<int32_t> failAfter = std::nullopt) {
+    auto stream = std::shared_ptr<ArrowArrayStream>(
+        new ArrowArrayStream(), [](ArrowArrayStream* stream) {
+          stream->release(stream);
+          delete stream;
+        });
+    stream->get_schema = getSchema;
+    stream->get_next = getNext;
+    stream->get_last_error = getLastError;
+    stream->release = release;
+    stream->private_data =
+        new VectorArrowStream(std::move(vectors), failAfter);
+    return stream;
+  }
+
+ private:
+  static VectorArrowStream& self(ArrowArrayStream* stream) {
+    return *static_cast<VectorArrowStream*>(stream->private_data);
+  }
+
+  static int getSchema(ArrowArrayStream* stream, ArrowSchema* out) {
+    exportToArrow(self(stream).vectors_[0]->type(), *out);
+    return 0;
+  }
+
+  static int getNext(ArrowArrayStream* stream, ArrowArray* out) {
+    auto& state = self(stream);
+    if (state.failAfter_.has_value() && state.next_ == *state.failAfter_) {
+      return EIO;
+    }
+    if (state.next_ == state.vectors_.size()) {
+      out->release = nullptr;
+      return 0;
+    }
+    exportToArrow(state.vectors_[state.next_++], *out);
+    return 0;
+  }
+
+  static const char* getLastError(ArrowArrayStream* /*stream*/) {
+    return "Test stream failure";
+  }
+
+  static void release(ArrowArrayStream* stream) {
+    delete &self(stream);
+    stream->release = nullptr;
+  }
+
+  const std::vector<RowVectorPtr> vectors_;
+  const std::optional<int32_t> failAfter_;
+  int32_t next_{0};
+};
+
+class ArrowStreamTest : public OperatorTestBase {
+ protected:
+  std::vector<RowVectorPtr> makeVectors(int32_t numVectors) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numVectors; ++i) {
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              100, [i](auto row) { return i * 100 + row; }, nullEvery(7)),
+          makeFlatVector<StringView>(
+              100,
+              [](auto row) {
+                static const std::string kValue(20, 'x');
+                return StringView(kValue.data(), row % 20);
+              }),
+          makeArrayVector<int32_t>(
+              100,
+              [](auto row) { return row % 5; },
+              [](auto row, auto idx) { return row + idx; }),
+      }));
+    }
+    return vectors;
+  }
+
+  // Reads all batches of 'arrowStream' and releases it.
+  std::vector<RowVectorPtr> readStream(ArrowArrayStream& arrowStream) {
+    ArrowSchema arrowSchema;
+    EXPECT_EQ(0, arrowStream.get_schema(&arrowStream, &arrowSchema));
+    auto type = importFromArrow(arrowSchema);
+    arrowSchema.release(&arrowSchema);
+
+    std::vector<RowVectorPtr> results;
+    for (;;) {
+      ArrowArray arrowArray;
+      ArrowSchema batchSchema;
+      EXPECT_EQ(0, arrowStream.get_next(&arrowStream, &arrowArray))
+          << arrowStream.get_last_error(&arrowStream);
+      if (!arrowArray.release) {
+        break;
+      }
+      exportToArrow(type, batchSchema);
+      results.push_back(std::dynamic_pointer_cast<RowVector>(
+          importFromArrowAsOwner(batchSchema, arrowArray, pool_.get())));
+    }
+    arrowStream.release(&arrowStream);
+    return results;
+  }
+};
+
+TEST_F(ArrowStreamTest, source) {
+  auto vectors = makeVectors(5);
+  createDuckDbTable(vectors);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(vectors[0]->type());
+
+  auto plan = PlanBuilder()
+                  .arrowStream(rowType, VectorArrowStream::make(vectors))
+                  .filter("c0 % 3 = 1")
+                  .project({"c0", "c1", "cardinality(c2)"})
+                  .planNode();
+  assertQuery(
+      plan, "SELECT c0, c1, cardinality(c2) FROM tmp WHERE c0 % 3 = 1");
+
+  // Arrow names do not need to match the plan's.
+  auto renamed = ROW({"a", "b", "c"}, rowType->children());
+  plan = PlanBuilder()
+             .arrowStream(renamed, VectorArrowStream::make(vectors))
+             .project({"a", "b"})
+             .planNode();
+  assertQuery(plan, "SELECT c0, c1 FROM tmp");
+}
+
+TEST_F(ArrowStreamTest, sourceErrors) {
+  auto vectors = makeVectors(3);
+  createDuckDbTable(vectors);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(vectors[0]->type());
+
+  auto plan = PlanBuilder()
+                  .arrowStream(rowType, VectorArrowStream::make(vectors, 2))
+                  .planNode();
+  EXPECT_THROW(assertQuery(plan, "SELECT * FROM tmp"), VeloxException);
+
+  // The stream type must match the plan type.
+  auto otherType = ROW({"c0"}, {BIGINT()});
+  plan = PlanBuilder()
+             .arrowStream(otherType, VectorArrowStream::make(vectors))
+             .planNode();
+  EXPECT_THROW(assertQuery(plan, "SELECT c0 FROM tmp"), VeloxException);
+}
+
+TEST_F(ArrowStreamTest, sink) {
+  auto vectors = makeVectors(10);
+  createDuckDbTable(vectors);
+
+  // Constant columns are flattened on export.
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .project({"c0", "c1", "c2", "17"})
+                  .planNode();
+  ArrowArrayStream arrowStream;
+  exportToArrowStream(plan, core::QueryCtx::create(), arrowStream);
+  auto results = readStream(arrowStream);
+  EXPECT_EQ(nullptr, arrowStream.release);
+  assertResults(
+      results,
+      plan->outputType(),
+      "SELECT *, 17::BIGINT FROM tmp",
+      duckDbQueryRunner_);
+
+  // Producers block once more than the buffered bytes are waiting.
+  exportToArrowStream(plan, core::QueryCtx::create(), arrowStream, 1, 1);
+  results = readStream(arrowStream);
+  assertResults(
+      results,
+      plan->outputType(),
+      "SELECT *, 17::BIGINT FROM tmp",
+      duckDbQueryRunner_);
+}
+
+TEST_F(ArrowStreamTest, sinkToSource) {
+  auto vectors = makeVectors(5);
+  createDuckDbTable(vectors);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(vectors[0]->type());
+
+  auto stream = std::shared_ptr<ArrowArrayStream>(
+      new ArrowArrayStream(), [](ArrowArrayStream* stream) {
+        stream->release(stream);
+        delete stream;
+      });
+  exportToArrowStream(
+      PlanBuilder().values(vectors).filter("c0 % 2 = 0").planNode(),
+      core::QueryCtx::create(),
+      *stream);
+  auto plan = PlanBuilder()
+                  .arrowStream(rowType, stream)
+                  .singleAggregation({}, {"count(1)", "sum(c0)"})
+                  .planNode();
+  assertQuery(plan, "SELECT count(1), sum(c0) FROM tmp WHERE c0 % 2 = 0");
+}
+
+TEST_F(ArrowStreamTest, sinkError) {
+  auto vectors = makeVectors(3);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(vectors[0]->type());
+  auto plan = PlanBuilder()
+                  .arrowStream(rowType, VectorArrowStream::make(vectors, 1))
+                  .planNode();
+  ArrowArrayStream arrowStream;
+  exportToArrowStream(plan, core::QueryCtx::create(), arrowStream);
+
+  ArrowArray arrowArray;
+  int result;
+  while ((result = arrowStream.get_next(&arrowStream, &arrowArray)) == 0) {
+    ASSERT_NE(nullptr, arrowArray.release);
+    arrowArray.release(&arrowArray);
+  }
+  EXPECT_EQ(EIO, result);
+  EXPECT_NE(nullptr, arrowStream.get_last_error(&arrowStream));
+  arrowStream.release(&arrowStream);
+}
+
+TEST_F(ArrowStreamTest, releaseStreamBeforeArrays) {
+  auto vectors = makeVectors(10);
+  auto plan = PlanBuilder().values(vectors).planNode();
+  ArrowArrayStream arrowStream;
+  exportToArrowStream(plan, core::QueryCtx::create(), arrowStream);
+
+  // The exported array keeps the memory of the Task alive.
+  ArrowArray arrowArray;
+  ASSERT_EQ(0, arrowStream.get_next(&arrowStream, &arrowArray));
+  ASSERT_NE(nullptr, arrowArray.release);
+  arrowStream.release(&arrowStream);
+
+  ArrowSchema arrowSchema;
+  exportToArrow(plan->outputType(), arrowSchema);
+  auto vector = importFromArrowAsOwner(arrowSchema, arrowArray, pool_.get());
+  EXPECT_EQ(100, vector->size());
+  for (auto i = 0; i < vector->size(); ++i) {
+    ASSERT_TRUE(vector->equalValueAt(vectors[0].get(), i, i));
+  }
+}
+
+} // namespace
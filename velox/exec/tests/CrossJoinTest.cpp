@@ -220,3 +220,90 @@ TEST_F(CrossJoinTest, zeroColumnBuild) {
 
   assertQuery(op, "SELECT * FROM t");
 }
+
+TEST_F(CrossJoinTest, filter) {
+  auto leftVectors = {
+      makeRowVector({sequence<int32_t>(10)}),
+      makeRowVector({sequence<int32_t>(100, 10)}),
+      makeRowVector({sequence<int32_t>(1'000, 10 + 100)}),
+  };
+
+  auto rightVectors = {
+      makeRowVector({sequence<int32_t>(10)}),
+      makeRowVector({sequence<int32_t>(100, 10)}),
+      makeRowVector({sequence<int32_t>(2'000, 10 + 100)}),
+  };
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto buildSide = [&](const std::string& filter) {
+    return PlanBuilder(0)
+        .values({rightVectors})
+        .filter(filter)
+        .project({"c0"}, {"u_c0"})
+        .planNode();
+  };
+
+  // Several probe rows per output batch.
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .crossJoin(buildSide("c0 < 50"), "c0 % 7 = u_c0 % 5", {0, 1})
+                .planNode();
+  assertQuery(
+      op, "SELECT * FROM t, u WHERE u.c0 < 50 AND t.c0 % 7 = u.c0 % 5");
+
+  // One probe row per output batch. Most batches have no passing rows.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .crossJoin(buildSide("c0 < 2000"), "c0 + u_c0 = 1000", {0, 1})
+           .planNode();
+  assertQuery(
+      op, "SELECT * FROM t, u WHERE u.c0 < 2000 AND t.c0 + u.c0 = 1000");
+
+  // Filter on build columns that are not in the output.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .crossJoin(buildSide("c0 < 20"), "u_c0 > c0", {0})
+           .planNode();
+  assertQuery(op, "SELECT t.c0 FROM t, u WHERE u.c0 < 20 AND u.c0 > t.c0");
+}
+
+TEST_F(CrossJoinTest, smallBuildBatches) {
+  // The build side comes in many one-row batches. These are combined so
+  // that each output batch covers many probe and build rows.
+  std::vector<RowVectorPtr> rightVectors;
+  for (auto i = 0; i < 30; ++i) {
+    rightVectors.push_back(makeRowVector({sequence<int32_t>(1, i)}));
+  }
+  auto leftVectors = {makeRowVector({sequence<int32_t>(1'000)})};
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", rightVectors);
+
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .crossJoin(
+                    PlanBuilder(0)
+                        .values(rightVectors)
+                        .project({"c0"}, {"u_c0"})
+                        .planNode(),
+                    {0, 1})
+                .planNode();
+
+  assertQuery(op, "SELECT * FROM t, u");
+
+  // With a filter.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .crossJoin(
+               PlanBuilder(0)
+                   .values(rightVectors)
+                   .project({"c0"}, {"u_c0"})
+                   .planNode(),
+               "c0 % 30 = u_c0",
+               {0, 1})
+           .planNode();
+
+  assertQuery(op, "SELECT * FROM t, u WHERE t.c0 % 30 = u.c0");
+}
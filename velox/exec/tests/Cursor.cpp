@@ -105,7 +105,7 @@ bool TaskQueue::hasNext() {
 int32_t TaskCursor::serial_;
 
 TaskCursor::TaskCursor(const CursorParameters& params)
-    : maxDrivers_{params.maxDrivers} {
+    : maxDrivers_{params.maxDrivers}, numSplitGroups_{params.numSplitGroups} {
   std::shared_ptr<core::QueryCtx> queryCtx;
   if (params.queryCtx) {
     queryCtx = params.queryCtx;
@@ -115,6 +115,8 @@ TaskCursor::TaskCursor(const CursorParameters& params)
   auto numProducers = params.numResultDrivers.has_value()
       ? params.numResultDrivers.value()
       : params.maxDrivers;
+  // Each split group has its own result Drivers.
+  numProducers *= std::max(1, params.numSplitGroups);
   queue_ = std::make_shared<TaskQueue>(numProducers, params.bufferedBytes);
   // Captured as a shared_ptr by the consumer callback of task_.
   auto queue = queue_;
@@ -142,7 +144,7 @@ TaskCursor::TaskCursor(const CursorParameters& params)
 bool TaskCursor::moveNext() {
   if (!started_) {
     started_ = true;
-    exec::Task::start(task_, maxDrivers_);
+    exec::Task::start(task_, maxDrivers_, numSplitGroups_);
   }
   current_ = queue_->dequeue();
   if (task_->error()) {
@@ -29,6 +29,9 @@ struct CursorParameters {
   // Number of drivers for the pipeline that produces task results. Cannot
   // exceed numThreads, but can be less.
   std::optional<int32_t> numResultDrivers;
+  // Number of split groups for grouped execution, 0 if not grouped. See
+  // Task::start().
+  int32_t numSplitGroups = 0;
   // Optional, created if not present.
   std::shared_ptr<core::QueryCtx> queryCtx;
   uint64_t bufferedBytes = 512 * 1024;
@@ -109,6 +112,7 @@ class TaskCursor {
 
  private:
   const int32_t maxDrivers_;
+  const int32_t numSplitGroups_;
   bool started_ = false;
   std::shared_ptr<TaskQueue> queue_;
   std::shared_ptr<exec::Task> task_;
@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/init/Init.h>
 #include "velox/dwio/dwrf/test/utils/BatchMaker.h"
 #include "velox/exec/tests/Cursor.h"
@@ -462,6 +463,124 @@ TEST_F(DriverTest, yield) {
   }
 }
 
+TEST_F(DriverTest, timeSlice) {
+  // Drivers of the low priority query yield after each microsecond and
+  // compete for the threads with a high priority query whose Drivers
+  // yield after each batch.
+  constexpr int32_t kNumTasks = 2;
+  constexpr int32_t kThreadsPerTask = 5;
+  std::vector<int32_t> counters(kNumTasks, 0);
+  std::vector<CursorParameters> params(kNumTasks);
+  int32_t hits;
+  for (int32_t i = 0; i < kNumTasks; ++i) {
+    params[i].planNode = makeValuesFilterProject(
+        rowType_,
+        "m1 % 10 > 0",
+        "m1 % 3 + m2 % 5 + m3 % 7 + m4 % 11 + m5 % 13 + m6 % 17 + m7 % 19",
+        200,
+        2'000,
+        [](int64_t num) { return num % 10 > 0; },
+        &hits);
+    params[i].maxDrivers = kThreadsPerTask;
+    params[i].queryCtx = core::QueryCtx::create();
+    params[i].queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kDriverPriority, i == 0 ? "-1" : "1"},
+        {core::QueryCtx::kDriverTimeSliceMicros, i == 0 ? "1" : "0"},
+        {core::QueryCtx::kDriverTimeSliceBatches, i == 0 ? "0" : "1"},
+    });
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(kNumTasks);
+  for (int32_t i = 0; i < kNumTasks; ++i) {
+    threads.push_back(std::thread([this, &params, &counters, i]() {
+      readResults(
+          params[i], ResultOperation::kRead, 1'000'000, &counters[i], i);
+    }));
+  }
+  for (int32_t i = 0; i < kNumTasks; ++i) {
+    threads[i].join();
+    EXPECT_EQ(counters[i], kThreadsPerTask * hits);
+    EXPECT_TRUE(stateFutures_.at(i).isReady());
+  }
+}
+
+TEST_F(DriverTest, parallelDriverCreation) {
+  constexpr int32_t kNumDrivers = 16;
+  auto executor = std::make_shared<folly::CPUThreadPoolExecutor>(4);
+  for (auto parallel : {true, false}) {
+    int32_t hits;
+    CursorParameters params;
+    params.planNode = makeValuesFilterProject(
+        rowType_,
+        "m1 % 10 > 0",
+        "m1 % 3 + m2 % 5",
+        100,
+        1'000,
+        [](int64_t num) { return num % 10 > 0; },
+        &hits);
+    params.maxDrivers = kNumDrivers;
+    params.queryCtx = core::QueryCtx::create(
+        std::make_shared<core::MemConfig>(),
+        {},
+        memory::MappedMemory::getInstance(),
+        memory::getProcessDefaultMemoryManager().getRoot().addScopedChild(
+            "parallelDriverCreation"),
+        executor);
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kParallelDriverCreationEnabled,
+         parallel ? "true" : "false"},
+    });
+    int32_t numRead = 0;
+    readResults(params, ResultOperation::kRead, 1'000'000, &numRead);
+    EXPECT_EQ(numRead, kNumDrivers * hits);
+    auto& operatorStats =
+        tasks_.back()->taskStats().pipelineStats[0].operatorStats;
+    ASSERT_FALSE(operatorStats.empty());
+    for (auto i = 0; i < operatorStats.size(); ++i) {
+      EXPECT_EQ(operatorStats[i].operatorId, i);
+    }
+    tasks_.clear();
+    stateFutures_.clear();
+  }
+}
+
+TEST_F(DriverTest, trace) {
+  CursorParameters params;
+  int32_t hits;
+  params.planNode = makeValuesFilterProject(
+      rowType_,
+      "m1 % 10 > 0",
+      "m1 % 3 + m2 % 5",
+      100,
+      10,
+      [](int64_t num) { return num % 10 > 0; },
+      &hits);
+  params.maxDrivers = 2;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kTraceEventsPerThread, "1000"},
+      {core::QueryCtx::kDriverTimeSliceBatches, "1"},
+  });
+  int32_t numRead = 0;
+  readResults(params, ResultOperation::kRead, 1'000'000, &numRead);
+  EXPECT_EQ(numRead, 2 * hits);
+
+  auto& recorder = tasks_[0]->traceRecorder();
+  ASSERT_TRUE(recorder != nullptr);
+  bool hasRun = false;
+  bool hasYield = false;
+  for (auto& event : recorder->events()) {
+    EXPECT_NE(event.track, 0);
+    hasRun |= std::string(event.name) == "run";
+    hasYield |= std::string(event.name) == "yield";
+  }
+  EXPECT_TRUE(hasRun);
+  EXPECT_TRUE(hasYield);
+  auto trace = tasks_[0]->toChromeTrace();
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(trace.find("pipeline 0 driver 1"), std::string::npos);
+}
+
 // A testing Operator that periodically does one of the following:
 //
 // 1. Blocks and registers a resume that continues the Driver after a timed
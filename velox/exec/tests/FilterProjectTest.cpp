@@ -200,6 +200,43 @@ TEST_F(FilterProjectTest, projectOverLazy) {
   assertQuery(plan, "SELECT c0 > 0 AND c1 > 0, c1 + 5.2 FROM tmp");
 }
 
+TEST_F(FilterProjectTest, loadLazyForNeededRows) {
+  vector_size_t size = 1'000;
+  int32_t numLoaded = 0;
+  auto lazyVectors = makeRowVector({
+      makeFlatVector<int32_t>(size, [](auto row) { return row; }),
+      std::make_shared<LazyVector>(
+          pool_.get(),
+          BIGINT(),
+          size,
+          std::make_unique<facebook::velox::test::SimpleVectorLoader>(
+              [&](RowSet rows) {
+                numLoaded += rows.size();
+                return makeFlatVector<int64_t>(
+                    rows.back() + 1, [](auto row) { return row; });
+              })),
+  });
+
+  auto vectors = makeRowVector({
+      makeFlatVector<int32_t>(size, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+  });
+
+  createDuckDbTable({vectors});
+
+  auto plan = PlanBuilder()
+                  .values({lazyVectors})
+                  .filter("c0 % 2 = 0")
+                  .project({"c0", "c0 % 4 = 0 AND c1 > 10"})
+                  .planNode();
+  assertQuery(
+      plan, "SELECT c0, c0 % 4 = 0 AND c1 > 10 FROM tmp WHERE c0 % 2 = 0");
+
+  // c1 is used by one projection only and is loaded for the rows that
+  // pass both the filter and the first conjunct.
+  EXPECT_EQ(numLoaded, size / 4);
+}
+
 TEST_F(FilterProjectTest, filterProject) {
   std::vector<RowVectorPtr> vectors;
   for (int32_t i = 0; i < 10; ++i) {
@@ -310,3 +347,79 @@ TEST_F(FilterProjectTest, filterProjectFused) {
       plan,
       "SELECT c0, c1, c0 %100 + c1 % 50, c0 % 100 FROM tmp WHERE c0 % 10 < 5");
 }
+
+TEST_F(FilterProjectTest, chainFused) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto vector = std::dynamic_pointer_cast<RowVector>(
+        BatchMaker::createBatch(rowType_, 100, *pool_));
+    vectors.push_back(vector);
+  }
+  createDuckDbTable(vectors);
+
+  // 'd' is not read after the second projection and 'e' is filtered on
+  // before it is projected.
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .project(
+                      std::vector<std::string>{"c0", "c1 % 7", "c0 * 2"},
+                      std::vector<std::string>{"c0", "e", "d"})
+                  .filter("e > 2")
+                  .project(
+                      std::vector<std::string>{"c0 % 100", "e + 1"},
+                      std::vector<std::string>{"a", "b"})
+                  .filter("a < 50")
+                  .planNode();
+
+  auto task = assertQuery(
+      plan,
+      "SELECT c0 % 100, c1 % 7 + 1 FROM tmp "
+      "WHERE c1 % 7 > 2 AND c0 % 100 < 50");
+
+  // The four nodes run as one operator.
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(1, std::count_if(stats.begin(), stats.end(), [](auto& op) {
+              return op.operatorType == "FilterProject";
+            }));
+}
+
+TEST_F(FilterProjectTest, exprStats) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto vector = std::dynamic_pointer_cast<RowVector>(
+        BatchMaker::createBatch(rowType_, 100, *pool_));
+    vectors.push_back(vector);
+  }
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kExprTrackStats, "true"},
+  });
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .filter("c1 % 10  > 0")
+          .project(std::vector<std::string>{"c0", "c1", "c0 + c1"})
+          .planNode();
+
+  auto task = assertQuery(
+      params, "SELECT c0, c1, c0 + c1 FROM tmp WHERE c1 % 10 > 0");
+
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  auto filterProjectStats =
+      std::find_if(stats.begin(), stats.end(), [](auto& op) {
+        return op.operatorType == "FilterProject";
+      });
+  ASSERT_NE(filterProjectStats, stats.end());
+  auto& runtimeStats = filterProjectStats->runtimeStats;
+  // The filter is evaluated on all rows, the projection on the passing
+  // rows.
+  EXPECT_EQ(1'000, runtimeStats["expr.gt.numRows"].sum);
+  EXPECT_EQ(10, runtimeStats["expr.gt.numCalls"].sum);
+  EXPECT_EQ(
+      filterProjectStats->outputPositions,
+      runtimeStats["expr.plus.numRows"].sum);
+  EXPECT_EQ(10, runtimeStats["expr.mod.numCalls"].sum);
+}
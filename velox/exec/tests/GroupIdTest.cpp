@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec::test;
+
+class GroupIdTest : public OperatorTestBase {
+ protected:
+  std::vector<RowVectorPtr> makeVectors() {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < 3; ++i) {
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int32_t>(1'000, [](auto row) { return row % 7; }),
+          makeFlatVector<int32_t>(
+              1'000,
+              [](auto row) { return row % 11; },
+              nullEvery(13)),
+          makeFlatVector<int64_t>(
+              1'000, [i](auto row) { return i * 1'000 + row; }),
+      }));
+    }
+    return vectors;
+  }
+
+  // Returns DuckDB SQL computing sum(c2) and count(1) for each of
+  // 'groupingSets'. Each grouping set is a pair of flags telling whether c0
+  // and c1 are grouping keys.
+  static std::string expectedSql(
+      const std::vector<std::pair<bool, bool>>& groupingSets) {
+    std::string sql;
+    for (auto i = 0; i < groupingSets.size(); ++i) {
+      auto [hasC0, hasC1] = groupingSets[i];
+      if (i > 0) {
+        sql += " UNION ALL ";
+      }
+      sql += fmt::format(
+          "SELECT {}, {}, CAST({} AS BIGINT), sum(c2), count(1) FROM tmp",
+          hasC0 ? "c0" : "null",
+          hasC1 ? "c1" : "null",
+          i);
+      if (hasC0 && hasC1) {
+        sql += " GROUP BY 1, 2";
+      } else if (hasC0) {
+        sql += " GROUP BY 1";
+      } else if (hasC1) {
+        sql += " GROUP BY 2";
+      }
+    }
+    return sql;
+  }
+};
+
+TEST_F(GroupIdTest, rollup) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .groupId({{"c0", "c1"}, {"c0"}, {}}, {"c2"})
+                  .singleAggregation({0, 1, 3}, {"sum(c2)", "count(1)"})
+                  .planNode();
+  assertQuery(plan, expectedSql({{true, true}, {true, false}, {false, false}}));
+}
+
+TEST_F(GroupIdTest, cube) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .groupId({{"c0", "c1"}, {"c0"}, {"c1"}, {}}, {"c2"})
+                  .singleAggregation({0, 1, 3}, {"sum(c2)", "count(1)"})
+                  .planNode();
+  assertQuery(
+      plan,
+      expectedSql(
+          {{true, true}, {true, false}, {false, true}, {false, false}}));
+
+  // The grouping keys are ordered by their first appearance, so c1 comes
+  // first.
+  plan = PlanBuilder()
+             .values(vectors)
+             .groupId({{"c1"}, {"c0"}}, {"c2"})
+             .singleAggregation({0, 1, 3}, {"sum(c2)", "count(1)"})
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT c1, c0, g, s, n FROM ("
+      "SELECT null AS c0, c1, CAST(0 AS BIGINT) AS g, sum(c2) AS s, "
+      "count(1) AS n FROM tmp GROUP BY 2 UNION ALL "
+      "SELECT c0, null, CAST(1 AS BIGINT), sum(c2), count(1) "
+      "FROM tmp GROUP BY 1) t");
+}
+
+TEST_F(GroupIdTest, rollupFromPartial) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  // The coarser grouping sets are combined from the partial aggregates of
+  // the finest one.
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .partialAggregation({0, 1}, {"sum(c2)", "count(1)"})
+                  .groupId({{"c0", "c1"}, {"c0"}, {}}, {"a0", "a1"})
+                  .finalAggregation({0, 1, 4}, {"sum(a0)", "count(a1)"})
+                  .planNode();
+  assertQuery(plan, expectedSql({{true, true}, {true, false}, {false, false}}));
+}
+
+TEST_F(GroupIdTest, invalidNode) {
+  auto vectors = makeVectors();
+  EXPECT_THROW(
+      PlanBuilder().values(vectors).groupId({{"c0"}}, {"c0"}),
+      VeloxException);
+  EXPECT_THROW(
+      PlanBuilder().values(vectors).groupId({{"c0"}}, {"c2"}, "c2"),
+      VeloxException);
+  EXPECT_THROW(
+      PlanBuilder().values(vectors).groupId({}, {"c2"}), VeloxException);
+}
@@ -15,6 +15,7 @@
  */
 
 #include "velox/dwio/dwrf/test/utils/BatchMaker.h"
+#include "velox/exec/HashTableCache.h"
 #include "velox/exec/tests/Cursor.h"
 #include "velox/exec/tests/HiveConnectorTestBase.h"
 #include "velox/exec/tests/PlanBuilder.h"
@@ -150,6 +151,25 @@ TEST_F(HashJoinTest, bigintArrayParallel) {
       "  WHERE t_k0 = u_k0");
 }
 
+TEST_F(HashJoinTest, parallelTableBuild) {
+  // Each of the 4 Drivers on either side produces all of the rows, so
+  // the build has 60000 rows in 4 tables that are inserted in parallel.
+  const std::string fourTimes = "SELECT * FROM {0} UNION ALL "
+                                "SELECT * FROM {0} UNION ALL "
+                                "SELECT * FROM {0} UNION ALL "
+                                "SELECT * FROM {0}";
+  auto sql = fmt::format(
+      "SELECT t_k0, t_k1, t_data, u_k0, u_k1, u_data FROM "
+      "  ({}) t, ({}) u "
+      "  WHERE t_k0 = u_k0 AND t_k1 = u_k1",
+      fmt::format(fourTimes, "t"),
+      fmt::format(fourTimes, "u"));
+  // Value ids and normalized keys.
+  testJoin({BIGINT(), INTEGER()}, 4, 2000, 15000, sql);
+  // Hashed keys.
+  testJoin({DOUBLE(), BIGINT()}, 4, 2000, 15000, sql);
+}
+
 TEST_F(HashJoinTest, emptyBuild) {
   testJoin(
       {BIGINT()},
@@ -280,6 +300,106 @@ TEST_F(HashJoinTest, lazyVectors) {
       "SELECT t.c1 + 1 FROM t, u WHERE t.c0 = u.c0");
 }
 
+TEST_F(HashJoinTest, lazyVectorsLoadedForMatches) {
+  // 20 probe rows have a match. Each of these gets 200 rows of output, so
+  // that the output for the probe input comes in several batches.
+  vector_size_t size = 2'000;
+  int32_t numLoaded = 0;
+  auto keyAt = [](auto row) -> int32_t { return row % 1'000; };
+  auto leftVectors = makeRowVector({
+      makeFlatVector<int32_t>(size, keyAt),
+      std::make_shared<LazyVector>(
+          pool_.get(),
+          BIGINT(),
+          size,
+          std::make_unique<facebook::velox::test::SimpleVectorLoader>(
+              [&](RowSet rows) {
+                numLoaded += rows.size();
+                return makeFlatVector<int64_t>(
+                    rows.back() + 1, [](auto row) { return row; });
+              })),
+  });
+
+  auto rightVectors = makeRowVector(
+      {makeFlatVector<int32_t>(size, [](auto row) { return row % 10; })});
+
+  createDuckDbTable(
+      "t",
+      {makeRowVector({
+          makeFlatVector<int32_t>(size, keyAt),
+          makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+      })});
+  createDuckDbTable("u", {rightVectors});
+
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .hashJoin(
+                    {0},
+                    {0},
+                    PlanBuilder(0).values({rightVectors}).planNode(),
+                    "",
+                    {1})
+                .planNode();
+
+  assertQuery(op, "SELECT t.c1 FROM t, u WHERE t.c0 = u.c0");
+  EXPECT_EQ(numLoaded, 20);
+}
+
+TEST_F(HashJoinTest, lazyBuildColumns) {
+  // Build-side columns are extracted only for the rows that pass the filter
+  // after the join and only if they are projected.
+  auto leftVectors = makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 23; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+  });
+  auto rightVectors = makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 31; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row * 10; }),
+      makeFlatVector<StringView>(
+          1'000,
+          [](auto row) {
+            return StringView(row % 2 ? "a string that is not inlined" : "");
+          }),
+  });
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .hashJoin(
+                    {0},
+                    {0},
+                    PlanBuilder(0)
+                        .values({rightVectors})
+                        .project({"c0", "c1", "c2"}, {"u0", "u1", "u2"})
+                        .planNode(),
+                    "",
+                    {1, 3, 4})
+                .filter("c1 % 10 = 0")
+                .project({"u1"})
+                .planNode();
+  assertQuery(op, "SELECT u.c1 FROM t, u WHERE t.c0 = u.c0 AND t.c1 % 10 = 0");
+
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .hashJoin(
+               {0},
+               {0},
+               PlanBuilder(0)
+                   .values({rightVectors})
+                   .project({"c0", "c1", "c2"}, {"u0", "u1", "u2"})
+                   .planNode(),
+               "",
+               {1, 3, 4},
+               core::JoinType::kLeft)
+           .filter("c1 % 7 = 0")
+           .planNode();
+  assertQuery(
+      op,
+      "SELECT t.c1, u.c1, u.c2 FROM t LEFT JOIN u ON t.c0 = u.c0 "
+      "WHERE t.c1 % 7 = 0");
+}
+
 /// Test hash join where build-side keys come from a small range and allow for
 /// array-based lookup instead of a hash table.
 TEST_F(HashJoinTest, arrayBasedLookup) {
@@ -400,6 +520,98 @@ TEST_F(HashJoinTest, semiJoin) {
 
   assertQuery(
       op, "SELECT t.c1 FROM t WHERE t.c0 IN (SELECT c0 FROM u WHERE c0 < 0)");
+
+  // Build side with duplicate keys and a non-key column that is not
+  // in the output and is therefore not stored in the table.
+  auto rightWithPayload = makeRowVector({
+      makeFlatVector<int32_t>(
+          500, [](auto row) { return row % 7; }, nullEvery(11)),
+      makeFlatVector<int64_t>(500, [](auto row) { return row * 10; }),
+  });
+  createDuckDbTable("v", {rightWithPayload});
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .hashJoin(
+               {0},
+               {0},
+               PlanBuilder(0)
+                   .values({rightWithPayload})
+                   .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                   .planNode(),
+               "",
+               {1},
+               core::JoinType::kSemi)
+           .planNode();
+
+  assertQuery(op, "SELECT t.c1 FROM t WHERE t.c0 IN (SELECT c0 FROM v)");
+}
+
+TEST_F(HashJoinTest, reorderSemiJoins) {
+  // The first join passes 90% of the rows, the second one 10%.
+  std::vector<RowVectorPtr> leftVectors;
+  for (auto i = 0; i < 50; ++i) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(1'000, [](auto row) { return row % 100; }),
+        makeFlatVector<int64_t>(1'000, [](auto row) { return row % 10; }),
+    }));
+  }
+  auto rightVectors = makeRowVector({
+      makeFlatVector<int64_t>(90, [](auto row) { return row; }),
+  });
+  auto otherRightVectors = makeRowVector({
+      makeFlatVector<int64_t>(1, [](auto /*row*/) { return 0; }),
+  });
+
+  createDuckDbTable("t", leftVectors);
+  createDuckDbTable("u", {rightVectors});
+  createDuckDbTable("v", {otherRightVectors});
+
+  auto test = [&](bool reorderingEnabled) {
+    CursorParameters params;
+    params.planNode =
+        PlanBuilder(10)
+            .values(leftVectors)
+            .hashJoin(
+                {0},
+                {0},
+                PlanBuilder(0).values({rightVectors}).planNode(),
+                "",
+                {0, 1},
+                core::JoinType::kSemi)
+            .hashJoin(
+                {1},
+                {0},
+                PlanBuilder(5).values({otherRightVectors}).planNode(),
+                "",
+                {0, 1},
+                core::JoinType::kSemi)
+            .planNode();
+    params.queryCtx = core::QueryCtx::create();
+    // Yield after every batch so that the Driver can reorder the joins
+    // between batches.
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kDriverTimeSliceBatches, "1"},
+        {core::QueryCtx::kAdaptiveFilterReorderingEnabled,
+         reorderingEnabled ? "true" : "false"},
+    });
+    return assertQuery(
+        params,
+        "SELECT c0, c1 FROM t WHERE c0 IN (SELECT c0 FROM u) "
+        "AND c1 IN (SELECT c0 FROM v)");
+  };
+
+  // The second join moves ahead of the first one once both have seen
+  // enough rows. The first join then probes only the rows that pass
+  // the second one.
+  auto task = test(true);
+  auto stats = task->taskStats().pipelineStats.front().operatorStats;
+  EXPECT_EQ(1, stats[2].runtimeStats["numReorders"].count);
+  EXPECT_LT(getInputPositions(task, 1), 25'000);
+
+  task = test(false);
+  stats = task->taskStats().pipelineStats.front().operatorStats;
+  EXPECT_EQ(0, stats[2].runtimeStats.count("numReorders"));
+  EXPECT_EQ(50'000, getInputPositions(task, 1));
 }
 
 TEST_F(HashJoinTest, antiJoin) {
@@ -704,6 +916,79 @@ TEST_F(HashJoinTest, dynamicFilters) {
   }
 }
 
+TEST_F(HashJoinTest, bloomFilters) {
+  // String keys do not make IN filters, so these are filtered with a
+  // BloomFilter.
+  std::vector<RowVectorPtr> leftVectors;
+  auto leftFiles = makeFilePaths(20);
+  for (int i = 0; i < 20; i++) {
+    auto rowVector = makeRowVector({
+        makeFlatVector<StringView>(
+            1'024,
+            [&](auto row) {
+              return StringView(fmt::format("key{}", row + i * 13));
+            }),
+        makeFlatVector<int64_t>(1'024, [](auto row) { return row; }),
+    });
+    leftVectors.push_back(rowVector);
+    writeToFile(leftFiles[i]->path, kWriter, rowVector);
+  }
+
+  auto rightKeys = makeFlatVector<StringView>(100, [](auto row) {
+    return StringView(fmt::format("key{}", 35 + row * 7));
+  });
+  auto rightVectors = {makeRowVector({rightKeys})};
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto probeType = ROW({"c0", "c1"}, {VARCHAR(), BIGINT()});
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors)
+                       .project({"c0"}, {"u_c0"})
+                       .planNode();
+
+  auto test = [&](bool bloomFilterEnabled) {
+    CursorParameters params;
+    params.planNode = PlanBuilder(10)
+                          .tableScan(probeType)
+                          .hashJoin({0}, {0}, buildSide, "", {0, 1})
+                          .planNode();
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kHashJoinBloomFilterEnabled,
+         bloomFilterEnabled ? "true" : "false"},
+    });
+    bool noMoreSplits = false;
+    auto addSplits = [&](Task* task) {
+      if (noMoreSplits) {
+        return;
+      }
+      for (auto& file : leftFiles) {
+        addSplit(task, "10", makeHiveSplit(file->path));
+      }
+      task->noMoreSplits("10");
+      noMoreSplits = true;
+    };
+    return ::assertQuery(
+        params,
+        addSplits,
+        "SELECT t.c0, t.c1 FROM t, u WHERE t.c0 = u.c0",
+        duckDbQueryRunner_);
+  };
+
+  auto task = test(true);
+  EXPECT_EQ(1, getFiltersProduced(task, 1).sum);
+  EXPECT_EQ(1, getFiltersAccepted(task, 0).sum);
+  // A BloomFilter passes some keys that are not on the build side, so
+  // the join stays.
+  EXPECT_EQ(0, getReplacedWithFilterRows(task, 1).sum);
+  EXPECT_LT(getInputPositions(task, 1), 1024 * 20);
+
+  task = test(false);
+  EXPECT_EQ(0, getFiltersProduced(task, 1).sum);
+  EXPECT_EQ(getInputPositions(task, 1), 1024 * 20);
+}
+
 TEST_F(HashJoinTest, leftJoin) {
   // Left side keys are [0, 1, 2,..10].
   auto leftVectors = {
@@ -908,3 +1193,285 @@ TEST_F(HashJoinTest, rightJoin) {
       op,
       "SELECT t.c0, t.c1, u.c1 FROM t RIGHT JOIN u ON t.c0 = u.c0 AND (t.c1 + u.c1) % 2 = 3");
 }
+
+TEST_F(HashJoinTest, parallelRightJoin) {
+  // Each of the 4 Drivers on both sides produces all rows, so that the
+  // build side has 4 RowContainers and each probe Driver lists the
+  // not-probed rows of one of them.
+  constexpr int32_t kNumDrivers = 4;
+  std::vector<RowVectorPtr> leftVectors = {makeRowVector({
+      makeFlatVector<int32_t>(
+          1'000, [](auto row) { return row % 300; }, nullEvery(13)),
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row; }),
+  })};
+  std::vector<RowVectorPtr> rightVectors = {makeRowVector({
+      makeFlatVector<int32_t>(
+          500, [](auto row) { return row * 2; }, nullEvery(11)),
+      makeFlatVector<int32_t>(500, [](auto row) { return -row; }),
+  })};
+  std::vector<RowVectorPtr> allLeft;
+  std::vector<RowVectorPtr> allRight;
+  for (auto i = 0; i < kNumDrivers; ++i) {
+    allLeft.push_back(leftVectors[0]);
+    allRight.push_back(rightVectors[0]);
+  }
+  createDuckDbTable("t", allLeft);
+  createDuckDbTable("u", allRight);
+
+  CursorParameters params;
+  params.maxDrivers = kNumDrivers;
+  params.planNode =
+      PlanBuilder(10)
+          .values(leftVectors, true)
+          .hashJoin(
+              {0},
+              {0},
+              PlanBuilder(0)
+                  .values(rightVectors, true)
+                  .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                  .planNode(),
+              "",
+              {0, 1, 3},
+              core::JoinType::kRight)
+          .planNode();
+  ::assertQuery(
+      params,
+      [](auto*) {},
+      "SELECT t.c0, t.c1, u.c1 FROM t RIGHT JOIN u ON t.c0 = u.c0",
+      duckDbQueryRunner_);
+}
+
+TEST_F(HashJoinTest, hashTableCache) {
+  std::vector<RowVectorPtr> leftVectors = {makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 300; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+  })};
+  std::vector<RowVectorPtr> rightVectors;
+  auto rightFiles = makeFilePaths(5);
+  for (auto i = 0; i < rightFiles.size(); ++i) {
+    auto rowVector = makeRowVector({
+        makeFlatVector<int32_t>(50, [&](auto row) { return i * 50 + row; }),
+        makeFlatVector<int64_t>(50, [](auto row) { return row * 10; }),
+    });
+    rightVectors.push_back(rowVector);
+    writeToFile(rightFiles[i]->path, kWriter, rowVector);
+  }
+  createDuckDbTable("t", leftVectors);
+
+  auto plan = PlanBuilder(10)
+                  .values(leftVectors)
+                  .hashJoin(
+                      {0},
+                      {0},
+                      PlanBuilder(20)
+                          .tableScan(ROW({"c0", "c1"}, {INTEGER(), BIGINT()}))
+                          .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                          .planNode(),
+                      "",
+                      {0, 1, 3})
+                  .planNode();
+
+  auto* cache = HashTableCache::getInstance();
+  cache->clear();
+
+  // Joins with the first 'numFiles' files of the build side.
+  auto test = [&](bool cacheEnabled, int32_t numFiles) {
+    createDuckDbTable(
+        "u",
+        std::vector<RowVectorPtr>(
+            rightVectors.begin(), rightVectors.begin() + numFiles));
+    CursorParameters params;
+    params.planNode = plan;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kHashTableCacheEnabled,
+         cacheEnabled ? "true" : "false"},
+    });
+    bool noMoreSplits = false;
+    auto addSplits = [&](Task* task) {
+      if (noMoreSplits) {
+        return;
+      }
+      for (auto i = 0; i < numFiles; ++i) {
+        auto split = makeHiveConnectorSplit(rightFiles[i]->path);
+        split->fileModificationTime = 1;
+        task->addSplit("20", exec::Split(std::move(split)));
+      }
+      task->noMoreSplits("20");
+      noMoreSplits = true;
+    };
+    ::assertQuery(
+        params,
+        addSplits,
+        "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0",
+        duckDbQueryRunner_);
+  };
+
+  test(false, 5);
+  EXPECT_EQ(0, cache->numMisses());
+  EXPECT_EQ(0, cache->cachedBytes());
+
+  test(true, 5);
+  EXPECT_EQ(1, cache->numMisses());
+  EXPECT_EQ(0, cache->numHits());
+  auto cachedBytes = cache->cachedBytes();
+  EXPECT_LT(0, cachedBytes);
+
+  // A query over the same splits probes the cached table.
+  test(true, 5);
+  EXPECT_EQ(1, cache->numHits());
+  EXPECT_EQ(cachedBytes, cache->cachedBytes());
+
+  // Other splits make another table.
+  test(true, 3);
+  EXPECT_EQ(2, cache->numMisses());
+  EXPECT_LT(cachedBytes, cache->cachedBytes());
+
+  cache->clear();
+}
+
+TEST_F(HashJoinTest, groupedExecution) {
+  // Both sides are bucketed on the key into 'kNumGroups' buckets, one
+  // file per bucket and side. Each split group joins one bucket.
+  constexpr int32_t kNumGroups = 4;
+  std::vector<RowVectorPtr> leftVectors;
+  std::vector<RowVectorPtr> rightVectors;
+  auto leftFiles = makeFilePaths(kNumGroups);
+  auto rightFiles = makeFilePaths(kNumGroups);
+  for (auto i = 0; i < kNumGroups; ++i) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            1'000, [&](auto row) { return row * kNumGroups + i; }),
+        makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+    }));
+    writeToFile(leftFiles[i]->path, kWriter, leftVectors.back());
+    rightVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            300, [&](auto row) { return row * kNumGroups * 3 + i; }),
+        makeFlatVector<int64_t>(300, [](auto row) { return -row; }),
+    }));
+    writeToFile(rightFiles[i]->path, kWriter, rightVectors.back());
+  }
+  createDuckDbTable("t", leftVectors);
+  createDuckDbTable("u", rightVectors);
+
+  auto type = ROW({"c0", "c1"}, {INTEGER(), BIGINT()});
+  CursorParameters params;
+  params.maxDrivers = 2;
+  params.numSplitGroups = kNumGroups;
+  params.planNode = PlanBuilder(10)
+                        .tableScan(type)
+                        .hashJoin(
+                            {0},
+                            {0},
+                            PlanBuilder(20)
+                                .tableScan(type)
+                                .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                                .planNode(),
+                            "",
+                            {0, 1, 3})
+                        .planNode();
+
+  bool noMoreSplits = false;
+  auto addSplits = [&](Task* task) {
+    if (noMoreSplits) {
+      return;
+    }
+    // The groups arrive in reverse order.
+    for (auto i = kNumGroups - 1; i >= 0; --i) {
+      auto leftSplit = makeHiveSplit(leftFiles[i]->path);
+      leftSplit.groupId = i;
+      task->addSplit("10", std::move(leftSplit));
+      task->noMoreSplitsForGroup("10", i);
+      auto rightSplit = makeHiveSplit(rightFiles[i]->path);
+      rightSplit.groupId = i;
+      task->addSplit("20", std::move(rightSplit));
+      task->noMoreSplitsForGroup("20", i);
+    }
+    task->noMoreSplits("10");
+    task->noMoreSplits("20");
+    noMoreSplits = true;
+  };
+  auto task = ::assertQuery(
+      params,
+      addSplits,
+      "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0",
+      duckDbQueryRunner_);
+  EXPECT_EQ(kNumGroups, task->taskStats().completedSplitGroups.size());
+}
+
+TEST_F(HashJoinTest, spill) {
+  std::vector<RowVectorPtr> leftVectors;
+  for (int32_t i = 0; i < 5; ++i) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            1'000,
+            [&](auto row) { return (row * 3 + i) % 1'500; },
+            nullEvery(17)),
+        makeFlatVector<int32_t>(1'000, [&](auto row) { return row + i; }),
+    }));
+  }
+  std::vector<RowVectorPtr> rightVectors;
+  for (int32_t i = 0; i < 5; ++i) {
+    rightVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            300,
+            [&](auto row) { return (row * 7 + i) % 2'000; },
+            nullEvery(13)),
+        makeFlatVector<int32_t>(300, [&](auto row) { return row - i; }),
+    }));
+  }
+
+  // The build side runs in two Drivers that each produce all of
+  // 'rightVectors'.
+  createDuckDbTable("t", leftVectors);
+  auto duplicatedRightVectors = rightVectors;
+  duplicatedRightVectors.insert(
+      duplicatedRightVectors.end(), rightVectors.begin(), rightVectors.end());
+  createDuckDbTable("u", duplicatedRightVectors);
+
+  // Set a tiny threshold so that the build side spills after every
+  // batch and the spilled partitions are partitioned again.
+  CursorParameters params;
+  params.maxDrivers = 2;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSpillEnabled, "true"},
+      {core::QueryCtx::kJoinSpillMemoryThreshold, "1"},
+  });
+
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors, true)
+                       .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                       .planNode();
+
+  auto test = [&](core::JoinType joinType, const std::string& sql) {
+    params.planNode =
+        PlanBuilder(10)
+            .values(leftVectors)
+            .hashJoin({0}, {0}, buildSide, "", {0, 1, 3}, joinType)
+            .planNode();
+    auto task = ::assertQuery(
+        params, [](auto*) {}, sql, duckDbQueryRunner_);
+
+    uint64_t spilledRows = 0;
+    for (auto& pipeline : task->taskStats().pipelineStats) {
+      for (auto& op : pipeline.operatorStats) {
+        if (op.operatorType == "HashBuild") {
+          spilledRows += op.runtimeStats["spilledRows"].sum;
+        }
+      }
+    }
+    EXPECT_GT(spilledRows, 0);
+  };
+
+  test(
+      core::JoinType::kInner,
+      "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0");
+  test(
+      core::JoinType::kLeft,
+      "SELECT t.c0, t.c1, u.c1 FROM t LEFT JOIN u ON t.c0 = u.c0");
+  test(
+      core::JoinType::kRight,
+      "SELECT t.c0, t.c1, u.c1 FROM t RIGHT JOIN u ON t.c0 = u.c0");
+}
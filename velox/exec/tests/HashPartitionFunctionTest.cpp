@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/HashPartitionFunction.h"
+#include <gtest/gtest.h>
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+TEST(HashPartitionFunctionTest, basic) {
+  constexpr int32_t kNumPartitions = 7;
+  constexpr vector_size_t kSize = 10'003;
+  auto pool = memory::getDefaultScopedMemoryPool();
+  test::VectorMaker vm(pool.get());
+  // Each key is repeated at rows that are not a multiple of 4 apart, so
+  // the copies are mapped by different lanes and by the scalar tail.
+  auto data = vm.rowVector({
+      vm.flatVector<int64_t>(kSize, [](auto row) { return row % 1'001; }),
+      vm.flatVector<int32_t>(kSize, [](auto row) { return row; }),
+  });
+  exec::HashPartitionFunction partitionFunction(
+      kNumPartitions,
+      std::dynamic_pointer_cast<const RowType>(data->type()),
+      {0});
+
+  std::vector<uint32_t> partitions;
+  partitionFunction.partition(*data, partitions);
+  ASSERT_EQ(partitions.size(), kSize);
+  std::vector<int32_t> counts(kNumPartitions);
+  for (auto i = 0; i < kSize; ++i) {
+    ASSERT_LT(partitions[i], kNumPartitions);
+    ASSERT_EQ(partitions[i], partitions[i % 1'001]) << "at " << i;
+    ++counts[partitions[i]];
+  }
+  for (auto count : counts) {
+    EXPECT_GT(count, kSize / kNumPartitions / 2);
+  }
+}
+
+TEST(HashPartitionFunctionTest, hotKeys) {
+  constexpr int32_t kNumPartitions = 8;
+  constexpr int32_t kSpread = 4;
+  constexpr vector_size_t kSize = 1'000;
+  auto pool = memory::getDefaultScopedMemoryPool();
+  test::VectorMaker vm(pool.get());
+  // Half of the rows have key 0. The other keys are distinct.
+  auto data = vm.rowVector({vm.flatVector<int64_t>(
+      kSize, [](auto row) { return row % 2 ? row : 0; })});
+  auto rowType = std::dynamic_pointer_cast<const RowType>(data->type());
+  exec::HashPartitionFunction plain(kNumPartitions, rowType, {0});
+  exec::HashPartitionFunction spread(kNumPartitions, rowType, {0}, kSpread);
+
+  std::vector<uint32_t> plainPartitions;
+  std::vector<uint32_t> partitions;
+  std::vector<int32_t> hotKeyCounts(kNumPartitions);
+  for (auto batch = 0; batch < 10; ++batch) {
+    plain.partition(*data, plainPartitions);
+    spread.partition(*data, partitions);
+    for (auto i = 0; i < kSize; ++i) {
+      if (i % 2) {
+        // Keys that are not hot keep their partition.
+        ASSERT_EQ(plainPartitions[i], partitions[i]);
+      } else if (batch > 0) {
+        ++hotKeyCounts[partitions[i]];
+      }
+    }
+  }
+  EXPECT_EQ(0, plain.numSpreadRows());
+  EXPECT_GT(spread.numSpreadRows(), 0);
+
+  // The hot key is detected in the first batch and is spread evenly over
+  // 'kSpread' partitions from the second batch on.
+  auto first = plainPartitions[0];
+  for (auto i = 0; i < kNumPartitions; ++i) {
+    auto offset = (i + kNumPartitions - first) % kNumPartitions;
+    if (offset < kSpread) {
+      EXPECT_EQ(hotKeyCounts[i], 9 * kSize / 2 / kSpread) << i;
+    } else {
+      EXPECT_EQ(hotKeyCounts[i], 0) << i;
+    }
+  }
+}
@@ -108,6 +108,46 @@ TEST_F(HashStringAllocatorTest, allocate) {
   EXPECT_LE(instance_->retainedSize() - instance_->freeSpace(), 200);
 }
 
+TEST_F(HashStringAllocatorTest, sizeClasses) {
+  // Interleave small and large blocks and free every other one of each to
+  // leave free blocks of all sizes.
+  std::vector<HashStringAllocator::Header*> headers;
+  for (auto i = 0; i < 4'000; ++i) {
+    headers.push_back(allocate(i % 2 ? 24 : 100 + (i % 50) * 100));
+  }
+  for (auto i = 0; i < headers.size(); i += 4) {
+    instance_->free(headers[i]);
+    instance_->free(headers[i + 1]);
+    headers[i] = nullptr;
+    headers[i + 1] = nullptr;
+  }
+  instance_->checkConsistency();
+  auto numFree = instance_->numFreeBlocks();
+  auto freeBytes = instance_->freeBytes();
+  EXPECT_GT(numFree, 0);
+  EXPECT_GT(freeBytes, 0);
+
+  // Allocations that fit in any of the freed blocks reuse them without
+  // growing.
+  auto retained = instance_->retainedSize();
+  for (auto i = 0; i < headers.size(); i += 4) {
+    headers[i] = allocate(100);
+  }
+  instance_->checkConsistency();
+  EXPECT_EQ(retained, instance_->retainedSize());
+  EXPECT_LT(instance_->freeBytes(), freeBytes);
+
+  for (auto header : headers) {
+    if (header) {
+      instance_->free(header);
+    }
+  }
+  instance_->checkConsistency();
+  // Adjacent free blocks are coalesced.
+  EXPECT_LT(instance_->numFreeBlocks(), numFree);
+  EXPECT_LE(instance_->freeBytes(), instance_->retainedSize());
+}
+
 TEST_F(HashStringAllocatorTest, multipart) {
   constexpr int32_t kNumSamples = 10'000;
   std::vector<Multipart> data(kNumSamples);
@@ -15,6 +15,7 @@
  */
 
 #include "velox/exec/HashTable.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "velox/common/base/SelectivityInfo.h"
 #include "velox/exec/VectorHasher.h"
 #include "velox/vector/tests/VectorMaker.h"
@@ -81,7 +82,7 @@ class HashTableTest : public testing::Test {
       batches_.insert(batches_.end(), batches.begin(), batches.end());
       startOffset += size;
     }
-    topTable_->prepareJoinTable(std::move(otherTables));
+    topTable_->prepareJoinTable(std::move(otherTables), executor_.get());
     EXPECT_EQ(topTable_->hashMode(), mode);
     LOG(INFO) << "Made table " << describeTable();
     testProbe();
@@ -156,7 +157,8 @@ class HashTableTest : public testing::Test {
     for (int32_t i = 0; i < hashers.size(); ++i) {
       auto key = input.childAt(hashers[i]->channel());
       if (mode != BaseHashTable::HashMode::kHash) {
-        if (!hashers[i]->computeValueIds(*key, activeRows, &lookup.hashes)) {
+        if (!hashers[i]->computeValueIds(
+                *key, activeRows, table.valueIdsFor(lookup, i))) {
           rehash = true;
         }
       } else {
@@ -432,6 +434,8 @@ class HashTableTest : public testing::Test {
   // Spacing between consecutive generated keys. Affects whether
   // Vectorhashers make ranges or ids of distinct values.
   int32_t keySpacing_ = 1;
+  // If set, the join table is built in parallel on this.
+  std::unique_ptr<folly::CPUThreadPoolExecutor> executor_;
 };
 
 TEST_F(HashTableTest, int2DenseArray) {
@@ -483,6 +487,154 @@ TEST_F(HashTableTest, mixed6Sparse) {
   testCycle(BaseHashTable::HashMode::kHash, 1000000, 2, type, 6);
 }
 
+TEST_F(HashTableTest, parallelBuildNormalized) {
+  executor_ = std::make_unique<folly::CPUThreadPoolExecutor>(4);
+  auto type = ROW({"k1", "k2"}, {BIGINT(), BIGINT()});
+  keySpacing_ = 1000;
+  testCycle(BaseHashTable::HashMode::kNormalizedKey, 10000, 4, type, 2);
+}
+
+TEST_F(HashTableTest, parallelBuildHash) {
+  executor_ = std::make_unique<folly::CPUThreadPoolExecutor>(4);
+  auto type = ROW({"key"}, {ROW({"k1", "k2"}, {BIGINT(), VARCHAR()})});
+  keySpacing_ = 1000;
+  testCycle(BaseHashTable::HashMode::kHash, 10000, 4, type, 1);
+}
+
+TEST_F(HashTableTest, wideNormalizedKey) {
+  // The value ids of 4 keys with 80K distinct values each do not fit in
+  // 64 bits. The group by uses a two word normalized key.
+  constexpr int32_t kNumBatches = 80;
+  constexpr int32_t kBatchSize = 1'000;
+  auto type = ROW(
+      {"k1", "k2", "k3", "k4"}, {BIGINT(), BIGINT(), BIGINT(), BIGINT()});
+  auto table = createHashTableForAggregation(type, 4);
+  auto lookup = std::make_unique<HashLookup>(table->hashers());
+  std::vector<RowVectorPtr> batches;
+  std::vector<char*> groups;
+  for (auto i = 0; i < kNumBatches; ++i) {
+    std::vector<VectorPtr> keys;
+    for (auto key = 0; key < 4; ++key) {
+      keys.push_back(vectorMaker_->flatVector<int64_t>(
+          kBatchSize, [&](auto row) {
+            return (i * kBatchSize + row) * 1'000 + key;
+          }));
+    }
+    batches.push_back(vectorMaker_->rowVector(keys));
+    lookup->reset(kBatchSize);
+    insertGroups(*batches.back(), *lookup, *table);
+    groups.insert(groups.end(), lookup->hits.begin(), lookup->hits.end());
+  }
+  EXPECT_EQ(table->hashMode(), BaseHashTable::HashMode::kNormalizedKey);
+  EXPECT_GT(table->wideKeyStart(), 0);
+  EXPECT_EQ(table->numDistinct(), kNumBatches * kBatchSize);
+
+  // Erase every other batch and see that the rest still hit.
+  for (auto i = 0; i < kNumBatches; i += 2) {
+    table->erase(
+        folly::Range<char**>(groups.data() + i * kBatchSize, kBatchSize));
+  }
+  for (auto i = 0; i < kNumBatches; ++i) {
+    lookup->reset(kBatchSize);
+    insertGroups(*batches[i], *lookup, *table);
+    if (i % 2 == 0) {
+      ASSERT_EQ(lookup->newGroups.size(), kBatchSize);
+      continue;
+    }
+    for (auto row = 0; row < kBatchSize; ++row) {
+      ASSERT_EQ(lookup->hits[row], groups[i * kBatchSize + row]);
+    }
+  }
+  EXPECT_EQ(table->numDistinct(), kNumBatches * kBatchSize);
+}
+
+TEST_F(HashTableTest, compact) {
+  constexpr int32_t kNumBatches = 100;
+  constexpr int32_t kBatchSize = 1'000;
+  auto type = ROW({"k1", "k2"}, {BIGINT(), BIGINT()});
+  auto table = createHashTableForAggregation(type, 2);
+  auto lookup = std::make_unique<HashLookup>(table->hashers());
+  std::vector<RowVectorPtr> batches;
+  std::vector<char*> groups;
+  for (auto i = 0; i < kNumBatches; ++i) {
+    std::vector<VectorPtr> keys;
+    for (auto key = 0; key < 2; ++key) {
+      keys.push_back(vectorMaker_->flatVector<int64_t>(
+          kBatchSize, [&](auto row) {
+            return (i * kBatchSize + row) * 1'000'000 + key;
+          }));
+    }
+    batches.push_back(vectorMaker_->rowVector(keys));
+    lookup->reset(kBatchSize);
+    insertGroups(*batches.back(), *lookup, *table);
+    groups.insert(groups.end(), lookup->hits.begin(), lookup->hits.end());
+  }
+  EXPECT_EQ(table->numDistinct(), kNumBatches * kBatchSize);
+
+  // Erase all but every 10th batch. The table and the rows keep their
+  // size until compacted.
+  for (auto i = 0; i < kNumBatches; ++i) {
+    if (i % 10 != 0) {
+      table->erase(
+          folly::Range<char**>(groups.data() + i * kBatchSize, kBatchSize));
+    }
+  }
+  auto bytes = table->allocatedBytes();
+  table->compact();
+  table->rows()->checkConsistency();
+  EXPECT_LT(table->allocatedBytes(), bytes / 4);
+  EXPECT_EQ(table->numDistinct(), kNumBatches / 10 * kBatchSize);
+
+  // The remaining groups are found at their new addresses.
+  for (auto i = 0; i < kNumBatches; ++i) {
+    lookup->reset(kBatchSize);
+    insertGroups(*batches[i], *lookup, *table);
+    ASSERT_EQ(lookup->newGroups.size(), i % 10 == 0 ? 0 : kBatchSize);
+  }
+  EXPECT_EQ(table->numDistinct(), kNumBatches * kBatchSize);
+
+  // After clear() the table itself is freed.
+  table->clear();
+  table->compact();
+  EXPECT_LT(table->allocatedBytes(), bytes / 100);
+  lookup->reset(kBatchSize);
+  insertGroups(*batches[0], *lookup, *table);
+  EXPECT_EQ(lookup->newGroups.size(), kBatchSize);
+}
+
+TEST_F(HashTableTest, distinctEstimate) {
+  constexpr int32_t kNumBatches = 100;
+  constexpr int32_t kBatchSize = 1'000;
+  auto type = ROW({"k1", "k2"}, {BIGINT(), BIGINT()});
+  auto table = createHashTableForAggregation(type, 2);
+  table->setDistinctEstimate(kNumBatches * kBatchSize);
+  table->forceGenericHashMode();
+  auto lookup = std::make_unique<HashLookup>(table->hashers());
+  auto tableBytes = [&]() {
+    return table->allocatedBytes() - table->rows()->allocatedBytes();
+  };
+  int64_t initialBytes = 0;
+  for (auto i = 0; i < kNumBatches; ++i) {
+    std::vector<VectorPtr> keys;
+    for (auto key = 0; key < 2; ++key) {
+      keys.push_back(vectorMaker_->flatVector<int64_t>(
+          kBatchSize, [&](auto row) {
+            return (i * kBatchSize + row) * 1'000'000 + key;
+          }));
+    }
+    lookup->reset(kBatchSize);
+    insertGroups(*vectorMaker_->rowVector(keys), *lookup, *table);
+    if (i == 0) {
+      initialBytes = tableBytes();
+      // The first batch allocates the table for all the groups.
+      EXPECT_GE(initialBytes, kNumBatches * kBatchSize * (1 + sizeof(char*)));
+    }
+  }
+  EXPECT_EQ(table->numDistinct(), kNumBatches * kBatchSize);
+  // The table did not grow.
+  EXPECT_EQ(tableBytes(), initialBytes);
+}
+
 // It should be safe to call clear() before we insert any data into HashTable
 TEST_F(HashTableTest, clear) {
   std::vector<std::unique_ptr<VectorHasher>> keyHashers;
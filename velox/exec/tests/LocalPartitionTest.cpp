@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "velox/exec/LocalPartition.h"
 #include "velox/exec/tests/HiveConnectorTestBase.h"
 #include "velox/exec/tests/PlanBuilder.h"
 
@@ -285,6 +286,40 @@ TEST_F(LocalPartitionTest, maxBufferSizePartition) {
   verifyExchangeSourceOperatorStats(task, 2100);
 }
 
+TEST_F(LocalPartitionTest, manyDrivers) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 50; i++) {
+    vectors.emplace_back(makeRowVector({makeFlatVector<int32_t>(
+        100, [i](auto row) { return i * 100 + row; })}));
+  }
+
+  createDuckDbTable(vectors);
+
+  // Each of the 16 producers emits all of 'vectors' and 16 consumers read
+  // the same sources. The small buffer limit makes producers and
+  // consumers block and unblock often.
+  auto op = PlanBuilder()
+                .localPartition(
+                    {0}, {PlanBuilder().values(vectors, true).planNode()})
+                .partialAggregation({0}, {"count(1)"})
+                .planNode();
+
+  CursorParameters params;
+  params.planNode = op;
+  params.maxDrivers = 16;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kMaxLocalExchangeBufferSize, "1024"},
+  });
+
+  auto task = ::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT c0, count(1) * 16 FROM tmp GROUP BY 1",
+      duckDbQueryRunner_);
+  verifyExchangeSourceOperatorStats(task, 16 * 5'000);
+}
+
 TEST_F(LocalPartitionTest, outputLayout) {
   std::vector<RowVectorPtr> vectors = {
       makeRowVector({
@@ -424,3 +459,93 @@ TEST_F(LocalPartitionTest, multipleExchanges) {
       ") t GROUP BY 1",
       duckDbQueryRunner_);
 }
+
+TEST_F(LocalPartitionTest, limitStopsScans) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 20; i++) {
+    vectors.emplace_back(makeRowVector({makeFlatSequence<int32_t>(i, 100)}));
+  }
+  auto filePaths = writeToFiles(vectors);
+  auto rowType = getRowType(vectors[0]);
+
+  auto scanNode = PlanBuilder(0).tableScan(rowType).planNode();
+  auto op = PlanBuilder(1)
+                .localPartition({}, {scanNode})
+                .limit(0, 10, false)
+                .planNode();
+
+  CursorParameters params;
+  params.planNode = op;
+  params.queryCtx = core::QueryCtx::create();
+  // The producer blocks after each batch, so that the Limit is done long
+  // before the scan runs out of splits.
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kMaxLocalExchangeBufferSize, "100"},
+  });
+
+  bool splitsAdded = false;
+  auto [cursor, results] = readCursor(params, [&](exec::Task* task) {
+    if (splitsAdded) {
+      return;
+    }
+    for (const auto& filePath : filePaths) {
+      addSplit(task, "0", makeHiveSplit(filePath->path));
+    }
+    task->noMoreSplits("0");
+    splitsAdded = true;
+  });
+
+  int32_t numRows = 0;
+  for (const auto& result : results) {
+    numRows += result->size();
+  }
+  EXPECT_EQ(10, numRows);
+
+  // The Limit ends the consumer. The producer then sees no open consumer
+  // and finishes its scan instead of reading all files.
+  auto task = cursor->task();
+  task->stateChangeFuture(1'000'000).wait();
+  EXPECT_EQ(exec::kFinished, task->state());
+  auto scanStats = task->taskStats().pipelineStats[1].operatorStats.front();
+  EXPECT_LT(scanStats.numSplits, 20);
+  EXPECT_LT(scanStats.rawInputPositions, 2'000u);
+}
+
+TEST_F(LocalPartitionTest, cancel) {
+  exec::LocalExchangeMemoryManager memoryManager(1);
+  exec::LocalExchangeSource producerSide(&memoryManager, 0);
+  exec::LocalExchangeSource consumerSide(&memoryManager, 1);
+  for (auto* source : {&producerSide, &consumerSide}) {
+    source->addProducer();
+    source->noMoreProducers();
+  }
+
+  // A producer over the memory limit and a consumer without data wait.
+  auto data = makeRowVector({makeFlatSequence<int32_t>(0, 100)});
+  ContinueFuture producerFuture(false);
+  ASSERT_EQ(
+      exec::BlockingReason::kWaitForConsumer,
+      producerSide.enqueue(data, &producerFuture));
+  ContinueFuture consumerFuture(false);
+  RowVectorPtr result;
+  ASSERT_EQ(
+      exec::BlockingReason::kWaitForExchange,
+      consumerSide.next(&consumerFuture, pool_.get(), &result));
+  ASSERT_FALSE(producerFuture.isReady());
+  ASSERT_FALSE(consumerFuture.isReady());
+
+  // Terminating the task cancels the memory manager and the sources.
+  memoryManager.cancel();
+  ASSERT_TRUE(producerFuture.isReady());
+  consumerSide.cancel();
+  ASSERT_TRUE(consumerFuture.isReady());
+
+  // Producers no longer block on memory and a cancelled source drops its
+  // input.
+  ContinueFuture future(false);
+  ASSERT_EQ(
+      exec::BlockingReason::kNotBlocked, producerSide.enqueue(data, &future));
+  ASSERT_EQ(
+      exec::BlockingReason::kNotBlocked, consumerSide.enqueue(data, &future));
+  producerSide.cancel();
+}
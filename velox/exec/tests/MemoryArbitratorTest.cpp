@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/MemoryArbitrator.h"
+#include <atomic>
+#include <thread>
+#include "velox/exec/tests/HiveConnectorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+static const std::string kWriter = "MemoryArbitratorTest.Writer";
+
+class MemoryArbitratorTest : public HiveConnectorTestBase {
+ protected:
+  // Runs 'plan' over 'filePaths' with memory arbitration enabled. After
+  // the scan has read all the files and before it is told that there
+  // are no more splits, calls MemoryArbitrator::reclaim() from outside
+  // of the Task. Returns the Task and the reclaimed bytes.
+  std::pair<std::shared_ptr<Task>, uint64_t> runWithReclaim(
+      const std::shared_ptr<const core::PlanNode>& plan,
+      const core::PlanNodeId& scanId,
+      const std::vector<std::shared_ptr<TempFilePath>>& filePaths,
+      const std::string& duckDbSql) {
+    CursorParameters params;
+    params.planNode = plan;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kSpillEnabled, "true"},
+        {core::QueryCtx::kMemoryArbitrationEnabled, "true"},
+    });
+
+    std::atomic<Task*> scanTask{nullptr};
+    auto addSplits = [&](Task* task) {
+      if (scanTask) {
+        return;
+      }
+      for (auto& filePath : filePaths) {
+        addSplit(task, scanId, makeHiveSplit(filePath->path));
+      }
+      scanTask = task;
+    };
+
+    uint64_t reclaimedBytes = 0;
+    std::thread arbitration([&]() {
+      Task* task;
+      while (!(task = scanTask.load()) ||
+             task->taskStats().numFinishedSplits < filePaths.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // NOLINT
+      }
+      reclaimedBytes = MemoryArbitrator::getInstance()->reclaim(1 << 30);
+      task->noMoreSplits(scanId);
+    });
+
+    auto task =
+        ::assertQuery(params, addSplits, duckDbSql, duckDbQueryRunner_);
+    arbitration.join();
+    return {task, reclaimedBytes};
+  }
+
+  static int64_t spilledRows(
+      const std::shared_ptr<Task>& task,
+      const std::string& operatorType) {
+    int64_t numRows = 0;
+    for (auto& pipeline : task->taskStats().pipelineStats) {
+      for (auto& op : pipeline.operatorStats) {
+        if (op.operatorType == operatorType) {
+          numRows += op.runtimeStats["spilledRows"].sum;
+        }
+      }
+    }
+    return numRows;
+  }
+
+  std::vector<std::shared_ptr<TempFilePath>> writeFiles(
+      const std::vector<RowVectorPtr>& vectors) {
+    auto filePaths = makeFilePaths(vectors.size());
+    for (auto i = 0; i < vectors.size(); ++i) {
+      writeToFile(filePaths[i]->path, kWriter, vectors[i]);
+    }
+    return filePaths;
+  }
+
+  const std::shared_ptr<const RowType> rowType_{
+      ROW({"c0", "c1", "c2"}, {BIGINT(), BIGINT(), VARCHAR()})};
+};
+
+TEST_F(MemoryArbitratorTest, orderBy) {
+  auto vectors = makeVectors(rowType_, 5, 1'000);
+  auto filePaths = writeFiles(vectors);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .tableScan(rowType_)
+                  .orderBy({0}, {core::SortOrder(true, false)}, false)
+                  .planNode();
+  auto numArbitrations = MemoryArbitrator::getInstance()->numArbitrations();
+  auto [task, reclaimedBytes] = runWithReclaim(
+      plan, plan->sources()[0]->id(), filePaths, "SELECT * FROM tmp");
+
+  EXPECT_GT(reclaimedBytes, 0);
+  EXPECT_EQ(
+      MemoryArbitrator::getInstance()->numArbitrations(), numArbitrations + 1);
+  EXPECT_EQ(spilledRows(task, "OrderBy"), 5 * 1'000);
+}
+
+TEST_F(MemoryArbitratorTest, aggregation) {
+  auto vectors = makeVectors(rowType_, 5, 1'000);
+  auto filePaths = writeFiles(vectors);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .tableScan(rowType_)
+                  .finalAggregation({0}, {"sum(c1)"})
+                  .planNode();
+  auto [task, reclaimedBytes] = runWithReclaim(
+      plan,
+      plan->sources()[0]->id(),
+      filePaths,
+      "SELECT c0, sum(c1) FROM tmp GROUP BY 1");
+
+  EXPECT_GT(reclaimedBytes, 0);
+  EXPECT_GT(spilledRows(task, "Aggregation"), 0);
+}
+
+TEST_F(MemoryArbitratorTest, notReclaimable) {
+  auto vectors = makeVectors(rowType_, 2, 1'000);
+  auto filePaths = writeFiles(vectors);
+  createDuckDbTable(vectors);
+
+  // A filter has no memory to give back.
+  auto plan =
+      PlanBuilder().tableScan(rowType_).filter("c1 % 2 = 0").planNode();
+  auto result = runWithReclaim(
+      plan,
+      plan->sources()[0]->id(),
+      filePaths,
+      "SELECT * FROM tmp WHERE c1 % 2 = 0");
+  EXPECT_EQ(result.second, 0);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec::test;
+
+class MergeJoinTest : public OperatorTestBase {
+ protected:
+  // Returns 'numBatches' batches of 'batchSize' rows sorted on c0. Each
+  // key repeats in 'keyRepeat' consecutive rows, starting at
+  // 'startKey'. c1 is the row number. Keys of the rows for which
+  // 'isNullAt' is true are null.
+  std::vector<RowVectorPtr> makeSortedVectors(
+      int32_t numBatches,
+      vector_size_t batchSize,
+      int32_t keyRepeat,
+      int32_t startKey,
+      std::function<bool(vector_size_t)> isNullAt = nullptr) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numBatches; ++i) {
+      auto offset = i * batchSize;
+      std::function<bool(vector_size_t)> isNullAtRow;
+      if (isNullAt) {
+        isNullAtRow = [&](auto row) { return isNullAt(offset + row); };
+      }
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int32_t>(
+              batchSize,
+              [&](auto row) { return startKey + (offset + row) / keyRepeat; },
+              isNullAtRow),
+          makeFlatVector<int64_t>(
+              batchSize, [&](auto row) { return offset + row; }),
+      }));
+    }
+    return vectors;
+  }
+
+  void testJoin(
+      const std::vector<RowVectorPtr>& left,
+      const std::vector<RowVectorPtr>& right,
+      const std::string& rightFilter = "") {
+    createDuckDbTable("t", left);
+    createDuckDbTable("u", right);
+
+    auto rightPlan = [&]() {
+      PlanBuilder builder(0);
+      builder.values(right);
+      if (!rightFilter.empty()) {
+        builder.filter(rightFilter);
+      }
+      return builder.project({"c0", "c1"}, {"u_c0", "u_c1"}).planNode();
+    };
+    auto uSql =
+        rightFilter.empty() ? "u" : fmt::format("u WHERE {}", rightFilter);
+
+    auto plan = PlanBuilder(10)
+                    .values(left)
+                    .mergeJoin({0}, {0}, rightPlan(), {0, 1, 2, 3})
+                    .planNode();
+    assertQuery(
+        plan,
+        fmt::format(
+            "SELECT t.*, u.* FROM t, (SELECT * FROM {}) u WHERE t.c0 = u.c0",
+            uSql));
+
+    plan = PlanBuilder(10)
+               .values(left)
+               .mergeJoin(
+                   {0},
+                   {0},
+                   rightPlan(),
+                   {0, 1, 2, 3},
+                   core::JoinType::kLeft)
+               .planNode();
+    assertQuery(
+        plan,
+        fmt::format(
+            "SELECT t.*, u.* FROM t LEFT JOIN (SELECT * FROM {}) u "
+            "ON t.c0 = u.c0",
+            uSql));
+  }
+};
+
+TEST_F(MergeJoinTest, oneToOne) {
+  testJoin(
+      makeSortedVectors(3, 1'000, 1, 0), makeSortedVectors(4, 999, 1, 500));
+}
+
+TEST_F(MergeJoinTest, duplicateKeys) {
+  // Runs of equal keys span batch boundaries on both sides and produce
+  // more than one output batch per left batch.
+  testJoin(
+      makeSortedVectors(3, 1'000, 3, 0), makeSortedVectors(4, 999, 2, 100));
+  testJoin(
+      makeSortedVectors(2, 100, 50, 0), makeSortedVectors(3, 70, 70, 1));
+}
+
+TEST_F(MergeJoinTest, nullKeys) {
+  // Nulls first on the left side and last on the right side.
+  testJoin(
+      makeSortedVectors(
+          3, 1'000, 2, 0, [](auto row) { return row < 150; }),
+      makeSortedVectors(
+          4, 999, 3, 0, [](auto row) { return row >= 3'000; }));
+}
+
+TEST_F(MergeJoinTest, emptyRightSide) {
+  testJoin(
+      makeSortedVectors(3, 1'000, 1, 0),
+      makeSortedVectors(2, 1'000, 1, 0),
+      "c0 < 0");
+}
+
+TEST_F(MergeJoinTest, rightSideEndsFirst) {
+  testJoin(
+      makeSortedVectors(3, 1'000, 1, 0), makeSortedVectors(1, 500, 2, 100));
+}
+
+TEST_F(MergeJoinTest, twoKeys) {
+  auto makeVectors = [&](int32_t numBatches, vector_size_t batchSize) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numBatches; ++i) {
+      auto offset = i * batchSize;
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int32_t>(
+              batchSize, [&](auto row) { return (offset + row) / 20; }),
+          makeFlatVector<int32_t>(
+              batchSize, [&](auto row) { return (offset + row) % 20 / 3; }),
+      }));
+    }
+    return vectors;
+  };
+  auto left = makeVectors(3, 500);
+  auto right = makeVectors(4, 333);
+  createDuckDbTable("t", left);
+  createDuckDbTable("u", right);
+
+  auto plan = PlanBuilder(10)
+                  .values(left)
+                  .mergeJoin(
+                      {0, 1},
+                      {0, 1},
+                      PlanBuilder(0)
+                          .values(right)
+                          .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                          .planNode(),
+                      {0, 1, 3},
+                      core::JoinType::kLeft)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT t.c0, t.c1, u.c1 FROM t LEFT JOIN u "
+      "ON t.c0 = u.c0 AND t.c1 = u.c1");
+}
@@ -110,3 +110,40 @@ TEST_F(MergeTest, localMerge) {
   testTwoKeys(vectors, "c0", "c3");
   testTwoKeys(vectors, "c3", "c0");
 }
+
+TEST_F(MergeTest, localMergeManySources) {
+  // Strings that are not inlined check that the rows of consumed source
+  // batches stay valid until the output is copied.
+  vector_size_t batchSize = 100;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 20; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize,
+        [&](vector_size_t row) { return (batchSize * i + row) / 7; },
+        nullEvery(13));
+    auto c1 = makeFlatVector<StringView>(batchSize, [&](vector_size_t row) {
+      return StringView(std::string(20 + row % 5, 'a' + (i + row) % 26));
+    });
+    vectors.push_back(makeRowVector({c0, c1}));
+  }
+  // Each of the 4 drivers produces all of 'vectors'.
+  std::vector<RowVectorPtr> allVectors;
+  for (auto i = 0; i < 4; ++i) {
+    allVectors.insert(allVectors.end(), vectors.begin(), vectors.end());
+  }
+  createDuckDbTable(allVectors);
+
+  CursorParameters params;
+  params.planNode = PlanBuilder()
+                        .values(vectors, true)
+                        .orderBy({0}, {kAscNullsLast}, true)
+                        .localMerge({0}, {kAscNullsLast})
+                        .planNode();
+  params.maxDrivers = 4;
+  test::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT * FROM tmp ORDER BY c0 NULLS LAST",
+      duckDbQueryRunner_,
+      std::vector<uint32_t>{0});
+}
@@ -412,6 +412,72 @@ TEST_F(MultiFragmentTest, partitionedOutput) {
   }
 }
 
+TEST_F(MultiFragmentTest, smallBatchesManyPartitions) {
+  // Each batch gives each partition less than one row on average. The
+  // batches are combined before partitioning.
+  constexpr int32_t kFanout = 20;
+  vectors_ = makeVectors(200, 10);
+  createDuckDbTable(vectors_);
+
+  auto leafTaskId = makeTaskId("leaf", 0);
+  auto leafPlan = PlanBuilder()
+                      .values(vectors_)
+                      .partitionedOutput({0}, kFanout)
+                      .planNode();
+  auto leafTask = makeTask(leafTaskId, leafPlan, 0);
+  Task::start(leafTask, 1);
+
+  auto intermediatePlan = PlanBuilder()
+                              .exchange(leafPlan->outputType())
+                              .partitionedOutput({}, 1)
+                              .planNode();
+  std::vector<std::string> intermediateTaskIds;
+  for (auto i = 0; i < kFanout; ++i) {
+    intermediateTaskIds.push_back(makeTaskId("intermediate", i));
+    auto intermediateTask =
+        makeTask(intermediateTaskIds.back(), intermediatePlan, i);
+    Task::start(intermediateTask, 1);
+    addRemoteSplits(intermediateTask, {leafTaskId});
+  }
+
+  auto op = PlanBuilder().exchange(intermediatePlan->outputType()).planNode();
+  assertQuery(op, intermediateTaskIds, "SELECT * FROM tmp");
+}
+
+TEST_F(MultiFragmentTest, exchangeClientBufferSize) {
+  // The intermediate task reads from many producers with a budget below
+  // the size of one page. It requests one page at a time.
+  configSettings_[core::QueryCtx::kMaxExchangeClientBufferSize] = "1";
+  constexpr int32_t kNumLeafTasks = 10;
+  vectors_ = makeVectors(20, 1'000);
+  createDuckDbTable(vectors_);
+
+  auto leafPlan =
+      PlanBuilder().values(vectors_).partitionedOutput({}, 1).planNode();
+  std::vector<std::string> leafTaskIds;
+  for (auto i = 0; i < kNumLeafTasks; ++i) {
+    leafTaskIds.push_back(makeTaskId("leaf", i));
+    auto leafTask = makeTask(leafTaskIds.back(), leafPlan, 0);
+    Task::start(leafTask, 1);
+  }
+
+  auto intermediatePlan = PlanBuilder()
+                              .exchange(leafPlan->outputType())
+                              .partialAggregation({}, {"count(1)"})
+                              .partitionedOutput({}, 1)
+                              .planNode();
+  auto intermediateTaskId = makeTaskId("intermediate", 0);
+  auto intermediateTask = makeTask(intermediateTaskId, intermediatePlan, 0);
+  Task::start(intermediateTask, 1);
+  addRemoteSplits(intermediateTask, leafTaskIds);
+
+  auto op = PlanBuilder()
+                .exchange(intermediatePlan->outputType())
+                .finalAggregation({}, {"sum(a0)"})
+                .planNode();
+  assertQuery(op, {intermediateTaskId}, "SELECT count(*) * 10 FROM tmp");
+}
+
 TEST_F(MultiFragmentTest, broadcast) {
   auto data = makeRowVector(
       {makeFlatVector<int32_t>(1'000, [](auto row) { return row; })});
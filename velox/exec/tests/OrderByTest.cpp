@@ -208,6 +208,46 @@ TEST_F(OrderByTest, multipleKeys) {
       {0, 1});
 }
 
+TEST_F(OrderByTest, encodedKeys) {
+  // Key types with a fixed width encoding, with negative values and
+  // nulls.
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 2; ++i) {
+    auto c0 = makeFlatVector<int8_t>(
+        batchSize, [](vector_size_t row) { return row % 7 - 3; }, nullEvery(5));
+    auto c1 = makeFlatVector<float>(
+        batchSize,
+        [](vector_size_t row) { return (row % 13 - 6) * 0.5; },
+        nullEvery(11));
+    auto c2 = makeFlatVector<bool>(
+        batchSize,
+        [](vector_size_t row) { return row % 3 == 0; },
+        nullEvery(7));
+    auto c3 = makeFlatVector<int16_t>(
+        batchSize, [](vector_size_t row) { return row - 500; });
+    vectors.push_back(makeRowVector({c0, c1, c2, c3}));
+  }
+  createDuckDbTable(vectors);
+
+  testTwoKeys(vectors, "c0", "c1");
+  testTwoKeys(vectors, "c2", "c3");
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .orderBy(
+                      {2, 0, 1, 3},
+                      {kDescNullsLast, kAscNullsFirst, kDescNullsFirst,
+                       kAscNullsLast},
+                      false)
+                  .planNode();
+  assertQueryOrdered(
+      plan,
+      "SELECT * FROM tmp ORDER BY c2 DESC NULLS LAST, c0 NULLS FIRST, "
+      "c1 DESC NULLS FIRST, c3 NULLS LAST",
+      {2, 0, 1, 3});
+}
+
 TEST_F(OrderByTest, multiBatchResult) {
   vector_size_t batchSize = 5000;
   std::vector<RowVectorPtr> vectors;
@@ -225,6 +265,44 @@ TEST_F(OrderByTest, multiBatchResult) {
   testSingleKey(vectors, "c0");
 }
 
+TEST_F(OrderByTest, outputBatchBytes) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize, [&](vector_size_t row) { return (row * 7919 + i) % 5000; });
+    auto c1 = makeFlatVector<int64_t>(
+        batchSize, [](vector_size_t row) { return row; });
+    vectors.push_back(makeRowVector({c0, c1}));
+  }
+
+  // Rows of two bigints are at least 16 bytes, so no batch of 1000
+  // bytes has more than 62 rows.
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kPreferredOutputBatchBytes, "1000"},
+  });
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .orderBy({0}, {kAscNullsLast}, false)
+                        .planNode();
+  auto [cursor, results] = readCursor(params, [](exec::Task*) {});
+
+  vector_size_t numRows = 0;
+  int64_t last = std::numeric_limits<int64_t>::min();
+  for (const auto& result : results) {
+    EXPECT_LE(result->size(), 62);
+    auto c0 = result->childAt(0)->asFlatVector<int64_t>();
+    for (auto i = 0; i < result->size(); ++i) {
+      EXPECT_LE(last, c0->valueAt(i));
+      last = c0->valueAt(i);
+    }
+    numRows += result->size();
+  }
+  EXPECT_EQ(numRows, 10 * batchSize);
+}
+
 TEST_F(OrderByTest, varfields) {
   vector_size_t batchSize = 1000;
   std::vector<RowVectorPtr> vectors;
@@ -266,3 +344,99 @@ TEST_F(OrderByTest, unknown) {
   assertQueryOrdered(
       plan, "SELECT *, null FROM tmp ORDER BY c0 DESC NULLS LAST", {0});
 }
+
+TEST_F(OrderByTest, spill) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize,
+        [&](vector_size_t row) { return (row * 7919 + i * 31) % 5000; },
+        nullEvery(5));
+    auto c1 = makeFlatVector<double>(
+        batchSize, [](vector_size_t row) { return row * 0.1; }, nullEvery(11));
+    auto c2 = makeFlatVector<StringView>(
+        batchSize,
+        [](vector_size_t row) { return StringView(std::to_string(row)); },
+        nullEvery(17));
+    vectors.push_back(makeRowVector({c0, c1, c2}));
+  }
+  createDuckDbTable(vectors);
+
+  // Set a tiny threshold so that every input batch after the first
+  // triggers spilling of a sorted run.
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSpillEnabled, "true"},
+      {core::QueryCtx::kOrderBySpillMemoryThreshold, "1"},
+  });
+
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .orderBy({2, 0}, {kDescNullsFirst, kAscNullsLast}, false)
+                        .planNode();
+
+  auto task = exec::test::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT * FROM tmp ORDER BY c2 DESC NULLS FIRST, c0 NULLS LAST",
+      duckDbQueryRunner_,
+      std::vector<uint32_t>{2, 0});
+
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  auto orderByStats = std::find_if(stats.begin(), stats.end(), [](auto& op) {
+    return op.operatorType == "OrderBy";
+  });
+  ASSERT_NE(orderByStats, stats.end());
+  EXPECT_EQ(orderByStats->runtimeStats["spillRuns"].sum, 9);
+  EXPECT_EQ(orderByStats->runtimeStats["spilledRows"].sum, 9 * batchSize);
+}
+
+TEST_F(OrderByTest, spillMultiLevelMerge) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize,
+        [&](vector_size_t row) { return (row * 7919 + i * 31) % 5000; },
+        nullEvery(5));
+    auto c1 = makeFlatVector<StringView>(
+        batchSize,
+        [](vector_size_t row) { return StringView(std::to_string(row)); },
+        nullEvery(17));
+    vectors.push_back(makeRowVector({c0, c1}));
+  }
+  createDuckDbTable(vectors);
+
+  // 9 spilled runs and the rows in memory make 10 streams. With a fan-in
+  // of 3, groups of runs are merged 4 times before the final merge.
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSpillEnabled, "true"},
+      {core::QueryCtx::kOrderBySpillMemoryThreshold, "1"},
+      {core::QueryCtx::kSpillMaxMergeFanIn, "3"},
+  });
+
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .orderBy({0, 1}, {kAscNullsLast, kDescNullsFirst}, false)
+          .planNode();
+
+  auto task = exec::test::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT * FROM tmp ORDER BY c0 NULLS LAST, c1 DESC NULLS FIRST",
+      duckDbQueryRunner_,
+      std::vector<uint32_t>{0, 1});
+
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  auto orderByStats = std::find_if(stats.begin(), stats.end(), [](auto& op) {
+    return op.operatorType == "OrderBy";
+  });
+  ASSERT_NE(orderByStats, stats.end());
+  EXPECT_EQ(orderByStats->runtimeStats["spillRuns"].sum, 9);
+  EXPECT_EQ(orderByStats->runtimeStats["spillMergedRuns"].sum, 4);
+}
@@ -357,3 +357,49 @@ TEST_F(PartitionedOutputBufferManagerTest, errorInQueue) {
   bool atEnd = false;
   EXPECT_THROW(auto page = queue->dequeue(&atEnd, &future), std::runtime_error);
 }
+
+TEST_F(PartitionedOutputBufferManagerTest, serializedPage) {
+  auto rowType = ROW({"a", "b", "c"}, {BIGINT(), VARCHAR(), DOUBLE()});
+  // Large enough for the page to need more than one allocation run.
+  auto vector = std::dynamic_pointer_cast<RowVector>(
+      BatchMaker::createBatch(rowType, 10'000, *pool_));
+  auto page = SerializedPage::fromVectorStreamGroup(
+      toVectorStreamGroup(vector).get());
+  EXPECT_GT(page->byteSize(), 0);
+
+  ByteStream input;
+  page->prepareStreamForDeserialize(&input);
+  RowVectorPtr result;
+  VectorStreamGroup::read(&input, pool_.get(), rowType, &result);
+  ASSERT_EQ(result->size(), vector->size());
+  for (auto i = 0; i < vector->size(); ++i) {
+    ASSERT_TRUE(vector->equalValueAt(result.get(), i, i)) << "at " << i;
+  }
+}
+
+TEST_F(PartitionedOutputBufferManagerTest, sharedSerializedPage) {
+  auto rowType = ROW({"a", "b", "c"}, {BIGINT(), VARCHAR(), DOUBLE()});
+  auto vector = std::dynamic_pointer_cast<RowVector>(
+      BatchMaker::createBatch(rowType, 10'000, *pool_));
+  auto group = toVectorStreamGroup(vector);
+  group->markShared();
+
+  // The consumers of a shared group get pages over the same memory.
+  auto first = SerializedPage::fromVectorStreamGroup(group.get());
+  auto numAllocated = mappedMemory_->numAllocated();
+  auto second = SerializedPage::fromVectorStreamGroup(group.get());
+  EXPECT_EQ(numAllocated, mappedMemory_->numAllocated());
+  EXPECT_EQ(first->byteSize(), second->byteSize());
+
+  // The shared memory outlives the group and the other pages.
+  group.reset();
+  first.reset();
+  ByteStream input;
+  second->prepareStreamForDeserialize(&input);
+  RowVectorPtr result;
+  VectorStreamGroup::read(&input, pool_.get(), rowType, &result);
+  ASSERT_EQ(result->size(), vector->size());
+  for (auto i = 0; i < vector->size(); ++i) {
+    ASSERT_TRUE(vector->equalValueAt(result.get(), i, i)) << "at " << i;
+  }
+}
@@ -79,6 +79,30 @@ PlanBuilder& PlanBuilder::values(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::arrowStream(
+    const RowTypePtr& outputType,
+    std::shared_ptr<ArrowArrayStream> arrowStream) {
+  planNode_ = std::make_shared<core::ArrowStreamNode>(
+      nextPlanNodeId(), outputType, std::move(arrowStream));
+  return *this;
+}
+
+PlanBuilder& PlanBuilder::syntheticSource(
+    const RowTypePtr& outputType,
+    std::vector<core::SyntheticColumn> columns,
+    uint64_t rowsPerDriver,
+    vector_size_t batchSize,
+    uint64_t seed) {
+  planNode_ = std::make_shared<core::SyntheticSourceNode>(
+      nextPlanNodeId(),
+      outputType,
+      std::move(columns),
+      rowsPerDriver,
+      batchSize,
+      seed);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::exchange(
     const std::shared_ptr<const RowType>& outputType) {
   planNode_ =
@@ -209,15 +233,100 @@ class AggregateTypeResolver {
   TypePtr resultType_;
 };
 
+// Resolves the types of ranking and value window functions and falls
+// back to the single step aggregate types for the rest.
+class WindowTypeResolver {
+ public:
+  WindowTypeResolver() : previousHook_(core::Expressions::getResolverHook()) {
+    core::Expressions::setTypeResolverHook(
+        [&](const auto& inputs, const auto& expr) {
+          return resolveType(inputs, expr);
+        });
+  }
+
+  ~WindowTypeResolver() {
+    core::Expressions::setTypeResolverHook(previousHook_);
+  }
+
+ private:
+  std::shared_ptr<const Type> resolveType(
+      const std::vector<std::shared_ptr<const core::ITypedExpr>>& inputs,
+      const std::shared_ptr<const core::CallExpr>& expr) const {
+    auto functionName = expr->getFunctionName();
+    if (functionName == "row_number" || functionName == "rank" ||
+        functionName == "dense_rank") {
+      return BIGINT();
+    }
+    if (functionName == "lag" || functionName == "lead") {
+      return inputs.empty() ? nullptr : inputs[0]->type();
+    }
+
+    std::vector<TypePtr> types;
+    for (auto& input : inputs) {
+      types.push_back(input->type());
+    }
+    auto aggregate = exec::Aggregate::create(
+        functionName,
+        core::AggregationNode::Step::kSingle,
+        types,
+        UNKNOWN());
+    if (aggregate) {
+      return aggregate->resultType();
+    }
+    return nullptr;
+  }
+
+  const core::Expressions::TypeResolverHook previousHook_;
+};
+
 } // namespace
 
 PlanBuilder& PlanBuilder::aggregation(
+    const std::vector<ChannelIndex>& groupingKeys,
+    const std::vector<std::string>& aggregates,
+    const std::vector<std::string>& masks,
+    core::AggregationNode::Step step,
+    bool ignoreNullKeys,
+    const std::vector<TypePtr>& resultTypes,
+    const std::vector<bool>& distincts) {
+  return aggregation(
+      groupingKeys,
+      {},
+      aggregates,
+      masks,
+      step,
+      ignoreNullKeys,
+      resultTypes,
+      distincts);
+}
+
+PlanBuilder& PlanBuilder::streamingAggregation(
     const std::vector<ChannelIndex>& groupingKeys,
     const std::vector<std::string>& aggregates,
     const std::vector<std::string>& masks,
     core::AggregationNode::Step step,
     bool ignoreNullKeys,
     const std::vector<TypePtr>& resultTypes) {
+  return aggregation(
+      groupingKeys,
+      groupingKeys,
+      aggregates,
+      masks,
+      step,
+      ignoreNullKeys,
+      resultTypes,
+      {});
+}
+
+PlanBuilder& PlanBuilder::aggregation(
+    const std::vector<ChannelIndex>& groupingKeys,
+    const std::vector<ChannelIndex>& preGroupedKeys,
+    const std::vector<std::string>& aggregates,
+    const std::vector<std::string>& masks,
+    core::AggregationNode::Step step,
+    bool ignoreNullKeys,
+    const std::vector<TypePtr>& resultTypes,
+    const std::vector<bool>& distincts) {
   AggregateTypeResolver resolver(step);
   std::vector<std::shared_ptr<const core::CallTypedExpr>> aggregateExprs;
   aggregateExprs.reserve(aggregates.size());
@@ -249,9 +358,11 @@ PlanBuilder& PlanBuilder::aggregation(
       nextPlanNodeId(),
       step,
       groupingExpr,
+      fields(preGroupedKeys),
       names,
       aggregateExprs,
       aggregateMasks,
+      distincts,
       ignoreNullKeys,
       planNode_);
   return *this;
@@ -288,6 +399,37 @@ PlanBuilder& PlanBuilder::orderBy(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::window(
+    const std::vector<ChannelIndex>& partitionKeys,
+    const std::vector<ChannelIndex>& sortingKeys,
+    const std::vector<core::SortOrder>& sortingOrders,
+    const std::vector<std::string>& functions,
+    const std::vector<core::WindowNode::Frame>& frames,
+    bool inputsSorted) {
+  VELOX_CHECK_EQ(sortingKeys.size(), sortingOrders.size());
+  VELOX_CHECK(frames.empty() || frames.size() == functions.size());
+  WindowTypeResolver resolver;
+  std::vector<core::WindowNode::Function> windowFunctions;
+  windowFunctions.reserve(functions.size());
+  for (auto i = 0; i < functions.size(); i++) {
+    auto expr = std::dynamic_pointer_cast<const core::CallTypedExpr>(
+        parseExpr(functions[i], planNode_->outputType()));
+    windowFunctions.push_back(
+        {expr, frames.empty() ? core::WindowNode::Frame{} : frames[i]});
+  }
+
+  planNode_ = std::make_shared<core::WindowNode>(
+      nextPlanNodeId(),
+      fields(partitionKeys),
+      fields(sortingKeys),
+      sortingOrders,
+      makeNames("w", functions.size()),
+      windowFunctions,
+      inputsSorted,
+      planNode_);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::topN(
     const std::vector<ChannelIndex>& keyIndices,
     const std::vector<core::SortOrder>& sortOrder,
@@ -309,6 +451,26 @@ PlanBuilder& PlanBuilder::topN(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::topNRowNumber(
+    const std::vector<ChannelIndex>& partitionKeys,
+    const std::vector<ChannelIndex>& sortingKeys,
+    const std::vector<core::SortOrder>& sortingOrders,
+    int32_t limit,
+    bool generateRowNumber,
+    bool isPartial) {
+  planNode_ = std::make_shared<core::TopNRowNumberNode>(
+      nextPlanNodeId(),
+      fields(partitionKeys),
+      fields(sortingKeys),
+      sortingOrders,
+      generateRowNumber ? std::make_optional<std::string>("row_number")
+                        : std::nullopt,
+      limit,
+      isPartial,
+      planNode_);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::limit(int32_t offset, int32_t count, bool isPartial) {
   planNode_ = std::make_shared<core::LimitNode>(
       nextPlanNodeId(), offset, count, isPartial, planNode_);
@@ -466,14 +628,54 @@ PlanBuilder& PlanBuilder::hashJoin(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::mergeJoin(
+    const std::vector<ChannelIndex>& leftKeys,
+    const std::vector<ChannelIndex>& rightKeys,
+    const std::shared_ptr<facebook::velox::core::PlanNode>& right,
+    const std::vector<ChannelIndex>& output,
+    core::JoinType joinType) {
+  VELOX_CHECK_EQ(leftKeys.size(), rightKeys.size());
+
+  auto leftType = planNode_->outputType();
+  auto rightType = right->outputType();
+  auto outputType = extract(concat(leftType, rightType), output);
+  auto leftKeyFields = fields(leftType, leftKeys);
+  auto rightKeyFields = fields(rightType, rightKeys);
+
+  planNode_ = std::make_shared<core::MergeJoinNode>(
+      nextPlanNodeId(),
+      joinType,
+      leftKeyFields,
+      rightKeyFields,
+      std::move(planNode_),
+      right,
+      outputType);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::crossJoin(
     const std::shared_ptr<core::PlanNode>& build,
     const std::vector<ChannelIndex>& output) {
+  return crossJoin(build, "", output);
+}
+
+PlanBuilder& PlanBuilder::crossJoin(
+    const std::shared_ptr<core::PlanNode>& build,
+    const std::string& filterText,
+    const std::vector<ChannelIndex>& output) {
   auto resultType = concat(planNode_->outputType(), build->outputType());
+  std::shared_ptr<const core::ITypedExpr> filterExpr;
+  if (!filterText.empty()) {
+    filterExpr = parseExpr(filterText, resultType);
+  }
   auto outputType = extract(resultType, output);
 
   planNode_ = std::make_shared<core::CrossJoinNode>(
-      nextPlanNodeId(), std::move(planNode_), build, outputType);
+      nextPlanNodeId(),
+      std::move(planNode_),
+      build,
+      outputType,
+      std::move(filterExpr));
   return *this;
 }
 
@@ -519,6 +721,37 @@ PlanBuilder& PlanBuilder::unnest(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::groupId(
+    const std::vector<std::vector<std::string>>& groupingSets,
+    const std::vector<std::string>& aggregationInputs,
+    const std::string& groupIdName) {
+  std::vector<std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>>
+      groupingSetFields;
+  groupingSetFields.reserve(groupingSets.size());
+  for (const auto& groupingSet : groupingSets) {
+    std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> keys;
+    keys.reserve(groupingSet.size());
+    for (const auto& name : groupingSet) {
+      keys.emplace_back(field(name));
+    }
+    groupingSetFields.emplace_back(std::move(keys));
+  }
+
+  std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> inputFields;
+  inputFields.reserve(aggregationInputs.size());
+  for (const auto& name : aggregationInputs) {
+    inputFields.emplace_back(field(name));
+  }
+
+  planNode_ = std::make_shared<core::GroupIdNode>(
+      nextPlanNodeId(),
+      std::move(groupingSetFields),
+      std::move(inputFields),
+      groupIdName,
+      planNode_);
+  return *this;
+}
+
 std::string PlanBuilder::nextPlanNodeId() {
   auto id = fmt::format("{}", planNodeId_);
   planNodeId_++;
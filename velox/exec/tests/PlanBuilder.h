@@ -37,6 +37,19 @@ class PlanBuilder {
       const std::vector<RowVectorPtr>& values,
       bool parallelizable = false);
 
+  PlanBuilder& arrowStream(
+      const RowTypePtr& outputType,
+      std::shared_ptr<ArrowArrayStream> arrowStream);
+
+  /// Generates 'rowsPerDriver' rows per driver as described by 'columns'.
+  /// See core::SyntheticSourceNode.
+  PlanBuilder& syntheticSource(
+      const RowTypePtr& outputType,
+      std::vector<core::SyntheticColumn> columns,
+      uint64_t rowsPerDriver,
+      vector_size_t batchSize = 1'024,
+      uint64_t seed = 0);
+
   PlanBuilder& exchange(const RowTypePtr& outputType);
 
   PlanBuilder& mergeExchange(
@@ -117,7 +130,21 @@ class PlanBuilder {
         resultTypes);
   }
 
+  // @param distincts Optional list of flags, one per aggregate. Aggregates
+  // with a set flag see each distinct combination of their arguments once
+  // per group, e.g. count(DISTINCT c1). Requires a single aggregation step.
   PlanBuilder& aggregation(
+      const std::vector<ChannelIndex>& groupingKeys,
+      const std::vector<std::string>& aggregates,
+      const std::vector<std::string>& masks,
+      core::AggregationNode::Step step,
+      bool ignoreNullKeys,
+      const std::vector<TypePtr>& resultTypes = {},
+      const std::vector<bool>& distincts = {});
+
+  // Adds an aggregation over input that is clustered on all
+  // 'groupingKeys'. It is computed by StreamingAggregation.
+  PlanBuilder& streamingAggregation(
       const std::vector<ChannelIndex>& groupingKeys,
       const std::vector<std::string>& aggregates,
       const std::vector<std::string>& masks,
@@ -134,16 +161,47 @@ class PlanBuilder {
       const std::vector<core::SortOrder>& sortOrder,
       bool isPartial);
 
+  // Adds a WindowNode computing 'functions' over partitions on
+  // 'partitionKeys' sorted on 'sortingKeys'. 'frames' gives the frame
+  // of each function and defaults to RANGE BETWEEN UNBOUNDED PRECEDING
+  // AND CURRENT ROW. The window columns are named w0, w1, ...
+  PlanBuilder& window(
+      const std::vector<ChannelIndex>& partitionKeys,
+      const std::vector<ChannelIndex>& sortingKeys,
+      const std::vector<core::SortOrder>& sortingOrders,
+      const std::vector<std::string>& functions,
+      const std::vector<core::WindowNode::Frame>& frames = {},
+      bool inputsSorted = false);
+
   PlanBuilder& topN(
       const std::vector<ChannelIndex>& keyIndices,
       const std::vector<core::SortOrder>& sortOrder,
       int32_t count,
       bool isPartial);
 
+  // Adds a TopNRowNumberNode keeping the first 'limit' rows of each
+  // partition on 'partitionKeys'. If 'generateRowNumber' is true, the
+  // row numbers are in an extra column named row_number.
+  PlanBuilder& topNRowNumber(
+      const std::vector<ChannelIndex>& partitionKeys,
+      const std::vector<ChannelIndex>& sortingKeys,
+      const std::vector<core::SortOrder>& sortingOrders,
+      int32_t limit,
+      bool generateRowNumber,
+      bool isPartial = false);
+
   PlanBuilder& limit(int32_t offset, int32_t count, bool isPartial);
 
   PlanBuilder& enforceSingleRow();
 
+  // Adds a GroupIdNode. Each grouping set is a list of grouping key names.
+  // The output has the union of the grouping keys, the 'aggregationInputs'
+  // and a BIGINT 'groupIdName' column.
+  PlanBuilder& groupId(
+      const std::vector<std::vector<std::string>>& groupingSets,
+      const std::vector<std::string>& aggregationInputs,
+      const std::string& groupIdName = "group_id");
+
   std::shared_ptr<const core::FieldAccessTypedExpr> field(int index);
 
   std::shared_ptr<const core::FieldAccessTypedExpr> field(
@@ -182,8 +240,24 @@ class PlanBuilder {
       const std::vector<ChannelIndex>& output,
       core::JoinType joinType = core::JoinType::kInner);
 
+  // Joins the output of the previous PlanNode with the output of
+  // 'right'. Both must be sorted on the join keys. 'leftKeys',
+  // 'rightKeys' and 'output' are indices as in hashJoin().
+  PlanBuilder& mergeJoin(
+      const std::vector<ChannelIndex>& leftKeys,
+      const std::vector<ChannelIndex>& rightKeys,
+      const std::shared_ptr<core::PlanNode>& right,
+      const std::vector<ChannelIndex>& output,
+      core::JoinType joinType = core::JoinType::kInner);
+
+  PlanBuilder& crossJoin(
+      const std::shared_ptr<core::PlanNode>& build,
+      const std::vector<ChannelIndex>& output);
+
+  // Cross join with a filter on the combined probe and build columns.
   PlanBuilder& crossJoin(
       const std::shared_ptr<core::PlanNode>& build,
+      const std::string& filterText,
       const std::vector<ChannelIndex>& output);
 
   PlanBuilder& unnest(
@@ -207,6 +281,16 @@ class PlanBuilder {
  private:
   std::string nextPlanNodeId();
 
+  PlanBuilder& aggregation(
+      const std::vector<ChannelIndex>& groupingKeys,
+      const std::vector<ChannelIndex>& preGroupedKeys,
+      const std::vector<std::string>& aggregates,
+      const std::vector<std::string>& masks,
+      core::AggregationNode::Step step,
+      bool ignoreNullKeys,
+      const std::vector<TypePtr>& resultTypes,
+      const std::vector<bool>& distincts);
+
   std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> fields(
       const std::vector<ChannelIndex>& indices);
   std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> fields(
@@ -403,3 +403,109 @@ TEST_F(RowContainerTest, rowSize) {
 
   EXPECT_EQ(rows, rowsFromContainer);
 }
+
+TEST_F(RowContainerTest, columnarDependents) {
+  // More rows than fit in one column chunk.
+  constexpr int32_t kNumRows = 10'000;
+  auto batch = makeDataset(
+      "key:bigint,a:double,b:string,c:int,d:timestamp", kNumRows, nullptr);
+  static const std::vector<std::unique_ptr<Aggregate>> kEmptyAggregates;
+  auto data = std::make_unique<RowContainer>(
+      std::vector<TypePtr>{BIGINT()},
+      true, // nullableKeys
+      kEmptyAggregates,
+      std::vector<TypePtr>{DOUBLE(), VARCHAR(), INTEGER(), TIMESTAMP()},
+      false, // hasNext
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      false, // hasNormalizedKey
+      mappedMemory_,
+      ContainerRowSerde::instance(),
+      true); // columnarDependents
+  EXPECT_FALSE(data->isColumnar(0));
+  EXPECT_TRUE(data->isColumnar(1));
+  EXPECT_FALSE(data->isColumnar(2));
+  EXPECT_TRUE(data->isColumnar(3));
+  EXPECT_TRUE(data->isColumnar(4));
+
+  std::vector<char*> rows(kNumRows);
+  for (auto i = 0; i < kNumRows; ++i) {
+    rows[i] = data->newRow();
+  }
+  SelectivityVector allRows(kNumRows);
+  for (auto column = 0; column < batch->childrenSize(); ++column) {
+    DecodedVector decoded(*batch->childAt(column), allRows);
+    for (auto i = 0; i < kNumRows; ++i) {
+      data->store(decoded, i, rows[i], column);
+    }
+  }
+  for (auto column = 0; column < batch->childrenSize(); ++column) {
+    testExtractColumnForAllRows(*data, rows, column, batch->childAt(column));
+    testExtractColumnForOddRows(*data, rows, column, batch->childAt(column));
+  }
+
+  // Reused rows keep their place in the column chunks.
+  std::vector<char*> erased;
+  for (auto i = 0; i < kNumRows; i += 3) {
+    erased.push_back(rows[i]);
+  }
+  data->eraseRows(folly::Range<char**>(erased.data(), erased.size()));
+  for (auto i = 0; i < erased.size(); ++i) {
+    data->newRow();
+  }
+  for (auto column = 0; column < batch->childrenSize(); ++column) {
+    DecodedVector decoded(*batch->childAt(column), allRows);
+    for (auto i = 0; i < kNumRows; i += 3) {
+      data->store(decoded, i, rows[i], column);
+    }
+  }
+  for (auto column = 0; column < batch->childrenSize(); ++column) {
+    testExtractColumnForAllRows(*data, rows, column, batch->childAt(column));
+  }
+  data->checkConsistency();
+}
+
+TEST_F(RowContainerTest, equalKeys) {
+  constexpr int32_t kNumRows = 100;
+  auto batch = makeDataset("key1:bigint,key2:int", kNumRows, nullptr);
+  static const std::vector<std::unique_ptr<Aggregate>> kEmptyAggregates;
+  auto data = std::make_unique<RowContainer>(
+      std::vector<TypePtr>{BIGINT(), INTEGER()},
+      true, // nullableKeys
+      kEmptyAggregates,
+      std::vector<TypePtr>{},
+      false, // hasNext
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      false, // hasNormalizedKey
+      mappedMemory_,
+      ContainerRowSerde::instance());
+  ASSERT_TRUE(data->hasBytewiseKeys());
+
+  // Each input row is stored twice, so that each row has an equal row.
+  std::vector<char*> rows(2 * kNumRows);
+  for (auto i = 0; i < rows.size(); ++i) {
+    rows[i] = data->newRow();
+  }
+  SelectivityVector allRows(kNumRows);
+  for (auto column = 0; column < batch->childrenSize(); ++column) {
+    DecodedVector decoded(*batch->childAt(column), allRows);
+    for (auto i = 0; i < rows.size(); ++i) {
+      data->store(decoded, i % kNumRows, rows[i], column);
+    }
+  }
+  CompareFlags flags{true, true};
+  for (auto i = 0; i < rows.size(); ++i) {
+    for (auto j = 0; j < rows.size(); ++j) {
+      bool expected = data->compare(rows[i], rows[j], 0, flags) == 0 &&
+          data->compare(rows[i], rows[j], 1, flags) == 0;
+      ASSERT_EQ(expected, data->equalKeys(rows[i], rows[j])) << i << " " << j;
+    }
+    ASSERT_TRUE(data->equalKeys(rows[i], rows[(i + kNumRows) % rows.size()]));
+  }
+
+  // Floating point and string keys are compared by value.
+  EXPECT_FALSE(makeRowContainer({DOUBLE()}, {})->hasBytewiseKeys());
+  EXPECT_FALSE(makeRowContainer({BIGINT(), VARCHAR()}, {})->hasBytewiseKeys());
+  EXPECT_TRUE(makeRowContainer({TIMESTAMP()}, {})->hasBytewiseKeys());
+}
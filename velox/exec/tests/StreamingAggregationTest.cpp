@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec::test;
+
+class StreamingAggregationTest : public OperatorTestBase {
+ protected:
+  // Returns batches clustered on c0. Each key repeats in 'keyRepeat'
+  // consecutive rows. c1 is the row number. The keys of the first
+  // 'numNullKeys' rows are null.
+  std::vector<RowVectorPtr> makeVectors(
+      int32_t numBatches,
+      vector_size_t batchSize,
+      int32_t keyRepeat,
+      int32_t numNullKeys = 0) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numBatches; ++i) {
+      auto offset = i * batchSize;
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int32_t>(
+              batchSize,
+              [&](auto row) { return (offset + row) / keyRepeat; },
+              [&](auto row) { return offset + row < numNullKeys; }),
+          makeFlatVector<int64_t>(
+              batchSize, [&](auto row) { return offset + row; }),
+      }));
+    }
+    return vectors;
+  }
+
+  void testAggregation(const std::vector<RowVectorPtr>& vectors) {
+    createDuckDbTable(vectors);
+
+    auto plan = PlanBuilder()
+                    .values(vectors)
+                    .streamingAggregation(
+                        {0},
+                        {"count(1)", "sum(c1)", "min(c1)", "max(c1)"},
+                        {},
+                        core::AggregationNode::Step::kSingle,
+                        false)
+                    .planNode();
+    assertQuery(
+        plan,
+        "SELECT c0, count(1), sum(c1), min(c1), max(c1) FROM tmp GROUP BY 1");
+
+    plan = PlanBuilder()
+               .values(vectors)
+               .streamingAggregation(
+                   {0},
+                   {"count(1)", "sum(c1)"},
+                   {},
+                   core::AggregationNode::Step::kPartial,
+                   false)
+               .streamingAggregation(
+                   {0},
+                   {"sum(a0)", "sum(a1)"},
+                   {},
+                   core::AggregationNode::Step::kFinal,
+                   false)
+               .planNode();
+    assertQuery(plan, "SELECT c0, count(1), sum(c1) FROM tmp GROUP BY 1");
+
+    // Distinct.
+    plan = PlanBuilder()
+               .values(vectors)
+               .streamingAggregation(
+                   {0}, {}, {}, core::AggregationNode::Step::kSingle, false)
+               .planNode();
+    assertQuery(plan, "SELECT DISTINCT c0 FROM tmp");
+  }
+};
+
+TEST_F(StreamingAggregationTest, smallGroups) {
+  // Groups continue across batch boundaries.
+  testAggregation(makeVectors(10, 1'000, 3));
+}
+
+TEST_F(StreamingAggregationTest, largeGroups) {
+  testAggregation(makeVectors(10, 1'000, 2'500));
+}
+
+TEST_F(StreamingAggregationTest, manyGroups) {
+  // More groups than fit in one output batch.
+  testAggregation(makeVectors(3, 10'000, 1));
+}
+
+TEST_F(StreamingAggregationTest, nullKeys) {
+  auto vectors = makeVectors(3, 1'000, 7, 1'500);
+  testAggregation(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .streamingAggregation(
+                      {0},
+                      {"count(1)", "sum(c1)"},
+                      {},
+                      core::AggregationNode::Step::kSingle,
+                      true)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT c0, count(1), sum(c1) FROM tmp WHERE c0 IS NOT NULL "
+      "GROUP BY 1");
+}
+
+TEST_F(StreamingAggregationTest, multiKey) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 5; ++i) {
+    auto offset = i * 1'000;
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            1'000, [&](auto row) { return (offset + row) / 100; }),
+        makeFlatVector<StringView>(
+            1'000,
+            [&](auto row) {
+              return StringView(
+                  std::string((offset + row) % 100 / 7 + 1, 'x'));
+            }),
+        makeFlatVector<int64_t>(1'000, [&](auto row) { return row; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .streamingAggregation(
+                      {0, 1},
+                      {"count(1)", "max(c2)"},
+                      {},
+                      core::AggregationNode::Step::kSingle,
+                      false)
+                  .planNode();
+  assertQuery(
+      plan, "SELECT c0, c1, count(1), max(c2) FROM tmp GROUP BY 1, 2");
+}
+
+TEST_F(StreamingAggregationTest, mask) {
+  auto vectors = makeVectors(5, 1'000, 11);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .project({"c0", "c1", "c1 % 3 = 0"}, {"c0", "c1", "m"})
+                  .streamingAggregation(
+                      {0},
+                      {"sum(c1)", "count(1)"},
+                      {"m", "m"},
+                      core::AggregationNode::Step::kSingle,
+                      false)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT c0, sum(c1) FILTER (WHERE c1 % 3 = 0), "
+      "count(1) FILTER (WHERE c1 % 3 = 0) FROM tmp GROUP BY 1");
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+#include "velox/vector/DecodedVector.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+using Distribution = core::SyntheticColumn::Distribution;
+using Encoding = core::SyntheticColumn::Encoding;
+
+class SyntheticSourceTest : public OperatorTestBase {
+ protected:
+  static core::SyntheticColumn column(
+      Distribution distribution,
+      Encoding encoding,
+      int64_t min,
+      int64_t max) {
+    core::SyntheticColumn column;
+    column.distribution = distribution;
+    column.encoding = encoding;
+    column.min = min;
+    column.max = max;
+    return column;
+  }
+
+  std::vector<RowVectorPtr> read(
+      const std::shared_ptr<const core::PlanNode>& plan,
+      int32_t maxDrivers = 1) {
+    CursorParameters params;
+    params.planNode = plan;
+    params.maxDrivers = maxDrivers;
+    auto [cursor, results] = readCursor(params, [](Task* /*task*/) {});
+    // The results are only valid while the cursor holds on to the task.
+    cursors_.push_back(std::move(cursor));
+    return results;
+  }
+
+  std::vector<std::unique_ptr<TaskCursor>> cursors_;
+};
+
+TEST_F(SyntheticSourceTest, sequence) {
+  auto prefixed = column(Distribution::kSequence, Encoding::kFlat, 0, 9);
+  prefixed.prefix = "value ";
+  auto plan = PlanBuilder()
+                  .syntheticSource(
+                      ROW({"c0", "c1"}, {BIGINT(), VARCHAR()}),
+                      {column(
+                           Distribution::kSequence,
+                           Encoding::kFlat,
+                           0,
+                           std::numeric_limits<int64_t>::max()),
+                       prefixed},
+                      1'000,
+                      100)
+                  .planNode();
+
+  // Each driver generates its own rows, which continue the sequence of the
+  // previous driver.
+  CursorParameters params;
+  params.planNode = plan;
+  params.maxDrivers = 4;
+  assertQuery(
+      params,
+      [](Task* /*task*/) {},
+      "SELECT range, 'value ' || (range % 10)::VARCHAR FROM range(4000)");
+}
+
+TEST_F(SyntheticSourceTest, distributions) {
+  auto nullable = column(Distribution::kUniform, Encoding::kFlat, -5, 5);
+  nullable.nullRatio = 0.5;
+  auto rowType = ROW({"c0", "c1", "c2"}, {INTEGER(), DOUBLE(), SMALLINT()});
+  auto plan = PlanBuilder()
+                  .syntheticSource(
+                      rowType,
+                      {column(Distribution::kUniform, Encoding::kFlat, 10, 20),
+                       column(Distribution::kNormal, Encoding::kFlat, 0, 60),
+                       nullable},
+                      10'000)
+                  .singleAggregation(
+                      {},
+                      {"min(c0)",
+                       "max(c0)",
+                       "min(c1)",
+                       "max(c1)",
+                       "avg(c1)",
+                       "count(c2)"})
+                  .planNode();
+  auto result = read(plan);
+  ASSERT_EQ(1, result.size());
+  auto value = [&](int32_t channel) {
+    return result[0]->childAt(channel)->variantAt(0);
+  };
+  EXPECT_EQ(10, value(0).value<int32_t>());
+  EXPECT_EQ(20, value(1).value<int32_t>());
+  EXPECT_LE(0, value(2).value<double>());
+  EXPECT_GE(60, value(3).value<double>());
+  EXPECT_NEAR(30, value(4).value<double>(), 1);
+  EXPECT_NEAR(5'000, value(5).value<int64_t>(), 500);
+}
+
+TEST_F(SyntheticSourceTest, encodings) {
+  auto dictionary =
+      column(Distribution::kUniform, Encoding::kDictionary, 100, 100);
+  dictionary.cardinality = 5;
+  dictionary.prefix = "a rather long string ";
+  dictionary.nullRatio = 0.1;
+  auto plan = PlanBuilder()
+                  .syntheticSource(
+                      ROW({"c0", "c1"}, {VARCHAR(), BIGINT()}),
+                      {dictionary,
+                       column(
+                           Distribution::kSequence,
+                           Encoding::kConstant,
+                           0,
+                           std::numeric_limits<int64_t>::max())},
+                      1'000,
+                      100)
+                  .planNode();
+  auto result = read(plan);
+  ASSERT_EQ(10, result.size());
+  std::unordered_set<std::string> values;
+  for (auto i = 0; i < result.size(); ++i) {
+    auto strings = result[i]->childAt(0);
+    ASSERT_EQ(VectorEncoding::Simple::DICTIONARY, strings->encoding());
+    auto constant = result[i]->childAt(1);
+    ASSERT_EQ(VectorEncoding::Simple::CONSTANT, constant->encoding());
+    EXPECT_EQ(i * 100, constant->as<SimpleVector<int64_t>>()->valueAt(0));
+
+    SelectivityVector rows(strings->size());
+    DecodedVector decoded(*strings, rows);
+    for (auto row = 0; row < strings->size(); ++row) {
+      if (!decoded.isNullAt(row)) {
+        values.insert(decoded.valueAt<StringView>(row).str());
+      }
+    }
+  }
+  // The dictionary holds the values of 5 numbers starting at min.
+  EXPECT_EQ(
+      (std::unordered_set<std::string>{
+          "a rather long string 100",
+          "a rather long string 101",
+          "a rather long string 102",
+          "a rather long string 103",
+          "a rather long string 104"}),
+      values);
+}
+
+TEST_F(SyntheticSourceTest, seed) {
+  auto makePlan = [&](uint64_t seed) {
+    return PlanBuilder()
+        .syntheticSource(
+            ROW({"c0"}, {BIGINT()}),
+            {column(Distribution::kUniform, Encoding::kFlat, 0, 1'000'000)},
+            1'000,
+            1'024,
+            seed)
+        .planNode();
+  };
+  auto expected = read(makePlan(1));
+  assertEqualResults(expected, read(makePlan(1)));
+
+  auto other = read(makePlan(2));
+  ASSERT_EQ(1, other.size());
+  EXPECT_FALSE(expected[0]->equalValueAt(other[0].get(), 0, 0) &&
+               expected[0]->equalValueAt(other[0].get(), 1, 1));
+}
+
+TEST_F(SyntheticSourceTest, unsupportedType) {
+  auto plan = PlanBuilder()
+                  .syntheticSource(
+                      ROW({"c0"}, {ARRAY(BIGINT())}),
+                      {core::SyntheticColumn{}},
+                      10)
+                  .planNode();
+  EXPECT_THROW(read(plan), VeloxException);
+}
+
+} // namespace
@@ -39,6 +39,7 @@ using namespace facebook::velox::exec::test;
 
 static const std::string kNodeSelectionStrategy = "node_selection_strategy";
 static const std::string kSoftAffinity = "SOFT_AFFINITY";
+static const std::string kParallelDecoding = "parallel_decoding";
 static const std::string kTableScanTest = "TableScanTest.Writer";
 
 class TableScanTest : public virtual HiveConnectorTestBase,
@@ -350,6 +351,143 @@ TEST_P(TableScanTest, constDictLazy) {
   assertQuery(op, {filePath}, "SELECT 2 FROM tmp WHERE c0 = 5");
 }
 
+// Tests reading only the map entries and array elements in the
+// required subfields of the column.
+TEST_P(TableScanTest, subscriptPruning) {
+  vector_size_t size = 1'000;
+  // The keys of the map at 'row' are 0 to row % 5 - 1.
+  std::vector<int64_t> keys;
+  for (auto row = 0; row < size; ++row) {
+    for (auto key = 0; key < row % 5; ++key) {
+      keys.push_back(key);
+    }
+  }
+  auto rowVector = makeRowVector(
+      {makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+       makeMapVector<int64_t, double>(
+           size,
+           [](auto row) { return row % 5; },
+           [&](auto idx) { return keys[idx]; },
+           [&](auto idx) { return keys[idx] * 0.1; }),
+       makeArrayVector<int64_t>(
+           size,
+           [](auto row) { return row % 5; },
+           [](auto /*row*/, auto idx) { return idx; })});
+
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, {rowVector});
+  // Exclude map and array columns as DuckDB doesn't support complex types
+  // yet.
+  createDuckDbTable({makeRowVector({rowVector->childAt(0)})});
+
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  auto assignments = allRegularColumns(rowType);
+  std::vector<common::Subfield> mapSubfields;
+  mapSubfields.emplace_back("c1[1]");
+  mapSubfields.emplace_back("c1[3]");
+  assignments["c1"] = std::make_shared<connector::hive::HiveColumnHandle>(
+      "c1",
+      connector::hive::HiveColumnHandle::ColumnType::kRegular,
+      std::move(mapSubfields));
+  std::vector<common::Subfield> arraySubfields;
+  arraySubfields.emplace_back("c2[2]");
+  assignments["c2"] = std::make_shared<connector::hive::HiveColumnHandle>(
+      "c2",
+      connector::hive::HiveColumnHandle::ColumnType::kRegular,
+      std::move(arraySubfields));
+
+  auto tableHandle = makeTableHandle(SubfieldFilters{});
+  auto op = PlanBuilder()
+                .tableScan(rowType, tableHandle, assignments)
+                .project({"c0", "cardinality(c1)", "cardinality(c2)"})
+                .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT c0, CAST(c0 % 5 > 1 AS BIGINT) + CAST(c0 % 5 > 3 AS BIGINT), "
+      "least(c0 % 5, 2) FROM tmp");
+}
+
+// Tests reading only the struct fields in the required subfields of the
+// column. The other fields are null.
+TEST_P(TableScanTest, structSubfieldPruning) {
+  vector_size_t size = 1'000;
+  auto nestedType = ROW({"x", "y"}, {INTEGER(), VARCHAR()});
+  auto structType = ROW({"a", "b", "c"}, {BIGINT(), nestedType, DOUBLE()});
+  auto makeStruct = [&](bool withX, bool withC) {
+    auto x = withX ? makeFlatVector<int32_t>(size, [](auto row) { return row; })
+                   : makeFlatVector<int32_t>(
+                         size, [](auto /*row*/) { return 0; }, nullEvery(1));
+    auto c = withC
+        ? makeFlatVector<double>(size, [](auto row) { return row * 0.5; })
+        : makeFlatVector<double>(
+              size, [](auto /*row*/) { return 0; }, nullEvery(1));
+    auto nested = std::make_shared<RowVector>(
+        pool_.get(),
+        nestedType,
+        BufferPtr(nullptr),
+        size,
+        std::vector<VectorPtr>{
+            x, makeFlatVector<StringView>(size, [](auto row) {
+              return StringView(row % 2 ? "an odd row string" : "even");
+            })});
+    return std::make_shared<RowVector>(
+        pool_.get(),
+        structType,
+        BufferPtr(nullptr),
+        size,
+        std::vector<VectorPtr>{
+            makeFlatVector<int64_t>(size, [](auto row) { return row * 3; }),
+            nested,
+            c});
+  };
+  auto rowVector = makeRowVector(
+      {makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+       makeStruct(true, true)});
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, {rowVector});
+
+  auto assignments = allRegularColumns(rowType);
+  std::vector<common::Subfield> subfields;
+  subfields.emplace_back("c1.a");
+  subfields.emplace_back("c1.b.y");
+  assignments["c1"] = std::make_shared<connector::hive::HiveColumnHandle>(
+      "c1",
+      connector::hive::HiveColumnHandle::ColumnType::kRegular,
+      std::move(subfields));
+
+  auto read = [&](SubfieldFilters filters) {
+    CursorParameters params;
+    params.planNode = PlanBuilder()
+                          .tableScan(
+                              rowType,
+                              makeTableHandle(std::move(filters)),
+                              assignments)
+                          .planNode();
+    bool splitAdded = false;
+    return readCursor(params, [&](Task* task) {
+      if (!splitAdded) {
+        addSplit(task, "0", makeHiveSplit(filePath->path));
+        task->noMoreSplits("0");
+        splitAdded = true;
+      }
+    });
+  };
+
+  auto [cursor, results] = read(SubfieldFilters{});
+  assertEqualResults(
+      {makeRowVector({rowVector->childAt(0), makeStruct(false, false)})},
+      results);
+
+  // A field with a filter is read even if it is not required.
+  auto [filterCursor, filterResults] =
+      read(singleSubfieldFilter("c1.b.x", lessThanOrEqual(size - 1)));
+  assertEqualResults(
+      {makeRowVector({rowVector->childAt(0), makeStruct(true, false)})},
+      filterResults);
+}
+
 TEST_P(TableScanTest, count) {
   auto vectors = makeVectors(10, 1'000);
   auto filePath = TempFilePath::create();
@@ -473,6 +611,109 @@ TEST_P(TableScanTest, multipleSplits) {
   assertQuery(tableScanNode(), filePaths, "SELECT * FROM tmp");
 }
 
+TEST_P(TableScanTest, manySmallSplits) {
+  // With AsyncDataCache the connector has an IO executor and the splits
+  // after the first are prepared in the background.
+  auto filePaths = makeFilePaths(50);
+  auto vectors = makeVectors(50, 100);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+
+  auto task = assertQuery(tableScanNode(), filePaths, "SELECT * FROM tmp");
+  EXPECT_EQ(50, getTableScanStats(task).numSplits);
+
+  auto filters = singleSubfieldFilter("c0", greaterThanOrEqual(0));
+  auto op = PlanBuilder()
+                .tableScan(
+                    rowType_,
+                    makeTableHandle(std::move(filters)),
+                    allRegularColumns(rowType_))
+                .planNode();
+  assertQuery(op, filePaths, "SELECT * FROM tmp WHERE c0 >= 0");
+}
+
+TEST_P(TableScanTest, parallelDecoding) {
+  // With AsyncDataCache the connector has an executor on which the
+  // columns without filters are decoded after the filter on c0.
+  auto vectors = makeVectors(10, 10'000);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.planNode = PlanBuilder()
+                        .tableScan(
+                            rowType_,
+                            makeTableHandle(singleSubfieldFilter(
+                                "c0", greaterThanOrEqual(0))),
+                            allRegularColumns(rowType_))
+                        .planNode();
+  params.queryCtx = core::QueryCtx::create(
+      std::make_shared<core::MemConfig>(),
+      {{kHiveConnectorId,
+        std::make_shared<core::MemConfig>(
+            std::unordered_map<std::string, std::string>{
+                {kParallelDecoding, "true"}})}},
+      memory::MappedMemory::getInstance());
+
+  bool splitAdded = false;
+  ::assertQuery(
+      params,
+      [&](Task* task) {
+        if (!splitAdded) {
+          addSplit(task, "0", makeHiveSplit(filePath->path));
+          task->noMoreSplits("0");
+          splitAdded = true;
+        }
+      },
+      "SELECT * FROM tmp WHERE c0 >= 0",
+      duckDbQueryRunner_);
+}
+
+TEST_P(TableScanTest, parallelDecodingRemainingFilter) {
+  // The remaining filter is evaluated in the scan after the filter on c0,
+  // so that the other columns are decoded only for the rows passing both.
+  auto rowType = ROW(
+      {"c0", "c1", "c2", "c3"}, {INTEGER(), INTEGER(), DOUBLE(), BOOLEAN()});
+  auto vectors = makeVectors(10, 10'000, rowType);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.planNode =
+      PlanBuilder()
+          .tableScan(
+              rowType,
+              makeTableHandle(
+                  singleSubfieldFilter("c0", greaterThanOrEqual(0)),
+                  parseExpr("c1 > c0 AND c3", rowType)),
+              allRegularColumns(rowType))
+          .planNode();
+  params.queryCtx = core::QueryCtx::create(
+      std::make_shared<core::MemConfig>(),
+      {{kHiveConnectorId,
+        std::make_shared<core::MemConfig>(
+            std::unordered_map<std::string, std::string>{
+                {kParallelDecoding, "true"}})}},
+      memory::MappedMemory::getInstance());
+
+  bool splitAdded = false;
+  ::assertQuery(
+      params,
+      [&](Task* task) {
+        if (!splitAdded) {
+          addSplit(task, "0", makeHiveSplit(filePath->path));
+          task->noMoreSplits("0");
+          splitAdded = true;
+        }
+      },
+      "SELECT * FROM tmp WHERE c0 >= 0 AND c1 > c0 AND c3",
+      duckDbQueryRunner_);
+}
+
 TEST_P(TableScanTest, waitForSplit) {
   auto filePaths = makeFilePaths(10);
   auto vectors = makeVectors(10, 1'000);
@@ -562,6 +803,46 @@ TEST_P(TableScanTest, partitionedTable) {
   testPartitionedTable(filePath->path);
 }
 
+TEST_P(TableScanTest, partitionKeyBasedSkipping) {
+  auto rowType = ROW({"c0", "c1"}, {BIGINT(), DOUBLE()});
+  auto vectors = makeVectors(10, 1'000, rowType);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  auto makeSplit = [&](const std::string& path,
+                       const std::optional<std::string>& ds) {
+    return std::make_shared<HiveConnectorSplit>(
+        kHiveConnectorId,
+        path,
+        facebook::velox::dwio::common::FileFormat::ORC,
+        0,
+        fs::file_size(filePath->path),
+        std::unordered_map<std::string, std::optional<std::string>>{
+            {"ds", ds}});
+  };
+  // The splits that the filter rules out do not exist. Opening them would
+  // fail the query.
+  std::vector<std::shared_ptr<connector::ConnectorSplit>> splits = {
+      makeSplit("/non-existent/1", "2020-10-31"),
+      makeSplit(filePath->path, "2020-11-01"),
+      makeSplit("/non-existent/2", std::nullopt)};
+
+  ColumnHandleMap assignments = {
+      {"ds", partitionKey("ds")}, {"c0", regularColumn("c0")}};
+  auto op = PlanBuilder()
+                .tableScan(
+                    ROW({"c0"}, {BIGINT()}),
+                    makeTableHandle(
+                        singleSubfieldFilter("ds", equal("2020-11-01"))),
+                    assignments)
+                .planNode();
+  auto task = OperatorTestBase::assertQuery(op, splits, "SELECT c0 FROM tmp");
+  auto stats = getTableScanStats(task).runtimeStats;
+  EXPECT_EQ(2, stats["skippedPartitionSplits"].sum);
+  EXPECT_EQ(2, stats["skippedSplits"].sum);
+}
+
 std::vector<StringView> toStringViews(const std::vector<std::string>& values) {
   std::vector<StringView> views;
   views.reserve(values.size());
@@ -710,6 +991,79 @@ TEST_P(TableScanTest, statsBasedSkippingFloat) {
   EXPECT_EQ(3, getSkippedStridesStat(task));
 }
 
+// Test skipping strides that have none of the values of an IN list in
+// their range.
+TEST_P(TableScanTest, statsBasedSkippingInList) {
+  auto filePaths = makeFilePaths(1);
+  auto size = 31'234;
+  auto rowVector = makeRowVector(
+      {makeFlatVector<int64_t>(size, [](auto row) { return row; })});
+
+  writeToFile(filePaths[0]->path, kTableScanTest, rowVector);
+  createDuckDbTable({rowVector});
+
+  ColumnHandleMap assignments = {{"c0", regularColumn("c0")}};
+  auto assertQuery = [&](SubfieldFilters subfieldFilters,
+                         const std::string& query) {
+    auto tableHandle = makeTableHandle(std::move(subfieldFilters));
+    return TableScanTest::assertQuery(
+        PlanBuilder()
+            .tableScan(ROW({"c0"}, {BIGINT()}), tableHandle, assignments)
+            .planNode(),
+        filePaths,
+        query);
+  };
+
+  // The values are in the first and third strides. The range of the
+  // values covers all strides.
+  auto task = assertQuery(
+      singleSubfieldFilter("c0", in({5, 25'000, 40'000})),
+      "SELECT c0 FROM tmp WHERE c0 IN (5, 25000, 40000)");
+  EXPECT_EQ(20'000, getTableScanStats(task).rawInputPositions);
+  EXPECT_EQ(2, getSkippedStridesStat(task));
+}
+
+// Test skipping a stripe that has no dictionary entry that passes the
+// filter.
+TEST_P(TableScanTest, dictionaryBasedSkipping) {
+  auto filePaths = makeFilePaths(1);
+  auto size = 31'234;
+  std::vector<StringView> fruits = {"apple", "cherry"};
+  auto rowVector = makeRowVector(
+      {makeFlatVector<int32_t>(size, [](auto row) { return row; }),
+       makeFlatVector<StringView>(
+           size, [&](auto row) { return fruits[row % fruits.size()]; })});
+
+  writeToFile(filePaths[0]->path, kTableScanTest, rowVector);
+  createDuckDbTable({rowVector});
+
+  ColumnHandleMap assignments = {{"c0", regularColumn("c0")}};
+  auto assertQuery = [&](SubfieldFilters subfieldFilters,
+                         const std::string& query) {
+    auto tableHandle = makeTableHandle(std::move(subfieldFilters));
+    return TableScanTest::assertQuery(
+        PlanBuilder()
+            .tableScan(ROW({"c0"}, {INTEGER()}), tableHandle, assignments)
+            .planNode(),
+        filePaths,
+        query);
+  };
+
+  // "banana" is between the min and max of every stride but is not in
+  // the dictionary.
+  auto task = assertQuery(
+      singleSubfieldFilter("c1", in({"banana", "beet"})),
+      "SELECT c0 FROM tmp WHERE c1 IN ('banana', 'beet')");
+  EXPECT_EQ(0, getTableScanStats(task).rawInputPositions);
+  EXPECT_EQ(4, getSkippedStridesStat(task));
+
+  task = assertQuery(
+      singleSubfieldFilter("c1", in({"banana", "cherry"})),
+      "SELECT c0 FROM tmp WHERE c1 IN ('banana', 'cherry')");
+  EXPECT_EQ(size, getTableScanStats(task).rawInputPositions);
+  EXPECT_EQ(0, getSkippedStridesStat(task));
+}
+
 // Test skipping whole file based on statistics
 TEST_P(TableScanTest, statsBasedSkipping) {
   auto filePaths = makeFilePaths(1);
@@ -1634,6 +1988,116 @@ TEST_P(TableScanTest, bitwiseAggregationPushdown) {
       "SELECT c5, bit_or(c0), bit_or(c1), bit_or(c2), bit_or(c6) FROM tmp group by c5");
 }
 
+TEST_P(TableScanTest, moreAggregationPushdown) {
+  auto vectors = makeVectors(10, 1'000);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+  auto tableHandle = makeTableHandle(SubfieldFilters(), nullptr);
+
+  auto assignments = allRegularColumns(rowType_);
+
+  auto op = PlanBuilder()
+                .tableScan(rowType_, tableHandle, assignments)
+                .singleAggregation(
+                    {5}, {"count(c0)", "avg(c1)", "avg(c4)", "count(c6)"})
+                .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT c5, count(c0), avg(c1), avg(c4), count(c6) FROM tmp "
+      "GROUP BY c5");
+
+  // Global aggregation pushes down into the single group.
+  op = PlanBuilder()
+           .tableScan(rowType_, tableHandle, assignments)
+           .singleAggregation(
+               {},
+               {"max(c0)",
+                "sum(c1)",
+                "bitwise_or_agg(c2)",
+                "avg(c3)",
+                "min(c4)",
+                "count(c5)"})
+           .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT max(c0), sum(c1), bit_or(c2), avg(c3), min(c4), count(c5) "
+      "FROM tmp");
+}
+
+TEST_P(TableScanTest, fragmentResultCache) {
+  auto filePaths = makeFilePaths(4);
+  auto vectors = makeVectors(4, 1'000);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+
+  // Cache hits in the TableScan and stores in the partial aggregation.
+  using Counts = std::pair<int64_t, int64_t>;
+  auto runQuery = [&](const std::vector<std::string>& aggregates,
+                      const std::string& duckDbSql,
+                      bool withModificationTime) {
+    CursorParameters params;
+    params.planNode = PlanBuilder()
+                          .tableScan(rowType_)
+                          .partialAggregation({6}, aggregates)
+                          .finalAggregation({0}, {"sum(a0)", "sum(a1)"})
+                          .planNode();
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryCtx::kFragmentResultCacheEnabled, "true"},
+    });
+    bool splitsAdded = false;
+    auto task = ::assertQuery(
+        params,
+        [&](Task* task) {
+          if (splitsAdded) {
+            return;
+          }
+          for (const auto& filePath : filePaths) {
+            auto split = makeHiveConnectorSplit(filePath->path);
+            if (withModificationTime) {
+              split->fileModificationTime = 1;
+            }
+            task->addSplit("0", exec::Split(std::move(split)));
+          }
+          task->noMoreSplits("0");
+          splitsAdded = true;
+        },
+        duckDbSql,
+        duckDbQueryRunner_);
+    auto& operatorStats = task->taskStats().pipelineStats[0].operatorStats;
+    return Counts(
+        operatorStats[0].runtimeStats["fragmentResultCacheHits"].sum,
+        operatorStats[1].runtimeStats["fragmentResultCacheStores"].sum);
+  };
+
+  const std::vector<std::string> aggregates = {"count(c0)", "sum(c1)"};
+  const std::string duckDbSql =
+      "SELECT c6, count(c0), sum(c1) FROM tmp GROUP BY 1";
+  // Results are cached only in an AsyncDataCache.
+  const int64_t numCached = GetParam() ? filePaths.size() : 0;
+
+  // The first run stores the result of each split, the second takes
+  // all from the cache.
+  EXPECT_EQ(Counts(0, numCached), runQuery(aggregates, duckDbSql, true));
+  EXPECT_EQ(Counts(numCached, 0), runQuery(aggregates, duckDbSql, true));
+
+  // A different fragment does not hit the results of the first.
+  EXPECT_EQ(
+      Counts(0, numCached),
+      runQuery(
+          {"count(c0)", "sum(c2)"},
+          "SELECT c6, count(c0), sum(c2) FROM tmp GROUP BY 1",
+          true));
+
+  // Splits without a modification time are not cached.
+  EXPECT_EQ(Counts(0, 0), runQuery(aggregates, duckDbSql, false));
+}
+
 VELOX_INSTANTIATE_TEST_SUITE_P(
     TableScanTests,
     TableScanTest,
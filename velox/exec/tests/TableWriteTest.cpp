@@ -235,3 +235,62 @@ TEST_F(TableWriteTest, writeEmptyFile) {
                   .planNode();
   ASSERT_FALSE(fs::exists(outputFile));
 }
+
+// Writes a table partitioned by c0 and bucketed by c1 and checks that each
+// partition directory has the rows of its partition in files named after
+// their buckets.
+TEST_F(TableWriteTest, partitionedAndBucketed) {
+  constexpr int32_t kNumPartitions = 5;
+  constexpr int32_t kNumBuckets = 4;
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 3; ++i) {
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            1'000, [&](auto row) { return (row + i) % kNumPartitions; }),
+        makeFlatVector<int64_t>(
+            1'000, [&](auto row) { return i * 1'000 + row; }),
+        makeFlatVector<StringView>(
+            1'000,
+            [](auto row) { return StringView(fmt::format("s{}", row % 7)); }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  char dirTemplate[] = "/tmp/velox_table_write_XXXXXX";
+  const std::string directory = mkdtemp(dirTemplate);
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .tableWrite(
+                      {"c0", "c1", "c2"},
+                      std::make_shared<core::InsertTableHandle>(
+                          kHiveConnectorId,
+                          std::make_shared<HiveInsertTableHandle>(
+                              directory,
+                              std::vector<std::string>{"c0"},
+                              kNumBuckets,
+                              std::vector<std::string>{"c1"})),
+                      "rows")
+                  .project({"rows"})
+                  .planNode();
+  assertQuery(plan, "SELECT count(*) FROM tmp");
+
+  // The partitioning column is not stored in the files.
+  auto dataType = ROW({"c1", "c2"}, {BIGINT(), VARCHAR()});
+  for (auto partition = 0; partition < kNumPartitions; ++partition) {
+    std::vector<exec::Split> splits;
+    auto partitionDir = fmt::format("{}/c0={}", directory, partition);
+    for (auto& entry : fs::directory_iterator(partitionDir)) {
+      auto fileName = entry.path().filename().string();
+      auto bucket = std::stoi(fileName.substr(0, 6));
+      EXPECT_GE(bucket, 0);
+      EXPECT_LT(bucket, kNumBuckets);
+      splits.push_back(makeHiveSplit(entry.path().string()));
+    }
+    ASSERT_FALSE(splits.empty());
+    assertQuery(
+        PlanBuilder().tableScan(dataType).planNode(),
+        std::move(splits),
+        fmt::format("SELECT c1, c2 FROM tmp WHERE c0 = {}", partition));
+  }
+  fs::remove_all(directory);
+}
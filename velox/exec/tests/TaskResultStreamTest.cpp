@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/exec/TaskResultStream.h"
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+class TaskResultStreamTest : public OperatorTestBase {
+ protected:
+  std::vector<RowVectorPtr> makeVectors(int32_t numVectors) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numVectors; ++i) {
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              1'000, [i](auto row) { return i * 1'000 + row; }, nullEvery(7)),
+          makeFlatVector<StringView>(
+              1'000,
+              [](auto row) {
+                static const std::string kValue(20, 'x');
+                return StringView(kValue.data(), row % 20);
+              }),
+      }));
+    }
+    return vectors;
+  }
+};
+
+TEST_F(TaskResultStreamTest, next) {
+  auto vectors = makeVectors(10);
+  createDuckDbTable(vectors);
+  auto plan = PlanBuilder().values(vectors).filter("c0 % 3 = 0").planNode();
+  auto stream = TaskResultStream::create(plan, core::QueryCtx::create());
+
+  std::vector<RowVectorPtr> results;
+  while (auto vector = stream->next()) {
+    results.push_back(vector);
+  }
+  EXPECT_TRUE(stream->atEnd());
+  EXPECT_EQ(nullptr, stream->next());
+  assertResults(
+      results,
+      plan->outputType(),
+      "SELECT * FROM tmp WHERE c0 % 3 = 0",
+      duckDbQueryRunner_);
+}
+
+TEST_F(TaskResultStreamTest, tryNext) {
+  auto vectors = makeVectors(10);
+  createDuckDbTable(vectors);
+  auto plan = PlanBuilder().values(vectors).planNode();
+  auto stream =
+      TaskResultStream::create(plan, core::QueryCtx::create(), 1, 1);
+
+  std::vector<RowVectorPtr> results;
+  while (!stream->atEnd()) {
+    ContinueFuture future(false);
+    auto vector = stream->tryNext(&future);
+    if (vector) {
+      // The producer blocks after each batch, so that at most one batch is
+      // buffered while the consumer holds another.
+      EXPECT_LE(stream->bufferedBytes(), vector->retainedSize());
+      results.push_back(std::move(vector));
+    } else {
+      std::move(future).wait();
+    }
+  }
+  assertResults(
+      results, plan->outputType(), "SELECT * FROM tmp", duckDbQueryRunner_);
+}
+
+TEST_F(TaskResultStreamTest, zeroCopy) {
+  auto vectors = makeVectors(1);
+  auto plan = PlanBuilder().values(vectors).planNode();
+  auto stream = TaskResultStream::create(plan, core::QueryCtx::create());
+
+  // The batch produced by Values reaches the consumer as is.
+  EXPECT_EQ(vectors[0], stream->next());
+  EXPECT_EQ(nullptr, stream->next());
+}
+
+TEST_F(TaskResultStreamTest, error) {
+  auto vectors = makeVectors(3);
+  auto plan =
+      PlanBuilder().values(vectors).project({"c0 / (c0 - c0)"}).planNode();
+  auto stream = TaskResultStream::create(plan, core::QueryCtx::create());
+
+  EXPECT_THROW(
+      {
+        while (stream->next()) {
+        }
+      },
+      VeloxException);
+}
+
+TEST_F(TaskResultStreamTest, close) {
+  auto vectors = makeVectors(10);
+  auto plan = PlanBuilder().values(vectors).planNode();
+  auto stream =
+      TaskResultStream::create(plan, core::QueryCtx::create(), 1, 1);
+
+  // Closing releases the blocked producer and ends the stream.
+  ASSERT_NE(nullptr, stream->next());
+  stream->close();
+  EXPECT_TRUE(stream->atEnd());
+  EXPECT_EQ(0, stream->bufferedBytes());
+  EXPECT_EQ(nullptr, stream->next());
+}
+
+} // namespace
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec::test;
+
+static const core::SortOrder kAscNullsLast(true, false);
+static const core::SortOrder kDescNullsFirst(false, true);
+
+class TopNRowNumberTest : public OperatorTestBase {
+ protected:
+  // Returns batches with a partition key c0 with some nulls, a sorting
+  // key c1 with some nulls, a unique c2 and a string partition key c3.
+  std::vector<RowVectorPtr> makeVectors(
+      int32_t numBatches,
+      vector_size_t batchSize) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numBatches; ++i) {
+      auto offset = i * batchSize;
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int32_t>(
+              batchSize,
+              [&](auto row) { return (offset + row) % 17; },
+              [&](auto row) { return (offset + row) % 23 == 0; }),
+          makeFlatVector<int32_t>(
+              batchSize,
+              [&](auto row) { return (offset + row) % 11; },
+              [&](auto row) { return (offset + row) % 13 == 0; }),
+          makeFlatVector<int64_t>(
+              batchSize, [&](auto row) { return offset + row; }),
+          makeFlatVector<StringView>(
+              batchSize,
+              [&](auto row) {
+                return StringView(
+                    fmt::format("partition {}", (offset + row) % 5));
+              }),
+      }));
+    }
+    return vectors;
+  }
+};
+
+TEST_F(TopNRowNumberTest, basic) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  for (auto limit : {1, 3, 100}) {
+    auto plan = PlanBuilder()
+                    .values(vectors)
+                    .topNRowNumber(
+                        {0},
+                        {1, 2},
+                        {kAscNullsLast, kAscNullsLast},
+                        limit,
+                        true)
+                    .planNode();
+    assertQuery(
+        plan,
+        fmt::format(
+            "SELECT * FROM (SELECT *, row_number() OVER "
+            "(PARTITION BY c0 ORDER BY c1 NULLS LAST, c2) AS rn FROM tmp) "
+            "WHERE rn <= {}",
+            limit));
+
+    plan = PlanBuilder()
+               .values(vectors)
+               .topNRowNumber(
+                   {3, 0},
+                   {1, 2},
+                   {kDescNullsFirst, kAscNullsLast},
+                   limit,
+                   false)
+               .planNode();
+    assertQuery(
+        plan,
+        fmt::format(
+            "SELECT c0, c1, c2, c3 FROM (SELECT *, row_number() OVER "
+            "(PARTITION BY c3, c0 ORDER BY c1 DESC NULLS FIRST, c2) AS rn "
+            "FROM tmp) WHERE rn <= {}",
+            limit));
+  }
+}
+
+TEST_F(TopNRowNumberTest, singlePartition) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .topNRowNumber({}, {2}, {kDescNullsFirst}, 10, true)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, row_number() OVER (ORDER BY c2 DESC) FROM tmp "
+      "ORDER BY c2 DESC LIMIT 10");
+}
+
+TEST_F(TopNRowNumberTest, partialAndFinal) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .topNRowNumber(
+                      {0},
+                      {1, 2},
+                      {kAscNullsLast, kAscNullsLast},
+                      5,
+                      false,
+                      true)
+                  .topNRowNumber(
+                      {0}, {1, 2}, {kAscNullsLast, kAscNullsLast}, 5, true)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT * FROM (SELECT *, row_number() OVER "
+      "(PARTITION BY c0 ORDER BY c1 NULLS LAST, c2) AS rn FROM tmp) "
+      "WHERE rn <= 5");
+
+  // A partial step cannot number the rows.
+  EXPECT_THROW(
+      PlanBuilder()
+          .values(vectors)
+          .topNRowNumber({0}, {1}, {kAscNullsLast}, 5, true, true),
+      VeloxRuntimeError);
+}
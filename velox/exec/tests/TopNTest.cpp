@@ -244,6 +244,31 @@ TEST_F(TopNTest, multiBatch) {
   testSingleKey(vectors, "c2", 2'500);
 }
 
+TEST_F(TopNTest, fewTopRows) {
+  // After the first batch almost all rows come after the top row on the
+  // first key. The first key has many ties that are decided by the
+  // second key.
+  vector_size_t batchSize = 1'000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 20; ++i) {
+    auto c0 = makeFlatVector<int32_t>(
+        batchSize,
+        [&](vector_size_t row) { return (row + i) % 50; },
+        nullEvery(7));
+    auto c1 = makeFlatVector<int64_t>(
+        batchSize, [&](vector_size_t row) { return batchSize * i + row; });
+    auto c2 = makeFlatVector<StringView>(
+        batchSize,
+        [&](vector_size_t row) { return StringView(std::to_string(row)); },
+        nullEvery(13));
+    vectors.push_back(makeRowVector({c0, c1, c2}));
+  }
+  createDuckDbTable(vectors);
+
+  testTwoKeys(vectors, "c0", "c1", 10);
+  testTwoKeys(vectors, "c2", "c1", 10);
+}
+
 TEST_F(TopNTest, empty) {
   vector_size_t batchSize = 1'000;
   std::vector<RowVectorPtr> vectors;
@@ -52,3 +52,21 @@ TEST_F(UnnestTest, allEmptyOrNullArrays) {
   auto op = PlanBuilder().values({vector}).unnest({"c0"}, {"c1"}).planNode();
   assertQueryReturnsEmptyResult(op);
 }
+
+TEST_F(UnnestTest, manyOutputBatches) {
+  // 10K arrays of up to 9 elements go out in several batches that start
+  // and end at different offsets.
+  auto vector = makeRowVector({
+      makeFlatVector<int64_t>(10'000, [](auto row) { return row; }),
+      makeArrayVector<int32_t>(
+          10'000,
+          [](auto row) { return row % 9 + 1; },
+          [](auto row, auto index) { return row + index; },
+          nullEvery(11)),
+  });
+
+  createDuckDbTable({vector});
+
+  auto op = PlanBuilder().values({vector}).unnest({"c0"}, {"c1"}).planNode();
+  assertQuery(op, "SELECT c0, UNNEST(c1) FROM tmp WHERE c0 % 11 > 0");
+}
@@ -403,6 +403,47 @@ TEST_F(VectorHasherTest, integerIds) {
   EXPECT_EQ(numDistinct, VectorHasher::kRangeTooLarge);
 }
 
+TEST_F(VectorHasherTest, timestampIds) {
+  auto vector = BaseVector::create(TIMESTAMP(), 100, pool_.get());
+  auto timestamps = vector->as<FlatVector<Timestamp>>();
+  timestamps->setNull(0, true);
+  for (auto i = 1; i < 100; ++i) {
+    timestamps->set(
+        i, Timestamp(1'600'000'000 + i / 2, (i % 2) * 500'000'000));
+  }
+  auto hasher = exec::VectorHasher::create(TIMESTAMP(), 1);
+  std::vector<uint64_t> hashes(timestamps->size());
+  SelectivityVector rows(timestamps->size());
+  EXPECT_FALSE(hasher->computeValueIds(*vector, rows, &hashes));
+  uint64_t numRange;
+  uint64_t numDistinct;
+  hasher->cardinality(numRange, numDistinct);
+  EXPECT_EQ(numDistinct, 100);
+  // The range is in nanoseconds, 49 seconds plus 1 for null and 1 for the
+  // closed interval.
+  EXPECT_EQ(numRange, 49'000'000'002);
+
+  hasher->enableValueIds(1, 0);
+  EXPECT_TRUE(hasher->computeValueIds(*vector, rows, &hashes));
+  EXPECT_EQ(hashes[0], 0);
+  std::unordered_set<uint64_t> ids(hashes.begin() + 1, hashes.end());
+  EXPECT_EQ(ids.size(), 99);
+  EXPECT_EQ(ids.count(0), 0);
+
+  // The same timestamp has the same id regardless of the position.
+  timestamps->set(0, Timestamp(1'600'000'000 + 5 / 2, 500'000'000));
+  std::vector<uint64_t> newHashes(timestamps->size());
+  EXPECT_TRUE(hasher->computeValueIds(*vector, rows, &newHashes));
+  EXPECT_EQ(newHashes[0], hashes[5]);
+
+  // Timestamps past 2262 do not fit in 64 bits of nanoseconds.
+  timestamps->set(1, Timestamp(10'000'000'000, 0));
+  EXPECT_FALSE(hasher->computeValueIds(*vector, rows, &newHashes));
+  hasher->cardinality(numRange, numDistinct);
+  EXPECT_EQ(numRange, VectorHasher::kRangeTooLarge);
+  EXPECT_EQ(numDistinct, VectorHasher::kRangeTooLarge);
+}
+
 TEST_F(VectorHasherTest, boolNoNulls) {
   auto vector = BaseVector::create(BOOLEAN(), 100, pool_.get());
   auto bools = vector->as<FlatVector<bool>>();
@@ -590,3 +631,37 @@ TEST_F(VectorHasherTest, computeValueIdsStrings) {
 
   ASSERT_LE(uniqueValues.size(), multiplier);
 }
+
+TEST_F(VectorHasherTest, computeValueIdsSameDictionary) {
+  auto base = vectorMaker_->flatVector({"red", "green", "blue", "yellow"});
+  auto reversedBase =
+      vectorMaker_->flatVector({"yellow", "blue", "green", "red"});
+  vector_size_t size = 100;
+  auto dictionary = makeDictionary(size, base);
+  // Another batch over the same base with different indices.
+  auto sameBase = BaseVector::wrapInDictionary(
+      BufferPtr(nullptr),
+      makeIndices(size, [](vector_size_t row) { return 3 - row % 4; }),
+      size,
+      base);
+  // The same values in a different base.
+  auto otherBase = makeDictionary(size, reversedBase);
+
+  auto hasher = exec::VectorHasher::create(VARCHAR(), 0);
+  SelectivityVector rows(size);
+  std::vector<uint64_t> result(size);
+  ASSERT_FALSE(hasher->computeValueIds(*dictionary, rows, &result));
+  hasher->enableValueIds(1, 0);
+
+  std::unordered_map<std::string, uint64_t> ids;
+  for (const auto& vector : {dictionary, sameBase, otherBase, dictionary}) {
+    ASSERT_TRUE(hasher->computeValueIds(*vector, rows, &result));
+    auto strings = vector->as<SimpleVector<StringView>>();
+    for (auto row = 0; row < size; ++row) {
+      auto it =
+          ids.emplace(std::string(strings->valueAt(row)), result[row]).first;
+      ASSERT_EQ(it->second, result[row]) << "at " << row;
+    }
+  }
+  EXPECT_EQ(4, ids.size());
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/OperatorTestBase.h"
+#include "velox/exec/tests/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec::test;
+
+static const core::SortOrder kAscNullsLast(true, false);
+static const core::SortOrder kDescNullsFirst(false, true);
+
+class WindowTest : public OperatorTestBase {
+ protected:
+  using Frame = core::WindowNode::Frame;
+  using BoundType = core::WindowNode::BoundType;
+
+  // Returns batches with a partition key c0, a sorting key c1 with some
+  // nulls and the row number in c2. If 'sorted' is true, the rows are
+  // sorted on c0 and c1.
+  std::vector<RowVectorPtr> makeVectors(
+      int32_t numBatches,
+      vector_size_t batchSize,
+      bool sorted = false) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < numBatches; ++i) {
+      auto offset = i * batchSize;
+      if (sorted) {
+        vectors.push_back(makeRowVector({
+            makeFlatVector<int32_t>(
+                batchSize, [&](auto row) { return (offset + row) / 100; }),
+            makeFlatVector<int32_t>(
+                batchSize, [&](auto row) { return (offset + row) % 100 / 7; }),
+            makeFlatVector<int64_t>(
+                batchSize, [&](auto row) { return offset + row; }),
+        }));
+      } else {
+        vectors.push_back(makeRowVector({
+            makeFlatVector<int32_t>(
+                batchSize, [&](auto row) { return (offset + row) % 7; }),
+            makeFlatVector<int32_t>(
+                batchSize,
+                [&](auto row) { return (offset + row) % 11; },
+                [&](auto row) { return (offset + row) % 13 == 0; }),
+            makeFlatVector<int64_t>(
+                batchSize, [&](auto row) { return offset + row; }),
+        }));
+      }
+    }
+    return vectors;
+  }
+};
+
+TEST_F(WindowTest, rank) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .window(
+                      {0},
+                      {1, 2},
+                      {kAscNullsLast, kAscNullsLast},
+                      {"row_number()"})
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, row_number() OVER "
+      "(PARTITION BY c0 ORDER BY c1 NULLS LAST, c2) FROM tmp");
+
+  plan = PlanBuilder()
+             .values(vectors)
+             .window({0}, {1}, {kDescNullsFirst}, {"rank()", "dense_rank()"})
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, rank() OVER w, dense_rank() OVER w FROM tmp "
+      "WINDOW w AS (PARTITION BY c0 ORDER BY c1 DESC NULLS FIRST)");
+
+  // A single partition.
+  plan = PlanBuilder()
+             .values(vectors)
+             .window({}, {1}, {kAscNullsLast}, {"rank()"})
+             .planNode();
+  assertQuery(
+      plan, "SELECT *, rank() OVER (ORDER BY c1 NULLS LAST) FROM tmp");
+}
+
+TEST_F(WindowTest, lagLead) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .window(
+                      {0},
+                      {2},
+                      {kAscNullsLast},
+                      {"lag(c1)", "lag(c1, 2, 0)", "lead(c2, 3)"})
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, lag(c1) OVER w, lag(c1, 2, 0) OVER w, lead(c2, 3) OVER w "
+      "FROM tmp WINDOW w AS (PARTITION BY c0 ORDER BY c2)");
+}
+
+TEST_F(WindowTest, aggregate) {
+  auto vectors = makeVectors(3, 1'000);
+  createDuckDbTable(vectors);
+
+  // The default frame includes the peers of the current row.
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .window({0}, {1}, {kAscNullsLast}, {"sum(c2)", "count(c1)"})
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, sum(c2) OVER w, count(c1) OVER w FROM tmp "
+      "WINDOW w AS (PARTITION BY c0 ORDER BY c1 NULLS LAST)");
+
+  Frame whole{
+      core::WindowNode::WindowType::kRange,
+      BoundType::kUnboundedPreceding,
+      0,
+      BoundType::kUnboundedFollowing,
+      0};
+  Frame sliding{
+      core::WindowNode::WindowType::kRows,
+      BoundType::kPreceding,
+      2,
+      BoundType::kFollowing,
+      1};
+  Frame following{
+      core::WindowNode::WindowType::kRows,
+      BoundType::kCurrentRow,
+      0,
+      BoundType::kUnboundedFollowing,
+      0};
+  plan = PlanBuilder()
+             .values(vectors)
+             .window(
+                 {0},
+                 {1, 2},
+                 {kAscNullsLast, kAscNullsLast},
+                 {"max(c2)", "sum(c2)", "min(c2)"},
+                 {whole, sliding, following})
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, "
+      "max(c2) OVER (PARTITION BY c0 ORDER BY c1 NULLS LAST, c2 "
+      "RANGE BETWEEN UNBOUNDED PRECEDING AND UNBOUNDED FOLLOWING), "
+      "sum(c2) OVER (PARTITION BY c0 ORDER BY c1 NULLS LAST, c2 "
+      "ROWS BETWEEN 2 PRECEDING AND 1 FOLLOWING), "
+      "min(c2) OVER (PARTITION BY c0 ORDER BY c1 NULLS LAST, c2 "
+      "ROWS BETWEEN CURRENT ROW AND UNBOUNDED FOLLOWING) "
+      "FROM tmp");
+}
+
+TEST_F(WindowTest, sortedInput) {
+  // Partitions span batch boundaries and some batches complete no
+  // partition.
+  auto vectors = makeVectors(10, 70, true);
+  createDuckDbTable(vectors);
+
+  Frame sliding{
+      core::WindowNode::WindowType::kRows,
+      BoundType::kPreceding,
+      1,
+      BoundType::kFollowing,
+      1};
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .window(
+                      {0},
+                      {1, 2},
+                      {kAscNullsLast, kAscNullsLast},
+                      {"row_number()", "sum(c2)", "lag(c2)"},
+                      {Frame{}, sliding, Frame{}},
+                      true)
+                  .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, row_number() OVER w, "
+      "sum(c2) OVER (PARTITION BY c0 ORDER BY c1, c2 "
+      "ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING), "
+      "lag(c2) OVER w "
+      "FROM tmp WINDOW w AS (PARTITION BY c0 ORDER BY c1, c2)");
+
+  plan = PlanBuilder()
+             .values(vectors)
+             .window(
+                 {0},
+                 {1},
+                 {kAscNullsLast},
+                 {"rank()", "dense_rank()", "sum(c2)"},
+                 {},
+                 true)
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT *, rank() OVER w, dense_rank() OVER w, sum(c2) OVER w "
+      "FROM tmp WINDOW w AS (PARTITION BY c0 ORDER BY c1)");
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/WorkStealingExecutor.h"
+
+#include <folly/synchronization/Baton.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::velox::exec;
+
+TEST(WorkStealingExecutorTest, priorities) {
+  WorkStealingExecutor executor(1, "test");
+  folly::Baton<> started;
+  folly::Baton<> proceed;
+  // Keeps the only thread busy until all the work below is queued.
+  executor.add([&]() {
+    started.post();
+    proceed.wait();
+  });
+  started.wait();
+
+  std::mutex mutex;
+  std::vector<int32_t> order;
+  auto record = [&](int32_t value) {
+    return [&, value]() {
+      std::lock_guard<std::mutex> l(mutex);
+      order.push_back(value);
+    };
+  };
+  executor.addWithPriority(record(1), -1);
+  executor.addWithPriority(record(2), 0);
+  executor.addWithPriority(record(3), 1);
+  executor.addWithPriority(record(4), 0);
+  executor.addWithPriority(record(5), 1);
+  proceed.post();
+  executor.join();
+  EXPECT_EQ(order, (std::vector<int32_t>{3, 5, 2, 4, 1}));
+}
+
+TEST(WorkStealingExecutorTest, steal) {
+  constexpr int32_t kNumTasks = 1'000;
+  WorkStealingExecutor executor(4, "test");
+  std::atomic<int32_t> numDone{0};
+  // The work added by work on a thread goes to the queue of that thread
+  // and the other threads can only get it by stealing.
+  executor.add([&]() {
+    for (auto i = 0; i < kNumTasks; ++i) {
+      executor.add([&]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++numDone;
+      });
+    }
+  });
+  executor.join();
+  EXPECT_EQ(numDone, kNumTasks);
+  EXPECT_GT(executor.numSteals(), 0);
+}
+
+TEST(WorkStealingExecutorTest, exception) {
+  WorkStealingExecutor executor(2, "test");
+  std::atomic<int32_t> numDone{0};
+  for (auto i = 0; i < 10; ++i) {
+    executor.add([&, i]() {
+      if (i % 2 == 0) {
+        throw std::runtime_error("Expected");
+      }
+      ++numDone;
+    });
+  }
+  executor.join();
+  EXPECT_EQ(numDone, 5);
+}
@@ -486,8 +486,7 @@ class CompiledExpressionTransformVisitor {
             "isDefaultNullStrict",
             isDefaultNullStrict(filter.id()) ? "true" : "false"));
 
-    auto compiledObject = codeManager_.compiler().compileString({}, fileString);
-    auto dynamicObject = codeManager_.compiler().link({}, {compiledObject});
+    auto dynamicObject = codeManager_.compiler().compileAndLink({}, fileString);
 
     // Extract the row input expression from the current filter
     const auto inputType = filter.sources()[0]->outputType();
@@ -583,8 +582,7 @@ class CompiledExpressionTransformVisitor {
         fmt::arg(
             "isDefaultNullStrict", isDefaultNullStrict ? "true" : "false"));
 
-    auto compiledObject = codeManager_.compiler().compileString({}, fileString);
-    auto dynamicObject = codeManager_.compiler().link({}, {compiledObject});
+    auto dynamicObject = codeManager_.compiler().compileAndLink({}, fileString);
     std::vector<std::shared_ptr<const ITypedExpr>> newProjections;
 
     // Extract the row input expression from the current projection
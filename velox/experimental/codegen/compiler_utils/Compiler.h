@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <folly/hash/Hash.h>
 #include "glog/logging.h"
 #include "velox/common/base/Exceptions.h"
 #include "velox/experimental/codegen/compiler_utils/CompilerOptions.h"
@@ -189,6 +190,40 @@ class Compiler {
     return dynamicLibPath;
   }
 
+  /// Compiles and links a given c++ string into a dynamic library. If
+  /// compilerOptions().cacheDirectory is set, the library is kept there
+  /// under a name derived from the source and the command lines, and later
+  /// calls with the same input, in this or another process, load it
+  /// instead of recompiling.
+  /// \param additionalLibraries
+  /// \param cppContent  c++ file content
+  /// \return path to the dynamic library
+  std::filesystem::path compileAndLink(
+      const std::vector<LibraryDescriptor>& additionalLibraries,
+      const std::string& cppContent) {
+    if (!compilerOptions_.cacheDirectory.has_value()) {
+      return link(
+          additionalLibraries,
+          {compileString(additionalLibraries, cppContent)});
+    }
+    const auto& cacheDirectory = compilerOptions_.cacheDirectory.value();
+    auto libraryPath = cacheDirectory /
+        fmt::format("codegen_{:016x}.so",
+                    libraryHash(additionalLibraries, cppContent));
+    if (std::filesystem::exists(libraryPath)) {
+      DefaultScopedTimer timer("CacheHit", eventSequence_);
+      return libraryPath;
+    }
+    std::filesystem::create_directories(cacheDirectory);
+    auto objectPath = compileString(additionalLibraries, cppContent);
+    // Links next to the final path and renames, so that concurrent
+    // compilations of the same code never load a partially written file.
+    auto tempPath = pathGenerator_.tempPath(cacheDirectory, "dyn", ".so");
+    link(additionalLibraries, {objectPath}, tempPath);
+    std::filesystem::rename(tempPath, libraryPath);
+    return libraryPath;
+  }
+
   /// Construct a command object which execution would compile the give files.
   /// \param additionalLibraries
   /// \param cppFile
@@ -267,6 +302,17 @@ class Compiler {
   }
 
  private:
+  // Returns a hash of everything that determines the library built from
+  // 'cppContent'. Uses a hash that is stable across processes.
+  uint64_t libraryHash(
+      const std::vector<LibraryDescriptor>& additionalLibraries,
+      const std::string& cppContent) {
+    auto key = cppContent;
+    key += compileCommand(additionalLibraries, "", "").toString(" ");
+    key += linkCommand(additionalLibraries, {}, "").toString(" ");
+    return folly::hash::fnv64(key);
+  }
+
   void includePathArgs(
       const LibraryDescriptor& library,
       std::vector<std::string>& args) {
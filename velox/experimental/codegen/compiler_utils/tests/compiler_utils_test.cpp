@@ -197,6 +197,8 @@ TEST_F(CompilerOptionsProtoTest, formatLoadJson) {
       testCompilerOptions_.formatterPath, newCompilerOptions.formatterPath);
   ASSERT_EQ(
       testCompilerOptions_.tempDirectory, newCompilerOptions.tempDirectory);
+  ASSERT_EQ(
+      testCompilerOptions_.cacheDirectory, newCompilerOptions.cacheDirectory);
 }
 
 TEST(Compiler, ExternalLibraries) {
@@ -290,4 +292,44 @@ TEST(Compiler, CompileAndLink) {
   ASSERT_EQ(dlerror(), nullptr);
   ASSERT_EQ(f(), 24);
 };
+
+TEST(Compiler, CompileAndLinkCached) {
+  auto sourceCode = R"a(
+  extern "C" {
+  int f() {
+    return 24;
+  };
+  }
+  )a";
+  auto cacheDirectory = boost::filesystem::unique_path(
+                            fmt::format(
+                                "{}/%%%%-%%%%",
+                                boost::filesystem::temp_directory_path()
+                                    .string()))
+                            .string();
+  auto options = testCompilerOptions().withCacheDirectory(cacheDirectory);
+  DefaultScopedTimer::EventSequence eventSequence;
+  Compiler compiler(options, eventSequence);
+
+  auto sharedObject = compiler.compileAndLink({}, sourceCode);
+  ASSERT_EQ(sharedObject.parent_path(), cacheDirectory);
+  ASSERT_GT(std::filesystem::file_size(sharedObject), 0);
+  auto writeTime = std::filesystem::last_write_time(sharedObject);
+
+  // A second compiler finds the library of the first.
+  Compiler otherCompiler(options, eventSequence);
+  ASSERT_EQ(otherCompiler.compileAndLink({}, sourceCode), sharedObject);
+  ASSERT_EQ(std::filesystem::last_write_time(sharedObject), writeTime);
+
+  // Different code gets a different library.
+  ASSERT_NE(
+      compiler.compileAndLink({}, std::string(sourceCode) + "\n"),
+      sharedObject);
+
+  auto libraryPtr =
+      native_loader::NativeLibraryLoader::loadLibraryInternal(sharedObject);
+  auto f = (int (*)())dlsym(libraryPtr, "f");
+  ASSERT_EQ(f(), 24);
+  std::filesystem::remove_all(cacheDirectory);
+}
 } // namespace facebook::velox::codegen::compiler_utils::test
@@ -15,10 +15,13 @@
  */
 
 #include "velox/expression/CastExpr.h"
+#include <cmath>
 #include <stdexcept>
 #include "velox/core/CoreTypeSystem.h"
 #include "velox/expression/VectorUdfTypeSystem.h"
-#include "velox/external/date/tz.h"
+#include "velox/type/DecimalType.h"
+#include "velox/type/DecimalUtil.h"
+#include "velox/type/tz/TimeZoneOffsets.h"
 #include "velox/vector/FunctionVector.h"
 
 namespace facebook::velox::exec {
@@ -58,6 +61,60 @@ void applyCastKernel(
   }
 }
 
+/// Casts a string to a number or timestamp without exceptions. Covers the
+/// common well formed values. Returns false if the row must go through
+/// applyCastKernel, which accepts the rest or produces the error.
+template <typename To, typename From>
+bool applyFastCastKernel(
+    vector_size_t row,
+    const DecodedVector& input,
+    FlatVector<To>* resultFlatVector) {
+  constexpr auto kind = CppToType<To>::typeKind;
+  auto value = input.valueAt<StringView>(row);
+  To result;
+  bool ok;
+  if constexpr (kind == TypeKind::DOUBLE) {
+    ok = util::tryParseDouble(value.data(), value.size(), result);
+  } else if constexpr (kind == TypeKind::TIMESTAMP) {
+    ok = util::tryFromTimestampString(value.data(), value.size(), result);
+  } else {
+    ok = util::tryParseInteger(value.data(), value.size(), result);
+  }
+  if (ok) {
+    resultFlatVector->set(row, result);
+  }
+  return ok;
+}
+
+/// Casts a string that applyFastCastKernel rejected with the general
+/// parser but without throwing. Returns false if the string is not valid.
+template <typename To, typename From>
+bool applyNoThrowCastKernel(
+    vector_size_t row,
+    const DecodedVector& input,
+    FlatVector<To>* resultFlatVector) {
+  if constexpr (CppToType<To>::typeKind == TypeKind::TIMESTAMP) {
+    // tryFromTimestampString() has already accepted all valid strings.
+    return false;
+  } else {
+    auto result =
+        folly::tryTo<To>(folly::StringPiece(input.valueAt<StringView>(row)));
+    if (result.hasValue()) {
+      resultFlatVector->set(row, result.value());
+    }
+    return result.hasValue();
+  }
+}
+
+template <typename To, typename From>
+constexpr bool hasFastCast() {
+  constexpr auto kind = CppToType<To>::typeKind;
+  return std::is_same_v<From, StringView> &&
+      (kind == TypeKind::TINYINT || kind == TypeKind::SMALLINT ||
+       kind == TypeKind::INTEGER || kind == TypeKind::BIGINT ||
+       kind == TypeKind::DOUBLE || kind == TypeKind::TIMESTAMP);
+}
+
 void populateNestedRows(
     const SelectivityVector& rows,
     const vector_size_t* rawSizes,
@@ -82,9 +139,47 @@ void CastExpr::applyCastWithTry(
   const auto& queryCtx = context->execCtx()->queryCtx();
   auto isCastIntByTruncate = queryCtx->isCastIntByTruncate();
 
+  // Parses the whole batch with the exception free parsers first. Only the
+  // rows these reject take the per row path below.
+  const SelectivityVector* slowRows = &rows;
+  LocalSelectivityVector remainingRows(context);
+  if constexpr (hasFastCast<To, From>()) {
+    *remainingRows.get(rows.size()) = rows;
+    rows.applyToSelected([&](auto row) {
+      if (applyFastCastKernel<To, From>(row, input, resultFlatVector)) {
+        remainingRows->setValid(row, false);
+      }
+    });
+    remainingRows->updateBounds();
+    slowRows = remainingRows.get();
+    if (remainingRows->hasSelections() &&
+        (nullOnFailure_ || !context->captureErrorDetails())) {
+      // The failures only become nulls, so these are found and reported in
+      // bulk without throwing.
+      LocalSelectivityVector failedRows(context, *remainingRows);
+      remainingRows->applyToSelected([&](auto row) {
+        if (applyNoThrowCastKernel<To, From>(row, input, resultFlatVector)) {
+          failedRows->setValid(row, false);
+        }
+      });
+      failedRows->updateBounds();
+      if (failedRows->hasSelections() && nullOnFailure_) {
+        resultFlatVector->addNulls(nullptr, *failedRows);
+      } else if (failedRows->hasSelections()) {
+        context->setErrors(
+            *failedRows,
+            std::make_exception_ptr(std::invalid_argument(fmt::format(
+                "Failed to cast from {} to {}",
+                CppToType<From>::name,
+                CppToType<To>::name))));
+      }
+      remainingRows->clearAll();
+    }
+  }
+
   if (!nullOnFailure_) {
     if (!isCastIntByTruncate) {
-      rows.applyToSelected([&](int row) {
+      slowRows->applyToSelected([&](int row) {
         // Passing a false truncate flag
         try {
           applyCastKernel<To, From, false>(row, input, resultFlatVector);
@@ -93,7 +188,7 @@ void CastExpr::applyCastWithTry(
         }
       });
     } else {
-      rows.applyToSelected([&](int row) {
+      slowRows->applyToSelected([&](int row) {
         // Passing a true truncate flag
         try {
           applyCastKernel<To, From, true>(row, input, resultFlatVector);
@@ -104,7 +199,7 @@ void CastExpr::applyCastWithTry(
     }
   } else {
     if (!isCastIntByTruncate) {
-      rows.applyToSelected([&](int row) {
+      slowRows->applyToSelected([&](int row) {
         // TRY_CAST implementation
         try {
           applyCastKernel<To, From, false>(row, input, resultFlatVector);
@@ -113,7 +208,7 @@ void CastExpr::applyCastWithTry(
         }
       });
     } else {
-      rows.applyToSelected([&](int row) {
+      slowRows->applyToSelected([&](int row) {
         // TRY_CAST implementation
         try {
           applyCastKernel<To, From, true>(row, input, resultFlatVector);
@@ -131,13 +226,30 @@ void CastExpr::applyCastWithTry(
     if (queryCtx->adjustTimestampToTimezone()) {
       auto sessionTzName = queryCtx->sessionTimezone();
       if (!sessionTzName.empty()) {
-        // locate_zone throws runtime_error if the timezone couldn't be found
-        // (so we're safe to dereference the pointer).
-        auto* timeZone = date::locate_zone(sessionTzName);
+        // Throws runtime_error if the timezone couldn't be found.
+        const auto& offsets = util::TimeZoneOffsets::get(sessionTzName);
         auto rawTimestamps = resultFlatVector->mutableRawValues();
-
-        rows.applyToSelected(
-            [&](int row) { rawTimestamps[row].toTimezone(*timeZone); });
+        auto adjust = [&](int row, int32_t offset) {
+          rawTimestamps[row] = Timestamp(
+              rawTimestamps[row].getSeconds() - offset,
+              rawTimestamps[row].getNanos());
+        };
+
+        // All the rows usually have the same offset.
+        int64_t minSeconds = std::numeric_limits<int64_t>::max();
+        int64_t maxSeconds = std::numeric_limits<int64_t>::min();
+        rows.applyToSelected([&](int row) {
+          minSeconds = std::min(minSeconds, rawTimestamps[row].getSeconds());
+          maxSeconds = std::max(maxSeconds, rawTimestamps[row].getSeconds());
+        });
+        int32_t offset;
+        if (offsets.commonOffset(minSeconds, maxSeconds, offset)) {
+          rows.applyToSelected([&](int row) { adjust(row, offset); });
+        } else {
+          rows.applyToSelected([&](int row) {
+            adjust(row, offsets.offsetAt(rawTimestamps[row].getSeconds()));
+          });
+        }
       }
     }
   }
@@ -196,6 +308,154 @@ void CastExpr::applyCast(
   }
 }
 
+void CastExpr::applyDecimalCast(
+    const SelectivityVector& rows,
+    exec::EvalCtx* context,
+    const DecodedVector& input,
+    const TypePtr& fromType,
+    const TypePtr& toType,
+    VectorPtr* result) {
+  auto fromDecimal = asShortDecimal(fromType);
+  auto toDecimal = asShortDecimal(toType);
+  auto setFailed = [&](vector_size_t row) {
+    if (nullOnFailure_) {
+      (*result)->setNull(row, true);
+    } else {
+      context->setError(
+          row,
+          std::make_exception_ptr(std::invalid_argument(fmt::format(
+              "Failed to cast from {} to {}",
+              fromType->toString(),
+              toType->toString()))));
+    }
+  };
+
+  if (toDecimal) {
+    auto rawResults = (*result)->asFlatVector<int64_t>()->mutableRawValues();
+    const auto precision = toDecimal->precision();
+    const auto scale = toDecimal->scale();
+    auto castInteger = [&](auto valueAt, int fromScale) {
+      rows.applyToSelected([&](vector_size_t row) {
+        if (!util::tryRescaleDecimal(
+                valueAt(row), fromScale, scale, precision, rawResults[row])) {
+          setFailed(row);
+        }
+      });
+    };
+    auto castFloat = [&](auto valueAt) {
+      const double max = util::maxUnscaledDecimal(precision);
+      rows.applyToSelected([&](vector_size_t row) {
+        double value = std::round(valueAt(row) * util::kPowersOfTen[scale]);
+        if (value >= -max && value <= max) {
+          rawResults[row] = value;
+        } else {
+          setFailed(row);
+        }
+      });
+    };
+    switch (fromType->kind()) {
+      case TypeKind::TINYINT:
+        return castInteger(
+            [&](auto row) { return input.valueAt<int8_t>(row); }, 0);
+      case TypeKind::SMALLINT:
+        return castInteger(
+            [&](auto row) { return input.valueAt<int16_t>(row); }, 0);
+      case TypeKind::INTEGER:
+        return castInteger(
+            [&](auto row) { return input.valueAt<int32_t>(row); }, 0);
+      case TypeKind::BIGINT:
+        return castInteger(
+            [&](auto row) { return input.valueAt<int64_t>(row); },
+            fromDecimal ? fromDecimal->scale() : 0);
+      case TypeKind::REAL:
+        return castFloat([&](auto row) { return input.valueAt<float>(row); });
+      case TypeKind::DOUBLE:
+        return castFloat([&](auto row) { return input.valueAt<double>(row); });
+      case TypeKind::VARCHAR:
+        rows.applyToSelected([&](vector_size_t row) {
+          auto value = input.valueAt<StringView>(row);
+          if (!util::tryParseDecimal(
+                  value.data(),
+                  value.size(),
+                  precision,
+                  scale,
+                  rawResults[row])) {
+            setFailed(row);
+          }
+        });
+        return;
+      default:
+        VELOX_UNSUPPORTED(
+            "Cannot cast {} to {}", fromType->toString(), toType->toString());
+    }
+  }
+
+  const auto scale = fromDecimal->scale();
+  auto castInteger = [&](auto* flatResult) {
+    auto rawResults = flatResult->mutableRawValues();
+    using T = std::remove_reference_t<decltype(*rawResults)>;
+    rows.applyToSelected([&](vector_size_t row) {
+      int64_t value;
+      if (util::tryRescaleDecimal(
+              input.valueAt<int64_t>(row),
+              scale,
+              0,
+              ShortDecimalType::kMaxPrecision,
+              value) &&
+          value >= std::numeric_limits<T>::min() &&
+          value <= std::numeric_limits<T>::max()) {
+        rawResults[row] = value;
+      } else {
+        setFailed(row);
+      }
+    });
+  };
+  auto castFloat = [&](auto* flatResult) {
+    rows.applyToSelected([&](vector_size_t row) {
+      flatResult->set(
+          row,
+          static_cast<double>(input.valueAt<int64_t>(row)) /
+              util::kPowersOfTen[scale]);
+    });
+  };
+  switch (toType->kind()) {
+    case TypeKind::BOOLEAN: {
+      auto flatResult = (*result)->asFlatVector<bool>();
+      rows.applyToSelected([&](vector_size_t row) {
+        flatResult->set(row, input.valueAt<int64_t>(row) != 0);
+      });
+      return;
+    }
+    case TypeKind::TINYINT:
+      return castInteger((*result)->asFlatVector<int8_t>());
+    case TypeKind::SMALLINT:
+      return castInteger((*result)->asFlatVector<int16_t>());
+    case TypeKind::INTEGER:
+      return castInteger((*result)->asFlatVector<int32_t>());
+    case TypeKind::BIGINT:
+      return castInteger((*result)->asFlatVector<int64_t>());
+    case TypeKind::REAL:
+      return castFloat((*result)->asFlatVector<float>());
+    case TypeKind::DOUBLE:
+      return castFloat((*result)->asFlatVector<double>());
+    case TypeKind::VARCHAR: {
+      auto flatResult = (*result)->asFlatVector<StringView>();
+      rows.applyToSelected([&](vector_size_t row) {
+        auto output = util::formatDecimal(input.valueAt<int64_t>(row), scale);
+        auto proxy =
+            exec::StringProxy<FlatVector<StringView>>(flatResult, row);
+        proxy.resize(output.size());
+        std::memcpy(proxy.data(), output.data(), output.size());
+        proxy.finalize();
+      });
+      return;
+    }
+    default:
+      VELOX_UNSUPPORTED(
+          "Cannot cast {} to {}", fromType->toString(), toType->toString());
+  }
+}
+
 void CastExpr::applyMap(
     const SelectivityVector& rows,
     VectorPtr& input,
@@ -447,6 +707,14 @@ void CastExpr::apply(
       DecodedVector decoded(*input.get(), rows);
       BaseVector::ensureWritable(rows, toType, context->pool(), result);
 
+      // Decimals have the kind of their physical type and need their own
+      // conversions.
+      if (isShortDecimalType(fromType) || isShortDecimalType(toType)) {
+        applyDecimalCast(
+            *nonNullRows.get(), context, decoded, fromType, toType, result);
+        break;
+      }
+
       // Unwrapping toType pointer. VERY IMPORTANT: dynamic type pointer and
       // static type templates in each cast must match exactly
       VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
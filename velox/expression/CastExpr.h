@@ -68,6 +68,22 @@ class CastExpr : public SpecialForm {
       const DecodedVector& input,
       VectorPtr* result);
 
+  /// Casts to or from a DECIMAL. Values that do not fit the target type
+  /// become errors or nulls depending on nullOnFailure_.
+  /// @param rows The list of rows
+  /// @param context The context
+  /// @param input The input vector (of type fromType)
+  /// @param fromType the input type
+  /// @param toType the target type
+  /// @param result The output vector (of type toType)
+  void applyDecimalCast(
+      const SelectivityVector& rows,
+      exec::EvalCtx* context,
+      const DecodedVector& input,
+      const TypePtr& fromType,
+      const TypePtr& toType,
+      VectorPtr* result);
+
   /// Apply the cast after generating the input vectors
   /// @param rows The list of rows being processed
   /// @param input The input vector to be casted
@@ -179,7 +179,7 @@ void SwitchExpr::evalSpecialForm(
                 *thenRows.get(), (*result)->type(), context->pool(), result);
           }
 
-          inputs_[2 * i + 1]->eval(*thenRows.get(), context, result);
+          evalBranch(*inputs_[2 * i + 1], *thenRows.get(), context, result);
           remainingRows.get()->deselect(*thenRows.get());
         }
       }
@@ -194,7 +194,7 @@ void SwitchExpr::evalSpecialForm(
     }
 
     if (hasElseClause_) {
-      inputs_.back()->eval(*remainingRows.get(), context, result);
+      evalBranch(*inputs_.back(), *remainingRows.get(), context, result);
 
     } else {
       // fill in nulls for remainingRows
@@ -204,6 +204,99 @@ void SwitchExpr::evalSpecialForm(
   }
 }
 
+namespace {
+// Adds the top level fields referenced by 'expr' to 'fields'. The
+// 'distinctFields_' of an Expr are empty when they are the same as the
+// parent's, so these are collected from the inputs. Returns false if the
+// fields cannot be determined.
+bool collectFields(const Expr& expr, std::vector<FieldReference*>& fields) {
+  if (!expr.distinctFields().empty()) {
+    for (auto* field : expr.distinctFields()) {
+      if (std::find(fields.begin(), fields.end(), field) == fields.end()) {
+        fields.push_back(field);
+      }
+    }
+    return true;
+  }
+  if (dynamic_cast<const LambdaExpr*>(&expr)) {
+    return false;
+  }
+  if (expr.inputs().empty()) {
+    if (auto* field = dynamic_cast<const FieldReference*>(&expr)) {
+      auto* mutableField = const_cast<FieldReference*>(field);
+      if (std::find(fields.begin(), fields.end(), mutableField) ==
+          fields.end()) {
+        fields.push_back(mutableField);
+      }
+    }
+    return true;
+  }
+  for (auto& input : expr.inputs()) {
+    if (!collectFields(*input, fields)) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+void SwitchExpr::evalBranch(
+    Expr& branch,
+    const SelectivityVector& rows,
+    EvalCtx* context,
+    VectorPtr* result) {
+  // A constant or a field is copied as fast as it is evaluated densely.
+  std::vector<FieldReference*> branchFields;
+  if (rows.end() < kMinRowsForDenseBranch ||
+      dynamic_cast<FieldReference*>(&branch) ||
+      rows.countSelected() > rows.end() / kDenseBranchRatio ||
+      !collectFields(branch, branchFields) || branchFields.empty()) {
+    branch.eval(rows, context, result);
+    return;
+  }
+  auto numRows = rows.countSelected();
+  auto pool = context->pool();
+  auto denseToRow = AlignedBuffer::allocate<vector_size_t>(numRows, pool);
+  // Rows outside of 'rows' must still point to a valid dense row if the
+  // result is returned as a dictionary.
+  auto rowToDense =
+      AlignedBuffer::allocate<vector_size_t>(rows.end(), pool, 0);
+  auto rawDenseToRow = denseToRow->asMutable<vector_size_t>();
+  auto rawRowToDense = rowToDense->asMutable<vector_size_t>();
+  vector_size_t numDense = 0;
+  rows.applyToSelected([&](auto row) {
+    rawRowToDense[row] = numDense;
+    rawDenseToRow[numDense++] = row;
+  });
+
+  // The fields are read before saving the context, which moves away the
+  // fields of an enclosing peeling.
+  std::vector<std::pair<int32_t, VectorPtr>> fields;
+  for (auto* field : branchFields) {
+    auto index = field->index(context);
+    context->ensureFieldLoaded(index, rows);
+    fields.emplace_back(
+        index,
+        BaseVector::wrapInDictionary(
+            nullptr, denseToRow, numRows, context->getField(index)));
+  }
+
+  LocalSelectivityVector denseRowsHolder(context, numRows);
+  auto denseRows = denseRowsHolder.get();
+  denseRows->setAll();
+  ContextSaver saver;
+  context->saveAndReset(&saver, rows);
+  for (auto& [index, field] : fields) {
+    context->setPeeled(index, field);
+  }
+  *context->mutableFinalSelection() = denseRows;
+  context->setDictionaryWrap(rowToDense, nullptr);
+
+  VectorPtr denseResult;
+  branch.eval(*denseRows, context, &denseResult);
+  context->setWrapped(this, denseResult, rows, result);
+}
+
 bool SwitchExpr::propagatesNulls() const {
   // The "switch" expression propagates nulls when all of the following
   // conditions are met:
@@ -398,28 +491,27 @@ void ConjunctExpr::evalSpecialForm(
         context->execCtx()->queryCtx()->adaptiveFilterReorderingEnabled();
     reorderEnabledChecked_ = true;
   }
-  if (reorderEnabled_) {
+  // The order is checked after the first evaluation and then every
+  // kReorderInterval evaluations.
+  if (reorderEnabled_ && numEvals_++ % kReorderInterval == 0) {
     maybeReorderInputs();
   }
 }
 
 void ConjunctExpr::maybeReorderInputs() {
-  bool reorder = false;
-  for (auto i = 1; i < inputs_.size(); ++i) {
-    if (selectivity_[inputOrder_[i - 1]].timeToDropValue() >
-        selectivity_[inputOrder_[i]].timeToDropValue()) {
-      reorder = true;
-      break;
+  auto less = [this](int32_t left, int32_t right) {
+    return selectivity_[left].timeToDropValue() <
+        selectivity_[right].timeToDropValue();
+  };
+  auto begin = inputOrder_.begin();
+  while (begin != inputOrder_.end()) {
+    auto end = std::find_if(begin, inputOrder_.end(), [this](int32_t input) {
+      return !inputs_[input]->isDeterministic();
+    });
+    if (!std::is_sorted(begin, end, less)) {
+      std::stable_sort(begin, end, less);
     }
-  }
-  if (reorder) {
-    std::sort(
-        inputOrder_.begin(),
-        inputOrder_.end(),
-        [this](size_t left, size_t right) {
-          return selectivity_[left].timeToDropValue() <
-              selectivity_[right].timeToDropValue();
-        });
+    begin = end == inputOrder_.end() ? end : end + 1;
   }
 }
 
@@ -621,10 +713,12 @@ class ExprCallable : public Callable {
   ExprCallable(
       std::shared_ptr<const RowType> signature,
       std::shared_ptr<RowVector> capture,
-      std::shared_ptr<Expr> body)
+      std::shared_ptr<Expr> body,
+      const std::vector<ExprPtr>& sharedSubexprs)
       : signature_(std::move(signature)),
         capture_(std::move(capture)),
-        body_(std::move(body)) {}
+        body_(std::move(body)),
+        sharedSubexprs_(sharedSubexprs) {}
 
   bool hasCapture() const override {
     return capture_->childrenSize() > signature_->size();
@@ -652,6 +746,11 @@ class ExprCallable : public Callable {
         rows.end(),
         std::move(allVectors));
     EvalCtx lambdaCtx(context->execCtx(), context->exprSet(), row.get());
+    // Values computed for the arguments of a previous call do not
+    // apply to 'args'.
+    for (auto& expr : sharedSubexprs_) {
+      expr->reset();
+    }
     body_->eval(rows, &lambdaCtx, result);
   }
 
@@ -659,6 +758,7 @@ class ExprCallable : public Callable {
   std::shared_ptr<const RowType> signature_;
   RowVectorPtr capture_;
   std::shared_ptr<Expr> body_;
+  std::vector<ExprPtr> sharedSubexprs_;
 };
 
 } // namespace
@@ -682,7 +782,8 @@ void LambdaExpr::evalSpecialForm(
       rows.end(),
       values,
       0);
-  auto callable = std::make_shared<ExprCallable>(signature_, capture, body_);
+  auto callable = std::make_shared<ExprCallable>(
+      signature_, capture, body_, sharedSubexprs_);
   std::shared_ptr<FunctionVector> functions;
   if (!*result) {
     functions = std::make_shared<FunctionVector>(context->pool(), type_);
@@ -720,15 +821,23 @@ void TryExpr::evalSpecialForm(
     EvalCtx* context,
     VectorPtr* result) {
   VarSetter throwOnError(context->mutableThrowOnError(), false);
+  VarSetter captureErrorDetails(context->mutableCaptureErrorDetails(), false);
   inputs_[0]->eval(rows, context, result);
 
   auto errors = context->errors();
   if (errors) {
-    rows.applyToSelected([&](auto row) {
-      if (row < errors->size() && !errors->isNullAt(row)) {
-        (*result)->setNull(row, true);
-      }
-    });
+    // The rows with an error are the non-null positions of 'errors'. Sets
+    // these to null in bulk.
+    LocalSelectivityVector errorRows(context, rows);
+    auto numErrors = std::min(errors->size(), rows.end());
+    if (errors->rawNulls()) {
+      errorRows->deselectNulls(errors->rawNulls(), rows.begin(), numErrors);
+    }
+    errorRows->setValidRange(numErrors, rows.end(), false);
+    errorRows->updateBounds();
+    if (errorRows->hasSelections()) {
+      (*result)->addNulls(nullptr, *errorRows);
+    }
   }
 }
 
@@ -179,6 +179,22 @@ class SwitchExpr : public SpecialForm {
   }
 
  private:
+  // A THEN or ELSE branch that selects at most 1 / kDenseBranchRatio of
+  // the rows of the batch is evaluated on a dense batch of its rows.
+  static constexpr vector_size_t kDenseBranchRatio = 8;
+  // Batches with fewer rows are not worth the gather and scatter.
+  static constexpr vector_size_t kMinRowsForDenseBranch = 256;
+
+  // Evaluates 'branch' for 'rows' into 'result'. If 'rows' are sparse,
+  // evaluates 'branch' on a dense batch made by wrapping the fields of
+  // 'branch' in a dictionary of 'rows' and scatters the results back to
+  // 'rows' of 'result'.
+  void evalBranch(
+      Expr& branch,
+      const SelectivityVector& rows,
+      EvalCtx* context,
+      VectorPtr* result);
+
   const size_t numCases_;
   const bool hasElseClause_;
   BufferPtr tempValues_;
@@ -197,6 +213,9 @@ class ConjunctExpr : public SpecialForm {
     std::iota(inputOrder_.begin(), inputOrder_.end(), 0);
   }
 
+  // Number of evaluations between checks of the order of the inputs.
+  static constexpr int32_t kReorderInterval = 8;
+
   void evalSpecialForm(
       const SelectivityVector& rows,
       EvalCtx* context,
@@ -214,7 +233,17 @@ class ConjunctExpr : public SpecialForm {
     return selectivity_[inputOrder_[index]];
   }
 
+  // Returns the index in 'inputs_' of the input evaluated at position
+  // 'index'.
+  int32_t inputOrderAt(int32_t index) const {
+    return inputOrder_[index];
+  }
+
  private:
+  // Sorts the inputs by time per dropped row. A non-deterministic
+  // input keeps its position and the inputs move only within the runs
+  // between non-deterministic inputs, so that each non-deterministic
+  // input sees the same rows as in the original order.
   void maybeReorderInputs();
   void updateResult(
       BaseVector* inputResult,
@@ -234,6 +263,8 @@ class ConjunctExpr : public SpecialForm {
   bool reorderEnabled_;
   std::vector<SelectivityInfo> selectivity_;
   std::vector<int32_t> inputOrder_;
+  // Number of calls to evalSpecialForm.
+  int64_t numEvals_{0};
 };
 
 class LambdaExpr : public SpecialForm {
@@ -242,14 +273,16 @@ class LambdaExpr : public SpecialForm {
       std::shared_ptr<const Type> type,
       std::shared_ptr<const RowType>&& signature,
       std::vector<std::shared_ptr<FieldReference>>&& capture,
-      std::shared_ptr<Expr>&& body)
+      std::shared_ptr<Expr>&& body,
+      std::vector<std::shared_ptr<Expr>>&& sharedSubexprs = {})
       : SpecialForm(
             std::move(type),
             std::vector<std::shared_ptr<Expr>>(),
             "lambda"),
         signature_(std::move(signature)),
         capture_(std::move(capture)),
-        body_(std::move(body)) {
+        body_(std::move(body)),
+        sharedSubexprs_(std::move(sharedSubexprs)) {
     for (auto& field : capture_) {
       distinctFields_.push_back(field.get());
     }
@@ -271,6 +304,9 @@ class LambdaExpr : public SpecialForm {
   std::shared_ptr<const RowType> signature_;
   std::vector<std::shared_ptr<FieldReference>> capture_;
   ExprPtr body_;
+  // Multiply referenced subexpressions of 'body_'. Reset before each
+  // evaluation of 'body_'.
+  std::vector<ExprPtr> sharedSubexprs_;
   // Filled on first use.
   std::shared_ptr<const RowType> typeWithCapture_;
   std::vector<ChannelIndex> captureChannels_;
@@ -131,6 +131,19 @@ void EvalCtx::addError(
     const std::exception_ptr& exceptionPtr,
     ErrorVectorPtr* errorsPtr) const {
   auto errors = errorsPtr->get();
+  if (errors && index < errors->size() && !errors->isNullAt(index)) {
+    // The first error of a row is kept.
+    return;
+  }
+  addError(
+      index, std::make_shared<std::exception_ptr>(exceptionPtr), errorsPtr);
+}
+
+void EvalCtx::addError(
+    vector_size_t index,
+    const std::shared_ptr<void>& error,
+    ErrorVectorPtr* errorsPtr) const {
+  auto errors = errorsPtr->get();
   auto oldSize = errors ? errors->size() : 0;
   if (!errors) {
     auto size = index + 1;
@@ -156,7 +169,7 @@ void EvalCtx::addError(
   }
   if (errors->isNullAt(index)) {
     errors->setNull(index, false);
-    errors->set(index, std::make_shared<std::exception_ptr>(exceptionPtr));
+    errors->set(index, error);
   }
 }
 
@@ -201,6 +214,26 @@ void EvalCtx::setError(
   addError(index, exceptionPtr, &errors_);
 }
 
+void EvalCtx::setErrors(
+    const SelectivityVector& rows,
+    const std::exception_ptr& exceptionPtr) {
+  if (throwOnError_) {
+    std::rethrow_exception(exceptionPtr);
+  }
+  if (!rows.hasSelections()) {
+    return;
+  }
+  auto error = std::make_shared<std::exception_ptr>(exceptionPtr);
+  // Sizes the vector once for the last row.
+  addError(rows.end() - 1, error, &errors_);
+  rows.applyToSelected([&](auto row) {
+    if (errors_->isNullAt(row)) {
+      errors_->setNull(row, false);
+      errors_->set(row, error);
+    }
+  });
+}
+
 VectorPtr EvalCtx::getField(int32_t index) const {
   VectorPtr field;
   if (!peeledFields_.empty()) {
@@ -74,6 +74,14 @@ class EvalCtx {
 
   void setError(vector_size_t index, const std::exception_ptr& exceptionPtr);
 
+  /// Records 'exceptionPtr' as the error of all 'rows' without throwing. The
+  /// rows share one error, so a function can report a batch of failures
+  /// without an exception per row. Throws 'exceptionPtr' if errors are not
+  /// captured, i.e. not under TRY or a conjunct.
+  void setErrors(
+      const SelectivityVector& rows,
+      const std::exception_ptr& exceptionPtr);
+
   /// Invokes a function on each selected row. Records per-row exceptions by
   /// calling 'setError'. The function must take a single "row" argument of type
   /// vector_size_t and return void.
@@ -103,6 +111,12 @@ class EvalCtx {
       const std::exception_ptr& exceptionPtr,
       ErrorVectorPtr* errorsPtr) const;
 
+  // Same as addError() for an error that may be shared by many rows.
+  void addError(
+      vector_size_t index,
+      const std::shared_ptr<void>& error,
+      ErrorVectorPtr* errorsPtr) const;
+
   // Returns the vector of errors or nullptr if no errors. This is
   // intentionally a raw pointer to signify that the caller may not
   // retain references to this.
@@ -118,6 +132,22 @@ class EvalCtx {
     return &throwOnError_;
   }
 
+  bool throwOnError() const {
+    return throwOnError_;
+  }
+
+  /// False if the errors recorded by setError(s) are only used to null
+  /// out the failing rows, e.g. under TRY, so that their messages are never
+  /// seen. Functions may then report failures with setErrors() and a
+  /// generic error instead of producing an exception per row.
+  bool captureErrorDetails() const {
+    return captureErrorDetails_;
+  }
+
+  bool* mutableCaptureErrorDetails() {
+    return &captureErrorDetails_;
+  }
+
   bool nullsPruned() const {
     return nullsPruned_;
   }
@@ -154,6 +184,12 @@ class EvalCtx {
     return execCtx_;
   }
 
+  // Scratch memory for a function that is valid until the next batch.
+  // See core::ExecCtx::arena().
+  Arena& arena() const {
+    return execCtx_->arena();
+  }
+
   ExprSet* exprSet() const {
     return exprSet_;
   }
@@ -206,6 +242,7 @@ class EvalCtx {
   // behavior.
   bool nullsPruned_{false};
   bool throwOnError_{true};
+  bool captureErrorDetails_{true};
 
   // True if the current set of rows will not grow, e.g. not under and IF or OR.
   bool isFinalSelection_{true};
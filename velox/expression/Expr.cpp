@@ -214,7 +214,7 @@ void Expr::evalSimplifiedImpl(
   inputValues_.clear();
 }
 
-void Expr::eval(
+void Expr::evalInternal(
     const SelectivityVector& rows,
     EvalCtx* context,
     VectorPtr* result) {
@@ -288,6 +288,10 @@ bool Expr::checkGetSharedSubexprValues(
         context->mutableIsFinalSelection(), false, updateFinalSelection);
 
     evalEncodings(*missingRows, context, &sharedSubexprValues_);
+    sharedSubexprRows_->select(*missingRows);
+  }
+  if (auto exprSet = context->exprSet()) {
+    exprSet->addSharedSubexprHit();
   }
   context->moveOrCopyResult(sharedSubexprValues_, rows, result);
   return true;
@@ -560,6 +564,9 @@ void Expr::evalEncodings(
           finalRowsHolder);
       auto* newRows = peelEncodingsResult.newRows;
       if (newRows) {
+        if (trackStats_) {
+          ++stats_.numPeeled;
+        }
         VectorPtr peeledResult;
         // peelEncodings() can potentially produce an empty selectivity vector
         // if all selected values we are waiting for are nulls. So, here we
@@ -633,6 +640,15 @@ void Expr::addNulls(
   (*result)->addNulls(rawNulls, rows);
 }
 
+void Expr::setTrackStats() {
+  // Field references and literals are not tracked.
+  trackStats_ = !dynamic_cast<const FieldReference*>(this) &&
+      !dynamic_cast<const ConstantExpr*>(this);
+  for (auto& input : inputs_) {
+    input->setTrackStats();
+  }
+}
+
 void Expr::evalWithNulls(
     const SelectivityVector& rows,
     EvalCtx* context,
@@ -653,6 +669,9 @@ void Expr::evalWithNulls(
     if (mayHaveNulls && !distinctFields_.empty()) {
       LocalSelectivityVector nonNullHolder(context);
       if (removeSureNulls(rows, context, nonNullHolder)) {
+        if (trackStats_) {
+          ++stats_.numNullFastPath;
+        }
         VarSetter noMoreNulls(context->mutableNullsPruned(), true);
         if (nonNullHolder.get()->hasSelections()) {
           evalAll(*nonNullHolder.get(), context, result);
@@ -694,6 +713,11 @@ void Expr::evalWithMemo(
       if (cached->hasSelections()) {
         BaseVector::ensureWritable(rows, type(), context->pool(), result);
         (*result)->copy(dictionaryCache_.get(), *cached, nullptr);
+        auto numHits = cached->countSelected();
+        context->exprSet()->addMemoHits(numHits);
+        if (trackStats_) {
+          stats_.numMemoHits += numHits;
+        }
       }
     }
     LocalSelectivityVector uncachedHolder(context, rows);
@@ -1114,6 +1138,39 @@ ExprSet::ExprSet(
     : execCtx_(execCtx) {
   exprs_ = compileExpressions(
       std::move(sources), execCtx, this, enableConstantFolding);
+  if (execCtx && execCtx->queryCtx() &&
+      execCtx->queryCtx()->exprTrackStats()) {
+    for (auto& expr : exprs_) {
+      expr->setTrackStats();
+    }
+  }
+}
+
+namespace {
+void addStats(
+    Expr& expr,
+    std::unordered_map<std::string, ExprStats>& stats,
+    std::unordered_set<const Expr*>& visited) {
+  if (!visited.insert(&expr).second) {
+    return;
+  }
+  if (expr.stats().timing.count > 0) {
+    stats[expr.name()].add(expr.stats());
+    expr.clearStats();
+  }
+  for (auto& input : expr.inputs()) {
+    addStats(*input, stats, visited);
+  }
+}
+} // namespace
+
+std::unordered_map<std::string, ExprStats> ExprSet::takeStats() {
+  std::unordered_map<std::string, ExprStats> stats;
+  std::unordered_set<const Expr*> visited;
+  for (auto& expr : exprs_) {
+    addStats(*expr, stats, visited);
+  }
+  return stats;
 }
 
 void ExprSet::eval(
@@ -1126,6 +1183,7 @@ void ExprSet::eval(
   result->resize(exprs_.size());
   if (initialize) {
     clearSharedSubexprs();
+    context->execCtx()->clearArena();
   }
   for (int32_t i = begin; i < end; ++i) {
     exprs_[i]->eval(rows, context, &(*result)[i]);
@@ -1155,6 +1213,7 @@ void ExprSetSimplified::eval(
   result->resize(exprs_.size());
   if (initialize) {
     clearSharedSubexprs();
+    context->execCtx()->clearArena();
   }
   for (int32_t i = begin; i < end; ++i) {
     exprs_[i]->evalSimplified(rows, context, &(*result)[i]);
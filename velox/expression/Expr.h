@@ -20,6 +20,7 @@
 
 #include <folly/container/F14Map.h>
 
+#include "velox/common/time/CpuWallTimer.h"
 #include "velox/core/Expressions.h"
 #include "velox/expression/EvalCtx.h"
 #include "velox/vector/SimpleVector.h"
@@ -60,6 +61,32 @@ class ExprSet;
 class FieldReference;
 class VectorFunction;
 
+// Counters for the evaluation of an Expr. Collected only if
+// QueryCtx::exprTrackStats() is true.
+struct ExprStats {
+  // Number of evaluations and their CPU and wall time, including the
+  // time of the inputs.
+  CpuWallTiming timing;
+  // Number of rows evaluated, summed over the evaluations.
+  uint64_t numProcessedRows{0};
+  // Number of evaluations that removed rows with null inputs before
+  // evaluating the function.
+  uint64_t numNullFastPath{0};
+  // Number of evaluations over the base vectors of dictionary or
+  // constant encoded inputs.
+  uint64_t numPeeled{0};
+  // Number of dictionary entries whose values came from the memo.
+  uint64_t numMemoHits{0};
+
+  void add(const ExprStats& other) {
+    timing.add(other.timing);
+    numProcessedRows += other.numProcessedRows;
+    numNullFastPath += other.numNullFastPath;
+    numPeeled += other.numPeeled;
+    numMemoHits += other.numMemoHits;
+  }
+};
+
 // An executable expression.
 class Expr {
  public:
@@ -84,7 +111,18 @@ class Expr {
 
   virtual ~Expr() = default;
 
-  void eval(const SelectivityVector& rows, EvalCtx* context, VectorPtr* result);
+  void eval(
+      const SelectivityVector& rows,
+      EvalCtx* context,
+      VectorPtr* result) {
+    if (UNLIKELY(trackStats_) && rows.hasSelections()) {
+      CpuWallTimer timer(stats_.timing);
+      stats_.numProcessedRows += rows.countSelected();
+      evalInternal(rows, context, result);
+    } else {
+      evalInternal(rows, context, result);
+    }
+  }
 
   // Simplified path for expression evaluation (flattens all vectors).
   void evalSimplified(
@@ -183,7 +221,27 @@ class Expr {
 
   virtual std::string toString() const;
 
+  const std::string& name() const {
+    return name_;
+  }
+
+  // Enables collecting 'stats_' for this and the inputs, recursively.
+  void setTrackStats();
+
+  const ExprStats& stats() const {
+    return stats_;
+  }
+
+  void clearStats() {
+    stats_ = ExprStats();
+  }
+
  private:
+  void evalInternal(
+      const SelectivityVector& rows,
+      EvalCtx* context,
+      VectorPtr* result);
+
   void setAllNulls(
       const SelectivityVector& rows,
       EvalCtx* context,
@@ -328,9 +386,16 @@ class Expr {
   // If multiply referenced or literal, these are the values.
   VectorPtr sharedSubexprValues_;
 
-  // The rows for which 'sharedSubexprValues_' has a value.
+  // The rows for which 'sharedSubexprValues_' has a value. This is the
+  // union of the rows of all the evaluations since the last reset(),
+  // e.g. the rows of all the branches of an IF that reference 'this'.
   std::unique_ptr<SelectivityVector> sharedSubexprRows_;
 
+  // The dictionary values the memo is for. The memo is kept across
+  // batches for as long as the input has the same base vector, e.g.
+  // for all the batches of a stripe read from a dictionary encoded
+  // column. A new base vector replaces the memo, so that there is at
+  // most one memo per Expr.
   VectorPtr baseDictionary_;
 
   // Values computed for the base dictionary, 1:1 to the positions in
@@ -346,6 +411,9 @@ class Expr {
 
   // Count of times the cacheable vector is seen for a non-first time.
   int32_t numCacheableRepeats_{0};
+
+  bool trackStats_{false};
+  ExprStats stats_;
 };
 
 using ExprPtr = std::shared_ptr<Expr>;
@@ -405,6 +473,34 @@ class ExprSet {
     memoizingExprs_.insert(expr);
   }
 
+  // Counts a use of previously computed values of a shared
+  // subexpression.
+  void addSharedSubexprHit() {
+    ++numSharedSubexprHits_;
+  }
+
+  // Returns the number of evaluations of shared subexpressions that
+  // were served from previously computed values.
+  int64_t numSharedSubexprHits() const {
+    return numSharedSubexprHits_;
+  }
+
+  // Counts 'numRows' dictionary entries whose values were taken from
+  // the memo of an Expr instead of being computed.
+  void addMemoHits(int64_t numRows) {
+    numMemoHits_ += numRows;
+  }
+
+  // Returns the number of dictionary entries served from memos.
+  int64_t numMemoHits() const {
+    return numMemoHits_;
+  }
+
+  // Returns the stats of the distinct Exprs in 'this', added up by
+  // function or special form name, and clears them. Empty unless
+  // QueryCtx::exprTrackStats() is true.
+  std::unordered_map<std::string, ExprStats> takeStats();
+
  protected:
   void clearSharedSubexprs();
 
@@ -417,6 +513,8 @@ class ExprSet {
   // Exprs which retain memoized state, e.g. from running over dictionaries.
   std::unordered_set<Expr*> memoizingExprs_;
   core::ExecCtx* const execCtx_;
+  int64_t numSharedSubexprHits_{0};
+  int64_t numMemoHits_{0};
 };
 
 class ExprSetSimplified : public ExprSet {
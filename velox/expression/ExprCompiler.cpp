@@ -71,6 +71,10 @@ struct Scope {
   std::vector<const ITypedExpr*> captureFieldAccesses;
   // Deduplicatable ITypedExprs. Only applies within the one scope.
   ExprDedupMap visited;
+  // Multiply referenced Exprs of a lambda Scope. These are reset at
+  // each invocation of the lambda since each invocation has different
+  // inputs. Empty for a top level Scope.
+  std::vector<ExprPtr> sharedSubexprs;
 
   Scope(std::vector<std::string>&& _locals, Scope* _parent, ExprSet* _exprSet)
       : locals(_locals), parent(_parent), exprSet(_exprSet) {}
@@ -244,7 +248,8 @@ std::shared_ptr<Expr> compileLambda(
       std::move(functionType),
       std::move(signature),
       std::move(captureReferences),
-      std::move(body));
+      std::move(body),
+      std::move(lambdaScope.sharedSubexprs));
 }
 
 ExprPtr tryFoldIfConstant(const ExprPtr& expr, Scope* scope) {
@@ -310,7 +315,11 @@ ExprPtr compileExpression(
   ExprPtr alreadyCompiled = getAlreadyCompiled(expr.get(), &scope->visited);
   if (alreadyCompiled) {
     if (!alreadyCompiled->isMultiplyReferenced()) {
-      scope->exprSet->addToReset(alreadyCompiled);
+      if (scope->parent) {
+        scope->sharedSubexprs.push_back(alreadyCompiled);
+      } else {
+        scope->exprSet->addToReset(alreadyCompiled);
+      }
     }
     alreadyCompiled->setMultiplyReferenced();
     return alreadyCompiled;
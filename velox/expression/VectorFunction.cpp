@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/expression/VectorFunction.h"
+#include <atomic>
 #include <unordered_map>
 #include "folly/Singleton.h"
 #include "folly/Synchronized.h"
@@ -25,13 +26,54 @@ VectorFunctionMap& vectorFunctionFactories() {
   return factories;
 }
 
+namespace {
+using VectorFunctionSnapshot =
+    std::unordered_map<std::string, VectorFunctionEntry>;
+
+// Incremented after every registration.
+std::atomic<uint64_t> registryVersion{1};
+
+struct VersionedSnapshot {
+  uint64_t version{0};
+  std::shared_ptr<const VectorFunctionSnapshot> functions;
+};
+
+// Returns a copy of vectorFunctionFactories() that is current as of
+// the last registration. The copy is made at most once per
+// registration and shared by all threads. Each thread keeps a
+// reference to the copy, so that lookups take no lock and write no
+// shared memory unless a function was registered in the meantime.
+const VectorFunctionSnapshot& functionsSnapshot() {
+  static folly::Synchronized<VersionedSnapshot> shared;
+  thread_local VersionedSnapshot local;
+  const auto version = registryVersion.load(std::memory_order_acquire);
+  if (local.version != version) {
+    local = shared.withWLock([version](auto& snapshot) {
+      if (snapshot.version != version) {
+        snapshot.functions = vectorFunctionFactories().withRLock(
+            [](const auto& functions) {
+              return std::make_shared<const VectorFunctionSnapshot>(
+                  functions);
+            });
+        snapshot.version = version;
+      }
+      return snapshot;
+    });
+  }
+  return *local.functions;
+}
+} // namespace
+
+uint64_t vectorFunctionRegistryVersion() {
+  return registryVersion.load(std::memory_order_acquire);
+}
+
 std::optional<std::vector<std::shared_ptr<FunctionSignature>>>
 getVectorFunctionSignatures(const std::string& name) {
-  return vectorFunctionFactories().withRLock([&name](auto& functions) -> auto {
-    auto it = functions.find(name);
-    return it == functions.end() ? std::nullopt
-                                 : std::optional(it->second.signatures);
-  });
+  const auto& functions = functionsSnapshot();
+  auto it = functions.find(name);
+  return it == functions.end() ? std::nullopt
+                               : std::optional(it->second.signatures);
 }
 
 std::shared_ptr<VectorFunction> getVectorFunction(
@@ -54,13 +96,11 @@ std::shared_ptr<VectorFunction> getVectorFunction(
     });
   }
 
-  return vectorFunctionFactories().withRLock(
-      [&name, &inputArgs ](auto& functionMap) -> auto {
-        auto functionIterator = functionMap.find(name);
-        return functionIterator == functionMap.end()
-            ? nullptr
-            : functionIterator->second.factory(name, inputArgs);
-      });
+  const auto& functionMap = functionsSnapshot();
+  auto functionIterator = functionMap.find(name);
+  return functionIterator == functionMap.end()
+      ? nullptr
+      : functionIterator->second.factory(name, inputArgs);
 }
 
 /// Registers a new vector function. When overwrite = true, previous functions
@@ -75,6 +115,7 @@ bool registerStatefulVectorFunction(
     vectorFunctionFactories().withWLock([&](auto& functionMap) {
       // Insert/overwrite.
       functionMap[name] = {std::move(signatures), std::move(factory)};
+      ++registryVersion;
     });
     return true;
   }
@@ -82,6 +123,9 @@ bool registerStatefulVectorFunction(
   return vectorFunctionFactories().withWLock([&](auto& functionMap) {
     auto [iterator, inserted] =
         functionMap.insert({name, {std::move(signatures), std::move(factory)}});
+    if (inserted) {
+      ++registryVersion;
+    }
     return inserted;
   });
 }
@@ -174,6 +174,10 @@ using VectorFunctionMap =
 
 VectorFunctionMap& vectorFunctionFactories();
 
+/// Returns a number that changes every time a vector function is
+/// registered. Used for invalidating caches of function resolution.
+uint64_t vectorFunctionRegistryVersion();
+
 // A template to simplify making VectorFunctionFactory for a function that has a
 // constructor that takes inputTypes and constantInputs
 //
@@ -72,6 +72,22 @@ class VectorAdapter : public VectorFunction {
       EvalCtx* context,
       VectorPtr* result) const override {
     ApplyContext applyContext{&rows, caller, context, result};
+    if constexpr (FUNC::reuse_strings_from_arg >= 0) {
+      static_assert(
+          FUNC::reuse_strings_from_arg < FUNC::num_args,
+          "reuse_strings_from_arg must be the index of an argument");
+      // The function may return slices of this argument without copying.
+      applyContext.result->acquireSharedStringBuffers(
+          args[FUNC::reuse_strings_from_arg].get());
+    }
+    if constexpr (hasFlatFastPath()) {
+      if (applyFlatNoNulls(
+              applyContext,
+              args,
+              std::make_index_sequence<FUNC::num_args>{})) {
+        return;
+      }
+    }
     DecodedArgs decodedArgs{rows, args, context};
     unpack<0>(applyContext, true, decodedArgs);
   }
@@ -85,6 +101,95 @@ class VectorAdapter : public VectorFunction {
   }
 
  private:
+  // True for execution types stored as an array of values in a
+  // FlatVector. Booleans are stored as bits.
+  template <typename TArg>
+  static constexpr bool isFlatValueType() {
+    return std::is_arithmetic_v<TArg> && !std::is_same_v<TArg, bool>;
+  }
+
+  template <size_t... Is>
+  static constexpr bool allArgsFlatValueType(std::index_sequence<Is...>) {
+    return (isFlatValueType<exec_arg_at<Is>>() && ...);
+  }
+
+  // True if the function can be called directly on the raw values of
+  // flat arguments and result, see applyFlatNoNulls().
+  static constexpr bool hasFlatFastPath() {
+    return FUNC::num_args > 0 && FUNC::is_default_null_behavior &&
+        isFlatValueType<T>() &&
+        allArgsFlatValueType(std::make_index_sequence<FUNC::num_args>{});
+  }
+
+  // Applies the function to the raw values of 'args' in a loop without
+  // decoding or per row error handling, so that the compiler can
+  // vectorize simple functions. Returns false without producing a
+  // result unless all 'args' are flat and have no nulls. Returns false
+  // also if the function produces a null or throws. The caller then
+  // evaluates all the rows again on the general path, which sets the
+  // nulls and errors per row.
+  template <size_t... Is>
+  bool applyFlatNoNulls(
+      ApplyContext& applyContext,
+      const std::vector<VectorPtr>& args,
+      std::index_sequence<Is...>) const {
+    bool nullsPruned = applyContext.context->nullsPruned();
+    for (auto& arg : args) {
+      if (arg->encoding() != VectorEncoding::Simple::FLAT ||
+          (!nullsPruned && arg->mayHaveNulls())) {
+        return false;
+      }
+    }
+    return applyToRawValues(
+        *applyContext.rows,
+        applyContext.result->mutableRawValues(),
+        args[Is]->template asUnchecked<FlatVector<exec_arg_at<Is>>>()
+            ->rawValues()...);
+  }
+
+  template <typename... TArg>
+  bool applyToRawValues(
+      const SelectivityVector& rows,
+      T* result,
+      const TArg*... values) const {
+    bool notNull = true;
+    auto applyRange = [&](vector_size_t begin, vector_size_t end) {
+      for (auto row = begin; row < end; ++row) {
+        notNull &= (*fn_).call(result[row], values[row]...);
+      }
+    };
+    // Runs of 64 selected rows go through the tight loop, other rows
+    // one at a time.
+    auto applyWord = [&](int32_t index, uint64_t word) {
+      if (word == ~0UL) {
+        applyRange(index * 64, index * 64 + 64);
+        return;
+      }
+      while (word) {
+        auto row = index * 64 + __builtin_ctzll(word);
+        applyRange(row, row + 1);
+        word &= word - 1;
+      }
+    };
+    try {
+      if (rows.isAllSelected()) {
+        applyRange(rows.begin(), rows.end());
+      } else {
+        auto bits = rows.asRange().bits();
+        bits::forEachWord(
+            rows.begin(),
+            rows.end(),
+            [&](int32_t index, uint64_t mask) {
+              applyWord(index, bits[index] & mask);
+            },
+            [&](int32_t index) { applyWord(index, bits[index]); });
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+    return notNull;
+  }
+
   template <
       int32_t POSITION,
       typename... TReader,
@@ -789,6 +789,17 @@ class StringProxy<FlatVector<StringView>, false /*reuseInput*/>
     dataBuffer_ = newDataBuffer;
   }
 
+  /// Points the output string at 'input' without copying. 'input' must be
+  /// in the string buffers of 'vector_', see
+  /// UDFOutputString::setNoCopy().
+  void setNoCopy(const std::string_view& input) override {
+    setData(const_cast<char*>(input.data()));
+    setSize(input.size());
+    setCapacity(input.size());
+    // Space reserved before is not used.
+    dataBuffer_ = nullptr;
+  }
+
   /// Not called by the UDF Implementation. Should be called at the end to
   /// finalize the allocation and the string writing
   void finalize() {
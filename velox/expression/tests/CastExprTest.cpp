@@ -16,6 +16,7 @@
 
 #include "velox/expression/ControlExpr.h"
 #include "velox/functions/prestosql/tests/FunctionBaseTest.h"
+#include "velox/type/DecimalType.h"
 
 using namespace facebook::velox;
 
@@ -303,6 +304,38 @@ TEST_F(CastExprTest, errorHandling) {
       "tinyint", {"1", "2", "3", "100", "-100.5"}, {1, 2, 3, 100, -100}, true);
 }
 
+TEST_F(CastExprTest, stringFastAndSlowPaths) {
+  // Plain digits take the exception free path. Signs, exponents and out of
+  // range values fall back to the general conversion.
+  testCast<std::string, int64_t>(
+      "bigint",
+      {"0", "-42", "+42", "999999999999999999", "9223372036854775807"},
+      {0, -42, 42, 999999999999999999, 9223372036854775807});
+  testCast<std::string, int8_t>(
+      "tinyint",
+      {"127", "-128", "128", "12a", std::nullopt},
+      {127, -128, std::nullopt, std::nullopt, std::nullopt},
+      false,
+      true);
+  testCast<std::string, int8_t>("tinyint", {"1", "128"}, {1, 1}, true);
+  testCast<std::string, double>(
+      "double",
+      {"1.5", "-0.125", "100", "1e3", "-2.5E-1", "0.1", "12345.678"},
+      {1.5, -0.125, 100.0, 1000.0, -0.25, 0.1, 12345.678});
+  testCast<std::string, double>(
+      "double",
+      {"1.5", "1..5", "abc", std::nullopt},
+      {1.5, std::nullopt, std::nullopt, std::nullopt},
+      false,
+      true);
+  testCast<std::string, Timestamp>(
+      "timestamp",
+      {"2000-01-01 12:21:56", "2000-01-01 12:21:56x", "2000-13-01"},
+      {Timestamp(946729316, 0), std::nullopt, std::nullopt},
+      false,
+      true);
+}
+
 constexpr vector_size_t kVectorSize = 1'000;
 
 TEST_F(CastExprTest, mapCast) {
@@ -492,3 +525,41 @@ TEST_F(CastExprTest, testNullOnFailure) {
           "c0", rowVector, INTEGER(), false),
       std::exception);
 }
+
+TEST_F(CastExprTest, decimal) {
+  auto strings = makeNullableFlatVector<std::string>(
+      {"12.345", "-1", "0.005", std::nullopt, "abc", "10000"});
+  auto decimals = evaluateComplexCast<FlatVector<int64_t>>(
+      "c0", makeRowVector({strings}), DECIMAL(6, 2), true);
+  EXPECT_EQ("DECIMAL(6,2)", decimals->type()->toString());
+  assertEqualVectors(
+      makeNullableFlatVector<int64_t>(
+          {1235, -100, 1, std::nullopt, std::nullopt, std::nullopt}),
+      decimals);
+  EXPECT_THROW(
+      evaluateComplexCast<FlatVector<int64_t>>(
+          "c0", makeRowVector({strings}), DECIMAL(6, 2), false),
+      std::exception);
+
+  auto input = makeNullableFlatVector<int64_t>(
+      {1235, -150, 5, std::nullopt}, DECIMAL(6, 2));
+  auto data = makeRowVector({input});
+  assertEqualVectors(
+      makeNullableFlatVector<std::string>(
+          {"12.35", "-1.50", "0.05", std::nullopt}),
+      evaluateComplexCast<FlatVector<StringView>>("c0", data, VARCHAR()));
+  assertEqualVectors(
+      makeNullableFlatVector<int64_t>({12, -2, 0, std::nullopt}),
+      evaluateComplexCast<FlatVector<int64_t>>("c0", data, BIGINT()));
+  assertEqualVectors(
+      makeNullableFlatVector<double>({12.35, -1.5, 0.05, std::nullopt}),
+      evaluateComplexCast<FlatVector<double>>("c0", data, DOUBLE()));
+  assertEqualVectors(
+      makeNullableFlatVector<int64_t>({124, -15, 1, std::nullopt}),
+      evaluateComplexCast<FlatVector<int64_t>>("c0", data, DECIMAL(4, 1)));
+  // 12.35 does not fit DECIMAL(3, 2).
+  assertEqualVectors(
+      makeNullableFlatVector<int64_t>({std::nullopt, -150, 5, std::nullopt}),
+      evaluateComplexCast<FlatVector<int64_t>>(
+          "c0", data, DECIMAL(3, 2), true));
+}
@@ -1287,6 +1287,40 @@ TEST_F(ExprTest, nonDeterministicConstantFolding) {
   assertEqualVectors(expected, result);
 }
 
+// Verify that the inputs of AND are not moved across a non-deterministic
+// input when reordered.
+TEST_F(ExprTest, reorderAroundNonDeterministic) {
+  exec::registerVectorFunction(
+      "plus_random",
+      PlusRandomIntegerFunction::signatures(),
+      std::make_unique<PlusRandomIntegerFunction>());
+
+  const vector_size_t size = 10'000;
+  auto row = makeRowVector({
+      makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+      makeFlatVector<int32_t>(size, [](auto /*row*/) { return 0; }),
+  });
+  auto exprSet = compileExpression(
+      "c0 % 409 < 300 AND c0 % 103 < 30 AND plus_random(c1) >= 0 "
+      "AND c0 % 7 = 0",
+      std::dynamic_pointer_cast<const RowType>(row->type()));
+  auto conjunct =
+      std::dynamic_pointer_cast<exec::ConjunctExpr>(exprSet->expr(0));
+  ASSERT_TRUE(conjunct != nullptr);
+
+  auto expected = makeFlatVector<bool>(size, [](auto row) {
+    return row % 409 < 300 && row % 103 < 30 && row % 7 == 0;
+  });
+  for (auto i = 0; i <= exec::ConjunctExpr::kReorderInterval; ++i) {
+    auto result = evaluate(exprSet.get(), row);
+    assertEqualVectors(expected, result);
+  }
+  EXPECT_LT(conjunct->inputOrderAt(0), 2);
+  EXPECT_LT(conjunct->inputOrderAt(1), 2);
+  EXPECT_EQ(2, conjunct->inputOrderAt(2));
+  EXPECT_EQ(3, conjunct->inputOrderAt(3));
+}
+
 TEST_F(ExprTest, shortCircuit) {
   vector_size_t size = 4;
 
@@ -1402,6 +1436,40 @@ TEST_F(ExprTest, csePartialEvaluation) {
   assertEqualVectors(expected, results[1]);
 }
 
+// Test CSE across the branches of an IF and a later expression of the same
+// ExprSet. The values are kept for the union of the rows of all evaluations.
+TEST_F(ExprTest, cseAcrossBranches) {
+  exec::registerVectorFunction(
+      "add_suffix",
+      AddSuffixFunction::signatures(),
+      std::make_unique<AddSuffixFunction>("_xx"));
+
+  auto input = makeRowVector({
+      makeFlatVector<int32_t>({1, 2, 3, 4, 5}),
+      makeFlatVector({"a", "b", "c", "d", "e"}),
+  });
+  auto rowType = std::dynamic_pointer_cast<const RowType>(input->type());
+  std::vector<std::shared_ptr<const core::ITypedExpr>> expressions = {
+      parseExpression(
+          "if (c0 >= 3, add_suffix(c1), add_suffix(add_suffix(c1)))",
+          rowType),
+      parseExpression("add_suffix(c1)", rowType)};
+  exec::ExprSet exprSet(std::move(expressions), execCtx_.get());
+  exec::EvalCtx context(execCtx_.get(), &exprSet, input.get());
+  SelectivityVector rows(input->size());
+  std::vector<VectorPtr> results(2);
+  exprSet.eval(rows, &context, &results);
+
+  auto expected =
+      makeFlatVector({"a_xx_xx", "b_xx_xx", "c_xx", "d_xx", "e_xx"});
+  assertEqualVectors(expected, results[0]);
+  expected = makeFlatVector({"a_xx", "b_xx", "c_xx", "d_xx", "e_xx"});
+  assertEqualVectors(expected, results[1]);
+
+  // The ELSE branch and the second expression reuse add_suffix(c1).
+  EXPECT_EQ(2, exprSet.numSharedSubexprHits());
+}
+
 // Checks that vector function registry overwrites if multiple registry attempts
 // are made for the same functions.
 TEST_F(ExprTest, overwriteInRegistry) {
@@ -1910,6 +1978,39 @@ TEST_F(ExprTest, switchExpr) {
   assertEqualVectors(expected, result);
 }
 
+TEST_F(ExprTest, sparseSwitchBranch) {
+  // The THEN branch selects 1 of 100 rows and is evaluated on a dense batch
+  // of these. c0 is a dictionary, so the dense batch wraps a dictionary.
+  vector_size_t size = 1'000;
+  auto c0 = wrapInDictionary(
+      makeIndices(size, [size](auto row) { return size - 1 - row; }),
+      size,
+      makeFlatVector<int32_t>(size, [](auto row) { return row; }));
+  auto c1 = makeFlatVector<int32_t>(
+      size, [](auto row) { return row; }, nullEvery(7));
+  auto vector = makeRowVector({c0, c1});
+  auto isSparse = [size](auto row) { return (size - 1 - row) % 100 == 0; };
+
+  auto result = evaluate(
+      "case when c0 % 100 = 0 then c0 * 2 + c1 else c1 + 1 end", vector);
+  auto expected = makeFlatVector<int32_t>(
+      size,
+      [&](auto row) {
+        return isSparse(row) ? (size - 1 - row) * 2 + row : row + 1;
+      },
+      nullEvery(7));
+  assertEqualVectors(expected, result);
+
+  // Errors in the sparse branch are reported for the original rows.
+  result = evaluate(
+      "try(case when c0 % 100 = 0 then c1 / (c0 - c0) else c1 end)", vector);
+  expected = makeFlatVector<int32_t>(
+      size,
+      [](auto row) { return row; },
+      [&](auto row) { return row % 7 == 0 || isSparse(row); });
+  assertEqualVectors(expected, result);
+}
+
 TEST_F(ExprTest, ifWithConstant) {
   vector_size_t size = 4;
 
@@ -1940,6 +2041,34 @@ TEST_F(ExprTest, tryExpr) {
   }
 }
 
+// Casts that fail under TRY are reported in bulk. Outside of TRY, the
+// errors kept by a conjunct still have the message of the failing row.
+TEST_F(ExprTest, tryCastErrorsInBulk) {
+  std::vector<std::string> strings;
+  for (auto i = 0; i < 1'000; ++i) {
+    strings.push_back(i % 3 == 0 ? fmt::format("{}x", i) : std::to_string(i));
+  }
+  auto data = makeRowVector({vectorMaker_->flatVector(strings)});
+
+  auto result = evaluate("try(cast(c0 as bigint))", data);
+  auto expected = makeFlatVector<int64_t>(
+      1'000, [](auto row) { return row; }, nullEvery(3));
+  assertEqualVectors(expected, result);
+
+  result = evaluate("try(cast(c0 as bigint) > 10 and c0 <> '5')", data);
+  auto expectedBool = makeFlatVector<bool>(
+      1'000, [](auto row) { return row > 10; }, nullEvery(3));
+  assertEqualVectors(expectedBool, result);
+
+  try {
+    evaluate("cast(c0 as bigint) > 10 and c0 <> '5'", data);
+    FAIL() << "Expected an error";
+  } catch (const std::exception& e) {
+    EXPECT_EQ(std::string(e.what()).find("Failed to cast"), std::string::npos)
+        << e.what();
+  }
+}
+
 namespace {
 // Testing functions for generating intermediate results in different
 // encodings. The test case passes vectors to these and these
@@ -2199,6 +2328,9 @@ TEST_F(ExprTest, memo) {
   expectedResult =
       makeFlatVector<int64_t>(100, [](auto row) { return (row * 5) % 3; });
   assertEqualVectors(expectedResult, result);
+  // Positions 10, 15, ..., 205 of 'base' were computed for the first two
+  // batches.
+  EXPECT_EQ(40, exprSet->numMemoHits());
 }
 
 // This test triggers the situation when peelEncodings() produces an empty
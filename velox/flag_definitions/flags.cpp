@@ -43,6 +43,28 @@ DEFINE_bool(
     true,
     "Use malloc for file cache and large operator allocations");
 
+DEFINE_bool(
+    velox_memory_huge_pages,
+    false,
+    "Back large MappedMemory runs and hash tables with transparent huge "
+    "pages");
+
+// Used in velox/dwio/dwrf/reader/FileMetadataCache.cpp
+
+DEFINE_int32(
+    velox_file_metadata_cache_mb,
+    256,
+    "Size of the process-wide cache of parsed file footers in MB. 0 "
+    "disables the cache");
+
+// Used in velox/dwio/dwrf/reader/SharedDictionaryCache.cpp
+
+DEFINE_int32(
+    velox_shared_dictionary_cache_mb,
+    256,
+    "Size of the process-wide cache of decoded stripe string dictionaries "
+    "in MB. 0 disables the cache");
+
 // Used in common/base/VeloxException.cpp
 
 DEFINE_bool(
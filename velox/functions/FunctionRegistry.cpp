@@ -18,6 +18,8 @@
 #include <boost/algorithm/string.hpp>
 #include <optional>
 #include <sstream>
+#include <unordered_map>
+#include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
 #include "velox/core/FunctionRegistry.h"
 #include "velox/core/ScalarFunction.h"
@@ -66,7 +68,7 @@ void populateSimpleFunctionSignatures(FunctionSignatureMap& map) {
 }
 
 void populateVectorFunctionSignatures(FunctionSignatureMap& map) {
-  auto vectorFunctions = exec::vectorFunctionFactories();
+  auto& vectorFunctions = exec::vectorFunctionFactories();
   vectorFunctions.withRLock([&map](const auto& locked) {
     for (const auto& it : locked) {
       const auto& allSignatures = it.second.signatures;
@@ -86,7 +88,45 @@ FunctionSignatureMap getFunctionSignatures() {
   return result;
 }
 
-std::shared_ptr<const Type> resolveFunction(
+namespace {
+struct ResolutionKey {
+  std::string name;
+  std::vector<TypePtr> argTypes;
+
+  bool operator==(const ResolutionKey& other) const {
+    if (name != other.name || argTypes.size() != other.argTypes.size()) {
+      return false;
+    }
+    for (auto i = 0; i < argTypes.size(); ++i) {
+      if (*argTypes[i] != *other.argTypes[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+struct ResolutionKeyHasher {
+  size_t operator()(const ResolutionKey& key) const {
+    auto hash = std::hash<std::string>()(key.name);
+    for (const auto& type : key.argTypes) {
+      hash = bits::hashMix(hash, type->hashKind());
+    }
+    return hash;
+  }
+};
+
+// Per-thread memo of resolveFunction() results. Valid as long as no
+// function was registered since it was filled.
+struct ResolutionCache {
+  static constexpr size_t kMaxEntries = 10'000;
+
+  uint64_t scalarVersion{0};
+  uint64_t vectorVersion{0};
+  std::unordered_map<ResolutionKey, TypePtr, ResolutionKeyHasher> entries;
+};
+
+std::shared_ptr<const Type> resolveFunctionUncached(
     const std::string& functionName,
     const std::vector<TypePtr>& argTypes) {
   // Check if ScalarFunctions has this function name + signature.
@@ -109,5 +149,30 @@ std::shared_ptr<const Type> resolveFunction(
 
   return nullptr;
 }
+} // namespace
+
+std::shared_ptr<const Type> resolveFunction(
+    const std::string& functionName,
+    const std::vector<TypePtr>& argTypes) {
+  thread_local ResolutionCache cache;
+  const auto scalarVersion = core::ScalarFunctions().version();
+  const auto vectorVersion = exec::vectorFunctionRegistryVersion();
+  if (cache.scalarVersion != scalarVersion ||
+      cache.vectorVersion != vectorVersion ||
+      cache.entries.size() >= ResolutionCache::kMaxEntries) {
+    cache.entries.clear();
+    cache.scalarVersion = scalarVersion;
+    cache.vectorVersion = vectorVersion;
+  }
+
+  ResolutionKey key{functionName, argTypes};
+  auto it = cache.entries.find(key);
+  if (it != cache.entries.end()) {
+    return it->second;
+  }
+  auto type = resolveFunctionUncached(functionName, argTypes);
+  cache.entries.emplace(std::move(key), type);
+  return type;
+}
 
 } // namespace facebook::velox
@@ -70,6 +70,16 @@ class UDFOutputString {
     std::copy(input.begin(), input.end(), output.data());
   }
 
+  /// Sets the string to 'input'. Implementations that can refer to 'input'
+  /// without copying do so. The default copies. A UDF may pass a slice of
+  /// an argument only if it declares that argument in
+  /// 'reuse_strings_from_arg', so that the result vector holds the string
+  /// buffers of the argument.
+  virtual void setNoCopy(const std::string_view& input) {
+    resize(input.size());
+    std::copy(input.begin(), input.end(), data());
+  }
+
  protected:
   void setData(char* address) noexcept {
     data_ = address;
@@ -16,8 +16,10 @@
 #include "velox/functions/lib/Re2Functions.h"
 
 #include <re2/re2.h>
+#include <mutex>
 #include <optional>
 
+#include "velox/common/caching/SimpleLRUCache.h"
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/Expr.h"
 #include "velox/expression/VectorUdfTypeSystem.h"
@@ -83,6 +85,142 @@ FlatVector<StringView>& ensureWritableStringView(
   return *flat;
 }
 
+// Maximum number of compiled non-constant patterns kept in the process.
+constexpr int64_t kMaxCachedPatterns = 1'000;
+
+// Returns the compiled 'pattern' from a process-wide LRU cache shared by all
+// drivers. Throws if 'pattern' is not valid. Used for non-constant patterns,
+// which often have few distinct values.
+std::shared_ptr<const RE2> compiledPattern(StringView pattern) {
+  using Cache = SimpleLRUCache<std::string, std::shared_ptr<const RE2>>;
+  static std::mutex mutex;
+  static Cache* cache = new Cache(kMaxCachedPatterns);
+  std::string key(pattern.data(), pattern.size());
+  {
+    std::lock_guard<std::mutex> l(mutex);
+    if (auto* cached = cache->get(key)) {
+      auto re = *cached;
+      cache->release(key);
+      return re;
+    }
+  }
+  auto re = std::make_shared<const RE2>(toStringPiece(pattern), RE2::Quiet);
+  checkForBadPattern(*re);
+  auto value = std::make_unique<std::shared_ptr<const RE2>>(re);
+  std::lock_guard<std::mutex> l(mutex);
+  if (cache->add(std::move(key), value.get(), 1)) {
+    value.release();
+  }
+  return re;
+}
+
+// Compiles the patterns of consecutive rows, reusing the last one when the
+// pattern repeats.
+class PatternCompiler {
+ public:
+  const RE2& compile(StringView pattern) {
+    if (!re_ || pattern != pattern_) {
+      re_ = compiledPattern(pattern);
+      pattern_ = pattern;
+    }
+    return *re_;
+  }
+
+ private:
+  std::shared_ptr<const RE2> re_;
+  StringView pattern_;
+};
+
+// Returns the literal text that every match of 'pattern' starts with. This
+// is the text before the first special character, less the last character
+// if a quantifier follows it. Returns an empty string if 'pattern' may have
+// an alternation outside of groups.
+std::string literalPrefix(StringView pattern) {
+  static const std::string_view kSpecialChars = "\\^$.|?*+()[]{}";
+  std::string_view text(pattern.data(), pattern.size());
+  if (text.find("\\Q") != std::string_view::npos) {
+    return "";
+  }
+  int32_t depth = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    switch (text[i]) {
+      case '\\':
+        ++i;
+        break;
+      case '[':
+        // A ']' right after '[' or '[^' is part of the class.
+        i += i + 1 < text.size() && text[i + 1] == '^' ? 2 : 1;
+        i += i < text.size() && text[i] == ']';
+        while (i < text.size() && text[i] != ']') {
+          i += text[i] == '\\' ? 2 : 1;
+        }
+        break;
+      case '(':
+        ++depth;
+        break;
+      case ')':
+        --depth;
+        break;
+      case '|':
+        if (depth == 0) {
+          return "";
+        }
+        break;
+    }
+  }
+  size_t size = 0;
+  // Stops at non-ASCII characters, whose bytes a quantifier would apply to
+  // together.
+  while (size < text.size() &&
+         kSpecialChars.find(text[size]) == std::string_view::npos &&
+         static_cast<uint8_t>(text[size]) < 0x80) {
+    ++size;
+  }
+  if (size > 0 && size < text.size() &&
+      (text[size] == '?' || text[size] == '*' || text[size] == '{')) {
+    --size;
+  }
+  return std::string(text.substr(0, size));
+}
+
+// Literal text that matching strings must start with, for a full match, or
+// contain, for a partial match. Lets most non-matching strings be rejected
+// with a memchr-based search instead of RE2.
+class LiteralPrefilter {
+ public:
+  LiteralPrefilter(StringView pattern, bool fullMatch)
+      : prefix_(literalPrefix(pattern)),
+        isLiteral_(prefix_.size() == pattern.size()),
+        fullMatch_(fullMatch) {}
+
+  // Returns false if 'str' cannot match.
+  bool mayMatch(StringView str) const {
+    if (prefix_.empty()) {
+      return true;
+    }
+    std::string_view text(str.data(), str.size());
+    if (fullMatch_) {
+      return text.substr(0, prefix_.size()) == prefix_;
+    }
+    return text.find(prefix_) != std::string_view::npos;
+  }
+
+  // Returns true if the pattern has no special characters. matches() then
+  // gives the result of matching without RE2.
+  bool isLiteral() const {
+    return isLiteral_;
+  }
+
+  bool matches(StringView str) const {
+    return mayMatch(str) && (!fullMatch_ || str.size() == prefix_.size());
+  }
+
+ private:
+  const std::string prefix_;
+  const bool isLiteral_;
+  const bool fullMatch_;
+};
+
 bool re2FullMatch(StringView str, const RE2& re) {
   return RE2::FullMatch(toStringPiece(str), re);
 }
@@ -120,7 +258,8 @@ template <bool (*Fn)(StringView, const RE2&)>
 class Re2MatchConstantPattern final : public VectorFunction {
  public:
   explicit Re2MatchConstantPattern(StringView pattern)
-      : re_(toStringPiece(pattern), RE2::Quiet) {}
+      : re_(toStringPiece(pattern), RE2::Quiet),
+        prefilter_(pattern, Fn == re2FullMatch) {}
 
   void apply(
       const SelectivityVector& rows,
@@ -133,13 +272,21 @@ class Re2MatchConstantPattern final : public VectorFunction {
         ensureWritableBool(rows, context->pool(), resultRef);
     exec::LocalDecodedVector toSearch(context, *args[0], rows);
     checkForBadPattern(re_);
+    if (prefilter_.isLiteral()) {
+      rows.applyToSelected([&](vector_size_t i) {
+        result.set(i, prefilter_.matches(toSearch->valueAt<StringView>(i)));
+      });
+      return;
+    }
     rows.applyToSelected([&](vector_size_t i) {
-      result.set(i, Fn(toSearch->valueAt<StringView>(i), re_));
+      auto str = toSearch->valueAt<StringView>(i);
+      result.set(i, prefilter_.mayMatch(str) && Fn(str, re_));
     });
   }
 
  private:
   RE2 re_;
+  const LiteralPrefilter prefilter_;
 };
 
 template <bool (*Fn)(StringView, const RE2&)>
@@ -162,9 +309,9 @@ class Re2Match final : public VectorFunction {
         ensureWritableBool(rows, context->pool(), resultRef);
     exec::LocalDecodedVector toSearch(context, *args[0], rows);
     exec::LocalDecodedVector pattern(context, *args[1], rows);
+    PatternCompiler compiler;
     rows.applyToSelected([&](vector_size_t row) {
-      RE2 re(toStringPiece(pattern->valueAt<StringView>(row)), RE2::Quiet);
-      checkForBadPattern(re);
+      auto& re = compiler.compile(pattern->valueAt<StringView>(row));
       result.set(row, Fn(toSearch->valueAt<StringView>(row), re));
     });
   }
@@ -180,7 +327,7 @@ template <typename T>
 class Re2SearchAndExtractConstantPattern final : public VectorFunction {
  public:
   explicit Re2SearchAndExtractConstantPattern(StringView pattern)
-      : re_(toStringPiece(pattern), RE2::Quiet) {}
+      : re_(toStringPiece(pattern), RE2::Quiet), prefilter_(pattern, false) {}
 
   void apply(
       const SelectivityVector& rows,
@@ -199,11 +346,18 @@ class Re2SearchAndExtractConstantPattern final : public VectorFunction {
     exec::LocalDecodedVector toSearch(context, *args[0], rows);
     bool mustRefSourceStrings = false;
     FOLLY_DECLARE_REUSED(groups, std::vector<re2::StringPiece>);
+    auto extract = [&](vector_size_t row, int32_t groupId) {
+      if (!prefilter_.mayMatch(toSearch->valueAt<StringView>(row))) {
+        result.setNull(row, true);
+        return false;
+      }
+      return re2Extract(result, row, re_, toSearch, groups, groupId);
+    };
     // Common case: constant group id.
     if (args.size() == 2) {
       groups.resize(1);
       rows.applyToSelected([&](vector_size_t i) {
-        mustRefSourceStrings |= re2Extract(result, i, re_, toSearch, groups, 0);
+        mustRefSourceStrings |= extract(i, 0);
       });
       if (mustRefSourceStrings) {
         result.acquireSharedStringBuffers(toSearch->base());
@@ -215,8 +369,7 @@ class Re2SearchAndExtractConstantPattern final : public VectorFunction {
       checkForBadGroupId(*groupId, re_);
       groups.resize(*groupId + 1);
       rows.applyToSelected([&](vector_size_t i) {
-        mustRefSourceStrings |=
-            re2Extract(result, i, re_, toSearch, groups, *groupId);
+        mustRefSourceStrings |= extract(i, *groupId);
       });
       if (mustRefSourceStrings) {
         result.acquireSharedStringBuffers(toSearch->base());
@@ -237,8 +390,7 @@ class Re2SearchAndExtractConstantPattern final : public VectorFunction {
     groups.resize(maxGroupId + 1);
     rows.applyToSelected([&](vector_size_t i) {
       T group = groupIds->valueAt<T>(i);
-      mustRefSourceStrings |=
-          re2Extract(result, i, re_, toSearch, groups, group);
+      mustRefSourceStrings |= extract(i, group);
     });
     if (mustRefSourceStrings) {
       result.acquireSharedStringBuffers(toSearch->base());
@@ -247,6 +399,7 @@ class Re2SearchAndExtractConstantPattern final : public VectorFunction {
 
  private:
   RE2 re_;
+  const LiteralPrefilter prefilter_;
 };
 
 // The factory function we provide returns a unique instance for each call, so
@@ -267,27 +420,26 @@ class Re2SearchAndExtract final : public VectorFunction {
           rows, args, caller, context, resultRef);
       return;
     }
-    // The general case. Further optimizations are possible to avoid regex
-    // recompilation, but a constant pattern is by far the most common case.
+    // The general case. The compiled patterns are cached across rows and
+    // batches.
     FlatVector<StringView>& result =
         ensureWritableStringView(rows, context->pool(), resultRef);
     exec::LocalDecodedVector toSearch(context, *args[0], rows);
     exec::LocalDecodedVector pattern(context, *args[1], rows);
     bool mustRefSourceStrings = false;
     FOLLY_DECLARE_REUSED(groups, std::vector<re2::StringPiece>);
+    PatternCompiler compiler;
     if (args.size() == 2) {
       groups.resize(1);
       rows.applyToSelected([&](vector_size_t i) {
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(i)), RE2::Quiet);
-        checkForBadPattern(re);
+        auto& re = compiler.compile(pattern->valueAt<StringView>(i));
         mustRefSourceStrings |= re2Extract(result, i, re, toSearch, groups, 0);
       });
     } else {
       exec::LocalDecodedVector groupIds(context, *args[2], rows);
       rows.applyToSelected([&](vector_size_t i) {
         const auto groupId = groupIds->valueAt<T>(i);
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(i)), RE2::Quiet);
-        checkForBadPattern(re);
+        auto& re = compiler.compile(pattern->valueAt<StringView>(i));
         checkForBadGroupId(groupId, re);
         groups.resize(groupId + 1);
         mustRefSourceStrings |=
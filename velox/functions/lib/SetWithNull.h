@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <folly/container/F14Set.h>
+
+namespace facebook::velox::functions {
+
+/// A set of values of type T and a flag for null, for set operations on the
+/// elements of arrays and maps. Up to kSmallSize values are kept in a
+/// vector that is searched linearly, which is faster than hashing for the
+/// small arrays that are typical. Larger sets move to an F14 set. reset()
+/// keeps the memory of both, so that one set reused for all the rows of a
+/// batch allocates only when it grows.
+template <typename T>
+class SetWithNull {
+ public:
+  static constexpr size_t kSmallSize = 8;
+
+  /// Adds 'value'. Returns true if 'value' was not in the set.
+  bool insert(const T& value) {
+    if (!isLarge_) {
+      if (std::find(small_.begin(), small_.end(), value) != small_.end()) {
+        return false;
+      }
+      if (small_.size() < kSmallSize) {
+        small_.push_back(value);
+        return true;
+      }
+      large_.insert(small_.begin(), small_.end());
+      isLarge_ = true;
+    }
+    return large_.insert(value).second;
+  }
+
+  bool contains(const T& value) const {
+    if (!isLarge_) {
+      return std::find(small_.begin(), small_.end(), value) != small_.end();
+    }
+    return large_.count(value) > 0;
+  }
+
+  void reset() {
+    small_.clear();
+    if (isLarge_) {
+      large_.clear();
+      isLarge_ = false;
+    }
+    hasNull = false;
+  }
+
+  bool hasNull{false};
+
+ private:
+  std::vector<T> small_;
+  folly::F14FastSet<T> large_;
+  bool isLarge_{false};
+};
+
+} // namespace facebook::velox::functions
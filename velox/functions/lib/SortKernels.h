@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace facebook::velox::functions {
+
+/// Sort kernels for the values of an array of a primitive type. The values
+/// are sorted by operator<, so NaNs must be moved out with partitionNaNs()
+/// first. Small ranges use std::sort on the plain operator<, which is
+/// branch-light and inlines unlike a comparator that checks for NaN.
+/// Integer and floating point ranges of at least kMinRadixSortSize values
+/// use an LSD radix sort that skips the bytes in which all values agree.
+class SortKernels {
+ public:
+  static constexpr size_t kMinRadixSortSize = 256;
+
+  /// Moves the NaNs of [begin, end) to its end. Returns the position of
+  /// the first NaN, or 'end' if there are none. The order of the other
+  /// values is not kept.
+  template <typename T>
+  static T* partitionNaNs(T* begin, T* end) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return std::partition(
+          begin, end, [](const T& value) { return !std::isnan(value); });
+    } else {
+      return end;
+    }
+  }
+
+  /// Sorts [begin, end) in ascending or descending order. 'scratch' is
+  /// reused across calls for the radix sort.
+  template <typename T>
+  static void sort(T* begin, T* end, bool descending, std::vector<T>& scratch) {
+    auto size = end - begin;
+    if (size < 2) {
+      return;
+    }
+    if constexpr (kHasRadixKey<T>) {
+      if (size >= kMinRadixSortSize) {
+        radixSort(begin, size, scratch);
+        if (descending) {
+          std::reverse(begin, end);
+        }
+        return;
+      }
+    }
+    if (descending) {
+      std::sort(begin, end, [](const T& a, const T& b) { return b < a; });
+    } else {
+      std::sort(begin, end);
+    }
+  }
+
+  /// Sorts the values of [begin, end) so that NaNs come after all other
+  /// values in ascending order and before them in descending order.
+  template <typename T>
+  static void sortWithNaNs(
+      T* begin,
+      T* end,
+      bool descending,
+      std::vector<T>& scratch) {
+    auto* firstNaN = partitionNaNs(begin, end);
+    sort(begin, firstNaN, false, scratch);
+    if (descending) {
+      std::reverse(begin, end);
+    }
+  }
+
+ private:
+  template <typename T>
+  static constexpr bool kHasRadixKey =
+      (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+      std::is_floating_point_v<T>;
+
+  // Returns an unsigned integer whose order is the order of 'value'.
+  template <typename T>
+  static auto radixKey(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+      constexpr U kSign = U(1) << (sizeof(U) * 8 - 1);
+      U bits;
+      memcpy(&bits, &value, sizeof(T));
+      // Negative values order the other way around.
+      return bits & kSign ? static_cast<U>(~bits) : bits | kSign;
+    } else {
+      using U = std::make_unsigned_t<T>;
+      return static_cast<U>(
+          static_cast<U>(value) ^ (U(1) << (sizeof(U) * 8 - 1)));
+    }
+  }
+
+  template <typename T>
+  static void radixSort(T* data, size_t size, std::vector<T>& scratch) {
+    scratch.resize(size);
+    T* from = data;
+    T* to = scratch.data();
+    constexpr int32_t kNumBits = sizeof(T) * 8;
+    for (int32_t shift = 0; shift < kNumBits; shift += 8) {
+      std::array<size_t, 256> offsets{};
+      for (size_t i = 0; i < size; ++i) {
+        ++offsets[(radixKey(from[i]) >> shift) & 0xff];
+      }
+      if (offsets[(radixKey(from[0]) >> shift) & 0xff] == size) {
+        // All values have the same byte.
+        continue;
+      }
+      size_t offset = 0;
+      for (auto& count : offsets) {
+        auto next = offset + count;
+        count = offset;
+        offset = next;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        to[offsets[(radixKey(from[i]) >> shift) & 0xff]++] = from[i];
+      }
+      std::swap(from, to);
+    }
+    if (from != data) {
+      std::copy(from, from + size, data);
+    }
+  }
+};
+
+} // namespace facebook::velox::functions
@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
+
 #include "velox/expression/VectorFunction.h"
 #include "velox/type/Type.h"
 
@@ -283,6 +286,26 @@ class SubscriptImpl : public exec::VectorFunction {
     return rawOffsets[indices[row]] + index;
   }
 
+  // Minimum size of a map for building a hash index of its keys when it is
+  // looked up with more than one key in a batch.
+  static constexpr vector_size_t kMinIndexedMapSize = 16;
+
+  // Returns a map from key to offset for the 'size' keys of a map that start
+  // at 'offset' in 'keys'.
+  template <typename TKey>
+  static folly::F14FastMap<TKey, vector_size_t> makeKeyIndex(
+      const DecodedVector& keys,
+      vector_size_t offset,
+      vector_size_t size) {
+    folly::F14FastMap<TKey, vector_size_t> keyIndex;
+    keyIndex.reserve(size);
+    for (auto i = offset; i < offset + size; ++i) {
+      // Keeps the first of duplicate keys, as the scan in findKey does.
+      keyIndex.emplace(keys.valueAt<TKey>(i), i);
+    }
+    return keyIndex;
+  }
+
   /// Decode arguments and transform result into a dictionaryVector where the
   /// dictionary maintains a mapping from a given row to the index of the input
   /// map value vector. This allows us to ensure that element_at is zero-copy.
@@ -321,53 +344,84 @@ class SubscriptImpl : public exec::VectorFunction {
     auto rawSizes = baseMap->rawSizes();
     auto rawOffsets = baseMap->rawOffsets();
 
-    // Lambda that does the search for a key, for each row.
-    auto processRow = [&](vector_size_t row, TKey searchKey) {
-      size_t mapIndex = mapIndices[row];
-      size_t offsetStart = rawOffsets[mapIndex];
-      size_t offsetEnd = offsetStart + rawSizes[mapIndex];
-      bool found = false;
-
-      // Sequentially check each key on this map for a match. We use a
-      // sequential scan over the keys because it's easier to express (and
-      // likely has good memory locality), but if we find that this is slow
-      // for large maps we could try to canonicalize the whole vector and binary
-      // search `searchKey`.
-      for (size_t offset = offsetStart; offset < offsetEnd; ++offset) {
+    // Returns the offset of 'searchKey' in the base map at 'mapIndex' or -1
+    // if the map does not have 'searchKey'.
+    auto findKey = [&](vector_size_t mapIndex, TKey searchKey) {
+      auto offsetStart = rawOffsets[mapIndex];
+      auto offsetEnd = offsetStart + rawSizes[mapIndex];
+      for (auto offset = offsetStart; offset < offsetEnd; ++offset) {
         if (decodedMapKeys->valueAt<TKey>(offset) == searchKey) {
-          rawIndices[row] = offset;
-          found = true;
-          break;
+          return offset;
         }
       }
+      return -1;
+    };
 
-      // NB: We still allow non-existent map keys, even if out of bounds is
-      // disabled for arrays.
-
-      // Handle NULLs.
-      if (!found) {
+    // NB: We still allow non-existent map keys, even if out of bounds is
+    // disabled for arrays.
+    auto setResult = [&](vector_size_t row, vector_size_t offset) {
+      if (offset == -1) {
         if (!rawNulls) {
           nulls =
               AlignedBuffer::allocate<bool>(rows.size(), pool, bits::kNotNull);
           rawNulls = nulls->asMutable<uint64_t>();
         }
         bits::setNull(rawNulls, row);
-      } else if (rawNulls) {
-        bits::clearNull(rawNulls, row);
+      } else {
+        rawIndices[row] = offset;
+        if (rawNulls) {
+          bits::clearNull(rawNulls, row);
+        }
       }
     };
 
     // When second argument ("at") is a constant.
     if (decodedIndices->isConstantMapping()) {
       auto searchKey = decodedIndices->valueAt<TKey>(0);
-      rows.applyToSelected(
-          [&](vector_size_t row) { processRow(row, searchKey); });
+      if (decodedMap->isIdentityMapping()) {
+        rows.applyToSelected([&](vector_size_t row) {
+          setResult(row, findKey(row, searchKey));
+        });
+      } else {
+        // Rows that refer to the same map share the result of the scan.
+        folly::F14FastMap<vector_size_t, vector_size_t> mapOffsets;
+        rows.applyToSelected([&](vector_size_t row) {
+          auto mapIndex = mapIndices[row];
+          auto it = mapOffsets.find(mapIndex);
+          if (it == mapOffsets.end()) {
+            it = mapOffsets.emplace(mapIndex, findKey(mapIndex, searchKey))
+                     .first;
+          }
+          setResult(row, it->second);
+        });
+      }
     }
     // When the second argument ("at") is also a variable vector.
     else {
+      // Maps of at least kMinIndexedMapSize entries are scanned on the first
+      // lookup and get a hash index from key to offset on the second.
+      folly::F14FastMap<vector_size_t, folly::F14FastMap<TKey, vector_size_t>>
+          keyIndices;
+      folly::F14FastSet<vector_size_t> scannedMaps;
       rows.applyToSelected([&](vector_size_t row) {
+        auto mapIndex = mapIndices[row];
         auto searchKey = decodedIndices->valueAt<TKey>(row);
-        processRow(row, searchKey);
+        if (rawSizes[mapIndex] < kMinIndexedMapSize) {
+          setResult(row, findKey(mapIndex, searchKey));
+          return;
+        }
+        auto it = keyIndices.find(mapIndex);
+        if (it == keyIndices.end()) {
+          if (scannedMaps.insert(mapIndex).second) {
+            setResult(row, findKey(mapIndex, searchKey));
+            return;
+          }
+          auto keyIndex = makeKeyIndex<TKey>(
+              *decodedMapKeys, rawOffsets[mapIndex], rawSizes[mapIndex]);
+          it = keyIndices.emplace(mapIndex, std::move(keyIndex)).first;
+        }
+        auto entry = it->second.find(searchKey);
+        setResult(row, entry == it->second.end() ? -1 : entry->second);
       });
     }
     return BaseVector::wrapInDictionary(
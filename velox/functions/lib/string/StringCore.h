@@ -21,6 +21,10 @@
 #include "folly/CPortability.h"
 #include "velox/external/utf8proc/utf8procImpl.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #if (ENABLE_VECTORIZATION > 0) && !defined(_DEBUG) && !defined(DEBUG)
 #if defined(__clang__) && (__clang_major__ > 7)
 #define IS_SANITIZER                          \
@@ -43,11 +47,50 @@
 namespace facebook::velox::functions {
 namespace stringCore {
 
+#ifdef __AVX2__
+/// Number of bytes processed at a time by the AVX2 kernels below.
+constexpr size_t kSimdBytes = 32;
+
+FOLLY_ALWAYS_INLINE __m256i loadSimdBytes(const char* input) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+}
+
+/// Returns true if the kSimdBytes bytes at 'input' are ascii.
+FOLLY_ALWAYS_INLINE bool isAsciiSimdBytes(const char* input) {
+  return _mm256_movemask_epi8(loadSimdBytes(input)) == 0;
+}
+
+/// Writes the kSimdBytes ascii bytes at 'input' to 'output' in upper case if
+/// 'toUpper' and in lower case otherwise. Other bytes are copied as is.
+template <bool toUpper>
+FOLLY_ALWAYS_INLINE void mapAsciiCaseSimdBytes(
+    char* output,
+    const char* input) {
+  auto block = loadSimdBytes(input);
+  // Bytes above 0x7f are negative and fall outside the range.
+  auto first = _mm256_set1_epi8(toUpper ? 'a' - 1 : 'A' - 1);
+  auto last = _mm256_set1_epi8(toUpper ? 'z' + 1 : 'Z' + 1);
+  auto inRange = _mm256_and_si256(
+      _mm256_cmpgt_epi8(block, first), _mm256_cmpgt_epi8(last, block));
+  auto flip = _mm256_and_si256(inRange, _mm256_set1_epi8(0x20));
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(output), _mm256_xor_si256(block, flip));
+}
+#endif
+
 /// Check if a given string is ascii
 static bool isAscii(const char* str, size_t length);
 
 FOLLY_ALWAYS_INLINE bool isAscii(const char* str, size_t length) {
-  for (auto i = 0; i < length; i++) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + kSimdBytes <= length; i += kSimdBytes) {
+    if (!isAsciiSimdBytes(str + i)) {
+      return false;
+    }
+  }
+#endif
+  for (; i < length; i++) {
     if (str[i] & 0x80) {
       return false;
     }
@@ -87,7 +130,13 @@ reverseUnicode(char* output, const char* input, size_t length) {
 /// Perform upper for ascii string input
 FOLLY_ALWAYS_INLINE static void
 upperAscii(char* output, const char* input, size_t length) {
-  VECTORIZE_LOOP_IF_POSSIBLE for (auto i = 0; i < length; i++) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + kSimdBytes <= length; i += kSimdBytes) {
+    mapAsciiCaseSimdBytes<true>(output + i, input + i);
+  }
+#endif
+  VECTORIZE_LOOP_IF_POSSIBLE for (; i < length; i++) {
     if (input[i] >= 'a' && input[i] <= 'z') {
       output[i] = input[i] - 32;
     } else {
@@ -99,7 +148,13 @@ upperAscii(char* output, const char* input, size_t length) {
 /// Perform lower for ascii string input
 FOLLY_ALWAYS_INLINE static void
 lowerAscii(char* output, const char* input, size_t length) {
-  VECTORIZE_LOOP_IF_POSSIBLE for (auto i = 0; i < length; i++) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + kSimdBytes <= length; i += kSimdBytes) {
+    mapAsciiCaseSimdBytes<false>(output + i, input + i);
+  }
+#endif
+  VECTORIZE_LOOP_IF_POSSIBLE for (; i < length; i++) {
     if (input[i] >= 'A' && input[i] <= 'Z') {
       output[i] = input[i] + 32;
     } else {
@@ -121,6 +176,16 @@ FOLLY_ALWAYS_INLINE size_t upperUnicode(
   auto outputIdx = 0;
 
   while (inputIdx < inputLength) {
+#ifdef __AVX2__
+    // Maps runs of ascii without decoding.
+    if (inputLength - inputIdx >= kSimdBytes && !(input[inputIdx] & 0x80) &&
+        isAsciiSimdBytes(&input[inputIdx])) {
+      mapAsciiCaseSimdBytes<true>(&output[outputIdx], &input[inputIdx]);
+      inputIdx += kSimdBytes;
+      outputIdx += kSimdBytes;
+      continue;
+    }
+#endif
     utf8proc_int32_t nextCodePoint;
     int size;
     nextCodePoint = utf8proc_codepoint(&input[inputIdx], size);
@@ -160,6 +225,16 @@ FOLLY_ALWAYS_INLINE size_t lowerUnicode(
   auto outputIdx = 0;
 
   while (inputIdx < inputLength) {
+#ifdef __AVX2__
+    // Maps runs of ascii without decoding.
+    if (inputLength - inputIdx >= kSimdBytes && !(input[inputIdx] & 0x80) &&
+        isAsciiSimdBytes(&input[inputIdx])) {
+      mapAsciiCaseSimdBytes<false>(&output[outputIdx], &input[inputIdx]);
+      inputIdx += kSimdBytes;
+      outputIdx += kSimdBytes;
+      continue;
+    }
+#endif
     utf8proc_int32_t nextCodePoint;
     int size;
     nextCodePoint = utf8proc_codepoint(&input[inputIdx], size);
@@ -215,6 +290,15 @@ lengthUnicode(const char* inputBuffer, size_t bufferLength) {
   auto currentChar = inputBuffer;
   int64_t size = 0;
   while (currentChar < buffEndAddress) {
+#ifdef __AVX2__
+    // Counts runs of ascii without decoding.
+    if (buffEndAddress - currentChar >= static_cast<int64_t>(kSimdBytes) &&
+        !(*currentChar & 0x80) && isAsciiSimdBytes(currentChar)) {
+      currentChar += kSimdBytes;
+      size += kSimdBytes;
+      continue;
+    }
+#endif
     auto chrOffset = utf8proc_char_length(currentChar);
     // Skip bad byte if we get utf length < 0.
     currentChar += UNLIKELY(chrOffset < 0) ? 1 : chrOffset;
@@ -223,6 +307,41 @@ lengthUnicode(const char* inputBuffer, size_t bufferLength) {
   return size;
 }
 
+/// Returns the byte index of the first instance of 'needle' in 'haystack' at
+/// or after 'start', or std::string_view::npos if there is none. Same as
+/// std::string_view::find, but checks kSimdBytes candidate positions at a
+/// time by comparing the first and last bytes of 'needle'.
+FOLLY_ALWAYS_INLINE size_t findSubstring(
+    std::string_view haystack,
+    std::string_view needle,
+    size_t start = 0) {
+#ifdef __AVX2__
+  auto needleSize = needle.size();
+  if (needleSize > 1 && start < haystack.size()) {
+    auto data = haystack.data();
+    auto first = _mm256_set1_epi8(needle[0]);
+    auto last = _mm256_set1_epi8(needle[needleSize - 1]);
+    for (; start + needleSize - 1 + kSimdBytes <= haystack.size();
+         start += kSimdBytes) {
+      auto firstMatches = _mm256_cmpeq_epi8(first, loadSimdBytes(data + start));
+      auto lastMatches = _mm256_cmpeq_epi8(
+          last, loadSimdBytes(data + start + needleSize - 1));
+      uint32_t candidates = _mm256_movemask_epi8(
+          _mm256_and_si256(firstMatches, lastMatches));
+      while (candidates) {
+        auto index = start + __builtin_ctz(candidates);
+        // The first and last bytes are known to match.
+        if (!memcmp(data + index + 1, needle.data() + 1, needleSize - 2)) {
+          return index;
+        }
+        candidates &= candidates - 1;
+      }
+    }
+  }
+#endif
+  return haystack.find(needle, start);
+}
+
 /// Returns the start byte index of the Nth instance of subString in
 /// string. Search starts from startPosition. Positions start with 0. If not
 /// found, -1 is returned.
@@ -241,7 +360,7 @@ static int64_t findNthInstanceByteIndex(
     return -1;
   }
 
-  auto byteIndex = string.find(subString, startPosition);
+  auto byteIndex = findSubstring(string, subString, startPosition);
   // Not found
   if (byteIndex == std::string_view::npos) {
     return -1;
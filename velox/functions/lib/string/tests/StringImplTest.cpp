@@ -19,6 +19,7 @@
 #include "velox/type/StringView.h"
 
 #include <gtest/gtest.h>
+#include <cctype>
 #include <memory>
 #include <vector>
 
@@ -421,3 +422,51 @@ TEST_F(StringImplTest, getByteRange) {
     EXPECT_EQ(expectedEndByteIndex, range.second);
   }
 }
+
+TEST_F(StringImplTest, longStrings) {
+  // Strings longer than a SIMD register, with non-ascii characters and
+  // matches at all offsets within and across registers.
+  std::string ascii;
+  for (auto i = 0; i < 100; ++i) {
+    ascii += static_cast<char>(i % 2 ? 'a' + i % 26 : '@' + i % 30);
+  }
+  std::string lowerAsciiText = ascii;
+  std::string upperAsciiText = ascii;
+  for (auto i = 0; i < ascii.size(); ++i) {
+    lowerAsciiText[i] = std::tolower(ascii[i]);
+    upperAsciiText[i] = std::toupper(ascii[i]);
+  }
+  std::string lowerOutput;
+  lower</*ascii*/ true>(lowerOutput, StringView(ascii));
+  EXPECT_EQ(lowerOutput, lowerAsciiText);
+  std::string upperOutput;
+  upper</*ascii*/ true>(upperOutput, StringView(ascii));
+  EXPECT_EQ(upperOutput, upperAsciiText);
+  EXPECT_TRUE(isAscii(ascii.data(), ascii.size()));
+
+  auto mixed = ascii + "éÉ" + ascii + "信";
+  auto lowerMixed = lowerAsciiText + "éé" + lowerAsciiText + "信";
+  auto upperMixed = upperAsciiText + "ÉÉ" + upperAsciiText + "信";
+  lowerOutput.clear();
+  lower</*ascii*/ false>(lowerOutput, StringView(mixed));
+  EXPECT_EQ(lowerOutput, lowerMixed);
+  upperOutput.clear();
+  upper</*ascii*/ false>(upperOutput, StringView(mixed));
+  EXPECT_EQ(upperOutput, upperMixed);
+  EXPECT_FALSE(isAscii(mixed.data(), mixed.size()));
+  EXPECT_TRUE(isAscii(mixed.data(), ascii.size()));
+  EXPECT_EQ(length</*isAscii*/ false>(mixed), 2 * ascii.size() + 3);
+
+  for (auto needleSize = 1; needleSize < 40; ++needleSize) {
+    for (auto start = 0; start + needleSize <= mixed.size(); start += 7) {
+      auto needle = std::string_view(mixed).substr(start, needleSize);
+      for (auto from : {0, 1, 33, 150}) {
+        EXPECT_EQ(
+            findSubstring(mixed, needle, from),
+            std::string_view(mixed).find(needle, from));
+      }
+    }
+  }
+  EXPECT_EQ(findSubstring(mixed, "aé"), std::string_view::npos);
+  EXPECT_EQ(findSubstring(ascii, ""), 0u);
+}
@@ -324,5 +324,85 @@ TEST_F(Re2FunctionsTest, regexExtractConstantPatternNoGroupId) {
   EXPECT_EQ(extract("a b245 c3", "\\d+"), "245");
 }
 
+TEST_F(Re2FunctionsTest, literalPrefilter) {
+  // The constant patterns are prefiltered on their literal prefix. Checks
+  // them against the same patterns given as columns, which are not.
+  std::vector<std::string> patterns = {
+      "abc",
+      "abc*",
+      "abc?d",
+      "ab{0,2}",
+      "abc+",
+      "abc.",
+      "abc|x",
+      "ab(c|x)",
+      "ab[|]c|x",
+      "ab[]|]c|x",
+      "ab\\|c|x",
+      "a\\Q(\\E|x",
+      "(?i)abc",
+      "^abc$",
+      "",
+      "\xc3\xa9+",
+  };
+  std::vector<std::string> inputs = {
+      "",
+      "abc",
+      "abcd",
+      "xabc",
+      "ab",
+      "a",
+      "x",
+      "abdd",
+      "ABC",
+      "abx",
+      "|",
+      "\xc3\xa9\xc3\xa9"};
+  for (const auto& pattern : patterns) {
+    for (const auto& input : inputs) {
+      for (const auto& function : {"re2_match", "re2_search"}) {
+        auto expected = evaluateOnce<bool>(
+            fmt::format("{}(c0, c1)", function),
+            std::optional(input),
+            std::optional(pattern));
+        auto constant = evaluateOnce<bool>(
+            fmt::format("{}(c0, '{}')", function, pattern),
+            std::optional(input));
+        EXPECT_EQ(expected, constant) << function << " " << pattern << " "
+                                      << input;
+      }
+      auto expected = evaluateOnce<std::string>(
+          "re2_extract(c0, c1)",
+          std::optional(input),
+          std::optional(pattern));
+      auto constant = evaluateOnce<std::string>(
+          fmt::format("re2_extract(c0, '{}')", pattern),
+          std::optional(input));
+      EXPECT_EQ(expected, constant) << pattern << " " << input;
+    }
+  }
+}
+
+TEST_F(Re2FunctionsTest, patternColumn) {
+  // Many rows with a few distinct patterns use the cached compiled patterns.
+  auto data = makeRowVector({
+      makeFlatVector<StringView>(
+          1'000,
+          [](auto row) { return StringView(row % 3 ? "abc" : "xyz"); }),
+      makeFlatVector<StringView>(
+          1'000, [](auto row) { return StringView(row % 2 ? "a.c" : "^x"); }),
+  });
+  auto result = evaluate<SimpleVector<bool>>("re2_search(c0, c1)", data);
+  for (auto i = 0; i < data->size(); ++i) {
+    EXPECT_EQ(result->valueAt(i), (i % 3 != 0) == (i % 2 != 0)) << i;
+  }
+  EXPECT_THROW(
+      evaluateOnce<bool>(
+          "re2_search(c0, c1)",
+          std::optional<std::string>("a"),
+          std::optional<std::string>("*")),
+      VeloxException);
+}
+
 } // namespace
 } // namespace facebook::velox::functions
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/functions/lib/SortKernels.h"
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+
+namespace facebook::velox::functions::test {
+namespace {
+
+template <typename T>
+std::vector<T> randomValues(size_t size, folly::Random::DefaultGenerator& rng) {
+  std::vector<T> values(size);
+  for (auto& value : values) {
+    if constexpr (std::is_floating_point_v<T>) {
+      value = (folly::Random::randDouble01(rng) - 0.5) * 1e6;
+    } else {
+      value = static_cast<T>(folly::Random::rand64(rng));
+    }
+  }
+  return values;
+}
+
+template <typename T>
+void testSort() {
+  folly::Random::DefaultGenerator rng(1);
+  std::vector<T> scratch;
+  // Sizes on both sides of the radix sort threshold.
+  std::vector<size_t> sizes = {
+      0, 1, 7, 100, SortKernels::kMinRadixSortSize, 5'000};
+  for (auto size : sizes) {
+    for (bool descending : {false, true}) {
+      auto values = randomValues<T>(size, rng);
+      auto expected = values;
+      if (descending) {
+        std::sort(expected.begin(), expected.end(), std::greater<T>());
+      } else {
+        std::sort(expected.begin(), expected.end());
+      }
+      SortKernels::sort(
+          values.data(), values.data() + size, descending, scratch);
+      EXPECT_EQ(expected, values) << size << " " << descending;
+    }
+  }
+}
+
+TEST(SortKernelsTest, integers) {
+  testSort<int8_t>();
+  testSort<int16_t>();
+  testSort<int32_t>();
+  testSort<int64_t>();
+}
+
+TEST(SortKernelsTest, floatingPoint) {
+  testSort<float>();
+  testSort<double>();
+
+  // Negative values, infinities and values that differ only in the low
+  // bytes.
+  const auto kInf = std::numeric_limits<double>::infinity();
+  std::vector<double> values;
+  for (auto i = 0; i < 300; ++i) {
+    values.push_back(i % 2 ? 1.0 + i * 1e-15 : -1.0 - i * 1e-15);
+  }
+  values.push_back(kInf);
+  values.push_back(-kInf);
+  auto expected = values;
+  std::sort(expected.begin(), expected.end());
+  std::vector<double> scratch;
+  SortKernels::sort(
+      values.data(), values.data() + values.size(), false, scratch);
+  EXPECT_EQ(expected, values);
+}
+
+TEST(SortKernelsTest, nans) {
+  const auto kNaN = std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> scratch;
+  auto isNaN = [](double value) { return std::isnan(value); };
+  for (int32_t size : {10, 1'000}) {
+    std::vector<double> values;
+    for (auto i = 0; i < size; ++i) {
+      values.push_back(i % 3 ? size - i : kNaN);
+    }
+    auto numNaNs = std::count_if(values.begin(), values.end(), isNaN);
+
+    auto ascending = values;
+    SortKernels::sortWithNaNs(
+        ascending.data(), ascending.data() + size, false, scratch);
+    EXPECT_TRUE(std::is_sorted(ascending.begin(), ascending.end() - numNaNs));
+    EXPECT_TRUE(std::all_of(ascending.end() - numNaNs, ascending.end(), isNaN));
+
+    auto descending = values;
+    SortKernels::sortWithNaNs(
+        descending.data(), descending.data() + size, true, scratch);
+    EXPECT_TRUE(
+        std::all_of(descending.begin(), descending.begin() + numNaNs, isNaN));
+    EXPECT_TRUE(std::is_sorted(
+        descending.begin() + numNaNs, descending.end(), std::greater<>()));
+  }
+}
+
+} // namespace
+} // namespace facebook::velox::functions::test
@@ -14,12 +14,11 @@
  * limitations under the License.
  */
 
-#include <folly/container/F14Set.h>
-
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/Expr.h"
 #include "velox/expression/VectorFunction.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
+#include "velox/functions/lib/SetWithNull.h"
 
 namespace facebook::velox::functions {
 namespace {
@@ -77,31 +76,31 @@ class ArrayDistinctFunction : public exec::VectorFunction {
     auto* rawSizes = newLengths->asMutable<vector_size_t>();
     auto* rawOffsets = newOffsets->asMutable<vector_size_t>();
 
-    // Process the rows: store unique values in the hash table.
-    folly::F14FastSet<T> uniqueSet;
+    // Process the rows: store unique values in the set, which is reused for
+    // all rows.
+    SetWithNull<T> uniqueSet;
 
     rows.applyToSelected([&](vector_size_t row) {
       auto size = arrayVector->sizeAt(row);
       auto offset = arrayVector->offsetAt(row);
 
       *rawOffsets = indicesCursor;
-      bool hasNulls = false;
       for (vector_size_t i = offset; i < offset + size; ++i) {
         if (elements->isNullAt(i)) {
-          if (!hasNulls) {
-            hasNulls = true;
+          if (!uniqueSet.hasNull) {
+            uniqueSet.hasNull = true;
             rawNewIndices[indicesCursor++] = i;
           }
         } else {
           auto value = elements->valueAt<T>(i);
 
-          if (uniqueSet.insert(value).second) {
+          if (uniqueSet.insert(value)) {
             rawNewIndices[indicesCursor++] = i;
           }
         }
       }
 
-      uniqueSet.clear();
+      uniqueSet.reset();
       *rawSizes = indicesCursor - *rawOffsets;
       ++rawSizes;
       ++rawOffsets;
@@ -16,27 +16,11 @@
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/VectorFunction.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
+#include "velox/functions/lib/SetWithNull.h"
 
 namespace facebook::velox::functions {
 namespace {
 
-template <typename T>
-struct SetWithNull {
-  SetWithNull(vector_size_t initialSetSize = kInitialSetSize) {
-    set.reserve(initialSetSize);
-  }
-
-  void reset() {
-    set.clear();
-    hasNull = false;
-  }
-
-  std::unordered_set<T> set;
-  bool hasNull{false};
-
-  static constexpr vector_size_t kInitialSetSize{128};
-};
-
 // Generates a set based on the elements of an ArrayVector. Note that we take
 // rightSet as a parameter (instead of returning a new one) to reuse the
 // allocated memory.
@@ -57,9 +41,9 @@ void generateSet(
       // Function can be called with either FlatVector or DecodedVector, but
       // their APIs are slightly different.
       if constexpr (std::is_same_v<TVector, DecodedVector>) {
-        rightSet.set.insert(arrayElements->template valueAt<T>(i));
+        rightSet.insert(arrayElements->template valueAt<T>(i));
       } else {
-        rightSet.set.insert(arrayElements->valueAt(i));
+        rightSet.insert(arrayElements->valueAt(i));
       }
     }
   }
@@ -200,13 +184,12 @@ class ArrayIntersectExceptFunction : public exec::VectorFunction {
           // (check outputSet).
           bool addValue = false;
           if constexpr (isIntersect) {
-            addValue = rightSet.set.count(val) > 0;
+            addValue = rightSet.contains(val);
           } else {
-            addValue = rightSet.set.count(val) == 0;
+            addValue = !rightSet.contains(val);
           }
           if (addValue) {
-            auto it = outputSet.set.insert(val);
-            if (it.second) {
+            if (outputSet.insert(val)) {
               rawNewIndices[indicesCursor++] = i;
             }
           }
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/expression/EvalCtx.h"
+#include "velox/expression/VectorFunction.h"
+#include "velox/functions/lib/LambdaFunctionUtil.h"
+#include "velox/functions/lib/SetWithNull.h"
+
+namespace facebook::velox::functions {
+namespace {
+
+// An array argument decoded together with its elements.
+struct DecodedArray {
+  DecodedArray(
+      exec::EvalCtx* context,
+      const BaseVector& vector,
+      const SelectivityVector& rows)
+      : arrayHolder(context, vector, rows),
+        array(arrayHolder.get()),
+        baseArray(array->base()->as<ArrayVector>()),
+        elementsHolder(
+            context,
+            *baseArray->elements(),
+            toElementRows(
+                baseArray->elements()->size(),
+                rows,
+                baseArray,
+                array->indices())),
+        elements(elementsHolder.get()) {}
+
+  exec::LocalDecodedVector arrayHolder;
+  DecodedVector* array;
+  ArrayVector* baseArray;
+  exec::LocalDecodedVector elementsHolder;
+  DecodedVector* elements;
+};
+
+// See documentation at https://prestodb.io/docs/current/functions/array.html
+template <typename T>
+class ArrayUnionFunction : public exec::VectorFunction {
+ public:
+  /// array_union(x, y) returns the distinct elements of x followed by the
+  /// distinct elements of y that are not in x. A set of the elements added
+  /// to the output row is reused for all rows. The elements come from two
+  /// vectors, so unlike array_intersect, the result copies them into a new
+  /// elements vector. Strings are not copied: the result refers to the
+  /// string buffers of the inputs.
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      exec::Expr* caller,
+      exec::EvalCtx* context,
+      VectorPtr* result) const override {
+    memory::MemoryPool* pool = context->pool();
+    DecodedArray left(context, *args[0], rows);
+    DecodedArray right(context, *args[1], rows);
+
+    auto elementsCount = countElements<ArrayVector>(rows, *left.array) +
+        countElements<ArrayVector>(rows, *right.array);
+    auto elementType = caller->type()->childAt(0);
+    auto newElements = BaseVector::create(elementType, elementsCount, pool);
+    auto flatElements = newElements->asFlatVector<T>();
+    if constexpr (std::is_same_v<T, StringView>) {
+      flatElements->acquireSharedStringBuffers(
+          left.baseArray->elements().get());
+      flatElements->acquireSharedStringBuffers(
+          right.baseArray->elements().get());
+    }
+
+    // Offsets and sizes are 0 for the rows that are not selected.
+    BufferPtr newOffsets =
+        AlignedBuffer::allocate<vector_size_t>(rows.size(), pool, 0);
+    BufferPtr newLengths =
+        AlignedBuffer::allocate<vector_size_t>(rows.size(), pool, 0);
+    auto rawNewOffsets = newOffsets->asMutable<vector_size_t>();
+    auto rawNewLengths = newLengths->asMutable<vector_size_t>();
+
+    vector_size_t elementsCursor = 0;
+    SetWithNull<T> outputSet;
+    auto addElements = [&](const DecodedArray& input, vector_size_t row) {
+      auto idx = input.array->index(row);
+      auto size = input.baseArray->sizeAt(idx);
+      auto offset = input.baseArray->offsetAt(idx);
+      for (vector_size_t i = offset; i < offset + size; ++i) {
+        if (input.elements->isNullAt(i)) {
+          if (!outputSet.hasNull) {
+            outputSet.hasNull = true;
+            flatElements->setNull(elementsCursor++, true);
+          }
+          continue;
+        }
+        auto value = input.elements->valueAt<T>(i);
+        if (outputSet.insert(value)) {
+          if constexpr (std::is_same_v<T, StringView>) {
+            flatElements->setNoCopy(elementsCursor++, value);
+          } else {
+            flatElements->set(elementsCursor++, value);
+          }
+        }
+      }
+    };
+
+    rows.applyToSelected([&](vector_size_t row) {
+      outputSet.reset();
+      rawNewOffsets[row] = elementsCursor;
+      addElements(left, row);
+      addElements(right, row);
+      rawNewLengths[row] = elementsCursor - rawNewOffsets[row];
+    });
+    newElements->resize(elementsCursor);
+
+    auto resultArray = std::make_shared<ArrayVector>(
+        pool,
+        caller->type(),
+        BufferPtr(nullptr),
+        rows.size(),
+        newOffsets,
+        newLengths,
+        newElements,
+        0);
+    context->moveOrCopyResult(resultArray, rows, result);
+  }
+};
+
+void validateType(const std::vector<exec::VectorFunctionArg>& inputArgs) {
+  VELOX_USER_CHECK_EQ(
+      inputArgs.size(), 2, "array_union requires exactly two parameters");
+
+  auto arrayType = inputArgs.front().type;
+  VELOX_USER_CHECK_EQ(
+      arrayType->kind(),
+      TypeKind::ARRAY,
+      "array_union requires arguments of type ARRAY");
+
+  for (auto& arg : inputArgs) {
+    VELOX_USER_CHECK(
+        arrayType->kindEquals(arg.type),
+        "array_union function requires all arguments of the same type: {} vs. {}",
+        arg.type->toString(),
+        arrayType->toString());
+  }
+}
+
+template <TypeKind kind>
+std::shared_ptr<exec::VectorFunction> createTyped(
+    const std::vector<exec::VectorFunctionArg>& inputArgs) {
+  VELOX_CHECK_EQ(inputArgs.size(), 2);
+  using T = typename TypeTraits<kind>::NativeType;
+  return std::make_shared<ArrayUnionFunction<T>>();
+}
+
+std::shared_ptr<exec::VectorFunction> create(
+    const std::string& /* name */,
+    const std::vector<exec::VectorFunctionArg>& inputArgs) {
+  validateType(inputArgs);
+  auto elementType = inputArgs.front().type->childAt(0);
+
+  return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+      createTyped, elementType->kind(), inputArgs);
+}
+
+std::vector<std::shared_ptr<exec::FunctionSignature>> signatures() {
+  // array(T), array(T) -> array(T)
+  return {exec::FunctionSignatureBuilder()
+              .typeVariable("T")
+              .returnType("array(T)")
+              .argumentType("array(T)")
+              .argumentType("array(T)")
+              .build()};
+}
+
+} // namespace
+
+VELOX_DECLARE_STATEFUL_VECTOR_FUNCTION(
+    udf_array_union,
+    signatures(),
+    create);
+
+} // namespace facebook::velox::functions
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/expression/Expr.h"
+#include "velox/expression/VectorFunction.h"
+#include "velox/type/TimestampConversion.h"
+#include "velox/type/tz/TimeZoneOffsets.h"
+
+namespace facebook::velox::functions {
+namespace {
+
+constexpr int64_t kSecondsInMinute = 60;
+constexpr int64_t kSecondsInHour = 60 * kSecondsInMinute;
+constexpr int64_t kSecondsInDay = 24 * kSecondsInHour;
+
+enum class DateTimeField { kYear, kMonth, kDay, kHour, kMinute, kSecond };
+
+template <DateTimeField kField>
+FOLLY_ALWAYS_INLINE int64_t extractField(int64_t localSeconds) {
+  auto days = localSeconds / kSecondsInDay;
+  auto secondOfDay = localSeconds % kSecondsInDay;
+  if (secondOfDay < 0) {
+    --days;
+    secondOfDay += kSecondsInDay;
+  }
+  if constexpr (kField == DateTimeField::kHour) {
+    return secondOfDay / kSecondsInHour;
+  } else if constexpr (kField == DateTimeField::kMinute) {
+    return (secondOfDay % kSecondsInHour) / kSecondsInMinute;
+  } else if constexpr (kField == DateTimeField::kSecond) {
+    return secondOfDay % kSecondsInMinute;
+  } else {
+    int32_t year;
+    int32_t month;
+    int32_t day;
+    util::toDate(days, year, month, day);
+    if constexpr (kField == DateTimeField::kYear) {
+      return year;
+    } else if constexpr (kField == DateTimeField::kMonth) {
+      return month;
+    } else {
+      return day;
+    }
+  }
+}
+
+// Returns the offsets of the session time zone if timestamps are to be
+// adjusted to it, nullptr for UTC.
+const util::TimeZoneOffsets* sessionTimeZone(exec::EvalCtx* context) {
+  const auto& queryCtx = context->execCtx()->queryCtx();
+  if (!queryCtx->adjustTimestampToTimezone()) {
+    return nullptr;
+  }
+  auto sessionTzName = queryCtx->sessionTimezone();
+  if (sessionTzName.empty()) {
+    return nullptr;
+  }
+  return &util::TimeZoneOffsets::get(sessionTzName);
+}
+
+/// year, month, day, hour, minute and second of a timestamp, in the session
+/// time zone if the session asks to adjust timestamps to it. The fields are
+/// computed with integer arithmetic from the local time. The rows of a
+/// batch usually have the same offset to UTC, which is then looked up once.
+template <DateTimeField kField>
+class ExtractDateTimeFunction : public exec::VectorFunction {
+ public:
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      exec::Expr* /* caller */,
+      exec::EvalCtx* context,
+      VectorPtr* result) const override {
+    exec::LocalDecodedVector decodedHolder(context, *args[0], rows);
+    auto decoded = decodedHolder.get();
+    auto timestamps = decoded->data<Timestamp>();
+    auto secondsAt = [&](vector_size_t row) {
+      return timestamps[decoded->index(row)].getSeconds();
+    };
+
+    BaseVector::ensureWritable(rows, BIGINT(), context->pool(), result);
+    auto rawResults = (*result)->asFlatVector<int64_t>()->mutableRawValues();
+
+    auto* timeZone = sessionTimeZone(context);
+    int32_t offset = 0;
+    if (timeZone) {
+      int64_t minSeconds = std::numeric_limits<int64_t>::max();
+      int64_t maxSeconds = std::numeric_limits<int64_t>::min();
+      rows.applyToSelected([&](auto row) {
+        minSeconds = std::min(minSeconds, secondsAt(row));
+        maxSeconds = std::max(maxSeconds, secondsAt(row));
+      });
+      if (!timeZone->commonOffset(minSeconds, maxSeconds, offset)) {
+        rows.applyToSelected([&](auto row) {
+          auto seconds = secondsAt(row);
+          rawResults[row] =
+              extractField<kField>(seconds + timeZone->offsetAt(seconds));
+        });
+        return;
+      }
+    }
+    rows.applyToSelected([&](auto row) {
+      rawResults[row] = extractField<kField>(secondsAt(row) + offset);
+    });
+  }
+
+  static std::vector<std::shared_ptr<exec::FunctionSignature>> signatures() {
+    // timestamp -> bigint
+    return {exec::FunctionSignatureBuilder()
+                .returnType("bigint")
+                .argumentType("timestamp")
+                .build()};
+  }
+};
+} // namespace
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_year,
+    ExtractDateTimeFunction<DateTimeField::kYear>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kYear>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_month,
+    ExtractDateTimeFunction<DateTimeField::kMonth>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kMonth>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_day,
+    ExtractDateTimeFunction<DateTimeField::kDay>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kDay>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_hour,
+    ExtractDateTimeFunction<DateTimeField::kHour>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kHour>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_minute,
+    ExtractDateTimeFunction<DateTimeField::kMinute>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kMinute>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_second,
+    ExtractDateTimeFunction<DateTimeField::kSecond>::signatures(),
+    std::make_unique<ExtractDateTimeFunction<DateTimeField::kSecond>>());
+
+} // namespace facebook::velox::functions
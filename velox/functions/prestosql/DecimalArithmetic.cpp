@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/expression/VectorFunction.h"
+#include "velox/type/DecimalType.h"
+#include "velox/type/DecimalUtil.h"
+
+namespace facebook::velox::functions {
+namespace {
+
+// Scale of the result of an addition or subtraction and the factors that
+// bring the arguments to it.
+struct AddScales {
+  AddScales(const ShortDecimalType& a, const ShortDecimalType& b)
+      : scale(std::max(a.scale(), b.scale())),
+        precision(std::min(
+            ShortDecimalType::kMaxPrecision,
+            std::max(a.precision() - a.scale(), b.precision() - b.scale()) +
+                scale + 1)),
+        aFactor(util::kPowersOfTen[scale - a.scale()]),
+        bFactor(util::kPowersOfTen[scale - b.scale()]) {}
+
+  const int scale;
+  const int precision;
+  const int64_t aFactor;
+  const int64_t bFactor;
+};
+
+struct DecimalAdd {
+  using Scales = AddScales;
+
+  // Sets 'result' to a + b at the result scale. Returns true on overflow.
+  static bool apply(const Scales& scales, int64_t a, int64_t b, int64_t& r) {
+    int64_t aScaled;
+    int64_t bScaled;
+    return __builtin_mul_overflow(a, scales.aFactor, &aScaled) |
+        __builtin_mul_overflow(b, scales.bFactor, &bScaled) |
+        __builtin_add_overflow(aScaled, bScaled, &r);
+  }
+};
+
+struct DecimalSubtract {
+  using Scales = AddScales;
+
+  static bool apply(const Scales& scales, int64_t a, int64_t b, int64_t& r) {
+    int64_t aScaled;
+    int64_t bScaled;
+    return __builtin_mul_overflow(a, scales.aFactor, &aScaled) |
+        __builtin_mul_overflow(b, scales.bFactor, &bScaled) |
+        __builtin_sub_overflow(aScaled, bScaled, &r);
+  }
+};
+
+struct MultiplyScales {
+  MultiplyScales(const ShortDecimalType& a, const ShortDecimalType& b)
+      : scale(a.scale() + b.scale()),
+        precision(std::min(
+            ShortDecimalType::kMaxPrecision, a.precision() + b.precision())) {
+    VELOX_USER_CHECK_LE(
+        scale,
+        ShortDecimalType::kMaxPrecision,
+        "DECIMAL multiplication result scale is too large");
+  }
+
+  const int scale;
+  const int precision;
+};
+
+struct DecimalMultiply {
+  using Scales = MultiplyScales;
+
+  static bool apply(const Scales& scales, int64_t a, int64_t b, int64_t& r) {
+    return __builtin_mul_overflow(a, b, &r);
+  }
+};
+
+/// Arithmetic on DECIMAL arguments of up to 18 digits. The arguments may
+/// have different scales. The result has the scale and precision of the
+/// Presto rules capped at 18 digits. Results with more digits are errors.
+template <typename Operation>
+class DecimalArithmeticFunction : public exec::VectorFunction {
+ public:
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      exec::Expr* /* caller */,
+      exec::EvalCtx* context,
+      VectorPtr* result) const override {
+    VELOX_CHECK_EQ(args.size(), 2);
+    auto aType = asShortDecimal(args[0]->type());
+    auto bType = asShortDecimal(args[1]->type());
+    VELOX_USER_CHECK(
+        aType && bType,
+        "Decimal arithmetic requires DECIMAL arguments: {}, {}",
+        args[0]->type()->toString(),
+        args[1]->type()->toString());
+    typename Operation::Scales scales(*aType, *bType);
+    const auto max = util::maxUnscaledDecimal(scales.precision);
+
+    BaseVector::ensureWritable(
+        rows,
+        DECIMAL(scales.precision, scales.scale),
+        context->pool(),
+        result);
+    auto rawResults = (*result)->asFlatVector<int64_t>()->mutableRawValues();
+
+    exec::LocalDecodedVector a(context, *args[0], rows);
+    exec::LocalDecodedVector b(context, *args[1], rows);
+
+    // The loops only compute values and an overflow flag, so that these
+    // stay free of branches. Rows that overflow are found in a second pass.
+    auto isOverflow = [&](int64_t x, int64_t y, int64_t& r) {
+      return Operation::apply(scales, x, y, r) | (r > max) | (r < -max);
+    };
+    bool anyOverflow = false;
+    if (a->isIdentityMapping() && b->isIdentityMapping() &&
+        rows.isAllSelected()) {
+      auto rawA = a->data<int64_t>();
+      auto rawB = b->data<int64_t>();
+      for (auto row = 0; row < rows.size(); ++row) {
+        anyOverflow |= isOverflow(rawA[row], rawB[row], rawResults[row]);
+      }
+    } else if (a->isIdentityMapping() && b->isConstantMapping()) {
+      auto rawA = a->data<int64_t>();
+      auto constant = b->valueAt<int64_t>(0);
+      rows.applyToSelected([&](vector_size_t row) {
+        anyOverflow |= isOverflow(rawA[row], constant, rawResults[row]);
+      });
+    } else {
+      rows.applyToSelected([&](vector_size_t row) {
+        anyOverflow |= isOverflow(
+            a->valueAt<int64_t>(row),
+            b->valueAt<int64_t>(row),
+            rawResults[row]);
+      });
+    }
+
+    if (anyOverflow) {
+      rows.applyToSelected([&](vector_size_t row) {
+        int64_t r;
+        if (isOverflow(
+                a->valueAt<int64_t>(row), b->valueAt<int64_t>(row), r)) {
+          context->setError(
+              row,
+              std::make_exception_ptr(std::overflow_error(fmt::format(
+                  "Decimal overflow: result does not fit in DECIMAL({},{})",
+                  scales.precision,
+                  scales.scale))));
+        }
+      });
+    }
+  }
+
+  static std::vector<std::shared_ptr<exec::FunctionSignature>> signatures() {
+    // Decimals are BIGINT in signatures. apply() checks that the arguments
+    // are decimals.
+    return {exec::FunctionSignatureBuilder()
+                .returnType("bigint")
+                .argumentType("bigint")
+                .argumentType("bigint")
+                .build()};
+  }
+};
+
+} // namespace
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_decimal_add,
+    DecimalArithmeticFunction<DecimalAdd>::signatures(),
+    std::make_unique<DecimalArithmeticFunction<DecimalAdd>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_decimal_subtract,
+    DecimalArithmeticFunction<DecimalSubtract>::signatures(),
+    std::make_unique<DecimalArithmeticFunction<DecimalSubtract>>());
+
+VELOX_DECLARE_VECTOR_FUNCTION(
+    udf_decimal_multiply,
+    DecimalArithmeticFunction<DecimalMultiply>::signatures(),
+    std::make_unique<DecimalArithmeticFunction<DecimalMultiply>>());
+
+} // namespace facebook::velox::functions
@@ -15,6 +15,7 @@
  */
 #include "velox/expression/VectorFunction.h"
 #include "velox/type/Filter.h"
+#include "velox/type/StringViewSimd.h"
 
 namespace facebook::velox::functions {
 namespace {
@@ -105,7 +106,12 @@ std::unique_ptr<common::Filter> createBytesValuesFilter(
 class InPredicate : public exec::VectorFunction {
  public:
   explicit InPredicate(std::unique_ptr<common::Filter> filter)
-      : filter_{std::move(filter)} {}
+      : filter_{std::move(filter)} {
+    auto range = dynamic_cast<const common::BytesRange*>(filter_.get());
+    if (range && range->isSingleValue()) {
+      singleString_ = StringView(range->lower());
+    }
+  }
 
   static std::shared_ptr<InPredicate> create(
       const std::string& /*name*/,
@@ -262,6 +268,20 @@ class InPredicate : public exec::VectorFunction {
         }
       });
     } else {
+      if constexpr (
+          std::is_same_v<T, int64_t> || std::is_same_v<T, int32_t>) {
+        if (decoder->isIdentityMapping()) {
+          applySimd<T>(rows, decoder->data<T>(), rawValues, testFunction);
+          return;
+        }
+      }
+      if constexpr (std::is_same_v<T, StringView>) {
+        if (decoder->isIdentityMapping() && singleString_.has_value()) {
+          applyEqualStrings(
+              rows, decoder->data<StringView>(), rawValues, testFunction);
+          return;
+        }
+      }
       rows.applyToSelected([&](auto row) {
         bool pass = testFunction(decoder->valueAt<T>(row));
         bits::setBit(rawValues, row, pass);
@@ -269,7 +289,86 @@ class InPredicate : public exec::VectorFunction {
     }
   }
 
+  // Tests a flat input without nulls one SIMD vector at a time with the
+  // batch tests of 'filter_' and sets the results of the selected rows.
+  // Words of 'rows' that are only partially in range use 'testFunction' so
+  // that no values out of range are read.
+  template <typename T, typename F>
+  void applySimd(
+      const SelectivityVector& rows,
+      const T* values,
+      uint64_t* rawResult,
+      F testFunction) const {
+    using V = simd::Vectors<T>;
+    const auto* selected = rows.asRange().bits();
+    bits::forEachWord(
+        rows.begin(),
+        rows.end(),
+        [&](int32_t index, uint64_t mask) {
+          mask &= selected[index];
+          while (mask) {
+            auto row = index * 64 + __builtin_ctzll(mask);
+            bits::setBit(rawResult, row, testFunction(values[row]));
+            mask &= mask - 1;
+          }
+        },
+        [&](int32_t index) {
+          auto mask = selected[index];
+          if (!mask) {
+            return;
+          }
+          const auto* start = values + index * 64;
+          uint64_t word = 0;
+          for (auto i = 0; i < 64; i += V::VSize) {
+            __m256i result;
+            if constexpr (sizeof(T) == 8) {
+              result = filter_->test4x64(V::load(start + i));
+            } else {
+              result = reinterpret_cast<__m256i>(filter_->test8x32(
+                  reinterpret_cast<__m256i>(V::load(start + i))));
+            }
+            uint64_t lanes = V::compareBitMask(V::compareResult(result));
+            word |= lanes << i;
+          }
+          rawResult[index] = (rawResult[index] & ~mask) | (word & mask);
+        });
+  }
+
+  // Compares a flat input without nulls to the single value of the
+  // IN list 64 rows at a time. See applySimd.
+  template <typename F>
+  void applyEqualStrings(
+      const SelectivityVector& rows,
+      const StringView* values,
+      uint64_t* rawResult,
+      F testFunction) const {
+    const auto* selected = rows.asRange().bits();
+    bits::forEachWord(
+        rows.begin(),
+        rows.end(),
+        [&](int32_t index, uint64_t mask) {
+          mask &= selected[index];
+          while (mask) {
+            auto row = index * 64 + __builtin_ctzll(mask);
+            bits::setBit(rawResult, row, testFunction(values[row]));
+            mask &= mask - 1;
+          }
+        },
+        [&](int32_t index) {
+          auto mask = selected[index];
+          if (!mask) {
+            return;
+          }
+          uint64_t word = 0;
+          simd::stringViewsEqual(
+              values + index * 64, singleString_.value(), 0, 64, &word);
+          rawResult[index] = (rawResult[index] & ~mask) | (word & mask);
+        });
+  }
+
   const std::unique_ptr<common::Filter> filter_;
+  // The value of a single value VARCHAR IN list. Points into 'filter_'.
+  std::optional<StringView> singleString_;
 };
 } // namespace
 
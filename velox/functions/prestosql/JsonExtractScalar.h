@@ -24,20 +24,27 @@ namespace facebook::velox::functions {
 // to being encoded as JSON). The value referenced by json_path must be a scalar
 // (boolean, number or string)
 VELOX_UDF_BEGIN(json_extract_scalar)
+// Scalars found in the text of the document are returned without copying.
+static constexpr int32_t reuse_strings_from_arg = 0;
+
 FOLLY_ALWAYS_INLINE bool call(
     out_type<Varchar>& result,
     const arg_type<Varchar>& json,
     const arg_type<Varchar>& jsonPath) {
   const folly::StringPiece& jsonStringPiece = json;
   const folly::StringPiece& jsonPathStringPiece = jsonPath;
-  auto extractResult = jsonExtractScalar(jsonStringPiece, jsonPathStringPiece);
-  if (extractResult.hasValue()) {
-    UDFOutputString::assign(result, *extractResult);
-    return true;
-
-  } else {
+  folly::StringPiece scalar;
+  std::string buffer;
+  if (!jsonExtractScalar(
+          jsonStringPiece, jsonPathStringPiece, scalar, buffer)) {
     return false;
   }
+  if (scalar.data() == buffer.data()) {
+    UDFOutputString::assign(result, buffer);
+  } else {
+    result.setNoCopy(std::string_view(scalar.data(), scalar.size()));
+  }
+  return true;
 }
 
 VELOX_UDF_END();
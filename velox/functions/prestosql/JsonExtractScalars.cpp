@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/expression/EvalCtx.h"
+#include "velox/expression/Expr.h"
+#include "velox/expression/VectorFunction.h"
+#include "velox/functions/prestosql/json/JsonExtractor.h"
+
+namespace facebook::velox::functions {
+namespace {
+
+// json_extract_scalars(json, array(json_path)) -> array(varchar)
+// Returns an array with the result of json_extract_scalar() for each of the
+// constant paths. Each document is scanned or parsed once for all the paths.
+// Sibling json_extract_scalar() calls on the same document can be written
+// as subscripts of one json_extract_scalars(), which is evaluated once.
+class JsonExtractScalarsFunction : public exec::VectorFunction {
+ public:
+  explicit JsonExtractScalarsFunction(
+      std::vector<std::unique_ptr<JsonExtractor>> extractors)
+      : extractors_(std::move(extractors)) {
+    for (auto& extractor : extractors_) {
+      rawExtractors_.push_back(extractor.get());
+    }
+  }
+
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      exec::Expr* /* caller */,
+      exec::EvalCtx* context,
+      VectorPtr* result) const override {
+    exec::LocalDecodedVector jsonHolder(context, *args[0], rows);
+    auto* jsons = jsonHolder.get();
+    auto* pool = context->pool();
+    vector_size_t numPaths = extractors_.size();
+
+    // The arrays of the selected rows are consecutive in 'elements' and the
+    // other rows get empty arrays.
+    auto elements = std::dynamic_pointer_cast<FlatVector<StringView>>(
+        BaseVector::create(VARCHAR(), rows.countSelected() * numPaths, pool));
+    auto offsets = AlignedBuffer::allocate<vector_size_t>(rows.size(), pool, 0);
+    auto sizes = AlignedBuffer::allocate<vector_size_t>(rows.size(), pool, 0);
+    auto rawOffsets = offsets->asMutable<vector_size_t>();
+    auto rawSizes = sizes->asMutable<vector_size_t>();
+
+    auto setNull = [&](vector_size_t index) {
+      elements->setNoCopy(index, StringView());
+      elements->setNull(index, true);
+    };
+    auto extractors = folly::range(rawExtractors_);
+    auto* scalars = context->arena().allocate<folly::StringPiece>(numPaths);
+    vector_size_t offset = 0;
+    rows.applyToSelected([&](vector_size_t row) {
+      rawOffsets[row] = offset;
+      rawSizes[row] = numPaths;
+      folly::StringPiece json(jsons->valueAt<StringView>(row));
+      uint64_t found;
+      auto scanResult = JsonExtractor::extractScalars(
+          json, extractors, scalars, found);
+      if (scanResult != JsonExtractor::ScanResult::kUnknown) {
+        // The results are in the input strings.
+        for (auto i = 0; i < numPaths; ++i) {
+          if (found & (1ULL << i)) {
+            elements->setNoCopy(
+                offset + i, StringView(scalars[i].data(), scalars[i].size()));
+          } else {
+            setNull(offset + i);
+          }
+        }
+      } else {
+        auto values = jsonExtractScalars(json, extractors);
+        for (auto i = 0; i < numPaths; ++i) {
+          if (values[i].hasValue()) {
+            elements->set(offset + i, StringView(*values[i]));
+          } else {
+            setNull(offset + i);
+          }
+        }
+      }
+      offset += numPaths;
+    });
+    elements->acquireSharedStringBuffers(args[0].get());
+
+    auto arrays = std::make_shared<ArrayVector>(
+        pool,
+        ARRAY(VARCHAR()),
+        nullptr,
+        rows.size(),
+        std::move(offsets),
+        std::move(sizes),
+        std::move(elements),
+        0);
+    context->moveOrCopyResult(arrays, rows, result);
+  }
+
+ private:
+  const std::vector<std::unique_ptr<JsonExtractor>> extractors_;
+  std::vector<const JsonExtractor*> rawExtractors_;
+};
+
+std::shared_ptr<exec::VectorFunction> create(
+    const std::string& name,
+    const std::vector<exec::VectorFunctionArg>& inputArgs) {
+  VELOX_CHECK_EQ(inputArgs.size(), 2);
+  auto* paths = inputArgs[1].constantValue.get();
+  VELOX_USER_CHECK(
+      paths != nullptr && !paths->isNullAt(0),
+      "{} requires a constant array of paths",
+      name);
+  auto* pathArrays = paths->wrappedVector()->as<ArrayVector>();
+  auto pathIndex = paths->wrappedIndex(0);
+  auto offset = pathArrays->offsetAt(pathIndex);
+  auto size = pathArrays->sizeAt(pathIndex);
+  VELOX_USER_CHECK_LE(
+      size,
+      JsonExtractor::kMaxScanPaths,
+      "{} supports up to {} paths",
+      name,
+      JsonExtractor::kMaxScanPaths);
+  auto* pathElements = pathArrays->elements()->as<SimpleVector<StringView>>();
+
+  std::vector<std::unique_ptr<JsonExtractor>> extractors;
+  for (auto i = offset; i < offset + size; ++i) {
+    VELOX_USER_CHECK(!pathElements->isNullAt(i), "JSON path cannot be null");
+    auto path = folly::trimWhitespace(
+        folly::StringPiece(pathElements->valueAt(i)));
+    auto extractor = std::make_unique<JsonExtractor>(path.str());
+    VELOX_USER_CHECK(extractor->isValid(), "Invalid JSON path: {}", path);
+    extractors.push_back(std::move(extractor));
+  }
+  return std::make_shared<JsonExtractScalarsFunction>(std::move(extractors));
+}
+
+std::vector<std::shared_ptr<exec::FunctionSignature>> signatures() {
+  // varchar, array(varchar) -> array(varchar)
+  return {exec::FunctionSignatureBuilder()
+              .returnType("array(varchar)")
+              .argumentType("varchar")
+              .argumentType("array(varchar)")
+              .build()};
+}
+
+} // namespace
+
+VELOX_DECLARE_STATEFUL_VECTOR_FUNCTION(
+    udf_json_extract_scalars,
+    signatures(),
+    create);
+
+} // namespace facebook::velox::functions
@@ -15,10 +15,44 @@
  */
 #include "velox/expression/Expr.h"
 #include "velox/expression/VectorFunction.h"
+#include "velox/functions/lib/SetWithNull.h"
 
 namespace facebook::velox::functions {
 namespace {
 
+// Marks as not valid in 'uniqueKeys' the entries of the maps of 'rows' whose
+// key comes again later in the same map, so that the value from the last
+// argument wins, and updates 'rawOffsets' and 'rawSizes' for the entries
+// that remain. Uses a set of the keys seen, which is reused for all rows.
+// 'keys' is flat. Returns the number of entries removed.
+template <TypeKind kKind>
+vector_size_t removeDuplicateKeys(
+    const SelectivityVector& rows,
+    const BaseVector& keys,
+    vector_size_t* rawOffsets,
+    vector_size_t* rawSizes,
+    SelectivityVector& uniqueKeys) {
+  using T = typename TypeTraits<kKind>::NativeType;
+  auto flatKeys = keys.asUnchecked<FlatVector<T>>();
+  SetWithNull<T> keysSeen;
+  vector_size_t duplicateCnt = 0;
+  rows.applyToSelected([&](vector_size_t row) {
+    auto mapOffset = rawOffsets[row];
+    auto mapSize = rawSizes[row];
+    rawOffsets[row] -= duplicateCnt;
+    keysSeen.reset();
+    for (auto i = mapSize - 1; i >= 0; --i) {
+      if (!keysSeen.insert(flatKeys->valueAt(mapOffset + i))) {
+        duplicateCnt++;
+        // "remove" duplicate entry
+        uniqueKeys.setValid(mapOffset + i, false);
+        rawSizes[row]--;
+      }
+    }
+  });
+  return duplicateCnt;
+}
+
 // See documentation at https://prestodb.io/docs/current/functions/map.html
 class MapConcatFunction : public exec::VectorFunction {
  public:
@@ -93,30 +127,42 @@ class MapConcatFunction : public exec::VectorFunction {
         combinedKeys,
         combinedValues);
 
-    combinedMap->canonicalize(true);
-
-    combinedKeys = combinedMap->mapKeys();
-    combinedValues = combinedMap->mapValues();
-
     // Check for duplicate keys
     SelectivityVector uniqueKeys(offset);
     vector_size_t duplicateCnt = 0;
-    rows.applyToSelected([&](vector_size_t row) {
-      auto mapOffset = rawOffsets[row];
-      auto mapSize = rawSizes[row];
-      if (duplicateCnt) {
-        rawOffsets[row] -= duplicateCnt;
-      }
-      for (vector_size_t i = 1; i < mapSize; i++) {
-        if (combinedKeys->equalValueAt(
-                combinedKeys.get(), mapOffset + i, mapOffset + i - 1)) {
-          duplicateCnt++;
-          // "remove" duplicate entry
-          uniqueKeys.setValid(mapOffset + i - 1, false);
-          rawSizes[row]--;
+    if (keyType->isPrimitiveType()) {
+      duplicateCnt = VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+          removeDuplicateKeys,
+          keyType->kind(),
+          rows,
+          *combinedKeys,
+          rawOffsets,
+          rawSizes,
+          uniqueKeys);
+    } else {
+      // Sorts the keys so that duplicates are next to each other.
+      combinedMap->canonicalize(true);
+
+      combinedKeys = combinedMap->mapKeys();
+      combinedValues = combinedMap->mapValues();
+
+      rows.applyToSelected([&](vector_size_t row) {
+        auto mapOffset = rawOffsets[row];
+        auto mapSize = rawSizes[row];
+        if (duplicateCnt) {
+          rawOffsets[row] -= duplicateCnt;
         }
-      }
-    });
+        for (vector_size_t i = 1; i < mapSize; i++) {
+          if (combinedKeys->equalValueAt(
+                  combinedKeys.get(), mapOffset + i, mapOffset + i - 1)) {
+            duplicateCnt++;
+            // "remove" duplicate entry
+            uniqueKeys.setValid(mapOffset + i - 1, false);
+            rawSizes[row]--;
+          }
+        }
+      });
+    }
 
     if (duplicateCnt) {
       uniqueKeys.updateBounds();
@@ -21,16 +21,15 @@
 namespace facebook::velox::functions {
 namespace {
 
-/// Populates indices of the n-th elements of the arrays.
-/// Selects 'row' in 'arrayRows' if corresponding array has an n-th element.
-/// Sets elementIndices[row] to the index of the n-th element in the 'elements'
-/// vector.
-/// Returns true if at least one array has n-th element.
-bool toNthElementRows(
+/// Selects in 'arrayRows' the rows of 'rows' with a non-null, non-empty array
+/// and sets elementIndices[row] to the index of the first element of the
+/// array in the 'elements' vector. Lists the selected rows in 'activeRows'.
+/// Returns true if at least one array has an element.
+bool toFirstElementRows(
     const ArrayVectorPtr& arrayVector,
     const SelectivityVector& rows,
-    vector_size_t n,
     SelectivityVector& arrayRows,
+    std::vector<vector_size_t>& activeRows,
     BufferPtr& elementIndices) {
   auto* rawSizes = arrayVector->rawSizes();
   auto* rawOffsets = arrayVector->rawOffsets();
@@ -39,19 +38,53 @@ bool toNthElementRows(
   auto* rawElementIndices = elementIndices->asMutable<vector_size_t>();
 
   arrayRows.clearAll();
+  activeRows.clear();
   memset(rawElementIndices, 0, elementIndices->size());
 
   rows.applyToSelected([&](auto row) {
     if (!rawNulls || !bits::isBitNull(rawNulls, row)) {
-      if (n < rawSizes[row]) {
+      if (rawSizes[row] > 0) {
         arrayRows.setValid(row, true);
-        rawElementIndices[row] = rawOffsets[row] + n;
+        rawElementIndices[row] = rawOffsets[row];
+        activeRows.push_back(row);
       }
     }
   });
   arrayRows.updateBounds();
 
-  return arrayRows.hasSelections();
+  return !activeRows.empty();
+}
+
+/// Moves the rows in 'activeRows' to the n-th elements of their arrays.
+/// Deselects in 'arrayRows' and removes from 'activeRows' the arrays with
+/// fewer than n + 1 elements. Only visits the arrays left from the previous
+/// step, so that a few long arrays do not make each step scan all rows. The
+/// indices of the deselected rows keep referring to valid elements.
+/// Returns true if at least one array has an n-th element.
+bool toNextElementRows(
+    const ArrayVectorPtr& arrayVector,
+    vector_size_t n,
+    SelectivityVector& arrayRows,
+    std::vector<vector_size_t>& activeRows,
+    BufferPtr& elementIndices) {
+  auto* rawSizes = arrayVector->rawSizes();
+  auto* rawOffsets = arrayVector->rawOffsets();
+
+  auto* rawElementIndices = elementIndices->asMutable<vector_size_t>();
+
+  vector_size_t numActive = 0;
+  for (auto row : activeRows) {
+    if (n < rawSizes[row]) {
+      rawElementIndices[row] = rawOffsets[row] + n;
+      activeRows[numActive++] = row;
+    } else {
+      arrayRows.setValid(row, false);
+    }
+  }
+  activeRows.resize(numActive);
+  arrayRows.updateBounds();
+
+  return numActive > 0;
 }
 
 /// See documentation at
@@ -116,16 +149,20 @@ class ReduceFunction : public exec::VectorFunction {
     // And so on until all elements of all arrays have been processed.
     // At each step the number of arrays being processed will get smaller as
     // some arrays will run out of elements.
+    std::vector<vector_size_t> activeRows;
     while (inputFuncIt.next(callable, callableRows)) {
       VectorPtr state = initialState;
+      if (!toFirstElementRows(
+              flatArray,
+              *callableRows,
+              arrayRows,
+              activeRows,
+              elementIndices)) {
+        continue; // All arrays are null or empty.
+      }
 
       int n = 0;
-      while (true) {
-        if (!toNthElementRows(
-                flatArray, *callableRows, n, arrayRows, elementIndices)) {
-          break; // Ran out of elements in all arrays.
-        }
-
+      do {
         auto nthElement = BaseVector::wrapInDictionary(
             BufferPtr(nullptr),
             elementIndices,
@@ -137,7 +174,8 @@ class ReduceFunction : public exec::VectorFunction {
             arrayRows, nullptr, context, lambdaArgs, &partialResult);
         state = partialResult;
         n++;
-      }
+      } while (toNextElementRows(
+          flatArray, n, arrayRows, activeRows, elementIndices));
     }
 
     // Apply output function.
@@ -218,7 +218,7 @@ class SplitFunction : public exec::VectorFunction {
     const std::string_view sdelim(delim.data(), delim.size());
     while (true) {
       // Find the byte of the 1st delimiter.
-      auto byteIndex = sinput.find(sdelim, 0);
+      auto byteIndex = stringCore::findSubstring(sinput, sdelim);
 
       // Delimiter is not found, leave the loop.
       if (byteIndex == std::string_view::npos) {
@@ -38,6 +38,7 @@ void registerVectorFunctions() {
   VELOX_REGISTER_VECTOR_FUNCTION(udf_array_distinct, "array_distinct");
   VELOX_REGISTER_VECTOR_FUNCTION(udf_array_intersect, "array_intersect");
   VELOX_REGISTER_VECTOR_FUNCTION(udf_array_except, "array_except");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_array_union, "array_union");
   VELOX_REGISTER_VECTOR_FUNCTION(udf_array_max, "array_max");
   VELOX_REGISTER_VECTOR_FUNCTION(udf_array_min, "array_min");
   VELOX_REGISTER_VECTOR_FUNCTION(udf_cardinality, "cardinality");
@@ -76,7 +77,20 @@ void registerVectorFunctions() {
 
   VELOX_REGISTER_VECTOR_FUNCTION(udf_to_utf8, "to_utf8");
 
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_decimal_add, "decimal_add");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_decimal_subtract, "decimal_subtract");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_decimal_multiply, "decimal_multiply");
+
   VELOX_REGISTER_VECTOR_FUNCTION(udf_from_unixtime, "from_unixtime");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_year, "year");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_month, "month");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_day, "day");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_hour, "hour");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_minute, "minute");
+  VELOX_REGISTER_VECTOR_FUNCTION(udf_second, "second");
+
+  VELOX_REGISTER_VECTOR_FUNCTION(
+      udf_json_extract_scalars, "json_extract_scalars");
 
   // TODO Fix Koski parser and clean this up.
   VELOX_REGISTER_VECTOR_FUNCTION(udf_concat_row, "ROW");
@@ -41,25 +41,40 @@ static const uint32_t kMaxCacheNum = 32;
 
 namespace {
 
-folly::Optional<folly::dynamic> jsonExtractInternal(
-    const folly::dynamic* json,
-    folly::StringPiece path) {
+// The path and extractor of the last lookup in this thread. Rows of a batch
+// usually have the same path, so these are found without hashing or
+// copying the path.
+thread_local std::string kLastPath;
+thread_local std::shared_ptr<JsonExtractor> kLastExtractor;
+
+JsonExtractor& getExtractor(folly::StringPiece path) {
   // Pre-process
-  auto trimedPath = folly::trimWhitespace(path).str();
+  auto trimedPath = folly::trimWhitespace(path);
+  if (kLastExtractor && trimedPath == kLastPath) {
+    return *kLastExtractor;
+  }
 
   std::shared_ptr<JsonExtractor> op;
-  if (kExtractorCache.count(trimedPath)) {
-    op = kExtractorCache.at(trimedPath);
+  auto pathString = trimedPath.str();
+  if (kExtractorCache.count(pathString)) {
+    op = kExtractorCache.at(pathString);
   } else {
     if (kExtractorCache.size() == kMaxCacheNum) {
       // TODO: Blindly evict the first one, use better policy
       kExtractorCache.erase(kExtractorCache.begin());
     }
-    op = std::make_shared<JsonExtractor>(trimedPath);
-    kExtractorCache[trimedPath] = op;
+    op = std::make_shared<JsonExtractor>(pathString);
+    kExtractorCache[pathString] = op;
   }
+  kLastPath = std::move(pathString);
+  kLastExtractor = op;
+  return *op;
+}
 
-  return op->extract(json);
+folly::Optional<folly::dynamic> jsonExtractInternal(
+    const folly::dynamic* json,
+    folly::StringPiece path) {
+  return getExtractor(path).extract(json);
 }
 
 bool isScalarType(const folly::Optional<folly::dynamic>& json) {
@@ -96,6 +111,344 @@ void extractArray(
     }
   }
 }
+// Same as the default recursion limit of folly::parseJson.
+constexpr int32_t kMaxDepth = 100;
+
+// Single pass scanner for JsonExtractor::extractScalars(). Accepts a strict
+// subset of what folly::parseJson accepts and gives up on anything else, so
+// that its answers never differ from parsing the document. The paths being
+// followed at each value are a bit mask over 'extractors_'. A value at depth
+// d is on a path if it matches the first d tokens of the path.
+class JsonScanner {
+ public:
+  JsonScanner(
+      folly::StringPiece json,
+      folly::Range<const JsonExtractor* const*> extractors,
+      folly::StringPiece* results)
+      : pos_(json.begin()),
+        end_(json.end()),
+        extractors_(extractors),
+        results_(results) {}
+
+  // Returns false if the document has to be parsed for an answer. Otherwise
+  // sets 'found' to the paths that lead to a scalar.
+  bool scan(uint64_t& found) {
+    auto numPaths = extractors_.size();
+    uint64_t allPaths = numPaths == 64 ? ~0ULL : (1ULL << numPaths) - 1;
+    if (!value(allPaths, 0)) {
+      return false;
+    }
+    skipWhitespace();
+    if (pos_ != end_) {
+      return false;
+    }
+    found = found_;
+    return true;
+  }
+
+ private:
+  template <typename Func>
+  static void forEachPath(uint64_t paths, Func func) {
+    while (paths) {
+      func(__builtin_ctzll(paths));
+      paths &= paths - 1;
+    }
+  }
+
+  const std::vector<std::string>& tokens(int32_t path) const {
+    return extractors_[path]->tokens();
+  }
+
+  void skipWhitespace() {
+    while (pos_ < end_ &&
+           (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\t' || *pos_ == '\r')) {
+      ++pos_;
+    }
+  }
+
+  // Scans a value at 'depth' on 'paths'. Returns false if the document has
+  // to be parsed for an answer.
+  bool value(uint64_t paths, int32_t depth) {
+    skipWhitespace();
+    if (pos_ == end_ || depth > kMaxDepth) {
+      return false;
+    }
+    uint64_t targets = 0;
+    forEachPath(paths, [&](int32_t path) {
+      if (tokens(path).size() == static_cast<size_t>(depth)) {
+        targets |= 1ULL << path;
+      }
+    });
+    auto children = paths & ~targets;
+    switch (*pos_) {
+      case '{':
+        return object(children, depth + 1);
+      case '[':
+        return array(children, depth + 1);
+      case '"': {
+        folly::StringPiece text;
+        bool hasEscapes;
+        if (!string(text, hasEscapes)) {
+          return false;
+        }
+        if (targets) {
+          if (hasEscapes) {
+            return false;
+          }
+          setResult(targets, text);
+        }
+        return true;
+      }
+      case 't':
+        return literal("true", targets);
+      case 'f':
+        return literal("false", targets);
+      case 'n':
+        // null is not a scalar.
+        return literal("null", 0);
+      default:
+        return number(targets);
+    }
+  }
+
+  // Scans an object whose members are at 'depth'. The keys are matched
+  // against the token at 'depth' - 1 of 'paths'.
+  bool object(uint64_t paths, int32_t depth) {
+    ++pos_;
+    skipWhitespace();
+    if (pos_ < end_ && *pos_ == '}') {
+      ++pos_;
+      return true;
+    }
+    for (;;) {
+      skipWhitespace();
+      folly::StringPiece key;
+      bool hasEscapes;
+      if (pos_ == end_ || *pos_ != '"' || !string(key, hasEscapes)) {
+        return false;
+      }
+      uint64_t valuePaths = 0;
+      if (paths) {
+        if (hasEscapes) {
+          return false;
+        }
+        forEachPath(paths, [&](int32_t path) {
+          if (key == tokens(path)[depth - 1]) {
+            valuePaths |= 1ULL << path;
+          }
+        });
+        // The last of duplicate keys wins, as in folly::dynamic.
+        found_ &= ~valuePaths;
+      }
+      skipWhitespace();
+      if (pos_ == end_ || *pos_ != ':') {
+        return false;
+      }
+      ++pos_;
+      if (!value(valuePaths, depth)) {
+        return false;
+      }
+      skipWhitespace();
+      if (pos_ == end_) {
+        return false;
+      }
+      if (*pos_ == '}') {
+        ++pos_;
+        return true;
+      }
+      if (*pos_ != ',') {
+        return false;
+      }
+      ++pos_;
+    }
+  }
+
+  // Scans an array whose elements are at 'depth'.
+  bool array(uint64_t paths, int32_t depth) {
+    // The subscripts at 'depth' - 1 of 'paths' and the path of each.
+    std::vector<std::pair<int32_t, uint64_t>> subscripts;
+    forEachPath(paths, [&](int32_t path) {
+      auto index = folly::tryTo<int32_t>(tokens(path)[depth - 1]);
+      if (index.hasValue()) {
+        subscripts.emplace_back(index.value(), 1ULL << path);
+      }
+    });
+    ++pos_;
+    skipWhitespace();
+    if (pos_ < end_ && *pos_ == ']') {
+      ++pos_;
+      return true;
+    }
+    for (int32_t index = 0;; ++index) {
+      uint64_t elementPaths = 0;
+      for (auto& [subscript, path] : subscripts) {
+        if (subscript == index) {
+          elementPaths |= path;
+        }
+      }
+      if (!value(elementPaths, depth)) {
+        return false;
+      }
+      skipWhitespace();
+      if (pos_ == end_) {
+        return false;
+      }
+      if (*pos_ == ']') {
+        ++pos_;
+        return true;
+      }
+      if (*pos_ != ',') {
+        return false;
+      }
+      ++pos_;
+    }
+  }
+
+  // Scans a string starting at the opening quote. Sets 'text' to the
+  // characters between the quotes.
+  bool string(folly::StringPiece& text, bool& hasEscapes) {
+    auto start = ++pos_;
+    hasEscapes = false;
+    while (pos_ < end_ && *pos_ != '"') {
+      auto c = static_cast<uint8_t>(*pos_);
+      if (c < 0x20) {
+        return false;
+      }
+      if (c == '\\') {
+        hasEscapes = true;
+        if (++pos_ == end_ || !escape()) {
+          return false;
+        }
+        continue;
+      }
+      ++pos_;
+    }
+    if (pos_ == end_) {
+      return false;
+    }
+    text = folly::StringPiece(start, pos_);
+    ++pos_;
+    return true;
+  }
+
+  // Checks the escape sequence after a backslash. Surrogates are left to
+  // the parser.
+  bool escape() {
+    switch (*pos_++) {
+      case '"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        return true;
+      case 'u': {
+        if (end_ - pos_ < 4) {
+          return false;
+        }
+        int32_t codePoint = 0;
+        for (auto i = 0; i < 4; ++i) {
+          auto c = *pos_++;
+          int32_t digit;
+          if (c >= '0' && c <= '9') {
+            digit = c - '0';
+          } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+          } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+          } else {
+            return false;
+          }
+          codePoint = codePoint * 16 + digit;
+        }
+        return codePoint < 0xd800 || codePoint > 0xdfff;
+      }
+      default:
+        return false;
+    }
+  }
+
+  bool literal(folly::StringPiece expected, uint64_t targets) {
+    if (end_ - pos_ < expected.size() ||
+        memcmp(pos_, expected.data(), expected.size()) != 0) {
+      return false;
+    }
+    if (targets) {
+      setResult(targets, folly::StringPiece(pos_, expected.size()));
+    }
+    pos_ += expected.size();
+    return true;
+  }
+
+  // Scans a number in the strict JSON syntax. As a result, only integers
+  // whose text is the same as their conversion to string are accepted.
+  bool number(uint64_t targets) {
+    auto start = pos_;
+    if (pos_ < end_ && *pos_ == '-') {
+      ++pos_;
+    }
+    auto numIntegerDigits = digits();
+    if (numIntegerDigits == 0 ||
+        (numIntegerDigits > 1 && pos_[-numIntegerDigits] == '0')) {
+      return false;
+    }
+    bool isInteger = true;
+    if (pos_ < end_ && *pos_ == '.') {
+      ++pos_;
+      isInteger = false;
+      if (digits() == 0) {
+        return false;
+      }
+    }
+    if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+      ++pos_;
+      isInteger = false;
+      if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-')) {
+        ++pos_;
+      }
+      // Leaves overflow to infinity to the parser.
+      auto numExponentDigits = digits();
+      if (numExponentDigits == 0 || numExponentDigits > 2) {
+        return false;
+      }
+    }
+    if (isInteger && numIntegerDigits > 18) {
+      // May not fit in int64_t.
+      return false;
+    }
+    if (targets) {
+      folly::StringPiece text(start, pos_);
+      // Doubles are printed in their shortest form and -0 as 0.
+      if (!isInteger || text == "-0") {
+        return false;
+      }
+      setResult(targets, text);
+    }
+    return true;
+  }
+
+  // Skips decimal digits and returns their count.
+  int32_t digits() {
+    auto start = pos_;
+    while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+      ++pos_;
+    }
+    return pos_ - start;
+  }
+
+  void setResult(uint64_t targets, folly::StringPiece text) {
+    forEachPath(targets, [&](int32_t path) { results_[path] = text; });
+    found_ |= targets;
+  }
+
+  const char* pos_;
+  const char* const end_;
+  const folly::Range<const JsonExtractor* const*> extractors_;
+  folly::StringPiece* const results_;
+  uint64_t found_{0};
+};
 } // namespace
 
 JsonExtractor::JsonExtractor(const std::string& path)
@@ -114,6 +467,7 @@ void JsonExtractor::tokenize() {
 
   while (kTokenizer.hasNext()) {
     if (auto token = kTokenizer.getNext()) {
+      hasWildcard_ |= token.value() == "*";
       tokens_.push_back(token.value());
     } else {
       tokens_.clear();
@@ -124,7 +478,7 @@ void JsonExtractor::tokenize() {
 }
 
 folly::Optional<folly::dynamic> JsonExtractor::extract(
-    const folly::dynamic* json) {
+    const folly::dynamic* json) const {
   VELOX_USER_CHECK(isValid_, "Invalid JSON path: {}", path_);
 
   JsonVector input;
@@ -162,6 +516,32 @@ folly::Optional<folly::dynamic> JsonExtractor::extract(
   }
 }
 
+JsonExtractor::ScanResult JsonExtractor::extractScalar(
+    folly::StringPiece json,
+    folly::StringPiece& result) const {
+  const JsonExtractor* self = this;
+  uint64_t found;
+  return extractScalars(json, {&self, 1}, &result, found);
+}
+
+// static
+JsonExtractor::ScanResult JsonExtractor::extractScalars(
+    folly::StringPiece json,
+    folly::Range<const JsonExtractor* const*> extractors,
+    folly::StringPiece* results,
+    uint64_t& found) {
+  VELOX_CHECK_LE(extractors.size(), kMaxScanPaths);
+  for (auto* extractor : extractors) {
+    if (!extractor->isValid_ || extractor->hasWildcard_) {
+      return ScanResult::kUnknown;
+    }
+  }
+  if (!JsonScanner(json, extractors, results).scan(found)) {
+    return ScanResult::kUnknown;
+  }
+  return found ? ScanResult::kFound : ScanResult::kNotFound;
+}
+
 folly::Optional<folly::dynamic> jsonExtract(
     folly::StringPiece json,
     folly::StringPiece path) {
@@ -195,12 +575,73 @@ folly::Optional<folly::dynamic> jsonExtract(
 folly::Optional<std::string> jsonExtractScalar(
     folly::StringPiece json,
     folly::StringPiece path) {
+  folly::StringPiece scalar;
+  std::string buffer;
+  if (!jsonExtractScalar(json, path, scalar, buffer)) {
+    return folly::none;
+  }
+  if (scalar.data() == buffer.data()) {
+    return buffer;
+  }
+  return scalar.str();
+}
+
+bool jsonExtractScalar(
+    folly::StringPiece json,
+    folly::StringPiece path,
+    folly::StringPiece& result,
+    std::string& buffer) {
+  switch (getExtractor(path).extractScalar(json, result)) {
+    case JsonExtractor::ScanResult::kFound:
+      return true;
+    case JsonExtractor::ScanResult::kNotFound:
+      return false;
+    case JsonExtractor::ScanResult::kUnknown:
+      break;
+  }
   auto res = jsonExtract(json, path);
   // Not a scalar value
-  if (isScalarType(res)) {
-    return res->asString();
+  if (!isScalarType(res)) {
+    return false;
   }
-  return folly::none;
+  buffer = res->asString();
+  result = buffer;
+  return true;
+}
+
+std::vector<folly::Optional<std::string>> jsonExtractScalars(
+    folly::StringPiece json,
+    folly::Range<const JsonExtractor* const*> extractors) {
+  std::vector<folly::Optional<std::string>> results(extractors.size());
+  if (extractors.size() <= JsonExtractor::kMaxScanPaths) {
+    std::vector<folly::StringPiece> scalars(extractors.size());
+    uint64_t found;
+    auto scanResult = JsonExtractor::extractScalars(
+        json, extractors, scalars.data(), found);
+    if (scanResult != JsonExtractor::ScanResult::kUnknown) {
+      for (auto i = 0; i < extractors.size(); ++i) {
+        if (found & (1ULL << i)) {
+          results[i] = scalars[i].str();
+        }
+      }
+      return results;
+    }
+  }
+  folly::dynamic jsonObj;
+  try {
+    jsonObj = folly::parseJson(json);
+  } catch (const folly::json::parse_error&) {
+    return results;
+  } catch (const folly::ConversionError&) {
+    return results;
+  }
+  for (auto i = 0; i < extractors.size(); ++i) {
+    auto res = extractors[i]->extract(&jsonObj);
+    if (isScalarType(res)) {
+      results[i] = res->asString();
+    }
+  }
+  return results;
 }
 
 folly::Optional<std::string> jsonExtractScalar(
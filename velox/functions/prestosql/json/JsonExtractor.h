@@ -65,6 +65,16 @@ folly::Optional<std::string> jsonExtractScalar(
     folly::StringPiece json,
     folly::StringPiece path);
 
+/// Same as jsonExtractScalar() but does not copy the result when it is a
+/// slice of 'json'. Returns false if there is no scalar at 'path'.
+/// Otherwise sets 'result' to the scalar, which is either in 'json' or,
+/// if the document had to be parsed, in 'buffer'.
+bool jsonExtractScalar(
+    folly::StringPiece json,
+    folly::StringPiece path,
+    folly::StringPiece& result,
+    std::string& buffer);
+
 folly::Optional<folly::dynamic> jsonExtract(
     const std::string& json,
     const std::string& path);
@@ -73,17 +83,73 @@ folly::Optional<std::string> jsonExtractScalar(
     const std::string& json,
     const std::string& path);
 
+class JsonExtractor;
+
+/// Returns the scalars at the paths of 'extractors' in 'json', in the same
+/// order. The document is scanned or parsed once for all the paths, as
+/// opposed to once per path with jsonExtractScalar().
+std::vector<folly::Optional<std::string>> jsonExtractScalars(
+    folly::StringPiece json,
+    folly::Range<const JsonExtractor* const*> extractors);
+
 class JsonExtractor {
  public:
+  /// Result of extractScalar().
+  enum class ScanResult {
+    // The path leads to a scalar other than null.
+    kFound,
+    // The document is valid but has no scalar at the path.
+    kNotFound,
+    // The document needs extract() for a definite answer, e.g. because it
+    // is not valid or has escaped characters in a key or the result.
+    kUnknown
+  };
+
+  /// Maximum number of paths for extractScalars().
+  static constexpr int32_t kMaxScanPaths = 64;
+
   explicit JsonExtractor(const std::string& path);
 
-  folly::Optional<folly::dynamic> extract(const folly::dynamic* json);
+  folly::Optional<folly::dynamic> extract(const folly::dynamic* json) const;
+
+  /// Finds the scalar at the path in the text of 'json' in a single pass
+  /// without building a folly::dynamic. The whole document is still
+  /// checked, so a kFound or kNotFound result is the same as the one of
+  /// extract() on the parsed document. On kFound, sets 'result' to the text
+  /// of the value in 'json', without the quotes of a string.
+  ScanResult extractScalar(folly::StringPiece json, folly::StringPiece& result)
+      const;
+
+  /// Multi-path form of extractScalar() for up to kMaxScanPaths
+  /// 'extractors'. Sets bit i of 'found' and results[i] for each path that
+  /// leads to a scalar. Returns kUnknown if any of the paths needs
+  /// extract(), kNotFound if none is found and kFound otherwise.
+  static ScanResult extractScalars(
+      folly::StringPiece json,
+      folly::Range<const JsonExtractor* const*> extractors,
+      folly::StringPiece* results,
+      uint64_t& found);
+
+  bool isValid() const {
+    return isValid_;
+  }
+
+  const std::string& path() const {
+    return path_;
+  }
+
+  const std::vector<std::string>& tokens() const {
+    return tokens_;
+  }
 
  private:
   void tokenize();
 
  private:
   bool isValid_;
+  // True if 'tokens_' has a wildcard. extractScalar() does not support
+  // these.
+  bool hasWildcard_{false};
   std::string path_;
   std::vector<std::string> tokens_;
 };
@@ -501,3 +501,105 @@ TEST(JsonExtractorTest, jsonMultipleExtractsTest) {
   ASSERT_TRUE(extract2.hasValue());
   EXPECT_EQ(jsonExtract(json, "$.store.fruit").value(), extract2.value());
 }
+
+TEST(JsonExtractorTest, extractScalarWithoutParsing) {
+  using facebook::velox::functions::JsonExtractor;
+  using ScanResult = JsonExtractor::ScanResult;
+  auto scan = [](const std::string& json, const std::string& path) {
+    folly::StringPiece result;
+    auto scanResult = JsonExtractor(path).extractScalar(json, result);
+    return std::make_pair(
+        scanResult,
+        scanResult == ScanResult::kFound ? result.str() : std::string());
+  };
+  auto found = [](const std::string& value) {
+    return std::make_pair(ScanResult::kFound, value);
+  };
+  auto notFound = std::make_pair(ScanResult::kNotFound, std::string());
+  auto unknown = std::make_pair(ScanResult::kUnknown, std::string());
+
+  auto json = R"DELIM(
+      {"a": {"b": [10, -2, "x", true, null, {"c": "y"}]},
+       "d": 1.5e3, "e": "A\n", "a2": [[]], "b": false})DELIM"s;
+  EXPECT_EQ(scan(json, "$.a.b[0]"), found("10"));
+  EXPECT_EQ(scan(json, "$.a.b[1]"), found("-2"));
+  EXPECT_EQ(scan(json, "$.a.b[2]"), found("x"));
+  EXPECT_EQ(scan(json, "$.a.b[3]"), found("true"));
+  EXPECT_EQ(scan(json, "$.a.b[5].c"), found("y"));
+  EXPECT_EQ(scan(json, "$.b"), found("false"));
+  EXPECT_EQ(scan(json, "$.a.b[4]"), notFound);
+  EXPECT_EQ(scan(json, "$.a.b[6]"), notFound);
+  EXPECT_EQ(scan(json, "$.a.b"), notFound);
+  EXPECT_EQ(scan(json, "$.x"), notFound);
+  EXPECT_EQ(scan(json, "$.a.b.c"), notFound);
+  // Doubles and escaped strings are left to the parser.
+  EXPECT_EQ(scan(json, "$.d"), unknown);
+  EXPECT_EQ(scan(json, "$.e"), unknown);
+  EXPECT_EQ(scan(json, "$.a.b[*]"), unknown);
+
+  // The last of duplicate keys wins.
+  EXPECT_EQ(scan(R"({"a": 1, "a": 2})", "$.a"), found("2"));
+  EXPECT_EQ(scan(R"({"a": 1, "a": [2]})", "$.a"), notFound);
+
+  // Invalid documents are never found, even where the path is valid.
+  EXPECT_EQ(scan(R"({"a": 1, "b": tru})", "$.a"), unknown);
+  EXPECT_EQ(scan(R"({"a": 1} x)", "$.a"), unknown);
+  EXPECT_EQ(scan(R"({"a": 01})", "$.a"), unknown);
+  EXPECT_EQ(scan(R"({"a": 1,})", "$.a"), unknown);
+  EXPECT_EQ(scan(R"({"a": "\ud800"})", "$.b"), unknown);
+
+  // The results agree with the parser for all of these.
+  for (const auto& path :
+       {"$.a.b[0]"s, "$.a.b[2]"s, "$.b"s, "$.a.b[4]"s, "$.d"s, "$.e"s}) {
+    EXPECT_EQ(
+        jsonExtractScalar(json, path),
+        jsonExtractScalar(folly::toJson(folly::parseJson(json)), path));
+  }
+}
+
+TEST(JsonExtractorTest, extractScalarsInOnePass) {
+  using facebook::velox::functions::JsonExtractor;
+  using facebook::velox::functions::jsonExtractScalars;
+  std::vector<std::string> paths = {
+      "$.a[1]", "$.a[0].b", "$.c", "$.a", "$.c", "$.d", "$.e"};
+  std::vector<std::unique_ptr<JsonExtractor>> holders;
+  std::vector<const JsonExtractor*> extractors;
+  for (auto& path : paths) {
+    holders.push_back(std::make_unique<JsonExtractor>(path));
+    extractors.push_back(holders.back().get());
+  }
+
+  auto json = R"({"a": [{"b": "x"}, 7], "c": true, "d": null, "e": 1.5})"s;
+  std::vector<folly::StringPiece> results(paths.size());
+  uint64_t found;
+  // 1.5 is left to the parser.
+  EXPECT_EQ(
+      JsonExtractor::extractScalars(
+          json, folly::range(extractors), results.data(), found),
+      JsonExtractor::ScanResult::kUnknown);
+  json = R"({"a": [{"b": "x"}, 7], "c": true, "d": null, "e": 15})"s;
+  EXPECT_EQ(
+      JsonExtractor::extractScalars(
+          json, folly::range(extractors), results.data(), found),
+      JsonExtractor::ScanResult::kFound);
+  EXPECT_EQ(found, 0b1010111);
+  EXPECT_EQ(results[0], "7");
+  EXPECT_EQ(results[1], "x");
+  EXPECT_EQ(results[2], "true");
+  EXPECT_EQ(results[4], "true");
+  EXPECT_EQ(results[6], "15");
+
+  // The parsed and scanned documents give the same results as one path at a
+  // time.
+  for (const auto& document :
+       {json,
+        R"({"a": [{"b": "x"}, 7], "c": true, "d": null, "e": 1.5})"s,
+        R"({"a": [{"b": "x"}, 7], "c": true, "c": [], "e": 1})"s,
+        R"({"a": [{"b": "x"}, 7], "c": tru})"s}) {
+    auto values = jsonExtractScalars(document, folly::range(extractors));
+    ASSERT_EQ(values.size(), paths.size());
+    for (auto i = 0; i < paths.size(); ++i) {
+      EXPECT_EQ(values[i], jsonExtractScalar(document, paths[i]));
+    }
+  }
+}
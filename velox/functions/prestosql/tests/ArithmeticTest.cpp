@@ -116,6 +116,33 @@ TEST_F(ArithmeticTest, modulusInt) {
   assertError<int64_t>("modulus(c0, c1)", {10}, {0}, "Cannot divide by 0");
 }
 
+// Flat arguments without nulls take the tight loop over raw values. Checks
+// partially selected rows and the per row errors after falling back.
+TEST_F(ArithmeticTest, modulusFlatNoNulls) {
+  vector_size_t size = 1'000;
+  auto input = makeRowVector({
+      makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(size, [](auto row) { return row % 7; }),
+  });
+
+  // Rows with c1 = 0 are not selected for modulus().
+  auto result = evaluate<SimpleVector<int64_t>>(
+      "if (c1 > 0 and c0 % 3 <> 1, modulus(c0, c1), -1)", input);
+  for (auto i = 0; i < size; ++i) {
+    auto expected = i % 7 > 0 && i % 3 != 1 ? i % (i % 7) : -1;
+    ASSERT_EQ(expected, result->valueAt(i)) << "at " << i;
+  }
+
+  result = evaluate<SimpleVector<int64_t>>("try(modulus(c0, c1))", input);
+  for (auto i = 0; i < size; ++i) {
+    if (i % 7 == 0) {
+      ASSERT_TRUE(result->isNullAt(i)) << "at " << i;
+    } else {
+      ASSERT_EQ(i % (i % 7), result->valueAt(i)) << "at " << i;
+    }
+  }
+}
+
 TEST_F(ArithmeticTest, power) {
   std::vector<double> baseDouble = {
       0, 0, 0, -1, -1, -1, -9, 9.1, 10.1, 11.1, -11.1, 0, kInf, kInf};
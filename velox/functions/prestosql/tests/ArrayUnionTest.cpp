@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <optional>
+#include "velox/functions/prestosql/tests/FunctionBaseTest.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::functions::test;
+
+namespace {
+
+class ArrayUnionTest : public FunctionBaseTest {
+ protected:
+  void testExpr(
+      const VectorPtr& expected,
+      const std::string& expression,
+      const std::vector<VectorPtr>& input) {
+    auto result = evaluate<ArrayVector>(expression, makeRowVector(input));
+    assertEqualVectors(expected, result);
+
+    // Also test using dictionary encodings.
+    auto newSize = input[0]->size() * 2;
+    auto indices = makeIndices(newSize, [](auto row) { return row / 2; });
+    auto firstDict = wrapInDictionary(indices, newSize, input[0]);
+    auto secondFlat = flatten(wrapInDictionary(indices, newSize, input[1]));
+
+    auto dictResult = evaluate<ArrayVector>(
+        expression, makeRowVector({firstDict, secondFlat}));
+    auto dictExpected = wrapInDictionary(indices, newSize, expected);
+    assertEqualVectors(dictExpected, dictResult);
+  }
+
+  template <typename T>
+  void testInt() {
+    auto array1 = makeNullableArrayVector<T>({
+        {1, -2, 3, std::nullopt, 4, 5, 6, std::nullopt},
+        {1, 2, -2, 1},
+        {3, 8, std::nullopt},
+        {1, 1, -2, -2, -2, 4, 8},
+        {},
+    });
+    auto array2 = makeNullableArrayVector<T>({
+        {1, -2, 4},
+        {1, -2, 4},
+        {1, std::nullopt, 4},
+        {},
+        {},
+    });
+    auto expected = makeNullableArrayVector<T>({
+        {1, -2, 3, std::nullopt, 4, 5, 6},
+        {1, 2, -2, 4},
+        {3, 8, std::nullopt, 1, 4},
+        {1, -2, 4, 8},
+        {},
+    });
+    testExpr(expected, "array_union(C0, C1)", {array1, array2});
+    expected = makeNullableArrayVector<T>({
+        {1, -2, 4, 3, std::nullopt, 5, 6},
+        {1, -2, 4, 2},
+        {1, std::nullopt, 4, 3, 8},
+        {1, -2, 4, 8},
+        {},
+    });
+    testExpr(expected, "array_union(C1, C0)", {array1, array2});
+  }
+};
+
+TEST_F(ArrayUnionTest, intArrays) {
+  testInt<int8_t>();
+  testInt<int16_t>();
+  testInt<int32_t>();
+  testInt<int64_t>();
+}
+
+TEST_F(ArrayUnionTest, strArrays) {
+  using S = StringView;
+  auto array1 = makeNullableArrayVector<StringView>({
+      {S("a"), std::nullopt, S("a string longer than inline"), S("a")},
+      {S("a"), S("b")},
+      {std::nullopt},
+  });
+  auto array2 = makeNullableArrayVector<StringView>({
+      {S("a string longer than inline"), S("b")},
+      {},
+      {S("c"), std::nullopt},
+  });
+  auto expected = makeNullableArrayVector<StringView>({
+      {S("a"), std::nullopt, S("a string longer than inline"), S("b")},
+      {S("a"), S("b")},
+      {std::nullopt, S("c")},
+  });
+  testExpr(expected, "array_union(C0, C1)", {array1, array2});
+}
+
+// Arrays larger than the set that is searched linearly.
+TEST_F(ArrayUnionTest, largeArrays) {
+  // Row r is [0, 10 * r) and [0, 2, 4, ... 98]. The union is [0, 10 * r)
+  // followed by the even numbers in [10 * r, 100).
+  std::vector<std::vector<int64_t>> data1;
+  std::vector<std::vector<int64_t>> data2;
+  std::vector<std::vector<int64_t>> expectedData;
+  for (auto row = 0; row < 10; ++row) {
+    data1.emplace_back();
+    data2.emplace_back();
+    for (auto i = 0; i < 100; ++i) {
+      if (i < row * 10) {
+        data1.back().push_back(i);
+      }
+      if (i % 2 == 0) {
+        data2.back().push_back(i);
+      }
+    }
+    expectedData.push_back(data1.back());
+    for (auto i = row * 10; i < 100; i += 2) {
+      expectedData.back().push_back(i);
+    }
+  }
+  testExpr(
+      makeArrayVector(expectedData),
+      "array_union(C0, C1)",
+      {makeArrayVector(data1), makeArrayVector(data2)});
+}
+
+} // namespace
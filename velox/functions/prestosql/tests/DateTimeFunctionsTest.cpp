@@ -130,3 +130,63 @@ TEST_F(DateTimeFunctionsTest, millisecond) {
   EXPECT_EQ(123, millisecond(Timestamp(-1, 123000000)));
   EXPECT_EQ(12300, millisecond(Timestamp(-1, 12300000000)));
 }
+
+TEST_F(DateTimeFunctionsTest, extractFields) {
+  auto fields = [&](std::optional<Timestamp> timestamp) {
+    std::vector<std::optional<int64_t>> result;
+    for (auto name : {"year", "month", "day", "hour", "minute", "second"}) {
+      result.push_back(
+          evaluateOnce<int64_t>(fmt::format("{}(c0)", name), timestamp));
+    }
+    return result;
+  };
+  using Fields = std::vector<std::optional<int64_t>>;
+
+  EXPECT_EQ(Fields(6, std::nullopt), fields(std::nullopt));
+  EXPECT_EQ((Fields{1970, 1, 1, 0, 0, 0}), fields(Timestamp(0, 0)));
+  EXPECT_EQ((Fields{1969, 12, 31, 23, 59, 59}), fields(Timestamp(-1, 9000)));
+  EXPECT_EQ(
+      (Fields{2001, 8, 22, 3, 4, 5}), fields(Timestamp(998474645, 321000000)));
+  EXPECT_EQ((Fields{2096, 10, 2, 7, 6, 40}), fields(Timestamp(4000000000, 0)));
+
+  // Without adjustment the session time zone is not used.
+  queryCtx_->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSessionTimezone, "America/Los_Angeles"},
+  });
+  EXPECT_EQ(
+      (Fields{2001, 8, 22, 3, 4, 5}), fields(Timestamp(998474645, 321000000)));
+
+  queryCtx_->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSessionTimezone, "America/Los_Angeles"},
+      {core::QueryCtx::kAdjustTimestampToTimezone, "true"},
+  });
+  // Daylight savings time, 7h offset.
+  EXPECT_EQ(
+      (Fields{2001, 8, 21, 20, 4, 5}), fields(Timestamp(998474645, 321000000)));
+  EXPECT_EQ((Fields{1969, 12, 31, 16, 0, 0}), fields(Timestamp(0, 0)));
+}
+
+TEST_F(DateTimeFunctionsTest, hourAcrossTransition) {
+  queryCtx_->setConfigOverridesUnsafe({
+      {core::QueryCtx::kSessionTimezone, "America/Los_Angeles"},
+      {core::QueryCtx::kAdjustTimestampToTimezone, "true"},
+  });
+  // 2021-11-07 08:00 UTC, 1 am local time before the end of daylight
+  // savings time at 09:00 UTC.
+  constexpr int64_t kStart = 1636272000;
+  auto data = makeRowVector({makeFlatVector<Timestamp>(
+      5, [](auto row) { return Timestamp(kStart + row * 1'800, 0); })});
+
+  // In one offset: 1:00 and 1:30 am PDT.
+  auto result = evaluate<SimpleVector<int64_t>>(
+      "hour(c0)",
+      makeRowVector({makeFlatVector<Timestamp>(
+          2, [](auto row) { return Timestamp(kStart + row * 1'800, 0); })}));
+  assertEqualVectors(makeFlatVector<int64_t>({1, 1}), result);
+
+  // 1:00 and 1:30 am PDT, then 1:00, 1:30 and 2:00 am PST.
+  result = evaluate<SimpleVector<int64_t>>("hour(c0)", data);
+  assertEqualVectors(makeFlatVector<int64_t>({1, 1, 1, 1, 2}), result);
+  result = evaluate<SimpleVector<int64_t>>("minute(c0)", data);
+  assertEqualVectors(makeFlatVector<int64_t>({0, 30, 0, 30, 0}), result);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/functions/prestosql/tests/FunctionBaseTest.h"
+#include "velox/type/DecimalType.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::test;
+
+namespace {
+
+class DecimalArithmeticTest : public functions::test::FunctionBaseTest {
+ protected:
+  // Returns a vector of DECIMAL(precision, scale) with unscaled 'values'.
+  FlatVectorPtr<int64_t> makeDecimalVector(
+      const std::vector<int64_t>& values,
+      int precision,
+      int scale) {
+    auto vector =
+        makeFlatVector<int64_t>(values.size(), DECIMAL(precision, scale));
+    for (auto i = 0; i < values.size(); ++i) {
+      vector->set(i, values[i]);
+    }
+    return vector;
+  }
+
+  void testDecimalExpr(
+      const std::string& expression,
+      const std::vector<VectorPtr>& inputs,
+      const std::vector<int64_t>& expected,
+      const std::string& expectedType) {
+    auto result =
+        evaluate<SimpleVector<int64_t>>(expression, makeRowVector(inputs));
+    EXPECT_EQ(expectedType, result->type()->toString());
+    assertEqualVectors(makeFlatVector<int64_t>(expected), result);
+  }
+};
+
+TEST_F(DecimalArithmeticTest, add) {
+  // 12.34, -0.50, 999.99 plus 1.0, 0.5, 0.1.
+  auto a = makeDecimalVector({1234, -50, 99999}, 5, 2);
+  auto b = makeDecimalVector({10, 5, 1}, 4, 1);
+  testDecimalExpr(
+      "decimal_add(c0, c1)", {a, b}, {1334, 0, 100009}, "DECIMAL(6,2)");
+  testDecimalExpr(
+      "decimal_add(c1, c0)", {a, b}, {1334, 0, 100009}, "DECIMAL(6,2)");
+  testDecimalExpr(
+      "decimal_add(c0, c0)", {a}, {2468, -100, 199998}, "DECIMAL(6,2)");
+}
+
+TEST_F(DecimalArithmeticTest, subtract) {
+  auto a = makeDecimalVector({1234, -50, 99999}, 5, 2);
+  auto b = makeDecimalVector({10, 5, 1}, 4, 1);
+  testDecimalExpr(
+      "decimal_subtract(c0, c1)",
+      {a, b},
+      {1134, -100, 99989},
+      "DECIMAL(6,2)");
+}
+
+TEST_F(DecimalArithmeticTest, multiply) {
+  auto a = makeDecimalVector({1234, -50, 99999}, 5, 2);
+  auto b = makeDecimalVector({10, 5, 1}, 4, 1);
+  testDecimalExpr(
+      "decimal_multiply(c0, c1)",
+      {a, b},
+      {12340, -250, 99999},
+      "DECIMAL(9,3)");
+}
+
+TEST_F(DecimalArithmeticTest, overflow) {
+  auto a = makeDecimalVector({999'999'999'999'999'999, 1, -1}, 18, 0);
+  auto b = makeDecimalVector({1, 2, -999'999'999'999'999'999}, 18, 0);
+  auto result = evaluate<SimpleVector<int64_t>>(
+      "try(decimal_add(c0, c1))", makeRowVector({a, b}));
+  EXPECT_TRUE(result->isNullAt(0));
+  EXPECT_EQ(3, result->valueAt(1));
+  EXPECT_TRUE(result->isNullAt(2));
+
+  EXPECT_THROW(
+      evaluate<SimpleVector<int64_t>>(
+          "decimal_multiply(c0, c0)", makeRowVector({a})),
+      std::overflow_error);
+}
+
+TEST_F(DecimalArithmeticTest, notDecimal) {
+  auto a = makeFlatVector<int64_t>({1, 2});
+  assertUserError(
+      [&]() {
+        evaluate<SimpleVector<int64_t>>(
+            "decimal_add(c0, c0)", makeRowVector({a}));
+      },
+      "Decimal arithmetic requires DECIMAL arguments");
+}
+
+} // namespace
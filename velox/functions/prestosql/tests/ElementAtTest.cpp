@@ -371,6 +371,43 @@ TEST_F(ElementAtTest, variableInputMap) {
   testVariableInputMap<StringView>(); // VARCHAR
 }
 
+TEST_F(ElementAtTest, repeatedLargeMaps) {
+  // 10 maps of 50 entries each referenced by many rows through a dictionary.
+  // Lookups of rows that refer to the same map reuse the result for a
+  // constant key and a hash index of the map for variable keys.
+  constexpr vector_size_t kNumMaps = 10;
+  constexpr vector_size_t kMapSize = 50;
+  auto mapVector = makeMapVector<int64_t, int64_t>(
+      kNumMaps,
+      [](vector_size_t /* row */) { return kMapSize; },
+      [](vector_size_t idx) { return idx % kMapSize * 2; },
+      [](vector_size_t idx) { return idx; });
+  auto indices = makeIndices(
+      kVectorSize, [](vector_size_t row) { return row % kNumMaps; });
+  auto maps = wrapInDictionary(indices, kVectorSize, mapVector);
+
+  testElementAt<int64_t>(
+      "element_at(C0, 10)", {maps}, [](vector_size_t row) {
+        return row % kNumMaps * kMapSize + 5;
+      });
+  testElementAt<int64_t>(
+      "element_at(C0, 11)",
+      {maps},
+      [](vector_size_t /* row */) { return 0; },
+      [](vector_size_t /* row */) { return true; });
+
+  // Odd keys are not in the maps.
+  auto keys = makeFlatVector<int64_t>(
+      kVectorSize, [](vector_size_t row) { return row % (kMapSize * 2); });
+  testElementAt<int64_t>(
+      "element_at(C0, C1)",
+      {maps, keys},
+      [](vector_size_t row) {
+        return row % kNumMaps * kMapSize + row % (kMapSize * 2) / 2;
+      },
+      [](vector_size_t row) { return row % 2 == 1; });
+}
+
 TEST_F(ElementAtTest, variableInputArray) {
   {
     auto indicesVector = makeFlatVector<int64_t>(
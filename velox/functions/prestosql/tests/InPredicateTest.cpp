@@ -262,3 +262,79 @@ TEST_F(InPredicateTest, varcharConstant) {
       "c1 IN ('apple', 'pear', 'banana')", rowVector);
   assertEqualVectors(constNull, result);
 }
+
+// Flat inputs without nulls are tested 64 rows at a time. Covers the bitmask,
+// hash table and range filters and a selection that starts and ends inside
+// a word.
+TEST_F(InPredicateTest, flatNoNullsBatches) {
+  const vector_size_t size = 1'000;
+  auto valueAt = [](auto row) { return row * 7 % 1'000; };
+  auto rowVector = makeRowVector({
+      makeFlatVector<int64_t>(size, valueAt),
+      makeFlatVector<int32_t>(size, valueAt),
+      makeFlatVector<int32_t>(size, [](auto row) { return row; }),
+  });
+
+  auto test = [&](const std::string& inList,
+                  std::function<bool(int64_t)> contains) {
+    for (auto column : {"c0", "c1"}) {
+      auto result = evaluate<SimpleVector<bool>>(
+          fmt::format("{} IN ({})", column, inList), rowVector);
+      auto expected = makeFlatVector<bool>(
+          size, [&](auto row) { return contains(valueAt(row)); });
+      assertEqualVectors(expected, result);
+
+      result = evaluate<SimpleVector<bool>>(
+          fmt::format(
+              "if(c2 >= 37 and c2 <= 900, {} IN ({}), true)", column, inList),
+          rowVector);
+      expected = makeFlatVector<bool>(size, [&](auto row) {
+        return row < 37 || row > 900 || contains(valueAt(row));
+      });
+      assertEqualVectors(expected, result);
+    }
+  };
+
+  test("100, 102, 105, 110", [](auto n) {
+    return n == 100 || n == 102 || n == 105 || n == 110;
+  });
+  test("1, 5000000, -5, 77", [](auto n) { return n == 1 || n == 77; });
+  test("10, 11, 12, 13", [](auto n) { return n >= 10 && n <= 13; });
+}
+
+// A single value VARCHAR IN list over a flat input without nulls compares the
+// string views 64 rows at a time.
+TEST_F(InPredicateTest, varcharSingleValueBatches) {
+  const vector_size_t size = 1'000;
+  std::vector<std::string> strings = {
+      "",
+      "ab",
+      "abcd",
+      "abcde",
+      "abcdefghijkl",
+      "abcdefghijklm",
+      "abcdefghijklmn",
+      "abcdefghijklmo"};
+  auto rowVector = makeRowVector({
+      makeFlatVector<StringView>(
+          size,
+          [&](auto row) { return StringView(strings[row % strings.size()]); }),
+      makeFlatVector<int32_t>(size, [](auto row) { return row; }),
+  });
+
+  for (auto& value : strings) {
+    auto result = evaluate<SimpleVector<bool>>(
+        fmt::format("c0 IN ('{}')", value), rowVector);
+    auto expected = makeFlatVector<bool>(
+        size, [&](auto row) { return strings[row % strings.size()] == value; });
+    assertEqualVectors(expected, result);
+
+    result = evaluate<SimpleVector<bool>>(
+        fmt::format("if(c1 >= 37 and c1 <= 900, c0 IN ('{}'), true)", value),
+        rowVector);
+    expected = makeFlatVector<bool>(size, [&](auto row) {
+      return row < 37 || row > 900 || strings[row % strings.size()] == value;
+    });
+    assertEqualVectors(expected, result);
+  }
+}
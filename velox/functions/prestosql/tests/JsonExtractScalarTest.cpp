@@ -97,6 +97,82 @@ TEST_F(JsonExtractScalarTest, overflow) {
       std::nullopt);
 }
 
+TEST_F(JsonExtractScalarTest, multiplePaths) {
+  using S = StringView;
+  std::vector<std::string> jsons = {
+      R"({"a": 1, "b": ["x", "y"], "c": {"d": true}})",
+      // Parsed for the double and the escaped string.
+      R"({"a": 1.5, "b": ["x", "y\n"], "c": {"d": false}})",
+      R"({"a": [1], "c": {"d": null}})",
+      R"({"a": 1, "b": ["x", "y"])",
+  };
+  auto data = makeRowVector({makeFlatVector<StringView>(
+      jsons.size(), [&](vector_size_t row) { return S(jsons[row]); })});
+
+  auto result = evaluate<ArrayVector>(
+      "json_extract_scalars(c0, ARRAY['$.a', '$.b[1]', '$.c.d', '$.a'])",
+      data);
+  auto expected = makeNullableArrayVector<StringView>({
+      {S("1"), S("y"), S("true"), S("1")},
+      {S("1.5"), S("y\n"), S("false"), S("1.5")},
+      {std::nullopt, std::nullopt, std::nullopt, std::nullopt},
+      {std::nullopt, std::nullopt, std::nullopt, std::nullopt},
+  });
+  assertEqualVectors(expected, result);
+
+  // Each path gives the same result as json_extract_scalar().
+  result =
+      evaluate<ArrayVector>("json_extract_scalars(c0, ARRAY['$.b[0]'])", data);
+  auto single = evaluate<SimpleVector<StringView>>(
+      "json_extract_scalar(c0, '$.b[0]')", data);
+  auto elements = result->elements()->as<SimpleVector<StringView>>();
+  for (auto i = 0; i < data->size(); ++i) {
+    auto offset = result->offsetAt(i);
+    EXPECT_EQ(single->isNullAt(i), elements->isNullAt(offset));
+    if (!single->isNullAt(i)) {
+      EXPECT_EQ(single->valueAt(i), elements->valueAt(offset));
+    }
+  }
+
+  EXPECT_THROW(
+      evaluate<ArrayVector>("json_extract_scalars(c0, ARRAY['$k1'])", data),
+      VeloxUserError);
+}
+
+TEST_F(JsonExtractScalarTest, noCopy) {
+  using S = StringView;
+  std::vector<std::string> jsons = {
+      R"({"k": "a value longer than inline"})",
+      // Parsed for the escaped string.
+      R"({"k": "an escaped value longer than \"inline\""})",
+      R"({"k": 12345678901234567})",
+      R"({"k": "short"})",
+  };
+  auto input = makeFlatVector<StringView>(
+      jsons.size(), [&](vector_size_t row) { return S(jsons[row]); });
+  auto result = evaluate<FlatVector<StringView>>(
+      "json_extract_scalar(c0, '$.k')", makeRowVector({input}));
+  auto expected = makeFlatVector<StringView>({
+      S("a value longer than inline"),
+      S("an escaped value longer than \"inline\""),
+      S("12345678901234567"),
+      S("short"),
+  });
+  assertEqualVectors(expected, result);
+
+  // The results found in the text refer to the input.
+  for (auto& buffer : input->stringBuffers()) {
+    EXPECT_NE(
+        std::find(
+            result->stringBuffers().begin(),
+            result->stringBuffers().end(),
+            buffer),
+        result->stringBuffers().end());
+  }
+  auto prefixSize = strlen(R"({"k": ")");
+  EXPECT_EQ(result->valueAt(0).data(), input->valueAt(0).data() + prefixSize);
+}
+
 } // namespace
 
 } // namespace facebook::velox::functions::prestosql
@@ -51,6 +51,40 @@ TEST_F(ReduceTest, basic) {
   assertEqualVectors(expectedResult, result);
 }
 
+// A few long arrays among many short and empty ones. The arrays drop out
+// of the loop at different steps.
+TEST_F(ReduceTest, skewedSizes) {
+  vector_size_t size = 1'000;
+  auto sizeAt = [](auto row) { return row % 100 == 0 ? 200 : row % 3; };
+  auto inputArray = makeArrayVector<int64_t>(
+      size,
+      sizeAt,
+      [](auto row, auto index) { return row + index; },
+      nullEvery(7));
+  auto input = makeRowVector({inputArray});
+  registerLambda(
+      "sum_input",
+      rowType("s", BIGINT(), "x", BIGINT()),
+      input->type(),
+      "s + x");
+  registerLambda("sum_output", rowType("s", BIGINT()), input->type(), "s");
+
+  auto result = evaluate<SimpleVector<int64_t>>(
+      "reduce(c0, 1, function('sum_input'), function('sum_output'))", input);
+
+  auto expectedResult = makeFlatVector<int64_t>(
+      size,
+      [&](auto row) {
+        int64_t sum = 1;
+        for (auto i = 0; i < sizeAt(row); i++) {
+          sum += row + i;
+        }
+        return sum;
+      },
+      nullEvery(7));
+  assertEqualVectors(expectedResult, result);
+}
+
 // Types of array elements, intermediate results and final results are all
 // different: BIGINT vs. DOUBLE vs. BOOLEAN:
 //  reduce(a, 100, (s, x) -> s + x * 0.1, s -> s < 101)
@@ -150,3 +150,28 @@ TEST_F(TransformTest, dictionaryWithDuplicates) {
 
   assertEqualVectors(expectedResult, result);
 }
+
+// Test a lambda with a common subexpression applied twice in one batch. The
+// values of the subexpression must not carry over between the applications.
+TEST_F(TransformTest, sharedSubexpressionInLambda) {
+  vector_size_t size = 1'000;
+  auto inputArray =
+      makeArrayVector<int64_t>(size, modN(5), modN(7), nullEvery(11));
+  auto input = makeRowVector({inputArray});
+  registerLambda(
+      "square1", rowType("x", BIGINT()), input->type(), "(x + 1) * (x + 1)");
+
+  auto result = evaluate<ArrayVector>(
+      "transform(transform(c0, function('square1')), function('square1'))",
+      input);
+
+  auto expectedResult = makeArrayVector<int64_t>(
+      size,
+      modN(5),
+      [](vector_size_t row) {
+        auto square = (row % 7 + 1) * (row % 7 + 1);
+        return (square + 1) * (square + 1);
+      },
+      nullEvery(11));
+  assertEqualVectors(expectedResult, result);
+}
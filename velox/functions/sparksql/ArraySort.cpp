@@ -21,7 +21,7 @@
 #include "velox/expression/Expr.h"
 #include "velox/expression/VectorFunction.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
-#include "velox/functions/sparksql/Comparisons.h"
+#include "velox/functions/lib/SortKernels.h"
 #include "velox/type/Type.h"
 #include "velox/vector/BaseVector.h"
 #include "velox/vector/ComplexVector.h"
@@ -55,6 +55,7 @@ void applyTyped(
   T* resultRawValues = resultFlatElements->mutableRawValues();
 
   vector_size_t resultOffset = 0;
+  std::vector<T> scratch;
   auto processRow = [&](vector_size_t row) {
     auto size = inputArray->sizeAt(row);
     auto inputOffset = inputArray->offsetAt(row);
@@ -76,7 +77,9 @@ void applyTyped(
           ++numNulls;
         }
       }
-      std::sort(rowValues, rowValues + size - numNulls, Greater<T>());
+      // NaN is the largest value.
+      SortKernels::sortWithNaNs(
+          rowValues, rowValues + size - numNulls, true, scratch);
     } else {
       // Move nulls to beginning of array
       vector_size_t numNulls = 0;
@@ -87,7 +90,8 @@ void applyTyped(
           ++numNulls;
         }
       }
-      std::sort(rowValues + numNulls, rowValues + size, Less<T>());
+      SortKernels::sortWithNaNs(
+          rowValues + numNulls, rowValues + size, false, scratch);
     }
     resultOffset += size;
   };
@@ -113,5 +113,33 @@ TEST_F(HashTest, Float) {
   EXPECT_EQ(hash<float>(-limits::infinity()), 427440766);
 }
 
+TEST_F(HashTest, batch) {
+  // 8 row batches with a tail. Rows without nulls are hashed in batches
+  // and must match hashing one row at a time.
+  constexpr vector_size_t kSize = 101;
+  auto ints = makeFlatVector<int32_t>(
+      kSize, [](vector_size_t row) { return row * 0x9e3779b9; });
+  auto bigints = makeFlatVector<int64_t>(
+      kSize, [](vector_size_t row) { return row * 0x9e3779b97f4a7c15; });
+  auto data = makeRowVector(
+      {ints,
+       bigints,
+       wrapInDictionary(makeIndicesInReverse(kSize), kSize, ints),
+       wrapInDictionary(makeIndicesInReverse(kSize), kSize, bigints)});
+  auto result = evaluate<FlatVector<int32_t>>("hash(c0, c1, c2, c3)", data);
+  for (auto i = 0; i < kSize; ++i) {
+    auto reversed = kSize - 1 - i;
+    EXPECT_EQ(
+        result->valueAt(i),
+        evaluateOnce<int32_t>(
+            "hash(c0, c1, c2, c3)",
+            std::optional(ints->valueAt(i)),
+            std::optional(bigints->valueAt(i)),
+            std::optional(ints->valueAt(reversed)),
+            std::optional(bigints->valueAt(reversed))))
+        << "at " << i;
+  }
+}
+
 } // namespace
 } // namespace facebook::velox::functions::sparksql::test
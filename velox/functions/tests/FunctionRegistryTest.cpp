@@ -330,7 +330,7 @@ TEST_F(FunctionRegistryTest, getFunctionSignatures) {
 
 TEST_F(FunctionRegistryTest, hasScalarFunctionSignature) {
   auto result = resolveFunction("func_one", {VARCHAR()});
-  ASSERT_EQ(*result, *VARCHAR());
+  ASSERT_EQ(*result, *BIGINT());
 }
 
 TEST_F(FunctionRegistryTest, hasScalarFunctionSignatureWrongArgType) {
@@ -373,4 +373,30 @@ TEST_F(FunctionRegistryTest, hasVectorFunctionSignatureWrongFunctionName) {
   ASSERT_EQ(result, nullptr);
 }
 
+TEST_F(FunctionRegistryTest, resolveAfterRegistration) {
+  // Repeated resolution returns the same memoized result.
+  auto result = resolveFunction("vector_func_two", {ARRAY(VARCHAR())});
+  ASSERT_EQ(*result, *ARRAY(BIGINT()));
+  ASSERT_EQ(
+      resolveFunction("vector_func_two", {ARRAY(VARCHAR())}).get(),
+      result.get());
+
+  // A function registered after a failed resolution is found.
+  ASSERT_EQ(resolveFunction("vector_func_late", {VARCHAR()}), nullptr);
+  exec::registerVectorFunction(
+      "vector_func_late",
+      VectorFuncOne::signatures(),
+      std::make_unique<VectorFuncOne>());
+  result = resolveFunction("vector_func_late", {VARCHAR()});
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(*result, *BIGINT());
+
+  // Overwriting a function changes the resolution.
+  exec::registerVectorFunction(
+      "vector_func_late",
+      VectorFuncTwo::signatures(),
+      std::make_unique<VectorFuncTwo>());
+  ASSERT_EQ(resolveFunction("vector_func_late", {VARCHAR()}), nullptr);
+}
+
 } // namespace facebook::velox
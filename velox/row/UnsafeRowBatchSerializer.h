@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/row/UnsafeRow.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::row {
+
+/// Serializes a whole RowVector to UnsafeRows one column at a time. The
+/// per-row serializers in UnsafeRowDynamicSerializer.h dispatch on the type
+/// of every field of every row. This serializer computes the null set length
+/// and the fixed-width field offsets once per schema, writes each fixed-width
+/// column with strided stores across all rows and then appends the
+/// variable-width data in a second pass. The output is byte-for-byte the same
+/// as UnsafeRowDynamicSerializer with each row padded to the field width.
+///
+/// Only top-level fixed-width, VARCHAR and VARBINARY columns are supported.
+/// Rows with complex type columns should use UnsafeRowDynamicSerializer.
+///
+/// Usage:
+///   UnsafeRowBatchSerializer serializer(asRowType(data->type()));
+///   auto size = serializer.prepare(data);
+///   ... allocate 'size' bytes at 'buffer' ...
+///   serializer.serialize(buffer);
+///   // Row i is at buffer + rowOffsets()[i] and is rowSizes()[i] bytes.
+class UnsafeRowBatchSerializer {
+ public:
+  explicit UnsafeRowBatchSerializer(RowTypePtr rowType)
+      : rowType_(std::move(rowType)),
+        nullLength_(UnsafeRow::getNullLength(rowType_->size())),
+        fixedRowSize_(
+            nullLength_ + rowType_->size() * UnsafeRow::kFieldWidthBytes) {
+    VELOX_USER_CHECK(
+        isSupported(rowType_),
+        "Unsupported type for batch UnsafeRow serialization: {}",
+        rowType_->toString());
+    for (auto i = 0; i < rowType_->size(); ++i) {
+      if (!rowType_->childAt(i)->isFixedWidth()) {
+        variableWidthColumns_.push_back(i);
+      }
+    }
+  }
+
+  /// Returns true if all top-level columns of 'rowType' are fixed-width,
+  /// VARCHAR or VARBINARY.
+  static bool isSupported(const RowTypePtr& rowType) {
+    for (const auto& child : rowType->children()) {
+      if (!child->isFixedWidth() && child->kind() != TypeKind::VARCHAR &&
+          child->kind() != TypeKind::VARBINARY) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Returns the size of the null set plus the fixed-width fields. This is
+  /// the size of every row without variable-width data.
+  size_t fixedRowSize() const {
+    return fixedRowSize_;
+  }
+
+  /// Decodes the columns of 'data' and computes the size and offset of each
+  /// serialized row. 'data' must stay alive until serialize() returns.
+  /// \return the total number of bytes serialize() will write.
+  size_t prepare(const RowVectorPtr& data) {
+    VELOX_CHECK_EQ(data->childrenSize(), rowType_->size());
+    numRows_ = data->size();
+    SelectivityVector allRows(numRows_);
+    decoded_.resize(rowType_->size());
+    for (auto i = 0; i < rowType_->size(); ++i) {
+      decoded_[i].decode(*data->childAt(i), allRows);
+    }
+
+    rowSizes_.assign(numRows_, fixedRowSize_);
+    for (auto column : variableWidthColumns_) {
+      const auto& decoded = decoded_[column];
+      for (auto row = 0; row < numRows_; ++row) {
+        if (!decoded.isNullAt(row)) {
+          rowSizes_[row] += UnsafeRow::alignToFieldWidth(
+              decoded.valueAt<StringView>(row).size());
+        }
+      }
+    }
+
+    rowOffsets_.resize(numRows_);
+    size_t totalSize = 0;
+    for (auto row = 0; row < numRows_; ++row) {
+      rowOffsets_[row] = totalSize;
+      totalSize += rowSizes_[row];
+    }
+    return totalSize;
+  }
+
+  /// Serializes the rows of the vector passed to the last prepare() call.
+  /// \param buffer must have space for the size returned by prepare().
+  void serialize(char* buffer) {
+    VELOX_CHECK_NOT_NULL(buffer);
+    for (auto row = 0; row < numRows_; ++row) {
+      std::memset(buffer + rowOffsets_[row], 0, nullLength_);
+    }
+    for (auto i = 0; i < rowType_->size(); ++i) {
+      VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+          writeFixedWidthColumn, rowType_->childAt(i)->kind(), i, buffer);
+    }
+    if (variableWidthColumns_.empty()) {
+      return;
+    }
+    variableOffsets_.assign(numRows_, fixedRowSize_);
+    for (auto column : variableWidthColumns_) {
+      writeVariableWidthColumn(column, buffer);
+    }
+  }
+
+  /// Offset of each serialized row from the start of the buffer.
+  const std::vector<size_t>& rowOffsets() const {
+    return rowOffsets_;
+  }
+
+  /// Size in bytes of each serialized row, a multiple of the field width.
+  const std::vector<size_t>& rowSizes() const {
+    return rowSizes_;
+  }
+
+ private:
+  template <typename T>
+  static uint64_t toWord(T value) {
+    uint64_t word = 0;
+    std::memcpy(&word, &value, sizeof(T));
+    return word;
+  }
+
+  template <TypeKind Kind>
+  uint64_t wordAt(const DecodedVector& decoded, vector_size_t row) const {
+    if constexpr (Kind == TypeKind::BOOLEAN) {
+      return bits::isBitSet(decoded.data<uint64_t>(), decoded.index(row));
+    } else if constexpr (Kind == TypeKind::TIMESTAMP) {
+      // Follow Spark, serialize timestamp as micros.
+      return toWord(decoded.valueAt<Timestamp>(row).toMicros());
+    } else {
+      using T = typename TypeTraits<Kind>::NativeType;
+      return toWord(decoded.valueAt<T>(row));
+    }
+  }
+
+  /// Writes the null bits of the column at 'column' and, for fixed-width
+  /// types, the values. Variable-width values are written by
+  /// writeVariableWidthColumn() once all fixed-width fields are in place.
+  template <TypeKind Kind>
+  void writeFixedWidthColumn(size_t column, char* buffer) {
+    constexpr bool kVariableWidth =
+        Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY;
+    const auto& decoded = decoded_[column];
+    const size_t fieldOffset =
+        nullLength_ + column * UnsafeRow::kFieldWidthBytes;
+    char* field = buffer + fieldOffset;
+
+    if (!decoded.mayHaveNulls()) {
+      if constexpr (!kVariableWidth) {
+        for (auto row = 0; row < numRows_; ++row) {
+          *reinterpret_cast<uint64_t*>(field + rowOffsets_[row]) =
+              wordAt<Kind>(decoded, row);
+        }
+      }
+      return;
+    }
+
+    for (auto row = 0; row < numRows_; ++row) {
+      auto* word = reinterpret_cast<uint64_t*>(field + rowOffsets_[row]);
+      if (decoded.isNullAt(row)) {
+        bits::setBit(buffer + rowOffsets_[row], column);
+        *word = 0;
+      } else if constexpr (!kVariableWidth) {
+        *word = wordAt<Kind>(decoded, row);
+      }
+    }
+  }
+
+  /// Appends the values of a VARCHAR or VARBINARY column after the data
+  /// already written to each row and sets the offset and size fields.
+  void writeVariableWidthColumn(size_t column, char* buffer) {
+    const auto& decoded = decoded_[column];
+    const size_t fieldOffset =
+        nullLength_ + column * UnsafeRow::kFieldWidthBytes;
+
+    for (auto row = 0; row < numRows_; ++row) {
+      if (decoded.isNullAt(row)) {
+        continue;
+      }
+      auto value = decoded.valueAt<StringView>(row);
+      char* rowStart = buffer + rowOffsets_[row];
+      auto& offset = variableOffsets_[row];
+      *reinterpret_cast<uint64_t*>(rowStart + fieldOffset) =
+          static_cast<uint64_t>(offset) << 32 | value.size();
+      std::memcpy(rowStart + offset, value.data(), value.size());
+      const auto paddedSize = UnsafeRow::alignToFieldWidth(value.size());
+      std::memset(
+          rowStart + offset + value.size(), 0, paddedSize - value.size());
+      offset += paddedSize;
+    }
+  }
+
+  const RowTypePtr rowType_;
+  const size_t nullLength_;
+  const size_t fixedRowSize_;
+  std::vector<size_t> variableWidthColumns_;
+
+  vector_size_t numRows_{0};
+  std::vector<DecodedVector> decoded_;
+  std::vector<size_t> rowSizes_;
+  std::vector<size_t> rowOffsets_;
+  // Offset of the first unwritten byte of each row in the second pass.
+  std::vector<size_t> variableOffsets_;
+};
+
+/// Deserializes a batch of UnsafeRows with the same schema into a RowVector
+/// one column at a time. Supports the same types as
+/// UnsafeRowBatchSerializer.
+class UnsafeRowBatchDeserializer {
+ public:
+  explicit UnsafeRowBatchDeserializer(RowTypePtr rowType)
+      : rowType_(std::move(rowType)),
+        nullLength_(UnsafeRow::getNullLength(rowType_->size())) {
+    VELOX_USER_CHECK(
+        UnsafeRowBatchSerializer::isSupported(rowType_),
+        "Unsupported type for batch UnsafeRow deserialization: {}",
+        rowType_->toString());
+  }
+
+  /// \param rows the serialized rows, each must be 8-byte aligned.
+  /// \param pool the memory pool to allocate Vectors from
+  /// \return a RowVector with one row per element of 'rows'
+  RowVectorPtr deserialize(
+      const std::vector<std::string_view>& rows,
+      memory::MemoryPool* pool) const {
+    std::vector<VectorPtr> children(rowType_->size());
+    for (auto i = 0; i < rowType_->size(); ++i) {
+      children[i] = VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+          readColumn, rowType_->childAt(i)->kind(), i, rows, pool);
+    }
+    return std::make_shared<RowVector>(
+        pool, rowType_, BufferPtr(nullptr), rows.size(), std::move(children));
+  }
+
+ private:
+  static Timestamp timestampFromMicros(int64_t micros) {
+    auto seconds = micros / 1'000'000;
+    auto remainder = micros % 1'000'000;
+    if (remainder < 0) {
+      --seconds;
+      remainder += 1'000'000;
+    }
+    return Timestamp(seconds, remainder * 1'000);
+  }
+
+  template <TypeKind Kind>
+  VectorPtr readColumn(
+      size_t column,
+      const std::vector<std::string_view>& rows,
+      memory::MemoryPool* pool) const {
+    using T = typename TypeTraits<Kind>::NativeType;
+    const vector_size_t numRows = rows.size();
+    const size_t fieldOffset =
+        nullLength_ + column * UnsafeRow::kFieldWidthBytes;
+    auto vector = BaseVector::create(rowType_->childAt(column), numRows, pool);
+    auto* flatVector = vector->asFlatVector<T>();
+
+    uint64_t* rawNulls = nullptr;
+    vector_size_t nullCount = 0;
+    size_t stringBytes = 0;
+    for (auto row = 0; row < numRows; ++row) {
+      if (bits::isBitSet(rows[row].data(), column)) {
+        if (!rawNulls) {
+          rawNulls = vector->mutableRawNulls();
+        }
+        bits::setNull(rawNulls, row);
+        ++nullCount;
+        continue;
+      }
+      uint64_t word = *reinterpret_cast<const uint64_t*>(
+          rows[row].data() + fieldOffset);
+      if constexpr (Kind == TypeKind::BOOLEAN) {
+        bits::setBit(
+            flatVector->template mutableRawValues<uint64_t>(), row, word);
+      } else if constexpr (Kind == TypeKind::TIMESTAMP) {
+        flatVector->mutableRawValues()[row] =
+            timestampFromMicros(static_cast<int64_t>(word));
+      } else if constexpr (std::is_same_v<T, StringView>) {
+        uint32_t size = word;
+        if (!StringView::isInline(size)) {
+          stringBytes += size;
+        }
+      } else {
+        std::memcpy(&flatVector->mutableRawValues()[row], &word, sizeof(T));
+      }
+    }
+    vector->setNullCount(nullCount);
+
+    if constexpr (std::is_same_v<T, StringView>) {
+      readStrings(flatVector, fieldOffset, rows, stringBytes);
+    }
+    return vector;
+  }
+
+  /// Copies all non-inlined strings of a column into one string buffer.
+  static void readStrings(
+      FlatVector<StringView>* flatVector,
+      size_t fieldOffset,
+      const std::vector<std::string_view>& rows,
+      size_t stringBytes) {
+    char* stringData = nullptr;
+    if (stringBytes > 0) {
+      auto* buffer = flatVector->getBufferWithSpace(stringBytes);
+      stringData = buffer->asMutable<char>() + buffer->size();
+      buffer->setSize(buffer->size() + stringBytes);
+    }
+    auto* rawValues = flatVector->mutableRawValues();
+    for (auto row = 0; row < rows.size(); ++row) {
+      if (flatVector->isNullAt(row)) {
+        continue;
+      }
+      uint64_t word =
+          *reinterpret_cast<const uint64_t*>(rows[row].data() + fieldOffset);
+      uint32_t size = word;
+      const char* data = rows[row].data() + (word >> 32);
+      if (StringView::isInline(size)) {
+        rawValues[row] = StringView(data, size);
+      } else {
+        std::memcpy(stringData, data, size);
+        rawValues[row] = StringView(stringData, size);
+        stringData += size;
+      }
+    }
+  }
+
+  const RowTypePtr rowType_;
+  const size_t nullLength_;
+};
+
+} // namespace facebook::velox::row
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/row/UnsafeRowBatchSerializer.h"
+#include <gtest/gtest.h>
+
+#include "velox/row/UnsafeRowDynamicSerializer.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+namespace facebook::velox::row {
+namespace {
+
+class UnsafeRowBatchSerializerTest : public ::testing::Test {
+ protected:
+  /// Serializes 'data' with UnsafeRowBatchSerializer and checks that every
+  /// row matches the output of UnsafeRowDynamicSerializer. Returns the
+  /// serialized rows.
+  std::vector<std::string_view> serializeAndCompare(
+      const RowVectorPtr& data) {
+    auto rowType = std::dynamic_pointer_cast<const RowType>(data->type());
+    UnsafeRowBatchSerializer serializer(rowType);
+    auto totalSize = serializer.prepare(data);
+    batchBuffer_ = AlignedBuffer::allocate<char>(totalSize, pool_.get());
+    char* batch = batchBuffer_->asMutable<char>();
+    serializer.serialize(batch);
+
+    std::vector<std::string_view> rows;
+    for (auto i = 0; i < data->size(); ++i) {
+      std::memset(buffer_, 0, kBufferSize);
+      auto expectedSize =
+          UnsafeRowDynamicSerializer::serialize(rowType, data, buffer_, i);
+      EXPECT_EQ(
+          UnsafeRow::alignToFieldWidth(expectedSize.value()),
+          serializer.rowSizes()[i]);
+      const char* row = batch + serializer.rowOffsets()[i];
+      EXPECT_EQ(0, std::memcmp(row, buffer_, serializer.rowSizes()[i]))
+          << "Mismatch at row " << i;
+      rows.emplace_back(row, serializer.rowSizes()[i]);
+    }
+    return rows;
+  }
+
+  void assertEqualRows(const RowVectorPtr& expected, const VectorPtr& actual) {
+    ASSERT_EQ(expected->size(), actual->size());
+    for (auto i = 0; i < expected->size(); ++i) {
+      ASSERT_TRUE(expected->equalValueAt(actual.get(), i, i))
+          << "at " << i << ": " << expected->toString(i) << " vs. "
+          << actual->toString(i);
+    }
+  }
+
+  static constexpr size_t kBufferSize = 1024;
+
+  std::unique_ptr<memory::ScopedMemoryPool> pool_ =
+      memory::getDefaultScopedMemoryPool();
+  BufferPtr bufferPtr_ =
+      AlignedBuffer::allocate<char>(kBufferSize, pool_.get(), true);
+  char* buffer_ = bufferPtr_->asMutable<char>();
+  BufferPtr batchBuffer_;
+  std::unique_ptr<velox::test::VectorMaker> vectorMaker_ =
+      std::make_unique<velox::test::VectorMaker>(pool_.get());
+};
+
+TEST_F(UnsafeRowBatchSerializerTest, fixedWidth) {
+  auto data = vectorMaker_->rowVector({
+      vectorMaker_->flatVectorNullable<int64_t>(
+          {0x0101010101010101, std::nullopt, -1, 0x0123456789ABCDEF}),
+      vectorMaker_->flatVectorNullable<int32_t>(
+          {std::nullopt, -2, 0x0AAAAAAA, 0x0BBBBBBB}),
+      vectorMaker_->flatVector<int16_t>({0x1111, -3, 0x7E00, 0x1234}),
+      vectorMaker_->flatVectorNullable<int8_t>({1, 2, std::nullopt, -4}),
+      vectorMaker_->flatVectorNullable<bool>(
+          {true, false, std::nullopt, true}),
+      vectorMaker_->flatVector<float>({1.5, -2.5, 0, 3.25}),
+      vectorMaker_->flatVectorNullable<double>(
+          {std::nullopt, 1.0 / 3, -7.5, 1e100}),
+      vectorMaker_->constantVector<int32_t>(
+          std::vector<std::optional<int32_t>>(4, 0x22222222)),
+      vectorMaker_->constantVector<int32_t>(
+          std::vector<std::optional<int32_t>>(4, std::nullopt)),
+      vectorMaker_->flatVectorNullable<Timestamp>(
+          {Timestamp(1, 2'000),
+           std::nullopt,
+           Timestamp(-1, 2'000),
+           Timestamp(0, 0xFF * 1'000)}),
+  });
+
+  auto rows = serializeAndCompare(data);
+  UnsafeRowBatchSerializer serializer(
+      std::dynamic_pointer_cast<const RowType>(data->type()));
+  for (auto i = 0; i < rows.size(); ++i) {
+    EXPECT_EQ(serializer.fixedRowSize(), rows[i].size());
+  }
+
+  UnsafeRowBatchDeserializer deserializer(
+      std::dynamic_pointer_cast<const RowType>(data->type()));
+  assertEqualRows(data, deserializer.deserialize(rows, pool_.get()));
+}
+
+TEST_F(UnsafeRowBatchSerializerTest, variableWidth) {
+  auto data = vectorMaker_->rowVector({
+      vectorMaker_->flatVectorNullable<int64_t>({1, 2, std::nullopt, 4, 5}),
+      vectorMaker_->flatVectorNullable(
+          {"hello",
+           std::nullopt,
+           "",
+           "a string longer than the inline limit",
+           "world"}),
+      vectorMaker_->flatVector<int32_t>({10, 20, 30, 40, 50}),
+      vectorMaker_->flatVectorNullable(
+          {std::optional<std::string>("12345678"),
+           std::optional<std::string>("another one longer than 12"),
+           std::nullopt,
+           std::nullopt,
+           std::optional<std::string>("x")},
+          VARBINARY()),
+      vectorMaker_->dictionaryVector<StringView>(
+          {StringView("abc"),
+           std::nullopt,
+           StringView("abc"),
+           StringView("dictionary encoded value"),
+           StringView("dictionary encoded value")}),
+  });
+
+  auto rows = serializeAndCompare(data);
+  UnsafeRowBatchDeserializer deserializer(
+      std::dynamic_pointer_cast<const RowType>(data->type()));
+  assertEqualRows(data, deserializer.deserialize(rows, pool_.get()));
+}
+
+TEST_F(UnsafeRowBatchSerializerTest, unsupportedType) {
+  auto rowType = ROW({"a", "b"}, {BIGINT(), ARRAY(BIGINT())});
+  EXPECT_FALSE(UnsafeRowBatchSerializer::isSupported(rowType));
+  EXPECT_THROW(UnsafeRowBatchSerializer{rowType}, VeloxUserError);
+  EXPECT_THROW(UnsafeRowBatchDeserializer{rowType}, VeloxUserError);
+}
+
+} // namespace
+} // namespace facebook::velox::row
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/serializers/CompactRowSerializer.h"
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::serializer {
+namespace {
+
+// The row serde reads the values of the children directly.
+void loadChildren(const RowVector& vector) {
+  for (auto i = 0; i < vector.childrenSize(); ++i) {
+    vector.loadedChildAt(i);
+  }
+}
+
+class CompactRowSerializer : public VectorSerializer {
+ public:
+  CompactRowSerializer(const RowSerde& rowSerde, StreamArena* streamArena)
+      : rowSerde_(rowSerde), data_(streamArena) {
+    data_.startWrite(memory::MappedMemory::kPageSize);
+  }
+
+  void append(
+      std::shared_ptr<RowVector> vector,
+      const folly::Range<const IndexRange*>& ranges) override {
+    loadChildren(*vector);
+    for (const auto& range : ranges) {
+      for (auto row = range.begin; row < range.begin + range.size; ++row) {
+        rowSerde_.serialize(*vector, row, data_);
+      }
+      numRows_ += range.size;
+    }
+  }
+
+  void appendSerializedRows(
+      const SerializedRows& rows,
+      const folly::Range<const IndexRange*>& ranges) override {
+    // The rows of a range are consecutive in 'rows' and are copied at once.
+    for (const auto& range : ranges) {
+      auto begin = rows.offsets[range.begin];
+      auto end = rows.offsets[range.begin + range.size];
+      data_.appendStringPiece(
+          folly::StringPiece(rows.data.data() + begin, end - begin));
+      numRows_ += range.size;
+    }
+  }
+
+  void flush(std::ostream* out) override {
+    out->write(reinterpret_cast<const char*>(&numRows_), sizeof(numRows_));
+    data_.flush(out);
+  }
+
+ private:
+  const RowSerde& rowSerde_;
+  ByteStream data_;
+  int32_t numRows_{0};
+};
+
+// Returns the serialized size of a non-null value at 'row' of 'vector'.
+vector_size_t estimateValueSize(
+    const RowSerde& rowSerde,
+    const BaseVector& vector,
+    vector_size_t row,
+    ByteStream* scratch) {
+  const auto& type = vector.type();
+  if (type->isFixedWidth()) {
+    return type->cppSizeInBytes();
+  }
+  if (type->kind() == TypeKind::VARCHAR ||
+      type->kind() == TypeKind::VARBINARY) {
+    return sizeof(int32_t) +
+        vector.asUnchecked<SimpleVector<StringView>>()->valueAt(row).size();
+  }
+  auto before = scratch->size();
+  rowSerde.serialize(vector, row, *scratch);
+  return scratch->size() - before;
+}
+
+} // namespace
+
+void CompactRowVectorSerde::estimateSerializedSize(
+    std::shared_ptr<BaseVector> vector,
+    const folly::Range<const IndexRange*>& ranges,
+    vector_size_t** sizes) {
+  const auto* loaded = vector->loadedVector();
+  // Complex type values are measured by serializing them.
+  std::unique_ptr<StreamArena> arena;
+  std::unique_ptr<ByteStream> scratch;
+  if (!loaded->type()->isPrimitiveType()) {
+    arena = std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
+    scratch = std::make_unique<ByteStream>(arena.get());
+    scratch->startWrite(memory::MappedMemory::kPageSize);
+  }
+  for (auto i = 0; i < ranges.size(); ++i) {
+    const auto& range = ranges[i];
+    for (auto row = range.begin; row < range.begin + range.size; ++row) {
+      if (!loaded->isNullAt(row)) {
+        *sizes[i] += estimateValueSize(rowSerde_, *loaded, row, scratch.get());
+      }
+    }
+  }
+}
+
+std::unique_ptr<VectorSerializer> CompactRowVectorSerde::createSerializer(
+    std::shared_ptr<const RowType> /*type*/,
+    int32_t /*numRows*/,
+    StreamArena* streamArena,
+    const Options* /*options*/) {
+  // Pages are not compressed. Rows copied to many small pages compress
+  // poorly and the point of this format is to avoid re-encoding.
+  return std::make_unique<CompactRowSerializer>(rowSerde_, streamArena);
+}
+
+void CompactRowVectorSerde::serializeRows(
+    const std::shared_ptr<RowVector>& vector,
+    memory::MappedMemory* mappedMemory,
+    SerializedRows& rows) {
+  loadChildren(*vector);
+  StreamArena arena(mappedMemory);
+  ByteStream stream(&arena);
+  stream.startWrite(memory::MappedMemory::kPageSize);
+
+  const auto numRows = vector->size();
+  rows.offsets.resize(numRows + 1);
+  rows.offsets[0] = 0;
+  // Bytes in the ranges of 'stream' before the last one.
+  size_t completedBytes = 0;
+  size_t numCompletedRanges = 0;
+  for (auto row = 0; row < numRows; ++row) {
+    rowSerde_.serialize(*vector, row, stream);
+    const auto& ranges = stream.ranges();
+    while (numCompletedRanges + 1 < ranges.size()) {
+      completedBytes += ranges[numCompletedRanges++].position;
+    }
+    rows.offsets[row + 1] = completedBytes + ranges.back().position;
+  }
+
+  rows.data.clear();
+  rows.data.reserve(rows.offsets[numRows]);
+  for (const auto& range : stream.ranges()) {
+    rows.data.append(
+        reinterpret_cast<const char*>(range.buffer), range.position);
+  }
+}
+
+void CompactRowVectorSerde::deserialize(
+    ByteStream* source,
+    velox::memory::MemoryPool* pool,
+    std::shared_ptr<const RowType> type,
+    std::shared_ptr<RowVector>* result) {
+  auto numRows = source->read<int32_t>();
+  // The result is not reused since deserializing complex types appends to
+  // the elements of the previous result.
+  *result = std::dynamic_pointer_cast<RowVector>(
+      BaseVector::create(type, numRows, pool));
+  for (auto row = 0; row < numRows; ++row) {
+    rowSerde_.deserialize(*source, row, result->get());
+  }
+}
+
+// static
+void CompactRowVectorSerde::registerVectorSerde(const RowSerde& rowSerde) {
+  velox::registerVectorSerde(std::make_unique<CompactRowVectorSerde>(rowSerde));
+}
+
+} // namespace facebook::velox::serializer
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/vector/RowSerde.h"
+#include "velox/vector/VectorStream.h"
+
+namespace facebook::velox::serializer {
+
+// Row-wise VectorSerde for repartitioning with many destinations. Each row
+// is written in the compact row format of a RowSerde, e.g. the one used for
+// complex types in RowContainer: a null flag per column followed by the
+// non-null values. Since rows are independent, PartitionedOutput serializes
+// each input row once and copies the bytes to the page of its destination.
+// The receiving side deserializes each page into one vector.
+//
+// The wire format of a page is the row count followed by the rows.
+class CompactRowVectorSerde : public VectorSerde {
+ public:
+  // 'rowSerde' must outlive 'this'.
+  explicit CompactRowVectorSerde(const RowSerde& rowSerde)
+      : rowSerde_(rowSerde) {}
+
+  void estimateSerializedSize(
+      std::shared_ptr<BaseVector> vector,
+      const folly::Range<const IndexRange*>& ranges,
+      vector_size_t** sizes) override;
+
+  std::unique_ptr<VectorSerializer> createSerializer(
+      std::shared_ptr<const RowType> type,
+      int32_t numRows,
+      StreamArena* streamArena,
+      const Options* options = nullptr) override;
+
+  void deserialize(
+      ByteStream* source,
+      velox::memory::MemoryPool* pool,
+      std::shared_ptr<const RowType> type,
+      std::shared_ptr<RowVector>* result) override;
+
+  bool isRowWise() const override {
+    return true;
+  }
+
+  void serializeRows(
+      const std::shared_ptr<RowVector>& vector,
+      memory::MappedMemory* mappedMemory,
+      SerializedRows& rows) override;
+
+  static void registerVectorSerde(const RowSerde& rowSerde);
+
+ private:
+  const RowSerde& rowSerde_;
+};
+
+} // namespace facebook::velox::serializer
@@ -15,6 +15,10 @@
  */
 #include "velox/serializers/PrestoSerializer.h"
 #include <boost/crc.hpp>
+#include <folly/Random.h>
+#include <folly/container/F14Map.h>
+#include <lz4.h>
+#include <zstd.h>
 #include "velox/functions/prestosql/TimestampWithTimeZoneType.h"
 #include "velox/vector/BiasVector.h"
 #include "velox/vector/ComplexVector.h"
@@ -26,6 +30,18 @@ namespace {
 static int8_t kCompressedBitMask = 1;
 static int8_t kEncryptedBitMask = 2;
 static int8_t kCheckSumBitMask = 4;
+// Set together with kCompressedBitMask for pages compressed with ZSTD.
+// Pages with only kCompressedBitMask are compressed with LZ4.
+static int8_t kZstdBitMask = 8;
+
+static constexpr int32_t kZstdLevel = 1;
+
+// Names of the encodings of a column that are not specific to the type.
+static const char* kDictionary = "DICTIONARY";
+static const char* kRle = "RLE";
+// A DICTIONARY column is followed by an id of the dictionary, which is
+// 3 int64s.
+static constexpr int32_t kDictionaryIdSize = 3 * sizeof(int64_t);
 
 int64_t computeChecksum(
     const std::string& stringData,
@@ -44,11 +60,12 @@ int64_t computeChecksum(
     ByteStream* source,
     int codecMarker,
     int numRows,
-    int uncompressedSize) {
+    int uncompressedSize,
+    int sizeInBytes) {
   auto offset = source->tellp();
   boost::crc_32_type crc32;
 
-  auto remainingBytes = uncompressedSize;
+  auto remainingBytes = sizeInBytes;
   while (remainingBytes > 0) {
     auto data = source->nextView(remainingBytes);
     crc32.process_bytes(data.data(), data.size());
@@ -83,6 +100,69 @@ bool isChecksumBitSet(int8_t codec) {
   return (codec & kCheckSumBitMask) == kCheckSumBitMask;
 }
 
+bool isZstdBitSet(int8_t codec) {
+  return (codec & kZstdBitMask) == kZstdBitMask;
+}
+
+// Compresses 'data' into 'compressed'. Returns false if the compressed
+// form would be larger than 'maxSize' bytes.
+bool compress(
+    VectorSerdeCompression compression,
+    const std::string& data,
+    int32_t maxSize,
+    std::string& compressed) {
+  switch (compression) {
+    case VectorSerdeCompression::kLz4: {
+      compressed.resize(LZ4_compressBound(data.size()));
+      auto size = LZ4_compress_default(
+          data.data(), compressed.data(), data.size(), compressed.size());
+      if (size <= 0 || size > maxSize) {
+        return false;
+      }
+      compressed.resize(size);
+      return true;
+    }
+    case VectorSerdeCompression::kZstd: {
+      compressed.resize(ZSTD_compressBound(data.size()));
+      auto size = ZSTD_compress(
+          compressed.data(),
+          compressed.size(),
+          data.data(),
+          data.size(),
+          kZstdLevel);
+      if (ZSTD_isError(size) || size > static_cast<size_t>(maxSize)) {
+        return false;
+      }
+      compressed.resize(size);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void decompress(
+    int8_t codec,
+    const std::string& compressed,
+    int32_t uncompressedSize,
+    std::string& data) {
+  data.resize(uncompressedSize);
+  if (isZstdBitSet(codec)) {
+    auto size = ZSTD_decompress(
+        data.data(), data.size(), compressed.data(), compressed.size());
+    VELOX_CHECK(
+        !ZSTD_isError(size) && size == data.size(),
+        "Failed to decompress a ZSTD serialized page");
+  } else {
+    auto size = LZ4_decompress_safe(
+        compressed.data(), data.data(), compressed.size(), data.size());
+    VELOX_CHECK_EQ(
+        size,
+        uncompressedSize,
+        "Failed to decompress an LZ4 serialized page");
+  }
+}
+
 std::string typeToEncodingName(const TypePtr& type) {
   switch (type->kind()) {
     case TypeKind::BOOLEAN:
@@ -216,6 +296,90 @@ readNulls(ByteStream* source, vector_size_t size, BaseVector* result) {
   return nullCount;
 }
 
+// Keeps the memory of a page alive while vectors reference it in place.
+struct InputOwnerReleaser {
+  explicit InputOwnerReleaser(std::shared_ptr<void> owner)
+      : owner_(std::move(owner)) {}
+
+  void addRef() const {}
+  void release() const {}
+
+ private:
+  const std::shared_ptr<void> owner_;
+};
+
+// Returns a view over the next 'size' bytes of 'source' and skips them if
+// 'source' has an owner and the bytes are in one range. Returns nullptr
+// without advancing otherwise.
+BufferPtr readInPlace(ByteStream* source, int32_t size) {
+  if (!source->inputOwner() || size == 0) {
+    return nullptr;
+  }
+  auto data = source->peek(0, size);
+  if (!data) {
+    return nullptr;
+  }
+  source->skip(size);
+  return BufferView<InputOwnerReleaser>::create(
+      data, size, InputOwnerReleaser(source->inputOwner()));
+}
+
+// Makes a flat vector over the values of a column without nulls in place
+// if the values are in one range of 'source' and suitably aligned. Returns
+// false without advancing 'source' otherwise. Booleans and timestamps are
+// not stored in their in-memory representation and are always copied.
+template <typename T>
+bool readFlatInPlace(
+    ByteStream* source,
+    const std::shared_ptr<const Type>& type,
+    vector_size_t size,
+    velox::memory::MemoryPool* pool,
+    VectorPtr* result) {
+  if constexpr (
+      std::is_same_v<T, bool> || std::is_same_v<T, Timestamp> ||
+      std::is_same_v<T, UnknownValue>) {
+    return false;
+  } else {
+    if (!source->inputOwner() || size == 0) {
+      return false;
+    }
+    // The column has no nulls if the null flag is 0.
+    auto nullFlag = source->peek(0, 1);
+    if (!nullFlag || *nullFlag != 0) {
+      return false;
+    }
+    const int32_t numBytes = size * sizeof(T);
+    auto data = source->peek(1, numBytes);
+    if (!data || reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+      return false;
+    }
+    source->skip(1 + numBytes);
+    auto values = BufferView<InputOwnerReleaser>::create(
+        data, numBytes, InputOwnerReleaser(source->inputOwner()));
+    *result = std::make_shared<FlatVector<T>>(
+        pool,
+        type,
+        BufferPtr(nullptr),
+        size,
+        std::move(values),
+        std::vector<BufferPtr>{},
+        cdvi::EMPTY_METADATA,
+        std::nullopt,
+        0 /*nullCount*/);
+    return true;
+  }
+}
+
+// Returns true if 'vector' is uniquely referenced and does not reference
+// the memory of a previous page, so that it can be overwritten.
+bool isReusable(const VectorPtr& vector) {
+  if (!vector || !vector.unique()) {
+    return false;
+  }
+  auto& values = vector->values();
+  return !values || !values->isView();
+}
+
 template <typename T>
 void read(
     ByteStream* source,
@@ -223,7 +387,10 @@ void read(
     velox::memory::MemoryPool* pool,
     VectorPtr* result) {
   int32_t size = source->read<int32_t>();
-  if (*result && result->unique()) {
+  if (readFlatInPlace<T>(source, type, size, pool, result)) {
+    return;
+  }
+  if (isReusable(*result)) {
     (*result)->resize(size);
   } else {
     *result = BaseVector::create(type, size, pool);
@@ -280,15 +447,21 @@ void read<StringView>(
 
   int32_t dataSize = source->read<int32_t>();
   auto& stringBuffers = flatResult->stringBuffers();
-  BufferPtr strings = findOrAllocateStringBuffer(dataSize, stringBuffers, pool);
-  auto rawStrings = strings->asMutable<uint8_t>();
+  // The string data is referenced in place if possible.
+  BufferPtr strings = readInPlace(source, dataSize);
+  const bool inPlace = strings != nullptr;
+  if (!inPlace) {
+    strings = findOrAllocateStringBuffer(dataSize, stringBuffers, pool);
+  }
+  auto rawChars = const_cast<char*>(strings->as<char>());
 
   stringBuffers.resize(1);
   stringBuffers[0] = std::move(strings);
 
-  source->readBytes(rawStrings, dataSize);
+  if (!inPlace) {
+    source->readBytes(rawChars, dataSize);
+  }
   int32_t previousOffset = 0;
-  auto rawChars = reinterpret_cast<char*>(rawStrings);
   for (int32_t i = 0; i < size; ++i) {
     int32_t offset = rawValues[i].size();
     rawValues[i] =
@@ -541,9 +714,8 @@ std::string readLengthPrefixedString(ByteStream* source) {
   return value;
 }
 
-void readAndCheckType(ByteStream* source, TypePtr type) {
+void checkEncoding(const std::string& encoding, TypePtr type) {
   auto kindEncoding = typeToEncodingName(type);
-  std::string encoding = readLengthPrefixedString(source);
   VELOX_CHECK(
       encoding == kindEncoding,
       "Encoding to Type mismatch {} expected {} got {}",
@@ -552,6 +724,37 @@ void readAndCheckType(ByteStream* source, TypePtr type) {
       encoding);
 }
 
+// Reads a DICTIONARY column into a DictionaryVector over the dictionary
+// values.
+void readDictionaryVector(
+    ByteStream* source,
+    std::shared_ptr<const Type> type,
+    velox::memory::MemoryPool* pool,
+    VectorPtr* result) {
+  vector_size_t size = source->read<int32_t>();
+  std::vector<VectorPtr> dictionary(1);
+  readColumns(source, pool, {type}, &dictionary);
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(size, pool);
+  source->readBytes(
+      indices->asMutable<uint8_t>(), size * sizeof(vector_size_t));
+  source->skip(kDictionaryIdSize);
+  *result = BaseVector::wrapInDictionary(
+      BufferPtr(nullptr), std::move(indices), size, std::move(dictionary[0]));
+}
+
+// Reads an RLE column into a ConstantVector.
+void readRleVector(
+    ByteStream* source,
+    std::shared_ptr<const Type> type,
+    velox::memory::MemoryPool* pool,
+    VectorPtr* result) {
+  vector_size_t size = source->read<int32_t>();
+  std::vector<VectorPtr> value(1);
+  readColumns(source, pool, {type}, &value);
+  VELOX_CHECK_EQ(value[0]->size(), 1, "RLE column with more than one value");
+  *result = BaseVector::wrapInConstant(size, 0, std::move(value[0]));
+}
+
 void readColumns(
     ByteStream* source,
     velox::memory::MemoryPool* pool,
@@ -587,8 +790,15 @@ void readColumns(
         "Column reader for type {} is missing",
         types[i]->kindName());
 
-    readAndCheckType(source, types[i]);
-    it->second(source, types[i], pool, &(*result)[i]);
+    auto encoding = readLengthPrefixedString(source);
+    if (encoding == kDictionary) {
+      readDictionaryVector(source, types[i], pool, &(*result)[i]);
+    } else if (encoding == kRle) {
+      readRleVector(source, types[i], pool, &(*result)[i]);
+    } else {
+      checkEncoding(encoding, types[i]);
+      it->second(source, types[i], pool, &(*result)[i]);
+    }
   }
 }
 
@@ -600,6 +810,11 @@ void writeInt64(std::ostream* out, int64_t value) {
   out->write(reinterpret_cast<char*>(&value), sizeof(value));
 }
 
+void writeEncoding(std::ostream* out, const std::string& encoding) {
+  writeInt32(out, encoding.size());
+  out->write(encoding.data(), encoding.size());
+}
+
 // Appendable container for serialized values. To append a value at a
 // time, call appendNull or appendNonNull first. Then call
 // appendLength if the type has a length. A null value has a length of
@@ -611,9 +826,12 @@ class VectorStream {
       StreamArena* streamArena,
       int32_t initialNumRows)
       : type_(type),
+        streamArena_(streamArena),
+        initialNumRows_(initialNumRows),
         nulls_(streamArena, true, true),
         lengths_(streamArena),
-        values_(streamArena) {
+        values_(streamArena),
+        ids_(streamArena) {
     streamArena->newTinyRange(50, &header_);
     auto name = typeToEncodingName(type);
     header_.size = name.size() + sizeof(int32_t);
@@ -697,8 +915,55 @@ class VectorStream {
     return children_[index].get();
   }
 
+  bool isEmpty() const {
+    return nullCount_ + nonNullCount_ == 0 && !dictionary_;
+  }
+
+  // Makes 'this' write a DICTIONARY column or, if the dictionary ends
+  // up with a single value, an RLE column. The distinct values go to
+  // dictionary() and appendId() adds a row. Must be called before
+  // anything is appended.
+  void startDictionary() {
+    VELOX_CHECK(isEmpty());
+    dictionary_ =
+        std::make_unique<VectorStream>(type_, streamArena_, initialNumRows_);
+    ids_.startWrite(std::max(initialNumRows_, 1) * sizeof(int32_t));
+  }
+
+  // Returns the stream of the dictionary values or nullptr if 'this' does
+  // not write a dictionary.
+  VectorStream* dictionary() const {
+    return dictionary_.get();
+  }
+
+  // Adds a row referring to the 'id'th value of dictionary().
+  void appendId(int32_t id) {
+    ids_.appendOne<int32_t>(id);
+    ++numIds_;
+  }
+
+  // Adds a value to dictionary() and returns its id. The caller appends
+  // the value to dictionary().
+  int32_t newDictionaryId() {
+    return dictionarySize_++;
+  }
+
+  // Returns the id of a null in dictionary(), adding the null if there
+  // is none.
+  int32_t nullDictionaryId() {
+    if (nullId_ == -1) {
+      dictionary_->appendNull();
+      nullId_ = newDictionaryId();
+    }
+    return nullId_;
+  }
+
   // Writes out the accumulated contents. Does not change the state.
   void flush(std::ostream* out) {
+    if (dictionary_) {
+      flushDictionary(out);
+      return;
+    }
     out->write(reinterpret_cast<char*>(header_.buffer), header_.size);
     switch (type_->kind()) {
       case TypeKind::ROW:
@@ -777,16 +1042,44 @@ class VectorStream {
   }
 
  private:
+  void flushDictionary(std::ostream* out) {
+    if (dictionarySize_ == 1) {
+      writeEncoding(out, kRle);
+      writeInt32(out, numIds_);
+      dictionary_->flush(out);
+      return;
+    }
+    writeEncoding(out, kDictionary);
+    writeInt32(out, numIds_);
+    dictionary_->flush(out);
+    ids_.flush(out);
+    // Each flushed dictionary is distinct for the consumer.
+    writeInt64(out, folly::Random::rand64());
+    writeInt64(out, folly::Random::rand64());
+    writeInt64(out, 0);
+  }
+
   int32_t nonNullCount_{0};
   int32_t nullCount_{0};
   int32_t totalLength_{0};
   bool hasLengths_{false};
   const TypePtr type_;
+  StreamArena* const streamArena_;
+  const int32_t initialNumRows_;
   ByteRange header_;
   ByteStream nulls_;
   ByteStream lengths_;
   ByteStream values_;
   std::vector<std::unique_ptr<VectorStream>> children_;
+
+  // Distinct values if 'this' writes a dictionary.
+  std::unique_ptr<VectorStream> dictionary_;
+  // Index into 'dictionary_' for each row.
+  ByteStream ids_;
+  int32_t numIds_{0};
+  int32_t dictionarySize_{0};
+  // Id of the null in 'dictionary_', -1 if none.
+  int32_t nullId_{-1};
 };
 
 template <>
@@ -1140,6 +1433,64 @@ void serializeColumn(
   }
 }
 
+// Appends the rows of 'vector' in 'ranges' to a 'stream' that writes a
+// dictionary. Only the distinct values of the base of 'vector' go to
+// the dictionary.
+void serializeDictionaryIds(
+    const BaseVector* vector,
+    const folly::Range<const IndexRange*>& ranges,
+    VectorStream* stream) {
+  auto dictionary = stream->dictionary();
+  auto base = vector->wrappedVector();
+  folly::F14FastMap<vector_size_t, int32_t> baseIds;
+  std::vector<IndexRange> newValues;
+  for (auto& range : ranges) {
+    for (auto row = range.begin; row < range.begin + range.size; ++row) {
+      if (vector->isNullAt(row)) {
+        if (!newValues.empty()) {
+          // The values before the null get the lower ids.
+          serializeColumn(base, newValues, dictionary);
+          newValues.clear();
+        }
+        stream->appendId(stream->nullDictionaryId());
+        continue;
+      }
+      auto baseIndex = vector->wrappedIndex(row);
+      auto it = baseIds.find(baseIndex);
+      if (it == baseIds.end()) {
+        it = baseIds.emplace(baseIndex, stream->newDictionaryId()).first;
+        newValues.push_back(IndexRange{baseIndex, 1});
+      }
+      stream->appendId(it->second);
+    }
+  }
+  if (!newValues.empty()) {
+    serializeColumn(base, newValues, dictionary);
+  }
+}
+
+// Serializes a top level column. A stream that first gets a constant
+// or a dictionary with repeating values writes a dictionary, which
+// keeps the repeated values once on the wire.
+void serializeTopLevelColumn(
+    BaseVector* vector,
+    const folly::Range<const IndexRange*>& ranges,
+    VectorStream* stream) {
+  if (stream->isEmpty()) {
+    auto encoding = vector->encoding();
+    if (encoding == VectorEncoding::Simple::CONSTANT ||
+        (encoding == VectorEncoding::Simple::DICTIONARY &&
+         vector->wrappedVector()->size() < rangesTotalSize(ranges))) {
+      stream->startDictionary();
+    }
+  }
+  if (stream->dictionary()) {
+    serializeDictionaryIds(vector, ranges, stream);
+  } else {
+    serializeColumn(vector, ranges, stream);
+  }
+}
+
 void expandRepeatedRanges(
     const BaseVector* vector,
     const vector_size_t* rawOffsets,
@@ -1406,7 +1757,9 @@ class PrestoVectorSerializer : public VectorSerializer {
   PrestoVectorSerializer(
       std::shared_ptr<const RowType> rowType,
       int32_t numRows,
-      StreamArena* streamArena) {
+      StreamArena* streamArena,
+      const VectorSerde::Options& options)
+      : options_(options) {
     auto types = rowType->children();
     auto numTypes = types.size();
     streams_.resize(numTypes);
@@ -1423,7 +1776,8 @@ class PrestoVectorSerializer : public VectorSerializer {
     if (newRows > 0) {
       numRows_ += newRows;
       for (int32_t i = 0; i < vector->childrenSize(); ++i) {
-        serializeColumn(vector->childAt(i).get(), ranges, streams_[i].get());
+        serializeTopLevelColumn(
+            vector->childAt(i)->loadedVector(), ranges, streams_[i].get());
       }
     }
   }
@@ -1439,6 +1793,21 @@ class PrestoVectorSerializer : public VectorSerializer {
       stream->flush(&data);
     }
     auto stringData = data.str();
+    int32_t uncompressedSize = stringData.size();
+    // The page goes uncompressed if compression does not save enough.
+    std::string compressed;
+    if (options_.compression != VectorSerdeCompression::kNone &&
+        compress(
+            options_.compression,
+            stringData,
+            uncompressedSize * options_.maxCompressedFraction,
+            compressed)) {
+      codec |= kCompressedBitMask;
+      if (options_.compression == VectorSerdeCompression::kZstd) {
+        codec |= kZstdBitMask;
+      }
+      stringData = std::move(compressed);
+    }
     int32_t offset = out->tellp();
 
     writeInt32(out, numRows_);
@@ -1453,14 +1822,14 @@ class PrestoVectorSerializer : public VectorSerializer {
 
     // fill in uncompressedSizeInBytes & sizeInBytes
     int32_t size = (int32_t)out->tellp() - offset;
-    int32_t uncompressedSize = size - kHeaderSize;
+    int32_t sizeInBytes = size - kHeaderSize;
 
     int64_t crc =
         computeChecksum(stringData, codec, numRows_, uncompressedSize);
 
     out->seekp(offset + kSizeInBytesOffset);
     writeInt32(out, uncompressedSize);
-    writeInt32(out, uncompressedSize);
+    writeInt32(out, sizeInBytes);
     writeInt64(out, crc);
     out->seekp(offset + size);
   }
@@ -1469,6 +1838,7 @@ class PrestoVectorSerializer : public VectorSerializer {
   static const int32_t kSizeInBytesOffset{4 + 1};
   static const int32_t kHeaderSize{kSizeInBytesOffset + 4 + 4 + 8};
 
+  const VectorSerde::Options options_;
   int32_t numRows_{0};
   std::vector<std::unique_ptr<VectorStream>> streams_;
 };
@@ -1484,8 +1854,10 @@ void PrestoVectorSerde::estimateSerializedSize(
 std::unique_ptr<VectorSerializer> PrestoVectorSerde::createSerializer(
     std::shared_ptr<const RowType> type,
     int32_t numRows,
-    StreamArena* streamArena) {
-  return std::make_unique<PrestoVectorSerializer>(type, numRows, streamArena);
+    StreamArena* streamArena,
+    const Options* options) {
+  return std::make_unique<PrestoVectorSerializer>(
+      type, numRows, streamArena, options ? *options : Options());
 }
 
 void PrestoVectorSerde::deserialize(
@@ -1503,18 +1875,41 @@ void PrestoVectorSerde::deserialize(
 
   auto pageCodecMarker = source->read<int8_t>();
   auto uncompressedSize = source->read<int32_t>();
-  // skip size in bytes
-  source->skip(4);
+  auto sizeInBytes = source->read<int32_t>();
   auto checksum = source->read<int64_t>();
 
   int64_t actualCheckSum = 0;
   if (isChecksumBitSet(pageCodecMarker)) {
-    actualCheckSum =
-        computeChecksum(source, pageCodecMarker, numRows, uncompressedSize);
+    actualCheckSum = computeChecksum(
+        source, pageCodecMarker, numRows, uncompressedSize, sizeInBytes);
   }
   VELOX_CHECK_EQ(
       checksum, actualCheckSum, "Received corrupted serialized page.");
 
+  // A compressed page is decompressed and the columns are read from the
+  // uncompressed copy.
+  ByteStream uncompressedSource;
+  if (isCompressedBitSet(pageCodecMarker)) {
+    auto uncompressed = std::make_shared<std::string>();
+    std::string compressed;
+    compressed.reserve(sizeInBytes);
+    for (auto remaining = sizeInBytes; remaining > 0;) {
+      auto view = source->nextView(remaining);
+      compressed.append(view.data(), view.size());
+      remaining -= view.size();
+    }
+    decompress(pageCodecMarker, compressed, uncompressedSize, *uncompressed);
+    uncompressedSource.resetInput({ByteRange{
+        reinterpret_cast<uint8_t*>(uncompressed->data()),
+        uncompressedSize,
+        0}});
+    // Vectors may reference the uncompressed copy in place.
+    if (source->inputOwner()) {
+      uncompressedSource.setInputOwner(std::move(uncompressed));
+    }
+    source = &uncompressedSource;
+  }
+
   // skip number of columns
   source->skip(4);
 
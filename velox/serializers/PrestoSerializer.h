@@ -27,7 +27,8 @@ class PrestoVectorSerde : public VectorSerde {
   std::unique_ptr<VectorSerializer> createSerializer(
       std::shared_ptr<const RowType> type,
       int32_t numRows,
-      StreamArena* streamArena) override;
+      StreamArena* streamArena,
+      const Options* options = nullptr) override;
 
   void deserialize(
       ByteStream* source,
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/serializers/CompactRowSerializer.h"
+#include <gtest/gtest.h>
+#include "velox/exec/ContainerRowSerde.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class CompactRowSerializerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = memory::getDefaultScopedMemoryPool();
+    serde_ = std::make_unique<serializer::CompactRowVectorSerde>(
+        exec::ContainerRowSerde::instance());
+    vectorMaker_ = std::make_unique<test::VectorMaker>(pool_.get());
+    arena_ =
+        std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
+  }
+
+  RowVectorPtr makeTestVector(vector_size_t size) {
+    for (auto i = 0; i < size; ++i) {
+      strings_.push_back(
+          i % 3 == 0 ? fmt::format("short{}", i)
+                     : fmt::format("a string that is not inlined {}", i));
+    }
+    auto nested = vectorMaker_->rowVector(
+        {vectorMaker_->flatVector<int32_t>(
+             size, [](vector_size_t row) { return row; }),
+         vectorMaker_->flatVector(strings_)});
+    return vectorMaker_->rowVector({
+        vectorMaker_->flatVector<int64_t>(
+            size,
+            [](vector_size_t row) { return row * 11; },
+            test::VectorMaker::nullEvery(7)),
+        vectorMaker_->flatVector(strings_),
+        vectorMaker_->arrayVector<int32_t>(
+            size,
+            [](vector_size_t row) { return row % 4; },
+            [](vector_size_t idx) { return idx; },
+            test::VectorMaker::nullEvery(5)),
+        vectorMaker_->mapVector<int32_t, double>(
+            size,
+            [](vector_size_t row) { return row % 3; },
+            [](vector_size_t idx) { return idx; },
+            [](vector_size_t idx) { return idx * 0.5; }),
+        nested,
+    });
+  }
+
+  std::string serialize(
+      const RowVectorPtr& vector,
+      const std::vector<IndexRange>& ranges,
+      const SerializedRows* serializedRows = nullptr) {
+    auto serializer = serde_->createSerializer(
+        std::dynamic_pointer_cast<const RowType>(vector->type()),
+        vector->size(),
+        arena_.get());
+    auto range = folly::Range(ranges.data(), ranges.size());
+    if (serializedRows) {
+      serializer->appendSerializedRows(*serializedRows, range);
+    } else {
+      serializer->append(vector, range);
+    }
+    std::ostringstream out;
+    serializer->flush(&out);
+    return out.str();
+  }
+
+  RowVectorPtr deserialize(
+      const std::shared_ptr<const RowType>& rowType,
+      const std::string& input) {
+    ByteStream byteStream;
+    byteStream.resetInput({ByteRange{
+        reinterpret_cast<uint8_t*>(const_cast<char*>(input.data())),
+        (int32_t)input.length(),
+        0}});
+    RowVectorPtr result;
+    serde_->deserialize(&byteStream, pool_.get(), rowType, &result);
+    EXPECT_TRUE(byteStream.atEnd());
+    return result;
+  }
+
+  // Checks that rows 'ranges' of 'expected' are the rows of 'actual'.
+  void assertEqualRows(
+      const RowVectorPtr& expected,
+      const std::vector<IndexRange>& ranges,
+      const RowVectorPtr& actual) {
+    vector_size_t actualRow = 0;
+    for (const auto& range : ranges) {
+      for (auto row = range.begin; row < range.begin + range.size; ++row) {
+        ASSERT_LT(actualRow, actual->size());
+        ASSERT_TRUE(expected->equalValueAt(actual.get(), row, actualRow))
+            << "at " << row << ". Expected: " << expected->toString(row)
+            << ", got: " << actual->toString(actualRow);
+        ++actualRow;
+      }
+    }
+    ASSERT_EQ(actualRow, actual->size());
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::unique_ptr<VectorSerde> serde_;
+  std::unique_ptr<test::VectorMaker> vectorMaker_;
+  std::unique_ptr<StreamArena> arena_;
+  std::vector<std::string> strings_;
+};
+
+TEST_F(CompactRowSerializerTest, roundTrip) {
+  auto data = makeTestVector(1'000);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(data->type());
+  std::vector<IndexRange> ranges = {{0, 1'000}};
+  auto deserialized = deserialize(rowType, serialize(data, ranges));
+  assertEqualRows(data, ranges, deserialized);
+
+  ranges = {{3, 1}, {10, 20}, {999, 1}};
+  deserialized = deserialize(rowType, serialize(data, ranges));
+  assertEqualRows(data, ranges, deserialized);
+}
+
+TEST_F(CompactRowSerializerTest, serializedRows) {
+  auto data = makeTestVector(1'000);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(data->type());
+  ASSERT_TRUE(serde_->isRowWise());
+
+  SerializedRows rows;
+  serde_->serializeRows(data, memory::MappedMemory::getInstance(), rows);
+  ASSERT_EQ(1'000, rows.size());
+  ASSERT_EQ(rows.offsets.back(), rows.data.size());
+
+  // Copying serialized rows gives the same bytes as serializing the rows.
+  std::vector<IndexRange> ranges = {{0, 10}, {500, 1}, {700, 300}};
+  auto copied = serialize(data, ranges, &rows);
+  EXPECT_EQ(serialize(data, ranges), copied);
+  assertEqualRows(data, ranges, deserialize(rowType, copied));
+
+  // The estimate matches the serialized size for fixed width values.
+  std::vector<IndexRange> allRows(1'000);
+  std::vector<vector_size_t> sizes(1'000, 0);
+  std::vector<vector_size_t*> sizePointers(1'000);
+  for (auto i = 0; i < 1'000; ++i) {
+    allRows[i] = IndexRange{i, 1};
+    sizePointers[i] = &sizes[i];
+  }
+  serde_->estimateSerializedSize(
+      data->childAt(0),
+      folly::Range(allRows.data(), allRows.size()),
+      sizePointers.data());
+  for (auto i = 0; i < 1'000; ++i) {
+    vector_size_t expected = i % 7 == 0 ? 0 : sizeof(int64_t);
+    EXPECT_EQ(expected, sizes[i]);
+  }
+}
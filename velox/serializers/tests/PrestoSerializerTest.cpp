@@ -42,7 +42,10 @@ class PrestoSerializerTest : public ::testing::Test {
     serde_->estimateSerializedSize(rowVector, ranges, rawRowSizes.data());
   }
 
-  void serialize(RowVectorPtr rowVector, std::ostream* output) {
+  void serialize(
+      RowVectorPtr rowVector,
+      std::ostream* output,
+      const VectorSerde::Options* options = nullptr) {
     auto numRows = rowVector->size();
 
     std::vector<IndexRange> rows(numRows);
@@ -56,7 +59,8 @@ class PrestoSerializerTest : public ::testing::Test {
     auto arena =
         std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
     auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
-    auto serializer = serde_->createSerializer(rowType, numRows, arena.get());
+    auto serializer =
+        serde_->createSerializer(rowType, numRows, arena.get(), options);
 
     serializer->append(rowVector, folly::Range(rows.data(), numRows));
     serializer->flush(output);
@@ -129,6 +133,34 @@ TEST_F(PrestoSerializerTest, basic) {
   assertEqualVectors(deserialized, rowVector);
 }
 
+TEST_F(PrestoSerializerTest, compression) {
+  auto rowVector = makeTestVector(10'000);
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  std::ostringstream uncompressed;
+  serialize(rowVector, &uncompressed);
+  // The codec marker is after the number of rows.
+  constexpr int32_t kCodecOffset = 4;
+  EXPECT_EQ(uncompressed.str()[kCodecOffset] & 1, 0);
+
+  for (auto compression :
+       {VectorSerdeCompression::kLz4, VectorSerdeCompression::kZstd}) {
+    VectorSerde::Options options;
+    options.compression = compression;
+    std::ostringstream out;
+    serialize(rowVector, &out, &options);
+    EXPECT_EQ(out.str()[kCodecOffset] & 1, 1);
+    EXPECT_LT(out.str().size(), uncompressed.str().size());
+    assertEqualVectors(deserialize(rowType, out.str()), rowVector);
+
+    // A page that does not compress enough is written uncompressed.
+    options.maxCompressedFraction = 0.01;
+    std::ostringstream poor;
+    serialize(rowVector, &poor, &options);
+    EXPECT_EQ(poor.str(), uncompressed.str());
+    assertEqualVectors(deserialize(rowType, poor.str()), rowVector);
+  }
+}
+
 /// Test serialization of a dictionary vector that adds nulls to the base
 /// vector.
 TEST_F(PrestoSerializerTest, dictionaryWithExtraNulls) {
@@ -155,6 +187,36 @@ TEST_F(PrestoSerializerTest, dictionaryWithExtraNulls) {
   testRoundTrip(dictionary);
 }
 
+TEST_F(PrestoSerializerTest, dictionaryAndConstant) {
+  vector_size_t size = 10'000;
+  auto base = vectorMaker_->flatVector<StringView>(10, [](auto row) {
+    return StringView(std::string(50, 'a' + row));
+  });
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(size, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < size; i++) {
+    rawIndices[i] = i % 10;
+  }
+  auto dictionary =
+      BaseVector::wrapInDictionary(nullptr, indices, size, base);
+  auto constant = BaseVector::wrapInConstant(size, 3, base);
+  auto rowVector = vectorMaker_->rowVector({dictionary, constant});
+
+  std::ostringstream out;
+  serialize(rowVector, &out);
+  // The repeated strings are not on the wire.
+  EXPECT_LT(out.str().size(), size * 2 * sizeof(int32_t) + 1'000);
+
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  auto deserialized = deserialize(rowType, out.str());
+  assertEqualVectors(deserialized, rowVector);
+  EXPECT_EQ(
+      deserialized->childAt(0)->encoding(),
+      VectorEncoding::Simple::DICTIONARY);
+  EXPECT_EQ(
+      deserialized->childAt(1)->encoding(), VectorEncoding::Simple::CONSTANT);
+}
+
 TEST_F(PrestoSerializerTest, emptyPage) {
   auto rowVector = vectorMaker_->rowVector(ROW({"a"}, {BIGINT()}), 0);
 
@@ -253,3 +315,55 @@ TEST_F(PrestoSerializerTest, multiPage) {
   assertEqualVectors(deserialized, c);
   ASSERT_TRUE(byteStream->atEnd());
 }
+
+TEST_F(PrestoSerializerTest, deserializeInPlace) {
+  std::vector<std::string> strings;
+  for (auto i = 0; i < 100; ++i) {
+    strings.push_back(std::string(i % 30, 'x'));
+  }
+  auto rowVector = vectorMaker_->rowVector({
+      vectorMaker_->flatVector<int8_t>(
+          100, [](vector_size_t row) { return row % 7; }),
+      vectorMaker_->flatVector(strings),
+      vectorMaker_->flatVector<int8_t>(
+          100,
+          [](vector_size_t row) { return row; },
+          [](vector_size_t row) { return row % 5 == 0; }),
+  });
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+
+  std::ostringstream out;
+  serialize(rowVector, &out);
+  auto page = std::make_shared<std::string>(out.str());
+
+  // With an owner, columns without nulls reference the page in place.
+  RowVectorPtr deserialized;
+  {
+    auto byteStream = toByteStream(*page);
+    byteStream->setInputOwner(page);
+    serde_->deserialize(byteStream.get(), pool_.get(), rowType, &deserialized);
+  }
+  ASSERT_TRUE(deserialized->childAt(0)->values()->isView());
+  ASSERT_TRUE(deserialized->childAt(1)
+                  ->asFlatVector<StringView>()
+                  ->stringBuffers()[0]
+                  ->isView());
+  ASSERT_FALSE(deserialized->childAt(2)->values()->isView());
+
+  // The vectors keep the page alive.
+  page.reset();
+  assertEqualVectors(deserialized, rowVector);
+
+  // Without an owner, the data is copied and views are not overwritten.
+  auto copy = out.str();
+  auto byteStream = toByteStream(copy);
+  auto previous = deserialized->childAt(0);
+  serde_->deserialize(byteStream.get(), pool_.get(), rowType, &deserialized);
+  ASSERT_FALSE(deserialized->childAt(0)->values()->isView());
+  ASSERT_FALSE(deserialized->childAt(1)
+                   ->asFlatVector<StringView>()
+                   ->stringBuffers()[0]
+                   ->isView());
+  assertEqualVectors(deserialized, rowVector);
+  assertEqualVectors(previous, rowVector->childAt(0));
+}
@@ -23,6 +23,91 @@
 
 namespace facebook::velox::util {
 
+/// Parses 'size' bytes at 'data' as an optional '-' followed by decimal
+/// digits. Returns false without throwing for any other input, including
+/// surrounding whitespace and values out of range of T. The caller then
+/// falls back to Converter, which either accepts the value or produces the
+/// error message.
+template <typename T>
+inline bool tryParseInteger(const char* data, size_t size, T& result) {
+  static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(int64_t));
+  size_t pos = 0;
+  bool negative = false;
+  if (size > 0 && data[0] == '-') {
+    negative = true;
+    pos = 1;
+  }
+  // 18 digits always fit in int64_t.
+  if (pos == size || size - pos > 18) {
+    return false;
+  }
+  int64_t value = 0;
+  for (; pos < size; ++pos) {
+    uint8_t digit = data[pos] - '0';
+    if (digit > 9) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  if (negative) {
+    value = -value;
+  }
+  if (value < std::numeric_limits<T>::min() ||
+      value > std::numeric_limits<T>::max()) {
+    return false;
+  }
+  result = value;
+  return true;
+}
+
+/// Parses 'size' bytes at 'data' as '-?[0-9]+(.[0-9]+)?' into 'result' if
+/// the value is exactly representable as an integer mantissa below 2^53
+/// divided by a power of 10 of at most 22. Both are then exact doubles and
+/// the single division is correctly rounded, giving the same result as
+/// the general parser. Returns false without throwing for anything else.
+inline bool tryParseDouble(const char* data, size_t size, double& result) {
+  static constexpr double kPowersOf10[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  constexpr uint64_t kMaxExactMantissa = uint64_t{1} << 53;
+  size_t pos = 0;
+  bool negative = false;
+  if (size > 0 && data[0] == '-') {
+    negative = true;
+    pos = 1;
+  }
+  uint64_t mantissa = 0;
+  int32_t numDigits = 0;
+  int32_t numFractionDigits = 0;
+  bool seenPoint = false;
+  for (; pos < size; ++pos) {
+    char c = data[pos];
+    if (c == '.') {
+      if (seenPoint || numDigits == 0) {
+        return false;
+      }
+      seenPoint = true;
+      continue;
+    }
+    uint8_t digit = c - '0';
+    // More than 19 digits may overflow 'mantissa'.
+    if (digit > 9 || ++numDigits > 19) {
+      return false;
+    }
+    mantissa = mantissa * 10 + digit;
+    numFractionDigits += seenPoint;
+  }
+  if (numDigits == 0 || (seenPoint && numFractionDigits == 0) ||
+      mantissa > kMaxExactMantissa || numFractionDigits > 22) {
+    return false;
+  }
+  result = static_cast<double>(mantissa) / kPowersOf10[numFractionDigits];
+  if (negative) {
+    result = -result;
+  }
+  return true;
+}
+
 template <TypeKind KIND, typename = void, bool TRUNCATE = false>
 struct Converter {
   template <typename T>
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "velox/common/base/Exceptions.h"
+#include "velox/type/Type.h"
+
+namespace facebook::velox {
+
+/// Decimal of up to 18 digits stored as its unscaled value in a BIGINT, e.g.
+/// 12.34 in DECIMAL(4, 2) is 1234. The physical type is BIGINT, so vectors,
+/// readers, serialization and row containers treat decimals as BIGINT and
+/// only functions and casts look at the precision and scale.
+class ShortDecimalType : public ScalarType<TypeKind::BIGINT> {
+ public:
+  static constexpr int kMaxPrecision = 18;
+
+  ShortDecimalType(int precision, int scale)
+      : precision_(precision), scale_(scale) {
+    VELOX_USER_CHECK(
+        precision > 0 && precision <= kMaxPrecision,
+        "DECIMAL precision must be between 1 and {}: {}",
+        kMaxPrecision,
+        precision);
+    VELOX_USER_CHECK(
+        scale >= 0 && scale <= precision,
+        "DECIMAL scale must be between 0 and the precision: {}",
+        scale);
+  }
+
+  int precision() const {
+    return precision_;
+  }
+
+  int scale() const {
+    return scale_;
+  }
+
+  std::string toString() const override {
+    return fmt::format("DECIMAL({},{})", precision_, scale_);
+  }
+
+  // Decimals of different precision or scale differ. A decimal equals
+  // BIGINT, like all types of the same kind do.
+  bool operator==(const Type& other) const override {
+    if (auto decimal = dynamic_cast<const ShortDecimalType*>(&other)) {
+      return precision_ == decimal->precision_ && scale_ == decimal->scale_;
+    }
+    return other.kind() == TypeKind::BIGINT;
+  }
+
+ private:
+  const int precision_;
+  const int scale_;
+};
+
+inline std::shared_ptr<const ShortDecimalType> DECIMAL(
+    int precision,
+    int scale) {
+  return std::make_shared<const ShortDecimalType>(precision, scale);
+}
+
+/// Returns 'type' as a decimal or nullptr if 'type' is not a decimal.
+inline const ShortDecimalType* asShortDecimal(const TypePtr& type) {
+  return dynamic_cast<const ShortDecimalType*>(type.get());
+}
+
+inline bool isShortDecimalType(const TypePtr& type) {
+  return asShortDecimal(type) != nullptr;
+}
+
+} // namespace facebook::velox
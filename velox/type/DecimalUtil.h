@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace facebook::velox::util {
+
+/// Powers of ten that fit in int64_t.
+constexpr int64_t kPowersOfTen[] = {
+    1,
+    10,
+    100,
+    1'000,
+    10'000,
+    100'000,
+    1'000'000,
+    10'000'000,
+    100'000'000,
+    1'000'000'000,
+    10'000'000'000,
+    100'000'000'000,
+    1'000'000'000'000,
+    10'000'000'000'000,
+    100'000'000'000'000,
+    1'000'000'000'000'000,
+    10'000'000'000'000'000,
+    100'000'000'000'000'000,
+    1'000'000'000'000'000'000};
+
+/// Returns the largest unscaled value of a decimal with 'precision' digits.
+inline int64_t maxUnscaledDecimal(int precision) {
+  return kPowersOfTen[precision] - 1;
+}
+
+/// Sets 'result' to the unscaled value of the decimal number in 'data' with
+/// 'scale' digits after the point. Extra fraction digits are rounded half
+/// away from zero. Returns false if 'data' is not a decimal number or has
+/// more than 'precision' digits at 'scale'.
+inline bool tryParseDecimal(
+    const char* data,
+    size_t size,
+    int precision,
+    int scale,
+    int64_t& result) {
+  size_t pos = 0;
+  bool negative = false;
+  if (pos < size && (data[pos] == '-' || data[pos] == '+')) {
+    negative = data[pos] == '-';
+    ++pos;
+  }
+  bool hasDigits = false;
+  for (; pos < size && data[pos] == '0'; ++pos) {
+    hasDigits = true;
+  }
+  int64_t value = 0;
+  int numIntegerDigits = 0;
+  for (; pos < size; ++pos) {
+    uint8_t digit = data[pos] - '0';
+    if (digit > 9) {
+      break;
+    }
+    if (++numIntegerDigits > precision - scale) {
+      return false;
+    }
+    value = value * 10 + digit;
+    hasDigits = true;
+  }
+  int numFractionDigits = 0;
+  bool roundUp = false;
+  if (pos < size && data[pos] == '.') {
+    for (++pos; pos < size; ++pos) {
+      uint8_t digit = data[pos] - '0';
+      if (digit > 9) {
+        break;
+      }
+      hasDigits = true;
+      if (numFractionDigits < scale) {
+        value = value * 10 + digit;
+        ++numFractionDigits;
+      } else if (numFractionDigits == scale) {
+        roundUp = digit >= 5;
+        // Marks the rounding digit as seen. The digits after it are ignored.
+        ++numFractionDigits;
+      }
+    }
+  }
+  if (!hasDigits || pos != size) {
+    return false;
+  }
+  if (numFractionDigits < scale) {
+    value *= kPowersOfTen[scale - numFractionDigits];
+  }
+  value += roundUp;
+  if (value > maxUnscaledDecimal(precision)) {
+    return false;
+  }
+  result = negative ? -value : value;
+  return true;
+}
+
+/// Returns the decimal with unscaled 'value' and 'scale' as a string, e.g.
+/// "12.34" for 1234 with scale 2.
+inline std::string formatDecimal(int64_t value, int scale) {
+  uint64_t absValue = value < 0 ? 0 - static_cast<uint64_t>(value) : value;
+  auto result = std::to_string(absValue);
+  if (scale > 0) {
+    int numDigits = result.size();
+    if (numDigits <= scale) {
+      result.insert(0, scale + 1 - numDigits, '0');
+    }
+    result.insert(result.size() - scale, 1, '.');
+  }
+  if (value < 0) {
+    result.insert(0, 1, '-');
+  }
+  return result;
+}
+
+/// Sets 'result' to the unscaled 'value' with 'fromScale' converted to
+/// 'toScale'. Dropped digits are rounded half away from zero. Returns false
+/// if the result has more than 'precision' digits.
+inline bool tryRescaleDecimal(
+    int64_t value,
+    int fromScale,
+    int toScale,
+    int precision,
+    int64_t& result) {
+  int64_t rescaled;
+  if (toScale >= fromScale) {
+    if (__builtin_mul_overflow(
+            value, kPowersOfTen[toScale - fromScale], &rescaled)) {
+      return false;
+    }
+  } else {
+    auto divisor = kPowersOfTen[fromScale - toScale];
+    rescaled = value / divisor;
+    auto remainder = value % divisor;
+    if (remainder >= (divisor + 1) / 2) {
+      ++rescaled;
+    } else if (remainder <= -(divisor + 1) / 2) {
+      --rescaled;
+    }
+  }
+  auto max = maxUnscaledDecimal(precision);
+  if (rescaled > max || rescaled < -max) {
+    return false;
+  }
+  result = rescaled;
+  return true;
+}
+
+} // namespace facebook::velox::util
@@ -17,6 +17,30 @@
 
 namespace facebook::velox::common {
 
+namespace {
+// Returns the lanes of 'values' that are in [min, max].
+__m256i rangeMask4x64(__m256i values, int64_t min, int64_t max) {
+  using TV = simd::Vectors<int64_t>;
+  return (TV::compareGt(TV::setAll(min), values) |
+          TV::compareGt(values, TV::setAll(max))) ^
+      -1;
+}
+
+// Tests 8x32 signed values with 'test4x64' by widening each half to
+// 4x64 and narrowing the 4x64 results back to 8x32.
+template <typename Test>
+__m256si test8x32With4x64(__m256i values, Test test4x64) {
+  auto narrow = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  auto low = test4x64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+  auto high =
+      test4x64(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+  return (__m256si)_mm256_blend_epi32(
+      _mm256_permutevar8x32_epi32(low, narrow),
+      _mm256_permutevar8x32_epi32(high, narrow),
+      0xf0);
+}
+} // namespace
+
 std::string Filter::toString() const {
   const char* strKind = "<unknown>";
   switch (kind_) {
@@ -62,6 +86,9 @@ std::string Filter::toString() const {
     case FilterKind::kMultiRange:
       strKind = "MultiRange";
       break;
+    case FilterKind::kBloomFilter:
+      strKind = "BloomFilter";
+      break;
   };
 
   return fmt::format(
@@ -82,10 +109,10 @@ BigintValuesUsingBitmask::BigintValuesUsingBitmask(
   VELOX_CHECK(min < max, "min must be less than max");
   VELOX_CHECK(values.size() > 1, "values must contain at least 2 entries");
 
-  bitmask_.resize(max - min + 1);
+  bitmask_.resize(bits::nwords(max - min + 1));
 
   for (int64_t value : values) {
-    bitmask_[value - min] = true;
+    bits::setBit(bitmask_.data(), value - min);
   }
 }
 
@@ -93,7 +120,21 @@ bool BigintValuesUsingBitmask::testInt64(int64_t value) const {
   if (value < min_ || value > max_) {
     return false;
   }
-  return bitmask_[value - min_];
+  return isSet(value);
+}
+
+__m256i BigintValuesUsingBitmask::test4x64(__m256i x) {
+  using TV = simd::Vectors<int64_t>;
+  auto inRange = rangeMask4x64(x, min_, max_);
+  // The lanes out of range read the first word.
+  auto offsets = _mm256_sub_epi64(x, TV::setAll(min_)) & inRange;
+  auto words = TV::gather64(bitmask_.data(), _mm256_srli_epi64(offsets, 6));
+  auto bits = _mm256_srlv_epi64(words, offsets & TV::setAll(63));
+  return TV::compareEq(bits & TV::setAll(1), TV::setAll(1)) & inRange;
+}
+
+__m256si BigintValuesUsingBitmask::test8x32(__m256i x) {
+  return test8x32With4x64(x, [&](__m256i x4) { return test4x64(x4); });
 }
 
 bool BigintValuesUsingBitmask::testInt64Range(
@@ -108,7 +149,14 @@ bool BigintValuesUsingBitmask::testInt64Range(
     return testInt64(min);
   }
 
-  return !(min > max_ || max < min_);
+  auto begin = std::max(min, min_);
+  auto end = std::min(max, max_);
+  if (begin > end) {
+    return false;
+  }
+  auto first =
+      bits::findFirstBit(bitmask_.data(), begin - min_, end - min_ + 1);
+  return first >= 0;
 }
 
 BigintValuesUsingHashTable::BigintValuesUsingHashTable(
@@ -141,6 +189,8 @@ BigintValuesUsingHashTable::BigintValuesUsingHashTable(
       }
     }
   }
+  sortedValues_ = values;
+  std::sort(sortedValues_.begin(), sortedValues_.end());
 }
 
 bool BigintValuesUsingHashTable::testInt64(int64_t value) const {
@@ -165,6 +215,45 @@ bool BigintValuesUsingHashTable::testInt64(int64_t value) const {
   return false;
 }
 
+__m256i BigintValuesUsingHashTable::test4x64(__m256i x) {
+  using TV = simd::Vectors<int64_t>;
+  if (containsEmptyMarker_) {
+    return Filter::test4x64(x);
+  }
+  auto inRange = rangeMask4x64(x, min_, max_);
+  if (TV::compareResult(inRange) == 0) {
+    return inRange;
+  }
+  int64_t size = hashTable_.size();
+  // The index uses only the low 32 bits of value * M, which are the low
+  // 32 bits of the product of the low halves.
+  auto indices = _mm256_mul_epu32(x, TV::setAll(M & 0xffffffff)) &
+      TV::setAll(size - 1);
+  auto table = TV::gather64(hashTable_.data(), indices);
+  auto empty = TV::compareEq(table, TV::setAll(kEmptyMarker));
+  auto hits = TV::compareEq(table, x) & inRange;
+  auto unresolved = TV::compareBitMask(
+      TV::compareResult(inRange & ~(hits | empty)));
+  if (LIKELY(unresolved == 0)) {
+    return hits;
+  }
+  // Finishes the values that collide with another value in the table.
+  alignas(32) int64_t values[4];
+  alignas(32) int64_t result[4];
+  TV::store(values, x);
+  TV::store(result, hits);
+  while (unresolved) {
+    auto lane = __builtin_ctz(unresolved);
+    result[lane] = testInt64(values[lane]) ? -1 : 0;
+    unresolved &= unresolved - 1;
+  }
+  return TV::load(result);
+}
+
+__m256si BigintValuesUsingHashTable::test8x32(__m256i x) {
+  return test8x32With4x64(x, [&](__m256i x4) { return test4x64(x4); });
+}
+
 bool BigintValuesUsingHashTable::testInt64Range(
     int64_t min,
     int64_t max,
@@ -177,7 +266,8 @@ bool BigintValuesUsingHashTable::testInt64Range(
     return testInt64(min);
   }
 
-  return !(min > max_ || max < min_);
+  auto it = std::lower_bound(sortedValues_.begin(), sortedValues_.end(), min);
+  return it != sortedValues_.end() && *it <= max;
 }
 
 namespace {
@@ -382,6 +472,51 @@ bool BigintMultiRange::testInt64(int64_t value) const {
   return ranges_[place - 1]->testInt64(value);
 }
 
+__m256i BigintMultiRange::test4x64(__m256i x) {
+  using TV = simd::Vectors<int64_t>;
+  if (ranges_.size() > kMaxSimdRanges) {
+    return Filter::test4x64(x);
+  }
+  auto result = TV::setAll(0);
+  for (auto& range : ranges_) {
+    result |= range->test4x64(x);
+    if (TV::compareResult(result) == TV::kAllTrue) {
+      break;
+    }
+  }
+  return result;
+}
+
+__m256si BigintMultiRange::test8x32(__m256i x) {
+  using TV = simd::Vectors<int32_t>;
+  if (ranges_.size() > kMaxSimdRanges) {
+    return Filter::test8x32(x);
+  }
+  auto result = TV::setAll(0);
+  for (auto& range : ranges_) {
+    result |= range->test8x32(x);
+    if (TV::compareResult(result) == TV::kAllTrue) {
+      break;
+    }
+  }
+  return result;
+}
+
+__m256hi BigintMultiRange::test16x16(__m256i x) {
+  using TV = simd::Vectors<int16_t>;
+  if (ranges_.size() > kMaxSimdRanges) {
+    return Filter::test16x16(x);
+  }
+  auto result = TV::setAll(0);
+  for (auto& range : ranges_) {
+    result |= range->test16x16(x);
+    if (TV::compareResult(result) == TV::kAllTrue) {
+      break;
+    }
+  }
+  return result;
+}
+
 bool BigintMultiRange::testInt64Range(int64_t min, int64_t max, bool hasNull)
     const {
   if (hasNull && nullAllowed_) {
@@ -437,6 +572,36 @@ bool MultiRange::testFloat(float value) const {
   return false;
 }
 
+__m256i MultiRange::test4x64(__m256i x) {
+  using TV = simd::Vectors<int64_t>;
+  auto values = reinterpret_cast<__m256d>(x);
+  auto result = nanAllowed_
+      ? (__m256i)_mm256_cmp_pd(values, values, _CMP_UNORD_Q)
+      : TV::setAll(0);
+  for (auto& filter : filters_) {
+    result |= filter->test4x64(x);
+    if (TV::compareResult(result) == TV::kAllTrue) {
+      break;
+    }
+  }
+  return result;
+}
+
+__m256si MultiRange::test8x32(__m256i x) {
+  using TV = simd::Vectors<int32_t>;
+  auto values = reinterpret_cast<__m256>(x);
+  auto result = nanAllowed_
+      ? (__m256si)_mm256_cmp_ps(values, values, _CMP_UNORD_Q)
+      : TV::setAll(0);
+  for (auto& filter : filters_) {
+    result |= filter->test8x32(x);
+    if (TV::compareResult(result) == TV::kAllTrue) {
+      break;
+    }
+  }
+  return result;
+}
+
 bool MultiRange::testBytes(const char* value, int32_t length) const {
   for (const auto& filter : filters_) {
     if (filter->testBytes(value, length)) {
@@ -792,7 +957,7 @@ std::unique_ptr<Filter> BigintValuesUsingBitmask::mergeWith(
         auto min = std::max(min_, range->lower());
         auto max = std::min(max_, range->upper());
         for (auto i = min; i <= max; ++i) {
-          if (bitmask_[i - min_] && range->testInt64(i)) {
+          if (isSet(i) && range->testInt64(i)) {
             valuesToKeep.push_back(i);
           }
         }
@@ -814,7 +979,7 @@ std::unique_ptr<Filter> BigintValuesUsingBitmask::mergeWith(
 
   std::vector<int64_t> valuesToKeep;
   for (auto i = min; i <= max; ++i) {
-    if (bitmask_[i - min_] && other->testInt64(i)) {
+    if (isSet(i) && other->testInt64(i)) {
       valuesToKeep.push_back(i);
     }
   }
@@ -1036,4 +1201,43 @@ std::unique_ptr<Filter> BytesValues::mergeWith(const Filter* other) const {
   }
 }
 
+BloomFilter::Builder::Builder(int64_t numValues) {
+  // 10 bits per value give about 1% false positives. Large filters are
+  // capped at 16MB since these would not fit in cache anyway.
+  constexpr int64_t kBitsPerValue = 10;
+  constexpr int64_t kBitsPerBlock = kWordsPerBlock * 32;
+  constexpr int64_t kMaxBlocks = (16 << 20) / (kBitsPerBlock / 8);
+  auto numBlocks = bits::nextPowerOfTwo(std::max<int64_t>(
+      1, bits::roundUp(numValues * kBitsPerValue, kBitsPerBlock) /
+          kBitsPerBlock));
+  blocks_.resize(std::min<int64_t>(numBlocks, kMaxBlocks) * kWordsPerBlock);
+}
+
+void BloomFilter::Builder::addHash(uint64_t hash) {
+  uint64_t blockMask = blocks_.size() / kWordsPerBlock - 1;
+  auto block = blocks_.data() + ((hash >> 32) & blockMask) * kWordsPerBlock;
+  for (auto i = 0; i < kWordsPerBlock; ++i) {
+    block[i] |= bitInWord(hash, i);
+  }
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::Builder::build() {
+  return std::make_unique<BloomFilter>(
+      std::make_shared<const std::vector<uint32_t>>(std::move(blocks_)));
+}
+
+std::unique_ptr<Filter> BloomFilter::mergeWith(const Filter* other) const {
+  if (!conjunct_) {
+    return std::make_unique<BloomFilter>(blocks_, other->clone());
+  }
+  // The other kinds of filters do not know how to merge with a
+  // BloomFilter, so a BloomFilter is always on the left.
+  std::shared_ptr<const Filter> conjunct =
+      other->kind() == FilterKind::kBloomFilter &&
+          conjunct_->kind() != FilterKind::kBloomFilter
+      ? other->mergeWith(conjunct_.get())
+      : conjunct_->mergeWith(other);
+  return std::make_unique<BloomFilter>(blocks_, std::move(conjunct));
+}
+
 } // namespace facebook::velox::common
@@ -24,6 +24,7 @@
 #include <folly/Range.h>
 #include <folly/container/F14Set.h>
 
+#include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
 #include "velox/common/base/SimdUtil.h"
 #include "velox/type/StringView.h"
@@ -45,6 +46,7 @@ enum class FilterKind {
   kBytesValues,
   kBigintMultiRange,
   kMultiRange,
+  kBloomFilter,
 };
 
 /**
@@ -516,6 +518,11 @@ class BoolValue final : public Filter {
 
   std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
 
+  std::string toString() const final {
+    return fmt::format(
+        "BoolValue: {} {}", value_, nullAllowed_ ? "with nulls" : "no nulls");
+  }
+
  private:
   const bool value_;
 };
@@ -653,7 +660,8 @@ class BigintValuesUsingHashTable final : public Filter {
         min_(other.min_),
         max_(other.max_),
         hashTable_(other.hashTable_),
-        containsEmptyMarker_(other.containsEmptyMarker_) {}
+        containsEmptyMarker_(other.containsEmptyMarker_),
+        sortedValues_(other.sortedValues_) {}
 
   std::unique_ptr<Filter> clone(
       std::optional<bool> nullAllowed = std::nullopt) const final {
@@ -667,6 +675,15 @@ class BigintValuesUsingHashTable final : public Filter {
 
   bool testInt64(int64_t value) const final;
 
+  // Probes the first slot of the 4 values with a gather. Only the
+  // values that collide with another value there are probed further
+  // one by one.
+  __m256i test4x64(__m256i x) final;
+
+  __m256si test8x32(__m256i x) final;
+
+  // True if any of the values is in [min, max]. Used for skipping row
+  // groups by their statistics.
   bool testInt64Range(int64_t min, int64_t max, bool hashNull) const final;
 
   std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
@@ -679,12 +696,19 @@ class BigintValuesUsingHashTable final : public Filter {
     return max_;
   }
 
+  /// Returns the values in ascending order.
+  const std::vector<int64_t>& values() const {
+    return sortedValues_;
+  }
+
   std::string toString() const final {
-    return fmt::format(
-        "BigintValuesUsingHashTable: [{}, {}] {}",
-        min_,
-        max_,
-        nullAllowed_ ? "with nulls" : "no nulls");
+    std::ostringstream out;
+    out << "BigintValuesUsingHashTable: [" << min_ << ", " << max_ << "] {";
+    for (auto value : sortedValues_) {
+      out << " " << value;
+    }
+    out << " } " << (nullAllowed_ ? "with nulls" : "no nulls");
+    return out.str();
   }
 
  private:
@@ -699,6 +723,8 @@ class BigintValuesUsingHashTable final : public Filter {
   const int64_t max_;
   std::vector<int64_t> hashTable_;
   bool containsEmptyMarker_ = false;
+  // The values in ascending order for testInt64Range().
+  std::vector<int64_t> sortedValues_;
 };
 
 /// IN-list filter for integral data types. Implemented as a bitmask. Offers
@@ -736,15 +762,46 @@ class BigintValuesUsingBitmask final : public Filter {
 
   bool testInt64(int64_t value) const final;
 
+  __m256i test4x64(__m256i x) final;
+
+  __m256si test8x32(__m256i x) final;
+
+  // True if any of the values is in [min, max].
   bool testInt64Range(int64_t min, int64_t max, bool hasNull) const final;
 
   std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
 
+  int64_t min() const {
+    return min_;
+  }
+
+  int64_t max() const {
+    return max_;
+  }
+
+  std::string toString() const final {
+    std::ostringstream out;
+    out << "BigintValuesUsingBitmask: {";
+    for (auto value = min_; value <= max_; ++value) {
+      if (isSet(value)) {
+        out << " " << value;
+      }
+    }
+    out << " } " << (nullAllowed_ ? "with nulls" : "no nulls");
+    return out.str();
+  }
+
  private:
   std::unique_ptr<Filter>
   mergeWith(int64_t min, int64_t max, const Filter* other) const;
 
-  std::vector<bool> bitmask_;
+  bool isSet(int64_t value) const {
+    return bits::isBitSet(bitmask_.data(), value - min_);
+  }
+
+  // Bit for each value in [min_, max_]. Words, so that the bits of 4
+  // values can be gathered at once.
+  std::vector<uint64_t> bitmask_;
   const int64_t min_;
   const int64_t max_;
 };
@@ -982,6 +1039,9 @@ inline __m256i FloatingPointRange<double>::test4x64(__m256i x) {
         result &= (__m256i)_mm256_cmp_pd(allUpper, values, _CMP_GE_OQ);
       }
     }
+  } else if (upperUnbounded_) {
+    // Only NaN fails a range without bounds.
+    result = (__m256i)_mm256_cmp_pd(values, values, _CMP_ORD_Q);
   } else {
     auto allUpper = simd::Vectors<double>::setAll(upper_);
     if (upperExclusive_) {
@@ -1022,6 +1082,9 @@ inline __m256si FloatingPointRange<float>::test8x32(__m256i x) {
         result &= (__m256i)_mm256_cmp_ps(allUpper, values, _CMP_GE_OQ);
       }
     }
+  } else if (upperUnbounded_) {
+    // Only NaN fails a range without bounds.
+    result = (__m256i)_mm256_cmp_ps(values, values, _CMP_ORD_Q);
   } else {
     auto allUpper = simd::Vectors<float>::setAll(upper_);
     if (upperExclusive_) {
@@ -1207,6 +1270,20 @@ class BytesValues final : public Filter {
     return values_;
   }
 
+  // Lists the values in sorted order, so that equal filters print the
+  // same.
+  std::string toString() const final {
+    std::vector<std::string> sorted(values_.begin(), values_.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::ostringstream out;
+    out << "BytesValues: {";
+    for (const auto& value : sorted) {
+      out << " '" << value << "'";
+    }
+    out << " } " << (nullAllowed_ ? "with nulls" : "no nulls");
+    return out.str();
+  }
+
  private:
   std::string lower_;
   std::string upper_;
@@ -1233,6 +1310,15 @@ class BigintMultiRange final : public Filter {
 
   bool testInt64(int64_t value) const final;
 
+  // OR of the SIMD tests of the ranges if there are at most
+  // kMaxSimdRanges. With more, the binary search of testInt64() is
+  // faster.
+  __m256i test4x64(__m256i x) final;
+
+  __m256si test8x32(__m256i x) final;
+
+  __m256hi test16x16(__m256i x) final;
+
   bool testInt64Range(int64_t min, int64_t max, bool hasNull) const final;
 
   std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
@@ -1252,6 +1338,8 @@ class BigintMultiRange final : public Filter {
   }
 
  private:
+  static constexpr int32_t kMaxSimdRanges = 8;
+
   const std::vector<std::unique_ptr<BigintRange>> ranges_;
   std::vector<int64_t> lowerBounds_;
 };
@@ -1283,6 +1371,13 @@ class MultiRange final : public Filter {
 
   bool testFloat(float value) const final;
 
+  // OR of the SIMD tests of the filters on 4 doubles, with NaNs
+  // passing if 'nanAllowed_'.
+  __m256i test4x64(__m256i x) final;
+
+  // Same as test4x64() for 8 floats.
+  __m256si test8x32(__m256i x) final;
+
   bool testBytes(const char* value, int32_t length) const final;
 
   bool testLength(int32_t length) const override;
@@ -1302,11 +1397,158 @@ class MultiRange final : public Filter {
     return nanAllowed_;
   }
 
+  std::string toString() const final {
+    std::ostringstream out;
+    out << "MultiRange: [";
+    for (const auto& filter : filters_) {
+      out << " " << filter->toString();
+    }
+    out << " ] " << (nullAllowed_ ? "with nulls" : "no nulls")
+        << (nanAllowed_ ? " with NaN" : "");
+    return out.str();
+  }
+
  private:
   const std::vector<std::unique_ptr<Filter>> filters_;
   const bool nanAllowed_;
 };
 
+/// Passes the values whose hash is set in a blocked Bloom filter. Made by
+/// the build side of a hash join for pushing down into the probe side
+/// scan when the join keys have too many distinct values for an IN
+/// filter. Values that are not on the build side can pass, so the join
+/// must still compare the keys. Each value sets or tests 8 bits in one
+/// 32 byte block, so that a test touches a single cache line. Integers
+/// of any width are tested as int64_t. Nulls do not pass.
+class BloomFilter final : public Filter {
+ public:
+  /// Collects the values that pass a BloomFilter.
+  class Builder {
+   public:
+    /// Sizes the filter to have about 1% false positives with
+    /// 'numValues' distinct values.
+    explicit Builder(int64_t numValues);
+
+    void addInt64(int64_t value) {
+      addHash(hashInt64(value));
+    }
+
+    void addBytes(const char* value, int32_t length) {
+      addHash(hashBytes(value, length));
+    }
+
+    /// Returns a filter passing the values added so far. 'this' must not
+    /// be used after this.
+    std::unique_ptr<BloomFilter> build();
+
+   private:
+    void addHash(uint64_t hash);
+
+    std::vector<uint32_t> blocks_;
+  };
+
+  BloomFilter(
+      std::shared_ptr<const std::vector<uint32_t>> blocks,
+      std::shared_ptr<const Filter> conjunct = nullptr)
+      : Filter(true, false, FilterKind::kBloomFilter),
+        blocks_(std::move(blocks)),
+        blockMask_(blocks_->size() / kWordsPerBlock - 1),
+        conjunct_(std::move(conjunct)) {}
+
+  std::unique_ptr<Filter> clone(
+      std::optional<bool> /*nullAllowed*/ = std::nullopt) const final {
+    return std::make_unique<BloomFilter>(*this);
+  }
+
+  bool testInt64(int64_t value) const final {
+    return testHash(hashInt64(value)) &&
+        (!conjunct_ || conjunct_->testInt64(value));
+  }
+
+  bool testBytes(const char* value, int32_t length) const final {
+    return testHash(hashBytes(value, length)) &&
+        (!conjunct_ || conjunct_->testBytes(value, length));
+  }
+
+  bool testInt64Range(int64_t min, int64_t max, bool hasNull) const final {
+    if (min == max) {
+      return testInt64(min);
+    }
+    return !conjunct_ || conjunct_->testInt64Range(min, max, hasNull);
+  }
+
+  bool testBytesRange(
+      std::optional<std::string_view> min,
+      std::optional<std::string_view> max,
+      bool hasNull) const final {
+    return !conjunct_ || conjunct_->testBytesRange(min, max, hasNull);
+  }
+
+  /// Returns a BloomFilter that also applies 'other'. Unlike the other
+  /// filters, any kind of filter can be merged into a BloomFilter.
+  std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
+
+  /// Returns the bits of the filter, 8 words for each block. A filter
+  /// made from the same words tests the same values.
+  const std::vector<uint32_t>& blocks() const {
+    return *blocks_;
+  }
+
+  std::string toString() const final {
+    return fmt::format(
+        "BloomFilter: {} bytes{}",
+        blocks_->size() * sizeof(uint32_t),
+        conjunct_ ? " and " + conjunct_->toString() : "");
+  }
+
+ private:
+  static constexpr int32_t kWordsPerBlock = 8;
+  static constexpr uint64_t kSeed = 0x9e3779b97f4a7c15UL;
+
+  static uint64_t hashInt64(int64_t value) {
+    return bits::hashMix(kSeed, value);
+  }
+
+  static uint64_t hashBytes(const char* value, int32_t length) {
+    return bits::hashMix(kSeed, bits::hashBytes(kSeed, value, length));
+  }
+
+  // Returns the bit to set or test in each word of the block of
+  // 'hash'. The multipliers are from the Parquet split block Bloom
+  // filter.
+  static uint32_t bitInWord(uint32_t hash, int32_t word) {
+    static constexpr uint32_t kSalts[kWordsPerBlock] = {
+        0x47b6137bU,
+        0x44974d91U,
+        0x8824ad5bU,
+        0xa2b7289dU,
+        0x705495c7U,
+        0x2df1424bU,
+        0x9efc4947U,
+        0x5c6bfb31U};
+    return 1U << ((hash * kSalts[word]) >> 27);
+  }
+
+  bool testHash(uint64_t hash) const {
+    auto block =
+        blocks_->data() + ((hash >> 32) & blockMask_) * kWordsPerBlock;
+    for (auto i = 0; i < kWordsPerBlock; ++i) {
+      auto bit = bitInWord(hash, i);
+      if ((block[i] & bit) != bit) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // kWordsPerBlock words for each block. The number of blocks is a
+  // power of 2. Shared between the copies made by clone().
+  const std::shared_ptr<const std::vector<uint32_t>> blocks_;
+  const uint64_t blockMask_;
+  // Filter that must also pass, set by mergeWith().
+  const std::shared_ptr<const Filter> conjunct_;
+};
+
 // Helper for applying filters to different types
 template <typename TFilter, typename T>
 static inline bool applyFilter(TFilter& filter, T value) {
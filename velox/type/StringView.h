@@ -130,6 +130,12 @@ struct StringView {
                size_ - kPrefixSize) == 0;
   }
 
+  // Returns true if the first kPrefixSize bytes, zero padded, are
+  // equal. If not, compare() is decided without reading string data.
+  bool prefixEquals(const StringView& other) const {
+    return prefixAsInt() == other.prefixAsInt();
+  }
+
   bool operator!=(const StringView& other) const {
     return !(*this == other);
   }
@@ -140,17 +146,28 @@ struct StringView {
   int32_t compare(const StringView& other) const {
     if (prefixAsInt() != other.prefixAsInt()) {
       // The result is decided on prefix. The shorter will be less
-      // because the prefix is padded with zeros.
-      return memcmp(prefix_, other.prefix_, kPrefixSize);
+      // because the prefix is padded with zeros. The byte swapped
+      // prefixes compare as unsigned words like memcmp does.
+      return __builtin_bswap32(prefixAsInt()) <
+              __builtin_bswap32(other.prefixAsInt())
+          ? -1
+          : 1;
     }
     int32_t size = std::min(size_, other.size_) - kPrefixSize;
     if (size <= 0) {
       // One ends within the prefix.
       return size_ - other.size_;
     }
-    if (size <= kInlineSize && isInline() && other.isInline()) {
-      int32_t result = memcmp(value_.inlined, other.value_.inlined, size);
-      return (result != 0) ? result : size_ - other.size_;
+    if (isInline() && other.isInline()) {
+      // The inline parts are zero padded, so the byte swapped words
+      // order like memcmp over the common length. Equal words leave
+      // the longer string greater.
+      auto left = __builtin_bswap64(inlinedAsInt64());
+      auto right = __builtin_bswap64(other.inlinedAsInt64());
+      if (left != right) {
+        return left < right ? -1 : 1;
+      }
+      return size_ - other.size_;
     }
     int32_t result =
         memcmp(data() + kPrefixSize, other.data() + kPrefixSize, size);
@@ -210,12 +227,12 @@ struct StringView {
     return reinterpret_cast<const int64_t*>(this)[0];
   }
 
-  inline int64_t inlinedAsInt64() const {
-    return reinterpret_cast<const int64_t*>(this)[1];
+  inline uint64_t inlinedAsInt64() const {
+    return reinterpret_cast<const uint64_t*>(this)[1];
   }
 
-  int32_t prefixAsInt() const {
-    return *reinterpret_cast<const int32_t*>(&prefix_);
+  uint32_t prefixAsInt() const {
+    return *reinterpret_cast<const uint32_t*>(&prefix_);
   }
 
   // We rely on all members being laid out top to bottom . C++
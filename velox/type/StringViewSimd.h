@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/common/base/BitUtil.h"
+#include "velox/common/base/SimdUtil.h"
+#include "velox/type/StringView.h"
+
+// Batch equality and comparison of StringViews. These look at the
+// 16 byte views a vector at a time and only touch out of line string
+// data for pairs that agree on size and prefix.
+namespace facebook::velox::simd {
+
+namespace detail {
+// Returns true if the views at 'left' and 'right' are equal given a
+// 16 bit mask with a bit per byte of the view set if the bytes are
+// equal. The first 8 bytes are size and prefix. The last 8 are either
+// the inlined tail or the data pointer.
+inline bool
+viewsEqual(uint32_t mask, const StringView& left, const StringView& right) {
+  if ((mask & 0xff) != 0xff) {
+    return false;
+  }
+  if (left.isInline()) {
+    return left.size() <= StringView::kPrefixSize || mask == 0xffff;
+  }
+  return left == right;
+}
+
+// Loads 2 consecutive views.
+inline __m256i load2(const StringView* views) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(views));
+}
+} // namespace detail
+
+// Sets bit 'i' of 'result' to left[i] == right[i] for 'i' in ['begin',
+// 'end').
+inline void stringViewsEqual(
+    const StringView* left,
+    const StringView* right,
+    int32_t begin,
+    int32_t end,
+    uint64_t* result) {
+  auto i = begin;
+  for (; i + 2 <= end; i += 2) {
+    uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi64(
+        detail::load2(left + i), detail::load2(right + i)));
+    bits::setBit(
+        result, i, detail::viewsEqual(mask & 0xffff, left[i], right[i]));
+    bits::setBit(
+        result,
+        i + 1,
+        detail::viewsEqual(mask >> 16, left[i + 1], right[i + 1]));
+  }
+  if (i < end) {
+    bits::setBit(result, i, left[i] == right[i]);
+  }
+}
+
+// Sets bit 'i' of 'result' to values[i] == 'constant' for 'i' in
+// ['begin', 'end').
+inline void stringViewsEqual(
+    const StringView* values,
+    const StringView& constant,
+    int32_t begin,
+    int32_t end,
+    uint64_t* result) {
+  auto wideConstant = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(&constant)));
+  auto i = begin;
+  for (; i + 2 <= end; i += 2) {
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi64(detail::load2(values + i), wideConstant));
+    bits::setBit(
+        result, i, detail::viewsEqual(mask & 0xffff, values[i], constant));
+    bits::setBit(
+        result,
+        i + 1,
+        detail::viewsEqual(mask >> 16, values[i + 1], constant));
+  }
+  if (i < end) {
+    bits::setBit(result, i, values[i] == constant);
+  }
+}
+
+// Sets result[i] to left[i].compare(right[i]) reduced to -1, 0 or 1 for
+// 'i' in ['begin', 'end'). The prefixes of 8 pairs are compared at a
+// time and only the pairs with equal prefixes are compared one by one.
+inline void stringViewsCompare(
+    const StringView* left,
+    const StringView* right,
+    int32_t begin,
+    int32_t end,
+    int32_t* result) {
+  // Offsets of the prefixes of 8 consecutive views in 4 byte units.
+  const auto prefixIndices = _mm256_setr_epi32(1, 5, 9, 13, 17, 21, 25, 29);
+  // Reverses the bytes of each 32 bit lane so that prefixes compare
+  // like memcmp.
+  const auto byteSwap = _mm256_broadcastsi128_si256(
+      _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203));
+  // Flips the sign bit so that a signed compare orders unsigned values.
+  const auto signBit = _mm256_set1_epi32(0x80000000);
+  auto reduce = [](int32_t value) { return value < 0 ? -1 : value > 0; };
+  auto i = begin;
+  for (; i + 8 <= end; i += 8) {
+    auto leftPrefixes = _mm256_xor_si256(
+        _mm256_shuffle_epi8(
+            _mm256_i32gather_epi32(
+                reinterpret_cast<const int*>(left + i), prefixIndices, 4),
+            byteSwap),
+        signBit);
+    auto rightPrefixes = _mm256_xor_si256(
+        _mm256_shuffle_epi8(
+            _mm256_i32gather_epi32(
+                reinterpret_cast<const int*>(right + i), prefixIndices, 4),
+            byteSwap),
+        signBit);
+    auto less = _mm256_cmpgt_epi32(rightPrefixes, leftPrefixes);
+    // -1 where left is less and 1 elsewhere.
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(result + i),
+        _mm256_or_si256(less, _mm256_set1_epi32(1)));
+    uint8_t tied = _mm256_movemask_ps(reinterpret_cast<__m256>(
+        _mm256_cmpeq_epi32(leftPrefixes, rightPrefixes)));
+    while (tied) {
+      auto lane = __builtin_ctz(tied);
+      result[i + lane] = reduce(left[i + lane].compare(right[i + lane]));
+      tied &= tied - 1;
+    }
+  }
+  for (; i < end; ++i) {
+    result[i] = reduce(left[i].compare(right[i]));
+  }
+}
+
+} // namespace facebook::velox::simd
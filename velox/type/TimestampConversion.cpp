@@ -516,18 +516,19 @@ void parserError(const char* str, size_t len) {
 
 } // namespace
 
-Timestamp fromTimestampString(const char* str, size_t len) {
+bool tryFromTimestampString(const char* str, size_t len, Timestamp& result) {
   size_t pos;
   int32_t daysSinceEpoch;
   int64_t microsSinceMidnight;
 
   if (!tryParseDateString(str, len, pos, daysSinceEpoch, false)) {
-    parserError(str, len);
+    return false;
   }
 
   if (pos == len) {
     // No time: only a date.
-    return fromDatetime(daysSinceEpoch, 0);
+    result = fromDatetime(daysSinceEpoch, 0);
+    return true;
   }
 
   // Try to parse a time field.
@@ -538,7 +539,7 @@ Timestamp fromTimestampString(const char* str, size_t len) {
   size_t timePos = 0;
   if (!tryParseTimeString(
           str + pos, len - pos, timePos, microsSinceMidnight, false)) {
-    parserError(str, len);
+    return false;
   }
 
   pos += timePos;
@@ -562,9 +563,18 @@ Timestamp fromTimestampString(const char* str, size_t len) {
       pos++;
     }
     if (pos < len) {
-      parserError(str, len);
+      return false;
     }
   }
+  result = timestamp;
+  return true;
+}
+
+Timestamp fromTimestampString(const char* str, size_t len) {
+  Timestamp timestamp;
+  if (!tryFromTimestampString(str, len, timestamp)) {
+    parserError(str, len);
+  }
   return timestamp;
 }
 
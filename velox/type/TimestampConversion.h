@@ -41,6 +41,31 @@ inline int32_t fromDateString(const StringView& str) {
   return fromDateString(str.data(), str.size());
 }
 
+/// Sets 'year', 'month' and 'day' to the date 'daysSinceEpoch' days after
+/// unix epoch, the inverse of fromDate(). Uses integer arithmetic only, so
+/// that it can be inlined in loops over many values.
+inline void toDate(
+    int64_t daysSinceEpoch,
+    int32_t& year,
+    int32_t& month,
+    int32_t& day) {
+  // Days since 0000-03-01, so that the leap day is the last of the year.
+  auto days = daysSinceEpoch + 719'468;
+  // 400 year eras of 146'097 days.
+  auto era = (days >= 0 ? days : days - 146'096) / 146'097;
+  auto dayOfEra = days - era * 146'097;
+  auto yearOfEra =
+      (dayOfEra - dayOfEra / 1'460 + dayOfEra / 36'524 - dayOfEra / 146'096) /
+      365;
+  auto dayOfYear =
+      dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  // Months starting from March.
+  auto shiftedMonth = (5 * dayOfYear + 2) / 153;
+  day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+  month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+  year = yearOfEra + era * 400 + (month <= 2);
+}
+
 /// Time conversions.
 
 /// Returns the cumulative number of microseconds.
@@ -68,6 +93,10 @@ inline int64_t fromTimeString(const StringView& str) {
 /// "YYYY-MM-DD HH:MM:SS[.MS] +00:00"
 Timestamp fromTimestampString(const char* buf, size_t len);
 
+/// Same as fromTimestampString() but returns false instead of throwing if
+/// 'buf' is not a valid timestamp.
+bool tryFromTimestampString(const char* buf, size_t len, Timestamp& result);
+
 inline Timestamp fromTimestampString(const std::string& str) {
   return fromTimestampString(str.data(), str.size());
 }
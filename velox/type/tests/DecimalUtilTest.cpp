@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/type/DecimalUtil.h"
+#include <gtest/gtest.h>
+#include <optional>
+
+namespace facebook::velox::util {
+namespace {
+
+std::optional<int64_t>
+parseDecimal(const std::string& str, int precision, int scale) {
+  int64_t result;
+  if (!tryParseDecimal(str.data(), str.size(), precision, scale, result)) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+std::optional<int64_t>
+rescaleDecimal(int64_t value, int fromScale, int toScale, int precision) {
+  int64_t result;
+  if (!tryRescaleDecimal(value, fromScale, toScale, precision, result)) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+TEST(DecimalUtilTest, parse) {
+  EXPECT_EQ(1234, parseDecimal("12.34", 4, 2));
+  EXPECT_EQ(-50, parseDecimal("-0.5", 3, 2));
+  EXPECT_EQ(50, parseDecimal("+.5", 3, 2));
+  EXPECT_EQ(500, parseDecimal("5.", 3, 2));
+  EXPECT_EQ(12310, parseDecimal("000123.10", 5, 2));
+  EXPECT_EQ(0, parseDecimal("0", 1, 0));
+
+  // Extra fraction digits round half away from zero.
+  EXPECT_EQ(101, parseDecimal("1.005", 4, 2));
+  EXPECT_EQ(-101, parseDecimal("-1.005", 4, 2));
+  EXPECT_EQ(100, parseDecimal("1.00499", 4, 2));
+
+  // Too many digits, also after rounding.
+  EXPECT_EQ(std::nullopt, parseDecimal("123.4", 4, 2));
+  EXPECT_EQ(std::nullopt, parseDecimal("99.995", 4, 2));
+  EXPECT_EQ(
+      999'999'999'999'999'999, parseDecimal("999999999999999999", 18, 0));
+  EXPECT_EQ(std::nullopt, parseDecimal("1000000000000000000", 18, 0));
+
+  EXPECT_EQ(std::nullopt, parseDecimal("", 4, 2));
+  EXPECT_EQ(std::nullopt, parseDecimal("-", 4, 2));
+  EXPECT_EQ(std::nullopt, parseDecimal(".", 4, 2));
+  EXPECT_EQ(std::nullopt, parseDecimal("1e3", 5, 0));
+  EXPECT_EQ(std::nullopt, parseDecimal("1.2.3", 5, 2));
+}
+
+TEST(DecimalUtilTest, format) {
+  EXPECT_EQ("12.34", formatDecimal(1234, 2));
+  EXPECT_EQ("-0.50", formatDecimal(-50, 2));
+  EXPECT_EQ("0.005", formatDecimal(5, 3));
+  EXPECT_EQ("-123", formatDecimal(-123, 0));
+  EXPECT_EQ("0", formatDecimal(0, 0));
+}
+
+TEST(DecimalUtilTest, rescale) {
+  EXPECT_EQ(12500, rescaleDecimal(125, 2, 4, 18));
+  EXPECT_EQ(13, rescaleDecimal(125, 2, 1, 18));
+  EXPECT_EQ(-13, rescaleDecimal(-125, 2, 1, 18));
+  EXPECT_EQ(-12, rescaleDecimal(-124, 2, 1, 18));
+  EXPECT_EQ(std::nullopt, rescaleDecimal(1000, 2, 2, 3));
+  EXPECT_EQ(std::nullopt, rescaleDecimal(123, 0, 17, 18));
+  EXPECT_EQ(std::nullopt, rescaleDecimal(INT64_MAX, 0, 1, 18));
+}
+
+} // namespace
+} // namespace facebook::velox::util
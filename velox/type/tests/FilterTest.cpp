@@ -244,6 +244,76 @@ TEST(FilterTest, bigintValuesUsingHashTable) {
   EXPECT_FALSE(filter->testInt64Range(11, 11, false));
   EXPECT_FALSE(filter->testInt64Range(-10, -5, false));
   EXPECT_FALSE(filter->testInt64Range(10'234, 20'000, false));
+  // The range is within [min, max] of the values but has none of them.
+  EXPECT_FALSE(filter->testInt64Range(11, 99, false));
+  EXPECT_TRUE(filter->testInt64Range(11, 100, false));
+  EXPECT_FALSE(filter->testInt64Range(11, 99, true));
+
+  {
+    __m256i n4 = {1, 2, 10'000, INT64_MAX};
+    checkSimd<int64_t>(
+        filter.get(), &n4, [&](int64_t x) { return filter->testInt64(x); });
+    __m256si n8 = {1, 10, 100, 10'000, -1, 11, 101, 9'999};
+    checkSimd<int32_t>(
+        filter.get(), &n8, [&](int64_t x) { return filter->testInt64(x); });
+  }
+
+  // Enough values for collisions in the table.
+  std::vector<int64_t> values;
+  for (auto i = 0; i < 1'000; ++i) {
+    values.push_back(i * 1'009);
+  }
+  filter = createBigintValues(values, false);
+  ASSERT_TRUE(dynamic_cast<BigintValuesUsingHashTable*>(filter.get()));
+  for (int64_t i = -5; i < 1'010'000; i += 997) {
+    __m256i n4 = {i, i + 1, i * 1'009, (i + 2) * 1'009};
+    checkSimd<int64_t>(
+        filter.get(), &n4, [&](int64_t x) { return filter->testInt64(x); });
+  }
+}
+
+TEST(FilterTest, bloomFilter) {
+  BloomFilter::Builder builder(10'000);
+  for (auto i = 0; i < 10'000; ++i) {
+    builder.addInt64(i * 7);
+    auto value = fmt::format("value{}", i);
+    builder.addBytes(value.data(), value.size());
+  }
+  std::unique_ptr<Filter> filter = builder.build();
+
+  EXPECT_FALSE(filter->testNull());
+  int32_t numFalsePositives = 0;
+  for (auto i = 0; i < 10'000; ++i) {
+    EXPECT_TRUE(filter->testInt64(i * 7));
+    auto value = fmt::format("value{}", i);
+    EXPECT_TRUE(filter->testBytes(value.data(), value.size()));
+    numFalsePositives += filter->testInt64(i * 7 + 1);
+  }
+  // The filter has twice the values it is sized for.
+  EXPECT_LT(numFalsePositives, 10'000 / 10);
+
+  // Ranges pass unless these are a single value.
+  EXPECT_TRUE(filter->testInt64Range(1, 5, false));
+  EXPECT_TRUE(filter->testInt64Range(7, 7, false));
+  EXPECT_TRUE(filter->testBytesRange("a", "b", false));
+
+  // A merge with another filter passes the values both pass.
+  auto range = lessThan(700);
+  auto merged = filter->mergeWith(range.get());
+  ASSERT_EQ(merged->kind(), FilterKind::kBloomFilter);
+  EXPECT_TRUE(merged->testInt64(49));
+  EXPECT_FALSE(merged->testInt64(700));
+  EXPECT_TRUE(merged->testInt64Range(0, 100, false));
+  EXPECT_FALSE(merged->testInt64Range(1'000, 2'000, false));
+  EXPECT_FALSE(merged->testNull());
+
+  // Merging two BloomFilters with a range on either side.
+  merged = merged->mergeWith(filter.get());
+  EXPECT_TRUE(merged->testInt64(49));
+  EXPECT_FALSE(merged->testInt64(700));
+
+  auto copy = filter->clone();
+  EXPECT_TRUE(copy->testInt64(70));
 }
 
 TEST(FilterTest, bigintValuesUsingBitmask) {
@@ -265,6 +335,20 @@ TEST(FilterTest, bigintValuesUsingBitmask) {
   EXPECT_FALSE(filter->testInt64Range(11, 11, false));
   EXPECT_FALSE(filter->testInt64Range(-10, -5, false));
   EXPECT_FALSE(filter->testInt64Range(1234, 2000, false));
+  // The range is within [min, max] of the values but has none of them.
+  EXPECT_FALSE(filter->testInt64Range(11, 99, false));
+  EXPECT_FALSE(filter->testInt64Range(101, 999, false));
+  EXPECT_TRUE(filter->testInt64Range(101, 1000, false));
+  EXPECT_TRUE(filter->testInt64Range(-100, 1, false));
+
+  {
+    __m256i n4 = {1, 2, 1000, INT64_MIN};
+    checkSimd<int64_t>(
+        filter.get(), &n4, [&](int64_t x) { return filter->testInt64(x); });
+    __m256si n8 = {1, 10, 100, 1000, -1, 0, 999, 1001};
+    checkSimd<int32_t>(
+        filter.get(), &n8, [&](int64_t x) { return filter->testInt64(x); });
+  }
 }
 
 TEST(FilterTest, bigintMultiRange) {
@@ -290,6 +374,19 @@ TEST(FilterTest, bigintMultiRange) {
   EXPECT_TRUE(filter->testInt64Range(105, 115, true));
   EXPECT_FALSE(filter->testInt64Range(15, 45, false));
   EXPECT_FALSE(filter->testInt64Range(15, 45, true));
+
+  {
+    __m256i n4 = {0, 5, 110, 150};
+    checkSimd<int64_t>(
+        filter.get(), &n4, [&](int64_t x) { return filter->testInt64(x); });
+    __m256si n8 = {1, 10, 11, 99, 100, 120, 121, -5};
+    checkSimd<int32_t>(
+        filter.get(), &n8, [&](int64_t x) { return filter->testInt64(x); });
+    __m256hi n16 = {
+        0, 1, 5, 10, 11, 50, 99, 100, 101, 119, 120, 121, -1, -100, 1000, 7};
+    checkSimd<int16_t>(
+        filter.get(), &n16, [&](int64_t x) { return filter->testInt64(x); });
+  }
 }
 
 TEST(FilterTest, boolValue) {
@@ -368,6 +465,16 @@ TEST(FilterTest, doubleRange) {
         filter.get(), &n4, [&](double x) { return filter->testDouble(x); });
   }
 
+  // Without bounds, only NaN fails.
+  filter = std::make_unique<DoubleRange>(0, true, false, 0, true, false, true);
+  EXPECT_TRUE(filter->testDouble(1e200));
+  EXPECT_FALSE(filter->testDouble(NAN));
+  {
+    __m256d n4 = {-1e100, std::nan("nan"), 1.3, 1e200};
+    checkSimd<double>(
+        filter.get(), &n4, [&](double x) { return filter->testDouble(x); });
+  }
+
   EXPECT_THROW(betweenDouble(NAN, NAN), VeloxRuntimeError)
       << "able to create a DoubleRange with NaN";
 }
@@ -411,6 +518,14 @@ TEST(FilterTest, floatRange) {
         filter.get(), &n8, [&](float x) { return filter->testFloat(x); });
   }
 
+  filter = std::make_unique<FloatRange>(0, true, false, 0, true, false, true);
+  EXPECT_FALSE(filter->testFloat(std::nanf("NAN")));
+  {
+    __m256 n8 = {1.0, std::nanf("nan"), 3.4, 3.1, -1e20, 0, 1e20, 1.2};
+    checkSimd<float>(
+        filter.get(), &n8, [&](float x) { return filter->testFloat(x); });
+  }
+
   EXPECT_THROW(
       betweenFloat(std::nanf("NAN"), std::nanf("NAN")), VeloxRuntimeError)
       << "able to create a FloatRange with NaN";
@@ -638,12 +753,22 @@ TEST(FilterTest, multiRangeWithNaNs) {
   EXPECT_FALSE(filter->testDouble(1.3));
   EXPECT_TRUE(filter->testDouble(1.4));
   EXPECT_TRUE(filter->testDouble(1.1));
+  {
+    __m256d n4 = {std::nan("nan"), 1.2, 1.25, 1.4};
+    checkSimd<double>(
+        filter.get(), &n4, [&](double x) { return filter->testDouble(x); });
+  }
 
   // x NOT IN (1.2) with nanAllowed false
   filter = orFilter(lessThanFloat(1.2), greaterThanFloat(1.2));
   EXPECT_FALSE(filter->testFloat(std::nanf("nan")));
   EXPECT_FALSE(filter->testFloat(1.2f));
   EXPECT_TRUE(filter->testFloat(1.3f));
+  {
+    __m256 n8 = {std::nanf("nan"), 1.2, 1.3, 1.1, -1, 1.2, 100, 1.25};
+    checkSimd<float>(
+        filter.get(), &n8, [&](float x) { return filter->testFloat(x); });
+  }
 
   filter = orFilter(lessThanDouble(1.2), greaterThanDouble(1.2));
   EXPECT_FALSE(filter->testDouble(std::nan("nan")));
@@ -15,6 +15,7 @@
  */
 #include <gtest/gtest.h>
 #include <sstream>
+#include "velox/type/StringViewSimd.h"
 #include "velox/type/Type.h"
 
 using namespace facebook::velox;
@@ -112,3 +113,54 @@ TEST(Type, StringViewSelfComparison) {
     EXPECT_EQ(lhs != rhs, false);
   }
 }
+
+TEST(Type, StringViewSimd) {
+  std::vector<std::string> texts{
+      "",
+      "USA",
+      "USB",
+      "CUBA",
+      std::string("CUBA\0", 5),
+      "ARGENTINA",
+      "ARGENTINO",
+      "UNITEDSTATES",
+      "UNITED STATES",
+      "UNITED STATEZ",
+      "UNITED STATES OF AMERICA",
+      "\xff\xfe"};
+  // All ordered pairs, laid out so that both the vectorized and the
+  // remainder loops see each pair.
+  std::vector<StringView> left;
+  std::vector<StringView> right;
+  for (auto& leftText : texts) {
+    for (auto& rightText : texts) {
+      left.push_back(StringView(leftText));
+      right.push_back(StringView(rightText));
+    }
+  }
+  left.push_back(StringView(texts[1]));
+  int32_t size = left.size() - 1;
+
+  std::vector<uint64_t> equal(bits::nwords(size), 0);
+  simd::stringViewsEqual(left.data(), right.data(), 0, size, equal.data());
+  std::vector<int32_t> compare(size);
+  simd::stringViewsCompare(left.data(), right.data(), 0, size, compare.data());
+  for (auto i = 0; i < size; ++i) {
+    auto expected = std::string(left[i]).compare(std::string(right[i]));
+    EXPECT_EQ(bits::isBitSet(equal.data(), i), expected == 0) << i;
+    EXPECT_EQ(compare[i], expected < 0 ? -1 : expected > 0) << i;
+    EXPECT_EQ(left[i].compare(right[i]) < 0, expected < 0) << i;
+    EXPECT_EQ(left[i].compare(right[i]) > 0, expected > 0) << i;
+  }
+
+  for (auto& text : texts) {
+    StringView constant(text);
+    std::vector<uint64_t> result(bits::nwords(left.size()), ~0UL);
+    simd::stringViewsEqual(
+        left.data(), constant, 1, left.size(), result.data());
+    EXPECT_TRUE(bits::isBitSet(result.data(), 0));
+    for (auto i = 1; i < left.size(); ++i) {
+      EXPECT_EQ(bits::isBitSet(result.data(), i), left[i] == constant) << i;
+    }
+  }
+}
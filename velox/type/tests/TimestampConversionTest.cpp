@@ -46,6 +46,37 @@ TEST(DateTimeUtilTest, fromDate) {
   EXPECT_EQ(-719893, fromDate(-1, 1, 1));
 }
 
+TEST(DateTimeUtilTest, toDate) {
+  auto testRoundTrip = [](int32_t year, int32_t month, int32_t day) {
+    int32_t resultYear;
+    int32_t resultMonth;
+    int32_t resultDay;
+    toDate(fromDate(year, month, day), resultYear, resultMonth, resultDay);
+    EXPECT_EQ(year, resultYear);
+    EXPECT_EQ(month, resultMonth);
+    EXPECT_EQ(day, resultDay);
+  };
+  testRoundTrip(1970, 1, 1);
+  testRoundTrip(1969, 12, 31);
+  testRoundTrip(2000, 2, 29);
+  testRoundTrip(2000, 3, 1);
+  testRoundTrip(1900, 2, 28);
+  testRoundTrip(1900, 3, 1);
+  testRoundTrip(2020, 7, 31);
+  testRoundTrip(0, 1, 1);
+  testRoundTrip(-1, 12, 31);
+
+  // Every day of 1600 to 2400.
+  int32_t year;
+  int32_t month;
+  int32_t day;
+  for (auto days = fromDate(1600, 1, 1); days < fromDate(2400, 1, 1);
+       ++days) {
+    toDate(days, year, month, day);
+    ASSERT_EQ(days, fromDate(year, month, day));
+  }
+}
+
 TEST(DateTimeUtilTest, fromDateInvalid) {
   EXPECT_THROW(fromDate(1970, 1, -1), VeloxUserError);
   EXPECT_THROW(fromDate(1970, -1, 1), VeloxUserError);
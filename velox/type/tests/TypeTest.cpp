@@ -15,6 +15,7 @@
  */
 #include "velox/type/Type.h"
 #include <gtest/gtest.h>
+#include "velox/type/DecimalType.h"
 #include <sstream>
 
 using namespace facebook;
@@ -107,6 +108,27 @@ TEST(Type, TimestampComparison) {
   EXPECT_GE(t1, t1lessSeconds);
 }
 
+TEST(Type, Decimal) {
+  auto t0 = DECIMAL(10, 2);
+  EXPECT_EQ(t0->toString(), "DECIMAL(10,2)");
+  EXPECT_EQ(t0->kind(), TypeKind::BIGINT);
+  EXPECT_EQ(t0->precision(), 10);
+  EXPECT_EQ(t0->scale(), 2);
+  EXPECT_EQ(t0->cppSizeInBytes(), sizeof(int64_t));
+  EXPECT_TRUE(isShortDecimalType(t0));
+  EXPECT_FALSE(isShortDecimalType(BIGINT()));
+
+  EXPECT_EQ(*t0, *DECIMAL(10, 2));
+  EXPECT_NE(*t0, *DECIMAL(10, 3));
+  EXPECT_NE(*t0, *DECIMAL(11, 2));
+  EXPECT_EQ(*t0, *BIGINT());
+  EXPECT_EQ(*BIGINT(), *t0);
+
+  EXPECT_THROW(DECIMAL(19, 2), VeloxUserError);
+  EXPECT_THROW(DECIMAL(0, 0), VeloxUserError);
+  EXPECT_THROW(DECIMAL(5, 6), VeloxUserError);
+}
+
 TEST(Type, Map) {
   auto map0 = MAP(INTEGER(), ARRAY(BIGINT()));
   EXPECT_EQ(map0->toString(), "MAP<INTEGER,ARRAY<BIGINT>>");
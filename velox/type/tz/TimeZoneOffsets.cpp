@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/type/tz/TimeZoneOffsets.h"
+
+#include <folly/container/F14Map.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "velox/external/date/tz.h"
+
+namespace facebook::velox::util {
+namespace {
+// 1900-01-01 and 2100-01-01 UTC.
+constexpr int64_t kTableBeginSeconds = -2'208'988'800;
+constexpr int64_t kTableEndSeconds = 4'102'444'800;
+
+date::sys_info infoAt(const date::time_zone* zone, int64_t utcSeconds) {
+  return zone->get_info(date::sys_seconds(std::chrono::seconds(utcSeconds)));
+}
+
+int64_t toSeconds(date::sys_seconds time) {
+  return time.time_since_epoch().count();
+}
+} // namespace
+
+// static
+const TimeZoneOffsets& TimeZoneOffsets::get(const std::string& name) {
+  static std::mutex mutex;
+  // Leaked so that it is valid in static destructors.
+  static auto* zones =
+      new folly::F14FastMap<std::string, std::unique_ptr<TimeZoneOffsets>>();
+  std::lock_guard<std::mutex> l(mutex);
+  auto it = zones->find(name);
+  if (it == zones->end()) {
+    // locate_zone throws std::runtime_error if the zone is not known.
+    auto* zone = date::locate_zone(name);
+    it = zones->emplace(name, std::make_unique<TimeZoneOffsets>(zone)).first;
+  }
+  return *it->second;
+}
+
+TimeZoneOffsets::TimeZoneOffsets(const date::time_zone* zone) : zone_(zone) {
+  auto info = infoAt(zone, kTableBeginSeconds);
+  tableBegin_ = toSeconds(info.begin);
+  for (;;) {
+    starts_.push_back(toSeconds(info.begin));
+    offsets_.push_back(info.offset.count());
+    if (toSeconds(info.end) >= kTableEndSeconds) {
+      break;
+    }
+    info = infoAt(zone, toSeconds(info.end));
+  }
+  tableEnd_ = toSeconds(info.end);
+}
+
+int32_t TimeZoneOffsets::intervalIndex(int64_t utcSeconds) const {
+  return std::upper_bound(starts_.begin(), starts_.end(), utcSeconds) -
+      starts_.begin() - 1;
+}
+
+int32_t TimeZoneOffsets::offsetAt(int64_t utcSeconds) const {
+  if (utcSeconds < tableBegin_ || utcSeconds >= tableEnd_) {
+    return infoAt(zone_, utcSeconds).offset.count();
+  }
+  return offsets_[intervalIndex(utcSeconds)];
+}
+
+bool TimeZoneOffsets::commonOffset(
+    int64_t minSeconds,
+    int64_t maxSeconds,
+    int32_t& offset) const {
+  if (minSeconds < tableBegin_ || maxSeconds >= tableEnd_) {
+    return false;
+  }
+  auto index = intervalIndex(minSeconds);
+  auto end = index + 1 < static_cast<int32_t>(starts_.size())
+      ? starts_[index + 1]
+      : tableEnd_;
+  if (maxSeconds >= end) {
+    return false;
+  }
+  offset = offsets_[index];
+  return true;
+}
+
+} // namespace facebook::velox::util
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace date {
+class time_zone;
+}
+
+namespace facebook::velox::util {
+
+/// The UTC offsets of a time zone as a sorted table of transitions, so that
+/// local times can be computed without a lookup in the time zone database
+/// for each value. The table covers the years 1900 to 2100. Times outside
+/// of it are looked up in the database.
+class TimeZoneOffsets {
+ public:
+  /// Returns the offsets of the time zone 'name', e.g.
+  /// "America/Los_Angeles", from a process-wide cache. Throws
+  /// std::runtime_error if the zone is not known.
+  static const TimeZoneOffsets& get(const std::string& name);
+
+  explicit TimeZoneOffsets(const date::time_zone* zone);
+
+  /// Returns the offset in seconds to add to 'utcSeconds' to get the local
+  /// time.
+  int32_t offsetAt(int64_t utcSeconds) const;
+
+  /// Returns true and sets 'offset' if all the times in ['minSeconds',
+  /// 'maxSeconds'] have the same offset. Values of a batch are usually
+  /// between two transitions, so that they can all be converted with one
+  /// offset. This is always the case for a zone with a fixed offset,
+  /// e.g. UTC or "Etc/GMT+5".
+  bool commonOffset(int64_t minSeconds, int64_t maxSeconds, int32_t& offset)
+      const;
+
+ private:
+  // Returns the index in 'starts_' of the interval of 'utcSeconds', which
+  // must be in [tableBegin_, tableEnd_).
+  int32_t intervalIndex(int64_t utcSeconds) const;
+
+  const date::time_zone* const zone_;
+  // Start of the intervals between transitions and their offsets. The
+  // first start is 'tableBegin_'.
+  std::vector<int64_t> starts_;
+  std::vector<int32_t> offsets_;
+  int64_t tableBegin_;
+  int64_t tableEnd_;
+};
+
+} // namespace facebook::velox::util
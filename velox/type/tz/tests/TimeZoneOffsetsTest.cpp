@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "velox/external/date/tz.h"
+#include "velox/type/tz/TimeZoneOffsets.h"
+
+namespace facebook::velox::util {
+namespace {
+
+int32_t databaseOffset(const std::string& zone, int64_t utcSeconds) {
+  return date::locate_zone(zone)
+      ->get_info(date::sys_seconds(std::chrono::seconds(utcSeconds)))
+      .offset.count();
+}
+
+TEST(TimeZoneOffsetsTest, offsetAt) {
+  for (auto zone : {"America/Los_Angeles", "Europe/Moscow", "Asia/Kolkata"}) {
+    const auto& offsets = TimeZoneOffsets::get(zone);
+    // Every 5 days and 17 minutes from 1800 to 2200.
+    for (int64_t seconds = -5'364'662'400; seconds < 7'258'118'400;
+         seconds += 5 * 86'400 + 17 * 60) {
+      ASSERT_EQ(databaseOffset(zone, seconds), offsets.offsetAt(seconds))
+          << zone << " at " << seconds;
+    }
+  }
+  EXPECT_EQ(
+      &TimeZoneOffsets::get("America/Los_Angeles"),
+      &TimeZoneOffsets::get("America/Los_Angeles"));
+  EXPECT_THROW(TimeZoneOffsets::get("bla"), std::runtime_error);
+}
+
+TEST(TimeZoneOffsetsTest, commonOffset) {
+  const auto& offsets = TimeZoneOffsets::get("America/Los_Angeles");
+  int32_t offset;
+  // 2021-07-01 and 2021-07-31, both in daylight savings time.
+  EXPECT_TRUE(offsets.commonOffset(1625097600, 1627689600, offset));
+  EXPECT_EQ(-7 * 3'600, offset);
+  // 2021-11-07 08:00 and 09:00, before and after the end of daylight
+  // savings time.
+  EXPECT_TRUE(offsets.commonOffset(1636272000, 1636275599, offset));
+  EXPECT_FALSE(offsets.commonOffset(1636272000, 1636275600, offset));
+
+  // A fixed offset is the same at all times.
+  const auto& utc = TimeZoneOffsets::get("UTC");
+  EXPECT_TRUE(utc.commonOffset(-10'000'000'000, 10'000'000'000, offset));
+  EXPECT_EQ(0, offset);
+}
+
+} // namespace
+} // namespace facebook::velox::util
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/vector/ColumnarFile.h"
+
+#include <fcntl.h>
+#include <folly/String.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox {
+
+MappedFile::MappedFile(const std::string& path) {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  VELOX_CHECK_GE(fd, 0, "Cannot open {}: {}", path, folly::errnoStr(errno));
+  struct stat info;
+  auto error = fstat(fd, &info) == 0 ? 0 : errno;
+  if (!error && info.st_size > 0) {
+    auto data = mmap(
+        nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      error = errno;
+    } else {
+      data_ = static_cast<char*>(data);
+      size_ = info.st_size;
+    }
+  }
+  ::close(fd);
+  VELOX_CHECK_EQ(error, 0, "Cannot map {}: {}", path, folly::errnoStr(error));
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(data_, size_);
+  }
+}
+
+namespace {
+
+constexpr uint32_t kBatchMagic = 0x31424656; // "VFB1"
+
+// Row number standing for a null row of a parent struct.
+constexpr vector_size_t kNullRow = -1;
+
+enum class ColumnEncoding : uint8_t { kFlat = 0, kConstant = 1 };
+
+struct BatchHeader {
+  uint32_t magic;
+  int32_t numRows;
+  // Size of the batch in bytes, including the header.
+  uint64_t size;
+};
+
+struct ColumnHeader {
+  ColumnEncoding encoding;
+  bool hasNulls;
+  uint8_t padding[6];
+};
+
+static_assert(sizeof(BatchHeader) == 8 + sizeof(uint64_t));
+static_assert(sizeof(ColumnHeader) == sizeof(uint64_t));
+
+uint64_t padded(uint64_t size) {
+  return bits::roundUp(size, sizeof(uint64_t));
+}
+
+// Writes columns of 'size' rows to 'out'. The rows come from the rows of
+// a vector given by 'rows' or are the first 'size' rows of the vector if
+// 'rows' is nullptr. A row of kNullRow is written as null.
+class ColumnWriter {
+ public:
+  explicit ColumnWriter(std::string& out) : out_(out) {}
+
+  void write(
+      const BaseVector& vector,
+      const vector_size_t* rows,
+      vector_size_t size) {
+    SelectivityVector allRows(vector.size());
+    DecodedVector decoded(vector, allRows);
+    if (vector.type()->isPrimitiveType() && size > 1 &&
+        isConstant(decoded, rows, size)) {
+      auto first = rows ? rows[0] : 0;
+      appendHeader(ColumnEncoding::kConstant, false);
+      writeFlat(decoded, &first, 1);
+    } else {
+      writeFlat(decoded, rows, size);
+    }
+  }
+
+ private:
+  static bool isConstant(
+      const DecodedVector& decoded,
+      const vector_size_t* rows,
+      vector_size_t size) {
+    if (decoded.isConstantMapping()) {
+      return !rows || std::find(rows, rows + size, kNullRow) == rows + size;
+    }
+    for (auto i = 0; i < size; ++i) {
+      auto row = rows ? rows[i] : i;
+      if (row != kNullRow && !decoded.isNullAt(row)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void appendBytes(const void* data, uint64_t size) {
+    out_.append(reinterpret_cast<const char*>(data), size);
+  }
+
+  void pad() {
+    out_.resize(padded(out_.size()));
+  }
+
+  void appendHeader(ColumnEncoding encoding, bool hasNulls) {
+    ColumnHeader header{encoding, hasNulls, {}};
+    appendBytes(&header, sizeof(header));
+  }
+
+  // Appends a bitmap of 'size' bits with bit i set if 'isSet(i)' is true.
+  template <typename IsSet>
+  void appendBits(vector_size_t size, IsSet isSet) {
+    auto offset = out_.size();
+    out_.resize(offset + padded(bits::nbytes(size)));
+    auto bits = reinterpret_cast<uint64_t*>(out_.data() + offset);
+    for (auto i = 0; i < size; ++i) {
+      bits::setBit(bits, i, isSet(i));
+    }
+  }
+
+  void writeFlat(
+      const DecodedVector& decoded,
+      const vector_size_t* rows,
+      vector_size_t size) {
+    auto isNull = [&](vector_size_t i) {
+      auto row = rows ? rows[i] : i;
+      return row == kNullRow || decoded.isNullAt(row);
+    };
+    bool hasNulls = false;
+    if (rows || decoded.mayHaveNulls()) {
+      for (auto i = 0; i < size && !hasNulls; ++i) {
+        hasNulls = isNull(i);
+      }
+    }
+    appendHeader(ColumnEncoding::kFlat, hasNulls);
+    if (hasNulls) {
+      appendBits(size, [&](auto i) { return !isNull(i); });
+    }
+    auto type = decoded.base()->type();
+    switch (type->kind()) {
+      case TypeKind::BOOLEAN:
+        appendBits(size, [&](auto i) {
+          return !isNull(i) && decoded.valueAt<bool>(rows ? rows[i] : i);
+        });
+        break;
+      case TypeKind::TINYINT:
+        writeValues<int8_t>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::SMALLINT:
+        writeValues<int16_t>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::INTEGER:
+        writeValues<int32_t>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::BIGINT:
+        writeValues<int64_t>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::REAL:
+        writeValues<float>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::DOUBLE:
+        writeValues<double>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::TIMESTAMP:
+        writeValues<Timestamp>(decoded, rows, size, isNull);
+        break;
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+        writeStrings(decoded, rows, size, isNull);
+        break;
+      case TypeKind::ARRAY: {
+        auto base = decoded.base()->as<ArrayVector>();
+        auto elementRows = writeOffsets(
+            decoded,
+            rows,
+            size,
+            isNull,
+            base->rawOffsets(),
+            base->rawSizes());
+        write(*base->elements(), elementRows.data(), elementRows.size());
+        break;
+      }
+      case TypeKind::MAP: {
+        auto base = decoded.base()->as<MapVector>();
+        auto elementRows = writeOffsets(
+            decoded,
+            rows,
+            size,
+            isNull,
+            base->rawOffsets(),
+            base->rawSizes());
+        write(*base->mapKeys(), elementRows.data(), elementRows.size());
+        write(*base->mapValues(), elementRows.data(), elementRows.size());
+        break;
+      }
+      case TypeKind::ROW: {
+        auto base = decoded.base()->as<RowVector>();
+        std::vector<vector_size_t> childRows(size);
+        for (auto i = 0; i < size; ++i) {
+          childRows[i] =
+              isNull(i) ? kNullRow : decoded.index(rows ? rows[i] : i);
+        }
+        for (auto& child : base->children()) {
+          write(*child, childRows.data(), size);
+        }
+        break;
+      }
+      default:
+        VELOX_UNSUPPORTED(
+            "Unsupported type in columnar file: {}", type->toString());
+    }
+  }
+
+  template <typename T, typename IsNull>
+  void writeValues(
+      const DecodedVector& decoded,
+      const vector_size_t* rows,
+      vector_size_t size,
+      IsNull isNull) {
+    if (!rows && decoded.isIdentityMapping()) {
+      appendBytes(decoded.data<T>(), size * sizeof(T));
+    } else {
+      auto offset = out_.size();
+      out_.resize(offset + size * sizeof(T));
+      auto values = reinterpret_cast<T*>(out_.data() + offset);
+      for (auto i = 0; i < size; ++i) {
+        values[i] = isNull(i) ? T() : decoded.valueAt<T>(rows ? rows[i] : i);
+      }
+    }
+    pad();
+  }
+
+  template <typename IsNull>
+  void writeStrings(
+      const DecodedVector& decoded,
+      const vector_size_t* rows,
+      vector_size_t size,
+      IsNull isNull) {
+    auto offset = out_.size();
+    out_.resize(offset + size * sizeof(StringView));
+    std::string bodies;
+    for (auto i = 0; i < size; ++i) {
+      auto value = isNull(i) ? StringView()
+                             : decoded.valueAt<StringView>(rows ? rows[i] : i);
+      auto view = out_.data() + offset + i * sizeof(StringView);
+      memcpy(view, &value, sizeof(StringView));
+      if (!value.isInline()) {
+        // The pointer follows the 4 bytes of size and 4 bytes of prefix.
+        uint64_t bodyOffset = bodies.size();
+        memcpy(view + sizeof(uint64_t), &bodyOffset, sizeof(uint64_t));
+        bodies.append(value.data(), value.size());
+      }
+    }
+    uint64_t bodiesSize = bodies.size();
+    appendBytes(&bodiesSize, sizeof(bodiesSize));
+    out_.append(bodies);
+    pad();
+  }
+
+  // Writes compacted offsets and sizes of arrays or maps and returns the
+  // rows of their elements.
+  template <typename IsNull>
+  std::vector<vector_size_t> writeOffsets(
+      const DecodedVector& decoded,
+      const vector_size_t* rows,
+      vector_size_t size,
+      IsNull isNull,
+      const vector_size_t* rawOffsets,
+      const vector_size_t* rawSizes) {
+    std::vector<vector_size_t> offsets(size);
+    std::vector<vector_size_t> sizes(size);
+    std::vector<vector_size_t> elementRows;
+    for (auto i = 0; i < size; ++i) {
+      offsets[i] = elementRows.size();
+      if (isNull(i)) {
+        sizes[i] = 0;
+        continue;
+      }
+      auto index = decoded.index(rows ? rows[i] : i);
+      sizes[i] = rawSizes[index];
+      for (auto j = 0; j < sizes[i]; ++j) {
+        elementRows.push_back(rawOffsets[index] + j);
+      }
+    }
+    appendBytes(offsets.data(), size * sizeof(vector_size_t));
+    pad();
+    appendBytes(sizes.data(), size * sizeof(vector_size_t));
+    pad();
+    int64_t numElements = elementRows.size();
+    appendBytes(&numElements, sizeof(numElements));
+    return elementRows;
+  }
+
+  std::string& out_;
+};
+
+// Keeps a MappedFile alive while buffers view its memory.
+struct MappedFileReleaser {
+  explicit MappedFileReleaser(std::shared_ptr<MappedFile> file)
+      : file_(std::move(file)) {}
+
+  void addRef() const {}
+  void release() const {}
+
+ private:
+  const std::shared_ptr<MappedFile> file_;
+};
+
+// Reads columns written by ColumnWriter from mapped memory starting at
+// 'position'. Wraps the buffers of the columns in BufferViews over the
+// mapped memory.
+class ColumnReader {
+ public:
+  ColumnReader(
+      const std::shared_ptr<MappedFile>& file,
+      char* position,
+      memory::MemoryPool* pool)
+      : releaser_(file), position_(position), pool_(pool) {}
+
+  VectorPtr read(const TypePtr& type, vector_size_t size) {
+    auto header = reinterpret_cast<const ColumnHeader*>(position_);
+    if (header->encoding == ColumnEncoding::kConstant) {
+      position_ += sizeof(ColumnHeader);
+      return BaseVector::wrapInConstant(size, 0, read(type, 1));
+    }
+    VELOX_CHECK(header->encoding == ColumnEncoding::kFlat);
+    return readFlat(type, size);
+  }
+
+  char* position() const {
+    return position_;
+  }
+
+ private:
+  // Returns a view over the next 'size' bytes and advances past their
+  // padding.
+  BufferPtr view(uint64_t size) {
+    auto buffer = BufferView<MappedFileReleaser>::create(
+        reinterpret_cast<const uint8_t*>(position_), size, releaser_);
+    position_ += padded(size);
+    return buffer;
+  }
+
+  template <typename T>
+  T next() {
+    T value;
+    memcpy(&value, position_, sizeof(T));
+    position_ += sizeof(T);
+    return value;
+  }
+
+  VectorPtr readFlat(const TypePtr& type, vector_size_t size) {
+    auto header = next<ColumnHeader>();
+    BufferPtr nulls;
+    if (header.hasNulls) {
+      nulls = view(bits::nbytes(size));
+    }
+    switch (type->kind()) {
+      case TypeKind::BOOLEAN:
+        return makeFlat<bool>(type, nulls, size, bits::nbytes(size));
+      case TypeKind::TINYINT:
+        return makeFlat<int8_t>(type, nulls, size);
+      case TypeKind::SMALLINT:
+        return makeFlat<int16_t>(type, nulls, size);
+      case TypeKind::INTEGER:
+        return makeFlat<int32_t>(type, nulls, size);
+      case TypeKind::BIGINT:
+        return makeFlat<int64_t>(type, nulls, size);
+      case TypeKind::REAL:
+        return makeFlat<float>(type, nulls, size);
+      case TypeKind::DOUBLE:
+        return makeFlat<double>(type, nulls, size);
+      case TypeKind::TIMESTAMP:
+        return makeFlat<Timestamp>(type, nulls, size);
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+        return readStrings(type, nulls, size);
+      case TypeKind::ARRAY: {
+        auto offsets = view(size * sizeof(vector_size_t));
+        auto sizes = view(size * sizeof(vector_size_t));
+        auto numElements = next<int64_t>();
+        auto elements = read(type->childAt(0), numElements);
+        return std::make_shared<ArrayVector>(
+            pool_, type, nulls, size, offsets, sizes, elements);
+      }
+      case TypeKind::MAP: {
+        auto offsets = view(size * sizeof(vector_size_t));
+        auto sizes = view(size * sizeof(vector_size_t));
+        auto numElements = next<int64_t>();
+        auto keys = read(type->childAt(0), numElements);
+        auto values = read(type->childAt(1), numElements);
+        return std::make_shared<MapVector>(
+            pool_, type, nulls, size, offsets, sizes, keys, values);
+      }
+      case TypeKind::ROW: {
+        std::vector<VectorPtr> children;
+        children.reserve(type->size());
+        for (auto i = 0; i < type->size(); ++i) {
+          children.push_back(read(type->childAt(i), size));
+        }
+        return std::make_shared<RowVector>(
+            pool_, type, nulls, size, std::move(children));
+      }
+      default:
+        VELOX_UNSUPPORTED(
+            "Unsupported type in columnar file: {}", type->toString());
+    }
+  }
+
+  template <typename T>
+  VectorPtr makeFlat(
+      const TypePtr& type,
+      const BufferPtr& nulls,
+      vector_size_t size,
+      uint64_t bytes = 0) {
+    auto values = view(bytes ? bytes : size * sizeof(T));
+    return std::make_shared<FlatVector<T>>(
+        pool_, type, nulls, size, values, std::vector<BufferPtr>());
+  }
+
+  VectorPtr
+  readStrings(const TypePtr& type, const BufferPtr& nulls, vector_size_t size) {
+    auto views = position_;
+    position_ += size * sizeof(StringView);
+    auto bodiesSize = next<uint64_t>();
+    auto bodies = position_;
+    for (auto i = 0; i < size; ++i) {
+      auto view = views + i * sizeof(StringView);
+      if (reinterpret_cast<const StringView*>(view)->isInline()) {
+        continue;
+      }
+      uint64_t bodyOffset;
+      memcpy(&bodyOffset, view + sizeof(uint64_t), sizeof(uint64_t));
+      VELOX_CHECK_LE(bodyOffset, bodiesSize);
+      auto body = bodies + bodyOffset;
+      memcpy(view + sizeof(uint64_t), &body, sizeof(body));
+    }
+    auto values = BufferView<MappedFileReleaser>::create(
+        reinterpret_cast<const uint8_t*>(views),
+        size * sizeof(StringView),
+        releaser_);
+    auto stringBuffer = view(bodiesSize);
+    return std::make_shared<FlatVector<StringView>>(
+        pool_,
+        type,
+        nulls,
+        size,
+        values,
+        std::vector<BufferPtr>{stringBuffer});
+  }
+
+  const MappedFileReleaser releaser_;
+  char* position_;
+  memory::MemoryPool* const pool_;
+};
+
+} // namespace
+
+// static
+void ColumnarFile::append(const RowVector& vector, std::string& out) {
+  auto start = out.size();
+  BatchHeader header{kBatchMagic, vector.size(), 0};
+  out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  ColumnWriter(out).write(vector, nullptr, vector.size());
+  header.size = out.size() - start;
+  memcpy(out.data() + start, &header, sizeof(header));
+}
+
+// static
+RowVectorPtr ColumnarFile::read(
+    const std::shared_ptr<MappedFile>& file,
+    uint64_t& offset,
+    const std::shared_ptr<const RowType>& type,
+    memory::MemoryPool* pool) {
+  VELOX_CHECK_LE(offset + sizeof(BatchHeader), file->size());
+  BatchHeader header;
+  memcpy(&header, file->data() + offset, sizeof(header));
+  VELOX_CHECK_EQ(header.magic, kBatchMagic, "Bad columnar file batch");
+  VELOX_CHECK_LE(offset + header.size, file->size());
+  ColumnReader reader(file, file->data() + offset + sizeof(header), pool);
+  auto result = std::dynamic_pointer_cast<RowVector>(
+      reader.read(type, header.numRows));
+  VELOX_CHECK_EQ(
+      static_cast<uint64_t>(reader.position() - file->data()),
+      offset + header.size);
+  offset += header.size;
+  return result;
+}
+
+} // namespace facebook::velox
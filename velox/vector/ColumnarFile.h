@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox {
+
+// A private, writable mapping of a whole local file. Writes go to
+// copy-on-write pages and never reach the file. Vectors read from the
+// mapping with ColumnarFile::read() keep it alive.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  char* data() const {
+    return data_;
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+ private:
+  char* data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+// Velox-native columnar format for spilling and caching vectors. A file
+// is a sequence of batches, each holding the rows of one RowVector. The
+// columns of a batch are laid out like FlatVector, ArrayVector, MapVector
+// and RowVector, with each buffer padded to 8 bytes, so that a batch read
+// from a mapped file is wrapped into vectors without copying:
+//
+//  - a column starts with its encoding and a null flag. Scalar columns
+//    with a single value or with only nulls are stored as a column of
+//    one row and are read back as a ConstantVector.
+//  - the nulls bitmap is omitted if the column has no nulls.
+//  - fixed width values and booleans are stored as in FlatVector.
+//  - strings are stored as an array of StringViews followed by the
+//    bodies of the non-inlined strings. The pointers of the StringViews
+//    are stored as offsets into the bodies and are set on read.
+//  - arrays and maps store offsets and sizes followed by their elements,
+//    which are compacted to the referenced rows only.
+//  - structs store their children one after the other.
+//
+// Dictionary and other wrappers are flattened on write. The format is not
+// meant to be portable between machines of different endianness.
+class ColumnarFile {
+ public:
+  // Serializes all rows of 'vector' as one batch and appends it to 'out'.
+  static void append(const RowVector& vector, std::string& out);
+
+  // Reads the batch that starts at 'offset' bytes into 'file' and sets
+  // 'offset' to the start of the next batch. The result references the
+  // mapped memory of 'file'. The StringView pointers of the batch are
+  // set in place, so that each batch can be read only once.
+  static RowVectorPtr read(
+      const std::shared_ptr<MappedFile>& file,
+      uint64_t& offset,
+      const std::shared_ptr<const RowType>& type,
+      memory::MemoryPool* pool);
+};
+
+} // namespace facebook::velox
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/vector/DecodedVector.h"
+#include "velox/common/base/SimdUtil.h"
 #include "velox/vector/BiasVector.h"
 #include "velox/vector/LazyVector.h"
 #include "velox/vector/SequenceVector.h"
@@ -31,6 +32,45 @@ std::vector<vector_size_t> makeConsecutiveIndices(size_t size) {
   }
   return consecutiveIndices;
 }
+
+// Sets 'result[row]' to 'inner[outer[row]]' for the selected rows. Fully
+// selected words of 'rows' use gathers of 8 indices. 'result' may be
+// the same as 'outer'.
+void composeIndices(
+    const SelectivityVector& rows,
+    const vector_size_t* outer,
+    const vector_size_t* inner,
+    vector_size_t* result) {
+  using V32 = simd::Vectors<int32_t>;
+  static_assert(sizeof(vector_size_t) == sizeof(int32_t));
+  const auto* selected = rows.asRange().bits();
+  auto composeSelected = [&](int32_t index, uint64_t mask) {
+    while (mask) {
+      auto row = index * 64 + __builtin_ctzll(mask);
+      result[row] = inner[outer[row]];
+      mask &= mask - 1;
+    }
+  };
+  bits::forEachWord(
+      rows.begin(),
+      rows.end(),
+      [&](int32_t index, uint64_t mask) {
+        composeSelected(index, mask & selected[index]);
+      },
+      [&](int32_t index) {
+        auto mask = selected[index];
+        if (mask != ~0UL) {
+          // Unselected rows may have indices that are out of range.
+          composeSelected(index, mask);
+          return;
+        }
+        for (auto row = index * 64; row < (index + 1) * 64;
+             row += V32::VSize) {
+          V32::store(
+              result + row, V32::gather32(inner, V32::load(outer + row)));
+        }
+      });
+}
 } // namespace
 
 const std::vector<vector_size_t>& DecodedVector::consecutiveIndices() {
@@ -196,6 +236,12 @@ void DecodedVector::combineWrappers(
           indices_ = copiedIndices_.data();
         }
 
+        if (!nulls_ && !newNulls) {
+          composeIndices(
+              rows, currentIndices, newIndices, copiedIndices_.data());
+          values = values->valueVector().get();
+          break;
+        }
         rows.applyToSelected([&, this](vector_size_t row) {
           if (!nulls_ || !bits::isBitNull(nulls_, row)) {
             auto wrappedIndex = currentIndices[row];
@@ -317,12 +363,25 @@ void DecodedVector::setFlatNulls(
     }
     auto leafNulls = vector.rawNulls();
     auto copiedNulls = &copiedNulls_[0];
-    rows.applyToSelected([&, this](vector_size_t row) {
-      if (!bits::isBitNull(nulls_, row) &&
-          (leafNulls && bits::isBitNull(leafNulls, indices_[row]))) {
-        bits::setNull(copiedNulls, row);
+    if (leafNulls && rows.isAllSelected()) {
+      // Gathers the leaf nulls through the indices a word at a time.
+      for (auto row = 0; row < rows.end(); row += 64) {
+        auto numRows = std::min<int32_t>(64, rows.end() - row);
+        uint64_t gathered = bits::kNotNull64;
+        simd::gatherBits(leafNulls, indices_ + row, numRows, &gathered);
+        if (numRows < 64) {
+          gathered |= ~bits::lowMask(numRows);
+        }
+        copiedNulls[row / 64] &= gathered;
       }
-    });
+    } else if (leafNulls) {
+      rows.applyToSelected([&, this](vector_size_t row) {
+        if (!bits::isBitNull(nulls_, row) &&
+            bits::isBitNull(leafNulls, indices_[row])) {
+          bits::setNull(copiedNulls, row);
+        }
+      });
+    }
     nulls_ = &copiedNulls_[0];
   } else {
     nulls_ = vector.rawNulls();
@@ -39,4 +39,39 @@ void VectorLoader::load(
   rows.applyToSelected([&](vector_size_t row) { positions[index++] = row; });
   load(positions, hook, result);
 }
+
+// static
+void LazyVector::ensureLoadedRows(
+    const BaseVector& vector,
+    const SelectivityVector& rows) {
+  if (!isLazyNotLoaded(vector)) {
+    return;
+  }
+  if (vector.encoding() == VectorEncoding::Simple::CONSTANT) {
+    // A constant refers to a single position, which is loaded on access.
+    vector.loadedVector();
+    return;
+  }
+  DecodedVector decoded(vector, rows, false);
+  VELOX_CHECK_EQ(decoded.base()->encoding(), VectorEncoding::Simple::LAZY);
+  auto lazyVector = decoded.base()->asUnchecked<LazyVector>();
+  std::vector<vector_size_t> positions;
+  if (decoded.isIdentityMapping()) {
+    positions.reserve(rows.countSelected());
+    rows.applyToSelected([&](vector_size_t row) { positions.push_back(row); });
+  } else {
+    SelectivityVector baseRows(lazyVector->size(), false);
+    rows.applyToSelected([&](vector_size_t row) {
+      if (!decoded.isNullAt(row)) {
+        baseRows.setValid(decoded.index(row), true);
+      }
+    });
+    baseRows.updateBounds();
+    baseRows.applyToSelected(
+        [&](vector_size_t row) { positions.push_back(row); });
+  }
+  lazyVector->load(positions, nullptr);
+  // Initializes the wrappers of the loaded vector.
+  vector.loadedVector();
+}
 } // namespace facebook::velox
@@ -138,6 +138,15 @@ class LazyVector : public BaseVector {
     loader_->load(rows, hook, &vector_);
   }
 
+  // Loads the LazyVector under 'vector', if it is not loaded yet, for
+  // the positions referenced by 'rows' of 'vector'. 'vector' may wrap
+  // the LazyVector in dictionaries or a constant. Used by operators to
+  // load a column for just the rows that survive filters and joins
+  // before wrapping it in more than one dictionary.
+  static void ensureLoadedRows(
+      const BaseVector& vector,
+      const SelectivityVector& rows);
+
   bool equalValueAt(
       const BaseVector* other,
       vector_size_t index,
@@ -368,9 +368,35 @@ inline void SelectivityVector::applyToSelected(Callable func) const {
     for (vector_size_t row = begin_; row < end_; ++row) {
       func(row);
     }
-  } else {
-    bits::forEachSetBit(bits_.data(), begin_, end_, func);
-  }
+    return;
+  }
+  // Runs of fully selected words, e.g. a contiguous range that does not
+  // start at 0, get the same counted loop as the all selected case so that
+  // simple functions vectorize. Other words loop over their set bits.
+  const auto* bits = bits_.data();
+  auto forEachSetBitInWord = [&](int32_t index, uint64_t word) {
+    while (word) {
+      func(index * 64 + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  };
+  bits::forEachWord(
+      begin_,
+      end_,
+      [&](int32_t index, uint64_t mask) {
+        forEachSetBitInWord(index, bits[index] & mask);
+      },
+      [&](int32_t index) {
+        auto word = bits[index];
+        if (word != ~0ULL) {
+          forEachSetBitInWord(index, word);
+          return;
+        }
+        auto firstRow = index * 64;
+        for (vector_size_t row = firstRow; row < firstRow + 64; ++row) {
+          func(row);
+        }
+      });
 }
 
 template <typename Callable>
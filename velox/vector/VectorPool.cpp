@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/vector/VectorPool.h"
+
+namespace facebook::velox {
+namespace {
+// Bytes of the values buffer of a flat vector of scalar 'type' with 'size'
+// rows.
+uint64_t valuesBytes(const Type& type, vector_size_t size) {
+  switch (type.kind()) {
+    case TypeKind::BOOLEAN:
+      return bits::nbytes(size);
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return sizeof(StringView) * size;
+    default:
+      return type.cppSizeInBytes() * size;
+  }
+}
+} // namespace
+
+VectorPtr VectorPool::get(
+    const TypePtr& type,
+    vector_size_t size,
+    memory::MemoryPool* FOLLY_NONNULL pool) {
+  auto kind = type->kind();
+  if (kind == TypeKind::ROW) {
+    std::vector<VectorPtr> children;
+    children.reserve(type->size());
+    // Like BaseVector::create, children get the capacity of the parent but
+    // are empty.
+    for (auto i = 0; i < type->size(); ++i) {
+      children.push_back(get(type->childAt(i), size, pool));
+      children.back()->resize(0);
+    }
+    return std::make_shared<RowVector>(
+        pool,
+        type,
+        BufferPtr(nullptr),
+        size,
+        std::move(children),
+        0 /*nullCount*/);
+  }
+
+  if (isCachedKind(kind)) {
+    auto& cached = vectors_[static_cast<int32_t>(kind)];
+    // Prefer the most recently released vector among the ones that have room
+    // for 'size' values. Fall back to any vector of the right type, which
+    // then grows its buffers in resize().
+    int32_t best = -1;
+    for (auto i = static_cast<int32_t>(cached.size()) - 1; i >= 0; --i) {
+      if (*cached[i]->type() != *type) {
+        continue;
+      }
+      auto& values = cached[i]->values();
+      if (!values) {
+        continue;
+      }
+      if (values->capacity() >= valuesBytes(*type, size)) {
+        best = i;
+        break;
+      }
+      if (best == -1) {
+        best = i;
+      }
+    }
+    if (best != -1) {
+      auto vector = std::move(cached[best]);
+      cached.erase(cached.begin() + best);
+      vector->resize(size);
+      return vector;
+    }
+  }
+  return BaseVector::create(type, size, pool);
+}
+
+bool VectorPool::release(VectorPtr& vector) {
+  VectorPtr released = std::move(vector);
+  if (!released || !isCachedKind(released->typeKind()) ||
+      released->size() > kMaxRows ||
+      !BaseVector::isReusableFlatVector(released)) {
+    return false;
+  }
+  auto& cached = vectors_[static_cast<int32_t>(released->typeKind())];
+  if (cached.size() >= kNumPerKind) {
+    return false;
+  }
+  // Drops string buffers and nulls. The values buffer keeps its capacity.
+  released->resize(0);
+  released->resetNulls();
+  cached.push_back(std::move(released));
+  return true;
+}
+
+size_t VectorPool::release(RowVectorPtr& vector) {
+  RowVectorPtr released = std::move(vector);
+  if (!released || !released.unique()) {
+    return 0;
+  }
+  return release(released->children());
+}
+
+size_t VectorPool::release(std::vector<VectorPtr>& vectors) {
+  size_t numCached = 0;
+  for (auto& vector : vectors) {
+    numCached += release(vector);
+  }
+  return numCached;
+}
+
+size_t VectorPool::numCached(TypeKind kind) const {
+  return isCachedKind(kind) ? vectors_[static_cast<int32_t>(kind)].size() : 0;
+}
+
+} // namespace facebook::velox
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox {
+
+/// Per-thread cache of flat vectors of fixed width and string types. Operators
+/// release vectors they no longer reference to the pool and allocate new ones
+/// from it, so that the nulls, values and string buffers of one batch are
+/// recycled for the next instead of going back to the memory pool.
+///
+/// A vector is only taken into the pool if it and its buffers are singly
+/// referenced and mutable. A recycled vector keeps the memory pool it was
+/// originally allocated from. The pool is owned by a Driver and is not thread
+/// safe.
+class VectorPool {
+ public:
+  /// Maximum number of cached vectors of each TypeKind.
+  static constexpr int32_t kNumPerKind = 10;
+
+  /// Vectors with more than this many rows are not cached.
+  static constexpr vector_size_t kMaxRows = 64 * 1024;
+
+  /// Returns a vector of 'type' with 'size' rows and no nulls. Flat vectors of
+  /// a scalar type and the scalar children of a ROW type come from the cache
+  /// if possible. Anything else is allocated from 'pool'.
+  VectorPtr get(
+      const TypePtr& type,
+      vector_size_t size,
+      memory::MemoryPool* FOLLY_NONNULL pool);
+
+  /// Takes 'vector' into the pool if it is reusable. Clears 'vector' in all
+  /// cases. Returns true if the vector was cached.
+  bool release(VectorPtr& vector);
+
+  /// Releases the children of 'vector' if 'vector' is singly referenced.
+  /// Clears 'vector' in all cases. Returns the number of cached children.
+  size_t release(RowVectorPtr& vector);
+
+  /// Releases each element of 'vectors'. Returns the number of cached
+  /// vectors.
+  size_t release(std::vector<VectorPtr>& vectors);
+
+  /// Number of cached vectors of 'kind'.
+  size_t numCached(TypeKind kind) const;
+
+ private:
+  static constexpr int32_t kNumCachedKinds =
+      static_cast<int32_t>(TypeKind::TIMESTAMP) + 1;
+
+  static bool isCachedKind(TypeKind kind) {
+    return static_cast<int32_t>(kind) < kNumCachedKinds;
+  }
+
+  std::array<std::vector<VectorPtr>, kNumCachedKinds> vectors_;
+};
+
+} // namespace facebook::velox
@@ -35,6 +35,19 @@ bool isRegisteredVectorSerde() {
   return (getVectorSerde().get() != nullptr);
 }
 
+VectorSerdeCompression toVectorSerdeCompression(const std::string& name) {
+  if (name == "none") {
+    return VectorSerdeCompression::kNone;
+  }
+  if (name == "lz4") {
+    return VectorSerdeCompression::kLz4;
+  }
+  if (name == "zstd") {
+    return VectorSerdeCompression::kZstd;
+  }
+  VELOX_USER_FAIL("Unknown vector serde compression: {}", name);
+}
+
 void StreamArena::newRange(int32_t bytes, ByteRange* range) {
   VELOX_CHECK(bytes > 0);
   memory::MachinePageCount numPages =
@@ -93,9 +106,11 @@ void ByteStream::flush(std::ostream* out) {
 
 void VectorStreamGroup::createStreamTree(
     std::shared_ptr<const RowType> type,
-    int32_t numRows) {
+    int32_t numRows,
+    const VectorSerde::Options* options) {
   VELOX_CHECK(getVectorSerde().get(), "Vector serde is not registered");
-  serializer_ = getVectorSerde()->createSerializer(type, numRows, this);
+  serializer_ =
+      getVectorSerde()->createSerializer(type, numRows, this, options);
 }
 
 void VectorStreamGroup::append(
@@ -104,6 +119,27 @@ void VectorStreamGroup::append(
   serializer_->append(vector, ranges);
 }
 
+void VectorStreamGroup::appendSerializedRows(
+    const SerializedRows& rows,
+    const folly::Range<const IndexRange*>& ranges) {
+  serializer_->appendSerializedRows(rows, ranges);
+}
+
+// static
+bool VectorStreamGroup::isRowWise() {
+  VELOX_CHECK(getVectorSerde().get(), "Vector serde is not registered");
+  return getVectorSerde()->isRowWise();
+}
+
+// static
+void VectorStreamGroup::serializeRows(
+    const std::shared_ptr<RowVector>& vector,
+    memory::MappedMemory* mappedMemory,
+    SerializedRows& rows) {
+  VELOX_CHECK(getVectorSerde().get(), "Vector serde is not registered");
+  getVectorSerde()->serializeRows(vector, mappedMemory, rows);
+}
+
 void VectorStreamGroup::flush(std::ostream* out) {
   serializer_->flush(out);
 }
@@ -15,6 +15,9 @@
  */
 #pragma once
 
+#include <functional>
+#include <mutex>
+
 #include "velox/buffer/Buffer.h"
 #include "velox/common/memory/MappedMemory.h"
 #include "velox/common/memory/Memory.h"
@@ -80,6 +83,24 @@ class StreamArena {
   std::vector<std::string> tinyRanges_;
 };
 
+// The rows of a vector serialized by a row-wise VectorSerde. Each row is
+// serialized once and its bytes can then be appended to the serializers of
+// any number of repartitioning targets without re-encoding the columns.
+struct SerializedRows {
+  // The serialized rows, back to back.
+  std::string data;
+  // Offset of each row in 'data' followed by the end of the last row.
+  std::vector<size_t> offsets;
+
+  vector_size_t size() const {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+  }
+
+  size_t rowSize(vector_size_t row) const {
+    return offsets[row + 1] - offsets[row];
+  }
+};
+
 class VectorSerializer {
  public:
   virtual ~VectorSerializer() = default;
@@ -88,12 +109,36 @@ class VectorSerializer {
       std::shared_ptr<RowVector> vector,
       const folly::Range<const IndexRange*>& ranges) = 0;
 
+  // Appends the rows in 'ranges' of 'rows'. 'rows' are produced by
+  // VectorSerde::serializeRows() of the same serde. Only supported by
+  // row-wise serdes.
+  virtual void appendSerializedRows(
+      const SerializedRows& /*rows*/,
+      const folly::Range<const IndexRange*>& /*ranges*/) {
+    VELOX_UNSUPPORTED("Serializer does not support serialized rows");
+  }
+
   // Writes the contents to 'stream' in wire format
   virtual void flush(std::ostream* stream) = 0;
 };
 
+// Compression of the pages written by a VectorSerializer.
+enum class VectorSerdeCompression { kNone, kLz4, kZstd };
+
+// Returns the compression named by 'name', which is one of "none",
+// "lz4" or "zstd".
+VectorSerdeCompression toVectorSerdeCompression(const std::string& name);
+
 class VectorSerde {
  public:
+  struct Options {
+    VectorSerdeCompression compression{VectorSerdeCompression::kNone};
+
+    // A page is written uncompressed if compressing does not shrink it
+    // to at most this fraction of its uncompressed size.
+    double maxCompressedFraction{0.8};
+  };
+
   virtual ~VectorSerde() = default;
 
   virtual void estimateSerializedSize(
@@ -104,13 +149,31 @@ class VectorSerde {
   virtual std::unique_ptr<VectorSerializer> createSerializer(
       std::shared_ptr<const RowType> type,
       int32_t numRows,
-      StreamArena* streamArena) = 0;
+      StreamArena* streamArena,
+      const Options* options = nullptr) = 0;
 
   virtual void deserialize(
       ByteStream* source,
       velox::memory::MemoryPool* pool,
       std::shared_ptr<const RowType> type,
       std::shared_ptr<RowVector>* result) = 0;
+
+  // Returns true if the serde writes each row independently of the
+  // others. The rows of a vector can then be serialized once with
+  // serializeRows() and appended to many serializers with
+  // VectorSerializer::appendSerializedRows().
+  virtual bool isRowWise() const {
+    return false;
+  }
+
+  // Serializes all rows of 'vector' into 'rows'. Temporary memory comes
+  // from 'mappedMemory'. Only supported if isRowWise() is true.
+  virtual void serializeRows(
+      const std::shared_ptr<RowVector>& /*vector*/,
+      memory::MappedMemory* /*mappedMemory*/,
+      SerializedRows& /*rows*/) {
+    VELOX_UNSUPPORTED("Vector serde is not row-wise");
+  }
 };
 
 bool registerVectorSerde(std::unique_ptr<VectorSerde> serde);
@@ -135,7 +198,10 @@ class VectorStreamGroup : public StreamArena {
   explicit VectorStreamGroup(memory::MappedMemory* mappedMemory)
       : StreamArena(mappedMemory) {}
 
-  void createStreamTree(std::shared_ptr<const RowType> type, int32_t numRows);
+  void createStreamTree(
+      std::shared_ptr<const RowType> type,
+      int32_t numRows,
+      const VectorSerde::Options* options = nullptr);
 
   static void estimateSerializedSize(
       std::shared_ptr<BaseVector> vector,
@@ -146,9 +212,49 @@ class VectorStreamGroup : public StreamArena {
       std::shared_ptr<RowVector> vector,
       const folly::Range<const IndexRange*>& ranges);
 
+  // Appends rows produced by serializeRows(). See
+  // VectorSerializer::appendSerializedRows().
+  void appendSerializedRows(
+      const SerializedRows& rows,
+      const folly::Range<const IndexRange*>& ranges);
+
+  // Returns true if the registered serde is row-wise.
+  static bool isRowWise();
+
+  // Serializes all rows of 'vector' with the registered serde, which must be
+  // row-wise.
+  static void serializeRows(
+      const std::shared_ptr<RowVector>& vector,
+      memory::MappedMemory* mappedMemory,
+      SerializedRows& rows);
+
   // Writes the contents to 'stream' in wire format.
   void flush(std::ostream* stream);
 
+  // Marks 'this' as read by many consumers, e.g. the destinations of a
+  // broadcast. These can then share one copy of the flushed contents
+  // via getOrMakeShared() instead of each flushing a copy of their own.
+  void markShared() {
+    isShared_ = true;
+  }
+
+  bool isShared() const {
+    return isShared_;
+  }
+
+  // Returns the object made by 'make' on the first call and the same
+  // object on later calls. Callers on other threads wait while 'make'
+  // runs. The object is freed together with 'this' at the latest.
+  template <typename T>
+  std::shared_ptr<T> getOrMakeShared(
+      const std::function<std::shared_ptr<T>()>& make) {
+    std::lock_guard<std::mutex> l(sharedMutex_);
+    if (!shared_) {
+      shared_ = make();
+    }
+    return std::static_pointer_cast<T>(shared_);
+  }
+
   // Reads data in wire format. Returns the RowVector in 'result'.
   static void read(
       ByteStream* source,
@@ -158,6 +264,9 @@ class VectorStreamGroup : public StreamArena {
 
  private:
   std::unique_ptr<VectorSerializer> serializer_;
+  bool isShared_{false};
+  std::mutex sharedMutex_;
+  std::shared_ptr<void> shared_;
 };
 
 struct ByteRange {
@@ -204,6 +313,19 @@ class ByteStream {
     ranges_ = std::move(ranges);
     current_ = &ranges_[0];
   }
+
+  // For input. Sets an owner that keeps the memory of the input ranges
+  // alive. If set, deserializers may return vectors that reference the
+  // input in place instead of copying it. These vectors hold a reference
+  // to 'owner'.
+  void setInputOwner(std::shared_ptr<void> owner) {
+    inputOwner_ = std::move(owner);
+  }
+
+  const std::shared_ptr<void>& inputOwner() const {
+    return inputOwner_;
+  }
+
   void setRange(ByteRange range) {
     ranges_.resize(1);
     ranges_[0] = range;
@@ -337,6 +459,22 @@ class ByteStream {
         reinterpret_cast<char*>(current_->buffer) + position, viewSize);
   }
 
+  // For input. Returns a pointer to the 'size' bytes that start 'offset'
+  // bytes after the read position if they are inside one range, nullptr
+  // otherwise. Does not advance.
+  const uint8_t* peek(int32_t offset, int32_t size) const {
+    const ByteRange* range = current_;
+    int32_t position = range->position + offset;
+    while (position >= range->size && range != &ranges_.back()) {
+      position -= range->size;
+      ++range;
+    }
+    if (range->size - position < size) {
+      return nullptr;
+    }
+    return range->buffer + position;
+  }
+
   void skip(int32_t size) {
     for (;;) {
       int32_t available = current_->size - current_->position;
@@ -448,6 +586,9 @@ class ByteStream {
   // bit order.
   bool isReversed_ = false;
   std::vector<ByteRange> ranges_;
+  // Keeps the memory of input 'ranges_' alive for vectors that reference
+  // it. See setInputOwner().
+  std::shared_ptr<void> inputOwner_;
   // Pointer to the current element of 'ranges_'.
   ByteRange* current_ = nullptr;
 };
@@ -15,19 +15,23 @@
  */
 
 #include "velox/vector/arrow/Bridge.h"
+
+#include <folly/ScopeGuard.h>
+
 #include "velox/buffer/Buffer.h"
 #include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
 #include "velox/common/memory/Memory.h"
+#include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox {
 
 namespace {
 
-// TODO: The initial supported conversions only use one buffer for nulls and
-// one for value, but we'll need more once we support strings and complex types.
-static constexpr size_t kMaxBuffers{2};
+// Arrow arrays use up to three buffers: nulls, values or offsets, and the
+// character data of strings.
+static constexpr size_t kMaxBuffers{3};
 
 // Structure that will hold the buffers needed by ArrowArray. This is opaquely
 // carried by ArrowArray.private_data
@@ -37,6 +41,19 @@ struct VeloxToArrowBridgeHolder {
 
   // Holds the pointers to buffers.
   const void* buffers[kMaxBuffers];
+
+  // Buffers allocated by the export, e.g. Arrow offsets, which Velox vectors
+  // do not have.
+  std::vector<BufferPtr> ownedBuffers;
+
+  // Same as for VeloxToArrowSchemaBridgeHolder, the following invariable
+  // should always hold:
+  //   childrenRaw[i] == childrenOwned[i].get()
+  std::vector<ArrowArray*> childrenRaw;
+  std::vector<std::unique_ptr<ArrowArray>> childrenOwned;
+
+  // The dictionary of a dictionary encoded array.
+  std::unique_ptr<ArrowArray> dictionary;
 };
 
 // Structure that will hold buffers needed by ArrowSchema. This is opaquely
@@ -55,6 +72,9 @@ struct VeloxToArrowSchemaBridgeHolder {
   // ArrowSchema.name pointer to the internal string that contains the column
   // name.
   RowTypePtr rowType;
+
+  // The schema of the dictionary of a dictionary encoded vector.
+  std::unique_ptr<ArrowSchema> dictionary;
 };
 
 // Release function for ArrowArray. Arrow standard requires it to recurse down
@@ -125,7 +145,67 @@ static void bridgeSchemaRelease(ArrowSchema* arrowSchema) {
   arrowSchema->private_data = nullptr;
 }
 
-void exportFlatVector(const VectorPtr& vector, ArrowArray& arrowArray) {
+// Exports the StringViews of 'vector' as Arrow int32 offsets and character
+// data. If the strings are stored back to back in one string buffer, as
+// when built by appending, the character data is that buffer. Otherwise the
+// strings are copied into a new buffer. The offsets are always new.
+void exportStrings(
+    const FlatVector<StringView>& vector,
+    ArrowArray& arrowArray,
+    VeloxToArrowBridgeHolder& bridgeHolder) {
+  const auto size = vector.size();
+  const StringView* values = vector.rawValues();
+  auto offsets = AlignedBuffer::allocate<int32_t>(size + 1, vector.pool());
+  auto rawOffsets = offsets->asMutable<int32_t>();
+
+  // Data of the first non-empty string and the end of the last one, if all
+  // strings are contiguous.
+  const char* start = nullptr;
+  const char* end = nullptr;
+  bool contiguous = true;
+  size_t totalBytes = 0;
+  for (auto i = 0; i < size; ++i) {
+    rawOffsets[i] = totalBytes;
+    if (vector.isNullAt(i) || values[i].empty()) {
+      continue;
+    }
+    if (!start) {
+      start = values[i].data();
+      end = start;
+    }
+    contiguous = contiguous && values[i].data() == end;
+    end += values[i].size();
+    totalBytes += values[i].size();
+  }
+  VELOX_USER_CHECK_LE(
+      totalBytes,
+      std::numeric_limits<int32_t>::max(),
+      "Strings are too large to export to Arrow.");
+  rawOffsets[size] = totalBytes;
+  bridgeHolder.ownedBuffers.push_back(offsets);
+
+  arrowArray.n_buffers = 3;
+  arrowArray.buffers[1] = rawOffsets;
+  if (contiguous) {
+    arrowArray.buffers[2] = start;
+    return;
+  }
+
+  auto data = AlignedBuffer::allocate<char>(totalBytes, vector.pool());
+  auto rawData = data->asMutable<char>();
+  for (auto i = 0; i < size; ++i) {
+    if (!vector.isNullAt(i)) {
+      memcpy(rawData + rawOffsets[i], values[i].data(), values[i].size());
+    }
+  }
+  bridgeHolder.ownedBuffers.push_back(data);
+  arrowArray.buffers[2] = rawData;
+}
+
+void exportFlatVector(
+    const VectorPtr& vector,
+    ArrowArray& arrowArray,
+    VeloxToArrowBridgeHolder& bridgeHolder) {
   switch (vector->typeKind()) {
     case TypeKind::BOOLEAN:
     case TypeKind::TINYINT:
@@ -137,6 +217,12 @@ void exportFlatVector(const VectorPtr& vector, ArrowArray& arrowArray) {
       arrowArray.buffers[1] = vector->valuesAsVoid();
       break;
 
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      exportStrings(
+          *vector->asFlatVector<StringView>(), arrowArray, bridgeHolder);
+      break;
+
     default:
       VELOX_NYI(
           "Conversion of FlatVector of {} is not supported yet.",
@@ -144,6 +230,209 @@ void exportFlatVector(const VectorPtr& vector, ArrowArray& arrowArray) {
   }
 }
 
+// Returns true if the non-null, non-empty arrays or maps of 'vector' are
+// stored one after another in row order. Their elements can then be exported
+// as is, otherwise they are compacted first.
+bool hasContiguousRanges(
+    const BaseVector& vector,
+    const vector_size_t* rawOffsets,
+    const vector_size_t* rawSizes) {
+  std::optional<vector_size_t> end;
+  for (auto i = 0; i < vector.size(); ++i) {
+    if (vector.isNullAt(i) || rawSizes[i] == 0) {
+      continue;
+    }
+    if (end.has_value() && rawOffsets[i] != end.value()) {
+      return false;
+    }
+    end = rawOffsets[i] + rawSizes[i];
+  }
+  return true;
+}
+
+// Returns the 'size + 1' Arrow offsets of the arrays or maps of 'vector'.
+// Null rows are empty. If 'contiguous', the offsets point into the original
+// elements, otherwise into the elements compacted by compactElements().
+template <typename TOffset>
+BufferPtr exportOffsets(
+    const BaseVector& vector,
+    const vector_size_t* rawOffsets,
+    const vector_size_t* rawSizes,
+    bool contiguous) {
+  const auto size = vector.size();
+  auto offsets = AlignedBuffer::allocate<TOffset>(size + 1, vector.pool());
+  auto rawArrowOffsets = offsets->asMutable<TOffset>();
+  TOffset end = 0;
+  if (contiguous) {
+    for (auto i = 0; i < size; ++i) {
+      if (!vector.isNullAt(i) && rawSizes[i] > 0) {
+        end = rawOffsets[i];
+        break;
+      }
+    }
+  }
+  for (auto i = 0; i < size; ++i) {
+    rawArrowOffsets[i] = end;
+    if (!vector.isNullAt(i)) {
+      end += rawSizes[i];
+    }
+  }
+  rawArrowOffsets[size] = end;
+  return offsets;
+}
+
+// Copies the elements of the non-null rows of 'vector' into a new vector in
+// row order.
+VectorPtr compactElements(
+    const VectorPtr& elements,
+    const BaseVector& vector,
+    const vector_size_t* rawOffsets,
+    const vector_size_t* rawSizes) {
+  vector_size_t numElements = 0;
+  for (auto i = 0; i < vector.size(); ++i) {
+    if (!vector.isNullAt(i)) {
+      numElements += rawSizes[i];
+    }
+  }
+  auto compacted =
+      BaseVector::create(elements->type(), numElements, vector.pool());
+  vector_size_t target = 0;
+  for (auto i = 0; i < vector.size(); ++i) {
+    if (!vector.isNullAt(i) && rawSizes[i] > 0) {
+      compacted->copy(elements.get(), target, rawOffsets[i], rawSizes[i]);
+      target += rawSizes[i];
+    }
+  }
+  return compacted;
+}
+
+// Exports 'children' as the children of 'arrowArray', which is held by
+// 'bridgeHolder'. If one of the children throws, the children that have
+// already been exported are released before re-throwing, since Arrow does
+// not define what the client needs to do if the conversion fails.
+void exportChildren(
+    VeloxToArrowBridgeHolder& bridgeHolder,
+    ArrowArray& arrowArray,
+    const std::vector<VectorPtr>& children) {
+  const auto numChildren = children.size();
+  bridgeHolder.childrenRaw.resize(numChildren);
+  bridgeHolder.childrenOwned.resize(numChildren);
+  for (size_t i = 0; i < numChildren; ++i) {
+    try {
+      VELOX_CHECK_NOT_NULL(children[i], "Cannot export a null child vector.");
+      auto& child = bridgeHolder.childrenOwned[i];
+      child = std::make_unique<ArrowArray>();
+      exportToArrow(children[i], *child);
+      bridgeHolder.childrenRaw[i] = child.get();
+    } catch (const VeloxException& e) {
+      for (size_t j = 0; j < i; ++j) {
+        bridgeHolder.childrenRaw[j]->release(bridgeHolder.childrenRaw[j]);
+      }
+      throw;
+    }
+  }
+  arrowArray.n_children = numChildren;
+  arrowArray.children = bridgeHolder.childrenRaw.data();
+}
+
+// Initializes 'arrowArray' with no buffers, children or dictionary and sets
+// the bridge holder, which is released with 'arrowArray'.
+void initArrowArray(
+    ArrowArray& arrowArray,
+    std::unique_ptr<VeloxToArrowBridgeHolder>& bridgeHolder,
+    int64_t length,
+    int64_t nullCount) {
+  arrowArray.length = length;
+  arrowArray.null_count = nullCount;
+
+  // Velox does not support offset'ed vectors yet.
+  arrowArray.offset = 0;
+  arrowArray.n_buffers = 1;
+  arrowArray.buffers = bridgeHolder->buffers;
+  arrowArray.buffers[0] = nullptr;
+  arrowArray.n_children = 0;
+  arrowArray.children = nullptr;
+  arrowArray.dictionary = nullptr;
+  arrowArray.release = bridgeRelease;
+}
+
+// Exports the keys and values of a map as the non-null struct array of its
+// entries.
+void exportMapEntries(
+    const VectorPtr& keys,
+    const VectorPtr& values,
+    ArrowArray& arrowArray) {
+  auto bridgeHolder = std::make_unique<VeloxToArrowBridgeHolder>();
+  initArrowArray(arrowArray, bridgeHolder, keys->size(), 0);
+  exportChildren(*bridgeHolder, arrowArray, {keys, values});
+  arrowArray.private_data = bridgeHolder.release();
+}
+
+// Arrays are exported as Arrow large lists with int64 offsets. The elements
+// are exported without copying if the arrays are stored in row order.
+void exportArrays(
+    const ArrayVector& vector,
+    ArrowArray& arrowArray,
+    VeloxToArrowBridgeHolder& bridgeHolder) {
+  auto rawOffsets = vector.rawOffsets();
+  auto rawSizes = vector.rawSizes();
+  bool contiguous = hasContiguousRanges(vector, rawOffsets, rawSizes);
+  auto offsets =
+      exportOffsets<int64_t>(vector, rawOffsets, rawSizes, contiguous);
+  bridgeHolder.ownedBuffers.push_back(offsets);
+  arrowArray.n_buffers = 2;
+  arrowArray.buffers[1] = offsets->as<int64_t>();
+
+  auto elements = contiguous
+      ? vector.elements()
+      : compactElements(vector.elements(), vector, rawOffsets, rawSizes);
+  exportChildren(bridgeHolder, arrowArray, {elements});
+}
+
+// Maps are exported as Arrow maps, i.e. lists with int32 offsets of a struct
+// of keys and values.
+void exportMaps(
+    const MapVector& vector,
+    ArrowArray& arrowArray,
+    VeloxToArrowBridgeHolder& bridgeHolder) {
+  auto rawOffsets = vector.rawOffsets();
+  auto rawSizes = vector.rawSizes();
+  bool contiguous = hasContiguousRanges(vector, rawOffsets, rawSizes);
+  auto offsets =
+      exportOffsets<int32_t>(vector, rawOffsets, rawSizes, contiguous);
+  bridgeHolder.ownedBuffers.push_back(offsets);
+  arrowArray.n_buffers = 2;
+  arrowArray.buffers[1] = offsets->as<int32_t>();
+
+  auto keys = vector.mapKeys();
+  auto values = vector.mapValues();
+  if (!contiguous) {
+    keys = compactElements(keys, vector, rawOffsets, rawSizes);
+    values = compactElements(values, vector, rawOffsets, rawSizes);
+  }
+  bridgeHolder.childrenRaw.resize(1);
+  bridgeHolder.childrenOwned.resize(1);
+  bridgeHolder.childrenOwned[0] = std::make_unique<ArrowArray>();
+  exportMapEntries(keys, values, *bridgeHolder.childrenOwned[0]);
+  bridgeHolder.childrenRaw[0] = bridgeHolder.childrenOwned[0].get();
+  arrowArray.n_children = 1;
+  arrowArray.children = bridgeHolder.childrenRaw.data();
+}
+
+// A dictionary vector is exported as an Arrow dictionary array: its own nulls,
+// its indices as int32 Arrow indices, and the exported base vector as the
+// dictionary. Nothing is copied.
+void exportDictionary(
+    const VectorPtr& vector,
+    ArrowArray& arrowArray,
+    VeloxToArrowBridgeHolder& bridgeHolder) {
+  arrowArray.n_buffers = 2;
+  arrowArray.buffers[1] = vector->wrapInfo()->as<vector_size_t>();
+  bridgeHolder.dictionary = std::make_unique<ArrowArray>();
+  exportToArrow(vector->valueVector(), *bridgeHolder.dictionary);
+  arrowArray.dictionary = bridgeHolder.dictionary.get();
+}
+
 // Returns the Arrow C data interface format type for a given Velox type.
 const char* exportArrowFormatStr(const TypePtr& type) {
   switch (type->kind()) {
@@ -184,6 +473,158 @@ const char* exportArrowFormatStr(const TypePtr& type) {
   }
 }
 
+// Returns true if 'vector' is an array or map vector whose elements are
+// exported without compaction.
+bool hasContiguousElements(const VectorPtr& vector) {
+  if (!vector) {
+    return false;
+  }
+  if (vector->encoding() == VectorEncoding::Simple::ARRAY) {
+    auto arrays = vector->as<ArrayVector>();
+    return hasContiguousRanges(
+        *arrays, arrays->rawOffsets(), arrays->rawSizes());
+  }
+  if (vector->encoding() == VectorEncoding::Simple::MAP) {
+    auto maps = vector->as<MapVector>();
+    return hasContiguousRanges(*maps, maps->rawOffsets(), maps->rawSizes());
+  }
+  return false;
+}
+
+void exportSchema(
+    const TypePtr& type,
+    const VectorPtr& vector,
+    ArrowSchema& arrowSchema);
+
+// Exports 'types' as the children of 'arrowSchema'. 'vectors' is empty or has
+// the vectors of the same children, which are exported along with their
+// types. If one of the children throws, the children that have already been
+// exported are released before re-throwing.
+void exportSchemaChildren(
+    VeloxToArrowSchemaBridgeHolder& bridgeHolder,
+    ArrowSchema& arrowSchema,
+    const std::vector<TypePtr>& types,
+    const std::vector<VectorPtr>& vectors,
+    const std::vector<const char*>& names) {
+  const size_t numChildren = types.size();
+  bridgeHolder.childrenRaw.resize(numChildren);
+  bridgeHolder.childrenOwned.resize(numChildren);
+  arrowSchema.children = bridgeHolder.childrenRaw.data();
+  arrowSchema.n_children = numChildren;
+
+  for (size_t i = 0; i < numChildren; ++i) {
+    // Recurse down the children. We use the same trick of temporarily holding
+    // the buffer in a unique_ptr so it doesn't leak if the recursion throws.
+    //
+    // But this is more nuanced: for types with a list of children (like
+    // row/structs), if one of the children throws, we need to make sure we
+    // call release() on the children that have already been created before we
+    // re-throw the exception back to the client, or memory will leak. This is
+    // needed because Arrow doesn't define what the client needs to do if the
+    // conversion fails, so we can't expect the client to call the release()
+    // method.
+    try {
+      auto& currentSchema = bridgeHolder.childrenOwned[i];
+      currentSchema = std::make_unique<ArrowSchema>();
+      exportSchema(
+          types[i], vectors.empty() ? nullptr : vectors[i], *currentSchema);
+      if (!names.empty()) {
+        currentSchema->name = names[i];
+      }
+      arrowSchema.children[i] = currentSchema.get();
+    } catch (const VeloxException& e) {
+      // Release any children that have already been built before re-throwing
+      // the exception back to the client.
+      for (size_t j = 0; j < i; ++j) {
+        arrowSchema.children[j]->release(arrowSchema.children[j]);
+      }
+      throw;
+    }
+  }
+}
+
+// Exports 'type' to 'arrowSchema'. If 'vector' is not null, the schema
+// describes the Arrow array 'vector' is exported to, i.e. dictionary encoded
+// vectors, at any level, get a dictionary schema.
+void exportSchema(
+    const TypePtr& type,
+    const VectorPtr& vector,
+    ArrowSchema& arrowSchema) {
+  arrowSchema.format = exportArrowFormatStr(type);
+  arrowSchema.name = nullptr;
+
+  // No additional metadata for now.
+  arrowSchema.metadata = nullptr;
+  arrowSchema.dictionary = nullptr;
+
+  // All supported types are semantically nullable.
+  arrowSchema.flags = ARROW_FLAG_NULLABLE;
+  arrowSchema.n_children = 0;
+  arrowSchema.children = nullptr;
+
+  // Allocate private data buffer holder and recurse down to children types.
+  auto bridgeHolder = std::make_unique<VeloxToArrowSchemaBridgeHolder>();
+
+  if (vector && vector->encoding() == VectorEncoding::Simple::DICTIONARY) {
+    // Dictionary indices are exported as int32.
+    arrowSchema.format = "i";
+    bridgeHolder->dictionary = std::make_unique<ArrowSchema>();
+    exportSchema(type, vector->valueVector(), *bridgeHolder->dictionary);
+    arrowSchema.dictionary = bridgeHolder->dictionary.get();
+  } else if (type->kind() == TypeKind::ROW) {
+    // Hold the shared_ptr so we can set the ArrowSchema.name pointer to its
+    // internal `name` string.
+    bridgeHolder->rowType = std::dynamic_pointer_cast<const RowType>(type);
+    std::vector<const char*> names;
+    for (const auto& name : bridgeHolder->rowType->names()) {
+      names.push_back(name.data());
+    }
+    exportSchemaChildren(
+        *bridgeHolder,
+        arrowSchema,
+        bridgeHolder->rowType->children(),
+        vector && vector->encoding() == VectorEncoding::Simple::ROW
+            ? vector->as<RowVector>()->children()
+            : std::vector<VectorPtr>{},
+        names);
+  } else if (type->kind() == TypeKind::ARRAY) {
+    // Non-contiguous elements are compacted into new flat vectors on export,
+    // so their encoding is not the one of 'vector'.
+    std::vector<VectorPtr> elements;
+    if (hasContiguousElements(vector)) {
+      elements.push_back(vector->as<ArrayVector>()->elements());
+    }
+    exportSchemaChildren(
+        *bridgeHolder, arrowSchema, {type->childAt(0)}, elements, {});
+  } else if (type->kind() == TypeKind::MAP) {
+    // Arrow maps have a single non-nullable struct child named 'entries' with
+    // the non-nullable 'key' and the 'value' children.
+    std::vector<VectorPtr> entries;
+    if (hasContiguousElements(vector)) {
+      auto maps = vector->as<MapVector>();
+      entries.push_back(std::make_shared<RowVector>(
+          vector->pool(),
+          ROW({"key", "value"}, {type->childAt(0), type->childAt(1)}),
+          nullptr,
+          maps->mapKeys()->size(),
+          std::vector<VectorPtr>{maps->mapKeys(), maps->mapValues()}));
+    }
+    exportSchemaChildren(
+        *bridgeHolder,
+        arrowSchema,
+        {ROW({"key", "value"}, {type->childAt(0), type->childAt(1)})},
+        entries,
+        {"entries"});
+    auto entriesSchema = arrowSchema.children[0];
+    entriesSchema->flags = 0;
+    entriesSchema->children[0]->flags = 0;
+  }
+
+  // Set release callback.
+  arrowSchema.release = bridgeSchemaRelease;
+  arrowSchema.private_data = bridgeHolder.release();
+}
+
 } // namespace
 
 void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray) {
@@ -196,36 +637,50 @@ void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray) {
   // alive, the last step in this function is to release this unique_ptr.
   auto bridgeHolder = std::make_unique<VeloxToArrowBridgeHolder>();
   bridgeHolder->vector = vector;
-  arrowArray.n_buffers = kMaxBuffers;
-  arrowArray.buffers = bridgeHolder->buffers;
-  arrowArray.release = bridgeRelease;
-  arrowArray.length = vector->size();
 
   // getNullCount() returns a std::optional. -1 means we don't have the count
-  // available yet (and we don't want to count it here).
-  arrowArray.null_count = vector->getNullCount().value_or(-1);
-
-  // Velox does not support offset'ed vectors yet.
-  arrowArray.offset = 0;
+  // available yet (and we don't want to count it here). Without a nulls
+  // buffer there are no nulls, and Arrow only allows a missing nulls buffer
+  // if the null count is zero.
+  initArrowArray(
+      arrowArray,
+      bridgeHolder,
+      vector->size(),
+      vector->rawNulls() ? vector->getNullCount().value_or(-1) : 0);
 
   // Setting up buffer pointers. First one is always nulls.
   arrowArray.buffers[0] = vector->rawNulls();
 
-  // Second buffer is values. Only support flat for now.
+  // Children and dictionaries are exported last, so that nothing but the
+  // bridge holder needs to be released if an export fails.
   switch (vector->encoding()) {
     case VectorEncoding::Simple::FLAT:
-      exportFlatVector(vector, arrowArray);
+      arrowArray.n_buffers = 2;
+      exportFlatVector(vector, arrowArray, *bridgeHolder);
       break;
 
-    default:
-      VELOX_NYI("Only FlatVectors can be exported to Arrow for now.");
+    case VectorEncoding::Simple::ROW:
+      exportChildren(
+          *bridgeHolder, arrowArray, vector->as<RowVector>()->children());
       break;
-  }
 
-  // TODO: No nested types, strings, or dictionaries for now.
-  arrowArray.n_children = 0;
-  arrowArray.children = nullptr;
-  arrowArray.dictionary = nullptr;
+    case VectorEncoding::Simple::ARRAY:
+      exportArrays(*vector->as<ArrayVector>(), arrowArray, *bridgeHolder);
+      break;
+
+    case VectorEncoding::Simple::MAP:
+      exportMaps(*vector->as<MapVector>(), arrowArray, *bridgeHolder);
+      break;
+
+    case VectorEncoding::Simple::DICTIONARY:
+      exportDictionary(vector, arrowArray, *bridgeHolder);
+      break;
+
+    default:
+      VELOX_NYI(
+          "Conversion of {} vectors to Arrow is not supported yet.",
+          vector->encoding());
+  }
 
   // We release the unique_ptr since bridgeHolder will now be carried inside
   // ArrowArray.
@@ -233,76 +688,23 @@ void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray) {
 }
 
 void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
-  arrowSchema.format = exportArrowFormatStr(type);
-  arrowSchema.name = nullptr;
-
-  // No additional metadata or support for dictionaries for now.
-  arrowSchema.metadata = nullptr;
-  arrowSchema.dictionary = nullptr;
-
-  // All supported types are semantically nullable.
-  arrowSchema.flags = ARROW_FLAG_NULLABLE;
-
-  // Allocate private data buffer holder and recurse down to children types.
-  auto bridgeHolder = std::make_unique<VeloxToArrowSchemaBridgeHolder>();
-  const size_t numChildren = type->size();
-
-  if (numChildren > 0) {
-    bridgeHolder->childrenRaw.resize(numChildren);
-    bridgeHolder->childrenOwned.resize(numChildren);
-
-    // If this is a RowType, hold the shared_ptr so we can set the
-    // ArrowSchema.name pointer to its internal `name` string.
-    if (type->kind() == TypeKind::ROW) {
-      bridgeHolder->rowType = std::dynamic_pointer_cast<const RowType>(type);
-    }
-
-    arrowSchema.children = bridgeHolder->childrenRaw.data();
-    arrowSchema.n_children = numChildren;
-
-    for (size_t i = 0; i < numChildren; ++i) {
-      // Recurse down the children. We use the same trick of temporarily holding
-      // the buffer in a unique_ptr so it doesn't leak if the recursion throws.
-      //
-      // But this is more nuanced: for types with a list of children (like
-      // row/structs), if one of the children throws, we need to make sure we
-      // call release() on the children that have already been created before we
-      // re-throw the exception back to the client, or memory will leak. This is
-      // needed because Arrow doesn't define what the client needs to do if the
-      // conversion fails, so we can't expect the client to call the release()
-      // method.
-      try {
-        auto& currentSchema = bridgeHolder->childrenOwned[i];
-        currentSchema = std::make_unique<ArrowSchema>();
-        exportToArrow(type->childAt(i), *currentSchema);
-
-        if (bridgeHolder->rowType) {
-          currentSchema->name = bridgeHolder->rowType->nameOf(i).data();
-        }
-        arrowSchema.children[i] = currentSchema.get();
-      } catch (const VeloxException& e) {
-        // Release any children that have already been built before re-throwing
-        // the exception back to the client.
-        for (size_t j = 0; j < i; ++j) {
-          arrowSchema.children[j]->release(arrowSchema.children[j]);
-        }
-        throw;
-      }
-    }
-  } else {
-    arrowSchema.n_children = 0;
-    arrowSchema.children = nullptr;
-  }
+  exportSchema(type, nullptr, arrowSchema);
+}
 
-  // Set release callback.
-  arrowSchema.release = bridgeSchemaRelease;
-  arrowSchema.private_data = bridgeHolder.release();
+void exportToArrow(const VectorPtr& vector, ArrowSchema& arrowSchema) {
+  exportSchema(vector->type(), vector, arrowSchema);
 }
 
 TypePtr importFromArrow(const ArrowSchema& arrowSchema) {
   const char* format = arrowSchema.format;
   VELOX_CHECK_NOT_NULL(format);
 
+  // The values of a dictionary encoded array are described by its
+  // dictionary, the format is the one of the indices.
+  if (arrowSchema.dictionary) {
+    return importFromArrow(*arrowSchema.dictionary);
+  }
+
   switch (format[0]) {
     case 'b':
       return BOOLEAN();
@@ -339,20 +741,35 @@ TypePtr importFromArrow(const ArrowSchema& arrowSchema) {
     // Complex types.
     case '+': {
       switch (format[1]) {
-        // Array/list.
+        // Array/list and large list.
+        case 'l':
         case 'L':
-          VELOX_CHECK_EQ(arrowSchema.n_children, 1);
+          VELOX_USER_CHECK_EQ(arrowSchema.n_children, 1);
           VELOX_CHECK_NOT_NULL(arrowSchema.children[0]);
           return ARRAY(importFromArrow(*arrowSchema.children[0]));
 
-        // Map.
-        case 'm':
-          VELOX_CHECK_EQ(arrowSchema.n_children, 2);
-          VELOX_CHECK_NOT_NULL(arrowSchema.children[0]);
-          VELOX_CHECK_NOT_NULL(arrowSchema.children[1]);
+        // Map. Arrow maps have a single struct child with the keys and
+        // values. Two children, keys and values, are also accepted, since
+        // that is what older versions of this bridge exported.
+        case 'm': {
+          VELOX_USER_CHECK(
+              arrowSchema.n_children == 1 || arrowSchema.n_children == 2,
+              "Arrow map schema needs to have one or two children.");
+          const ArrowSchema* parent = &arrowSchema;
+          if (arrowSchema.n_children == 1) {
+            VELOX_CHECK_NOT_NULL(arrowSchema.children[0]);
+            parent = arrowSchema.children[0];
+            VELOX_USER_CHECK_EQ(
+                parent->n_children,
+                2,
+                "Arrow map entries need to have a key and a value.");
+          }
+          VELOX_CHECK_NOT_NULL(parent->children[0]);
+          VELOX_CHECK_NOT_NULL(parent->children[1]);
           return MAP(
-              importFromArrow(*arrowSchema.children[0]),
-              importFromArrow(*arrowSchema.children[1]));
+              importFromArrow(*parent->children[0]),
+              importFromArrow(*parent->children[1]));
+        }
 
         // Struct/rows.
         case 's': {
@@ -386,23 +803,39 @@ TypePtr importFromArrow(const ArrowSchema& arrowSchema) {
 }
 
 namespace {
+// Releaser of the buffer views wrapping Arrow buffers. If 'arrowArray' is set,
+// the views keep the imported ArrowArray alive, otherwise the buffer lifetime
+// is fully controlled by the client of the API.
 struct BufferViewReleaser {
+  BufferViewReleaser() = default;
+
+  explicit BufferViewReleaser(std::shared_ptr<ArrowArray> arrowArray)
+      : arrowArray_(std::move(arrowArray)) {}
+
   void addRef() const {}
   void release() const {}
+
+ private:
+  const std::shared_ptr<ArrowArray> arrowArray_;
 };
 
-// Wraps a naked pointer using a Velox buffer view, without copying it. Adding a
-// dummy releaser as the buffer lifetime is fully controled by the client of the
-// API.
-BufferPtr wrapInBufferView(const void* buffer, size_t length) {
-  static const BufferViewReleaser kDummy;
+// Wraps a naked pointer using a Velox buffer view, without copying it.
+BufferPtr wrapInBufferView(
+    const void* buffer,
+    size_t length,
+    const BufferViewReleaser& releaser) {
   return BufferView<BufferViewReleaser>::create(
-      static_cast<const uint8_t*>(buffer), length, kDummy);
+      static_cast<const uint8_t*>(buffer), length, releaser);
+}
+
+std::optional<vector_size_t> optionalNullCount(int64_t nullCount) {
+  return nullCount == -1 ? std::nullopt
+                         : std::optional<vector_size_t>(nullCount);
 }
 
 // Dispatch based on the type.
 template <TypeKind kind>
-VectorPtr importFromArrowImpl(
+VectorPtr createFlatVector(
     memory::MemoryPool* pool,
     const TypePtr& type,
     BufferPtr nulls,
@@ -421,18 +854,172 @@ VectorPtr importFromArrowImpl(
       std::nullopt,
       nullCount == -1 ? std::nullopt : std::optional<int64_t>(nullCount));
 }
-} // namespace
 
-VectorPtr importFromArrow(
-    const ArrowSchema& arrowSchema,
+// Wraps the nulls buffer into a Velox BufferView (zero-copy). Null buffer size
+// needs to be at least one bit per element.
+BufferPtr importNulls(
     const ArrowArray& arrowArray,
-    memory::MemoryPool* pool) {
+    const BufferViewReleaser& releaser) {
+  // If either greater than zero or -1 (unknown).
+  if (arrowArray.null_count != 0) {
+    VELOX_USER_CHECK_NOT_NULL(
+        arrowArray.buffers[0],
+        "Nulls buffer can't be null unless null_count is zero.");
+    return wrapInBufferView(
+        arrowArray.buffers[0], bits::nbytes(arrowArray.length), releaser);
+  }
   VELOX_USER_CHECK_NULL(
-      arrowArray.dictionary,
-      "Dictionary encoded arrowArrays not supported yet.");
-  VELOX_USER_CHECK(
-      (arrowArray.n_children == 0) && (arrowArray.children == nullptr),
-      "Only flat buffers are supported for now.");
+      arrowArray.buffers[0],
+      "Nulls buffer must be nullptr when null_count is zero.");
+  return nullptr;
+}
+
+// Builds StringViews over the Arrow offsets and character data. The
+// character data is not copied, so strings longer than the StringView inline
+// size point into the Arrow buffer.
+template <typename TOffset>
+VectorPtr importStrings(
+    const TypePtr& type,
+    const ArrowArray& arrowArray,
+    BufferPtr nulls,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser) {
+  const auto length = arrowArray.length;
+  auto rawOffsets = static_cast<const TOffset*>(arrowArray.buffers[1]);
+  auto rawData = static_cast<const char*>(arrowArray.buffers[2]);
+  auto rawNulls = nulls ? nulls->as<uint64_t>() : nullptr;
+
+  auto values = AlignedBuffer::allocate<StringView>(length, pool);
+  auto rawValues = values->asMutable<StringView>();
+  for (auto i = 0; i < length; ++i) {
+    if (rawNulls && bits::isBitNull(rawNulls, i)) {
+      rawValues[i] = StringView();
+    } else {
+      rawValues[i] = StringView(
+          rawData + rawOffsets[i], rawOffsets[i + 1] - rawOffsets[i]);
+    }
+  }
+
+  std::vector<BufferPtr> stringBuffers;
+  if (length > 0 && rawData) {
+    stringBuffers.push_back(
+        wrapInBufferView(rawData, rawOffsets[length], releaser));
+  }
+  return std::make_shared<FlatVector<StringView>>(
+      pool,
+      type,
+      nulls,
+      length,
+      values,
+      std::move(stringBuffers),
+      cdvi::EMPTY_METADATA,
+      std::nullopt,
+      optionalNullCount(arrowArray.null_count));
+}
+
+// Converts the 'size + 1' Arrow offsets into Velox offsets and sizes. The
+// offsets are not copied if they are int32.
+template <typename TOffset>
+void importOffsets(
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser,
+    BufferPtr& offsets,
+    BufferPtr& sizes) {
+  const auto length = arrowArray.length;
+  auto rawArrowOffsets = static_cast<const TOffset*>(arrowArray.buffers[1]);
+  sizes = AlignedBuffer::allocate<vector_size_t>(length, pool);
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  vector_size_t* rawOffsets = nullptr;
+  if constexpr (std::is_same_v<TOffset, vector_size_t>) {
+    offsets = wrapInBufferView(
+        rawArrowOffsets, length * sizeof(vector_size_t), releaser);
+  } else {
+    offsets = AlignedBuffer::allocate<vector_size_t>(length, pool);
+    rawOffsets = offsets->asMutable<vector_size_t>();
+  }
+  for (auto i = 0; i < length; ++i) {
+    VELOX_USER_CHECK_LE(
+        rawArrowOffsets[i + 1],
+        std::numeric_limits<vector_size_t>::max(),
+        "Arrow offsets are too large to import.");
+    if (rawOffsets) {
+      rawOffsets[i] = rawArrowOffsets[i];
+    }
+    rawSizes[i] = rawArrowOffsets[i + 1] - rawArrowOffsets[i];
+  }
+}
+
+VectorPtr importFromArrowImpl(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser);
+
+// Imports the children of a struct array.
+std::vector<VectorPtr> importChildren(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser) {
+  VELOX_USER_CHECK_EQ(
+      arrowSchema.n_children,
+      arrowArray.n_children,
+      "ArrowSchema and ArrowArray need to have the same number of children.");
+  std::vector<VectorPtr> children;
+  children.reserve(arrowArray.n_children);
+  for (auto i = 0; i < arrowArray.n_children; ++i) {
+    VELOX_CHECK_NOT_NULL(arrowSchema.children[i]);
+    VELOX_CHECK_NOT_NULL(arrowArray.children[i]);
+    children.push_back(importFromArrowImpl(
+        *arrowSchema.children[i], *arrowArray.children[i], pool, releaser));
+  }
+  return children;
+}
+
+// Imports a dictionary encoded array. The Arrow indices are used as is,
+// unless there are nulls, for which the Arrow indices are undefined and
+// Velox requires them to be valid.
+VectorPtr importDictionary(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    BufferPtr nulls,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser) {
+  VELOX_CHECK_NOT_NULL(arrowSchema.dictionary);
+  VELOX_USER_CHECK_NOT_NULL(
+      arrowArray.dictionary, "ArrowArray needs to have a dictionary.");
+  VELOX_USER_CHECK_EQ(
+      std::string(arrowSchema.format),
+      "i",
+      "Only int32 dictionary indices are supported.");
+  VELOX_USER_CHECK_EQ(arrowArray.n_buffers, 2);
+
+  const auto length = arrowArray.length;
+  auto rawArrowIndices =
+      static_cast<const vector_size_t*>(arrowArray.buffers[1]);
+  BufferPtr indices;
+  if (nulls) {
+    indices = AlignedBuffer::allocate<vector_size_t>(length, pool);
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    auto rawNulls = nulls->as<uint64_t>();
+    for (auto i = 0; i < length; ++i) {
+      rawIndices[i] = bits::isBitNull(rawNulls, i) ? 0 : rawArrowIndices[i];
+    }
+  } else {
+    indices = wrapInBufferView(
+        rawArrowIndices, length * sizeof(vector_size_t), releaser);
+  }
+  auto dictionary = importFromArrowImpl(
+      *arrowSchema.dictionary, *arrowArray.dictionary, pool, releaser);
+  return BaseVector::wrapInDictionary(nulls, indices, length, dictionary);
+}
+
+VectorPtr importFromArrowImpl(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const BufferViewReleaser& releaser) {
   VELOX_USER_CHECK_EQ(
       arrowArray.offset,
       0,
@@ -441,38 +1028,107 @@ VectorPtr importFromArrow(
 
   // First parse and generate a Velox type.
   auto type = importFromArrow(arrowSchema);
-  VELOX_CHECK(
-      type->isPrimitiveType(),
-      "Only conversion of primitive types is supported for now.");
+  auto nulls = importNulls(arrowArray, releaser);
 
-  // Wrap the nulls buffer into a Velox BufferView (zero-copy). Null buffer size
-  // needs to be at least one bit per element.
-  BufferPtr nulls = nullptr;
+  if (arrowSchema.dictionary) {
+    return importDictionary(arrowSchema, arrowArray, nulls, pool, releaser);
+  }
+  VELOX_USER_CHECK_NULL(
+      arrowArray.dictionary,
+      "ArrowArray has a dictionary but ArrowSchema does not.");
 
-  // If either greater than zero or -1 (unknown).
-  if (arrowArray.null_count != 0) {
-    VELOX_USER_CHECK_NOT_NULL(
-        arrowArray.buffers[0],
-        "Nulls buffer can't be null unless null_count is zero.");
-    nulls = wrapInBufferView(
-        arrowArray.buffers[0], bits::nbytes(arrowArray.length));
-  } else {
-    VELOX_USER_CHECK_NULL(
-        arrowArray.buffers[0],
-        "Nulls buffer must be nullptr when null_count is zero.");
+  const char* format = arrowSchema.format;
+  switch (type->kind()) {
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      VELOX_USER_CHECK_EQ(
+          arrowArray.n_buffers,
+          3,
+          "Expecting three buffers as input for string types.");
+      if (format[0] == 'U' || format[0] == 'Z') {
+        return importStrings<int64_t>(type, arrowArray, nulls, pool, releaser);
+      }
+      return importStrings<int32_t>(type, arrowArray, nulls, pool, releaser);
+
+    case TypeKind::ARRAY:
+    case TypeKind::MAP: {
+      VELOX_USER_CHECK_EQ(arrowArray.n_buffers, 2);
+      VELOX_USER_CHECK_EQ(arrowArray.n_children, 1);
+      BufferPtr offsets;
+      BufferPtr sizes;
+      if (format[1] == 'L') {
+        importOffsets<int64_t>(arrowArray, pool, releaser, offsets, sizes);
+      } else {
+        importOffsets<int32_t>(arrowArray, pool, releaser, offsets, sizes);
+      }
+      if (type->kind() == TypeKind::ARRAY) {
+        return std::make_shared<ArrayVector>(
+            pool,
+            type,
+            nulls,
+            arrowArray.length,
+            offsets,
+            sizes,
+            importFromArrowImpl(
+                *arrowSchema.children[0],
+                *arrowArray.children[0],
+                pool,
+                releaser),
+            optionalNullCount(arrowArray.null_count));
+      }
+      VELOX_USER_CHECK_EQ(
+          arrowSchema.n_children,
+          1,
+          "Only Arrow maps with a struct of entries can be imported.");
+      auto entries = importChildren(
+          *arrowSchema.children[0], *arrowArray.children[0], pool, releaser);
+      VELOX_USER_CHECK_EQ(entries.size(), 2);
+      return std::make_shared<MapVector>(
+          pool,
+          type,
+          nulls,
+          arrowArray.length,
+          offsets,
+          sizes,
+          entries[0],
+          entries[1],
+          optionalNullCount(arrowArray.null_count));
+    }
+
+    case TypeKind::ROW:
+      VELOX_USER_CHECK_EQ(arrowArray.n_buffers, 1);
+      return std::make_shared<RowVector>(
+          pool,
+          type,
+          nulls,
+          arrowArray.length,
+          importChildren(arrowSchema, arrowArray, pool, releaser),
+          optionalNullCount(arrowArray.null_count));
+
+    default:
+      break;
   }
 
+  VELOX_USER_CHECK(
+      (arrowArray.n_children == 0) && (arrowArray.children == nullptr),
+      "Primitive types can't have children.");
+  VELOX_CHECK(
+      type->isPrimitiveType(),
+      "Conversion of {} is not supported yet.",
+      type->toString());
+
   // Wrap the values buffer into a Velox BufferView (also zero-copy).
   VELOX_USER_CHECK_EQ(
       arrowArray.n_buffers,
       2,
-      "Expecting two buffers as input "
-      "(only simple types supported for now).");
+      "Expecting two buffers as input for primitive types.");
   auto values = wrapInBufferView(
-      arrowArray.buffers[1], arrowArray.length * type->cppSizeInBytes());
+      arrowArray.buffers[1],
+      arrowArray.length * type->cppSizeInBytes(),
+      releaser);
 
   return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
-      importFromArrowImpl,
+      createFlatVector,
       type->kind(),
       pool,
       type,
@@ -481,5 +1137,41 @@ VectorPtr importFromArrow(
       values,
       arrowArray.null_count);
 }
+} // namespace
+
+VectorPtr importFromArrow(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool) {
+  return importFromArrowImpl(
+      arrowSchema, arrowArray, pool, BufferViewReleaser());
+}
+
+VectorPtr importFromArrowAsOwner(
+    ArrowSchema& arrowSchema,
+    ArrowArray& arrowArray,
+    memory::MemoryPool* pool) {
+  VELOX_USER_CHECK_NOT_NULL(
+      arrowArray.release, "ArrowArray has already been released.");
+
+  // Move the ArrowArray, as the Arrow C data interface allows, and release
+  // it when the last buffer view referencing it is destroyed.
+  auto owned = std::shared_ptr<ArrowArray>(
+      new ArrowArray(arrowArray), [](ArrowArray* array) {
+        if (array->release) {
+          array->release(array);
+        }
+        delete array;
+      });
+  arrowArray.release = nullptr;
+
+  SCOPE_EXIT {
+    if (arrowSchema.release) {
+      arrowSchema.release(&arrowSchema);
+    }
+  };
+  return importFromArrowImpl(
+      arrowSchema, *owned, pool, BufferViewReleaser(owned));
+}
 
 } // namespace facebook::velox
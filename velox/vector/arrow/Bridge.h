@@ -38,6 +38,14 @@ namespace facebook::velox {
 /// being referenced, so the consumer does not need to explicitly hold on to the
 /// input Vector shared_ptr.
 ///
+/// Flat vectors of fixed width types, row, array and map vectors are
+/// exported without copying any values. Strings are exported without copying
+/// if they are stored one after another in a single string buffer, and are
+/// copied into a new buffer otherwise. Arrays and maps whose elements are not
+/// stored in row order are compacted before export. Dictionary vectors are
+/// exported as Arrow dictionary arrays with int32 indices; their schema needs
+/// to be exported with the VectorPtr->ArrowSchema function below.
+///
 /// The function throws in case the conversion is not implemented yet.
 ///
 /// Example usage:
@@ -71,6 +79,12 @@ void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray);
 ///
 void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema);
 
+/// Export the type of a Velox Vector to an ArrowSchema describing the
+/// ArrowArray the vector is exported to. Unlike the function above, this
+/// describes dictionary encoded vectors, at any level of nesting, as Arrow
+/// dictionary arrays.
+void exportToArrow(const VectorPtr& vector, ArrowSchema& arrowSchema);
+
 /// Import an ArrowSchema into a Velox Type object.
 ///
 /// This function does the exact opposite of the function above. TypePtr carries
@@ -97,8 +111,9 @@ TypePtr importFromArrow(const ArrowSchema& arrowSchema);
 /// both (buffer and type). A memory pool is also required, since all vectors
 /// carry a pointer to it, but not really used in most cases - unless the
 /// conversion itself requires a new allocation. In most cases no new
-/// allocations are required, unless for arrays of varchars (or varbinaries) and
-/// complex types written out of order.
+/// allocations are required, unless for the StringViews of arrays of varchars
+/// (or varbinaries), the sizes of arrays and maps, and the indices of
+/// dictionaries with nulls.
 ///
 /// The new Velox vector returned contains only references to the underlying
 /// buffers, so it's the client's responsibility to ensure the buffer's
@@ -119,4 +134,23 @@ VectorPtr importFromArrow(
     const ArrowArray& arrowArray,
     memory::MemoryPool* pool);
 
+/// Same as above, but takes ownership of both structures instead of
+/// referencing buffers whose lifetime is managed by the client. The
+/// ArrowArray is moved, i.e. its release callback is set to null, and
+/// released once the returned vector and all vectors sharing its buffers are
+/// destroyed. The ArrowSchema is released before returning.
+///
+/// Example usage:
+///
+///   ArrowSchema arrowSchema;
+///   ArrowArray arrowArray;
+///   ... // fills structures
+///   auto vector = importFromArrowAsOwner(arrowSchema, arrowArray, pool);
+///   ... // arrowArray and arrowSchema no longer need to be released.
+///
+VectorPtr importFromArrowAsOwner(
+    ArrowSchema& arrowSchema,
+    ArrowArray& arrowArray,
+    memory::MemoryPool* pool);
+
 } // namespace facebook::velox
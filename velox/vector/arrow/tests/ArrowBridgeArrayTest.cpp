@@ -72,6 +72,35 @@ class ArrowBridgeArrayExportTest : public testing::Test {
     EXPECT_EQ(nullptr, arrowArray.private_data);
   }
 
+  void verifyStrings(
+      const ArrowArray& arrowArray,
+      const std::vector<std::optional<std::string>>& expected) {
+    ASSERT_EQ(3, arrowArray.n_buffers);
+    auto nulls = static_cast<const uint64_t*>(arrowArray.buffers[0]);
+    auto offsets = static_cast<const int32_t*>(arrowArray.buffers[1]);
+    auto data = static_cast<const char*>(arrowArray.buffers[2]);
+    for (auto i = 0; i < expected.size(); ++i) {
+      if (!expected[i].has_value()) {
+        EXPECT_TRUE(bits::isBitNull(nulls, i));
+        EXPECT_EQ(offsets[i], offsets[i + 1]);
+        continue;
+      }
+      EXPECT_TRUE(!nulls || !bits::isBitNull(nulls, i));
+      EXPECT_EQ(
+          expected[i].value(),
+          std::string(data + offsets[i], offsets[i + 1] - offsets[i]));
+    }
+  }
+
+  template <typename TOffset>
+  void verifyOffsets(
+      const ArrowArray& arrowArray,
+      const std::vector<TOffset>& expected) {
+    auto offsets = static_cast<const TOffset*>(arrowArray.buffers[1]);
+    EXPECT_EQ(
+        expected, std::vector<TOffset>(offsets, offsets + expected.size()));
+  }
+
   ArrowSchema makeArrowSchema(const char* format) {
     return ArrowSchema{
         .format = format,
@@ -208,40 +237,213 @@ TEST_F(ArrowBridgeArrayExportTest, flatDouble) {
   });
 }
 
-TEST_F(ArrowBridgeArrayExportTest, unsupported) {
+TEST_F(ArrowBridgeArrayExportTest, flatString) {
+  // Short strings are inlined and strings made by VectorMaker point to the
+  // input, so the strings are copied into a single buffer.
+  std::vector<std::optional<std::string>> inputData = {
+      "a", std::nullopt, "", "a string that is not inlined", "abc"};
+  auto vector = vectorMaker_.flatVectorNullable(inputData);
   ArrowArray arrowArray;
-  VectorPtr vector;
+  exportToArrow(vector, arrowArray);
 
-  // Strings.
-  vector = vectorMaker_.flatVectorNullable<std::string>({});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+  EXPECT_EQ(inputData.size(), arrowArray.length);
+  EXPECT_EQ(1, arrowArray.null_count);
+  EXPECT_EQ(3, arrowArray.n_buffers);
+  EXPECT_EQ(0, arrowArray.n_children);
+  EXPECT_EQ(vector->rawNulls(), arrowArray.buffers[0]);
+  verifyStrings(arrowArray, inputData);
 
-  // Timestamps.
-  vector = vectorMaker_.flatVectorNullable<Timestamp>({});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+  EXPECT_EQ(nullptr, arrowArray.private_data);
 
-  // Arrays.
-  vector = vectorMaker_.arrayVector<int64_t>({{1, 2, 3}, {4, 5}});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+  // Binary.
+  vector = vectorMaker_.flatVectorNullable(inputData, VARBINARY());
+  exportToArrow(vector, arrowArray);
+  verifyStrings(arrowArray, inputData);
+  arrowArray.release(&arrowArray);
+}
 
-  // Maps.
-  auto lambda = [](vector_size_t /* row */) { return 1; };
-  vector = vectorMaker_.mapVector<int64_t, int64_t>(2, lambda, lambda, lambda);
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+TEST_F(ArrowBridgeArrayExportTest, flatStringContiguous) {
+  // Strings longer than the inline size are appended to a single string
+  // buffer, which is exported without copying.
+  std::vector<std::optional<std::string>> inputData = {
+      "the first string of this vector",
+      std::nullopt,
+      "the second string of this vector",
+      "the last string of this vector"};
+  auto vector = std::dynamic_pointer_cast<FlatVector<StringView>>(
+      BaseVector::create(VARCHAR(), inputData.size(), pool_.get()));
+  for (auto i = 0; i < inputData.size(); ++i) {
+    if (inputData[i].has_value()) {
+      vector->set(i, StringView(inputData[i].value()));
+    } else {
+      vector->setNull(i, true);
+    }
+  }
+  ASSERT_EQ(1, vector->stringBuffers().size());
 
-  // Row vectors.
-  vector =
-      vectorMaker_.rowVector({vectorMaker_.flatVector<int64_t>({1, 2, 3})});
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+  EXPECT_EQ(vector->stringBuffers()[0]->as<char>(), arrowArray.buffers[2]);
+  verifyStrings(arrowArray, inputData);
+  arrowArray.release(&arrowArray);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, array) {
+  auto vector = vectorMaker_.arrayVector<int64_t>({{1, 2, 3}, {}, {4, 5}});
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+
+  EXPECT_EQ(3, arrowArray.length);
+  EXPECT_EQ(2, arrowArray.n_buffers);
+  ASSERT_EQ(1, arrowArray.n_children);
+  verifyOffsets<int64_t>(arrowArray, {0, 3, 3, 5});
+
+  // Elements are in row order, so they are exported as is.
+  auto& elements = *arrowArray.children[0];
+  EXPECT_EQ(5, elements.length);
+  EXPECT_EQ(vector->elements()->valuesAsVoid(), elements.buffers[1]);
+
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+  EXPECT_EQ(nullptr, elements.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, arrayOutOfOrder) {
+  // The second array comes first in the elements, so the elements are
+  // compacted in row order. The null array is empty.
+  auto offsets = AlignedBuffer::allocate<vector_size_t>(3, pool_.get());
+  auto sizes = AlignedBuffer::allocate<vector_size_t>(3, pool_.get());
+  auto rawOffsets = offsets->asMutable<vector_size_t>();
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  rawOffsets[0] = 3;
+  rawSizes[0] = 2;
+  rawOffsets[1] = 0;
+  rawSizes[1] = 2;
+  rawOffsets[2] = 0;
+  rawSizes[2] = 3;
+  auto nulls = AlignedBuffer::allocate<bool>(3, pool_.get(), bits::kNotNull);
+  bits::setNull(nulls->asMutable<uint64_t>(), 1);
+  auto vector = std::make_shared<ArrayVector>(
+      pool_.get(),
+      ARRAY(BIGINT()),
+      nulls,
+      3,
+      offsets,
+      sizes,
+      vectorMaker_.flatVector<int64_t>({1, 2, 3, 4, 5}));
+
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+  verifyOffsets<int64_t>(arrowArray, {0, 2, 2, 5});
+
+  auto& elements = *arrowArray.children[0];
+  EXPECT_EQ(5, elements.length);
+  auto values = static_cast<const int64_t*>(elements.buffers[1]);
+  EXPECT_EQ(
+      std::vector<int64_t>({4, 5, 1, 2, 3}),
+      std::vector<int64_t>(values, values + 5));
+  arrowArray.release(&arrowArray);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, map) {
+  auto vector = vectorMaker_.mapVector<int64_t, double>(
+      4,
+      [](auto row) { return row; },
+      [](auto idx) { return idx; },
+      [](auto idx) { return idx * 0.5; },
+      test::VectorMaker::nullEvery(3));
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+
+  EXPECT_EQ(4, arrowArray.length);
+  EXPECT_EQ(2, arrowArray.n_buffers);
+  verifyOffsets<int32_t>(arrowArray, {0, 0, 1, 3, 3});
+
+  // A single non-null struct child with the keys and values.
+  ASSERT_EQ(1, arrowArray.n_children);
+  auto& entries = *arrowArray.children[0];
+  EXPECT_EQ(3, entries.length);
+  EXPECT_EQ(0, entries.null_count);
+  EXPECT_EQ(nullptr, entries.buffers[0]);
+  ASSERT_EQ(2, entries.n_children);
+  EXPECT_EQ(vector->mapKeys()->valuesAsVoid(), entries.children[0]->buffers[1]);
+  EXPECT_EQ(
+      vector->mapValues()->valuesAsVoid(), entries.children[1]->buffers[1]);
+
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+  EXPECT_EQ(nullptr, entries.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, row) {
+  auto vector = vectorMaker_.rowVector(
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_.flatVectorNullable<std::string>(
+           {"a", std::nullopt, "c"})});
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+
+  EXPECT_EQ(3, arrowArray.length);
+  EXPECT_EQ(1, arrowArray.n_buffers);
+  ASSERT_EQ(2, arrowArray.n_children);
+  EXPECT_EQ(
+      vector->childAt(0)->valuesAsVoid(), arrowArray.children[0]->buffers[1]);
+  verifyStrings(*arrowArray.children[1], {"a", std::nullopt, "c"});
+
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, dictionary) {
+  auto indices = AlignedBuffer::allocate<vector_size_t>(4, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  rawIndices[0] = 2;
+  rawIndices[1] = 0;
+  rawIndices[2] = 2;
+  rawIndices[3] = 1;
+  auto base = vectorMaker_.flatVector<int64_t>({10, 20, 30});
+  auto vector = BaseVector::wrapInDictionary(BufferPtr(), indices, 4, base);
+
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+  EXPECT_EQ(4, arrowArray.length);
+  EXPECT_EQ(2, arrowArray.n_buffers);
+  EXPECT_EQ(rawIndices, arrowArray.buffers[1]);
+  ASSERT_NE(nullptr, arrowArray.dictionary);
+  EXPECT_EQ(3, arrowArray.dictionary->length);
+  EXPECT_EQ(base->valuesAsVoid(), arrowArray.dictionary->buffers[1]);
+
+  ArrowSchema arrowSchema;
+  exportToArrow(vector, arrowSchema);
+  EXPECT_EQ(std::string("i"), std::string(arrowSchema.format));
+  ASSERT_NE(nullptr, arrowSchema.dictionary);
+  EXPECT_EQ(std::string("l"), std::string(arrowSchema.dictionary->format));
+
+  auto dictionary = arrowArray.dictionary;
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, dictionary->release);
+  arrowSchema.release(&arrowSchema);
+  EXPECT_EQ(nullptr, arrowSchema.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, unsupported) {
+  ArrowArray arrowArray;
+  VectorPtr vector;
+
+  // Timestamps.
+  vector = vectorMaker_.flatVectorNullable<Timestamp>({});
   EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
 
   // Constant encoding.
   vector = BaseVector::createConstant(variant(10), 10, pool_.get());
   EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
 
-  // Dictionary encoding.
-  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(3, pool_.get());
-  vector = BaseVector::wrapInDictionary(
-      BufferPtr(), indices, 3, vectorMaker_.flatVector<int64_t>({1, 2, 3}));
+  // Unsupported children are not leaked.
+  vector = vectorMaker_.rowVector(
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       BaseVector::createConstant(variant(10), 3, pool_.get())});
   EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
 }
 
@@ -313,6 +515,61 @@ class ArrowBridgeArrayImportTest : public ArrowBridgeArrayExportTest {
     }
   }
 
+  // Same as above, for strings with offsets of type TOffset.
+  template <typename TOffset>
+  void testArrowImportStrings(
+      const char* format,
+      const std::vector<std::optional<std::string>>& inputValues) {
+    int64_t length = inputValues.size();
+    int64_t nullCount = 0;
+
+    BufferPtr nulls = AlignedBuffer::allocate<uint64_t>(length, pool_.get());
+    auto rawNulls = nulls->asMutable<uint64_t>();
+    std::vector<TOffset> offsets = {0};
+    std::string data;
+    for (size_t i = 0; i < length; ++i) {
+      if (inputValues[i] == std::nullopt) {
+        bits::setNull(rawNulls, i);
+        nullCount++;
+      } else {
+        bits::clearNull(rawNulls, i);
+        data += inputValues[i].value();
+      }
+      offsets.push_back(data.size());
+    }
+
+    const void* buffers[3];
+    buffers[0] = (nullCount == 0) ? nullptr : (const void*)rawNulls;
+    buffers[1] = offsets.data();
+    buffers[2] = data.data();
+
+    ArrowArray arrowArray{
+        .length = length,
+        .null_count = nullCount,
+        .offset = 0,
+        .n_buffers = 3,
+        .n_children = 0,
+        .buffers = buffers,
+        .children = nullptr,
+        .dictionary = nullptr,
+        .release = nullptr,
+        .private_data = nullptr,
+    };
+    auto arrowSchema = makeArrowSchema(format);
+    auto output = importFromArrow(arrowSchema, arrowArray, pool_.get());
+
+    EXPECT_EQ(nullCount, *output->getNullCount());
+    EXPECT_EQ(inputValues.size(), output->size());
+
+    auto expected =
+        vectorMaker_.flatVectorNullable(inputValues, output->type());
+    for (vector_size_t i = 0; i < length; ++i) {
+      ASSERT_TRUE(expected->equalValueAt(output.get(), i, i))
+          << "at " << i << ": " << expected->toString(i) << " vs. "
+          << output->toString(i);
+    }
+  }
+
   std::unique_ptr<memory::ScopedMemoryPool> pool_{
       memory::getDefaultScopedMemoryPool()};
 };
@@ -344,13 +601,16 @@ TEST_F(ArrowBridgeArrayImportTest, scalar) {
   testArrowImport<double>("g", {-99.9, 4.3, 31.1, 129.11, -12});
   testArrowImport<float>("f", {-99.9, 4.3, 31.1, 129.11, -12});
 
-  // VARCHAR and VARBINARY not supported for now.
-  EXPECT_THROW(
-      testArrowImport<std::string>("u", {"hello world"}),
-      std::invalid_argument);
-  EXPECT_THROW(
-      testArrowImport<std::string>("z", {"hello world"}),
-      std::invalid_argument);
+}
+
+TEST_F(ArrowBridgeArrayImportTest, string) {
+  testArrowImportStrings<int32_t>("u", {});
+  testArrowImportStrings<int32_t>("u", {"hello world"});
+  testArrowImportStrings<int32_t>(
+      "u", {"a", std::nullopt, "", "a string that is not inlined"});
+  testArrowImportStrings<int64_t>("U", {std::nullopt, "b", "large utf-8"});
+  testArrowImportStrings<int32_t>("z", {"binary", std::nullopt});
+  testArrowImportStrings<int64_t>("Z", {"binary", std::nullopt, "data"});
 }
 
 TEST_F(ArrowBridgeArrayImportTest, failures) {
@@ -376,7 +636,7 @@ TEST_F(ArrowBridgeArrayImportTest, failures) {
 
   // Unsupported:
 
-  // Children not yet supported.
+  // Primitive types can't have children.
   arrowArray.n_children = 1;
   EXPECT_THROW(
       importFromArrow(arrowSchema, arrowArray, pool_.get()), VeloxUserError);
@@ -411,4 +671,110 @@ TEST_F(ArrowBridgeArrayImportTest, failures) {
   EXPECT_NO_THROW(importFromArrow(arrowSchema, arrowArray, pool_.get()));
 }
 
+class ArrowBridgeArrayRoundtripTest : public ArrowBridgeArrayImportTest {
+ protected:
+  // Exports 'vector' and its schema, imports them back and checks the result
+  // has the same values.
+  void testRoundtrip(const VectorPtr& vector) {
+    ArrowArray arrowArray;
+    ArrowSchema arrowSchema;
+    exportToArrow(vector, arrowArray);
+    exportToArrow(vector, arrowSchema);
+
+    auto output = importFromArrow(arrowSchema, arrowArray, pool_.get());
+    assertEqualVectors(vector, output);
+
+    // The output references the buffers of the ArrowArray.
+    output.reset();
+    arrowArray.release(&arrowArray);
+    arrowSchema.release(&arrowSchema);
+  }
+
+  void assertEqualVectors(const VectorPtr& expected, const VectorPtr& actual) {
+    ASSERT_EQ(expected->size(), actual->size());
+    ASSERT_EQ(*expected->type(), *actual->type());
+    for (vector_size_t i = 0; i < expected->size(); ++i) {
+      ASSERT_TRUE(expected->equalValueAt(actual.get(), i, i))
+          << "at " << i << ": " << expected->toString(i) << " vs. "
+          << actual->toString(i);
+    }
+  }
+};
+
+TEST_F(ArrowBridgeArrayRoundtripTest, flat) {
+  testRoundtrip(vectorMaker_.flatVectorNullable<int32_t>(
+      {1, std::nullopt, 3, -4, std::nullopt}));
+  testRoundtrip(vectorMaker_.flatVectorNullable<std::string>(
+      {"a", std::nullopt, "", "a string that is not inlined"}));
+}
+
+TEST_F(ArrowBridgeArrayRoundtripTest, complex) {
+  testRoundtrip(vectorMaker_.arrayVector<int64_t>(
+      10,
+      [](auto row) { return row % 4; },
+      [](auto idx) { return idx; },
+      test::VectorMaker::nullEvery(3)));
+  testRoundtrip(vectorMaker_.arrayVector<std::string>(
+      {{"a", "b"}, {}, {"c", "a string that is not inlined"}}));
+  testRoundtrip(vectorMaker_.mapVector<int32_t, double>(
+      10,
+      [](auto row) { return row % 3; },
+      [](auto idx) { return idx; },
+      [](auto idx) { return idx * 1.5; },
+      test::VectorMaker::nullEvery(4)));
+  testRoundtrip(vectorMaker_.rowVector(
+      {vectorMaker_.flatVectorNullable<int64_t>({1, std::nullopt, 3}),
+       vectorMaker_.arrayVector<double>({{1.0}, {2.0, 3.0}, {}}),
+       vectorMaker_.rowVector(
+           {vectorMaker_.flatVectorNullable<std::string>(
+               {"x", "y", std::nullopt})})}));
+}
+
+TEST_F(ArrowBridgeArrayRoundtripTest, dictionary) {
+  auto indices = AlignedBuffer::allocate<vector_size_t>(5, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < 5; ++i) {
+    rawIndices[i] = (i * 2) % 3;
+  }
+  auto base = vectorMaker_.flatVectorNullable<std::string>(
+      {"a", std::nullopt, "a string that is not inlined"});
+  testRoundtrip(BaseVector::wrapInDictionary(BufferPtr(), indices, 5, base));
+
+  // With nulls added by the dictionary and inside an array.
+  auto nulls = AlignedBuffer::allocate<bool>(5, pool_.get(), bits::kNotNull);
+  bits::setNull(nulls->asMutable<uint64_t>(), 3);
+  auto dictionary = BaseVector::wrapInDictionary(nulls, indices, 5, base);
+  testRoundtrip(dictionary);
+
+  auto offsets = AlignedBuffer::allocate<vector_size_t>(2, pool_.get());
+  auto sizes = AlignedBuffer::allocate<vector_size_t>(2, pool_.get());
+  offsets->asMutable<vector_size_t>()[0] = 0;
+  sizes->asMutable<vector_size_t>()[0] = 2;
+  offsets->asMutable<vector_size_t>()[1] = 2;
+  sizes->asMutable<vector_size_t>()[1] = 3;
+  testRoundtrip(std::make_shared<ArrayVector>(
+      pool_.get(), ARRAY(VARCHAR()), nullptr, 2, offsets, sizes, dictionary));
+}
+
+TEST_F(ArrowBridgeArrayRoundtripTest, importAsOwner) {
+  auto vector = vectorMaker_.rowVector(
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_.flatVectorNullable<std::string>(
+           {"a string that is not inlined", std::nullopt, "c"})});
+  ArrowArray arrowArray;
+  ArrowSchema arrowSchema;
+  exportToArrow(vector, arrowArray);
+  exportToArrow(vector, arrowSchema);
+
+  auto output = importFromArrowAsOwner(arrowSchema, arrowArray, pool_.get());
+  EXPECT_EQ(nullptr, arrowArray.release);
+  EXPECT_EQ(nullptr, arrowSchema.release);
+
+  // The imported children keep the exported buffers alive after the
+  // imported row vector is destroyed.
+  auto child = output->as<RowVector>()->childAt(1);
+  output.reset();
+  assertEqualVectors(vector->childAt(1), child);
+}
+
 } // namespace
@@ -60,8 +60,18 @@ class ArrowBridgeSchemaExportTest : public testing::Test {
       EXPECT_EQ(std::string{"+L"}, std::string{schema.format});
       EXPECT_EQ(1, schema.n_children);
     } else if (type->kind() == TypeKind::MAP) {
+      // Maps have a single struct child with the keys and values.
       EXPECT_EQ(std::string{"+m"}, std::string{schema.format});
-      EXPECT_EQ(2, schema.n_children);
+      ASSERT_EQ(1, schema.n_children);
+      auto& entries = *schema.children[0];
+      EXPECT_EQ(std::string{"+s"}, std::string{entries.format});
+      EXPECT_EQ(std::string{"entries"}, std::string{entries.name});
+      ASSERT_EQ(2, entries.n_children);
+      EXPECT_EQ(std::string{"key"}, std::string{entries.children[0]->name});
+      EXPECT_EQ(0, entries.children[0]->flags);
+      verifyNestedType(type->childAt(0), *entries.children[0]);
+      verifyNestedType(type->childAt(1), *entries.children[1]);
+      return;
     } else if (type->kind() == TypeKind::ROW) {
       // Structs can have zero of more children.
       EXPECT_EQ(std::string{"+s"}, std::string{schema.format});
@@ -230,6 +240,22 @@ TEST_F(ArrowBridgeSchemaImportTest, complexTypes) {
   EXPECT_EQ(
       *MAP(SMALLINT(), REAL()), *testSchemaImportComplex("+m", {"s", "f"}));
 
+  // Map with the struct of entries the Arrow specification requires.
+  auto keySchema = makeArrowSchema("u");
+  auto valueSchema = makeArrowSchema("l");
+  std::vector<ArrowSchema*> entryPtrs = {&keySchema, &valueSchema};
+  auto entriesSchema = makeArrowSchema("+s");
+  entriesSchema.n_children = 2;
+  entriesSchema.children = entryPtrs.data();
+  ArrowSchema* entriesPtr = &entriesSchema;
+  auto mapSchema = makeArrowSchema("+m");
+  mapSchema.n_children = 1;
+  mapSchema.children = &entriesPtr;
+  EXPECT_EQ(*MAP(VARCHAR(), BIGINT()), *importFromArrow(mapSchema));
+
+  // Regular list.
+  EXPECT_EQ(*ARRAY(INTEGER()), *testSchemaImportComplex("+l", {"i"}));
+
   // Row/struct.
   EXPECT_EQ(
       *ROW({SMALLINT(), REAL()}), *testSchemaImportComplex("+s", {"s", "f"}));
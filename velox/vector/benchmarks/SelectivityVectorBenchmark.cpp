@@ -300,6 +300,56 @@ BENCHMARK_PARAM(BM_operatorEquals, 1000000);
 BENCHMARK_PARAM(BM_operatorEquals, 10000000);
 BENCHMARK_DRAW_LINE();
 
+// applyToSelected Tests
+
+// Sums 'numEntries' values over a selection that is all rows, a contiguous
+// range that starts past row 0, or every other row.
+void applyToSelectedTest(
+    uint32_t iterations,
+    size_t numEntries,
+    const std::function<void(SelectivityVector&)>& select) {
+  folly::BenchmarkSuspender suspender;
+  SelectivityVector vector(numEntries);
+  select(vector);
+  vector.updateBounds();
+  std::vector<int64_t> values(numEntries, 1);
+  int64_t sum = 0;
+  suspender.dismiss();
+
+  for (uint32_t i = 0; i < iterations; ++i) {
+    vector.applyToSelected([&](auto row) { sum += values[row]; });
+  }
+
+  folly::doNotOptimizeAway(sum);
+  suspender.rehire();
+}
+
+void BM_applyToSelectedAll(uint32_t iterations, size_t numEntries) {
+  applyToSelectedTest(iterations, numEntries, [](auto& /*vector*/) {});
+}
+
+void BM_applyToSelectedRange(uint32_t iterations, size_t numEntries) {
+  applyToSelectedTest(iterations, numEntries, [&](auto& vector) {
+    vector.setValidRange(0, numEntries / 10, false);
+  });
+}
+
+void BM_applyToSelectedSparse(uint32_t iterations, size_t numEntries) {
+  applyToSelectedTest(iterations, numEntries, [&](auto& vector) {
+    for (size_t i = 0; i < numEntries; i += 2) {
+      vector.setValid(i, false);
+    }
+  });
+}
+
+BENCHMARK_PARAM(BM_applyToSelectedAll, 1000);
+BENCHMARK_PARAM(BM_applyToSelectedAll, 1000000);
+BENCHMARK_PARAM(BM_applyToSelectedRange, 1000);
+BENCHMARK_PARAM(BM_applyToSelectedRange, 1000000);
+BENCHMARK_PARAM(BM_applyToSelectedSparse, 1000);
+BENCHMARK_PARAM(BM_applyToSelectedSparse, 1000000);
+BENCHMARK_DRAW_LINE();
+
 } // namespace test
 } // namespace velox
 } // namespace facebook
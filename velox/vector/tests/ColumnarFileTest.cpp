@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <fstream>
+
+#include "velox/vector/ColumnarFile.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class ColumnarFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = memory::getDefaultScopedMemoryPool();
+    vectorMaker_ = std::make_unique<test::VectorMaker>(pool_.get());
+    char path[] = "/tmp/ColumnarFileTestXXXXXX";
+    auto fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    path_ = path;
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+  }
+
+  // Writes 'batches' to a file and reads them back from a mapping of the
+  // file.
+  std::vector<RowVectorPtr> roundTrip(
+      const std::vector<RowVectorPtr>& batches) {
+    std::string data;
+    for (auto& batch : batches) {
+      ColumnarFile::append(*batch, data);
+      EXPECT_EQ(0, data.size() % sizeof(uint64_t));
+    }
+    std::ofstream(path_, std::ios::binary).write(data.data(), data.size());
+
+    auto file = std::make_shared<MappedFile>(path_);
+    EXPECT_EQ(data.size(), file->size());
+    std::vector<RowVectorPtr> result;
+    uint64_t offset = 0;
+    auto type = std::dynamic_pointer_cast<const RowType>(batches[0]->type());
+    while (offset < file->size()) {
+      result.push_back(ColumnarFile::read(file, offset, type, pool_.get()));
+    }
+    return result;
+  }
+
+  void assertEqualRows(
+      const RowVectorPtr& expected,
+      const RowVectorPtr& actual) {
+    ASSERT_EQ(expected->size(), actual->size());
+    ASSERT_EQ(expected->childrenSize(), actual->childrenSize());
+    for (auto column = 0; column < expected->childrenSize(); ++column) {
+      for (auto row = 0; row < expected->size(); ++row) {
+        ASSERT_TRUE(expected->childAt(column)->equalValueAt(
+            actual->childAt(column).get(), row, row))
+            << "at column " << column << ", row " << row << ": "
+            << expected->childAt(column)->toString(row) << " vs "
+            << actual->childAt(column)->toString(row);
+      }
+    }
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::unique_ptr<test::VectorMaker> vectorMaker_;
+  std::string path_;
+};
+
+TEST_F(ColumnarFileTest, roundTrip) {
+  const vector_size_t size = 1'000;
+  const std::string longString = "a string that is not inlined";
+  auto makeBatch = [&](int32_t seed) {
+    BufferPtr indices =
+        AlignedBuffer::allocate<vector_size_t>(size, pool_.get());
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    for (auto i = 0; i < size; ++i) {
+      rawIndices[i] = size - 1 - i;
+    }
+    return vectorMaker_->rowVector({
+        vectorMaker_->flatVector<int64_t>(
+            size,
+            [&](auto row) { return row * seed; },
+            test::VectorMaker::nullEvery(7)),
+        vectorMaker_->flatVector<StringView>(
+            size,
+            [&](auto row) {
+              return row % 3
+                  ? StringView(longString.data(), row % longString.size())
+                  : StringView("short");
+            },
+            test::VectorMaker::nullEvery(11)),
+        vectorMaker_->flatVector<bool>(
+            size, [](auto row) { return row % 5 == 0; }),
+        BaseVector::createConstant(variant(seed), size, pool_.get()),
+        BaseVector::createNullConstant(DOUBLE(), size, pool_.get()),
+        BaseVector::wrapInDictionary(
+            nullptr,
+            indices,
+            size,
+            vectorMaker_->flatVector<double>(
+                size, [](auto row) { return row * 0.5; })),
+        vectorMaker_->arrayVector<int32_t>(
+            size,
+            [](auto row) { return row % 4; },
+            [](auto index) { return index; },
+            test::VectorMaker::nullEvery(9)),
+        vectorMaker_->mapVector<int32_t, double>(
+            size,
+            [](auto row) { return row % 3; },
+            [](auto index) { return index; },
+            [](auto index) { return index * 1.5; },
+            test::VectorMaker::nullEvery(13),
+            test::VectorMaker::nullEvery(5)),
+        vectorMaker_->rowVector({
+            vectorMaker_->flatVector<int16_t>(
+                size, [](auto row) { return row % 100; }),
+            vectorMaker_->flatVector<Timestamp>(
+                size,
+                [](auto row) { return Timestamp(row, row * 1'000); },
+                test::VectorMaker::nullEvery(3)),
+        }),
+    });
+  };
+  std::vector<RowVectorPtr> batches = {makeBatch(1), makeBatch(2)};
+  auto result = roundTrip(batches);
+  ASSERT_EQ(2, result.size());
+  for (auto i = 0; i < batches.size(); ++i) {
+    assertEqualRows(batches[i], result[i]);
+
+    // Constant and all null columns are stored as one value.
+    ASSERT_TRUE(result[i]->childAt(3)->isConstantEncoding());
+    ASSERT_TRUE(result[i]->childAt(4)->isConstantEncoding());
+
+    // Flat values are wrapped without copying.
+    ASSERT_TRUE(result[i]->childAt(0)->values()->isView());
+    auto strings = result[i]->childAt(1)->asFlatVector<StringView>();
+    ASSERT_TRUE(strings->values()->isView());
+    ASSERT_EQ(1, strings->stringBuffers().size());
+    ASSERT_TRUE(strings->stringBuffers()[0]->isView());
+  }
+}
+
+TEST_F(ColumnarFileTest, slicesOfArrays) {
+  // Arrays whose elements are not contiguous are compacted on write.
+  const vector_size_t size = 100;
+  auto arrays = vectorMaker_->arrayVector<int64_t>(
+      size, [](auto row) { return row % 5; }, [](auto index) { return index; });
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(10, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < 10; ++i) {
+    rawIndices[i] = i * 9;
+  }
+  auto batch = vectorMaker_->rowVector(
+      {BaseVector::wrapInDictionary(nullptr, indices, 10, arrays)});
+  auto result = roundTrip({batch});
+  ASSERT_EQ(1, result.size());
+  assertEqualRows(batch, result[0]);
+  auto elements = result[0]->childAt(0)->as<ArrayVector>()->elements();
+  ASSERT_EQ(20, elements->size());
+}
+
+TEST_F(ColumnarFileTest, emptyBatch) {
+  auto batch = vectorMaker_->rowVector(
+      {vectorMaker_->flatVector<int32_t>(std::vector<int32_t>{}),
+       vectorMaker_->flatVector<StringView>(std::vector<StringView>{})});
+  auto result = roundTrip({batch, batch});
+  ASSERT_EQ(2, result.size());
+  ASSERT_EQ(0, result[0]->size());
+  ASSERT_EQ(0, result[1]->size());
+}
@@ -453,4 +453,54 @@ TEST_F(DecodedVectorTest, dictionaryOverConstant) {
   testDictionaryOverConstant(arrayVector, 5); // null
 }
 
+// Indices of dictionaries over dictionaries without nulls are combined with
+// gathers for fully selected words and one by one elsewhere.
+TEST_F(DecodedVectorTest, nestedDictionaries) {
+  const vector_size_t size = 1'000;
+  auto base = makeFlatVector<int64_t>(size, [](auto row) { return row * 3; });
+  auto makeIndices = [&](std::function<vector_size_t(vector_size_t)> at) {
+    BufferPtr indices =
+        AlignedBuffer::allocate<vector_size_t>(size, pool_.get());
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    for (auto i = 0; i < size; ++i) {
+      rawIndices[i] = at(i);
+    }
+    return indices;
+  };
+  auto inner = makeIndices([](auto row) { return (row * 7) % size; });
+  auto middle = makeIndices([](auto row) { return size - 1 - row; });
+  auto outer = makeIndices([](auto row) { return (row * 13) % size; });
+  auto dictionary = BaseVector::wrapInDictionary(
+      nullptr,
+      outer,
+      size,
+      BaseVector::wrapInDictionary(
+          nullptr,
+          middle,
+          size,
+          BaseVector::wrapInDictionary(nullptr, inner, size, base)));
+
+  auto expectedAt = [&](vector_size_t row) {
+    auto index = (row * 13) % size;
+    index = size - 1 - index;
+    index = (index * 7) % size;
+    return index * 3;
+  };
+
+  SelectivityVector all(size);
+  SelectivityVector partial(size);
+  partial.setValidRange(0, 10, false);
+  partial.setValidRange(300, 310, false);
+  partial.setValidRange(990, size, false);
+  partial.updateBounds();
+  for (auto* rows : {&all, &partial}) {
+    DecodedVector decoded(*dictionary, *rows);
+    EXPECT_FALSE(decoded.mayHaveNulls());
+    EXPECT_EQ(base.get(), decoded.base());
+    rows->applyToSelected([&](auto row) {
+      EXPECT_EQ(expectedAt(row), decoded.valueAt<int64_t>(row)) << row;
+    });
+  }
+}
+
 } // namespace facebook::velox::test
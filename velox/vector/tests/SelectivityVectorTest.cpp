@@ -375,6 +375,42 @@ TEST(SelectivityVectorTest, iterator) {
   EXPECT_EQ(count, bits::countBits(&contiguous[0], 0, 240));
 }
 
+// Fully selected words are visited with a counted loop and the others bit by
+// bit. Covers both in one selection and words cut by begin and end.
+TEST(SelectivityVectorTest, applyToSelectedMixed) {
+  SelectivityVector vector(2'000);
+  vector.clearAll();
+  vector.setValidRange(100, 1'000, true);
+  vector.setValidRange(500, 520, false);
+  for (auto row = 1'000; row < 1'300; row += 3) {
+    vector.setValid(row, true);
+  }
+  vector.setValidRange(1'900, 1'937, true);
+  vector.updateBounds();
+  ASSERT_FALSE(vector.isAllSelected());
+
+  std::vector<vector_size_t> expected;
+  for (auto row = 0; row < vector.size(); ++row) {
+    if (vector.isValid(row)) {
+      expected.push_back(row);
+    }
+  }
+  std::vector<vector_size_t> actual;
+  vector.applyToSelected([&](auto row) { actual.push_back(row); });
+  EXPECT_EQ(expected, actual);
+
+  vector.setActiveRange(130, 1'910);
+  expected.clear();
+  for (auto row = 130; row < 1'910; ++row) {
+    if (vector.isValid(row)) {
+      expected.push_back(row);
+    }
+  }
+  actual.clear();
+  vector.applyToSelected([&](auto row) { actual.push_back(row); });
+  EXPECT_EQ(expected, actual);
+}
+
 TEST(SelectivityVectorTest, resize) {
   SelectivityVector vector(64, false);
   vector.resize(128, /* value */ true);
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "velox/vector/VectorPool.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class VectorPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = memory::getDefaultScopedMemoryPool();
+    vectorMaker_ = std::make_unique<test::VectorMaker>(pool_.get());
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::unique_ptr<test::VectorMaker> vectorMaker_;
+  VectorPool vectorPool_;
+};
+
+TEST_F(VectorPoolTest, reuseFlat) {
+  VectorPtr vector = vectorPool_.get(BIGINT(), 1'000, pool_.get());
+  ASSERT_EQ(1'000, vector->size());
+  auto* flat = vector->asFlatVector<int64_t>();
+  for (auto i = 0; i < 1'000; ++i) {
+    if (i % 7 == 0) {
+      flat->setNull(i, true);
+    } else {
+      flat->set(i, i);
+    }
+  }
+  auto* rawValues = flat->values().get();
+
+  ASSERT_TRUE(vectorPool_.release(vector));
+  ASSERT_FALSE(vector);
+  ASSERT_EQ(1, vectorPool_.numCached(TypeKind::BIGINT));
+
+  // Different type of the same size does not match.
+  auto other = vectorPool_.get(DOUBLE(), 1'000, pool_.get());
+  ASSERT_NE(rawValues, other->values().get());
+  ASSERT_EQ(1, vectorPool_.numCached(TypeKind::BIGINT));
+
+  vector = vectorPool_.get(BIGINT(), 500, pool_.get());
+  ASSERT_EQ(0, vectorPool_.numCached(TypeKind::BIGINT));
+  ASSERT_EQ(flat, vector.get());
+  ASSERT_EQ(rawValues, vector->values().get());
+  ASSERT_EQ(500, vector->size());
+  ASSERT_FALSE(vector->mayHaveNulls());
+  for (auto i = 0; i < 500; ++i) {
+    ASSERT_FALSE(vector->isNullAt(i));
+  }
+}
+
+TEST_F(VectorPoolTest, reuseStrings) {
+  auto vector = vectorMaker_->flatVector<StringView>(100, [](auto row) {
+    static const std::string kLong = "a string that is not inlined";
+    return StringView(kLong);
+  });
+  ASSERT_FALSE(vector->stringBuffers().empty());
+  auto* raw = vector.get();
+  VectorPtr released = std::move(vector);
+  ASSERT_TRUE(vectorPool_.release(released));
+
+  auto reused = vectorPool_.get(VARCHAR(), 10, pool_.get());
+  ASSERT_EQ(raw, reused.get());
+  auto* flat = reused->asFlatVector<StringView>();
+  ASSERT_TRUE(flat->stringBuffers().empty());
+  for (auto i = 0; i < 10; ++i) {
+    ASSERT_EQ(0, flat->valueAt(i).size());
+  }
+}
+
+TEST_F(VectorPoolTest, notReusable) {
+  // Shared vectors, shared buffers and complex types are not taken.
+  VectorPtr vector = vectorMaker_->flatVector<int32_t>({1, 2, 3});
+  auto copy = vector;
+  ASSERT_FALSE(vectorPool_.release(vector));
+  ASSERT_FALSE(vector);
+
+  auto values = copy->values();
+  ASSERT_FALSE(vectorPool_.release(copy));
+  values.reset();
+
+  VectorPtr array = vectorMaker_->arrayVector<int32_t>({{1, 2}, {3}});
+  ASSERT_FALSE(vectorPool_.release(array));
+
+  VectorPtr constant = BaseVector::createConstant(1, 10, pool_.get());
+  ASSERT_FALSE(vectorPool_.release(constant));
+
+  VectorPtr large =
+      BaseVector::create(BIGINT(), VectorPool::kMaxRows + 1, pool_.get());
+  ASSERT_FALSE(vectorPool_.release(large));
+
+  ASSERT_EQ(0, vectorPool_.numCached(TypeKind::INTEGER));
+  ASSERT_EQ(0, vectorPool_.numCached(TypeKind::BIGINT));
+
+  // The cache of each kind is bounded.
+  for (auto i = 0; i < VectorPool::kNumPerKind + 5; ++i) {
+    VectorPtr flat = BaseVector::create(BIGINT(), 10, pool_.get());
+    vectorPool_.release(flat);
+  }
+  ASSERT_EQ(VectorPool::kNumPerKind, vectorPool_.numCached(TypeKind::BIGINT));
+}
+
+TEST_F(VectorPoolTest, rowVector) {
+  auto row = vectorMaker_->rowVector(
+      {vectorMaker_->flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_->flatVector<double>({1, 2, 3})});
+  auto copy = row;
+  // A row that is referenced elsewhere keeps its children.
+  ASSERT_EQ(0, vectorPool_.release(row));
+  ASSERT_FALSE(row);
+  ASSERT_EQ(2, vectorPool_.release(copy));
+
+  auto rowType = ROW({"a", "b", "c"}, {BIGINT(), DOUBLE(), INTEGER()});
+  auto result = std::dynamic_pointer_cast<RowVector>(
+      vectorPool_.get(rowType, 100, pool_.get()));
+  ASSERT_TRUE(result);
+  ASSERT_EQ(100, result->size());
+  ASSERT_EQ(0, vectorPool_.numCached(TypeKind::BIGINT));
+  ASSERT_EQ(0, vectorPool_.numCached(TypeKind::DOUBLE));
+  for (auto& child : result->children()) {
+    ASSERT_EQ(0, child->size());
+  }
+}